@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/attr_builder.h"
 #include "tensorflow/core/common_runtime/eager/copy_to_device_node.h"
 #include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/op_trace.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/eager_grpc_server_lib.h"
@@ -307,16 +308,16 @@ TF_DataType TFE_TensorHandleDataType(TFE_TensorHandle* h) {
 }
 
 int TFE_TensorHandleNumDims(TFE_TensorHandle* h, TF_Status* status) {
-  const tensorflow::Tensor* t = nullptr;
-  status->status = h->handle->Tensor(&t);
-  return t == nullptr ? 0 : t->dims();
+  tensorflow::TensorShape shape;
+  status->status = h->handle->Shape(&shape);
+  return status->status.ok() ? shape.dims() : 0;
 }
 
 int64_t TFE_TensorHandleDim(TFE_TensorHandle* h, int dim_index,
                             TF_Status* status) {
-  const tensorflow::Tensor* t = nullptr;
-  status->status = h->handle->Tensor(&t);
-  return t == nullptr ? 0 : t->dim_size(dim_index);
+  tensorflow::TensorShape shape;
+  status->status = h->handle->Shape(&shape);
+  return status->status.ok() ? shape.dim_size(dim_index) : 0;
 }
 
 const char* TFE_TensorHandleDeviceName(TFE_TensorHandle* h, TF_Status* status) {
@@ -598,6 +599,41 @@ void TFE_ContextAddFunction(TFE_Context* ctx, TF_Function* function,
   status->status = ctx->context.AddFunctionDef(function->fdef);
 }
 
+void TFE_ContextStartTrace(TFE_Context* ctx, TF_Status* status) {
+  std::unique_ptr<tensorflow::OpTrace> trace(
+      new tensorflow::OpTrace(&ctx->context));
+  status->status = ctx->context.StartTrace(trace.get());
+  if (status->status.ok()) trace.release();
+}
+
+const char* TFE_ContextEndTrace(TFE_Context* ctx, TFE_TensorHandle** inputs,
+                                int num_inputs, TFE_TensorHandle** outputs,
+                                int num_outputs, TF_Status* status) {
+  std::unique_ptr<tensorflow::OpTrace> trace(ctx->context.EndTrace());
+  if (trace == nullptr) {
+    status->status = tensorflow::errors::FailedPrecondition(
+        "TFE_ContextStartTrace was not called on this thread");
+    return nullptr;
+  }
+  std::vector<tensorflow::TensorHandle*> input_handles(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    input_handles[i] = inputs[i]->handle;
+  }
+  std::vector<tensorflow::TensorHandle*> output_handles(num_outputs);
+  for (int i = 0; i < num_outputs; ++i) {
+    output_handles[i] = outputs[i]->handle;
+  }
+  tensorflow::FunctionDef fdef;
+  status->status = trace->ToFunctionDef(input_handles, output_handles, &fdef);
+  if (!status->status.ok()) return nullptr;
+  const tensorflow::string& name = fdef.signature().name();
+  if (!ctx->context.FindFunctionByName(name)) {
+    status->status = ctx->context.AddFunctionDef(fdef);
+    if (!status->status.ok()) return nullptr;
+  }
+  return ctx->context.FindFunctionDef(name)->signature().name().c_str();
+}
+
 void TFE_ContextEnableRunMetadata(TFE_Context* ctx) {
   ctx->context.SetShouldStoreMetadata(true);
 }
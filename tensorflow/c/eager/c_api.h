@@ -363,6 +363,25 @@ TF_CAPI_EXPORT extern void TFE_ContextAddFunction(TFE_Context* ctx,
                                                   TF_Function* function,
                                                   TF_Status* status);
 
+// Starts recording the ops executed from this context on the calling thread,
+// until TFE_ContextEndTrace is called on it, so that they can be replayed as a
+// single function. The ops are still executed as usual while recorded.
+TF_CAPI_EXPORT extern void TFE_ContextStartTrace(TFE_Context* ctx,
+                                                 TF_Status* status);
+
+// Stops recording the ops of the calling thread, and adds to `ctx` a function
+// computing `outputs` from `inputs` by the recorded ops. The other tensors read
+// by the ops are embedded in the function as constants; they must be in host
+// memory, and resources must be among `inputs`.
+//
+// Returns the name of the function, to be executed with TFE_Execute by
+// creating an op with that name (with TFE_OpSetXLACompilation to compile it).
+// Tracing the same op sequence again returns the same function. The name is
+// owned by `ctx`.
+TF_CAPI_EXPORT extern const char* TFE_ContextEndTrace(
+    TFE_Context* ctx, TFE_TensorHandle** inputs, int num_inputs,
+    TFE_TensorHandle** outputs, int num_outputs, TF_Status* status);
+
 // Enables tracing of RunMetadata on the ops executed from this context.
 TF_CAPI_EXPORT extern void TFE_ContextEnableRunMetadata(TFE_Context* ctx);
 
@@ -86,6 +86,43 @@ void BM_Execute(int iters, int async) {
 }
 BENCHMARK(BM_Execute)->Arg(0)->Arg(1);
 
+// Measures the per-op overhead of eager dispatch: every iteration creates,
+// executes and deletes an Add of two scalars or of two 2x2 matrices, as the
+// Python bindings do for each op. The kernel is cached after the first one.
+void BM_ExecuteSmallOp(int iters, int matrix) {
+  tensorflow::testing::StopTiming();
+  tensorflow::testing::SetLabel(matrix ? "2x2" : "scalar");
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* t =
+      matrix ? TestMatrixTensorHandle() : TestScalarTensorHandle();
+  TFE_TensorHandle* retvals[1];
+  int num_retvals = 1;
+  tensorflow::testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TFE_Op* add = TFE_NewOp(ctx, "Add", status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(add, t, status);
+    TFE_OpAddInput(add, t, status);
+    TFE_OpSetAttrType(add, "T", TF_FLOAT);
+    TFE_Execute(add, &retvals[0], &num_retvals, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(retvals[0]);
+    TFE_DeleteOp(add);
+  }
+  tensorflow::testing::StopTiming();
+  tensorflow::testing::ItemsProcessed(iters);
+  TFE_DeleteTensorHandle(t);
+  TFE_DeleteContext(ctx, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_DeleteStatus(status);
+}
+BENCHMARK(BM_ExecuteSmallOp)->Arg(0)->Arg(1);
+
 TEST(CAPI, Context) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
@@ -625,6 +662,13 @@ void Execute_MatMul_CPU(bool async) {
   TFE_DeleteOp(matmul);
   TFE_DeleteTensorHandle(m);
 
+  // In async mode, the shape is inferred without waiting for the MatMul.
+  EXPECT_EQ(2, TFE_TensorHandleNumDims(retvals[0], status));
+  EXPECT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(2, TFE_TensorHandleDim(retvals[0], 0, status));
+  EXPECT_EQ(2, TFE_TensorHandleDim(retvals[0], 1, status));
+  EXPECT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
   TF_Tensor* t = TFE_TensorHandleResolve(retvals[0], status);
   ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
   TFE_DeleteTensorHandle(retvals[0]);
@@ -643,6 +687,64 @@ void Execute_MatMul_CPU(bool async) {
 TEST(CAPI, Execute_MatMul_CPU) { Execute_MatMul_CPU(false); }
 TEST(CAPI, Execute_MatMul_CPUAsync) { Execute_MatMul_CPU(true); }
 
+TEST(CAPI, TraceMatMul) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle();
+  const char* function_name = nullptr;
+  for (int i = 0; i < 2; ++i) {
+    TFE_ContextStartTrace(ctx, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_Op* matmul = MatMulOp(ctx, m, m);
+    TFE_TensorHandle* product = nullptr;
+    int num_retvals = 1;
+    TFE_Execute(matmul, &product, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteOp(matmul);
+    const char* name =
+        TFE_ContextEndTrace(ctx, &m, 1, &product, 1, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(product);
+    // Tracing the same ops again yields the same function.
+    if (function_name != nullptr) {
+      EXPECT_STREQ(function_name, name);
+    }
+    function_name = name;
+  }
+  TFE_ContextEndTrace(ctx, nullptr, 0, nullptr, 0, status);
+  EXPECT_EQ(TF_FAILED_PRECONDITION, TF_GetCode(status));
+
+  TFE_Op* call = TFE_NewOp(ctx, function_name, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpAddInput(call, m, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_TensorHandle* retval = nullptr;
+  int num_retvals = 1;
+  TFE_Execute(call, &retval, &num_retvals, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteOp(call);
+  TFE_DeleteTensorHandle(m);
+
+  TF_Tensor* t = TFE_TensorHandleResolve(retval, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteTensorHandle(retval);
+  TFE_DeleteContext(ctx, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  float product[4] = {0};
+  EXPECT_EQ(sizeof(product), TF_TensorByteSize(t));
+  memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+  TF_DeleteTensor(t);
+  EXPECT_EQ(7, product[0]);
+  EXPECT_EQ(10, product[1]);
+  EXPECT_EQ(15, product[2]);
+  EXPECT_EQ(22, product[3]);
+  TF_DeleteStatus(status);
+}
+
 void Execute_MatMul_CPU_Runtime_Error(bool async) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
@@ -24,6 +24,10 @@ constexpr char kSavedModelAssetsDirectory[] = "assets";
 /// SavedModel assets.extra directory.
 constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
 
+/// SavedModel warmup requests filename, in the assets.extra directory.
+constexpr char kSavedModelWarmupRequestsFilename[] =
+    "saved_model_warmup_requests";
+
 /// SavedModel assets key for graph collection-def.
 constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
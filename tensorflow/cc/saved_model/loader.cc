@@ -15,13 +15,21 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
@@ -43,6 +51,11 @@ auto* load_latency = monitoring::Counter<1>::New(
 constexpr char kLoadAttemptFail[] = "fail";
 constexpr char kLoadAttemptSuccess[] = "success";
 
+// The size and the maximal number of parallel reads that prefetch the
+// variables of a SavedModel.
+constexpr int64 kVariablesPrefetchChunkBytes = 8 << 20;
+constexpr int kMaxVariablesPrefetchThreads = 8;
+
 Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
@@ -213,6 +226,159 @@ Status RunLegacyInitOp(const RunOptions& run_options, const string& export_dir,
   return Status::OK();
 }
 
+Status RunWarmupRequest(const RunOptions& run_options,
+                        const MetaGraphDef& meta_graph_def,
+                        const SavedModelWarmupRequest& request,
+                        Session* session) {
+  const auto& signature_def_map = meta_graph_def.signature_def();
+  const auto signature_it = signature_def_map.find(request.signature_key());
+  if (signature_it == signature_def_map.end()) {
+    return errors::InvalidArgument("Warmup request for unknown signature: ",
+                                   request.signature_key());
+  }
+  const SignatureDef& signature_def = signature_it->second;
+
+  std::vector<std::pair<string, Tensor>> inputs;
+  for (const auto& input : request.inputs()) {
+    const auto input_it = signature_def.inputs().find(input.first);
+    if (input_it == signature_def.inputs().end()) {
+      return errors::InvalidArgument("Warmup request feeds unknown input ",
+                                     input.first, " of signature ",
+                                     request.signature_key());
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(input.second)) {
+      return errors::InvalidArgument("Invalid tensor in warmup request for ",
+                                     input.first);
+    }
+    inputs.emplace_back(input_it->second.name(), std::move(tensor));
+  }
+  // Fetch the outputs in the order of their keys, so that repeated requests
+  // reuse the same executors.
+  const std::map<string, TensorInfo> outputs(signature_def.outputs().begin(),
+                                             signature_def.outputs().end());
+  std::vector<string> output_names;
+  for (const auto& output : outputs) {
+    output_names.push_back(output.second.name());
+  }
+
+  std::vector<Tensor> output_tensors;
+  RunMetadata run_metadata;
+  return session->Run(run_options, inputs, output_names, {}, &output_tensors,
+                      &run_metadata);
+}
+
+// Runs the warmup requests stored with the SavedModel, if any. The first run
+// of a signature creates its executors and kernels, and the first runs on a
+// device initialize its libraries and grow its allocator: doing them at load
+// time keeps that latency away from the first requests served.
+//
+// The requests of different signatures are run concurrently, so that their
+// graphs are optimized and their executors created in parallel. Those of one
+// signature are run in order, since only the first of them creates anything.
+Status RunWarmup(const RunOptions& run_options, const string& export_dir,
+                 const MetaGraphDef& meta_graph_def, Session* session) {
+  const string warmup_path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(warmup_path).ok()) {
+    return Status::OK();
+  }
+  LOG(INFO) << "Running warmup requests on SavedModel bundle.";
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(warmup_path, &file));
+  io::SequentialRecordReader reader(file.get());
+
+  int num_requests = 0;
+  std::map<string, std::vector<SavedModelWarmupRequest>> requests;
+  string record;
+  while (true) {
+    const Status read_status = reader.ReadRecord(&record);
+    if (errors::IsOutOfRange(read_status)) break;
+    TF_RETURN_IF_ERROR(read_status);
+    SavedModelWarmupRequest request;
+    if (!request.ParseFromString(record)) {
+      return errors::DataLoss("Failed to parse warmup request ", num_requests,
+                              " in ", warmup_path);
+    }
+    requests[request.signature_key()].push_back(std::move(request));
+    ++num_requests;
+  }
+
+  std::vector<Status> statuses(requests.size());
+  {
+    const int num_threads = std::min<int>(
+        requests.size(), port::NumSchedulableCPUs());
+    thread::ThreadPool pool(Env::Default(), "saved_model_warmup",
+                            std::max(num_threads, 1));
+    int i = 0;
+    for (const auto& signature_requests : requests) {
+      const std::vector<SavedModelWarmupRequest>* signature_requests_p =
+          &signature_requests.second;
+      Status* status = &statuses[i++];
+      pool.Schedule([&run_options, &meta_graph_def, session,
+                     signature_requests_p, status]() {
+        for (const SavedModelWarmupRequest& request : *signature_requests_p) {
+          *status = RunWarmupRequest(run_options, meta_graph_def, request,
+                                     session);
+          if (!status->ok()) return;
+        }
+      });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  LOG(INFO) << "Ran " << num_requests << " warmup requests.";
+  return Status::OK();
+}
+
+// Reads the data files of the variables of the SavedModel in chunks on `pool`,
+// so that they are in the file system's cache when the restore op reads them:
+// the reads overlap the import of the graph into the session, which does not
+// need them. Nothing is read when the files would take more than half of the
+// free memory, where they would only evict each other from the cache. Errors
+// are ignored, the restore op reports them.
+void PrefetchVariables(const string& export_dir, thread::ThreadPool* pool) {
+  Env* env = Env::Default();
+  const string variables_prefix =
+      io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                   kSavedModelVariablesFilename);
+  std::vector<string> data_files;
+  if (!env->GetMatchingPaths(strings::StrCat(variables_prefix, ".data-*"),
+                             &data_files)
+           .ok()) {
+    return;
+  }
+  std::vector<uint64> file_sizes(data_files.size());
+  uint64 total_size = 0;
+  for (int i = 0; i < data_files.size(); ++i) {
+    if (!env->GetFileSize(data_files[i], &file_sizes[i]).ok()) return;
+    total_size += file_sizes[i];
+  }
+  if (total_size > port::AvailableRam() / 2) {
+    LOG(INFO) << "Not prefetching " << total_size
+              << " bytes of variables, for lack of free memory.";
+    return;
+  }
+  for (int i = 0; i < data_files.size(); ++i) {
+    std::unique_ptr<RandomAccessFile> file;
+    if (!env->NewRandomAccessFile(data_files[i], &file).ok()) continue;
+    // RandomAccessFile reads are safe from several threads at once.
+    std::shared_ptr<RandomAccessFile> shared_file(file.release());
+    for (uint64 offset = 0; offset < file_sizes[i];
+         offset += kVariablesPrefetchChunkBytes) {
+      pool->Schedule([shared_file, offset]() {
+        std::unique_ptr<char[]> scratch(new char[kVariablesPrefetchChunkBytes]);
+        StringPiece data;
+        shared_file
+            ->Read(offset, kVariablesPrefetchChunkBytes, &data, scratch.get())
+            .IgnoreError();
+      });
+    }
+  }
+}
+
 Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
                         std::vector<AssetFileDef>* asset_file_defs) {
   const auto& collection_def_map = meta_graph_def.collection_def();
@@ -248,8 +414,16 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   TF_RETURN_IF_ERROR(
       FindMetaGraphDefToLoad(saved_model_proto, tags, &bundle->meta_graph_def));
 
-  TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
-      bundle->meta_graph_def, session_options, &bundle->session));
+  {
+    // The variables are prefetched while the session is created, and the
+    // pool is joined before they are restored.
+    thread::ThreadPool prefetch_pool(
+        Env::Default(), "saved_model_prefetch",
+        std::min(port::NumSchedulableCPUs(), kMaxVariablesPrefetchThreads));
+    PrefetchVariables(export_dir, &prefetch_pool);
+    TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
+        bundle->meta_graph_def, session_options, &bundle->session));
+  }
 
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
@@ -268,6 +442,8 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                                        bundle->meta_graph_def, asset_file_defs,
                                        bundle->session.get()));
   }
+  TF_RETURN_IF_ERROR(RunWarmup(run_options, export_dir, bundle->meta_graph_def,
+                               bundle->session.get()));
   return Status::OK();
 }
 
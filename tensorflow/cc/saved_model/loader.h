@@ -47,6 +47,16 @@ struct SavedModelBundle {
 /// to be loaded is identified by the supplied tags, corresponding exactly to
 /// the set of tags used at SavedModel build time. Returns a SavedModel bundle
 /// with a session and the requested meta graph def, if found.
+///
+/// If the SavedModel has warmup requests, a TFRecord file of
+/// `SavedModelWarmupRequest` protos named `kSavedModelWarmupRequestsFilename`
+/// in its assets.extra directory, they are run before returning, so that the
+/// executors and kernels of their signatures are ready for the first requests.
+/// The requests of different signatures are run concurrently.
+///
+/// The variables are read ahead while the graph is imported into the session.
+/// LoadSavedModel is thread-safe: several SavedModels can be loaded at once
+/// from different threads.
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
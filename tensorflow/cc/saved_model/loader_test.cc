@@ -23,9 +23,12 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -65,6 +68,42 @@ class LoaderTest : public ::testing::Test {
         test::AsTensor<string>({"foo.txt"}, TensorShape({})), path_outputs[0]);
   }
 
+  // Copies the SavedModel in `export_dir` to a temporary directory, with
+  // `requests` as its warmup requests, and returns the directory.
+  string CopyWithWarmupRequests(
+      const string& export_dir, const string& name,
+      const std::vector<SavedModelWarmupRequest>& requests) {
+    Env* env = Env::Default();
+    const string copy_dir = io::JoinPath(testing::TmpDir(), name);
+    for (const string& dir :
+         {kSavedModelAssetsDirectory, kSavedModelAssetsExtraDirectory,
+          kSavedModelVariablesDirectory}) {
+      TF_CHECK_OK(env->RecursivelyCreateDir(io::JoinPath(copy_dir, dir)));
+    }
+    for (const string& file :
+         {string(kSavedModelFilenamePb),
+          io::JoinPath(kSavedModelAssetsDirectory, "foo.txt"),
+          io::JoinPath(kSavedModelVariablesDirectory, "variables.index"),
+          io::JoinPath(kSavedModelVariablesDirectory,
+                       "variables.data-00000-of-00001")}) {
+      TF_CHECK_OK(env->CopyFile(io::JoinPath(export_dir, file),
+                                io::JoinPath(copy_dir, file)));
+    }
+
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(
+        io::JoinPath(copy_dir, kSavedModelAssetsExtraDirectory,
+                     kSavedModelWarmupRequestsFilename),
+        &file));
+    io::RecordWriter writer(file.get());
+    for (const SavedModelWarmupRequest& request : requests) {
+      TF_CHECK_OK(writer.WriteRecord(request.SerializeAsString()));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    return copy_dir;
+  }
+
   void CheckSavedModelBundle(const string& export_dir,
                              const SavedModelBundle& bundle) {
     ValidateAssets(export_dir, bundle);
@@ -198,6 +237,89 @@ TEST_F(LoaderTest, MainOpFormat) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, WarmupRequests) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  SavedModelWarmupRequest request;
+  request.set_signature_key("regress_x_to_y");
+  Tensor input = test::AsTensor<string>(
+      {MakeSerializedExample(0), MakeSerializedExample(1)}, TensorShape({2}));
+  input.AsProtoTensorContent(&(*request.mutable_inputs())[kRegressInputs]);
+
+  const string export_dir = CopyWithWarmupRequests(
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded),
+      "warmup_requests", {request, request});
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, WarmupRequestsOfSeveralSignatures) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  Tensor input = test::AsTensor<string>(
+      {MakeSerializedExample(0), MakeSerializedExample(1)}, TensorShape({2}));
+  std::vector<SavedModelWarmupRequest> requests;
+  for (const string& signature_key :
+       {"regress_x_to_y", "regress_x_to_y2", "regress_x_to_y"}) {
+    SavedModelWarmupRequest request;
+    request.set_signature_key(signature_key);
+    input.AsProtoTensorContent(&(*request.mutable_inputs())[kRegressInputs]);
+    requests.push_back(request);
+  }
+
+  const string export_dir = CopyWithWarmupRequests(
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded),
+      "warmup_requests_of_several_signatures", requests);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, InvalidWarmupRequest) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  SavedModelWarmupRequest request;
+  request.set_signature_key("missing_signature");
+
+  const string export_dir = CopyWithWarmupRequests(
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded),
+      "invalid_warmup_request", {request});
+  const Status st = LoadSavedModel(session_options, run_options, export_dir,
+                                   {kSavedModelTagServe}, &bundle);
+  EXPECT_TRUE(errors::IsInvalidArgument(st));
+  EXPECT_TRUE(str_util::StrContains(st.error_message(), "missing_signature"))
+      << st.error_message();
+}
+
+TEST_F(LoaderTest, ConcurrentLoads) {
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  SessionOptions session_options;
+  RunOptions run_options;
+  SavedModelBundle bundles[4];
+  Status statuses[4];
+  {
+    thread::ThreadPool pool(Env::Default(), "concurrent_loads", 4);
+    for (int i = 0; i < 4; ++i) {
+      pool.Schedule([&, i]() {
+        statuses[i] = LoadSavedModel(session_options, run_options, export_dir,
+                                     {kSavedModelTagServe}, &bundles[i]);
+      });
+    }
+  }
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    CheckSavedModelBundle(export_dir, bundles[i]);
+  }
+}
+
 TEST_F(LoaderTest, InvalidExportPath) {
   SavedModelBundle bundle;
   RunOptions run_options;
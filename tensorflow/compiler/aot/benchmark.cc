@@ -77,10 +77,17 @@ void DumpStatsToStdout(const Stats& stats) {
   const string label_trimmed(buf);
   snprintf(buf, kBufSize, "Mean of %2.0f%% best:", best_ratio * 100);
   const string label_best(buf);
+  // The nearest-rank percentile of the sorted iterations.
+  auto percentile = [&sorted_us, count_us](int p) -> double {
+    const size_t rank = (count_us * p + 99) / 100;
+    return sorted_us[rank > 0 ? rank - 1 : 0];
+  };
   std::vector<std::pair<string, double>> groups = {
       {"Best:", sorted_us.front()},
       {"Worst:", sorted_us.back()},
       {"Median:", sorted_us[count_us / 2]},
+      {"90th percentile:", percentile(90)},
+      {"99th percentile:", percentile(99)},
       {"Mean:", sum_us / count_us},
       {label_trimmed, sum_us_trimmed / count_us_trimmed},
       {label_best, sum_us_best / count_us_best},
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/aot/tests/test_graph_tfgather.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmul.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_parallel.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfmatmulandadd_with_profiling.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfsplits.h"
 #include "tensorflow/compiler/xla/service/hlo_profile_printer.h"
@@ -404,6 +405,25 @@ TEST(TFCompileTest, MatMulAndAdd1) {
   }
 }
 
+TEST(TFCompileTest, MatMulAndAddParallel) {
+  Eigen::ThreadPool tp(4);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+
+  MatMulAndAddCompParallel muladd;
+  muladd.set_thread_pool(&device);
+  const float args[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::copy(args + 0, args + 4, muladd.arg0_data());
+  std::copy(args + 4, args + 8, muladd.arg1_data());
+  EXPECT_TRUE(muladd.Run());
+  EXPECT_EQ(muladd.error_msg(), "");
+  const float results0[4] = {19, 22, 43, 50};
+  const float results1[4] = {6, 8, 10, 12};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(muladd.result0_data()[i], results0[i]);
+    EXPECT_EQ(muladd.result1_data()[i], results1[i]);
+  }
+}
+
 TEST(TFCompileTest, Function) {
   // The function is equivalent to an addition
   FunctionComp add_fn;
@@ -26,7 +26,8 @@ def tf_library(name, graph, config,
                tfcompile_flags=None,
                tfcompile_tool="//tensorflow/compiler/aot:tfcompile",
                include_standard_runtime_deps=True,
-               enable_xla_hlo_profiling=False, deps=None, tags=None):
+               enable_xla_hlo_profiling=False, xla_cpu_max_parallelism=None,
+               deps=None, tags=None):
   """Runs tfcompile to compile a TensorFlow graph into executable code.
 
   Given an invocation of tf_library(name="foo", ...), generates the following
@@ -71,6 +72,11 @@ def tf_library(name, graph, config,
       needed by the generated library.
     enable_xla_hlo_profiling: Enable XLA HLO profiling in the generated program,
       and emit metadata that lets us pretty-print the gathered profile counters.
+      The benchmark binary then prints the profile accumulated over its run.
+    xla_cpu_max_parallelism: If set, the generated code splits large ops into
+      parallel tasks for up to this many threads of the thread pool passed to
+      set_thread_pool(). Without a thread pool, the tasks run on the calling
+      thread.
     deps: a list of deps to include on the build rules for the generated
       library, added to the standard deps if standard_runtime_deps is True.
     tags: tags to apply to subsidiary build rules.
@@ -144,6 +150,11 @@ def tf_library(name, graph, config,
     profiling_flag = "--xla_hlo_profile"
   else:
     profiling_flag = ""
+  if xla_cpu_max_parallelism:
+    parallelism_flag = ("--xla_cpu_aot_max_parallelism=" +
+                        str(xla_cpu_max_parallelism))
+  else:
+    parallelism_flag = ""
   native.genrule(
       name=("gen_" + name),
       srcs=[
@@ -164,7 +175,7 @@ def tf_library(name, graph, config,
            " --out_header=$(@D)/" + header_file +
            " --out_metadata_object=$(@D)/" + metadata_object_file +
            " --out_function_object=$(@D)/" + function_object_file +
-           " " + flags + " " + profiling_flag),
+           " " + flags + " " + profiling_flag + " " + parallelism_flag),
       tools=[tfcompile_tool],
       visibility=visibility,
       testonly=testonly,
@@ -229,6 +240,8 @@ def tf_library(name, graph, config,
           "//tensorflow/compiler/xla:xla_data_proto",
       ] or []) + (enable_xla_hlo_profiling and [
           "//tensorflow/compiler/xla/service:hlo_profile_printer_data"
+      ] or []) + (xla_cpu_max_parallelism and [
+          "//tensorflow/compiler/xla/service/cpu:runtime_fork_join"
       ] or []) + (include_standard_runtime_deps and [
           # TODO(cwhipkey): only depend on kernel code that the model actually needed.
           "//tensorflow/compiler/tf2xla/kernels:index_ops_kernel_argmax_float_1d",
@@ -252,7 +265,9 @@ def tf_library(name, graph, config,
   sed_replace = (
       "-e \"s|{{TFCOMPILE_HEADER}}|$(location " + header_file + ")|g\" " +
       "-e \"s|{{TFCOMPILE_CPP_CLASS}}|" + cpp_class + "|g\" " +
-      "-e \"s|{{TFCOMPILE_NAME}}|" + no_ns_name + "|g\" ")
+      "-e \"s|{{TFCOMPILE_NAME}}|" + no_ns_name + "|g\" " +
+      "-e \"s|{{TFCOMPILE_HLO_PROFILING}}|" +
+      (enable_xla_hlo_profiling and "1" or "0") + "|g\" ")
 
   if gen_test:
     test_name = name + "_test"
@@ -333,7 +348,9 @@ def tf_library(name, graph, config,
             "//tensorflow/compiler/aot:runtime",
             "//tensorflow/compiler/xla:executable_run_options",
             "//third_party/eigen3",
-        ] + if_android([
+        ] + (enable_xla_hlo_profiling and [
+            "//tensorflow/compiler/xla/service:hlo_profile_printer",
+        ] or []) + if_android([
             "//tensorflow/compiler/aot:benchmark_extra_android",
         ]),
         tags=tags,
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_launch_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
@@ -33,6 +36,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -90,6 +95,85 @@ Status XlaLocalLaunchBase::BuildCompilationCache(OpKernelContext* ctx,
   return Status::OK();
 }
 
+namespace {
+
+// The thread pool that compiles the clusters in asynchronous mode, shared by
+// all the devices.
+thread::ThreadPool* AsyncCompilationThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "xla_async_compilation",
+      std::max(1, legacy_flags::GetXlaLaunchOpFlags()
+                      ->tf_xla_async_compilation_threads));
+  return thread_pool;
+}
+
+}  // namespace
+
+bool XlaLocalLaunchBase::CanRunFunction(OpKernelContext* ctx) const {
+  if (device_type_ == DeviceType(DEVICE_CPU)) {
+    return true;
+  }
+  if (device_type_ != DeviceType(DEVICE_GPU)) {
+    // XLA devices have no TensorFlow kernels.
+    return false;
+  }
+  // The constants are in host memory, while the arguments of a GPU function
+  // are expected in device memory, except for int32 ones.
+  for (int i : constants_) {
+    if (ctx->input_dtype(i) != DT_INT32) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status XlaLocalLaunchBase::RunFunction(OpKernelContext* ctx) {
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  if (lib == nullptr) {
+    return errors::Internal("No function library.");
+  }
+  FunctionLibraryRuntime::Handle handle;
+  {
+    mutex_lock lock(function_handle_mu_);
+    if (function_handle_ == kInvalidHandle) {
+      TF_RETURN_IF_ERROR(lib->Instantiate(
+          function_.name(), AttrSlice(&function_.attr()), &function_handle_));
+    }
+    handle = function_handle_;
+  }
+
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = ctx->step_id();
+  opts.rendezvous = ctx->rendezvous();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.step_container = ctx->step_container();
+  opts.stats_collector = ctx->stats_collector();
+  opts.runner = ctx->runner();
+  std::vector<Tensor> rets;
+  Notification n;
+  Status status;
+  lib->Run(opts, handle, args, &rets, [&n, &status](const Status& s) {
+    status = s;
+    n.Notify();
+  });
+  n.WaitForNotification();
+  TF_RETURN_IF_ERROR(status);
+  if (static_cast<int>(rets.size()) != ctx->num_outputs()) {
+    return errors::Internal("Function ", function_.name(), " returned ",
+                            rets.size(), " values, expected ",
+                            ctx->num_outputs());
+  }
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    ctx->set_output(i, rets[i]);
+  }
+  return Status::OK();
+}
+
 void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   VLOG(1) << "XlaLocalLaunchOpBase::Compute "
           << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
@@ -166,9 +250,25 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   }
   XlaCompiler::CompileOptions compile_options;
   compile_options.is_entry_computation = true;
-  OP_REQUIRES_OK(
-      ctx, cache->Compile(options, function_, constant_args, variables, ctx,
-                          &kernel, &executable, &compile_options));
+  const legacy_flags::XlaLaunchOpFlags* flags =
+      legacy_flags::GetXlaLaunchOpFlags();
+  if (flags->tf_xla_async_compilation && CanRunFunction(ctx)) {
+    OP_REQUIRES_OK(ctx, cache->CompileAsync(
+                            options, function_, constant_args, variables, ctx,
+                            AsyncCompilationThreadPool(),
+                            flags->tf_xla_max_signatures_per_cluster, &kernel,
+                            &executable, &compile_options));
+    if (kernel == nullptr) {
+      // Not compiled (yet) for these inputs.
+      VLOG(1) << "Running the function with TensorFlow kernels";
+      OP_REQUIRES_OK(ctx, RunFunction(ctx));
+      return;
+    }
+  } else {
+    OP_REQUIRES_OK(
+        ctx, cache->Compile(options, function_, constant_args, variables, ctx,
+                            &kernel, &executable, &compile_options));
+  }
 
   VLOG(1) << "Executing XLA Computation...";
 
@@ -18,10 +18,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace tensorflow {
@@ -51,6 +54,13 @@ class XlaLocalLaunchBase : public OpKernel {
   Status BuildCompilationCache(OpKernelContext* ctx,
                                XlaCompilationCache** cache);
 
+  // Returns true if the cluster can be evaluated by running `function_` with
+  // TensorFlow kernels while it is compiled in the background.
+  bool CanRunFunction(OpKernelContext* ctx) const;
+
+  // Evaluates the cluster by running `function_` with TensorFlow kernels.
+  Status RunFunction(OpKernelContext* ctx);
+
   // Indexes of compile-time constant inputs
   std::vector<int> constants_;
   // Indexes of resource inputs
@@ -59,6 +69,12 @@ class XlaLocalLaunchBase : public OpKernel {
   DeviceType device_type_;
   NameAttrList function_;
   se::Platform::Id platform_id_;
+
+  // The handle of `function_` in the function library of the kernel, used to
+  // run it while it is compiled asynchronously.
+  mutex function_handle_mu_;
+  FunctionLibraryRuntime::Handle function_handle_
+      GUARDED_BY(function_handle_mu_) = kInvalidHandle;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -42,6 +42,7 @@ static void AllocateFlags() {
   flags->tf_xla_cpu_global_jit = false;
   flags->tf_xla_clustering_fuel = std::numeric_limits<int64>::max();
   flags->tf_xla_fusion_only = false;
+  flags->tf_xla_padding_buckets = "";
   flag_list = new std::vector<Flag>(
       {Flag("tf_xla_auto_jit", &flags->tf_xla_auto_jit,
             "Control compilation of operators into XLA computations on CPU and "
@@ -63,7 +64,11 @@ static void AllocateFlags() {
             "eligible for clustering."),
        Flag("tf_xla_fusion_only", &flags->tf_xla_fusion_only,
             "enable fusion of element-wise operations only using XLA when "
-            "global_jit_level is ON*.")});
+            "global_jit_level is ON*."),
+       Flag("tf_xla_padding_buckets", &flags->tf_xla_padding_buckets,
+            "Comma-separated sizes the leading dimension of the arguments of "
+            "the clusters is padded to, when the rows of the cluster are "
+            "independent. Empty means no padding.")});
   xla::legacy_flags::ParseFlagsFromEnv(*flag_list);
 }
 
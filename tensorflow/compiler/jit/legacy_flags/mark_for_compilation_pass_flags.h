@@ -55,6 +55,9 @@ typedef struct {
                             // is set to ON* and overrides its behavior. If
                             // true, enable fusion of element-wise operations
                             // only using XLA.
+  string tf_xla_padding_buckets;  // Comma-separated sizes the leading
+                                  // dimension of the arguments of the
+                                  // clusters is padded to. Empty = off.
 } MarkForCompilationPassFlags;
 
 // Return a pointer to the MarkForCompilationPassFlags struct;
@@ -0,0 +1,65 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Legacy flags for the XLA bridge's xla_launch_op module.
+
+#include <mutex>
+#include <vector>
+
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
+#include "tensorflow/compiler/xla/legacy_flags/parse_flags_from_env.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace legacy_flags {
+
+// Pointers to the parsed value of the flags and flag descriptors, initialized
+// via flags_init.
+static XlaLaunchOpFlags* flags;
+static std::vector<Flag>* flag_list;
+static std::once_flag flags_init;
+
+// Allocate *flags.  Called via call_once(&flags_init,...).
+static void AllocateFlags() {
+  flags = new XlaLaunchOpFlags;
+  flags->tf_xla_async_compilation = false;
+  flags->tf_xla_async_compilation_threads = 1;
+  flags->tf_xla_max_signatures_per_cluster = 10;
+  flag_list = new std::vector<Flag>({
+      Flag("tf_xla_async_compilation", &flags->tf_xla_async_compilation,
+           "Compile the clusters in the background, and run their "
+           "TensorFlow function until the compilation is done."),
+      Flag("tf_xla_async_compilation_threads",
+           &flags->tf_xla_async_compilation_threads,
+           "Number of threads that compile the clusters in the background."),
+      Flag("tf_xla_max_signatures_per_cluster",
+           &flags->tf_xla_max_signatures_per_cluster,
+           "Maximum number of input signatures a cluster is compiled for in "
+           "asynchronous mode; <= 0 means no limit."),
+  });
+  xla::legacy_flags::ParseFlagsFromEnv(*flag_list);
+}
+
+// Return a pointer to the XlaLaunchOpFlags struct;
+// repeated calls return the same pointer.
+// This should be called only after Flags::Parse() has returned.
+XlaLaunchOpFlags* GetXlaLaunchOpFlags() {
+  std::call_once(flags_init, &AllocateFlags);
+  return flags;
+}
+
+}  // namespace legacy_flags
+}  // namespace tensorflow
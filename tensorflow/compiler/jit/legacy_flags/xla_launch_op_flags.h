@@ -0,0 +1,53 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
+#define TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
+
+// Legacy flags for the XLA bridge's xla_launch_op module.
+
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace legacy_flags {
+
+// The values of flags associated with the XLA bridge's
+// xla_launch_op module.
+typedef struct {
+  // Compile the clusters on a background thread pool instead of blocking the
+  // step, and run the original TensorFlow function of a cluster until its
+  // compilation for the shapes of the inputs is done.
+  bool tf_xla_async_compilation;
+  // Number of threads that compile the clusters in the background.
+  int32 tf_xla_async_compilation_threads;
+  // Maximum number of distinct input signatures a cluster is compiled for in
+  // asynchronous mode. A cluster that keeps being recompiled for new shapes
+  // runs the original TensorFlow function for the other signatures. <= 0
+  // means no limit.
+  int32 tf_xla_max_signatures_per_cluster;
+} XlaLaunchOpFlags;
+
+// Return a pointer to the XlaLaunchOpFlags struct;
+// repeated calls return the same pointer.
+// This should be called only after Flags::Parse() has returned.
+XlaLaunchOpFlags* GetXlaLaunchOpFlags();
+
+}  // namespace legacy_flags
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
@@ -282,6 +282,7 @@ Status XlaCompilationCache::CompileImpl(
     std::unique_ptr<Entry>& e = cache_[signature];
     if (!e) {
       e.reset(new Entry);
+      ++num_signatures_[signature.name];
     }
     entry = e.get();
   }
@@ -290,6 +291,9 @@ Status XlaCompilationCache::CompileImpl(
   // TODO(phawkins): this locking will need to be restructured when we implement
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
+  while (entry->compiling) {
+    entry->compilation_done.wait(entry_lock);
+  }
   if (!entry->compiled) {
     VLOG(1) << "Compilation cache miss for signature: "
             << SignatureDebugString(signature);
@@ -325,4 +329,108 @@ Status XlaCompilationCache::CompileImpl(
   return status;
 }
 
+Status XlaCompilationCache::CompileAsync(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const std::map<int, Tensor>& constant_args,
+    const std::map<int, OptionalTensor>& variable_args, OpKernelContext* ctx,
+    thread::ThreadPool* thread_pool, int max_signatures,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable,
+    const XlaCompiler::CompileOptions* compile_options) {
+  VLOG(1) << "XlaCompilationCache::CompileAsync " << DebugString();
+  *compilation_result = nullptr;
+  *executable = nullptr;
+
+  TF_RET_CHECK(constant_args.size() + variable_args.size() <=
+               ctx->num_inputs());
+
+  Signature signature;
+  TF_RETURN_IF_ERROR(
+      BuildSignature(function, constant_args, variable_args, ctx, &signature));
+
+  Entry* entry;
+  {
+    mutex_lock lock(mu_);
+    auto it = cache_.find(signature);
+    if (it == cache_.end()) {
+      int& num_signatures = num_signatures_[signature.name];
+      if (max_signatures > 0 && num_signatures >= max_signatures) {
+        if (blacklisted_.insert(signature.name).second) {
+          LOG(WARNING) << "Not compiling " << signature.name
+                       << " for new signatures anymore: it was compiled for "
+                       << num_signatures << " signatures already.";
+        }
+        return Status::OK();
+      }
+      ++num_signatures;
+      it = cache_.emplace(signature, std::unique_ptr<Entry>(new Entry)).first;
+    }
+    entry = it->second.get();
+  }
+
+  mutex_lock entry_lock(entry->mu);
+  if (entry->compiled) {
+    *compilation_result = &entry->compilation_result;
+    *executable = entry->executable.get();
+    return entry->compilation_status;
+  }
+  if (!entry->compiling) {
+    VLOG(1) << "Compiling in the background for signature: "
+            << SignatureDebugString(signature);
+    std::vector<XlaCompiler::Argument> args;
+    TF_RETURN_IF_ERROR(
+        BuildArguments(constant_args, variable_args, ctx, &args));
+    entry->compiling = true;
+    ScheduleCompilation(
+        options, function, std::move(args),
+        compile_options ? *compile_options : XlaCompiler::CompileOptions(),
+        thread_pool, entry);
+  }
+  return Status::OK();
+}
+
+void XlaCompilationCache::ScheduleCompilation(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    std::vector<XlaCompiler::Argument> args,
+    const XlaCompiler::CompileOptions& compile_options,
+    thread::ThreadPool* thread_pool, Entry* entry) {
+  // The function library and the allocator of the caller may be gone by the
+  // time the compilation runs, so the compilation uses a copy of the library
+  // and the allocator of the XLA backend.
+  std::shared_ptr<FunctionLibraryDefinition> flib_def(
+      new FunctionLibraryDefinition(*options.flib_def));
+  XlaCompiler::Options compiler_options = options;
+  compiler_options.flib_def = flib_def.get();
+  compiler_options.device_allocator = nullptr;
+
+  // The compilation holds a reference to the cache, which owns `entry`.
+  Ref();
+  thread_pool->Schedule([this, compiler_options, flib_def, function, args,
+                         compile_options, entry]() {
+    XlaCompiler::CompilationResult result;
+    std::unique_ptr<xla::LocalExecutable> executable;
+    Status status;
+    {
+      XlaCompiler compiler(compiler_options);
+      status = compiler.CompileFunction(compile_options, function, args,
+                                        &result);
+    }
+    if (status.ok()) {
+      status = BuildExecutable(compiler_options, result, &executable);
+    }
+    VLOG(1) << "Background compilation of " << function.name()
+            << " done: " << status;
+    {
+      mutex_lock lock(entry->mu);
+      entry->compilation_status = status;
+      entry->compilation_result = std::move(result);
+      entry->executable = std::move(executable);
+      entry->compiled = true;
+      entry->compiling = false;
+    }
+    entry->compilation_done.notify_all();
+    Unref();
+  });
+}
+
 }  // namespace tensorflow
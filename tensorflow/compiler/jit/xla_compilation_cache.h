@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 
+#include <unordered_set>
+
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -71,6 +73,23 @@ class XlaCompilationCache : public ResourceBase {
                  xla::LocalExecutable** executable,
                  const XlaCompiler::CompileOptions* compile_options);
 
+  // As Compile, but does not wait for the compilation of a new signature: it
+  // is scheduled on `thread_pool`, and `*compilation_result` and
+  // `*executable` are set to null until it is done, in which case the caller
+  // must evaluate `function` some other way. Once `function` has been compiled
+  // for `max_signatures` distinct signatures, no new signature of it is
+  // compiled anymore (no limit if <= 0). The options are copied, except for
+  // the device allocator, which is not used by the background compilation.
+  Status CompileAsync(const XlaCompiler::Options& options,
+                      const NameAttrList& function,
+                      const std::map<int, Tensor>& constant_args,
+                      const std::map<int, OptionalTensor>& variable_args,
+                      OpKernelContext* ctx, thread::ThreadPool* thread_pool,
+                      int max_signatures,
+                      const XlaCompiler::CompilationResult** compilation_result,
+                      xla::LocalExecutable** executable,
+                      const XlaCompiler::CompileOptions* compile_options);
+
   // As above, but calls XlaCompiler::CompileSingleOp instead of
   // XlaCompiler::CompileFunction.
   Status CompileSingleOp(
@@ -139,6 +158,11 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is this entry being compiled in the background? `compilation_done` is
+    // notified when it is done.
+    bool compiling GUARDED_BY(mu) = false;
+    condition_variable compilation_done;
+
     // Did compilation succeed?
     Status compilation_status GUARDED_BY(mu);
 
@@ -150,10 +174,23 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable GUARDED_BY(mu);
   };
 
+  // Compiles `function` and builds its executable on `thread_pool`, then
+  // marks `entry` as compiled.
+  void ScheduleCompilation(const XlaCompiler::Options& options,
+                           const NameAttrList& function,
+                           std::vector<XlaCompiler::Argument> args,
+                           const XlaCompiler::CompileOptions& compile_options,
+                           thread::ThreadPool* thread_pool, Entry* entry);
+
   mutex mu_;
   std::unordered_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       GUARDED_BY(mu_);
 
+  // Number of signatures each function has been compiled for, and the
+  // functions that are not compiled for new signatures anymore.
+  std::unordered_map<string, int> num_signatures_ GUARDED_BY(mu_);
+  std::unordered_set<string> blacklisted_ GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
 
@@ -0,0 +1,542 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_launch_padding_pass.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+
+#include "tensorflow/compiler/jit/legacy_flags/mark_for_compilation_pass_flags.h"
+#include "tensorflow/compiler/tf2xla/dump_graph.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Ops that compute their result element-wise from their inputs, with
+// broadcasting.
+bool IsElementwise(const Node* n) {
+  static const std::unordered_set<string>* const kOps =
+      new std::unordered_set<string>({
+          // Unary.
+          "Abs", "Acos", "Acosh", "Asin", "Asinh", "Atan", "Atanh", "Cast",
+          "Ceil", "Cos", "Cosh", "Elu", "Erf", "Erfc", "Exp", "Expm1", "Floor",
+          "Identity", "Inv", "IsFinite", "IsInf", "IsNan", "Log", "Log1p",
+          "LogicalNot", "Neg", "Reciprocal", "Relu", "Relu6", "Rint", "Round",
+          "Rsqrt", "Selu", "Sigmoid", "Sign", "Sin", "Sinh", "Softplus",
+          "Softsign", "Sqrt", "Square", "StopGradient", "Tan", "Tanh",
+          // Binary.
+          "Add", "Atan2", "Div", "Equal", "FloorDiv", "FloorMod", "Greater",
+          "GreaterEqual", "Less", "LessEqual", "LogicalAnd", "LogicalOr",
+          "Maximum", "Minimum", "Mod", "Mul", "NotEqual", "Pow", "RealDiv",
+          "SquaredDifference", "Sub", "TruncateDiv", "TruncateMod",
+          // N-ary.
+          "AddN",
+      });
+  return kOps->count(n->type_string()) > 0;
+}
+
+// Ops whose first input has the rows, and whose other inputs are weights.
+bool IsRowwiseOnFirstInput(const Node* n) {
+  static const std::unordered_set<string>* const kOps =
+      new std::unordered_set<string>({"AvgPool", "BiasAdd", "Conv2D",
+                                      "DepthwiseConv2dNative", "MatMul",
+                                      "MaxPool"});
+  return kOps->count(n->type_string()) > 0;
+}
+
+// Reductions over the dimensions given by their second input.
+bool IsReduction(const Node* n) {
+  static const std::unordered_set<string>* const kOps =
+      new std::unordered_set<string>({"All", "Any", "ArgMax", "ArgMin", "Max",
+                                      "Mean", "Min", "Prod", "Sum"});
+  return kOps->count(n->type_string()) > 0;
+}
+
+// Returns the rank of output `index` of `n`, or -1 if unknown.
+int Rank(const ShapeRefiner& refiner, const Node* n, int index) {
+  shape_inference::InferenceContext* c = refiner.GetContext(n);
+  if (c == nullptr || index >= c->num_outputs()) return -1;
+  return c->Rank(c->output(index));
+}
+
+// Returns the size of dimension 0 of output `index` of `n`, or -1 if unknown.
+int64 LeadingDim(const ShapeRefiner& refiner, const Node* n, int index) {
+  shape_inference::InferenceContext* c = refiner.GetContext(n);
+  if (c == nullptr || index >= c->num_outputs()) return -1;
+  shape_inference::ShapeHandle shape = c->output(index);
+  if (c->Rank(shape) < 1) return -1;
+  return c->Value(c->Dim(shape, 0));
+}
+
+// Returns whether the dimensions of a rank `rank` tensor listed in the value
+// of the constant `n` include dimension 0.
+bool MayIncludeDimZero(const Node* n, int rank) {
+  if (!n->IsConstant() || rank < 0) return true;
+  const TensorProto* proto;
+  Tensor axes;
+  if (!GetNodeAttr(n->attrs(), "value", &proto).ok() ||
+      !axes.FromProto(*proto)) {
+    return true;
+  }
+  for (int64 i = 0; i < axes.NumElements(); ++i) {
+    int64 axis;
+    if (axes.dtype() == DT_INT32) {
+      axis = axes.flat<int32>()(i);
+    } else if (axes.dtype() == DT_INT64) {
+      axis = axes.flat<int64>()(i);
+    } else {
+      return true;
+    }
+    if (axis == 0 || axis == -rank) return true;
+  }
+  return false;
+}
+
+// Returns whether `n` computes row i of its result from row i of its batched
+// inputs, i.e. the inputs that have the rows of the arguments.
+bool IsRowwise(const Node* n, const ShapeRefiner& refiner,
+               const std::vector<bool>& batched) {
+  std::vector<const Edge*> inputs;
+  if (!n->input_edges(&inputs).ok()) return false;
+  auto is_batched = [&batched, &inputs](int i) {
+    return static_cast<bool>(batched[inputs[i]->src()->id()]);
+  };
+  auto rank = [&refiner, &inputs](int i) {
+    return Rank(refiner, inputs[i]->src(), inputs[i]->src_output());
+  };
+
+  if (IsElementwise(n)) {
+    // The batched inputs must have the same rank, and the others must not
+    // broadcast along the rows.
+    int batched_rank = -1;
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (!is_batched(i)) continue;
+      if (rank(i) < 1 || (batched_rank != -1 && rank(i) != batched_rank)) {
+        return false;
+      }
+      batched_rank = rank(i);
+    }
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (is_batched(i)) continue;
+      if (rank(i) < 0 || rank(i) > batched_rank) return false;
+      if (rank(i) == batched_rank &&
+          LeadingDim(refiner, inputs[i]->src(), inputs[i]->src_output()) !=
+              1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  for (int i = 1; i < inputs.size(); ++i) {
+    if (is_batched(i)) return false;
+  }
+  if (IsRowwiseOnFirstInput(n)) {
+    bool transpose_a = false;
+    if (n->type_string() == "MatMul" &&
+        (!GetNodeAttr(n->attrs(), "transpose_a", &transpose_a).ok() ||
+         transpose_a)) {
+      return false;
+    }
+    return rank(0) >= 2;
+  }
+  if (n->type_string() == "Softmax" || n->type_string() == "LogSoftmax") {
+    // Normalizes along the last dimension.
+    return rank(0) >= 2;
+  }
+  if (IsReduction(n)) {
+    return !MayIncludeDimZero(inputs[1]->src(), rank(0));
+  }
+  return false;
+}
+
+// Returns whether row i of the results of `fbody` only depends on row i of
+// its first `arg_shapes.size()` arguments, which have the given shapes. Sets
+// `batched_results` to whether each result has the rows of the arguments.
+bool HasIndependentRows(const FunctionBody& fbody,
+                        const std::vector<PartialTensorShape>& arg_shapes,
+                        std::vector<bool>* batched_results) {
+  const Graph& graph = *fbody.graph;
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  refiner.set_require_shape_inference_fns(false);
+  std::vector<bool> batched(graph.num_node_ids(), false);
+  batched_results->assign(fbody.ret_nodes.size(), false);
+  for (Node* n : order) {
+    if (!n->IsOp()) continue;
+    if (n->IsControlFlow() || !refiner.AddNode(n).ok()) return false;
+    if (n->type_string() == "_Arg") {
+      int index;
+      if (!GetNodeAttr(n->attrs(), "index", &index).ok()) return false;
+      if (index < static_cast<int>(arg_shapes.size())) {
+        shape_inference::InferenceContext* c = refiner.GetContext(n);
+        shape_inference::ShapeHandle shape;
+        if (!c->MakeShapeFromPartialTensorShape(arg_shapes[index], &shape)
+                 .ok() ||
+            !refiner.SetShape(n, 0, shape).ok()) {
+          return false;
+        }
+        batched[n->id()] = true;
+      }
+      continue;
+    }
+    bool has_batched_input = false;
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge() && batched[e->src()->id()]) {
+        has_batched_input = true;
+      }
+    }
+    if (!has_batched_input) continue;
+    if (n->type_string() == "_Retval") {
+      int index;
+      if (!GetNodeAttr(n->attrs(), "index", &index).ok() || index < 0 ||
+          index >= static_cast<int>(batched_results->size())) {
+        return false;
+      }
+      (*batched_results)[index] = true;
+      continue;
+    }
+    if (!IsRowwise(n, refiner, batched)) {
+      VLOG(2) << "Rows are not independent in " << n->DebugString();
+      return false;
+    }
+    batched[n->id()] = true;
+  }
+  return true;
+}
+
+// Returns the CPU device of the task of `device`, which computes the padded
+// sizes.
+string HostDevice(const string& device) {
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed)) return device;
+  parsed.type = DEVICE_CPU;
+  parsed.id = 0;
+  return DeviceNameUtils::ParsedNameToString(parsed);
+}
+
+// Builds the node of `builder`, placed on `device`.
+Status AddNode(const NodeBuilder& builder, const string& device, Graph* graph,
+               Node** node) {
+  TF_RETURN_IF_ERROR(builder.Finalize(graph, node));
+  (*node)->set_requested_device(device);
+  (*node)->set_assigned_device_name(device);
+  return Status::OK();
+}
+
+// Adds an int32 constant, of shape [values.size()] or scalar.
+Status AddInt32Const(const std::vector<int32>& values, bool scalar,
+                     const string& device, Graph* graph, Node** node) {
+  TensorShape shape;
+  if (!scalar) shape.AddDim(values.size());
+  Tensor value(DT_INT32, shape);
+  std::copy(values.begin(), values.end(), value.flat<int32>().data());
+  return AddNode(NodeBuilder(graph->NewName("xla_padding/Const"), "Const")
+                     .Attr("dtype", DT_INT32)
+                     .Attr("value", value),
+                 device, graph, node);
+}
+
+// Pads the arguments of the XlaLaunch node `launch` and slices its batched
+// results. Leaves `launch` unchanged if its rows may not be independent.
+Status PadLaunchNode(Node* launch, const std::vector<int>& buckets,
+                     const FunctionLibraryDefinition& flib_def,
+                     const ShapeRefiner& refiner, Graph* graph) {
+  DataTypeVector constant_dtypes, arg_dtypes;
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(launch->attrs(), "Tconstants", &constant_dtypes));
+  TF_RETURN_IF_ERROR(GetNodeAttr(launch->attrs(), "Targs", &arg_dtypes));
+  if (!constant_dtypes.empty() || arg_dtypes.empty()) return Status::OK();
+
+  std::vector<const Edge*> arg_edges(arg_dtypes.size());
+  std::vector<PartialTensorShape> arg_shapes(arg_dtypes.size());
+  for (int i = 0; i < arg_dtypes.size(); ++i) {
+    TF_RETURN_IF_ERROR(launch->input_edge(i, &arg_edges[i]));
+    const Node* src = arg_edges[i]->src();
+    const int rank = Rank(refiner, src, arg_edges[i]->src_output());
+    if (rank < 1) return Status::OK();
+    shape_inference::InferenceContext* c = refiner.GetContext(src);
+    shape_inference::ShapeHandle shape = c->output(arg_edges[i]->src_output());
+    std::vector<int64> dims(rank);
+    for (int d = 0; d < rank; ++d) {
+      dims[d] = c->Value(c->Dim(shape, d));
+    }
+    // The leading dimension changes with the padding.
+    dims[0] = -1;
+    arg_shapes[i] = PartialTensorShape(dims);
+  }
+
+  const NameAttrList* function;
+  TF_RETURN_IF_ERROR(GetNodeAttr(launch->attrs(), "function", &function));
+  const FunctionDef* fdef = flib_def.Find(function->name());
+  if (fdef == nullptr) return Status::OK();
+  FunctionBody* fbody_ptr;
+  Status s = FunctionDefToBodyHelper(
+      *fdef, AttrSlice(&function->attr()), &flib_def,
+      [&flib_def](const string& op, const OpDef** sig) {
+        return flib_def.LookUpOpDef(op, sig);
+      },
+      &fbody_ptr);
+  if (!s.ok()) {
+    VLOG(1) << "Not padding " << launch->name() << ": " << s;
+    return Status::OK();
+  }
+  std::unique_ptr<FunctionBody> fbody(fbody_ptr);
+  std::vector<bool> batched_results;
+  if (!HasIndependentRows(*fbody, arg_shapes, &batched_results)) {
+    VLOG(1) << "Not padding " << launch->name()
+            << ": its rows may not be independent.";
+    return Status::OK();
+  }
+  VLOG(1) << "Padding the arguments of " << launch->name();
+
+  const string& device = launch->assigned_device_name();
+  const string host_device = HostDevice(device);
+  Node *zero, *begin, *one, *head_shape;
+  TF_RETURN_IF_ERROR(AddInt32Const({0}, true, host_device, graph, &zero));
+  TF_RETURN_IF_ERROR(AddInt32Const({0}, false, host_device, graph, &begin));
+  TF_RETURN_IF_ERROR(AddInt32Const({1}, false, host_device, graph, &one));
+  TF_RETURN_IF_ERROR(
+      AddInt32Const({1, 2}, false, host_device, graph, &head_shape));
+
+  // The leading dimension of each argument, and whether they are all equal.
+  std::vector<Node*> shapes(arg_edges.size());
+  Node* rows = nullptr;
+  Node* same_rows = nullptr;
+  for (int i = 0; i < arg_edges.size(); ++i) {
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/Shape"), "Shape")
+            .Input(arg_edges[i]->src(), arg_edges[i]->src_output()),
+        device, graph, &shapes[i]));
+    Node* arg_rows;
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/Rows"), "StridedSlice")
+            .Input(shapes[i])
+            .Input(begin)
+            .Input(one)
+            .Input(one)
+            .Attr("shrink_axis_mask", 1),
+        host_device, graph, &arg_rows));
+    if (rows == nullptr) {
+      rows = arg_rows;
+      continue;
+    }
+    Node* equal;
+    TF_RETURN_IF_ERROR(
+        AddNode(NodeBuilder(graph->NewName("xla_padding/Equal"), "Equal")
+                    .Input(arg_rows)
+                    .Input(rows),
+                host_device, graph, &equal));
+    if (same_rows == nullptr) {
+      same_rows = equal;
+    } else {
+      TF_RETURN_IF_ERROR(AddNode(
+          NodeBuilder(graph->NewName("xla_padding/LogicalAnd"), "LogicalAnd")
+              .Input(same_rows)
+              .Input(equal),
+          host_device, graph, &same_rows));
+    }
+  }
+
+  // The smallest bucket that fits the rows, or the rows if none does.
+  Node* padded_rows = rows;
+  for (auto it = buckets.rbegin(); it != buckets.rend(); ++it) {
+    Node *bucket, *fits;
+    TF_RETURN_IF_ERROR(AddInt32Const({*it}, true, host_device, graph, &bucket));
+    TF_RETURN_IF_ERROR(
+        AddNode(NodeBuilder(graph->NewName("xla_padding/Fits"), "LessEqual")
+                    .Input(rows)
+                    .Input(bucket),
+                host_device, graph, &fits));
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/Bucket"), "Select")
+            .Input(fits)
+            .Input(bucket)
+            .Input(padded_rows),
+        host_device, graph, &padded_rows));
+  }
+  Node* num_padding_rows;
+  TF_RETURN_IF_ERROR(
+      AddNode(NodeBuilder(graph->NewName("xla_padding/Sub"), "Sub")
+                  .Input(padded_rows)
+                  .Input(rows),
+              host_device, graph, &num_padding_rows));
+  if (same_rows != nullptr) {
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/Select"), "Select")
+            .Input(same_rows)
+            .Input(num_padding_rows)
+            .Input(zero),
+        host_device, graph, &num_padding_rows));
+  }
+  // [[0, num_padding_rows]], the paddings of the leading dimension.
+  Node *head_pack, *head;
+  TF_RETURN_IF_ERROR(AddNode(
+      NodeBuilder(graph->NewName("xla_padding/Pack"), "Pack")
+          .Input(std::vector<NodeBuilder::NodeOut>({zero, num_padding_rows})),
+      host_device, graph, &head_pack));
+  TF_RETURN_IF_ERROR(
+      AddNode(NodeBuilder(graph->NewName("xla_padding/Reshape"), "Reshape")
+                  .Input(head_pack)
+                  .Input(head_shape),
+              host_device, graph, &head));
+
+  for (int i = 0; i < arg_edges.size(); ++i) {
+    // No padding for the other dimensions.
+    Node *tail_shape, *tail_zeros, *tail, *paddings, *pad;
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/TailShape"), "StridedSlice")
+            .Input(shapes[i])
+            .Input(one)
+            .Input(begin)
+            .Input(one)
+            .Attr("end_mask", 1),
+        host_device, graph, &tail_shape));
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/ZerosLike"), "ZerosLike")
+            .Input(tail_shape),
+        host_device, graph, &tail_zeros));
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/Pack"), "Pack")
+            .Input(std::vector<NodeBuilder::NodeOut>({tail_zeros, tail_zeros}))
+            .Attr("axis", 1),
+        host_device, graph, &tail));
+    TF_RETURN_IF_ERROR(AddNode(
+        NodeBuilder(graph->NewName("xla_padding/Paddings"), "ConcatV2")
+            .Input(std::vector<NodeBuilder::NodeOut>({head, tail}))
+            .Input(zero),
+        host_device, graph, &paddings));
+    TF_RETURN_IF_ERROR(
+        AddNode(NodeBuilder(graph->NewName("xla_padding/Pad"), "Pad")
+                    .Input(arg_edges[i]->src(), arg_edges[i]->src_output())
+                    .Input(paddings),
+                device, graph, &pad));
+    const int dst_input = arg_edges[i]->dst_input();
+    graph->RemoveEdge(arg_edges[i]);
+    graph->AddEdge(pad, 0, launch, dst_input);
+  }
+
+  // Slices the rows of the arguments out of the batched results.
+  Node* end;
+  TF_RETURN_IF_ERROR(AddNode(
+      NodeBuilder(graph->NewName("xla_padding/Pack"), "Pack")
+          .Input(std::vector<NodeBuilder::NodeOut>({rows})),
+      host_device, graph, &end));
+  std::vector<std::vector<const Edge*>> out_edges(launch->num_outputs());
+  for (const Edge* e : launch->out_edges()) {
+    if (!e->IsControlEdge()) out_edges[e->src_output()].push_back(e);
+  }
+  for (int i = 0; i < launch->num_outputs(); ++i) {
+    if (!batched_results[i] || out_edges[i].empty()) continue;
+    Node* slice;
+    TF_RETURN_IF_ERROR(
+        AddNode(NodeBuilder(graph->NewName("xla_padding/Slice"),
+                            "StridedSlice")
+                    .Input(launch, i)
+                    .Input(begin)
+                    .Input(end)
+                    .Input(one),
+                device, graph, &slice));
+    for (const Edge* e : out_edges[i]) {
+      Node* dst = e->dst();
+      const int dst_input = e->dst_input();
+      graph->RemoveEdge(e);
+      graph->AddEdge(slice, 0, dst, dst_input);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status XlaLaunchPaddingPass::Run(const GraphOptimizationPassOptions& options) {
+  const string& flag =
+      legacy_flags::GetMarkForCompilationPassFlags()->tf_xla_padding_buckets;
+  if (flag.empty()) {
+    return Status::OK();
+  }
+  std::vector<int> buckets;
+  for (const string& bucket : str_util::Split(flag, ',')) {
+    int32 size;
+    if (!strings::safe_strto32(bucket, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid --tf_xla_padding_buckets: ",
+                                     flag);
+    }
+    buckets.push_back(size);
+  }
+  return RunImpl(options, buckets);
+}
+
+Status XlaLaunchPaddingPass::RunImpl(
+    const GraphOptimizationPassOptions& options,
+    const std::vector<int>& buckets) {
+  Graph* graph = options.graph->get();
+  std::vector<int> sorted_buckets = buckets;
+  std::sort(sorted_buckets.begin(), sorted_buckets.end());
+
+  std::vector<Node*> launch_nodes;
+  for (Node* n : graph->op_nodes()) {
+    if (n->type_string() == "XlaLaunch") launch_nodes.push_back(n);
+  }
+  if (launch_nodes.empty() || sorted_buckets.empty()) {
+    return Status::OK();
+  }
+
+  // The shapes of the arguments. The nodes whose shapes cannot be inferred,
+  // e.g. in loops, are left out.
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  ShapeRefiner refiner(graph->versions(), graph->op_registry());
+  refiner.set_require_shape_inference_fns(false);
+  for (Node* n : order) {
+    if (!n->IsOp() || n->IsControlFlow()) continue;
+    bool inputs_known = true;
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge() && e->src()->IsOp() &&
+          refiner.GetContext(e->src()) == nullptr) {
+        inputs_known = false;
+      }
+    }
+    if (inputs_known) refiner.AddNode(n).IgnoreError();
+  }
+
+  for (Node* launch : launch_nodes) {
+    TF_RETURN_IF_ERROR(PadLaunchNode(launch, sorted_buckets, *options.flib_def,
+                                     refiner, graph));
+  }
+
+  if (VLOG_IS_ON(1)) {
+    dump_graph::DumpGraphToFile("xla_launch_padding", *graph,
+                                options.flib_def);
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_PADDING_PASS_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_PADDING_PASS_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Pass that pads the leading dimension of the arguments of XlaLaunch nodes up
+// to the smallest of a few bucket sizes that fits, and slices the results
+// back, so that a handful of executables cover inputs whose leading dimension
+// (e.g. the batch size) varies between steps.
+//
+// A cluster is only padded if every row of its results only depends on the
+// same row of its arguments, e.g. if it is made of element-wise ops, matrix
+// multiplications by weights, convolutions and reductions over the other
+// dimensions. The padded rows are zeros, and are computed and discarded. Its
+// arguments must have a known rank >= 1, it must not have compile-time
+// constant arguments, and the arguments must all have the same leading
+// dimension at run time, otherwise they are not padded.
+class XlaLaunchPaddingPass : public GraphOptimizationPass {
+ public:
+  XlaLaunchPaddingPass() = default;
+
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+  // Run() just calls RunImpl() with the buckets of --tf_xla_padding_buckets if
+  // it is set. To run the pass unconditionally, call RunImpl() directly.
+  Status RunImpl(const GraphOptimizationPassOptions& options,
+                 const std::vector<int>& buckets);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_PADDING_PASS_H_
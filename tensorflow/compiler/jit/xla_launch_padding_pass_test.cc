@@ -0,0 +1,155 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_launch_padding_pass.h"
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const char kCpuDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+// Builds a graph that feeds a [?, 4] placeholder to an XlaLaunch of
+// `function`, and runs the padding pass on it. Returns the node that consumes
+// the result of the launch.
+Status PadGraph(const FunctionDef& function, std::unique_ptr<Graph>* graph,
+                const Node** consumer) {
+  FunctionDefLibrary library;
+  *library.add_function() = function;
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), library);
+  graph->reset(new Graph(OpRegistry::Global()));
+
+  Node* x;
+  TF_RETURN_IF_ERROR(NodeBuilder("x", "Placeholder")
+                         .Attr("dtype", DT_FLOAT)
+                         .Attr("shape", PartialTensorShape({-1, 4}))
+                         .Finalize(graph->get(), &x));
+  NameAttrList launch_function;
+  launch_function.set_name(function.signature().name());
+  Node* launch;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder("launch", "XlaLaunch")
+          .Input(std::vector<NodeBuilder::NodeOut>())
+          .Input(std::vector<NodeBuilder::NodeOut>({x}))
+          .Input(std::vector<NodeBuilder::NodeOut>())
+          .Attr("Tconstants", DataTypeVector())
+          .Attr("Targs", DataTypeVector({DT_FLOAT}))
+          .Attr("Nresources", 0)
+          .Attr("Tresults", DataTypeVector({DT_FLOAT}))
+          .Attr("function", launch_function)
+          .Finalize(graph->get(), &launch));
+  Node* y;
+  TF_RETURN_IF_ERROR(NodeBuilder("y", "Identity")
+                         .Input(launch, 0)
+                         .Finalize(graph->get(), &y));
+  for (Node* n : (*graph)->nodes()) {
+    n->set_assigned_device_name(kCpuDevice);
+  }
+
+  GraphOptimizationPassOptions options;
+  options.graph = graph;
+  options.flib_def = &flib_def;
+  XlaLaunchPaddingPass pass;
+  TF_RETURN_IF_ERROR(pass.RunImpl(options, {16, 8, 32}));
+  *consumer = y;
+  return Status::OK();
+}
+
+const Node* InputNode(const Node* n, int index) {
+  const Node* input;
+  TF_CHECK_OK(n->input_node(index, &input));
+  return input;
+}
+
+TEST(XlaLaunchPaddingPassTest, PadsIndependentRows) {
+  Tensor weights(DT_FLOAT, TensorShape({4, 3}));
+  test::FillIota<float>(&weights, 0.0f);
+  FunctionDef function = FunctionDefHelper::Define(
+      "Rowwise", {"x: float"}, {"y: float"}, {},
+      {{{"w"}, "Const", {}, {{"dtype", DT_FLOAT}, {"value", weights}}},
+       {{"m"}, "MatMul", {"x", "w"}, {{"T", DT_FLOAT}}},
+       {{"axis"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+       {{"s"},
+        "Sum",
+        {"m", "axis"},
+        {{"T", DT_FLOAT}, {"Tidx", DT_INT32}, {"keep_dims", true}}},
+       {{"y"}, "Sub", {"m", "s"}, {{"T", DT_FLOAT}}}});
+
+  std::unique_ptr<Graph> graph;
+  const Node* y;
+  TF_ASSERT_OK(PadGraph(function, &graph, &y));
+
+  const Node* slice = InputNode(y, 0);
+  EXPECT_EQ("StridedSlice", slice->type_string());
+  const Node* launch = InputNode(slice, 0);
+  EXPECT_EQ("XlaLaunch", launch->type_string());
+  const Node* pad = InputNode(launch, 0);
+  EXPECT_EQ("Pad", pad->type_string());
+  EXPECT_EQ("x", InputNode(pad, 0)->name());
+  EXPECT_EQ(kCpuDevice, pad->assigned_device_name());
+}
+
+TEST(XlaLaunchPaddingPassTest, DoesNotPadReductionOverRows) {
+  FunctionDef function = FunctionDefHelper::Define(
+      "ReduceRows", {"x: float"}, {"y: float"}, {},
+      {{{"axis"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}},
+       {{"y"},
+        "Sum",
+        {"x", "axis"},
+        {{"T", DT_FLOAT}, {"Tidx", DT_INT32}, {"keep_dims", false}}}});
+
+  std::unique_ptr<Graph> graph;
+  const Node* y;
+  TF_ASSERT_OK(PadGraph(function, &graph, &y));
+
+  const Node* launch = InputNode(y, 0);
+  EXPECT_EQ("XlaLaunch", launch->type_string());
+  EXPECT_EQ("x", InputNode(launch, 0)->name());
+}
+
+TEST(XlaLaunchPaddingPassTest, DoesNotPadRowBroadcasts) {
+  // [?, 4] + [1, 4] broadcasts along the rows, but [?, 4] + [4, 4] does not.
+  Tensor row(DT_FLOAT, TensorShape({1, 4}));
+  test::FillIota<float>(&row, 0.0f);
+  Tensor square(DT_FLOAT, TensorShape({4, 4}));
+  test::FillIota<float>(&square, 0.0f);
+  for (const Tensor& value : {row, square}) {
+    FunctionDef function = FunctionDefHelper::Define(
+        "AddConst", {"x: float"}, {"y: float"}, {},
+        {{{"c"}, "Const", {}, {{"dtype", DT_FLOAT}, {"value", value}}},
+         {{"y"}, "Add", {"x", "c"}, {{"T", DT_FLOAT}}}});
+
+    std::unique_ptr<Graph> graph;
+    const Node* y;
+    TF_ASSERT_OK(PadGraph(function, &graph, &y));
+    EXPECT_EQ(value.dim_size(0) == 1 ? "StridedSlice" : "XlaLaunch",
+              InputNode(y, 0)->type_string());
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -234,6 +234,21 @@ void AllocateFlags() {
           int32_setter_for(&DebugOptions::set_xla_gpu_max_kernel_unroll_factor),
           flag_values->xla_gpu_max_kernel_unroll_factor(),
           "Specify the maximum kernel unroll factor for the GPU backend."),
+      tensorflow::Flag(
+          "xla_gpu_persistent_cubin_cache_dir",
+          flag_values->mutable_xla_gpu_persistent_cubin_cache_dir(),
+          "If non-empty, the GPU backend stores the cubins compiled by ptxas "
+          "in this directory, and reuses them across processes."),
+      tensorflow::Flag(
+          "xla_gpu_autotune_results_file",
+          flag_values->mutable_xla_gpu_autotune_results_file(),
+          "If non-empty, the GPU backend loads the autotuning results of "
+          "convolutions and gemms from this file and adds the new ones to it."),
+      tensorflow::Flag(
+          "xla_gpu_autotune_results_preload_file",
+          flag_values->mutable_xla_gpu_autotune_results_preload_file(),
+          "If non-empty, a read-only file of autotuning results that the GPU "
+          "backend loads, e.g. one shared by many machines."),
       tensorflow::Flag(
           "xla_dump_optimized_hlo_proto_to",
           flag_values->mutable_xla_dump_optimized_hlo_proto_to(),
@@ -306,6 +321,21 @@ void AllocateFlags() {
                        bool_setter_for(&DebugOptions::set_xla_cpu_use_mkl_dnn),
                        flag_values->xla_cpu_use_mkl_dnn(),
                        "Generate calls to MKL-DNN in the CPU backend."),
+      tensorflow::Flag(
+          "xla_cpu_parallel_codegen_split_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+          flag_values->xla_cpu_parallel_codegen_split_count(),
+          "If greater than 1, the CPU backend splits the optimized LLVM "
+          "module into up to this many partitions and generates their "
+          "machine code in parallel."),
+      tensorflow::Flag(
+          "xla_cpu_aot_max_parallelism",
+          int32_setter_for(&DebugOptions::set_xla_cpu_aot_max_parallelism),
+          flag_values->xla_cpu_aot_max_parallelism(),
+          "If positive, ahead-of-time compiled CPU code splits large ops "
+          "into parallel tasks for up to this many threads of the intra op "
+          "thread pool."),
   });
   ParseFlagsFromEnv(*flag_objects);
 }
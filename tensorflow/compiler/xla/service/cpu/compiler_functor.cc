@@ -25,6 +25,7 @@ limitations under the License.
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/MCContext.h"
@@ -93,8 +94,7 @@ class FilteredPassManager : public llvm::legacy::PassManager {
 };
 }  // anonymous namespace
 
-std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
-    llvm::Module& module) const {
+void CompilerFunctor::OptimizeModule(llvm::Module& module) const {
   FilteredPassManager module_passes(disable_expensive_passes_);
   FilteredFunctionPassManager function_passes(&module,
                                               disable_expensive_passes_);
@@ -139,16 +139,21 @@ std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
 
   runtime::RewriteIRRuntimeFunctions(&module, enable_fast_math_);
 
-  // Buffer for holding machine code prior to constructing the ObjectFile.
-  llvm::SmallVector<char, 0> stream_buffer;
-  llvm::raw_svector_ostream ostream(stream_buffer);
-
   VLOG(2) << "IR after optimizations";
   XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(module));
 
   if (post_optimization_hook_) {
     TF_CHECK_OK(post_optimization_hook_(module));
   }
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
+    llvm::Module& module) const {
+  OptimizeModule(module);
+
+  // Buffer for holding machine code prior to constructing the ObjectFile.
+  llvm::SmallVector<char, 0> stream_buffer;
+  llvm::raw_svector_ostream ostream(stream_buffer);
 
   // Generate code.
   llvm::MCContext* mc_context;
@@ -161,6 +166,40 @@ std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
       new llvm::SmallVectorMemoryBuffer(std::move(stream_buffer)));
 }
 
+std::vector<std::unique_ptr<llvm::MemoryBuffer>>
+CompilerFunctor::CompileInPartitions(
+    std::unique_ptr<llvm::Module> module, int num_partitions,
+    const std::function<std::unique_ptr<llvm::TargetMachine>()>&
+        target_machine_factory) const {
+  CHECK_GT(num_partitions, 1);
+  // The IR is optimized before splitting, so that the partitioning does not
+  // prevent inlining across functions.
+  OptimizeModule(*module);
+
+  std::vector<llvm::SmallVector<char, 0>> stream_buffers(num_partitions);
+  {
+    std::vector<std::unique_ptr<llvm::raw_svector_ostream>> ostreams;
+    std::vector<llvm::raw_pwrite_stream*> ostream_ptrs;
+    for (auto& stream_buffer : stream_buffers) {
+      ostreams.push_back(MakeUnique<llvm::raw_svector_ostream>(stream_buffer));
+      ostream_ptrs.push_back(ostreams.back().get());
+    }
+    // Each partition is cloned into its own LLVMContext, and its code is
+    // generated by a thread of its own.
+    llvm::splitCodeGen(std::move(module), ostream_ptrs, /*BCOSs=*/{},
+                       target_machine_factory,
+                       llvm::TargetMachine::CGFT_ObjectFile,
+                       /*PreserveLocals=*/false);
+  }
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> object_files;
+  for (auto& stream_buffer : stream_buffers) {
+    object_files.push_back(std::unique_ptr<llvm::MemoryBuffer>(
+        new llvm::SmallVectorMemoryBuffer(std::move(stream_buffer))));
+  }
+  return object_files;
+}
+
 static std::vector<llvm::VecDesc> VectorFunctionsForTargetLibraryInfoImpl() {
   std::vector<llvm::VecDesc> result = {
       {"tanhf", runtime::kTanhV4F32SymbolName, 4},
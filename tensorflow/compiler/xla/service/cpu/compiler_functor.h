@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COMPILER_FUNCTOR_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_COMPILER_FUNCTOR_H_
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Object/ObjectFile.h"
@@ -50,7 +54,20 @@ class CompilerFunctor {
   std::unique_ptr<llvm::MemoryBuffer> operator()(
       llvm::Module& module) const;  // NOLINT
 
+  // Compile a Module to one ObjectFile per partition. The module is optimized
+  // as a whole, then split into num_partitions partitions whose machine code
+  // is generated in parallel, each with a TargetMachine returned by
+  // target_machine_factory. The symbols referenced across partitions are
+  // external with hidden visibility, and must be resolved by the linker.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> CompileInPartitions(
+      std::unique_ptr<llvm::Module> module, int num_partitions,
+      const std::function<std::unique_ptr<llvm::TargetMachine>()>&
+          target_machine_factory) const;
+
  private:
+  // Runs the hooks and the IR optimization passes on the module.
+  void OptimizeModule(llvm::Module& module) const;  // NOLINT
+
   // Populates the given pass manager with TargetLibraryInfo and
   // TargetTransformInfo passes.
   void AddTargetInfoPasses(llvm::legacy::PassManagerBase* passes) const;
@@ -314,18 +314,22 @@ Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
   pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
   pipeline.AddPass<HloElementTypeConverter>(BF16, F32);
   // Outline ops in the entry computation into calls to subcomputations.
-  const int max_parallelism =
+  int max_parallelism =
       module->config().intra_op_parallelism_threads() > 0
           ? module->config().intra_op_parallelism_threads()
           : tensorflow::port::NumSchedulableCPUs();
-  if (!is_aot_compile) {
+  if (is_aot_compile) {
+    // Parallel tasks bring in thread pool and thread synchronization
+    // dependencies which increase binary size, and the threads of the target
+    // are unknown, so AOT compilation only assigns them on request.
+    max_parallelism =
+        module->config().debug_options().xla_cpu_aot_max_parallelism();
+  }
+  if (max_parallelism > 0) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
-    // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
-        max_parallelism, ShapeSizeBytesFunction(), &target_machine_features);
+        max_parallelism * options::ParallelTasksPerThread(module->config()),
+        ShapeSizeBytesFunction(), &target_machine_features);
   }
   // Copy insertion should be performed immediately before IR emission to avoid
   // inserting unnecessary copies (later pass adds an instruction which
@@ -520,6 +524,7 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
       options::OptimizeForSizeRequested(module->config()),
       module->config().debug_options().xla_enable_fast_math(),
       module->config().debug_options().xla_llvm_disable_expensive_passes(),
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count(),
       pre_optimization_ir_hook, post_optimization_ir_hook);
   llvm_module->setDataLayout(jit->data_layout());
   llvm_module->setTargetTriple(jit->target_triple().getTriple());
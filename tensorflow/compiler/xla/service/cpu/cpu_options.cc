@@ -26,6 +26,8 @@ const char* const kLlvmIrDotTilingFactor = "xla_llvm_dot_tiling_factor";
 const char* const kXlaEnableExperimentalLlvmIrGemm =
     "xla_enable_experimental_llvm_ir_gemm";
 const char* const kLlvmIrGemmTileSize = "xla_llvm_ir_gemm_tile_size";
+const char* const kXlaCpuParallelTasksPerThread =
+    "xla_cpu_parallel_tasks_per_thread";
 
 }  // namespace
 
@@ -64,6 +66,19 @@ bool EnableExperimentalLlvmIrGemm(const HloModuleConfig& config) {
   return extra_options_map.count(kXlaEnableExperimentalLlvmIrGemm) > 0;
 }
 
+int64 ParallelTasksPerThread(const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  auto it = extra_options_map.find(kXlaCpuParallelTasksPerThread);
+  int64 tasks_per_thread;
+  if (it != extra_options_map.end() &&
+      tensorflow::strings::safe_strto64(it->second, &tasks_per_thread) &&
+      tasks_per_thread > 0) {
+    return tasks_per_thread;
+  }
+  return 1;
+}
+
 static tensorflow::StringPiece RemoveSuffix(tensorflow::StringPiece str,
                                             tensorflow::StringPiece suffix) {
   CHECK_GE(str.size(), suffix.size());
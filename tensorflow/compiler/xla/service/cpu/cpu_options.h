@@ -31,6 +31,9 @@ tensorflow::gtl::optional<int64> LlvmIrGemvTilingFactor(
     const HloModuleConfig& config);
 tensorflow::gtl::optional<std::tuple<int64, int64, int64>> LlvmIrGemmTileSize(
     const HloModuleConfig& config);
+// The maximum number of parallel tasks per thread of an instruction. More
+// tasks than threads balance the load when some threads are busy.
+int64 ParallelTasksPerThread(const HloModuleConfig& config);
 
 }  // namespace options
 }  // namespace cpu
@@ -15,14 +15,17 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
 #include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
@@ -237,5 +240,44 @@ INSTANTIATE_TEST_CASE_P(MKLMatMulTestInstantiaion, MKLMatMulTest,
                         MKLMatMulTest::Name);
 #endif  // INTEL_MKL
 
+// Counts the runs of the partitions. Called by ParallelForkJoin.
+void CountPartition(void* result, const void* run_options, const void** params,
+                    void** temps, int64* partition, uint64* prof_counters) {
+  auto* counts = static_cast<std::atomic<int>*>(result);
+  for (int64 i = partition[0]; i < partition[1]; ++i) {
+    counts[i].fetch_add(1);
+  }
+}
+
+TEST_F(CpuRuntimeTest, ParallelForkJoinRunsEachPartitionOnce) {
+  // More partitions than threads, so that the workers run several.
+  const int kNumPartitions = 64;
+  tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(), "XLAEigen",
+                                      4);
+  tensorflow::EigenThreadPoolWrapper tp(&pool);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+
+  std::vector<int64> partitions;
+  for (int64 i = 0; i < kNumPartitions; ++i) {
+    partitions.push_back(i);
+    partitions.push_back(i + 1);
+  }
+  for (int run = 0; run < 10; ++run) {
+    std::vector<std::atomic<int>> counts(kNumPartitions);
+    for (auto& count : counts) {
+      count = 0;
+    }
+    __xla_cpu_runtime_ParallelForkJoin(
+        counts.data(), &run_options, nullptr, nullptr, nullptr, kNumPartitions,
+        partitions.data(), /*num_partitioned_dims=*/1,
+        reinterpret_cast<void*>(&CountPartition));
+    for (int i = 0; i < kNumPartitions; ++i) {
+      EXPECT_EQ(1, counts[i].load()) << "partition " << i;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xla
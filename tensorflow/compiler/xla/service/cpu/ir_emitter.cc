@@ -227,6 +227,14 @@ Status IrEmitter::HandleCopy(HloInstruction* copy) {
     TF_RETURN_IF_ERROR(EmitTargetAddressForOp(copy));
     return EmitMemcpy(*(copy->operand(0)), *copy);
   } else if (ShapeUtil::IsArray(copy->shape())) {
+    string tiling_failure_reason;
+    TF_ASSIGN_OR_RETURN(bool tiling_successful,
+                        EmitTiledTranspose(copy, &tiling_failure_reason));
+    if (tiling_successful) {
+      return Status::OK();
+    }
+    VLOG(2) << "Could not tile copy " << copy->ToString() << ": "
+            << tiling_failure_reason;
     // Use the elemental emitter for array shapes.
     return DefaultAction(copy);
   }
@@ -235,6 +243,91 @@ Status IrEmitter::HandleCopy(HloInstruction* copy) {
       PrimitiveType_Name(copy->shape().element_type()).c_str());
 }
 
+StatusOr<bool> IrEmitter::EmitTiledTranspose(HloInstruction* copy,
+                                             string* failure_reason) {
+  // The tiles are square and one cache line wide.
+  constexpr int64 kTileSizeInBytes = 64;
+
+  const Shape& shape = copy->shape();
+  const Shape& operand_shape = copy->operand(0)->shape();
+  if (ShapeUtil::Rank(shape) != 2) {
+    *failure_reason = "copy is not rank 2";
+    return false;
+  }
+  const int64 minor_dimension = LayoutUtil::Minor(shape.layout(), 0);
+  const int64 major_dimension = LayoutUtil::Minor(shape.layout(), 1);
+  if (LayoutUtil::Minor(operand_shape.layout(), 0) == minor_dimension) {
+    *failure_reason = "copy does not transpose its operand";
+    return false;
+  }
+  if (ShouldEmitParallelLoopFor(*copy)) {
+    *failure_reason = "cannot tile a copy for the parallel CPU backend";
+    return false;
+  }
+  const int64 tile_size =
+      kTileSizeInBytes /
+      ShapeUtil::ByteSizeOfPrimitiveType(shape.element_type());
+  const int64 major_size = shape.dimensions(major_dimension);
+  const int64 minor_size = shape.dimensions(minor_dimension);
+  if (tile_size < 2 || major_size < tile_size || minor_size < tile_size) {
+    *failure_reason = "copy is smaller than a tile";
+    return false;
+  }
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(copy));
+  llvm_ir::IrArray source_array(GetIrArrayFor(copy->operand(0)));
+  llvm_ir::IrArray target_array(GetIrArrayFor(copy));
+
+  //  for (t0 in major dimension with stride T) {
+  //    for (t1 in minor dimension with stride T) {
+  //      for (i in [t0, min(t0 + T, major_size))) {
+  //        for (j in [t1, min(t1 + T, minor_size))) {
+  //          output[i, j] = input[i, j]
+  //        }
+  //      }
+  //    }
+  //  }
+  llvm_ir::ForLoopNest tile_loops(IrName(copy, "tile"), &ir_builder_);
+  std::unique_ptr<llvm_ir::ForLoop> major_tile_loop =
+      tile_loops.AddLoop(0, major_size, tile_size, "major_dim");
+  std::unique_ptr<llvm_ir::ForLoop> minor_tile_loop =
+      tile_loops.AddLoop(0, minor_size, tile_size, "minor_dim");
+  SetToFirstInsertPoint(tile_loops.GetInnerLoopBodyBasicBlock(), &ir_builder_);
+
+  // The bounds of the last tile in each dimension are clamped to the size of
+  // the dimension.
+  auto tile_end = [&](llvm::Value* tile_start, int64 dimension_size) {
+    llvm::Value* end =
+        ir_builder_.CreateAdd(tile_start, ir_builder_.getInt64(tile_size));
+    llvm::Value* size = ir_builder_.getInt64(dimension_size);
+    return ir_builder_.CreateSelect(ir_builder_.CreateICmpSLT(end, size), end,
+                                    size);
+  };
+  llvm::Value* major_end =
+      tile_end(major_tile_loop->GetIndVarValue(), major_size);
+  llvm::Value* minor_end =
+      tile_end(minor_tile_loop->GetIndVarValue(), minor_size);
+
+  std::unique_ptr<llvm_ir::ForLoop> major_loop = llvm_ir::ForLoop::EmitForLoop(
+      IrName(copy, "major_dim"), major_tile_loop->GetIndVarValue(), major_end,
+      ir_builder_.getInt64(1), &ir_builder_);
+  SetToFirstInsertPoint(major_loop->GetBodyBasicBlock(), &ir_builder_);
+  std::unique_ptr<llvm_ir::ForLoop> minor_loop = llvm_ir::ForLoop::EmitForLoop(
+      IrName(copy, "minor_dim"), minor_tile_loop->GetIndVarValue(), minor_end,
+      ir_builder_.getInt64(1), &ir_builder_);
+  SetToFirstInsertPoint(minor_loop->GetBodyBasicBlock(), &ir_builder_);
+
+  llvm_ir::IrArray::Index index(2);
+  index[major_dimension] = major_loop->GetIndVarValue();
+  index[minor_dimension] = minor_loop->GetIndVarValue();
+  target_array.EmitWriteArrayElement(
+      index, source_array.EmitReadArrayElement(index, &ir_builder_),
+      &ir_builder_);
+
+  SetToFirstInsertPoint(tile_loops.GetOuterLoopExitBasicBlock(), &ir_builder_);
+  return true;
+}
+
 // Calculate the alignment of a buffer allocated for a given primitive type.
 int IrEmitter::MinimumAlignmentForPrimitiveType(PrimitiveType primitive_type) {
   int64 byte_size = ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
@@ -1656,9 +1749,9 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type()));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
-    return false;
+    return EmitVectorizedReduceOverMinorDimension(
+        reduce, arg, init_value, dimensions, reduction_generator,
+        vectorization_factor, element_alignment, failure_reason);
   }
 
   CHECK(!ShapeUtil::IsTuple(reduce->shape()));
@@ -1772,6 +1865,174 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   return true;
 }
 
+StatusOr<bool> IrEmitter::EmitVectorizedReduceOverMinorDimension(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    gtl::ArraySlice<int64> dimensions,
+    const ReductionGenerator& reduction_generator, int vectorization_factor,
+    unsigned element_alignment, string* failure_reason) {
+  const int64 minor_dimension = LayoutUtil::Minor(arg->shape().layout(), 0);
+  const int64 minor_dimension_size = arg->shape().dimensions(minor_dimension);
+  if (vectorization_factor < 2 ||
+      (vectorization_factor & (vectorization_factor - 1)) != 0) {
+    *failure_reason = "vectorization factor is not a power of two";
+    return false;
+  }
+  if (minor_dimension_size < vectorization_factor) {
+    *failure_reason = "minor dimension is smaller than a vector";
+    return false;
+  }
+
+  // Every output element is computed independently, so the reduction can go
+  // through EmitTargetElementLoop and still be split by the parallel CPU
+  // backend.  For each output element we emit:
+  //
+  //  vector_acc = splat(init)
+  //  scalar_acc = init
+  //  for (r in the other reduced dimensions R) {
+  //    for (m in [0, VM) with stride VS) {
+  //      vector_acc = reduce(vector_acc, input[..., r, m:m+VS])
+  //    }
+  //    for (m in [VM, M)) {
+  //      scalar_acc = reduce(scalar_acc, input[..., r, m])
+  //    }
+  //  }
+  //  output[...] = reduce(horizontal_reduce(vector_acc), scalar_acc)
+  //
+  // where M is the size of the minor dimension, VS is the vectorization stride
+  // and VM is M rounded down to a multiple of VS.  Splatting the init value
+  // into every lane is fine because XLA requires it to be an identity of the
+  // reduction function.
+  std::vector<int64> other_dimensions;
+  for (int64 dimension : dimensions) {
+    if (dimension != minor_dimension) {
+      other_dimensions.push_back(dimension);
+    }
+  }
+  const int64 vectorized_size =
+      (minor_dimension_size / vectorization_factor) * vectorization_factor;
+  llvm::Type* element_ir_type =
+      llvm_ir::PrimitiveTypeToIrType(reduce->shape().element_type(), module_);
+  llvm::Type* vector_ir_type =
+      llvm::VectorType::get(element_ir_type, vectorization_factor);
+
+  TF_RETURN_IF_ERROR(EmitTargetElementLoop(
+      reduce, [&](const llvm_ir::IrArray::Index& index) {
+        llvm::Value* init_value_ssa =
+            ir_builder_.CreateLoad(GetEmittedValueFor(init_value));
+        llvm::AllocaInst* vector_accumulator =
+            llvm_ir::EmitAllocaAtFunctionEntry(
+                vector_ir_type, "vector_accumulator", &ir_builder_,
+                element_alignment);
+        llvm::AllocaInst* scalar_accumulator =
+            llvm_ir::EmitAllocaAtFunctionEntry(element_ir_type,
+                                               "scalar_accumulator",
+                                               &ir_builder_, element_alignment);
+        ir_builder_.CreateAlignedStore(
+            ir_builder_.CreateVectorSplat(vectorization_factor,
+                                          init_value_ssa),
+            vector_accumulator, element_alignment);
+        ir_builder_.CreateAlignedStore(init_value_ssa, scalar_accumulator,
+                                       element_alignment);
+
+        llvm_ir::ForLoopNest reduction_loops(IrName(reduce, "inner"),
+                                             &ir_builder_);
+        const llvm_ir::IrArray::Index reduced_dims_index =
+            reduction_loops.AddLoopsForShapeOnDimensions(
+                arg->shape(), other_dimensions, "reduction_dim");
+        if (llvm::BasicBlock* innermost_body_bb =
+                reduction_loops.GetInnerLoopBodyBasicBlock()) {
+          SetToFirstInsertPoint(innermost_body_bb, &ir_builder_);
+        }
+
+        // Fills in the dimensions that are not reduced from the output index,
+        // as in the scalar lowering in HandleReduce.
+        llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+        auto input_address_for = [&](llvm::Value* minor_index) {
+          llvm_ir::IrArray::Index input_index = reduced_dims_index;
+          input_index[minor_dimension] = minor_index;
+          llvm_ir::IrArray::Index::const_iterator it = index.begin();
+          for (size_t i = 0; i < input_index.size(); ++i) {
+            if (input_index[i] == nullptr) {
+              input_index[i] = *it++;
+            }
+          }
+          CHECK(index.end() == it);
+          return arg_array.EmitArrayElementAddress(input_index, &ir_builder_);
+        };
+
+        llvm_ir::ForLoopNest vector_loop(IrName(reduce, "vectorized"),
+                                         &ir_builder_);
+        std::unique_ptr<llvm_ir::ForLoop> loop =
+            vector_loop.AddLoop(0, vectorized_size, vectorization_factor,
+                                "minor_dim");
+        SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &ir_builder_);
+        llvm::Value* vector_address = ir_builder_.CreateBitCast(
+            input_address_for(loop->GetIndVarValue()),
+            vector_ir_type->getPointerTo());
+        llvm::LoadInst* vector_value =
+            ir_builder_.CreateAlignedLoad(vector_address, element_alignment);
+        arg_array.AnnotateLoadStoreInstructionWithMetadata(vector_value);
+        ir_builder_.CreateAlignedStore(
+            reduction_generator(&ir_builder_,
+                                ir_builder_.CreateAlignedLoad(
+                                    vector_accumulator, element_alignment),
+                                vector_value),
+            vector_accumulator, element_alignment);
+        SetToFirstInsertPoint(vector_loop.GetOuterLoopExitBasicBlock(),
+                              &ir_builder_);
+
+        if (vectorized_size < minor_dimension_size) {
+          llvm_ir::ForLoopNest epilogue_loop(IrName(reduce, "epilogue"),
+                                             &ir_builder_);
+          loop = epilogue_loop.AddLoop(vectorized_size, minor_dimension_size,
+                                       "minor_dim");
+          SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &ir_builder_);
+          llvm::LoadInst* scalar_value = ir_builder_.CreateAlignedLoad(
+              input_address_for(loop->GetIndVarValue()), element_alignment);
+          arg_array.AnnotateLoadStoreInstructionWithMetadata(scalar_value);
+          ir_builder_.CreateAlignedStore(
+              reduction_generator(&ir_builder_,
+                                  ir_builder_.CreateAlignedLoad(
+                                      scalar_accumulator, element_alignment),
+                                  scalar_value),
+              scalar_accumulator, element_alignment);
+          SetToFirstInsertPoint(epilogue_loop.GetOuterLoopExitBasicBlock(),
+                                &ir_builder_);
+        }
+
+        if (llvm::BasicBlock* outermost_exit_bb =
+                reduction_loops.GetOuterLoopExitBasicBlock()) {
+          SetToFirstInsertPoint(outermost_exit_bb, &ir_builder_);
+        }
+
+        // Reduces the vector accumulator by halves: on every step the upper
+        // half of the remaining lanes is combined with the lower half.
+        llvm::Value* accumulator = ir_builder_.CreateAlignedLoad(
+            vector_accumulator, element_alignment);
+        for (int width = vectorization_factor; width > 1; width /= 2) {
+          llvm::SmallVector<llvm::Constant*, 32> low_mask, high_mask;
+          for (int i = 0; i < width / 2; ++i) {
+            low_mask.push_back(ir_builder_.getInt32(i));
+            high_mask.push_back(ir_builder_.getInt32(width / 2 + i));
+          }
+          llvm::Value* undef = llvm::UndefValue::get(accumulator->getType());
+          accumulator = reduction_generator(
+              &ir_builder_,
+              ir_builder_.CreateShuffleVector(
+                  accumulator, undef, llvm::ConstantVector::get(low_mask)),
+              ir_builder_.CreateShuffleVector(
+                  accumulator, undef, llvm::ConstantVector::get(high_mask)));
+        }
+        return reduction_generator(
+            &ir_builder_,
+            ir_builder_.CreateExtractElement(accumulator,
+                                             ir_builder_.getInt32(0)),
+            ir_builder_.CreateAlignedLoad(scalar_accumulator,
+                                          element_alignment));
+      }));
+  return true;
+}
+
 Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto arg = reduce->mutable_operand(0);
   auto init_value = reduce->mutable_operand(1);
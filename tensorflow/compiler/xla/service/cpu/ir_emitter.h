@@ -377,6 +377,24 @@ class IrEmitter : public DfsHloVisitorWithDefault {
       HloInstruction* arg, tensorflow::gtl::ArraySlice<int64> dimensions,
       unsigned element_alignment);
 
+  // Emits a vectorized reduction over the minor dimension of "arg", possibly
+  // along with other dimensions.  Each output element is accumulated into a
+  // vector which is reduced horizontally at the end.  Helper function for
+  // EmitVectorizedReduce.
+  StatusOr<bool> EmitVectorizedReduceOverMinorDimension(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      tensorflow::gtl::ArraySlice<int64> dimensions,
+      const ReductionGenerator& reduction_generator, int vectorization_factor,
+      unsigned element_alignment, string* failure_reason);
+
+  // Tries to emit a rank 2 copy that transposes the layout of its operand as
+  // a loop over square tiles, so that both the loads and the stores of a tile
+  // stay in cache.  Returns true if successful, and false on failure.  On
+  // failure, sets "failure_reason" to a string describing why it could not
+  // emit a tiled transpose.
+  StatusOr<bool> EmitTiledTranspose(HloInstruction* copy,
+                                    string* failure_reason);
+
   // Tries to emit a fast concatenate operation using memcpy.  Returns true if
   // successful, and false on failure.  On failure, sets "failure_reason" to a
   // string describing why it could not emit a fast concatenate.
@@ -17,6 +17,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
@@ -30,9 +34,28 @@ using tensorflow::uint64;
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      int64*, uint64*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchonize threads after parallel calls complete.
+namespace {
+
+// The state shared by the workers of a ParallelForkJoin call. It is reference
+// counted because the workers that start after all the partitions are done
+// may outlive the call.
+struct ForkJoinState {
+  explicit ForkJoinState(int32 num_partitions)
+      : next_partition(0), num_pending(num_partitions) {}
+
+  // The index of the next partition to run.
+  std::atomic<int32> next_partition;
+  tensorflow::BlockingCounter num_pending;
+};
+
+}  // namespace
+
+// Runs the 'num_partitions' calls to 'function_ptr' on up to one worker per
+// thread of the intra op thread pool, plus the calling thread. The workers
+// take the next partition that no one has started until there are none left,
+// so the partitions are balanced between the threads that are available,
+// and the calling thread runs them all if the thread pool is busy. Returns
+// when all the partitions are done.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -74,24 +97,37 @@ void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64 stride = 2 * num_partitioned_dims;
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32 i = 1; i < num_partitions; ++i) {
-    const int64 offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, params, temps, prof_counters,
-         partitions, offset, &bc]() {
-          function(result_ptr, run_options_ptr, params, temps,
-                   &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
-  }
+  auto state = std::make_shared<ForkJoinState>(num_partitions);
+  // Runs partitions until there are none left. The arguments of 'function'
+  // are only used while a partition is pending, i.e. while this call has not
+  // returned.
+  auto run_partitions = [state, num_partitions, function, result_ptr,
+                         run_options_ptr, params, temps, prof_counters,
+                         partitions, stride]() {
+    for (;;) {
+      const int32 i = state->next_partition.fetch_add(1);
+      if (i >= num_partitions) {
+        break;
+      }
+      function(result_ptr, run_options_ptr, params, temps,
+               &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      state->num_pending.DecrementCount();
+    }
+  };
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, temps, &partitions[0],
-           prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  // Dispatch workers to the thread pool, the calling thread being one of them.
+  // Ahead-of-time compiled code may run without a thread pool.
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options->intra_op_thread_pool();
+  const int32 num_workers =
+      thread_pool == nullptr
+          ? 1
+          : std::min<int32>(num_partitions, thread_pool->numThreads() + 1);
+  for (int32 i = 1; i < num_workers; ++i) {
+    thread_pool->enqueueNoNotification(run_partitions);
+  }
+  run_partitions();
+  state->num_pending.Wait();
   VLOG(2) << "ParallelForkJoin EXIT";
 }
@@ -94,11 +94,20 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions& target_options,
                            llvm::CodeGenOpt::Level opt_level,
                            bool optimize_for_size, bool enable_fast_math,
                            bool disable_expensive_passes,
+                           int parallel_codegen_split_count,
                            LLVMCompiler::ModuleHook pre_optimization_hook,
                            LLVMCompiler::ModuleHook post_optimization_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      parallel_codegen_split_count_(parallel_codegen_split_count),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       disassembler_(*target_machine_),
       data_layout_(target_machine_->createDataLayout()),
+      compiler_functor_(target_machine_.get(), &disassembler_, opt_level,
+                        optimize_for_size, enable_fast_math,
+                        disable_expensive_passes,
+                        std::move(pre_optimization_hook),
+                        std::move(post_optimization_hook)),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](const std::string& name) -> llvm::JITSymbol {
@@ -116,12 +125,7 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions& target_options,
                       result.Resolver = symbol_resolver_;
                       return result;
                     }),
-      compile_layer_(object_layer_,
-                     CompilerFunctor(target_machine_.get(), &disassembler_,
-                                     opt_level, optimize_for_size,
-                                     enable_fast_math, disable_expensive_passes,
-                                     std::move(pre_optimization_hook),
-                                     std::move(post_optimization_hook))) {
+      compile_layer_(object_layer_, compiler_functor_) {
   VLOG(1) << "CPU target: " << target_machine_->getTargetCPU().str()
           << " features: " << target_machine_->getTargetFeatureString().str();
 }
@@ -136,6 +140,10 @@ llvm::JITSymbol SimpleOrcJIT::ResolveRuntimeSymbol(const std::string& name) {
 
   void* func_addr = CustomCallTargetRegistry::Global()->Lookup(name);
   if (func_addr == nullptr) {
+    // The partitions of a module reference each other's hidden symbols.
+    if (!partition_keys_.empty()) {
+      return object_layer_.findSymbol(name, /*ExportedSymbolsOnly=*/false);
+    }
     return nullptr;
   }
   llvm::JITEvaluatedSymbol symbol_info(reinterpret_cast<uint64_t>(func_addr),
@@ -145,13 +153,49 @@ llvm::JITSymbol SimpleOrcJIT::ResolveRuntimeSymbol(const std::string& name) {
 
 SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
     std::unique_ptr<llvm::Module> module) {
+  if (parallel_codegen_split_count_ > 1) {
+    return AddModuleInPartitions(std::move(module));
+  }
   auto key = execution_session_.allocateVModule();
   cantFail(compile_layer_.addModule(key, std::move(module)));
   module_keys_.push_back(key);
   return key;
 }
 
+SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModuleInPartitions(
+    std::unique_ptr<llvm::Module> module) {
+  // The TargetMachine is not thread-safe, so each partition uses its own.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> object_files =
+      compiler_functor_.CompileInPartitions(
+          std::move(module), parallel_codegen_split_count_, [this]() {
+            return InferTargetMachineForJIT(target_options_, opt_level_);
+          });
+
+  std::vector<VModuleKeyT> keys;
+  for (auto& object_file : object_files) {
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object_file)));
+    module_keys_.push_back(key);
+    keys.push_back(key);
+  }
+  CHECK(!keys.empty());
+  const VModuleKeyT module_key = keys.front();
+  partition_keys_[module_key] = std::move(keys);
+  return module_key;
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
+  auto it = partition_keys_.find(key);
+  if (it != partition_keys_.end()) {
+    for (VModuleKeyT partition_key : it->second) {
+      module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(),
+                                     partition_key),
+                         module_keys_.end());
+      cantFail(object_layer_.removeObject(partition_key));
+    }
+    partition_keys_.erase(it);
+    return;
+  }
   module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
                      module_keys_.end());
   cantFail(compile_layer_.removeModule(key));
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_SIMPLE_ORC_JIT_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_SIMPLE_ORC_JIT_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,7 +41,8 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
+// Supports JIT-ing multiple modules but without cross-module linking, except
+// between the partitions of a module whose code is generated in parallel.
 // Implements eager compilation - the module is lowered to binary as soon as
 // it's added to the JIT.
 class SimpleOrcJIT {
@@ -60,6 +62,8 @@ class SimpleOrcJIT {
   // optimize to reduce code size, potentially at the cost of performance.
   // The |disable_expensive_passes| parameter will disable certain optimization
   // passes
+  // The |parallel_codegen_split_count| parameter, if greater than 1, is the
+  // number of partitions whose machine code is generated in parallel.
   // The |pre_optimization_hook| is invoked on the module before any IR
   // level optimizations are applied.
   // The |post_optimization_hook| is invoked on the module after all IR
@@ -67,6 +71,7 @@ class SimpleOrcJIT {
   SimpleOrcJIT(const llvm::TargetOptions& target_options,
                llvm::CodeGenOpt::Level opt_level, bool optimize_for_size,
                bool enable_fast_math, bool disable_expensive_passes,
+               int parallel_codegen_split_count,
                LLVMCompiler::ModuleHook pre_optimization_hook,
                LLVMCompiler::ModuleHook post_optimization_hook);
 
@@ -104,10 +109,21 @@ class SimpleOrcJIT {
  private:
   llvm::JITSymbol ResolveRuntimeSymbol(const std::string& name);
 
+  // Compiles the module in parallel_codegen_split_count_ partitions and adds
+  // the object files to the object layer.
+  VModuleKeyT AddModuleInPartitions(std::unique_ptr<llvm::Module> module);
+
   std::vector<VModuleKeyT> module_keys_;
+  // The keys of the object files of the modules compiled in partitions,
+  // indexed by the key returned by AddModule.
+  std::map<VModuleKeyT, std::vector<VModuleKeyT>> partition_keys_;
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const int parallel_codegen_split_count_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const Disassembler disassembler_;
   const llvm::DataLayout data_layout_;
+  const CompilerFunctor compiler_functor_;
   llvm::orc::ExecutionSession execution_session_;
   std::shared_ptr<llvm::orc::SymbolResolver> symbol_resolver_;
   ObjLayerT object_layer_;
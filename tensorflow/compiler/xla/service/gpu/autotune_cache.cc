@@ -0,0 +1,151 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+/* static */ AutotuneCache* AutotuneCache::Global() {
+  static AutotuneCache* cache = new AutotuneCache();
+  return cache;
+}
+
+/* static */ string AutotuneCache::DeviceKey(se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& description =
+      stream_exec->GetDeviceDescription();
+  int cc_major = 0;
+  int cc_minor = 0;
+  description.cuda_compute_capability(&cc_major, &cc_minor);
+  string cudnn_version = "none";
+  if (auto* dnn = stream_exec->AsDnn()) {
+    auto version = dnn->GetVersion();
+    if (version.ok()) {
+      auto& version_info = version.ValueOrDie();
+      cudnn_version = tensorflow::strings::StrCat(
+          version_info.major_version(), ".", version_info.minor_version(), ".",
+          version_info.patch());
+    }
+  }
+  return tensorflow::strings::StrCat(
+      description.name(), "|sm_", cc_major, cc_minor, "|driver ",
+      description.driver_version(), "|cudnn ", cudnn_version);
+}
+
+bool AutotuneCache::Find(const string& device, const string& problem,
+                         AutotuneResult* result) const {
+  tensorflow::mutex_lock lock(mu_);
+  auto it = results_.find(std::make_pair(device, problem));
+  if (it == results_.end()) {
+    return false;
+  }
+  *result = it->second;
+  return true;
+}
+
+void AutotuneCache::Insert(const AutotuneResult& result) {
+  tensorflow::mutex_lock lock(mu_);
+  results_[std::make_pair(result.device(), result.problem())] = result;
+  dirty_ = true;
+}
+
+Status AutotuneCache::Load(const string& path) {
+  {
+    tensorflow::mutex_lock lock(mu_);
+    if (!loaded_paths_.insert(path).second) {
+      return Status::OK();
+    }
+  }
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return Status::OK();
+  }
+  AutotuneResults results;
+  TF_RETURN_IF_ERROR(tensorflow::ReadBinaryProto(env, path, &results));
+  tensorflow::mutex_lock lock(mu_);
+  for (const AutotuneResult& result : results.results()) {
+    results_.insert(
+        {std::make_pair(result.device(), result.problem()), result});
+  }
+  VLOG(1) << "Loaded " << results.results_size()
+          << " autotuning results from " << path;
+  return Status::OK();
+}
+
+Status AutotuneCache::Save(const string& path) {
+  {
+    tensorflow::mutex_lock lock(mu_);
+    if (!dirty_) {
+      return Status::OK();
+    }
+  }
+  tensorflow::Env* env = tensorflow::Env::Default();
+  // Keeps the results that other processes saved since this one loaded the
+  // file.
+  AutotuneResults saved_results;
+  if (env->FileExists(path).ok()) {
+    TF_RETURN_IF_ERROR(tensorflow::ReadBinaryProto(env, path, &saved_results));
+  }
+  AutotuneResults results;
+  {
+    tensorflow::mutex_lock lock(mu_);
+    for (const AutotuneResult& result : saved_results.results()) {
+      results_.insert(
+          {std::make_pair(result.device(), result.problem()), result});
+    }
+    for (const auto& entry : results_) {
+      *results.add_results() = entry.second;
+    }
+    dirty_ = false;
+  }
+  const string tmp_path =
+      tensorflow::strings::StrCat(path, ".tmp.", env->NowMicros());
+  TF_RETURN_IF_ERROR(tensorflow::WriteBinaryProto(env, tmp_path, results));
+  return env->RenameFile(tmp_path, path);
+}
+
+void AutotuneCache::LoadFiles(const DebugOptions& options) {
+  for (const string& path : {options.xla_gpu_autotune_results_preload_file(),
+                             options.xla_gpu_autotune_results_file()}) {
+    if (path.empty()) {
+      continue;
+    }
+    Status status = Load(path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Couldn't load the autotuning results from " << path
+                   << ": " << status;
+    }
+  }
+}
+
+void AutotuneCache::SaveFile(const DebugOptions& options) {
+  const string& path = options.xla_gpu_autotune_results_file();
+  if (path.empty()) {
+    return;
+  }
+  Status status = Save(path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Couldn't save the autotuning results to " << path << ": "
+                 << status;
+  }
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,92 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_H_
+
+#include <map>
+#include <set>
+#include <utility>
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_results.pb.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+namespace gpu {
+
+// Stores the best algorithms found by autotuning the cudnn convolutions and
+// the cublas gemms, keyed by the device and by a description of the problem.
+// The results can be loaded from and saved to files of AutotuneResults, so
+// that the processes that run the same models on the same kind of devices do
+// not autotune them again, and do not allocate the scratch memory needed to
+// do so.
+//
+// This is thread-safe.
+class AutotuneCache {
+ public:
+  AutotuneCache() {}
+
+  // The cache shared by the whole process.
+  static AutotuneCache* Global();
+
+  // Returns the key of the device of "stream_exec" in the cache: its model and
+  // compute capability, and the versions of the driver and of cudnn. The
+  // results found with other versions are not reused.
+  static string DeviceKey(se::StreamExecutor* stream_exec);
+
+  // Looks up the result for "problem" on "device". Returns false if there is
+  // none.
+  bool Find(const string& device, const string& problem,
+            AutotuneResult* result) const;
+
+  // Adds or replaces the result for result.problem() on result.device().
+  void Insert(const AutotuneResult& result);
+
+  // Adds the results in the file "path", unless they were loaded before. A
+  // missing file is not an error, so that the first process to run creates it.
+  // The results already in the cache win over the ones in the file.
+  Status Load(const string& path);
+
+  // Writes all the results to the file "path" if some were inserted since the
+  // last call. The file is replaced atomically, so that other processes never
+  // read a partial file.
+  Status Save(const string& path);
+
+  // Loads the files named by the xla_gpu_autotune_results_file and
+  // xla_gpu_autotune_results_preload_file debug options, and saves to the
+  // former. Errors are logged and ignored: autotuning results are only hints.
+  void LoadFiles(const DebugOptions& options);
+  void SaveFile(const DebugOptions& options);
+
+ private:
+  mutable tensorflow::mutex mu_;
+  std::map<std::pair<string, string>, AutotuneResult> results_
+      GUARDED_BY(mu_);
+  std::set<string> loaded_paths_ GUARDED_BY(mu_);
+  bool dirty_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AutotuneCache);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_H_
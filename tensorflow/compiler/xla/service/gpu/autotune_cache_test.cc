@@ -0,0 +1,73 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+AutotuneResult MakeResult(const string& device, const string& problem,
+                          int64 algorithm) {
+  AutotuneResult result;
+  result.set_device(device);
+  result.set_problem(problem);
+  result.set_algorithm(algorithm);
+  return result;
+}
+
+TEST(AutotuneCacheTest, FindInsertedResults) {
+  AutotuneCache cache;
+  cache.Insert(MakeResult("gpu_a", "conv", 1));
+  cache.Insert(MakeResult("gpu_b", "conv", 2));
+
+  AutotuneResult result;
+  ASSERT_TRUE(cache.Find("gpu_a", "conv", &result));
+  EXPECT_EQ(1, result.algorithm());
+  ASSERT_TRUE(cache.Find("gpu_b", "conv", &result));
+  EXPECT_EQ(2, result.algorithm());
+  EXPECT_FALSE(cache.Find("gpu_a", "gemm", &result));
+}
+
+TEST(AutotuneCacheTest, SaveAndLoad) {
+  const string path =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "autotune");
+  AutotuneCache cache;
+  // A missing file is not an error.
+  TF_EXPECT_OK(cache.Load(path));
+  cache.Insert(MakeResult("gpu", "conv", 3));
+  TF_EXPECT_OK(cache.Save(path));
+
+  // The results saved by another process are kept.
+  AutotuneCache other_cache;
+  other_cache.Insert(MakeResult("gpu", "gemm", 4));
+  TF_EXPECT_OK(other_cache.Save(path));
+
+  AutotuneCache loaded_cache;
+  TF_EXPECT_OK(loaded_cache.Load(path));
+  AutotuneResult result;
+  ASSERT_TRUE(loaded_cache.Find("gpu", "conv", &result));
+  EXPECT_EQ(3, result.algorithm());
+  ASSERT_TRUE(loaded_cache.Find("gpu", "gemm", &result));
+  EXPECT_EQ(4, result.algorithm());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
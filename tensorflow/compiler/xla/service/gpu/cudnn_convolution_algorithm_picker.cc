@@ -14,9 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/xla/service/gpu/cudnn_convolution_algorithm_picker.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/window_util.h"
 #include "tensorflow/core/lib/gtl/optional.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -139,22 +141,33 @@ string NumBytesToString(int64 bytes) {
 
 }  // anonymous namespace
 
-// We could have caching here so that we don't redo this work for two identical
-// convolutions.  Unfortunately our cache key would have to be a tuple
-// containing the protos passed to this function, and we have no utility for
-// hashing protos.  We could write our own hash functions, but they'd silently
-// break if we ever added a field to one of the protos.  Perhaps we could hack
-// using the binary-encoded proto as the hash key, on the assumption that two
-// protos being binary-equal is a sufficient, if not necessary, condition for
-// proper equality.  But that would still leave us open to having unnecessary
-// cache misses and doing extra work.  Overall, caching doesn't seem worth the
-// trouble, but we may want to revisit this if we ever find a model where
-// caching would speed up compilation a lot.
+// The results are cached in AutotuneCache::Global(), keyed by the textual
+// forms of the shapes, window and dimension numbers of the convolution.  Two
+// identical convolutions always have the same key, so the cache never misses
+// a result that it has.
 optional<std::tuple<int64, bool, int64>>
 CudnnConvolutionAlgorithmPicker::PickBestAlgorithm(
     CudnnConvKind kind, const Shape& input_shape, const Shape& filter_shape,
     const Shape& output_shape, const Window& window,
     const ConvolutionDimensionNumbers& dnums, HloInstruction* instr) {
+  AutotuneCache* cache = AutotuneCache::Global();
+  const string device_key = AutotuneCache::DeviceKey(stream_exec_);
+  const string problem_key = tensorflow::strings::StrCat(
+      CudnnConvKindToString(kind), "|",
+      ShapeUtil::HumanStringWithLayout(input_shape), "|",
+      ShapeUtil::HumanStringWithLayout(filter_shape), "|",
+      ShapeUtil::HumanStringWithLayout(output_shape), "|",
+      window_util::ToString(window), "|",
+      ConvolutionDimensionNumbersToString(dnums));
+  AutotuneResult cached_result;
+  if (cache->Find(device_key, problem_key, &cached_result)) {
+    VLOG(2) << "Using the cached algorithm " << cached_result.algorithm()
+            << " for " << instr->ToString();
+    return std::make_tuple(cached_result.algorithm(),
+                           cached_result.tensor_ops_enabled(),
+                           cached_result.scratch_bytes());
+  }
+
   // Create a stream for us to do our work on.
   se::Stream stream{stream_exec_};
   stream.Init();
@@ -257,6 +270,13 @@ CudnnConvolutionAlgorithmPicker::PickBestAlgorithm(
             << AlgorithmToString(best_result.algorithm()) << ", takes "
             << best_result.elapsed_time_in_ms() << "ms, and uses "
             << best_result_bytes_used << "B of scratch memory.";
+    AutotuneResult result;
+    result.set_device(device_key);
+    result.set_problem(problem_key);
+    result.set_algorithm(best_result.algorithm().algo_id());
+    result.set_tensor_ops_enabled(best_result.algorithm().tensor_ops_enabled());
+    result.set_scratch_bytes(best_result_bytes_used);
+    cache->Insert(result);
     return std::make_tuple(best_result.algorithm().algo_id(),
                            best_result.algorithm().tensor_ops_enabled(),
                            best_result_bytes_used);
@@ -363,11 +383,14 @@ StatusOr<bool> CudnnConvolutionAlgorithmPicker::RunOnComputation(
 }
 
 StatusOr<bool> CudnnConvolutionAlgorithmPicker::Run(HloModule* module) {
+  const DebugOptions& debug_options = module->config().debug_options();
+  AutotuneCache::Global()->LoadFiles(debug_options);
   bool changed = false;
   for (HloComputation* computation : module->MakeNonfusionComputations()) {
     TF_ASSIGN_OR_RETURN(bool result, RunOnComputation(computation));
     changed |= result;
   }
+  AutotuneCache::Global()->SaveFile(debug_options);
   return changed;
 }
 
@@ -17,7 +17,10 @@ limitations under the License.
 
 #include <functional>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/platform/types.h"
@@ -318,9 +321,39 @@ Status GemmThunk::ExecuteOnStream(const BufferAllocations& buffer_allocations,
     const string& device_name = stream->parent()->GetDeviceDescription().name();
     auto autotune_it = autotune_results_.find(device_name);
     if (autotune_it == autotune_results_.end()) {
-      StatusOr<se::blas::AlgorithmType> best_algorithm =
-          GetGemmAutotuneFn(element_type)(lhs_matrix, rhs_matrix, output_matrix,
-                                          alpha_, computation_type, stream);
+      // The results of other thunks and processes for the same problem are in
+      // the global AutotuneCache.
+      AutotuneCache* cache = AutotuneCache::Global();
+      const DebugOptions& debug_options =
+          hlo_instruction()->GetModule()->config().debug_options();
+      cache->LoadFiles(debug_options);
+      const string device_key = AutotuneCache::DeviceKey(stream->parent());
+      auto matrix_key = [](const MatrixDescriptor& matrix) {
+        return tensorflow::strings::StrCat(matrix.transpose ? "T" : "N",
+                                           matrix.num_rows, "x",
+                                           matrix.num_cols);
+      };
+      const string problem_key = tensorflow::strings::StrCat(
+          "gemm|", PrimitiveType_Name(element_type), "|",
+          matrix_key(lhs_matrix), "|", matrix_key(rhs_matrix), "|",
+          matrix_key(output_matrix), "|", alpha_);
+      AutotuneResult cached_result;
+      StatusOr<se::blas::AlgorithmType> best_algorithm;
+      if (cache->Find(device_key, problem_key, &cached_result)) {
+        best_algorithm = cached_result.algorithm();
+      } else {
+        best_algorithm = GetGemmAutotuneFn(element_type)(
+            lhs_matrix, rhs_matrix, output_matrix, alpha_, computation_type,
+            stream);
+        if (best_algorithm.ok()) {
+          AutotuneResult result;
+          result.set_device(device_key);
+          result.set_problem(problem_key);
+          result.set_algorithm(best_algorithm.ValueOrDie());
+          cache->Insert(result);
+          cache->SaveFile(debug_options);
+        }
+      }
       autotune_it =
           autotune_results_.insert({device_name, best_algorithm}).first;
 
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_support_checker.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_layout_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_schedule.h"
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
@@ -85,8 +86,10 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cuda_libdevice_path.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -277,6 +280,13 @@ Status OptimizeHloModule(HloModule* hlo_module, se::StreamExecutor* stream_exec,
       // fuse the new ReducePrecision operations.
       TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
     }
+
+    // Merge the independent kernels that are left once the producer-consumer
+    // fusion has converged, to reduce the number of kernel launches.
+    HloPassPipeline horizontal_fusion("horizontal-fusion");
+    horizontal_fusion.AddInvariantChecker<HloVerifier>();
+    horizontal_fusion.AddPass<GpuHorizontalFusion>();
+    TF_RETURN_IF_ERROR(horizontal_fusion.Run(hlo_module).status());
   }
 
   {
@@ -475,6 +485,57 @@ StatusOr<std::vector<uint8>> CompilePtx(const string& ptx, int cc_major,
   return cubin_vector;
 }
 
+// Returns the file of the persistent cache in "cache_dir" that holds the cubin
+// compiled from "ptx" for sm_<cc_major><cc_minor>, or "" if there is no ptxas.
+// The size and modification time of ptxas are part of the key, so that the
+// cubins compiled by another version of ptxas are not reused.
+string PersistentCubinPath(const string& cache_dir, const string& ptx,
+                           int cc_major, int cc_minor) {
+  const string ptxas_path =
+      tensorflow::io::JoinPath(tensorflow::CudaRoot(), "bin", "ptxas");
+  tensorflow::FileStatistics ptxas_stat;
+  if (!tensorflow::Env::Default()->Stat(ptxas_path, &ptxas_stat).ok()) {
+    return "";
+  }
+  const tensorflow::Fprint128 fingerprint =
+      tensorflow::Fingerprint128(tensorflow::strings::StrCat(
+          ptxas_path, ":", ptxas_stat.length, ":", ptxas_stat.mtime_nsec,
+          ":sm_", cc_major, cc_minor, ":", ptx));
+  return tensorflow::io::JoinPath(
+      cache_dir, tensorflow::strings::Printf(
+                     "%016llx%016llx.cubin",
+                     static_cast<unsigned long long>(fingerprint.high64),
+                     static_cast<unsigned long long>(fingerprint.low64)));
+}
+
+// Returns false if "path" doesn't hold a cubin.
+bool LoadPersistentCubin(const string& path, std::vector<uint8>* cubin) {
+  string contents;
+  if (!tensorflow::ReadFileToString(tensorflow::Env::Default(), path,
+                                    &contents)
+           .ok() ||
+      contents.empty()) {
+    return false;
+  }
+  cubin->assign(contents.begin(), contents.end());
+  return true;
+}
+
+// Writes to a temporary file first, so that the other processes sharing the
+// cache never read a partial cubin.
+Status StorePersistentCubin(const string& cache_dir, const string& path,
+                            const std::vector<uint8>& cubin) {
+  auto* env = tensorflow::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(cache_dir));
+  const string tmp_path =
+      tensorflow::strings::StrCat(path, ".tmp.", env->NowMicros());
+  TF_RETURN_IF_ERROR(tensorflow::WriteStringToFile(
+      env, tmp_path, tensorflow::StringPiece(
+                         reinterpret_cast<const char*>(cubin.data()),
+                         cubin.size())));
+  return env->RenameFile(tmp_path, path);
+}
+
 }  // namespace
 
 GpuCompiler::GpuCompiler()
@@ -659,8 +720,9 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
     }
   }
 
-  const std::vector<uint8> cubin =
-      CompilePtxOrGetCachedResult(ptx, cc_major, cc_minor);
+  const std::vector<uint8> cubin = CompilePtxOrGetCachedResult(
+      ptx, cc_major, cc_minor,
+      module->config().debug_options().xla_gpu_persistent_cubin_cache_dir());
 
   auto thunk_schedule = MakeUnique<ThunkSchedule>(
       ir_emitter.ConsumeThunkSequence(), std::move(stream_assignment),
@@ -692,9 +754,9 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   return std::unique_ptr<Executable>(gpu_executable);
 }
 
-std::vector<uint8> GpuCompiler::CompilePtxOrGetCachedResult(const string& ptx,
-                                                            int cc_major,
-                                                            int cc_minor) {
+std::vector<uint8> GpuCompiler::CompilePtxOrGetCachedResult(
+    const string& ptx, int cc_major, int cc_minor,
+    const string& persistent_cache_dir) {
   XLA_SCOPED_LOGGING_TIMER("GpuCompiler::CompilePtxOrGetCachedResult");
   tracing::ScopedActivity activity("PTX->CUBIN", /*is_expensive=*/true);
   bool inserted;
@@ -721,13 +783,30 @@ std::vector<uint8> GpuCompiler::CompilePtxOrGetCachedResult(const string& ptx,
     tensorflow::mutex_lock lock(cache_value->mutex_);
     if (inserted) {
       CHECK(!cache_value->compilation_done);
-      if (!ptx.empty()) {
+      const string persistent_path =
+          persistent_cache_dir.empty() || ptx.empty()
+              ? ""
+              : PersistentCubinPath(persistent_cache_dir, ptx, cc_major,
+                                    cc_minor);
+      if (!persistent_path.empty() &&
+          LoadPersistentCubin(persistent_path, &cache_value->cubin_data)) {
+        VLOG(2) << "Loaded CUBIN size: " << cache_value->cubin_data.size()
+                << " from " << persistent_path;
+      } else if (!ptx.empty()) {
         StatusOr<std::vector<uint8>> maybe_cubin =
             CompilePtx(*cache_ptx, cc_major, cc_minor);
         if (maybe_cubin.ok()) {
           cache_value->cubin_data = std::move(maybe_cubin).ValueOrDie();
           VLOG(2) << "Compiled PTX size:" << ptx.size()
                   << " CUBIN size: " << cache_value->cubin_data.size();
+          if (!persistent_path.empty()) {
+            Status status = StorePersistentCubin(
+                persistent_cache_dir, persistent_path, cache_value->cubin_data);
+            if (!status.ok()) {
+              LOG(WARNING) << "Couldn't store the cubin to " << persistent_path
+                           << ": " << status;
+            }
+          }
         } else {
           bool log_warning = true;
           if (maybe_cubin.status().code() ==
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 
+#include <map>
 #include <set>
 #include <utility>
 #include <vector>
@@ -59,7 +60,56 @@ GpuExecutable::GpuExecutable(
       cubin_(cubin),
       compute_capability_(compute_capability),
       thunk_schedule_(std::move(thunk_schedule)),
-      assignment_(std::move(assignment)) {}
+      assignment_(std::move(assignment)) {
+  std::map<const Thunk*, int> thunk_to_finish_event;
+  for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+    ThunkLaunch launch;
+    launch.thunk = thunk;
+    launch.stream_no =
+        thunk_schedule_->StreamNumberForHlo(*thunk->hlo_instruction());
+    for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk)) {
+      launch.wait_events.push_back(
+          FindOrDie(thunk_to_finish_event, dependency));
+    }
+    launch.finish_event = -1;
+    if (thunk_schedule_->Depended(thunk)) {
+      launch.finish_event = num_events_++;
+      thunk_to_finish_event[thunk] = launch.finish_event;
+    }
+    thunk_launches_.push_back(std::move(launch));
+  }
+}
+
+Status GpuExecutable::BorrowEvents(
+    se::StreamExecutor* executor,
+    std::vector<std::unique_ptr<se::Event>>* events) {
+  {
+    tensorflow::mutex_lock lock(event_pool_mu_);
+    std::vector<std::unique_ptr<se::Event>>& pool = event_pool_[executor];
+    while (!pool.empty() && static_cast<int>(events->size()) < num_events_) {
+      events->push_back(std::move(pool.back()));
+      pool.pop_back();
+    }
+  }
+  while (static_cast<int>(events->size()) < num_events_) {
+    auto event = MakeUnique<se::Event>(executor);
+    if (!event->Init()) {
+      return InternalError("Failed to initialize an event for the thunks");
+    }
+    events->push_back(std::move(event));
+  }
+  return Status::OK();
+}
+
+void GpuExecutable::ReturnEvents(
+    se::StreamExecutor* executor,
+    std::vector<std::unique_ptr<se::Event>> events) {
+  tensorflow::mutex_lock lock(event_pool_mu_);
+  std::vector<std::unique_ptr<se::Event>>& pool = event_pool_[executor];
+  for (auto& event : events) {
+    pool.push_back(std::move(event));
+  }
+}
 
 Status GpuExecutable::ExecuteThunks(
     const ServiceExecutableRunOptions* run_options,
@@ -103,8 +153,10 @@ Status GpuExecutable::ExecuteThunks(
   //     tracing is disabled.
   ScopedAnnotation top_level_annotation(hlo_module_->name(), "XLA GPU module");
 
-  std::map<const Thunk*, std::unique_ptr<se::Event>> thunk_to_finish_event;
-  for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+  std::vector<std::unique_ptr<se::Event>> events;
+  TF_RETURN_IF_ERROR(BorrowEvents(executor, &events));
+  for (const ThunkLaunch& launch : thunk_launches_) {
+    Thunk* thunk = launch.thunk;
     // Annotate execution of this op if tracing was enabled when we started
     // running this module.  If tracing is enabled *while* we're running the
     // module, we won't get any data, but that's probably an OK trade-off.
@@ -121,13 +173,12 @@ Status GpuExecutable::ExecuteThunks(
     }
 
     TF_RETURN_IF_ERROR(thunk->Initialize(*this, executor));
-    int32 stream_no =
-        thunk_schedule_->StreamNumberForHlo(*thunk->hlo_instruction());
+    int32 stream_no = launch.stream_no;
     se::Stream* stream =
         (stream_no == 0 ? main_stream : sub_streams[stream_no - 1].get());
 
-    for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk)) {
-      stream->ThenWaitFor(FindOrDie(thunk_to_finish_event, dependency).get());
+    for (int wait_event : launch.wait_events) {
+      stream->ThenWaitFor(events[wait_event].get());
     }
 
     // If this thunk requests it, wait for all currently-executing thunks to
@@ -141,14 +192,12 @@ Status GpuExecutable::ExecuteThunks(
             << thunk->hlo_instruction()->ToString() << " on stream "
             << stream_no;
     TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(buffer_allocations, stream));
-    if (thunk_schedule_->Depended(thunk)) {
-      auto finish_event = MakeUnique<se::Event>(main_stream->parent());
-      finish_event->Init();
-      stream->ThenRecordEvent(finish_event.get());
-      thunk_to_finish_event[thunk] = std::move(finish_event);
+    if (launch.finish_event >= 0) {
+      stream->ThenRecordEvent(events[launch.finish_event].get());
     }
     profiler.FinishOperation(thunk->hlo_instruction());
   }
+  ReturnEvents(executor, std::move(events));
 
   main_stream->ThenWaitFor(&sub_streams);
   // Make sure kernels are completed before deallocating temporary buffers.
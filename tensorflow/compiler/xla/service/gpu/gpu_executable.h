@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/device_memory_allocator.h"
@@ -35,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
 namespace xla {
@@ -98,6 +101,16 @@ class GpuExecutable : public Executable {
   // computation. Uses points-to analysis from buffer assignment.
   const PointsToSet& GetRootPointsToSet() const;
 
+  // Takes num_events_ initialized events of "executor" from the pool, creating
+  // the missing ones, and puts them into "events".
+  Status BorrowEvents(se::StreamExecutor* executor,
+                      std::vector<std::unique_ptr<se::Event>>* events);
+
+  // Returns "events" of "executor" to the pool, once all the operations
+  // waiting on them have been enqueued.
+  void ReturnEvents(se::StreamExecutor* executor,
+                    std::vector<std::unique_ptr<se::Event>> events);
+
   // The LLVM IR, in string format, of the unoptimized module generated for this
   // GpuExecutable. We save a string instead of an llvm::Module* because leaving
   // llvm::Module* in a singleton can cause the heap checker to emit false
@@ -126,6 +139,27 @@ class GpuExecutable : public Executable {
   // memory for every output/temp buffers.
   const std::unique_ptr<const BufferAssignment> assignment_;
 
+  // How ExecuteThunks launches a thunk, computed once from thunk_schedule_ so
+  // that every execution does not look the thunk up in the schedule's maps.
+  struct ThunkLaunch {
+    Thunk* thunk;
+    int stream_no;
+    // The indices of the events recorded by the thunks this one depends on.
+    std::vector<int> wait_events;
+    // The index of the event to record after this thunk, or -1 if no thunk
+    // depends on it.
+    int finish_event;
+  };
+  std::vector<ThunkLaunch> thunk_launches_;
+  int num_events_ = 0;
+
+  // The events used by the previous executions, per StreamExecutor. Creating
+  // an event is much slower than recording it again, and re-recording an event
+  // does not affect the operations already waiting for it.
+  tensorflow::mutex event_pool_mu_;
+  std::map<se::StreamExecutor*, std::vector<std::unique_ptr<se::Event>>>
+      event_pool_ GUARDED_BY(event_pool_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
 
@@ -0,0 +1,149 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
+
+namespace xla {
+namespace gpu {
+
+constexpr int64 GpuHorizontalFusion::kMaxElements;
+constexpr int64 GpuHorizontalFusion::kMaxOutputs;
+constexpr int64 GpuHorizontalFusion::kMaxOperands;
+
+namespace {
+
+bool IsCandidate(const HloInstruction& instr) {
+  if (!ShapeUtil::IsArray(instr.shape()) ||
+      ShapeUtil::ElementsIn(instr.shape()) >
+          GpuHorizontalFusion::kMaxElements) {
+    return false;
+  }
+  if (instr.opcode() == HloOpcode::kFusion) {
+    if (instr.fusion_kind() != HloInstruction::FusionKind::kLoop ||
+        instr.IsMultiOutputFusion() || ImplementedAsGemm(instr)) {
+      return false;
+    }
+    // Fusions with a bitcast root would become nested fusions, and fusions
+    // with a dynamic-update-slice root may be emitted in place.
+    HloOpcode root_opcode = instr.fused_expression_root()->opcode();
+    return root_opcode != HloOpcode::kBitcast &&
+           root_opcode != HloOpcode::kDynamicUpdateSlice;
+  }
+  return instr.IsElementwise() && instr.operand_count() > 0;
+}
+
+// Returns a group of at least two candidates of the same shape which can be
+// merged together, or an empty vector if there is none.
+std::vector<HloInstruction*> FindGroup(HloComputation* computation) {
+  std::unique_ptr<HloReachabilityMap> reachability =
+      computation->ComputeReachability();
+  // The candidates are bucketed by their shape, in post order so that the
+  // result does not depend on pointer values.
+  std::map<string, std::vector<HloInstruction*>> candidates_by_shape;
+  for (HloInstruction* instr : computation->MakeInstructionPostOrder()) {
+    if (IsCandidate(*instr)) {
+      candidates_by_shape[ShapeUtil::HumanStringWithLayout(instr->shape())]
+          .push_back(instr);
+    }
+  }
+
+  for (const auto& bucket : candidates_by_shape) {
+    const std::vector<HloInstruction*>& candidates = bucket.second;
+    for (size_t first = 0; first + 1 < candidates.size(); ++first) {
+      std::vector<HloInstruction*> group = {candidates[first]};
+      tensorflow::gtl::FlatSet<const HloInstruction*> operands(
+          candidates[first]->operands().begin(),
+          candidates[first]->operands().end());
+      for (size_t i = first + 1; i < candidates.size(); ++i) {
+        if (static_cast<int64>(group.size()) ==
+            GpuHorizontalFusion::kMaxOutputs) {
+          break;
+        }
+        HloInstruction* candidate = candidates[i];
+        bool independent = true;
+        for (const HloInstruction* member : group) {
+          if (reachability->IsConnected(member, candidate)) {
+            independent = false;
+            break;
+          }
+        }
+        if (!independent) {
+          continue;
+        }
+        tensorflow::gtl::FlatSet<const HloInstruction*> merged_operands =
+            operands;
+        merged_operands.insert(candidate->operands().begin(),
+                               candidate->operands().end());
+        if (static_cast<int64>(merged_operands.size()) >
+            GpuHorizontalFusion::kMaxOperands) {
+          continue;
+        }
+        operands = std::move(merged_operands);
+        group.push_back(candidate);
+      }
+      if (group.size() > 1) {
+        return group;
+      }
+    }
+  }
+  return {};
+}
+
+HloInstruction* MakeFusion(HloInstruction* instr) {
+  if (instr->opcode() == HloOpcode::kFusion) {
+    return instr;
+  }
+  return instr->parent()->CreateFusionInstruction(
+      {instr}, HloInstruction::FusionKind::kLoop);
+}
+
+}  // namespace
+
+StatusOr<bool> GpuHorizontalFusion::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    // Merging a group changes the reachability of the instructions of the
+    // other groups, so the groups are formed one at a time. The merged fusion
+    // is a multi-output fusion and is no longer a candidate.
+    for (std::vector<HloInstruction*> group = FindGroup(computation);
+         !group.empty(); group = FindGroup(computation)) {
+      VLOG(2) << "Merging " << group.size() << " instructions of shape "
+              << ShapeUtil::HumanStringWithLayout(group[0]->shape())
+              << " in computation " << computation->name();
+      HloInstruction* fusion = MakeFusion(group[0]);
+      for (size_t i = 1; i < group.size(); ++i) {
+        fusion->MergeFusionInstructionIntoMultiOutput(MakeFusion(group[i]));
+      }
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,59 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that merges independent small loop fusions and elementwise
+// instructions into multi-output loop fusions, so that they run as one kernel
+// instead of one kernel each.
+//
+// Unlike GpuMultiOutputFusion, which only merges siblings that read common
+// operands, the instructions merged here need not share anything: e.g. the
+// per-variable updates of an optimizer. They are merged if:
+//
+// 1) They have the same shape, including the layout, because a multi-output
+//    loop fusion computes all of its outputs in the same loop.
+// 2) Neither of them is reachable from the other.
+// 3) They have at most kMaxElements elements, as larger kernels do not pay a
+//    significant launch overhead.
+//
+// This pass should run after the producer-consumer fusion passes, which do not
+// fuse into multi-output fusions.
+class GpuHorizontalFusion : public HloPassInterface {
+ public:
+  tensorflow::StringPiece name() const override { return "horizontal-fusion"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // The largest number of elements of a merged instruction.
+  static constexpr int64 kMaxElements = 1 << 20;
+
+  // The largest number of outputs and of operands of a merged fusion. These
+  // bound the number of kernel parameters.
+  static constexpr int64 kMaxOutputs = 32;
+  static constexpr int64 kMaxOperands = 64;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
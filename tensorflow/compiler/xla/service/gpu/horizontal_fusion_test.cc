@@ -0,0 +1,101 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace op = xla::testing::opcode_matchers;
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using HorizontalFusionTest = HloTestBase;
+
+TEST_F(HorizontalFusionTest, MergeIndependentLoopFusions) {
+  auto module = ParseHloString(R"(
+    HloModule test_module
+
+    fused_computation_1 {
+      p0.1 = f32[64]{0} parameter(0)
+      p1.1 = f32[64]{0} parameter(1)
+      ROOT add.1 = f32[64]{0} add(p0.1, p1.1)
+    }
+
+    fused_computation_2 {
+      p0.2 = f32[64]{0} parameter(0)
+      p1.2 = f32[64]{0} parameter(1)
+      ROOT mul.2 = f32[64]{0} multiply(p0.2, p1.2)
+    }
+
+    ENTRY entry {
+      p0 = f32[64]{0} parameter(0)
+      p1 = f32[64]{0} parameter(1)
+      p2 = f32[64]{0} parameter(2)
+      p3 = f32[64]{0} parameter(3)
+      fusion.1 = f32[64]{0} fusion(p0, p1), kind=kLoop, calls=fused_computation_1
+      fusion.2 = f32[64]{0} fusion(p2, p3), kind=kLoop, calls=fused_computation_2
+      sub = f32[64]{0} subtract(p1, p2)
+      ROOT root = (f32[64]{0}, f32[64]{0}, f32[64]{0}) tuple(fusion.1, fusion.2, sub)
+    })")
+                    .ValueOrDie();
+  ASSERT_TRUE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+  SCOPED_TRACE(module->ToString());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Tuple(op::GetTupleElement(), op::GetTupleElement(),
+                              op::GetTupleElement()));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  ASSERT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_EQ(fusion, root->operand(2)->operand(0));
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Add(), op::Multiply(), op::Subtract()));
+}
+
+TEST_F(HorizontalFusionTest, DontMergeDependentInstructions) {
+  auto module = ParseHloString(R"(
+    HloModule test_module
+
+    ENTRY entry {
+      p0 = f32[64]{0} parameter(0)
+      p1 = f32[64]{0} parameter(1)
+      add = f32[64]{0} add(p0, p1)
+      ROOT mul = f32[64]{0} multiply(add, p1)
+    })")
+                    .ValueOrDie();
+  EXPECT_FALSE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+}
+
+TEST_F(HorizontalFusionTest, DontMergeDifferentShapes) {
+  auto module = ParseHloString(R"(
+    HloModule test_module
+
+    ENTRY entry {
+      p0 = f32[64]{0} parameter(0)
+      p1 = f32[32]{0} parameter(1)
+      neg.0 = f32[64]{0} negate(p0)
+      neg.1 = f32[32]{0} negate(p1)
+      ROOT root = (f32[64]{0}, f32[32]{0}) tuple(neg.0, neg.1)
+    })")
+                    .ValueOrDie();
+  EXPECT_FALSE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
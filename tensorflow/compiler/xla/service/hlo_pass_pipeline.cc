@@ -23,8 +23,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 using ::tensorflow::strings::StrAppend;
@@ -33,6 +35,12 @@ using ::tensorflow::strings::StrCat;
 namespace xla {
 
 namespace {
+
+auto* hlo_pass_micros = tensorflow::monitoring::Counter<2>::New(
+    "/tensorflow/compiler/xla/hlo_pass_micros",
+    "The wall time spent in each HLO pass while compiling.", "pipeline",
+    "pass");
+
 void DumpModuleGraph(const HloModule& module, const string& message) {
   hlo_graph_dumper::MaybeDumpHloModule(module, message);
   VLOG(3) << "HLO " << message << ":";
@@ -102,7 +110,9 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
                     std::string(name()), "pipeline_start");
   }
 
-  for (auto& pass : passes_) {
+  pass_run_micros_.resize(passes_.size(), 0);
+  for (size_t i = 0; i < passes_.size(); ++i) {
+    auto& pass = passes_[i];
     if (disabled_passes.count(std::string(pass->name())) > 0) {
       VLOG(1) << "  Skipping HLO pass " << pass->name()
               << ", disabled by --xla_disable_hlo_passes";
@@ -116,7 +126,16 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
     StrAppend(&message, prefix, ", before ", pass->name());
     DumpModuleGraph(*module, message);
 
+    const uint64 start_micros = tensorflow::Env::Default()->NowMicros();
     TF_ASSIGN_OR_RETURN(bool changed_this_pass, pass->Run(module));
+    const uint64 pass_micros =
+        tensorflow::Env::Default()->NowMicros() - start_micros;
+    pass_run_micros_[i] += pass_micros;
+    hlo_pass_micros
+        ->GetCell(std::string(name()), std::string(pass->name()))
+        ->IncrementBy(pass_micros);
+    VLOG(1) << "  HLO pass " << pass->name() << " took " << pass_micros
+            << " us";
     TF_RETURN_IF_ERROR(
         run_invariant_checkers(StrCat("after running pass: ", pass->name())));
     if (!xla_dump_per_pass_hlo_proto_to.empty()) {
@@ -132,4 +151,14 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
   return changed;
 }
 
+std::vector<std::pair<string, int64>> HloPassPipeline::pass_run_micros()
+    const {
+  std::vector<std::pair<string, int64>> result;
+  for (size_t i = 0; i < passes_.size(); ++i) {
+    result.emplace_back(std::string(passes_[i]->name()),
+                        i < pass_run_micros_.size() ? pass_run_micros_[i] : 0);
+  }
+  return result;
+}
+
 }  // namespace xla
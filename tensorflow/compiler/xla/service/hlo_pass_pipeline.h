@@ -19,6 +19,7 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/compiler/xla/ptr_util.h"
@@ -64,9 +65,16 @@ class HloPassPipeline : public HloPassInterface {
   // Run all passes on the given HLO module.
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Returns the name of each pass and the total wall time in microseconds it
+  // spent in the calls to Run, in the order of the passes. The passes disabled
+  // by --xla_disable_hlo_passes have a zero time.
+  std::vector<std::pair<string, int64>> pass_run_micros() const;
+
  private:
   const string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
+  // The total wall time spent in each pass, indexed like passes_.
+  std::vector<int64> pass_run_micros_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
 
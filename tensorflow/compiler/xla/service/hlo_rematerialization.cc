@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/copy_insertion.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -830,14 +831,18 @@ bool MemoryUsageTracker::Check() const {
 // Computes and returns the cost of rematerializing the given instruction.
 // Cost per rematerialized instruction is defined as:
 //
-// memory_limit_bytes / memory_reduced
+// memory_limit_bytes / memory_reduced * (1 + recompute_flops / memory_reduced)
 //
 // The idea is to choose the operation that will save the most memory for
-// rematerialization and do not worry about how much the compute costs since
-// running out of memory is more harmful than taking longer to get the answer.
+// rematerialization, since running out of memory is more harmful than taking
+// longer to get the answer. Among the operations saving a similar amount of
+// memory, the ones which are cheap to recompute per byte saved (e.g.
+// broadcasts and elementwise operations) are preferred over the expensive ones
+// (e.g. dots and convolutions).
 int64 RematerializationCost(const HloInstruction* instruction,
                             const MemoryUsageTracker& memory_tracker,
-                            int64 memory_reduced, int64 memory_limit_bytes) {
+                            int64 memory_reduced, int64 memory_limit_bytes,
+                            int64 recompute_flops) {
   // If none of the users of 'instruction' have been placed in the sequence (as
   // tracked by memory_tracker), then rematerialization of 'instruction' is a
   // zero-cost move of 'instruction' in the sequence.
@@ -849,8 +854,14 @@ int64 RematerializationCost(const HloInstruction* instruction,
   }
 
   CHECK_GT(memory_reduced, 0);
-  // Return the inverse of the benefit of rematerialization.
-  return memory_limit_bytes / memory_reduced;
+  // Return the inverse of the benefit of rematerialization, scaled by the
+  // compute cost per byte saved.
+  const double cost =
+      static_cast<double>(memory_limit_bytes) / memory_reduced *
+      (1.0 + static_cast<double>(recompute_flops) / memory_reduced);
+  return cost >= static_cast<double>(tensorflow::kint64max)
+             ? tensorflow::kint64max
+             : static_cast<int64>(cost);
 }
 
 // Selects and returns the best candidate instruction for rematerialization.
@@ -861,6 +872,8 @@ int64 RematerializationCost(const HloInstruction* instruction,
 Item* PickRematerializationCandidate(
     const MemoryUsageTracker& memory_tracker,
     const InstructionList& instruction_list, int64 memory_limit_bytes,
+    const tensorflow::gtl::FlatMap<const HloInstruction*, int64>&
+        recompute_flops,
     tensorflow::gtl::FlatMap<const HloInstruction*, bool>* remat_able) {
   Item* best_item = nullptr;
   int64 best_cost = 0;
@@ -913,11 +926,13 @@ Item* PickRematerializationCandidate(
       continue;
     }
 
-    const int cost = RematerializationCost(candidate, memory_tracker,
-                                           memory_reduced, memory_limit_bytes);
+    const int64 flops = FindOrDefault(recompute_flops, candidate, 0);
+    const int64 cost = RematerializationCost(
+        candidate, memory_tracker, memory_reduced, memory_limit_bytes, flops);
 
     VLOG(5) << "candidate " << candidate->name() << ", memory reduced "
-            << memory_reduced << ", cost per byte " << cost;
+            << memory_reduced << ", recompute flops " << flops
+            << ", cost per byte " << cost;
 
     if (best_item == nullptr || cost < best_cost) {
       VLOG(5) << "candidate " << candidate->name() << " now best";
@@ -1029,7 +1044,8 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
               << ", limit is " << HumanReadableNumBytes(memory_limit_bytes);
 
       Item* best_item = PickRematerializationCandidate(
-          memory_tracker, instruction_list, memory_limit_bytes, &remat_able);
+          memory_tracker, instruction_list, memory_limit_bytes,
+          recompute_flops_, &remat_able);
 
       if (best_item == nullptr) {
         VLOG(3) << "Unable to find rematerialization candidate at program "
@@ -1050,6 +1066,9 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
 
       HloInstruction* remat =
           computation->AddInstruction(best->Clone(/*suffix=*/"remat"));
+      if (ContainsKey(recompute_flops_, best)) {
+        recompute_flops_[remat] = recompute_flops_.at(best);
+      }
 
       // Add control dependencies to the new operation.
       for (auto successor : best->control_successors()) {
@@ -1247,6 +1266,31 @@ StatusOr<bool> HloRematerialization::Run(
     TF_RETURN_IF_ERROR(RemoveUnnecessaryCopies(ordering, {}, module));
   }
 
+  // Estimate the cost of recomputing each instruction. Rematerialization still
+  // proceeds without the estimates if the analysis fails.
+  HloCostAnalysis cost_analysis(size_function_);
+  Status cost_status = Status::OK();
+  for (const HloComputation* computation :
+       module->MakeNonfusionComputations()) {
+    cost_status = computation->Accept(&cost_analysis);
+    if (!cost_status.ok()) {
+      break;
+    }
+  }
+  if (cost_status.ok()) {
+    for (const HloComputation* computation :
+         module->MakeNonfusionComputations()) {
+      for (const HloInstruction* instruction : computation->instructions()) {
+        recompute_flops_[instruction] =
+            cost_analysis.flop_count(*instruction) +
+            cost_analysis.transcendental_count(*instruction);
+      }
+    }
+  } else {
+    VLOG(1) << "Rematerializing without compute cost estimates: "
+            << cost_status;
+  }
+
   // Compute peak memory usage of all computations in the module called in a
   // sequential context.
   call_graph_ = CallGraph::Build(module);
@@ -132,6 +132,11 @@ class HloRematerialization {
 
   std::unique_ptr<TuplePointsToAnalysis> points_to_analysis_;
 
+  // The estimated number of flops and transcendental operations needed to
+  // recompute each instruction, including the rematerialized ones. Missing
+  // instructions are assumed free to recompute.
+  tensorflow::gtl::FlatMap<const HloInstruction*, int64> recompute_flops_;
+
   // Set of computations which have had rematerialization
   // applied. Rematerialization is only applied once per computation.
   tensorflow::gtl::FlatSet<const HloComputation*> rematerialized_computations_;
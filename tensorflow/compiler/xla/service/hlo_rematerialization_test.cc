@@ -499,6 +499,70 @@ TEST_F(HloRematerializationTest, InstructionRematerializedMultipleTimes) {
   EXPECT_THAT(add_4->operand(0), op::Broadcast(param));
 }
 
+TEST_F(HloRematerializationTest, PreferCheapToRecomputeInstructions) {
+  // Test that among the candidates saving the same amount of memory, the one
+  // which is cheaper to recompute is rematerialized. Module:
+  //
+  //   F32[32,32] %p0 = {...}
+  //   F32[32,32] %p1 = {...}
+  //   F32[32,32] %dot = dot(%p0, %p1)
+  //   F32[32,32] %negate = negate(%p0)
+  //   F32[32,32] %sum = add(%dot, %negate)
+  //   F32[4,32,32] %bcast = broadcast(%sum)
+  //   F32[4,32,32] %big_negate = negate(%bcast)
+  //   F32[1,32,32] %slice = slice(%big_negate)
+  //   F32[32,32] %reshape = reshape(%slice)
+  //   F32[32,32] %add_1 = add(%reshape, %dot)
+  //   F32[32,32] %add_2 = add(%add_1, %negate)
+  //
+  // %dot and %negate are both live across %big_negate and rematerializing
+  // either one of them brings the peak memory use from 48KB down to 44KB.
+  // %negate is much cheaper to recompute.
+  auto module = CreateNewModule();
+  const Shape matrix_shape = ShapeUtil::MakeShape(xla::F32, {32, 32});
+  const Shape big_shape = ShapeUtil::MakeShape(xla::F32, {4, 32, 32});
+
+  auto builder = HloComputation::Builder(TestName());
+  auto p0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, matrix_shape, "p0"));
+  auto p1 = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, matrix_shape, "p1"));
+  auto dot = builder.AddInstruction(
+      HloInstruction::CreateCanonicalDot(matrix_shape, p0, p1));
+  auto negate = builder.AddInstruction(
+      HloInstruction::CreateUnary(matrix_shape, HloOpcode::kNegate, p0));
+  auto sum = builder.AddInstruction(
+      HloInstruction::CreateBinary(matrix_shape, HloOpcode::kAdd, dot, negate));
+  auto bcast = builder.AddInstruction(
+      HloInstruction::CreateBroadcast(big_shape, sum, {1, 2}));
+  auto big_negate = builder.AddInstruction(
+      HloInstruction::CreateUnary(big_shape, HloOpcode::kNegate, bcast));
+  auto slice = builder.AddInstruction(HloInstruction::CreateSlice(
+      ShapeUtil::MakeShape(xla::F32, {1, 32, 32}), big_negate,
+      /*start_indices=*/{0, 0, 0}, /*limit_indices=*/{1, 32, 32},
+      /*strides=*/{1, 1, 1}));
+  auto reshape = builder.AddInstruction(
+      HloInstruction::CreateReshape(matrix_shape, slice));
+  auto add_1 = builder.AddInstruction(HloInstruction::CreateBinary(
+      matrix_shape, HloOpcode::kAdd, reshape, dot));
+  auto add_2 = builder.AddInstruction(HloInstruction::CreateBinary(
+      matrix_shape, HloOpcode::kAdd, add_1, negate));
+  module->AddEntryComputation(builder.Build());
+
+  SequentialHloOrdering::HloModuleSequence sequence;
+  // Pick a memory limit between 52KB (initial peak memory including the
+  // output) and 48KB (peak memory after rematerializing one instruction).
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloRematerialization(
+                                            /*memory_limit_bytes=*/50 * 1024,
+                                            module.get(), &sequence));
+  EXPECT_TRUE(changed);
+
+  // The negate should have been rematerialized but not the dot.
+  EXPECT_EQ(add_1->operand(1), dot);
+  EXPECT_THAT(add_2->operand(1), op::Negate(p0));
+  EXPECT_NE(add_2->operand(1), negate);
+}
+
 class IndirectUseTest : public HloRematerializationTest,
                         public ::testing::WithParamInterface<bool> {};
 
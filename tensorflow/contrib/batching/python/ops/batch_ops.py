@@ -60,7 +60,8 @@ def batch_function(num_batch_threads,
                    allowed_batch_sizes=None,
                    grad_timeout_micros=60 * 1000 * 1000,
                    unbatch_timeout_micros=60 * 1000 * 1000,
-                   max_enqueued_batches=10):
+                   max_enqueued_batches=10,
+                   target_latency_micros=0):
   """Batches the computation done by the decorated function.
 
   So, for example, in the following code
@@ -99,6 +100,10 @@ def batch_function(num_batch_threads,
     unbatch_timeout_micros: The timeout to use for unbatching. See the
      documentation of the unbatch op for more details. Defaults to 60s.
     max_enqueued_batches: The maximum depth of the batch queue. Defaults to 10.
+    target_latency_micros: If positive, the batch sizes and the timeout are
+     chosen as the load changes so that the batches meet this latency. The
+     batch sizes are then chosen among `allowed_batch_sizes` if given.
+     Defaults to 0, which disables it.
 
   Returns:
     The decorated function will return the unbatched computation output Tensors.
@@ -129,6 +134,7 @@ def batch_function(num_batch_threads,
             batch_timeout_micros=batch_timeout_micros,
             allowed_batch_sizes=allowed_batch_sizes,
             max_enqueued_batches=max_enqueued_batches,
+            target_latency_micros=target_latency_micros,
             shared_name=name,
             f=computation,
             in_tensors=list(args),
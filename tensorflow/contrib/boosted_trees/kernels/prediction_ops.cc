@@ -13,6 +13,7 @@
 // limitations under the License.
 // =============================================================================
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -286,6 +287,8 @@ class GradientTreesPredictionOp : public OpKernel {
     // Run predictor.
     thread::ThreadPool* const worker_threads =
         context->device()->tensorflow_cpu_worker_threads()->workers;
+    const std::shared_ptr<const boosted_trees::trees::FlatTreeEnsemble>
+        flat_ensemble = ensemble_resource->GetFlatEnsemble();
 
     if (apply_averaging_) {
       DecisionTreeEnsembleConfig adjusted =
@@ -303,14 +306,16 @@ class GradientTreesPredictionOp : public OpKernel {
         adjusted.mutable_tree_weights()->Set(
             i, weight * (num_ensembles - i + start_averaging) / num_ensembles);
       }
+      // Averaging only changes the tree weights, so the compiled ensemble
+      // still applies.
       MultipleAdditiveTrees::Predict(adjusted, trees_to_include, batch_features,
                                      worker_threads, output_predictions,
-                                     output_leaf_index_t);
+                                     output_leaf_index_t, flat_ensemble.get());
     } else {
       MultipleAdditiveTrees::Predict(
           ensemble_resource->decision_tree_ensemble(), trees_to_include,
           batch_features, worker_threads, output_predictions,
-          output_leaf_index_t);
+          output_leaf_index_t, flat_ensemble.get());
     }
 
     // Output dropped trees and original weights.
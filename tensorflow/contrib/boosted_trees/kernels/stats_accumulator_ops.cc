@@ -219,6 +219,80 @@ void SerializeTensorAccumulatorToOutput(
   }
 }
 
+// The range of slots that a batch of updates touches, laid out densely in the
+// order of PartitionKey::Less. The updates are first summed into a histogram
+// indexed by slot, which costs an array access per update instead of a map
+// lookup, and the histogram is then merged into the accumulator's map once per
+// slot. This pays off as the number of updates per slot grows, e.g. for dense
+// features bucketized by quantiles, where every example updates one of a few
+// buckets in one of a few partitions.
+struct DenseSlots {
+  int32 min_partition_id;
+  int64 min_feature_id;
+  int32 min_dimension;
+  int64 num_partitions;
+  int64 num_features;
+  int64 num_dimensions;
+
+  int64 size() const { return num_partitions * num_dimensions * num_features; }
+
+  int64 Index(int32 partition_id, int64 feature_id, int32 dimension) const {
+    return ((partition_id - min_partition_id) * num_dimensions +
+            (dimension - min_dimension)) *
+               num_features +
+           (feature_id - min_feature_id);
+  }
+
+  PartitionKey Key(int64 index) const {
+    const int64 feature_id = min_feature_id + index % num_features;
+    index /= num_features;
+    const int32 dimension = min_dimension + index % num_dimensions;
+    const int32 partition_id = min_partition_id + index / num_dimensions;
+    return PartitionKey(partition_id, feature_id, dimension);
+  }
+};
+
+// Histograms smaller than this are always used, and larger ones only if they
+// have at most kMaxDenseSlotsPerUpdate slots per update.
+const int64 kMinDenseSlots = 1024;
+const int64 kMaxDenseSlotsPerUpdate = 4;
+
+// Sets '*slots' to the range of slots touched by the updates, and returns
+// whether it is small enough to be accumulated densely.
+bool GetDenseSlots(TTypes<int32>::ConstVec partition_ids,
+                   TTypes<int64>::ConstMatrix feature_ids_and_dimensions,
+                   int64 num_updates, DenseSlots* slots) {
+  if (num_updates == 0) {
+    return false;
+  }
+  int32 max_partition_id = partition_ids(0);
+  int64 max_feature_id = feature_ids_and_dimensions(0, 0);
+  int64 max_dimension = feature_ids_and_dimensions(0, 1);
+  slots->min_partition_id = max_partition_id;
+  slots->min_feature_id = max_feature_id;
+  int64 min_dimension = max_dimension;
+  for (int64 i = 1; i < num_updates; ++i) {
+    slots->min_partition_id = std::min(slots->min_partition_id,
+                                       partition_ids(i));
+    max_partition_id = std::max(max_partition_id, partition_ids(i));
+    slots->min_feature_id =
+        std::min(slots->min_feature_id, feature_ids_and_dimensions(i, 0));
+    max_feature_id = std::max(max_feature_id, feature_ids_and_dimensions(i, 0));
+    min_dimension = std::min(min_dimension, feature_ids_and_dimensions(i, 1));
+    max_dimension = std::max(max_dimension, feature_ids_and_dimensions(i, 1));
+  }
+  slots->min_dimension = min_dimension;
+  slots->num_partitions =
+      static_cast<int64>(max_partition_id) - slots->min_partition_id + 1;
+  slots->num_features = max_feature_id - slots->min_feature_id + 1;
+  slots->num_dimensions = max_dimension - min_dimension + 1;
+  // Compare in floating point, since the product may overflow.
+  const double size = static_cast<double>(slots->num_partitions) *
+                      static_cast<double>(slots->num_features) *
+                      static_cast<double>(slots->num_dimensions);
+  return size <= std::max(kMinDenseSlots, kMaxDenseSlotsPerUpdate * num_updates);
+}
+
 void AddToScalarAccumulator(
     StatsAccumulatorScalarResource* accumulator_resource,
     const Tensor& partition_ids_t, const Tensor& feature_ids_t,
@@ -233,6 +307,39 @@ void AddToScalarAccumulator(
 
   int64 num_updates = partition_ids_shape.dim_size(0);
   auto stats_map = accumulator_resource->mutable_values();
+  DenseSlots slots;
+  if (GetDenseSlots(partition_ids, feature_ids_and_dimensions, num_updates,
+                    &slots)) {
+    // Interleave the gradients and hessians of each slot, so that an update
+    // touches a single cache line.
+    std::vector<double> slot_stats(2 * slots.size(), 0);
+    std::vector<bool> slot_updated(slots.size(), false);
+    for (int64 i = 0; i < num_updates; ++i) {
+      const int64 index =
+          slots.Index(partition_ids(i), feature_ids_and_dimensions(i, 0),
+                      feature_ids_and_dimensions(i, 1));
+      slot_stats[2 * index] += gradients(i);
+      slot_stats[2 * index + 1] += hessians(i);
+      slot_updated[index] = true;
+    }
+    for (int64 index = 0; index < slots.size(); ++index) {
+      if (!slot_updated[index]) {
+        continue;
+      }
+      const PartitionKey key = slots.Key(index);
+      auto itr = stats_map->lower_bound(key);
+      if (itr != stats_map->end() && itr->first == key) {
+        itr->second.first += slot_stats[2 * index];
+        itr->second.second += slot_stats[2 * index + 1];
+      } else {
+        stats_map->emplace_hint(
+            itr, key,
+            std::make_pair(static_cast<float>(slot_stats[2 * index]),
+                           static_cast<float>(slot_stats[2 * index + 1])));
+      }
+    }
+    return;
+  }
   for (int64 i = 0; i < num_updates; ++i) {
     const auto key =
         PartitionKey(partition_ids(i), feature_ids_and_dimensions(i, 0),
@@ -296,6 +403,51 @@ void AddToTensorAccumulator(
 
   int64 num_updates = partition_ids_shape.dim_size(0);
   auto stats_map = accumulator_resource->mutable_values();
+  DenseSlots slots;
+  if (GetDenseSlots(partition_ids, feature_ids_and_dimensions, num_updates,
+                    &slots)) {
+    const int64 num_gradient_elements = gradients_shape.num_elements();
+    const int64 num_hessian_elements = hessians_shape.num_elements();
+    const int64 stride = num_gradient_elements + num_hessian_elements;
+    std::vector<double> slot_stats(stride * slots.size(), 0);
+    std::vector<bool> slot_updated(slots.size(), false);
+    for (int64 i = 0; i < num_updates; ++i) {
+      const int64 index =
+          slots.Index(partition_ids(i), feature_ids_and_dimensions(i, 0),
+                      feature_ids_and_dimensions(i, 1));
+      double* stats = &slot_stats[stride * index];
+      for (int j = 0; j < num_gradient_elements; ++j) {
+        stats[j] += gradients(i, j);
+      }
+      for (int j = 0; j < num_hessian_elements; ++j) {
+        stats[num_gradient_elements + j] += hessians(i, j);
+      }
+      slot_updated[index] = true;
+    }
+    for (int64 index = 0; index < slots.size(); ++index) {
+      if (!slot_updated[index]) {
+        continue;
+      }
+      const PartitionKey key = slots.Key(index);
+      auto itr = stats_map->lower_bound(key);
+      if (itr == stats_map->end() || !(itr->first == key)) {
+        itr = stats_map->emplace_hint(
+            itr, key,
+            std::make_pair(std::vector<float>(num_gradient_elements, 0),
+                           std::vector<float>(num_hessian_elements, 0)));
+      }
+      const double* stats = &slot_stats[stride * index];
+      auto& stored_gradients = itr->second.first;
+      for (int j = 0; j < num_gradient_elements; ++j) {
+        stored_gradients[j] += stats[j];
+      }
+      auto& stored_hessians = itr->second.second;
+      for (int j = 0; j < num_hessian_elements; ++j) {
+        stored_hessians[j] += stats[num_gradient_elements + j];
+      }
+    }
+    return;
+  }
   for (int64 i = 0; i < num_updates; ++i) {
     const auto key =
         PartitionKey(partition_ids(i), feature_ids_and_dimensions(i, 0),
@@ -27,7 +27,8 @@ void MultipleAdditiveTrees::Predict(
     const boosted_trees::utils::BatchFeatures& features,
     tensorflow::thread::ThreadPool* const worker_threads,
     tensorflow::TTypes<float>::Matrix output_predictions,
-    Tensor* const output_leaf_index) {
+    Tensor* const output_leaf_index,
+    const boosted_trees::trees::FlatTreeEnsemble* flat_ensemble) {
   // Zero out predictions as the model is additive.
   output_predictions.setZero();
 
@@ -37,6 +38,32 @@ void MultipleAdditiveTrees::Predict(
     return;
   }
 
+  if (flat_ensemble != nullptr &&
+      static_cast<int>(features.dense_float_feature_columns().size()) >=
+          flat_ensemble->num_dense_float_features()) {
+    std::vector<const float*> dense_float_features;
+    dense_float_features.reserve(features.dense_float_feature_columns().size());
+    for (const Tensor& column : features.dense_float_feature_columns()) {
+      dense_float_features.push_back(column.flat<float>().data());
+    }
+    auto update_flat_predictions = [&config, &trees_to_include, flat_ensemble,
+                                    &dense_float_features, &output_predictions,
+                                    &output_leaf_index](int64 start,
+                                                        int64 end) {
+      tensorflow::TTypes<int>::Matrix output_leaf_index_mat =
+          output_leaf_index != nullptr ? output_leaf_index->matrix<int>()
+                                       : tensorflow::TTypes<int>::Matrix(
+                                             nullptr, 0, 0);
+      flat_ensemble->Predict(
+          trees_to_include, config.tree_weights(), dense_float_features, start,
+          end, output_predictions,
+          output_leaf_index != nullptr ? &output_leaf_index_mat : nullptr);
+    };
+    boosted_trees::utils::ParallelFor(batch_size, worker_threads->NumThreads(),
+                                      worker_threads, update_flat_predictions);
+    return;
+  }
+
   // Lambda for doing a block of work.
   auto update_predictions = [&config, &features, &trees_to_include,
                              &output_predictions,
@@ -17,6 +17,7 @@
 
 #include <vector>
 
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_types.h"
@@ -37,13 +38,16 @@ class MultipleAdditiveTrees {
   // nullptr, this method fills output_leaf_indices with a per-tree leaf id
   // where each of the instances from 'features' ended up in. Its shape is num
   // examples X num of trees.
+  // If 'flat_ensemble' is not nullptr, it must be 'config' compiled, and is
+  // used instead of 'config' when the batch has all the features it splits on.
   static void Predict(
       const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
       const std::vector<int32>& trees_to_include,
       const boosted_trees::utils::BatchFeatures& features,
       tensorflow::thread::ThreadPool* const worker_threads,
       tensorflow::TTypes<float>::Matrix output_predictions,
-      Tensor* const output_leaf_index);
+      Tensor* const output_leaf_index,
+      const boosted_trees::trees::FlatTreeEnsemble* flat_ensemble = nullptr);
 };
 
 }  // namespace models
@@ -16,6 +16,7 @@
 
 #include "tensorflow/contrib/boosted_trees/lib/testutil/batch_features_testutil.h"
 #include "tensorflow/contrib/boosted_trees/lib/testutil/random_tree_gen.h"
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/resources/decision_tree_ensemble_resource.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -29,6 +30,7 @@
 
 namespace tensorflow {
 using boosted_trees::trees::DecisionTreeEnsembleConfig;
+using boosted_trees::trees::FlatTreeEnsemble;
 using test::AsTensor;
 
 namespace boosted_trees {
@@ -292,6 +294,64 @@ TEST_F(MultipleAdditiveTreesTest, DenseLeaves) {
   }
 }
 
+TEST_F(MultipleAdditiveTreesTest, FlatEnsemble) {
+  // Generate an ensemble of dense splits and a batch spanning several blocks
+  // of examples.
+  random::PhiloxRandom philox(1);
+  random::SimplePhilox rng(&philox);
+  boosted_trees::testutil::RandomTreeGen tree_gen(&rng, 4, 0);
+  DecisionTreeEnsembleConfig tree_ensemble_config =
+      tree_gen.GenerateEnsemble(6, 10);
+  for (int i = 0; i < tree_ensemble_config.trees_size(); ++i) {
+    tree_ensemble_config.set_tree_weights(i, rng.RandFloat());
+  }
+  std::unique_ptr<FlatTreeEnsemble> flat_ensemble =
+      FlatTreeEnsemble::Compile(tree_ensemble_config);
+  ASSERT_NE(nullptr, flat_ensemble);
+  EXPECT_EQ(10, flat_ensemble->num_trees());
+  EXPECT_GE(4, flat_ensemble->num_dense_float_features());
+
+  const int64 batch_size = 150;
+  boosted_trees::utils::BatchFeatures batch_features(batch_size);
+  boosted_trees::testutil::RandomlyInitializeBatchFeatures(&rng, 4, 0, 0.0, 0.0,
+                                                           &batch_features);
+
+  tensorflow::thread::ThreadPool threads(tensorflow::Env::Default(), "test",
+                                         kNumThreadsMultiThreaded);
+  const std::vector<int32> trees_to_include = {0, 2, 3, 5, 6, 7, 9};
+  Tensor expected_predictions(DT_FLOAT, TensorShape({batch_size, 1}));
+  Tensor expected_leaf_index(DT_INT32, TensorShape({batch_size, 10}));
+  expected_leaf_index.flat<int>().setZero();
+  MultipleAdditiveTrees::Predict(tree_ensemble_config, trees_to_include,
+                                 batch_features, &threads,
+                                 expected_predictions.matrix<float>(),
+                                 &expected_leaf_index);
+  Tensor predictions(DT_FLOAT, TensorShape({batch_size, 1}));
+  Tensor leaf_index(DT_INT32, TensorShape({batch_size, 10}));
+  leaf_index.flat<int>().setZero();
+  MultipleAdditiveTrees::Predict(
+      tree_ensemble_config, trees_to_include, batch_features, &threads,
+      predictions.matrix<float>(), &leaf_index, flat_ensemble.get());
+  test::ExpectTensorNear<float>(expected_predictions, predictions, 1e-5);
+  test::ExpectTensorEqual<int>(expected_leaf_index, leaf_index);
+}
+
+TEST_F(MultipleAdditiveTreesTest, FlatEnsembleUnsupportedSplit) {
+  DecisionTreeEnsembleConfig tree_ensemble_config;
+  auto* tree = tree_ensemble_config.add_trees();
+  auto* split = tree->add_nodes()->mutable_categorical_id_binary_split();
+  split->set_feature_column(0);
+  split->set_feature_id(5);
+  split->set_left_id(1);
+  split->set_right_id(2);
+  for (int i = 0; i < 2; ++i) {
+    auto* leaf = tree->add_nodes()->mutable_leaf()->mutable_sparse_vector();
+    leaf->add_index(0);
+    leaf->add_value(0.5f);
+  }
+  EXPECT_EQ(nullptr, FlatTreeEnsemble::Compile(tree_ensemble_config));
+}
+
 }  // namespace
 }  // namespace models
 }  // namespace boosted_trees
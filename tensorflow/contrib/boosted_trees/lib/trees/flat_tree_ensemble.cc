@@ -0,0 +1,176 @@
+// Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+namespace {
+// The number of examples traversed together.
+constexpr int kBlockSize = 64;
+}  // namespace
+
+std::unique_ptr<FlatTreeEnsemble> FlatTreeEnsemble::Compile(
+    const DecisionTreeEnsembleConfig& config) {
+  std::unique_ptr<FlatTreeEnsemble> ensemble(new FlatTreeEnsemble);
+  for (const DecisionTreeConfig& tree : config.trees()) {
+    if (!ensemble->AddTree(tree)) {
+      return nullptr;
+    }
+  }
+  return ensemble;
+}
+
+bool FlatTreeEnsemble::AddTree(const DecisionTreeConfig& tree) {
+  const int32 num_nodes = tree.nodes_size();
+  if (num_nodes == 0) {
+    return false;
+  }
+
+  // Order the nodes breadth-first, and find the depth of the tree.
+  std::vector<int32> order = {0};
+  std::vector<int32> flat_ids(num_nodes, -1);
+  flat_ids[0] = 0;
+  int32 depth = 0;
+  for (size_t level_start = 0; level_start < order.size();) {
+    const size_t level_end = order.size();
+    for (size_t i = level_start; i < level_end; ++i) {
+      const TreeNode& node = tree.nodes(order[i]);
+      if (node.node_case() != TreeNode::kDenseFloatBinarySplit) {
+        continue;
+      }
+      for (const int32 child_id : {node.dense_float_binary_split().left_id(),
+                                   node.dense_float_binary_split().right_id()}) {
+        if (child_id < 0 || child_id >= num_nodes || flat_ids[child_id] >= 0) {
+          return false;
+        }
+        flat_ids[child_id] = order.size();
+        order.push_back(child_id);
+      }
+    }
+    if (order.size() > level_end) {
+      ++depth;
+    }
+    level_start = level_end;
+  }
+
+  const int32 root = nodes_.size();
+  for (const int32 node_id : order) {
+    const TreeNode& node = tree.nodes(node_id);
+    const int32 flat_id = root + flat_ids[node_id];
+    Node flat_node;
+    switch (node.node_case()) {
+      case TreeNode::kLeaf: {
+        flat_node.feature_column = 0;
+        flat_node.threshold = 0;
+        flat_node.left_id = flat_id;
+        flat_node.right_id = flat_id;
+        if (node.leaf().has_sparse_vector()) {
+          const auto& leaf = node.leaf().sparse_vector();
+          if (leaf.index_size() != leaf.value_size()) {
+            return false;
+          }
+          logit_dimensions_.insert(logit_dimensions_.end(),
+                                   leaf.index().begin(), leaf.index().end());
+          logit_values_.insert(logit_values_.end(), leaf.value().begin(),
+                               leaf.value().end());
+        } else if (node.leaf().has_vector()) {
+          const auto& leaf = node.leaf().vector();
+          for (int i = 0; i < leaf.value_size(); ++i) {
+            logit_dimensions_.push_back(i);
+          }
+          logit_values_.insert(logit_values_.end(), leaf.value().begin(),
+                               leaf.value().end());
+        } else {
+          return false;
+        }
+        break;
+      }
+      case TreeNode::kDenseFloatBinarySplit: {
+        const auto& split = node.dense_float_binary_split();
+        if (split.feature_column() < 0) {
+          return false;
+        }
+        flat_node.feature_column = split.feature_column();
+        flat_node.threshold = split.threshold();
+        flat_node.left_id = root + flat_ids[split.left_id()];
+        flat_node.right_id = root + flat_ids[split.right_id()];
+        num_dense_float_features_ =
+            std::max(num_dense_float_features_, split.feature_column() + 1);
+        break;
+      }
+      default:
+        return false;
+    }
+    nodes_.push_back(flat_node);
+    original_node_ids_.push_back(node_id);
+    logits_offsets_.push_back(logit_values_.size());
+  }
+  tree_roots_.push_back(root);
+  tree_depths_.push_back(depth);
+  return true;
+}
+
+void FlatTreeEnsemble::Predict(
+    const std::vector<int32>& trees_to_include,
+    const protobuf::RepeatedField<float>& tree_weights,
+    const std::vector<const float*>& dense_float_features,
+    const int64 example_start, const int64 example_end,
+    TTypes<float>::Matrix output_predictions,
+    TTypes<int>::Matrix* output_leaf_index) const {
+  DCHECK_GE(static_cast<int>(dense_float_features.size()),
+            num_dense_float_features_);
+  int32 node_ids[kBlockSize];
+  for (int64 block_start = example_start; block_start < example_end;
+       block_start += kBlockSize) {
+    const int block_size =
+        std::min<int64>(kBlockSize, example_end - block_start);
+    for (const int32 tree_idx : trees_to_include) {
+      std::fill(node_ids, node_ids + block_size, tree_roots_[tree_idx]);
+      for (int32 level = 0; level < tree_depths_[tree_idx]; ++level) {
+        for (int i = 0; i < block_size; ++i) {
+          const Node& node = nodes_[node_ids[i]];
+          const float value =
+              dense_float_features[node.feature_column][block_start + i];
+          node_ids[i] = value <= node.threshold ? node.left_id : node.right_id;
+        }
+      }
+
+      const float tree_weight = tree_weights.Get(tree_idx);
+      for (int i = 0; i < block_size; ++i) {
+        const int32 node_id = node_ids[i];
+        const int64 example_idx = block_start + i;
+        if (output_leaf_index != nullptr) {
+          (*output_leaf_index)(example_idx, tree_idx) =
+              original_node_ids_[node_id];
+        }
+        for (int32 j = logits_offsets_[node_id];
+             j < logits_offsets_[node_id + 1]; ++j) {
+          output_predictions(example_idx, logit_dimensions_[j]) +=
+              tree_weight * logit_values_[j];
+        }
+      }
+    }
+  }
+}
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+// Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_TREE_ENSEMBLE_H_
+#define TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_TREE_ENSEMBLE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+// A tree ensemble compiled into flat arrays for fast prediction. Only the
+// ensembles made of leaves and dense float splits can be compiled.
+//
+// The nodes of each tree are laid out breadth-first, so that the top levels,
+// which every example visits, share a few cache lines. Examples are traversed
+// in blocks, one tree level at a time for the whole block: the traversals of a
+// block are independent, which lets the CPU overlap their memory accesses, and
+// each step is a conditional move instead of a branch. Leaves loop to
+// themselves, so that every example of a block takes as many steps as the
+// depth of the tree.
+//
+// This class is immutable and thread safe.
+class FlatTreeEnsemble {
+ public:
+  // Returns the compiled 'config', or nullptr if it has nodes other than
+  // leaves and dense float splits, or malformed trees.
+  static std::unique_ptr<FlatTreeEnsemble> Compile(
+      const DecisionTreeEnsembleConfig& config);
+
+  int num_trees() const { return tree_roots_.size(); }
+
+  // Returns the number of dense float feature columns the splits read.
+  int num_dense_float_features() const { return num_dense_float_features_; }
+
+  // Adds the predictions of 'trees_to_include', weighted by 'tree_weights',
+  // for the examples in [example_start, example_end) to their rows of
+  // 'output_predictions'. 'dense_float_features' holds the values of each
+  // dense float feature column, indexed by example, and must have at least
+  // num_dense_float_features() columns. If 'output_leaf_index' is not nullptr,
+  // stores the id of the leaf each example reaches in each tree in it.
+  void Predict(const std::vector<int32>& trees_to_include,
+               const protobuf::RepeatedField<float>& tree_weights,
+               const std::vector<const float*>& dense_float_features,
+               int64 example_start, int64 example_end,
+               TTypes<float>::Matrix output_predictions,
+               TTypes<int>::Matrix* output_leaf_index) const;
+
+ private:
+  // A split, or a leaf whose children are itself.
+  struct Node {
+    int32 feature_column;
+    float threshold;
+    int32 left_id;
+    int32 right_id;
+  };
+
+  FlatTreeEnsemble() = default;
+
+  // Appends the nodes of 'tree'. Returns false if it cannot be compiled.
+  bool AddTree(const DecisionTreeConfig& tree);
+
+  // The nodes of all the trees.
+  std::vector<Node> nodes_;
+  // For each node, the id of the node in its original tree, and the range of
+  // its logits in 'logit_dimensions_' and 'logit_values_', which is empty for
+  // splits. 'logits_offsets_' has a trailing entry for the end of the last
+  // range.
+  std::vector<int32> original_node_ids_;
+  std::vector<int32> logits_offsets_ = {0};
+  std::vector<int32> logit_dimensions_;
+  std::vector<float> logit_values_;
+
+  // For each tree, the index of its root in 'nodes_' and its depth.
+  std::vector<int32> tree_roots_;
+  std::vector<int32> tree_depths_;
+
+  int num_dense_float_features_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FlatTreeEnsemble);
+};
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_TREE_ENSEMBLE_H_
@@ -85,6 +85,37 @@ class StatsAccumulatorScalarTest(test_util.TensorFlowTestCase):
       self.assertAllClose(result[(2, 3, 0)], [0.3, 0.4])
       self.assertAllClose(result[(2, 3, 1)], [0.1, 0.2])
 
+  def testManyUpdatesPerSlot(self):
+    with self.test_session() as sess:
+      accumulator = stats_accumulator_ops.StatsAccumulator(
+          stamp_token=0,
+          gradient_shape=tensor_shape.scalar(),
+          hessian_shape=tensor_shape.scalar())
+      with ops.control_dependencies([accumulator._create_op]):
+        # Summed into a histogram first, since the updates hit few slots.
+        op1 = accumulator.add(
+            stamp_token=0,
+            partition_ids=[1, 3] * 500,
+            feature_ids=[[-1, 0], [4, 0]] * 500,
+            gradients=[0.1, 0.2] * 500,
+            hessians=[0.3, 0.4] * 500)
+        # Accumulated one at a time, since the updates are spread out.
+        op2 = accumulator.add(0, [1, 3], [[-1, 0], [1 << 40, 0]], [0.5, 0.6],
+                              [0.7, 0.8])
+
+      with ops.control_dependencies([op1, op2]):
+        num_updates, partition, bucket_ids, grads, hessians = accumulator.flush(
+            stamp_token=0, next_stamp_token=1)
+        num_updates, partition, bucket_ids, grads, hessians = sess.run(
+            [num_updates, partition, bucket_ids, grads, hessians])
+
+      result = _AccumulatorResultToDict(partition, bucket_ids, grads, hessians)
+      self.assertEqual(num_updates, 2)
+      self.assertEqual(len(result), 3)
+      self.assertAllClose(result[(1, -1, 0)], [50.5, 150.7])
+      self.assertAllClose(result[(3, 4, 0)], [100, 200])
+      self.assertAllClose(result[(3, 1 << 40, 0)], [0.6, 0.8])
+
   def testDropStaleUpdate(self):
     with self.test_session() as sess:
       accumulator = stats_accumulator_ops.StatsAccumulator(
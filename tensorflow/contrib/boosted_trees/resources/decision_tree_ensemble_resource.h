@@ -15,7 +15,10 @@
 #ifndef TENSORFLOW_CONTRIB_BOOSTED_TREES_RESOURCES_DECISION_TREE_ENSEMBLE_RESOURCE_H_
 #define TENSORFLOW_CONTRIB_BOOSTED_TREES_RESOURCES_DECISION_TREE_ENSEMBLE_RESOURCE_H_
 
+#include <memory>
+
 #include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/resources/stamped_resource.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -155,12 +158,35 @@ class DecisionTreeEnsembleResource : public StampedResource {
     }
   }
 
+  // Returns the ensemble compiled for prediction, or nullptr if it cannot be
+  // compiled. The compiled ensemble is cached until the stamp changes, which
+  // every op mutating the ensemble does.
+  // Caller needs to hold the mutex lock, at least shared, while calling this.
+  std::shared_ptr<const boosted_trees::trees::FlatTreeEnsemble>
+  GetFlatEnsemble() {
+    mutex_lock l(flat_ensemble_mu_);
+    if (!flat_ensemble_valid_ || flat_ensemble_stamp_ != stamp()) {
+      flat_ensemble_ = boosted_trees::trees::FlatTreeEnsemble::Compile(
+          *decision_tree_ensemble_);
+      flat_ensemble_stamp_ = stamp();
+      flat_ensemble_valid_ = true;
+    }
+    return flat_ensemble_;
+  }
+
   // Resets the resource and frees the protos in arena.
   // Caller needs to hold the mutex lock while calling this.
   virtual void Reset() {
     // Reset stamp.
     set_stamp(-1);
 
+    // Invalidate the compiled ensemble.
+    {
+      mutex_lock l(flat_ensemble_mu_);
+      flat_ensemble_.reset();
+      flat_ensemble_valid_ = false;
+    }
+
     // Clear tree ensemle.
     arena_.Reset();
     CHECK_EQ(0, arena_.SpaceAllocated());
@@ -174,6 +200,13 @@ class DecisionTreeEnsembleResource : public StampedResource {
   protobuf::Arena arena_;
   mutex mu_;
   boosted_trees::trees::DecisionTreeEnsembleConfig* decision_tree_ensemble_;
+
+  // Guards the compiled ensemble, which ops holding 'mu_' shared may compile.
+  mutex flat_ensemble_mu_;
+  std::shared_ptr<const boosted_trees::trees::FlatTreeEnsemble> flat_ensemble_
+      GUARDED_BY(flat_ensemble_mu_);
+  bool flat_ensemble_valid_ GUARDED_BY(flat_ensemble_mu_) = false;
+  int64 flat_ensemble_stamp_ GUARDED_BY(flat_ensemble_mu_) = -1;
 };
 
 }  // namespace models
@@ -26,6 +26,9 @@ Managing dependencies:
 @@NoDependency
 @@split_dependency
 
+Incremental checkpoints:
+@@DeltaSaver
+
 Checkpointable data structures:
 @@List
 @@Mapping
@@ -37,6 +40,7 @@ from __future__ import division
 from __future__ import print_function
 
 from tensorflow.contrib.checkpoint.python.containers import UniqueNameTracker
+from tensorflow.contrib.checkpoint.python.delta_saver import DeltaSaver
 from tensorflow.contrib.checkpoint.python.split_dependency import split_dependency
 from tensorflow.contrib.checkpoint.python.visualize import dot_graph_from_checkpoint
 from tensorflow.core.protobuf.checkpointable_object_graph_pb2 import CheckpointableObjectGraph
@@ -0,0 +1,275 @@
+"""Checkpoints that only write the rows of large variables that changed."""
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import threading
+
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import io_ops
+from tensorflow.python.ops import state_ops
+from tensorflow.python.ops import variables
+from tensorflow.python.training import saver as saver_lib
+from tensorflow.python.training import training_util
+
+
+_INDICES_SUFFIX = "/delta_indices"
+_VALUES_SUFFIX = "/delta_values"
+
+
+class DeltaSaver(object):
+  """Writes full checkpoints, and in between only the rows that changed.
+
+  Large embedding tables often see updates to only a small fraction of their
+  rows between two checkpoints. `DeltaSaver` keeps a dirty-row mask for each
+  of the `tracked_variables`, which `mark_dirty` or `track_gradients` set as
+  the training step updates rows. `save` then writes either a full checkpoint
+  of `var_list`, called the base, or a delta holding the dirty rows of the
+  tracked variables since the previous save. Every `max_deltas_per_base`
+  deltas it writes a new base, which bounds the number of deltas a restore
+  has to replay.
+
+  The rows of a delta are copied out of the variables in one `Session.run`,
+  and the copy is written to disk on a background thread, so the training
+  step can continue while the delta is written. Call `wait` before relying
+  on the returned file. Rows marked by a step that runs concurrently with
+  the copy may be missed until the next base.
+
+  Variables that are not tracked only change at base saves. Note that
+  optimizers whose dense slot updates touch every row (e.g. `AdamOptimizer`)
+  should not have those slots tracked.
+
+  Example usage:
+
+  ```python
+  saver = tf.contrib.checkpoint.DeltaSaver(
+      var_list=tf.global_variables(), tracked_variables=[embeddings])
+  grads_and_vars = opt.compute_gradients(loss)
+  train_op = tf.group(opt.apply_gradients(grads_and_vars),
+                      saver.track_gradients(grads_and_vars))
+  ...
+  path = saver.save(sess, "/tmp/model", global_step=step)
+  ...
+  saver.restore(sess, saver.last_checkpoints)
+  ```
+
+  The dirty-row masks are local variables: run
+  `tf.local_variables_initializer()` before training.
+  """
+
+  def __init__(self, var_list, tracked_variables, max_deltas_per_base=10):
+    """Creates a `DeltaSaver`.
+
+    Args:
+      var_list: The variables written by base saves.
+      tracked_variables: Variables of `var_list` whose changed rows (slices
+        along the first dimension) are written by delta saves. Their first
+        dimension must be known.
+      max_deltas_per_base: The number of deltas written after a base before
+        the next save writes a new base.
+
+    Raises:
+      ValueError: If a tracked variable is not in `var_list`, or does not
+        have a known first dimension.
+    """
+    var_set = set(var_list)
+    self._tracked_variables = list(tracked_variables)
+    self._max_deltas_per_base = max_deltas_per_base
+    self._saver = saver_lib.Saver(var_list=var_list, max_to_keep=None)
+    self._masks = {}
+    for var in self._tracked_variables:
+      if var not in var_set:
+        raise ValueError("Tracked variable %s is not in var_list." % var.name)
+      shape = var.get_shape()
+      if shape.ndims is None or shape.ndims < 1 or shape[0].value is None:
+        raise ValueError("Tracked variable %s must have a known first "
+                         "dimension, got shape %s." % (var.name, shape))
+      with ops.colocate_with(var):
+        self._masks[var] = variables.Variable(
+            array_ops.zeros([shape[0].value], dtype=dtypes.bool),
+            trainable=False,
+            collections=[ops.GraphKeys.LOCAL_VARIABLES],
+            name=var.op.name + "/dirty_rows")
+
+    with ops.name_scope("delta_saver"):
+      # Copies out the dirty rows and clears the masks.
+      self._snapshot_indices = []
+      self._snapshot_values = []
+      clear_ops = []
+      for var in self._tracked_variables:
+        mask = self._masks[var]
+        indices = array_ops.reshape(array_ops.where(mask.value()), [-1])
+        values = array_ops.gather(var, indices)
+        with ops.control_dependencies([values]):
+          clear_ops.append(state_ops.assign(
+              mask, array_ops.zeros_like(mask.value())))
+        self._snapshot_indices.append(indices)
+        self._snapshot_values.append(values)
+      self._snapshot_clear = control_flow_ops.group(*clear_ops)
+      self._clear_masks = control_flow_ops.group(*[
+          state_ops.assign(mask, array_ops.zeros_like(mask.value()))
+          for mask in self._masks.values()
+      ])
+
+      # Writes a snapshot fed from the client.
+      self._filename = array_ops.placeholder(dtypes.string, [])
+      self._index_placeholders = []
+      self._value_placeholders = []
+      names = []
+      for var in self._tracked_variables:
+        self._index_placeholders.append(
+            array_ops.placeholder(dtypes.int64, [None]))
+        self._value_placeholders.append(array_ops.placeholder(
+            var.dtype.base_dtype, [None] + var.get_shape()[1:].as_list()))
+        names.extend([var.op.name + _INDICES_SUFFIX,
+                      var.op.name + _VALUES_SUFFIX])
+      tensors = []
+      for indices, values in zip(self._index_placeholders,
+                                 self._value_placeholders):
+        tensors.extend([indices, values])
+      self._write_delta = io_ops.save_v2(self._filename, names,
+                                         [""] * len(names), tensors)
+
+      # Replays a delta onto the variables.
+      restored = io_ops.restore_v2(
+          self._filename, names, [""] * len(names),
+          [t.dtype for t in tensors])
+      self._apply_delta = control_flow_ops.group(*[
+          state_ops.scatter_update(var, restored[2 * i], restored[2 * i + 1])
+          for i, var in enumerate(self._tracked_variables)
+      ])
+
+    self._lock = threading.Lock()
+    self._writer_thread = None
+    self._writer_error = None
+    self._last_checkpoints = []
+
+  @property
+  def last_checkpoints(self):
+    """The last base followed by the deltas written after it."""
+    return list(self._last_checkpoints)
+
+  def mark_dirty(self, var, indices):
+    """Returns an op marking rows `indices` of the tracked `var` as changed."""
+    mask = self._masks[var]
+    with ops.colocate_with(mask):
+      return state_ops.scatter_update(
+          mask, indices, array_ops.ones_like(indices, dtype=dtypes.bool))
+
+  def track_gradients(self, grads_and_vars):
+    """Returns an op marking the rows updated by `grads_and_vars` as changed.
+
+    Sparse gradients (`IndexedSlices`) of tracked variables mark their
+    indices; dense gradients mark every row.
+
+    Args:
+      grads_and_vars: A list of (gradient, variable) pairs, as returned by
+        `Optimizer.compute_gradients`.
+
+    Returns:
+      An op to run with the training step.
+    """
+    mark_ops = []
+    for grad, var in grads_and_vars:
+      if grad is None or var not in self._masks:
+        continue
+      if isinstance(grad, ops.IndexedSlices):
+        mark_ops.append(self.mark_dirty(var, grad.indices))
+      else:
+        mask = self._masks[var]
+        with ops.colocate_with(mask):
+          mark_ops.append(state_ops.assign(
+              mask, array_ops.ones_like(mask.value())))
+    return control_flow_ops.group(*mark_ops)
+
+  def save(self, sess, save_path, global_step=None):
+    """Writes a base or a delta checkpoint.
+
+    Args:
+      sess: The session to run the save in.
+      save_path: Prefix of the checkpoint files.
+      global_step: If given, appended to `save_path` as by `Saver.save`.
+
+    Returns:
+      The path of the new checkpoint. A delta may still be being written;
+      call `wait` before reading it.
+
+    Raises:
+      errors.OpError: If writing the previous delta failed.
+    """
+    self.wait()
+    if global_step is not None:
+      save_path = "%s-%d" % (save_path,
+                             training_util.global_step(sess, global_step))
+
+    if (not self._last_checkpoints or
+        len(self._last_checkpoints) > self._max_deltas_per_base):
+      sess.run(self._clear_masks)
+      path = self._saver.save(sess, save_path, write_meta_graph=False)
+      self._last_checkpoints = [path]
+      return path
+
+    path = save_path + ".delta"
+    indices, values, _ = sess.run(
+        [self._snapshot_indices, self._snapshot_values, self._snapshot_clear])
+    feed_dict = {self._filename: path}
+    feed_dict.update(zip(self._index_placeholders, indices))
+    feed_dict.update(zip(self._value_placeholders, values))
+
+    def _write():
+      try:
+        sess.run(self._write_delta, feed_dict=feed_dict)
+      except Exception as e:  # pylint: disable=broad-except
+        with self._lock:
+          self._writer_error = e
+
+    self._writer_thread = threading.Thread(target=_write)
+    self._writer_thread.start()
+    self._last_checkpoints.append(path)
+    return path
+
+  def wait(self):
+    """Blocks until the last delta is written.
+
+    Raises:
+      errors.OpError: If writing it failed.
+    """
+    if self._writer_thread is not None:
+      self._writer_thread.join()
+      self._writer_thread = None
+    with self._lock:
+      error, self._writer_error = self._writer_error, None
+    if error is not None:
+      raise error
+
+  def restore(self, sess, checkpoints):
+    """Restores a base, then replays the deltas written after it.
+
+    Args:
+      sess: The session to run the restore in.
+      checkpoints: A base checkpoint path followed by the paths of the deltas
+        to apply, in the order they were written, e.g. `last_checkpoints`.
+    """
+    self.wait()
+    self._saver.restore(sess, checkpoints[0])
+    for path in checkpoints[1:]:
+      sess.run(self._apply_delta, feed_dict={self._filename: path})
+    sess.run(self._clear_masks)
+    self._last_checkpoints = list(checkpoints)
@@ -0,0 +1,93 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+import numpy as np
+
+from tensorflow.contrib.checkpoint.python import delta_saver
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.ops import embedding_ops
+from tensorflow.python.ops import io_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import state_ops
+from tensorflow.python.ops import variables
+from tensorflow.python.platform import test
+from tensorflow.python.training import gradient_descent
+
+
+class DeltaSaverTest(test.TestCase):
+
+  def testSaveAndRestoreDeltas(self):
+    prefix = os.path.join(self.get_temp_dir(), "model")
+    with self.test_session() as sess:
+      embeddings = variables.Variable(
+          np.arange(20, dtype=np.float32).reshape([10, 2]), name="embeddings")
+      bias = variables.Variable(1.0)
+      ids = array_ops.placeholder(dtypes.int64, [None])
+      loss = math_ops.reduce_sum(
+          embedding_ops.embedding_lookup(embeddings, ids)) + bias
+      opt = gradient_descent.GradientDescentOptimizer(1.0)
+      grads_and_vars = opt.compute_gradients(loss, [embeddings])
+      saver = delta_saver.DeltaSaver(
+          var_list=[embeddings, bias], tracked_variables=[embeddings],
+          max_deltas_per_base=2)
+      train_op = control_flow_ops.group(
+          opt.apply_gradients(grads_and_vars),
+          saver.track_gradients(grads_and_vars))
+      sess.run([variables.global_variables_initializer(),
+                variables.local_variables_initializer()])
+
+      base = saver.save(sess, prefix, global_step=0)
+      sess.run(train_op, feed_dict={ids: [1, 3]})
+      delta1 = saver.save(sess, prefix, global_step=1)
+      sess.run(train_op, feed_dict={ids: [3, 7]})
+      delta2 = saver.save(sess, prefix, global_step=2)
+      saver.wait()
+      self.assertEqual([base, delta1, delta2], saver.last_checkpoints)
+      expected = sess.run(embeddings)
+
+      # Only the changed rows are in a delta.
+      self.assertAllEqual([3, 7], sess.run(io_ops.restore_v2(
+          delta2, ["embeddings/delta_indices"], [""], [dtypes.int64]))[0])
+
+      sess.run(state_ops.assign(embeddings, array_ops.zeros([10, 2])))
+      sess.run(state_ops.assign(bias, 0.0))
+      saver.restore(sess, [base, delta1, delta2])
+      self.assertAllEqual(expected, sess.run(embeddings))
+      self.assertEqual(1.0, sess.run(bias))
+
+      # The next save starts a new base.
+      new_base = saver.save(sess, prefix, global_step=3)
+      self.assertEqual([new_base], saver.last_checkpoints)
+
+  def testTrackedVariableMustBeSaved(self):
+    with ops.Graph().as_default():
+      v = variables.Variable(array_ops.zeros([3, 2]))
+      w = variables.Variable(1.0)
+      with self.assertRaisesRegexp(ValueError, "not in var_list"):
+        delta_saver.DeltaSaver(var_list=[w], tracked_variables=[v])
+      with self.assertRaisesRegexp(ValueError, "known first dimension"):
+        delta_saver.DeltaSaver(var_list=[w], tracked_variables=[w])
+
+
+if __name__ == "__main__":
+  test.main()
@@ -32,6 +32,7 @@ from tensorflow.contrib.cudnn_rnn.python.ops import cudnn_rnn_ops
 from tensorflow.contrib.rnn.python.ops import rnn as contrib_rnn_lib
 from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
+from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import random_seed
@@ -322,6 +323,44 @@ class CudnnRNNTestBasic(test_util.TensorFlowTestCase):
       self.assertEqual(0, total_sum2_v)
       self.assertEqual(0, total_sum3_v)
 
+  @unittest.skipUnless(test.is_built_with_cuda(),
+                       "Test only applicable when running on GPUs")
+  def testVariableSequenceLengths(self):
+    num_layers = 2
+    num_units = 3
+    input_size = 4
+    seq_lengths = [5, 3, 1]
+    max_seq_length = max(seq_lengths)
+    batch_size = len(seq_lengths)
+    np.random.seed(0)
+    inputs_np = np.random.rand(max_seq_length, batch_size,
+                               input_size).astype(np.float32)
+
+    with ops.Graph().as_default(), self.test_session(use_gpu=True) as sess:
+      lstm = cudnn_rnn.CudnnLSTM(num_layers, num_units)
+      inputs = constant_op.constant(inputs_np)
+      outputs, (h, c) = lstm(inputs, sequence_lengths=seq_lengths)
+      input_grad, = gradients.gradients(math_ops.reduce_sum(outputs), inputs)
+      # Every sequence on its own, without padding.
+      unpadded = [
+          lstm(constant_op.constant(inputs_np[:length, b:b + 1]))
+          for b, length in enumerate(seq_lengths)
+      ]
+      sess.run(variables.global_variables_initializer())
+      outputs_v, h_v, c_v, input_grad_v, unpadded_v = sess.run(
+          [outputs, h, c, input_grad, unpadded])
+
+    for b, length in enumerate(seq_lengths):
+      expected_outputs, (expected_h, expected_c) = unpadded_v[b]
+      self.assertAllClose(expected_outputs[:, 0], outputs_v[:length, b])
+      self.assertAllEqual(
+          np.zeros([max_seq_length - length, num_units]), outputs_v[length:, b])
+      self.assertAllClose(expected_h[:, 0], h_v[:, b])
+      self.assertAllClose(expected_c[:, 0], c_v[:, b])
+      self.assertAllEqual(
+          np.zeros([max_seq_length - length, input_size]),
+          input_grad_v[length:, b])
+
   @unittest.skipUnless(test.is_built_with_cuda(),
                        "Test only applicable when running on GPUs")
   def testOptimizersSupport(self):
@@ -372,7 +372,8 @@ class _CudnnRNN(base_layer.Layer):
         "This cell does not yet support object-based saving. File a feature "
         "request if this limitation bothers you.")
 
-  def call(self, inputs, initial_state=None, training=True):
+  def call(self, inputs, initial_state=None, training=True,
+           sequence_lengths=None):
     """Runs the forward step for the RNN model.
 
     Args:
@@ -381,6 +382,10 @@ class _CudnnRNN(base_layer.Layer):
         `[num_layers * num_dirs, batch_size, num_units]`. If not provided, use
         zero initial states. The tuple size is 2 for LSTM and 1 for other RNNs.
       training: whether this operation will be used in training or inference.
+      sequence_lengths: an optional int32 vector of shape `[batch_size]` with
+        the length of every sequence, each in `[1, time_len]`. The padding
+        past it is then not computed, and the output states are those of the
+        last step of every sequence.
     Returns:
       output: a tensor of shape `[time_len, batch_size, num_dirs * num_units]`.
         It is a `concat([fwd_output, bak_output], axis=2)`.
@@ -409,7 +414,7 @@ class _CudnnRNN(base_layer.Layer):
       # For model that doesn't take input_c, replace with a dummy tensor.
       c = array_ops.constant([], dtype=dtype)
     outputs, (output_h, output_c) = self._forward(inputs, h, c, self.kernel,
-                                                  training)
+                                                  training, sequence_lengths)
     if self._rnn_mode == CUDNN_LSTM:
       return outputs, (output_h, output_c)
     else:
@@ -473,7 +478,8 @@ class _CudnnRNN(base_layer.Layer):
           dropout=self._dropout,
           direction=self._direction)
 
-  def _forward(self, inputs, h, c, opaque_params, training):
+  def _forward(self, inputs, h, c, opaque_params, training,
+               sequence_lengths=None):
     output, output_h, output_c = cudnn_rnn_ops._cudnn_rnn(  # pylint:disable=protected-access
         inputs,
         h,
@@ -484,7 +490,8 @@ class _CudnnRNN(base_layer.Layer):
         input_mode=self._input_mode,
         direction=self._direction,
         dropout=self._dropout,
-        seed=self._seed)
+        seed=self._seed,
+        sequence_lengths=sequence_lengths)
     return output, (output_h, output_c)
 
   def _create_saveable(self):
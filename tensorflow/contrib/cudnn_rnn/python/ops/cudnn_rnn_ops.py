@@ -867,7 +867,8 @@ def _cudnn_rnn(inputs,
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
                seed=0,
-               name=None):
+               name=None,
+               sequence_lengths=None):
   """Cudnn RNN.
 
   Args:
@@ -894,6 +895,10 @@ def _cudnn_rnn(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 vector of the length of every sequence
+      of the batch, each in [1, time_len]. The steps past the length of a
+      sequence are then skipped and zero in outputs, and output_h and output_c
+      are those of the last step of every sequence. Requires cuDNN 7.2.1.
   Returns:
     outputs, output_h, output_c
   """
@@ -918,7 +923,10 @@ def _cudnn_rnn(inputs,
       "seed2": seed2,
       "name": name
   }
-  if use_cudnn_v2 is not "1":
+  if sequence_lengths is not None:
+    args["sequence_lengths"] = sequence_lengths
+    outputs, output_h, output_c, _, _ = gen_cudnn_rnn_ops.cudnn_rnnv3(**args)
+  elif use_cudnn_v2 is not "1":
     outputs, output_h, output_c, _ = gen_cudnn_rnn_ops.cudnn_rnn(**args)
   else:
     outputs, output_h, output_c, _, _ = gen_cudnn_rnn_ops.cudnn_rnnv2(**args)
@@ -934,7 +942,8 @@ def cudnn_lstm(inputs,
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
                seed=0,
-               name=None):
+               name=None,
+               sequence_lengths=None):
   """Cudnn LSTM.
 
   Args:
@@ -960,11 +969,16 @@ def cudnn_lstm(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 vector of the length of every sequence
+      of the batch, each in [1, time_len]. The steps past the length of a
+      sequence are then skipped and zero in outputs, and output_h and output_c
+      are those of the last step of every sequence. Requires cuDNN 7.2.1.
   Returns:
     outputs, output_h, output_c
   """
   return _cudnn_rnn(inputs, input_h, input_c, params, is_training, CUDNN_LSTM,
-                    input_mode, direction, dropout, seed, name)
+                    input_mode, direction, dropout, seed, name,
+                    sequence_lengths)
 
 
 def _cudnn_rnn_no_input_c(inputs,
@@ -976,7 +990,8 @@ def _cudnn_rnn_no_input_c(inputs,
                           direction=CUDNN_RNN_UNIDIRECTION,
                           dropout=0.,
                           seed=0,
-                          name=None):
+                          name=None,
+                          sequence_lengths=None):
   """Cudnn RNN w/o input_c.
 
   Args:
@@ -1001,13 +1016,18 @@ def _cudnn_rnn_no_input_c(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 vector of the length of every sequence
+      of the batch, each in [1, time_len]. The steps past the length of a
+      sequence are then skipped and zero in outputs, and output_h is that of
+      the last step of every sequence. Requires cuDNN 7.2.1.
   Returns:
     outputs, output_h
   """
   input_c = array_ops.constant([], dtype=input_h.dtype)
   outputs, output_h, _ = _cudnn_rnn(inputs, input_h, input_c, params,
                                     is_training, rnn_mode, input_mode,
-                                    direction, dropout, seed, name)
+                                    direction, dropout, seed, name,
+                                    sequence_lengths)
   return outputs, output_h
 
 
@@ -1019,7 +1039,8 @@ def cudnn_gru(inputs,
               direction=CUDNN_RNN_UNIDIRECTION,
               dropout=0.,
               seed=0,
-              name=None):
+              name=None,
+              sequence_lengths=None):
   """Cudnn GRU.
 
   Args:
@@ -1043,11 +1064,16 @@ def cudnn_gru(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 vector of the length of every sequence
+      of the batch, each in [1, time_len]. The steps past the length of a
+      sequence are then skipped and zero in outputs, and output_h is that of
+      the last step of every sequence. Requires cuDNN 7.2.1.
   Returns:
     outputs, output_h
   """
   return _cudnn_rnn_no_input_c(inputs, input_h, params, is_training, CUDNN_GRU,
-                               input_mode, direction, dropout, seed, name)
+                               input_mode, direction, dropout, seed, name,
+                               sequence_lengths)
 
 
 def cudnn_rnn_relu(inputs,
@@ -1058,7 +1084,8 @@ def cudnn_rnn_relu(inputs,
                    direction=CUDNN_RNN_UNIDIRECTION,
                    dropout=0.,
                    seed=0,
-                   name=None):
+                   name=None,
+                   sequence_lengths=None):
   """Cudnn RNN Relu.
 
   Args:
@@ -1082,12 +1109,16 @@ def cudnn_rnn_relu(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 vector of the length of every sequence
+      of the batch, each in [1, time_len]. The steps past the length of a
+      sequence are then skipped and zero in outputs, and output_h is that of
+      the last step of every sequence. Requires cuDNN 7.2.1.
   Returns:
     outputs, output_h
   """
   return _cudnn_rnn_no_input_c(inputs, input_h, params, is_training,
                                CUDNN_RNN_RELU, input_mode, direction, dropout,
-                               seed, name)
+                               seed, name, sequence_lengths)
 
 
 def cudnn_rnn_tanh(inputs,
@@ -1098,7 +1129,8 @@ def cudnn_rnn_tanh(inputs,
                    direction=CUDNN_RNN_UNIDIRECTION,
                    dropout=0.,
                    seed=0,
-                   name=None):
+                   name=None,
+                   sequence_lengths=None):
   """Cudnn RNN Tanh.
 
   Args:
@@ -1122,12 +1154,16 @@ def cudnn_rnn_tanh(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 vector of the length of every sequence
+      of the batch, each in [1, time_len]. The steps past the length of a
+      sequence are then skipped and zero in outputs, and output_h is that of
+      the last step of every sequence. Requires cuDNN 7.2.1.
   Returns:
     outputs, output_h
   """
   return _cudnn_rnn_no_input_c(inputs, input_h, params, is_training,
                                CUDNN_RNN_TANH, input_mode, direction, dropout,
-                               seed, name)
+                               seed, name, sequence_lengths)
 
 
 def cudnn_rnn_opaque_params_to_canonical(rnn_mode,
@@ -24,6 +24,7 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 
 @@Counter
 @@CheckpointInputPipelineHook
+@@ColumnFileDataset
 @@CsvDataset
 @@SqlDataset
 
@@ -32,6 +33,7 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@bucket_by_sequence_length
 @@choose_from_datasets
 @@dense_to_sparse_batch
+@@dynamic_interleave
 @@enumerate_dataset
 @@group_by_window
 @@ignore_errors
@@ -41,6 +43,7 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@map_and_batch
 @@padded_batch_and_drop_remainder
 @@parallel_interleave
+@@parse_example_dataset
 @@prefetch_to_device
 @@read_batch_features
 @@rejection_resample
@@ -49,6 +52,8 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@shuffle_and_repeat
 @@sliding_window_batch
 @@sloppy_interleave
+@@snapshot
+@@spilling_shuffle
 @@unbatch
 
 @@get_single_element
@@ -72,12 +77,15 @@ from tensorflow.contrib.data.python.ops.error_ops import ignore_errors
 from tensorflow.contrib.data.python.ops.get_single_element import get_single_element
 from tensorflow.contrib.data.python.ops.grouping import bucket_by_sequence_length
 from tensorflow.contrib.data.python.ops.grouping import group_by_window
+from tensorflow.contrib.data.python.ops.interleave_ops import dynamic_interleave
 from tensorflow.contrib.data.python.ops.interleave_ops import parallel_interleave
 from tensorflow.contrib.data.python.ops.interleave_ops import sample_from_datasets
 from tensorflow.contrib.data.python.ops.interleave_ops import sloppy_interleave
 from tensorflow.contrib.data.python.ops.iterator_ops import CheckpointInputPipelineHook
 from tensorflow.contrib.data.python.ops.iterator_ops import make_saveable_from_iterator
+from tensorflow.contrib.data.python.ops.parsing_ops import parse_example_dataset
 from tensorflow.contrib.data.python.ops.prefetching_ops import prefetch_to_device
+from tensorflow.contrib.data.python.ops.readers import ColumnFileDataset
 from tensorflow.contrib.data.python.ops.readers import CsvDataset
 from tensorflow.contrib.data.python.ops.readers import make_batched_features_dataset
 from tensorflow.contrib.data.python.ops.readers import make_csv_dataset
@@ -86,7 +94,9 @@ from tensorflow.contrib.data.python.ops.readers import SqlDataset
 from tensorflow.contrib.data.python.ops.resampling import rejection_resample
 from tensorflow.contrib.data.python.ops.scan_ops import scan
 from tensorflow.contrib.data.python.ops.shuffle_ops import shuffle_and_repeat
+from tensorflow.contrib.data.python.ops.shuffle_ops import spilling_shuffle
 from tensorflow.contrib.data.python.ops.sliding import sliding_window_batch
+from tensorflow.contrib.data.python.ops.snapshot import snapshot
 # pylint: enable=unused-import
 
 from tensorflow.python.util.all_util import remove_undocumented
@@ -0,0 +1,367 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <map>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/util/example_proto_fast_parsing.h"
+#include "tensorflow/core/util/example_proto_helper.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit ParseExampleDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, attrs_.Init(ctx));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 num_parallel_calls;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "num_parallel_calls",
+                                                   &num_parallel_calls));
+    OP_REQUIRES(ctx, num_parallel_calls > 0,
+                errors::InvalidArgument(
+                    "num_parallel_calls must be greater than zero."));
+
+    OP_REQUIRES(ctx,
+                input->output_dtypes().size() == 1 &&
+                    input->output_dtypes()[0] == DT_STRING &&
+                    input->output_shapes()[0].IsCompatibleWith(
+                        PartialTensorShape({-1})),
+                errors::InvalidArgument(
+                    "ParseExampleDataset only supports inputs with a single "
+                    "`tf.string` vector component, but got types ",
+                    DataTypeVectorString(input->output_dtypes()),
+                    " and shapes ", input->output_shapes()[0].DebugString()));
+
+    OpInputList dense_default_tensors;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("dense_defaults", &dense_default_tensors));
+    OP_REQUIRES(ctx, dense_default_tensors.size() == attrs_.dense_keys.size(),
+                errors::InvalidArgument(
+                    "Expected len(dense_defaults) == len(dense_keys) but got: ",
+                    dense_default_tensors.size(), " vs. ",
+                    attrs_.dense_keys.size()));
+
+    const size_t num_dense = attrs_.dense_keys.size();
+    const size_t num_sparse = attrs_.sparse_keys.size();
+    for (size_t d = 0; d < num_dense; ++d) {
+      const Tensor& def_value = dense_default_tensors[d];
+      if (attrs_.variable_length[d]) {
+        OP_REQUIRES(ctx, def_value.NumElements() == 1,
+                    errors::InvalidArgument(
+                        "dense_shape[", d, "] is a variable length shape: ",
+                        attrs_.dense_shapes[d].DebugString(),
+                        ", therefore def_value[", d,
+                        "] must contain a single element (the padding "
+                        "element). But its shape is: ",
+                        def_value.shape().DebugString()));
+      } else if (def_value.NumElements() > 0) {
+        OP_REQUIRES(ctx,
+                    attrs_.dense_shapes[d].IsCompatibleWith(def_value.shape()),
+                    errors::InvalidArgument(
+                        "def_value[", d,
+                        "].shape() == ", def_value.shape().DebugString(),
+                        " is not compatible with dense_shapes_[", d,
+                        "] == ", attrs_.dense_shapes[d].DebugString()));
+      }
+      OP_REQUIRES(ctx, def_value.dtype() == attrs_.dense_types[d],
+                  errors::InvalidArgument(
+                      "dense_defaults[", d, "].dtype() == ",
+                      DataTypeString(def_value.dtype()), " != dense_types_[",
+                      d, "] == ", DataTypeString(attrs_.dense_types[d])));
+    }
+
+    // The components of an element are the parsed features in the order of
+    // their keys, which matches the order in which the Python API flattens
+    // the dictionary of features.
+    std::map<string, int> key_to_output_index;
+    for (const string& key : attrs_.sparse_keys) {
+      key_to_output_index.insert({key, 0});
+    }
+    for (const string& key : attrs_.dense_keys) {
+      key_to_output_index.insert({key, 0});
+    }
+    OP_REQUIRES(ctx, key_to_output_index.size() == num_dense + num_sparse,
+                errors::InvalidArgument(
+                    "Dense and sparse keys must be distinct."));
+    OP_REQUIRES(ctx, output_types_.size() == key_to_output_index.size(),
+                errors::InvalidArgument(
+                    "Expected ", key_to_output_index.size(),
+                    " output types, but got ", output_types_.size()));
+    int index = 0;
+    for (auto& key_and_index : key_to_output_index) {
+      key_and_index.second = index++;
+    }
+
+    example::FastParseExampleConfig config;
+    std::vector<int> dense_output_index(num_dense);
+    for (size_t d = 0; d < num_dense; ++d) {
+      config.dense.push_back({attrs_.dense_keys[d], attrs_.dense_types[d],
+                              attrs_.dense_shapes[d], dense_default_tensors[d],
+                              attrs_.variable_length[d],
+                              attrs_.elements_per_stride[d]});
+      dense_output_index[d] = key_to_output_index[attrs_.dense_keys[d]];
+      OP_REQUIRES(ctx, output_types_[dense_output_index[d]] ==
+                           attrs_.dense_types[d],
+                  errors::InvalidArgument(
+                      "Expected output type ",
+                      DataTypeString(attrs_.dense_types[d]), " for feature ",
+                      attrs_.dense_keys[d], ", but got ",
+                      DataTypeString(output_types_[dense_output_index[d]])));
+    }
+    std::vector<int> sparse_output_index(num_sparse);
+    for (size_t d = 0; d < num_sparse; ++d) {
+      config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
+      sparse_output_index[d] = key_to_output_index[attrs_.sparse_keys[d]];
+      OP_REQUIRES(ctx, output_types_[sparse_output_index[d]] == DT_VARIANT,
+                  errors::InvalidArgument(
+                      "Expected output type variant for sparse feature ",
+                      attrs_.sparse_keys[d], ", but got ",
+                      DataTypeString(output_types_[sparse_output_index[d]])));
+    }
+
+    std::vector<Tensor> dense_defaults;
+    dense_defaults.reserve(num_dense);
+    for (const Tensor& dense_default : dense_default_tensors) {
+      dense_defaults.push_back(dense_default);
+    }
+    *output = new Dataset(ctx, input, num_parallel_calls, attrs_,
+                          std::move(dense_defaults), std::move(config),
+                          std::move(dense_output_index),
+                          std::move(sparse_output_index), output_types_,
+                          output_shapes_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            int64 num_parallel_calls, const ParseSingleExampleAttrs& attrs,
+            std::vector<Tensor> dense_defaults,
+            example::FastParseExampleConfig config,
+            std::vector<int> dense_output_index,
+            std::vector<int> sparse_output_index,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          input_(input),
+          num_parallel_calls_(num_parallel_calls),
+          attrs_(attrs),
+          dense_defaults_(std::move(dense_defaults)),
+          config_(std::move(config)),
+          dense_output_index_(std::move(dense_output_index)),
+          sparse_output_index_(std::move(sparse_output_index)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::ParseExample")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ParseExampleDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* num_parallel_calls_node;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(num_parallel_calls_, &num_parallel_calls_node));
+      std::vector<Node*> dense_defaults_nodes;
+      dense_defaults_nodes.reserve(dense_defaults_.size());
+      for (const Tensor& dense_default : dense_defaults_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(dense_default, &node));
+        dense_defaults_nodes.emplace_back(node);
+      }
+      AttrValue num_sparse_attr;
+      b->BuildAttrValue(static_cast<int64>(attrs_.sparse_keys.size()),
+                        &num_sparse_attr);
+      AttrValue sparse_keys_attr;
+      b->BuildAttrValue(attrs_.sparse_keys, &sparse_keys_attr);
+      AttrValue dense_keys_attr;
+      b->BuildAttrValue(attrs_.dense_keys, &dense_keys_attr);
+      AttrValue sparse_types_attr;
+      b->BuildAttrValue(attrs_.sparse_types, &sparse_types_attr);
+      AttrValue dense_types_attr;
+      b->BuildAttrValue(attrs_.dense_types, &dense_types_attr);
+      AttrValue dense_shapes_attr;
+      b->BuildAttrValue(attrs_.dense_shapes, &dense_shapes_attr);
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this,
+                        {std::make_pair(0, input_graph_node),
+                         std::make_pair(1, num_parallel_calls_node)},
+                        {std::make_pair(2, dense_defaults_nodes)},
+                        {{"num_sparse", num_sparse_attr},
+                         {"sparse_keys", sparse_keys_attr},
+                         {"dense_keys", dense_keys_attr},
+                         {"sparse_types", sparse_types_attr},
+                         {"Tdense", dense_types_attr},
+                         {"dense_shapes", dense_shapes_attr}},
+                        output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        // The calling thread parses a share of each batch too, so a pool of
+        // `num_parallel_calls - 1` threads gives the requested parallelism.
+        if (dataset()->num_parallel_calls_ > 1) {
+          thread_pool_.reset(new thread::ThreadPool(
+              ctx->env(), ThreadOptions(), "parse_example_dataset",
+              dataset()->num_parallel_calls_ - 1,
+              false /* low_latency_hint */));
+        }
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        std::vector<Tensor> input;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &input, end_of_sequence));
+        if (*end_of_sequence) {
+          input_impl_.reset();
+          return Status::OK();
+        }
+        const Tensor& serialized = input[0];
+        if (!TensorShapeUtils::IsVector(serialized.shape())) {
+          return errors::InvalidArgument(
+              "ParseExampleDataset expects a vector of serialized Example "
+              "protos, but got shape: ",
+              serialized.shape().DebugString());
+        }
+
+        // `FastParseExample()` writes fixed-length dense features straight
+        // into their output tensors, and shards the batch across the pool.
+        auto serialized_t = serialized.flat<string>();
+        gtl::ArraySlice<string> slice(serialized_t.data(),
+                                      serialized_t.size());
+        example::Result result;
+        TF_RETURN_IF_ERROR(example::FastParseExample(
+            dataset()->config_, slice, {}, thread_pool_.get(), &result));
+
+        out_tensors->resize(dataset()->output_types_.size());
+        for (size_t d = 0; d < result.dense_values.size(); ++d) {
+          (*out_tensors)[dataset()->dense_output_index_[d]] =
+              std::move(result.dense_values[d]);
+        }
+        // Sparse features are produced in the variant encoding of
+        // `tf.SparseTensor` components used by `tf.data`.
+        for (size_t d = 0; d < result.sparse_indices.size(); ++d) {
+          Tensor sparse(DT_VARIANT, TensorShape({3}));
+          auto sparse_t = sparse.vec<Variant>();
+          sparse_t(0) = std::move(result.sparse_indices[d]);
+          sparse_t(1) = std::move(result.sparse_values[d]);
+          sparse_t(2) = std::move(result.sparse_shapes[d]);
+          (*out_tensors)[dataset()->sparse_output_index_[d]] =
+              std::move(sparse);
+        }
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        if (input_impl_) {
+          TF_RETURN_IF_ERROR(SaveParent(writer, input_impl_));
+        } else {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("input_impl_empty"), ""));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        if (!reader->Contains(full_name("input_impl_empty"))) {
+          TF_RETURN_IF_ERROR(RestoreParent(ctx, reader, input_impl_));
+        } else {
+          input_impl_.reset();
+        }
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<thread::ThreadPool> thread_pool_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const int64 num_parallel_calls_;
+    const ParseSingleExampleAttrs attrs_;
+    const std::vector<Tensor> dense_defaults_;
+    const example::FastParseExampleConfig config_;
+    const std::vector<int> dense_output_index_;
+    const std::vector<int> sparse_output_index_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  ParseSingleExampleAttrs attrs_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ParseExampleDataset").Device(DEVICE_CPU),
+                        ParseExampleDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,658 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level description of
+// the following op.
+
+// A snapshot of a dataset lives in `<path>/<fingerprint>`, where the
+// fingerprint identifies the graph of the dataset. The directory contains:
+//
+// * `<run>/shard_<i>-of-<n>`: the elements i, i + n, i + 2n, ... of the
+//   dataset, as written by the writer with the random id `<run>`. Each
+//   element is a sequence of records, one serialized `TensorProto` per
+//   component.
+// * `snapshot.metadata`: "<run> <n>", which names the run that completed the
+//   snapshot. It is published atomically, after all shards were closed, and
+//   readers never look at a run that it does not name.
+// * `writer.lease`: "<run>", the run that currently writes the snapshot.
+//   Its writer rewrites it periodically, and a lease that is older than
+//   `kLeaseTimeoutMicros` belongs to a writer that died before it completed
+//   the snapshot.
+constexpr char kMetadataFilename[] = "snapshot.metadata";
+constexpr char kLeaseFilename[] = "writer.lease";
+constexpr int64 kLeaseRefreshMicros = 10 * 1000 * 1000;
+constexpr int64 kLeaseTimeoutMicros = 6 * kLeaseRefreshMicros;
+// The number of elements that may wait to be written to each shard before
+// the iterator blocks.
+constexpr size_t kMaxPendingElements = 64;
+constexpr size_t kReadBufferSize = 256 << 10;
+
+string ShardFilename(const string& run_dir, int64 shard, int64 num_shards) {
+  return io::JoinPath(
+      run_dir, strings::Printf("shard_%05lld-of-%05lld",
+                               static_cast<long long>(shard),
+                               static_cast<long long>(num_shards)));
+}
+
+string NewRunId() {
+  return strings::StrCat(strings::Hex(random::New64(), strings::ZERO_PAD_16));
+}
+
+bool IsRunId(const string& run) {
+  return !run.empty() && run.find_first_not_of("0123456789abcdef") ==
+                             string::npos;
+}
+
+// Writes `contents` to `filename` so that readers see either the previous or
+// the new contents.
+Status AtomicallyWriteStringToFile(Env* env, const string& filename,
+                                   const string& contents) {
+  const string tmp_filename = strings::StrCat(filename, ".tmp-", NewRunId());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  Status s = env->RenameFile(tmp_filename, filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+// Returns NotFound if no run completed the snapshot in `dir`.
+Status ReadMetadata(Env* env, const string& dir, string* run,
+                    int64* num_shards) {
+  const string filename = io::JoinPath(dir, kMetadataFilename);
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &contents));
+  std::vector<string> parts = str_util::Split(contents, ' ');
+  if (parts.size() != 2 || !IsRunId(parts[0]) ||
+      !strings::safe_strto64(parts[1], num_shards) || *num_shards <= 0) {
+    return errors::DataLoss("Invalid snapshot metadata in ", filename, ": ",
+                            contents);
+  }
+  *run = parts[0];
+  return Status::OK();
+}
+
+// Takes the lease on writing the snapshot in `dir` for `run`, unless another
+// writer holds a live lease. A stale lease is taken over, and the partial
+// snapshot of its run is deleted.
+Status AcquireLease(Env* env, const string& dir, const string& run,
+                    bool* acquired) {
+  const string filename = io::JoinPath(dir, kLeaseFilename);
+  FileStatistics stat;
+  Status s = env->Stat(filename, &stat);
+  if (s.ok()) {
+    const int64 age_micros =
+        static_cast<int64>(env->NowMicros()) - stat.mtime_nsec / 1000;
+    if (age_micros < kLeaseTimeoutMicros) {
+      *acquired = false;
+      return Status::OK();
+    }
+    string stale_run;
+    if (ReadFileToString(env, filename, &stale_run).ok() &&
+        IsRunId(stale_run)) {
+      LOG(WARNING) << "Deleting the partial snapshot "
+                   << io::JoinPath(dir, stale_run)
+                   << ", whose writer did not renew its lease for "
+                   << age_micros / 1000000 << " seconds.";
+      int64 undeleted_files, undeleted_dirs;
+      env->DeleteRecursively(io::JoinPath(dir, stale_run), &undeleted_files,
+                             &undeleted_dirs)
+          .IgnoreError();
+    }
+  } else if (!errors::IsNotFound(s)) {
+    return s;
+  }
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(env, filename, run));
+  *acquired = true;
+  return Status::OK();
+}
+
+// Deletes the lease on `dir` if it still belongs to `run`.
+void ReleaseLease(Env* env, const string& dir, const string& run) {
+  const string filename = io::JoinPath(dir, kLeaseFilename);
+  string holder;
+  if (ReadFileToString(env, filename, &holder).ok() && holder == run) {
+    env->DeleteFile(filename).IgnoreError();
+  }
+}
+
+// Writes the elements of a dataset to the shards of a new run, with one
+// thread per shard, and publishes the run once all elements were written.
+//
+// This class is thread-compatible.
+class SnapshotWriter {
+ public:
+  SnapshotWriter(Env* env, const string& dir, const string& run,
+                 int64 num_shards)
+      : env_(env),
+        dir_(dir),
+        run_(run),
+        run_dir_(io::JoinPath(dir, run)),
+        shards_(num_shards) {}
+
+  // Abandons the run, unless it was committed.
+  ~SnapshotWriter() {
+    if (committed_) return;
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+    }
+    for (Shard& shard : shards_) {
+      shard.thread.reset();
+    }
+    shards_.clear();
+    int64 undeleted_files, undeleted_dirs;
+    env_->DeleteRecursively(run_dir_, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+    ReleaseLease(env_, dir_, run_);
+  }
+
+  Status Start() {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(run_dir_));
+    for (int64 i = 0; i < shards_.size(); ++i) {
+      Shard* shard = &shards_[i];
+      TF_RETURN_IF_ERROR(env_->NewWritableFile(
+          ShardFilename(run_dir_, i, shards_.size()), &shard->file));
+      shard->writer.reset(new io::RecordWriter(shard->file.get()));
+      shard->thread.reset(env_->StartThread(
+          ThreadOptions(), strings::StrCat("snapshot_writer_", i),
+          [this, shard]() { ShardThread(shard); }));
+    }
+    last_lease_refresh_micros_ = env_->NowMicros();
+    return Status::OK();
+  }
+
+  // Queues `element` for its shard, and blocks while that shard is behind.
+  Status Write(const std::vector<Tensor>& element) {
+    MaybeRefreshLease();
+    Shard* shard = &shards_[num_elements_ % shards_.size()];
+    ++num_elements_;
+    mutex_lock l(mu_);
+    while (status_.ok() && shard->pending.size() >= kMaxPendingElements) {
+      cond_var_.wait(l);
+    }
+    TF_RETURN_IF_ERROR(status_);
+    shard->pending.push_back(element);
+    cond_var_.notify_all();
+    return Status::OK();
+  }
+
+  // Waits for all elements to be written, and publishes the run.
+  Status Commit() {
+    {
+      mutex_lock l(mu_);
+      finished_ = true;
+      cond_var_.notify_all();
+    }
+    for (Shard& shard : shards_) {
+      shard.thread.reset();
+    }
+    {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(status_);
+    }
+    for (Shard& shard : shards_) {
+      TF_RETURN_IF_ERROR(shard.writer->Close());
+      TF_RETURN_IF_ERROR(shard.file->Close());
+    }
+    TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(
+        env_, io::JoinPath(dir_, kMetadataFilename),
+        strings::StrCat(run_, " ", shards_.size())));
+    committed_ = true;
+    ReleaseLease(env_, dir_, run_);
+    LOG(INFO) << "Wrote a snapshot of " << num_elements_ << " elements to "
+              << run_dir_;
+    return Status::OK();
+  }
+
+ private:
+  struct Shard {
+    std::unique_ptr<WritableFile> file;
+    std::unique_ptr<io::RecordWriter> writer;
+    std::deque<std::vector<Tensor>> pending;  // guarded by mu_
+    std::unique_ptr<Thread> thread;
+  };
+
+  void MaybeRefreshLease() {
+    const uint64 now = env_->NowMicros();
+    if (now - last_lease_refresh_micros_ < kLeaseRefreshMicros) return;
+    last_lease_refresh_micros_ = now;
+    Status s = AtomicallyWriteStringToFile(
+        env_, io::JoinPath(dir_, kLeaseFilename), run_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to refresh the lease on " << dir_ << ": " << s;
+    }
+  }
+
+  void ShardThread(Shard* shard) {
+    while (true) {
+      std::vector<Tensor> element;
+      {
+        mutex_lock l(mu_);
+        while (!cancelled_ && !finished_ && shard->pending.empty()) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_ || !status_.ok() || shard->pending.empty()) return;
+        element = std::move(shard->pending.front());
+        shard->pending.pop_front();
+        cond_var_.notify_all();
+      }
+      Status s = WriteElement(shard, element);
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+        cond_var_.notify_all();
+        return;
+      }
+    }
+  }
+
+  Status WriteElement(Shard* shard, const std::vector<Tensor>& element) {
+    string record;
+    for (const Tensor& t : element) {
+      TensorProto proto;
+      t.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&record)) {
+        return errors::Internal("Failed to serialize a tensor of shape ",
+                                t.shape().DebugString());
+      }
+      TF_RETURN_IF_ERROR(shard->writer->WriteRecord(record));
+    }
+    return Status::OK();
+  }
+
+  Env* const env_;
+  const string dir_;
+  const string run_;
+  const string run_dir_;
+  std::vector<Shard> shards_;
+  int64 num_elements_ = 0;
+  uint64 last_lease_refresh_micros_ = 0;
+  bool committed_ = false;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool finished_ GUARDED_BY(mu_) = false;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  Status status_ GUARDED_BY(mu_);
+};
+
+// Reads the elements of a completed run, in the order in which they were
+// written, by reading its shards in turns.
+//
+// This class is thread-compatible.
+class SnapshotReader {
+ public:
+  SnapshotReader(const DataTypeVector& dtypes, int64 num_shards)
+      : dtypes_(dtypes), files_(num_shards), readers_(num_shards) {}
+
+  Status Open(Env* env, const string& run_dir) {
+    io::RecordReaderOptions options;
+    options.buffer_size = kReadBufferSize;
+    for (int64 i = 0; i < files_.size(); ++i) {
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+          ShardFilename(run_dir, i, files_.size()), &files_[i]));
+      readers_[i].reset(
+          new io::SequentialRecordReader(files_[i].get(), options));
+    }
+    return Status::OK();
+  }
+
+  Status Read(std::vector<Tensor>* out_tensors, bool* end_of_sequence) {
+    io::SequentialRecordReader* reader =
+        readers_[next_element_ % readers_.size()].get();
+    string record;
+    out_tensors->reserve(dtypes_.size());
+    for (size_t i = 0; i < dtypes_.size(); ++i) {
+      Status s = reader->ReadRecord(&record);
+      if (errors::IsOutOfRange(s) && i == 0) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      if (errors::IsOutOfRange(s)) {
+        return errors::DataLoss("Truncated snapshot element ", next_element_);
+      }
+      TF_RETURN_IF_ERROR(s);
+      TensorProto proto;
+      Tensor t;
+      if (!proto.ParseFromString(record) || !t.FromProto(proto) ||
+          t.dtype() != dtypes_[i]) {
+        return errors::DataLoss("Invalid component ", i,
+                                " of snapshot element ", next_element_);
+      }
+      out_tensors->push_back(std::move(t));
+    }
+    ++next_element_;
+    *end_of_sequence = false;
+    return Status::OK();
+  }
+
+  int64 next_element() const { return next_element_; }
+  uint64 offset(int64 shard) const { return readers_[shard]->TellOffset(); }
+
+  // Continues reading from the given position of a reader of the same run.
+  Status Seek(int64 next_element, const std::vector<uint64>& offsets) {
+    next_element_ = next_element;
+    for (int64 i = 0; i < readers_.size(); ++i) {
+      TF_RETURN_IF_ERROR(readers_[i]->SeekOffset(offsets[i]));
+    }
+    return Status::OK();
+  }
+
+ private:
+  const DataTypeVector dtypes_;
+  std::vector<std::unique_ptr<RandomAccessFile>> files_;
+  std::vector<std::unique_ptr<io::SequentialRecordReader>> readers_;
+  int64 next_element_ = 0;
+};
+
+class SnapshotDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit SnapshotDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    string path;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "path", &path));
+    OP_REQUIRES(ctx, !path.empty(),
+                errors::InvalidArgument("`path` must not be empty."));
+    int64 num_shards;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "num_shards", &num_shards));
+    OP_REQUIRES(ctx, num_shards > 0,
+                errors::InvalidArgument("`num_shards` must be > 0"));
+    string fingerprint;
+    OP_REQUIRES_OK(ctx, Dataset::Fingerprint(ctx, input, &fingerprint));
+    *output = new Dataset(ctx, input, path, num_shards,
+                          io::JoinPath(path, fingerprint));
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, const string& path,
+            int64 num_shards, const string& dir)
+        : GraphDatasetBase(ctx),
+          input_(input),
+          path_(path),
+          num_shards_(num_shards),
+          dir_(dir),
+          env_(ctx->env()) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    // Returns a fingerprint of the graph that defines `input`, which does not
+    // depend on where or by which program the graph was built.
+    static Status Fingerprint(OpKernelContext* ctx, const DatasetBase* input,
+                              string* fingerprint) {
+      GraphDefBuilder b;
+      DatasetGraphDefBuilder db(&b);
+      Node* node = nullptr;
+      Status s = db.AddParentDataset(ctx, input, &node);
+      if (!s.ok()) {
+        return errors::InvalidArgument(
+            "Cannot snapshot a dataset whose graph cannot be serialized: ",
+            s.error_message());
+      }
+      GraphDef graph_def;
+      TF_RETURN_IF_ERROR(b.ToGraphDef(&graph_def));
+      string serialized;
+      if (!SerializeToStringDeterministic(graph_def, &serialized)) {
+        return errors::Internal("Failed to serialize the input dataset graph");
+      }
+      *fingerprint = strings::StrCat(
+          strings::Hex(Fingerprint64(serialized), strings::ZERO_PAD_16));
+      return Status::OK();
+    }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Snapshot")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "SnapshotDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* path = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(path_, &path));
+      Node* num_shards = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(num_shards_, &num_shards));
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {input_graph_node, path, num_shards}, output));
+      return Status::OK();
+    }
+
+   private:
+    // The iterator decides how to produce its elements when it produces the
+    // first one, or when it is restored:
+    //
+    // * If the snapshot is complete, it reads it.
+    // * Otherwise, if no other writer is writing the snapshot, it writes a
+    //   new run while it passes on the elements of the input.
+    // * Otherwise, it only passes on the elements of the input.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      enum class Mode : int64 { kUnknown, kRead, kWrite, kPassthrough };
+
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (mode_ == Mode::kUnknown) {
+          TF_RETURN_IF_ERROR(ChooseMode(ctx));
+        }
+        if (mode_ == Mode::kRead) {
+          return reader_->Read(out_tensors, end_of_sequence);
+        }
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (writer_) {
+          if (*end_of_sequence) {
+            TF_RETURN_IF_ERROR(writer_->Commit());
+          } else {
+            TF_RETURN_IF_ERROR(writer_->Write(*out_tensors));
+          }
+        }
+        if (*end_of_sequence) {
+          writer_.reset();
+          input_impl_.reset();
+        }
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        if (mode_ == Mode::kWrite && writer_) {
+          return errors::Unimplemented(
+              "Saving the iterator of a SnapshotDataset while it writes the "
+              "snapshot is not supported.");
+        }
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("mode"),
+                                               static_cast<int64>(mode_)));
+        if (mode_ == Mode::kRead) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("run"), run_));
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("num_shards"), num_shards_));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("next_element"),
+                                                 reader_->next_element()));
+          for (int64 i = 0; i < num_shards_; ++i) {
+            TF_RETURN_IF_ERROR(
+                writer->WriteScalar(full_name(strings::StrCat("offset_", i)),
+                                    static_cast<int64>(reader_->offset(i))));
+          }
+        } else if (input_impl_) {
+          TF_RETURN_IF_ERROR(SaveParent(writer, input_impl_));
+        } else if (mode_ != Mode::kUnknown) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("end_of_sequence"), ""));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        writer_.reset();
+        reader_.reset();
+        input_impl_.reset();
+        int64 mode;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("mode"), &mode));
+        mode_ = static_cast<Mode>(mode);
+        if (mode_ == Mode::kRead) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("run"), &run_));
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("num_shards"), &num_shards_));
+          int64 next_element;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("next_element"), &next_element));
+          std::vector<uint64> offsets(num_shards_);
+          for (int64 i = 0; i < num_shards_; ++i) {
+            int64 offset;
+            TF_RETURN_IF_ERROR(reader->ReadScalar(
+                full_name(strings::StrCat("offset_", i)), &offset));
+            offsets[i] = offset;
+          }
+          TF_RETURN_IF_ERROR(OpenReader());
+          return reader_->Seek(next_element, offsets);
+        }
+        if (mode_ == Mode::kUnknown ||
+            reader->Contains(full_name("end_of_sequence"))) {
+          return Status::OK();
+        }
+        // The iterator continues from its input, and only writes a snapshot
+        // the next time it is created.
+        mode_ = Mode::kPassthrough;
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
+        return RestoreParent(ctx, reader, input_impl_);
+      }
+
+     private:
+      Status ChooseMode(IteratorContext* ctx) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Env* env = dataset()->env_;
+        const string& dir = dataset()->dir_;
+        Status s = ReadMetadata(env, dir, &run_, &num_shards_);
+        if (s.ok()) {
+          mode_ = Mode::kRead;
+          return OpenReader();
+        }
+        if (!errors::IsNotFound(s)) return s;
+
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
+        const string run = NewRunId();
+        bool acquired;
+        TF_RETURN_IF_ERROR(AcquireLease(env, dir, run, &acquired));
+        if (!acquired) {
+          LOG(INFO) << "Another writer is writing the snapshot in " << dir
+                    << ", computing the input instead.";
+          mode_ = Mode::kPassthrough;
+          return Status::OK();
+        }
+        // A writer may have completed the snapshot while we took the lease.
+        if (ReadMetadata(env, dir, &run_, &num_shards_).ok()) {
+          ReleaseLease(env, dir, run);
+          input_impl_.reset();
+          mode_ = Mode::kRead;
+          return OpenReader();
+        }
+        writer_.reset(
+            new SnapshotWriter(env, dir, run, dataset()->num_shards_));
+        TF_RETURN_IF_ERROR(writer_->Start());
+        mode_ = Mode::kWrite;
+        return Status::OK();
+      }
+
+      Status OpenReader() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        reader_.reset(
+            new SnapshotReader(dataset()->output_dtypes(), num_shards_));
+        return reader_->Open(dataset()->env_,
+                             io::JoinPath(dataset()->dir_, run_));
+      }
+
+      mutex mu_;
+      Mode mode_ GUARDED_BY(mu_) = Mode::kUnknown;
+      // The run that is read, in `Mode::kRead`.
+      string run_ GUARDED_BY(mu_);
+      int64 num_shards_ GUARDED_BY(mu_) = 0;
+      std::unique_ptr<SnapshotReader> reader_ GUARDED_BY(mu_);
+      std::unique_ptr<SnapshotWriter> writer_ GUARDED_BY(mu_);
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const string path_;
+    const int64 num_shards_;
+    // The directory of the snapshot of `input_`.
+    const string dir_;
+    Env* const env_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("SnapshotDataset").Device(DEVICE_CPU),
+                        SnapshotDatasetOp);
+
+}  // namespace
+}  // namespace tensorflow
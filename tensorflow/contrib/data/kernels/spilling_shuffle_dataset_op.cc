@@ -0,0 +1,609 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <map>
+#include <set>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level description of
+// the following op.
+
+// The size at which a scratch file is closed, and a new one is started.
+constexpr int64 kSegmentBytes = 64 << 20;
+
+// Serializes `element` as a sequence of length-prefixed `TensorProto`s.
+void SerializeElement(const std::vector<Tensor>& element, string* record) {
+  record->clear();
+  TensorProto proto;
+  string serialized;
+  for (const Tensor& t : element) {
+    proto.Clear();
+    t.AsProtoTensorContent(&proto);
+    proto.SerializeToString(&serialized);
+    core::PutVarint64(record, serialized.size());
+    record->append(serialized);
+  }
+}
+
+Status ParseElement(StringPiece record, size_t num_components,
+                    std::vector<Tensor>* element) {
+  element->clear();
+  element->reserve(num_components);
+  TensorProto proto;
+  for (size_t i = 0; i < num_components; ++i) {
+    uint64 length;
+    if (!core::GetVarint64(&record, &length) || length > record.size() ||
+        !proto.ParseFromArray(record.data(), length)) {
+      return errors::DataLoss("Corrupted shuffle scratch record.");
+    }
+    record.remove_prefix(length);
+    element->emplace_back();
+    if (!element->back().FromProto(cpu_allocator(), proto)) {
+      return errors::DataLoss("Corrupted tensor in shuffle scratch record.");
+    }
+  }
+  return Status::OK();
+}
+
+class SpillingShuffleDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit SpillingShuffleDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    int64 buffer_size_bytes;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "buffer_size_bytes",
+                                                   &buffer_size_bytes));
+    OP_REQUIRES(ctx, buffer_size > 0 || buffer_size_bytes > 0,
+                errors::InvalidArgument(
+                    "At least one of buffer_size and buffer_size_bytes must "
+                    "be greater than zero."));
+    int64 memory_budget_bytes;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "memory_budget_bytes",
+                                                   &memory_budget_bytes));
+    OP_REQUIRES(ctx, memory_budget_bytes >= 0,
+                errors::InvalidArgument(
+                    "memory_budget_bytes must be greater than or equal to "
+                    "zero."));
+    string scratch_dir;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<string>(ctx, "scratch_dir", &scratch_dir));
+    if (scratch_dir.empty()) {
+      std::vector<string> dirs;
+      ctx->env()->GetLocalTempDirectories(&dirs);
+      OP_REQUIRES(ctx, !dirs.empty(),
+                  errors::NotFound("No local temporary directory found for "
+                                   "the shuffle scratch files."));
+      scratch_dir = dirs[0];
+    }
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+    // By TensorFlow convention, passing 0 for both seeds indicates
+    // that the shuffling should be seeded non-deterministically.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, input, buffer_size, buffer_size_bytes,
+                          memory_budget_bytes, scratch_dir, seed, seed2);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
+            int64 buffer_size_bytes, int64 memory_budget_bytes,
+            const string& scratch_dir, int64 seed, int64 seed2)
+        : GraphDatasetBase(ctx),
+          input_(input),
+          buffer_size_(buffer_size),
+          buffer_size_bytes_(buffer_size_bytes),
+          memory_budget_bytes_(memory_budget_bytes),
+          scratch_dir_(scratch_dir),
+          seed_(seed),
+          seed2_(seed2),
+          parent_generator_(seed, seed2),
+          generator_(&parent_generator_) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      // Each iterator shuffles differently, as with
+      // `reshuffle_each_iteration=True` in `ShuffleDataset`.
+      int64 iterator_seed;
+      int64 iterator_seed2;
+      {
+        mutex_lock l(mu_);
+        iterator_seed = generator_();
+        iterator_seed2 = generator_();
+      }
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::SpillingShuffle")},
+                       iterator_seed, iterator_seed2));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return strings::StrCat("SpillingShuffleDatasetOp(", buffer_size_, ", ",
+                             buffer_size_bytes_, ", ", memory_budget_bytes_,
+                             ")::Dataset");
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      Node* buffer_size_bytes = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_bytes_, &buffer_size_bytes));
+      Node* memory_budget_bytes = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(memory_budget_bytes_, &memory_budget_bytes));
+      Node* scratch_dir = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(scratch_dir_, &scratch_dir));
+      Node* seed = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      Node* seed2 = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {input_graph_node, buffer_size, buffer_size_bytes,
+           memory_budget_bytes, scratch_dir, seed, seed2},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    // Stores the serialized elements that do not fit in the memory budget in
+    // a sequence of scratch files ("segments"). Records are only ever
+    // appended to the newest segment; once a segment is full it is closed
+    // and read through a memory mapping. A closed segment whose live records
+    // take up less than half of it is compacted by moving them to the newest
+    // segment, which bounds the disk space to about twice the size of the
+    // spilled elements.
+    class ScratchStore {
+     public:
+      // The location of a record.
+      struct Location {
+        int64 segment;
+        int64 offset;
+        int64 length;
+      };
+
+      ScratchStore(Env* env, const string& prefix)
+          : env_(env), prefix_(prefix) {}
+
+      ~ScratchStore() {
+        for (auto& segment : segments_) {
+          segment.second.writer.reset();
+          segment.second.region.reset();
+          env_->DeleteFile(segment.second.filename).IgnoreError();
+        }
+      }
+
+      Status Append(const string& record, Location* location) {
+        if (segments_.empty() || !segments_.rbegin()->second.writer) {
+          TF_RETURN_IF_ERROR(StartSegment());
+        }
+        const int64 id = segments_.rbegin()->first;
+        Segment* segment = &segments_.rbegin()->second;
+        TF_RETURN_IF_ERROR(segment->writer->Append(record));
+        *location = {id, segment->size, static_cast<int64>(record.size())};
+        segment->size += record.size();
+        segment->live_bytes += record.size();
+        segment->unflushed = true;
+        if (segment->size >= kSegmentBytes) {
+          TF_RETURN_IF_ERROR(segment->writer->Close());
+          segment->writer.reset();
+          segment->file.reset();
+          TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+              segment->filename, &segment->region));
+        }
+        return Status::OK();
+      }
+
+      Status Read(const Location& location, string* scratch,
+                  StringPiece* record) {
+        Segment* segment = &segments_.at(location.segment);
+        if (segment->region) {
+          *record = StringPiece(
+              static_cast<const char*>(segment->region->data()) +
+                  location.offset,
+              location.length);
+          return Status::OK();
+        }
+        if (segment->unflushed) {
+          TF_RETURN_IF_ERROR(segment->writer->Flush());
+          segment->unflushed = false;
+        }
+        if (!segment->file) {
+          TF_RETURN_IF_ERROR(
+              env_->NewRandomAccessFile(segment->filename, &segment->file));
+        }
+        scratch->resize(location.length);
+        TF_RETURN_IF_ERROR(segment->file->Read(location.offset,
+                                               location.length, record,
+                                               &(*scratch)[0]));
+        if (record->size() != location.length) {
+          return errors::DataLoss("Truncated shuffle scratch file ",
+                                  segment->filename);
+        }
+        return Status::OK();
+      }
+
+      // Marks the record at `location` as no longer used. Returns true in
+      // `*compact` if its segment should be compacted.
+      Status Release(const Location& location, bool* compact) {
+        auto it = segments_.find(location.segment);
+        Segment* segment = &it->second;
+        segment->live_bytes -= location.length;
+        *compact = false;
+        if (segment->writer) return Status::OK();
+        if (segment->live_bytes == 0) {
+          segment->region.reset();
+          TF_RETURN_IF_ERROR(env_->DeleteFile(segment->filename));
+          segments_.erase(it);
+        } else {
+          *compact = 2 * segment->live_bytes < segment->size;
+        }
+        return Status::OK();
+      }
+
+     private:
+      struct Segment {
+        string filename;
+        // Set while the segment is written.
+        std::unique_ptr<WritableFile> writer;
+        std::unique_ptr<RandomAccessFile> file;
+        bool unflushed = false;
+        // Set once the segment is closed.
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        int64 size = 0;
+        int64 live_bytes = 0;
+      };
+
+      Status StartSegment() {
+        Segment segment;
+        segment.filename = strings::StrCat(prefix_, "_", next_segment_);
+        TF_RETURN_IF_ERROR(
+            env_->NewWritableFile(segment.filename, &segment.writer));
+        segments_.emplace(next_segment_++, std::move(segment));
+        return Status::OK();
+      }
+
+      Env* const env_;
+      const string prefix_;
+      int64 next_segment_ = 0;
+      std::map<int64, Segment> segments_;
+    };
+
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      Iterator(const Params& params, int64 seed, int64 seed2)
+          : DatasetIterator<Dataset>(params),
+            seed_(seed),
+            seed2_(seed2),
+            parent_generator_(seed, seed2),
+            generator_(&parent_generator_) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(EnsureInitialized(ctx));
+        while (input_impl_ && !BufferIsFull()) {
+          std::vector<Tensor> element;
+          bool end_of_input_sequence;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input_sequence));
+          if (end_of_input_sequence) {
+            input_impl_.reset();
+            break;
+          }
+          TF_RETURN_IF_ERROR(AddElement(std::move(element)));
+        }
+        if (buffer_.empty()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        // Produces an element chosen uniformly at random from the buffer,
+        // and moves the last element into its place.
+        const int64 index = Random() % buffer_.size();
+        TF_RETURN_IF_ERROR(TakeElement(index, out_tensors));
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("num_random_samples"),
+                                               num_random_samples_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed"), seed_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed2"), seed2_));
+        if (!initialized_) {
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("initialized"), ""));
+        if (input_impl_) {
+          TF_RETURN_IF_ERROR(SaveParent(writer, input_impl_));
+        } else {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("end_of_input_sequence"), ""));
+        }
+        // Spilled elements are read back, so that the checkpoint does not
+        // depend on the scratch files.
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("buffer_size"), buffer_.size()));
+        string scratch;
+        for (size_t i = 0; i < buffer_.size(); ++i) {
+          std::vector<Tensor> spilled;
+          const std::vector<Tensor>* element = &buffer_[i].element;
+          if (buffer_[i].spilled) {
+            StringPiece record;
+            TF_RETURN_IF_ERROR(
+                store_->Read(buffer_[i].location, &scratch, &record));
+            TF_RETURN_IF_ERROR(ParseElement(
+                record, dataset()->output_dtypes().size(), &spilled));
+            element = &spilled;
+          }
+          for (size_t j = 0; j < element->size(); ++j) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                full_name(strings::StrCat("buffer_", i, "_", j)),
+                (*element)[j]));
+          }
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("num_random_samples"),
+                                              &num_random_samples_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed"), &seed_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed2"), &seed2_));
+        ResetRngs();
+        buffer_.clear();
+        memory_bytes_ = 0;
+        buffer_bytes_ = 0;
+        store_.reset();
+        input_impl_.reset();
+        initialized_ = false;
+        if (!reader->Contains(full_name("initialized"))) {
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(EnsureInitialized(ctx));
+        if (!reader->Contains(full_name("end_of_input_sequence"))) {
+          TF_RETURN_IF_ERROR(RestoreParent(ctx, reader, input_impl_));
+        } else {
+          input_impl_.reset();
+        }
+        int64 buffer_size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("buffer_size"), &buffer_size));
+        for (int64 i = 0; i < buffer_size; ++i) {
+          std::vector<Tensor> element(dataset()->output_dtypes().size());
+          for (size_t j = 0; j < element.size(); ++j) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                full_name(strings::StrCat("buffer_", i, "_", j)),
+                &element[j]));
+          }
+          TF_RETURN_IF_ERROR(AddElement(std::move(element)));
+        }
+        return Status::OK();
+      }
+
+     private:
+      // An element of the shuffle buffer, which is either held in memory or
+      // spilled to the scratch files.
+      struct Entry {
+        std::vector<Tensor> element;
+        bool spilled = false;
+        ScratchStore::Location location;
+        int64 bytes = 0;
+      };
+
+      Status EnsureInitialized(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (initialized_) return Status::OK();
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
+        store_.reset(new ScratchStore(
+            ctx->env(),
+            io::JoinPath(dataset()->scratch_dir_,
+                         strings::StrCat("shuffle_",
+                                         strings::Hex(random::New64(),
+                                                      strings::ZERO_PAD_16)))));
+        initialized_ = true;
+        return Status::OK();
+      }
+
+      bool BufferIsFull() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return (dataset()->buffer_size_ > 0 &&
+                buffer_.size() >= dataset()->buffer_size_) ||
+               (dataset()->buffer_size_bytes_ > 0 &&
+                buffer_bytes_ >= dataset()->buffer_size_bytes_);
+      }
+
+      Status AddElement(std::vector<Tensor> element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Entry entry;
+        for (const Tensor& t : element) entry.bytes += t.TotalBytes();
+        if (memory_bytes_ + entry.bytes <= dataset()->memory_budget_bytes_) {
+          memory_bytes_ += entry.bytes;
+          entry.element = std::move(element);
+        } else {
+          SerializeElement(element, &record_);
+          TF_RETURN_IF_ERROR(store_->Append(record_, &entry.location));
+          entry.spilled = true;
+          spilled_indices_[entry.location.segment].insert(buffer_.size());
+        }
+        buffer_bytes_ += entry.bytes;
+        buffer_.push_back(std::move(entry));
+        return Status::OK();
+      }
+
+      Status TakeElement(int64 index, std::vector<Tensor>* element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Entry* entry = &buffer_[index];
+        int64 compact_segment = -1;
+        if (entry->spilled) {
+          StringPiece record;
+          TF_RETURN_IF_ERROR(store_->Read(entry->location, &record_, &record));
+          TF_RETURN_IF_ERROR(ParseElement(
+              record, dataset()->output_dtypes().size(), element));
+          RemoveSpilledIndex(entry->location.segment, index);
+          bool compact;
+          TF_RETURN_IF_ERROR(store_->Release(entry->location, &compact));
+          if (compact) compact_segment = entry->location.segment;
+        } else {
+          *element = std::move(entry->element);
+          memory_bytes_ -= entry->bytes;
+        }
+        buffer_bytes_ -= entry->bytes;
+
+        const int64 last = buffer_.size() - 1;
+        if (index != last) {
+          if (buffer_[last].spilled) {
+            RemoveSpilledIndex(buffer_[last].location.segment, last);
+            spilled_indices_[buffer_[last].location.segment].insert(index);
+          }
+          buffer_[index] = std::move(buffer_[last]);
+        }
+        buffer_.pop_back();
+        if (compact_segment >= 0) {
+          TF_RETURN_IF_ERROR(Compact(compact_segment));
+        }
+        return Status::OK();
+      }
+
+      // Moves the remaining records of `segment` to the newest segment.
+      Status Compact(int64 segment) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        auto it = spilled_indices_.find(segment);
+        if (it == spilled_indices_.end()) return Status::OK();
+        const std::set<int64> indices = std::move(it->second);
+        spilled_indices_.erase(it);
+        string scratch;
+        for (int64 index : indices) {
+          Entry* entry = &buffer_[index];
+          const ScratchStore::Location old_location = entry->location;
+          StringPiece record;
+          TF_RETURN_IF_ERROR(store_->Read(old_location, &scratch, &record));
+          // Copies the record, since releasing the last record of the
+          // segment unmaps it.
+          record_.assign(record.data(), record.size());
+          TF_RETURN_IF_ERROR(store_->Append(record_, &entry->location));
+          spilled_indices_[entry->location.segment].insert(index);
+          bool compact;
+          TF_RETURN_IF_ERROR(store_->Release(old_location, &compact));
+        }
+        return Status::OK();
+      }
+
+      void RemoveSpilledIndex(int64 segment, int64 index)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        auto it = spilled_indices_.find(segment);
+        it->second.erase(index);
+        if (it->second.empty()) spilled_indices_.erase(it);
+      }
+
+      random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        num_random_samples_++;
+        return generator_();
+      }
+
+      void ResetRngs() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        // Reset the generators based on the current iterator seeds.
+        parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+        generator_ = random::SingleSampleAdapter<random::PhiloxRandom>(
+            &parent_generator_);
+        generator_.Skip(num_random_samples_);
+      }
+
+      mutex mu_;
+      bool initialized_ GUARDED_BY(mu_) = false;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      std::vector<Entry> buffer_ GUARDED_BY(mu_);
+      // The indices in `buffer_` of the spilled elements, by segment.
+      std::map<int64, std::set<int64>> spilled_indices_ GUARDED_BY(mu_);
+      std::unique_ptr<ScratchStore> store_ GUARDED_BY(mu_);
+      // The bytes of the elements in memory, and of all elements.
+      int64 memory_bytes_ GUARDED_BY(mu_) = 0;
+      int64 buffer_bytes_ GUARDED_BY(mu_) = 0;
+      string record_ GUARDED_BY(mu_);
+      int64 seed_ GUARDED_BY(mu_);
+      int64 seed2_ GUARDED_BY(mu_);
+      random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+      random::SingleSampleAdapter<random::PhiloxRandom> generator_
+          GUARDED_BY(mu_);
+      int64 num_random_samples_ GUARDED_BY(mu_) = 0;
+    };
+
+    const DatasetBase* const input_;
+    const int64 buffer_size_;
+    const int64 buffer_size_bytes_;
+    const int64 memory_budget_bytes_;
+    const string scratch_dir_;
+    const int64 seed_;
+    const int64 seed2_;
+    mutable mutex mu_;
+    mutable random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+    mutable random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        GUARDED_BY(mu_);
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("SpillingShuffleDataset").Device(DEVICE_CPU),
+                        SpillingShuffleDatasetOp);
+
+}  // namespace
+}  // namespace tensorflow
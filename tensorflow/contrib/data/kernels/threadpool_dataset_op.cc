@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset_scheduler.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -175,6 +176,8 @@ class ThreadPoolDatasetOp : public UnaryDatasetOpKernel {
         params.lib = ctx->lib();
         params.function_library = ctx->function_library();
         params.allocator_getter = ctx->allocator_getter();
+        params.model = ctx->model();
+        params.pipeline_stats = ctx->pipeline_stats();
         IteratorContext threadpool_ctx(params);
         return input_impl_->GetNext(&threadpool_ctx, out_tensors,
                                     end_of_sequence);
@@ -189,10 +192,113 @@ class ThreadPoolDatasetOp : public UnaryDatasetOpKernel {
   };
 };
 
+class SharedSchedulerDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit SharedSchedulerDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 priority;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "priority", &priority));
+    *output = new Dataset(ctx, input, priority);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 priority)
+        : GraphDatasetBase(ctx), input_(input), priority_(priority) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::SharedScheduler")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "SharedSchedulerDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* priority = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(priority_, &priority));
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {input_graph_node, priority}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            runner_(DatasetScheduler::Global()
+                        ->NewClient(params.prefix, params.dataset->priority_)
+                        ->runner()) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        IteratorContext::Params params;
+        params.env = ctx->env();
+        params.runner = runner_;
+        params.stats_aggregator_getter = ctx->stats_aggregator_getter();
+        params.lib = ctx->lib();
+        params.function_library = ctx->function_library();
+        params.allocator_getter = ctx->allocator_getter();
+        params.model = ctx->model();
+        params.pipeline_stats = ctx->pipeline_stats();
+        IteratorContext scheduler_ctx(params);
+        return input_impl_->GetNext(&scheduler_ctx, out_tensors,
+                                    end_of_sequence);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return SaveParent(writer, input_impl_);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return RestoreParent(ctx, reader, input_impl_);
+      }
+
+     private:
+      const std::function<void(std::function<void()>)> runner_;
+      std::unique_ptr<IteratorBase> input_impl_;
+    };
+
+    const DatasetBase* const input_;
+    const int64 priority_;
+  };
+};
+
 REGISTER_KERNEL_BUILDER(Name("ThreadPoolHandle").Device(DEVICE_CPU),
                         ThreadPoolHandleOp);
 REGISTER_KERNEL_BUILDER(Name("ThreadPoolDataset").Device(DEVICE_CPU),
                         ThreadPoolDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("SharedSchedulerDataset").Device(DEVICE_CPU),
+                        SharedSchedulerDatasetOp);
 
 }  // namespace
 }  // namespace tensorflow
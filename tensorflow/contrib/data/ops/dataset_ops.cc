@@ -88,6 +88,99 @@ REGISTER_OP("UniqueDataset")
 Creates a dataset that contains the unique elements of `input_dataset`.
 )doc");
 
+REGISTER_OP("ParseExampleDataset")
+    .Input("input_dataset: variant")
+    .Input("num_parallel_calls: int64")
+    .Input("dense_defaults: Tdense")
+    .Output("handle: variant")
+    .Attr("num_sparse: int >= 0")
+    .Attr("sparse_keys: list(string) >= 0")
+    .Attr("dense_keys: list(string) >= 0")
+    .Attr("sparse_types: list({float,int64,string}) >= 0")
+    .Attr("Tdense: list({float,int64,string}) >= 0")
+    .Attr("dense_shapes: list(shape) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that parses the batches of serialized `Example` protos in
+`input_dataset` into their features.
+
+Each element of `input_dataset` must be a vector of serialized protos. The
+components of an output element are the features in the order of their keys:
+a dense feature is a tensor with the batch as its first dimension, and a
+sparse feature is a variant vector of its indices, values and dense shape.
+
+num_parallel_calls: A scalar. The number of threads that parse the protos of
+  a batch in parallel.
+dense_defaults: A list of Tensors (some may be empty), whose length matches
+  the length of `dense_keys`. See `ParseExample`.
+num_sparse: The number of sparse features to be parsed.
+sparse_keys: The keys of the sparse features.
+dense_keys: The keys of the dense features.
+sparse_types: The types of the sparse features.
+Tdense: The types of the dense features.
+dense_shapes: The shapes of the dense features, without the batch dimension.
+)doc");
+
+REGISTER_OP("SnapshotDataset")
+    .Input("input_dataset: variant")
+    .Input("path: string")
+    .Input("num_shards: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that materializes `input_dataset` in a snapshot on disk, and
+reads the snapshot instead of computing `input_dataset` once it is complete.
+
+The snapshot is stored in a directory under `path` that is named after a
+fingerprint of the graph of `input_dataset`, so that all programs which build
+the same input dataset share it. The first iterator that finds no snapshot
+writes one while it produces the elements of `input_dataset`; iterators that
+start while the snapshot is being written compute `input_dataset` themselves.
+A snapshot becomes visible only after it was written completely.
+
+path: A scalar. The directory in which snapshots are stored.
+num_shards: A scalar. The number of files that a new snapshot is written to in
+  parallel.
+)doc");
+
+REGISTER_OP("SpillingShuffleDataset")
+    .Input("input_dataset: variant")
+    .Input("buffer_size: int64")
+    .Input("buffer_size_bytes: int64")
+    .Input("memory_budget_bytes: int64")
+    .Input("scratch_dir: string")
+    .Input("seed: int64")
+    .Input("seed2: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that shuffles elements from `input_dataset` pseudorandomly,
+with a shuffle buffer that spills to local disk.
+
+The elements that do not fit in `memory_budget_bytes` are serialized to
+scratch files in `scratch_dir`, and only their locations are kept in memory.
+Each iterator uses a different shuffle order.
+
+buffer_size: The number of elements in the shuffle buffer, or -1 to limit it
+  only by `buffer_size_bytes`.
+buffer_size_bytes: The total size in bytes of the elements in the shuffle
+  buffer, or -1 to limit it only by `buffer_size`.
+memory_budget_bytes: The size in bytes of the elements that are kept in
+  memory.
+scratch_dir: The directory for the scratch files, or "" for a local temporary
+  directory.
+seed: A scalar seed for the random number generator. If either seed or
+  seed2 is set to be non-zero, the random number generator is seeded
+  by the given seed.  Otherwise, a random seed is used.
+seed2: A second scalar seed to avoid seed collision.
+)doc");
+
 REGISTER_OP("IteratorGetDevice")
     .Input("resource: resource")
     .Output("device: string")
@@ -170,4 +263,19 @@ display_name: A human-readable name for the threads that may be visible in
   some visualizations.
 )doc");
 
+REGISTER_OP("SharedSchedulerDataset")
+    .Input("input_dataset: variant")
+    .Input("priority: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that computes `input_dataset` on the process-wide
+tf.data scheduler, which shares a bounded pool of threads among pipelines.
+
+priority: A scalar. Work of pipelines with a higher priority runs first, and
+  pipelines of the same priority get equal shares of the threads.
+)doc");
+
 }  // namespace tensorflow
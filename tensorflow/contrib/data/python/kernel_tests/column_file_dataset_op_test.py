@@ -0,0 +1,133 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for ColumnFileDataset and ColumnFileWriter."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from tensorflow.contrib.data.python.kernel_tests import dataset_serialization_test_base
+from tensorflow.contrib.data.python.ops import readers
+from tensorflow.contrib.data.python.ops import writers
+from tensorflow.python.client import session
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+from tensorflow.python.util import compat
+
+
+def _write_column_file(filename, num_rows, row_group_size):
+  """Writes `num_rows` rows to `filename`, in groups of `row_group_size`."""
+  with ops.Graph().as_default():
+    dataset = dataset_ops.Dataset.range(num_rows).map(
+        lambda i: {  # pylint: disable=g-long-lambda
+            "id": i,
+            "score": 0.5 * math_ops.cast(i, dtypes.float32),
+            "name": string_ops.as_string(i),
+            "unused": 2 * i,
+        }).batch(row_group_size)
+    write_op = writers.ColumnFileWriter(filename).write(dataset)
+    with session.Session() as sess:
+      sess.run(write_op)
+
+
+class ColumnFileDatasetTest(test.TestCase):
+
+  def setUp(self):
+    super(ColumnFileDatasetTest, self).setUp()
+    self._filenames = []
+    for i in range(2):
+      filename = os.path.join(self.get_temp_dir(), "data.%d.col" % i)
+      _write_column_file(filename, num_rows=7, row_group_size=3)
+      self._filenames.append(filename)
+
+  def testReadRequestedColumns(self):
+    dataset = readers.ColumnFileDataset(self._filenames, {
+        "name": dtypes.string,
+        "score": dtypes.float32
+    })
+    self.assertEqual({"name": dtypes.string, "score": dtypes.float32},
+                     dataset.output_types)
+    self.assertEqual([None], dataset.output_shapes["score"].as_list())
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      for _ in self._filenames:
+        # Row groups of 3, 3 and 1 rows.
+        for start, end in [(0, 3), (3, 6), (6, 7)]:
+          element = sess.run(get_next)
+          self.assertEqual(["name", "score"], sorted(element))
+          self.assertAllEqual(
+              [compat.as_bytes(str(i)) for i in range(start, end)],
+              element["name"])
+          self.assertAllEqual([0.5 * i for i in range(start, end)],
+                              element["score"])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testMissingColumn(self):
+    dataset = readers.ColumnFileDataset(self._filenames,
+                                        {"missing": dtypes.int64})
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaisesOpError("has no column missing"):
+        sess.run(get_next)
+
+  def testWrongColumnType(self):
+    dataset = readers.ColumnFileDataset(self._filenames,
+                                        {"id": dtypes.float32})
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaisesOpError("does not hold float values"):
+        sess.run(get_next)
+
+  def testUnsupportedColumnType(self):
+    with self.assertRaises(TypeError):
+      readers.ColumnFileDataset(self._filenames, {"id": dtypes.int32})
+    dataset = dataset_ops.Dataset.range(3).map(lambda i: {"id": i})
+    with self.assertRaises(TypeError):
+      # Each element must be a row group of vectors.
+      writers.ColumnFileWriter(
+          os.path.join(self.get_temp_dir(), "scalars.col")).write(dataset)
+
+
+class ColumnFileDatasetSerializationTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_dataset(self, filenames, num_repeats):
+    return readers.ColumnFileDataset(filenames, {
+        "id": dtypes.int64,
+        "name": dtypes.string
+    }).repeat(num_repeats)
+
+  def testColumnFileSaveable(self):
+    filenames = []
+    for i in range(2):
+      filename = os.path.join(self.get_temp_dir(), "saveable.%d.col" % i)
+      _write_column_file(filename, num_rows=5, row_group_size=2)
+      filenames.append(filename)
+    num_repeats = 2
+    # Three row groups per file.
+    num_outputs = num_repeats * len(filenames) * 3
+    self.run_core_tests(lambda: self._build_dataset(filenames, num_repeats),
+                        None, num_outputs)
+
+
+if __name__ == "__main__":
+  test.main()
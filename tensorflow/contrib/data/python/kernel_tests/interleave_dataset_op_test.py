@@ -906,5 +906,75 @@ class ParallelInterleaveDatasetTest(test.TestCase):
         sess.run(self.next_element)
 
 
+
+class DynamicInterleaveDatasetTest(test.TestCase):
+
+  def _build_dataset(self, input_values, cycle_length, num_parallel_calls,
+                     max_backup_inputs, blocked_values=()):
+    # The inputs in `blocked_values` produce their elements only once
+    # `self.unblock` is set.
+    self.unblock = threading.Event()
+
+    def map_py_fn(x):
+      if x in blocked_values:
+        self.unblock.wait()
+      return x * x
+
+    def interleave_fn(x):
+      return dataset_ops.Dataset.from_tensors(x).repeat(x).map(
+          lambda y: script_ops.py_func(map_py_fn, [y], y.dtype))
+
+    return dataset_ops.Dataset.from_tensor_slices(input_values).apply(
+        interleave_ops.dynamic_interleave(
+            interleave_fn,
+            cycle_length,
+            num_parallel_calls=num_parallel_calls,
+            max_backup_inputs=max_backup_inputs))
+
+  def testAllElements(self):
+    input_values = np.array([4, 5, 6, 1, 0, 3], dtype=np.int64)
+    expected = sorted(x * x for x in input_values for _ in range(x))
+    for cycle_length, num_parallel_calls, max_backup_inputs in [
+        (1, 1, 0), (2, 1, 1), (2, 4, 0), (3, 2, 2), (8, 8, 8)]:
+      next_element = self._build_dataset(
+          input_values, cycle_length, num_parallel_calls,
+          max_backup_inputs).make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        actual = []
+        while True:
+          try:
+            actual.append(sess.run(next_element))
+          except errors.OutOfRangeError:
+            break
+        self.assertEqual(expected, sorted(actual))
+
+  def testSlowInputDoesNotBlockOthers(self):
+    input_values = np.array([1, 2, 3, 4], dtype=np.int64)
+    next_element = self._build_dataset(
+        input_values, 2, 2, 0,
+        blocked_values=(1,)).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      actual = [sess.run(next_element) for _ in range(9)]
+      self.assertEqual(sorted([4] * 2 + [9] * 3 + [16] * 4), sorted(actual))
+      self.unblock.set()
+      self.assertEqual(1, sess.run(next_element))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
+  def testBackupInputs(self):
+    # Both inputs in the cycle block, so the elements of the third input can
+    # only be produced by a backup input.
+    input_values = np.array([1, 2, 3], dtype=np.int64)
+    next_element = self._build_dataset(
+        input_values, 2, 3, 1,
+        blocked_values=(1, 2)).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      self.assertEqual([9] * 3, [sess.run(next_element) for _ in range(3)])
+      self.unblock.set()
+      self.assertEqual([1, 4, 4],
+                       sorted(sess.run(next_element) for _ in range(3)))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
 if __name__ == "__main__":
   test.main()
@@ -72,6 +72,25 @@ class OptimizeDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(get_next)
 
+  def testMapVectorization(self):
+    dataset = dataset_ops.Dataset.range(10).map(lambda x: x * 2 + 1).batch(
+        4).apply(optimization.optimize(["map_vectorization"]))
+    iterator = dataset.make_one_shot_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      graph = graph_pb2.GraphDef().FromString(
+          sess.run(dataset._as_serialized_graph()))
+      nodes = {node.name: node for node in graph.node}
+      map_node = [node for node in graph.node if node.op == "MapDataset"][0]
+      self.assertIn(nodes[map_node.input[0]].op,
+                    ("BatchDataset", "BatchDatasetV2"))
+      self.assertAllEqual([1, 3, 5, 7], sess.run(get_next))
+      self.assertAllEqual([9, 11, 13, 15], sess.run(get_next))
+      self.assertAllEqual([17, 19], sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
 
 class OptimizeDatasetSerializationTest(
     dataset_serialization_test_base.DatasetSerializationTestBase):
@@ -0,0 +1,127 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import parsing_ops as contrib_parsing_ops
+from tensorflow.core.example import example_pb2
+from tensorflow.core.example import feature_pb2
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import parsing_ops
+from tensorflow.python.platform import test
+from tensorflow.python.util import compat
+
+
+def _make_example(i):
+  return example_pb2.Example(features=feature_pb2.Features(feature={
+      "age": feature_pb2.Feature(
+          int64_list=feature_pb2.Int64List(value=[i] if i % 3 else [])),
+      "kws": feature_pb2.Feature(
+          bytes_list=feature_pb2.BytesList(
+              value=[compat.as_bytes("kw%d" % j) for j in range(i % 4)])),
+      "pos": feature_pb2.Feature(
+          float_list=feature_pb2.FloatList(value=[i, 2 * i])),
+      "seq": feature_pb2.Feature(
+          int64_list=feature_pb2.Int64List(value=list(range(i % 5)))),
+  })).SerializeToString()
+
+
+class ParseExampleDatasetTest(test.TestCase):
+
+  def _testMatchesParseExample(self, features, num_parallel_calls):
+    serialized = [_make_example(i) for i in range(10)]
+    dataset = dataset_ops.Dataset.from_tensor_slices(serialized).batch(4)
+    expected_next = dataset.map(
+        lambda x: parsing_ops.parse_example(x, features)
+    ).make_one_shot_iterator().get_next()
+    next_element = dataset.apply(
+        contrib_parsing_ops.parse_example_dataset(
+            features, num_parallel_calls=num_parallel_calls)
+    ).make_one_shot_iterator().get_next()
+
+    self.assertEqual(set(features), set(next_element))
+    with self.test_session() as sess:
+      for _ in range(3):
+        expected, actual = sess.run([expected_next, next_element])
+        for key in features:
+          if isinstance(expected[key], sparse_tensor.SparseTensorValue):
+            self.assertAllEqual(expected[key].indices, actual[key].indices)
+            self.assertAllEqual(expected[key].values, actual[key].values)
+            self.assertAllEqual(expected[key].dense_shape,
+                                actual[key].dense_shape)
+          else:
+            self.assertAllEqual(expected[key], actual[key])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
+  def testDenseAndSparseFeatures(self):
+    features = {
+        "age": parsing_ops.FixedLenFeature([], dtypes.int64, default_value=-1),
+        "kws": parsing_ops.VarLenFeature(dtypes.string),
+        "pos": parsing_ops.FixedLenFeature([2], dtypes.float32),
+        "seq": parsing_ops.FixedLenSequenceFeature(
+            [], dtypes.int64, allow_missing=True),
+    }
+    for num_parallel_calls in [1, 4]:
+      self._testMatchesParseExample(features, num_parallel_calls)
+
+  def testSparseFeature(self):
+    features = {
+        "sparse": parsing_ops.SparseFeature(
+            index_key="seq", value_key="seq", dtype=dtypes.int64, size=5),
+    }
+    self._testMatchesParseExample(features, num_parallel_calls=2)
+
+  def testStaticShapes(self):
+    features = {
+        "age": parsing_ops.FixedLenFeature([], dtypes.int64, default_value=-1),
+        "kws": parsing_ops.VarLenFeature(dtypes.string),
+        "pos": parsing_ops.FixedLenFeature([2], dtypes.float32),
+    }
+    with self.assertRaises(ValueError):
+      # The input must be batched.
+      dataset_ops.Dataset.from_tensor_slices(
+          [_make_example(i) for i in range(8)]).apply(
+              contrib_parsing_ops.parse_example_dataset(features))
+
+    dataset = dataset_ops.Dataset.from_tensors(
+        np.array([_make_example(i) for i in range(8)])).apply(
+            contrib_parsing_ops.parse_example_dataset(features))
+    self.assertEqual([8], dataset.output_shapes["age"].as_list())
+    self.assertEqual([8, None], dataset.output_shapes["kws"].as_list())
+    self.assertEqual([8, 2], dataset.output_shapes["pos"].as_list())
+
+  def testMissingRequiredFeature(self):
+    features = {
+        "missing": parsing_ops.FixedLenFeature([], dtypes.int64),
+    }
+    next_element = dataset_ops.Dataset.from_tensors(
+        [_make_example(0)]).apply(
+            contrib_parsing_ops.parse_example_dataset(features)
+        ).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaisesOpError("Feature: missing"):
+        sess.run(next_element)
+
+
+if __name__ == "__main__":
+  test.main()
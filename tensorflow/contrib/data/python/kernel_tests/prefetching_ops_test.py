@@ -235,6 +235,23 @@ class PrefetchToDeviceTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(next_element)
 
+  def testPrefetchToDeviceBufferSize(self):
+    host_dataset = dataset_ops.Dataset.range(10)
+    with ops.device("/cpu:0"):
+      for buffer_size in [1, 4, 20]:
+        iterator = host_dataset.apply(
+            prefetching_ops.prefetch_to_device(
+                "/cpu:1", buffer_size=buffer_size)).make_one_shot_iterator()
+        next_element = iterator.get_next()
+
+        worker_config = config_pb2.ConfigProto()
+        worker_config.device_count["CPU"] = 2
+        with self.test_session(config=worker_config) as sess:
+          for i in range(10):
+            self.assertEqual(i, sess.run(next_element))
+          with self.assertRaises(errors.OutOfRangeError):
+            sess.run(next_element)
+
   def testPrefetchDictToDevice(self):
     host_dataset = dataset_ops.Dataset.range(10).map(lambda x: {"a": x})
     device_dataset = host_dataset.apply(
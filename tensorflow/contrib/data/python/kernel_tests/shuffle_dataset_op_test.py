@@ -17,6 +17,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
+
 import numpy as np
 
 from tensorflow.contrib.data.python.kernel_tests import dataset_serialization_test_base
@@ -25,6 +27,7 @@ from tensorflow.contrib.data.python.ops import shuffle_ops
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 from tensorflow.python.training import saver as saver_lib
 
@@ -234,5 +237,67 @@ class ShuffleAndRepeatSerializationTest(
                         100)
 
 
+
+class SpillingShuffleTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_ds(self, seed, memory_budget_bytes=0, **kwargs):
+    # With a memory budget of 0, every element is spilled to disk.
+    return dataset_ops.Dataset.range(20).map(
+        lambda x: (x, string_ops.as_string(x))).apply(
+            shuffle_ops.spilling_shuffle(
+                memory_budget_bytes=memory_budget_bytes,
+                scratch_dir=self.get_temp_dir(),
+                seed=seed,
+                **kwargs))
+
+  def _values(self, output):
+    return [value for value, _ in output]
+
+  def testCorrectOutput(self):
+    for memory_budget_bytes in [0, 80, 1 << 20]:
+      output = self.gen_outputs(
+          lambda: self._build_ds(
+              10, memory_budget_bytes=memory_budget_bytes, buffer_size=5),
+          [], 20)
+      self.assertSequenceEqual(sorted(self._values(output)), range(20))
+      for value, string in output:
+        self.assertEqual(str(value).encode(), string)
+
+  def testBufferSizeBytes(self):
+    # Each element takes more than 10 bytes, so a buffer of 10 bytes holds a
+    # single element, and the order of the input does not change.
+    output = self.gen_outputs(
+        lambda: self._build_ds(10, buffer_size_bytes=10), [], 20)
+    self.assertSequenceEqual(self._values(output), range(20))
+    output = self.gen_outputs(
+        lambda: self._build_ds(10, buffer_size_bytes=1 << 20), [], 20)
+    self.assertNotEqual(self._values(output), list(range(20)))
+
+  def testSameOrderForSameSeeds(self):
+    output1 = self.gen_outputs(lambda: self._build_ds(10, buffer_size=8), [],
+                               20)
+    output2 = self.gen_outputs(lambda: self._build_ds(10, buffer_size=8), [],
+                               20)
+    self.assertEqual(self._values(output1), self._values(output2))
+    output3 = self.gen_outputs(lambda: self._build_ds(20, buffer_size=8), [],
+                               20)
+    self.assertNotEqual(self._values(output1), self._values(output3))
+
+  def testDeletesScratchFiles(self):
+    self.gen_outputs(lambda: self._build_ds(10, buffer_size=8), [], 20)
+    self.assertEqual([],
+                     [f for f in os.listdir(self.get_temp_dir())
+                      if f.startswith("shuffle_")])
+
+  def testNoBufferSize(self):
+    with self.assertRaises(ValueError):
+      shuffle_ops.spilling_shuffle()
+
+  def testCore(self):
+    self.run_core_tests(
+        lambda: self._build_ds(10, buffer_size=8),
+        lambda: self._build_ds(20, buffer_size=8), 20)
+
 if __name__ == "__main__":
   test.main()
@@ -0,0 +1,121 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline snapshot ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import shutil
+import tempfile
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import snapshot
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import readers
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+class SnapshotDatasetTest(test.TestCase):
+
+  def setUp(self):
+    self.tmp_dir = tempfile.mkdtemp()
+    self.snapshot_dir = os.path.join(self.tmp_dir, "snapshots")
+    self.filename = os.path.join(self.tmp_dir, "lines.txt")
+    with open(self.filename, "w") as f:
+      f.write("".join("%d\n" % i for i in range(10)))
+    self.lines = [str(i).encode() for i in range(10)]
+
+  def tearDown(self):
+    shutil.rmtree(self.tmp_dir, ignore_errors=True)
+
+  def _lines_dataset(self, num_shards=8):
+    return lambda: readers.TextLineDataset(self.filename).apply(  # pylint: disable=g-long-lambda
+        snapshot.snapshot(self.snapshot_dir, num_shards=num_shards))
+
+  def _read(self, make_dataset, num_elements=None):
+    # Each pass uses its own graph and session, so that the iterator of a
+    # partial pass is destroyed when the pass ends.
+    elements = []
+    with ops.Graph().as_default() as g, self.test_session(graph=g) as sess:
+      next_element = make_dataset().make_one_shot_iterator().get_next()
+      try:
+        while num_elements is None or len(elements) < num_elements:
+          elements.append(sess.run(next_element))
+      except errors.OutOfRangeError:
+        pass
+    return elements
+
+  def _snapshots(self):
+    return [
+        d for d in os.listdir(self.snapshot_dir) if os.path.exists(
+            os.path.join(self.snapshot_dir, d, "snapshot.metadata"))
+    ]
+
+  def testWriteThenRead(self):
+    dataset = self._lines_dataset(num_shards=3)
+    self.assertEqual(self.lines, self._read(dataset))
+    self.assertEqual(1, len(self._snapshots()))
+
+    # The second pass reads the snapshot instead of the input.
+    os.remove(self.filename)
+    self.assertEqual(self.lines, self._read(dataset))
+
+  def testPartialPassWritesNoSnapshot(self):
+    dataset = self._lines_dataset()
+    self.assertEqual(self.lines[:3], self._read(dataset, num_elements=3))
+    self.assertEqual([], self._snapshots())
+    self.assertEqual(self.lines, self._read(dataset))
+    self.assertEqual(1, len(self._snapshots()))
+
+  def testSnapshotsAreKeyedByInput(self):
+
+    def make_dataset(num_elements, num_shards=8):
+      return lambda: dataset_ops.Dataset.range(num_elements).apply(  # pylint: disable=g-long-lambda
+          snapshot.snapshot(self.snapshot_dir, num_shards=num_shards))
+
+    self._read(make_dataset(5))
+    self._read(make_dataset(6))
+    self.assertEqual(2, len(self._snapshots()))
+
+    # An equal pipeline reuses the snapshot, even with a different number of
+    # shards.
+    self.assertEqual(list(range(5)), self._read(make_dataset(5, num_shards=2)))
+    self.assertEqual(2, len(self._snapshots()))
+
+  def testMultipleComponents(self):
+
+    def make_dataset():
+      return dataset_ops.Dataset.range(7).map(
+          lambda x: (x, string_ops.as_string(x), [x, x])).apply(
+              snapshot.snapshot(self.snapshot_dir, num_shards=4))
+
+    expected = [(i, str(i).encode(), np.array([i, i])) for i in range(7)]
+    for _ in range(2):
+      elements = self._read(make_dataset)
+      self.assertEqual(len(expected), len(elements))
+      for want, got in zip(expected, elements):
+        self.assertEqual(want[0], got[0])
+        self.assertEqual(want[1], got[1])
+        self.assertAllEqual(want[2], got[2])
+    self.assertEqual(1, len(self._snapshots()))
+
+
+if __name__ == "__main__":
+  test.main()
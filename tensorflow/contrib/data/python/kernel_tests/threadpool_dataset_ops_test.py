@@ -72,6 +72,26 @@ class OverrideThreadpoolDatasetTest(test.TestCase):
         # perform work.
         self.assertLessEqual(len(thread_ids), num_threads)
 
+  def testSharedScheduler(self):
+    train = threadpool.use_shared_scheduler(
+        dataset_ops.Dataset.range(100).map(lambda x: x * 2,
+                                           num_parallel_calls=4),
+        priority=1)
+    evaluation = threadpool.use_shared_scheduler(
+        dataset_ops.Dataset.range(100).map(lambda x: x * 3,
+                                           num_parallel_calls=4))
+    train_iterator = train.make_initializable_iterator()
+    eval_iterator = evaluation.make_initializable_iterator()
+    train_next = train_iterator.get_next()
+    eval_next = eval_iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run([train_iterator.initializer, eval_iterator.initializer])
+      for i in range(100):
+        self.assertEqual([i * 2, i * 3], sess.run([train_next, eval_next]))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(train_next)
+
 
 if __name__ == "__main__":
   test.main()
@@ -66,6 +66,8 @@ def parallel_interleave(map_func,
   Args:
     map_func: A function mapping a nested structure of tensors to a `Dataset`.
     cycle_length: The number of input `Dataset`s to interleave from in parallel.
+      If the value `tf.contrib.data.AUTOTUNE` is used, it is set to the number
+      of schedulable CPU cores.
     block_length: The number of consecutive elements to pull from an input
       `Dataset` before advancing to the next input `Dataset`.
     sloppy: If false, elements are produced in deterministic order. Otherwise,
@@ -89,6 +91,64 @@ def parallel_interleave(map_func,
   return _apply_fn
 
 
+def dynamic_interleave(map_func,
+                       cycle_length,
+                       num_parallel_calls=None,
+                       buffer_output_elements=None,
+                       max_backup_inputs=None):
+  """A parallel interleave that produces elements in completion order.
+
+  `dynamic_interleave()` maps `map_func` across its input to produce nested
+  datasets, and reads from up to `cycle_length` of them at a time with
+  `num_parallel_calls` threads. Unlike `parallel_interleave()`, the threads are
+  not tied to positions in the cycle: any thread may read from any nested
+  dataset that no other thread reads from, and each element is produced as
+  soon as it was read. A nested dataset that is slow to produce an element,
+  e.g. because of a straggling read from a remote file system, thus only holds
+  up the thread that reads from it.
+
+  While the consumer waits for an element, up to `max_backup_inputs` further
+  nested datasets are opened early, so that the other threads have something
+  to read from while a straggler catches up.
+
+  Example usage:
+
+  ```python
+  filenames = tf.data.Dataset.list_files("/path/to/data/train*.tfrecords")
+  dataset = filenames.apply(
+      tf.contrib.data.dynamic_interleave(
+          lambda filename: tf.data.TFRecordDataset(filename),
+          cycle_length=8))
+  ```
+
+  WARNING: The order of produced elements is not deterministic, and the
+  iterator of the resulting dataset cannot be checkpointed.
+
+  Args:
+    map_func: A function mapping a nested structure of tensors to a `Dataset`.
+    cycle_length: The number of nested `Dataset`s to read from at a time. If
+      the value `tf.contrib.data.AUTOTUNE` is used, it is set to the number of
+      schedulable CPU cores.
+    num_parallel_calls: (Optional.) The number of threads that read from the
+      nested `Dataset`s. Defaults to `cycle_length`.
+    buffer_output_elements: (Optional.) The number of elements that may be read
+      before they are requested. Defaults to `2 * cycle_length`.
+    max_backup_inputs: (Optional.) The number of nested `Dataset`s that may be
+      opened beyond `cycle_length` while the consumer waits for an element.
+      Defaults to `cycle_length`.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    @{tf.data.Dataset.apply}.
+  """
+  def _apply_fn(dataset):
+    return readers.DynamicInterleaveDataset(
+        dataset, map_func, cycle_length, num_parallel_calls,
+        buffer_output_elements, max_backup_inputs)
+
+  return _apply_fn
+
+
 @deprecation.deprecated(
     None, "Use `tf.contrib.data.parallel_interleave(..., sloppy=True)`.")
 def sloppy_interleave(map_func, cycle_length, block_length=1):
@@ -0,0 +1,144 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Experimental `dataset` API for parsing example."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.data.python.ops import contrib_op_loader  # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops import gen_dataset_ops
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.ops import parsing_ops
+
+
+class _ParseExampleDataset(dataset_ops.Dataset):
+  """A `Dataset` that parses `example` dataset into a `dict` dataset."""
+
+  def __init__(self, input_dataset, features, num_parallel_calls):
+    super(_ParseExampleDataset, self).__init__()
+    self._input_dataset = input_dataset
+    if input_dataset.output_types != dtypes.string:
+      raise TypeError("Input dataset should be a dataset of vectors of "
+                      "strings, but got %s." % input_dataset.output_types)
+    input_shape = input_dataset.output_shapes.with_rank(1)
+    self._num_parallel_calls = ops.convert_to_tensor(
+        num_parallel_calls, dtype=dtypes.int64, name="num_parallel_calls")
+    # pylint: disable=protected-access
+    self._features = parsing_ops._prepend_none_dimension(features)
+    (sparse_keys, sparse_types, dense_keys, dense_types, dense_defaults,
+     dense_shapes) = parsing_ops._features_to_raw_params(
+         self._features, [
+             parsing_ops.VarLenFeature, parsing_ops.SparseFeature,
+             parsing_ops.FixedLenFeature, parsing_ops.FixedLenSequenceFeature
+         ])
+    (_, self._dense_defaults, self._sparse_keys, self._sparse_types,
+     self._dense_keys, dense_shapes) = parsing_ops._process_raw_parameters(
+         None, dense_defaults, sparse_keys, sparse_types, dense_keys,
+         dense_types, dense_shapes)
+    # pylint: enable=protected-access
+    self._dense_shapes = [shape.as_proto() for shape in dense_shapes]
+    self._dense_types = dense_types
+
+    batch_shape = input_shape[:1]
+    self._output_classes = dict(
+        [(key, ops.Tensor) for key in self._dense_keys] +
+        [(key, sparse_tensor.SparseTensor) for key in self._sparse_keys])
+    self._output_types = dict(
+        list(zip(self._dense_keys, self._dense_types)) +
+        list(zip(self._sparse_keys, self._sparse_types)))
+    self._output_shapes = dict(
+        [(key, batch_shape.concatenate(shape))
+         for key, shape in zip(self._dense_keys, dense_shapes)] +
+        [(key, batch_shape.concatenate(tensor_shape.unknown_shape(ndims=1)))
+         for key in self._sparse_keys])
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.parse_example_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        self._num_parallel_calls,
+        self._dense_defaults,
+        num_sparse=len(self._sparse_keys),
+        sparse_keys=self._sparse_keys,
+        dense_keys=self._dense_keys,
+        sparse_types=self._sparse_types,
+        dense_shapes=self._dense_shapes,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._output_classes
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+
+def parse_example_dataset(features, num_parallel_calls=1):
+  """A transformation that parses `Example` protos into a `dict` of tensors.
+
+  Each element of the input dataset must be a vector of serialized `Example`
+  protos, which this transformation parses into a dictionary mapping keys to
+  `Tensor` and `SparseTensor` objects in the same way as @{tf.parse_example}, so
+  `features` is a dict from keys to `VarLenFeature`, `SparseFeature`,
+  `FixedLenFeature` and `FixedLenSequenceFeature` objects. Unlike
+  `dataset.map(lambda x: tf.parse_example(x, features))`, the protos of a
+  batch are parsed by a dedicated pool of `num_parallel_calls` threads, the
+  parsing configuration is built only once, and fixed-length dense features
+  are written directly into their batched output tensors. For example:
+
+  ```python
+  dataset = tf.data.TFRecordDataset(filenames).batch(batch_size)
+  dataset = dataset.apply(
+      tf.contrib.data.parse_example_dataset(features, num_parallel_calls=4))
+  ```
+
+  Args:
+    features: A `dict` mapping feature keys to `FixedLenFeature`,
+      `VarLenFeature`, and `SparseFeature` values.
+    num_parallel_calls: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+      representing the number of threads that parse the protos of a batch in
+      parallel.
+
+  Returns:
+    A dataset transformation function, which can be passed to
+    @{tf.data.Dataset.apply}.
+
+  Raises:
+    ValueError: if features argument is None.
+  """
+  if features is None:
+    raise ValueError("Missing: features was %s." % features)
+
+  def _apply_fn(dataset):
+    """Function from `Dataset` to `Dataset` that applies the transformation."""
+    out_dataset = _ParseExampleDataset(dataset, features, num_parallel_calls)
+    if any(isinstance(feature, parsing_ops.SparseFeature)
+           for feature in features.values()):
+      # pylint: disable=protected-access
+      # pylint: disable=g-long-lambda
+      out_dataset = out_dataset.map(
+          lambda x: parsing_ops._construct_sparse_tensors_for_sparse_features(
+              features, x), num_parallel_calls=num_parallel_calls)
+    return out_dataset
+
+  return _apply_fn
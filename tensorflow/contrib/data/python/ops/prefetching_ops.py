@@ -241,7 +241,10 @@ class _PrefetchToDeviceDataset(dataset_ops.Dataset):
   def __init__(self, input_dataset, device, buffer_size):
     self._input_dataset = input_dataset
     self._device = device
-    self._buffer_size = buffer_size if buffer_size is not None else 1
+    self._buffer_size = buffer_size if buffer_size is not None else 2
+    # Prefetches on the host as well, so that producing the next element
+    # overlaps with copying the previous one to `device`.
+    self._host_dataset = input_dataset.prefetch(self._buffer_size)
 
   # The static analysis cannot tell that the eager iterator's superclass has
   # a `next()` method.
@@ -259,7 +262,7 @@ class _PrefetchToDeviceDataset(dataset_ops.Dataset):
       RuntimeError: If eager execution is enabled.
     """
     if context.executing_eagerly():
-      return _PrefetchToDeviceEagerIterator(self._input_dataset, self._device,
+      return _PrefetchToDeviceEagerIterator(self._host_dataset, self._device,
                                             self._buffer_size)
     else:
       raise RuntimeError("dataset.__iter__() is only supported when eager "
@@ -268,16 +271,16 @@ class _PrefetchToDeviceDataset(dataset_ops.Dataset):
 
   def make_one_shot_iterator(self):
     if context.executing_eagerly():
-      return _PrefetchToDeviceEagerIterator(self._input_dataset, self._device,
+      return _PrefetchToDeviceEagerIterator(self._host_dataset, self._device,
                                             self._buffer_size)
     else:
-      return _PrefetchToDeviceIterator(self._input_dataset, one_shot=True,
+      return _PrefetchToDeviceIterator(self._host_dataset, one_shot=True,
                                        device=self._device,
                                        buffer_size=self._buffer_size)
 
   def make_initializable_iterator(self, shared_name=None):
     return _PrefetchToDeviceIterator(
-        self._input_dataset,
+        self._host_dataset,
         one_shot=False,
         device=self._device,
         buffer_size=self._buffer_size,
@@ -307,6 +310,12 @@ class _PrefetchToDeviceDataset(dataset_ops.Dataset):
 def prefetch_to_device(device, buffer_size=None):
   """A transformation that prefetches dataset values to the given `device`.
 
+  The elements are copied to `device` as soon as they are produced, while the
+  consumer works on earlier elements, so that up to `buffer_size` elements are
+  resident on `device` when they are requested. The input is also prefetched
+  on the host, so that producing an element overlaps with copying the previous
+  one.
+
   NOTE: Although the transformation creates a @{tf.data.Dataset}, the
   transformation must be the final `Dataset` in the input pipeline.
 
@@ -25,6 +25,7 @@ import numpy as np
 from tensorflow.contrib.data.python.ops import batching
 from tensorflow.contrib.data.python.ops import gen_dataset_ops as contrib_gen_dataset_ops
 from tensorflow.contrib.data.python.ops import interleave_ops
+from tensorflow.contrib.data.python.ops import parsing_ops
 from tensorflow.contrib.data.python.ops import shuffle_ops
 from tensorflow.contrib.data.python.ops import stats_ops
 from tensorflow.python.data.ops import dataset_ops
@@ -37,7 +38,6 @@ from tensorflow.python.framework import ops
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.lib.io import file_io
 from tensorflow.python.ops import gen_dataset_ops
-from tensorflow.python.ops import parsing_ops
 from tensorflow.python.platform import gfile
 from tensorflow.python.util import deprecation
 
@@ -763,9 +763,9 @@ def make_batched_features_dataset(file_pattern,
     dataset = dataset.batch(batch_size)
 
   # Parse `Example` tensors to a dictionary of `Feature` tensors.
-  dataset = dataset.map(
-      lambda x: parsing_ops.parse_example(x, features),
-      num_parallel_calls=parser_num_threads)
+  dataset = dataset.apply(
+      parsing_ops.parse_example_dataset(
+          features, num_parallel_calls=parser_num_threads))
 
   # TODO(rachelim): Add an optional label_name argument for extracting the label
   # from the features dictionary, to comply with the type expected by the
@@ -949,3 +949,63 @@ class SqlDataset(dataset_ops.Dataset):
   @property
   def output_types(self):
     return self._output_types
+
+
+class ColumnFileDataset(dataset_ops.Dataset):
+  """A `Dataset` consisting of the row groups of one or more column files."""
+
+  def __init__(self, filenames, columns):
+    """Creates a `ColumnFileDataset`.
+
+    Column files store each column of a row group contiguously, so a
+    `ColumnFileDataset` only reads the columns it is asked for, and emits them
+    as tensors without parsing anything. Each element is a row group: a
+    dictionary mapping the requested column names to vectors of their values.
+    For example:
+
+    ```python
+    dataset = tf.contrib.data.ColumnFileDataset(
+        ["/foo/part-0.col", "/foo/part-1.col"],
+        {"age": tf.int64, "score": tf.float32})
+    # Rows instead of row groups.
+    dataset = dataset.apply(tf.contrib.data.unbatch())
+    ```
+
+    Column files are written with
+    `tf.contrib.data.python.ops.writers.ColumnFileWriter`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      columns: A dictionary mapping the names of the columns to read to their
+        `tf.DType`, which is one of `tf.int64`, `tf.float32` and `tf.string`.
+    """
+    super(ColumnFileDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    for name, dtype in columns.items():
+      if dtype not in (dtypes.int64, dtypes.float32, dtypes.string):
+        raise TypeError(
+            "Column %r must have type tf.int64, tf.float32 or tf.string, not "
+            "%s." % (name, dtype))
+    self._output_types = dict(columns)
+    # `nest.flatten()` orders the components of a dictionary by their keys.
+    self._columns = ops.convert_to_tensor(
+        sorted(self._output_types), dtype=dtypes.string, name="columns")
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.column_file_dataset(
+        self._filenames, self._columns, nest.flatten(self.output_types),
+        nest.flatten(self.output_shapes))
+
+  @property
+  def output_classes(self):
+    return nest.map_structure(lambda _: ops.Tensor, self._output_types)
+
+  @property
+  def output_shapes(self):
+    return nest.map_structure(lambda _: tensor_shape.vector(None),
+                              self._output_types)
+
+  @property
+  def output_types(self):
+    return self._output_types
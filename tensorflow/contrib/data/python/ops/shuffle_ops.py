@@ -17,6 +17,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+from tensorflow.contrib.data.python.ops import contrib_op_loader  # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops import gen_dataset_ops as contrib_gen_dataset_ops
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import random_seed
 from tensorflow.python.framework import constant_op
@@ -103,3 +105,109 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     return _ShuffleAndRepeatDataset(dataset, buffer_size, count, seed)
 
   return _apply_fn
+
+
+class _SpillingShuffleDataset(dataset_ops.Dataset):
+  """A `Dataset` that shuffles its input with a buffer that spills to disk."""
+
+  def __init__(self, input_dataset, buffer_size, buffer_size_bytes,
+               memory_budget_bytes, scratch_dir, seed):
+    """See `spilling_shuffle()` for details."""
+    super(_SpillingShuffleDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        -1 if buffer_size is None else buffer_size,
+        dtype=dtypes.int64,
+        name="buffer_size")
+    self._buffer_size_bytes = ops.convert_to_tensor(
+        -1 if buffer_size_bytes is None else buffer_size_bytes,
+        dtype=dtypes.int64,
+        name="buffer_size_bytes")
+    self._memory_budget_bytes = ops.convert_to_tensor(
+        memory_budget_bytes, dtype=dtypes.int64, name="memory_budget_bytes")
+    self._scratch_dir = ops.convert_to_tensor(
+        "" if scratch_dir is None else scratch_dir,
+        dtype=dtypes.string,
+        name="scratch_dir")
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+
+  def _as_variant_tensor(self):
+    return contrib_gen_dataset_ops.spilling_shuffle_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        buffer_size=self._buffer_size,
+        buffer_size_bytes=self._buffer_size_bytes,
+        memory_budget_bytes=self._memory_budget_bytes,
+        scratch_dir=self._scratch_dir,
+        seed=self._seed,
+        seed2=self._seed2,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+
+def spilling_shuffle(buffer_size=None,
+                     buffer_size_bytes=None,
+                     memory_budget_bytes=1 << 30,
+                     scratch_dir=None,
+                     seed=None):
+  """Shuffles a `Dataset` with a shuffle buffer that spills to local disk.
+
+  Like @{tf.data.Dataset.shuffle}, this fills a buffer with elements of the
+  input and produces elements chosen uniformly at random from the buffer, with
+  a new order for each iteration. Only `memory_budget_bytes` of the buffered
+  elements are kept in memory, and the others are serialized to scratch files
+  in `scratch_dir`, which should be on a fast local disk. This allows shuffle
+  buffers that are much larger than the memory of the worker:
+
+  ```python
+  dataset = dataset.apply(tf.contrib.data.spilling_shuffle(
+      buffer_size_bytes=200 << 30, memory_budget_bytes=4 << 30,
+      scratch_dir="/mnt/ssd/tmp"))
+  ```
+
+  The size of the buffer can be limited by the number of elements, by their
+  total size in bytes, or both.
+
+  Args:
+    buffer_size: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing
+      the maximum number of elements in the shuffle buffer.
+    buffer_size_bytes: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+      representing the maximum total size in bytes of the elements in the
+      shuffle buffer. At least one of `buffer_size` and `buffer_size_bytes`
+      must be set.
+    memory_budget_bytes: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+      representing the maximum size in bytes of the buffered elements that are
+      kept in memory.
+    scratch_dir: (Optional.) A `tf.string` scalar `tf.Tensor`, representing
+      the directory for the scratch files. Defaults to a local temporary
+      directory.
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      random seed that will be used to create the distribution. See
+      @{tf.set_random_seed} for behavior.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    @{tf.data.Dataset.apply}.
+
+  Raises:
+    ValueError: If neither `buffer_size` nor `buffer_size_bytes` is set.
+  """
+  if buffer_size is None and buffer_size_bytes is None:
+    raise ValueError(
+        "At least one of buffer_size and buffer_size_bytes must be set.")
+
+  def _apply_fn(dataset):  # pylint: disable=missing-docstring
+    return _SpillingShuffleDataset(dataset, buffer_size, buffer_size_bytes,
+                                   memory_budget_bytes, scratch_dir, seed)
+
+  return _apply_fn
@@ -0,0 +1,95 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Dataset snapshot transformations."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.data.python.ops import contrib_op_loader  # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops import gen_dataset_ops
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+
+
+def snapshot(path, num_shards=8):
+  """Materializes a `Dataset` on disk, and reuses it in later runs.
+
+  The first iteration over the transformed dataset writes its elements to a
+  snapshot under `path`, and every later iteration, including those of other
+  programs that build the same input pipeline, reads the snapshot instead of
+  recomputing the input. For example:
+
+  ```python
+  dataset = tf.data.TFRecordDataset(filenames).map(expensive_preprocessing)
+  dataset = dataset.apply(tf.contrib.data.snapshot("/path/to/snapshots"))
+  ```
+
+  Snapshots are keyed by a fingerprint of the graph of the input dataset, so
+  changing the input pipeline, e.g. its input files or the functions it maps,
+  writes a new snapshot. A snapshot becomes visible only after its writer
+  produced all elements, so an iteration that is stopped early, or that
+  crashes, leaves no partial snapshot behind for readers. While one iterator
+  writes a snapshot, other iterators of the same input compute it themselves.
+
+  The input dataset should be deterministic: the snapshot records the
+  elements of a single pass over it, including any randomness in that pass.
+
+  Args:
+    path: A `tf.string` scalar `tf.Tensor`, representing the directory in
+      which snapshots are stored.
+    num_shards: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      number of files that a new snapshot is written to in parallel.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    @{tf.data.Dataset.apply}.
+  """
+
+  def _apply_fn(dataset):
+    return _SnapshotDataset(dataset, path, num_shards)
+
+  return _apply_fn
+
+
+class _SnapshotDataset(dataset_ops.Dataset):
+  """A `Dataset` that reads its input from a snapshot, if there is one."""
+
+  def __init__(self, input_dataset, path, num_shards):
+    """See `snapshot()` for details."""
+    super(_SnapshotDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._path = ops.convert_to_tensor(path, dtype=dtypes.string, name="path")
+    self._num_shards = ops.convert_to_tensor(
+        num_shards, dtype=dtypes.int64, name="num_shards")
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.snapshot_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        path=self._path,
+        num_shards=self._num_shards,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
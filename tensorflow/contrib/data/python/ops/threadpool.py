@@ -23,6 +23,8 @@ from tensorflow.contrib.data.python.ops import contrib_op_loader  # pylint: disa
 from tensorflow.contrib.data.python.ops import gen_dataset_ops
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.eager import context
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
 from tensorflow.python.ops import resource_variable_ops
 
 _uid_counter = 0
@@ -95,3 +97,54 @@ def override_threadpool(dataset, thread_pool):
     @{tf.data.Dataset.map}).
   """
   return _ThreadPoolDataset(dataset, thread_pool)
+
+
+class _SharedSchedulerDataset(dataset_ops.Dataset):
+  """A `Dataset` that acts as an identity, and uses the shared scheduler."""
+
+  def __init__(self, input_dataset, priority):
+    super(_SharedSchedulerDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._priority = ops.convert_to_tensor(
+        priority, dtype=dtypes.int64, name="priority")
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.shared_scheduler_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        self._priority,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+
+def use_shared_scheduler(dataset, priority=0):
+  """Returns a new dataset that runs its operations on the shared scheduler.
+
+  The shared scheduler multiplexes the parallel operations (such as
+  @{tf.data.Dataset.map}) of all input pipelines in the process that use it
+  onto one bounded pool of threads, whose size is the number of schedulable
+  CPU cores unless set by the `TF_DATA_SCHEDULER_NUM_THREADS` environment
+  variable. Setting the `TF_DATA_USE_SHARED_SCHEDULER` environment variable
+  to true makes all input pipelines use it with priority 0.
+
+  Args:
+    dataset: A `tf.data.Dataset` object.
+    priority: A `tf.int64` scalar. The work of pipelines with a higher
+      priority, e.g. for training, runs before that of pipelines with a lower
+      one, e.g. for evaluation. Pipelines of the same priority get equal
+      shares of the threads.
+
+  Returns:
+    A dataset containing the same values as `dataset`.
+  """
+  return _SharedSchedulerDataset(dataset, priority)
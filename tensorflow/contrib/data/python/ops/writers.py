@@ -56,3 +56,44 @@ class TFRecordWriter(object):
                                                     dataset.output_types))
     return gen_dataset_ops.dataset_to_tf_record(
         dataset._as_variant_tensor(), self._filename, self._compression_type)  # pylint: disable=protected-access
+
+
+class ColumnFileWriter(object):
+  """Writes data to a column file, which `ColumnFileDataset` reads."""
+
+  def __init__(self, filename):
+    self._filename = ops.convert_to_tensor(
+        filename, dtypes.string, name="filename")
+
+  def write(self, dataset):
+    """Returns a @{tf.Operation} to write a dataset to a file.
+
+    Args:
+      dataset: a @{tf.data.Dataset} whose elements are row groups: dictionaries
+        mapping column names to vectors of `tf.int64`, `tf.float32` or
+        `tf.string` values, all of the same length. For example, the result of
+        batching a dataset of dictionaries of scalars.
+
+    Returns:
+      A @{tf.Operation} that, when run, writes contents of `dataset` to a file.
+    """
+    if not isinstance(dataset, dataset_ops.Dataset):
+      raise TypeError("`dataset` must be a `tf.data.Dataset` object.")
+    if not isinstance(dataset.output_types, dict):
+      raise TypeError(
+          "`dataset` must produce dictionaries of columns whereas it produces "
+          "types {0}".format(dataset.output_types))
+    for name in dataset.output_types:
+      dtype = dataset.output_types[name]
+      shape = dataset.output_shapes[name]
+      if (dtype not in (dtypes.int64, dtypes.float32, dtypes.string) or
+          not shape.is_compatible_with(tensor_shape.vector(None))):
+        raise TypeError(
+            "Column {0} must be a vector of `tf.int64`, `tf.float32` or "
+            "`tf.string` values whereas it has shape {1} and type {2}".format(
+                name, shape, dtype))
+    # `nest.flatten()` orders the components of a dictionary by their keys.
+    columns = ops.convert_to_tensor(
+        sorted(dataset.output_types), dtypes.string, name="columns")
+    return gen_dataset_ops.dataset_to_column_file(
+        dataset._as_variant_tensor(), self._filename, columns)  # pylint: disable=protected-access
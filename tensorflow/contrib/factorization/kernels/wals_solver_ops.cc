@@ -14,24 +14,18 @@
 // ==============================================================================
 
 // TensorFlow kernels and Ops for constructing WALS normal equations.
-// TODO(agarwal,rmlarsen): Add security checks to the code.
 
 #include <algorithm>
-#include <numeric>
+#include <cmath>
 #include <vector>
 
-// This is only used for std::this_thread::get_id()
-#include <thread>  // NOLINT
-
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
-#include "tensorflow/core/platform/mutex.h"
 
 using tensorflow::DEVICE_CPU;
 using tensorflow::DT_BOOL;
@@ -106,10 +100,63 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
     const float w_0 = unobserved_weights.scalar<float>()();
     const auto& input_values_vec = input_values.vec<float>();
 
+    OP_REQUIRES(context, input_indices.dim_size(1) == 2,
+                InvalidArgument("Input input_indices should have 2 columns, "
+                                "got ",
+                                input_indices.dim_size(1), "."));
+    OP_REQUIRES(context, input_values.dim_size(0) == num_nonzero_elements,
+                InvalidArgument("Input input_values should have ",
+                                num_nonzero_elements, " entries, got ",
+                                input_values.dim_size(0), "."));
+    OP_REQUIRES(context, block_size >= 0,
+                InvalidArgument("Input input_block_size should be "
+                                "non-negative, got ",
+                                block_size, "."));
+    OP_REQUIRES(context, factor_weights.dim_size(0) >= factors_size,
+                InvalidArgument("Input factor_weights should have at least ",
+                                factors_size, " entries, got ",
+                                factor_weights.dim_size(0), "."));
+    OP_REQUIRES(context, input_weights.dim_size(0) >= block_size,
+                InvalidArgument("Input input_weights should have at least ",
+                                block_size, " entries, got ",
+                                input_weights.dim_size(0), "."));
+    for (int64 i = 0; i < factors_size; ++i) {
+      OP_REQUIRES(context, factor_weights_vec(i) >= 0,
+                  InvalidArgument("Input factor_weights should be "
+                                  "non-negative, got ",
+                                  factor_weights_vec(i), " at ", i, "."));
+    }
+    for (int64 i = 0; i < block_size; ++i) {
+      OP_REQUIRES(context, input_weights_vec(i) >= 0,
+                  InvalidArgument("Input input_weights should be "
+                                  "non-negative, got ",
+                                  input_weights_vec(i), " at ", i, "."));
+    }
+
     ConstEigenMatrixFloatMap factors_mat(factors.matrix<float>().data(),
                                          factor_dim, factors_size);
     ConstEigenMatrixInt64Map indices_mat(input_indices.matrix<int64>().data(),
                                          2, num_nonzero_elements);
+    const bool is_transpose = input_is_transpose.scalar<bool>()();
+
+    auto get_input_index = [is_transpose, &indices_mat](int64 i) {
+      return is_transpose ? indices_mat(1, i) : indices_mat(0, i);
+    };
+    auto get_factor_index = [is_transpose, &indices_mat](int64 i) {
+      return is_transpose ? indices_mat(0, i) : indices_mat(1, i);
+    };
+
+    for (int64 i = 0; i < num_nonzero_elements; ++i) {
+      const int64 input_index = get_input_index(i);
+      const int64 factor_index = get_factor_index(i);
+      OP_REQUIRES(context, input_index >= 0 && input_index < block_size,
+                  InvalidArgument("Input index ", input_index, " of entry ", i,
+                                  " is out of range [0, ", block_size, ")."));
+      OP_REQUIRES(context, factor_index >= 0 && factor_index < factors_size,
+                  InvalidArgument("Factor index ", factor_index, " of entry ",
+                                  i, " is out of range [0, ", factors_size,
+                                  ")."));
+    }
 
     Tensor* output_lhs_tensor;
     OP_REQUIRES_OK(context,
@@ -125,138 +172,148 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
     EigenMatrixFloatMap rhs_mat(output_rhs_tensor->matrix<float>().data(),
                                 factor_dim, block_size);
     rhs_mat.setZero();
-    const bool is_transpose = input_is_transpose.scalar<bool>()();
-
-    auto get_input_index = [is_transpose, &indices_mat](int64 i) {
-      return is_transpose ? indices_mat(1, i) : indices_mat(0, i);
-    };
-    auto get_factor_index = [is_transpose, &indices_mat](int64 i) {
-      return is_transpose ? indices_mat(0, i) : indices_mat(1, i);
+    if (num_nonzero_elements == 0) {
+      return;
+    }
+    auto lhs_map = [output_lhs_tensor, factor_dim](int64 input_index) {
+      return EigenMatrixFloatMap(output_lhs_tensor->flat<float>().data() +
+                                     input_index * factor_dim * factor_dim,
+                                 factor_dim, factor_dim);
     };
 
     // TODO(rmlarsen): In principle, we should be using the SparseTensor class
     // and machinery for iterating over groups, but the fact that class
     // SparseTensor makes a complete copy of the matrix makes me reluctant to
     // use it.
+    //
+    // Group the entries by input index in a compressed sparse row layout: the
+    // entries of input index r are perm[row_offsets[r]..row_offsets[r + 1]).
+    // The counting sort is stable, which preserves spatial locality.
+    std::vector<int64> row_offsets(block_size + 1, 0);
+    for (int64 i = 0; i < num_nonzero_elements; ++i) {
+      ++row_offsets[get_input_index(i) + 1];
+    }
+    for (int64 r = 0; r < block_size; ++r) {
+      row_offsets[r + 1] += row_offsets[r];
+    }
     std::vector<int64> perm(num_nonzero_elements);
-    std::iota(perm.begin(), perm.end(), 0);
-
-    typedef std::pair<int64, int64> Shard;
-    std::vector<Shard> shards;
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
-    int64 shard_total = 0;
-    // Compute a permutation such that get_input_index(perm[i]) is sorted, use
-    // stable_sort to preserve spatial locality.
-    std::stable_sort(perm.begin(), perm.end(),
-                     [&get_input_index](int64 i, int64 j) {
-                       return get_input_index(i) < get_input_index(j);
-                     });
-
-    // Compute the start and end of runs with identical input_index.
-    // These are the shards of work that can be processed in parallel
-    // without locking.
-    int64 start = 0;
-    int64 end = 0;
-    while (end < num_nonzero_elements) {
-      start = end;
-      while (end < num_nonzero_elements &&
-             get_input_index(perm[start]) == get_input_index(perm[end])) {
-        ++end;
+    {
+      std::vector<int64> next(row_offsets.begin(), row_offsets.end() - 1);
+      for (int64 i = 0; i < num_nonzero_elements; ++i) {
+        perm[next[get_input_index(i)]++] = i;
       }
-      shards.emplace_back(start, end);
-      shard_total += end - start;
     }
-    CHECK_EQ(shard_total, num_nonzero_elements);
-    CHECK_LE(shards.size(), num_nonzero_elements);
-    CHECK_GT(shards.size(), 0);
 
     // Batch the rank-one updates into a rank-k update to lower memory traffic
     const int kMaxBatchSize = 128;
 
-    // Since we do not have an easy way of generating thread id's within the
-    // range [0,num_threads), we can instead call out to an std::unordered_map
-    // of matrices and initialize the matrix on the first call.
-    // However, this might have a performance penalty, as memory allocation can
-    // cause the OS kernel to enter a critical section and temporarily disable
-    // parallelism, and the unordered_map must be protected with a read/write
-    // mutex.
-    //
-    // TODO(jpoulson): Simplify after the thread rank can be queried
-    std::unordered_map<size_t, Eigen::MatrixXf> factor_batch_map;
-    mutex map_mutex;
-
-    BlockingCounter counter(shards.size());
-    // Lambda encapsulating the per-shard computation.
-    auto work = [&](const Shard& shard) {
-      const std::thread::id thread_id = std::this_thread::get_id();
-      const size_t id_hash = std::hash<std::thread::id>()(thread_id);
-      // If this thread's unique factors_mat.rows() x kMaxBatchSize
-      // batching matrix has not yet been created, then emplace it into the
-      // map using the hash of the thread id as the key.
-      //
-      // TODO(jpoulson): Switch to try_emplace once C++17 is supported
-      map_mutex.lock();
-      const auto key_count = factor_batch_map.count(id_hash);
-      map_mutex.unlock();
-      if (!key_count) {
-        map_mutex.lock();
-        factor_batch_map.emplace(
-            std::piecewise_construct, std::forward_as_tuple(id_hash),
-            std::forward_as_tuple(factors_mat.rows(), kMaxBatchSize));
-        map_mutex.unlock();
+    // Accumulates the lhs and rhs terms in the normal equations for the
+    // entries perm[begin..end), which all have the same input index, into the
+    // lower triangle of 'lhs' and into 'rhs'. The rank-one updates are
+    // batched into the columns of 'factor_batch', so that they are applied as
+    // vectorized symmetric rank-k updates.
+    auto accumulate = [&](int64 begin, int64 end, int64 input_index,
+                          Eigen::MatrixXf* factor_batch,
+                          Eigen::Ref<Eigen::MatrixXf> lhs,
+                          Eigen::Ref<Eigen::VectorXf> rhs) {
+      if (factor_batch->size() == 0) {
+        factor_batch->resize(factor_dim, kMaxBatchSize);
       }
-      map_mutex.lock();
-      auto& factor_batch = factor_batch_map[id_hash];
-      map_mutex.unlock();
-
-      CHECK_GE(shard.first, 0);
-      CHECK_LE(shard.second, perm.size());
-      CHECK_LE(shard.first, shard.second);
-      const int64 input_index = get_input_index(perm[shard.first]);
-      // Accumulate the rhs and lhs terms in the normal equations
-      // for the non-zero elements in the row or column of the sparse matrix
-      // corresponding to input_index.
+      auto lhs_symm = lhs.selfadjointView<Eigen::Lower>();
+      const float input_weight = input_weights_vec(input_index);
       int num_batched = 0;
-      EigenMatrixFloatMap lhs_mat(output_lhs_tensor->flat<float>().data() +
-                                      input_index * factor_dim * factor_dim,
-                                  factor_dim, factor_dim);
-      auto lhs_symm = lhs_mat.selfadjointView<Eigen::Lower>();
-      for (int64 p = shard.first; p < shard.second; ++p) {
+      for (int64 p = begin; p < end; ++p) {
         const int64 i = perm[p];
-        // Check that all entries in the shard have the same input index.
-        CHECK_EQ(input_index, get_input_index(i));
         const int64 factor_index = get_factor_index(i);
-        const float input_value = input_values_vec(i);
-        const float weight =
-            input_weights_vec(input_index) * factor_weights_vec(factor_index);
-        CHECK_GE(weight, 0);
-        factor_batch.col(num_batched) =
+        const float weight = input_weight * factor_weights_vec(factor_index);
+        factor_batch->col(num_batched) =
             factors_mat.col(factor_index) * std::sqrt(weight);
         ++num_batched;
         if (num_batched == kMaxBatchSize) {
-          lhs_symm.rankUpdate(factor_batch);
+          lhs_symm.rankUpdate(*factor_batch);
           num_batched = 0;
         }
-
-        rhs_mat.col(input_index) +=
-            input_value * (w_0 + weight) * factors_mat.col(factor_index);
+        rhs.noalias() +=
+            input_values_vec(i) * (w_0 + weight) * factors_mat.col(factor_index);
       }
       if (num_batched != 0) {
-        auto factor_block =
-            factor_batch.block(0, 0, factors_mat.rows(), num_batched);
-        lhs_symm.rankUpdate(factor_block);
+        lhs_symm.rankUpdate(factor_batch->leftCols(num_batched));
       }
-      // Copy lower triangular to upper triangular part of normal equation
-      // matrix.
-      lhs_mat = lhs_symm;
-      counter.DecrementCount();
     };
-    for (size_t i = 1; i < shards.size(); ++i) {
-      worker_threads.workers->Schedule(std::bind(work, shards[i]));
+    // Copies the lower triangular part of a normal equation matrix to its
+    // upper triangular part.
+    auto symmetrize = [](Eigen::Ref<Eigen::MatrixXf> lhs) {
+      lhs.triangularView<Eigen::StrictlyUpper>() = lhs.transpose();
+    };
+
+    thread::ThreadPool* workers =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    const int num_workers = workers->NumThreads() + 1;
+    // Each worker has its own batching matrix, allocated on first use.
+    std::vector<Eigen::MatrixXf> factor_batches(num_workers);
+
+    // Rows with many more entries than a worker's fair share would serialize
+    // the computation, so the entries of such rows are split between workers
+    // instead, each of which accumulates partial sums that are added up at
+    // the end.
+    const int64 kMinHeavyRowSize = 4096;
+    const int64 heavy_row_size =
+        std::max(kMinHeavyRowSize, num_nonzero_elements / num_workers);
+    auto is_heavy = [&row_offsets, heavy_row_size](int64 r) {
+      return row_offsets[r + 1] - row_offsets[r] >= heavy_row_size;
+    };
+
+    // The entries are split into shards of about equal cost, and each shard
+    // processes the rows whose first entry it contains, so that skewed rows
+    // do not unbalance the shards as much as splitting by rows would.
+    const int64 cost_per_entry = factor_dim * (factor_dim + 4);
+    workers->ParallelForWithWorkerId(
+        num_nonzero_elements, cost_per_entry,
+        [&](int64 start, int64 limit, int worker_id) {
+          int64 r = std::lower_bound(row_offsets.begin(),
+                                     row_offsets.end() - 1, start) -
+                    row_offsets.begin();
+          for (; r < block_size && row_offsets[r] < limit; ++r) {
+            if (row_offsets[r] == row_offsets[r + 1] || is_heavy(r)) {
+              continue;
+            }
+            EigenMatrixFloatMap lhs_mat = lhs_map(r);
+            accumulate(row_offsets[r], row_offsets[r + 1], r,
+                       &factor_batches[worker_id], lhs_mat, rhs_mat.col(r));
+            symmetrize(lhs_mat);
+          }
+        });
+
+    std::vector<Eigen::MatrixXf> partial_lhs(num_workers);
+    std::vector<Eigen::VectorXf> partial_rhs(num_workers);
+    for (int64 r = 0; r < block_size; ++r) {
+      if (!is_heavy(r)) {
+        continue;
+      }
+      for (int w = 0; w < num_workers; ++w) {
+        partial_lhs[w].resize(0, 0);
+      }
+      workers->ParallelForWithWorkerId(
+          row_offsets[r + 1] - row_offsets[r], cost_per_entry,
+          [&](int64 start, int64 limit, int worker_id) {
+            Eigen::MatrixXf& lhs = partial_lhs[worker_id];
+            Eigen::VectorXf& rhs = partial_rhs[worker_id];
+            if (lhs.size() == 0) {
+              lhs.setZero(factor_dim, factor_dim);
+              rhs.setZero(factor_dim);
+            }
+            accumulate(row_offsets[r] + start, row_offsets[r] + limit, r,
+                       &factor_batches[worker_id], lhs, rhs);
+          });
+      EigenMatrixFloatMap lhs_mat = lhs_map(r);
+      for (int w = 0; w < num_workers; ++w) {
+        if (partial_lhs[w].size() != 0) {
+          lhs_mat += partial_lhs[w];
+          rhs_mat.col(r) += partial_rhs[w];
+        }
+      }
+      symmetrize(lhs_mat);
     }
-    // Inline execute the 1st shard.
-    work(shards[0]);
-    counter.Wait();
   }
 };
 
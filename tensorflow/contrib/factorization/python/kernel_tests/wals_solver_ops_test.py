@@ -78,6 +78,49 @@ class WalsSolverOpsTest(test.TestCase):
                                               [0.160400, 0.220000, 0.279600],
                                               [0.492800, 0.563200, 0.633600]])
 
+  def testWalsSolverSkewedRows(self):
+    # One row has enough entries to be split between threads, the others are
+    # small or empty.
+    np.random.seed(0)
+    num_rows, num_cols, dim = 6, 50, 4
+    rows = np.concatenate([
+        np.zeros(5000, dtype=np.int64),
+        np.random.randint(2, num_rows, size=300).astype(np.int64)
+    ])
+    cols = np.random.randint(0, num_cols, size=rows.size).astype(np.int64)
+    values = np.random.uniform(size=rows.size).astype(np.float32)
+    factors = np.random.uniform(size=(num_cols, dim)).astype(np.float32)
+    col_weights = np.random.uniform(size=num_cols).astype(np.float32)
+    row_weights = np.random.uniform(size=num_rows).astype(np.float32)
+    w_0 = 0.1
+
+    expected_lhs = np.zeros((num_rows, dim, dim))
+    expected_rhs = np.zeros((num_rows, dim))
+    for r, c, v in zip(rows, cols, values):
+      weight = row_weights[r] * col_weights[c]
+      expected_lhs[r] += weight * np.outer(factors[c], factors[c])
+      expected_rhs[r] += v * (w_0 + weight) * factors[c]
+
+    with self.test_session():
+      for is_transpose in [False, True]:
+        indices = np.stack([rows, cols] if not is_transpose else [cols, rows],
+                           axis=1)
+        lhs, rhs = gen_factorization_ops.wals_compute_partial_lhs_and_rhs(
+            factors, col_weights, w_0, row_weights, indices, values, num_rows,
+            is_transpose)
+        self.assertAllClose(expected_lhs, lhs.eval(), rtol=1e-3)
+        self.assertAllClose(expected_rhs, rhs.eval(), rtol=1e-3)
+
+  def testWalsSolverInvalidIndices(self):
+    sparse_block = SparseBlock3x3()
+    with self.test_session():
+      lhs, _ = gen_factorization_ops.wals_compute_partial_lhs_and_rhs(
+          self._column_factors, self._column_weights, self._unobserved_weights,
+          self._row_weights, sparse_block.indices, sparse_block.values, 3,
+          False)
+      with self.assertRaisesOpError("out of range"):
+        lhs.eval()
+
 
 if __name__ == "__main__":
   test.main()
@@ -948,8 +948,12 @@ class WALSModel(object):
               name="wals_compute_partial_lhs_rhs"))
       total_lhs = array_ops.expand_dims(total_lhs, 0) + partial_lhs
       total_rhs = array_ops.expand_dims(total_rhs, -1)
+      # The normal equations are symmetric positive definite, so they are
+      # solved with a batched Cholesky factorization, which is about twice as
+      # cheap as the LU factorization of tf.matrix_solve.
       new_left_values = array_ops.squeeze(
-          linalg_ops.matrix_solve(total_lhs, total_rhs), [2])
+          linalg_ops.cholesky_solve(linalg_ops.cholesky(total_lhs), total_rhs),
+          [2])
 
     update_op_name = "row_update" if update_row_factors else "col_update"
     update_op = self.scatter_update(
@@ -19,6 +19,9 @@
 @@decode_wav
 @@encode_wav
 @@audio_spectrogram
+@@audio_spectrogram_stream
+@@audio_spectrogram_stream_compute
+@@audio_spectrogram_stream_reset
 @@mfcc
 """
 from __future__ import absolute_import
@@ -16,42 +16,12 @@ limitations under the License.
 #ifndef GDR_MEMORY_MANAGER_H_
 #define GDR_MEMORY_MANAGER_H_
 
-#include "google/protobuf/any.pb.h"
-#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_manager.h"
 
 namespace tensorflow {
 
-class Device;
-class DeviceContext;
-class Tensor;
-
-// Abstract interface that handles out-of-band tensor transport.
-//
-// The transport options are encoded into a protocol buffer and transmitted via
-// some other communication channels like RPC.
-// See RecvTensorRequest in tensorflow/core/protobuf/worker.proto
-class RemoteMemoryManager {
- public:
-  virtual ~RemoteMemoryManager() {}
-  virtual Status Init() = 0;
-  virtual void Run() = 0;
-  virtual void Stop() = 0;
-
-  // Encodes the tensor information to an arbitrary protocol buffer
-  // The protocol buffer needs to be transmitted via some other channel
-  virtual void TransportOptionsFromTensor(
-      ::google::protobuf::Any* mutable_transport_options, const Tensor& tensor,
-      Device* device, DeviceContext* device_context, bool on_host,
-      StatusCallback done) = 0;
-
-  // Retrieve the tensor from the encoded protocol buffer
-  // Note that the tensor has to be allocated, but not initialized
-  virtual void TensorFromTransportOptions(
-      Tensor* tensor, const ::google::protobuf::Any& transport_options,
-      Device* device, DeviceContext* device_context, bool on_host,
-      StatusCallback done) = 0;
-};
-
+// Creates a RemoteMemoryManager that transfers tensors with GPUDirect RDMA
+// through the RDMA CM listening on "host":"port".
 RemoteMemoryManager* CreateRemoteMemoryManager(const string& host,
                                                const string& port);
 
@@ -48,6 +48,9 @@ GdrServer::GdrServer(const ServerDef& server_def, Env* env)
 GdrServer::~GdrServer() {}
 
 Status GdrServer::Init() {
+  // Lets the collectives share the memory regions and RDMA endpoints of the
+  // rendezvous.
+  worker_env()->remote_memory_manager = remote_memory_manager_.get();
   RendezvousMgrCreationFunction rendezvous_mgr_func =
       [this](const WorkerEnv* env) {
         return new GdrRendezvousMgr(env, remote_memory_manager_.get());
@@ -15,18 +15,21 @@
 """Kafka Dataset.
 
 @@KafkaDataset
+@@KafkaBatchDataset
 """
 
 from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+from tensorflow.contrib.kafka.python.ops.kafka_dataset_ops import KafkaBatchDataset
 from tensorflow.contrib.kafka.python.ops.kafka_dataset_ops import KafkaDataset
 
 from tensorflow.python.util.all_util import remove_undocumented
 
 _allowed_symbols = [
     "KafkaDataset",
+    "KafkaBatchDataset",
 ]
 
 remove_undocumented(__name__)
@@ -41,4 +41,34 @@ timeout: The timeout value for the Kafka Consumer to wait
   (in millisecond).
 )doc");
 
+REGISTER_OP("KafkaBatchDataset")
+    .Input("topics: string")
+    .Input("servers: string")
+    .Input("group: string")
+    .Input("eof: bool")
+    .Input("timeout: int64")
+    .Input("batch_size: int64")
+    .Output("handle: variant")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that emits batches of the messages of Kafka topics.
+
+The subscriptions are read in parallel, each by its own consumer, and the
+batches mix their messages. The messages of a subscription keep their order.
+Checkpointing the iterator also commits the offsets of the produced messages
+to the consumer group, asynchronously.
+
+topics: A `tf.string` tensor containing one or more subscriptions,
+  in the format of [topic:partition:offset:length],
+  by default length is -1 for unlimited.
+servers: A list of bootstrap servers.
+group: The consumer group id.
+eof: If True, the kafka reader will stop on EOF.
+timeout: The timeout value for the Kafka Consumer to wait
+  (in millisecond).
+batch_size: The maximum number of messages in a batch. Only the last batch
+  may have fewer messages.
+)doc");
+
 }  // namespace tensorflow
@@ -18,12 +18,17 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
+
+from tensorflow.contrib.data.python.ops import iterator_ops as contrib_iterator_ops
 from tensorflow.contrib.kafka.python.ops import kafka_dataset_ops
 from tensorflow.python.data.ops import iterator_ops
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.platform import test
+from tensorflow.python.training import saver as saver_lib
 
 
 class KafkaDatasetTest(test.TestCase):
@@ -110,6 +115,70 @@ class KafkaDatasetTest(test.TestCase):
         self.assertAllEqual(["D" + str(i + 5) for i in range(5)],
                             sess.run(get_next))
 
+  def testKafkaBatchDataset(self):
+    topics = array_ops.placeholder(dtypes.string, shape=[None])
+    batch_size = array_ops.placeholder(dtypes.int64, shape=[])
+
+    batch_dataset = kafka_dataset_ops.KafkaBatchDataset(
+        topics, batch_size, group="test", eof=True)
+    iterator = batch_dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      # Both subscriptions are read in parallel, in order within each.
+      sess.run(
+          iterator.initializer,
+          feed_dict={
+              topics: ["test:0:0:4", "test:0:5:-1"],
+              batch_size: 3
+          })
+      messages = []
+      while True:
+        try:
+          batch = sess.run(get_next)
+        except errors.OutOfRangeError:
+          break
+        self.assertLessEqual(len(batch), 3)
+        messages.extend(batch)
+      self.assertEqual(10, len(messages))
+      self.assertAllEqual(["D" + str(i) for i in range(10)], sorted(messages))
+      for i in range(4):
+        self.assertLess(
+            messages.index("D" + str(i)), messages.index("D" + str(i + 1)))
+
+      # A single subscription produces full batches in order.
+      sess.run(
+          iterator.initializer,
+          feed_dict={
+              topics: ["test:0:0:-1"],
+              batch_size: 4
+          })
+      self.assertAllEqual(["D0", "D1", "D2", "D3"], sess.run(get_next))
+      self.assertAllEqual(["D4", "D5", "D6", "D7"], sess.run(get_next))
+      self.assertAllEqual(["D8", "D9"], sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testKafkaBatchDatasetSaveRestore(self):
+    batch_dataset = kafka_dataset_ops.KafkaBatchDataset(
+        ["test:0:0:-1"], 3, group="test", eof=True)
+    iterator = batch_dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+    saveable = contrib_iterator_ops.make_saveable_from_iterator(iterator)
+    ops.add_to_collection(ops.GraphKeys.SAVEABLE_OBJECTS, saveable)
+    saver = saver_lib.Saver()
+    checkpoint_path = os.path.join(self.get_temp_dir(), "kafka")
+
+    with self.test_session() as sess:
+      sess.run(iterator.initializer)
+      self.assertAllEqual(["D0", "D1", "D2"], sess.run(get_next))
+      saver.save(sess, checkpoint_path)
+      self.assertAllEqual(["D3", "D4", "D5"], sess.run(get_next))
+      # Restoring goes back to the message after the last produced batch,
+      # even though more messages were fetched.
+      saver.restore(sess, checkpoint_path)
+      self.assertAllEqual(["D3", "D4", "D5"], sess.run(get_next))
+
 
 if __name__ == "__main__":
   test.main()
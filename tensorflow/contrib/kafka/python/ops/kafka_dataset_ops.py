@@ -73,3 +73,68 @@ class KafkaDataset(Dataset):
   @property
   def output_types(self):
     return dtypes.string
+
+
+class KafkaBatchDataset(Dataset):
+  """A Kafka Dataset that consumes batches of messages.
+
+  Each subscription is read in parallel by its own consumer on a background
+  thread, and each element is a 1-D `tf.string` tensor of up to `batch_size`
+  messages. The messages of a subscription keep their order, but the
+  subscriptions are interleaved nondeterministically.
+
+  Saving the iterator in a checkpoint records the offset of the next message
+  of each subscription, and commits it to the consumer `group`
+  asynchronously.
+  """
+
+  def __init__(self,
+               topics,
+               batch_size,
+               servers="localhost",
+               group="",
+               eof=False,
+               timeout=1000):
+    """Create a KafkaBatchDataset.
+
+    Args:
+      topics: A `tf.string` tensor containing one or more subscriptions,
+              in the format of [topic:partition:offset:length],
+              by default length is -1 for unlimited.
+      batch_size: A `tf.int64` scalar, the maximum number of messages in a
+                  batch.
+      servers: A list of bootstrap servers.
+      group: The consumer group id.
+      eof: If True, the kafka reader will stop on EOF.
+      timeout: The timeout value for the Kafka Consumer to wait
+               (in millisecond).
+    """
+    super(KafkaBatchDataset, self).__init__()
+    self._topics = ops.convert_to_tensor(
+        topics, dtype=dtypes.string, name="topics")
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._servers = ops.convert_to_tensor(
+        servers, dtype=dtypes.string, name="servers")
+    self._group = ops.convert_to_tensor(
+        group, dtype=dtypes.string, name="group")
+    self._eof = ops.convert_to_tensor(eof, dtype=dtypes.bool, name="eof")
+    self._timeout = ops.convert_to_tensor(
+        timeout, dtype=dtypes.int64, name="timeout")
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.kafka_batch_dataset(
+        self._topics, self._servers, self._group, self._eof, self._timeout,
+        self._batch_size)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.vector(None)
+
+  @property
+  def output_types(self):
+    return dtypes.string
@@ -19,6 +19,7 @@ See the @{$python/contrib.layers} guide.
 @@avg_pool2d
 @@avg_pool3d
 @@batch_norm
+@@CachedEmbedding
 @@convolution
 @@convolution1d
 @@convolution2d
@@ -28,20 +28,25 @@ from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import check_ops
 from tensorflow.python.ops import clip_ops
 from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import data_flow_ops
 from tensorflow.python.ops import embedding_ops
+from tensorflow.python.ops import gen_resource_variable_ops
+from tensorflow.python.ops import init_ops
 from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import nn_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import sparse_ops
+from tensorflow.python.ops import variable_scope
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import tf_logging as logging
 
 __all__ = [
     "safe_embedding_lookup_sparse", "scattered_embedding_lookup",
     "scattered_embedding_lookup_sparse", "embedding_lookup_unique",
-    "embedding_lookup_sparse_with_distributed_aggregation"
+    "embedding_lookup_sparse_with_distributed_aggregation", "CachedEmbedding"
 ]
 
 
@@ -499,6 +504,176 @@ def embedding_lookup_unique(params, ids, partition_strategy="mod", name=None):
     return embeds
 
 
+class CachedEmbedding(object):
+  """An embedding table kept in host memory with a cache of its rows.
+
+  Tables too large for GPU memory otherwise have to be gathered from on CPU
+  and copied to the GPU in full every step. This keeps the `table` on CPU and
+  a `cache` of `cache_size` of its rows on the device in scope when the
+  `CachedEmbedding` is created. Each `lookup` moves the rows missing from the
+  cache in with one batched copy, into the least recently used slots, after
+  writing the rows they replace back to the table.
+
+  The rows are trained in the cache: gradients of `lookup` go to the `cache`
+  variable, which an optimizer updates sparsely as any other. Slot variables
+  of the optimizer are kept per cache slot though, so an evicted row's
+  accumulators are carried over to the row taking its slot; optimizers
+  without slots, like plain SGD, are not affected.
+
+  Each `lookup` updates the cache, so lookups must run one after another (at
+  most one per step), and the ids of one lookup must fit in the cache. The
+  table only holds the latest values of rows that are not cached: run `flush`
+  before reading it, e.g. to export the embeddings. Saving and restoring all
+  the variables of a `CachedEmbedding` together needs no flush.
+  """
+
+  def __init__(self,
+               vocab_size,
+               dimension,
+               cache_size,
+               initializer=None,
+               dtype=dtypes.float32,
+               name=None):
+    """Creates the table, the cache and their bookkeeping.
+
+    Args:
+      vocab_size: The number of rows of the table.
+      dimension: The size of each row.
+      cache_size: The number of rows the cache holds. Must be at least the
+        number of distinct ids of a lookup.
+      initializer: The initializer of the table, as in `get_variable`.
+      dtype: The type of the embeddings.
+      name: The name of the variable scope of the variables (optional).
+    """
+    self._cache_size = cache_size
+    with variable_scope.variable_scope(name, "CachedEmbedding"):
+      with ops.device("/cpu:0"):
+        self._table = variable_scope.get_variable(
+            "table", [vocab_size, dimension],
+            dtype=dtype,
+            initializer=initializer,
+            trainable=False,
+            use_resource=True)
+        # The cache slot of each id, -1 if not cached.
+        self._slot_of_id = self._get_int64_variable("slot_of_id", vocab_size,
+                                                    -1)
+        # The id of each cache slot, -1 if the slot is empty.
+        self._id_of_slot = self._get_int64_variable("id_of_slot", cache_size,
+                                                    -1)
+        # The lookup which last used each cache slot, -1 if the slot is empty.
+        self._last_used = self._get_int64_variable("last_used", cache_size, -1)
+        self._num_lookups = self._get_int64_variable("num_lookups", None, 0)
+      self._cache = variable_scope.get_variable(
+          "cache", [cache_size, dimension],
+          dtype=dtype,
+          initializer=init_ops.zeros_initializer(),
+          use_resource=True)
+
+  def _get_int64_variable(self, name, size, value):
+    return variable_scope.get_variable(
+        name, [] if size is None else [size],
+        dtype=dtypes.int64,
+        initializer=init_ops.constant_initializer(value),
+        trainable=False,
+        use_resource=True)
+
+  @property
+  def table(self):
+    return self._table
+
+  @property
+  def cache(self):
+    return self._cache
+
+  def lookup(self, ids, name=None):
+    """Looks up `ids`, moving the rows missing from the cache into it.
+
+    Args:
+      ids: A `Tensor` of type `int32` or `int64` with the ids to look up.
+      name: A name for the operation (optional).
+
+    Returns:
+      A `Tensor` of shape `ids.shape + [dimension]` with the embeddings.
+    """
+    with ops.name_scope(name, "CachedEmbeddingLookup", [ids]):
+      ids = ops.convert_to_tensor(ids)
+      shape = array_ops.shape(ids)
+      unique_ids, idx = array_ops.unique(
+          math_ops.to_int64(array_ops.reshape(ids, [-1])))
+      with ops.device(self._num_lookups.device):
+        lookup_id = ops.convert_to_tensor(self._num_lookups.assign_add(1))
+        fits = check_ops.assert_less_equal(
+            array_ops.size(unique_ids),
+            self._cache_size,
+            message="More distinct ids than the cache holds")
+        with ops.control_dependencies([lookup_id, fits]):
+          slots = self._slot_of_id.sparse_read(unique_ids)
+        is_miss = math_ops.less(slots, 0)
+        miss_ids = array_ops.boolean_mask(unique_ids, is_miss)
+        hit_slots = array_ops.boolean_mask(slots, math_ops.logical_not(is_miss))
+        mark_hits = self._scatter_update(
+            self._last_used, hit_slots,
+            array_ops.fill(array_ops.shape(hit_slots), lookup_id))
+
+        # The hits were just marked as the most recently used slots, so the
+        # least recently used ones are free to take the misses.
+        with ops.control_dependencies([mark_hits]):
+          _, evict_slots = nn_ops.top_k(
+              math_ops.negative(self._last_used.read_value()),
+              k=array_ops.size(miss_ids),
+              sorted=False)
+        evict_slots = math_ops.to_int64(evict_slots)
+        evict_ids = self._id_of_slot.sparse_read(evict_slots)
+        is_used = math_ops.greater_equal(evict_ids, 0)
+        write_back_ids = array_ops.boolean_mask(evict_ids, is_used)
+        write_back = self._scatter_update(
+            self._table, write_back_ids,
+            self._cache.sparse_read(array_ops.boolean_mask(evict_slots,
+                                                           is_used)))
+        unmap = self._scatter_update(
+            self._slot_of_id, write_back_ids,
+            array_ops.fill(array_ops.shape(write_back_ids),
+                           constant_op.constant(-1, dtypes.int64)))
+
+        with ops.control_dependencies([write_back, unmap]):
+          fetch = self._scatter_update(self._cache, evict_slots,
+                                       self._table.sparse_read(miss_ids))
+          remap = control_flow_ops.group(
+              self._scatter_update(self._slot_of_id, miss_ids, evict_slots),
+              self._scatter_update(self._id_of_slot, evict_slots, miss_ids),
+              self._scatter_update(
+                  self._last_used, evict_slots,
+                  array_ops.fill(array_ops.shape(evict_slots), lookup_id)))
+        with ops.control_dependencies([remap]):
+          unique_slots = self._slot_of_id.sparse_read(unique_ids)
+
+      with ops.control_dependencies([fetch]):
+        unique_embeddings = self._cache.sparse_read(unique_slots)
+      embeddings = array_ops.gather(unique_embeddings, idx)
+      embeddings = array_ops.reshape(
+          embeddings,
+          array_ops.concat([shape, array_ops.shape(unique_embeddings)[1:]], 0))
+      embeddings.set_shape(ids.get_shape().concatenate(
+          self._cache.get_shape()[1:]))
+      return embeddings
+
+  def flush(self, name=None):
+    """Returns an op writing the rows in the cache back to the table."""
+    with ops.name_scope(name, "CachedEmbeddingFlush"):
+      with ops.device(self._table.device):
+        slot_ids = self._id_of_slot.read_value()
+        is_used = math_ops.greater_equal(slot_ids, 0)
+        used_slots = array_ops.boolean_mask(
+            math_ops.range(self._cache_size, dtype=dtypes.int64), is_used)
+        return self._scatter_update(
+            self._table, array_ops.boolean_mask(slot_ids, is_used),
+            self._cache.sparse_read(used_slots))
+
+  def _scatter_update(self, variable, indices, updates):
+    return gen_resource_variable_ops.resource_scatter_update(
+        variable.handle, indices, updates)
+
+
 def _sampled_scattered_embedding_lookup_sparse(params,
                                                sp_values,
                                                dimension=None,
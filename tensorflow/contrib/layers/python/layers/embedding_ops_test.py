@@ -37,7 +37,9 @@ from tensorflow.python.ops import gradient_checker
 from tensorflow.python.ops import init_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import partitioned_variables
+from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
+from tensorflow.python.training import gradient_descent
 from tensorflow.python.util import compat
 
 
@@ -388,6 +390,45 @@ class ScatteredEmbeddingLookupTest(test.TestCase):
     np.testing.assert_almost_equal(embedded_np2d, embedded_tf2d)
 
 
+class CachedEmbeddingTest(test.TestCase):
+
+  def test_lookup_with_evictions(self):
+    table = np.random.randn(10, 2).astype(np.float32)
+    all_ids = [[0, 1, 1], [2, 3, 0], [4, 5, 6], [1, 4, 1]]
+    with self.test_session() as sess:
+      embedding = embedding_ops.CachedEmbedding(
+          10, 2, cache_size=3, initializer=init_ops.constant_initializer(table))
+      ids = array_ops.placeholder(dtypes.int64, [3])
+      lookup = embedding.lookup(ids)
+      flush = embedding.flush()
+      variables.global_variables_initializer().run()
+      for step_ids in all_ids:
+        np.testing.assert_almost_equal(
+            table[step_ids], sess.run(lookup, {ids: step_ids}))
+      flush.run()
+      np.testing.assert_almost_equal(table, embedding.table.eval())
+
+  def test_training_writes_back_evicted_rows(self):
+    table = np.random.randn(10, 2).astype(np.float32)
+    all_ids = [[[0, 1], [1, 2]], [[3, 4], [5, 3]], [[0, 6], [6, 6]]]
+    with self.test_session() as sess:
+      embedding = embedding_ops.CachedEmbedding(
+          10, 2, cache_size=4, initializer=init_ops.constant_initializer(table))
+      ids = array_ops.placeholder(dtypes.int64, [2, 2])
+      lookup = embedding.lookup(ids)
+      train = gradient_descent.GradientDescentOptimizer(0.5).minimize(
+          math_ops.reduce_sum(lookup))
+      variables.global_variables_initializer().run()
+      for step_ids in all_ids:
+        np.testing.assert_almost_equal(
+            table[step_ids], sess.run(lookup, {ids: step_ids}))
+        sess.run(train, {ids: step_ids})
+        for i in np.array(step_ids).flatten():
+          table[i] -= 0.5
+      embedding.flush().run()
+      np.testing.assert_almost_equal(table, embedding.table.eval())
+
+
 class SampledScatteredEmbeddingLookupTest(test.TestCase):
 
   def setUp(self):
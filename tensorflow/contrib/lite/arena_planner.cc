@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/arena_planner.h"
+#include <cstring>
 #include <utility>
 
 namespace tflite {
@@ -21,7 +22,9 @@ namespace {
 
 // Memory allocation tuning
 constexpr const int kDefaultArenaAlignment = 64;
-constexpr const int kDefaultTensorAlignment = 4;
+
+// The first word of a serialized ArenaPlan, which changes with its format.
+constexpr uint64_t kArenaPlanMagic = 0x314E414C50464C54ull;  // "TFLPLAN1"
 
 }  // namespace
 
@@ -35,13 +38,42 @@ struct AllocationInfo {
 };
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
-                           std::unique_ptr<GraphInfo> graph_info)
+                           std::unique_ptr<GraphInfo> graph_info,
+                           std::shared_ptr<ArenaBuffer> shared_arena)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
-      persistent_arena_(kDefaultArenaAlignment) {}
+      persistent_arena_(kDefaultArenaAlignment),
+      shared_arena_(std::move(shared_arena)),
+      resolved_(false) {
+  if (shared_arena_) {
+    arena_.SetBuffer(context_, shared_arena_);
+    // Another planner may move the buffer when it grows it.
+    shared_arena_->AddMoveCallback(this, [this]() {
+      if (resolved_) ResolveAllocations();
+    });
+  }
+}
+
+ArenaPlanner::~ArenaPlanner() {
+  if (shared_arena_) {
+    shared_arena_->RemoveMoveCallback(this);
+  }
+}
 
-ArenaPlanner::~ArenaPlanner() {}
+void ArenaPlanner::SetNodeStages(std::vector<int> node_stages) {
+  node_stages_ = std::move(node_stages);
+}
+
+bool ArenaPlanner::IsFirstNodeOfStage(int node_index) const {
+  return node_stages_.empty() || node_index == 0 ||
+         node_stages_[node_index] != node_stages_[node_index - 1];
+}
+
+bool ArenaPlanner::IsLastNodeOfStage(int node_index) const {
+  return node_stages_.empty() || node_index + 1 == node_stages_.size() ||
+         node_stages_[node_index] != node_stages_[node_index + 1];
+}
 
 int64_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
   if (type == kTfLiteArenaRwPersistent) {
@@ -56,6 +88,7 @@ int64_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
 TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(arena_.Clear());
   TF_LITE_ENSURE_STATUS(persistent_arena_.Clear());
+  resolved_ = false;
   allocs_.clear();
   allocs_.resize(graph_info_->num_tensors());
   return kTfLiteOk;
@@ -146,9 +179,15 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       TF_LITE_ENSURE_STATUS(allocate(0, tensor_index));
     }
   }
+  TF_LITE_ENSURE(context_, node_stages_.empty() ||
+                               node_stages_.size() == graph_info_->num_nodes());
   // Go through the graph in execution order.
+  int stage_start = 0;
   for (int i = 0; i < graph_info_->num_nodes(); ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    if (IsFirstNodeOfStage(i)) {
+      stage_start = i;
+    }
 
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
@@ -157,15 +196,21 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
     }
 
-    // Then update the ref-counts of the node's inputs, and if necessary queue
-    // them for deallocation.
-    TfLiteIntArray* node_inputs = node.inputs;
-    for (int j = 0; j < node_inputs->size; ++j) {
-      int tensor_index = node_inputs->data[j];
-      if (tensor_index != kOptionalTensor) {
-        refcounts[tensor_index]--;
-        if (refcounts[tensor_index] == 0) {
-          TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+    // Then, once all the outputs of the stage are allocated, update the
+    // ref-counts of the inputs of its nodes, and if necessary queue them for
+    // deallocation.
+    if (!IsLastNodeOfStage(i)) {
+      continue;
+    }
+    for (int k = stage_start; k <= i; ++k) {
+      TfLiteIntArray* node_inputs = graph_info_->node(k).inputs;
+      for (int j = 0; j < node_inputs->size; ++j) {
+        int tensor_index = node_inputs->data[j];
+        if (tensor_index != kOptionalTensor) {
+          refcounts[tensor_index]--;
+          if (refcounts[tensor_index] == 0) {
+            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+          }
         }
       }
     }
@@ -182,17 +227,151 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   allocs_.resize(graph_info_->num_tensors());
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  // A precomputed plan can only replace the planning of the whole graph, as
+  // the arenas don't know about its allocations.
+  const bool whole_graph =
+      first_node == 0 && last_node + 1 >= graph_info_->num_nodes();
+  const bool use_precomputed_plan = whole_graph && UsePrecomputedPlan();
+  if (!use_precomputed_plan) {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
+  // TODO(ahentz): we could do this only for the tensors that were modified
+  // in CalculateAllocations(), instead of redoing it for tensors that
+  // already had proper pointers. However we must be very careful, because
+  // SimpleMemoryArena::Commit() could move the base pointer.
+  TF_LITE_ENSURE_STATUS(ResolveAllocations());
+
+  // Keep the new layout, to skip computing it again if the sizes of the
+  // tensors are the same the next time.
+  if (whole_graph && !use_precomputed_plan) {
+    TF_LITE_ENSURE_STATUS(GetPlan(&precomputed_plan_));
+  }
+  return kTfLiteOk;
+}
+
+size_t ArenaPlanner::ArenaSize(const TfLiteTensor& tensor) const {
+  if (!round_up_arena_sizes_ || tensor.allocation_type != kTfLiteArenaRw ||
+      tensor.bytes == 0) {
+    return tensor.bytes;
+  }
+  size_t size = 1;
+  while (size < tensor.bytes) size <<= 1;
+  return size;
+}
+
+uint64_t ArenaPlanner::GraphFingerprint() const {
+  // 64-bit FNV-1a.
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](int64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      hash = (hash ^ ((value >> (8 * i)) & 0xff)) * 1099511628211ull;
+    }
+  };
+  auto mix_array = [&mix](const int* data, int size) {
+    mix(size);
+    for (int i = 0; i < size; ++i) mix(data[i]);
+  };
+  mix(graph_info_->num_tensors());
+  mix_array(graph_info_->inputs().data(), graph_info_->inputs().size());
+  mix_array(graph_info_->outputs().data(), graph_info_->outputs().size());
+  mix_array(graph_info_->variables().data(), graph_info_->variables().size());
+  mix(graph_info_->num_nodes());
+  for (size_t i = 0; i < graph_info_->num_nodes(); ++i) {
+    const TfLiteNode& node = graph_info_->node(i);
+    mix_array(node.inputs->data, node.inputs->size);
+    mix_array(node.outputs->data, node.outputs->size);
+    mix_array(node.temporaries->data, node.temporaries->size);
+  }
+  mix_array(node_stages_.data(), node_stages_.size());
+  return hash;
+}
+
+bool ArenaPlanner::UsePrecomputedPlan() {
+  const ArenaPlan& plan = precomputed_plan_;
+  const size_t num_tensors = graph_info_->num_tensors();
+  if (plan.allocs.size() != num_tensors || plan.types.size() != num_tensors) {
+    return false;
+  }
+  for (size_t i = 0; i < num_tensors; ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if ((tensor.allocation_type == kTfLiteArenaRw ||
+         tensor.allocation_type == kTfLiteArenaRwPersistent) &&
+        (plan.types[i] != tensor.allocation_type ||
+         plan.allocs[i].size != ArenaSize(tensor))) {
+      return false;
+    }
+  }
+  // The fingerprint is only checked once the sizes match, since it is the
+  // more expensive check.
+  if (plan.graph_fingerprint != GraphFingerprint()) {
+    return false;
+  }
+  allocs_ = plan.allocs;
+  arena_.ReserveHighWaterMark(plan.arena_size);
+  persistent_arena_.ReserveHighWaterMark(plan.persistent_arena_size);
+  return true;
+}
+
+TfLiteStatus ArenaPlanner::GetPlan(ArenaPlan* plan) const {
+  TF_LITE_ENSURE(context_, resolved_);
+  plan->graph_fingerprint = GraphFingerprint();
+  plan->types.resize(graph_info_->num_tensors());
+  for (size_t i = 0; i < plan->types.size(); ++i) {
+    plan->types[i] = graph_info_->tensor(i)->allocation_type;
+  }
+  plan->allocs = allocs_;
+  plan->arena_size = arena_.high_water_mark();
+  plan->persistent_arena_size = persistent_arena_.high_water_mark();
+  return kTfLiteOk;
+}
+
+std::string ArenaPlan::Serialize() const {
+  std::vector<uint64_t> words = {kArenaPlanMagic, graph_fingerprint,
+                                 arena_size, persistent_arena_size,
+                                 allocs.size()};
+  for (size_t i = 0; i < allocs.size(); ++i) {
+    words.push_back(types[i]);
+    words.push_back(allocs[i].offset);
+    words.push_back(allocs[i].size);
+  }
+  return std::string(reinterpret_cast<const char*>(words.data()),
+                     words.size() * sizeof(uint64_t));
+}
+
+bool ArenaPlan::Parse(const std::string& data) {
+  const size_t kHeaderWords = 5;
+  if (data.size() % sizeof(uint64_t) != 0 ||
+      data.size() < kHeaderWords * sizeof(uint64_t)) {
+    return false;
+  }
+  std::vector<uint64_t> words(data.size() / sizeof(uint64_t));
+  memcpy(words.data(), data.data(), data.size());
+  const uint64_t num_tensors = words[4];
+  if (words[0] != kArenaPlanMagic ||
+      words.size() != kHeaderWords + 3 * num_tensors) {
+    return false;
+  }
+  graph_fingerprint = words[1];
+  arena_size = words[2];
+  persistent_arena_size = words[3];
+  types.resize(num_tensors);
+  allocs.resize(num_tensors);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    const uint64_t* tensor_words = &words[kHeaderWords + 3 * i];
+    types[i] = static_cast<TfLiteAllocationType>(tensor_words[0]);
+    allocs[i].offset = tensor_words[1];
+    allocs[i].size = tensor_words[2];
+  }
+  return true;
+}
+
+TfLiteStatus ArenaPlanner::ResolveAllocations() {
   for (int i = 0; i < graph_info_->num_tensors(); ++i) {
-    // TODO(ahentz): we could do this only for the tensors that were modified
-    // in CalculateAllocations(), instead of redoing it for tensors that
-    // already had proper pointers. However we must be very careful, because
-    // SimpleMemoryArena::Commit() could move the base pointer.
     TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
   }
-
+  resolved_ = true;
   return kTfLiteOk;
 }
 
@@ -211,12 +390,13 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   for (const auto& alloc_info : alloc_queue_) {
     if (alloc_info.node < first_node) continue;
     if (alloc_info.node > last_node) break;
-    if (alloc_info.node == active_node) {
-      // This is the first allocation/deallocation for a given node.  It is
-      // time to deallocate the previous temporaries and allocate new ones.
-      if (active_node != first_node) {
-        TF_LITE_ENSURE_STATUS(
-            CalculateDeallocationOfInternalTensors(active_node - 1));
+    while (active_node <= alloc_info.node) {
+      // This is the first allocation/deallocation for a given node. It is time
+      // to deallocate the temporaries of the previous stage, if it is over,
+      // and allocate new ones.
+      if (active_node != first_node && IsFirstNodeOfStage(active_node)) {
+        TF_LITE_ENSURE_STATUS(CalculateDeallocationOfStageTemporaries(
+            first_node, active_node - 1));
       }
       TF_LITE_ENSURE_STATUS(CalculateAllocationOfInternalTensors(active_node));
       ++active_node;
@@ -229,9 +409,11 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
-  // Don't forget to deallocate temporaries of last node.
-  TF_LITE_ENSURE_STATUS(
-      CalculateDeallocationOfInternalTensors(active_node - 1));
+  // Don't forget to deallocate temporaries of last stage.
+  if (active_node != first_node) {
+    TF_LITE_ENSURE_STATUS(
+        CalculateDeallocationOfStageTemporaries(first_node, active_node - 1));
+  }
 
   return kTfLiteOk;
 }
@@ -257,7 +439,7 @@ TfLiteStatus ArenaPlanner::CalculateTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
     TF_LITE_ENSURE_STATUS(arena_.Allocate(context_, kDefaultTensorAlignment,
-                                          tensor.bytes,
+                                          ArenaSize(tensor),
                                           &allocs_[tensor_index]));
   }
   if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
@@ -302,4 +484,13 @@ TfLiteStatus ArenaPlanner::CalculateDeallocationOfInternalTensors(
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::CalculateDeallocationOfStageTemporaries(
+    int first_node, int last_node) {
+  for (int i = last_node; i >= first_node; --i) {
+    TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(i));
+    if (IsFirstNodeOfStage(i)) break;
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace tflite
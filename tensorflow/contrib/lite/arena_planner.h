@@ -15,7 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_ARENA_PLANNER_H_
 #define TENSORFLOW_CONTRIB_LITE_ARENA_PLANNER_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/contrib/lite/context.h"
@@ -25,8 +27,32 @@ limitations under the License.
 
 namespace tflite {
 
+// The alignment of the tensors allocated in the arenas, which buffers provided
+// by the caller must also respect.
+constexpr const int kDefaultTensorAlignment = 4;
+
 struct AllocationInfo;
 
+// The layout of the tensors in the arenas, as computed by an ArenaPlanner for
+// a graph and the sizes of its tensors. It can be saved, e.g. next to the
+// model, and given to the planner of the same graph on the next start, which
+// then skips computing the layout.
+struct ArenaPlan {
+  // A fingerprint of the graph structure the plan was computed for.
+  uint64_t graph_fingerprint = 0;
+  // The allocation type and the place in its arena of each tensor.
+  std::vector<TfLiteAllocationType> types;
+  std::vector<ArenaAlloc> allocs;
+  // The sizes required by the arena and the persistent arena.
+  size_t arena_size = 0;
+  size_t persistent_arena_size = 0;
+
+  // Converts the plan to and from a string of bytes. Parse() returns false
+  // if 'data' isn't a plan serialized by this version of the planner.
+  std::string Serialize() const;
+  bool Parse(const std::string& data);
+};
+
 // A memory planner that makes all the allocations using arenas.
 //
 // Before a model is executed by the interpreter, this class determines when
@@ -43,12 +69,23 @@ struct AllocationInfo;
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
-  // ArenaPlanner is destroyed.
-  ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info);
+  // ArenaPlanner is destroyed. If 'shared_arena' is not null, it backs the
+  // arena of the temporary and output tensors instead of a buffer of the
+  // planner's own; see ArenaBuffer.
+  ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
+               std::shared_ptr<ArenaBuffer> shared_arena = nullptr);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
 
+  // Lets the nodes of a same stage run concurrently. 'node_stages' holds the
+  // stage of each node, in execution order, and must be non-decreasing. All
+  // the outputs and temporaries of the nodes of a stage are allocated when
+  // the stage starts, and their inputs and temporaries are only deallocated
+  // when it ends, so no tensor of a stage shares memory with another tensor
+  // used by the stage. Must be called before PlanAllocations().
+  void SetNodeStages(std::vector<int> node_stages);
+
   TfLiteStatus ResetAllocations() override;
   TfLiteStatus PlanAllocations() override;
   TfLiteStatus ExecuteAllocations(int first_node, int last_node) override;
@@ -56,6 +93,25 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   int64_t BasePointer(TfLiteAllocationType type);
 
+  // Returns the layout of the tensors computed by the last
+  // ExecuteAllocations().
+  TfLiteStatus GetPlan(ArenaPlan* plan) const;
+
+  // Uses 'plan' instead of computing the layout of the tensors, when
+  // ExecuteAllocations() allocates the whole graph at once and the graph and
+  // the sizes of its arena tensors are still those 'plan' was computed for.
+  // Otherwise the layout is computed as usual. The planner then keeps the
+  // layout it computes, so that it can reuse it the next time the whole graph
+  // is allocated if no arena tensor changed size.
+  void SetPlan(ArenaPlan plan) { precomputed_plan_ = std::move(plan); }
+
+  // Rounds the memory of each kTfLiteArenaRw tensor up to a power of two
+  // bytes, so that tensors whose sizes change a little, e.g. with the length
+  // of the inputs, most often keep their size in the arena, and the layout
+  // of the previous allocation can be reused. Must be called before
+  // ExecuteAllocations().
+  void SetRoundUpArenaSizes(bool round_up) { round_up_arena_sizes_ = round_up; }
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -65,6 +121,9 @@ class ArenaPlanner : public MemoryPlanner {
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Assign absolute memory locations to all tensors.
+  TfLiteStatus ResolveAllocations();
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -83,6 +142,25 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
 
+  // Register a deallocation for the temporary tensors of the nodes of the
+  // stage ending with 'last_node', skipping the nodes before 'first_node'.
+  TfLiteStatus CalculateDeallocationOfStageTemporaries(int first_node,
+                                                       int last_node);
+
+  // Returns the number of bytes to allocate for 'tensor' in its arena.
+  size_t ArenaSize(const TfLiteTensor& tensor) const;
+
+  // Returns a fingerprint of the nodes, their tensors and their stages.
+  uint64_t GraphFingerprint() const;
+
+  // Lays the tensors out as in 'precomputed_plan_', if it still applies.
+  // Returns false otherwise.
+  bool UsePrecomputedPlan();
+
+  // Returns true if 'node_index' is the first or the last node of its stage.
+  bool IsFirstNodeOfStage(int node_index) const;
+  bool IsLastNodeOfStage(int node_index) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -100,6 +178,22 @@ class ArenaPlanner : public MemoryPlanner {
   // Raw memory buffer that is allocated for persistent tensors that are
   // declared as kTfLiteArenaRwPersistent.
   SimpleMemoryArena persistent_arena_;
+
+  // The arena buffer shared with other planners, if any.
+  std::shared_ptr<ArenaBuffer> shared_arena_;
+
+  // The stage of each node, or empty if every node is a stage of its own.
+  std::vector<int> node_stages_;
+
+  // Whether the tensors have been resolved since the last ResetAllocations().
+  bool resolved_;
+
+  // The layout to use instead of computing it, if any: the one given to
+  // SetPlan(), or the last one computed for the whole graph.
+  ArenaPlan precomputed_plan_;
+
+  // Whether the arena sizes of the tensors are rounded up to powers of two.
+  bool round_up_arena_sizes_ = false;
 };
 
 }  // namespace tflite
@@ -151,11 +151,12 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph) {
+  void SetGraph(TestGraph* graph, std::vector<int> node_stages = {}) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph))));
+    planner_->SetNodeStages(std::move(node_stages));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -183,6 +184,14 @@ class ArenaPlannerTest : public ::testing::Test {
     return offset;
   };
 
+  // Returns true if the memory of two tensors overlaps.
+  bool Overlap(int tensor_a, int tensor_b) {
+    const TfLiteTensor& a = (*graph_->tensors())[tensor_a];
+    const TfLiteTensor& b = (*graph_->tensors())[tensor_b];
+    return a.data.raw < b.data.raw + b.bytes &&
+           b.data.raw < a.data.raw + a.bytes;
+  }
+
   TfLiteContext context_;
   TestGraph* graph_;
   std::unique_ptr<ArenaPlanner> planner_;
@@ -367,6 +376,34 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithDynamicTensor) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, GraphWithConcurrentStages) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{0}, {2}, {}},     // Second op
+                      {{1}, {3}, {6}},    // Third op
+                      {{2}, {4}, {7}},    // Fourth op
+                      {{3, 4}, {5}, {}},  // Fifth op
+                  },
+                  {5});
+  // The first two ops run concurrently, and so do the next two.
+  SetGraph(&graph, {0, 0, 1, 1, 2});
+  Execute(0, 10);
+
+  // Were the ops run one at a time, #4 would reuse the memory of #1.
+  const std::vector<int> second_stage_tensors = {1, 2, 3, 4, 6, 7};
+  for (int a : second_stage_tensors) {
+    for (int b : second_stage_tensors) {
+      if (a != b) {
+        EXPECT_FALSE(Overlap(a, b)) << a << " and " << b << " overlap";
+      }
+    }
+  }
+  // Once the second stage is over, the memory of its temporaries is reused.
+  EXPECT_EQ(GetOffset(5), GetOffset(7));
+}
+
 TEST_F(ArenaPlannerTest, LargerGraphAndStepwiseAllocation) {
   TestGraph graph({0, 1},
                   {
@@ -466,6 +503,106 @@ TEST_F(ArenaPlannerTest, LargerGraphAndStepwiseAllocation) {
   EXPECT_EQ(GetOffset(10), 0);
 }
 
+
+TEST_F(ArenaPlannerTest, PrecomputedPlan) {
+  auto make_graph = []() {
+    return new TestGraph({0, 1},
+                         {
+                             /* in, out, tmp */
+                             {{0, 1}, {2}, {}},   // First op
+                             {{2, 0}, {4}, {5}},  // Second op, with temporary
+                             {{4}, {3}, {}}       // Third op
+                         },
+                         {3});
+  };
+  std::unique_ptr<TestGraph> graph(make_graph());
+  SetGraph(graph.get());
+  Execute(0, 10);
+  ArenaPlan plan;
+  ASSERT_EQ(planner_->GetPlan(&plan), kTfLiteOk);
+  ArenaPlan parsed_plan;
+  ASSERT_TRUE(parsed_plan.Parse(plan.Serialize()));
+  EXPECT_FALSE(parsed_plan.Parse("not a plan"));
+  std::vector<int64_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // The same graph is laid out as in the plan. The offsets are moved, to tell
+  // the plan apart from a new layout.
+  for (ArenaAlloc& alloc : parsed_plan.allocs) {
+    alloc.offset += 64;
+  }
+  parsed_plan.arena_size += 64;
+  std::unique_ptr<TestGraph> same_graph(make_graph());
+  SetGraph(same_graph.get());
+  planner_->SetPlan(parsed_plan);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i] + 64);
+  }
+
+  // The plan doesn't apply once the tensors change size, nor to another
+  // graph.
+  std::unique_ptr<TestGraph> resized_graph(make_graph());
+  (*resized_graph->tensors())[2].bytes = 100;
+  SetGraph(resized_graph.get());
+  planner_->SetPlan(parsed_plan);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(0), 0);
+  TestGraph other_graph({0, 1}, {{{0, 1}, {2}, {5}}, {{2, 0}, {3}, {4}}},
+                        {3});
+  SetGraph(&other_graph);
+  planner_->SetPlan(parsed_plan);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(5));
+}
+
+
+TEST_F(ArenaPlannerTest, RoundUpArenaSizes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},  // First op
+                      {{2}, {3}, {}}      // Second op
+                  },
+                  {3});
+  SetGraph(&graph);
+  planner_->SetRoundUpArenaSizes(true);
+  Execute(0, 10);
+  // #0 has 3 bytes, rounded up to 4, and #1 has 6, rounded up to 8.
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 4);
+  EXPECT_EQ(GetOffset(2), 12);
+  // #3 has 12 bytes, rounded up to 16, which don't fit where #0 and #1 were.
+  EXPECT_EQ(GetOffset(3), 28);
+
+  // Once the layout is moved, it is kept as long as the rounded sizes don't
+  // change.
+  ArenaPlan plan;
+  ASSERT_EQ(planner_->GetPlan(&plan), kTfLiteOk);
+  for (ArenaAlloc& alloc : plan.allocs) {
+    alloc.offset += 64;
+  }
+  plan.arena_size += 64;
+  planner_->SetPlan(plan);
+  (*graph.tensors())[1].bytes = 7;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(1), 68);
+  (*graph.tensors())[1].bytes = 5;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(1), 68);
+
+  // A larger size is a new layout.
+  (*graph.tensors())[1].bytes = 9;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(1), 4);
+  EXPECT_EQ(GetOffset(2), 20);
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -99,6 +99,7 @@ typedef enum {
   kTfLiteBuiltinEqual = 71,
   kTfLiteBuiltinNotEqual = 72,
   kTfLiteBuiltinLog = 73,
+  kTfLiteBuiltinHardSwish = 74,
 } TfLiteBuiltinOperator;
 
 #ifdef __cplusplus
@@ -60,6 +60,20 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src) {
 
 void TfLiteIntArrayFree(TfLiteIntArray* a) { free(a); }
 
+TfLitePerChannelQuantization* TfLitePerChannelQuantizationCreate(
+    int num_channels) {
+  TfLitePerChannelQuantization* ret = (TfLitePerChannelQuantization*)malloc(
+      sizeof(TfLitePerChannelQuantization) + sizeof(float) * num_channels);
+  ret->quantized_dimension = 0;
+  ret->num_channels = num_channels;
+  ret->scale = (float*)(ret + 1);
+  return ret;
+}
+
+void TfLitePerChannelQuantizationFree(TfLitePerChannelQuantization* q) {
+  free(q);
+}
+
 void TfLiteTensorDataFree(TfLiteTensor* t) {
   if (t->allocation_type == kTfLiteDynamic && t->data.raw) {
     free(t->data.raw);
@@ -71,6 +85,10 @@ void TfLiteTensorFree(TfLiteTensor* t) {
   TfLiteTensorDataFree(t);
   if (t->dims) TfLiteIntArrayFree(t->dims);
   t->dims = NULL;
+  if (t->per_channel_quantization) {
+    TfLitePerChannelQuantizationFree(t->per_channel_quantization);
+  }
+  t->per_channel_quantization = NULL;
 }
 
 void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
@@ -149,6 +149,26 @@ typedef struct {
   int32_t zero_point;
 } TfLiteQuantizationParams;
 
+// Parameters for symmetric per-channel quantization, where every slice of a
+// tensor along `quantized_dimension` has its own scale and all slices share
+// the zero point of the tensor's TfLiteQuantizationParams:
+//    real_value = scale[channel] * (quantized_value - zero_point);
+typedef struct {
+  int quantized_dimension;
+  int num_channels;
+  // Points to `num_channels` scales, stored in the same allocation.
+  float* scale;
+} TfLitePerChannelQuantization;
+
+// Create per-channel quantization parameters for `num_channels` channels
+// (uninitialized scales). This returns a pointer, that you must free using
+// TfLitePerChannelQuantizationFree().
+TfLitePerChannelQuantization* TfLitePerChannelQuantizationCreate(
+    int num_channels);
+
+// Free memory of per-channel quantization parameters `q`.
+void TfLitePerChannelQuantizationFree(TfLitePerChannelQuantization* q);
+
 // A union of pointers that points to memory for a given tensor.
 typedef union {
   int* i32;
@@ -164,12 +184,15 @@ typedef union {
 // Memory allocation strategies. kTfLiteMmapRo is for read-only memory-mapped
 // data (or data externally allocated). kTfLiteArenaRw is arena allocated
 // data. kTfLiteDynamic is for tensors that are allocated during evaluation.
+// kTfLiteCustom is for writable data owned by the caller, e.g. an input or
+// output bound with Interpreter::SetCustomAllocationForTensor().
 typedef enum {
   kTfLiteMemNone = 0,
   kTfLiteMmapRo,
   kTfLiteArenaRw,
   kTfLiteArenaRwPersistent,
   kTfLiteDynamic,
+  kTfLiteCustom,
 } TfLiteAllocationType;
 
 // The delegates should use zero or positive integers to represent handles.
@@ -228,6 +251,11 @@ typedef struct {
 
   // True if the tensor is a variable.
   bool is_variable;
+
+  // Per-channel quantization parameters, or NULL if the tensor is quantized
+  // with the single scale in `params`. Owned by the tensor.
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLitePerChannelQuantization* per_channel_quantization;
 } TfLiteTensor;
 
 // Free data memory of tensor `t`;
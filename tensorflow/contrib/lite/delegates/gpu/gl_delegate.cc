@@ -0,0 +1,759 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/gpu/gl_delegate.h"
+
+#include <EGL/egl.h>
+#include <GLES3/gl31.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+#include "tensorflow/contrib/lite/builtin_ops.h"
+#include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/context_util.h"
+#include "tensorflow/contrib/lite/kernels/kernel_util.h"
+#include "tensorflow/contrib/lite/kernels/padding.h"
+
+namespace tflite {
+namespace {
+
+// The number of invocations in the work group of every shader.
+constexpr int kWorkgroupSize = 64;
+// The minimum of GL_MAX_COMPUTE_WORK_GROUP_COUNT guaranteed by the spec.
+constexpr int kMaxWorkgroupCount = 65535;
+
+// Computes the index of the output element of the invocation, and returns
+// early from the extra invocations of the last work group. The work groups
+// may be laid out in two dimensions for large outputs.
+constexpr char kShaderMainPrologue[] = R"(
+void main() {
+  int gid = int(gl_GlobalInvocationID.y * gl_NumWorkGroups.x *
+                gl_WorkGroupSize.x + gl_GlobalInvocationID.x);
+  if (gid >= $NUM_INVOCATIONS$) return;
+)";
+
+// Splits the index of an element of a NHWC output into its coordinates.
+constexpr char kNhwcCoordinates[] = R"(
+  int c = gid % $OUT_DEPTH$;
+  int t = gid / $OUT_DEPTH$;
+  int out_x = t % $OUT_WIDTH$;
+  t /= $OUT_WIDTH$;
+  int out_y = t % $OUT_HEIGHT$;
+  int b = t / $OUT_HEIGHT$;
+)";
+
+constexpr char kAddShader[] = R"(
+  out0.data[gid] = activate(in0.data[gid] + in1.data[gid]);
+)";
+
+constexpr char kConvShader[] = R"(
+  float sum = in2.data[c];
+  for (int fy = 0; fy < $FILTER_HEIGHT$; ++fy) {
+    int in_y = out_y * $STRIDE_HEIGHT$ - $PAD_HEIGHT$ + fy * $DILATION_HEIGHT$;
+    if (in_y < 0 || in_y >= $IN_HEIGHT$) continue;
+    for (int fx = 0; fx < $FILTER_WIDTH$; ++fx) {
+      int in_x = out_x * $STRIDE_WIDTH$ - $PAD_WIDTH$ + fx * $DILATION_WIDTH$;
+      if (in_x < 0 || in_x >= $IN_WIDTH$) continue;
+      int in_offset = ((b * $IN_HEIGHT$ + in_y) * $IN_WIDTH$ + in_x) * $IN_DEPTH$;
+      int filter_offset =
+          ((c * $FILTER_HEIGHT$ + fy) * $FILTER_WIDTH$ + fx) * $IN_DEPTH$;
+      for (int ic = 0; ic < $IN_DEPTH$; ++ic) {
+        sum += in0.data[in_offset + ic] * in1.data[filter_offset + ic];
+      }
+    }
+  }
+  out0.data[gid] = activate(sum);
+)";
+
+constexpr char kDepthwiseConvShader[] = R"(
+  int ic = c / $DEPTH_MULTIPLIER$;
+  float sum = in2.data[c];
+  for (int fy = 0; fy < $FILTER_HEIGHT$; ++fy) {
+    int in_y = out_y * $STRIDE_HEIGHT$ - $PAD_HEIGHT$ + fy;
+    if (in_y < 0 || in_y >= $IN_HEIGHT$) continue;
+    for (int fx = 0; fx < $FILTER_WIDTH$; ++fx) {
+      int in_x = out_x * $STRIDE_WIDTH$ - $PAD_WIDTH$ + fx;
+      if (in_x < 0 || in_x >= $IN_WIDTH$) continue;
+      int in_offset = ((b * $IN_HEIGHT$ + in_y) * $IN_WIDTH$ + in_x) * $IN_DEPTH$;
+      int filter_offset = (fy * $FILTER_WIDTH$ + fx) * $OUT_DEPTH$;
+      sum += in0.data[in_offset + ic] * in1.data[filter_offset + c];
+    }
+  }
+  out0.data[gid] = activate(sum);
+)";
+
+constexpr char kAveragePoolShader[] = R"(
+  float sum = 0.0;
+  int count = 0;
+  for (int fy = 0; fy < $FILTER_HEIGHT$; ++fy) {
+    int in_y = out_y * $STRIDE_HEIGHT$ - $PAD_HEIGHT$ + fy;
+    if (in_y < 0 || in_y >= $IN_HEIGHT$) continue;
+    for (int fx = 0; fx < $FILTER_WIDTH$; ++fx) {
+      int in_x = out_x * $STRIDE_WIDTH$ - $PAD_WIDTH$ + fx;
+      if (in_x < 0 || in_x >= $IN_WIDTH$) continue;
+      sum += in0.data[((b * $IN_HEIGHT$ + in_y) * $IN_WIDTH$ + in_x) *
+                      $OUT_DEPTH$ + c];
+      ++count;
+    }
+  }
+  out0.data[gid] = activate(sum / float(count));
+)";
+
+constexpr char kMaxPoolShader[] = R"(
+  float result = $LOWEST$;
+  for (int fy = 0; fy < $FILTER_HEIGHT$; ++fy) {
+    int in_y = out_y * $STRIDE_HEIGHT$ - $PAD_HEIGHT$ + fy;
+    if (in_y < 0 || in_y >= $IN_HEIGHT$) continue;
+    for (int fx = 0; fx < $FILTER_WIDTH$; ++fx) {
+      int in_x = out_x * $STRIDE_WIDTH$ - $PAD_WIDTH$ + fx;
+      if (in_x < 0 || in_x >= $IN_WIDTH$) continue;
+      result = max(result,
+                   in0.data[((b * $IN_HEIGHT$ + in_y) * $IN_WIDTH$ + in_x) *
+                            $OUT_DEPTH$ + c]);
+    }
+  }
+  out0.data[gid] = activate(result);
+)";
+
+// Copies the input into its slice of the output. There is one such shader
+// per input of the concatenation.
+constexpr char kConcatenationShader[] = R"(
+  int outer = gid / $INPUT_INNER_SIZE$;
+  int inner = gid % $INPUT_INNER_SIZE$;
+  out0.data[outer * $OUTPUT_INNER_SIZE$ + $OFFSET$ + inner] =
+      activate(in0.data[gid]);
+)";
+
+// Matches reference_ops::ResizeBilinear.
+constexpr char kResizeBilinearShader[] = R"(
+  float in_y = float(out_y) * $HEIGHT_SCALE$;
+  int y0 = int(floor(in_y));
+  int y1 = min(y0 + 1, $IN_HEIGHT$ - 1);
+  float dy = in_y - float(y0);
+  float in_x = float(out_x) * $WIDTH_SCALE$;
+  int x0 = int(floor(in_x));
+  int x1 = min(x0 + 1, $IN_WIDTH$ - 1);
+  float dx = in_x - float(x0);
+  int row0 = (b * $IN_HEIGHT$ + y0) * $IN_WIDTH$;
+  int row1 = (b * $IN_HEIGHT$ + y1) * $IN_WIDTH$;
+  out0.data[gid] =
+      in0.data[(row0 + x0) * $OUT_DEPTH$ + c] * (1.0 - dy) * (1.0 - dx) +
+      in0.data[(row1 + x0) * $OUT_DEPTH$ + c] * dy * (1.0 - dx) +
+      in0.data[(row0 + x1) * $OUT_DEPTH$ + c] * (1.0 - dy) * dx +
+      in0.data[(row1 + x1) * $OUT_DEPTH$ + c] * dy * dx;
+)";
+
+// One invocation computes the softmax of one row.
+constexpr char kSoftmaxShader[] = R"(
+  int offset = gid * $DEPTH$;
+  float max_value = in0.data[offset];
+  for (int i = 1; i < $DEPTH$; ++i) {
+    max_value = max(max_value, in0.data[offset + i]);
+  }
+  float sum = 0.0;
+  for (int i = 0; i < $DEPTH$; ++i) {
+    sum += exp((in0.data[offset + i] - max_value) * $BETA$);
+  }
+  for (int i = 0; i < $DEPTH$; ++i) {
+    out0.data[offset + i] =
+        exp((in0.data[offset + i] - max_value) * $BETA$) / sum;
+  }
+)";
+
+// Replaces every "$NAME$" in 'code' by the value of NAME in 'values'.
+std::string Substitute(std::string code,
+                       const std::map<std::string, std::string>& values) {
+  for (const auto& value : values) {
+    const std::string placeholder = "$" + value.first + "$";
+    for (size_t pos = code.find(placeholder); pos != std::string::npos;
+         pos = code.find(placeholder, pos + value.second.size())) {
+      code.replace(pos, placeholder.size(), value.second);
+    }
+  }
+  return code;
+}
+
+// Returns a GLSL expression of the float 'value', which doesn't lose any
+// precision.
+std::string FloatLiteral(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "uintBitsToFloat(%uu)",
+           static_cast<unsigned>(bits));
+  return buffer;
+}
+
+// Returns the body of the GLSL function applying 'activation', or an empty
+// string if the activation is not supported.
+std::string ActivationBody(TfLiteFusedActivation activation) {
+  switch (activation) {
+    case kTfLiteActNone:
+      return "return x;";
+    case kTfLiteActRelu:
+      return "return max(x, 0.0);";
+    case kTfLiteActRelu1:
+      return "return clamp(x, -1.0, 1.0);";
+    case kTfLiteActRelu6:
+      return "return clamp(x, 0.0, 6.0);";
+    case kTfLiteActTanh:
+      return "return tanh(x);";
+    case kTfLiteActSigmoid:
+      return "return 1.0 / (1.0 + exp(-x));";
+    default:
+      return "";
+  }
+}
+
+bool IsFloatTensor(TfLiteContext* context, int tensor_index) {
+  return context->tensors[tensor_index].type == kTfLiteFloat32;
+}
+
+bool IsConstantTensor(TfLiteContext* context, int tensor_index) {
+  return context->tensors[tensor_index].allocation_type == kTfLiteMmapRo;
+}
+
+int NumDimensions(TfLiteContext* context, int tensor_index) {
+  return context->tensors[tensor_index].dims->size;
+}
+
+// Returns true if the node can be run by the delegate.
+bool IsNodeSupported(TfLiteContext* context, TfLiteNode* node,
+                     TfLiteRegistration* registration) {
+  const TfLiteIntArray* inputs = node->inputs;
+  const TfLiteIntArray* outputs = node->outputs;
+  if (inputs->size < 1 || outputs->size != 1 ||
+      !IsFloatTensor(context, outputs->data[0])) {
+    return false;
+  }
+  // All the ops take a float tensor as first input. The other inputs are
+  // checked below.
+  const int input = inputs->data[0];
+  if (input == kOptionalTensor || !IsFloatTensor(context, input)) {
+    return false;
+  }
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinAdd: {
+      auto* params = reinterpret_cast<TfLiteAddParams*>(node->builtin_data);
+      return inputs->size == 2 && IsFloatTensor(context, inputs->data[1]) &&
+             HaveSameShapes(&context->tensors[input],
+                            &context->tensors[inputs->data[1]]) &&
+             !ActivationBody(params->activation).empty();
+    }
+    case kTfLiteBuiltinConv2d:
+    case kTfLiteBuiltinDepthwiseConv2d: {
+      // The weights and the bias are uploaded once, and must not change.
+      if (inputs->size != 3 || NumDimensions(context, input) != 4) {
+        return false;
+      }
+      for (int i = 1; i < 3; ++i) {
+        if (inputs->data[i] == kOptionalTensor ||
+            !IsFloatTensor(context, inputs->data[i]) ||
+            !IsConstantTensor(context, inputs->data[i])) {
+          return false;
+        }
+      }
+      const TfLiteFusedActivation activation =
+          registration->builtin_code == kTfLiteBuiltinConv2d
+              ? reinterpret_cast<TfLiteConvParams*>(node->builtin_data)
+                    ->activation
+              : reinterpret_cast<TfLiteDepthwiseConvParams*>(
+                    node->builtin_data)
+                    ->activation;
+      return !ActivationBody(activation).empty();
+    }
+    case kTfLiteBuiltinAveragePool2d:
+    case kTfLiteBuiltinMaxPool2d: {
+      auto* params = reinterpret_cast<TfLitePoolParams*>(node->builtin_data);
+      return inputs->size == 1 && NumDimensions(context, input) == 4 &&
+             !ActivationBody(params->activation).empty();
+    }
+    case kTfLiteBuiltinConcatenation: {
+      auto* params =
+          reinterpret_cast<TfLiteConcatenationParams*>(node->builtin_data);
+      for (int i : TfLiteIntArrayView(inputs)) {
+        if (i == kOptionalTensor || !IsFloatTensor(context, i)) return false;
+      }
+      return !ActivationBody(params->activation).empty();
+    }
+    case kTfLiteBuiltinResizeBilinear:
+      // The output size was already computed from the constant size input.
+      return inputs->size == 2 && NumDimensions(context, input) == 4 &&
+             IsConstantTensor(context, inputs->data[1]);
+    case kTfLiteBuiltinSoftmax:
+      return inputs->size == 1 && (NumDimensions(context, input) == 2 ||
+                                   NumDimensions(context, input) == 4);
+    default:
+      return false;
+  }
+}
+
+// Returns true if the current EGL context supports OpenGL ES 3.1, which
+// introduced compute shaders.
+bool HasComputeShaders() {
+  if (eglGetCurrentContext() == EGL_NO_CONTEXT) return false;
+  GLint major_version = 0;
+  GLint minor_version = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+  glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+  return major_version > 3 || (major_version == 3 && minor_version >= 1);
+}
+
+// The kernel running a subgraph with compute shaders. Every float tensor used
+// by the subgraph is stored in a shader storage buffer, and every node is
+// replaced by one or more compute programs, which read and write these
+// buffers. Only the inputs and the outputs of the subgraph are copied between
+// the CPU and the GPU.
+class GlDelegateKernel {
+ public:
+  GlDelegateKernel() = default;
+  GlDelegateKernel(const GlDelegateKernel&) = delete;
+  GlDelegateKernel& operator=(const GlDelegateKernel&) = delete;
+
+  ~GlDelegateKernel() {
+    for (const Program& program : programs_) {
+      glDeleteProgram(program.program);
+    }
+    for (const auto& buffer : buffers_) {
+      glDeleteBuffers(1, &buffer.second);
+    }
+  }
+
+  TfLiteStatus Init(TfLiteContext* context,
+                    const TfLiteDelegateParams* params) {
+    for (int node_index : TfLiteIntArrayView(params->nodes_to_replace)) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, node_index, &node, &registration));
+      TF_LITE_ENSURE_STATUS(AddNode(context, node, registration));
+    }
+    for (int tensor_index : TfLiteIntArrayView(params->input_tensors)) {
+      if (buffers_.count(tensor_index) != 0 &&
+          !IsConstantTensor(context, tensor_index)) {
+        inputs_.push_back(tensor_index);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(params->output_tensors)) {
+      outputs_.push_back(tensor_index);
+    }
+    if (glGetError() != GL_NO_ERROR) {
+      context->ReportError(context, "OpenGL error while building the graph.");
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus Invoke(TfLiteContext* context, TfLiteNode* node) {
+    for (int tensor_index : inputs_) {
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_[tensor_index]);
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tensor.bytes,
+                      tensor.data.raw);
+    }
+
+    for (const Program& program : programs_) {
+      glUseProgram(program.program);
+      for (size_t binding = 0; binding < program.tensors.size(); ++binding) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding,
+                         buffers_[program.tensors[binding]]);
+      }
+      const int num_workgroups =
+          (program.num_invocations + kWorkgroupSize - 1) / kWorkgroupSize;
+      const int num_workgroups_x = std::min(num_workgroups, kMaxWorkgroupCount);
+      const int num_workgroups_y =
+          (num_workgroups + num_workgroups_x - 1) / num_workgroups_x;
+      glDispatchCompute(num_workgroups_x, num_workgroups_y, 1);
+      // The next programs may read the output of this one.
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    for (int tensor_index : outputs_) {
+      TfLiteTensor& tensor = context->tensors[tensor_index];
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_[tensor_index]);
+      const void* data = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+                                          tensor.bytes, GL_MAP_READ_BIT);
+      if (data == nullptr) {
+        context->ReportError(context, "Failed to map the output %d.",
+                             tensor_index);
+        return kTfLiteError;
+      }
+      std::memcpy(tensor.data.raw, data, tensor.bytes);
+      glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR) {
+      context->ReportError(context, "OpenGL error while running the graph.");
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+ private:
+  struct Program {
+    GLuint program;
+    // The tensors bound to the buffer bindings of the program: the inputs,
+    // then the output.
+    std::vector<int> tensors;
+    int num_invocations;
+  };
+
+  TfLiteStatus AddNode(TfLiteContext* context, TfLiteNode* node,
+                       TfLiteRegistration* registration) {
+    const int input = node->inputs->data[0];
+    const int output = node->outputs->data[0];
+    const TfLiteTensor* input_tensor = &context->tensors[input];
+    const TfLiteTensor* output_tensor = &context->tensors[output];
+    std::map<std::string, std::string> values;
+    if (NumDimensions(context, output) == 4) {
+      values = {
+          {"IN_HEIGHT", std::to_string(SizeOfDimension(input_tensor, 1))},
+          {"IN_WIDTH", std::to_string(SizeOfDimension(input_tensor, 2))},
+          {"IN_DEPTH", std::to_string(SizeOfDimension(input_tensor, 3))},
+          {"OUT_HEIGHT", std::to_string(SizeOfDimension(output_tensor, 1))},
+          {"OUT_WIDTH", std::to_string(SizeOfDimension(output_tensor, 2))},
+          {"OUT_DEPTH", std::to_string(SizeOfDimension(output_tensor, 3))},
+      };
+    }
+
+    switch (registration->builtin_code) {
+      case kTfLiteBuiltinAdd: {
+        auto* params = reinterpret_cast<TfLiteAddParams*>(node->builtin_data);
+        return AddProgram(context, kAddShader, values,
+                          {input, node->inputs->data[1]}, output,
+                          NumElements(output_tensor), params->activation);
+      }
+      case kTfLiteBuiltinConv2d: {
+        auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
+        const TfLiteTensor* filter = &context->tensors[node->inputs->data[1]];
+        const int filter_height = SizeOfDimension(filter, 1);
+        const int filter_width = SizeOfDimension(filter, 2);
+        values["FILTER_HEIGHT"] = std::to_string(filter_height);
+        values["FILTER_WIDTH"] = std::to_string(filter_width);
+        values["STRIDE_HEIGHT"] = std::to_string(params->stride_height);
+        values["STRIDE_WIDTH"] = std::to_string(params->stride_width);
+        values["DILATION_HEIGHT"] =
+            std::to_string(params->dilation_height_factor);
+        values["DILATION_WIDTH"] = std::to_string(params->dilation_width_factor);
+        values["PAD_HEIGHT"] = std::to_string(ComputePadding(
+            params->stride_height, params->dilation_height_factor,
+            SizeOfDimension(input_tensor, 1), filter_height,
+            SizeOfDimension(output_tensor, 1)));
+        values["PAD_WIDTH"] = std::to_string(ComputePadding(
+            params->stride_width, params->dilation_width_factor,
+            SizeOfDimension(input_tensor, 2), filter_width,
+            SizeOfDimension(output_tensor, 2)));
+        return AddProgram(
+            context, std::string(kNhwcCoordinates) + kConvShader, values,
+            {input, node->inputs->data[1], node->inputs->data[2]}, output,
+            NumElements(output_tensor), params->activation);
+      }
+      case kTfLiteBuiltinDepthwiseConv2d: {
+        auto* params =
+            reinterpret_cast<TfLiteDepthwiseConvParams*>(node->builtin_data);
+        const TfLiteTensor* filter = &context->tensors[node->inputs->data[1]];
+        const int filter_height = SizeOfDimension(filter, 1);
+        const int filter_width = SizeOfDimension(filter, 2);
+        values["FILTER_HEIGHT"] = std::to_string(filter_height);
+        values["FILTER_WIDTH"] = std::to_string(filter_width);
+        values["STRIDE_HEIGHT"] = std::to_string(params->stride_height);
+        values["STRIDE_WIDTH"] = std::to_string(params->stride_width);
+        values["DEPTH_MULTIPLIER"] = std::to_string(
+            SizeOfDimension(output_tensor, 3) / SizeOfDimension(input_tensor, 3));
+        values["PAD_HEIGHT"] = std::to_string(ComputePadding(
+            params->stride_height, 1, SizeOfDimension(input_tensor, 1),
+            filter_height, SizeOfDimension(output_tensor, 1)));
+        values["PAD_WIDTH"] = std::to_string(ComputePadding(
+            params->stride_width, 1, SizeOfDimension(input_tensor, 2),
+            filter_width, SizeOfDimension(output_tensor, 2)));
+        return AddProgram(
+            context, std::string(kNhwcCoordinates) + kDepthwiseConvShader,
+            values, {input, node->inputs->data[1], node->inputs->data[2]},
+            output, NumElements(output_tensor), params->activation);
+      }
+      case kTfLiteBuiltinAveragePool2d:
+      case kTfLiteBuiltinMaxPool2d: {
+        auto* params = reinterpret_cast<TfLitePoolParams*>(node->builtin_data);
+        values["FILTER_HEIGHT"] = std::to_string(params->filter_height);
+        values["FILTER_WIDTH"] = std::to_string(params->filter_width);
+        values["STRIDE_HEIGHT"] = std::to_string(params->stride_height);
+        values["STRIDE_WIDTH"] = std::to_string(params->stride_width);
+        values["PAD_HEIGHT"] =
+            std::to_string(params->computed.padding.height);
+        values["PAD_WIDTH"] = std::to_string(params->computed.padding.width);
+        values["LOWEST"] = FloatLiteral(std::numeric_limits<float>::lowest());
+        return AddProgram(
+            context,
+            std::string(kNhwcCoordinates) +
+                (registration->builtin_code == kTfLiteBuiltinAveragePool2d
+                     ? kAveragePoolShader
+                     : kMaxPoolShader),
+            values, {input}, output, NumElements(output_tensor),
+            params->activation);
+      }
+      case kTfLiteBuiltinConcatenation: {
+        auto* params =
+            reinterpret_cast<TfLiteConcatenationParams*>(node->builtin_data);
+        const int num_dimensions = NumDimensions(context, output);
+        const int axis =
+            params->axis < 0 ? params->axis + num_dimensions : params->axis;
+        int output_inner_size = 1;
+        for (int d = axis; d < num_dimensions; ++d) {
+          output_inner_size *= SizeOfDimension(output_tensor, d);
+        }
+        int offset = 0;
+        for (int i : TfLiteIntArrayView(node->inputs)) {
+          const TfLiteTensor* tensor = &context->tensors[i];
+          int input_inner_size = 1;
+          for (int d = axis; d < num_dimensions; ++d) {
+            input_inner_size *= SizeOfDimension(tensor, d);
+          }
+          TF_LITE_ENSURE_STATUS(AddProgram(
+              context, kConcatenationShader,
+              {{"INPUT_INNER_SIZE", std::to_string(input_inner_size)},
+               {"OUTPUT_INNER_SIZE", std::to_string(output_inner_size)},
+               {"OFFSET", std::to_string(offset)}},
+              {i}, output, NumElements(tensor), params->activation));
+          offset += input_inner_size;
+        }
+        return kTfLiteOk;
+      }
+      case kTfLiteBuiltinResizeBilinear: {
+        auto* params =
+            reinterpret_cast<TfLiteResizeBilinearParams*>(node->builtin_data);
+        const int input_height = SizeOfDimension(input_tensor, 1);
+        const int input_width = SizeOfDimension(input_tensor, 2);
+        const int output_height = SizeOfDimension(output_tensor, 1);
+        const int output_width = SizeOfDimension(output_tensor, 2);
+        float height_scale = static_cast<float>(input_height) / output_height;
+        float width_scale = static_cast<float>(input_width) / output_width;
+        if (params->align_corners && output_height > 1) {
+          height_scale =
+              static_cast<float>(input_height - 1) / (output_height - 1);
+        }
+        if (params->align_corners && output_width > 1) {
+          width_scale = static_cast<float>(input_width - 1) / (output_width - 1);
+        }
+        values["HEIGHT_SCALE"] = FloatLiteral(height_scale);
+        values["WIDTH_SCALE"] = FloatLiteral(width_scale);
+        return AddProgram(
+            context, std::string(kNhwcCoordinates) + kResizeBilinearShader,
+            values, {input}, output, NumElements(output_tensor),
+            kTfLiteActNone);
+      }
+      case kTfLiteBuiltinSoftmax: {
+        auto* params =
+            reinterpret_cast<TfLiteSoftmaxParams*>(node->builtin_data);
+        const int depth = SizeOfDimension(
+            input_tensor, NumDimensions(context, input) - 1);
+        return AddProgram(context, kSoftmaxShader,
+                          {{"DEPTH", std::to_string(depth)},
+                           {"BETA", FloatLiteral(params->beta)}},
+                          {input}, output, NumElements(output_tensor) / depth,
+                          kTfLiteActNone);
+      }
+      default:
+        context->ReportError(context, "Op %d is not supported by the delegate.",
+                             registration->builtin_code);
+        return kTfLiteError;
+    }
+  }
+
+  // Compiles the program running 'code' once for every index 'gid' in
+  // [0, num_invocations). 'code' reads the inputs as in<i>.data and writes
+  // the output as out0.data, after applying 'activate' to it.
+  TfLiteStatus AddProgram(TfLiteContext* context, const std::string& code,
+                          std::map<std::string, std::string> values,
+                          const std::vector<int>& inputs, int output,
+                          int num_invocations,
+                          TfLiteFusedActivation activation) {
+    std::string source = "#version 310 es\n";
+    source += "layout(local_size_x = " + std::to_string(kWorkgroupSize) +
+              ") in;\n";
+    Program program;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      const std::string binding = std::to_string(program.tensors.size());
+      source += "layout(std430, binding = " + binding +
+                ") readonly buffer Input" + std::to_string(i) +
+                " { float data[]; } in" + std::to_string(i) + ";\n";
+      program.tensors.push_back(inputs[i]);
+    }
+    source += "layout(std430, binding = " +
+              std::to_string(program.tensors.size()) +
+              ") writeonly buffer Output { float data[]; } out0;\n";
+    program.tensors.push_back(output);
+    source += "float activate(float x) { " + ActivationBody(activation) +
+              " }\n";
+    values["NUM_INVOCATIONS"] = std::to_string(num_invocations);
+    source += Substitute(kShaderMainPrologue + code + "}\n", values);
+
+    for (int tensor_index : program.tensors) {
+      TF_LITE_ENSURE_STATUS(AddBuffer(context, tensor_index));
+    }
+    TF_LITE_ENSURE_STATUS(CompileProgram(context, source, &program.program));
+    program.num_invocations = num_invocations;
+    programs_.push_back(std::move(program));
+    return kTfLiteOk;
+  }
+
+  // Creates the buffer of the tensor if it doesn't exist yet. The data of
+  // constant tensors is uploaded right away.
+  TfLiteStatus AddBuffer(TfLiteContext* context, int tensor_index) {
+    if (buffers_.count(tensor_index) != 0) return kTfLiteOk;
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    const bool is_constant = IsConstantTensor(context, tensor_index);
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    // Empty buffers may not be bound.
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 std::max<size_t>(tensor.bytes, sizeof(float)),
+                 is_constant ? tensor.data.raw : nullptr,
+                 is_constant ? GL_STATIC_DRAW : GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    buffers_[tensor_index] = buffer;
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus CompileProgram(TfLiteContext* context,
+                                     const std::string& source,
+                                     GLuint* program) {
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    const char* source_data = source.c_str();
+    glShaderSource(shader, 1, &source_data, nullptr);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+      GLint length = 0;
+      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+      std::string log(std::max(length, 1), '\0');
+      glGetShaderInfoLog(shader, log.size(), nullptr, &log[0]);
+      glDeleteShader(shader);
+      context->ReportError(context, "Failed to compile shader: %s\n%s",
+                           log.c_str(), source.c_str());
+      return kTfLiteError;
+    }
+
+    *program = glCreateProgram();
+    glAttachShader(*program, shader);
+    glLinkProgram(*program);
+    // The shader is only deleted along with the program.
+    glDeleteShader(shader);
+    glGetProgramiv(*program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+      GLint length = 0;
+      glGetProgramiv(*program, GL_INFO_LOG_LENGTH, &length);
+      std::string log(std::max(length, 1), '\0');
+      glGetProgramInfoLog(*program, log.size(), nullptr, &log[0]);
+      glDeleteProgram(*program);
+      context->ReportError(context, "Failed to link program: %s", log.c_str());
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  std::vector<Program> programs_;
+  // The buffer of every float tensor used by the subgraph.
+  std::map<int, GLuint> buffers_;
+  // The inputs of the subgraph which are copied to the GPU on every Invoke.
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+};
+
+// The kernel and the status of its initialization, which can only be
+// reported in prepare.
+struct GlDelegateKernelState {
+  GlDelegateKernel kernel;
+  TfLiteStatus init_status;
+};
+
+}  // namespace
+
+TfLiteDelegate* GlDelegate() {
+  static TfLiteDelegate delegate = {
+      .data_ = nullptr,
+      .Prepare = [](TfLiteContext* context,
+                    TfLiteDelegate* delegate) -> TfLiteStatus {
+        // Leave the graph to the CPU kernels without a usable GL context.
+        if (!HasComputeShaders()) return kTfLiteOk;
+
+        std::vector<int> supported_nodes(1);
+        TfLiteIntArray* plan;
+        TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+        for (int node_index : TfLiteIntArrayView(plan)) {
+          TfLiteNode* node;
+          TfLiteRegistration* registration;
+          TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+              context, node_index, &node, &registration));
+          if (IsNodeSupported(context, node, registration)) {
+            supported_nodes.push_back(node_index);
+          }
+        }
+        // Put the size at the beginning of the array.
+        supported_nodes[0] = supported_nodes.size() - 1;
+
+        static const TfLiteRegistration gl_delegate_kernel = {
+            .init = [](TfLiteContext* context, const char* buffer,
+                       size_t length) -> void* {
+              const TfLiteDelegateParams* params =
+                  reinterpret_cast<const TfLiteDelegateParams*>(buffer);
+              auto* state = new GlDelegateKernelState;
+              state->init_status = state->kernel.Init(context, params);
+              return state;
+            },
+
+            .free = [](TfLiteContext* context, void* buffer) -> void {
+              delete reinterpret_cast<GlDelegateKernelState*>(buffer);
+            },
+
+            .prepare = [](TfLiteContext* context,
+                          TfLiteNode* node) -> TfLiteStatus {
+              // The shapes were fixed before delegation, so the programs
+              // built in init remain valid.
+              return reinterpret_cast<GlDelegateKernelState*>(node->user_data)
+                  ->init_status;
+            },
+
+            .invoke = [](TfLiteContext* context,
+                         TfLiteNode* node) -> TfLiteStatus {
+              auto* state =
+                  reinterpret_cast<GlDelegateKernelState*>(node->user_data);
+              return state->kernel.Invoke(context, node);
+            },
+
+            .builtin_code = kTfLiteBuiltinDelegate,
+        };
+
+        return context->ReplaceSubgraphsWithDelegateKernels(
+            context, gl_delegate_kernel,
+            reinterpret_cast<TfLiteIntArray*>(supported_nodes.data()),
+            delegate);
+      }};
+
+  return &delegate;
+}
+
+}  // namespace tflite
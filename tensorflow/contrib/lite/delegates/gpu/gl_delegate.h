@@ -0,0 +1,39 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_DELEGATE_H_
+#define TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_DELEGATE_H_
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+
+// Return a delegate that runs the supported float ops on the GPU, with
+// OpenGL ES 3.1 compute shaders. The supported ops are ADD, CONV_2D,
+// DEPTHWISE_CONV_2D, AVERAGE_POOL_2D, MAX_POOL_2D, CONCATENATION,
+// RESIZE_BILINEAR and SOFTMAX. The tensors produced and consumed inside a
+// delegated subgraph stay in GPU buffers.
+// e.g.
+//   interpreter->ModifyGraphWithDelegate(GlDelegate());
+// The delegate uses the EGL context that is current on the calling thread
+// when ModifyGraphWithDelegate() is called, and leaves the graph untouched if
+// there is none or if it doesn't support OpenGL ES 3.1. The same context must
+// be current whenever the interpreter is invoked or destroyed.
+// GlDelegate() returns a singleton, so you should not free this pointer or
+// worry about its lifetime.
+TfLiteDelegate* GlDelegate();
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_DELEGATE_H_
@@ -0,0 +1,200 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/gpu/gl_delegate.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/test_util.h"
+#include "tensorflow/contrib/lite/model.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+// Makes an OpenGL ES 3.1 context current on this thread, if the platform has
+// one. Otherwise the delegate leaves the graphs to the CPU kernels, and the
+// tests only check that it does so.
+void MakeGlContextCurrent() {
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) ||
+      !eglBindAPI(EGL_OPENGL_ES_API)) {
+    return;
+  }
+  const EGLint config_attributes[] = {EGL_RENDERABLE_TYPE,
+                                      EGL_OPENGL_ES3_BIT_KHR, EGL_NONE};
+  EGLConfig config;
+  EGLint num_configs = 0;
+  if (!eglChooseConfig(display, config_attributes, &config, 1,
+                       &num_configs) ||
+      num_configs == 0) {
+    return;
+  }
+  const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+                                       EGL_CONTEXT_MINOR_VERSION_KHR, 1,
+                                       EGL_NONE};
+  EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT,
+                                        context_attributes);
+  if (context != EGL_NO_CONTEXT) {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+  }
+}
+
+class FloatAddOpModel : public SingleOpModel {
+ public:
+  FloatAddOpModel(const TensorData& input1, const TensorData& input2,
+                  const TensorData& output,
+                  ActivationFunctionType activation_type) {
+    this->SetApplyDelegate([](Interpreter* interpreter) {
+      interpreter->ModifyGraphWithDelegate(GlDelegate());
+    });
+    input1_ = AddInput(input1);
+    input2_ = AddInput(input2);
+    output_ = AddOutput(output);
+    SetBuiltinOp(BuiltinOperator_ADD, BuiltinOptions_AddOptions,
+                 CreateAddOptions(builder_, activation_type).Union());
+    BuildInterpreter({GetShape(input1_), GetShape(input2_)});
+  }
+
+  int input1() { return input1_; }
+  int input2() { return input2_; }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ protected:
+  int input1_;
+  int input2_;
+  int output_;
+};
+
+TEST(GlDelegate, AddWithRelu) {
+  FloatAddOpModel m({TensorType_FLOAT32, {1, 2, 2, 1}},
+                    {TensorType_FLOAT32, {1, 2, 2, 1}},
+                    {TensorType_FLOAT32, {}}, ActivationFunctionType_RELU);
+  m.PopulateTensor<float>(m.input1(), {-2.0, 0.2, 0.7, 0.8});
+  m.PopulateTensor<float>(m.input2(), {0.1, 0.2, 0.3, 0.5});
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({0.0, 0.4, 1.0,
+                                                              1.3})));
+}
+
+// The weights and the bias of the convolution must be constant to be
+// delegated.
+class FloatConvolutionOpModel : public SingleOpModel {
+ public:
+  FloatConvolutionOpModel(const TensorData& input,
+                          std::initializer_list<float> filter,
+                          std::initializer_list<int> filter_shape,
+                          std::initializer_list<float> bias,
+                          const TensorData& output) {
+    this->SetApplyDelegate([](Interpreter* interpreter) {
+      interpreter->ModifyGraphWithDelegate(GlDelegate());
+    });
+    input_ = AddInput(input);
+    AddConstInput(TensorType_FLOAT32, filter, filter_shape);
+    AddConstInput(TensorType_FLOAT32, bias, {static_cast<int>(bias.size())});
+    output_ = AddOutput(output);
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, /*stride_w=*/2,
+                                     /*stride_h=*/2)
+                     .Union());
+    BuildInterpreter({GetShape(input_)});
+  }
+
+  int input() { return input_; }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ protected:
+  int input_;
+  int output_;
+};
+
+TEST(GlDelegate, Convolution) {
+  FloatConvolutionOpModel m({TensorType_FLOAT32, {2, 2, 4, 1}},
+                            {
+                                1, 2, 3, 4,    // first 2x2 filter
+                                -1, 1, -1, 1,  // second 2x2 filter
+                                -1, -1, 1, 1,  // third 2x2 filter
+                            },
+                            {3, 2, 2, 1}, {1, 2, 3},
+                            {TensorType_FLOAT32, {}});
+  m.PopulateTensor<float>(m.input(), {
+                                         // First batch
+                                         1, 1, 1, 1,  // row = 1
+                                         2, 2, 2, 2,  // row = 2
+                                         // Second batch
+                                         1, 2, 3, 4,  // row = 1
+                                         1, 2, 3, 4,  // row = 2
+                                     });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 18, 2, 5,  // first batch, left
+                                 18, 2, 5,  // first batch, right
+                                 17, 4, 3,  // second batch, left
+                                 37, 4, 3,  // second batch, right
+                             })));
+}
+
+class FloatSoftmaxOpModel : public SingleOpModel {
+ public:
+  FloatSoftmaxOpModel(const TensorData& input, float beta) {
+    this->SetApplyDelegate([](Interpreter* interpreter) {
+      interpreter->ModifyGraphWithDelegate(GlDelegate());
+    });
+    input_ = AddInput(input);
+    output_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_SOFTMAX, BuiltinOptions_SoftmaxOptions,
+                 CreateSoftmaxOptions(builder_, beta).Union());
+    BuildInterpreter({GetShape(input_)});
+  }
+
+  int input() { return input_; }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ protected:
+  int input_;
+  int output_;
+};
+
+TEST(GlDelegate, Softmax) {
+  FloatSoftmaxOpModel m({TensorType_FLOAT32, {2, 5}}, /*beta=*/0.1);
+  m.PopulateTensor<float>(m.input(), {
+                                         1.0, 2.0, 3.0, 4.0, 5.0,       //
+                                         -1.0, -2.0, -3.0, -4.0, -5.0,  //
+                                     });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     0.16212035, 0.17917069, 0.19801424,
+                                     0.21883958, 0.24185514, 0.24185514,
+                                     0.21883958, 0.19801424, 0.17917069,
+                                     0.16212035,
+                                 },
+                                 1e-6)));
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::tflite::MakeGlContextCurrent();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
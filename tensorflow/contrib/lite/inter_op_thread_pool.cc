@@ -0,0 +1,89 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/inter_op_thread_pool.h"
+
+namespace tflite {
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::ParallelFor(int num_items,
+                                    const std::function<void(int)>& fn) {
+  if (num_items <= 1 || workers_.empty()) {
+    for (int i = 0; i < num_items; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_items_ = num_items;
+    next_item_ = 0;
+    num_pending_items_ = num_items;
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunItems();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return num_pending_items_ == 0; });
+  fn_ = nullptr;
+}
+
+void InterOpThreadPool::RunItems() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (next_item_ < num_items_) {
+    const int item = next_item_++;
+    const std::function<void(int)>* fn = fn_;
+    lock.unlock();
+    (*fn)(item);
+    lock.lock();
+    if (--num_pending_items_ == 0) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+void InterOpThreadPool::WorkerLoop() {
+  int64_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_available_.wait(lock, [this, &seen_generation]() {
+      return shutdown_ || generation_ != seen_generation;
+    });
+    if (shutdown_) return;
+    seen_generation = generation_;
+    lock.unlock();
+    RunItems();
+    lock.lock();
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,63 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_CONTRIB_LITE_INTER_OP_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// The threads used by the interpreter to run independent ops concurrently.
+// The calling thread takes part in the work, so a pool of 'num_threads' has
+// 'num_threads - 1' threads of its own. The work items are whole ops, so the
+// pool favors simplicity over the cost of handing out an item.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  // Calls 'fn' for each index in [0, num_items), and returns once all the
+  // calls have returned. Must not be called concurrently, nor from 'fn'.
+  void ParallelFor(int num_items, const std::function<void(int)>& fn);
+
+ private:
+  // Runs the items of the current ParallelFor() until there are none left.
+  void RunItems();
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  const std::function<void(int)>* fn_ = nullptr;
+  int num_items_ = 0;
+  int next_item_ = 0;
+  int num_pending_items_ = 0;
+  // Incremented by each ParallelFor(), to wake up the workers.
+  int64_t generation_ = 0;
+  bool shutdown_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_INTER_OP_THREAD_POOL_H_
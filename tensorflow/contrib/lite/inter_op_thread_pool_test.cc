@@ -0,0 +1,65 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/inter_op_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TEST(InterOpThreadPoolTest, RunsEachItemOnce) {
+  InterOpThreadPool pool(4);
+  for (int num_items : {0, 1, 3, 4, 100}) {
+    std::vector<std::atomic<int>> counts(num_items);
+    for (auto& count : counts) count = 0;
+    pool.ParallelFor(num_items, [&counts](int i) { ++counts[i]; });
+    for (int i = 0; i < num_items; ++i) {
+      EXPECT_EQ(counts[i], 1) << "item " << i << " of " << num_items;
+    }
+  }
+}
+
+TEST(InterOpThreadPoolTest, RunsItemsConcurrently) {
+  InterOpThreadPool pool(2);
+  // Each item waits for the other one, so they can only both finish if they
+  // run on different threads.
+  std::atomic<int> num_started(0);
+  pool.ParallelFor(2, [&num_started](int) {
+    ++num_started;
+    while (num_started < 2) {
+    }
+  });
+  EXPECT_EQ(num_started, 2);
+}
+
+TEST(InterOpThreadPoolTest, SingleThread) {
+  InterOpThreadPool pool(1);
+  std::vector<int> order;
+  pool.ParallelFor(3, [&order](int i) { order.push_back(i); });
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2}));
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,8 +17,11 @@ limitations under the License.
 
 #include <cassert>
 #include <cstdarg>
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
+#include <utility>
 
 #include "tensorflow/contrib/lite/arena_planner.h"
 #include "tensorflow/contrib/lite/context.h"
@@ -231,6 +234,7 @@ TfLiteStatus Interpreter::ReplaceSubgraphsWithDelegateKernels(
   PartitionGraphIntoIndependentSubgraphs(&info, nodes_to_replace, &subgraphs);
 
   execution_plan_.clear();
+  execution_stages_.clear();
   for (auto& subgraph : subgraphs) {
     // Subgraphs calimed by the delegate should have a "macro" op created, the
     // other subgraphs (kTfNonPartition) just have their nodes added back to
@@ -478,12 +482,18 @@ TfLiteStatus Interpreter::ResizeInputTensor(int tensor_index,
                 "ResizeInputTensor is disallowed when graph is immutable.");
     return kTfLiteError;
   }
-  state_ = kStateUninvokable;
 
   // TODO(aselle): All bounds checks can be implemented as one-sided bounds
   // checks by casting to unsigned for efficiency. Profile before doing this.
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
+  // Nothing needs to be allocated again if the shape doesn't change.
+  TfLiteTensor* tensor = &context_.tensors[tensor_index];
+  if (tensor->data.raw != nullptr &&
+      EqualArrayAndTfLiteIntArray(tensor->dims, dims.size(), dims.data())) {
+    return kTfLiteOk;
+  }
+  state_ = kStateUninvokable;
   TfLiteIntArray* dims_lite = ConvertVectorToTfLiteIntArray(dims);
   return ResizeTensorImpl(&context_.tensors[tensor_index], dims_lite);
 }
@@ -525,10 +535,73 @@ TfLiteStatus Interpreter::PrepareOpsStartingAt(
   return kTfLiteOk;
 }
 
+void Interpreter::ScheduleExecutionPlanInStages() {
+  // The last stage writing and reading each tensor.
+  std::vector<int> last_write(tensors_.size(), -1);
+  std::vector<int> last_read(tensors_.size(), -1);
+  std::vector<int> stages(execution_plan_.size());
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    // An op runs after the ops writing its inputs, and after the ops reading
+    // or writing its outputs. Ops may update the variables they read.
+    int stage = 0;
+    for (int j = 0; j < node.inputs->size; ++j) {
+      int tensor_index = node.inputs->data[j];
+      if (tensor_index == kOptionalTensor) continue;
+      stage = std::max(stage, last_write[tensor_index] + 1);
+      if (tensors_[tensor_index].is_variable) {
+        stage = std::max(stage, last_read[tensor_index] + 1);
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      int tensor_index = node.outputs->data[j];
+      stage = std::max(stage, last_write[tensor_index] + 1);
+      stage = std::max(stage, last_read[tensor_index] + 1);
+    }
+    stages[i] = stage;
+
+    for (int j = 0; j < node.inputs->size; ++j) {
+      int tensor_index = node.inputs->data[j];
+      if (tensor_index == kOptionalTensor) continue;
+      last_read[tensor_index] = std::max(last_read[tensor_index], stage);
+      if (tensors_[tensor_index].is_variable) {
+        last_write[tensor_index] = stage;
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      last_write[node.outputs->data[j]] = stage;
+    }
+  }
+
+  // Every op is in a later stage than the ops it depends on, so the order by
+  // stage is also a valid execution order.
+  std::vector<int> order(execution_plan_.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&stages](int a, int b) { return stages[a] < stages[b]; });
+  std::vector<int> new_plan(execution_plan_.size());
+  execution_stages_.resize(execution_plan_.size());
+  for (int i = 0; i < order.size(); ++i) {
+    new_plan[i] = execution_plan_[order[i]];
+    execution_stages_[i] = stages[order[i]];
+  }
+  execution_plan_ = std::move(new_plan);
+}
+
 TfLiteStatus Interpreter::PrepareOpsAndTensors() {
   if (!memory_planner_) {
-    memory_planner_.reset(new ArenaPlanner(
-        &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this))));
+    std::unique_ptr<ArenaPlanner> planner(new ArenaPlanner(
+        &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
+        shared_arena_));
+    if (inter_op_thread_pool_) {
+      ScheduleExecutionPlanInStages();
+      planner->SetNodeStages(execution_stages_);
+    }
+    planner->SetRoundUpArenaSizes(arena_overallocation_);
+    if (arena_plan_) {
+      planner->SetPlan(*arena_plan_);
+    }
+    memory_planner_ = std::move(planner);
     memory_planner_->PlanAllocations();
   }
 
@@ -568,45 +641,42 @@ TfLiteStatus Interpreter::Invoke() {
     }
   }
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order, unless the ops of a stage
+  // run concurrently.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
   // TODO(b/71913981): we should force recalculation in the presence of dynamic
   // tensors, because they may have new value which in turn may affect shapes
   // and allocations.
-  for (int execution_plan_index = 0;
-       execution_plan_index < execution_plan_.size(); execution_plan_index++) {
-    if (execution_plan_index == next_execution_plan_index_to_prepare_) {
-      TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
-      TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
-                                    execution_plan_index);
-    }
-    int node_index = execution_plan_[execution_plan_index];
-    TfLiteNode& node = nodes_and_registration_[node_index].first;
-    const TfLiteRegistration& registration =
-        nodes_and_registration_[node_index].second;
-    SCOPED_OPERATOR_PROFILE(profiler_, node_index);
-
-    // TODO(ycling): This is an extra loop through inputs to check if the data
-    // need to be copied from Delegate buffer to raw memory, which is often not
-    // needed. We may want to cache this in prepare to know if this needs to be
-    // done for a node or not.
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        EnsureTensorDataIsReadable(tensor_index);
+  if (!execution_stages_.empty() && profiler_ == nullptr &&
+      !op_invoked_callback_ &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    status = InvokeInStages();
+  } else {
+    for (int execution_plan_index = 0;
+         execution_plan_index < execution_plan_.size();
+         execution_plan_index++) {
+      if (execution_plan_index == next_execution_plan_index_to_prepare_) {
+        TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+        TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
+                                      execution_plan_index);
       }
-    }
+      int node_index = execution_plan_[execution_plan_index];
+      TfLiteNode& node = nodes_and_registration_[node_index].first;
+      const TfLiteRegistration& registration =
+          nodes_and_registration_[node_index].second;
+      SCOPED_OPERATOR_PROFILE(profiler_, node_index);
 
-    EnsureTensorsVectorCapacity();
-    if (OpInvoke(registration, &node) == kTfLiteError) {
-      status = kTfLiteError;
+      EnsureNodeInputsAreReadable(node);
+
+      EnsureTensorsVectorCapacity();
+      if (OpInvoke(registration, &node) == kTfLiteError) {
+        status = kTfLiteError;
+      }
+      if (op_invoked_callback_) {
+        op_invoked_callback_(node_index);
+      }
     }
   }
 
@@ -619,6 +689,56 @@ TfLiteStatus Interpreter::Invoke() {
   return status;
 }
 
+TfLiteStatus Interpreter::InvokeInStages() {
+  // Reserve room for the tensors the ops may add, so that adding them never
+  // moves the tensors used by the other ops of a stage.
+  EnsureTensorsVectorCapacity();
+  std::atomic<bool> failed(false);
+  int stage_start = 0;
+  while (stage_start < execution_plan_.size()) {
+    int stage_end = stage_start + 1;
+    while (stage_end < execution_plan_.size() &&
+           execution_stages_[stage_end] == execution_stages_[stage_start]) {
+      ++stage_end;
+    }
+    for (int i = stage_start; i < stage_end; ++i) {
+      EnsureNodeInputsAreReadable(
+          nodes_and_registration_[execution_plan_[i]].first);
+    }
+    inter_op_thread_pool_->ParallelFor(
+        stage_end - stage_start, [this, stage_start, &failed](int i) {
+          int node_index = execution_plan_[stage_start + i];
+          TfLiteNode& node = nodes_and_registration_[node_index].first;
+          const TfLiteRegistration& registration =
+              nodes_and_registration_[node_index].second;
+          if (OpInvoke(registration, &node) == kTfLiteError) {
+            failed = true;
+          }
+        });
+    EnsureTensorsVectorCapacity();
+    stage_start = stage_end;
+  }
+  return failed ? kTfLiteError : kTfLiteOk;
+}
+
+void Interpreter::EnsureNodeInputsAreReadable(const TfLiteNode& node) {
+  // TODO(ycling): This is an extra loop through inputs to check if the data
+  // need to be copied from Delegate buffer to raw memory, which is often not
+  // needed. We may want to cache this in prepare to know if this needs to be
+  // done for a node or not.
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      EnsureTensorDataIsReadable(tensor_index);
+    }
+  }
+}
+
 TfLiteStatus Interpreter::ResizeTensor(TfLiteContext* context,
                                        TfLiteTensor* tensor,
                                        TfLiteIntArray* new_size) {
@@ -714,6 +834,10 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
     tensor.data.raw = const_cast<char*>(buffer);
     if (!tensor.dims) tensor.dims = ConvertArrayToTfLiteIntArray(rank, dims);
     tensor.params = quantization;
+    if (tensor.per_channel_quantization) {
+      TfLitePerChannelQuantizationFree(tensor.per_channel_quantization);
+      tensor.per_channel_quantization = nullptr;
+    }
     tensor.allocation_type = kTfLiteMmapRo;
     tensor.allocation = allocation;
   } else {
@@ -769,11 +893,113 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetTensorPerChannelQuantization(
+    int tensor_index, int quantized_dimension,
+    const std::vector<float>& scales) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "SetTensorPerChannelQuantization is disallowed when graph is "
+                "immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TF_LITE_ENSURE(&context_, tensor.dims != nullptr);
+  TF_LITE_ENSURE(&context_, quantized_dimension >= 0 &&
+                                quantized_dimension < tensor.dims->size);
+  TF_LITE_ENSURE_EQ(&context_, tensor.dims->data[quantized_dimension],
+                    static_cast<int>(scales.size()));
+
+  state_ = kStateUninvokable;
+  if (tensor.per_channel_quantization) {
+    TfLitePerChannelQuantizationFree(tensor.per_channel_quantization);
+  }
+  tensor.per_channel_quantization =
+      TfLitePerChannelQuantizationCreate(scales.size());
+  tensor.per_channel_quantization->quantized_dimension = quantized_dimension;
+  std::copy(scales.begin(), scales.end(),
+            tensor.per_channel_quantization->scale);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::GetArenaPlan(std::string* plan) {
+  TF_LITE_ENSURE(&context_, memory_planner_ != nullptr);
+  ArenaPlan arena_plan;
+  TF_LITE_ENSURE_STATUS(
+      static_cast<ArenaPlanner*>(memory_planner_.get())->GetPlan(&arena_plan));
+  *plan = arena_plan.Serialize();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetArenaPlan(const std::string& plan) {
+  if (memory_planner_) {
+    ReportError(&context_,
+                "SetArenaPlan() must be called before AllocateTensors().");
+    return kTfLiteError;
+  }
+  std::unique_ptr<ArenaPlan> arena_plan(new ArenaPlan);
+  if (!arena_plan->Parse(plan)) {
+    ReportError(&context_, "Invalid arena plan.");
+    return kTfLiteError;
+  }
+  arena_plan_ = std::move(arena_plan);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetCustomAllocationForTensor(int tensor_index,
+                                                       void* data,
+                                                       size_t bytes) {
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  if (std::find(inputs_.begin(), inputs_.end(), tensor_index) ==
+          inputs_.end() &&
+      std::find(outputs_.begin(), outputs_.end(), tensor_index) ==
+          outputs_.end()) {
+    ReportError(&context_,
+                "Tensor %d is neither an input nor an output of the graph.",
+                tensor_index);
+    return kTfLiteError;
+  }
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  if (tensor.allocation_type != kTfLiteArenaRw &&
+      tensor.allocation_type != kTfLiteCustom) {
+    ReportError(&context_,
+                "Tensor %d is constant, variable or dynamically allocated and "
+                "cannot use a custom allocation.",
+                tensor_index);
+    return kTfLiteError;
+  }
+  if (data == nullptr ||
+      reinterpret_cast<uintptr_t>(data) % kDefaultTensorAlignment != 0) {
+    ReportError(&context_,
+                "The custom allocation of tensor %d must be aligned to %d "
+                "bytes.",
+                tensor_index, kDefaultTensorAlignment);
+    return kTfLiteError;
+  }
+  if (bytes < tensor.bytes) {
+    ReportError(&context_,
+                "The custom allocation of tensor %d has %zu bytes but the "
+                "tensor needs %zu.",
+                tensor_index, bytes, tensor.bytes);
+    return kTfLiteError;
+  }
+  // The arena planner ignores kTfLiteCustom tensors, so the part of the arena
+  // that was planned for an arena tensor is only reclaimed by the next
+  // AllocateTensors().
+  tensor.allocation_type = kTfLiteCustom;
+  tensor.data.raw = static_cast<char*>(data);
+  custom_allocation_bytes_[tensor_index] = bytes;
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::SetExecutionPlan(const std::vector<int>& new_plan) {
   for (int node_index : new_plan) {
     TF_LITE_ENSURE(&context_, node_index >= 0 && node_index < nodes_size());
   }
   execution_plan_ = new_plan;
+  execution_stages_.clear();
   return kTfLiteOk;
 }
 
@@ -802,6 +1028,26 @@ TfLiteStatus Interpreter::ResizeTensorImpl(TfLiteTensor* tensor,
     if (tensor->allocation_type != kTfLiteDynamic) {
       tensor->data.raw = nullptr;
     }
+  } else if (tensor->allocation_type == kTfLiteCustom) {
+    // The caller's buffer is kept, as long as the tensor still fits in it.
+    size_t bytesRequired;
+    if (BytesRequired(tensor->type, new_size->data, new_size->size,
+                      &bytesRequired) != kTfLiteOk) {
+      TfLiteIntArrayFree(new_size);
+      return kTfLiteError;
+    }
+    const int tensor_index = tensor - context_.tensors;
+    if (bytesRequired > custom_allocation_bytes_[tensor_index]) {
+      TfLiteIntArrayFree(new_size);
+      ReportError(&context_,
+                  "Tensor %d needs %zu bytes, more than its custom "
+                  "allocation.",
+                  tensor_index, bytesRequired);
+      return kTfLiteError;
+    }
+    tensor->bytes = bytesRequired;
+    if (tensor->dims) TfLiteIntArrayFree(tensor->dims);
+    tensor->dims = new_size;
   } else {
     // kTfLiteMmapRo tensors are stored in the flatbuffer and are therefore
     // of fixed size.
@@ -824,6 +1070,43 @@ void Interpreter::UseNNAPI(bool enable) {
   }
 }
 
+TfLiteStatus Interpreter::SetSharedArena(
+    std::shared_ptr<ArenaBuffer> shared_arena) {
+  if (memory_planner_) {
+    ReportError(&context_,
+                "SetSharedArena() must be called before AllocateTensors().");
+    return kTfLiteError;
+  }
+  shared_arena_ = std::move(shared_arena);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetArenaOverallocation(bool enable) {
+  if (memory_planner_) {
+    ReportError(&context_,
+                "SetArenaOverallocation() must be called before "
+                "AllocateTensors().");
+    return kTfLiteError;
+  }
+  arena_overallocation_ = enable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetNumInterOpThreads(int num_threads) {
+  if (memory_planner_) {
+    ReportError(&context_,
+                "SetNumInterOpThreads() must be called before "
+                "AllocateTensors().");
+    return kTfLiteError;
+  }
+  if (num_threads > 1) {
+    inter_op_thread_pool_.reset(new InterOpThreadPool(num_threads));
+  } else {
+    inter_op_thread_pool_.reset();
+  }
+  return kTfLiteOk;
+}
+
 void Interpreter::SetNumThreads(int num_threads) {
   context_.recommended_num_threads = num_threads;
 
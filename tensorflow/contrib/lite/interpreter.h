@@ -19,13 +19,19 @@ limitations under the License.
 
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "tensorflow/contrib/lite/allocation.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/error_reporter.h"
+#include "tensorflow/contrib/lite/inter_op_thread_pool.h"
 #include "tensorflow/contrib/lite/memory_planner.h"
 #include "tensorflow/contrib/lite/profiling/profiler.h"
+#include "tensorflow/contrib/lite/simple_memory_arena.h"
 
 namespace tflite {
 
@@ -39,6 +45,10 @@ constexpr TfLiteType typeToTfLiteType<int>() {
   return kTfLiteInt32;
 }
 template <>
+constexpr TfLiteType typeToTfLiteType<int16_t>() {
+  return kTfLiteInt16;
+}
+template <>
 constexpr TfLiteType typeToTfLiteType<int64_t>() {
   return kTfLiteInt64;
 }
@@ -57,6 +67,7 @@ constexpr TfLiteType typeToTfLiteType<bool>() {
 
 // Forward declare since NNAPIDelegate uses Interpreter.
 class NNAPIDelegate;
+struct ArenaPlan;
 
 // An interpreter for a graph of nodes that input and output from tensors.
 // Each node of the graph processes a set of input tensors and produces a
@@ -175,6 +186,31 @@ class Interpreter {
       const int* dims, TfLiteQuantizationParams quantization,
       bool is_variable = false);
 
+  // Quantize tensor 'tensor_index' per channel along 'quantized_dimension',
+  // with one scale per channel in 'scales' and the zero point already set in
+  // its TfLiteQuantizationParams. Must be called after the tensor parameters
+  // are set, since setting them drops any per-channel quantization.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetTensorPerChannelQuantization(int tensor_index,
+                                               int quantized_dimension,
+                                               const std::vector<float>& scales);
+
+  // Use 'data', a buffer of 'bytes' bytes owned by the caller, as the memory
+  // of the input or output tensor 'tensor_index', so that inputs can be
+  // written and outputs read in place, without copies. 'data' may be any
+  // memory mapped in the address space of the process, e.g. a locked camera
+  // frame or AHardwareBuffer, but it must be aligned to
+  // kDefaultTensorAlignment bytes (see arena_planner.h) and hold the whole
+  // tensor. The tensor then has the kTfLiteCustom allocation type and takes
+  // no room in the arena. Binding another buffer to the same tensor is cheap
+  // and needs no call to AllocateTensors(), so a new buffer can be bound for
+  // every frame. ResizeInputTensor() and AllocateTensors() fail if the tensor
+  // grows larger than 'bytes'. The buffer must outlive the interpreter or the
+  // next binding of the tensor.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForTensor(int tensor_index, void* data,
+                                            size_t bytes);
+
   // Functions to access tensor data
 
   // Read only access to list of inputs.
@@ -317,6 +353,50 @@ class Interpreter {
   // Set the number of threads available to the interpreter.
   void SetNumThreads(int num_threads);
 
+  // Use 'shared_arena' for the memory of the input, output and temporary
+  // tensors, instead of a buffer owned by the interpreter. Several
+  // interpreters, e.g. for models that run one after the other, can share an
+  // arena as long as they are never invoked concurrently. The arena then only
+  // needs to be as large as the largest of them, but the inputs and outputs
+  // of one interpreter are overwritten when another is invoked, and the tensor
+  // pointers of all of them may change whenever one of them allocates tensors.
+  // Interpreters built from the same FlatBufferModel already share its
+  // read-only weights. Must be called before AllocateTensors().
+  TfLiteStatus SetSharedArena(std::shared_ptr<ArenaBuffer> shared_arena);
+
+  // Run the ops that don't depend on each other concurrently, on 'num_threads'
+  // threads including the one calling Invoke(). The execution plan is split
+  // into stages: an op runs in the stage following the last op it depends on,
+  // and a stage only starts once the previous one is over. The plan is then
+  // reordered by stage, and the tensors of a stage don't share memory, which
+  // may make the arena larger. Graphs with dynamic tensors, and interpreters
+  // with a profiler or an op invoked callback, still run one op at a time. The
+  // ops must be safe to run concurrently, as the builtin ones are. 1, the
+  // default, disables it. Must be called before AllocateTensors().
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
+  // Round the memory of each tensor in the arena up to a power of two bytes,
+  // so that a small change in the shape of the inputs, e.g. a shorter chunk
+  // of audio, most often leaves the sizes of the tensors in the arena as they
+  // are. AllocateTensors() then still prepares the ops again, but keeps the
+  // layout of the arena instead of computing a new one. This takes up to
+  // twice the memory. Must be called before AllocateTensors().
+  TfLiteStatus SetArenaOverallocation(bool enable);
+
+  // Returns in 'plan' the layout of the tensors in the arena, as computed by
+  // the last AllocateTensors(). Saved, e.g. next to the model, and given to
+  // SetArenaPlan() on the next start, it spares computing the layout again.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus GetArenaPlan(std::string* plan);
+
+  // Lays out the tensors as in 'plan', from GetArenaPlan() on an interpreter
+  // of the same model, instead of computing the layout. The plan is ignored
+  // if the graph or the sizes of its tensors are no longer the same, e.g.
+  // because of another delegate or other input shapes, or if the graph has
+  // dynamic tensors. Must be called before AllocateTensors().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetArenaPlan(const std::string& plan);
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -369,6 +449,15 @@ class Interpreter {
 
   profiling::Profiler* GetProfiler() { return profiler_; }
 
+  // Call 'callback' with the index of each node right after its op is
+  // invoked, while the tensors it wrote still hold their values, e.g. so that
+  // tools can record the ranges of the activations. Interpreters with such a
+  // callback run one op at a time. An empty function removes it.
+  // WARNING: This is an experimental API and subject to change.
+  void SetOpInvokedCallback(std::function<void(int node_index)> callback) {
+    op_invoked_callback_ = std::move(callback);
+  }
+
   // The default capacity of `tensors_` vector.
   static constexpr int kTensorsReservedCapacity = 128;
   // The capacity headroom of `tensors_` vector before calling ops'
@@ -435,6 +524,17 @@ class Interpreter {
   TfLiteStatus PrepareOpsStartingAt(int first_execution_plan_index,
                                     int* last_execution_plan_index_prepared);
 
+  // Reorder the execution plan so that ops which can run concurrently are
+  // next to each other, and fill 'execution_stages_'.
+  void ScheduleExecutionPlanInStages();
+
+  // Invoke the ops of each stage of 'execution_stages_' concurrently. All the
+  // ops must have been prepared.
+  TfLiteStatus InvokeInStages();
+
+  // Copy the inputs of 'node' that are stale from their delegate buffers.
+  void EnsureNodeInputsAreReadable(const TfLiteNode& node);
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -587,10 +687,32 @@ class Interpreter {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // The arena shared with other interpreters, if any.
+  std::shared_ptr<ArenaBuffer> shared_arena_;
+
+  // Whether the arena sizes of the tensors are rounded up to powers of two.
+  bool arena_overallocation_ = false;
+
+  // The layout of the arena to use instead of computing it, if any.
+  std::unique_ptr<ArenaPlan> arena_plan_;
+
+  // The threads running independent ops concurrently, if enabled.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
+  // The stage of each op of the execution plan, or empty if the ops run one
+  // at a time.
+  std::vector<int> execution_stages_;
+
   bool allow_buffer_handle_output_ = false;
 
+  // The size of the caller's buffer bound to each kTfLiteCustom tensor.
+  std::map<int, size_t> custom_allocation_bytes_;
+
   // Profiler for this interpreter instance.
   profiling::Profiler* profiler_;
+
+  // Called after each op is invoked, if set.
+  std::function<void(int node_index)> op_invoked_callback_;
 };
 
 }  // namespace tflite
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/contrib/lite/interpreter.h"
+#include <cstring>
 #include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/arena_planner.h"
 #include "tensorflow/contrib/lite/error_reporter.h"
 #include "tensorflow/contrib/lite/kernels/internal/compatibility.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
@@ -421,6 +423,287 @@ TEST(BasicInterpreter, OneOpInterpreter) {
   ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
 }
 
+// Builds an interpreter that copies a float input of 'size' elements to its
+// output.
+void BuildCopyInterpreter(Interpreter* interpreter, int size) {
+  ASSERT_EQ(interpreter->AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetOutputs({1}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(interpreter->SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                        {size}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(
+      interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+}
+
+TEST(BasicInterpreter, SharedArena) {
+  auto arena = std::make_shared<ArenaBuffer>();
+  Interpreter small;
+  Interpreter large;
+  BuildCopyInterpreter(&small, 4);
+  BuildCopyInterpreter(&large, 4096);
+  ASSERT_EQ(small.SetSharedArena(arena), kTfLiteOk);
+  ASSERT_EQ(large.SetSharedArena(arena), kTfLiteOk);
+  ASSERT_EQ(small.AllocateTensors(), kTfLiteOk);
+  // Allocating the larger interpreter grows the arena, and moves the tensors
+  // of the smaller one.
+  ASSERT_EQ(large.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(small.tensor(0)->data.raw, large.tensor(0)->data.raw);
+
+  for (int i = 0; i < 4; ++i) {
+    small.typed_tensor<float>(0)[i] = i;
+  }
+  ASSERT_EQ(small.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(small.typed_tensor<float>(1)[i], i);
+  }
+
+  for (int i = 0; i < 4096; ++i) {
+    large.typed_tensor<float>(0)[i] = 2 * i;
+  }
+  ASSERT_EQ(large.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4096; ++i) {
+    ASSERT_EQ(large.typed_tensor<float>(1)[i], 2 * i);
+  }
+
+  // The arena can no longer be changed.
+  EXPECT_EQ(small.SetSharedArena(std::make_shared<ArenaBuffer>()),
+            kTfLiteError);
+}
+
+TEST(BasicInterpreter, CustomAllocation) {
+  Interpreter interpreter;
+  BuildCopyInterpreter(&interpreter, 4);
+  alignas(kDefaultTensorAlignment) float input[5] = {1, 2, 3, 4, 5};
+  alignas(kDefaultTensorAlignment) float output[4] = {0, 0, 0, 0};
+  ASSERT_EQ(interpreter.SetCustomAllocationForTensor(0, input, sizeof(input)),
+            kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.SetCustomAllocationForTensor(1, output, sizeof(output)),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->allocation_type, kTfLiteCustom);
+  EXPECT_EQ(interpreter.typed_tensor<float>(0), input);
+  EXPECT_EQ(interpreter.typed_tensor<float>(1), output);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(output[i], i + 1);
+  }
+
+  // Another frame is bound without allocating the tensors again.
+  alignas(kDefaultTensorAlignment) float next_input[4] = {5, 6, 7, 8};
+  ASSERT_EQ(interpreter.SetCustomAllocationForTensor(0, next_input,
+                                                     sizeof(next_input)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(output[i], i + 5);
+  }
+
+  // The tensors can't outgrow their buffers.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {5}), kTfLiteError);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->bytes, 2 * sizeof(float));
+  EXPECT_EQ(interpreter.typed_tensor<float>(0), next_input);
+}
+
+TEST(BasicInterpreter, InvalidCustomAllocation) {
+  Interpreter interpreter;
+  BuildCopyInterpreter(&interpreter, 4);
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  alignas(kDefaultTensorAlignment) char buffer[5 * sizeof(float)];
+  // Not an input or an output.
+  EXPECT_EQ(interpreter.SetCustomAllocationForTensor(2, buffer, sizeof(buffer)),
+            kTfLiteError);
+  // Misaligned.
+  EXPECT_EQ(interpreter.SetCustomAllocationForTensor(0, buffer + 1,
+                                                     4 * sizeof(float)),
+            kTfLiteError);
+  // Too small.
+  EXPECT_EQ(interpreter.SetCustomAllocationForTensor(0, buffer,
+                                                     3 * sizeof(float)),
+            kTfLiteError);
+  EXPECT_EQ(interpreter.tensor(0)->allocation_type, kTfLiteArenaRw);
+}
+
+TEST(BasicInterpreter, ArenaPlan) {
+  Interpreter first;
+  BuildCopyInterpreter(&first, 4);
+  std::string plan;
+  EXPECT_EQ(first.GetArenaPlan(&plan), kTfLiteError);
+  ASSERT_EQ(first.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(first.GetArenaPlan(&plan), kTfLiteOk);
+
+  Interpreter second;
+  BuildCopyInterpreter(&second, 4);
+  EXPECT_EQ(second.SetArenaPlan("not a plan"), kTfLiteError);
+  ASSERT_EQ(second.SetArenaPlan(plan), kTfLiteOk);
+  ASSERT_EQ(second.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(second.tensor(1)->data.raw - second.tensor(0)->data.raw,
+            first.tensor(1)->data.raw - first.tensor(0)->data.raw);
+  for (int i = 0; i < 4; ++i) {
+    second.typed_tensor<float>(0)[i] = i;
+  }
+  ASSERT_EQ(second.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(second.typed_tensor<float>(1)[i], i);
+  }
+  EXPECT_EQ(second.SetArenaPlan(plan), kTfLiteError);
+}
+
+TEST(BasicInterpreter, ResizeToSameShape) {
+  Interpreter interpreter;
+  BuildCopyInterpreter(&interpreter, 4);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // The interpreter stays ready to be invoked.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {4}), kTfLiteOk);
+  EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  EXPECT_EQ(interpreter.Invoke(), kTfLiteError);
+}
+
+TEST(BasicInterpreter, ArenaOverallocation) {
+  Interpreter interpreter;
+  BuildCopyInterpreter(&interpreter, 5);
+  ASSERT_EQ(interpreter.SetArenaOverallocation(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // 5 floats take 32 bytes in the arena.
+  EXPECT_EQ(interpreter.tensor(1)->data.raw - interpreter.tensor(0)->data.raw,
+            32);
+  const char* input = interpreter.tensor(0)->data.raw;
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {7}), kTfLiteOk);
+  ASSERT_EQ(interpreter.ResizeInputTensor(1, {7}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->data.raw, input);
+  EXPECT_EQ(interpreter.tensor(1)->data.raw - interpreter.tensor(0)->data.raw,
+            32);
+  EXPECT_EQ(interpreter.SetArenaOverallocation(false), kTfLiteError);
+}
+
+TEST(BasicInterpreter, InterOpParallelism) {
+  // Two towers of two ops each, whose outputs are summed:
+  //   0 -> 1 -> 3
+  //   0 -> 2 -> 4
+  //   3, 4 -> 5
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(6), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({5}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {256}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg_add_one = {nullptr, nullptr, nullptr, nullptr};
+  reg_add_one.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < 256; ++i) {
+      output->data.f[i] = input->data.f[i] + 1;
+    }
+    return kTfLiteOk;
+  };
+  TfLiteRegistration reg_sum = {nullptr, nullptr, nullptr, nullptr};
+  reg_sum.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* a = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* b = &context->tensors[node->inputs->data[1]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < 256; ++i) {
+      output->data.f[i] = a->data.f[i] + b->data.f[i];
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {3}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2}, {4}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({3, 4}, {5}, nullptr, 0, nullptr,
+                                              &reg_sum),
+            kTfLiteOk);
+
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // The first ops of the towers run together, and so do the second ones.
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3, 4}));
+
+  for (int run = 0; run < 10; ++run) {
+    for (int i = 0; i < 256; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = i + run;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 256; ++i) {
+      ASSERT_EQ(interpreter.typed_tensor<float>(5)[i], 2 * (i + run + 2));
+    }
+  }
+
+  // The threads can no longer be changed.
+  EXPECT_EQ(interpreter.SetNumInterOpThreads(4), kTfLiteError);
+}
+
+TEST(BasicInterpreter, OpInvokedCallback) {
+  // Two chained ops, 0 -> 1 -> 2, whose intermediate output 1 is read by the
+  // callback right after the first op.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg_double = {nullptr, nullptr, nullptr, nullptr};
+  reg_double.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    output->data.f[0] = 2 * input->data.f[0];
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg_double),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &reg_double),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  std::vector<std::pair<int, float>> invoked;
+  interpreter.SetOpInvokedCallback([&interpreter, &invoked](int node_index) {
+    const TfLiteNode& node =
+        interpreter.node_and_registration(node_index)->first;
+    invoked.emplace_back(
+        node_index, interpreter.tensor(node.outputs->data[0])->data.f[0]);
+  });
+  interpreter.typed_tensor<float>(0)[0] = 3;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(invoked, (std::vector<std::pair<int, float>>{{0, 6}, {1, 12}}));
+
+  interpreter.SetOpInvokedCallback(nullptr);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(invoked.size(), 2);
+}
+
 // Forcefully divides tensor allocation in three steps: one before invocation
 // and two more at invocation time. This happens because we use string tensors
 // and their sizes can't be determined until invocation time.
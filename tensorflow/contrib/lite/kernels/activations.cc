@@ -39,6 +39,9 @@ struct OpData {
   int input_left_shift = 0;
   int32_t input_range_radius = 0;
   int diff_min = 0;
+  // The quantized output for each quantized input, for elementwise ops that
+  // are simpler to tabulate than to compute in fixed point.
+  uint8_t lookup_table[256];
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -150,6 +153,31 @@ TfLiteStatus SoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
                                TfLiteIntArrayCopy(input->dims));
 }
 
+TfLiteStatus HardSwishPrepare(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  const TfLiteTensor* input = GetInput(context, node, 0);
+  TfLiteTensor* output = GetOutput(context, node, 0);
+  TF_LITE_ENSURE_EQ(context, input->type, output->type);
+
+  if (input->type == kTfLiteUInt8) {
+    for (int i = 0; i < 256; ++i) {
+      const float x = input->params.scale * (i - input->params.zero_point);
+      const float y = x * std::min(std::max(x + 3.0f, 0.0f), 6.0f) / 6.0f;
+      const int32_t quantized = static_cast<int32_t>(
+          std::round(y / output->params.scale) + output->params.zero_point);
+      data->lookup_table[i] = static_cast<uint8_t>(
+          std::min(std::max(quantized, static_cast<int32_t>(0)),
+                   static_cast<int32_t>(255)));
+    }
+  }
+
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(input->dims));
+}
+
 TfLiteStatus PreluPrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -237,6 +265,33 @@ TfLiteStatus Relu6Eval(TfLiteContext* context, TfLiteNode* node) {
   }
 }
 
+TfLiteStatus HardSwishEval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* input = GetInput(context, node, 0);
+  TfLiteTensor* output = GetOutput(context, node, 0);
+  switch (input->type) {
+    case kTfLiteFloat32: {
+      optimized_ops::HardSwish(GetTensorData<float>(input),
+                               GetTensorDims(input),
+                               GetTensorData<float>(output),
+                               GetTensorDims(output));
+      return kTfLiteOk;
+    } break;
+    case kTfLiteUInt8: {
+      const uint8_t* in = GetTensorData<uint8_t>(input);
+      const uint8_t* in_end = in + input->bytes;
+      uint8_t* out = GetTensorData<uint8_t>(output);
+      for (; in < in_end; in++, out++) *out = data->lookup_table[*in];
+      return kTfLiteOk;
+    } break;
+    default:
+      context->ReportError(context,
+                           "Only float32 and uint8 supported currently, got %d.",
+                           input->type);
+      return kTfLiteError;
+  }
+}
+
 TfLiteStatus TanhEval(TfLiteContext* context, TfLiteNode* node) {
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
   const TfLiteTensor* input = GetInput(context, node, 0);
@@ -478,6 +533,13 @@ TfLiteRegistration* Register_RELU6() {
   return &r;
 }
 
+TfLiteRegistration* Register_HARD_SWISH() {
+  static TfLiteRegistration r = {activations::Init, activations::Free,
+                                 activations::HardSwishPrepare,
+                                 activations::HardSwishEval};
+  return &r;
+}
+
 TfLiteRegistration* Register_TANH() {
   static TfLiteRegistration r = {activations::Init, activations::Free,
                                  activations::TanhPrepare,
@@ -137,6 +137,42 @@ TEST(FloatActivationsOpTest, Relu6) {
                              }));
 }
 
+TEST(FloatActivationsOpTest, HardSwish) {
+  FloatActivationsOpModel m(BuiltinOperator_HARD_SWISH,
+                            /*input=*/{TensorType_FLOAT32, {1, 2, 4, 1}});
+  m.SetInput({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 0, 0, 1.6666667, 4,            //
+                                 3, -0.3333333, 10, 0.6666667,  //
+                             })));
+}
+
+TEST(QuantizedActivationsOpTest, HardSwish) {
+  const float kMin = -1;
+  const float kMax = 10;
+  QuantizedActivationsOpModel m(
+      BuiltinOperator_HARD_SWISH,
+      /*input=*/{TensorType_UINT8, {1, 2, 4, 1}, -10, 10},
+      /*output=*/{TensorType_UINT8, {}, kMin, kMax});
+  m.SetInput({
+      0, -6, 2, 4,   //
+      3, -2, 10, 1,  //
+  });
+  m.Invoke();
+  // Allow for the rounding of both the input and the output.
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      0, 0, 1.6666667, 4,             //
+                      3, -0.3333333, 10, 0.6666667,  //
+                  },
+                  2 * (kMax - kMin) / 255)));
+}
+
 TEST(FloatActivationsOpTest, Tanh) {
   FloatActivationsOpModel m(BuiltinOperator_TANH,
                             /*input=*/{TensorType_FLOAT32, {1, 2, 4, 1}});
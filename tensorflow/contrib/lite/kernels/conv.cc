@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
@@ -31,9 +32,11 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/sparse_weights.h"
 
 namespace tflite {
 namespace ops {
@@ -61,6 +64,9 @@ struct OpData {
   // memory buffers.
   int im2col_id = kTensorNotAllocated;
   int hwcn_weights_id = kTensorNotAllocated;
+  int input_quantized_id = kTensorNotAllocated;
+  int scaling_factors_id = kTensorNotAllocated;
+  int accum_scratch_id = kTensorNotAllocated;
 
   TfLitePaddingValues padding;
   // The scaling factor from input to output (aka the 'real multiplier') can
@@ -75,9 +81,23 @@ struct OpData {
   // of the allocated temporaries.
   int32_t im2col_index;
   int32_t hwcn_weights_index;
+  int32_t input_quantized_index;
+  int32_t scaling_factors_index;
+  int32_t accum_scratch_index;
   bool need_hwcn_weights;
   bool have_weights_been_transposed;
   bool need_im2col;
+  // Whether the op has float inputs and outputs, but symmetrically quantized
+  // weights (see tensor_utils::SymmetricQuantizeFloats).
+  bool is_hybrid;
+  // The float weights in block-sparse form, if they are mostly zeros.
+  SparseWeights sparse_weights;
+  // Whether the uint8 weights are quantized per output channel, in which case
+  // each channel has its own output multiplier and (right) shift, and the
+  // optimized kernel needs an int32 buffer for the accumulators.
+  bool is_per_channel;
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int> per_channel_output_shift;
 
   bool run_multithreaded_kernel;
 };
@@ -114,7 +134,9 @@ void TransposeFloatTensor(TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
-// Allocate temporary tensors (`im2col`, `hwcn_weights` if necessary).
+// Allocate temporary tensors (`im2col`, `hwcn_weights`, the quantized input
+// and its scaling factors for the hybrid op, and the accumulators for
+// per-channel quantized weights, if necessary).
 // Note: `context->AddTensors` might invalidate pointers to existing tensors.
 // Therefore the logic to add tensors are isolated into this function.
 static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
@@ -146,8 +168,20 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   // buffer to store the results.
   // This path is only used for float processing, so only create the buffer if
   // we're running with that data type.
+  data->is_hybrid =
+      input->type == kTfLiteFloat32 && filter->type == kTfLiteUInt8;
+  // Float weights that are mostly zeros are multiplied with the im2col matrix
+  // in block-sparse form instead, and never transposed.
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32) {
+    PrepareSparseWeights(filter, filter->dims->data[0],
+                         filter_height * filter_width * filter->dims->data[3],
+                         &data->sparse_weights);
+  }
   data->need_hwcn_weights =
-      (input->type == kTfLiteFloat32 && data->run_multithreaded_kernel);
+      (input->type == kTfLiteFloat32 && !data->is_hybrid &&
+       !data->sparse_weights.is_sparse && data->run_multithreaded_kernel);
+  data->is_per_channel = input->type == kTfLiteUInt8 &&
+                         filter->per_channel_quantization != nullptr;
 
   int temporaries_count = 0;
   if (data->need_im2col) {
@@ -164,6 +198,27 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
     }
     ++temporaries_count;
   }
+  // The hybrid op quantizes the rows of the im2col matrix (or of the input,
+  // if it doesn't need im2col) on the fly, each with its own scaling factor.
+  if (data->is_hybrid) {
+    data->input_quantized_index = temporaries_count;
+    if (data->input_quantized_id == kTensorNotAllocated) {
+      context->AddTensors(context, 1, &data->input_quantized_id);
+    }
+    ++temporaries_count;
+    data->scaling_factors_index = temporaries_count;
+    if (data->scaling_factors_id == kTensorNotAllocated) {
+      context->AddTensors(context, 1, &data->scaling_factors_id);
+    }
+    ++temporaries_count;
+  }
+  if (data->is_per_channel) {
+    data->accum_scratch_index = temporaries_count;
+    if (data->accum_scratch_id == kTensorNotAllocated) {
+      context->AddTensors(context, 1, &data->accum_scratch_id);
+    }
+    ++temporaries_count;
+  }
 
   TfLiteIntArrayFree(node->temporaries);
   node->temporaries = TfLiteIntArrayCreate(temporaries_count);
@@ -198,7 +253,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context,
                  data_type == kTfLiteFloat32 || data_type == kTfLiteUInt8);
   TF_LITE_ENSURE_EQ(context, output->type, data_type);
-  TF_LITE_ENSURE_EQ(context, filter->type, data_type);
+  TF_LITE_ENSURE(context, filter->type == data_type || data->is_hybrid);
 
   TfLiteTensor* bias = nullptr;
 
@@ -252,7 +307,24 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
-  if (data_type != kTfLiteFloat32) {
+  if (data->is_per_channel) {
+    std::vector<double> real_multipliers;
+    TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipliersPerChannel(
+        context, input, filter, bias, output, /*channel_dimension=*/0,
+        &real_multipliers));
+    data->per_channel_output_multiplier.resize(channels_out);
+    data->per_channel_output_shift.resize(channels_out);
+    for (int c = 0; c < channels_out; ++c) {
+      TF_LITE_ENSURE(context, real_multipliers[c] < 1.0);
+      QuantizeMultiplierSmallerThanOneExp(
+          real_multipliers[c], &data->per_channel_output_multiplier[c],
+          &data->per_channel_output_shift[c]);
+      data->per_channel_output_shift[c] *= -1;
+    }
+    CalculateActivationRangeUint8(params->activation, output,
+                                  &data->output_activation_min,
+                                  &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -329,9 +401,96 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     data->have_weights_been_transposed = false;
   }
 
+  if (data->is_hybrid) {
+    const int input_depth = input->dims->data[3];
+    const int num_rows = batches * outHeight * outWidth;
+
+    node->temporaries->data[data->input_quantized_index] =
+        data->input_quantized_id;
+    TfLiteTensor* input_quantized =
+        &context->tensors[node->temporaries->data[data->input_quantized_index]];
+    input_quantized->type = kTfLiteUInt8;
+    input_quantized->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* input_quantized_size = TfLiteIntArrayCreate(2);
+    input_quantized_size->data[0] = num_rows;
+    input_quantized_size->data[1] = filter_height * filter_width * input_depth;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_quantized,
+                                                     input_quantized_size));
+
+    node->temporaries->data[data->scaling_factors_index] =
+        data->scaling_factors_id;
+    TfLiteTensor* scaling_factors =
+        &context->tensors[node->temporaries->data[data->scaling_factors_index]];
+    scaling_factors->type = kTfLiteFloat32;
+    scaling_factors->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = num_rows;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
+  if (data->is_per_channel) {
+    node->temporaries->data[data->accum_scratch_index] =
+        data->accum_scratch_id;
+    TfLiteTensor* accum_scratch =
+        &context->tensors[node->temporaries->data[data->accum_scratch_index]];
+    accum_scratch->type = kTfLiteInt32;
+    accum_scratch->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* accum_scratch_size = TfLiteIntArrayCreate(2);
+    accum_scratch_size->data[0] = batches * outHeight * outWidth;
+    accum_scratch_size->data[1] = channels_out;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, accum_scratch,
+                                                     accum_scratch_size));
+  }
+
   return kTfLiteOk;
 }
 
+// Evaluates a uint8 convolution whose weights are quantized per output
+// channel.
+template <KernelType kernel_type>
+void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteConvParams* params, OpData* data,
+                             TfLiteTensor* input, TfLiteTensor* filter,
+                             TfLiteTensor* bias, TfLiteTensor* im2col,
+                             TfLiteTensor* accum_scratch,
+                             TfLiteTensor* output) {
+  auto input_offset = -input->params.zero_point;
+  auto filter_offset = -filter->params.zero_point;
+  auto output_offset = output->params.zero_point;
+
+  switch (kernel_type) {
+    case kReference:
+      reference_ops::ConvPerChannel(
+          GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+          GetTensorData<uint8_t>(filter), GetTensorDims(filter), filter_offset,
+          GetTensorData<int32_t>(bias), GetTensorDims(bias),
+          params->stride_width, params->stride_height, data->padding.width,
+          data->padding.height, output_offset,
+          data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), data->output_activation_min,
+          data->output_activation_max, GetTensorData<uint8_t>(output),
+          GetTensorDims(output));
+      break;
+    case kGenericOptimized:
+    case kMultithreadOptimized:
+    case kCblasOptimized:
+      optimized_ops::ConvPerChannel(
+          GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+          GetTensorData<uint8_t>(filter), GetTensorDims(filter), filter_offset,
+          GetTensorData<int32_t>(bias), GetTensorDims(bias),
+          params->stride_width, params->stride_height, data->padding.width,
+          data->padding.height, output_offset,
+          data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), data->output_activation_min,
+          data->output_activation_max, GetTensorData<uint8_t>(output),
+          GetTensorDims(output), GetTensorData<uint8_t>(im2col),
+          GetTensorDims(im2col), GetTensorData<int32_t>(accum_scratch),
+          gemm_support::GetFromContext(context));
+      break;
+  }
+}
+
 template <KernelType kernel_type>
 void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
@@ -427,6 +586,7 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
         filter_data = GetTensorData<float>(filter);
       }
       multithreaded_ops::Conv(
+          *eigen_support::GetThreadPoolDevice(context),
           GetTensorData<float>(input), GetTensorDims(input), filter_data,
           GetTensorDims(filter), GetTensorData<float>(bias),
           GetTensorDims(bias), params->stride_width, params->stride_height,
@@ -450,6 +610,118 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+// Returns the float input as a matrix with one row per output position, each
+// holding the input values under the filter: the im2col matrix, if the
+// convolution needs one, or else the input itself.
+const float* Im2colFloatIfRequired(TfLiteConvParams* params, OpData* data,
+                                   TfLiteTensor* input, TfLiteTensor* filter,
+                                   TfLiteTensor* im2col,
+                                   TfLiteTensor* output) {
+  if (!data->need_im2col) {
+    return GetTensorData<float>(input);
+  }
+  // NB: static_cast<float>(0x00000000h) == 0.0f
+  const uint8_t float_zero_byte = 0x00;
+  if (params->dilation_width_factor != 1 ||
+      params->dilation_height_factor != 1) {
+    optimized_ops::DilatedIm2col(
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorDims(filter), params->stride_width, params->stride_height,
+        params->dilation_width_factor, params->dilation_height_factor,
+        data->padding.width, data->padding.height, GetTensorDims(output),
+        float_zero_byte, GetTensorData<float>(im2col));
+  } else {
+    optimized_ops::Im2col(
+        GetTensorData<float>(input), GetTensorDims(input),
+        params->stride_width, params->stride_height, data->padding.width,
+        data->padding.height, SizeOfDimension(filter, 1),
+        SizeOfDimension(filter, 2), float_zero_byte,
+        GetTensorData<float>(im2col), GetTensorDims(im2col));
+  }
+  return GetTensorData<float>(im2col);
+}
+
+// Evaluates a convolution of float inputs with symmetrically quantized
+// weights, as a product of the weights with the im2col matrix whose rows are
+// quantized independently.
+void EvalHybrid(TfLiteContext* context, TfLiteNode* node,
+                TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
+                TfLiteTensor* filter, TfLiteTensor* bias, TfLiteTensor* im2col,
+                TfLiteTensor* input_quantized, TfLiteTensor* scaling_factors,
+                TfLiteTensor* output) {
+  const int num_rows = SizeOfDimension(input_quantized, 0);
+  const int row_size = SizeOfDimension(input_quantized, 1);
+  const int channels_out = SizeOfDimension(filter, 0);
+
+  const float* gemm_input_data =
+      Im2colFloatIfRequired(params, data, input, filter, im2col, output);
+
+  // Output = bias.
+  tensor_utils::VectorBatchVectorAssign(GetTensorData<float>(bias),
+                                        channels_out, num_rows,
+                                        GetTensorData<float>(output));
+
+  // Quantize each row independently, and incorporate the scaling of the
+  // filter.
+  int8_t* quantized_data =
+      reinterpret_cast<int8_t*>(GetTensorData<uint8_t>(input_quantized));
+  float* scaling_factors_data = GetTensorData<float>(scaling_factors);
+  float unused_min, unused_max;
+  for (int row = 0; row < num_rows; ++row) {
+    const int offset = row * row_size;
+    tensor_utils::SymmetricQuantizeFloats(
+        gemm_input_data + offset, row_size, quantized_data + offset,
+        &unused_min, &unused_max, &scaling_factors_data[row]);
+    scaling_factors_data[row] *= filter->params.scale;
+  }
+
+  // Output += filter * quantized_input
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      reinterpret_cast<int8_t*>(GetTensorData<uint8_t>(filter)), channels_out,
+      row_size, quantized_data, scaling_factors_data, num_rows,
+      GetTensorData<float>(output), /*result_stride=*/1);
+
+  tensor_utils::ApplyActivationToVector(
+      GetTensorData<float>(output), num_rows * channels_out,
+      params->activation, GetTensorData<float>(output));
+}
+
+// Evaluates a float convolution with weights in block-sparse form, as a
+// product of the weights with the im2col matrix that skips their zeros.
+void EvalSparse(TfLiteContext* context, TfLiteNode* node,
+                TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
+                TfLiteTensor* filter, TfLiteTensor* bias, TfLiteTensor* im2col,
+                TfLiteTensor* output) {
+  const int channels_out = SizeOfDimension(filter, 0);
+  const int row_size = SizeOfDimension(filter, 1) *
+                       SizeOfDimension(filter, 2) * SizeOfDimension(filter, 3);
+  const int num_rows = NumElements(output) / channels_out;
+
+  const float* gemm_input_data =
+      Im2colFloatIfRequired(params, data, input, filter, im2col, output);
+
+  // Output = bias, if any.
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(GetTensorData<float>(bias),
+                                          channels_out, num_rows,
+                                          GetTensorData<float>(output));
+  } else {
+    tensor_utils::ZeroVector(GetTensorData<float>(output),
+                             num_rows * channels_out);
+  }
+
+  // Output += filter * gemm_input
+  const SparseWeights& weights = data->sparse_weights;
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      weights.blocks.data(), weights.block_columns.data(),
+      weights.row_starts.data(), channels_out, row_size, gemm_input_data,
+      num_rows, GetTensorData<float>(output), /*result_stride=*/1);
+
+  tensor_utils::ApplyActivationToVector(
+      GetTensorData<float>(output), num_rows * channels_out,
+      params->activation, GetTensorData<float>(output));
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -479,7 +751,19 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   // separate ops to avoid dispatch overhead here.
   switch (input->type) {  // Already know in/outtypes are same.
     case kTfLiteFloat32:
-      if (data->run_multithreaded_kernel) {
+      if (data->is_hybrid) {
+        TfLiteTensor* input_quantized =
+            &context->tensors[node->temporaries
+                                  ->data[data->input_quantized_index]];
+        TfLiteTensor* scaling_factors =
+            &context->tensors[node->temporaries
+                                  ->data[data->scaling_factors_index]];
+        EvalHybrid(context, node, params, data, input, filter, bias, im2col,
+                   input_quantized, scaling_factors, output);
+      } else if (kernel_type != kReference && data->sparse_weights.is_sparse) {
+        EvalSparse(context, node, params, data, input, filter, bias, im2col,
+                   output);
+      } else if (data->run_multithreaded_kernel) {
         EvalFloat<kernel_type>(context, node, params, data, input, filter, bias,
                                im2col, hwcn_weights, output);
       } else {
@@ -488,8 +772,17 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       }
       break;
     case kTfLiteUInt8:
-      EvalQuantized<kernel_type>(context, node, params, data, input, filter,
-                                 bias, im2col, hwcn_weights, output);
+      if (data->is_per_channel) {
+        TfLiteTensor* accum_scratch =
+            &context->tensors[node->temporaries
+                                  ->data[data->accum_scratch_index]];
+        EvalQuantizedPerChannel<kernel_type>(context, node, params, data,
+                                             input, filter, bias, im2col,
+                                             accum_scratch, output);
+      } else {
+        EvalQuantized<kernel_type>(context, node, params, data, input, filter,
+                                   bias, im2col, hwcn_weights, output);
+      }
       break;
     default:
       context->ReportError(context, "Type %d not currently supported.",
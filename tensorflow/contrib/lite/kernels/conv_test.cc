@@ -12,11 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cmath>
 #include <cstdarg>
 
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
 #include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/kernels/test_util.h"
 #include "tensorflow/contrib/lite/model.h"
@@ -103,6 +105,22 @@ class ConvolutionOpModel : public BaseConvolutionOpModel {
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 };
 
+class HybridConvolutionOpModel : public BaseConvolutionOpModel {
+ public:
+  using BaseConvolutionOpModel::BaseConvolutionOpModel;
+
+  void SetFilter(std::initializer_list<float> f) {
+    SymmetricQuantizeAndPopulate(filter_, f);
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_CONVOLUTION_REF()},
     {"GenericOptimized", ops::builtin::Register_CONVOLUTION_GENERIC_OPT()},
@@ -148,6 +166,40 @@ TEST_P(ConvolutionOpTest, SimpleTestFloat32) {
                              }));
 }
 
+TEST_P(ConvolutionOpTest, SimpleTestHybrid) {
+  HybridConvolutionOpModel m(
+      GetRegistration(), {TensorType_FLOAT32, {2, 2, 4, 1}},
+      {TensorType_UINT8, {3, 2, 2, 1}}, {TensorType_FLOAT32, {}});
+
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+  m.SetFilter({
+      1, 2, 3, 4,    // first 2x2 filter
+      -1, 1, -1, 1,  // second 2x2 filter
+      -1, -1, 1, 1,  // third 2x2 filter
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+
+  // Both the filter and the input are quantized symmetrically, so the result
+  // is only approximately the one of SimpleTestFloat32.
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     18, 2, 5,  // first batch, left
+                                     18, 2, 5,  // first batch, right
+                                     17, 4, 3,  // second batch, left
+                                     37, 4, 3,  // second batch, right
+                                 },
+                                 0.16)));
+}
+
 TEST_P(ConvolutionOpTest, SimpleTestFloat32WithAnisotropicStrides) {
   ConvolutionOpModel m(GetRegistration(), {TensorType_FLOAT32, {1, 3, 6, 1}},
                        {TensorType_FLOAT32, {1, 2, 2, 1}},
@@ -441,6 +493,90 @@ TEST_P(ConvolutionOpTest, SimpleTestQuantized) {
                              }));
 }
 
+class PerChannelQuantizedConvolutionOpModel
+    : public QuantizedConvolutionOpModel {
+ public:
+  using QuantizedConvolutionOpModel::QuantizedConvolutionOpModel;
+
+  // Quantizes the filter symmetrically with one scale per output channel, and
+  // the bias with the matching scales. This changes the quantization of the
+  // tensors, so they are allocated again before being populated.
+  void SetPerChannelFilterAndBias(std::initializer_list<float> filter,
+                                  std::initializer_list<float> bias) {
+    const int num_channels = GetShape(filter_)[0];
+    std::vector<float> filter_values(filter);
+    const int filter_size = filter_values.size();
+    std::vector<uint8_t> quantized_filter(filter_size);
+    std::vector<float> filter_scales(num_channels);
+    SymmetricQuantizePerChannel(filter_values.data(), filter_size,
+                                num_channels, filter_size / num_channels,
+                                quantized_filter.data(), filter_scales.data());
+
+    std::vector<float> bias_values(bias);
+    std::vector<float> bias_scales(num_channels);
+    std::vector<int32_t> quantized_bias(num_channels);
+    for (int c = 0; c < num_channels; ++c) {
+      bias_scales[c] = GetScale(input_) * filter_scales[c];
+      quantized_bias[c] =
+          static_cast<int32_t>(std::round(bias_values[c] / bias_scales[c]));
+    }
+
+    CHECK_EQ(interpreter_->SetTensorPerChannelQuantization(filter_, 0,
+                                                           filter_scales),
+             kTfLiteOk);
+    CHECK_EQ(
+        interpreter_->SetTensorPerChannelQuantization(bias_, 0, bias_scales),
+        kTfLiteOk);
+    CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    PopulateTensor(filter_, 0, quantized_filter.data(),
+                   quantized_filter.data() + filter_size);
+    PopulateTensor(bias_, 0, quantized_bias.data(),
+                   quantized_bias.data() + num_channels);
+  }
+};
+
+// The filters have very different ranges, which a single scale for all of
+// them would not represent well.
+TEST_P(ConvolutionOpTest, SimpleTestQuantizedPerChannel) {
+  PerChannelQuantizedConvolutionOpModel m(
+      GetRegistration(), {TensorType_UINT8, {2, 2, 4, 1}, -63.5, 64},
+      {TensorType_UINT8, {3, 2, 2, 1}, -64, 63.5},
+      {TensorType_UINT8, {}, -63.5, 64});
+  m.SetPerChannelFilterAndBias(
+      {
+          1, 2, 3, 5,                // first 2x2 filter
+          -0.25, 0.25, -0.25, 0.25,  // second 2x2 filter
+          -1, -1, 1, 1,              // third 2x2 filter
+      },
+      {1.5, 0.5, 3});
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      20.5, 0.5, 5,  // first batch, left
+                      20.5, 0.5, 5,  // first batch, right
+                      19.5, 1, 3,    // second batch, left
+                      41.5, 1, 3,    // second batch, right
+                  },
+                  1e-5)));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 168, 128, 137,  //
+                                 168, 128, 137,  //
+                                 166, 129, 133,  //
+                                 210, 129, 133,  //
+                             }));
+}
+
 TEST_P(ConvolutionOpTest, SimpleTestQuantizedWithAnisotropicStrides) {
   QuantizedConvolutionOpModel m(GetRegistration(),
                                 {TensorType_UINT8, {1, 3, 6, 1}, -63.5, 64},
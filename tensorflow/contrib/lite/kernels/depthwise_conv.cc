@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
@@ -59,6 +60,11 @@ struct OpData {
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+  // Whether the uint8 weights are quantized per output channel, in which case
+  // each channel has its own output multiplier and (right) shift.
+  bool is_per_channel;
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int> per_channel_output_shift;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -147,7 +153,25 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
-  if (data_type != kTfLiteFloat32) {
+  data->is_per_channel = data_type == kTfLiteUInt8 &&
+                         filter->per_channel_quantization != nullptr;
+  if (data->is_per_channel) {
+    std::vector<double> real_multipliers;
+    TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipliersPerChannel(
+        context, input, filter, bias, output, /*channel_dimension=*/3,
+        &real_multipliers));
+    data->per_channel_output_multiplier.resize(channels_out);
+    data->per_channel_output_shift.resize(channels_out);
+    for (int c = 0; c < channels_out; ++c) {
+      int exponent;
+      QuantizeMultiplier(real_multipliers[c],
+                         &data->per_channel_output_multiplier[c], &exponent);
+      data->per_channel_output_shift[c] = -exponent;
+    }
+    CalculateActivationRangeUint8(params->activation, output,
+                                  &data->output_activation_min,
+                                  &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -224,6 +248,38 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
       GetTensorDims(output));
 }
 
+template <KernelType kernel_type>
+void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteDepthwiseConvParams* params, OpData* data,
+                             const TfLiteTensor* input,
+                             const TfLiteTensor* filter,
+                             const TfLiteTensor* bias, TfLiteTensor* output) {
+  auto input_offset = -input->params.zero_point;
+  auto filter_offset = -filter->params.zero_point;
+  auto output_offset = output->params.zero_point;
+
+  void (*depthwise_conv)(const uint8*, const Dims<4>&, int32, const uint8*,
+                         const Dims<4>&, int32, const int32*, const Dims<4>&,
+                         int, int, int, int, int, int32, const int32*,
+                         const int*, int32, int32, uint8*, const Dims<4>&);
+  if (kernel_type == kReference) {
+    depthwise_conv = &reference_ops::DepthwiseConvPerChannel;
+  } else {
+    depthwise_conv = &optimized_ops::DepthwiseConvPerChannel;
+  }
+
+  depthwise_conv(
+      GetTensorData<uint8_t>(input), GetTensorDims(input), input_offset,
+      GetTensorData<uint8_t>(filter), GetTensorDims(filter), filter_offset,
+      GetTensorData<int32_t>(bias), GetTensorDims(bias), params->stride_width,
+      params->stride_height, data->padding.width, data->padding.height,
+      params->depth_multiplier, output_offset,
+      data->per_channel_output_multiplier.data(),
+      data->per_channel_output_shift.data(), data->output_activation_min,
+      data->output_activation_max, GetTensorData<uint8_t>(output),
+      GetTensorDims(output));
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
@@ -244,8 +300,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                              output);
       break;
     case kTfLiteUInt8:
-      EvalQuantized<kernel_type>(context, node, params, data, input, filter,
-                                 bias, output);
+      if (data->is_per_channel) {
+        EvalQuantizedPerChannel<kernel_type>(context, node, params, data,
+                                             input, filter, bias, output);
+      } else {
+        EvalQuantized<kernel_type>(context, node, params, data, input, filter,
+                                   bias, output);
+      }
       break;
     default:
       context->ReportError(context, "Type %d not currently supported.",
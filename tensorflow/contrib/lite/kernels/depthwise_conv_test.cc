@@ -12,9 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cmath>
 #include <cstdarg>
 #include <gtest/gtest.h>
 #include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/kernels/test_util.h"
 #include "tensorflow/contrib/lite/model.h"
@@ -207,6 +209,85 @@ TEST(QuantizedDepthwiseConvolutionOpTest,
               ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 1)));
 }
 
+class PerChannelQuantizedDepthwiseConvolutionOpModel
+    : public QuantizedDepthwiseConvolutionOpModel {
+ public:
+  using QuantizedDepthwiseConvolutionOpModel::
+      QuantizedDepthwiseConvolutionOpModel;
+
+  // Quantizes the filter symmetrically with one scale per output channel, and
+  // the bias with the matching scales. This changes the quantization of the
+  // tensors, so they are allocated again before being populated.
+  void SetPerChannelFilterAndBias(std::initializer_list<float> filter,
+                                  std::initializer_list<float> bias) {
+    const int num_channels = GetShape(filter_)[3];
+    std::vector<float> filter_values(filter);
+    const int filter_size = filter_values.size();
+    std::vector<uint8_t> quantized_filter(filter_size);
+    std::vector<float> filter_scales(num_channels);
+    SymmetricQuantizePerChannel(filter_values.data(), filter_size,
+                                num_channels, /*inner_size=*/1,
+                                quantized_filter.data(), filter_scales.data());
+
+    std::vector<float> bias_values(bias);
+    std::vector<float> bias_scales(num_channels);
+    std::vector<int32_t> quantized_bias(num_channels);
+    for (int c = 0; c < num_channels; ++c) {
+      bias_scales[c] = GetScale(input_) * filter_scales[c];
+      quantized_bias[c] =
+          static_cast<int32_t>(std::round(bias_values[c] / bias_scales[c]));
+    }
+
+    CHECK_EQ(interpreter_->SetTensorPerChannelQuantization(filter_, 3,
+                                                           filter_scales),
+             kTfLiteOk);
+    CHECK_EQ(
+        interpreter_->SetTensorPerChannelQuantization(bias_, 0, bias_scales),
+        kTfLiteOk);
+    CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    PopulateTensor(filter_, 0, quantized_filter.data(),
+                   quantized_filter.data() + filter_size);
+    PopulateTensor(bias_, 0, quantized_bias.data(),
+                   quantized_bias.data() + num_channels);
+  }
+};
+
+TEST(QuantizedDepthwiseConvolutionOpTest, SimpleTestQuantizedPerChannel) {
+  PerChannelQuantizedDepthwiseConvolutionOpModel quant_op(
+      {TensorType_UINT8, {1, 3, 2, 2}, -63.5, 64},
+      {TensorType_UINT8, {1, 2, 2, 4}, -128, 127},
+      {TensorType_UINT8, {}, -127, 128});
+  DepthwiseConvolutionOpModel float_op({TensorType_FLOAT32, {1, 3, 2, 2}},
+                                       {TensorType_FLOAT32, {1, 2, 2, 4}},
+                                       {TensorType_FLOAT32, {}});
+
+  std::initializer_list<float> input = {
+      1, 2, 7,  8,   // column 1
+      3, 4, 9,  10,  // column 2
+      5, 6, 11, 12,  // column 3
+  };
+  // The second output channel has much smaller weights than the others.
+  std::initializer_list<float> filter = {
+      1,  0.2,  3,   4,    //
+      -9, 1.0,  -11, 12,   //
+      5,  0.6,  7,   8,    //
+      13, -1.4, 15,  -16,  //
+  };
+  std::initializer_list<float> bias = {1, 2, 3, 4};
+
+  quant_op.SetPerChannelFilterAndBias(filter, bias);
+  quant_op.SetInput(input);
+  quant_op.Invoke();
+
+  float_op.SetInput(input);
+  float_op.SetFilter(filter);
+  float_op.SetBias(bias);
+  float_op.Invoke();
+
+  EXPECT_THAT(quant_op.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 1)));
+}
+
 }  // namespace
 }  // namespace tflite
 
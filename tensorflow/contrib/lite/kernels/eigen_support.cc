@@ -14,23 +14,56 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/kernels/eigen_support.h"
 
-#include "third_party/eigen3/Eigen/Core"
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+
+#include "tensorflow/contrib/lite/kernels/internal/optimized/eigen_spatial_convolutions.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 
 namespace tflite {
 namespace eigen_support {
+namespace {
+
+// Number of threads of the pool when the context doesn't recommend any.
+constexpr int kDefaultNumThreadpoolThreads = 4;
+
+class EigenThreadPoolWrapper : public Eigen::ThreadPoolInterface {
+ public:
+  explicit EigenThreadPoolWrapper(Eigen::ThreadPool* pool) : pool_(pool) {}
+  ~EigenThreadPoolWrapper() override {}
+
+  void Schedule(std::function<void()> fn) override {
+    pool_->Schedule(std::move(fn));
+  }
+  int NumThreads() const override { return pool_->NumThreads(); }
+  int CurrentThreadId() const override { return pool_->CurrentThreadId(); }
+
+ private:
+  Eigen::ThreadPool* pool_ = nullptr;
+};
+
+}  // namespace
 
 struct RefCountedEigenContext {
   int num_references = 0;
+  int num_threads = kDefaultNumThreadpoolThreads;
+
+  // Created lazily by GetThreadPoolDevice(), and reset when the number of
+  // threads changes. Declared in destruction order.
+  std::mutex device_mutex;
+  std::unique_ptr<Eigen::ThreadPool> thread_pool;
+  std::unique_ptr<EigenThreadPoolWrapper> thread_pool_wrapper;
+  std::unique_ptr<Eigen::ThreadPoolDevice> device;
 };
 
 void IncrementUsageCounter(TfLiteContext* context) {
   auto* ptr = reinterpret_cast<RefCountedEigenContext*>(context->eigen_context);
   if (ptr == nullptr) {
+    ptr = new RefCountedEigenContext;
     if (context->recommended_num_threads != -1) {
       Eigen::setNbThreads(context->recommended_num_threads);
+      ptr->num_threads = context->recommended_num_threads;
     }
-    ptr = new RefCountedEigenContext;
     ptr->num_references = 0;
     context->eigen_context = ptr;
   }
@@ -53,8 +86,35 @@ void DecrementUsageCounter(TfLiteContext* context) {
 void SetNumThreads(TfLiteContext* context, int num_threads) {
   IncrementUsageCounter(context);
   Eigen::setNbThreads(num_threads);
+  auto* ptr = reinterpret_cast<RefCountedEigenContext*>(context->eigen_context);
+  {
+    std::lock_guard<std::mutex> lock(ptr->device_mutex);
+    ptr->num_threads =
+        num_threads == -1 ? kDefaultNumThreadpoolThreads : num_threads;
+    ptr->device.reset();
+    ptr->thread_pool_wrapper.reset();
+    ptr->thread_pool.reset();
+  }
   DecrementUsageCounter(context);
 }
 
+const Eigen::ThreadPoolDevice* GetThreadPoolDevice(TfLiteContext* context) {
+  auto* ptr = reinterpret_cast<RefCountedEigenContext*>(context->eigen_context);
+  if (ptr == nullptr) {
+    TF_LITE_FATAL(
+        "Call to GetThreadPoolDevice() not preceded by "
+        "IncrementUsageCounter()");
+  }
+  std::lock_guard<std::mutex> lock(ptr->device_mutex);
+  if (ptr->device == nullptr) {
+    ptr->thread_pool.reset(new Eigen::ThreadPool(ptr->num_threads));
+    ptr->thread_pool_wrapper.reset(
+        new EigenThreadPoolWrapper(ptr->thread_pool.get()));
+    ptr->device.reset(new Eigen::ThreadPoolDevice(
+        ptr->thread_pool_wrapper.get(), ptr->num_threads));
+  }
+  return ptr->device.get();
+}
+
 }  // namespace eigen_support
 }  // namespace tflite
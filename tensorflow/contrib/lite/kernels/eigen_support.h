@@ -17,6 +17,10 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/context.h"
 
+namespace EigenForTFLite {
+struct ThreadPoolDevice;
+}
+
 namespace tflite {
 namespace eigen_support {
 
@@ -31,6 +35,13 @@ void DecrementUsageCounter(TfLiteContext* context);
 // Set the number of threads that can be used by Eigen.
 void SetNumThreads(TfLiteContext* context, int num_threads);
 
+// Returns the Eigen thread pool device shared by all the ops of 'context'.
+// Its threads are created on first use, and their number is the context's
+// 'recommended_num_threads' (or 4 if unset). Must only be called by ops that
+// incremented the usage counter.
+const EigenForTFLite::ThreadPoolDevice* GetThreadPoolDevice(
+    TfLiteContext* context);
+
 }  // namespace eigen_support
 }  // namespace tflite
 
@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/eigen_support.h"
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_conv.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
@@ -32,6 +34,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/sparse_weights.h"
 
 namespace tflite {
 namespace ops {
@@ -57,8 +60,17 @@ struct OpData {
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
   int input_quantized_index;
+  // Whether the float product is large enough to be sharded over the threads
+  // of the Eigen thread pool device.
+  bool run_multithreaded_kernel;
+  // The float weights in block-sparse form, if they are mostly zeros.
+  SparseWeights sparse_weights;
 };
 
+// Float products with fewer multiply-adds than this run on the calling thread,
+// where they are cheaper than the synchronization with the thread pool.
+constexpr int kMultithreadMinMultiplyAdds = 1 << 18;
+
 constexpr int kInputTensor = 0;
 constexpr int kWeightsTensor = 1;
 constexpr int kBiasTensor = 2;
@@ -70,6 +82,7 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // Instead, we allocate a new object to carry information from Prepare() to
   // Eval().
   gemm_support::IncrementUsageCounter(context);
+  eigen_support::IncrementUsageCounter(context);
   auto* op_data = new OpData;
   context->AddTensors(context, 1, &op_data->input_quantized_index);
   return op_data;
@@ -77,6 +90,7 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
 
 void Free(TfLiteContext* context, void* buffer) {
   gemm_support::DecrementUsageCounter(context);
+  eigen_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
 }
 
@@ -110,6 +124,16 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_EQ(context, NumElements(bias), SizeOfDimension(filter, 0));
   }
 
+  data->run_multithreaded_kernel =
+      context->recommended_num_threads != 1 &&
+      static_cast<int64_t>(input_size) * num_units >=
+          kMultithreadMinMultiplyAdds;
+
+  if (input->type == kTfLiteFloat32) {
+    PrepareSparseWeights(filter, num_units, filter->dims->data[1],
+                         &data->sparse_weights);
+  }
+
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   TfLiteType data_type = input->type;
@@ -189,6 +213,37 @@ TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Evaluates the op with weights in block-sparse form, skipping their zeros.
+TfLiteStatus EvalSparse(TfLiteContext* context, TfLiteNode* node,
+                        TfLiteFullyConnectedParams* params, OpData* data,
+                        const TfLiteTensor* input, const TfLiteTensor* filter,
+                        const TfLiteTensor* bias, TfLiteTensor* output) {
+  const int input_size = filter->dims->data[1];
+  const int batch_size = NumElements(input) / input_size;
+  const int num_units = filter->dims->data[0];
+
+  // Output = bias if bias tensor exists.
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(bias->data.f, num_units, batch_size,
+                                          output->data.f);
+  } else {
+    tensor_utils::ZeroVector(output->data.f, batch_size * num_units);
+  }
+
+  // Compute output += weight * input
+  const SparseWeights& weights = data->sparse_weights;
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      weights.blocks.data(), weights.block_columns.data(),
+      weights.row_starts.data(), num_units, input_size, input->data.f,
+      batch_size, output->data.f, /*result_stride=*/1);
+
+  // Apply activation function
+  tensor_utils::ApplyActivationToVector(output->data.f, batch_size * num_units,
+                                        params->activation, output->data.f);
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus EvalPieQuantized(TfLiteContext* context, TfLiteNode* node,
                               TfLiteFullyConnectedParams* params, OpData* data,
                               const TfLiteTensor* input,
@@ -324,6 +379,17 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
                        GetTensorData<float>(output), GetTensorDims(output))
   if (kernel_type == kReference) {
     TF_LITE_FULLY_CONNECTED(reference_ops);
+  } else if (data->sparse_weights.is_sparse) {
+    return EvalSparse(context, node, params, data, input, filter, bias,
+                      output);
+  } else if (data->run_multithreaded_kernel) {
+    multithreaded_ops::FullyConnected(
+        *eigen_support::GetThreadPoolDevice(context),
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(filter), GetTensorDims(filter),
+        GetTensorData<float>(bias), GetTensorDims(bias), output_activation_min,
+        output_activation_max, GetTensorData<float>(output),
+        GetTensorDims(output));
   } else if (kernel_type == kPie) {
     return EvalPie(context, node, params, data, input, filter, bias, output);
   } else {
@@ -279,6 +279,37 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
   int input_size_;
 };
 
+// The weights are constant, so that the kernels can use them in block-sparse
+// form if they are mostly zeros.
+class SparseFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseFullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                              int batches, int input_size,
+                              std::initializer_list<float> weights) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    AddConstInput(TensorType_FLOAT32, weights, {units, input_size});
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(bias_)});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ protected:
+  int input_;
+  int bias_;
+  int output_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"NeonOptimized", ops::builtin::Register_FULLY_CONNECTED_NEON_OPT()},
@@ -340,6 +371,26 @@ TEST_P(FloatFullyConnectedOpTest, SimpleTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(24, 25, 26, 58, 59, 60));
 }
 
+TEST_P(FloatFullyConnectedOpTest, SparseWeights) {
+  SparseFullyConnectedOpModel m(GetRegistration(), /*units=*/3, /*batches=*/2,
+                                /*input_size=*/8,
+                                {
+                                    1, 2, 0, 0, 0, 0, 0, 0,  // u = 0
+                                    0, 0, 0, 0, 0, 0, 0, 0,  // u = 1
+                                    0, 0, 0, 0, 1, 1, 1, 1,  // u = 2
+                                });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,       // b = 0
+      -1, -2, 3, 4, -5, -6, -7, 8,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAre(6, 2, 29, 0, 2, 0));
+}
+
 TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantized) {
   QuantizedFullyConnectedOpModel m(
       GetRegistration(), /*units=*/3, /*batches*/ 2,
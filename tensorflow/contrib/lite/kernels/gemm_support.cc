@@ -14,24 +14,31 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
 
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 
 namespace tflite {
 namespace gemm_support {
 
 struct RefCountedGemmContext {
-  gemmlowp::GemmContext* gemm_context_ = nullptr;
   int num_references_ = 0;
+  int max_num_threads_ = -1;
+  // A GemmContext can't be used concurrently, so each thread running ops
+  // (see Interpreter::SetNumInterOpThreads()) gets its own.
+  std::mutex mutex_;
+  std::unordered_map<std::thread::id, std::unique_ptr<gemmlowp::GemmContext>>
+      gemm_contexts_;
 };
 
 void IncrementUsageCounter(TfLiteContext* context) {
   auto* ptr = reinterpret_cast<RefCountedGemmContext*>(context->gemm_context);
   if (ptr == nullptr) {
     ptr = new RefCountedGemmContext;
-    ptr->gemm_context_ = new gemmlowp::GemmContext();
-    if (context->recommended_num_threads != -1) {
-      ptr->gemm_context_->set_max_num_threads(context->recommended_num_threads);
-    }
+    ptr->max_num_threads_ = context->recommended_num_threads;
     ptr->num_references_ = 0;
     context->gemm_context = ptr;
   }
@@ -46,7 +53,6 @@ void DecrementUsageCounter(TfLiteContext* context) {
         "IncrementUsageCounter()");
   }
   if (--ptr->num_references_ == 0) {
-    delete ptr->gemm_context_;
     delete ptr;
     context->gemm_context = nullptr;
   }
@@ -58,12 +64,28 @@ gemmlowp::GemmContext* GetFromContext(TfLiteContext* context) {
     TF_LITE_FATAL(
         "Call to GetFromContext() not preceded by IncrementUsageCounter()");
   }
-  return ptr->gemm_context_;
+  std::lock_guard<std::mutex> lock(ptr->mutex_);
+  std::unique_ptr<gemmlowp::GemmContext>& gemm_context =
+      ptr->gemm_contexts_[std::this_thread::get_id()];
+  if (gemm_context == nullptr) {
+    gemm_context.reset(new gemmlowp::GemmContext());
+    if (ptr->max_num_threads_ != -1) {
+      gemm_context->set_max_num_threads(ptr->max_num_threads_);
+    }
+  }
+  return gemm_context.get();
 }
 
 void SetNumThreads(TfLiteContext* context, int num_threads) {
   IncrementUsageCounter(context);
-  GetFromContext(context)->set_max_num_threads(num_threads);
+  auto* ptr = reinterpret_cast<RefCountedGemmContext*>(context->gemm_context);
+  {
+    std::lock_guard<std::mutex> lock(ptr->mutex_);
+    ptr->max_num_threads_ = num_threads;
+    for (auto& gemm_context : ptr->gemm_contexts_) {
+      gemm_context.second->set_max_num_threads(num_threads);
+    }
+  }
   DecrementUsageCounter(context);
 }
 
@@ -21,8 +21,9 @@ limitations under the License.
 namespace tflite {
 namespace gemm_support {
 
-// Returns the GemmContext stored in 'context', allowing multiple ops to
-// share a single object, as long as they share a TfLiteContext. The caller
+// Returns the GemmContext stored in 'context' for the calling thread, allowing
+// multiple ops to share a single object, as long as they share a TfLiteContext
+// and run on the same thread. The caller
 // must ensure that this is called between IncrementUsageCounter() and
 // DecrementUsageCounter(). For example, in the implementation of an op:
 //   void* Init(TfLiteContext* context, const char*, size_t) {
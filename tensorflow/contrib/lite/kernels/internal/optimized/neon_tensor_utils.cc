@@ -242,6 +242,32 @@ void NeonMatrixBatchVectorMultiplyAccumulate(
   free(aligned_vec_free);
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride) {
+  float* result_in_batch = result;
+  for (int b = 0; b < n_batch; b++) {
+    const float* vector_in_batch = vector + b * m_cols;
+    for (int r = 0; r < m_rows; r++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      // Each block is one lane of 4 floats.
+      for (int i = row_starts[r]; i < row_starts[r + 1]; ++i) {
+        float32x4_t block_f32x4 =
+            vld1q_f32(blocks + kFloatWeightsPerNeonLane * i);
+        float32x4_t vector_f32x4 =
+            vld1q_f32(vector_in_batch + block_columns[i]);
+        acc_32x4 = vmlaq_f32(acc_32x4, block_f32x4, vector_f32x4);
+      }
+      *result_in_batch +=
+          (vgetq_lane_f32(acc_32x4, 0) + vgetq_lane_f32(acc_32x4, 1) +
+           vgetq_lane_f32(acc_32x4, 2) + vgetq_lane_f32(acc_32x4, 3));
+      result_in_batch += result_stride;
+    }
+  }
+}
+
 void NeonVectorVectorCwiseProduct(const float* vector1, const float* vector2,
                                   int v_size, float* result) {
   // If v_size is not divisible by kWeightsPerNeonLane, we cannot use the main
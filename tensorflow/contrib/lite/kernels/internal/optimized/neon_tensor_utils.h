@@ -40,6 +40,27 @@ void MatrixBatchVectorMultiplyAccumulate(
                    vectors, scaling_factors, n_batch, result, result_stride);
 }
 
+int CountNonZeroBlocks1x4(const float* matrix, int m_rows, int m_cols) {
+  return PortableCountNonZeroBlocks1x4(matrix, m_rows, m_cols);
+}
+
+void DenseToSparse1x4(const float* matrix, int m_rows, int m_cols,
+                      float* blocks, int32_t* block_columns,
+                      int32_t* row_starts) {
+  PortableDenseToSparse1x4(matrix, m_rows, m_cols, blocks, block_columns,
+                           row_starts);
+}
+
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride) {
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x4, blocks,
+                   block_columns, row_starts, m_rows, m_cols, vector, n_batch,
+                   result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   NEON_OR_PORTABLE(VectorVectorCwiseProduct, vector1, vector2, v_size, result);
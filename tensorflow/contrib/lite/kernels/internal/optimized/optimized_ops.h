@@ -2093,6 +2093,97 @@ inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
       input_offset, output_pipeline);
 }
 
+// Like the uint8 Conv above, but with weights quantized per output channel:
+// output_multiplier and output_shift hold one entry per output channel, and
+// the shifts are right shifts. The GEMM adds the bias and writes int32
+// accumulators to 'accum_data', which has room for the whole output, then
+// each output channel is down-quantized with its own multiplier.
+inline void ConvPerChannel(
+    const uint8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const uint8* filter_data, const Dims<4>& filter_dims, int32 filter_offset,
+    const int32* bias_data, const Dims<4>& bias_dims, int stride_width,
+    int stride_height, int pad_width, int pad_height, int32 output_offset,
+    const int32* output_multiplier, const int* output_shift,
+    int32 output_activation_min, int32 output_activation_max,
+    uint8* output_data, const Dims<4>& output_dims, uint8* im2col_data,
+    const Dims<4>& im2col_dims, int32* accum_data,
+    gemmlowp::GemmContext* gemm_context) {
+  gemmlowp::ScopedProfilingLabel label("ConvPerChannel/8bit");
+
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(filter_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(output_dims));
+
+  const uint8* gemm_input_data = nullptr;
+  const Dims<4>* gemm_input_dims = nullptr;
+  const int filter_width = ArraySize(filter_dims, 1);
+  const int filter_height = ArraySize(filter_dims, 2);
+  const bool need_im2col = stride_width != 1 || stride_height != 1 ||
+                           filter_width != 1 || filter_height != 1;
+  if (need_im2col) {
+    TFLITE_DCHECK(im2col_data);
+    const int input_zero_point = -input_offset;
+    TFLITE_DCHECK_GE(input_zero_point, 0);
+    TFLITE_DCHECK_LE(input_zero_point, 255);
+    Im2col(input_data, input_dims, stride_width, stride_height, pad_width,
+           pad_height, filter_height, filter_width, input_zero_point,
+           im2col_data, im2col_dims);
+    gemm_input_data = im2col_data;
+    gemm_input_dims = &im2col_dims;
+  } else {
+    TFLITE_DCHECK(!im2col_data);
+    gemm_input_data = input_data;
+    gemm_input_dims = &input_dims;
+  }
+
+  const int gemm_input_rows = gemm_input_dims->sizes[0];
+  // See b/79927784 in Conv above.
+  const int gemm_input_cols = gemm_input_dims->sizes[1] *
+                              gemm_input_dims->sizes[2] *
+                              gemm_input_dims->sizes[3];
+  const int filter_rows = filter_dims.sizes[3];
+  const int filter_cols =
+      filter_dims.sizes[0] * filter_dims.sizes[1] * filter_dims.sizes[2];
+  const int output_rows = output_dims.sizes[0];
+  const int output_cols =
+      output_dims.sizes[1] * output_dims.sizes[2] * output_dims.sizes[3];
+  TFLITE_DCHECK_EQ(output_rows, filter_rows);
+  TFLITE_DCHECK_EQ(output_cols, gemm_input_cols);
+  TFLITE_DCHECK_EQ(filter_cols, gemm_input_rows);
+  TFLITE_DCHECK_EQ(bias_dims.sizes[0], output_rows);
+  TFLITE_DCHECK_EQ(bias_dims.sizes[1], 1);
+  TFLITE_DCHECK_EQ(bias_dims.sizes[2], 1);
+  TFLITE_DCHECK_EQ(bias_dims.sizes[3], 1);
+  gemmlowp::MatrixMap<const uint8, gemmlowp::MapOrder::RowMajor> filter_matrix(
+      filter_data, filter_rows, filter_cols);
+  gemmlowp::MatrixMap<const uint8, gemmlowp::MapOrder::ColMajor> input_matrix(
+      gemm_input_data, gemm_input_rows, gemm_input_cols);
+  gemmlowp::MatrixMap<int32, gemmlowp::MapOrder::ColMajor> accum_matrix(
+      accum_data, output_rows, output_cols);
+  gemmlowp::OutputStageBiasAddition<GemmlowpOutputPipeline::ColVectorMap>
+      bias_addition_stage;
+  bias_addition_stage.bias_vector =
+      GemmlowpOutputPipeline::ColVectorMap(bias_data, output_rows);
+  gemmlowp::GemmWithOutputPipeline<uint8, int32,
+                                   gemmlowp::L8R8WithLhsNonzeroBitDepthParams>(
+      gemm_context, filter_matrix, input_matrix, &accum_matrix, filter_offset,
+      input_offset, std::make_tuple(bias_addition_stage));
+
+  gemmlowp::ScopedProfilingLabel requantize_label("downquantize+store");
+  const int32* accum_ptr = accum_data;
+  uint8* output_ptr = output_data;
+  for (int col = 0; col < output_cols; ++col) {
+    for (int row = 0; row < output_rows; ++row) {
+      int32 acc = MultiplyByQuantizedMultiplier(
+          *accum_ptr++, output_multiplier[row], -output_shift[row]);
+      acc += output_offset;
+      acc = std::max(acc, output_activation_min);
+      acc = std::min(acc, output_activation_max);
+      *output_ptr++ = static_cast<uint8>(acc);
+    }
+  }
+}
+
 // legacy, for compatibility with old checked-in code
 template <FusedActivationFunctionType Ac>
 inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
@@ -2365,6 +2456,18 @@ inline void Relu6(const float* input_data, const Dims<4>& input_dims,
   }
 }
 
+// Computes x * Relu6(x + 3) / 6 in a single pass over the data, rather than
+// the four passes of the unfused Add, Relu6, Mul and Mul.
+inline void HardSwish(const float* input_data, const Dims<4>& input_dims,
+                      float* output_data, const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("HardSwish");
+  const auto input = MapAsVector(input_data, input_dims);
+  auto output = MapAsVector(output_data, output_dims);
+  output.array() = input.array() *
+                   (input.array() + 3.0f).cwiseMax(0.0f).cwiseMin(6.0f) *
+                   (1.0f / 6.0f);
+}
+
 template <FusedActivationFunctionType Ac>
 void L2Normalization(const float* input_data, const RuntimeShape& input_shape,
                      float* output_data, const RuntimeShape& output_shape) {
@@ -50,6 +50,25 @@ void NeonMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ vectors, const float* scaling_factors,
     int n_batch, float* __restrict__ result, int result_stride);
 
+// Block-sparse matrix in blocks of 1x4 values.
+int PortableCountNonZeroBlocks1x4(const float* matrix, int m_rows,
+                                  int m_cols);
+void PortableDenseToSparse1x4(const float* matrix, int m_rows, int m_cols,
+                              float* blocks, int32_t* block_columns,
+                              int32_t* row_starts);
+
+// Multiplication of a block-sparse matrix by a batch vector.
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride);
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
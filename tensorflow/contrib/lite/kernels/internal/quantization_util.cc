@@ -126,4 +126,29 @@ void NudgeQuantizationRange(const float min, const float max,
   *nudged_max = (quant_max_float - nudged_zero_point) * (*scale);
 }
 
+void SymmetricQuantizePerChannel(const float* values, int size,
+                                 int num_channels, int inner_size,
+                                 uint8_t* quantized_values, float* scales) {
+  TFLITE_CHECK_GT(num_channels, 0);
+  TFLITE_CHECK_GT(inner_size, 0);
+  TFLITE_CHECK_EQ(size % (num_channels * inner_size), 0);
+  for (int c = 0; c < num_channels; ++c) {
+    scales[c] = 0.f;
+  }
+  for (int i = 0; i < size; ++i) {
+    float& scale = scales[(i / inner_size) % num_channels];
+    scale = std::max(scale, std::abs(values[i]));
+  }
+  for (int c = 0; c < num_channels; ++c) {
+    // An all-zeros channel quantizes to zeros whatever its scale.
+    scales[c] = scales[c] == 0.f ? 1.f : scales[c] / 127.f;
+  }
+  for (int i = 0; i < size; ++i) {
+    const float scale = scales[(i / inner_size) % num_channels];
+    const int32_t q = static_cast<int32_t>(TfLiteRound(values[i] / scale));
+    quantized_values[i] = static_cast<uint8_t>(
+        std::min(127, std::max(-127, q)) + kSymmetricUint8ZeroPoint);
+  }
+}
+
 }  // namespace tflite
@@ -218,6 +218,20 @@ void NudgeQuantizationRange(const float min, const float max,
                             const int quant_min, const int quant_max,
                             float* nudged_min, float* nudged_max, float* scale);
 
+// The zero point of uint8 arrays quantized symmetrically, so that they hold
+// int8 values in [-127, 127] offset by 128.
+constexpr int32_t kSymmetricUint8ZeroPoint = 128;
+
+// Quantizes 'values' symmetrically and per channel into uint8 values with
+// kSymmetricUint8ZeroPoint as zero point. 'values' has 'num_channels' channels
+// along one of its dimensions: element i belongs to channel
+// (i / inner_size) % num_channels, where inner_size is the number of elements
+// in the dimensions after the channel one. The scale of each channel, written
+// to 'scales', maps its largest absolute value to 127.
+void SymmetricQuantizePerChannel(const float* values, int size,
+                                 int num_channels, int inner_size,
+                                 uint8_t* quantized_values, float* scales);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_QUANTIZATION_UTIL_H_
@@ -20,6 +20,7 @@ limitations under the License.
 namespace tflite {
 namespace {
 
+using ::testing::ElementsAreArray;
 using ::testing::Pair;
 
 template <class FloatIn, class IntOut>
@@ -273,6 +274,29 @@ TEST(QuantizationUtilTest, CalculateInputRadius) {
   EXPECT_EQ(CalculateInputRadius(4, 2), 503316480);
 }
 
+TEST(QuantizationUtilTest, SymmetricQuantizePerChannel) {
+  // Two outer slices of 2 channels of 2 values each.
+  const float values[] = {0.5,  -0.5, 0.0, 0.25,  //
+                          -2.0, 0.5,  0.1, 0.0};
+  uint8_t quantized[8];
+  float scales[2];
+  SymmetricQuantizePerChannel(values, 8, 2, 2, quantized, scales);
+  EXPECT_FLOAT_EQ(2.0 / 127, scales[0]);
+  EXPECT_FLOAT_EQ(0.25 / 127, scales[1]);
+  EXPECT_THAT(quantized, ElementsAreArray({160, 96, 128, 255,  //
+                                           1, 160, 179, 128}));
+}
+
+TEST(QuantizationUtilTest, SymmetricQuantizePerChannelZeroChannel) {
+  const float values[] = {0.0, 3.0, 0.0, -3.0};
+  uint8_t quantized[4];
+  float scales[2];
+  SymmetricQuantizePerChannel(values, 4, 2, 1, quantized, scales);
+  EXPECT_FLOAT_EQ(1.0, scales[0]);
+  EXPECT_FLOAT_EQ(3.0 / 127, scales[1]);
+  EXPECT_THAT(quantized, ElementsAreArray({128, 255, 128, 1}));
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -103,6 +103,59 @@ void PortableMatrixBatchVectorMultiplyAccumulate(
   }    // for batch
 }
 
+int PortableCountNonZeroBlocks1x4(const float* matrix, int m_rows,
+                                  int m_cols) {
+  int num_blocks = 0;
+  for (int i = 0; i < m_rows * m_cols; i += 4) {
+    if (matrix[i] != 0.0f || matrix[i + 1] != 0.0f || matrix[i + 2] != 0.0f ||
+        matrix[i + 3] != 0.0f) {
+      ++num_blocks;
+    }
+  }
+  return num_blocks;
+}
+
+void PortableDenseToSparse1x4(const float* matrix, int m_rows, int m_cols,
+                              float* blocks, int32_t* block_columns,
+                              int32_t* row_starts) {
+  int num_blocks = 0;
+  for (int r = 0; r < m_rows; ++r) {
+    row_starts[r] = num_blocks;
+    const float* row = matrix + r * m_cols;
+    for (int c = 0; c < m_cols; c += 4) {
+      if (row[c] != 0.0f || row[c + 1] != 0.0f || row[c + 2] != 0.0f ||
+          row[c + 3] != 0.0f) {
+        memcpy(blocks + 4 * num_blocks, row + c, 4 * sizeof(float));
+        block_columns[num_blocks] = c;
+        ++num_blocks;
+      }
+    }
+  }
+  row_starts[m_rows] = num_blocks;
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride) {
+  float* result_in_batch = result;
+  for (int b = 0; b < n_batch; b++) {
+    const float* vector_in_batch = vector + b * m_cols;
+    for (int r = 0; r < m_rows; r++) {
+      float dot_prod = 0.0f;
+      for (int i = row_starts[r]; i < row_starts[r + 1]; ++i) {
+        const float* block = blocks + 4 * i;
+        const float* vector_block = vector_in_batch + block_columns[i];
+        dot_prod += block[0] * vector_block[0] + block[1] * vector_block[1] +
+                    block[2] * vector_block[2] + block[3] * vector_block[3];
+      }
+      *result_in_batch += dot_prod;
+      result_in_batch += result_stride;
+    }
+  }
+}
+
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
                                       float* result) {
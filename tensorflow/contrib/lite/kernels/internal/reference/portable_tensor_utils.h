@@ -44,6 +44,19 @@ void PortableMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ vectors, const float* scaling_factors,
     int n_batch, float* __restrict__ result, int result_stride);
 
+int PortableCountNonZeroBlocks1x4(const float* matrix, int m_rows,
+                                  int m_cols);
+
+void PortableDenseToSparse1x4(const float* matrix, int m_rows, int m_cols,
+                              float* blocks, int32_t* block_columns,
+                              int32_t* row_starts);
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -142,6 +155,27 @@ void MatrixBatchVectorMultiplyAccumulate(
                                               result_stride);
 }
 
+int CountNonZeroBlocks1x4(const float* matrix, int m_rows, int m_cols) {
+  return PortableCountNonZeroBlocks1x4(matrix, m_rows, m_cols);
+}
+
+void DenseToSparse1x4(const float* matrix, int m_rows, int m_cols,
+                      float* blocks, int32_t* block_columns,
+                      int32_t* row_starts) {
+  PortableDenseToSparse1x4(matrix, m_rows, m_cols, blocks, block_columns,
+                           row_starts);
+}
+
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+      blocks, block_columns, row_starts, m_rows, m_cols, vector, n_batch,
+      result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   PortableVectorVectorCwiseProduct(vector1, vector2, v_size, result);
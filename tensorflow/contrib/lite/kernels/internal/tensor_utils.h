@@ -63,6 +63,30 @@ void MatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ vectors, const float* scaling_factors,
     int n_batch, float* __restrict__ result, int result_stride);
 
+// Returns the number of blocks of 4 consecutive values of a row of 'matrix'
+// holding at least one non-zero value. 'm_cols' must be a multiple of 4.
+int CountNonZeroBlocks1x4(const float* matrix, int m_rows, int m_cols);
+
+// Encodes 'matrix' in block-sparse form, keeping only the blocks of 4
+// consecutive values of a row that aren't all zeros. 'blocks' receives the
+// values of those blocks, row after row, 'block_columns' the column of the
+// first value of each block, and 'row_starts' the index of the first block
+// of each row, followed by the number of blocks. They must hold
+// 4 * CountNonZeroBlocks1x4(), CountNonZeroBlocks1x4() and 'm_rows' + 1
+// values. 'm_cols' must be a multiple of 4.
+void DenseToSparse1x4(const float* matrix, int m_rows, int m_cols,
+                      float* blocks, int32_t* block_columns,
+                      int32_t* row_starts);
+
+// Same as MatrixBatchVectorMultiplyAccumulate, for a matrix encoded by
+// DenseToSparse1x4. The zero blocks of the matrix are skipped, which makes
+// the product faster than the dense one for pruned weights.
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ blocks, const int32_t* __restrict__ block_columns,
+    const int32_t* __restrict__ row_starts, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result,
+    int result_stride);
+
 // Cwise product of two vectors.
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result);
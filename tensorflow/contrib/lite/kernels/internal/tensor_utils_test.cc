@@ -126,6 +126,42 @@ TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
                                                -1., 3., 7., 3., 23., 3.})));
 }
 
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Test) {
+  constexpr int kRow = 3;
+  constexpr int kCol = 8;
+  constexpr int kBatch = 2;
+  static float matrix[kRow * kCol] = {1.0, 2.0,  0.0, 0.0, 0.0, 0.0,  0.0, 0.0,
+                                      0.0, 0.0,  0.0, 0.0, 0.0, 0.0,  0.0, 0.0,
+                                      0.0, -1.0, 0.0, 0.0, 3.0, -2.0, 0.0, 1.0};
+  static float vector[kCol * kBatch] = {1.0, -1.0, 1.0, -1.0,
+                                        1.0, -1.0, 1.0, -1.0,  //
+                                        2.0, -2.0, 2.0, -2.0,
+                                        2.0, -2.0, 2.0, -2.0};
+  const int num_blocks = CountNonZeroBlocks1x4(matrix, kRow, kCol);
+  EXPECT_EQ(num_blocks, 3);
+  std::vector<float> blocks(4 * num_blocks);
+  std::vector<int32_t> block_columns(num_blocks);
+  std::vector<int32_t> row_starts(kRow + 1);
+  DenseToSparse1x4(matrix, kRow, kCol, blocks.data(), block_columns.data(),
+                   row_starts.data());
+  EXPECT_THAT(block_columns, ElementsAreArray({0, 0, 4}));
+  EXPECT_THAT(row_starts, ElementsAreArray({0, 1, 1, 3}));
+
+  std::vector<float> output(kRow * kBatch);
+  std::fill(output.begin(), output.end(), 3.0);
+  SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      blocks.data(), block_columns.data(), row_starts.data(), kRow, kCol,
+      vector, kBatch, output.data(), /*result_stride=*/1);
+  std::vector<float> expected_output(kRow * kBatch);
+  std::fill(expected_output.begin(), expected_output.end(), 3.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vector, kBatch,
+                                      expected_output.data(),
+                                      /*result_stride=*/1);
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear({2., 3., 8.,  //
+                                                       1., 3., 13.})));
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected_output)));
+}
+
 TEST(uKernels, MatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
   // Note we use 29 columns as this exercises all the neon kernel: the
   // 16-block SIMD code, the 8-block postamble, and the leftover postamble.
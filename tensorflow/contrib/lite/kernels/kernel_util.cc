@@ -43,6 +43,40 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus GetQuantizedConvolutionMultipliersPerChannel(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias, TfLiteTensor* output,
+    int channel_dimension, std::vector<double>* multipliers) {
+  const TfLitePerChannelQuantization* filter_quantization =
+      filter->per_channel_quantization;
+  TF_LITE_ENSURE(context, filter_quantization != nullptr);
+  TF_LITE_ENSURE_EQ(context, filter_quantization->quantized_dimension,
+                    channel_dimension);
+  const int num_channels = filter_quantization->num_channels;
+  const TfLitePerChannelQuantization* bias_quantization =
+      bias ? bias->per_channel_quantization : nullptr;
+  if (bias) {
+    TF_LITE_ENSURE(context, bias_quantization != nullptr);
+    TF_LITE_ENSURE_EQ(context, bias_quantization->num_channels, num_channels);
+  }
+
+  multipliers->resize(num_channels);
+  for (int c = 0; c < num_channels; ++c) {
+    const double input_product_scale =
+        input->params.scale * filter_quantization->scale[c];
+    if (bias) {
+      const double bias_scale = bias_quantization->scale[c];
+      TF_LITE_ENSURE(context,
+                     std::abs(input_product_scale - bias_scale) <=
+                         1e-6 * std::min(input_product_scale, bias_scale));
+    }
+    TF_LITE_ENSURE(context, input_product_scale >= 0);
+    (*multipliers)[c] = input_product_scale / output->params.scale;
+  }
+
+  return kTfLiteOk;
+}
+
 void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
                                    TfLiteTensor* output, int32_t* act_min,
                                    int32_t* act_max) {
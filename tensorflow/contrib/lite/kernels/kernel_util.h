@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_KERNEL_UTIL_H_
 #define TENSORFLOW_CONTRIB_LITE_KERNELS_KERNEL_UTIL_H_
 
+#include <vector>
+
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 
@@ -86,6 +88,16 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
                                               TfLiteTensor* output,
                                               double* multiplier);
 
+// Calculates the multiplication factors for a quantized convolution (or
+// quantized depthwise convolution) whose filter is quantized per channel along
+// 'channel_dimension', its output channel dimension. The bias, if any, must be
+// quantized per channel too. Returns an error if the filter isn't quantized
+// along that dimension or the scales of the tensors are not compatible.
+TfLiteStatus GetQuantizedConvolutionMultipliersPerChannel(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias, TfLiteTensor* output,
+    int channel_dimension, std::vector<double>* multipliers);
+
 // Calculates the useful range of an activation layer given its activation
 // tensor.
 void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
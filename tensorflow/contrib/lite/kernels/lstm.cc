@@ -24,8 +24,10 @@ limitations under the License.
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/gemm_support.h"
 #include "tensorflow/contrib/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
@@ -42,6 +44,11 @@ struct OpData {
   TfLiteLSTMKernelType kernel_type;
   // Only used by full kernel.
   int scratch_tensor_index;
+  // Only used by the quantized basic kernel: the fixed-point multiplier
+  // taking the int32 accumulators of the internal fully-connected node to its
+  // int16 output.
+  int32_t accum_multiplier;
+  int accum_shift;
 };
 
 // For full inputs kernel (18-inputs).
@@ -798,21 +805,103 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   op_data->kernel_type = kTfLiteLSTMBasicKernel;
   // `scratch_tensor_index` is unused in this kernel.
   op_data->scratch_tensor_index = -1;
+  gemm_support::IncrementUsageCounter(context);
   return op_data;
 }
 
+void Free(TfLiteContext* context, void* buffer) {
+  gemm_support::DecrementUsageCounter(context);
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+// The quantized cell uses fixed formats for most of its arrays, see the
+// comment on LstmCell in reference_ops.h: the activations are uint8 on
+// [-1, 127/128], the output of the internal fully-connected node is int16 on
+// [-8, 8] and the internal state is int16 on [-2^kStateIntegerBits,
+// 2^kStateIntegerBits].
+constexpr float kActivationScale = 1.0f / 128;
+constexpr int32_t kActivationZeroPoint = 128;
+constexpr float kActivationTempScale = 1.0f / 4096;
+constexpr int kStateIntegerBits = 4;
+constexpr float kStateScale = 1.0f / (1 << (15 - kStateIntegerBits));
+
+TfLiteStatus CheckQuantizationParams(TfLiteContext* context,
+                                     const TfLiteTensor* tensor, float scale,
+                                     int32_t zero_point) {
+  if (std::abs(tensor->params.scale - scale) > 1e-6f * scale ||
+      tensor->params.zero_point != zero_point) {
+    context->ReportError(context,
+                         "LSTM tensor %s should be quantized with scale %g and "
+                         "zero point %d, got %g and %d.",
+                         tensor->name, scale, zero_point, tensor->params.scale,
+                         tensor->params.zero_point);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus PrepareQuantized(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input = GetInput(context, node, kInputData);
+  const TfLiteTensor* prev_activation =
+      GetInput(context, node, kInputPrevActivation);
+  const TfLiteTensor* weights = GetInput(context, node, kInputWeights);
+  const TfLiteTensor* bias = GetInput(context, node, kInputBiases);
+  const TfLiteTensor* prev_state = GetInput(context, node, kInputPrevState);
+  TF_LITE_ENSURE_EQ(context, prev_activation->type, kTfLiteUInt8);
+  TF_LITE_ENSURE_EQ(context, weights->type, kTfLiteUInt8);
+  TF_LITE_ENSURE_EQ(context, bias->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, prev_state->type, kTfLiteInt16);
+
+  TfLiteTensor* activation_out = GetOutput(context, node, kOutputActivation);
+  TfLiteTensor* state_out = GetOutput(context, node, kOutputState);
+  TfLiteTensor* concat_temp = GetOutput(context, node, kOutputConcatTemp);
+  TfLiteTensor* activation_temp =
+      GetOutput(context, node, kOutputActivationTemp);
+  TF_LITE_ENSURE_EQ(context, activation_out->type, kTfLiteUInt8);
+  TF_LITE_ENSURE_EQ(context, state_out->type, kTfLiteInt16);
+  TF_LITE_ENSURE_EQ(context, concat_temp->type, kTfLiteUInt8);
+  TF_LITE_ENSURE_EQ(context, activation_temp->type, kTfLiteInt16);
+
+  const std::initializer_list<const TfLiteTensor*> activations = {
+      input, prev_activation, activation_out, concat_temp};
+  for (const TfLiteTensor* tensor : activations) {
+    TF_LITE_ENSURE_OK(context,
+                      CheckQuantizationParams(context, tensor, kActivationScale,
+                                              kActivationZeroPoint));
+  }
+  const std::initializer_list<const TfLiteTensor*> states = {prev_state,
+                                                              state_out};
+  for (const TfLiteTensor* tensor : states) {
+    TF_LITE_ENSURE_OK(
+        context, CheckQuantizationParams(context, tensor, kStateScale, 0));
+  }
+  TF_LITE_ENSURE_OK(context,
+                    CheckQuantizationParams(context, activation_temp,
+                                            kActivationTempScale, 0));
+
+  auto* op_data = reinterpret_cast<OpData*>(node->user_data);
+  const double real_accum_multiplier =
+      static_cast<double>(input->params.scale) * weights->params.scale /
+      kActivationTempScale;
+  QuantizeMultiplier(real_accum_multiplier, &op_data->accum_multiplier,
+                     &op_data->accum_shift);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, node->inputs->size == kInputNum);
   TF_LITE_ENSURE(context, node->outputs->size == kOutputNum);
 
-  // Only Float32 is supported currently.
-  // TODO(ycling): Implement quantize uint8 support.
-  for (int index = 0; index < node->inputs->size; ++index) {
-    TfLiteTensor* tensor = &context->tensors[node->inputs->data[index]];
-    TF_LITE_ENSURE_EQ(context, tensor->type, kTfLiteFloat32);
+  const TfLiteTensor* input = GetInput(context, node, kInputData);
+  if (input->type == kTfLiteUInt8) {
+    TF_LITE_ENSURE_OK(context, PrepareQuantized(context, node));
+  } else {
+    for (int index = 0; index < node->inputs->size; ++index) {
+      TfLiteTensor* tensor = &context->tensors[node->inputs->data[index]];
+      TF_LITE_ENSURE_EQ(context, tensor->type, kTfLiteFloat32);
+    }
   }
 
-  const TfLiteTensor* input = GetInput(context, node, kInputData);
   const TfLiteTensor* prev_activation =
       GetInput(context, node, kInputPrevActivation);
   const TfLiteTensor* weights = GetInput(context, node, kInputWeights);
@@ -876,18 +965,36 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* activation_temp =
       GetOutput(context, node, kOutputActivationTemp);
 
-  optimized_ops::LstmCell(
-      // Inputs.
-      GetTensorData<float>(input), GetTensorDims(input),
-      GetTensorData<float>(prev_activation), GetTensorDims(prev_activation),
-      GetTensorData<float>(weights), GetTensorDims(weights),
-      GetTensorData<float>(bias), GetTensorDims(bias),
-      GetTensorData<float>(prev_state), GetTensorDims(prev_state),
-      // Outputs.
-      GetTensorData<float>(state_out), GetTensorDims(state_out),
-      GetTensorData<float>(activation_out), GetTensorDims(activation_out),
-      GetTensorData<float>(concat_temp), GetTensorDims(concat_temp),
-      GetTensorData<float>(activation_temp), GetTensorDims(activation_temp));
+  if (input->type == kTfLiteUInt8) {
+    const auto* op_data = reinterpret_cast<const OpData*>(node->user_data);
+    optimized_ops::LstmCell<kStateIntegerBits>(
+        // Inputs.
+        GetTensorData<uint8_t>(input), GetTensorDims(input),
+        GetTensorData<uint8_t>(prev_activation), GetTensorDims(prev_activation),
+        GetTensorData<uint8_t>(weights), GetTensorDims(weights),
+        GetTensorData<int32_t>(bias), GetTensorDims(bias),
+        GetTensorData<int16_t>(prev_state), GetTensorDims(prev_state),
+        // Outputs.
+        GetTensorData<int16_t>(state_out), GetTensorDims(state_out),
+        GetTensorData<uint8_t>(activation_out), GetTensorDims(activation_out),
+        GetTensorData<uint8_t>(concat_temp), GetTensorDims(concat_temp),
+        GetTensorData<int16_t>(activation_temp), GetTensorDims(activation_temp),
+        weights->params.zero_point, op_data->accum_multiplier,
+        op_data->accum_shift, gemm_support::GetFromContext(context));
+  } else {
+    optimized_ops::LstmCell(
+        // Inputs.
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(prev_activation), GetTensorDims(prev_activation),
+        GetTensorData<float>(weights), GetTensorDims(weights),
+        GetTensorData<float>(bias), GetTensorDims(bias),
+        GetTensorData<float>(prev_state), GetTensorDims(prev_state),
+        // Outputs.
+        GetTensorData<float>(state_out), GetTensorDims(state_out),
+        GetTensorData<float>(activation_out), GetTensorDims(activation_out),
+        GetTensorData<float>(concat_temp), GetTensorDims(concat_temp),
+        GetTensorData<float>(activation_temp), GetTensorDims(activation_temp));
+  }
 
   // TODO(ycling): Investigate if this copy can be avoided with the 5-inputs
   // LSTM kernel.
@@ -910,7 +1017,14 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   }
 }
 void Free(TfLiteContext* context, void* buffer) {
-  delete reinterpret_cast<OpData*>(buffer);
+  const auto* op_data = reinterpret_cast<const OpData*>(buffer);
+  switch (op_data->kernel_type) {
+    case kTfLiteLSTMFullKernel:
+      delete op_data;
+      return;
+    case kTfLiteLSTMBasicKernel:
+      return basic::Free(context, buffer);
+  }
 }
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
@@ -1432,6 +1432,145 @@ TEST_F(NoCifgPeepholeProjectionClippingLstmTest, HybridLstmBlackBoxTest) {
   VerifyGoldens(lstm_input_, lstm_golden_output_, &lstm, /*tolerance=*/0.00467);
 }
 
+// A 5-input LSTM cell with fused gates, i.e. the basic kernel. The quantized
+// version uses the fixed formats the quantized kernel expects for its
+// activations and state, and 8-bit weights on [-1, 1].
+class BasicLSTMOpModel : public SingleOpModel {
+ public:
+  BasicLSTMOpModel(int n_batch, int n_input, int n_output, bool quantized)
+      : quantized_(quantized) {
+    const TensorData activation =
+        quantized ? TensorData{TensorType_UINT8, {}, 0, 0, 1.0f / 128, 128}
+                  : TensorData{TensorType_FLOAT32};
+    const TensorData state =
+        quantized ? TensorData{TensorType_INT16, {}, 0, 0, 1.0f / 2048, 0}
+                  : TensorData{TensorType_FLOAT32};
+    input_ = AddInput(activation);
+    prev_activation_ = AddInput(activation);
+    weights_ = AddInput(quantized ? TensorData{TensorType_UINT8, {}, -1, 1}
+                                  : TensorData{TensorType_FLOAT32});
+    biases_ = AddInput(
+        quantized
+            ? TensorData{TensorType_INT32, {}, 0, 0,
+                         GetScale(input_) * GetScale(weights_), 0}
+            : TensorData{TensorType_FLOAT32});
+    prev_state_ = AddInput(state);
+
+    activation_ = AddOutput(activation);
+    state_ = AddOutput(state);
+    AddOutput(activation);
+    AddOutput(quantized
+                  ? TensorData{TensorType_INT16, {}, 0, 0, 1.0f / 4096, 0}
+                  : TensorData{TensorType_FLOAT32});
+
+    SetBuiltinOp(BuiltinOperator_LSTM, BuiltinOptions_LSTMOptions,
+                 CreateLSTMOptions(builder_, ActivationFunctionType_TANH,
+                                   /*cell_clip=*/0, /*proj_clip=*/0,
+                                   LSTMKernelType_BASIC)
+                     .Union());
+    BuildInterpreter({{n_batch, n_input},
+                      {n_batch, n_output},
+                      {4 * n_output, n_input + n_output},
+                      {4 * n_output},
+                      {n_batch, n_output}});
+    SetValues(prev_activation_, std::vector<float>(n_batch * n_output, 0));
+    SetValues(prev_state_, std::vector<float>(n_batch * n_output, 0));
+  }
+
+  void SetWeights(const std::vector<float>& f) { SetValues(weights_, f); }
+  void SetBiases(const std::vector<float>& f) { SetValues(biases_, f); }
+  void SetInput(const std::vector<float>& f) { SetValues(input_, f); }
+
+  std::vector<float> GetActivation() { return GetValues(activation_); }
+  std::vector<float> GetState() { return GetValues(state_); }
+
+ private:
+  void SetValues(int index, const std::vector<float>& f) {
+    if (!quantized_) {
+      PopulateTensor(index, 0, f.data(), f.data() + f.size());
+      return;
+    }
+    const TfLiteTensor* t = interpreter_->tensor(index);
+    switch (t->type) {
+      case kTfLiteUInt8: {
+        auto q = Quantize<uint8_t>(f, t->params.scale, t->params.zero_point);
+        PopulateTensor(index, 0, q.data(), q.data() + q.size());
+        break;
+      }
+      case kTfLiteInt16: {
+        auto q = Quantize<int16_t>(f, t->params.scale, t->params.zero_point);
+        PopulateTensor(index, 0, q.data(), q.data() + q.size());
+        break;
+      }
+      default: {
+        auto q = Quantize<int32_t>(f, t->params.scale, t->params.zero_point);
+        PopulateTensor(index, 0, q.data(), q.data() + q.size());
+        break;
+      }
+    }
+  }
+
+  std::vector<float> GetValues(int index) {
+    if (!quantized_) {
+      return ExtractVector<float>(index);
+    }
+    const TfLiteTensor* t = interpreter_->tensor(index);
+    if (t->type == kTfLiteUInt8) {
+      return Dequantize<uint8_t>(ExtractVector<uint8_t>(index),
+                                 t->params.scale, t->params.zero_point);
+    }
+    return Dequantize<int16_t>(ExtractVector<int16_t>(index), t->params.scale,
+                               t->params.zero_point);
+  }
+
+  bool quantized_;
+
+  int input_;
+  int prev_activation_;
+  int weights_;
+  int biases_;
+  int prev_state_;
+  int activation_;
+  int state_;
+};
+
+TEST(BasicLstmTest, QuantizedMatchesFloat) {
+  const int n_batch = 2;
+  const int n_input = 3;
+  const int n_output = 2;
+  // Gates in input, new input, forget, output order, each row reading the
+  // input then the previous activation.
+  const std::vector<float> weights = {
+      0.1,  -0.2, 0.3,  0.4,  -0.5, 0.6,  -0.7, 0.2,  0.8,  -0.1, 0.5,
+      -0.3, 0.2,  0.9,  -0.4, 0.1,  -0.6, 0.3,  0.7,  -0.2, 0.4,  -0.8,
+      0.1,  0.5,  0.3,  0.2,  -0.9, 0.6,  -0.4, 0.7,  0.1,  -0.3};
+  const std::vector<float> biases = {0.1, -0.1, 0.2, 0.0,
+                                     1.0, 1.0,  -0.2, 0.3};
+  const std::vector<std::vector<float>> inputs = {
+      {0.5, -0.25, 0.75, -0.5, 0.25, 0.125},
+      {-0.75, 0.5, 0.25, 0.875, -0.125, -0.5},
+      {0.25, 0.25, -0.5, 0.0, 0.5, -0.875}};
+
+  BasicLSTMOpModel float_lstm(n_batch, n_input, n_output, /*quantized=*/false);
+  BasicLSTMOpModel quantized_lstm(n_batch, n_input, n_output,
+                                  /*quantized=*/true);
+  for (BasicLSTMOpModel* lstm : {&float_lstm, &quantized_lstm}) {
+    lstm->SetWeights(weights);
+    lstm->SetBiases(biases);
+  }
+  for (const auto& input : inputs) {
+    for (BasicLSTMOpModel* lstm : {&float_lstm, &quantized_lstm}) {
+      lstm->SetInput(input);
+      lstm->Invoke();
+    }
+    EXPECT_THAT(quantized_lstm.GetActivation(),
+                ElementsAreArray(
+                    ArrayFloatNear(float_lstm.GetActivation(), 0.03)));
+    EXPECT_THAT(quantized_lstm.GetState(),
+                ElementsAreArray(ArrayFloatNear(float_lstm.GetState(), 0.03)));
+  }
+}
+
 }  // namespace
 }  // namespace tflite
 
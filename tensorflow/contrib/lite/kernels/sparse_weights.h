@@ -0,0 +1,72 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_SPARSE_WEIGHTS_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_SPARSE_WEIGHTS_H_
+
+#include <vector>
+
+#include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
+
+namespace tflite {
+
+// The float weights of an op, as a matrix of 'rows' x 'cols' values in
+// block-sparse form (see tensor_utils::DenseToSparse1x4). Pruned weights,
+// e.g. from contrib/model_pruning, are mostly zeros, and their product with
+// the inputs is faster in this form.
+struct SparseWeights {
+  bool initialized = false;
+  // Whether the weights are sparse enough to be used in this form. Otherwise
+  // the vectors below are empty.
+  bool is_sparse = false;
+  std::vector<float> blocks;
+  std::vector<int32_t> block_columns;
+  std::vector<int32_t> row_starts;
+};
+
+// Weights with at most this fraction of non-zero blocks are used in
+// block-sparse form.
+constexpr float kMaxNonZeroBlockFraction = 0.5f;
+
+// Encodes 'weights', of 'rows' x 'cols' values, in 'sparse' if they are
+// float constants, 'cols' is a multiple of 4 and they are sparse enough. This
+// is only done the first time, as constant weights never change.
+inline void PrepareSparseWeights(const TfLiteTensor* weights, int rows,
+                                 int cols, SparseWeights* sparse) {
+  if (sparse->initialized) return;
+  sparse->initialized = true;
+  if (weights->type != kTfLiteFloat32 ||
+      weights->allocation_type != kTfLiteMmapRo || cols % 4 != 0 ||
+      rows * cols == 0) {
+    return;
+  }
+  const int num_blocks =
+      tensor_utils::CountNonZeroBlocks1x4(weights->data.f, rows, cols);
+  if (num_blocks > kMaxNonZeroBlockFraction * (rows * cols / 4)) {
+    return;
+  }
+  sparse->is_sparse = true;
+  sparse->blocks.resize(4 * num_blocks);
+  sparse->block_columns.resize(num_blocks);
+  sparse->row_starts.resize(rows + 1);
+  tensor_utils::DenseToSparse1x4(weights->data.f, rows, cols,
+                                 sparse->blocks.data(),
+                                 sparse->block_columns.data(),
+                                 sparse->row_starts.data());
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_SPARSE_WEIGHTS_H_
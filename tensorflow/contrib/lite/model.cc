@@ -688,6 +688,7 @@ TfLiteStatus ParseOpData(const Operator* op, BuiltinOperator op_type,
     case BuiltinOperator_FLOOR:
     case BuiltinOperator_GREATER:
     case BuiltinOperator_GREATER_EQUAL:
+    case BuiltinOperator_HARD_SWISH:
     case BuiltinOperator_LESS:
     case BuiltinOperator_LESS_EQUAL:
     case BuiltinOperator_LOG:
@@ -790,21 +791,22 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     TfLiteQuantizationParams quantization;
     quantization.scale = 0;
     quantization.zero_point = 0;
+    // Scales of a tensor quantized per channel. Its per-tensor scale is left
+    // at 0, so that it is never mistaken for a per-tensor quantized tensor.
+    std::vector<float> per_channel_scales;
     auto* q_params = tensor->quantization();
     if (q_params) {
-      // Note that the schema could hold per-channel quantization parameters
-      // but we really only support one value for the whole tensor.
+      // The schema can hold one scale per channel along quantized_dimension,
+      // but a single zero_point shared by all channels.
       // TODO(aselle): This breaks as well if these are nullptr's.
-      // TODO(aselle): This assumes non per-channel quantization.
 
       if (q_params->scale()) {
-        if (q_params->scale()->size() != 1) {
-          error_reporter_->Report(
-              "QuantizationParam has %d scale values (only 1 is supported).",
-              q_params->scale()->size());
-          return kTfLiteError;
+        if (q_params->scale()->size() == 1) {
+          quantization.scale = q_params->scale()->Get(0);
+        } else if (q_params->scale()->size() > 1) {
+          per_channel_scales.assign(q_params->scale()->begin(),
+                                    q_params->scale()->end());
         }
-        quantization.scale = q_params->scale()->Get(0);
       }
 
       if (q_params->zero_point()) {
@@ -878,6 +880,17 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
         status = kTfLiteError;
       }
     }
+
+    if (!per_channel_scales.empty() &&
+        interpreter->SetTensorPerChannelQuantization(
+            i, q_params->quantized_dimension(), per_channel_scales) !=
+            kTfLiteOk) {
+      error_reporter_->Report(
+          "Tensor %d has %d scales, which don't match dimension %d.\n", i,
+          static_cast<int>(per_channel_scales.size()),
+          q_params->quantized_dimension());
+      status = kTfLiteError;
+    }
   }
 
   return status;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/contrib/lite/profiling/time.h"
 
@@ -48,16 +49,7 @@ struct ProfileEvent {
   // Extra data describing the details of the event.
   uint32_t event_metadata;
 };
-}  // namespace profiling
-}  // namespace tflite
-
-#ifdef TFLITE_PROFILING_ENABLED
 
-#include <sys/time.h>
-#include <vector>
-
-namespace tflite {
-namespace profiling {
 constexpr uint32_t kInvalidEventHandle = static_cast<uint32_t>(~0) - 1;
 
 // A ring buffer of profile events.
@@ -142,5 +134,4 @@ class ProfileBuffer {
 };
 }  // namespace profiling
 }  // namespace tflite
-#endif  // TFLITE_PROFILING_ENABLED
 #endif  // TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILE_BUFFER_H_
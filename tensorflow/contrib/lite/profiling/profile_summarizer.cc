@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/profiling/profile_summarizer.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "tensorflow/contrib/lite/schema/schema_generated.h"
@@ -29,6 +30,7 @@ struct OperatorDetails {
   std::string name;
   std::vector<std::string> inputs;
   std::vector<std::string> outputs;
+  int64_t output_bytes;
 };
 
 std::string GetTensorName(const tflite::Interpreter& interpreter,
@@ -65,6 +67,28 @@ std::string ToString(const std::vector<std::string>& str_vector) {
   return stream.str();
 }
 
+// Returns the total size of the tensors in 'tensor_indices'.
+int64_t GetTensorBytes(const tflite::Interpreter& interpreter,
+                       const TfLiteIntArray* tensor_indices) {
+  int64_t bytes = 0;
+  for (int i = 0; i < tensor_indices->size; i++) {
+    const auto tensor = interpreter.tensor(tensor_indices->data[i]);
+    if (tensor != nullptr) {
+      bytes += tensor->bytes;
+    }
+  }
+  return bytes;
+}
+
+// Returns the nearest-rank 'percentile' of the sorted 'values'.
+int64_t Percentile(const std::vector<int64_t>& values, int percentile) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t rank = (values.size() * percentile + 99) / 100;
+  return values[std::max<size_t>(rank, 1) - 1];
+}
+
 OperatorDetails GetOperatorDetails(const tflite::Interpreter& interpreter,
                                    int node_index) {
   auto node_reg = interpreter.node_and_registration(node_index);
@@ -82,13 +106,14 @@ OperatorDetails GetOperatorDetails(const tflite::Interpreter& interpreter,
   details.name = op_name;
   details.inputs = GetTensorNames(interpreter, inputs);
   details.outputs = GetTensorNames(interpreter, outputs);
+  details.output_bytes = GetTensorBytes(interpreter, outputs);
   return details;
 }
 
 tensorflow::StatSummarizerOptions GetProfileSummarizerOptions() {
   auto options = tensorflow::StatSummarizerOptions();
   options.show_summary = true;
-  options.show_memory = false;
+  options.show_memory = true;
   return options;
 }
 
@@ -120,7 +145,8 @@ void ProfileSummarizer::ProcessProfiles(
   int64_t base_start_us = events[0]->begin_timestamp_us;
   int node_num = 0;
   int64_t curr_total_us = 0;
-  std::map<std::string, Detail> details;
+  // Accumulate the stats of this run with the ones of the previous runs.
+  std::map<std::string, Detail> details = stats_calculator_->GetDetails();
   for (auto event : events) {
     auto op_details = GetOperatorDetails(interpreter, event->event_metadata);
     auto node_name = ToString(op_details.outputs);
@@ -130,6 +156,8 @@ void ProfileSummarizer::ProcessProfiles(
     int64_t node_exec_time =
         event->end_timestamp_us - event->begin_timestamp_us;
     detail->rel_end_us.UpdateStat(node_exec_time);
+    detail->mem_used.UpdateStat(op_details.output_bytes);
+    latencies_us_[node_name].push_back(node_exec_time);
     curr_total_us += node_exec_time;
     ++node_num;
 
@@ -144,5 +172,33 @@ void ProfileSummarizer::ProcessProfiles(
   stats_calculator_->UpdateDetails(details);
   stats_calculator_->UpdateRunTotalUs(curr_total_us);
 }
+
+std::string ProfileSummarizer::GetCsvString() const {
+  std::vector<const Detail*> details;
+  for (const auto& detail : stats_calculator_->GetDetails()) {
+    details.push_back(&detail.second);
+  }
+  std::sort(details.begin(), details.end(),
+            [](const Detail* a, const Detail* b) {
+              return a->run_order < b->run_order;
+            });
+
+  std::stringstream stream;
+  stream << "run_order,type,name,times_called,first_us,avg_us,min_us,p50_us,"
+            "p90_us,p99_us,max_us,output_bytes\n";
+  for (const Detail* detail : details) {
+    std::vector<int64_t> latencies = latencies_us_.at(detail->name);
+    std::sort(latencies.begin(), latencies.end());
+    stream << detail->run_order << "," << detail->type << ",\""
+           << detail->name << "\"," << detail->times_called << ","
+           << detail->rel_end_us.first() << "," << detail->rel_end_us.avg()
+           << "," << detail->rel_end_us.min() << ","
+           << Percentile(latencies, 50) << "," << Percentile(latencies, 90)
+           << "," << Percentile(latencies, 99) << ","
+           << detail->rel_end_us.max() << "," << detail->mem_used.newest()
+           << "\n";
+  }
+  return stream.str();
+}
 }  // namespace profiling
 }  // namespace tflite
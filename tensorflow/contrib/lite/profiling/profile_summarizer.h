@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILE_SUMMARIZER_H_
 #define TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILE_SUMMARIZER_H_
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include "tensorflow/contrib/lite/interpreter.h"
@@ -45,8 +47,16 @@ class ProfileSummarizer {
     return stats_calculator_->GetShortSummary();
   }
 
+  // Returns the accumulated stats of every operator, in run order, as CSV
+  // with a header line. The latencies are in microseconds, and include the
+  // 50th, 90th and 99th percentiles over the runs. The memory is the size of
+  // the outputs of the operator, in bytes.
+  std::string GetCsvString() const;
+
  private:
   std::unique_ptr<tensorflow::StatsCalculator> stats_calculator_;
+  // The latency of every invocation of each operator, by operator name.
+  std::map<std::string, std::vector<int64_t>> latencies_us_;
 };
 
 }  // namespace profiling
@@ -82,7 +82,6 @@ TEST(ProfileSummarizerTest, Empty) {
   EXPECT_GT(output.size(), 0);
 }
 
-#ifdef TFLITE_PROFILING_ENABLED
 TEST(ProfileSummarizerTest, Interpreter) {
   Profiler profiler;
   SimpleOpModel m;
@@ -103,7 +102,34 @@ TEST(ProfileSummarizerTest, Interpreter) {
   // TODO(shashishekhar): Add a better test here.
   ASSERT_TRUE(output.find("SimpleOp") != std::string::npos) << output;
 }
-#endif
+
+TEST(ProfileSummarizerTest, CsvAccumulatesRuns) {
+  Profiler profiler;
+  SimpleOpModel m;
+  m.Init();
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  ProfileSummarizer summarizer;
+  for (int run = 0; run < 2; ++run) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    m.SetInputs(1, 2);
+    m.Invoke();
+    profiler.StopProfiling();
+    summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  }
+  std::string csv = summarizer.GetCsvString();
+  std::string header = csv.substr(0, csv.find('\n'));
+  EXPECT_EQ(
+      "run_order,type,name,times_called,first_us,avg_us,min_us,p50_us,p90_us,"
+      "p99_us,max_us,output_bytes",
+      header);
+  // One line for the only op, which was called once in each run.
+  std::string line = csv.substr(header.size() + 1);
+  ASSERT_EQ(0, line.find("1,SimpleOp")) << csv;
+  std::string times_called = line.substr(line.find("\",") + 2);
+  EXPECT_EQ("2", times_called.substr(0, times_called.find(','))) << csv;
+}
 
 }  // namespace
 }  // namespace profiling
@@ -19,8 +19,6 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/profiling/profile_buffer.h"
 
-#ifdef TFLITE_PROFILING_ENABLED
-
 namespace tflite {
 namespace profiling {
 class ScopedProfile;
@@ -31,6 +29,10 @@ class ScopedOperatorProfile;
 // kept as simple as possible. It is designed to be used only on a single
 // thread.
 //
+// Profiling is always compiled in, but an interpreter only records events
+// while a profiler is set with Interpreter::SetProfiler(), and otherwise pays
+// a single null check per op.
+//
 // Profiles are collected using Scoped*Profile objects that begin and end a
 // profile event.
 // An example usage is shown in the example below:
@@ -156,24 +158,5 @@ class ScopedOperatorProfile {
 #define SCOPED_OPERATOR_PROFILE(profiler, node_index)    \
   tflite::profiling::ScopedOperatorProfile VARNAME_UNIQ( \
       _profile_, __COUNTER__)((profiler), "OpInvoke", (node_index))
-#else
-
-namespace tflite {
-namespace profiling {
-// A noop version of profiler when profiling is disabled.
-class Profiler {
- public:
-  Profiler() {}
-  void StartProfiling() {}
-  void StopProfiling() {}
-  void Reset() {}
-  std::vector<const ProfileEvent*> GetProfileEvents() { return {}; }
-};
-}  // namespace profiling
-}  // namespace tflite
-
-#define SCOPED_OPERATOR_PROFILE(profiler, node_index)
-
-#endif  // TFLITE_PROFILING_ENABLED
 
 #endif  // TENSORFLOW_CONTRIB_LITE_PROFILING_PROFILER_H_
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/simple_memory_arena.h"
 
+#include <algorithm>
 #include <cstring>
 #include <limits>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -100,31 +102,56 @@ TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
   return kTfLiteOk;
 }
 
-TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
-  size_t required_size = RequiredBufferSize();
-  if (required_size > underlying_buffer_size_) {
-    char* new_alloc = new char[required_size];
-    char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
-        AlignTo(arena_alignment_, reinterpret_cast<intptr_t>(new_alloc)));
+TfLiteStatus ArenaBuffer::Reserve(size_t alignment, size_t size) {
+  // A buffer shared with an arena of a smaller alignment may need to move.
+  if (size > size_ ||
+      reinterpret_cast<intptr_t>(aligned_ptr_) % alignment != 0) {
+    size = std::max(size, size_);
+    char* new_alloc = new char[size];
+    char* new_aligned_ptr = reinterpret_cast<char*>(
+        AlignTo(alignment, reinterpret_cast<intptr_t>(new_alloc)));
 
-    // If the arena had been previously allocated, copy over the old memory.
+    // If the buffer had been previously allocated, copy over the old memory.
     // Since Alloc pointers are offset based, they will remain valid in the new
     // memory block.
-    if (high_water_mark_ > 0 && underlying_buffer_size_ > 0) {
-      size_t copy_amount = std::min(
-          underlying_buffer_.get() + underlying_buffer_size_ -
-              underlying_buffer_aligned_ptr_,
-          new_alloc + required_size - new_underlying_buffer_aligned_ptr);
-      memcpy(new_underlying_buffer_aligned_ptr, underlying_buffer_aligned_ptr_,
-             copy_amount);
+    if (size_ > 0) {
+      size_t copy_amount =
+          std::min(buffer_.get() + size_ - aligned_ptr_,
+                   new_alloc + size - new_aligned_ptr);
+      memcpy(new_aligned_ptr, aligned_ptr_, copy_amount);
     }
 
-    underlying_buffer_.reset(new_alloc);
-    underlying_buffer_size_ = required_size;
-    underlying_buffer_aligned_ptr_ = new_underlying_buffer_aligned_ptr;
+    buffer_.reset(new_alloc);
+    size_ = size;
+    aligned_ptr_ = new_aligned_ptr;
+    for (const auto& callback : move_callbacks_) {
+      callback.second();
+    }
   }
+  return buffer_ != nullptr ? kTfLiteOk : kTfLiteError;
+}
+
+void ArenaBuffer::RemoveMoveCallback(const void* owner) {
+  for (auto it = move_callbacks_.begin(); it != move_callbacks_.end(); ++it) {
+    if (it->first == owner) {
+      move_callbacks_.erase(it);
+      return;
+    }
+  }
+}
+
+TfLiteStatus SimpleMemoryArena::SetBuffer(TfLiteContext* context,
+                                          std::shared_ptr<ArenaBuffer> buffer) {
+  TF_LITE_ENSURE(context, !committed_);
+  TF_LITE_ENSURE(context, buffer != nullptr);
+  buffer_ = std::move(buffer);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
+  TF_LITE_ENSURE_STATUS(buffer_->Reserve(arena_alignment_, RequiredBufferSize()));
   committed_ = true;
-  return underlying_buffer_ != nullptr ? kTfLiteOk : kTfLiteError;
+  return kTfLiteOk;
 }
 
 TfLiteStatus SimpleMemoryArena::ResolveAlloc(TfLiteContext* context,
@@ -135,7 +162,7 @@ TfLiteStatus SimpleMemoryArena::ResolveAlloc(TfLiteContext* context,
   if (alloc.size == 0) {
     *output_ptr = nullptr;
   } else {
-    *output_ptr = underlying_buffer_aligned_ptr_ + alloc.offset;
+    *output_ptr = buffer_->aligned_ptr() + alloc.offset;
   }
   return kTfLiteOk;
 }
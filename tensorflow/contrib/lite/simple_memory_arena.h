@@ -15,8 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_SIMPLE_MEMORY_ARENA_H_
 #define TENSORFLOW_CONTRIB_LITE_SIMPLE_MEMORY_ARENA_H_
 
+#include <functional>
 #include <list>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "tensorflow/contrib/lite/context.h"
 
 namespace tflite {
@@ -36,6 +39,37 @@ struct ArenaAlloc {
   }
 };
 
+// The buffer that backs a SimpleMemoryArena. A buffer may be shared by the
+// arenas of several interpreters, as long as they are never invoked
+// concurrently (e.g. models that run one after the other): it then only needs
+// to be as large as the largest of them.
+class ArenaBuffer {
+ public:
+  ArenaBuffer() : size_(0), aligned_ptr_(nullptr) {}
+
+  // Grows the buffer to at least 'size' bytes, of which up to 'alignment'
+  // bytes are used for aligning it. The contents are preserved, but the
+  // buffer may move, in which case the move callbacks are called.
+  TfLiteStatus Reserve(size_t alignment, size_t size);
+
+  char* aligned_ptr() const { return aligned_ptr_; }
+
+  // Registers 'on_move' to be called after the buffer moves, so that the
+  // users of the buffer can update their pointers into it. 'owner' identifies
+  // the callback for RemoveMoveCallback().
+  void AddMoveCallback(const void* owner, std::function<void()> on_move) {
+    move_callbacks_.emplace_back(owner, std::move(on_move));
+  }
+
+  void RemoveMoveCallback(const void* owner);
+
+ private:
+  std::unique_ptr<char[]> buffer_;
+  size_t size_;
+  char* aligned_ptr_;
+  std::vector<std::pair<const void*, std::function<void()>>> move_callbacks_;
+};
+
 // This small class is responsible for allocating, deallocating and reusing
 // dynamic memory from a common underlying buffer. The arena can be used in
 // scenarios when the pattern of memory allocations and deallocations is
@@ -47,14 +81,29 @@ class SimpleMemoryArena {
       : committed_(false),
         arena_alignment_(arena_alignment),
         high_water_mark_(0),
-        underlying_buffer_size_(0),
+        buffer_(new ArenaBuffer),
         allocs_() {}
 
+  // Makes the arena use 'buffer', which may be shared with other arenas,
+  // instead of a buffer of its own. Must be called before Commit().
+  TfLiteStatus SetBuffer(TfLiteContext* context,
+                         std::shared_ptr<ArenaBuffer> buffer);
+
   TfLiteStatus Allocate(TfLiteContext* context, size_t alignment, size_t size,
                         ArenaAlloc* new_alloc);
 
   TfLiteStatus Deallocate(TfLiteContext* context, const ArenaAlloc& alloc);
 
+  // The size of the arena needed by the allocations so far.
+  size_t high_water_mark() const { return high_water_mark_; }
+
+  // Makes the arena at least 'size' bytes large, for allocations whose offsets
+  // were computed ahead of time instead of by Allocate(). Must be called
+  // before Commit().
+  void ReserveHighWaterMark(size_t size) {
+    if (size > high_water_mark_) high_water_mark_ = size;
+  }
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
@@ -70,16 +119,14 @@ class SimpleMemoryArena {
   TfLiteStatus Clear();
 
   int64_t BasePointer() const {
-    return reinterpret_cast<int64_t>(underlying_buffer_aligned_ptr_);
+    return reinterpret_cast<int64_t>(buffer_->aligned_ptr());
   }
 
  private:
   bool committed_;
   size_t arena_alignment_;
   size_t high_water_mark_;
-  std::unique_ptr<char[]> underlying_buffer_;
-  size_t underlying_buffer_size_;
-  char* underlying_buffer_aligned_ptr_;
+  std::shared_ptr<ArenaBuffer> buffer_;
   // TODO(maciekc): add list iterator to the ArenaAlloc to lookup quickly.
   std::list<ArenaAlloc> allocs_;
 };
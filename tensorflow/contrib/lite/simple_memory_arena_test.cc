@@ -123,6 +123,44 @@ TEST(SimpleMemoryArenaTest, TestAfterClear) {
   EXPECT_EQ(allocs[8].offset, 8192);
 }
 
+TEST(SimpleMemoryArenaTest, SharedBuffer) {
+  TfLiteContext context;
+  auto buffer = std::make_shared<ArenaBuffer>();
+  int num_moves = 0;
+  buffer->AddMoveCallback(&num_moves, [&num_moves]() { ++num_moves; });
+  SimpleMemoryArena small_arena(64);
+  SimpleMemoryArena large_arena(64);
+  ASSERT_EQ(small_arena.SetBuffer(&context, buffer), kTfLiteOk);
+  ASSERT_EQ(large_arena.SetBuffer(&context, buffer), kTfLiteOk);
+  ArenaAlloc small_alloc;
+  ArenaAlloc large_alloc;
+
+  ASSERT_EQ(small_arena.Allocate(&context, 32, 1023, &small_alloc), kTfLiteOk);
+  ASSERT_EQ(small_arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(num_moves, 1);
+  char* small_ptr = nullptr;
+  ASSERT_EQ(small_arena.ResolveAlloc(&context, small_alloc, &small_ptr),
+            kTfLiteOk);
+  small_ptr[1022] = 42;
+
+  // Growing the buffer for the larger arena preserves the contents.
+  ASSERT_EQ(large_arena.Allocate(&context, 32, 4095, &large_alloc), kTfLiteOk);
+  ASSERT_EQ(large_arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(num_moves, 2);
+  EXPECT_EQ(small_arena.BasePointer(), large_arena.BasePointer());
+  ASSERT_EQ(small_arena.ResolveAlloc(&context, small_alloc, &small_ptr),
+            kTfLiteOk);
+  EXPECT_EQ(small_ptr[1022], 42);
+
+  // The buffer is large enough for both arenas now.
+  small_arena.Clear();
+  ASSERT_EQ(small_arena.Allocate(&context, 32, 2047, &small_alloc), kTfLiteOk);
+  ASSERT_EQ(small_arena.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(num_moves, 2);
+
+  buffer->RemoveMoveCallback(&num_moves);
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -235,6 +235,7 @@ struct ParsedTocoFlags {
   Arg<bool> reorder_across_fake_quant = Arg<bool>(false);
   Arg<bool> allow_custom_ops = Arg<bool>(false);
   Arg<bool> quantize_weights = Arg<bool>(false);
+  Arg<bool> quantize_conv_weights_per_channel = Arg<bool>(false);
   // Deprecated flags
   Arg<string> input_type;
   Arg<string> input_types;
@@ -15,9 +15,11 @@ limitations under the License.
 #include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -127,8 +129,63 @@ void DiscardUselessConnectedComponentsAndRNNBackEdges(Model* model) {
   }
 }
 
+// Tracks the operators at which every graph transformation was tried without
+// making a change, so that later passes only revisit the operators around the
+// changes made since, instead of rescanning the whole graph. An operator is
+// identified by its address together with a fingerprint of its type and
+// connections, so that an operator rewired in place, or a new one allocated
+// where a deleted one was, gets visited again.
+class SettledOperators {
+ public:
+  bool empty() const { return fingerprints_.empty(); }
+  void Clear() { fingerprints_.clear(); }
+
+  bool Contains(const Operator& op) const {
+    const auto it = fingerprints_.find(&op);
+    return it != fingerprints_.end() && it->second == Fingerprint(op);
+  }
+
+  void Insert(const Operator& op) { fingerprints_[&op] = Fingerprint(op); }
+
+  // Forgets the operators reading or writing any of 'arrays'.
+  void EraseNeighbors(const Model& model,
+                      const std::unordered_set<string>& arrays) {
+    for (const auto& op : model.operators) {
+      bool touches_arrays = false;
+      for (const string& input : op->inputs) {
+        touches_arrays |= arrays.count(input) > 0;
+      }
+      for (const string& output : op->outputs) {
+        touches_arrays |= arrays.count(output) > 0;
+      }
+      if (touches_arrays) {
+        fingerprints_.erase(op.get());
+      }
+    }
+  }
+
+ private:
+  static std::size_t Fingerprint(const Operator& op) {
+    std::hash<string> hash;
+    std::size_t fingerprint = static_cast<std::size_t>(op.type);
+    const auto combine = [&fingerprint, &hash](const string& name) {
+      fingerprint ^= hash(name) + 0x9e3779b9 + (fingerprint << 6) +
+                     (fingerprint >> 2);
+    };
+    for (const string& input : op.inputs) combine(input);
+    combine("->");
+    for (const string& output : op.outputs) combine(output);
+    return fingerprint;
+  }
+
+  // The addresses of the settled operators are never dereferenced, so
+  // entries for deleted operators are harmless.
+  std::unordered_map<const Operator*, std::size_t> fingerprints_;
+};
+
 bool GraphTransformationsPass(int increment, Model* model,
-                              const GraphTransformationsSet& transformations) {
+                              const GraphTransformationsSet& transformations,
+                              SettledOperators* settled) {
   CHECK(increment == 1 || increment == -1);
   bool changed = false;
   if (model->operators.empty()) {
@@ -138,35 +195,47 @@ bool GraphTransformationsPass(int increment, Model* model,
   int op_index = increment == 1 ? 0 : model->operators.size() - 1;
   while (true) {
     bool changed_now = false;
-    // Loop over all transformations at the current position in the graph.
-    for (const auto& transformation : transformations) {
-      CHECK(!changed_now);
-      CHECK(transformation->Messages().empty());
-      changed_now = transformation->Run(model, op_index);
-      const char* made_a_change_msg =
-          changed_now ? "made a change" : "did NOT make a change";
-      const int log_level =
-          changed_now ? kLogLevelModelChanged : kLogLevelModelUnchanged;
-      if (transformation->Messages().empty()) {
-        VLOG(log_level) << transformation->Name() << " " << made_a_change_msg
-                        << " at op_index=" << op_index << "/"
-                        << model->operators.size() - 1;
-      }
-      for (const string& message : transformation->Messages()) {
-        VLOG(log_level) << transformation->Name() << " " << made_a_change_msg
-                        << " at op_index=" << op_index << "/"
-                        << model->operators.size() - 1 << ": " << message;
-      }
-      transformation->ClearMessages();
-      if (changed_now) {
-        DumpGraphvizVideoFrame(*model);
-        if (model->operators.empty()) return true;
-        op_index = std::min<int>(op_index, model->operators.size() - 1);
-        // Uncomment for debugging
-        // CheckInvariants(*model);
+    const Operator& op = *model->operators[op_index];
+    if (!settled->Contains(op)) {
+      // The transformations may delete 'op', so remember what it touches.
+      std::unordered_set<string> touched_arrays(op.inputs.begin(),
+                                                op.inputs.end());
+      touched_arrays.insert(op.outputs.begin(), op.outputs.end());
+      // Loop over all transformations at the current position in the graph.
+      for (const auto& transformation : transformations) {
+        CHECK(!changed_now);
+        CHECK(transformation->Messages().empty());
+        changed_now = transformation->Run(model, op_index);
+        const char* made_a_change_msg =
+            changed_now ? "made a change" : "did NOT make a change";
+        const int log_level =
+            changed_now ? kLogLevelModelChanged : kLogLevelModelUnchanged;
+        if (transformation->Messages().empty()) {
+          VLOG(log_level) << transformation->Name() << " " << made_a_change_msg
+                          << " at op_index=" << op_index << "/"
+                          << model->operators.size() - 1;
+        }
+        for (const string& message : transformation->Messages()) {
+          VLOG(log_level) << transformation->Name() << " " << made_a_change_msg
+                          << " at op_index=" << op_index << "/"
+                          << model->operators.size() - 1 << ": " << message;
+        }
+        transformation->ClearMessages();
+        if (changed_now) {
+          DumpGraphvizVideoFrame(*model);
+          if (model->operators.empty()) return true;
+          op_index = std::min<int>(op_index, model->operators.size() - 1);
+          // Uncomment for debugging
+          // CheckInvariants(*model);
+        }
+        if (changed_now) {
+          break;
+        }
       }
       if (changed_now) {
-        break;
+        settled->EraseNeighbors(*model, touched_arrays);
+      } else {
+        settled->Insert(op);
       }
     }
     if (changed_now) {
@@ -189,9 +258,21 @@ bool GraphTransformationsPass(int increment, Model* model,
 void RunGraphTransformations(Model* model, const string& msg,
                              const GraphTransformationsSet& transformations) {
   PrintModelStats(toco::port::StringF("Before %s", msg), *model);
+  SettledOperators settled;
   int pass_index = 0;
-  while (GraphTransformationsPass((pass_index % 2) ? -1 : 1, model,
-                                  transformations)) {
+  while (true) {
+    const bool full_pass = settled.empty();
+    if (!GraphTransformationsPass((pass_index % 2) ? -1 : 1, model,
+                                  transformations, &settled)) {
+      if (full_pass) {
+        break;
+      }
+      // Changes may enable transformations beyond the operators around them,
+      // e.g. through array attributes, so a fixed point is only reached once
+      // a pass over every operator changes nothing.
+      settled.Clear();
+      continue;
+    }
     pass_index++;
     const auto& label =
         toco::port::StringF("After %s pass %d", msg, pass_index);
@@ -133,6 +133,7 @@ DECLARE_GRAPH_TRANSFORMATION(MergeLstmCellInputs)
 DECLARE_GRAPH_TRANSFORMATION(MergeReshapeIntoPrecedingTranspose)
 DECLARE_GRAPH_TRANSFORMATION(IdentifyRelu1)
 DECLARE_GRAPH_TRANSFORMATION(IdentifyPRelu)
+DECLARE_GRAPH_TRANSFORMATION(IdentifyHardSwish)
 DECLARE_GRAPH_TRANSFORMATION(IdentifyDilatedConv)
 DECLARE_GRAPH_TRANSFORMATION(MakeInitialDequantizeOperator)
 DECLARE_GRAPH_TRANSFORMATION(PropagateActivationFunctionIntoConstants)
@@ -140,7 +141,6 @@ DECLARE_GRAPH_TRANSFORMATION(PropagateArrayDataTypes)
 DECLARE_GRAPH_TRANSFORMATION(PropagateFakeQuantNumBits);
 DECLARE_GRAPH_TRANSFORMATION(PropagateFixedSizes)
 DECLARE_GRAPH_TRANSFORMATION(HardcodeMinMax)
-DECLARE_GRAPH_TRANSFORMATION(Quantize)
 DECLARE_GRAPH_TRANSFORMATION(QuantizeWeights)
 DECLARE_GRAPH_TRANSFORMATION(RemoveFinalDequantizeOp)
 DECLARE_GRAPH_TRANSFORMATION(RemoveTensorFlowAssert)
@@ -250,6 +250,24 @@ class ResolveConstantFakeQuant : public GraphTransformation {
   bool propagate_fake_quant_num_bits_ = false;
 };
 
+class Quantize : public GraphTransformation {
+ public:
+  bool Run(Model* model, std::size_t op_index) override;
+  const char* Name() const override { return "Quantize"; }
+
+  // Whether to quantize the constant weights of Conv and DepthwiseConv
+  // symmetrically with one scale per output channel, and their bias to match.
+  bool quantize_weights_per_channel() const {
+    return quantize_weights_per_channel_;
+  }
+  void set_quantize_weights_per_channel(bool val) {
+    quantize_weights_per_channel_ = val;
+  }
+
+ private:
+  bool quantize_weights_per_channel_ = false;
+};
+
 class EnsureUint8WeightsSafeForFastInt8Kernels : public GraphTransformation {
  public:
   bool Run(Model* model, std::size_t op_index) override;
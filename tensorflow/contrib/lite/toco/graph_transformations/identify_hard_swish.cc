@@ -0,0 +1,203 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+// This transformation rule tries to identify the hard-swish activation of
+// MobileNetV3-style models and convert it to a single op:
+//
+// f(x) = x * Relu6(x + 3) / 6
+//
+// TensorFlow graphs spell it out as four elementwise ops, each reading and
+// writing a whole activation array. By the time this rule runs, the Relu6 has
+// been fused into the Add, so we're looking for either of:
+//
+// f(x) = (x * Add(x, 3, activation=Relu6)) * (1/6)
+// f(x) = x * (Add(x, 3, activation=Relu6) * (1/6))
+//
+// where the operands of the Muls may come in either order, and a division by
+// 6 may stand for the multiplication by 1/6.
+
+namespace toco {
+
+namespace {
+
+bool IsScalarFloatNear(const Model& model, const string& name, float value) {
+  if (!IsConstantParameterArray(model, name)) {
+    return false;
+  }
+  const auto& array = model.GetArray(name);
+  if (array.data_type != ArrayDataType::kFloat ||
+      RequiredBufferSizeForShape(array.shape()) != 1) {
+    return false;
+  }
+  const float array_value = array.GetBuffer<ArrayDataType::kFloat>().data[0];
+  return std::abs(array_value - value) <= 1e-6f * std::abs(value);
+}
+
+// Returns the op producing 'name' if it is of 'type', has no fused
+// activation function other than 'activation', and its output isn't needed by
+// anything else than the matched subgraph.
+Operator* GetIntermediateOp(const Model& model, const string& name,
+                            OperatorType type,
+                            FusedActivationFunctionType activation) {
+  Operator* op = GetOpWithOutput(model, name);
+  if (op == nullptr || op->type != type || op->inputs.size() != 2 ||
+      op->fused_activation_function != activation ||
+      CountOpsWithInput(model, name) != 1 ||
+      !IsDiscardableArray(model, name)) {
+    return nullptr;
+  }
+  return op;
+}
+
+// If 'name' is the output of a multiplication by 1/6 or a division by 6,
+// returns the array being scaled and appends the op to 'ops'.
+bool GetArrayScaledBySixth(const Model& model, const string& name,
+                           string* scaled, std::vector<Operator*>* ops) {
+  Operator* mul_op = GetIntermediateOp(model, name, OperatorType::kMul,
+                                       FusedActivationFunctionType::kNone);
+  if (mul_op != nullptr) {
+    for (int i = 0; i < 2; ++i) {
+      if (IsScalarFloatNear(model, mul_op->inputs[i], 1.0f / 6.0f)) {
+        *scaled = mul_op->inputs[1 - i];
+        ops->push_back(mul_op);
+        return true;
+      }
+    }
+    return false;
+  }
+  Operator* div_op = GetIntermediateOp(model, name, OperatorType::kDiv,
+                                       FusedActivationFunctionType::kNone);
+  if (div_op != nullptr && IsScalarFloatNear(model, div_op->inputs[1], 6.0f)) {
+    *scaled = div_op->inputs[0];
+    ops->push_back(div_op);
+    return true;
+  }
+  return false;
+}
+
+// If 'name' is the output of Add(x, 3, activation=Relu6), returns x and
+// appends the op to 'ops'.
+bool GetShiftedRelu6Input(const Model& model, const string& name,
+                          string* input, std::vector<Operator*>* ops) {
+  Operator* add_op = GetIntermediateOp(model, name, OperatorType::kAdd,
+                                       FusedActivationFunctionType::kRelu6);
+  if (add_op == nullptr) {
+    return false;
+  }
+  for (int i = 0; i < 2; ++i) {
+    if (IsScalarFloatNear(model, add_op->inputs[i], 3.0f)) {
+      *input = add_op->inputs[1 - i];
+      ops->push_back(add_op);
+      return true;
+    }
+  }
+  return false;
+}
+
+// If 'name' is the output of x * Relu6(x + 3), returns x and appends the ops
+// to 'ops'.
+bool GetProductWithShiftedRelu6Input(const Model& model, const string& name,
+                                     string* input,
+                                     std::vector<Operator*>* ops) {
+  Operator* mul_op = GetIntermediateOp(model, name, OperatorType::kMul,
+                                       FusedActivationFunctionType::kNone);
+  if (mul_op == nullptr) {
+    return false;
+  }
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Operator*> add_ops;
+    string relu6_input;
+    if (GetShiftedRelu6Input(model, mul_op->inputs[i], &relu6_input,
+                             &add_ops) &&
+        relu6_input == mul_op->inputs[1 - i]) {
+      *input = relu6_input;
+      ops->push_back(mul_op);
+      ops->insert(ops->end(), add_ops.begin(), add_ops.end());
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool IdentifyHardSwish::Run(Model* model, std::size_t op_index) {
+  const auto op_it = model->operators.begin() + op_index;
+  auto* final_op = op_it->get();
+  if ((final_op->type != OperatorType::kMul &&
+       final_op->type != OperatorType::kDiv) ||
+      final_op->inputs.size() != 2 || final_op->outputs.size() != 1 ||
+      final_op->fused_activation_function !=
+          FusedActivationFunctionType::kNone) {
+    return false;
+  }
+
+  // The ops of the subgraph other than 'final_op', consumers first.
+  std::vector<Operator*> intermediate_ops;
+  string input;
+  bool matched = false;
+  if (final_op->type == OperatorType::kDiv) {
+    // (x * Relu6(x + 3)) / 6
+    matched = IsScalarFloatNear(*model, final_op->inputs[1], 6.0f) &&
+              GetProductWithShiftedRelu6Input(*model, final_op->inputs[0],
+                                              &input, &intermediate_ops);
+  } else {
+    for (int i = 0; i < 2 && !matched; ++i) {
+      intermediate_ops.clear();
+      if (IsScalarFloatNear(*model, final_op->inputs[i], 1.0f / 6.0f)) {
+        // (x * Relu6(x + 3)) * (1/6)
+        matched = GetProductWithShiftedRelu6Input(
+            *model, final_op->inputs[1 - i], &input, &intermediate_ops);
+      } else {
+        // x * (Relu6(x + 3) * (1/6))
+        string scaled;
+        matched = GetArrayScaledBySixth(*model, final_op->inputs[i], &scaled,
+                                        &intermediate_ops) &&
+                  GetShiftedRelu6Input(*model, scaled, &input,
+                                       &intermediate_ops) &&
+                  input == final_op->inputs[1 - i];
+      }
+    }
+  }
+  if (!matched) {
+    return false;
+  }
+
+  auto* hard_swish_op = new HardSwishOperator;
+  hard_swish_op->inputs = {input};
+  hard_swish_op->outputs = final_op->outputs;
+  model->operators.emplace(op_it, hard_swish_op);
+  AddMessageF("Creating %s replacing equivalent subgraph",
+              LogName(*hard_swish_op));
+
+  // The input is still consumed by the new op, so only the intermediate and
+  // constant arrays are deleted along with the ops.
+  DeleteOpAndArraysIfUnused(model, final_op);
+  for (Operator* op : intermediate_ops) {
+    DeleteOpAndArraysIfUnused(model, op);
+  }
+  return true;
+}
+
+}  // namespace toco
@@ -12,7 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
 #include "tensorflow/contrib/lite/toco/graph_transformations/quantization_util.h"
@@ -191,6 +194,83 @@ void QuantizeArray(GraphTransformation* transformation, Model* model,
   }
 }
 
+void QuantizeArrayPerChannel(GraphTransformation* transformation, Model* model,
+                             const string& name, int quantized_dimension) {
+  auto& array = model->GetArray(name);
+  CHECK(array.data_type == ArrayDataType::kFloat);
+  CHECK(!array.quantization_params);
+  const Shape& shape = array.shape();
+  CHECK_GE(quantized_dimension, 0);
+  CHECK_LT(quantized_dimension, shape.dimensions_count());
+  const int num_channels = shape.dims(quantized_dimension);
+  int inner_size = 1;
+  for (int i = quantized_dimension + 1; i < shape.dimensions_count(); i++) {
+    inner_size *= shape.dims(i);
+  }
+
+  const auto& float_data = array.GetBuffer<ArrayDataType::kFloat>().data;
+  auto* quantized_buffer = new Buffer<ArrayDataType::kUint8>;
+  quantized_buffer->data.resize(float_data.size());
+  std::vector<float> scales(num_channels);
+  tflite::SymmetricQuantizePerChannel(
+      float_data.data(), float_data.size(), num_channels, inner_size,
+      quantized_buffer->data.data(), scales.data());
+  array.buffer = std::unique_ptr<GenericBuffer>(quantized_buffer);
+
+  auto* per_channel_params = new PerChannelQuantizationParams;
+  per_channel_params->quantized_dimension = quantized_dimension;
+  per_channel_params->scale.assign(scales.begin(), scales.end());
+  array.per_channel_quantization_params.reset(per_channel_params);
+  QuantizationParams& quantization_params =
+      array.GetOrCreateQuantizationParams();
+  quantization_params.zero_point = tflite::kSymmetricUint8ZeroPoint;
+  quantization_params.scale =
+      *std::max_element(scales.begin(), scales.end());
+  array.data_type = ArrayDataType::kUint8;
+  array.final_data_type = ArrayDataType::kUint8;
+  transformation->AddMessageF(
+      "Quantized array %s per channel along dimension %d to %s "
+      "zero_point=%d, max scale=%g",
+      name, quantized_dimension, ArrayDataTypeName(array.data_type),
+      quantization_params.zero_point, quantization_params.scale);
+}
+
+void QuantizeBiasArrayPerChannel(
+    GraphTransformation* transformation, Model* model, const string& name,
+    double input_scale, const PerChannelQuantizationParams& weights_params) {
+  auto& array = model->GetArray(name);
+  CHECK(array.data_type == ArrayDataType::kFloat);
+  CHECK(!array.quantization_params);
+  const auto& float_data = array.GetBuffer<ArrayDataType::kFloat>().data;
+  const int num_channels = weights_params.scale.size();
+  CHECK_EQ(float_data.size(), static_cast<size_t>(num_channels));
+
+  auto* quantized_buffer = new Buffer<ArrayDataType::kInt32>;
+  quantized_buffer->data.resize(num_channels);
+  auto* per_channel_params = new PerChannelQuantizationParams;
+  per_channel_params->quantized_dimension = 0;
+  per_channel_params->scale.resize(num_channels);
+  for (int c = 0; c < num_channels; c++) {
+    const double scale = input_scale * weights_params.scale[c];
+    per_channel_params->scale[c] = scale;
+    quantized_buffer->data[c] = tflite::SafeCast<int32>(
+        scale == 0 ? 0. : std::round(float_data[c] / scale));
+  }
+  array.buffer = std::unique_ptr<GenericBuffer>(quantized_buffer);
+  array.per_channel_quantization_params.reset(per_channel_params);
+  QuantizationParams& quantization_params =
+      array.GetOrCreateQuantizationParams();
+  quantization_params.zero_point = 0;
+  quantization_params.scale =
+      *std::max_element(per_channel_params->scale.begin(),
+                        per_channel_params->scale.end());
+  array.data_type = ArrayDataType::kInt32;
+  array.final_data_type = ArrayDataType::kInt32;
+  transformation->AddMessageF(
+      "Quantized bias array %s per channel to %s with input scale=%g", name,
+      ArrayDataTypeName(array.data_type), input_scale);
+}
+
 bool IsArrayQuantizedRangeSubset(GraphTransformation* transformation,
                                  const Array& array, double clamp_min,
                                  double clamp_max) {
@@ -60,6 +60,20 @@ void QuantizeArray(GraphTransformation* transformation, Model* model,
                    const string& name, ArrayDataType quantized_data_type,
                    const QuantizationParams& quantization_params);
 
+// Quantizes the constant float array 'name' symmetrically to uint8, with one
+// scale per slice along 'quantized_dimension' and the zero point
+// tflite::kSymmetricUint8ZeroPoint shared by all slices. Its
+// quantization_params hold that zero point and the largest of the scales.
+void QuantizeArrayPerChannel(GraphTransformation* transformation, Model* model,
+                             const string& name, int quantized_dimension);
+
+// Quantizes the constant float bias array 'name' to int32, with one scale per
+// channel: the product of 'input_scale' and the scale of the matching channel
+// of the weights.
+void QuantizeBiasArrayPerChannel(
+    GraphTransformation* transformation, Model* model, const string& name,
+    double input_scale, const PerChannelQuantizationParams& weights_params);
+
 // Returns true if the given array, when quantized, contains only values between
 // the provided clamp min/max.
 // Either clamp_min or clamp_max may be +/-infinity to indicate that the value
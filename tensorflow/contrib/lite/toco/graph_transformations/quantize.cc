@@ -45,6 +45,7 @@ bool SupportsQuantization(const Operator& op) {
          type == OperatorType::kTensorFlowMinimum ||
          type == OperatorType::kTensorFlowMaximum ||
          type == OperatorType::kLogistic || type == OperatorType::kSoftmax ||
+         type == OperatorType::kHardSwish ||
          type == OperatorType::kLogSoftmax || type == OperatorType::kSlice ||
          type == OperatorType::kResizeBilinear ||
          type == OperatorType::kTensorFlowSplit || type == OperatorType::kSub ||
@@ -230,6 +231,51 @@ bool ChooseQuantizationForOperatorInput(
   return true;
 }
 
+// Returns the dimension of the output channels in the weights of 'op', if they
+// can be quantized per channel, or -1. Weights are in OHWI order for Conv and
+// in 1HWO order for DepthwiseConv.
+int GetPerChannelWeightsDimension(const Operator& op) {
+  if (op.type == OperatorType::kConv) {
+    return 0;
+  }
+  if (op.type == OperatorType::kDepthwiseConv) {
+    return 3;
+  }
+  return -1;
+}
+
+// Quantizes the constant weights of a Conv or DepthwiseConv per output
+// channel, and then its constant bias to match. Returns false, leaving the
+// array to the per-tensor quantization, for any other input.
+bool QuantizeInputPerChannel(GraphTransformation* transformation,
+                             Model* model, const Operator& op,
+                             std::size_t input_index) {
+  const int channel_dimension = GetPerChannelWeightsDimension(op);
+  if (channel_dimension < 0 || (input_index != 1 && input_index != 2)) {
+    return false;
+  }
+  const auto& input = op.inputs[input_index];
+  const auto& array = model->GetArray(input);
+  if (array.data_type != ArrayDataType::kFloat ||
+      !IsConstantParameterArray(*model, input)) {
+    return false;
+  }
+  if (input_index == 1) {
+    QuantizeArrayPerChannel(transformation, model, input, channel_dimension);
+    return true;
+  }
+  const auto& input_activations = model->GetArray(op.inputs[0]);
+  const auto& input_weights = model->GetArray(op.inputs[1]);
+  if (!input_activations.quantization_params ||
+      !input_weights.per_channel_quantization_params) {
+    return false;
+  }
+  QuantizeBiasArrayPerChannel(transformation, model, input,
+                              input_activations.quantization_params->scale,
+                              *input_weights.per_channel_quantization_params);
+  return true;
+}
+
 bool IsExactlyRepresentable(double real_value, ArrayDataType data_type,
                             const QuantizationParams& quantization_params) {
   const double scaled_value =
@@ -489,6 +535,11 @@ bool Quantize::Run(Model* model, std::size_t op_index) {
   // Quantize inputs, remove any Dequantize op on the inputs side
   for (std::size_t input_index = 0; input_index < op.inputs.size();
        input_index++) {
+    if (quantize_weights_per_channel_ &&
+        QuantizeInputPerChannel(this, model, op, input_index)) {
+      changed = true;
+      continue;
+    }
     ArrayDataType quantized_data_type;
     QuantizationParams quantization_params;
     if (ChooseQuantizationForOperatorInput(this, model, op, input_index,
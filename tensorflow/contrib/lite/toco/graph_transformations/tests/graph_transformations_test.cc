@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+namespace {
+
+// Counts the operators it is run at, without changing anything.
+class CountVisits : public GraphTransformation {
+ public:
+  explicit CountVisits(int* visits) : visits_(visits) {}
+  bool Run(Model* model, std::size_t op_index) override {
+    ++*visits_;
+    return false;
+  }
+  const char* Name() const override { return "CountVisits"; }
+
+ private:
+  int* visits_;
+};
+
+// At the operator writing the model output, gives the model input a range.
+class SetInputMinMax : public GraphTransformation {
+ public:
+  bool Run(Model* model, std::size_t op_index) override {
+    const auto& op = model->operators[op_index];
+    if (!IsOutputArray(*model, op->outputs[0])) return false;
+    auto& input_array = model->GetArray(model->flags.input_arrays(0).name());
+    if (input_array.minmax) return false;
+    input_array.GetOrCreateMinMax();
+    return true;
+  }
+  const char* Name() const override { return "SetInputMinMax"; }
+};
+
+// Turns the Relus reading an input that has a range into Relu6s.
+class ConvertReluOfRangedInput : public GraphTransformation {
+ public:
+  bool Run(Model* model, std::size_t op_index) override {
+    auto& op = model->operators[op_index];
+    if (op->type != OperatorType::kRelu ||
+        !model->GetArray(op->inputs[0]).minmax) {
+      return false;
+    }
+    auto* relu6_op = new Relu6Operator;
+    relu6_op->inputs = op->inputs;
+    relu6_op->outputs = op->outputs;
+    op.reset(relu6_op);
+    return true;
+  }
+  const char* Name() const override { return "ConvertReluOfRangedInput"; }
+};
+
+// Builds the chain of Relus: input -> relu_0 -> ... -> output.
+void BuildReluChain(int num_ops, Model* model) {
+  model->flags.add_input_arrays()->set_name("input");
+  model->GetOrCreateArray("input");
+  string previous = "input";
+  for (int i = 0; i < num_ops; ++i) {
+    const string output =
+        i == num_ops - 1 ? "output" : "relu_" + std::to_string(i);
+    model->GetOrCreateArray(output);
+    auto* op = new ReluOperator;
+    op->inputs = {previous};
+    op->outputs = {output};
+    model->operators.emplace_back(op);
+    previous = output;
+  }
+  model->flags.add_output_arrays("output");
+}
+
+}  // namespace
+
+TEST(GraphTransformationsTest, UnchangedModelIsVisitedOnce) {
+  Model model;
+  BuildReluChain(5, &model);
+  int visits = 0;
+  RunGraphTransformations(&model, "test", {new CountVisits(&visits)});
+  EXPECT_EQ(visits, 5);
+}
+
+TEST(GraphTransformationsTest, ReachesFixedPointAcrossDistantOperators) {
+  // The change at the last operator enables one at the first, which isn't
+  // next to it: the first operator is already settled by then, and only gets
+  // revisited by the final pass over every operator.
+  Model model;
+  BuildReluChain(3, &model);
+  RunGraphTransformations(
+      &model, "test",
+      {new SetInputMinMax, new ConvertReluOfRangedInput});
+  EXPECT_TRUE(model.GetArray("input").minmax);
+  EXPECT_EQ(model.operators[0]->type, OperatorType::kRelu6);
+  EXPECT_EQ(model.operators[1]->type, OperatorType::kRelu);
+  EXPECT_EQ(model.operators[2]->type, OperatorType::kRelu);
+}
+
+}  // namespace toco
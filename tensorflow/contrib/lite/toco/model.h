@@ -69,6 +69,7 @@ enum class OperatorType {
   kRelu1,
   kRelu6,
   kPRelu,
+  kHardSwish,
   kSoftmax,
   kLogSoftmax,
   kSub,
@@ -598,6 +599,18 @@ struct PReluOperator : Operator {
   PReluOperator() : Operator(OperatorType::kPRelu) {}
 };
 
+// HardSwish
+//   f(x) = x * Relu6(x + 3) / 6
+//
+// Inputs:
+//   inputs[0]: required: the input array
+//
+// There is no such TensorFlow op; it is identified from the equivalent
+// subgraph of elementwise ops, see IdentifyHardSwish.
+struct HardSwishOperator : Operator {
+  HardSwishOperator() : Operator(OperatorType::kHardSwish) {}
+};
+
 // Element-wise Logistic operator:
 //   x -> Logistic(x) = 1 / (1 + exp(-x))
 //
@@ -1694,6 +1707,14 @@ class Shape {
   std::vector<int> dims_;
 };
 
+// Quantization parameters of an array quantized per channel: each slice
+// along 'quantized_dimension' has its own scale, and all of them share the
+// zero point of the array's QuantizationParams.
+struct PerChannelQuantizationParams {
+  int quantized_dimension = 0;
+  std::vector<double> scale;
+};
+
 // Array represents an array (either a constant parameter array or an
 // activations array) in a Model.
 struct Array {
@@ -1825,6 +1846,11 @@ struct Array {
   // If this is non-null, then these quantization parameters are to be used
   // to assign a meaning as real numbers to the elements of this array.
   std::unique_ptr<QuantizationParams> quantization_params;
+  // Per-channel quantization parameters, only for constant arrays quantized
+  // per channel, such as the weights of convolutions and their bias. When
+  // set, the scale in 'quantization_params' is only indicative and the
+  // per-channel scales are to be used instead.
+  std::unique_ptr<PerChannelQuantizationParams> per_channel_quantization_params;
 
  private:
   std::unique_ptr<Shape> array_shape;
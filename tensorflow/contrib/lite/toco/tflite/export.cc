@@ -124,20 +124,28 @@ Offset<Vector<Offset<Tensor>>> ExportTensors(
     Offset<Vector<float>> max;
     Offset<Vector<float>> scale;
     Offset<Vector<int64_t>> zero_point;
+    int quantized_dimension = 0;
     if (array.minmax) {
       min = builder->CreateVector(
           std::vector<float>{static_cast<float>(array.minmax->min)});
       max = builder->CreateVector(
           std::vector<float>{static_cast<float>(array.minmax->max)});
     }
-    if (array.quantization_params) {
+    if (array.per_channel_quantization_params) {
+      const auto& per_channel = *array.per_channel_quantization_params;
+      scale = builder->CreateVector(std::vector<float>(
+          per_channel.scale.begin(), per_channel.scale.end()));
+      zero_point = builder->CreateVector(
+          std::vector<int64_t>{array.quantization_params->zero_point});
+      quantized_dimension = per_channel.quantized_dimension;
+    } else if (array.quantization_params) {
       scale = builder->CreateVector(std::vector<float>{
           static_cast<float>(array.quantization_params->scale)});
       zero_point = builder->CreateVector(
           std::vector<int64_t>{array.quantization_params->zero_point});
     }
-    auto q_param = ::tflite::CreateQuantizationParameters(*builder, min, max,
-                                                          scale, zero_point);
+    auto q_param = ::tflite::CreateQuantizationParameters(
+        *builder, min, max, scale, zero_point, quantized_dimension);
 
     int index = tensors_map.at(tensor_name);
     bool is_variable =
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/toco/tflite/import.h"
 
+#include <algorithm>
+
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/schema/schema_generated.h"
@@ -78,7 +80,8 @@ void ImportTensors(const ::tflite::Model& input_model, Model* model) {
     auto quantization = input_tensor->quantization();
     if (quantization) {
       // Note that tf.mini only supports a single quantization parameters for
-      // the whole array.
+      // the whole array, except for the scales of arrays quantized per
+      // channel.
       if (quantization->min() && quantization->max()) {
         CHECK_EQ(1, quantization->min()->Length());
         CHECK_EQ(1, quantization->max()->Length());
@@ -87,11 +90,22 @@ void ImportTensors(const ::tflite::Model& input_model, Model* model) {
         minmax.max = quantization->max()->Get(0);
       }
       if (quantization->scale() && quantization->zero_point()) {
-        CHECK_EQ(1, quantization->scale()->Length());
         CHECK_EQ(1, quantization->zero_point()->Length());
         QuantizationParams& q = array.GetOrCreateQuantizationParams();
-        q.scale = quantization->scale()->Get(0);
         q.zero_point = quantization->zero_point()->Get(0);
+        const auto* scales = quantization->scale();
+        if (scales->Length() == 1) {
+          q.scale = scales->Get(0);
+        } else {
+          CHECK_GT(scales->Length(), 1);
+          auto* per_channel = new PerChannelQuantizationParams;
+          per_channel->quantized_dimension =
+              quantization->quantized_dimension();
+          per_channel->scale.assign(scales->begin(), scales->end());
+          array.per_channel_quantization_params.reset(per_channel);
+          q.scale = *std::max_element(per_channel->scale.begin(),
+                                      per_channel->scale.end());
+        }
       }
     }
   }
@@ -1111,6 +1111,8 @@ std::vector<std::unique_ptr<BaseOperator>> BuildOperatorList() {
       new SimpleOperator<Relu6Operator>("RELU6", OperatorType::kRelu6));
   ops.emplace_back(
       new SimpleOperator<PReluOperator>("PRELU", OperatorType::kPRelu));
+  ops.emplace_back(new SimpleOperator<HardSwishOperator>(
+      "HARD_SWISH", OperatorType::kHardSwish));
   ops.emplace_back(new SimpleOperator<LogisticOperator>(
       "LOGISTIC", OperatorType::kLogistic));
   ops.emplace_back(
@@ -163,6 +163,12 @@ bool ParseTocoFlagsFromCommandLineFlags(
            "Store weights as quantized weights followed by dequantize "
            "operations. Computation is still done in float, but reduces model "
            "size (at the cost of accuracy and latency)."),
+      Flag("quantize_conv_weights_per_channel",
+           parsed_flags.quantize_conv_weights_per_channel.bind(),
+           parsed_flags.quantize_conv_weights_per_channel.default_value(),
+           "Quantize the weights of Conv and DepthwiseConv symmetrically with "
+           "one scale per output channel, and their bias to match. Ignored "
+           "unless inference_type is QUANTIZED_UINT8."),
   };
   bool asked_for_help =
       *argc == 2 && (!strcmp(argv[1], "--help") || !strcmp(argv[1], "-help"));
@@ -257,6 +263,7 @@ void ReadTocoFlagsFromCommandLineFlags(const ParsedTocoFlags& parsed_toco_flags,
   READ_TOCO_FLAG(dedupe_array_min_size_bytes, FlagRequirement::kNone);
   READ_TOCO_FLAG(split_tflite_lstm_inputs, FlagRequirement::kNone);
   READ_TOCO_FLAG(quantize_weights, FlagRequirement::kNone);
+  READ_TOCO_FLAG(quantize_conv_weights_per_channel, FlagRequirement::kNone);
 
   // Deprecated flag handling.
   if (parsed_toco_flags.input_type.specified()) {
@@ -103,6 +103,7 @@ void MakeGeneralGraphTransformationsSet(
   transformations->Add(new IdentifyL2Pool);
   transformations->Add(new IdentifyRelu1);
   transformations->Add(new IdentifyPRelu);
+  transformations->Add(new IdentifyHardSwish);
   transformations->Add(new RemoveTrivialBinaryOperator);
   transformations->Add(new ReadFakeQuantMinMax);
   transformations->Add(new ResolveSpaceToBatchNDAttributes);
@@ -327,11 +328,14 @@ void Transform(const TocoFlags& toco_flags, Model* model) {
         new EnsureUint8WeightsSafeForFastInt8Kernels;
     ensure_safe_for_int8_kernels->set_allow_nudging_weights(
         toco_flags.allow_nudging_weights_to_use_fast_gemm_kernel());
+    auto* quantize = new Quantize;
+    quantize->set_quantize_weights_per_channel(
+        toco_flags.quantize_conv_weights_per_channel());
     RunGraphTransformations(model, "quantization graph transformations",
                             {
                                 new RemoveTrivialQuantizedActivationFunc,
                                 new RemoveTrivialQuantizedMinMax,
-                                new Quantize,
+                                quantize,
                                 new RemoveFinalDequantizeOp,
                                 ensure_safe_for_int8_kernels,
                             });
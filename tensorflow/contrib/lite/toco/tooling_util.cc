@@ -332,6 +332,7 @@ const char* OperatorTypeName(OperatorType type) {
     HANDLE_OPERATORTYPENAME_CASE(Relu1)
     HANDLE_OPERATORTYPENAME_CASE(Relu6)
     HANDLE_OPERATORTYPENAME_CASE(PRelu)
+    HANDLE_OPERATORTYPENAME_CASE(HardSwish)
     HANDLE_OPERATORTYPENAME_CASE(ReorderAxes)
     HANDLE_OPERATORTYPENAME_CASE(Softmax)
     HANDLE_OPERATORTYPENAME_CASE(LogSoftmax)
@@ -1237,6 +1238,14 @@ void CopyArrayAttribs(const Array& source_array, Array* target_array) {
   } else {
     target_array->quantization_params.reset();
   }
+
+  if (source_array.per_channel_quantization_params) {
+    target_array->per_channel_quantization_params.reset(
+        new PerChannelQuantizationParams(
+            *source_array.per_channel_quantization_params));
+  } else {
+    target_array->per_channel_quantization_params.reset();
+  }
 }
 }  // namespace
 
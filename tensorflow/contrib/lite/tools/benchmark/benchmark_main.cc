@@ -28,6 +28,8 @@ int Main(int argc, char** argv) {
   BenchmarkTfLiteModel benchmark;
   BenchmarkLoggingListener listener;
   benchmark.AddListener(&listener);
+  BenchmarkCsvListener csv_listener;
+  benchmark.AddListener(&csv_listener);
   benchmark.Run(argc, argv);
   return 0;
 }
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <time.h>
 
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -56,6 +57,42 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults &results) {
                    << "Warmup: " << warmup_us.avg() << ", "
                    << "Init: " << init_us << ", "
                    << "no stats: " << inference_us.avg();
+  TFLITE_LOG(INFO) << "Inference timings in us: "
+                   << "First (cold): " << results.first_inference_time_us()
+                   << ", p50: " << results.inference_time_percentile_us(50)
+                   << ", p90: " << results.inference_time_percentile_us(90)
+                   << ", p99: " << results.inference_time_percentile_us(99);
+}
+
+void BenchmarkCsvListener::OnBenchmarkStart(const BenchmarkParams &params) {
+  params_ = params;
+}
+
+void BenchmarkCsvListener::OnBenchmarkEnd(const BenchmarkResults &results) {
+  if (params_.results_csv_file.empty()) {
+    return;
+  }
+  // Only a new file gets a header.
+  const bool write_header = !std::ifstream(params_.results_csv_file).good();
+  std::ofstream csv(params_.results_csv_file, std::ios::app);
+  if (!csv) {
+    TFLITE_LOG(ERROR) << "Failed to open " << params_.results_csv_file;
+    return;
+  }
+  if (write_header) {
+    csv << "benchmark_name,num_threads,num_runs,init_us,first_us,warmup_avg_us,"
+           "avg_us,std_us,min_us,p50_us,p90_us,p99_us,max_us\n";
+  }
+  const auto inference_us = results.inference_time_us();
+  csv << params_.benchmark_name << "," << params_.num_threads << ","
+      << inference_us.count() << "," << results.startup_latency_us() << ","
+      << results.first_inference_time_us() << ","
+      << results.warmup_time_us().avg() << "," << inference_us.avg() << ","
+      << inference_us.std_deviation() << "," << inference_us.min() << ","
+      << results.inference_time_percentile_us(50) << ","
+      << results.inference_time_percentile_us(90) << ","
+      << results.inference_time_percentile_us(99) << "," << inference_us.max()
+      << "\n";
 }
 
 std::vector<Flag> BenchmarkModel::GetFlags() {
@@ -67,6 +104,8 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
       Flag("output_prefix", &params_.output_prefix, "benchmark output prefix"),
       Flag("warmup_runs", &params_.warmup_runs,
            "how many runs to initialize model"),
+      Flag("results_csv_file", &params_.results_csv_file,
+           "CSV file to append the results to"),
   };
 }
 
@@ -78,9 +117,11 @@ void BenchmarkModel::LogFlags() {
   TFLITE_LOG(INFO) << "Benchmark name: [" << params_.benchmark_name << "]";
   TFLITE_LOG(INFO) << "Output prefix: [" << params_.output_prefix << "]";
   TFLITE_LOG(INFO) << "Warmup runs: [" << params_.warmup_runs << "]";
+  TFLITE_LOG(INFO) << "Results CSV file: [" << params_.results_csv_file << "]";
 }
 
-Stat<int64_t> BenchmarkModel::Run(int num_times, RunType run_type) {
+Stat<int64_t> BenchmarkModel::Run(int num_times, RunType run_type,
+                                  std::vector<int64_t> *run_times_us) {
   Stat<int64_t> run_stats;
   TFLITE_LOG(INFO) << "Running benchmark for " << num_times << " iterations ";
   for (int run = 0; run < num_times; run++) {
@@ -91,6 +132,9 @@ Stat<int64_t> BenchmarkModel::Run(int num_times, RunType run_type) {
     listeners_.OnSingleRunEnd();
 
     run_stats.UpdateStat(end_us - start_us);
+    if (run_times_us != nullptr) {
+      run_times_us->push_back(end_us - start_us);
+    }
     SleepForSeconds(params_.run_delay);
   }
 
@@ -117,10 +161,14 @@ void BenchmarkModel::Run(int argc, char **argv) {
                    << "ms";
 
   uint64_t input_bytes = ComputeInputBytes();
-  Stat<int64_t> warmup_time_us = Run(params_.warmup_runs, WARMUP);
-  Stat<int64_t> inference_time_us = Run(params_.num_runs, REGULAR);
-  listeners_.OnBenchmarkEnd(
-      {startup_latency_us, input_bytes, warmup_time_us, inference_time_us});
+  Stat<int64_t> warmup_time_us =
+      Run(params_.warmup_runs, WARMUP, /*run_times_us=*/nullptr);
+  std::vector<int64_t> inference_times_us;
+  Stat<int64_t> inference_time_us =
+      Run(params_.num_runs, REGULAR, &inference_times_us);
+  listeners_.OnBenchmarkEnd({startup_latency_us, input_bytes, warmup_time_us,
+                             inference_time_us,
+                             std::move(inference_times_us)});
 }
 
 bool BenchmarkModel::ParseFlags(int argc, char **argv) {
@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_MODEL_H_
 #define TENSORFLOW_CONTRIB_LITE_TOOLS_BENCHMARK_MODEL_H_
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <ostream>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/contrib/lite/tools/benchmark/command_line_flags.h"
@@ -38,16 +40,32 @@ class BenchmarkResults {
  public:
   BenchmarkResults(int64_t startup_latency_us, uint64_t input_bytes,
                    tensorflow::Stat<int64_t> warmup_time_us,
-                   tensorflow::Stat<int64_t> inference_time_us)
+                   tensorflow::Stat<int64_t> inference_time_us,
+                   std::vector<int64_t> inference_times_us)
       : startup_latency_us_(startup_latency_us),
         input_bytes_(input_bytes),
         warmup_time_us_(warmup_time_us),
-        inference_time_us_(inference_time_us) {}
+        inference_time_us_(inference_time_us),
+        sorted_inference_times_us_(std::move(inference_times_us)) {
+    std::sort(sorted_inference_times_us_.begin(),
+              sorted_inference_times_us_.end());
+  }
 
   tensorflow::Stat<int64_t> inference_time_us() const {
     return inference_time_us_;
   }
   tensorflow::Stat<int64_t> warmup_time_us() const { return warmup_time_us_; }
+  // Returns the latency of the first, cold, inference.
+  int64_t first_inference_time_us() const {
+    return warmup_time_us_.empty() ? inference_time_us_.first()
+                                   : warmup_time_us_.first();
+  }
+  // Returns the nearest-rank percentile of the latencies of the regular runs.
+  int64_t inference_time_percentile_us(int percentile) const {
+    if (sorted_inference_times_us_.empty()) return 0;
+    size_t rank = (sorted_inference_times_us_.size() * percentile + 99) / 100;
+    return sorted_inference_times_us_[std::max<size_t>(rank, 1) - 1];
+  }
   int64_t startup_latency_us() const { return startup_latency_us_; }
   uint64_t input_bytes() const { return input_bytes_; }
   double throughput_MB_per_second() const {
@@ -61,6 +79,7 @@ class BenchmarkResults {
   uint64_t input_bytes_;
   tensorflow::Stat<int64_t> warmup_time_us_;
   tensorflow::Stat<int64_t> inference_time_us_;
+  std::vector<int64_t> sorted_inference_times_us_;
 };
 
 struct BenchmarkParams {
@@ -72,6 +91,7 @@ struct BenchmarkParams {
   int num_threads;
   std::string benchmark_name;
   std::string output_prefix;
+  std::string results_csv_file;
 };
 
 class BenchmarkListener {
@@ -130,6 +150,17 @@ class BenchmarkLoggingListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override;
 };
 
+// Benchmark listener that appends the results of the benchmark run as a line
+// of the CSV file given by --results_csv_file, if any. Running the benchmark
+// several times, e.g. with different --num_threads, builds a table of results
+// which can be tracked across devices and builds.
+class BenchmarkCsvListener : public BenchmarkListener {
+  void OnBenchmarkStart(const BenchmarkParams& params) override;
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+  BenchmarkParams params_;
+};
+
 // Benchmarks a model.
 //
 // Subclasses need to implement initialization and running of the model.
@@ -149,7 +180,10 @@ class BenchmarkModel {
   virtual bool ValidateFlags() { return true; }
   virtual std::vector<Flag> GetFlags();
   virtual uint64_t ComputeInputBytes() = 0;
-  virtual tensorflow::Stat<int64_t> Run(int num_times, RunType run_type);
+  // Runs the model 'num_times', and appends the latency of every run to
+  // 'run_times_us' if it isn't null.
+  virtual tensorflow::Stat<int64_t> Run(int num_times, RunType run_type,
+                                        std::vector<int64_t>* run_times_us);
   virtual void RunImpl() = 0;
   BenchmarkParams params_;
   BenchmarkListeners listeners_;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdarg>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -50,8 +51,17 @@ void ProfilingListener::OnSingleRunStart(RunType run_type) {
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
-  if (has_profiles_) {
-    TFLITE_LOG(INFO) << summarizer_.GetOutputString();
+  if (!has_profiles_) {
+    return;
+  }
+  TFLITE_LOG(INFO) << summarizer_.GetOutputString();
+  if (!csv_file_.empty()) {
+    std::ofstream csv(csv_file_);
+    if (!csv) {
+      TFLITE_LOG(ERROR) << "Failed to open " << csv_file_;
+      return;
+    }
+    csv << summarizer_.GetCsvString();
   }
 }
 
@@ -170,7 +180,11 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       Flag("graph", &graph, "graph file name"),
       Flag("input_layer", &input_layer_string, "input layer names"),
       Flag("input_layer_shape", &input_layer_shape_string, "input layer shape"),
-      Flag("use_nnapi", &use_nnapi, "use nnapi api")};
+      Flag("use_nnapi", &use_nnapi, "use nnapi api"),
+      Flag("enable_op_profiling", &enable_op_profiling,
+           "profile the ops of the regular runs"),
+      Flag("op_profiling_csv_file", &op_profiling_csv_file,
+           "CSV file to write the op profile to")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
   return flags;
@@ -182,6 +196,9 @@ void BenchmarkTfLiteModel::LogFlags() {
   TFLITE_LOG(INFO) << "Input layers: [" << input_layer_string << "]";
   TFLITE_LOG(INFO) << "Input shapes: [" << input_layer_shape_string << "]";
   TFLITE_LOG(INFO) << "Use nnapi : [" << use_nnapi << "]";
+  TFLITE_LOG(INFO) << "Enable op profiling: [" << enable_op_profiling << "]";
+  TFLITE_LOG(INFO) << "Op profiling CSV file: [" << op_profiling_csv_file
+                   << "]";
 }
 
 bool BenchmarkTfLiteModel::ValidateFlags() {
@@ -224,7 +241,11 @@ void BenchmarkTfLiteModel::Init() {
   if (!interpreter) {
     TFLITE_LOG(FATAL) << "Failed to construct interpreter";
   }
-  profiling_listener_.SetInterpreter(interpreter.get());
+  if (enable_op_profiling) {
+    profiling_listener_.SetInterpreter(interpreter.get());
+    profiling_listener_.SetCsvFile(op_profiling_csv_file);
+    AddListener(&profiling_listener_);
+  }
 
   if (params_.num_threads != -1) {
     interpreter->SetNumThreads(params_.num_threads);
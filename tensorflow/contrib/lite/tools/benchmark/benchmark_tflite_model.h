@@ -27,12 +27,14 @@ limitations under the License.
 namespace tflite {
 namespace benchmark {
 
-// Dumps profiling events if profiling is enabled
+// Dumps the per-op profile of the regular runs, and writes it as CSV to
+// 'csv_file' if it isn't empty.
 class ProfilingListener : public BenchmarkListener {
  public:
   explicit ProfilingListener() : interpreter_(nullptr), has_profiles_(false) {}
 
   void SetInterpreter(Interpreter* interpreter);
+  void SetCsvFile(const std::string& csv_file) { csv_file_ = csv_file; }
 
   void OnSingleRunStart(RunType run_type) override;
 
@@ -45,14 +47,13 @@ class ProfilingListener : public BenchmarkListener {
   profiling::Profiler profiler_;
   profiling::ProfileSummarizer summarizer_;
   bool has_profiles_;
+  std::string csv_file_;
 };
 
 // Benchmarks a TFLite model by running tflite interpreter.
 class BenchmarkTfLiteModel : public BenchmarkModel {
  public:
-  BenchmarkTfLiteModel() : use_nnapi(false) {
-    AddListener(&profiling_listener_);
-  }
+  BenchmarkTfLiteModel() : use_nnapi(false), enable_op_profiling(false) {}
 
   std::vector<Flag> GetFlags() override;
   void LogFlags() override;
@@ -77,6 +78,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::string input_layer_values_string;
   std::vector<InputLayerInfo> inputs;
   bool use_nnapi;
+  bool enable_op_profiling;
+  std::string op_profiling_csv_file;
   ProfilingListener profiling_listener_;
 };
 
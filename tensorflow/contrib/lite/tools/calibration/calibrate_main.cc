@@ -0,0 +1,160 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Converts a float TFLite model into a fully quantized uint8 one, using the
+// ranges its activations take on a representative dataset:
+//
+// calibrate --input_model=model.tflite --dataset=sample0.raw,sample1.raw \
+//   --range_method=kl --output_file=quantized.tflite
+//
+// Each dataset file holds the raw float32 values of all the inputs of the
+// model for one invocation, concatenated in input order.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/contrib/lite/kernels/register.h"
+#include "tensorflow/contrib/lite/toco/model_flags.pb.h"
+#include "tensorflow/contrib/lite/toco/toco_flags.pb.h"
+#include "tensorflow/contrib/lite/toco/toco_tooling.h"
+#include "tensorflow/contrib/lite/tools/calibration/calibrator.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+using tensorflow::Flag;
+using tensorflow::Flags;
+using tensorflow::string;
+
+namespace {
+
+// Copies the values of one dataset sample into the inputs of 'interpreter'.
+bool LoadSample(const string& filename, tflite::Interpreter* interpreter) {
+  string contents;
+  TF_CHECK_OK(tensorflow::ReadFileToString(tensorflow::Env::Default(),
+                                           filename, &contents));
+  size_t offset = 0;
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    if (tensor->type != kTfLiteFloat32) {
+      LOG(ERROR) << "Input " << tensor->name << " is not float.";
+      return false;
+    }
+    if (offset + tensor->bytes > contents.size()) {
+      LOG(ERROR) << filename << " is too short for the inputs of the model.";
+      return false;
+    }
+    std::memcpy(tensor->data.raw, contents.data() + offset, tensor->bytes);
+    offset += tensor->bytes;
+  }
+  if (offset != contents.size()) {
+    LOG(ERROR) << filename << " is too long for the inputs of the model.";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  string input_model;
+  string dataset;
+  string range_method = "minmax";
+  string output_file;
+  std::vector<Flag> flag_list = {
+      Flag("input_model", &input_model, "path to the float tflite model"),
+      Flag("dataset", &dataset,
+           "comma-separated files of raw float32 input values, one per "
+           "invocation"),
+      Flag("range_method", &range_method,
+           "how to pick the range of each tensor: minmax or kl"),
+      Flag("output_file", &output_file, "path to the quantized tflite model"),
+  };
+  const string usage = Flags::Usage(argv[0], flag_list);
+  if (!Flags::Parse(&argc, argv, flag_list) || input_model.empty() ||
+      dataset.empty() || output_file.empty()) {
+    LOG(ERROR) << usage;
+    return 1;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+
+  tflite::calibration::RangeMethod method;
+  if (range_method == "minmax") {
+    method = tflite::calibration::RangeMethod::kMinMax;
+  } else if (range_method == "kl") {
+    method = tflite::calibration::RangeMethod::kKlDivergence;
+  } else {
+    LOG(ERROR) << "Unknown --range_method: " << range_method;
+    return 1;
+  }
+
+  auto model = tflite::FlatBufferModel::BuildFromFile(input_model.c_str());
+  if (!model) {
+    LOG(ERROR) << "Failed to load " << input_model;
+    return 1;
+  }
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  if (tflite::InterpreterBuilder(*model, resolver)(&interpreter) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    LOG(ERROR) << "Failed to build an interpreter for " << input_model;
+    return 1;
+  }
+
+  tflite::calibration::Calibrator calibrator(interpreter.get());
+  for (const string& sample : tensorflow::str_util::Split(dataset, ',')) {
+    if (!LoadSample(sample, interpreter.get()) ||
+        calibrator.Invoke() != kTfLiteOk) {
+      LOG(ERROR) << "Failed to run the model on " << sample;
+      return 1;
+    }
+  }
+
+  string model_with_ranges;
+  if (tflite::calibration::WriteModelWithRanges(
+          model->GetModel(), calibrator, method, tflite::DefaultErrorReporter(),
+          &model_with_ranges) != kTfLiteOk) {
+    return 1;
+  }
+
+  // The uint8 inputs are dequantized with the calibrated ranges too.
+  toco::ModelFlags model_flags;
+  for (int i = 0; i < interpreter->inputs().size(); ++i) {
+    float min, max;
+    calibrator.stats().at(interpreter->inputs()[i]).GetRange(method, &min,
+                                                             &max);
+    auto* input_array = model_flags.add_input_arrays();
+    input_array->set_name(interpreter->GetInputName(i));
+    const float std_value = max > min ? 255 / (max - min) : 1;
+    input_array->set_std_value(std_value);
+    input_array->set_mean_value(-min * std_value);
+  }
+  toco::TocoFlags toco_flags;
+  toco_flags.set_input_format(toco::TFLITE);
+  toco_flags.set_output_format(toco::TFLITE);
+  toco_flags.set_inference_type(toco::QUANTIZED_UINT8);
+  toco_flags.set_inference_input_type(toco::QUANTIZED_UINT8);
+
+  std::unique_ptr<toco::Model> toco_model =
+      toco::Import(toco_flags, model_flags, model_with_ranges);
+  toco::Transform(toco_flags, toco_model.get());
+  string output_contents;
+  toco::Export(toco_flags, *toco_model, &output_contents);
+  TF_CHECK_OK(tensorflow::WriteStringToFile(tensorflow::Env::Default(),
+                                            output_file, output_contents));
+  return 0;
+}
@@ -0,0 +1,216 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/tools/calibration/calibrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include "tensorflow/contrib/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace calibration {
+
+constexpr int TensorRangeStats::kNumBins;
+
+void TensorRangeStats::Update(const float* values, int size) {
+  for (int i = 0; i < size; ++i) {
+    const float value = values[i];
+    if (!std::isfinite(value)) continue;
+    if (count_ == 0) {
+      min_ = max_ = value;
+    } else {
+      min_ = std::min(min_, value);
+      max_ = std::max(max_, value);
+    }
+    ++count_;
+
+    const float magnitude = std::abs(value);
+    if (magnitude == 0) {
+      ++histogram_[0];
+      continue;
+    }
+    if (bin_width_ == 0) {
+      // Leave room for larger values before the first merge.
+      bin_width_ = magnitude / (kNumBins / 2);
+    }
+    while (magnitude >= bin_width_ * kNumBins) {
+      for (int bin = 0; bin < kNumBins / 2; ++bin) {
+        histogram_[bin] = histogram_[2 * bin] + histogram_[2 * bin + 1];
+      }
+      std::fill(histogram_.begin() + kNumBins / 2, histogram_.end(), 0);
+      bin_width_ *= 2;
+    }
+    const int bin = std::min(static_cast<int>(magnitude / bin_width_),
+                             kNumBins - 1);
+    ++histogram_[bin];
+  }
+}
+
+namespace {
+
+// Returns the KL divergence of 'q' from 'p', both unnormalized. Like
+// TensorRT's entropy calibration, 'q' is smoothed so that the bins it misses
+// cost a finite amount.
+double KlDivergence(const std::vector<double>& p, const std::vector<double>& q) {
+  constexpr double kEpsilon = 0.0001;
+  double p_sum = 0, q_sum = 0;
+  int q_zeros = 0;
+  for (int i = 0; i < p.size(); ++i) {
+    p_sum += p[i];
+    q_sum += q[i];
+    if (q[i] == 0) ++q_zeros;
+  }
+  if (q_zeros == q.size()) return std::numeric_limits<double>::infinity();
+  const double nonzero_epsilon = kEpsilon * q_zeros / (q.size() - q_zeros);
+  double divergence = 0;
+  for (int i = 0; i < p.size(); ++i) {
+    if (p[i] == 0) continue;
+    const double p_i = p[i] / p_sum;
+    const double q_i = q[i] == 0 ? kEpsilon : q[i] / q_sum - nonzero_epsilon;
+    if (q_i <= 0) return std::numeric_limits<double>::infinity();
+    divergence += p_i * std::log(p_i / q_i);
+  }
+  return divergence;
+}
+
+}  // namespace
+
+float TensorRangeStats::KlDivergenceThreshold(int num_levels) const {
+  int num_used_bins = kNumBins;
+  while (num_used_bins > 0 && histogram_[num_used_bins - 1] == 0) {
+    --num_used_bins;
+  }
+  const float max_magnitude = std::max(std::abs(min_), std::abs(max_));
+  if (num_used_bins <= num_levels) return max_magnitude;
+
+  // Try each clipping threshold, at the edge of a bin: the reference
+  // distribution folds the clipped values into its last bin, and the candidate
+  // spreads the unclipped values of each of 'num_levels' levels evenly over
+  // the non-empty bins of the reference it covers.
+  double best_divergence = std::numeric_limits<double>::infinity();
+  int best_num_bins = num_used_bins;
+  for (int num_bins = num_levels; num_bins <= num_used_bins; ++num_bins) {
+    std::vector<double> reference(histogram_.begin(),
+                                  histogram_.begin() + num_bins);
+    for (int bin = num_bins; bin < num_used_bins; ++bin) {
+      reference[num_bins - 1] += histogram_[bin];
+    }
+
+    std::vector<double> candidate(num_bins);
+    const double bins_per_level = static_cast<double>(num_bins) / num_levels;
+    for (int level = 0; level < num_levels; ++level) {
+      const int begin = static_cast<int>(level * bins_per_level);
+      const int end = level == num_levels - 1
+                          ? num_bins
+                          : static_cast<int>((level + 1) * bins_per_level);
+      double level_sum = 0;
+      int num_nonempty = 0;
+      for (int bin = begin; bin < end; ++bin) {
+        level_sum += histogram_[bin];
+        if (reference[bin] != 0) ++num_nonempty;
+      }
+      if (num_nonempty == 0) continue;
+      for (int bin = begin; bin < end; ++bin) {
+        if (reference[bin] != 0) candidate[bin] = level_sum / num_nonempty;
+      }
+    }
+
+    const double divergence = KlDivergence(reference, candidate);
+    if (divergence < best_divergence) {
+      best_divergence = divergence;
+      best_num_bins = num_bins;
+    }
+  }
+  return std::min(max_magnitude, best_num_bins * bin_width_);
+}
+
+void TensorRangeStats::GetRange(RangeMethod method, float* min,
+                                float* max) const {
+  *min = std::min(min_, 0.0f);
+  *max = std::max(max_, 0.0f);
+  if (method == RangeMethod::kKlDivergence) {
+    // Tensors that are never negative use all the levels for their positive
+    // values.
+    const float threshold = KlDivergenceThreshold(min_ >= 0 ? 255 : 128);
+    *min = std::max(*min, -threshold);
+    *max = std::min(*max, threshold);
+  }
+}
+
+Calibrator::Calibrator(Interpreter* interpreter) : interpreter_(interpreter) {
+  interpreter_->SetOpInvokedCallback([this](int node_index) {
+    const TfLiteNode& node =
+        interpreter_->node_and_registration(node_index)->first;
+    for (int i = 0; i < node.outputs->size; ++i) {
+      RecordTensor(node.outputs->data[i]);
+    }
+  });
+}
+
+Calibrator::~Calibrator() { interpreter_->SetOpInvokedCallback(nullptr); }
+
+TfLiteStatus Calibrator::Invoke() {
+  for (int tensor_index : interpreter_->inputs()) {
+    RecordTensor(tensor_index);
+  }
+  return interpreter_->Invoke();
+}
+
+void Calibrator::RecordTensor(int tensor_index) {
+  if (tensor_index < 0) return;
+  const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+  if (tensor->type != kTfLiteFloat32 || tensor->data.f == nullptr) return;
+  stats_[tensor_index].Update(tensor->data.f, tensor->bytes / sizeof(float));
+}
+
+TfLiteStatus WriteModelWithRanges(const ::tflite::Model* model,
+                                  const Calibrator& calibrator,
+                                  RangeMethod method,
+                                  ErrorReporter* error_reporter,
+                                  string* output) {
+  std::unique_ptr<ModelT> model_t(model->UnPack());
+  if (model_t->subgraphs.size() != 1) {
+    error_reporter->Report("Only models with one subgraph are supported.");
+    return kTfLiteError;
+  }
+  auto& tensors = model_t->subgraphs[0]->tensors;
+  for (const auto& tensor_stats : calibrator.stats()) {
+    const int tensor_index = tensor_stats.first;
+    if (tensor_index >= tensors.size()) {
+      error_reporter->Report("Tensor %d is not in the model.", tensor_index);
+      return kTfLiteError;
+    }
+    if (tensor_stats.second.empty()) continue;
+    float min, max;
+    tensor_stats.second.GetRange(method, &min, &max);
+    auto& tensor = tensors[tensor_index];
+    if (!tensor->quantization) {
+      tensor->quantization.reset(new QuantizationParametersT);
+    }
+    tensor->quantization->min = {min};
+    tensor->quantization->max = {max};
+  }
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, model_t.get()));
+  output->assign(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                 builder.GetSize());
+  return kTfLiteOk;
+}
+
+}  // namespace calibration
+}  // namespace tflite
@@ -0,0 +1,105 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_TOOLS_CALIBRATION_CALIBRATOR_H_
+#define TENSORFLOW_CONTRIB_LITE_TOOLS_CALIBRATION_CALIBRATOR_H_
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/model.h"
+#include "tensorflow/contrib/lite/string.h"
+
+namespace tflite {
+namespace calibration {
+
+// How the range of a tensor is chosen from the values it took.
+enum class RangeMethod {
+  // The smallest and largest values.
+  kMinMax,
+  // The range that minimizes the KL divergence between the distribution of
+  // the values and that of their quantized form, which clips rare outliers.
+  kKlDivergence,
+};
+
+// The minimum and maximum of the values a float tensor took, and a histogram
+// of their magnitudes. The histogram has a fixed number of bins, and merges
+// pairs of them whenever a value falls beyond its range.
+class TensorRangeStats {
+ public:
+  static constexpr int kNumBins = 2048;
+
+  void Update(const float* values, int size);
+
+  bool empty() const { return count_ == 0; }
+  float min() const { return min_; }
+  float max() const { return max_; }
+  float bin_width() const { return bin_width_; }
+  const std::vector<int64_t>& histogram() const { return histogram_; }
+
+  // Returns the range to quantize the tensor with, which always contains 0.
+  void GetRange(RangeMethod method, float* min, float* max) const;
+
+  // Returns the magnitude beyond which values are clipped so as to minimize
+  // the KL divergence between the histogram and its quantization into
+  // 'num_levels' levels.
+  float KlDivergenceThreshold(int num_levels) const;
+
+ private:
+  int64_t count_ = 0;
+  float min_ = 0;
+  float max_ = 0;
+  float bin_width_ = 0;
+  std::vector<int64_t> histogram_ = std::vector<int64_t>(kNumBins);
+};
+
+// Records the ranges of the float activations of a model while an
+// interpreter runs it on a representative dataset.
+class Calibrator {
+ public:
+  // Observes 'interpreter', which must outlive the calibrator, until the
+  // calibrator is destroyed.
+  explicit Calibrator(Interpreter* interpreter);
+  ~Calibrator();
+
+  // Invokes the interpreter on the values already in its inputs, recording
+  // those and the values of every float tensor its ops write.
+  TfLiteStatus Invoke();
+
+  // The statistics of the tensors seen so far, by tensor index.
+  const std::map<int, TensorRangeStats>& stats() const { return stats_; }
+
+ private:
+  void RecordTensor(int tensor_index);
+
+  Interpreter* interpreter_;
+  std::map<int, TensorRangeStats> stats_;
+};
+
+// Writes to 'output' a copy of the float 'model' in which the tensors of its
+// first subgraph that the calibrator saw are annotated with their ranges, in
+// the min and max of their quantization parameters. toco uses those as the
+// ranges of the arrays when quantizing the model.
+TfLiteStatus WriteModelWithRanges(const ::tflite::Model* model,
+                                  const Calibrator& calibrator,
+                                  RangeMethod method,
+                                  ErrorReporter* error_reporter,
+                                  string* output);
+
+}  // namespace calibration
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_TOOLS_CALIBRATION_CALIBRATOR_H_
@@ -0,0 +1,111 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/tools/calibration/calibrator.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace calibration {
+namespace {
+
+TEST(CalibratorTest, RecordsInputAndActivationRanges) {
+  // A single op, 0 -> 1, that subtracts one.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {2}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg_decrement = {nullptr, nullptr, nullptr, nullptr};
+  reg_decrement.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < 2; ++i) {
+      output->data.f[i] = input->data.f[i] - 1;
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg_decrement),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  Calibrator calibrator(&interpreter);
+  const std::vector<std::vector<float>> dataset = {{1, 3}, {-2, 0.5}};
+  for (const auto& sample : dataset) {
+    std::copy(sample.begin(), sample.end(), interpreter.typed_tensor<float>(0));
+    ASSERT_EQ(calibrator.Invoke(), kTfLiteOk);
+  }
+
+  ASSERT_EQ(calibrator.stats().size(), 2);
+  const TensorRangeStats& input_stats = calibrator.stats().at(0);
+  EXPECT_EQ(input_stats.min(), -2);
+  EXPECT_EQ(input_stats.max(), 3);
+  const TensorRangeStats& output_stats = calibrator.stats().at(1);
+  EXPECT_EQ(output_stats.min(), -3);
+  EXPECT_EQ(output_stats.max(), 2);
+
+  float min, max;
+  output_stats.GetRange(RangeMethod::kMinMax, &min, &max);
+  EXPECT_EQ(min, -3);
+  EXPECT_EQ(max, 2);
+}
+
+TEST(CalibratorTest, RangeAlwaysContainsZero) {
+  TensorRangeStats stats;
+  const float values[] = {2, 5};
+  stats.Update(values, 2);
+  float min, max;
+  stats.GetRange(RangeMethod::kMinMax, &min, &max);
+  EXPECT_EQ(min, 0);
+  EXPECT_EQ(max, 5);
+}
+
+TEST(CalibratorTest, KlDivergenceClipsOutliers) {
+  TensorRangeStats stats;
+  std::vector<float> values;
+  for (int i = 0; i <= 10000; ++i) {
+    values.push_back(i / 10000.0f);
+  }
+  values.push_back(100);
+  stats.Update(values.data(), values.size());
+
+  float min, max;
+  stats.GetRange(RangeMethod::kMinMax, &min, &max);
+  EXPECT_EQ(min, 0);
+  EXPECT_EQ(max, 100);
+
+  stats.GetRange(RangeMethod::kKlDivergence, &min, &max);
+  EXPECT_EQ(min, 0);
+  EXPECT_GE(max, 1);
+  EXPECT_LT(max, 20);
+}
+
+}  // namespace
+}  // namespace calibration
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -310,12 +310,17 @@ class MutableHashTable(LookupInterface):
                default_value,
                shared_name=None,
                name="MutableHashTable",
-               checkpoint=True):
+               checkpoint=True,
+               max_size=0):
     """Creates an empty `MutableHashTable` object.
 
     Creates a table, the type of its keys and values are specified by key_dtype
     and value_dtype, respectively.
 
+    A table with vector values, e.g. of embeddings keyed by ids, can be bounded
+    with `max_size`: inserts that would grow it beyond `max_size` keys first
+    evict the keys that lookups found least often.
+
     Args:
       key_dtype: the type of the key tensors.
       value_dtype: the type of the value tensors.
@@ -326,16 +331,21 @@ class MutableHashTable(LookupInterface):
       checkpoint: if True, the contents of the table are saved to and restored
         from checkpoints. If `shared_name` is empty for a checkpointed table, it
         is shared using the table node name.
+      max_size: If positive, the maximum number of keys in the table. Only
+        supported for vector values.
 
     Returns:
       A `MutableHashTable` object.
 
     Raises:
-      ValueError: If checkpoint is True and no name was specified.
+      ValueError: If checkpoint is True and no name was specified, or if
+        max_size is positive for scalar values.
     """
     self._default_value = ops.convert_to_tensor(default_value,
                                                 dtype=value_dtype)
     self._value_shape = self._default_value.get_shape()
+    if max_size and self._default_value.get_shape().ndims == 0:
+      raise ValueError("max_size is only supported for vector values.")
 
     # The table must be shared if checkpointing is requested for multi-worker
     # training to work correctly. Use the node name if no shared_name has been
@@ -355,6 +365,7 @@ class MutableHashTable(LookupInterface):
           key_dtype=key_dtype,
           value_dtype=value_dtype,
           value_shape=self._default_value.get_shape(),
+          max_size=max_size,
           name=name)
     super(MutableHashTable, self).__init__(key_dtype, value_dtype,
                                            self._table_ref.op.name.split(
@@ -715,6 +715,63 @@ class MutableHashTableOpTest(test.TestCase):
       result = output.eval()
       self.assertAllEqual((b"brain", b"salad", b"n/a"), result)
 
+  def testMutableHashTableOfTensorsMaxSize(self):
+    with self.test_session():
+      default_val = constant_op.constant([-1, -1], dtypes.float32)
+      table = lookup.MutableHashTable(
+          dtypes.int64, dtypes.float32, default_val, max_size=3)
+      table.insert(
+          constant_op.constant([1, 2, 3], dtypes.int64),
+          constant_op.constant([[1, 1], [2, 2], [3, 3]], dtypes.float32)).run()
+      self.assertAllEqual(3, table.size().eval())
+
+      # Finds 1 twice and 2 once, so 3 is evicted first.
+      table.lookup(constant_op.constant([1, 1, 2], dtypes.int64)).eval()
+      table.insert(
+          constant_op.constant([4], dtypes.int64),
+          constant_op.constant([[4, 4]], dtypes.float32)).run()
+      self.assertAllEqual(3, table.size().eval())
+      output = table.lookup(constant_op.constant([1, 2, 3, 4], dtypes.int64))
+      self.assertAllEqual([[1, 1], [2, 2], [-1, -1], [4, 4]], output.eval())
+
+      # The keys being inserted are never evicted, even if found least often.
+      table.lookup(constant_op.constant([1], dtypes.int64)).eval()
+      table.insert(
+          constant_op.constant([2, 5], dtypes.int64),
+          constant_op.constant([[20, 20], [5, 5]], dtypes.float32)).run()
+      self.assertAllEqual(3, table.size().eval())
+      output = table.lookup(constant_op.constant([1, 2, 4, 5], dtypes.int64))
+      self.assertAllEqual([[1, 1], [20, 20], [-1, -1], [5, 5]], output.eval())
+
+      with self.assertRaisesOpError("Cannot insert 4 distinct keys"):
+        table.insert(
+            constant_op.constant([6, 7, 8, 9], dtypes.int64),
+            constant_op.constant([[6, 6], [7, 7], [8, 8], [9, 9]],
+                                 dtypes.float32)).run()
+
+  def testMutableHashTableMaxSizeScalarValues(self):
+    with self.assertRaisesRegexp(ValueError, "only supported for vector"):
+      lookup.MutableHashTable(dtypes.int64, dtypes.int64, -1, max_size=3)
+
+  def testMutableHashTableManyKeys(self):
+    with self.test_session():
+      default_val = -1
+      num_keys = 1000
+      keys = constant_op.constant(np.arange(num_keys), dtypes.int64)
+      values = constant_op.constant(2 * np.arange(num_keys), dtypes.int64)
+      table = lookup.MutableHashTable(dtypes.int64, dtypes.int64, default_val)
+      table.insert(keys, values).run()
+      self.assertAllEqual(num_keys, table.size().eval())
+
+      output = table.lookup(
+          constant_op.constant([999, 0, num_keys, 500], dtypes.int64))
+      self.assertAllEqual([1998, 0, default_val, 1000], output.eval())
+
+      # exported data is in the order of the internal map, i.e. undefined
+      exported_keys, exported_values = [t.eval() for t in table.export()]
+      self.assertAllEqual(2 * exported_keys, exported_values)
+      self.assertAllEqual(np.arange(num_keys), np.sort(exported_keys))
+
 
 class MutableDenseHashTableOpTest(test.TestCase):
 
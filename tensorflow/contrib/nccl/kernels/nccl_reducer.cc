@@ -0,0 +1,55 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "third_party/nccl/nccl.h"
+#include "tensorflow/contrib/nccl/kernels/nccl_manager.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs the CollectiveReduce of one device as a participant of an NCCL
+// all-reduce.  The stream syncing and memory management are those of
+// NcclAllReduceOpKernel, see nccl_ops.cc.
+void NcclReduce(OpKernelContext* ctx, const CollectiveParams& col_params,
+                const string& exec_key, int64 step_id, const Tensor* input,
+                Tensor* output, const StatusCallback& done) {
+  // CollectiveReduce only allows the "Add" and "Mul" merge ops.
+  const ncclRedOp_t reduction_op =
+      col_params.merge_op->type_string() == "Mul" ? ncclProd : ncclSum;
+  // The exec_key is the same in every step, and a device may start the next
+  // step before all others joined the current one.
+  const string key = strings::StrCat("collective:", step_id, ":", exec_key);
+  auto* compute_stream = ctx->op_device_context()->stream();
+  auto* gpu_info = ctx->device()->tensorflow_gpu_device_info();
+  NcclManager::instance()->AddToAllReduce(
+      col_params.group.group_size, key, reduction_op, compute_stream->parent(),
+      gpu_info->gpu_id, gpu_info->event_mgr, compute_stream, input, output,
+      done);
+}
+
+struct NcclReduceRegistration {
+  NcclReduceRegistration() { RegisterNcclReduceFunction(NcclReduce); }
+};
+static NcclReduceRegistration nccl_reduce_registration;
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
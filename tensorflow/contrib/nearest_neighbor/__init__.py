@@ -25,6 +25,16 @@ The following ops generate multiprobe sequences for various hash families.
 
 @@hyperplane_lsh_hash
 
+### Indexes
+
+The following ops build and query indexes for approximate nearest neighbor
+search.
+
+@@ivf_index
+@@build_ivf_index
+@@ivf_index_search
+@@IvfIndexSaveable
+
 """
 
 from __future__ import absolute_import
@@ -0,0 +1,351 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+
+namespace tensorflow {
+namespace nearest_neighbor {
+
+namespace {
+
+using Matrix = IvfIndex::Matrix;
+using ConstMatrixMap = IvfIndex::ConstMatrixMap;
+
+// The maximum number of points per list used to train the centroids.
+constexpr int64 kMaxTrainingPointsPerList = 256;
+
+// The number of points assigned to centroids with one matrix product.
+constexpr int64 kAssignBlockSize = 256;
+
+// The version of the serialized format.
+constexpr uint32 kFormatVersion = 1;
+
+void ParallelFor(thread::ThreadPool* pool, int64 total, int64 cost_per_unit,
+                 const std::function<void(int64, int64)>& fn) {
+  if (pool == nullptr) {
+    fn(0, total);
+  } else {
+    pool->ParallelFor(total, cost_per_unit, fn);
+  }
+}
+
+// Stores the index of the closest of 'centroids' to each row of 'points' in
+// 'assignments'. 'centroid_norms' holds the squared norms of the centroids.
+void AssignToCentroids(ConstMatrixMap points, const Matrix& centroids,
+                       const Eigen::VectorXf& centroid_norms,
+                       thread::ThreadPool* pool, int32* assignments) {
+  auto assign = [&points, &centroids, &centroid_norms, assignments](
+                    int64 start, int64 end) {
+    Matrix distances;
+    for (int64 block_start = start; block_start < end;
+         block_start += kAssignBlockSize) {
+      const int64 block_size = std::min(kAssignBlockSize, end - block_start);
+      // The squared distances, less the squared norms of the points.
+      distances.noalias() =
+          points.middleRows(block_start, block_size) * centroids.transpose();
+      distances *= -2;
+      distances.rowwise() += centroid_norms.transpose();
+      for (int64 i = 0; i < block_size; ++i) {
+        Eigen::Index closest;
+        distances.row(i).minCoeff(&closest);
+        assignments[block_start + i] = closest;
+      }
+    }
+  };
+  ParallelFor(pool, points.rows(), 2 * centroids.rows() * centroids.cols(),
+              assign);
+}
+
+template <typename T>
+void AppendValues(const T* values, int64 num_values, string* output) {
+  output->append(reinterpret_cast<const char*>(values),
+                 num_values * sizeof(T));
+}
+
+template <typename T>
+void ConsumeValues(StringPiece* input, int64 num_values, T* values) {
+  const size_t num_bytes = num_values * sizeof(T);
+  DCHECK_GE(input->size(), num_bytes);
+  std::memcpy(values, input->data(), num_bytes);
+  input->remove_prefix(num_bytes);
+}
+
+}  // namespace
+
+Status IvfIndex::Build(ConstMatrixMap points, Metric metric, int num_lists,
+                       int num_iterations, uint64 seed,
+                       thread::ThreadPool* pool,
+                       std::unique_ptr<IvfIndex>* index) {
+  const int64 num_points = points.rows();
+  const int dimension = points.cols();
+  if (num_points < 1 || dimension < 1) {
+    return errors::InvalidArgument(
+        "Need at least one point with at least one dimension, got ",
+        num_points, " points with ", dimension, " dimensions.");
+  }
+  if (num_lists < 1 || num_lists > num_points) {
+    return errors::InvalidArgument(
+        "num_lists must be between 1 and the number of points ", num_points,
+        ", got ", num_lists, ".");
+  }
+  if (num_iterations < 0) {
+    return errors::InvalidArgument("num_iterations must be non-negative, got ",
+                                   num_iterations, ".");
+  }
+
+  // Sample the training points without replacement, with Floyd's algorithm,
+  // and shuffle them.
+  random::PhiloxRandom philox(seed);
+  random::SimplePhilox rng(&philox);
+  const int64 num_training_points =
+      std::min(num_points, num_lists * kMaxTrainingPointsPerList);
+  std::vector<int64> training_ids;
+  training_ids.reserve(num_training_points);
+  if (num_training_points == num_points) {
+    training_ids.resize(num_points);
+    std::iota(training_ids.begin(), training_ids.end(), 0);
+  } else {
+    std::unordered_set<int64> chosen;
+    for (int64 i = num_points - num_training_points; i < num_points; ++i) {
+      int64 id = rng.Uniform64(i + 1);
+      if (!chosen.insert(id).second) {
+        id = i;
+        chosen.insert(id);
+      }
+      training_ids.push_back(id);
+    }
+  }
+  for (int64 i = num_training_points - 1; i > 0; --i) {
+    std::swap(training_ids[i], training_ids[rng.Uniform64(i + 1)]);
+  }
+  Matrix training_points(num_training_points, dimension);
+  for (int64 i = 0; i < num_training_points; ++i) {
+    training_points.row(i) = points.row(training_ids[i]);
+  }
+
+  // Start from the first training points, and run Lloyd's algorithm. Lists
+  // that end up empty keep their centroid.
+  Matrix centroids = training_points.topRows(num_lists);
+  std::vector<int32> assignments(num_training_points);
+  for (int iteration = 0; iteration < num_iterations; ++iteration) {
+    const Eigen::VectorXf centroid_norms = centroids.rowwise().squaredNorm();
+    AssignToCentroids(ConstMatrixMap(training_points.data(),
+                                     num_training_points, dimension),
+                      centroids, centroid_norms, pool, assignments.data());
+    Matrix sums = Matrix::Zero(num_lists, dimension);
+    std::vector<int64> counts(num_lists, 0);
+    for (int64 i = 0; i < num_training_points; ++i) {
+      sums.row(assignments[i]) += training_points.row(i);
+      ++counts[assignments[i]];
+    }
+    for (int list = 0; list < num_lists; ++list) {
+      if (counts[list] > 0) {
+        centroids.row(list) = sums.row(list) / counts[list];
+      }
+    }
+  }
+
+  // Assign all the points, and group them by list.
+  std::unique_ptr<IvfIndex> result(new IvfIndex(metric, dimension));
+  assignments.resize(num_points);
+  AssignToCentroids(points, centroids, centroids.rowwise().squaredNorm(), pool,
+                    assignments.data());
+  result->centroids_ = std::move(centroids);
+  result->list_offsets_.assign(num_lists + 1, 0);
+  for (const int32 list : assignments) {
+    ++result->list_offsets_[list + 1];
+  }
+  std::partial_sum(result->list_offsets_.begin(), result->list_offsets_.end(),
+                   result->list_offsets_.begin());
+  std::vector<int64> next_offsets(result->list_offsets_.begin(),
+                                  result->list_offsets_.end() - 1);
+  result->points_.resize(num_points, dimension);
+  result->ids_.resize(num_points);
+  for (int64 i = 0; i < num_points; ++i) {
+    const int64 offset = next_offsets[assignments[i]]++;
+    result->points_.row(offset) = points.row(i);
+    result->ids_[offset] = i;
+  }
+  result->ComputeNorms();
+  *index = std::move(result);
+  return Status::OK();
+}
+
+Status IvfIndex::Parse(StringPiece serialized,
+                       std::unique_ptr<IvfIndex>* index) {
+  uint32 version, metric, dimension, num_lists;
+  uint64 num_points;
+  if (!core::GetVarint32(&serialized, &version) ||
+      !core::GetVarint32(&serialized, &metric) ||
+      !core::GetVarint32(&serialized, &dimension) ||
+      !core::GetVarint32(&serialized, &num_lists) ||
+      !core::GetVarint64(&serialized, &num_points)) {
+    return errors::DataLoss("Truncated IVF index header.");
+  }
+  if (version != kFormatVersion) {
+    return errors::InvalidArgument("Unsupported IVF index version ", version,
+                                   ".");
+  }
+  if (metric > static_cast<uint32>(Metric::kInnerProduct) || dimension < 1 ||
+      num_lists < 1 || dimension > serialized.size() ||
+      num_lists > serialized.size() || num_points > serialized.size()) {
+    return errors::DataLoss("Corrupted IVF index header.");
+  }
+  const uint64 expected_size =
+      (static_cast<uint64>(num_lists) + num_points) * dimension *
+          sizeof(float) +
+      (num_lists + 1 + num_points) * sizeof(int64);
+  if (serialized.size() != expected_size) {
+    return errors::DataLoss("Expected ", expected_size,
+                            " bytes of IVF index data, got ",
+                            serialized.size(), ".");
+  }
+
+  std::unique_ptr<IvfIndex> result(
+      new IvfIndex(static_cast<Metric>(metric), dimension));
+  result->centroids_.resize(num_lists, dimension);
+  ConsumeValues(&serialized, result->centroids_.size(),
+                result->centroids_.data());
+  result->list_offsets_.resize(num_lists + 1);
+  ConsumeValues(&serialized, num_lists + 1, result->list_offsets_.data());
+  result->ids_.resize(num_points);
+  ConsumeValues(&serialized, num_points, result->ids_.data());
+  result->points_.resize(num_points, dimension);
+  ConsumeValues(&serialized, result->points_.size(), result->points_.data());
+
+  if (result->list_offsets_.front() != 0 ||
+      result->list_offsets_.back() != static_cast<int64>(num_points) ||
+      !std::is_sorted(result->list_offsets_.begin(),
+                      result->list_offsets_.end())) {
+    return errors::DataLoss("Corrupted IVF index lists.");
+  }
+  result->ComputeNorms();
+  *index = std::move(result);
+  return Status::OK();
+}
+
+void IvfIndex::SerializeToString(string* output) const {
+  output->clear();
+  core::PutVarint32(output, kFormatVersion);
+  core::PutVarint32(output, static_cast<uint32>(metric_));
+  core::PutVarint32(output, dimension_);
+  core::PutVarint32(output, num_lists());
+  core::PutVarint64(output, num_points());
+  output->reserve(output->size() +
+                  (centroids_.size() + points_.size()) * sizeof(float) +
+                  (list_offsets_.size() + ids_.size()) * sizeof(int64));
+  AppendValues(centroids_.data(), centroids_.size(), output);
+  AppendValues(list_offsets_.data(), list_offsets_.size(), output);
+  AppendValues(ids_.data(), ids_.size(), output);
+  AppendValues(points_.data(), points_.size(), output);
+}
+
+void IvfIndex::ComputeNorms() {
+  centroid_norms_ = centroids_.rowwise().squaredNorm();
+  point_norms_ = points_.rowwise().squaredNorm();
+  max_list_size_ = 0;
+  for (int list = 0; list < num_lists(); ++list) {
+    max_list_size_ = std::max(max_list_size_, list_offsets_[list + 1] -
+                                                  list_offsets_[list]);
+  }
+}
+
+void IvfIndex::Search(const float* query, int k, int num_probes, int64* ids,
+                      float* scores) const {
+  if (k <= 0) {
+    return;
+  }
+  const bool squared_l2 = metric_ == Metric::kSquaredL2;
+  const Eigen::Map<const Eigen::VectorXf> query_vector(query, dimension_);
+
+  // Points and centroids are ranked by increasing distance: their squared
+  // distances less the squared norm of the query, or their negated inner
+  // products.
+  // Find the lists to probe.
+  num_probes = std::max(1, std::min(num_probes, num_lists()));
+  Eigen::VectorXf centroid_distances(num_lists());
+  centroid_distances.noalias() = centroids_ * query_vector;
+  if (squared_l2) {
+    centroid_distances = centroid_norms_ - 2 * centroid_distances;
+  } else {
+    centroid_distances = -centroid_distances;
+  }
+  std::vector<int32> lists(num_lists());
+  std::iota(lists.begin(), lists.end(), 0);
+  std::partial_sort(lists.begin(), lists.begin() + num_probes, lists.end(),
+                    [&centroid_distances](int32 a, int32 b) {
+                      return centroid_distances(a) < centroid_distances(b);
+                    });
+
+  // Scan the lists, keeping a max-heap of the 'k' closest points.
+  std::vector<std::pair<float, int64>> closest;
+  closest.reserve(k);
+  Eigen::VectorXf distances(max_list_size_);
+  for (int probe = 0; probe < num_probes; ++probe) {
+    const int32 list = lists[probe];
+    const int64 begin = list_offsets_[list];
+    const int64 size = list_offsets_[list + 1] - begin;
+    if (size == 0) {
+      continue;
+    }
+    auto list_distances = distances.head(size);
+    list_distances.noalias() = points_.middleRows(begin, size) * query_vector;
+    if (squared_l2) {
+      list_distances = point_norms_.segment(begin, size) - 2 * list_distances;
+    } else {
+      list_distances = -list_distances;
+    }
+    for (int64 i = 0; i < size; ++i) {
+      if (closest.size() < static_cast<size_t>(k)) {
+        closest.emplace_back(list_distances(i), ids_[begin + i]);
+        std::push_heap(closest.begin(), closest.end());
+      } else if (list_distances(i) < closest.front().first) {
+        std::pop_heap(closest.begin(), closest.end());
+        closest.back() = std::make_pair(list_distances(i), ids_[begin + i]);
+        std::push_heap(closest.begin(), closest.end());
+      }
+    }
+  }
+  std::sort_heap(closest.begin(), closest.end());
+
+  const float query_norm = query_vector.squaredNorm();
+  for (int i = 0; i < k; ++i) {
+    if (i < static_cast<int>(closest.size())) {
+      ids[i] = closest[i].second;
+      scores[i] = squared_l2 ? std::max(0.0f, closest[i].first + query_norm)
+                             : -closest[i].first;
+    } else {
+      ids[i] = -1;
+      scores[i] = squared_l2 ? std::numeric_limits<float>::infinity()
+                             : -std::numeric_limits<float>::infinity();
+    }
+  }
+}
+
+}  // namespace nearest_neighbor
+}  // namespace tensorflow
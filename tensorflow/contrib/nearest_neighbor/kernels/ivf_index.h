@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
+#define TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
+
+#include <memory>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace nearest_neighbor {
+
+// An inverted file (IVF) index for approximate nearest neighbor search.
+//
+// The points are clustered with k-means, and each cluster is kept as a list
+// of its points. A search scores the query against the centroids first, and
+// then only against the points of the 'num_probes' best lists, so that it
+// scans about num_probes / num_lists of the points. The points of a list are
+// stored contiguously, so that scoring a list is a single vectorized
+// matrix-vector product.
+//
+// This class is immutable after construction and thread safe.
+class IvfIndex {
+ public:
+  enum class Metric {
+    // Smaller squared Euclidean distances are better.
+    kSquaredL2,
+    // Larger inner products are better.
+    kInnerProduct,
+  };
+
+  using Matrix =
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using ConstMatrixMap = Eigen::Map<const Matrix>;
+
+  // Builds an index of the rows of 'points', whose ids are their row indices.
+  // The centroids are trained by 'num_iterations' iterations of Lloyd's
+  // algorithm on a sample of at most 256 points per list, drawn with 'seed'.
+  // Uses 'pool' to parallelize over points if it is not nullptr.
+  static Status Build(ConstMatrixMap points, Metric metric, int num_lists,
+                      int num_iterations, uint64 seed,
+                      thread::ThreadPool* pool,
+                      std::unique_ptr<IvfIndex>* index);
+
+  // Parses an index serialized by SerializeToString().
+  static Status Parse(StringPiece serialized, std::unique_ptr<IvfIndex>* index);
+
+  // Serializes the index. Floats and ids are stored in host byte order, which
+  // is little endian on all the supported platforms.
+  void SerializeToString(string* output) const;
+
+  Metric metric() const { return metric_; }
+  int dimension() const { return dimension_; }
+  int num_lists() const { return list_offsets_.size() - 1; }
+  int64 num_points() const { return ids_.size(); }
+
+  // Finds the 'k' best points for the 'dimension()' values of 'query' among
+  // the points of its 'num_probes' best lists. Stores their ids and squared
+  // distances or inner products in 'ids' and 'scores', which must have room
+  // for 'k' values, best first. If fewer than 'k' points are found, pads
+  // 'ids' with -1 and 'scores' with the worst possible score.
+  void Search(const float* query, int k, int num_probes, int64* ids,
+              float* scores) const;
+
+ private:
+  IvfIndex(Metric metric, int dimension)
+      : metric_(metric), dimension_(dimension) {}
+
+  // Computes the norms used to score against 'centroids_' and 'points_'.
+  void ComputeNorms();
+
+  const Metric metric_;
+  const int dimension_;
+
+  // The centroids of the lists, and their squared norms.
+  Matrix centroids_;
+  Eigen::VectorXf centroid_norms_;
+
+  // The points, grouped by list: the points of list i are the rows
+  // [list_offsets_[i], list_offsets_[i + 1]) of 'points_', and their squared
+  // norms and ids are at the same positions in 'point_norms_' and 'ids_'.
+  std::vector<int64> list_offsets_;
+  Matrix points_;
+  Eigen::VectorXf point_norms_;
+  std::vector<int64> ids_;
+
+  // The size of the largest list.
+  int64 max_list_size_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IvfIndex);
+};
+
+}  // namespace nearest_neighbor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
@@ -0,0 +1,267 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+namespace tensorflow {
+
+using errors::FailedPrecondition;
+using errors::InvalidArgument;
+
+using nearest_neighbor::IvfIndex;
+
+// A resource holding an IVF index, which is null until it is built or
+// restored. The index itself is immutable, so searches only hold the mutex
+// shared while they use it, and rebuilding it swaps in a new one.
+class IvfIndexResource : public ResourceBase {
+ public:
+  string DebugString() override {
+    tf_shared_lock l(mu_);
+    if (index_ == nullptr) {
+      return "IvfIndex[empty]";
+    }
+    return strings::StrCat("IvfIndex[points=", index_->num_points(),
+                           ", lists=", index_->num_lists(), "]");
+  }
+
+  mutex* mu() { return &mu_; }
+
+  const IvfIndex* index() const SHARED_LOCKS_REQUIRED(mu_) {
+    return index_.get();
+  }
+
+  void set_index(std::unique_ptr<const IvfIndex> index)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    index_ = std::move(index);
+  }
+
+ private:
+  mutex mu_;
+  std::unique_ptr<const IvfIndex> index_ GUARDED_BY(mu_);
+};
+
+class CreateIvfIndexOp : public OpKernel {
+ public:
+  explicit CreateIvfIndexOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    // Only create one, if one does not exist already. Report status for all
+    // other exceptions.
+    auto status = CreateResource(context, HandleFromInput(context, 0),
+                                 new IvfIndexResource);
+    if (!status.ok() && status.code() != error::ALREADY_EXISTS) {
+      OP_REQUIRES(context, false, status);
+    }
+  }
+};
+
+class BuildIvfIndexOp : public OpKernel {
+ public:
+  explicit BuildIvfIndexOp(OpKernelConstruction* context) : OpKernel(context) {
+    string metric;
+    OP_REQUIRES_OK(context, context->GetAttr("metric", &metric));
+    metric_ = metric == "inner_product" ? IvfIndex::Metric::kInnerProduct
+                                        : IvfIndex::Metric::kSquaredL2;
+    OP_REQUIRES_OK(context, context->GetAttr("num_lists", &num_lists_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("num_iterations", &num_iterations_));
+    int64 seed;
+    OP_REQUIRES_OK(context, context->GetAttr("seed", &seed));
+    seed_ = seed;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+
+    const Tensor& points_tensor = context->input(1);
+    OP_REQUIRES(context, points_tensor.dims() == 2,
+                InvalidArgument("Need a two-dimensional points tensor, got ",
+                                points_tensor.dims(), " dimensions."));
+    auto points = points_tensor.matrix<float>();
+    IvfIndex::ConstMatrixMap points_matrix(
+        points.data(), points_tensor.dim_size(0), points_tensor.dim_size(1));
+
+    // Build the index without holding the lock, so that searches can go on
+    // with the previous one.
+    std::unique_ptr<IvfIndex> index;
+    OP_REQUIRES_OK(
+        context,
+        IvfIndex::Build(
+            points_matrix, metric_, num_lists_, num_iterations_, seed_,
+            context->device()->tensorflow_cpu_worker_threads()->workers,
+            &index));
+    mutex_lock l(*resource->mu());
+    resource->set_index(std::move(index));
+  }
+
+ private:
+  IvfIndex::Metric metric_;
+  int num_lists_;
+  int num_iterations_;
+  uint64 seed_;
+};
+
+class IvfIndexSerializeOp : public OpKernel {
+ public:
+  explicit IvfIndexSerializeOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    Tensor* serialized_tensor = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, TensorShape(),
+                                                     &serialized_tensor));
+    tf_shared_lock l(*resource->mu());
+    if (resource->index() != nullptr) {
+      resource->index()->SerializeToString(
+          &serialized_tensor->scalar<string>()());
+    }
+  }
+};
+
+class IvfIndexDeserializeOp : public OpKernel {
+ public:
+  explicit IvfIndexDeserializeOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+
+    const Tensor& serialized_tensor = context->input(1);
+    OP_REQUIRES(context, serialized_tensor.dims() == 0,
+                InvalidArgument("Need a scalar serialized_index tensor, got ",
+                                serialized_tensor.dims(), " dimensions."));
+    const string& serialized = serialized_tensor.scalar<string>()();
+    std::unique_ptr<IvfIndex> index;
+    if (!serialized.empty()) {
+      OP_REQUIRES_OK(context, IvfIndex::Parse(serialized, &index));
+    }
+    mutex_lock l(*resource->mu());
+    resource->set_index(std::move(index));
+  }
+};
+
+class IvfIndexSearchOp : public OpKernel {
+ public:
+  explicit IvfIndexSearchOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+
+    const Tensor& queries_tensor = context->input(1);
+    OP_REQUIRES(context, queries_tensor.dims() == 2,
+                InvalidArgument("Need a two-dimensional queries tensor, got ",
+                                queries_tensor.dims(), " dimensions."));
+
+    const Tensor& k_tensor = context->input(2);
+    OP_REQUIRES(context, k_tensor.dims() == 0,
+                InvalidArgument("Need a scalar k tensor, got ",
+                                k_tensor.dims(), " dimensions."));
+    const int k = k_tensor.scalar<int32>()();
+    OP_REQUIRES(context, k >= 1,
+                InvalidArgument("k must be at least 1 but got ", k, "."));
+
+    const Tensor& num_probes_tensor = context->input(3);
+    OP_REQUIRES(context, num_probes_tensor.dims() == 0,
+                InvalidArgument("Need a scalar num_probes tensor, got ",
+                                num_probes_tensor.dims(), " dimensions."));
+    const int num_probes = num_probes_tensor.scalar<int32>()();
+    OP_REQUIRES(context, num_probes >= 1,
+                InvalidArgument("num_probes must be at least 1 but got ",
+                                num_probes, "."));
+
+    tf_shared_lock l(*resource->mu());
+    const IvfIndex* index = resource->index();
+    OP_REQUIRES(context, index != nullptr,
+                FailedPrecondition("The IVF index has not been built."));
+    OP_REQUIRES(context, queries_tensor.dim_size(1) == index->dimension(),
+                InvalidArgument("Expected queries with ", index->dimension(),
+                                " dimensions but received ",
+                                queries_tensor.dim_size(1), "."));
+
+    const int64 batch_size = queries_tensor.dim_size(0);
+    Tensor* ids_tensor = nullptr;
+    Tensor* scores_tensor = nullptr;
+    TensorShape output_shape({batch_size, k});
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &ids_tensor));
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, output_shape, &scores_tensor));
+    auto queries = queries_tensor.matrix<float>();
+    auto ids = ids_tensor->matrix<int64>();
+    auto scores = scores_tensor->matrix<float>();
+
+    // Each query scores the centroids and the points of about 'num_probes'
+    // average lists.
+    const int64 cost_per_unit =
+        2 * index->dimension() *
+        (index->num_lists() +
+         index->num_points() * std::min(num_probes, index->num_lists()) /
+             index->num_lists());
+    context->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        batch_size, cost_per_unit, [&](int64 start, int64 end) {
+          for (int64 query_index = start; query_index < end; ++query_index) {
+            index->Search(&queries(query_index, 0), k, num_probes,
+                          &ids(query_index, 0), &scores(query_index, 0));
+          }
+        });
+  }
+};
+
+REGISTER_RESOURCE_HANDLE_KERNEL(IvfIndexResource);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexIsInitialized").Device(DEVICE_CPU),
+                        IsResourceInitialized<IvfIndexResource>);
+
+REGISTER_KERNEL_BUILDER(Name("CreateIvfIndex").Device(DEVICE_CPU),
+                        CreateIvfIndexOp);
+
+REGISTER_KERNEL_BUILDER(Name("BuildIvfIndex").Device(DEVICE_CPU),
+                        BuildIvfIndexOp);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexSerialize").Device(DEVICE_CPU),
+                        IvfIndexSerializeOp);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexDeserialize").Device(DEVICE_CPU),
+                        IvfIndexDeserializeOp);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexSearch").Device(DEVICE_CPU),
+                        IvfIndexSearchOp);
+
+}  // namespace tensorflow
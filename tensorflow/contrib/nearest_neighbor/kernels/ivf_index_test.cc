@@ -0,0 +1,180 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace nearest_neighbor {
+namespace {
+
+using Matrix = IvfIndex::Matrix;
+using ConstMatrixMap = IvfIndex::ConstMatrixMap;
+
+Matrix RandomMatrix(int64 rows, int cols, random::SimplePhilox* rng) {
+  Matrix matrix(rows, cols);
+  for (int64 i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      matrix(i, j) = rng->RandFloat() - 0.5f;
+    }
+  }
+  return matrix;
+}
+
+ConstMatrixMap AsMap(const Matrix& matrix) {
+  return ConstMatrixMap(matrix.data(), matrix.rows(), matrix.cols());
+}
+
+// Returns the ids of the 'k' best rows of 'points' for 'query', and their
+// scores, by brute force.
+std::vector<std::pair<float, int64>> BruteForceSearch(
+    const Matrix& points, const Eigen::RowVectorXf& query,
+    IvfIndex::Metric metric, int k) {
+  std::vector<std::pair<float, int64>> results;
+  for (int64 i = 0; i < points.rows(); ++i) {
+    if (metric == IvfIndex::Metric::kSquaredL2) {
+      results.emplace_back((points.row(i) - query).squaredNorm(), i);
+    } else {
+      results.emplace_back(-points.row(i).dot(query), i);
+    }
+  }
+  std::partial_sort(results.begin(), results.begin() + k, results.end());
+  results.resize(k);
+  if (metric == IvfIndex::Metric::kInnerProduct) {
+    for (auto& result : results) {
+      result.first = -result.first;
+    }
+  }
+  return results;
+}
+
+void ExpectExactSearch(IvfIndex::Metric metric) {
+  random::PhiloxRandom philox(7);
+  random::SimplePhilox rng(&philox);
+  const Matrix points = RandomMatrix(500, 8, &rng);
+  const Matrix queries = RandomMatrix(5, 8, &rng);
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  std::unique_ptr<IvfIndex> index;
+  TF_ASSERT_OK(
+      IvfIndex::Build(AsMap(points), metric, 10, 5, 1, &pool, &index));
+  EXPECT_EQ(500, index->num_points());
+  EXPECT_EQ(10, index->num_lists());
+  EXPECT_EQ(8, index->dimension());
+
+  const int k = 5;
+  for (int64 q = 0; q < queries.rows(); ++q) {
+    std::vector<int64> ids(k);
+    std::vector<float> scores(k);
+    // Probing all the lists makes the search exact.
+    index->Search(queries.row(q).data(), k, 10, ids.data(), scores.data());
+    const auto expected = BruteForceSearch(points, queries.row(q), metric, k);
+    for (int i = 0; i < k; ++i) {
+      EXPECT_EQ(expected[i].second, ids[i]);
+      EXPECT_NEAR(expected[i].first, scores[i], 1e-4);
+    }
+  }
+}
+
+TEST(IvfIndexTest, ExactSearchSquaredL2) {
+  ExpectExactSearch(IvfIndex::Metric::kSquaredL2);
+}
+
+TEST(IvfIndexTest, ExactSearchInnerProduct) {
+  ExpectExactSearch(IvfIndex::Metric::kInnerProduct);
+}
+
+TEST(IvfIndexTest, ProbesClosestList) {
+  // Two well separated clusters: a single probe finds the closest points.
+  Matrix points(4, 2);
+  points << 0.0, 0.0, 0.0, 1.0, 100.0, 100.0, 100.0, 101.0;
+  std::unique_ptr<IvfIndex> index;
+  TF_ASSERT_OK(IvfIndex::Build(AsMap(points), IvfIndex::Metric::kSquaredL2, 2,
+                               5, 3, nullptr, &index));
+  const float query[] = {99.0, 101.0};
+  int64 ids[3];
+  float scores[3];
+  index->Search(query, 3, 1, ids, scores);
+  EXPECT_EQ(3, ids[0]);
+  EXPECT_FLOAT_EQ(1.0, scores[0]);
+  EXPECT_EQ(2, ids[1]);
+  EXPECT_FLOAT_EQ(2.0, scores[1]);
+  // The other list is not probed.
+  EXPECT_EQ(-1, ids[2]);
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), scores[2]);
+}
+
+TEST(IvfIndexTest, SerializeAndParse) {
+  random::PhiloxRandom philox(11);
+  random::SimplePhilox rng(&philox);
+  const Matrix points = RandomMatrix(200, 4, &rng);
+  std::unique_ptr<IvfIndex> index;
+  TF_ASSERT_OK(IvfIndex::Build(AsMap(points),
+                               IvfIndex::Metric::kInnerProduct, 8, 3, 2,
+                               nullptr, &index));
+  string serialized;
+  index->SerializeToString(&serialized);
+  std::unique_ptr<IvfIndex> parsed;
+  TF_ASSERT_OK(IvfIndex::Parse(serialized, &parsed));
+  EXPECT_EQ(IvfIndex::Metric::kInnerProduct, parsed->metric());
+  EXPECT_EQ(index->num_points(), parsed->num_points());
+  EXPECT_EQ(index->num_lists(), parsed->num_lists());
+
+  const float query[] = {0.1, -0.2, 0.3, 0.4};
+  int64 ids[10], parsed_ids[10];
+  float scores[10], parsed_scores[10];
+  index->Search(query, 10, 2, ids, scores);
+  parsed->Search(query, 10, 2, parsed_ids, parsed_scores);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(ids[i], parsed_ids[i]);
+    EXPECT_EQ(scores[i], parsed_scores[i]);
+  }
+
+  // Truncated data is rejected.
+  EXPECT_FALSE(IvfIndex::Parse(StringPiece(serialized.data(),
+                                           serialized.size() - 1),
+                               &parsed)
+                   .ok());
+  EXPECT_FALSE(IvfIndex::Parse("", &parsed).ok());
+}
+
+TEST(IvfIndexTest, InvalidArguments) {
+  Matrix points(3, 2);
+  points.setZero();
+  std::unique_ptr<IvfIndex> index;
+  EXPECT_FALSE(IvfIndex::Build(AsMap(points), IvfIndex::Metric::kSquaredL2, 4,
+                               1, 0, nullptr, &index)
+                   .ok());
+  EXPECT_FALSE(IvfIndex::Build(AsMap(points), IvfIndex::Metric::kSquaredL2, 0,
+                               1, 0, nullptr, &index)
+                   .ok());
+  EXPECT_FALSE(IvfIndex::Build(AsMap(points), IvfIndex::Metric::kSquaredL2, 1,
+                               -1, 0, nullptr, &index)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace nearest_neighbor
+}  // namespace tensorflow
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/shape_inference.h"
 
 namespace tensorflow {
 
@@ -46,4 +49,131 @@ probes: the output matrix of probes. Size `batch_size` times `num_probes`.
 table_ids: the output matrix of tables ids. Size `batch_size` times `num_probes`.
 )doc");
 
+REGISTER_RESOURCE_HANDLE_OP(IvfIndexResource);
+
+REGISTER_OP("IvfIndexIsInitialized")
+    .Input("index_handle: resource")
+    .Output("is_initialized: bool")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused_input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_input));
+      c->set_output(0, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Checks whether an IVF index has been created.
+)doc");
+
+REGISTER_OP("CreateIvfIndex")
+    .Input("index_handle: resource")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused_input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_input));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Creates an empty IVF index, to be built with BuildIvfIndex or restored with
+IvfIndexDeserialize.
+
+index_handle: Handle to the IVF index resource to be created.
+)doc");
+
+REGISTER_OP("BuildIvfIndex")
+    .Attr("metric: {'squared_l2', 'inner_product'} = 'squared_l2'")
+    .Attr("num_lists: int >= 1")
+    .Attr("num_iterations: int >= 0 = 10")
+    .Attr("seed: int = 0")
+    .Input("index_handle: resource")
+    .Input("points: float")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused_input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_input));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &unused_input));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Builds an inverted file (IVF) index of points, replacing the previous one.
+
+The points are clustered into `num_lists` lists with k-means. A search only
+scans the points of the lists whose centroids best match the query.
+
+index_handle: Handle to the IVF index.
+points: The points to index, one per row. The id of a point is its row index.
+metric: The metric searches rank the points by: `squared_l2` for the smallest
+  squared Euclidean distances, or `inner_product` for the largest inner
+  products.
+num_lists: The number of lists to cluster the points into.
+num_iterations: The number of iterations of k-means.
+seed: The seed for sampling the points the centroids are trained on.
+)doc");
+
+REGISTER_OP("IvfIndexSerialize")
+    .Input("index_handle: resource")
+    .Output("serialized_index: string")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused_input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_input));
+      c->set_output(0, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Serializes an IVF index.
+
+index_handle: Handle to the IVF index.
+serialized_index: The serialized index, empty if it has not been built.
+)doc");
+
+REGISTER_OP("IvfIndexDeserialize")
+    .Input("index_handle: resource")
+    .Input("serialized_index: string")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused_input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_input));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused_input));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Restores an IVF index serialized by IvfIndexSerialize.
+
+index_handle: Handle to the IVF index.
+serialized_index: The serialized index.
+)doc");
+
+REGISTER_OP("IvfIndexSearch")
+    .Input("index_handle: resource")
+    .Input("queries: float")
+    .Input("k: int32")
+    .Input("num_probes: int32")
+    .Output("ids: int64")
+    .Output("scores: float")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused_input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_input));
+      shape_inference::ShapeHandle queries;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &queries));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused_input));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused_input));
+      shape_inference::DimensionHandle k;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &k));
+      c->set_output(0, c->Matrix(c->Dim(queries, 0), k));
+      c->set_output(1, c->Matrix(c->Dim(queries, 0), k));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Finds approximate nearest neighbors of a batch of queries in an IVF index.
+
+Each query is only compared with the points of the `num_probes` lists whose
+centroids best match it, so that larger values trade speed for recall. With
+`num_probes` equal to the number of lists, the search is exact.
+
+index_handle: Handle to the IVF index.
+queries: The queries, one per row, with as many columns as the points.
+k: The number of neighbors to find per query.
+num_probes: The number of lists to scan per query.
+ids: The ids of the neighbors of each query, best first, padded with -1 if
+  the probed lists have fewer than `k` points. Size `batch_size` times `k`.
+scores: The squared distances or inner products of the neighbors of each
+  query, padded with the worst possible score. Size `batch_size` times `k`.
+)doc");
+
 }  // namespace tensorflow
@@ -0,0 +1,113 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the IVF index ops."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+import numpy as np
+
+from tensorflow.contrib.nearest_neighbor.python.ops import nearest_neighbor_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import resources
+from tensorflow.python.platform import test
+from tensorflow.python.training import saver
+
+
+class IvfIndexTest(test.TestCase):
+
+  def setUp(self):
+    super(IvfIndexTest, self).setUp()
+    np.random.seed(0)
+    self._points = np.random.uniform(-1, 1, (300, 6)).astype(np.float32)
+    self._queries = np.random.uniform(-1, 1, (4, 6)).astype(np.float32)
+
+  def testExactSearch(self):
+    with self.test_session():
+      index = nearest_neighbor_ops.ivf_index("index")
+      resources.initialize_resources(resources.shared_resources()).run()
+      nearest_neighbor_ops.build_ivf_index(index, self._points, 8).run()
+      # Probing all the lists makes the search exact.
+      ids, scores = nearest_neighbor_ops.ivf_index_search(
+          index, self._queries, k=3, num_probes=8)
+      ids, scores = ids.eval(), scores.eval()
+
+    distances = np.sum(
+        np.square(self._queries[:, np.newaxis, :] - self._points), axis=2)
+    expected_ids = np.argsort(distances, axis=1)[:, :3]
+    self.assertAllEqual(expected_ids, ids)
+    self.assertAllClose(
+        distances[np.arange(4)[:, np.newaxis], expected_ids], scores, atol=1e-4)
+
+  def testInnerProduct(self):
+    with self.test_session():
+      index = nearest_neighbor_ops.ivf_index("index")
+      resources.initialize_resources(resources.shared_resources()).run()
+      nearest_neighbor_ops.build_ivf_index(
+          index, self._points, 8, metric="inner_product").run()
+      ids, scores = nearest_neighbor_ops.ivf_index_search(
+          index, self._queries, k=3, num_probes=8)
+      ids, scores = ids.eval(), scores.eval()
+
+    products = np.dot(self._queries, self._points.T)
+    expected_ids = np.argsort(-products, axis=1)[:, :3]
+    self.assertAllEqual(expected_ids, ids)
+    self.assertAllClose(
+        products[np.arange(4)[:, np.newaxis], expected_ids], scores, atol=1e-4)
+
+  def testSearchBeforeBuild(self):
+    with self.test_session():
+      index = nearest_neighbor_ops.ivf_index("index")
+      resources.initialize_resources(resources.shared_resources()).run()
+      ids, _ = nearest_neighbor_ops.ivf_index_search(
+          index, self._queries, k=3, num_probes=1)
+      with self.assertRaisesOpError("has not been built"):
+        ids.eval()
+
+  def testSaveRestore(self):
+    save_path = os.path.join(self.get_temp_dir(), "restore-index")
+    with ops.Graph().as_default() as graph:
+      with self.test_session(graph):
+        index = nearest_neighbor_ops.ivf_index("index")
+        resources.initialize_resources(resources.shared_resources()).run()
+        nearest_neighbor_ops.build_ivf_index(index, self._points, 8).run()
+        ids, scores = nearest_neighbor_ops.ivf_index_search(
+            index, self._queries, k=5, num_probes=2)
+        expected_ids, expected_scores = ids.eval(), scores.eval()
+        saver.Saver().save(ops.get_default_session(), save_path)
+
+    with ops.Graph().as_default() as graph:
+      with self.test_session(graph):
+        index = nearest_neighbor_ops.ivf_index("index")
+        ids, scores = nearest_neighbor_ops.ivf_index_search(
+            index, self._queries, k=5, num_probes=2)
+        saver.Saver().restore(ops.get_default_session(), save_path)
+        self.assertAllEqual(expected_ids, ids.eval())
+        self.assertAllEqual(expected_scores, scores.eval())
+
+  def testInvalidNumLists(self):
+    with self.test_session():
+      index = nearest_neighbor_ops.ivf_index("index")
+      resources.initialize_resources(resources.shared_resources()).run()
+      with self.assertRaises(errors.InvalidArgumentError):
+        nearest_neighbor_ops.build_ivf_index(index, self._points[:4], 8).run()
+
+
+if __name__ == "__main__":
+  test.main()
@@ -20,7 +20,9 @@ from __future__ import print_function
 
 from tensorflow.contrib.util import loader
 from tensorflow.python.framework import ops
+from tensorflow.python.ops import resources
 from tensorflow.python.platform import resource_loader
+from tensorflow.python.training import saver
 
 _nearest_neighbor_ops = loader.load_op_library(
     resource_loader.get_path_to_datafile("_nearest_neighbor_ops.so"))
@@ -62,3 +64,139 @@ def hyperplane_lsh_probes(point_hyperplane_product,
                                                      name=name)
 
 ops.NotDifferentiable("HyperplaneLSHProbes")
+
+
+class IvfIndexSaveable(saver.BaseSaverBuilder.SaveableObject):
+  """SaveableObject implementation for IVF indexes."""
+
+  def __init__(self, index_handle, create_op, name):
+    """Creates an IvfIndexSaveable object.
+
+    Args:
+      index_handle: handle to the IVF index.
+      create_op: the op to create the index.
+      name: the name to save the index under.
+    """
+    serialized_index = _nearest_neighbor_ops.ivf_index_serialize(index_handle)
+    # slice_spec is useful for saving a slice from a variable.
+    # It's not meaningful for the index. So we just pass an empty value.
+    slice_spec = ""
+    specs = [
+        saver.BaseSaverBuilder.SaveSpec(serialized_index, slice_spec,
+                                        name + "_index"),
+    ]
+    super(IvfIndexSaveable, self).__init__(index_handle, specs, name)
+    self._index_handle = index_handle
+    self._create_op = create_op
+
+  def restore(self, restored_tensors, unused_restored_shapes):
+    """Restores the associated IVF index from 'restored_tensors'.
+
+    Args:
+      restored_tensors: the tensors that were loaded from a checkpoint.
+      unused_restored_shapes: the shapes this object should conform to after
+        restore. Not meaningful for indexes.
+
+    Returns:
+      The operation that restores the state of the index.
+    """
+    with ops.control_dependencies([self._create_op]):
+      return _nearest_neighbor_ops.ivf_index_deserialize(
+          self._index_handle, serialized_index=restored_tensors[0])
+
+
+def ivf_index(name, container=None):
+  """Creates an empty inverted file (IVF) index and returns a handle to it.
+
+  The index is built with `build_ivf_index`, queried with `ivf_index_search`,
+  and saved and restored with the other saveable objects of the graph.
+
+  Args:
+    name: A name for the index.
+    container: An optional `string`. Defaults to `""`.
+
+  Returns:
+    A `Tensor` of type `resource`. The handle to the index.
+  """
+  with ops.name_scope(name, "IvfIndex") as name:
+    index_handle = _nearest_neighbor_ops.ivf_index_resource_handle_op(
+        container=container, shared_name=name, name=name)
+    create_op = _nearest_neighbor_ops.create_ivf_index(index_handle)
+    is_initialized_op = _nearest_neighbor_ops.ivf_index_is_initialized(
+        index_handle)
+    # Adds the index to the saveable list.
+    saveable = IvfIndexSaveable(index_handle, create_op, index_handle.name)
+    ops.add_to_collection(ops.GraphKeys.SAVEABLE_OBJECTS, saveable)
+    resources.register_resource(index_handle, create_op, is_initialized_op)
+    return index_handle
+
+
+def build_ivf_index(index_handle,
+                    points,
+                    num_lists,
+                    metric="squared_l2",
+                    num_iterations=10,
+                    seed=0,
+                    name=None):
+  """Builds an IVF index of points, replacing the previous one.
+
+  The points are clustered into `num_lists` lists with k-means. A search only
+  scans the points of the lists whose centroids best match the query, so that
+  about `sqrt(num_points)` lists usually work well.
+
+  Args:
+    index_handle: the handle returned by `ivf_index`.
+    points: a float matrix of the points to index, one per row, e.g. the value
+      of an embedding variable. The id of a point is its row index.
+    num_lists: the number of lists to cluster the points into.
+    metric: `"squared_l2"` to rank the points by increasing squared Euclidean
+      distance, or `"inner_product"` to rank them by decreasing inner product.
+    num_iterations: the number of iterations of k-means.
+    seed: the seed for sampling the points the centroids are trained on.
+    name: A name for the operation (optional).
+
+  Returns:
+    The operation that builds the index.
+  """
+  return _nearest_neighbor_ops.build_ivf_index(index_handle,
+                                               points,
+                                               num_lists=num_lists,
+                                               metric=metric,
+                                               num_iterations=num_iterations,
+                                               seed=seed,
+                                               name=name)
+
+
+def ivf_index_search(index_handle, queries, k, num_probes, name=None):
+  """Finds approximate nearest neighbors of a batch of queries in an IVF index.
+
+  Each query is only compared with the points of the `num_probes` lists whose
+  centroids best match it, so that larger values trade speed for recall. With
+  `num_probes` equal to the number of lists, the search is exact.
+
+  Args:
+    index_handle: the handle returned by `ivf_index`.
+    queries: a float matrix of queries, one per row, with as many columns as
+      the indexed points.
+    k: the number of neighbors to find per query.
+    num_probes: the number of lists to scan per query.
+    name: A name prefix for the returned tensors (optional).
+
+  Returns:
+    ids: the int64 ids of the neighbors of each query, best first, padded with
+      -1 if the probed lists have fewer than `k` points. Size `batch_size`
+      times `k`.
+    scores: the squared distances or inner products of the neighbors of each
+      query, padded with the worst possible score. Size `batch_size` times
+      `k`.
+  """
+  return _nearest_neighbor_ops.ivf_index_search(index_handle,
+                                                queries,
+                                                k,
+                                                num_probes,
+                                                name=name)
+
+ops.NotDifferentiable("IvfIndexSerialize")
+ops.NotDifferentiable("IvfIndexDeserialize")
+ops.NotDifferentiable("BuildIvfIndex")
+ops.NotDifferentiable("IvfIndexSearch")
@@ -33,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
@@ -82,6 +85,47 @@ bool IsTensorRTCandidate(const tensorflow::Node* node) {
           PluginFactoryTensorRT::GetInstance()->IsPlugin(node->type_string()));
 }
 
+// Estimated time in microseconds to feed or fetch one tensor of a TensorRT
+// engine, charged against the nodes a segment saves from running in TF.
+const double kBoundaryTensorCostUs = 2.0;
+
+// Returns the estimated time in microseconds 'node' takes to run on its
+// device. Ops the estimator doesn't know or whose shapes are unknown get a
+// rough lower bound.
+double EstimateNodeCost(
+    const tensorflow::Node* node,
+    const tensorflow::grappler::GraphProperties& graph_properties,
+    const tensorflow::grappler::OpLevelCostEstimator& estimator) {
+  tensorflow::grappler::OpContext op_context;
+  op_context.name = node->name();
+  op_context.device_name = node->assigned_device_name().empty()
+                               ? node->requested_device()
+                               : node->assigned_device_name();
+  auto& op_info = op_context.op_info;
+  op_info.set_op(node->type_string());
+  *op_info.mutable_attr() = node->def().attr();
+  if (graph_properties.HasInputProperties(node->name())) {
+    for (const auto& input : graph_properties.GetInputProperties(node->name())) {
+      *op_info.add_inputs() = input;
+    }
+  }
+  if (graph_properties.HasOutputProperties(node->name())) {
+    for (const auto& output :
+         graph_properties.GetOutputProperties(node->name())) {
+      *op_info.add_outputs() = output;
+    }
+  }
+  // Segments are converted for the GPU whatever their placement.
+  if (op_context.device_name.empty()) {
+    op_info.mutable_device()->set_type("GPU");
+  } else {
+    *op_info.mutable_device() =
+        tensorflow::grappler::GetDeviceInfo(op_context.device_name);
+  }
+  const auto costs = estimator.PredictCosts(op_context);
+  return costs.execution_time.count() / 1000.0;
+}
+
 void GetSubGraphIncomingEdges(const tensorflow::Graph& graph,
                               const std::set<int>& subgraph_node_ids,
                               tensorflow::EdgeSet* incoming_edges) {
@@ -154,7 +198,8 @@ struct ConvertGraphParams {
       const tensorflow::grappler::GraphProperties& current_graph_properties,
       std::unordered_map<string, std::pair<int, string>>* output_edges,
       int engine_precision_mode, const string& device_name,
-      std::shared_ptr<nvinfer1::IGpuAllocator> allocator, int cuda_gpu_id)
+      std::shared_ptr<nvinfer1::IGpuAllocator> allocator, int cuda_gpu_id,
+      int max_cached_engines_count)
       : graph(inp_graph),
         output_names(output_node_names),
         subgraph_node_ids(subgraph_node_id_numbers),
@@ -165,7 +210,8 @@ struct ConvertGraphParams {
         precision_mode(engine_precision_mode),
         device_name_(device_name),
         allocator_(allocator),
-        cuda_gpu_id_(cuda_gpu_id) {}
+        cuda_gpu_id_(cuda_gpu_id),
+        max_cached_engines(max_cached_engines_count) {}
   tensorflow::Graph& graph;
   const std::vector<string>& output_names;
   const std::set<int>& subgraph_node_ids;
@@ -177,6 +223,7 @@ struct ConvertGraphParams {
   string device_name_;
   std::shared_ptr<nvinfer1::IGpuAllocator> allocator_;
   int cuda_gpu_id_;
+  int max_cached_engines;
   std::vector<std::pair<int, int>> subgraph_inputs;
   std::vector<std::pair<int, int>> subgraph_outputs;
   tensorflow::EdgeSet subgraph_incoming_edges;
@@ -248,7 +295,8 @@ tensorflow::Status ConvertSubGraphToTensorRT(ConvertGraphParams* params) {
                    params->max_batch_size, params->max_workspace_size_bytes,
                    params->graph_properties, params->output_edge_map,
                    &trt_node_def, params->precision_mode, params->device_name_,
-                   params->allocator_, params->cuda_gpu_id_);
+                   params->allocator_, params->cuda_gpu_id_,
+                   params->max_cached_engines);
   TF_RETURN_IF_ERROR(ConvertSubGraphToTensorRTNodeDef(s));
   tensorflow::Status status;
   tensorflow::Node* trt_node = params->graph.AddNode(trt_node_def, &status);
@@ -352,7 +400,8 @@ tensorflow::Status ConvertGraphDefToTensorRT(
     const tensorflow::GraphDef& graph_def,
     const std::vector<string>& output_names, size_t max_batch_size,
     size_t max_workspace_size_bytes, tensorflow::GraphDef* new_graph_def,
-    int precision_mode = FP32MODE, int minimum_segment_size = 3) {
+    int precision_mode = FP32MODE, int minimum_segment_size = 3,
+    int max_cached_engines = 1) {
   // optimization pass
   tensorflow::grappler::GrapplerItem item;
   item.fetch = output_names;
@@ -383,6 +432,8 @@ tensorflow::Status ConvertGraphDefToTensorRT(
   return ConvertAfterShapes(gdef, output_names, max_batch_size,
                             max_workspace_size_bytes, new_graph_def,
                             precision_mode, minimum_segment_size,
+                            max_cached_engines,
+                            /*minimum_segment_cost_us=*/0,
                             static_graph_properties, nullptr);
 }
 
@@ -390,7 +441,8 @@ tensorflow::Status ConvertAfterShapes(
     const tensorflow::GraphDef& gdef, const std::vector<string>& output_names,
     size_t max_batch_size, size_t max_workspace_size_bytes,
     tensorflow::GraphDef* new_graph_def, int precision_mode,
-    int minimum_segment_size,
+    int minimum_segment_size, int max_cached_engines,
+    double minimum_segment_cost_us,
     const tensorflow::grappler::GraphProperties& graph_properties,
     const tensorflow::grappler::Cluster* cluster) {
   // Segment the graph into subgraphs that can be converted to TensorRT
@@ -408,6 +460,13 @@ tensorflow::Status ConvertAfterShapes(
 
   // TODO(sami): this should be passed as a knob!!!!
   segment_options.minimum_segment_size = minimum_segment_size;
+  tensorflow::grappler::OpLevelCostEstimator cost_estimator;
+  segment_options.node_cost_fn = [&graph_properties, &cost_estimator](
+                                     const tensorflow::Node* node) {
+    return EstimateNodeCost(node, graph_properties, cost_estimator);
+  };
+  segment_options.boundary_tensor_cost = kBoundaryTensorCostUs;
+  segment_options.minimum_segment_cost = minimum_segment_cost_us;
   tensorflow::tensorrt::segment::SegmentNodesVector segments;
   TF_RETURN_IF_ERROR(tensorrt::segment::SegmentGraph(
       &graph, IsTensorRTCandidate, segment_options, &segments));
@@ -477,7 +536,7 @@ tensorflow::Status ConvertAfterShapes(
     ConvertGraphParams p(graph, output_names, subgraph_node_ids, max_batch_size,
                          max_mem_per_engine, graph_properties, &output_edge_map,
                          precision_mode, segment_nodes_and_device.second,
-                         allocator, cuda_device_id);
+                         allocator, cuda_device_id, max_cached_engines);
     if (precision_mode == INT8MODE) {
       tensorflow::Status status = GetCalibNode(&p);
       if (status != tensorflow::Status::OK()) {
@@ -39,18 +39,24 @@ tensorflow::Status ConvertCalibGraphToInferGraph(
 //                 optimization targets inference run with max batch size.
 // max_workspace_size_bytes: The upper bound of memory allowance for
 //                 engine building.
+// max_cached_engines: maximum number of engines each TRTEngineOp builds at
+//                 runtime for input shapes its static engine does not support.
 tensorflow::Status ConvertGraphDefToTensorRT(
     const tensorflow::GraphDef& graph_def,
     const std::vector<string>& output_names, size_t max_batch_size,
     size_t max_workspace_size_bytes, tensorflow::GraphDef* new_graph_def,
-    int precision_mode, int minimum_segment_size);
+    int precision_mode, int minimum_segment_size, int max_cached_engines);
 
 // Method to call from optimization pass
+// minimum_segment_cost_us: segments whose estimated run time, less the cost of
+//                 their input and output tensors, is below this many
+//                 microseconds stay in TensorFlow. 0 disables the check.
 tensorflow::Status ConvertAfterShapes(
     const tensorflow::GraphDef& graph, const std::vector<string>& output_names,
     size_t max_batch_size, size_t max_workspace_size_bytes,
     tensorflow::GraphDef* new_graph_def, int precision_mode,
-    int minimum_segment_size,
+    int minimum_segment_size, int max_cached_engines,
+    double minimum_segment_cost_us,
     const tensorflow::grappler::GraphProperties& graph_properties,
     const tensorflow::grappler::Cluster* cluster);
 }  // namespace convert
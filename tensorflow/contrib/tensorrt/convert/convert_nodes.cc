@@ -28,14 +28,18 @@ limitations under the License.
 #include "tensorflow/contrib/tensorrt/log/trt_logger.h"
 #include "tensorflow/contrib/tensorrt/resources/trt_resource_manager.h"
 #include "tensorflow/contrib/tensorrt/resources/trt_resources.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph_to_functiondef.h"
 #include "tensorflow/core/framework/node_def.pb.h"  // NOLINT
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"  // NOLINT
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -2603,16 +2607,106 @@ tensorflow::Status InjectCalibrationNode(tensorrt::convert::SubGraphParams& s) {
   return tensorflow::Status::OK();
 }
 
-tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
-    tensorrt::convert::SubGraphParams& s) {
-  // Visit nodes in reverse topological order and construct the TRT network.
-  std::list<tensorflow::Node*> order;
-  TF_RETURN_IF_ERROR(ReverseTopologicalSort(s, &order));
+// Returns the names and types of the unique input and output tensors of the
+// segment, which name the bindings of its engines.
+void GetSegmentTensors(const tensorrt::convert::SubGraphParams& s,
+                       std::vector<string>* input_names,
+                       std::vector<tensorflow::DataType>* input_dtypes,
+                       std::vector<string>* output_names,
+                       std::vector<tensorflow::DataType>* output_dtypes) {
+  std::set<string> added_tensors;
+  for (const std::pair<int, int>& input : s.input_inds) {
+    const tensorflow::Node* node = s.graph.FindNodeId(input.first);
+    string tensor_name = node->name();
+    if (input.second != 0) StrAppend(&tensor_name, ":", input.second);
+    if (!added_tensors.insert(tensor_name).second) continue;
+    input_names->push_back(tensor_name);
+    input_dtypes->push_back(node->output_type(input.second));
+  }
+  added_tensors.clear();
+  for (const std::pair<int, int>& output : s.output_inds) {
+    const tensorflow::Node* node = s.graph.FindNodeId(output.first);
+    string tensor_name = node->name();
+    if (output.second != 0) StrAppend(&tensor_name, ":", output.second);
+    if (!added_tensors.insert(tensor_name).second) continue;
+    output_names->push_back(tensor_name);
+    output_dtypes->push_back(node->output_type(output.second));
+  }
+}
 
-  static int static_id = 0;
-  string subgraph_name_scope = SubgraphNameScopeGenerator(&order);
-  string engine_name = StrCat(subgraph_name_scope, "my_trt_op", static_id++);
+// Adds the segment to the function library of the graph as the function
+// 'funcdef_name', which the TRTEngineOp runs for the input shapes it has no
+// engine for.
+tensorflow::Status AddSegmentFunction(
+    tensorrt::convert::SubGraphParams& s,
+    const std::list<tensorflow::Node*>& order,
+    const std::vector<string>& input_names,
+    const std::vector<tensorflow::DataType>& input_dtypes,
+    const std::vector<string>& output_names,
+    const std::vector<tensorflow::DataType>& output_dtypes,
+    const string& funcdef_name) {
+  tensorflow::GraphDef segment_def;
+  std::unordered_map<string, string> input_to_arg;
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    tensorflow::NodeDef* arg = segment_def.add_node();
+    arg->set_name(StrCat(funcdef_name, "_input_", i));
+    arg->set_op("_Arg");
+    tensorflow::AddNodeAttr("T", input_dtypes[i], arg);
+    tensorflow::AddNodeAttr("index", static_cast<int>(i), arg);
+    input_to_arg[input_names[i]] = arg->name();
+  }
+  std::set<string> segment_nodes;
+  for (const tensorflow::Node* node : order) {
+    segment_nodes.insert(node->name());
+  }
+  for (const tensorflow::Node* node : order) {
+    tensorflow::NodeDef* node_def = segment_def.add_node();
+    *node_def = node->def();
+    node_def->clear_input();
+    for (const string& input : node->def().input()) {
+      if (input[0] == '^') {
+        // Control dependencies on the rest of the graph are kept by the
+        // TRTEngineOp itself.
+        if (segment_nodes.count(input.substr(1))) node_def->add_input(input);
+        continue;
+      }
+      string tensor_name = input;
+      const size_t colon = tensor_name.find_first_of(':');
+      if (colon != string::npos && colon + 2 == tensor_name.size() &&
+          tensor_name[colon + 1] == '0') {
+        tensor_name.erase(colon);
+      }
+      auto arg = input_to_arg.find(tensor_name);
+      node_def->add_input(arg == input_to_arg.end() ? input : arg->second);
+    }
+  }
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    tensorflow::NodeDef* retval = segment_def.add_node();
+    retval->set_name(StrCat(funcdef_name, "_output_", i));
+    retval->set_op("_Retval");
+    retval->add_input(output_names[i]);
+    tensorflow::AddNodeAttr("T", output_dtypes[i], retval);
+    tensorflow::AddNodeAttr("index", static_cast<int>(i), retval);
+  }
+
+  tensorflow::Graph segment_graph(s.graph.flib_def());
+  TF_RETURN_IF_ERROR(tensorflow::ConvertGraphDefToGraph(
+      tensorflow::GraphConstructorOptions(), segment_def, &segment_graph));
+  tensorflow::FunctionDefLibrary library;
+  TF_RETURN_IF_ERROR(tensorflow::GraphToFunctionDef(
+      segment_graph, funcdef_name, library.add_function()));
+  return s.graph.AddFunctionLibrary(library);
+}
 
+// Builds the static engine of the segment for the shapes inferred when
+// converting the graph, and serializes it into 'engine_plan_string'.
+tensorflow::Status BuildStaticEngine(
+    tensorrt::convert::SubGraphParams& s, std::list<tensorflow::Node*>* order,
+    const string& engine_name, std::vector<string>* input_names,
+    std::vector<tensorflow::DataType>* input_dtypes,
+    std::vector<string>* output_names,
+    std::vector<tensorflow::DataType>* output_dtypes,
+    string* engine_plan_string) {
   tensorflow::tensorrt::Logger trt_logger;
   cudaSetDevice(s.cuda_gpu_id_);
   auto trt_builder = infer_object(nvinfer1::createInferBuilder(trt_logger));
@@ -2629,21 +2723,15 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
         "Failed to create TensorRT network object");
   }
 
-  auto trt_rmgr = tensorflow::tensorrt::TRTResourceManager::instance();
-  auto weight_rmgr = trt_rmgr->getManager("WeightStore");
+  // The weights only need to outlive the building of the engine.
   auto ws = new tensorflow::tensorrt::TRTWeightStore();
-  TF_CHECK_OK(weight_rmgr->Create(engine_name, engine_name, ws));
+  tensorflow::core::ScopedUnref unref_ws(ws);
 
   // Build the network
   Converter converter(trt_network.get(), ws, s.precision_mode == FP16MODE);
-
-  std::vector<string> input_names;
-  std::vector<tensorflow::DataType> input_dtypes;
-  std::vector<string> output_names;
-  std::vector<tensorflow::DataType> output_dtypes;
-  TF_RETURN_IF_ERROR(ConvertSubgraph(converter, s, &order, &input_names,
-                                     &input_dtypes, &output_names,
-                                     &output_dtypes, engine_name));
+  TF_RETURN_IF_ERROR(ConvertSubgraph(converter, s, order, input_names,
+                                     input_dtypes, output_names,
+                                     output_dtypes, engine_name));
 
   VLOG(2) << "Finished output";
 
@@ -2657,25 +2745,78 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
     VLOG(0) << "Using FP16 precision mode";
   }
   LOG(INFO) << "starting build engine";
+  auto trt_engine =
+      infer_object(trt_builder->buildCudaEngine(*converter.network()));
+  VLOG(0) << "Built network";
+  if (trt_engine.get() == nullptr) {
+    return tensorflow::errors::Internal("Engine building failure");
+  }
+  auto engine_plan = infer_object(trt_engine->serialize());
+  VLOG(0) << "Serialized engine";
+  const char* engine_plan_data = static_cast<const char*>(engine_plan->data());
+  *engine_plan_string =
+      string(engine_plan_data, engine_plan_data + engine_plan->size());
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
+    tensorrt::convert::SubGraphParams& s) {
+  // Visit nodes in reverse topological order and construct the TRT network.
+  std::list<tensorflow::Node*> order;
+  TF_RETURN_IF_ERROR(ReverseTopologicalSort(s, &order));
+
+  static int static_id = 0;
+  string subgraph_name_scope = SubgraphNameScopeGenerator(&order);
+  string engine_name = StrCat(subgraph_name_scope, "my_trt_op", static_id++);
+
+  std::vector<string> input_names;
+  std::vector<tensorflow::DataType> input_dtypes;
+  std::vector<string> output_names;
+  std::vector<tensorflow::DataType> output_dtypes;
   string engine_plan_string;
-  {
-    auto trt_engine =
-        infer_object(trt_builder->buildCudaEngine(*converter.network()));
-    VLOG(0) << "Built network";
-    if (trt_engine.get() == nullptr) {
-      return tensorflow::errors::Internal("Engine building failure");
-    }
-    auto engine_plan = infer_object(trt_engine->serialize());
-    VLOG(0) << "Serialized engine";
-    const char* engine_plan_data =
-        static_cast<const char*>(engine_plan->data());
-    engine_plan_string =
-        string(engine_plan_data, engine_plan_data + engine_plan->size());
-  }
-  TF_RETURN_IF_ERROR(weight_rmgr->Delete<tensorflow::tensorrt::TRTWeightStore>(
-      engine_name, engine_name));
-  LOG(INFO) << "finished engine " << engine_name << " containing "
-            << s.subgraph_node_ids.size() << " nodes";
+  tensorflow::Status status =
+      BuildStaticEngine(s, &order, engine_name, &input_names, &input_dtypes,
+                        &output_names, &output_dtypes, &engine_plan_string);
+  if (!status.ok()) {
+    // Without a static engine, e.g. for inputs of unknown shapes, the op can
+    // still build engines at runtime.
+    if (s.max_cached_engines <= 0) return status;
+    LOG(WARNING) << "No static engine for " << engine_name << " due to: \""
+                 << status.ToString()
+                 << "\", its engines will be built at runtime";
+    input_names.clear();
+    input_dtypes.clear();
+    output_names.clear();
+    output_dtypes.clear();
+    engine_plan_string.clear();
+    GetSegmentTensors(s, &input_names, &input_dtypes, &output_names,
+                      &output_dtypes);
+    // Map the outputs of the op to the original ones for the shapes of the
+    // following segments, as ConvertSubgraph does.
+    for (size_t i = 0; i < s.output_inds.size(); ++i) {
+      const tensorflow::Node* node =
+          s.graph.FindNodeId(s.output_inds[i].first);
+      s.output_edge_map->insert(
+          {i == 0 ? engine_name : StrCat(engine_name, ":", i),
+           {s.output_inds[i].second, node->name()}});
+    }
+  } else {
+    LOG(INFO) << "finished engine " << engine_name << " containing "
+              << s.subgraph_node_ids.size() << " nodes";
+  }
+
+  const string funcdef_name = StrCat(engine_name, "_native_segment");
+  TF_RETURN_IF_ERROR(AddSegmentFunction(s, order, input_names, input_dtypes,
+                                        output_names, output_dtypes,
+                                        funcdef_name));
+  string segment_graph_string;
+  if (s.max_cached_engines > 0) {
+    tensorflow::GraphDef segment_graph;
+    for (const tensorflow::Node* node : order) {
+      *segment_graph.add_node() = node->def();
+    }
+    segment_graph.SerializeToString(&segment_graph_string);
+  }
 
   // Build the TRT op
   tensorflow::NodeDefBuilder op_builder(engine_name, "TRTEngineOp");
@@ -2683,12 +2824,18 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
 
   VLOG(0) << "Finished op preparation";
 
-  auto status = op_builder.Attr("serialized_engine", engine_plan_string)
-                    .Attr("input_nodes", input_names)
-                    .Attr("output_nodes", output_names)
-                    .Attr("OutT", output_dtypes)
-                    .Device(s.device_name_)
-                    .Finalize(s.trt_node);
+  status = op_builder.Attr("serialized_engine", engine_plan_string)
+               .Attr("input_nodes", input_names)
+               .Attr("output_nodes", output_names)
+               .Attr("OutT", output_dtypes)
+               .Attr("segment_funcdef_name", funcdef_name)
+               .Attr("segment_graph", segment_graph_string)
+               .Attr("max_cached_engines_count", s.max_cached_engines)
+               .Attr("precision_mode", s.precision_mode)
+               .Attr("workspace_size_bytes",
+                     static_cast<int64>(s.max_workspace_size_bytes))
+               .Device(s.device_name_)
+               .Finalize(s.trt_node);
 
   VLOG(0) << status.ToString() << " finished op building for " << engine_name
           << " on device " << s.device_name_;
@@ -2696,6 +2843,97 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status ConvertSegmentToEngine(
+    const tensorflow::GraphDef& segment_graph,
+    const std::vector<string>& input_names,
+    const std::vector<tensorflow::DataType>& input_dtypes,
+    const std::vector<tensorflow::TensorShape>& input_shapes,
+    const std::vector<string>& output_names,
+    const std::vector<tensorflow::DataType>& output_dtypes,
+    int precision_mode, size_t max_workspace_size_bytes,
+    nvinfer1::IGpuAllocator* allocator, nvinfer1::ILogger& logger,
+    nvinfer1::ICudaEngine** engine) {
+  if (precision_mode == INT8MODE) {
+    return tensorflow::errors::Unimplemented(
+        "INT8 engines can not be built at runtime without calibration");
+  }
+  auto trt_builder = infer_object(nvinfer1::createInferBuilder(logger));
+  if (!trt_builder) {
+    return tensorflow::errors::Internal(
+        "Failed to create TensorRT builder object");
+  }
+#if NV_TENSORRT_MAJOR > 3
+  trt_builder->setGpuAllocator(allocator);
+#endif
+  auto trt_network = infer_object(trt_builder->createNetwork());
+  if (!trt_network) {
+    return tensorflow::errors::Internal(
+        "Failed to create TensorRT network object");
+  }
+  auto ws = new tensorflow::tensorrt::TRTWeightStore();
+  tensorflow::core::ScopedUnref unref_ws(ws);
+  Converter converter(trt_network.get(), ws, precision_mode == FP16MODE);
+
+  int max_batch_size = 0;
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    const tensorflow::TensorShape& shape = input_shapes.at(i);
+    // TODO(jie): TRT 3.x only support 4 dimensional input tensor.
+    if (shape.dims() != 4) {
+      return tensorflow::errors::Unimplemented(
+          "Require 4 dimensional input. Got ", shape.dims(), " ",
+          input_names[i]);
+    }
+    max_batch_size = std::max<int>(max_batch_size, shape.dim_size(0));
+    nvinfer1::DataType dtype(nvinfer1::DataType::kFLOAT);
+    TF_RETURN_IF_ERROR(ConvertDType(input_dtypes.at(i), &dtype));
+    nvinfer1::DimsCHW input_dim_chw;
+    for (int j = 0; j < 3; j++) input_dim_chw.d[j] = shape.dim_size(j + 1);
+    nvinfer1::ITensor* input_tensor = converter.network()->addInput(
+        input_names[i].c_str(), dtype, input_dim_chw);
+    if (!input_tensor) {
+      return tensorflow::errors::InvalidArgument(
+          "Failed to create Input layer");
+    }
+    if (!converter.insert_input_tensor(input_names[i], input_tensor)) {
+      return tensorflow::errors::AlreadyExists(
+          "Output tensor already exists for op: " + input_names[i]);
+    }
+  }
+
+  for (const tensorflow::NodeDef& node_def : segment_graph.node()) {
+    VLOG(2) << "Converting node: " << node_def.name() << " , " << node_def.op();
+    TF_RETURN_IF_ERROR(converter.convert_node(node_def));
+  }
+
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    auto tensor_or_weights = converter.get_tensor(output_names[i]);
+    if (!tensor_or_weights.is_tensor()) {
+      return tensorflow::errors::InvalidArgument(
+          "Output node '" + output_names[i] + "' is weights not tensor");
+    }
+    nvinfer1::ITensor* tensor = tensor_or_weights.tensor();
+    if (!tensor) {
+      return tensorflow::errors::NotFound("Output tensor not found: " +
+                                          output_names[i]);
+    }
+    converter.network()->markOutput(*tensor);
+    nvinfer1::DataType trt_dtype = nvinfer1::DataType::kFLOAT;
+    TF_RETURN_IF_ERROR(ConvertDType(output_dtypes.at(i), &trt_dtype));
+    tensor->setType(trt_dtype);
+  }
+
+  trt_builder->setMaxBatchSize(max_batch_size);
+  trt_builder->setMaxWorkspaceSize(max_workspace_size_bytes);
+  if (precision_mode == FP16MODE) {
+    trt_builder->setHalf2Mode(true);
+  }
+  *engine = trt_builder->buildCudaEngine(*converter.network());
+  if (*engine == nullptr) {
+    return tensorflow::errors::Internal("Engine building failure");
+  }
+  return tensorflow::Status::OK();
+}
+
 }  // namespace convert
 }  // namespace tensorrt
 }  // namespace tensorflow
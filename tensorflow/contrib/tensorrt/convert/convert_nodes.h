@@ -24,6 +24,8 @@ limitations under the License.
 
 #include "tensorflow/contrib/tensorrt/resources/trt_allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -50,7 +52,7 @@ struct SubGraphParams {
       tensorflow::NodeDef* constructed_trt_node,
       int engine_precision_mode = FP32MODE, const string& device_name = "",
       std::shared_ptr<nvinfer1::IGpuAllocator> allocator = nullptr,
-      int cuda_gpu_id = 0)
+      int cuda_gpu_id = 0, int max_cached_engines_count = 0)
       : graph(inp_graph),
         subgraph_node_ids(subgraph_node_id_numbers),
         input_inds(input_indices),
@@ -63,7 +65,8 @@ struct SubGraphParams {
         precision_mode(engine_precision_mode),
         device_name_(device_name),
         allocator_(allocator),
-        cuda_gpu_id_(cuda_gpu_id) {}
+        cuda_gpu_id_(cuda_gpu_id),
+        max_cached_engines(max_cached_engines_count) {}
 
   tensorflow::Graph& graph;
   const std::set<int>& subgraph_node_ids;
@@ -78,6 +81,9 @@ struct SubGraphParams {
   const string device_name_;
   std::shared_ptr<nvinfer1::IGpuAllocator> allocator_;
   const int cuda_gpu_id_;
+  // The number of engines that the TRTEngineOp can build at runtime for input
+  // shapes that the static engine does not support. Zero disables them.
+  const int max_cached_engines;
 };
 
 // TODO(sami): Replace references with const reference or pointers
@@ -85,6 +91,21 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(SubGraphParams& params);
 tensorflow::Status InjectCalibrationNode(SubGraphParams& params);
 tensorflow::Status ConvertCalibrationNodeToEngineNode(tensorflow::Graph& graph,
                                                       tensorflow::Node* c_node);
+
+// Builds an engine for the segment of a TRTEngineOp for inputs of the shapes
+// 'input_shapes', whose first dimension is the batch. 'segment_graph' holds the
+// nodes of the segment in topological order, which read the inputs by the
+// names in 'input_names'.
+tensorflow::Status ConvertSegmentToEngine(
+    const tensorflow::GraphDef& segment_graph,
+    const std::vector<string>& input_names,
+    const std::vector<tensorflow::DataType>& input_dtypes,
+    const std::vector<tensorflow::TensorShape>& input_shapes,
+    const std::vector<string>& output_names,
+    const std::vector<tensorflow::DataType>& output_dtypes,
+    int precision_mode, size_t max_workspace_size_bytes,
+    nvinfer1::IGpuAllocator* allocator, nvinfer1::ILogger& logger,
+    nvinfer1::ICudaEngine** engine);
 }  // namespace convert
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -47,6 +47,12 @@ tensorflow::Status TRTOptimizationPass::Init(
   }
   if (params.count("max_workspace_size_bytes"))
     maximum_workspace_size_ = params.at("max_workspace_size_bytes").i();
+  if (params.count("maximum_cached_engines")) {
+    maximum_cached_engines_ = params.at("maximum_cached_engines").i();
+  }
+  if (params.count("minimum_segment_cost_us")) {
+    minimum_segment_cost_us_ = params.at("minimum_segment_cost_us").f();
+  }
   if (params.count("precision_mode")) {
     string pm = Uppercase(params.at("precision_mode").s());
     if (pm == "FP32") {
@@ -207,6 +213,7 @@ tensorflow::Status TRTOptimizationPass::Optimize(
   auto status = tensorflow::tensorrt::convert::ConvertAfterShapes(
       item.graph, item.fetch, maximum_batch_size_, maximum_workspace_size_,
       optimized_graph, precision_mode_, minimum_segment_size_,
+      maximum_cached_engines_, minimum_segment_cost_us_,
       static_graph_properties, cluster);
   VLOG(2) << optimized_graph->DebugString();
   return status;
@@ -36,7 +36,9 @@ class TRTOptimizationPass : public tensorflow::grappler::CustomGraphOptimizer {
         minimum_segment_size_(3),
         precision_mode_(0),
         maximum_batch_size_(-1),
-        maximum_workspace_size_(-1) {
+        maximum_workspace_size_(-1),
+        maximum_cached_engines_(1),
+        minimum_segment_cost_us_(0) {
     VLOG(1) << "Constructing " << name_;
   }
 
@@ -62,6 +64,8 @@ class TRTOptimizationPass : public tensorflow::grappler::CustomGraphOptimizer {
   int precision_mode_;
   int maximum_batch_size_;
   int64_t maximum_workspace_size_;
+  int maximum_cached_engines_;
+  double minimum_segment_cost_us_;
 };
 
 }  // namespace convert
@@ -14,8 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/tensorrt/kernels/trt_engine_op.h"
 
+#include <algorithm>
+
+#include "tensorflow/contrib/tensorrt/convert/convert_nodes.h"
 #include "tensorflow/contrib/tensorrt/log/trt_logger.h"
 #include "tensorflow/contrib/tensorrt/plugin/trt_plugin_factory.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/types.h"
@@ -31,7 +36,29 @@ using Dims = nvinfer1::Dims;
 
 namespace tensorrt {
 
-TRTEngineOp::TRTEngineOp(OpKernelConstruction* context) : OpKernel(context) {
+namespace {
+
+// Returns whether an engine built for 'engine_shapes' runs inputs of the
+// shapes 'input_shapes', whose batch may be smaller.
+bool EngineSupportsShapes(const std::vector<TensorShape>& engine_shapes,
+                          const std::vector<TensorShape>& input_shapes) {
+  if (engine_shapes.size() != input_shapes.size()) return false;
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    const TensorShape& engine_shape = engine_shapes[i];
+    const TensorShape& input_shape = input_shapes[i];
+    if (engine_shape.dims() != input_shape.dims()) return false;
+    if (input_shape.dim_size(0) > engine_shape.dim_size(0)) return false;
+    for (int j = 1; j < input_shape.dims(); ++j) {
+      if (engine_shape.dim_size(j) != input_shape.dim_size(j)) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
+    : AsyncOpKernel(context) {
   // read serialized_engine
   OP_REQUIRES_OK(context,
                  context->GetAttr("serialized_engine", &serialized_engine_));
@@ -39,109 +66,251 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context) : OpKernel(context) {
   // register input output node name in trt_sub_graph
   OP_REQUIRES_OK(context, context->GetAttr("input_nodes", &input_nodes_));
   OP_REQUIRES_OK(context, context->GetAttr("output_nodes", &output_nodes_));
+  OP_REQUIRES_OK(context, context->GetAttr("InT", &input_types_));
+  OP_REQUIRES_OK(context, context->GetAttr("OutT", &output_types_));
+
+  OP_REQUIRES_OK(context, context->GetAttr("segment_funcdef_name",
+                                           &segment_funcdef_name_));
+  string segment_graph;
+  OP_REQUIRES_OK(context, context->GetAttr("segment_graph", &segment_graph));
+  OP_REQUIRES(context, segment_graph_.ParseFromString(segment_graph),
+              errors::InvalidArgument("Could not parse the segment graph of ",
+                                      name()));
+  OP_REQUIRES_OK(context, context->GetAttr("max_cached_engines_count",
+                                           &max_cached_engines_));
+  OP_REQUIRES_OK(context, context->GetAttr("precision_mode", &precision_mode_));
+  OP_REQUIRES_OK(context, context->GetAttr("workspace_size_bytes",
+                                           &workspace_size_bytes_));
+  // Building engines at runtime needs both the segment to build them from and
+  // the native segment to run meanwhile.
+  if (segment_graph_.node_size() == 0 || segment_funcdef_name_.empty()) {
+    max_cached_engines_ = 0;
+  }
+  if (max_cached_engines_ > 0) {
+    build_thread_.reset(
+        new thread::ThreadPool(Env::Default(), "trt_engine_build", 1));
+  }
 }
 
-void TRTEngineOp::Compute(OpKernelContext* context) {
-  // TODO(samikama) runtime should be taken from a resourcemanager as well.
-  // Only engine should be in the op and context and runtime should be taken
-  // from resourcemanager
+void TRTEngineOp::ComputeAsync(OpKernelContext* context, DoneCallback done) {
+  InputShapes input_shapes;
+  for (int i = 0; i < context->num_inputs(); i++) {
+    const TensorShape& input_shape = context->input(i).shape();
+    OP_REQUIRES_ASYNC(
+        context,
+        input_shape.dims() > 0 &&
+            input_shape.dim_size(0) == context->input(0).dim_size(0),
+        errors::InvalidArgument("input data inconsistent batch size"), done);
+    input_shapes.push_back(input_shape);
+  }
 
-  if (!trt_execution_context_ptr_) {
-    IRuntime* infer = nvinfer1::createInferRuntime(logger);
-#if NV_TENSORRT_MAJOR > 3
+  std::shared_ptr<EngineContext> engine_context;
+  OP_REQUIRES_OK_ASYNC(context,
+                       GetEngine(context, input_shapes, &engine_context), done);
+  if (engine_context == nullptr) {
+    OP_REQUIRES_ASYNC(
+        context, !segment_funcdef_name_.empty(),
+        errors::InvalidArgument(
+            "The TensorRT engine does not support the input shapes, e.g. ",
+            input_shapes[0].DebugString(), " for ", input_nodes_[0]),
+        done);
+    ExecuteNativeSegment(context, done);
+    return;
+  }
+  ExecuteEngine(context, engine_context.get());
+  done();
+}
+
+Status TRTEngineOp::GetEngine(OpKernelContext* context,
+                              const InputShapes& input_shapes,
+                              std::shared_ptr<EngineContext>* engine_context) {
+  mutex_lock l(mu_);
+  if (allocator_ == nullptr) {
     auto device = context->device();
     auto dev_allocator =
         device->GetAllocator(tensorflow::AllocatorAttributes());
     if (!dev_allocator) {
-      LOG(FATAL) << "Can't find device allocator for gpu device "
-                 << device->name();
+      return errors::Internal("Can't find device allocator for gpu device ",
+                              device->name());
     }
     allocator_ = std::make_shared<TRTDeviceAllocator>(dev_allocator);
+  }
+  if (!serialized_engine_.empty()) {
+    IRuntime* infer = nvinfer1::createInferRuntime(logger);
+#if NV_TENSORRT_MAJOR > 3
     infer->setGpuAllocator(allocator_.get());
 #endif
-    trt_engine_ptr_.reset(infer->deserializeCudaEngine(
+    static_engine_ = std::make_shared<EngineContext>();
+    static_engine_->engine.reset(infer->deserializeCudaEngine(
         serialized_engine_.c_str(), serialized_engine_.size(),
         PluginFactoryTensorRT::GetInstance()));
-    trt_execution_context_ptr_.reset(trt_engine_ptr_->createExecutionContext());
     // Runtime is safe to delete after engine creation
     infer->destroy();
     serialized_engine_.clear();
+    if (static_engine_->engine == nullptr) {
+      static_engine_.reset();
+      return errors::Internal("Failed to deserialize the TensorRT engine");
+    }
+    {
+      mutex_lock engine_lock(static_engine_->mu);
+      static_engine_->execution_context.reset(
+          static_engine_->engine->createExecutionContext());
+    }
+    const int max_batch_size = static_engine_->engine->getMaxBatchSize();
+    for (const string& input_node : input_nodes_) {
+      const int binding_index =
+          static_engine_->engine->getBindingIndex(input_node.c_str());
+      if (binding_index == -1) {
+        return errors::NotFound("input node not found, at ", input_node);
+      }
+      const Dims dims =
+          static_engine_->engine->getBindingDimensions(binding_index);
+      TensorShape shape({max_batch_size});
+      for (int j = 0; j < dims.nbDims; j++) shape.AddDim(dims.d[j]);
+      static_engine_shapes_.push_back(shape);
+    }
+  }
+
+  if (static_engine_ != nullptr &&
+      EngineSupportsShapes(static_engine_shapes_, input_shapes)) {
+    *engine_context = static_engine_;
+    return Status::OK();
+  }
+  for (auto it = engine_cache_.begin(); it != engine_cache_.end(); ++it) {
+    if (EngineSupportsShapes(it->first, input_shapes)) {
+      engine_cache_.splice(engine_cache_.begin(), engine_cache_, it);
+      *engine_context = engine_cache_.front().second;
+      return Status::OK();
+    }
   }
+  // Without the native segment the static engine is the only choice, which
+  // fails for batches that are too large.
+  if (segment_funcdef_name_.empty() && static_engine_ != nullptr &&
+      input_shapes[0].dim_size(0) <= static_engine_shapes_[0].dim_size(0)) {
+    *engine_context = static_engine_;
+    return Status::OK();
+  }
+  if (max_cached_engines_ > 0 && !engine_building_ && !engine_build_failed_) {
+    engine_building_ = true;
+    int cuda_device_id = 0;
+    cudaGetDevice(&cuda_device_id);
+    build_thread_->Schedule([this, input_shapes, cuda_device_id]() {
+      BuildEngine(input_shapes, cuda_device_id);
+    });
+  }
+  engine_context->reset();
+  return Status::OK();
+}
+
+void TRTEngineOp::BuildEngine(const InputShapes& input_shapes,
+                              int cuda_device_id) {
+  cudaSetDevice(cuda_device_id);
+  std::shared_ptr<nvinfer1::IGpuAllocator> allocator;
+  {
+    mutex_lock l(mu_);
+    allocator = allocator_;
+  }
+  VLOG(1) << "Building a TensorRT engine for " << name() << " with input "
+          << input_shapes[0].DebugString();
+  nvinfer1::ICudaEngine* engine = nullptr;
+  Status status = convert::ConvertSegmentToEngine(
+      segment_graph_, input_nodes_, input_types_, input_shapes, output_nodes_,
+      output_types_, precision_mode_, workspace_size_bytes_, allocator.get(),
+      logger, &engine);
+  std::shared_ptr<EngineContext> engine_context;
+  if (status.ok()) {
+    engine_context = std::make_shared<EngineContext>();
+    engine_context->engine.reset(engine);
+    mutex_lock engine_lock(engine_context->mu);
+    engine_context->execution_context.reset(engine->createExecutionContext());
+  }
+
+  mutex_lock l(mu_);
+  engine_building_ = false;
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to build a TensorRT engine for " << name()
+                 << ", running its native segment instead: " << status;
+    engine_build_failed_ = true;
+    return;
+  }
+  engine_cache_.emplace_front(input_shapes, std::move(engine_context));
+  while (engine_cache_.size() > static_cast<size_t>(max_cached_engines_)) {
+    engine_cache_.pop_back();
+  }
+}
+
+void TRTEngineOp::ExecuteEngine(OpKernelContext* context,
+                                EngineContext* engine_context) {
+  nvinfer1::ICudaEngine* trt_engine = engine_context->engine.get();
   int num_binding = context->num_inputs() + context->num_outputs();
   std::vector<void*> buffers(num_binding);
 
-  size_t binding_index;
-  int num_batch = 0;
+  const int num_batch = context->input(0).dim_size(0);
   for (int i = 0; i < context->num_inputs(); i++) {
     // Grab the input tensor
-    binding_index = trt_engine_ptr_->getBindingIndex(input_nodes_[i].c_str());
+    const int binding_index =
+        trt_engine->getBindingIndex(input_nodes_[i].c_str());
+    OP_REQUIRES(context, binding_index != -1,
+                errors::NotFound("input node not found, at ", input_nodes_[i]));
 
     const Tensor& input_tensor = context->input(i);
-    const TensorShape& input_shape = input_tensor.shape();
-    if (i == 0) {
-      num_batch = input_shape.dim_size(0);
-      if (num_batch > trt_engine_ptr_->getMaxBatchSize()) {
-        LOG(FATAL) << "input tensor batch larger than max_batch_size: "
-                   << trt_engine_ptr_->getMaxBatchSize();
-      }
-    } else if (num_batch != input_shape.dim_size(0)) {
-      LOG(FATAL) << "input data inconsistent batch size";
-      break;
-    }
-    auto dtype = trt_engine_ptr_->getBindingDataType(binding_index);
+    auto dtype = trt_engine->getBindingDataType(binding_index);
     switch (dtype) {
       case nvinfer1::DataType::kFLOAT:
         buffers[binding_index] = (void*)(input_tensor.flat<float>().data());
         break;
       case nvinfer1::DataType::kHALF:
-        LOG(FATAL) << "half size is not supported yet!";
-        break;
+        context->SetStatus(
+            errors::Unimplemented("half size is not supported yet!"));
+        return;
       case nvinfer1::DataType::kINT8:
-        LOG(FATAL) << "int8 is not supported yet!";
-        break;
+        context->SetStatus(errors::Unimplemented("int8 is not supported yet!"));
+        return;
       default:
-        LOG(FATAL) << "Unknown data type: " << int(dtype);
-        break;
+        context->SetStatus(
+            errors::Unimplemented("Unknown data type: ", int(dtype)));
+        return;
     }
   }
 
   for (int i = 0; i < static_cast<int>(output_nodes_.size()); i++) {
     // This is bad that we have to reallocate output buffer every run.
     // Create an output tensor
-    binding_index = trt_engine_ptr_->getBindingIndex(output_nodes_[i].c_str());
+    const int binding_index =
+        trt_engine->getBindingIndex(output_nodes_[i].c_str());
+    OP_REQUIRES(context, binding_index != -1,
+                errors::NotFound("output node not found, at ",
+                                 output_nodes_[i]));
     Tensor* output_tensor = nullptr;
 
     TensorShape output_shape;
-    if (binding_index != -1) {
-      auto dims = trt_engine_ptr_->getBindingDimensions(binding_index);
-      std::vector<int> trt_shape(dims.nbDims + 1);
-      trt_shape[0] = num_batch;
-      for (int j = 0; j < dims.nbDims; j++) trt_shape[j + 1] = dims.d[j];
-      OP_REQUIRES_OK(context,
-                     TensorShapeUtils::MakeShape(
-                         trt_shape.data(), trt_shape.size(), &output_shape));
-    } else {
-      LOG(FATAL) << "output node not found, at " << output_nodes_[i];
-      break;
-    }
+    auto dims = trt_engine->getBindingDimensions(binding_index);
+    std::vector<int> trt_shape(dims.nbDims + 1);
+    trt_shape[0] = num_batch;
+    for (int j = 0; j < dims.nbDims; j++) trt_shape[j + 1] = dims.d[j];
+    OP_REQUIRES_OK(context,
+                   TensorShapeUtils::MakeShape(
+                       trt_shape.data(), trt_shape.size(), &output_shape));
 
     OP_REQUIRES_OK(context,
                    context->allocate_output(i, output_shape, &output_tensor));
-    auto dtype = trt_engine_ptr_->getBindingDataType(binding_index);
+    auto dtype = trt_engine->getBindingDataType(binding_index);
     switch (dtype) {
       case nvinfer1::DataType::kFLOAT:
         buffers[binding_index] =
             reinterpret_cast<void*>(output_tensor->flat<float>().data());
         break;
       case nvinfer1::DataType::kHALF:
-        LOG(FATAL) << "half size is not supported yet!";
-        break;
+        context->SetStatus(
+            errors::Unimplemented("half size is not supported yet!"));
+        return;
       case nvinfer1::DataType::kINT8:
-        LOG(FATAL) << "int8 is not supported yet!";
-        break;
+        context->SetStatus(errors::Unimplemented("int8 is not supported yet!"));
+        return;
       default:
-        LOG(FATAL) << "Unknown data type: " << int(dtype);
-        break;
+        context->SetStatus(
+            errors::Unimplemented("Unknown data type: ", int(dtype)));
+        return;
     }
   }
   // copied from cuda_kernel_helper since it seems only valid in *.cu.cc files
@@ -152,15 +321,61 @@ void TRTEngineOp::Compute(OpKernelContext* context) {
                                                 ->CudaStreamMemberHack()));
 
   // TODO(jie): trt enqueue does not return error
-  auto ret = trt_execution_context_ptr_->enqueue(num_batch, &buffers[0],
-                                                 *stream, nullptr);
+  mutex_lock l(engine_context->mu);
+  auto ret = engine_context->execution_context->enqueue(
+      num_batch, &buffers[0], *stream, nullptr);
   VLOG(2) << "enqueue returns: " << ret;
   // sync should be done by TF.
 }
+
+void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* context,
+                                       DoneCallback done) {
+  FunctionLibraryRuntime* lib = context->function_library();
+  OP_REQUIRES_ASYNC(context, lib != nullptr,
+                    errors::Internal("No function library for ", name()),
+                    done);
+  FunctionLibraryRuntime::Handle handle;
+  {
+    mutex_lock l(mu_);
+    if (native_func_ == kInvalidHandle) {
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          lib->Instantiate(segment_funcdef_name_, AttrSlice(), &native_func_),
+          done);
+    }
+    handle = native_func_;
+  }
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = context->step_id();
+  opts.rendezvous = context->rendezvous();
+  opts.cancellation_manager = context->cancellation_manager();
+  opts.runner = context->runner();
+  std::vector<Tensor> inputs;
+  inputs.reserve(context->num_inputs());
+  for (int i = 0; i < context->num_inputs(); i++) {
+    inputs.push_back(context->input(i));
+  }
+  auto* outputs = new std::vector<Tensor>();
+  lib->Run(opts, handle, inputs, outputs,
+           [context, outputs, done](const Status& status) {
+             if (!status.ok()) {
+               context->SetStatus(status);
+             } else {
+               for (size_t i = 0; i < outputs->size(); ++i) {
+                 context->set_output(i, (*outputs)[i]);
+               }
+             }
+             delete outputs;
+             done();
+           });
+}
+
 TRTEngineOp::~TRTEngineOp() {
-  // Order matters!
-  trt_execution_context_ptr_.reset();
-  trt_engine_ptr_.reset();
+  // Order matters! The pending builds use the allocator, and the engines
+  // use the allocator until they are destroyed.
+  build_thread_.reset();
+  engine_cache_.clear();
+  static_engine_.reset();
   allocator_.reset();
 }
 REGISTER_KERNEL_BUILDER(Name("TRTEngineOp").Device(DEVICE_GPU), TRTEngineOp);
@@ -16,12 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_TENSORRT_KERNELS_TRT_ENGINE_OP_H_
 #define TENSORFLOW_CONTRIB_TENSORRT_KERNELS_TRT_ENGINE_OP_H_
 
+#include <list>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/contrib/tensorrt/resources/trt_allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
 
 #if GOOGLE_CUDA
 #if GOOGLE_TENSORRT
@@ -32,12 +39,15 @@ namespace tensorflow {
 namespace tensorrt {
 class Logger;
 
-//  TODO(Sami): Remove this file?
-class TRTEngineOp : public OpKernel {
+// Runs a segment of the graph with TensorRT. Besides the static engine built
+// when converting the graph, the op builds engines in the background for the
+// input shapes that the static engine does not support, and keeps the most
+// recently used ones. It runs the original segment while it has no engine.
+class TRTEngineOp : public AsyncOpKernel {
  public:
   explicit TRTEngineOp(OpKernelConstruction* context);
 
-  void Compute(OpKernelContext* context) override;
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override;
   ~TRTEngineOp();
 
  private:
@@ -48,14 +58,58 @@ class TRTEngineOp : public OpKernel {
 
   template <typename T>
   using destroyed_ptr = std::unique_ptr<T, Destroyer<T>>;
-  destroyed_ptr<nvinfer1::ICudaEngine> trt_engine_ptr_;
-  // TODO(samikama): context should go to a resource manager!
-  destroyed_ptr<nvinfer1::IExecutionContext> trt_execution_context_ptr_;
+
+  using InputShapes = std::vector<TensorShape>;
+
+  // An engine and its execution context, which runs one batch at a time.
+  struct EngineContext {
+    mutex mu;
+    destroyed_ptr<nvinfer1::ICudaEngine> engine;
+    destroyed_ptr<nvinfer1::IExecutionContext> execution_context
+        GUARDED_BY(mu);
+  };
+
+  // Returns the engine that supports 'input_shapes', or null if there is none
+  // yet, in which case it starts building one if it can.
+  Status GetEngine(OpKernelContext* context, const InputShapes& input_shapes,
+                   std::shared_ptr<EngineContext>* engine_context);
+
+  // Builds an engine for 'input_shapes' and adds it to the cache.
+  void BuildEngine(const InputShapes& input_shapes, int cuda_device_id);
+
+  // Runs the inputs through the engine.
+  void ExecuteEngine(OpKernelContext* context, EngineContext* engine_context);
+
+  // Runs the inputs through the original segment of the graph.
+  void ExecuteNativeSegment(OpKernelContext* context, DoneCallback done);
 
   std::vector<string> input_nodes_;
   std::vector<string> output_nodes_;
-  std::shared_ptr<nvinfer1::IGpuAllocator> allocator_;
-  string serialized_engine_;
+  std::vector<DataType> input_types_;
+  std::vector<DataType> output_types_;
+  string segment_funcdef_name_;
+  GraphDef segment_graph_;
+  int max_cached_engines_;
+  int precision_mode_;
+  int64 workspace_size_bytes_;
+
+  mutex mu_;
+  std::shared_ptr<nvinfer1::IGpuAllocator> allocator_ GUARDED_BY(mu_);
+  string serialized_engine_ GUARDED_BY(mu_);
+  std::shared_ptr<EngineContext> static_engine_ GUARDED_BY(mu_);
+  InputShapes static_engine_shapes_ GUARDED_BY(mu_);
+  // The engines built at runtime, from the most to the least recently used.
+  std::list<std::pair<InputShapes, std::shared_ptr<EngineContext>>>
+      engine_cache_ GUARDED_BY(mu_);
+  bool engine_building_ GUARDED_BY(mu_) = false;
+  // Set when an engine fails to build, which is usually due to an op that
+  // TensorRT does not support, so that no more builds are attempted.
+  bool engine_build_failed_ GUARDED_BY(mu_) = false;
+  FunctionLibraryRuntime::Handle native_func_ GUARDED_BY(mu_) =
+      kInvalidHandle;
+
+  // Builds the engines, one at a time.
+  std::unique_ptr<thread::ThreadPool> build_thread_;
 };
 
 }  // namespace tensorrt
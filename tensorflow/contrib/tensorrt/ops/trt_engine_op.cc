@@ -33,6 +33,11 @@ REGISTER_OP("TRTEngineOp")
     .Attr("output_nodes: list(string)")
     .Attr("InT: list({float32})")
     .Attr("OutT: list({float32})")
+    .Attr("segment_funcdef_name: string = ''")
+    .Attr("segment_graph: string = ''")
+    .Attr("max_cached_engines_count: int = 0")
+    .Attr("precision_mode: int = 0")
+    .Attr("workspace_size_bytes: int = 0")
     .Input("in_tensor: InT")
     .Output("out_tensor: OutT")
     .SetShapeFn(shape_inference::TRTEngineOpShapeInference);
@@ -40,7 +40,8 @@ def create_inference_graph(input_graph_def,
                            max_batch_size=1,
                            max_workspace_size_bytes=2 << 20,
                            precision_mode="FP32",
-                           minimum_segment_size=3):
+                           minimum_segment_size=3,
+                           maximum_cached_engines=1):
   """Python wrapper for the TRT transformation.
 
   Args:
@@ -51,6 +52,11 @@ def create_inference_graph(input_graph_def,
     precision_mode: one of 'FP32', 'FP16' and 'INT8'
     minimum_segment_size: the minimum number of nodes required for a subgraph to
       be replaced by TRTEngineOp.
+    maximum_cached_engines: the maximum number of engines each TRTEngineOp
+      builds at runtime for the input shapes that its static engine does not
+      support. While an engine is being built, and for shapes beyond the
+      cache, the op runs the original TensorFlow subgraph. Zero disables
+      building engines at runtime.
 
   Returns:
     New GraphDef with TRTEngineOps placed in graph replacing subgraphs.
@@ -65,6 +71,9 @@ def create_inference_graph(input_graph_def,
                       "It should be one of {}").format(
                           precision_mode, "{'FP32', 'FP16', 'INT8'}"))
   mode = supported_precision_modes[precision_mode.upper()]
+  if maximum_cached_engines < 0:
+    raise ValueError("maximum_cached_engines must be non-negative, got %d" %
+                     maximum_cached_engines)
 
   def py2bytes(inp):
     return inp
@@ -100,7 +109,8 @@ def create_inference_graph(input_graph_def,
   # pair or strings where first one is encoded status and the second
   # one is the transformed graphs protobuf string.
   out = trt_convert(input_graph_def_str, out_names, max_batch_size,
-                    max_workspace_size_bytes, mode, minimum_segment_size)
+                    max_workspace_size_bytes, mode, minimum_segment_size,
+                    maximum_cached_engines)
   status = to_string(out[0])
   output_graph_def_string = out[1]
   del input_graph_def_str  # Save some memory
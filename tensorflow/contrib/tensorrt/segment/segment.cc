@@ -279,6 +279,30 @@ bool CanContractEdge(const SimpleEdge* edge,
   bool is_cycle = CheckCycles(graph, src, dfs_start_nodes);
   return !is_cycle;
 }
+
+// Returns the estimated benefit of running 'nodes' in a TensorRT engine: the
+// total cost of the nodes minus the cost of every distinct tensor that has to
+// cross the boundary of the segment.
+double SegmentBenefit(const std::vector<const tensorflow::Node*>& nodes,
+                      const std::set<string>& node_names,
+                      const SegmentOptions& options) {
+  double cost = 0;
+  std::set<std::pair<int, int>> boundary_tensors;
+  for (const tensorflow::Node* node : nodes) {
+    cost += options.node_cost_fn ? options.node_cost_fn(node) : 1.0;
+    for (const tensorflow::Edge* edge : node->in_edges()) {
+      if (!edge->IsControlEdge() && !node_names.count(edge->src()->name())) {
+        boundary_tensors.emplace(edge->src()->id(), edge->src_output());
+      }
+    }
+    for (const tensorflow::Edge* edge : node->out_edges()) {
+      if (!edge->IsControlEdge() && !node_names.count(edge->dst()->name())) {
+        boundary_tensors.emplace(node->id(), edge->src_output());
+      }
+    }
+  }
+  return cost - options.boundary_tensor_cost * boundary_tensors.size();
+}
 }  // namespace
 
 void ContractEdge(SimpleEdge* edge, SimpleGraph* graph,
@@ -458,11 +482,13 @@ tensorflow::Status SegmentGraph(
   // Collect the segments/subgraphs. Each subgraph is represented by a
   // set of the names of the nodes in that subgraph.
   std::unordered_map<string, std::set<string>> sg_map;
+  std::unordered_map<string, std::vector<const tensorflow::Node*>> sg_nodes;
   std::unordered_map<string, std::set<string>> device_maps;
   for (auto& u : node_segments) {
     if ((u.Value() != nullptr) && (u.ParentValue() != nullptr)) {
       sg_map[u.ParentValue()->name()].insert(u.Value()->name());
       auto tf_node = u.Value()->tf_node();
+      sg_nodes[u.ParentValue()->name()].push_back(tf_node);
       // has_assigned_device_name() is expected to return true
       // when called from optimization pass. However, since graph
       // is converted back and forth between graph and graphdef,
@@ -500,6 +526,18 @@ tensorflow::Status SegmentGraph(
               << segment_node_names.size() << " nodes, dropping";
       continue;
     }
+    // Don't use segments whose work doesn't pay for moving their inputs and
+    // outputs in and out of the engine.
+    if (options.minimum_segment_cost > 0) {
+      const double benefit =
+          SegmentBenefit(sg_nodes[itr.first], segment_node_names, options);
+      if (benefit < options.minimum_segment_cost) {
+        VLOG(1) << "Segment " << segments->size() << " has an estimated "
+                << "benefit of " << benefit << ", below the minimum of "
+                << options.minimum_segment_cost << ", dropping";
+        continue;
+      }
+    }
     // TODO(sami): Make segmenter placement aware once trtscopes are in place
     const auto& dev_itr = device_maps.find(itr.first);
     if (dev_itr == device_maps.end() || dev_itr->second.empty()) {
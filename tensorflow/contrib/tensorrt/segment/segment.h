@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_TENSORRT_SEGMENT_SEGMENT_H_
 #define TENSORFLOW_CONTRIB_TENSORRT_SEGMENT_SEGMENT_H_
 
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -37,6 +38,14 @@ struct SegmentOptions {
   // Segment must contain at least this many nodes.
   int minimum_segment_size = 2;
   std::set<string> exclude_node_list;
+  // Estimated cost of running a node, used to decide whether a segment is
+  // worth converting. When unset every node costs 1.
+  std::function<double(const tensorflow::Node*)> node_cost_fn;
+  // Cost charged for every distinct tensor crossing the segment boundary,
+  // in the same unit as node_cost_fn.
+  double boundary_tensor_cost = 0;
+  // Segments whose node cost minus boundary cost is below this are dropped.
+  double minimum_segment_cost = 0;
 };
 
 // Get the subgraphs of a graph that can be handled by TensorRT.
@@ -360,6 +360,78 @@ TEST_F(SegmentTest, BigIfElse) {
   TF_DeleteStatus(s);
 }
 
+TEST_F(SegmentTest, MinimumSegmentCost) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  //           feed
+  //            ||
+  //           add0
+  //            ||
+  //           add1
+  //            ||
+  //           add2 (not a candidate)
+  //            ||
+  //           add3
+  //            ||
+  //           add4
+  //            ||
+  //           add5
+  //            ||
+  //          <sink>
+  //
+  TF_Operation* feed = Placeholder(graph, s, "feed");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add0 = Add(feed, feed, graph, s, "add0");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add1 = Add(add0, add0, graph, s, "add1");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add2 = Add(add1, add1, graph, s, "add2");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add3 = Add(add2, add2, graph, s, "add3");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add4 = Add(add3, add3, graph, s, "add4");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add5 = Add(add4, add4, graph, s, "add5");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(string("add5"), string(TF_OperationName(add5)));
+
+  GraphDef graph_def;
+  ASSERT_TRUE(GetGraphDef(graph, &graph_def));
+
+  // add3 is expensive, so {add3, add4, add5} pays for its single input while
+  // {add0, add1} doesn't pay for its input and output.
+  SegmentOptions options = default_options_;
+  options.node_cost_fn = [](const tensorflow::Node* node) {
+    return node->name() == "add3" ? 4.0 : 1.0;
+  };
+  options.boundary_tensor_cost = 1.5;
+  options.minimum_segment_cost = 2;
+
+  SegmentNodesVector segments;
+  ASSERT_EQ(SegmentGraph(graph_def,
+                         MakeCandidateFn(
+                             {"add0", "add1", "add3", "add4", "add5"}),
+                         options, &segments),
+            tensorflow::Status::OK());
+
+  ASSERT_EQ(segments.size(), 1);
+  EXPECT_EQ(segments[0].first,
+            std::set<string>({"add3", "add4", "add5"}));
+
+  // Without a minimum cost both segments are kept.
+  options.minimum_segment_cost = 0;
+  segments.clear();
+  ASSERT_EQ(SegmentGraph(graph_def,
+                         MakeCandidateFn(
+                             {"add0", "add1", "add3", "add4", "add5"}),
+                         options, &segments),
+            tensorflow::Status::OK());
+  EXPECT_EQ(segments.size(), 2);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 }  // namespace test
 }  // namespace segment
 }  // namespace tensorrt
@@ -32,6 +32,17 @@ tensorflow::Status TRTEngineOpShapeInference(InferenceContext* context) {
   tensorflow::tensorrt::Logger logger;
   string serialized_engine;
   TF_RETURN_IF_ERROR(context->GetAttr("serialized_engine", &serialized_engine));
+  int max_cached_engines_count;
+  TF_RETURN_IF_ERROR(
+      context->GetAttr("max_cached_engines_count", &max_cached_engines_count));
+  if (serialized_engine.empty() || max_cached_engines_count > 0) {
+    // The engines built at runtime may support other shapes than the static
+    // one.
+    for (int i = 0; i < context->num_outputs(); i++) {
+      context->set_output(i, context->UnknownShape());
+    }
+    return Status::OK();
+  }
   nvinfer1::IRuntime* infer = nvinfer1::createInferRuntime(logger);
   nvinfer1::ICudaEngine* trt_engine = infer->deserializeCudaEngine(
       serialized_engine.c_str(), serialized_engine.size(),
@@ -80,6 +91,8 @@ tensorflow::Status TRTEngineOpShapeInference(InferenceContext* context) {
     output_shape = context->MakeShape(dim_vec);
     context->set_output(i, output_shape);
   }
+  trt_engine->destroy();
+  infer->destroy();
 
   return Status::OK();
 }
@@ -124,6 +124,25 @@ class IntegrationTest(test_util.TensorFlowTestCase):
     result1 = self.run_graph(trt_graph, self._input)
     self.assertAllEqual(result1, result)
 
+  def testDynamicBatchSize(self):
+    """Test a batch larger than the one the static engine was built for."""
+    trt_graph = self.get_trt_graph("FP32")
+    large_input = np.concatenate([self._input, self._input])
+    reference = np.concatenate([self._reference, self._reference])
+    ops.reset_default_graph()
+    g = ops.Graph()
+    with g.as_default():
+      inp, out = importer.import_graph_def(
+          graph_def=trt_graph, return_elements=["input", "output"])
+      inp = inp.outputs[0]
+      out = out.outputs[0]
+    with self.test_session(
+        graph=g, config=self._config, use_gpu=True, force_gpu=True) as sess:
+      # The first runs use the original subgraph while the engine for the
+      # larger batch is being built, and the later ones use the engine.
+      for _ in range(10):
+        self.assertAllEqual(reference, sess.run(out, {inp: large_input}))
+
   def testFP16(self):
     """Test FP16 conversion. Results may be different from native case."""
     trt_graph = self.get_trt_graph("FP16")
@@ -18,9 +18,11 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 #include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/mutex.h"
 
 #define VALUE_IN_DEBUG_STRING false
 
@@ -58,6 +60,21 @@ int64 CollectiveAdapter::AlignedChunkElts(int64 elt_bytes, int64 total_elts,
 }
 
 namespace {
+// Runs "reducer" in an I/O thread, so as not to starve the executor
+// threads, and deletes it when it is done.
+// TODO(tucker): Instead of forking every per-device Collective
+// Op off into its own thread, consider queuing them on a
+// fixed-size thread-pool dedicated to running CollectiveOps.
+template <typename Reducer>
+void RunReducer(Reducer* reducer, const StatusCallback& done) {
+  SchedClosure([reducer, done]() {
+    reducer->Run([reducer, done](const Status& s) {
+      done(s);
+      delete reducer;
+    });
+  });
+}
+
 template <typename T>
 class CollectiveAdapterImpl : public CollectiveAdapter {
  public:
@@ -182,6 +199,24 @@ CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
   }
 }
 
+namespace {
+mutex nccl_reduce_mu(LINKER_INITIALIZED);
+ExternalReduceFunction* nccl_reduce_fn GUARDED_BY(nccl_reduce_mu) = nullptr;
+}  // namespace
+
+void RegisterNcclReduceFunction(ExternalReduceFunction fn) {
+  mutex_lock l(nccl_reduce_mu);
+  // The NCCL kernels may be both linked in and loaded as a custom op library.
+  if (nccl_reduce_fn == nullptr) {
+    nccl_reduce_fn = new ExternalReduceFunction(std::move(fn));
+  }
+}
+
+const ExternalReduceFunction* NcclReduceFunction() {
+  mutex_lock l(nccl_reduce_mu);
+  return nccl_reduce_fn;
+}
+
 BaseCollectiveExecutor::~BaseCollectiveExecutor() {}
 
 void BaseCollectiveExecutor::StartAbort(const Status& s) {
@@ -217,23 +252,29 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
       // TODO(tucker): support other reduction algorithms,
       // e.g. tree-reduce, hybrid tree/ring, delegate-to-NCCL, etc.
       const Tensor* input = &ctx->input(0);
-      RingReducer* reducer =
-          CreateReducer(ctx, CtxParams(ctx), col_params, exec_key, step_id_,
-                        input, output, &error);
-      if (!reducer) {
+      if (!CheckReducerDataType(col_params, &error)) {
         done_safe(errors::Internal(error));
         return;
       }
-      // Run in an I/O thread, so as not to starve the executor threads.
-      // TODO(tucker): Instead of forking every per-device Collective
-      // Op off into its own thread, consider queuing them on a
-      // fixed-size thread-pool dedicated to running CollectiveOps.
-      SchedClosure([reducer, done_safe]() {
-        reducer->Run([reducer, done_safe](const Status& s) {
-          done_safe(s);
-          delete reducer;
-        });
-      });
+      if (col_params.instance.impl_details.nccl) {
+        // NCCL queues its kernels on its own streams and calls back when
+        // they complete, so there's no need for a thread of our own, and
+        // each gradient starts reducing as soon as all devices produced it.
+        const ExternalReduceFunction* nccl_reduce = NcclReduceFunction();
+        CHECK(nccl_reduce != nullptr);
+        (*nccl_reduce)(ctx, col_params, exec_key, step_id_, input, output,
+                       done_safe);
+      } else if (col_params.instance.impl_details.hierarchical) {
+        RunReducer(new HierarchicalReducer(this, dev_mgr_, ctx, CtxParams(ctx),
+                                           col_params, exec_key, step_id_,
+                                           input, output),
+                   done_safe);
+      } else {
+        RunReducer(new RingReducer(this, dev_mgr_, ctx, CtxParams(ctx),
+                                   col_params, exec_key, step_id_, input,
+                                   output),
+                   done_safe);
+      }
     } break;
 
     case BROADCAST_COLLECTIVE: {
@@ -258,29 +299,25 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   }
 }
 
-RingReducer* BaseCollectiveExecutor::CreateReducer(
-    OpKernelContext* ctx, OpKernelContext::Params* params,
-    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
-    const Tensor* input, Tensor* output, string* error) {
+bool BaseCollectiveExecutor::CheckReducerDataType(
+    const CollectiveParams& col_params, string* error) {
   switch (col_params.instance.data_type) {
     case DT_INT32:
       if (col_params.group.device_type == DEVICE_GPU) {
         *error =
             "Collective Reduce does not support datatype DT_INT32 on "
             "DEVICE_GPU";
-        return nullptr;
+        return false;
       }
       TF_FALLTHROUGH_INTENDED;
     case DT_FLOAT:
     case DT_DOUBLE:
     case DT_INT64:
-      return new RingReducer(this, dev_mgr_, ctx, params, col_params, exec_key,
-                             step_id, input, output);
-      break;
+      return true;
     default:
       *error = strings::StrCat("Collective Reduce does not support datatype ",
                                col_params.instance.data_type);
-      return nullptr;
+      return false;
   }
 }
 
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 
+#include <functional>
 #include <string>
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/framework/collective.h"
@@ -80,6 +81,24 @@ class CollectiveAdapter {
 CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
                                          Allocator* allocator);
 
+// Runs a whole collective all-reduce of "input" into "output" on behalf of
+// the device of "ctx", and calls "done" once "output" holds the result.
+typedef std::function<void(OpKernelContext* ctx,
+                           const CollectiveParams& col_params,
+                           const string& exec_key, int64 step_id,
+                           const Tensor* input, Tensor* output,
+                           const StatusCallback& done)>
+    ExternalReduceFunction;
+
+// NCCL can't be linked into core, so the library that wraps it registers its
+// all-reduce here when it is loaded; later registrations are ignored.  CollectiveParamResolverLocal then sets
+// impl_details.nccl for the reductions it can run, which are those among the
+// GPUs of a single task without a final_op; all others keep using the ring.
+void RegisterNcclReduceFunction(ExternalReduceFunction fn);
+
+// Returns the function registered by RegisterNcclReduceFunction, or nullptr.
+const ExternalReduceFunction* NcclReduceFunction();
+
 // Default implementation of CollectiveExecutor.  Delegates the actual
 // work of moving data to a class specialized for the operation type,
 // arguments and device+interconnect topology.
@@ -133,12 +152,10 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unique_ptr<PerStepCollectiveRemoteAccess> remote_access_;
 
  private:
-  RingReducer* CreateReducer(OpKernelContext* ctx,
-                             OpKernelContext::Params* params,
-                             const CollectiveParams& col_params,
-                             const string& exec_key, int64 step_id,
-                             const Tensor* input, Tensor* output,
-                             string* error);
+  // Returns true if the data type of "col_params" can be reduced, and
+  // otherwise sets "*error".
+  bool CheckReducerDataType(const CollectiveParams& col_params,
+                            string* error);
 
   Broadcaster* CreateBroadcaster(OpKernelContext* ctx,
                                  OpKernelContext::Params* params,
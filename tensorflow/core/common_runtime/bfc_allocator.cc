@@ -14,25 +14,44 @@ limitations under the License.
 ==============================================================================*/
 
 #include <atomic>
+#include <thread>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* bfc_allocator_bytes_in_use = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/bfc_allocator/bytes_in_use",
+    "The bytes allocated by a BFC allocator and in use, excluding the chunks "
+    "held by its caches.",
+    "allocator");
+
+auto* bfc_allocator_bytes_limit = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/bfc_allocator/bytes_limit",
+    "The memory limit of a BFC allocator.", "allocator");
+
+}  // namespace
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name)
     : suballocator_(sub_allocator),
       name_(name),
+      bytes_in_use_cell_(bfc_allocator_bytes_in_use->GetCell(name)),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
   if (allow_growth) {
@@ -47,6 +66,7 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
   // Allocate the requested amount of memory.
   memory_limit_ = total_memory;
   stats_.bytes_limit = static_cast<int64>(total_memory);
+  bfc_allocator_bytes_limit->GetCell(name)->Set(stats_.bytes_limit);
 
   // Create a bunch of bins of various good sizes.
 
@@ -65,6 +85,14 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  bool cache_small_chunks = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_BFC_ALLOCATOR_CACHE_SMALL_CHUNKS",
+                                 /*default_val=*/false, &cache_small_chunks));
+  if (cache_small_chunks) {
+    caches_.reset(new ChunkCache[kNumCacheShards]);
+    allocation_shards_.reset(new AllocationShard[kNumCacheShards]);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -169,6 +197,34 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   return true;
 }
 
+size_t BFCAllocator::ReleaseFreeRegions() {
+  // The visitors may have registered the regions, e.g. with a NIC, and are
+  // never told that a region is gone.
+  if (!region_visitors_.empty()) {
+    return 0;
+  }
+  std::vector<std::pair<void*, size_t>> free_regions;
+  for (const auto& region : region_manager_.regions()) {
+    const Chunk* c = ChunkFromHandle(region_manager_.get_handle(region.ptr()));
+    if (!c->in_use() && c->size == region.memory_size()) {
+      free_regions.emplace_back(region.ptr(), region.memory_size());
+    }
+  }
+  size_t released_bytes = 0;
+  for (const auto& region : free_regions) {
+    ChunkHandle h = region_manager_.get_handle(region.first);
+    RemoveFreeChunkFromBin(h);
+    DeleteChunk(h);
+    region_manager_.RemoveAllocationRegion(region.first);
+    suballocator_->Free(region.first, region.second);
+    total_region_allocated_bytes_ -= region.second;
+    released_bytes += region.second;
+    VLOG(1) << "Released memory at " << region.first << " of "
+            << strings::HumanReadableNumBytes(region.second) << " bytes.";
+  }
+  return released_bytes;
+}
+
 BFCAllocator::ChunkHandle BFCAllocator::AllocateChunk() {
   if (free_chunks_list_ != kInvalidChunkHandle) {
     ChunkHandle h = free_chunks_list_;
@@ -251,34 +307,66 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  const bool cacheable =
+      caching_enabled() && rounded_bytes <= kMaxCachedChunkBytes;
+  if (cacheable) {
+    void* ptr = AllocateFromCache(rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
-  mutex_lock l(lock_);
-  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
-  if (ptr != nullptr) {
-    return ptr;
-  }
-
-  // Try to extend
-  if (Extend(unused_alignment, rounded_bytes)) {
+  void* ptr = nullptr;
+  CacheableAllocation a;
+  {
+    mutex_lock l(lock_);
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
-    if (ptr != nullptr) {
-      return ptr;
+
+    // Try to extend
+    if (ptr == nullptr && Extend(unused_alignment, rounded_bytes)) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+    }
+
+    // Chunks sitting in the caches may coalesce into one that fits.
+    if (ptr == nullptr && caching_enabled() && FlushCaches() > 0) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
     }
-  }
 
-  // We searched all bins for an existing free chunk to use and
-  // couldn't find one.  This means we must have run out of memory,
-  // Dump the memory log for analysis.
-  if (dump_log_on_failure) {
-    LOG(WARNING) << "Allocator (" << Name() << ") ran out of memory trying "
-                 << "to allocate " << strings::HumanReadableNumBytes(num_bytes)
-                 << ".  Current allocation summary follows.";
-    DumpMemoryLog(rounded_bytes);
-    LOG(WARNING) << RenderOccupancy();
+    // The free memory may be split across regions that are each too small.
+    // Return the unused ones and try again with one large region.
+    if (ptr == nullptr && ReleaseFreeRegions() > 0 &&
+        Extend(unused_alignment, rounded_bytes)) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+    }
+
+    if (ptr == nullptr) {
+      // We searched all bins for an existing free chunk to use and
+      // couldn't find one.  This means we must have run out of memory,
+      // Dump the memory log for analysis.
+      if (dump_log_on_failure) {
+        LOG(WARNING) << "Allocator (" << Name()
+                     << ") ran out of memory trying "
+                     << "to allocate "
+                     << strings::HumanReadableNumBytes(num_bytes)
+                     << ".  Current allocation summary follows.";
+        DumpMemoryLog(rounded_bytes);
+        LOG(WARNING) << RenderOccupancy();
+      }
+      return nullptr;
+    }
+
+    if (cacheable) {
+      const Chunk* c = ChunkFromHandle(region_manager_.get_handle(ptr));
+      a = {rounded_bytes, num_bytes, c->size, c->allocation_id};
+    }
   }
-  return nullptr;
+  if (cacheable) {
+    AddCacheableAllocation(ptr, a);
+  }
+  return ptr;
 }
 
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
@@ -319,6 +407,7 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // Update stats.
         ++stats_.num_allocs;
         stats_.bytes_in_use += chunk->size;
+        bytes_in_use_cell_->IncrementBy(chunk->size);
         stats_.max_bytes_in_use =
             std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
         stats_.max_alloc_size =
@@ -381,6 +470,9 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     LOG(ERROR) << "tried to deallocate nullptr";
     return;
   }
+  if (caching_enabled() && DeallocateToCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
 
   // Find the chunk from the ptr.
@@ -470,6 +562,7 @@ void BFCAllocator::FreeAndMaybeCoalesce(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  bytes_in_use_cell_->IncrementBy(-static_cast<int64>(c->size));
 
   // This chunk is no longer in-use, consider coalescing the chunk
   // with adjacent chunks.
@@ -510,6 +603,115 @@ void BFCAllocator::FreeAndMaybeCoalesce(BFCAllocator::ChunkHandle h) {
   InsertFreeChunkIntoBin(chunk_to_reassign);
 }
 
+BFCAllocator::ChunkCache* BFCAllocator::CacheForCurrentThread() {
+  const size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &caches_[h % kNumCacheShards];
+}
+
+BFCAllocator::AllocationShard* BFCAllocator::ShardFor(const void* ptr) {
+  // The low bits of a chunk address are always zero.
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptr);
+  return &allocation_shards_[(p >> kMinAllocationBits) % kNumCacheShards];
+}
+
+void* BFCAllocator::AllocateFromCache(size_t rounded_bytes, size_t num_bytes) {
+  CachedChunk c;
+  {
+    ChunkCache* cache = CacheForCurrentThread();
+    mutex_lock l(cache->mu);
+    std::vector<CachedChunk>& free_chunks =
+        cache->free_chunks[(rounded_bytes >> kMinAllocationBits) - 1];
+    if (free_chunks.empty()) {
+      return nullptr;
+    }
+    c = free_chunks.back();
+    free_chunks.pop_back();
+  }
+  num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  bytes_in_caches_.fetch_sub(c.chunk_bytes, std::memory_order_relaxed);
+  bytes_in_use_cell_->IncrementBy(c.chunk_bytes);
+  AddCacheableAllocation(
+      c.ptr, {rounded_bytes, num_bytes, c.chunk_bytes, next_allocation_id_++});
+  return c.ptr;
+}
+
+void BFCAllocator::AddCacheableAllocation(void* ptr,
+                                          const CacheableAllocation& a) {
+  AllocationShard* shard = ShardFor(ptr);
+  mutex_lock l(shard->mu);
+  shard->allocations[ptr] = a;
+}
+
+bool BFCAllocator::FindCacheableAllocation(const void* ptr, bool erase,
+                                           CacheableAllocation* a) {
+  AllocationShard* shard = ShardFor(ptr);
+  mutex_lock l(shard->mu);
+  auto it = shard->allocations.find(ptr);
+  if (it == shard->allocations.end()) {
+    return false;
+  }
+  *a = it->second;
+  if (erase) {
+    shard->allocations.erase(it);
+  }
+  return true;
+}
+
+bool BFCAllocator::DeallocateToCache(void* ptr) {
+  CacheableAllocation a;
+  if (!FindCacheableAllocation(ptr, /*erase=*/true, &a)) {
+    return false;
+  }
+  bytes_in_caches_.fetch_add(a.chunk_bytes, std::memory_order_relaxed);
+  bytes_in_use_cell_->IncrementBy(-static_cast<int64>(a.chunk_bytes));
+  std::vector<CachedChunk> to_free;
+  {
+    ChunkCache* cache = CacheForCurrentThread();
+    mutex_lock l(cache->mu);
+    std::vector<CachedChunk>& free_chunks =
+        cache->free_chunks[(a.rounded_bytes >> kMinAllocationBits) - 1];
+    free_chunks.push_back({ptr, a.chunk_bytes});
+    if (free_chunks.size() > kMaxCachedChunksPerSize) {
+      // Return the older half in one batch, so that the lock_ is taken
+      // once per kMaxCachedChunksPerSize / 2 frees at most.
+      const size_t n = free_chunks.size() / 2;
+      to_free.assign(free_chunks.begin(), free_chunks.begin() + n);
+      free_chunks.erase(free_chunks.begin(), free_chunks.begin() + n);
+    }
+  }
+  if (!to_free.empty()) {
+    mutex_lock l(lock_);
+    for (const CachedChunk& c : to_free) {
+      FreeCachedChunk(c);
+    }
+  }
+  return true;
+}
+
+void BFCAllocator::FreeCachedChunk(const CachedChunk& c) {
+  bytes_in_caches_.fetch_sub(c.chunk_bytes, std::memory_order_relaxed);
+  bytes_in_use_cell_->IncrementBy(c.chunk_bytes);
+  BFCAllocator::ChunkHandle h = region_manager_.get_handle(c.ptr);
+  CHECK(h != kInvalidChunkHandle);
+  FreeAndMaybeCoalesce(h);
+}
+
+size_t BFCAllocator::FlushCaches() {
+  size_t num_freed = 0;
+  for (int i = 0; i < kNumCacheShards; ++i) {
+    ChunkCache* cache = &caches_[i];
+    mutex_lock l(cache->mu);
+    for (std::vector<CachedChunk>& free_chunks : cache->free_chunks) {
+      for (const CachedChunk& c : free_chunks) {
+        FreeCachedChunk(c);
+      }
+      num_freed += free_chunks.size();
+      free_chunks.clear();
+    }
+  }
+  return num_freed;
+}
+
 void BFCAllocator::AddAllocVisitor(Visitor visitor) {
   VLOG(1) << "AddVisitor";
   mutex_lock l(lock_);
@@ -522,6 +724,10 @@ void BFCAllocator::AddAllocVisitor(Visitor visitor) {
 bool BFCAllocator::TracksAllocationSizes() { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) {
+  CacheableAllocation a;
+  if (caching_enabled() && FindCacheableAllocation(ptr, /*erase=*/false, &a)) {
+    return a.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -540,6 +746,10 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) {
 }
 
 int64 BFCAllocator::AllocationId(const void* ptr) {
+  CacheableAllocation a;
+  if (caching_enabled() && FindCacheableAllocation(ptr, /*erase=*/false, &a)) {
+    return a.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -683,6 +893,12 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
 void BFCAllocator::GetStats(AllocatorStats* stats) {
   mutex_lock l(lock_);
   *stats = stats_;
+  // Chunks held by the caches are still in use as far as stats_ is
+  // concerned, and cache hits never reach the bins.
+  stats->num_cache_hits = num_cache_hits_.load(std::memory_order_relaxed);
+  stats->bytes_in_caches = bytes_in_caches_.load(std::memory_order_relaxed);
+  stats->num_allocs += stats->num_cache_hits;
+  stats->bytes_in_use -= stats->bytes_in_caches;
 }
 
 void BFCAllocator::ClearStats() {
@@ -690,6 +906,7 @@ void BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.max_bytes_in_use = stats_.bytes_in_use;
   stats_.max_alloc_size = 0;
+  num_cache_hits_.store(0, std::memory_order_relaxed);
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -24,7 +25,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/visitable_allocator.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -42,6 +45,14 @@ namespace tensorflow {
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If the environment variable TF_BFC_ALLOCATOR_CACHE_SMALL_CHUNKS is set to
+// true, freed chunks of up to kMaxCachedChunkBytes are not coalesced right
+// away but kept in per-thread caches (sharded by thread id), from which
+// allocations of the same rounded size are served without taking the
+// allocator-wide lock. A cache that grows too large returns half of its
+// chunks to the bins in one batch, and all caches are flushed before an
+// allocation is allowed to fail.
 class BFCAllocator : public VisitableAllocator {
  public:
   // Takes ownership of sub_allocator.
@@ -263,6 +274,15 @@ class BFCAllocator : public VisitableAllocator {
       regions_.insert(entry, AllocationRegion(ptr, memory_size));
     }
 
+    // Removes the region starting at 'ptr'.
+    void RemoveAllocationRegion(const void* ptr) {
+      auto entry =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      CHECK(entry != regions_.end() && entry->ptr() == ptr)
+          << "Could not find Region for " << ptr;
+      regions_.erase(entry);
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -299,6 +319,62 @@ class BFCAllocator : public VisitableAllocator {
     std::vector<AllocationRegion> regions_;
   };
 
+  // Small-chunk caches. A chunk handed out to a client or held by a cache is
+  // "in use" as far as the bins are concerned. Lock order: lock_ before
+  // ChunkCache::mu; AllocationShard::mu is never held with either.
+  static const int kNumCacheShards = 16;
+  static const size_t kMaxCachedChunkBytes = 64 << 10;
+  // When a cache holds more than this many chunks of one size, it returns
+  // the older half of them to the bins.
+  static const size_t kMaxCachedChunksPerSize = 64;
+
+  struct CachedChunk {
+    void* ptr;
+    size_t chunk_bytes;  // The size of the underlying chunk.
+  };
+  struct ChunkCache {
+    mutex mu;
+    // free_chunks[i] holds chunks allocated for requests that round up to
+    // (i + 1) * kMinAllocationSize bytes, most recently freed last.
+    std::vector<CachedChunk>
+        free_chunks[kMaxCachedChunkBytes >> kMinAllocationBits] GUARDED_BY(mu);
+  };
+  // What the allocator knows about a live allocation of at most
+  // kMaxCachedChunkBytes, so that it can be cached when freed without
+  // looking at the chunk.
+  struct CacheableAllocation {
+    size_t rounded_bytes;
+    size_t requested_size;
+    size_t chunk_bytes;
+    int64 allocation_id;
+  };
+  struct AllocationShard {
+    mutex mu;
+    gtl::FlatMap<const void*, CacheableAllocation> allocations GUARDED_BY(mu);
+  };
+
+  bool caching_enabled() const { return caches_ != nullptr; }
+  ChunkCache* CacheForCurrentThread();
+  AllocationShard* ShardFor(const void* ptr);
+
+  // Returns a cached chunk that fits a request of 'rounded_bytes', or
+  // nullptr on a cache miss.
+  void* AllocateFromCache(size_t rounded_bytes, size_t num_bytes);
+  // Records a live cacheable allocation.
+  void AddCacheableAllocation(void* ptr, const CacheableAllocation& a);
+  // Returns true and fills *a if 'ptr' is a live cacheable allocation. If
+  // 'erase' is true, the allocation is forgotten.
+  bool FindCacheableAllocation(const void* ptr, bool erase,
+                               CacheableAllocation* a);
+  // Puts 'ptr' in the cache of the calling thread. Returns false if 'ptr' is
+  // not a cacheable allocation.
+  bool DeallocateToCache(void* ptr);
+  // Returns a cached chunk to the bins.
+  void FreeCachedChunk(const CachedChunk& c) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns all cached chunks to the bins. Returns the number of chunks
+  // freed.
+  size_t FlushCaches() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns 'bytes' rounded up to the next highest kMinAllocationSize.
   size_t RoundedBytes(size_t bytes);
 
@@ -308,6 +384,11 @@ class BFCAllocator : public VisitableAllocator {
   bool Extend(size_t alignment, size_t rounded_bytes)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the regions that hold no allocated chunk to the sub-allocator, so
+  // that Extend() can allocate one larger region in their place. Returns the
+  // number of bytes released.
+  size_t ReleaseFreeRegions() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes)
@@ -416,6 +497,8 @@ class BFCAllocator : public VisitableAllocator {
 
   std::unique_ptr<SubAllocator> suballocator_;
   string name_;
+  // Exports the bytes in use, i.e. stats_.bytes_in_use - bytes_in_caches_.
+  monitoring::GaugeCell<int64>* const bytes_in_use_cell_;
 
   // Structures mutable after construction
   mutable mutex lock_;
@@ -431,11 +514,17 @@ class BFCAllocator : public VisitableAllocator {
 
   // Counter containing the next unique identifier to assign to a
   // newly-created chunk.
-  int64 next_allocation_id_ GUARDED_BY(lock_);
+  std::atomic<int64> next_allocation_id_;
 
   // Stats.
   AllocatorStats stats_ GUARDED_BY(lock_);
 
+  // Null unless small-chunk caching is enabled. Arrays of kNumCacheShards.
+  std::unique_ptr<ChunkCache[]> caches_;
+  std::unique_ptr<AllocationShard[]> allocation_shards_;
+  std::atomic<int64> num_cache_hits_{0};
+  std::atomic<int64> bytes_in_caches_{0};
+
   friend class GPUBFCAllocatorPrivateMethodsTest;
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
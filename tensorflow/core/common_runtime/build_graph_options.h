@@ -16,13 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BUILD_GRAPH_OPTIONS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BUILD_GRAPH_OPTIONS_H_
 
+#include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
+class SetupStatsCollector;
+
 struct BuildGraphOptions {
   CallableOptions callable_options;
 
@@ -34,6 +38,16 @@ struct BuildGraphOptions {
   static const int64 kNoCollectiveGraphKey = 0;
   int64 collective_graph_key = kNoCollectiveGraphKey;
 
+  // If non-null, the wall time of each phase of building the client graph is
+  // recorded into it.
+  SetupStatsCollector* setup_stats = nullptr;  // Not owned.
+
+  // The shapes of the fed tensors that the graph is specialized for, keyed by
+  // their names in `callable_options.feed()`. Grappler optimizes the graph
+  // assuming that the placeholders fed with them always have these shapes,
+  // so the graph must only be run with feeds of exactly these shapes.
+  std::unordered_map<string, TensorShape> feed_shapes;
+
   string DebugString() const;
 };
 
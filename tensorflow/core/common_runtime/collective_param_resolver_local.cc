@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 
 namespace tensorflow {
@@ -499,6 +500,20 @@ void CollectiveParamResolverLocal::CompleteDefaultRanking(
 
   ir->shared.instance.device_names = new_device_names;
   ir->shared.instance.task_names = new_task_names;
+  // The ranking above keeps the devices of each task adjacent, so a
+  // reduction among several tasks that each have several devices can
+  // reduce over the links within each task before it crosses tasks.
+  const int num_tasks = ir->shared.group.num_tasks;
+  ir->shared.instance.impl_details.hierarchical =
+      ir->shared.instance.type == REDUCTION_COLLECTIVE && num_tasks > 1 &&
+      ir->shared.instance.same_num_devices_per_task &&
+      num_devices / num_tasks > 1;
+  // NCCL only reduces among the GPUs of one process, and has no way to apply
+  // a final_op such as the division of a mean.
+  ir->shared.instance.impl_details.nccl =
+      ir->shared.instance.type == REDUCTION_COLLECTIVE && num_tasks == 1 &&
+      ir->shared.group.device_type == DEVICE_GPU && cp->merge_op &&
+      !cp->final_op && NcclReduceFunction() != nullptr;
   if (VLOG_IS_ON(2)) {
     string buf;
     for (const auto& d : cp->instance.device_names)
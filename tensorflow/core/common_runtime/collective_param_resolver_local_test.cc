@@ -95,6 +95,8 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
     EXPECT_FALSE(cps[i].is_source);
     EXPECT_EQ(cps[i].default_rank, i);
     EXPECT_TRUE(cps[i].instance.same_num_devices_per_task);
+    // NCCL only reduces among GPUs.
+    EXPECT_FALSE(cps[i].instance.impl_details.nccl);
   }
 }
 
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -53,13 +55,16 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/device_tracer.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -74,6 +79,16 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+auto* direct_session_run_latency = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/direct_session/run_latency_usecs",
+     "The latency of DirectSession::Run() calls, in microseconds."},
+    // 1us to ~18min.
+    monitoring::Buckets::Exponential(1, 2, 30));
+
+// The size of the blocks that step arenas bump-allocate from. Larger tensors
+// bypass the arena.
+const size_t kStepArenaBlockSize = 4 << 20;
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -248,7 +263,8 @@ DirectSession::DirectSession(const SessionOptions& options,
       device_mgr_(device_mgr),
       factory_(factory),
       cancellation_manager_(new CancellationManager()),
-      operation_timeout_in_ms_(options_.config.operation_timeout_in_ms()) {
+      operation_timeout_in_ms_(options_.config.operation_timeout_in_ms()),
+      step_arena_pool_(cpu_allocator(), kStepArenaBlockSize) {
   const int thread_pool_size =
       options_.config.session_inter_op_thread_pool_size();
   if (thread_pool_size > 0) {
@@ -273,6 +289,15 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  if (options_.config.experimental().max_concurrent_steps() > 0) {
+    step_admission_queue_.reset(new StepAdmissionQueue(
+        options_.config.experimental().max_concurrent_steps()));
+  }
+  const Status dump_status = ReadBoolFromEnvVar(
+      "TF_DUMP_SESSION_SETUP_STATS", false, &dump_setup_stats_);
+  if (!dump_status.ok()) {
+    LOG(ERROR) << dump_status.error_message();
+  }
   // NOTE(mrry): We do not need to use a unique string for the session
   // handle, because DirectSession owns its devices. This may change
   // in future versions.
@@ -341,6 +366,7 @@ Status DirectSession::MaybeInitializeExecutionState(
   GraphExecutionStateOptions options;
   options.device_set = &device_set_;
   options.session_options = &options_;
+  options.setup_stats = &graph_setup_stats_;
   // TODO(mrry,suharshs): We explicitly copy `graph` so that
   // `MakeForBaseGraph()` can take ownership of its
   // contents. Previously this happened implicitly in calls to the
@@ -434,6 +460,15 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
                                   CallFrameInterface* call_frame,
                                   ExecutorsAndKeys* executors_and_keys,
                                   RunMetadata* run_metadata) {
+  if (step_admission_queue_) {
+    step_admission_queue_->Admit(run_options.experimental().priority());
+  }
+  const int num_running_steps = num_running_steps_.fetch_add(1) + 1;
+  auto end_step = gtl::MakeCleanup([this] {
+    num_running_steps_.fetch_sub(1);
+    if (step_admission_queue_) step_admission_queue_->Release();
+  });
+
   const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
 
   std::unique_ptr<DebuggerStateInterface> debugger_state;
@@ -508,6 +543,8 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
+    args.collect_hardware_counters =
+        do_trace && run_options.experimental().collect_hardware_counters();
   }
 
   std::unique_ptr<DeviceTracer> tracer;
@@ -556,6 +593,21 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
                                            pool](Executor::Args::Closure c) {
     SchedClosure(pool, std::move(c));
   };
+  if (options_.config.experimental().partition_inter_op_thread_pool()) {
+    // Limit the step to its share of the pool among the running steps.
+    const int max_parallelism =
+        std::max(1, pool->NumThreads() / num_running_steps);
+    std::shared_ptr<BoundedStepRunner> step_runner =
+        std::make_shared<BoundedStepRunner>(default_runner, max_parallelism);
+    default_runner = [step_runner](Executor::Args::Closure c) {
+      step_runner->Run(std::move(c));
+    };
+  }
+  StepArenaAllocator* step_arena = nullptr;
+  if (run_options.experimental().use_step_arena_allocator()) {
+    step_arena = step_arena_pool_.Acquire();
+    args.step_allocator = step_arena;
+  }
   for (const auto& item : executors_and_keys->items) {
     // TODO(zhengxq): support partial run.
     // TODO(zhengxq): if the device picks its own threadpool, we need to assign
@@ -577,6 +629,12 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
                           ? run_options.timeout_in_ms()
                           : operation_timeout_in_ms_);
 
+  // All executors are done, so no more tensors will be allocated from the
+  // arena. Tensors that are still alive, e.g. fetches, keep it alive.
+  if (step_arena != nullptr) {
+    step_arena_pool_.Release(step_arena);
+  }
+
   if (!cancellation_manager_->DeregisterCallback(cancellation_token)) {
     // The step has been cancelled: make sure we don't attempt to receive the
     // outputs as this would make it block forever.
@@ -651,6 +709,11 @@ Status DirectSession::Run(const RunOptions& run_options,
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("Run()"));
   direct_session_runs->GetCell()->IncrementBy(1);
+  const uint64 start_time_usecs = Env::Default()->NowMicros();
+  auto record_latency = gtl::MakeCleanup([start_time_usecs] {
+    direct_session_run_latency->GetCell()->Add(Env::Default()->NowMicros() -
+                                               start_time_usecs);
+  });
 
   // Extract the inputs names for this run of the session.
   std::vector<string> input_tensor_names;
@@ -663,9 +726,24 @@ Status DirectSession::Run(const RunOptions& run_options,
   ExecutorsAndKeys* executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
 
-  TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
-                                          target_nodes, &executors_and_keys,
-                                          &run_state_args));
+  // Keeps the shape-specialized executors alive while they run, since they
+  // may be evicted meanwhile.
+  std::shared_ptr<ExecutorsAndKeys> shape_specialized_executors;
+  if (options_.config.experimental().max_shape_specialized_executors() > 0) {
+    TF_RETURN_IF_ERROR(GetShapeSpecializedExecutors(
+        inputs, output_names, target_nodes, &run_state_args,
+        &shape_specialized_executors));
+  }
+  if (shape_specialized_executors) {
+    executors_and_keys = shape_specialized_executors.get();
+  } else {
+    TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
+                                            target_nodes, &executors_and_keys,
+                                            &run_state_args));
+  }
+  if (run_state_args.setup_stats.phases_size() > 0) {
+    run_metadata->mutable_setup_stats()->Swap(&run_state_args.setup_stats);
+  }
 
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
@@ -1096,9 +1174,20 @@ Status DirectSession::CreateExecutors(
     std::unique_ptr<ExecutorsAndKeys>* out_executors_and_keys,
     std::unique_ptr<FunctionInfo>* out_func_info,
     RunStateArgs* run_state_args) {
+  // The setup of the graph by Create() and Extend() is reported with the
+  // first executors created after it.
+  SetupStatsCollector setup_stats;
+  {
+    SetupStats graph_setup_stats;
+    graph_setup_stats_.Swap(&graph_setup_stats);
+    setup_stats.Merge(graph_setup_stats);
+  }
+
   BuildGraphOptions options;
   options.callable_options = callable_options;
   options.use_function_convention = !run_state_args->is_partial_run;
+  options.setup_stats = &setup_stats;
+  options.feed_shapes = run_state_args->feed_shapes;
 
   std::unique_ptr<FunctionInfo> func_info(new FunctionInfo);
   std::unique_ptr<ExecutorsAndKeys> ek(new ExecutorsAndKeys);
@@ -1142,6 +1231,8 @@ Status DirectSession::CreateExecutors(
       func_info->flib_def.get(), optimizer_opts, thread_pools_[0].first));
 
   GraphOptimizer optimizer(optimizer_opts);
+  // The kernels are created by NewLocalExecutor().
+  auto kernel_micros = std::make_shared<std::atomic<int64>>(0);
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
     std::unique_ptr<Graph>& partition_graph = iter->second;
@@ -1161,8 +1252,12 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.function_library = lib;
     auto opseg = device->op_segment();
-    params.create_kernel = [this, lib, opseg](const NodeDef& ndef,
-                                              OpKernel** kernel) {
+    params.create_kernel = [this, lib, opseg, kernel_micros](
+                               const NodeDef& ndef, OpKernel** kernel) {
+      const uint64 start_us = Env::Default()->NowMicros();
+      auto record_time = gtl::MakeCleanup([kernel_micros, start_us] {
+        *kernel_micros += Env::Default()->NowMicros() - start_us;
+      });
       // We do not share the kernel via the OpSegment if the node is
       // stateless, or a function.
       // NOTE(mrry): We must not share function kernels (implemented
@@ -1190,8 +1285,11 @@ Status DirectSession::CreateExecutors(
     };
     params.node_outputs_cb = node_outputs_callback_;
 
-    optimizer.Optimize(lib, options_.env, device, &iter->second,
-                       /*shape_map=*/nullptr);
+    {
+      ScopedSetupTimer timer(&setup_stats, "graph_optimization");
+      optimizer.Optimize(lib, options_.env, device, &iter->second,
+                         /*shape_map=*/nullptr);
+    }
 
     // EXPERIMENTAL: tfdbg inserts debug nodes in the graph.
     const DebugOptions& debug_options =
@@ -1209,10 +1307,15 @@ Status DirectSession::CreateExecutors(
     item->executor = nullptr;
     item->device = device;
     Executor* executor;
-    TF_RETURN_IF_ERROR(
-        NewLocalExecutor(params, std::move(partition_graph), &executor));
+    {
+      ScopedSetupTimer timer(&setup_stats, "executor_creation");
+      TF_RETURN_IF_ERROR(
+          NewLocalExecutor(params, std::move(partition_graph), &executor));
+    }
     item->executor.reset(executor);
   }
+  setup_stats.Record("executor_creation/kernel_instantiation",
+                     kernel_micros->load());
 
   // Cache the mapping from input/output names to graph elements to
   // avoid recomputing it every time.
@@ -1247,11 +1350,109 @@ Status DirectSession::CreateExecutors(
     }
   }
 
+  if (dump_setup_stats_) {
+    LOG(INFO) << "Session setup for "
+              << str_util::Join(callable_options.fetch(), ",") << ":\n"
+              << setup_stats.ReportString();
+  }
+  setup_stats.Swap(&run_state_args->setup_stats);
+
   *out_executors_and_keys = std::move(ek);
   *out_func_info = std::move(func_info);
   return Status::OK();
 }
 
+namespace {
+
+// The number of runs of a signature with the same feed shapes after which
+// executors specialized to the shapes are created.
+constexpr int kRunsBeforeShapeSpecialization = 2;
+
+}  // namespace
+
+Status DirectSession::GetShapeSpecializedExecutors(
+    const NamedTensorList& inputs, gtl::ArraySlice<string> outputs,
+    gtl::ArraySlice<string> target_nodes, RunStateArgs* run_state_args,
+    std::shared_ptr<ExecutorsAndKeys>* executors_and_keys) {
+  executors_and_keys->reset();
+  if (inputs.empty() || LogMemory::IsEnabled() ||
+      !run_state_args->debug_options.debug_tensor_watch_opts().empty()) {
+    return Status::OK();
+  }
+  string key;
+  for (const auto& input : inputs) {
+    // Resources are fed through handles, whose shape says nothing about the
+    // resource.
+    if (input.second.dtype() == DT_RESOURCE) return Status::OK();
+    strings::StrAppend(&key, input.first, input.second.shape().DebugString(),
+                       ",");
+  }
+  strings::StrAppend(&key, "->", str_util::Join(outputs, ","), "/",
+                     str_util::Join(target_nodes, ","));
+
+  const int max_executors =
+      options_.config.experimental().max_shape_specialized_executors();
+  {
+    mutex_lock l(shape_specialized_lock_);
+    auto it = shape_specialized_index_.find(key);
+    if (it != shape_specialized_index_.end()) {
+      shape_specialized_executors_.splice(shape_specialized_executors_.begin(),
+                                          shape_specialized_executors_,
+                                          it->second);
+      const std::shared_ptr<Callable>& callable = it->second->second;
+      // Shares the ownership of the callable, which destroys the executors
+      // before the function library they use.
+      *executors_and_keys = std::shared_ptr<ExecutorsAndKeys>(
+          callable, callable->executors_and_keys.get());
+      return Status::OK();
+    }
+    // Shapes that vary from run to run are not worth specializing for.
+    if (unspecialized_shape_runs_.size() >= 16 * max_executors) {
+      unspecialized_shape_runs_.clear();
+    }
+    if (++unspecialized_shape_runs_[key] < kRunsBeforeShapeSpecialization) {
+      return Status::OK();
+    }
+    unspecialized_shape_runs_.erase(key);
+  }
+
+  // Create the executors with the lock released, as GetOrCreateExecutors()
+  // does.
+  CallableOptions callable_options;
+  for (const auto& input : inputs) {
+    callable_options.add_feed(input.first);
+    run_state_args->feed_shapes[input.first] = input.second.shape();
+  }
+  for (const string& output : outputs) {
+    callable_options.add_fetch(output);
+  }
+  for (const string& target : target_nodes) {
+    callable_options.add_target(target);
+  }
+  std::unique_ptr<ExecutorsAndKeys> ek;
+  std::unique_ptr<FunctionInfo> func_info;
+  TF_RETURN_IF_ERROR(
+      CreateExecutors(callable_options, &ek, &func_info, run_state_args));
+  std::shared_ptr<Callable> callable = std::make_shared<Callable>();
+  callable->executors_and_keys = std::move(ek);
+  callable->function_info = std::move(func_info);
+  *executors_and_keys = std::shared_ptr<ExecutorsAndKeys>(
+      callable, callable->executors_and_keys.get());
+
+  mutex_lock l(shape_specialized_lock_);
+  if (shape_specialized_index_.count(key) == 0) {
+    shape_specialized_executors_.emplace_front(key, std::move(callable));
+    shape_specialized_index_[key] = shape_specialized_executors_.begin();
+    while (shape_specialized_executors_.size() > max_executors) {
+      VLOG(1) << "Evicting executors specialized for "
+              << shape_specialized_executors_.back().first;
+      shape_specialized_index_.erase(shape_specialized_executors_.back().first);
+      shape_specialized_executors_.pop_back();
+    }
+  }
+  return Status::OK();
+}
+
 Status DirectSession::GetOrCreateExecutors(
     gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
     gtl::ArraySlice<string> target_nodes, ExecutorsAndKeys** executors_and_keys,
@@ -1378,6 +1579,7 @@ Status DirectSession::CreateGraphs(
     prune_options.device_set = &device_set_;
     prune_options.session_options = &options_;
     prune_options.stateful_placements = stateful_placements_;
+    prune_options.setup_stats = subgraph_options.setup_stats;
     TF_RETURN_IF_ERROR(GraphExecutionState::MakeForPrunedGraph(
         execution_state_->original_graph_def().library(), prune_options,
         execution_state_->original_graph_def(), subgraph_options,
@@ -1449,7 +1651,10 @@ Status DirectSession::CreateGraphs(
   popts.control_flow_added = false;
 
   std::unordered_map<string, GraphDef> partitions;
-  TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
+  {
+    ScopedSetupTimer timer(subgraph_options.setup_stats, "partitioning");
+    TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
+  }
 
   std::vector<string> device_names;
   for (auto device : devices_) {
@@ -1471,26 +1676,33 @@ Status DirectSession::CreateGraphs(
     }
   }
 
-  for (const auto& partition : partitions) {
-    std::unique_ptr<Graph> device_graph(
-        new Graph(client_graph->flib_def.get()));
-    GraphConstructorOptions device_opts;
-    // There are internal operations (e.g., send/recv) that we now allow.
-    device_opts.allow_internal_ops = true;
-    device_opts.expect_device_spec = true;
-    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(device_opts, partition.second,
-                                              device_graph.get()));
-    outputs->emplace(partition.first, std::move(device_graph));
+  {
+    ScopedSetupTimer timer(subgraph_options.setup_stats,
+                           "partition_graph_conversion");
+    for (const auto& partition : partitions) {
+      std::unique_ptr<Graph> device_graph(
+          new Graph(client_graph->flib_def.get()));
+      GraphConstructorOptions device_opts;
+      // There are internal operations (e.g., send/recv) that we now allow.
+      device_opts.allow_internal_ops = true;
+      device_opts.expect_device_spec = true;
+      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(device_opts, partition.second,
+                                                device_graph.get()));
+      outputs->emplace(partition.first, std::move(device_graph));
+    }
   }
 
   GraphOptimizationPassOptions optimization_options;
   optimization_options.session_options = &options_;
   optimization_options.flib_def = client_graph->flib_def.get();
   optimization_options.partition_graphs = outputs;
+  optimization_options.setup_stats = subgraph_options.setup_stats;
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
 
   Status s;
+  ScopedSetupTimer rewrite_timer(subgraph_options.setup_stats,
+                                 "device_graph_rewrite");
   for (auto& partition : *outputs) {
     const string& partition_name = partition.first;
     std::unique_ptr<Graph>* graph = &partition.second;
@@ -1634,6 +1846,23 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
         "Debug options are not currently supported via the C++ MakeCallable "
         "interface.");
   }
+  const std::unordered_set<string> feeds(callable_options.feed().begin(),
+                                         callable_options.feed().end());
+  for (const auto& feed_device : callable_options.feed_devices()) {
+    if (feeds.count(feed_device.first) == 0) {
+      return errors::InvalidArgument("Device requested for ",
+                                     feed_device.first, " which is not fed");
+    }
+  }
+  const std::unordered_set<string> fetches(callable_options.fetch().begin(),
+                                           callable_options.fetch().end());
+  for (const auto& fetch_device : callable_options.fetch_devices()) {
+    if (fetches.count(fetch_device.first) == 0) {
+      return errors::InvalidArgument("Device requested for ",
+                                     fetch_device.first,
+                                     " which is not fetched");
+    }
+  }
 
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
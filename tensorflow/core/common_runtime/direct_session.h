@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -32,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/setup_stats_collector.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+#include "tensorflow/core/common_runtime/step_scheduler.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -203,6 +207,11 @@ class DirectSession : public Session {
     string handle;
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
+    // The wall time of each phase of creating the executors, if this call
+    // created them.
+    SetupStats setup_stats;
+    // If not empty, the executors are specialized to these feed shapes.
+    std::unordered_map<string, TensorShape> feed_shapes;
   };
 
   // Initializes the base execution state given the 'graph',
@@ -218,6 +227,14 @@ class DirectSession : public Session {
       gtl::ArraySlice<string> target_nodes,
       ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args);
 
+  // Returns in '*executors_and_keys' the executors specialized to the shapes
+  // of 'inputs', creating them if this signature ran with these shapes
+  // before. Leaves it null if the generic executors should be used.
+  ::tensorflow::Status GetShapeSpecializedExecutors(
+      const NamedTensorList& inputs, gtl::ArraySlice<string> outputs,
+      gtl::ArraySlice<string> target_nodes, RunStateArgs* run_state_args,
+      std::shared_ptr<ExecutorsAndKeys>* executors_and_keys);
+
   // Creates a set of executors to run the subgraph defined by
   // `callable_options`.
   ::tensorflow::Status CreateExecutors(
@@ -320,6 +337,11 @@ class DirectSession : public Session {
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
+  // If true, logs the wall time of each phase of creating new executors.
+  bool dump_setup_stats_ = false;
+  // The setup phases of Create() and Extend() not yet reported by a call that
+  // created executors.
+  SetupStatsCollector graph_setup_stats_;
   // Schedules 'c' for execution on pool.
   void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
 
@@ -345,6 +367,19 @@ class DirectSession : public Session {
   int64 next_callable_handle_ GUARDED_BY(callables_lock_) = 0;
   std::unordered_map<int64, Callable> callables_ GUARDED_BY(callables_lock_);
 
+  // The executors specialized to feed shapes, keyed by signature and shapes,
+  // in least recently used order, and the number of runs of the keys that
+  // were not specialized yet.
+  typedef std::list<std::pair<string, std::shared_ptr<Callable>>>
+      ShapeSpecializedExecutors;
+  mutex shape_specialized_lock_;
+  ShapeSpecializedExecutors shape_specialized_executors_
+      GUARDED_BY(shape_specialized_lock_);
+  std::unordered_map<string, ShapeSpecializedExecutors::iterator>
+      shape_specialized_index_ GUARDED_BY(shape_specialized_lock_);
+  std::unordered_map<string, int> unspecialized_shape_runs_
+      GUARDED_BY(shape_specialized_lock_);
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       GUARDED_BY(executor_lock_);
@@ -389,6 +424,19 @@ class DirectSession : public Session {
   // Manages all the cost models for the graphs executed in this session.
   CostModelManager cost_model_manager_;
 
+  // Arenas for the steps that set
+  // RunOptions.experimental.use_step_arena_allocator.
+  StepArenaPool step_arena_pool_;
+
+  // Bounds the steps running at a time, if
+  // ConfigProto.Experimental.max_concurrent_steps is set.
+  std::unique_ptr<StepAdmissionQueue> step_admission_queue_;
+
+  // The steps running in RunInternal(), used to partition the inter-op
+  // thread pools among them if
+  // ConfigProto.Experimental.partition_inter_op_thread_pool is set.
+  std::atomic<int> num_running_steps_{0};
+
   Executor::Args::NodeOutputsCallback node_outputs_callback_ = nullptr;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DirectSession);
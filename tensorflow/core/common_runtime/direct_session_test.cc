@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -334,6 +335,55 @@ TEST_F(DirectSessionMinusAXTest, TestTensorConnection) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, TestFeedAndFetchDevices) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  const string cpu1 = "/job:localhost/replica:0/task:0/device:CPU:1";
+
+  {
+    // Feed a and fetch y on the second CPU device.
+    CallableOptions callable_options =
+        MakeCallableOptions({a_ + ":0"}, {y_ + ":0"}, {});
+    (*callable_options.mutable_feed_devices())[a_ + ":0"] = cpu1;
+    (*callable_options.mutable_fetch_devices())[y_ + ":0"] = cpu1;
+
+    Session::CallableHandle handle;
+    TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+    Tensor a(DT_FLOAT, TensorShape({2, 2}));
+    test::FillValues<float>(&a, {1, 0, 0, 1});
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {a}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    // y = a * x, with the identity matrix for a.
+    auto mat = outputs[0].matrix<float>();
+    EXPECT_FLOAT_EQ(1.0, mat(0, 0));
+    EXPECT_FLOAT_EQ(1.0, mat(1, 0));
+    TF_ASSERT_OK(session->ReleaseCallable(handle));
+  }
+
+  {
+    CallableOptions callable_options = MakeCallableOptions({}, {y_ + ":0"}, {});
+    (*callable_options.mutable_fetch_devices())[y_ + ":0"] =
+        "/job:localhost/replica:0/task:0/device:CPU:7";
+    Session::CallableHandle handle;
+    Status s = session->MakeCallable(callable_options, &handle);
+    EXPECT_TRUE(errors::IsInvalidArgument(s));
+    EXPECT_TRUE(str_util::StrContains(s.error_message(), "unknown device"));
+  }
+
+  {
+    CallableOptions callable_options = MakeCallableOptions({}, {y_ + ":0"}, {});
+    (*callable_options.mutable_feed_devices())[a_ + ":0"] = cpu1;
+    Session::CallableHandle handle;
+    Status s = session->MakeCallable(callable_options, &handle);
+    EXPECT_TRUE(errors::IsInvalidArgument(s));
+    EXPECT_TRUE(str_util::StrContains(s.error_message(), "which is not fed"));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, TestFeed) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -363,6 +413,39 @@ TEST_F(DirectSessionMinusAXTest, TestFeed) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, TestFeedShapeSpecializedExecutors) {
+  Initialize({1, 2, 3, 4});
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  options.config.mutable_experimental()->set_max_shape_specialized_executors(
+      1);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<string> output_names = {y_ + ":0"};
+  // The executors are specialized from the second run with the same shapes
+  // on, and evicted when runs with other shapes are specialized.
+  for (int columns : {1, 1, 1, 2, 2, 1}) {
+    Tensor t(DT_FLOAT, TensorShape({2, columns}));
+    for (int j = 0; j < columns; ++j) {
+      t.matrix<float>()(0, j) = 5 + j;
+      t.matrix<float>()(1, j) = 6 + j;
+    }
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({{x_, t}}, output_names, {}, &outputs));
+
+    ASSERT_EQ(1, outputs.size());
+    ASSERT_EQ(TensorShape({2, columns}), outputs[0].shape());
+    auto mat = outputs[0].matrix<float>();
+    for (int j = 0; j < columns; ++j) {
+      // 1*x0 + 2*x1, 3*x0 + 4*x1
+      EXPECT_FLOAT_EQ(17.0 + 3 * j, mat(0, j));
+      EXPECT_FLOAT_EQ(39.0 + 7 * j, mat(1, j));
+    }
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, TestFeed_Callable) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -498,6 +581,46 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestAdmissionAndPoolPartitioning) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  options.config.set_use_per_session_threads(true);
+  options.config.set_inter_op_parallelism_threads(4);
+  options.config.mutable_experimental()->set_max_concurrent_steps(2);
+  options.config.mutable_experimental()->set_partition_inter_op_thread_pool(
+      true);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+
+  // Run the graph 1000 times in 4 threads with different priorities, of
+  // which at most 2 run steps at a time.
+  std::vector<string> output_names = {y_ + ":0"};
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule([&session, output_names, i]() {
+      RunOptions run_options;
+      run_options.mutable_experimental()->set_priority(i);
+      for (int j = 0; j < 1000; ++j) {
+        std::vector<Tensor> outputs;
+        RunMetadata run_metadata;
+        TF_ASSERT_OK(session->Run(run_options, {}, output_names, {}, &outputs,
+                                  &run_metadata));
+        ASSERT_EQ(1, outputs.size());
+        auto mat = outputs[0].matrix<float>();
+        EXPECT_FLOAT_EQ(3.0, mat(0, 0));
+      }
+    });
+  }
+
+  // Wait for the functions to finish.
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -586,6 +709,59 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkSetupStats) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<Tensor> outputs;
+
+  // The first run reports the setup of the graph and of its executors.
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(RunOptions(), inputs, output_names, {}, &outputs,
+                            &run_metadata));
+  std::set<string> phases;
+  for (const SetupStats::Phase& phase : run_metadata.setup_stats().phases()) {
+    EXPECT_GE(phase.wall_time_micros(), 0);
+    phases.insert(phase.name());
+  }
+  EXPECT_EQ(1, phases.count("placement"));
+  EXPECT_EQ(1, phases.count("partitioning"));
+  EXPECT_EQ(1, phases.count("executor_creation"));
+  EXPECT_EQ(1, phases.count("executor_creation/kernel_instantiation"));
+
+  // The executors are cached, so the next run has no setup.
+  RunMetadata second_run_metadata;
+  TF_ASSERT_OK(session->Run(RunOptions(), inputs, output_names, {}, &outputs,
+                            &second_run_metadata));
+  EXPECT_EQ(0, second_run_metadata.setup_stats().phases_size());
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithStepArena) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_use_step_arena_allocator(true);
+
+  // Fetches of earlier steps stay valid while later steps reuse the arena.
+  std::vector<std::vector<Tensor>> all_outputs(10);
+  for (std::vector<Tensor>& outputs : all_outputs) {
+    TF_ASSERT_OK(session->Run(run_options, inputs, {y_ + ":0", z_ + ":0"},
+                              {}, &outputs, nullptr));
+  }
+  for (const std::vector<Tensor>& outputs : all_outputs) {
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
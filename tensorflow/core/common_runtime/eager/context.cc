@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -63,6 +64,15 @@ EagerContext::EagerContext(
 }
 
 void EagerContext::InitDeviceMapAndAsync() {
+  bool per_device_queues = false;
+  Status s = ReadBoolFromEnvVar("TF_EAGER_ASYNC_PER_DEVICE_QUEUES", false,
+                                &per_device_queues);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+  if (per_device_queues) {
+    executor_.EnablePerDeviceQueues();
+  }
   if (async_default_) {
     executor_.EnableAsync();
   }
@@ -104,6 +114,21 @@ Status EagerContext::SetAsyncForThread(bool async) {
   return Status::OK();
 }
 
+Status EagerContext::AsyncWait() {
+  Status status = executor_.WaitForAllPendingNodes();
+  std::vector<eager::RemoteOpBatcher*> batchers;
+  {
+    mutex_lock l(remote_op_batchers_mu_);
+    for (const auto& client_and_batcher : remote_op_batchers_) {
+      batchers.push_back(client_and_batcher.second.get());
+    }
+  }
+  for (eager::RemoteOpBatcher* batcher : batchers) {
+    status.Update(batcher->WaitForAllPendingItems());
+  }
+  return status;
+}
+
 void EagerContext::ClearCaches() {
   mutex_lock ml(cache_mu_);
   gtl::STLDeleteValues(&kernel_cache_);
@@ -132,6 +157,13 @@ EagerContext::~EagerContext() {
     server_.release();
   }
 
+  // Let the remote contexts run the ops streamed to them before closing them.
+  AsyncWait().IgnoreError();
+  {
+    mutex_lock l(remote_op_batchers_mu_);
+    remote_op_batchers_.clear();
+  }
+
   // Close all remote contexts.
   std::vector<eager::CloseContextRequest> requests(remote_contexts_.size());
   std::vector<eager::CloseContextResponse> responses(remote_contexts_.size());
@@ -164,6 +196,34 @@ EagerContext::~EagerContext() {
   rendezvous_->Unref();
 }
 
+Status EagerContext::StartTrace(OpTrace* trace) {
+  mutex_lock l(trace_map_mu_);
+  if (!thread_local_traces_.emplace(std::this_thread::get_id(), trace)
+           .second) {
+    return errors::FailedPrecondition(
+        "A trace is already being recorded on this thread");
+  }
+  num_traces_.fetch_add(1);
+  return Status::OK();
+}
+
+OpTrace* EagerContext::EndTrace() {
+  mutex_lock l(trace_map_mu_);
+  auto it = thread_local_traces_.find(std::this_thread::get_id());
+  if (it == thread_local_traces_.end()) return nullptr;
+  OpTrace* trace = it->second;
+  thread_local_traces_.erase(it);
+  num_traces_.fetch_sub(1);
+  return trace;
+}
+
+OpTrace* EagerContext::ActiveTrace() {
+  if (num_traces_.load(std::memory_order_relaxed) == 0) return nullptr;
+  mutex_lock l(trace_map_mu_);
+  return gtl::FindWithDefault(thread_local_traces_,
+                              std::this_thread::get_id(), nullptr);
+}
+
 bool EagerContext::FindFunctionByName(const string& name) {
   mutex_lock l(functions_mu_);
   return func_lib_def_.Find(name) != nullptr;
@@ -254,4 +314,19 @@ Status EagerContext::GetClientAndContextID(Device* device,
   return Status::OK();
 }
 
+Status EagerContext::GetRemoteOpBatcher(Device* device,
+                                        eager::RemoteOpBatcher** batcher) {
+  eager::EagerClient* client;
+  uint64 context_id;
+  TF_RETURN_IF_ERROR(GetClientAndContextID(device, &client, &context_id));
+  mutex_lock l(remote_op_batchers_mu_);
+  std::unique_ptr<eager::RemoteOpBatcher>& remote_op_batcher =
+      remote_op_batchers_[client];
+  if (remote_op_batcher == nullptr) {
+    remote_op_batcher.reset(new eager::RemoteOpBatcher(client, context_id));
+  }
+  *batcher = remote_op_batcher.get();
+  return Status::OK();
+}
+
 }  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_op_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -46,6 +47,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class OpTrace;
+
 // Note: there's a copy enum in eager/c_api.h. It should be kept in sync.
 enum ContextDevicePlacementPolicy {
   // Running operations with input tensors on the wrong device will fail.
@@ -122,7 +125,9 @@ class EagerContext {
   // Returns the device placement policy for the current thread.
   ContextDevicePlacementPolicy GetDevicePlacementPolicy();
 
-  Status AsyncWait() { return executor_.WaitForAllPendingNodes(); }
+  // Waits for the pending nodes, and for the remote contexts to run the ops
+  // streamed to them.
+  Status AsyncWait();
 
   Status GetStatus() { return executor_.status(); }
 
@@ -143,8 +148,26 @@ class EagerContext {
 
   void ExecutorAdd(EagerNode* node) { executor_.Add(node); }
 
+  // Adds `node`, which runs on `device`, to the executor. The nodes of
+  // different devices may run concurrently if
+  // TF_EAGER_ASYNC_PER_DEVICE_QUEUES is set.
+  void ExecutorAdd(EagerNode* node, Device* device) {
+    executor_.Add(node, device);
+  }
+
   Status AddFunctionDef(const FunctionDef& fdef);
 
+  // Makes the ops executed on the calling thread be recorded into `trace`,
+  // which is not owned, until EndTrace is called.
+  Status StartTrace(OpTrace* trace);
+
+  // Stops recording the ops of the calling thread, and returns the trace they
+  // were recorded into, or null if there was none.
+  OpTrace* EndTrace();
+
+  // Returns the trace recording the ops of the calling thread, or null.
+  OpTrace* ActiveTrace();
+
   KernelAndDevice* GetCachedKernel(Fprint128 cache_key);
 
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
@@ -177,6 +200,10 @@ class EagerContext {
   Status GetClientAndContextID(Device* device, eager::EagerClient** client,
                                uint64* context_id);
 
+  // Returns in '*batcher' the stream of ops to the remote context of
+  // 'device', which is owned by this context.
+  Status GetRemoteOpBatcher(Device* device, eager::RemoteOpBatcher** batcher);
+
  private:
   void InitDeviceMapAndAsync();
 
@@ -228,6 +255,12 @@ class EagerContext {
   std::unordered_map<std::thread::id, bool> thread_local_async_
       GUARDED_BY(async_map_mu_);
 
+  // The number of threads being traced, to skip the lookup when none is.
+  std::atomic<int> num_traces_{0};
+  mutex trace_map_mu_;
+  std::unordered_map<std::thread::id, OpTrace*> thread_local_traces_
+      GUARDED_BY(trace_map_mu_);
+
   // The server_ is not const since we release it when the context is destroyed.
   // Therefore the server_ object is not marked as const (even though it should
   // be).
@@ -238,6 +271,12 @@ class EagerContext {
   const gtl::FlatMap<string, uint64> remote_contexts_;
   gtl::FlatMap<Device*, std::pair<eager::EagerClient*, uint64>>
       device_to_client_cache_;
+
+  mutex remote_op_batchers_mu_;
+  // One per remote context, keyed by the client of its task.
+  std::unordered_map<eager::EagerClient*,
+                     std::unique_ptr<eager::RemoteOpBatcher>>
+      remote_op_batchers_ GUARDED_BY(remote_op_batchers_mu_);
 };
 
 }  // namespace tensorflow
@@ -19,10 +19,14 @@ namespace tensorflow {
 
 EagerNode::EagerNode(tensorflow::uint64 id) : id(id) {}
 
+constexpr int EagerExecutor::kMaxBatchSize;
+
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   thread_done_ = true;
-  nodes_pending_.notify_all();
+  for (auto& queue : queues_) {
+    queue.second->nodes_pending.notify_all();
+  }
 }
 
 tensorflow::uint64 EagerExecutor::NextId() {
@@ -32,33 +36,46 @@ tensorflow::uint64 EagerExecutor::NextId() {
 
 void EagerExecutor::EnableAsync() {
   tensorflow::mutex_lock l(node_queue_mutex_);
-  if (thread_ == nullptr) {
-    thread_.reset(tensorflow::Env::Default()->StartThread(
+  GetQueueLocked(nullptr);
+}
+
+void EagerExecutor::EnablePerDeviceQueues() {
+  tensorflow::mutex_lock l(node_queue_mutex_);
+  per_device_queues_ = true;
+}
+
+EagerExecutor::NodeQueue* EagerExecutor::GetQueueLocked(Device* device) {
+  std::unique_ptr<NodeQueue>& queue = queues_[device];
+  if (queue == nullptr) {
+    queue.reset(new NodeQueue);
+    queue->thread.reset(tensorflow::Env::Default()->StartThread(
         tensorflow::ThreadOptions(), "eager_async_executor",
-        std::bind(&EagerExecutor::Run, this)));
+        std::bind(&EagerExecutor::Run, this, queue.get())));
   }
+  return queue.get();
 }
 
-void EagerExecutor::Add(EagerNode* node) {
+void EagerExecutor::Add(EagerNode* node, Device* device) {
   tensorflow::mutex_lock l(node_queue_mutex_);
-  DCHECK(thread_) << "EnableAsync should have been called before Add";
+  DCHECK(queues_.count(nullptr) > 0)
+      << "EnableAsync should have been called before Add";
   if (!status_.ok()) {
     delete node;
     return;
   }
-  int64 qlen = node_queue_.size();
-  if (qlen > 0) {
-    if (node_queue_.back()->id >= node->id) {
+  NodeQueue* queue = GetQueueLocked(per_device_queues_ ? device : nullptr);
+  if (!queue->nodes.empty()) {
+    if (queue->nodes.back()->id >= node->id) {
       status_ = tensorflow::errors::InvalidArgument(
           "Inserting EagerNode with non-increasing ids:",
-          node_queue_.back()->id, " vs ", node->id);
+          queue->nodes.back()->id, " vs ", node->id);
       delete node;
       return;
     }
-    node_queue_.push(node);
+    queue->nodes.push_back(node);
   } else {
-    node_queue_.push(node);
-    nodes_pending_.notify_all();
+    queue->nodes.push_back(node);
+    queue->nodes_pending.notify_all();
   }
 }
 
@@ -70,22 +87,56 @@ tensorflow::Status EagerExecutor::WaitForAllPendingNodes() {
   return WaitImpl(true, 0);
 }
 
+bool EagerExecutor::IsPendingLocked(tensorflow::uint64 node_id) {
+  for (const auto& queue : queues_) {
+    const std::deque<EagerNode*>& nodes = queue.second->nodes;
+    // Note that we are relying on the nodes being dispatched sequentially from
+    // each queue.
+    if (nodes.empty() || node_id < nodes.front()->id ||
+        node_id > nodes.back()->id) {
+      continue;
+    }
+    auto it = std::lower_bound(
+        nodes.begin(), nodes.end(), node_id,
+        [](const EagerNode* node, tensorflow::uint64 id) {
+          return node->id < id;
+        });
+    if (it != nodes.end() && (*it)->id == node_id) return true;
+  }
+  return false;
+}
+
 tensorflow::Status EagerExecutor::WaitImpl(bool wait_all,
                                            tensorflow::uint64 node_id) {
-  tensorflow::condition_variable cond;
   tensorflow::mutex_lock l(node_queue_mutex_);
-  // Don't wait if an error is already set.
-  if (!status_.ok()) return status_;
-  if (node_queue_.empty()) return tensorflow::Status::OK();
-  if (wait_all) {
-    node_id = node_queue_.back()->id;
-  } else if (node_id < node_queue_.front()->id) {
-    // Note that we are relying on the ops being dispatched sequentially from
-    // the queue.
-    return tensorflow::Status::OK();
+  ++num_waiters_;
+  while (status_.ok()) {
+    if (wait_all) {
+      // Waits for the nodes pending when this was called, i.e. the nodes with
+      // ids up to the largest id queued then.
+      if (node_id == 0) {
+        for (const auto& queue : queues_) {
+          if (!queue.second->nodes.empty()) {
+            node_id = std::max(node_id, queue.second->nodes.back()->id);
+          }
+        }
+        if (node_id == 0) break;
+      }
+      bool pending = false;
+      for (const auto& queue : queues_) {
+        const std::deque<EagerNode*>& nodes = queue.second->nodes;
+        if (!nodes.empty() && nodes.front()->id <= node_id) {
+          pending = true;
+          break;
+        }
+      }
+      if (!pending) break;
+    } else if (!IsPendingLocked(node_id)) {
+      break;
+    }
+    nodes_done_.wait(l);
   }
-  node_done_notifications_.insert(std::make_pair(node_id, &cond));
-  cond.wait(l);
+  --num_waiters_;
   // Note that we could be woken up if an error occurs, even though the node has
   // not actually executed.
   return status_;
@@ -94,12 +145,18 @@ tensorflow::Status EagerExecutor::WaitImpl(bool wait_all,
 void EagerExecutor::ClearError() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   if (status_.ok()) return;
-  // If an error was set, node_done_notifications_ and node_queue_ should have
-  // been cleared, and no new entries should have been added since.
-  DCHECK(node_done_notifications_.empty());
-  DCHECK(node_queue_.empty());
+  // If an error was set, the queues should have been cleared, except for the
+  // nodes still being executed, and no new entries should have been added
+  // since.
+  for (const auto& queue : queues_) {
+    DCHECK_LE(static_cast<int>(queue.second->nodes.size()),
+              queue.second->num_running);
+  }
   status_ = tensorflow::Status::OK();
-  nodes_pending_.notify_all();
+  has_error_ = false;
+  for (auto& queue : queues_) {
+    queue.second->nodes_pending.notify_all();
+  }
 }
 
 tensorflow::Status EagerExecutor::status() {
@@ -107,44 +164,63 @@ tensorflow::Status EagerExecutor::status() {
   return status_;
 }
 
-void EagerExecutor::Run() {
+void EagerExecutor::Run(NodeQueue* queue) {
+  std::vector<EagerNode*> batch;
+  batch.reserve(kMaxBatchSize);
   while (true) {
-    std::unique_ptr<EagerNode> curr_node;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
-      while (node_queue_.empty() || !status_.ok()) {
+      while (queue->nodes.empty() || !status_.ok()) {
         if (thread_done_) return;
-        nodes_pending_.wait(l);
+        queue->nodes_pending.wait(l);
       }
-      curr_node.reset(node_queue_.front());
+      // The nodes stay in the queue while they execute, so that WaitFor knows
+      // they are pending.
+      queue->num_running = std::min<int>(queue->nodes.size(), kMaxBatchSize);
+      batch.assign(queue->nodes.begin(),
+                   queue->nodes.begin() + queue->num_running);
     }
-    tensorflow::Status status = curr_node->Run();
-    const bool ok = status.ok();
-    tensorflow::mutex_lock l(node_queue_mutex_);
-    node_queue_.pop();
-    if (!ok) {
-      status_ = status;
-      // TODO(agarwal): mark all affected handles as corrupted before clearing
-      // this queue.
-      // We remove any pending ops so that we don't try to execute them if
-      // ClearError is called.
-      for (int i = 0; i < node_queue_.size(); ++i) {
-        delete node_queue_.front();
-        node_queue_.pop();
-      }
+    tensorflow::Status status;
+    int num_done = 0;
+    for (EagerNode* node : batch) {
+      status = node->Run();
+      ++num_done;
+      // Stop the batch early on errors, or if some thread waits, so that it
+      // does not wait for the rest of the batch.
+      if (!status.ok() || has_error_ || num_waiters_ > 0) break;
     }
-    if (!node_done_notifications_.empty()) {
-      tensorflow::uint64 node_id = curr_node->id;
+    std::vector<EagerNode*> nodes_to_delete(batch.begin(),
+                                            batch.begin() + num_done);
+    {
+      tensorflow::mutex_lock l(node_queue_mutex_);
+      queue->nodes.erase(queue->nodes.begin(),
+                         queue->nodes.begin() + num_done);
+      queue->num_running = 0;
+      if (!status.ok()) {
+        status_ = status;
+        has_error_ = true;
+      }
+      if (!status_.ok()) {
+        // TODO(agarwal): mark all affected handles as corrupted before clearing
+        // the queues.
+        // We remove any pending ops so that we don't try to execute them if
+        // ClearError is called. The nodes being executed by other threads are
+        // removed by those threads.
+        for (auto& other : queues_) {
+          std::deque<EagerNode*>* nodes = &other.second->nodes;
+          auto first_pending = nodes->begin() + other.second->num_running;
+          nodes_to_delete.insert(nodes_to_delete.end(), first_pending,
+                                 nodes->end());
+          nodes->erase(first_pending, nodes->end());
+        }
+      }
       // Note that we notify all waiting threads in case an error has occurred.
       // These calling threads are responsible for checking status_ before
       // proceeding.
-      const auto range = ok ? node_done_notifications_.equal_range(node_id)
-                            : make_pair(node_done_notifications_.begin(),
-                                        node_done_notifications_.end());
-      for (auto it = range.first; it != range.second; ++it) {
-        it->second->notify_all();
-      }
-      node_done_notifications_.erase(range.first, range.second);
+      if (num_waiters_ > 0) nodes_done_.notify_all();
+    }
+    for (EagerNode* node : nodes_to_delete) {
+      delete node;
     }
   }
 }
@@ -16,7 +16,9 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_EXECUTOR_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
 #include <queue>
@@ -57,12 +59,18 @@ class EagerNode {
 
 // A class for handling async execution (see TFE_ContextSetAsync).
 // Note that this class is thread-safe.
+//
+// EagerNodes are executed in the order they were added. If per-device queues
+// are enabled, the nodes added for each device are instead executed in order
+// by a thread of that device, so that e.g. CPU ops progress while a GPU op
+// waits. Nodes on different devices only synchronize through their inputs:
+// reading an input handle that is not ready yet waits for the node computing
+// it (see TensorHandle::WaitReady), whose id is always smaller.
+//
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
 // device of the input handle. Fix that.
 // TODO(agarwal): On error, mark all affected handles as corrupted.
 // TODO(agarwal): Implement support for control dependencies.
-// TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
@@ -73,13 +81,21 @@ class EagerExecutor {
   // independently.
   void EnableAsync();
 
+  // Makes Add(node, device) execute the nodes of each device on a thread of
+  // that device. Must be called before any node is added.
+  void EnablePerDeviceQueues();
+
   // Helper function to create monotonically increasing ids unique to this
   // object.
   uint64 NextId();
 
   // Schedules `node` for execution.
   // Note that Add must be called in monotonically increasing order of node->id.
-  void Add(EagerNode* node);
+  void Add(EagerNode* node) { Add(node, nullptr); }
+
+  // Schedules `node` for execution on the queue of `device`, if per-device
+  // queues are enabled.
+  void Add(EagerNode* node, Device* device);
 
   // Causes the caller to block till node with id `node_id` has finished
   // execution.
@@ -95,40 +111,65 @@ class EagerExecutor {
   Status status();
 
  private:
-  // Starts execution of pending EagerNodes. This function loops till
-  // thread_done_ is set to true. If any errors are encontered, these are set
-  // inside `status_`. The loop blocks anytime there are no pending nodes, or if
-  // `status_` is not ok.
-  void Run();
+  // The pending EagerNodes of a device, in increasing order of ids, and the
+  // thread executing them. A node stays in `nodes` until it is done.
+  struct NodeQueue {
+    std::deque<EagerNode*> nodes;
+    // The number of nodes at the front of `nodes` being executed.
+    int num_running = 0;
+    // Used to signal that some EagerNodes are pending execution.
+    condition_variable nodes_pending;
+    // Declared last, so that the thread is joined before the rest of the
+    // queue is destroyed.
+    std::unique_ptr<Thread> thread;
+  };
+
+  // The number of consecutive nodes a thread executes before removing them
+  // from its queue, unless some thread waits for a node. This amortizes the
+  // locking over bursts of small nodes.
+  static constexpr int kMaxBatchSize = 16;
+
+  // Starts execution of the pending EagerNodes of `queue`. This function loops
+  // till thread_done_ is set to true. If any errors are encontered, these are
+  // set inside `status_`. The loop blocks anytime there are no pending nodes,
+  // or if `status_` is not ok.
+  void Run(NodeQueue* queue);
+
+  // Returns the queue of `device`, starting its thread if needed.
+  NodeQueue* GetQueueLocked(Device* device)
+      EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
+  // Returns true if the node with id `node_id` is in some queue.
+  bool IsPendingLocked(uint64 node_id)
+      EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
 
   Status WaitImpl(bool wait_all, uint64 node_id);
 
   mutex node_queue_mutex_;
 
-  // Used to signal that some EagerNodes are pending execution.
-  condition_variable nodes_pending_ GUARDED_BY(node_queue_mutex_);
-
-  // Queue of pending EagerNodes.
-  std::queue<EagerNode*> node_queue_ GUARDED_BY(node_queue_mutex_);
-
   // `status_` is set based on any errors raised during execution of a
   // EagerNode.  It remains set until ClearError is called.
   Status status_ GUARDED_BY(node_queue_mutex_);
+  // Whether `status_` is not ok, readable without the lock.
+  std::atomic<bool> has_error_{false};
 
-  // Map from id of a EagerNode to condition_variables (not owned by the map).
-  // These condition_variables are notified and removed when that EagerNode is
-  // done executing, or if an error is found in execution of any EagerNode.
-  std::multimap<uint64, condition_variable*> node_done_notifications_
-      GUARDED_BY(node_queue_mutex_);
+  // Notified when EagerNodes are done executing, or when an error is found in
+  // execution of any EagerNode, if `num_waiters_` is positive.
+  condition_variable nodes_done_;
+  // The number of threads blocked in WaitImpl.
+  std::atomic<int> num_waiters_{0};
 
-  // Thread object that calls the `Run` method. Currently we use only one thread
-  // for executing the EagerNodes one-by-one.
-  std::unique_ptr<Thread> thread_ GUARDED_BY(node_queue_mutex_);
-
-  // Indicates that `thread_` should stop as soon as it is done executing the
-  // current EagerNode.
+  // Indicates that the threads should stop as soon as they are done executing
+  // their current EagerNodes.
   bool thread_done_ GUARDED_BY(node_queue_mutex_) = false;
 
+  bool per_device_queues_ GUARDED_BY(node_queue_mutex_) = false;
+
+  // The queue of each device. All nodes are added to the queue of nullptr,
+  // unless per-device queues are enabled.
+  std::map<Device*, std::unique_ptr<NodeQueue>> queues_
+      GUARDED_BY(node_queue_mutex_);
+
   mutex next_id_mutex_;
   uint64 next_id_ GUARDED_BY(next_id_mutex_) = 1;
 };
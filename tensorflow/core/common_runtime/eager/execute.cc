@@ -23,9 +23,11 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/copy_to_device_node.h"
 #include "tensorflow/core/common_runtime/eager/execute_node.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/common_runtime/eager/op_trace.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_execute_node.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_op_batcher.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -449,7 +451,10 @@ Status EagerLocalExecute(EagerOperation* op,
   // Ensure all resource-touching ops run in the device the resource is,
   // regardless of anything else that has been specified. This is identical to
   // the graph mode behavior.
+  // Only resource inputs are looked at, so that the other inputs need not be
+  // ready yet.
   for (int i = 0; i < op->Inputs().size(); ++i) {
+    if (op->Inputs()[i]->dtype != DT_RESOURCE) continue;
     Device* input_op_device = nullptr;
     status = op->Inputs()[i]->OpDevice(&input_op_device);
     if (!status.ok()) return status;
@@ -457,8 +462,7 @@ Status EagerLocalExecute(EagerOperation* op,
             << DataTypeString(op->Inputs()[i]->dtype) << " "
             << (input_op_device == nullptr ? "cpu" : input_op_device->name())
             << " " << (op->Device() == nullptr ? "cpu" : op->Device()->name());
-    if (op->Inputs()[i]->dtype == DT_RESOURCE &&
-        (input_op_device != op->Device() || input_op_device == nullptr)) {
+    if (input_op_device != op->Device() || input_op_device == nullptr) {
       Device* d = input_op_device == nullptr ? ctx->HostCPU() : input_op_device;
       VLOG(1) << "Changing device of operation " << op->Name() << " to "
               << d->name() << " because input #" << i
@@ -544,11 +548,14 @@ Status EagerLocalExecute(EagerOperation* op,
     tensorflow::uint64 id = ctx->NextId();
     for (int i = 0; i < *num_retvals; ++i) {
       (*retvals)[i] = new TensorHandle(id, output_dtypes[i], ctx);
+      // Lets shape queries on the outputs use the op's shape function
+      // instead of waiting for it to execute.
+      (*retvals)[i]->SetShapeInference(kernel, i, op->Inputs());
     }
     EagerNode* node =
         new ExecuteNode(id, ctx, op->Device(), op->Inputs(), kernel,
                         maybe_stats.release(), output_dtypes, *retvals);
-    ctx->ExecutorAdd(node);
+    ctx->ExecutorAdd(node, kernel->device());
   } else {
     // Execute checks if retvals[i] is nullptr or not to figure if it needs to
     // allocate it.
@@ -559,13 +566,10 @@ Status EagerLocalExecute(EagerOperation* op,
   return status;
 }
 
-Status EagerRemoteExecute(EagerOperation* op, eager::EagerClient* eager_client,
-                          uint64 context_id, TensorHandle** retvals,
-                          int* num_retvals) {
-  eager::EnqueueRequest request;
-  eager::EnqueueResponse response;
-
-  auto* remote_op = request.add_queue()->mutable_operation();
+Status EagerRemoteExecute(EagerOperation* op, eager::RemoteOpBatcher* batcher,
+                          TensorHandle** retvals, int* num_retvals) {
+  eager::QueueItem item;
+  auto* remote_op = item.mutable_operation();
 
   for (int i = 0; i < op->Inputs().size(); i++) {
     tensorflow::Device* input_device;
@@ -595,22 +599,24 @@ Status EagerRemoteExecute(EagerOperation* op, eager::EagerClient* eager_client,
   op->Attrs().FillAttrValueMap(remote_op->mutable_attrs());
   remote_op->set_device(op->Device()->name());
 
-  request.set_context_id(context_id);
-
   if (op->EagerContext()->Async()) {
     tensorflow::uint64 id = op->EagerContext()->NextId();
-    auto* node = new eager::RemoteExecuteNode(id, request, eager_client);
+    auto* node = new eager::RemoteExecuteNode(id, item, batcher);
     op->EagerContext()->ExecutorAdd(node);
   } else {
     Notification n;
     Status status;
-    eager_client->EnqueueAsync(&request, &response,
-                               [&n, &status](const Status& s) {
-                                 status = s;
-                                 n.Notify();
-                               });
+    TF_RETURN_IF_ERROR(batcher->Add(item, [&n, &status](const Status& s) {
+      status = s;
+      n.Notify();
+    }));
     n.WaitForNotification();
-    if (!status.ok()) return status;
+    if (!status.ok()) {
+      // The error is reported here, so it need not be reported again by the
+      // next ops streamed to the remote context.
+      batcher->WaitForAllPendingItems().IgnoreError();
+      return status;
+    }
   }
 
   DataTypeVector output_dtypes;
@@ -626,27 +632,21 @@ Status EagerRemoteExecute(EagerOperation* op, eager::EagerClient* eager_client,
 
   const tensorflow::uint64 id = remote_op->id();
   for (int i = 0; i < *num_retvals; i++) {
-    // TODO(nareshmodi): Change the callback to instead add the decref to a list
-    // of pending decrefs that we can send as a batch with the next execute.
-    std::function<void()> callback = [ctx, eager_client, context_id, id, i]() {
-      eager::EnqueueRequest request;
-      request.set_context_id(context_id);
-
-      auto* handle_to_decref = request.add_queue()->mutable_handle_to_decref();
+    // The decref is streamed with the next ops instead of being sent on its
+    // own.
+    std::function<void()> callback = [ctx, batcher, id, i]() {
+      eager::QueueItem item;
+      auto* handle_to_decref = item.mutable_handle_to_decref();
       handle_to_decref->set_op_id(id);
       handle_to_decref->set_output_num(i);
 
       if (ctx->Async()) {
+        // Ops already queued in the executor may still use the handle.
         tensorflow::uint64 id = ctx->NextId();
-        auto* node = new eager::RemoteExecuteNode(id, request, eager_client);
+        auto* node = new eager::RemoteExecuteNode(id, item, batcher);
         ctx->ExecutorAdd(node);
       } else {
-        Notification n;
-        eager::EnqueueResponse response;
-        eager_client->EnqueueAsync(
-            &request, &response,
-            [&n](const tensorflow::Status& s) { n.Notify(); });
-        n.WaitForNotification();
+        batcher->Add(item).IgnoreError();
       }
 
       return tensorflow::Status::OK();
@@ -658,11 +658,10 @@ Status EagerRemoteExecute(EagerOperation* op, eager::EagerClient* eager_client,
 
   return Status::OK();
 }
-}  // namespace
 
-Status EagerExecute(EagerOperation* op,
-                    gtl::InlinedVector<TensorHandle*, 2>* retvals,
-                    int* num_retvals) {
+Status EagerExecuteImpl(EagerOperation* op,
+                        gtl::InlinedVector<TensorHandle*, 2>* retvals,
+                        int* num_retvals) {
   bool op_is_local = IsLocal(op->EagerContext(), op->Device());
 
   if (op_is_local) {
@@ -671,13 +670,35 @@ Status EagerExecute(EagerOperation* op,
 
   auto* ctx = op->EagerContext();
 
-  tensorflow::eager::EagerClient* eager_client;
-  tensorflow::uint64 context_id;
-  TF_RETURN_IF_ERROR(
-      ctx->GetClientAndContextID(op->Device(), &eager_client, &context_id));
+  tensorflow::eager::RemoteOpBatcher* batcher;
+  TF_RETURN_IF_ERROR(ctx->GetRemoteOpBatcher(op->Device(), &batcher));
+
+  return EagerRemoteExecute(op, batcher, retvals->data(), num_retvals);
+}
+
+}  // namespace
 
-  return EagerRemoteExecute(op, eager_client, context_id, retvals->data(),
-                            num_retvals);
+Status EagerExecute(EagerOperation* op,
+                    gtl::InlinedVector<TensorHandle*, 2>* retvals,
+                    int* num_retvals) {
+  OpTrace* trace = op->EagerContext()->ActiveTrace();
+  if (trace == nullptr) {
+    return EagerExecuteImpl(op, retvals, num_retvals);
+  }
+  // The inputs of `op` may be replaced by their copies to its device, and the
+  // trace needs the original ones.
+  gtl::InlinedVector<TensorHandle*, 4> inputs = op->Inputs();
+  for (TensorHandle* input : inputs) {
+    input->Ref();
+  }
+  Status status = EagerExecuteImpl(op, retvals, num_retvals);
+  if (status.ok()) {
+    status = trace->Record(op, inputs, retvals->data(), *num_retvals);
+  }
+  for (TensorHandle* input : inputs) {
+    input->Unref();
+  }
+  return status;
 }
 
 Status EagerExecute(EagerContext* ctx, Device* device,
@@ -690,10 +711,10 @@ Status EagerExecute(EagerContext* ctx, Device* device,
     device = kernel->device();
   }
 
-  std::vector<Tensor> outputs(1);
+  std::vector<Tensor> outputs;
   const MemoryTypeVector* output_memory_types = nullptr;
   output_memory_types = &kernel->kernel()->output_memory_types();
-  std::vector<Tensor> inputs(op_inputs.size());
+  gtl::InlinedVector<Tensor, 4> inputs(op_inputs.size());
   for (int i = 0; i < op_inputs.size(); ++i) {
     const Tensor* input_tensor = nullptr;
     TF_RETURN_IF_ERROR(op_inputs[i]->Tensor(&input_tensor));
@@ -764,7 +785,7 @@ Status LocalEagerCopyToDevice(TensorHandle* h, EagerContext* ctx, Device* dstd,
     TensorHandle* output = node->dst();
     // Note that calling Add makes `node` accessible by the EagerExecutor
     // thread. So further accesses need to be thread-safe.
-    ctx->ExecutorAdd(node);
+    ctx->ExecutorAdd(node, dstd);
     *result = output;
     return Status::OK();
   } else {
@@ -41,6 +41,7 @@ Status KernelAndDevice::InitOp(Device* device, const NodeDef& ndef,
   out->device_ = device;
   out->kernel_.reset(k);
   out->flib_ = nullptr;
+  if (s.ok()) out->InitRunState();
   return s;
 }
 
@@ -52,10 +53,22 @@ Status KernelAndDevice::Init(const NodeDef& ndef, FunctionLibraryRuntime* flib,
   out->device_ = flib->device();
   out->kernel_.reset(k);
   out->flib_ = flib;
+  if (s.ok()) out->InitRunState();
   return s;
 }
 
-Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
+void KernelAndDevice::InitRunState() {
+  output_alloc_attrs_.resize(kernel_->num_outputs());
+  for (size_t i = 0; i < output_alloc_attrs_.size(); ++i) {
+    output_alloc_attrs_[i].set_on_host(kernel_->output_memory_types()[i] ==
+                                       tensorflow::HOST_MEMORY);
+  }
+  is_recv_ = kernel_->def().op() == "_Recv";
+  // TODO(apassos): use a thread pool.
+  runner_ = [](std::function<void()> f) { f(); };
+}
+
+Status KernelAndDevice::Run(gtl::InlinedVector<Tensor, 4>* input_tensors,
                             std::vector<Tensor>* output_tensors,
                             NodeExecStats* stats) {
   gtl::InlinedVector<TensorValue, 4> inputs;
@@ -63,19 +76,13 @@ Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
     inputs.push_back(TensorValue(&t));
   }
 
-  std::vector<AllocatorAttributes> out_attrs(kernel_->num_outputs());
-  for (size_t i = 0; i < out_attrs.size(); ++i) {
-    out_attrs[i].set_on_host(kernel_->output_memory_types()[i] ==
-                             tensorflow::HOST_MEMORY);
-  }
-
   OpKernelContext::Params params;
   params.device = device_;
   params.frame_iter = FrameAndIter(0, 0);
   params.inputs = &inputs;
   params.op_kernel = kernel_.get();
   params.resource_manager = device_->resource_manager();
-  params.output_attr_array = gtl::vector_as_array(&out_attrs);
+  params.output_attr_array = output_alloc_attrs_.data();
   params.function_library = flib_;
   params.slice_reader_cache = &slice_reader_cache_;
   params.rendezvous = rendez_;
@@ -83,10 +90,7 @@ Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
   if (stats != nullptr) {
     params.track_allocations = true;
   }
-  // TODO(apassos): use a thread pool.
-  std::function<void(std::function<void()>)> runner =
-      [](std::function<void()> f) { f(); };
-  params.runner = &runner;
+  params.runner = &runner_;
 
   ScopedStepContainer step_container(0, [this](const string& name) {
     device_->resource_manager()->Cleanup(name).IgnoreError();
@@ -95,7 +99,7 @@ Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
 
   OpKernelContext context(&params);
 
-  if (kernel_->def().op() == "_Recv") {
+  if (is_recv_) {
     // TODO(apassos) do not special-case _Recv. Currently the GPU device fails
     // if trying to run _Recv->Compute(), specifically checking for _Recv. To go
     // around this we call _Recv->ComputeAsync, to mimic graph mode behavior.
@@ -109,6 +113,7 @@ Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
   if (!context.status().ok()) return context.status();
 
   output_tensors->clear();
+  output_tensors->reserve(context.num_outputs());
   for (int i = 0; i < context.num_outputs(); ++i) {
     output_tensors->push_back(Tensor(*context.mutable_output(i)));
   }
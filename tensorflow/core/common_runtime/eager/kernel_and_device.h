@@ -18,8 +18,10 @@ limitations under the License.
 
 // Support for eager execution of TensorFlow kernels.
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -66,8 +68,8 @@ class KernelAndDevice {
       : device_(nullptr), flib_(nullptr), rendez_(rendez) {}
 
   // TODO(ashankar): Handle list-valued inputs.
-  Status Run(std::vector<Tensor>* inputs, std::vector<Tensor>* outputs,
-             NodeExecStats* stats);
+  Status Run(gtl::InlinedVector<Tensor, 4>* inputs,
+             std::vector<Tensor>* outputs, NodeExecStats* stats);
 
   const OpKernel* kernel() const { return kernel_.get(); }
 
@@ -77,6 +79,8 @@ class KernelAndDevice {
   const DataTypeVector& output_dtypes() { return output_dtypes_; }
 
  private:
+  void InitRunState();
+
   // TODO(apassos) Consider a shared cancellation manager. Note that this
   // cancellation manager is not useful to actually cancel anything, and is
   // provided here only for the few kernels which can't handle one being
@@ -88,6 +92,12 @@ class KernelAndDevice {
   checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
   Rendezvous* rendez_;
   DataTypeVector output_dtypes_;
+
+  // The per-call state of Run() that only depends on the kernel, computed
+  // once by Init() so that Run() does not allocate it for every call.
+  gtl::InlinedVector<AllocatorAttributes, 4> output_alloc_attrs_;
+  bool is_recv_ = false;
+  std::function<void(std::function<void()>)> runner_;
 };
 
 }  // namespace tensorflow
@@ -116,7 +116,7 @@ BENCHMARK(BM_KernelAndDeviceInit);
 void BM_KernelAndDeviceRun(int iters) {
   tensorflow::testing::StopTiming();
   Tensor t(Input({{1.0f, 2.0f}, {3.0f, 4.0f}}).tensor());
-  std::vector<Tensor> inputs;
+  gtl::InlinedVector<Tensor, 4> inputs;
   inputs.push_back(t);
   inputs.push_back(t);
   std::vector<Tensor> outputs;
@@ -0,0 +1,192 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/op_trace.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+
+namespace {
+
+string CapturedName(int index) { return strings::StrCat("captured_", index); }
+
+}  // namespace
+
+OpTrace::~OpTrace() {
+  for (TensorHandle* handle : held_) {
+    handle->Unref();
+  }
+}
+
+void OpTrace::Hold(TensorHandle* handle) {
+  handle->Ref();
+  held_.push_back(handle);
+}
+
+Status OpTrace::Record(EagerOperation* op,
+                       const gtl::InlinedVector<TensorHandle*, 4>& inputs,
+                       TensorHandle* const* outputs, int num_outputs) {
+  const OpRegistrationData* op_data = nullptr;
+  TF_RETURN_IF_ERROR(ctx_->FindFunctionOpData(op->Name(), &op_data));
+  const OpDef& op_def = op_data->op_def;
+
+  NodeDef ndef;
+  ndef.set_name(strings::StrCat(op->Name(), "_", nodes_.size()));
+  ndef.set_op(op->Name());
+  op->Attrs().FillAttrValueMap(ndef.mutable_attr());
+  AddDefaultsToNodeDef(op_def, &ndef);
+
+  for (TensorHandle* input : inputs) {
+    auto produced = produced_.find(input);
+    if (produced != produced_.end()) {
+      ndef.add_input(produced->second);
+      continue;
+    }
+    auto captured = captured_index_.find(input);
+    if (captured == captured_index_.end()) {
+      captured =
+          captured_index_.emplace(input, static_cast<int>(captured_.size()))
+              .first;
+      captured_.push_back(input);
+      Hold(input);
+    }
+    ndef.add_input(CapturedName(captured->second));
+  }
+  if (op_def.is_stateful()) {
+    if (!last_stateful_node_.empty()) {
+      ndef.add_input(strings::StrCat("^", last_stateful_node_));
+    }
+    last_stateful_node_ = ndef.name();
+  }
+
+  NameRangeMap output_ranges;
+  TF_RETURN_IF_ERROR(NameRangesForNode(ndef, op_def, nullptr, &output_ranges));
+  for (const OpDef::ArgDef& arg : op_def.output_arg()) {
+    const auto& range = output_ranges[arg.name()];
+    for (int i = range.first; i < range.second; ++i) {
+      if (i >= num_outputs) {
+        return errors::Internal("Op ", op->Name(), " produced ", num_outputs,
+                                " outputs, but its signature has more");
+      }
+      produced_[outputs[i]] =
+          strings::StrCat(ndef.name(), ":", arg.name(), ":", i - range.first);
+      Hold(outputs[i]);
+    }
+  }
+  nodes_.push_back(std::move(ndef));
+  return Status::OK();
+}
+
+Status OpTrace::ToFunctionDef(const std::vector<TensorHandle*>& inputs,
+                              const std::vector<TensorHandle*>& outputs,
+                              FunctionDef* fdef) const {
+  fdef->Clear();
+  OpDef* signature = fdef->mutable_signature();
+  std::unordered_map<TensorHandle*, string> input_names;
+  for (int i = 0; i < inputs.size(); ++i) {
+    TensorHandle* input = inputs[i];
+    auto captured = captured_index_.find(input);
+    const string name = captured != captured_index_.end()
+                            ? CapturedName(captured->second)
+                            : strings::StrCat("input_", i);
+    if (!input_names.emplace(input, name).second) {
+      return errors::InvalidArgument("Input ", i, " of the trace is repeated");
+    }
+    OpDef::ArgDef* arg = signature->add_input_arg();
+    arg->set_name(name);
+    arg->set_type(input->dtype);
+  }
+
+  // The captured tensors that are not inputs are embedded as constants,
+  // whose outputs replace the references to them.
+  std::unordered_map<string, string> constants;
+  for (int i = 0; i < captured_.size(); ++i) {
+    TensorHandle* handle = captured_[i];
+    if (input_names.count(handle) > 0) continue;
+    if (handle->dtype == DT_RESOURCE) {
+      return errors::InvalidArgument(
+          "The traced ops read a resource which is not an input of the "
+          "trace");
+    }
+    const Tensor* tensor = nullptr;
+    Device* device = nullptr;
+    Device* op_device = nullptr;
+    TF_RETURN_IF_ERROR(handle->TensorAndDevice(&tensor, &device, &op_device));
+    if (device != nullptr) {
+      return errors::InvalidArgument(
+          "The traced ops read a tensor on ", device->name(),
+          " which is not an input of the trace; only host tensors can be "
+          "embedded in the function");
+    }
+    NodeDef* constant = fdef->add_node_def();
+    constant->set_name(CapturedName(i));
+    constant->set_op("Const");
+    AttrValue dtype;
+    dtype.set_type(handle->dtype);
+    (*constant->mutable_attr())["dtype"] = dtype;
+    AttrValue value;
+    tensor->AsProtoTensorContent(value.mutable_tensor());
+    (*constant->mutable_attr())["value"] = value;
+    constants[constant->name()] = strings::StrCat(constant->name(), ":output:0");
+  }
+  for (const NodeDef& node : nodes_) {
+    NodeDef* added = fdef->add_node_def();
+    *added = node;
+    for (int i = 0; i < added->input_size(); ++i) {
+      auto constant = constants.find(added->input(i));
+      if (constant != constants.end()) {
+        added->set_input(i, constant->second);
+      }
+    }
+  }
+
+  for (int i = 0; i < outputs.size(); ++i) {
+    TensorHandle* output = outputs[i];
+    const string name = strings::StrCat("output_", i);
+    OpDef::ArgDef* arg = signature->add_output_arg();
+    arg->set_name(name);
+    arg->set_type(output->dtype);
+    auto produced = produced_.find(output);
+    if (produced != produced_.end()) {
+      (*fdef->mutable_ret())[name] = produced->second;
+      continue;
+    }
+    auto input = input_names.find(output);
+    if (input == input_names.end()) {
+      return errors::InvalidArgument("Output ", i,
+                                     " of the trace is neither computed by "
+                                     "the traced ops nor an input");
+    }
+    (*fdef->mutable_ret())[name] = input->second;
+  }
+
+  string serialized;
+  if (!SerializeToStringDeterministic(*fdef, &serialized)) {
+    return errors::Internal("Failed to serialize the traced function");
+  }
+  signature->set_name(
+      strings::StrCat("__traced_", Fingerprint64(serialized)));
+  return Status::OK();
+}
+
+}  // namespace tensorflow
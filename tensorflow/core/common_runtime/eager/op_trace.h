@@ -0,0 +1,85 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_OP_TRACE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_OP_TRACE_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+// Records the ops executed eagerly, with their attributes and the tensors
+// flowing between them, so that the sequence can be replayed as a function.
+// Calling the function dispatches a single op instead of each traced op, and
+// lets the whole sequence be optimized, and compiled with XLA, as a graph.
+//
+// The handles read and produced by the recorded ops are kept alive until the
+// trace is destroyed, since their addresses identify the dataflow.
+//
+// Not thread-safe: a trace records the ops of a single thread (see
+// EagerContext::StartTrace).
+class OpTrace {
+ public:
+  explicit OpTrace(EagerContext* ctx) : ctx_(ctx) {}
+  ~OpTrace();
+
+  // Records that `op` ran on `inputs` and produced `outputs`.
+  Status Record(EagerOperation* op,
+                const gtl::InlinedVector<TensorHandle*, 4>& inputs,
+                TensorHandle* const* outputs, int num_outputs);
+
+  // Converts the recorded ops into a function of `inputs` returning
+  // `outputs`. The other tensors read by the ops, which were not computed by
+  // them, become constants of the function; resources must be inputs.
+  // Stateful ops run in the order they were recorded.
+  //
+  // The function is named after a fingerprint of its body, so tracing the
+  // same op sequence again yields the same function.
+  Status ToFunctionDef(const std::vector<TensorHandle*>& inputs,
+                       const std::vector<TensorHandle*>& outputs,
+                       FunctionDef* fdef) const;
+
+ private:
+  void Hold(TensorHandle* handle);
+
+  EagerContext* const ctx_;
+
+  std::vector<NodeDef> nodes_;
+  // The name of the output of a recorded op that each handle is.
+  std::unordered_map<TensorHandle*, string> produced_;
+  // The handles read by the recorded ops but not produced by them, in the
+  // order they were first read. The i-th one is named "captured_<i>".
+  std::vector<TensorHandle*> captured_;
+  std::unordered_map<TensorHandle*, int> captured_index_;
+  // The last recorded stateful op, which the next one depends on.
+  string last_stateful_node_;
+  std::vector<TensorHandle*> held_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OpTrace);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_OP_TRACE_H_
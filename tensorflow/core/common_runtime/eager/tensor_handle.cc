@@ -30,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -107,6 +109,132 @@ Status TensorHandle::TensorAndDevice(const tensorflow::Tensor** tensor,
   return Status::OK();
 }
 
+Status TensorHandle::Shape(tensorflow::TensorShape* shape) {
+  if (!IsReady() && InferShape(shape)) return Status::OK();
+  const tensorflow::Tensor* t = nullptr;
+  TF_RETURN_IF_ERROR(Tensor(&t));
+  *shape = t->shape();
+  return Status::OK();
+}
+
+void TensorHandle::SetShapeInference(
+    KernelAndDevice* kernel, int output_index,
+    const gtl::InlinedVector<TensorHandle*, 4>& inputs) {
+  mutex_lock l(ctx_mutex_);
+  DCHECK(node_id > 0 && !is_ready_);
+  shape_kernel_ = kernel;
+  shape_output_index_ = output_index;
+  shape_inputs_ = inputs;
+  for (TensorHandle* input : shape_inputs_) {
+    input->Ref();
+  }
+}
+
+bool TensorHandle::ShapeIfKnown(tensorflow::TensorShape* shape) {
+  if (IsRemote()) return false;
+  {
+    mutex_lock l(ctx_mutex_);
+    if (node_id == 0 || is_ready_) {
+      *shape = tensor_.shape();
+      return true;
+    }
+  }
+  return InferShape(shape);
+}
+
+bool TensorHandle::InferShape(tensorflow::TensorShape* shape) {
+  KernelAndDevice* kernel = nullptr;
+  int output_index = 0;
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  {
+    mutex_lock l(ctx_mutex_);
+    if (has_inferred_shape_) {
+      *shape = inferred_shape_;
+      return true;
+    }
+    if (shape_kernel_ == nullptr) return false;
+    kernel = shape_kernel_;
+    output_index = shape_output_index_;
+    // Keep the inputs alive without holding the lock while inferring their
+    // shapes, which may recurse into the ops that compute them.
+    inputs = shape_inputs_;
+    for (TensorHandle* input : inputs) {
+      input->Ref();
+    }
+  }
+  bool inferred = false;
+  tensorflow::TensorShape output_shape;
+  const NodeDef& ndef = kernel->kernel()->def();
+  const OpRegistrationData* op_reg_data = nullptr;
+  // Functions are not in the op registry, and looking them up there builds
+  // an error message listing all ops, so they are skipped.
+  if (!ctx_->FindFunctionByName(ndef.op()) &&
+      OpRegistry::Global()->LookUp(ndef.op(), &op_reg_data).ok() &&
+      op_reg_data->shape_inference_fn != nullptr) {
+    std::vector<PartialTensorShape> input_shapes(inputs.size());
+    std::vector<const tensorflow::Tensor*> input_tensors(inputs.size(),
+                                                         nullptr);
+    bool inputs_known = true;
+    for (int i = 0; i < inputs.size() && inputs_known; ++i) {
+      tensorflow::TensorShape input_shape;
+      inputs_known = inputs[i]->ShapeIfKnown(&input_shape);
+      input_shapes[i] = input_shape;
+      // Shape functions may read the values of small host tensors, e.g. the
+      // shape argument of Reshape.
+      if (inputs_known && inputs[i]->IsReady() &&
+          inputs[i]->device_ == nullptr) {
+        input_tensors[i] = &inputs[i]->tensor_;
+      }
+    }
+    if (inputs_known) {
+      shape_inference::InferenceContext c(
+          TF_GRAPH_DEF_VERSION, &ndef, op_reg_data->op_def, input_shapes,
+          input_tensors, {}, {});
+      if (c.construction_status().ok() &&
+          c.Run(op_reg_data->shape_inference_fn).ok() &&
+          output_index < c.num_outputs()) {
+        shape_inference::ShapeHandle s = c.output(output_index);
+        if (c.FullyDefined(s)) {
+          for (int d = 0; d < c.Rank(s); ++d) {
+            output_shape.AddDim(c.Value(c.Dim(s, d)));
+          }
+          inferred = true;
+        }
+      }
+    }
+  }
+  for (TensorHandle* input : inputs) {
+    input->Unref();
+  }
+  {
+    mutex_lock l(ctx_mutex_);
+    if (inferred) {
+      has_inferred_shape_ = true;
+      inferred_shape_ = output_shape;
+    } else if (is_ready_) {
+      // Raced with the op computing this handle.
+      *shape = tensor_.shape();
+      return true;
+    }
+  }
+  // Either way, there is nothing more to infer.
+  ClearShapeInference();
+  *shape = output_shape;
+  return inferred;
+}
+
+void TensorHandle::ClearShapeInference() {
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  {
+    mutex_lock l(ctx_mutex_);
+    shape_kernel_ = nullptr;
+    inputs.swap(shape_inputs_);
+  }
+  for (TensorHandle* input : inputs) {
+    input->Unref();
+  }
+}
+
 Status TensorHandle::RemoteAddress(uint64* op_id, int32* output_num) {
   if (!IsRemote()) {
     return errors::FailedPrecondition(
@@ -121,14 +249,22 @@ Status TensorHandle::RemoteAddress(uint64* op_id, int32* output_num) {
 void TensorHandle::SetTensorAndDevice(const tensorflow::Tensor& tensor,
                                       tensorflow::Device* device,
                                       tensorflow::Device* op_device) {
-  mutex_lock l(ctx_mutex_);
-  DCHECK(node_id > 0 && !is_ready_)
-      << "SetTensorAndDevice should be only called  "
-      << "on non-ready handles.";
-  is_ready_ = true;
-  tensor_ = tensor;
-  device_ = device;
-  op_device_ = op_device;
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  {
+    mutex_lock l(ctx_mutex_);
+    DCHECK(node_id > 0 && !is_ready_)
+        << "SetTensorAndDevice should be only called  "
+        << "on non-ready handles.";
+    is_ready_ = true;
+    tensor_ = tensor;
+    device_ = device;
+    op_device_ = op_device;
+    shape_kernel_ = nullptr;
+    inputs.swap(shape_inputs_);
+  }
+  for (TensorHandle* input : inputs) {
+    input->Unref();
+  }
 }
 
 Status TensorHandle::CopyToDevice(EagerContext* ctx, tensorflow::Device* dstd,
@@ -94,6 +94,7 @@ class TensorHandle : public core::RefCounted {
     if (call_on_destroy_) {
       call_on_destroy_();
     }
+    ClearShapeInference();
   }
 
   Status Tensor(const tensorflow::Tensor** t);
@@ -106,6 +107,17 @@ class TensorHandle : public core::RefCounted {
                          tensorflow::Device** device,
                          tensorflow::Device** op_device);
 
+  // Returns the shape of the tensor. If the handle is not ready, the shape is
+  // inferred with the shape function of the op computing it if possible, so
+  // that the caller need not wait for the op to execute.
+  Status Shape(tensorflow::TensorShape* shape);
+
+  // Makes the shape of this non-ready handle inferable as the shape of output
+  // `output_index` of `kernel` run on `inputs`. Must be called before the
+  // handle is shared.
+  void SetShapeInference(KernelAndDevice* kernel, int output_index,
+                         const gtl::InlinedVector<TensorHandle*, 4>& inputs);
+
   // Return the op_id and output num if the handle refers to a remote tensor.
   Status RemoteAddress(uint64* op_id, int32* output_num);
 
@@ -138,6 +150,16 @@ class TensorHandle : public core::RefCounted {
 
   bool IsRemote();
 
+  // Sets `shape` and returns true if the shape is known without waiting for
+  // the handle to be ready.
+  bool ShapeIfKnown(tensorflow::TensorShape* shape);
+
+  // Infers the shape of this non-ready handle, if possible.
+  bool InferShape(tensorflow::TensorShape* shape);
+
+  // Releases the inputs held for shape inference.
+  void ClearShapeInference();
+
   // Id for the EagerNode that will compute the value pointed to by this handle.
   // If the value is 0, the handle is already ready, but not vice-versa.
   const uint64 node_id;
@@ -174,6 +196,14 @@ class TensorHandle : public core::RefCounted {
   // `ctx` object is not owned and should outlive this handle.
   EagerContext* ctx_ GUARDED_BY(ctx_mutex_);
   bool is_ready_ GUARDED_BY(ctx_mutex_);
+
+  // How to infer the shape of this handle before it is ready (see
+  // SetShapeInference), cleared once it is ready or the shape was inferred.
+  KernelAndDevice* shape_kernel_ GUARDED_BY(ctx_mutex_) = nullptr;
+  int shape_output_index_ GUARDED_BY(ctx_mutex_) = 0;
+  gtl::InlinedVector<TensorHandle*, 4> shape_inputs_ GUARDED_BY(ctx_mutex_);
+  bool has_inferred_shape_ GUARDED_BY(ctx_mutex_) = false;
+  tensorflow::TensorShape inferred_shape_ GUARDED_BY(ctx_mutex_);
 };
 
 }  // namespace tensorflow
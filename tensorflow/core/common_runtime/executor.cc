@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/memory_planner.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -54,12 +56,16 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
+#include "tensorflow/core/platform/profile_utils/perf_event_counters.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
 namespace tensorflow {
@@ -68,6 +74,9 @@ namespace {
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+// Written by grappler's MemoryAwareScheduler.
+const char kSchedulingPriorityAttr[] = "_scheduling_priority";
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -152,6 +161,20 @@ void SetOpEnd(NodeExecStatsWrapper* stats) {
   nt->set_op_end_rel_micros(NowInUsec() - nt->all_start_micros());
 }
 
+// Records the counters accumulated since `start` was read.
+void SetHardwareCounters(NodeExecStatsWrapper* stats,
+                         const profile_utils::PerfEventCounters::Values& start) {
+  profile_utils::PerfEventCounters::Values end;
+  if (!profile_utils::PerfEventCounters::Read(&end)) return;
+  HardwareCounters* counters = stats->stats()->mutable_hardware_counters();
+  counters->set_cycles(end.cycles - start.cycles);
+  counters->set_instructions(end.instructions - start.instructions);
+  const int64 llc_misses = end.llc_misses - start.llc_misses;
+  counters->set_llc_misses(llc_misses);
+  counters->set_dram_bytes(llc_misses *
+                           profile_utils::PerfEventCounters::kCacheLineBytes);
+}
+
 void SetAllEnd(NodeExecStatsWrapper* stats) {
   if (!stats) return;
   NodeExecStats* nt = stats->stats();
@@ -224,6 +247,8 @@ struct NodeItem {
   bool is_sink : 1;              // True iff IsSink(node)
   // True iff IsEnter(node) || IsExit(node) || IsNextIteration(node)
   bool is_enter_exit_or_next_iter : 1;
+  // True iff the kernel may allocate from Executor::Args::step_allocator.
+  bool uses_step_allocator : 1;
 
   // Cached values of node->num_inputs() and node->num_outputs(), to
   // avoid levels of indirection.
@@ -237,6 +262,11 @@ struct NodeItem {
   // Number of output edges.
   size_t num_output_edges;
 
+  // The order in which this node should run relative to the other nodes
+  // that become ready at the same time, lowest first. Set by grappler's
+  // memory-aware scheduler, 0 otherwise.
+  int scheduling_priority = 0;
+
   PendingCounts::Handle pending_id;
 
   const EdgeInfo* output_edge_list() const { return output_edge_base(); }
@@ -346,6 +376,44 @@ class GraphView {
   TF_DISALLOW_COPY_AND_ASSIGN(GraphView);
 };
 
+// Tracks a running estimate of the cost, in clock cycles, of every kernel
+// whose OpKernel::IsExpensive() returns true, and uses it to decide whether
+// a ready node is worth dispatching to another thread. Nodes whose kernels
+// are not marked expensive are never measured and are always run inline.
+class KernelStats {
+ public:
+  KernelStats() {}
+
+  void Initialize(const GraphView& gview, const Graph* g);
+
+  // Returns true iff the kernel of "item" is expensive enough that running
+  // it in a different thread than its predecessor pays off.
+  bool IsExpensive(const NodeItem& item) const;
+
+  // Returns true iff the cost of the kernel of "item" should be measured.
+  bool HasExpensiveMarker(const NodeItem& item) const {
+    return item.kernel_is_expensive;
+  }
+
+  // Folds one measured execution of "item" into its cost estimate.
+  void UpdateCostEstimate(const NodeItem& item, uint64 elapsed_cycles);
+
+ private:
+  // Kernels start out as expensive as their IsExpensive() marker claims.
+  static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
+  // Below this estimate dispatching a node costs about as much as running it.
+  static constexpr uint64 kOpIsExpensiveThresholdCycles = 5000;
+  // The weight of the history in the running estimate is
+  // (kCostDecay - 1) / kCostDecay.
+  static constexpr uint64 kCostDecay = 10;
+
+  // Indexed by node id. Updates are atomic but unlocked: concurrent updates
+  // of the same node may drop a sample, which is fine for an estimate.
+  std::unique_ptr<std::atomic<uint64>[]> cost_estimates_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KernelStats);
+};
+
 class ExecutorImpl : public Executor {
  public:
   ExecutorImpl(const LocalExecutorParams& p, std::unique_ptr<const Graph> g)
@@ -364,10 +432,21 @@ class ExecutorImpl : public Executor {
     for (auto fiter : frame_info_) {
       delete fiter.second;
     }
+    if (memory_plan_ != nullptr) memory_plan_->Unref();
   }
 
   Status Initialize();
 
+  // Switches this executor to the work-stealing scheduling mode: instead of
+  // dispatching every extra ready node through the runner, each thread of
+  // computation owns a bounded deque of ready nodes and idle threads steal
+  // from their peers. At most "max_workers" threads of computation run a
+  // step at any time. Must be called before Initialize().
+  void EnableWorkStealing(int max_workers) {
+    CHECK_GT(max_workers, 0);
+    work_stealing_max_workers_ = max_workers;
+  }
+
   // Process all Nodes in the current graph, attempting to infer the
   // memory allocation attributes to be used wherever they may allocate
   // a tensor buffer.
@@ -433,6 +512,20 @@ class ExecutorImpl : public Executor {
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // Measured kernel costs, shared by all steps run by this executor.
+  mutable KernelStats kernel_stats_;
+
+  // If > 0, the maximum number of concurrent workers of a step scheduled in
+  // the work-stealing mode. See EnableWorkStealing().
+  int work_stealing_max_workers_ = 0;
+
+  // True iff some node of the graph has a scheduling priority.
+  bool has_scheduling_priorities_ = false;
+
+  // If non-null, the slab in which the outputs of nodes are placed when
+  // their shapes are known statically. Owns a reference.
+  MemoryPlanSlab* memory_plan_ = nullptr;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
@@ -633,6 +726,30 @@ void GraphView::Initialize(const Graph* g) {
   CHECK_EQ(ptr, space_ + total_bytes);
 }
 
+void KernelStats::Initialize(const GraphView& gview, const Graph* g) {
+  const int num_nodes = g->num_node_ids();
+  cost_estimates_.reset(new std::atomic<uint64>[num_nodes]);
+  for (int i = 0; i < num_nodes; ++i) {
+    cost_estimates_[i].store(kInitialCostEstimateCycles,
+                             std::memory_order_relaxed);
+  }
+}
+
+bool KernelStats::IsExpensive(const NodeItem& item) const {
+  return item.kernel_is_expensive &&
+         cost_estimates_[item.node->id()].load(std::memory_order_relaxed) >
+             kOpIsExpensiveThresholdCycles;
+}
+
+void KernelStats::UpdateCostEstimate(const NodeItem& item,
+                                     uint64 elapsed_cycles) {
+  std::atomic<uint64>& cost_estimate = cost_estimates_[item.node->id()];
+  const uint64 prev_estimate = cost_estimate.load(std::memory_order_relaxed);
+  cost_estimate.store(
+      ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay,
+      std::memory_order_relaxed);
+}
+
 void GetMaxPendingCounts(const Node* n, size_t* max_pending,
                          size_t* max_dead_count) {
   const size_t num_in_edges = n->in_edges().size();
@@ -656,6 +773,25 @@ void GetMaxPendingCounts(const Node* n, size_t* max_pending,
   *max_dead_count = num_in_edges;
 }
 
+// Returns true if the tensors that 'n' allocates are not expected to outlive
+// the step, so that they may come from a step allocator. Stateful kernels and
+// kernels that touch references or resources can stash their tensors in
+// state that survives the step, and the outputs of _Retval and _Send inputs
+// escape to the caller.
+static bool AllocatesStepLocal(const Node* n) {
+  if (n->op_def().is_stateful()) return false;
+  for (DataType dt : n->input_types()) {
+    if (IsRefType(dt) || dt == DT_RESOURCE) return false;
+  }
+  for (DataType dt : n->output_types()) {
+    if (IsRefType(dt) || dt == DT_RESOURCE) return false;
+  }
+  for (const Node* dst : n->out_nodes()) {
+    if (IsSend(dst) || dst->type_string() == "_Retval") return false;
+  }
+  return true;
+}
+
 Status ExecutorImpl::Initialize() {
   gview_.Initialize(graph_.get());
 
@@ -672,6 +808,8 @@ Status ExecutorImpl::Initialize() {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
 
+  kernel_stats_.Initialize(gview_, graph_.get());
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   for (const Node* n : graph_->nodes()) {
@@ -707,6 +845,13 @@ Status ExecutorImpl::Initialize() {
     item->is_sink = IsSink(n);
     item->is_enter_exit_or_next_iter =
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
+    item->uses_step_allocator =
+        params_.device->device_type() == DEVICE_CPU && AllocatesStepLocal(n);
+    const AttrValue* priority = n->attrs().Find(kSchedulingPriorityAttr);
+    if (priority != nullptr) {
+      item->scheduling_priority = static_cast<int>(priority->i());
+      has_scheduling_priorities_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -730,7 +875,21 @@ Status ExecutorImpl::Initialize() {
   // all nodes.
   InitializePending(graph_.get(), cf_info);
 
-  return gview_.SetAllocAttrs(graph_.get(), params_.device);
+  TF_RETURN_IF_ERROR(gview_.SetAllocAttrs(graph_.get(), params_.device));
+
+  // Opt-in, as the plan only pays off for graphs that run many steps.
+  bool plan_memory = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_EXECUTOR_PLAN_MEMORY",
+                                        /*default_val=*/false, &plan_memory));
+  if (plan_memory) {
+    TF_RETURN_IF_ERROR(MemoryPlanSlab::Create(
+        *graph_, params_.device->GetAllocator(AllocatorAttributes()),
+        [this](const Node* n) {
+          return gview_.node(n->id())->uses_step_allocator;
+        },
+        &memory_plan_));
+  }
+  return Status::OK();
 }
 
 // If a Node has been marked to use a ScopedAllocator x for output i, then
@@ -1288,6 +1447,23 @@ class ExecutorState {
     int front_index_;
   };
 
+  // The ready deque owned by one worker in the work-stealing mode. Only the
+  // owning worker pushes to it, and it pops from the back (LIFO, which keeps
+  // producer/consumer pairs on the same thread). Idle workers steal from the
+  // front.
+  struct WorkerQueue {
+    mutex mu;
+    std::deque<TaggedNode> nodes GUARDED_BY(mu);
+    // A lock-free approximation of nodes.size(), used by thieves to skip
+    // empty queues without taking their locks.
+    std::atomic<int> size{0};
+  };
+
+  // The maximum number of nodes a worker keeps in its own deque. Ready nodes
+  // that do not fit are handed to a newly started worker or put in
+  // overflow_ready_.
+  static constexpr size_t kMaxWorkerQueueSize = 1024;
+
   struct AsyncState;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
@@ -1303,7 +1479,11 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  Allocator* step_allocator_;
   StepStatsCollector* stats_collector_;
+  // True iff the hardware counters of the kernels are recorded in their
+  // stats.
+  const bool collect_hardware_counters_;
   // QUESTION: Make it a checkpoint::TensorSliceReaderCacheWrapper
   // instead of a pointer?  (avoids having to delete).
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
@@ -1330,6 +1510,21 @@ class ExecutorState {
   mutex mu_;
   Status status_ GUARDED_BY(mu_);
 
+  // State of the work-stealing mode; unused unless work_stealing_ is true.
+  const bool work_stealing_;
+  std::unique_ptr<WorkerQueue[]> worker_queues_;
+  // The number of threads of computation currently touching this step's
+  // state in the work-stealing mode. The last one to leave after the step has
+  // completed calls Finish().
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<bool> step_completed_{false};
+  mutex worker_mu_;
+  // Ids of the worker queues that have no running worker.
+  std::vector<int> idle_workers_ GUARDED_BY(worker_mu_);
+  // Ready nodes which no worker could absorb. Drained by any worker that runs
+  // out of local and stealable work.
+  std::deque<TaggedNode> overflow_ready_ GUARDED_BY(worker_mu_);
+
   // Mapping from frame name to outstanding frames. A new frame is created
   // at some iteration of an active frame. So the unique key for the new
   // child frame is composed of the name of the parent frame, the iteration
@@ -1356,8 +1551,28 @@ class ExecutorState {
   void CleanupFramesIterations(FrameState* frame, int64 iter,
                                TaggedNodeSeq* ready);
 
-  // Process a ready node in current thread.
-  void Process(TaggedNode node, int64 scheduled_usec);
+  // Process a ready node in current thread. In the work-stealing mode,
+  // "worker" is the id of the worker queue owned by this thread of
+  // computation, which is drained (and peers stolen from) after "node".
+  void Process(TaggedNode node, int64 scheduled_usec, int worker);
+
+  // Pops the next node to be processed by the current thread of computation
+  // into *node. Returns false if there is nothing left to do, in which case
+  // "worker" (if any) is released.
+  bool PopReady(int worker, TaggedNodeReadyQueue* inline_ready,
+                TaggedNode* node);
+
+  // Work-stealing counterpart of ScheduleReady. Pushes the nodes in 'ready'
+  // onto the queue of 'worker' (or, if worker < 0, which happens outside of
+  // any worker, hands them out to idle workers), and starts idle workers to
+  // share any surplus.
+  void ScheduleReadyWorkStealing(const TaggedNodeSeq& ready, int worker,
+                                 int64 scheduled_usec);
+
+  // Marks the current thread of computation as no longer touching this
+  // step's state in the work-stealing mode. "completed" is true if the
+  // thread observed the completion of the step.
+  void LeaveWorkStealing(bool completed);
 
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -1379,13 +1594,13 @@ class ExecutorState {
   // "node" just finishes. Takes ownership of "stats". Returns true if
   // execution has completed.
   bool NodeDone(const Status& s, const Node* node, const TaggedNodeSeq& ready,
-                NodeExecStatsWrapper* stats,
-                TaggedNodeReadyQueue* inline_ready);
+                NodeExecStatsWrapper* stats, TaggedNodeReadyQueue* inline_ready,
+                int worker = -1);
 
   // Schedule all the expensive nodes in 'ready', and put all the inexpensive
   // nodes in 'ready' into 'inline_ready'.
   void ScheduleReady(const TaggedNodeSeq& ready,
-                     TaggedNodeReadyQueue* inline_ready);
+                     TaggedNodeReadyQueue* inline_ready, int worker = -1);
 
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
@@ -1425,14 +1640,25 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       session_state_(args.session_state),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_allocator_(args.step_allocator),
       stats_collector_(args.stats_collector),
+      collect_hardware_counters_(
+          args.collect_hardware_counters && args.stats_collector != nullptr &&
+          impl->params_.device->device_type() == DEVICE_CPU),
       slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
       call_frame_(args.call_frame),
       impl_(impl),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
-      num_outstanding_ops_(0) {
+      num_outstanding_ops_(0),
+      work_stealing_(impl->work_stealing_max_workers_ > 0) {
+  if (work_stealing_) {
+    const int num_workers = impl_->work_stealing_max_workers_;
+    worker_queues_.reset(new WorkerQueue[num_workers]);
+    idle_workers_.reserve(num_workers);
+    for (int i = num_workers - 1; i >= 0; --i) idle_workers_.push_back(i);
+  }
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
@@ -1565,7 +1791,13 @@ void ExecutorState::RunAsync(Executor::DoneCallback done) {
     root_frame_->iterations[0]->outstanding_ops = ready.size();
     done_cb_ = std::move(done);
     // Schedule to run all the ready ops in thread pool.
-    ScheduleReady(ready, nullptr);
+    if (work_stealing_) {
+      num_active_workers_.fetch_add(1, std::memory_order_relaxed);
+      ScheduleReady(ready, nullptr);
+      LeaveWorkStealing(false);
+    } else {
+      ScheduleReady(ready, nullptr);
+    }
   }
 }
 
@@ -1615,7 +1847,8 @@ struct ExecutorState::AsyncState {
   }
 };
 
-void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
+void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec,
+                            int worker) {
   const GraphView& gview = impl_->gview_;
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
@@ -1652,9 +1885,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   EntryVector outputs;
   bool completed = false;
   inline_ready.push_back(tagged_node);
-  while (!inline_ready.empty()) {
-    tagged_node = inline_ready.front();
-    inline_ready.pop_front();
+  while (PopReady(worker, &inline_ready, &tagged_node)) {
     const Node* node = tagged_node.node;
     FrameState* input_frame = tagged_node.input_frame;
     const int64 input_iter = tagged_node.input_iter;
@@ -1673,6 +1904,16 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
       params.op_device_context = device_context_map_[id];
     }
 
+    params.step_allocator = nullptr;
+    if (item.uses_step_allocator) {
+      if (impl_->memory_plan_ != nullptr) {
+        params.step_allocator = impl_->memory_plan_->allocator(id);
+      }
+      if (params.step_allocator == nullptr) {
+        params.step_allocator = step_allocator_;
+      }
+    }
+
     params.track_allocations = false;
     stats = nullptr;
     if (stats_collector_ && !tagged_node.is_dead) {
@@ -1715,7 +1956,8 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         }
         MaybeMarkCompleted(input_frame, input_iter, id);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+        completed =
+            NodeDone(s, item.node, ready, stats, &inline_ready, worker);
         continue;
       }
 
@@ -1736,6 +1978,9 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
             new AsyncState(params, tagged_node, &item, first_input, stats);
 
         auto done = [this, state]() {
+          if (work_stealing_) {
+            num_active_workers_.fetch_add(1, std::memory_order_relaxed);
+          }
           Device* device = impl_->params_.device;
           NodeExecStatsWrapper* stats = state->stats;  // Shorthand
           Entry* first_input = state->first_input;     // Shorthand
@@ -1778,16 +2023,41 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
           const bool completed =
               NodeDone(s, state->item->node, ready, stats, nullptr);
           delete state;
-          if (completed) Finish();
+          if (work_stealing_) {
+            LeaveWorkStealing(completed);
+          } else if (completed) {
+            Finish();
+          }
         };
         nodestats::SetOpStart(stats);
         device->ComputeAsync(async, &state->ctx, done);
       } else {
         // Synchronous computes.
         OpKernelContext ctx(&params, item.num_outputs);
+        profile_utils::PerfEventCounters::Values counters_start;
+        const bool record_counters =
+            stats && collect_hardware_counters_ &&
+            profile_utils::PerfEventCounters::Read(&counters_start);
         nodestats::SetOpStart(stats);
-        device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        if (impl_->kernel_stats_.HasExpensiveMarker(item)) {
+          const uint64 start_cycles =
+              profile_utils::CpuUtils::GetCurrentClockCycle();
+          device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+          const uint64 end_cycles =
+              profile_utils::CpuUtils::GetCurrentClockCycle();
+          // A clock that does not advance (or goes backwards across cores)
+          // would make every kernel look free; ignore such samples.
+          if (end_cycles > start_cycles) {
+            impl_->kernel_stats_.UpdateCostEstimate(item,
+                                                    end_cycles - start_cycles);
+          }
+        } else {
+          device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        }
         nodestats::SetOpEnd(stats);
+        if (record_counters) {
+          nodestats::SetHardwareCounters(stats, counters_start);
+        }
         s = ProcessOutputs(item, &ctx, &outputs, stats);
         if (s.ok() && impl_->device_record_tensor_accesses_) {
           // Get the list of all tensors accessed during the execution
@@ -1826,12 +2096,73 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         scheduled_usec = nodestats::NowInUsec();
       }
       // Postprocess.
-      completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+      completed = NodeDone(s, item.node, ready, stats, &inline_ready, worker);
     }
-  }  // while !inline_ready.empty()
+  }  // while PopReady(...)
 
   // This thread of computation is done if completed = true.
-  if (completed) Finish();
+  if (worker >= 0) {
+    LeaveWorkStealing(completed);
+  } else if (completed) {
+    Finish();
+  }
+}
+
+bool ExecutorState::PopReady(int worker, TaggedNodeReadyQueue* inline_ready,
+                             TaggedNode* node) {
+  if (!inline_ready->empty()) {
+    *node = inline_ready->front();
+    inline_ready->pop_front();
+    return true;
+  }
+  if (worker < 0) return false;
+
+  // Local work first, most recently pushed node first.
+  {
+    WorkerQueue* q = &worker_queues_[worker];
+    mutex_lock l(q->mu);
+    if (!q->nodes.empty()) {
+      *node = q->nodes.back();
+      q->nodes.pop_back();
+      q->size.store(q->nodes.size(), std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Steal the oldest node of a peer.
+  const int num_workers = impl_->work_stealing_max_workers_;
+  for (int i = 1; i < num_workers; ++i) {
+    WorkerQueue* q = &worker_queues_[(worker + i) % num_workers];
+    if (q->size.load(std::memory_order_relaxed) == 0) continue;
+    mutex_lock l(q->mu);
+    if (!q->nodes.empty()) {
+      *node = q->nodes.front();
+      q->nodes.pop_front();
+      q->size.store(q->nodes.size(), std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Nothing to steal: take from the overflow queue or give up the worker.
+  // Both happen under worker_mu_, so a node pushed to overflow_ready_ while
+  // no worker is idle is always picked up by some still running worker.
+  mutex_lock l(worker_mu_);
+  if (!overflow_ready_.empty()) {
+    *node = overflow_ready_.front();
+    overflow_ready_.pop_front();
+    return true;
+  }
+  idle_workers_.push_back(worker);
+  return false;
+}
+
+void ExecutorState::LeaveWorkStealing(bool completed) {
+  if (completed) step_completed_.store(true, std::memory_order_release);
+  if (num_active_workers_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+      step_completed_.load(std::memory_order_acquire)) {
+    // No other thread can touch this step anymore.
+    Finish();
+  }
 }
 
 Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -2168,7 +2499,7 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
 bool ExecutorState::NodeDone(const Status& s, const Node* node,
                              const TaggedNodeSeq& ready,
                              NodeExecStatsWrapper* stats,
-                             TaggedNodeReadyQueue* inline_ready) {
+                             TaggedNodeReadyQueue* inline_ready, int worker) {
   nodestats::SetAllEnd(stats);
   if (stats_collector_ != nullptr && !SetTimelineLabel(node, stats)) {
     // Only record non-transfer nodes.
@@ -2210,31 +2541,69 @@ bool ExecutorState::NodeDone(const Status& s, const Node* node,
 
   // Schedule the ready nodes in 'ready'.
   if (s.ok()) {
-    ScheduleReady(ready, inline_ready);
+    ScheduleReady(ready, inline_ready, worker);
   }
   return completed;
 }
 
-void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
-                                  TaggedNodeReadyQueue* inline_ready) {
-  if (ready.empty()) return;
+void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready_in,
+                                  TaggedNodeReadyQueue* inline_ready,
+                                  int worker) {
+  if (ready_in.empty()) return;
+
+  const GraphView& gview = impl_->gview_;
+  // Hand out the ready nodes in the order chosen by the memory-aware
+  // scheduler, so that the consumers of large tensors run first.
+  TaggedNodeSeq sorted;
+  if (impl_->has_scheduling_priorities_ && ready_in.size() > 1) {
+    sorted = ready_in;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&gview](const TaggedNode& a, const TaggedNode& b) {
+                       return gview.node(a.node->id())->scheduling_priority <
+                              gview.node(b.node->id())->scheduling_priority;
+                     });
+  }
+  const TaggedNodeSeq& ready = sorted.empty() ? ready_in : sorted;
 
   int64 scheduled_usec = 0;
   if (stats_collector_) {
     scheduled_usec = nodestats::NowInUsec();
   }
+  if (work_stealing_) {
+    ScheduleReadyWorkStealing(ready, worker, scheduled_usec);
+    return;
+  }
   if (inline_ready == nullptr) {
-    // Schedule to run all the ready ops in thread pool.
+    // Schedule to run all the ready ops in thread pool. Expensive ops get a
+    // closure each, inexpensive ops are run back to back in a single closure
+    // so that they do not pay one handoff each.
+    TaggedNodeSeq inexpensive_nodes;
     for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_usec); });
+      const NodeItem& item = *gview.node(tagged_node.node->id());
+      if (tagged_node.is_dead || !impl_->kernel_stats_.IsExpensive(item)) {
+        inexpensive_nodes.push_back(tagged_node);
+      } else {
+        runner_([=]() { Process(tagged_node, scheduled_usec, -1); });
+      }
+    }
+    if (inexpensive_nodes.size() == 1) {
+      const TaggedNode tagged_node = inexpensive_nodes[0];
+      runner_([=]() { Process(tagged_node, scheduled_usec, -1); });
+    } else if (!inexpensive_nodes.empty()) {
+      // NOTE: None of the nodes but the last one can complete the step, so
+      // 'this' stays alive until the last call to Process().
+      runner_([this, inexpensive_nodes, scheduled_usec]() {
+        for (const TaggedNode& tagged_node : inexpensive_nodes) {
+          Process(tagged_node, scheduled_usec, -1);
+        }
+      });
     }
     return;
   }
-  const GraphView& gview = impl_->gview_;
   const TaggedNode* curr_expensive_node = nullptr;
   for (auto& tagged_node : ready) {
     const NodeItem& item = *gview.node(tagged_node.node->id());
-    if (tagged_node.is_dead || !item.kernel_is_expensive) {
+    if (tagged_node.is_dead || !impl_->kernel_stats_.IsExpensive(item)) {
       // Inline this inexpensive node.
       inline_ready->push_back(tagged_node);
     } else {
@@ -2242,7 +2611,7 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
         runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_usec));
+                          scheduled_usec, -1));
       }
       curr_expensive_node = &tagged_node;
     }
@@ -2255,8 +2624,54 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
       runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_usec));
+                        scheduled_usec, -1));
+    }
+  }
+}
+
+void ExecutorState::ScheduleReadyWorkStealing(const TaggedNodeSeq& ready,
+                                              int worker,
+                                              int64 scheduled_usec) {
+  size_t next = 0;
+  if (worker >= 0) {
+    // Absorb as much of the fan-out as possible into our own deque.
+    WorkerQueue* q = &worker_queues_[worker];
+    mutex_lock l(q->mu);
+    while (next < ready.size() && q->nodes.size() < kMaxWorkerQueueSize) {
+      q->nodes.push_back(ready[next++]);
+    }
+    q->size.store(q->nodes.size(), std::memory_order_relaxed);
+  }
+
+  // Start an idle worker for every node our deque could not absorb, and for
+  // all but the last node of our deque while there are idle workers left: the
+  // new workers take the oldest nodes, the way a thief would.
+  gtl::InlinedVector<std::pair<int, TaggedNode>, 8> to_start;
+  {
+    mutex_lock l(worker_mu_);
+    for (; next < ready.size(); ++next) {
+      if (idle_workers_.empty()) {
+        overflow_ready_.push_back(ready[next]);
+      } else {
+        to_start.emplace_back(idle_workers_.back(), ready[next]);
+        idle_workers_.pop_back();
+      }
     }
+    if (worker >= 0 && !idle_workers_.empty()) {
+      WorkerQueue* q = &worker_queues_[worker];
+      mutex_lock ql(q->mu);
+      while (q->nodes.size() > 1 && !idle_workers_.empty()) {
+        to_start.emplace_back(idle_workers_.back(), q->nodes.front());
+        idle_workers_.pop_back();
+        q->nodes.pop_front();
+      }
+      q->size.store(q->nodes.size(), std::memory_order_relaxed);
+    }
+  }
+  for (const auto& w : to_start) {
+    num_active_workers_.fetch_add(1, std::memory_order_relaxed);
+    runner_(std::bind(&ExecutorState::Process, this, w.second, scheduled_usec,
+                      w.first));
   }
 }
 
@@ -2404,6 +2819,12 @@ void ExecutorState::Finish() {
     // the user until the step (and its side-effects) has actually completed.
     status = impl_->params_.device->Sync();
   }
+  if (stats_collector_ && impl_->memory_plan_ != nullptr) {
+    MemoryPlanStats plan_stats;
+    impl_->memory_plan_->GetStats(&plan_stats);
+    stats_collector_->SaveMemoryPlanStats(impl_->params_.device->name(),
+                                          plan_stats);
+  }
   delete this;
   CHECK(done_cb != nullptr);
   runner([=]() { done_cb(status); });
@@ -2789,6 +3210,31 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING" executor, which schedules ready nodes on
+// per-worker deques (see ExecutorImpl::EnableWorkStealing) with one worker
+// per schedulable CPU.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params,
+                       std::unique_ptr<const Graph> graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      std::unique_ptr<ExecutorImpl> impl(
+          new ExecutorImpl(params, std::move(graph)));
+      impl->EnableWorkStealing(std::max(1, port::NumSchedulableCPUs()));
+      TF_RETURN_IF_ERROR(impl->Initialize());
+      out_executor->reset(impl.release());
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -91,6 +91,14 @@ class Executor {
     ScopedStepContainer* step_container = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
 
+    // If non-null, kernels on CPU devices allocate the tensors that are not
+    // expected to outlive the step from here. See StepArenaAllocator.
+    Allocator* step_allocator = nullptr;
+
+    // If true and `stats_collector` is set, records the hardware performance
+    // counters of each synchronous kernel run on a CPU device.
+    bool collect_hardware_counters = false;
+
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
 
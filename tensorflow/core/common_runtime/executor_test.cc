@@ -13,11 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+
 #include <algorithm>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
@@ -56,8 +59,10 @@ class ExecutorTest : public ::testing::Test {
     delete device_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor of type 'executor_type' based on a
+  // graph 'gdef'.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_;
@@ -69,7 +74,9 @@ class ExecutorTest : public ::testing::Test {
       DeleteNonCachedKernel(kernel);
     };
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, std::move(graph), &exec_));
+    std::unique_ptr<Executor> exec;
+    TF_CHECK_OK(NewExecutor(executor_type, params, std::move(graph), &exec));
+    exec_ = exec.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
     rendez_ = NewLocalRendezvous();
   }
@@ -163,6 +170,42 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, StaticMemoryPlan) {
+  setenv("TF_EXECUTOR_PLAN_MEMORY", "true", 1);
+  // t3 = (a + b) + (a + b) + b
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto a = test::graph::Constant(g.get(), V(1.0));
+  auto b = test::graph::Constant(g.get(), V(2.0));
+  auto t1 = test::graph::Add(g.get(), a, b);
+  auto t2 = test::graph::Add(g.get(), t1, t1);
+  auto t3 = test::graph::Add(g.get(), t2, b);
+  test::graph::Send(g.get(), t3, "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  unsetenv("TF_EXECUTOR_PLAN_MEMORY");
+
+  Rendezvous::Args args;
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(8.0, V(out));
+  }
+
+  step_stats_collector_.Finalize();
+  ASSERT_EQ(1, step_stats_.dev_stats_size());
+  const DeviceStepStats& dev_stats = step_stats_.dev_stats(0);
+  ASSERT_EQ(3, dev_stats.memory_plans_size());
+  const MemoryPlanStats& plan = dev_stats.memory_plans(2);
+  // Only t1 and t2 are planned: the constants do not allocate, and t3 is
+  // sent. t1 is still live when t2 is computed.
+  EXPECT_EQ(2 * Allocator::kAllocatorAlignment, plan.slab_bytes());
+  EXPECT_EQ(2 * sizeof(float), plan.planned_bytes());
+  EXPECT_EQ(6, plan.num_slab_allocations());
+  EXPECT_EQ(0, plan.num_fallback_allocations());
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -243,6 +286,64 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, WideFanOutWorkStealing) {
+  // Fans "a" out to more nodes than fit in one worker's deque, and sums them
+  // back up in a chain.
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  const int N = 3000;
+  Node* sum = test::graph::Identity(g.get(), in, 0);
+  for (int i = 1; i < N; ++i) {
+    sum = test::graph::Add(g.get(), sum, test::graph::Identity(g.get(), in, 0));
+  }
+  test::graph::Send(g.get(), sum, "b", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(static_cast<float>(N), V(out));
+  }
+}
+
+TEST_F(ExecutorTest, SimpleSwitchDeadWorkStealing) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -413,7 +514,8 @@ TEST_F(ExecutorTest, RecvInvalidRefDtype) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(int iters, int width, int depth) {
+static void BM_executor_type(int iters, int width, int depth,
+                             const char* executor_type) {
 #ifdef PLATFORM_GOOGLE
   BenchmarkUseRealTime();
 #endif  // PLATFORM_GOOGLE
@@ -447,7 +549,16 @@ static void BM_executor(int iters, int width, int depth) {
   SetBenchmarkLabel(strings::StrCat("Nodes = ", cur));
   SetBenchmarkItemsProcessed(cur * static_cast<int64>(iters));
 #endif  // PLATFORM_GOOGLE
-  test::Benchmark("cpu", g).Run(iters);
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr, executor_type)
+      .Run(iters);
+}
+
+static void BM_executor(int iters, int width, int depth) {
+  BM_executor_type(iters, width, depth, "");
+}
+
+static void BM_workstealing_executor(int iters, int width, int depth) {
+  BM_executor_type(iters, width, depth, "WORK_STEALING");
 }
 
 // Tall skinny graphs
@@ -461,6 +572,67 @@ BENCHMARK(BM_executor)->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->ArgPair(1024, 1024);
 
+BENCHMARK(BM_workstealing_executor)->ArgPair(16, 1024);
+BENCHMARK(BM_workstealing_executor)->ArgPair(32, 8192);
+BENCHMARK(BM_workstealing_executor)->ArgPair(1024, 16);
+BENCHMARK(BM_workstealing_executor)->ArgPair(8192, 32);
+BENCHMARK(BM_workstealing_executor)->ArgPair(1024, 1024);
+
+// A chain of 'depth' nodes, each fanning out to 'width' independent no-ops
+// which are joined again by the next link of the chain. With 'width' == 0 the
+// links depend on each other directly.
+static void BM_executor_fanout_chain(int iters, int width, int depth,
+                                     const char* executor_type) {
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#endif  // PLATFORM_GOOGLE
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* link = test::graph::NoOp(g, {});
+  int64 cur = 1;
+  for (int i = 0; i < depth; ++i) {
+    std::vector<Node*> fanout;
+    for (int j = 0; j < width; ++j) {
+      fanout.push_back(test::graph::NoOp(g, {link}));
+    }
+    if (fanout.empty()) fanout.push_back(link);
+    link = test::graph::NoOp(g, fanout);
+    cur += width + 1;
+  }
+#ifdef PLATFORM_GOOGLE
+  SetBenchmarkLabel(strings::StrCat("Nodes = ", cur));
+  SetBenchmarkItemsProcessed(cur * static_cast<int64>(iters));
+#endif  // PLATFORM_GOOGLE
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr, executor_type)
+      .Run(iters);
+}
+
+static void BM_executor_wide(int iters, int width) {
+  BM_executor_fanout_chain(iters, width, 1, "");
+}
+static void BM_workstealing_executor_wide(int iters, int width) {
+  BM_executor_fanout_chain(iters, width, 1, "WORK_STEALING");
+}
+BENCHMARK(BM_executor_wide)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_workstealing_executor_wide)->Arg(1024)->Arg(8192);
+
+static void BM_executor_narrow(int iters, int depth) {
+  BM_executor_fanout_chain(iters, 2, depth, "");
+}
+static void BM_workstealing_executor_narrow(int iters, int depth) {
+  BM_executor_fanout_chain(iters, 2, depth, "WORK_STEALING");
+}
+BENCHMARK(BM_executor_narrow)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_workstealing_executor_narrow)->Arg(1024)->Arg(8192);
+
+static void BM_executor_deep_chain(int iters, int depth) {
+  BM_executor_fanout_chain(iters, 0, depth, "");
+}
+static void BM_workstealing_executor_deep_chain(int iters, int depth) {
+  BM_executor_fanout_chain(iters, 0, depth, "WORK_STEALING");
+}
+BENCHMARK(BM_executor_deep_chain)->Arg(1024)->Arg(8192);
+BENCHMARK(BM_workstealing_executor_deep_chain)->Arg(1024)->Arg(8192);
+
 static void BM_FeedInputFetchOutput(int iters) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
@@ -53,6 +53,12 @@ static constexpr const char* const kNodeLabel = "Func";
 static constexpr const char* const kFuncAttr =
     FunctionLibraryDefinition::kFuncAttr;
 
+// Functions on CPU with at most this many nodes are run on the calling thread
+// by the single-threaded executor, unless an executor type is requested.
+static constexpr int kMaxSingleThreadedFunctionNodes = 32;
+// The number of idle call states kept for reuse per function handle.
+static constexpr int kMaxIdleRunStates = 16;
+
 // Represents the index-th output of a node.
 struct Endpoint {
   Node* node;
@@ -208,16 +214,31 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
 
   int next_handle_ GUARDED_BY(mu_);
 
+  // The state of a local call of a function, which is recycled across the
+  // calls of the same handle to save allocating it on every call.
+  struct RunState {
+    RunState(DataTypeSlice arg_types, DataTypeSlice ret_types)
+        : frame(arg_types, ret_types) {}
+    Executor::Args exec_args;
+    FunctionCallFrame frame;
+  };
+
   // The instantiated and transformed function is encoded as a Graph
   // object, and an executor is created for the graph.
   struct Item {
     uint64 instantiation_counter = 0;
-    const Graph* graph = nullptr;                            // Owned by exec.
+    const Graph* graph = nullptr;  // Owned by exec, or by owned_graph.
+    // Set if exec does not keep its graph.
+    std::unique_ptr<const Graph> owned_graph;
     const FunctionLibraryDefinition* overlay_lib = nullptr;  // Not owned.
     FunctionBody* func_graph = nullptr;
     Executor* exec = nullptr;
     string executor_type;
 
+    mutex run_states_mu;
+    std::vector<std::unique_ptr<RunState>> idle_run_states
+        GUARDED_BY(run_states_mu);
+
     ~Item() {
       delete this->func_graph;
       delete this->exec;
@@ -235,6 +256,12 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
                            FunctionBody** fbody);
   Status CreateItem(Handle handle, Item** item);
   Status GetOrCreateItem(Handle handle, Item** item);
+  // Returns whether `g` is small enough to run on the single-threaded
+  // executor.
+  bool IsSmallFunctionGraph(const Graph& g);
+  RunState* GetRunState(Item* item);
+  void ReleaseRunState(Item* item, RunState* state);
+  void FillExecutorArgs(const Options& run_opts, Executor::Args* exec_args);
   Status InstantiateSymbolicGradient(const NameAttrList& func,
                                      const FunctionLibraryDefinition* lib_def,
                                      FunctionBody** g_body);
@@ -662,18 +689,90 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Handle handle, Item** item) {
   };
   Graph* graph = g.get();
   std::unique_ptr<Executor> exec;
-  TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, std::move(g), &exec));
+  std::unique_ptr<const Graph> owned_graph;
+  if (executor_type.empty() && IsSmallFunctionGraph(*graph)) {
+    // The single-threaded executor does not keep the graph, and rejects
+    // graphs it cannot run (e.g. with asynchronous kernels), which are then
+    // run by the default executor.
+    std::unique_ptr<Graph> copy(new Graph(lib_def));
+    CopyGraph(*graph, copy.get());
+    Status s = NewExecutor("SINGLE_THREADED_EXECUTOR", params,
+                           std::move(copy), &exec);
+    if (s.ok()) {
+      owned_graph = std::move(g);
+    } else {
+      VLOG(2) << "Running function on the default executor: " << s;
+    }
+  }
+  if (exec == nullptr) {
+    TF_RETURN_IF_ERROR(
+        NewExecutor(executor_type, params, std::move(g), &exec));
+  }
   {
     // Guard item since it is already inserted in items_.
     mutex_lock l(mu_);
     if ((*item)->exec == nullptr) {
       (*item)->graph = graph;
+      (*item)->owned_graph = std::move(owned_graph);
       (*item)->exec = exec.release();
     }
   }
   return Status::OK();
 }
 
+bool FunctionLibraryRuntimeImpl::IsSmallFunctionGraph(const Graph& g) {
+  if (device_->device_type() != DEVICE_CPU ||
+      g.num_op_nodes() > kMaxSingleThreadedFunctionNodes) {
+    return false;
+  }
+  for (const Node* n : g.op_nodes()) {
+    if (n->IsControlFlow() || n->IsSend() || n->IsRecv() ||
+        n->IsCollective()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FunctionLibraryRuntimeImpl::RunState* FunctionLibraryRuntimeImpl::GetRunState(
+    Item* item) {
+  {
+    mutex_lock l(item->run_states_mu);
+    if (!item->idle_run_states.empty()) {
+      RunState* state = item->idle_run_states.back().release();
+      item->idle_run_states.pop_back();
+      return state;
+    }
+  }
+  const FunctionBody* fbody = item->func_graph;
+  return new RunState(fbody->arg_types, fbody->ret_types);
+}
+
+void FunctionLibraryRuntimeImpl::ReleaseRunState(Item* item,
+                                                 RunState* state) {
+  // Drop the references to the tensors and closures of the call.
+  state->frame.Clear();
+  state->exec_args = Executor::Args();
+  mutex_lock l(item->run_states_mu);
+  if (item->idle_run_states.size() < kMaxIdleRunStates) {
+    item->idle_run_states.emplace_back(state);
+  } else {
+    delete state;
+  }
+}
+
+void FunctionLibraryRuntimeImpl::FillExecutorArgs(const Options& run_opts,
+                                                  Executor::Args* exec_args) {
+  // Inherit the step_id from the caller.
+  exec_args->step_id = run_opts.step_id;
+  exec_args->rendezvous = run_opts.rendezvous;
+  exec_args->stats_collector = run_opts.stats_collector;
+  exec_args->cancellation_manager = run_opts.cancellation_manager;
+  exec_args->collective_executor = run_opts.collective_executor;
+  exec_args->step_container = run_opts.step_container;
+  exec_args->runner = *run_opts.runner;
+}
+
 Status FunctionLibraryRuntimeImpl::GetOrCreateItem(Handle handle, Item** item) {
   LocalHandle local_handle = parent_->GetHandleOnDevice(device_name_, handle);
   {
@@ -804,53 +903,41 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
   DCHECK(run_opts.runner != nullptr);
 
-  Executor::Args* exec_args = new Executor::Args;
-  // Inherit the step_id from the caller.
-  exec_args->step_id = run_opts.step_id;
-  exec_args->rendezvous = run_opts.rendezvous;
-  exec_args->stats_collector = run_opts.stats_collector;
-  exec_args->cancellation_manager = run_opts.cancellation_manager;
-  exec_args->step_container = run_opts.step_container;
-  exec_args->runner = *run_opts.runner;
-  exec_args->collective_executor = run_opts.collective_executor;
-
   Item* item = nullptr;
   Status s = GetOrCreateItem(handle, &item);
   if (!s.ok()) {
-    delete exec_args;
     done(s);
     return;
   }
 
   if (run_opts.remote_execution) {
+    Executor::Args* exec_args = new Executor::Args;
+    FillExecutorArgs(run_opts, exec_args);
     // NOTE(mrry): `RunRemote()` will set `exec_args->call_frame` for us.
     RunRemote(run_opts, handle, args, rets, exec_args, item, done);
     return;
   }
 
-  const FunctionBody* fbody = GetFunctionBody(handle);
-  FunctionCallFrame* frame =
-      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
-  exec_args->call_frame = frame;
-  s = frame->SetArgs(args);
+  RunState* state = GetRunState(item);
+  FillExecutorArgs(run_opts, &state->exec_args);
+  state->exec_args.call_frame = &state->frame;
+  s = state->frame.SetArgs(args);
   if (!s.ok()) {
-    delete frame;
-    delete exec_args;
+    ReleaseRunState(item, state);
     done(s);
     return;
   }
 
   item->exec->RunAsync(
       // Executor args
-      *exec_args,
+      state->exec_args,
       // Done callback.
-      [frame, rets, done, exec_args](const Status& status) {
+      [this, item, state, rets, done](const Status& status) {
         Status s = status;
         if (s.ok()) {
-          s = frame->ConsumeRetvals(rets);
+          s = state->frame.ConsumeRetvals(rets);
         }
-        delete frame;
-        delete exec_args;
+        ReleaseRunState(item, state);
         done(s);
       });
 }
@@ -894,26 +981,19 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
   DCHECK(run_opts.runner != nullptr);
 
-  Executor::Args* exec_args = new Executor::Args;
-  // Inherit the step_id from the caller.
-  exec_args->step_id = run_opts.step_id;
-  exec_args->rendezvous = run_opts.rendezvous;
-  exec_args->stats_collector = run_opts.stats_collector;
-  exec_args->cancellation_manager = run_opts.cancellation_manager;
-  exec_args->collective_executor = run_opts.collective_executor;
-  exec_args->step_container = run_opts.step_container;
-  exec_args->runner = *run_opts.runner;
-  exec_args->call_frame = frame;
+  RunState* state = GetRunState(item);
+  FillExecutorArgs(run_opts, &state->exec_args);
+  state->exec_args.call_frame = frame;
 
   item->exec->RunAsync(
       // Executor args
-      *exec_args,
+      state->exec_args,
       // Done callback.
       std::bind(
-          [item, frame, exec_args](DoneCallback done,
-                                   // Start unbound arguments.
-                                   const Status& status) {
-            delete exec_args;
+          [this, item, state](DoneCallback done,
+                              // Start unbound arguments.
+                              const Status& status) {
+            ReleaseRunState(item, state);
             done(status);
           },
           std::move(done), std::placeholders::_1));
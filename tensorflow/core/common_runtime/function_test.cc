@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph_constructor.h"
@@ -42,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/equal_graph_def.h"
@@ -164,12 +166,8 @@ class FunctionLibraryRuntimeTest : public ::testing::Test {
              FunctionLibraryRuntime::Options opts,
              const std::vector<Tensor>& args, std::vector<Tensor*> rets,
              bool add_runner = true) {
-    std::atomic<int32> call_count(0);
     std::function<void(std::function<void()>)> runner =
-        [&call_count](std::function<void()> fn) {
-          ++call_count;
-          test::function::FunctionTestSchedClosure(fn);
-        };
+        test::function::FunctionTestSchedClosure;
     if (add_runner) {
       opts.runner = &runner;
     } else {
@@ -191,10 +189,6 @@ class FunctionLibraryRuntimeTest : public ::testing::Test {
       *rets[i] = out[i];
     }
 
-    if (add_runner) {
-      EXPECT_GE(call_count, 1);  // Test runner is used.
-    }
-
     return Status::OK();
   }
 
@@ -250,12 +244,8 @@ class FunctionLibraryRuntimeTest : public ::testing::Test {
   Status Run(FunctionLibraryRuntime* flr, FunctionLibraryRuntime::Handle handle,
              FunctionLibraryRuntime::Options opts, CallFrameInterface* frame,
              bool add_runner = true) {
-    std::atomic<int32> call_count(0);
     std::function<void(std::function<void()>)> runner =
-        [&call_count](std::function<void()> fn) {
-          ++call_count;
-          test::function::FunctionTestSchedClosure(fn);
-        };
+        test::function::FunctionTestSchedClosure;
     if (add_runner) {
       opts.runner = &runner;
     } else {
@@ -273,10 +263,6 @@ class FunctionLibraryRuntimeTest : public ::testing::Test {
       return status;
     }
 
-    if (add_runner) {
-      EXPECT_GE(call_count, 1);  // Test runner is used.
-    }
-
     return Status::OK();
   }
 
@@ -595,6 +581,68 @@ TEST_F(FunctionLibraryRuntimeTest, ExecutorFactory) {
   }
 }
 
+// Runs `handle` of `flr` on x with a runner that counts its calls.
+int RunAndCountRunnerCalls(FunctionLibraryRuntime* flr,
+                           FunctionLibraryRuntime::Handle handle,
+                           const Tensor& x, Tensor* y,
+                           StepStatsCollector* stats_collector = nullptr) {
+  std::atomic<int32> call_count(0);
+  std::function<void(std::function<void()>)> runner =
+      [&call_count](std::function<void()> fn) {
+        ++call_count;
+        test::function::FunctionTestSchedClosure(fn);
+      };
+  FunctionLibraryRuntime::Options opts;
+  opts.runner = &runner;
+  opts.stats_collector = stats_collector;
+  Notification done;
+  std::vector<Tensor> out;
+  flr->Run(opts, handle, {x}, &out, [&done](const Status& s) {
+    TF_EXPECT_OK(s);
+    done.Notify();
+  });
+  done.WaitForNotification();
+  CHECK_EQ(1, out.size());
+  *y = out[0];
+  return call_count;
+}
+
+TEST_F(FunctionLibraryRuntimeTest, SmallFunctionRunsOnCallerThread) {
+  Init({test::function::XTimesTwo()});
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+
+  // The default executor schedules the function's nodes on the runner.
+  {
+    FunctionLibraryRuntime::InstantiateOptions options;
+    options.executor_type = "DEFAULT";
+    FunctionLibraryRuntime::Handle handle;
+    TF_CHECK_OK(
+        Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options, &handle));
+    EXPECT_GE(RunAndCountRunnerCalls(flr0_, handle, x, &y), 1);
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  }
+
+  // Without an explicit executor type, the small function runs on the
+  // calling thread, also when it is called repeatedly.
+  {
+    FunctionLibraryRuntime::Handle handle;
+    TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &handle));
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(0, RunAndCountRunnerCalls(flr0_, handle, x, &y));
+      test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+    }
+
+    // Its nodes are still traced.
+    StepStats stats;
+    StepStatsCollector stats_collector(&stats);
+    RunAndCountRunnerCalls(flr0_, handle, x, &y, &stats_collector);
+    stats_collector.Finalize();
+    ASSERT_EQ(1, stats.dev_stats_size());
+    EXPECT_GT(stats.dev_stats(0).node_stats_size(), 0);
+  }
+}
+
 TEST_F(FunctionLibraryRuntimeTest, ExpandInlineFunctions) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour(),
         test::function::XTimes16()});
@@ -1668,5 +1716,48 @@ TEST(OptimizationTest, RemoveListArrayConverter_WithContolDeps) {
   TF_EXPECT_GRAPH_EQ(expected, Optimize(remove_listarray_and_identity, func));
 }
 
+// Calls a small function repeatedly, on the default executor if
+// `default_executor`, and otherwise on the executor chosen for it.
+void BM_RunSmallFunction(int iters, int default_executor) {
+  testing::StopTiming();
+  std::vector<Device*> devices;
+  TF_CHECK_OK(DeviceFactory::AddDevices(
+      SessionOptions(), "/job:localhost/replica:0/task:0", &devices));
+  DeviceMgr device_mgr(devices);
+  FunctionDefLibrary proto;
+  *proto.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+  thread::ThreadPool pool(Env::Default(), "BM_RunSmallFunction", 4);
+  ProcessFunctionLibraryRuntime pflr(&device_mgr, Env::Default(),
+                                     TF_GRAPH_DEF_VERSION, &lib_def,
+                                     OptimizerOptions(), &pool, nullptr);
+  FunctionLibraryRuntime* flr =
+      pflr.GetFLR("/job:localhost/replica:0/task:0/cpu:0");
+  FunctionLibraryRuntime::InstantiateOptions instantiate_options;
+  if (default_executor) {
+    instantiate_options.executor_type = "DEFAULT";
+  }
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(flr->Instantiate("XTimesTwo",
+                               test::function::Attrs({{"T", DT_FLOAT}}),
+                               instantiate_options, &handle));
+
+  const Tensor x = test::AsTensor<float>({1, 2, 3, 4});
+  std::vector<Tensor> rets;
+  FunctionLibraryRuntime::Options opts;
+  testing::ItemsProcessed(static_cast<int64>(iters));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Notification done;
+    flr->Run(opts, handle, {x}, &rets, [&done](const Status& s) {
+      TF_CHECK_OK(s);
+      done.Notify();
+    });
+    done.WaitForNotification();
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_RunSmallFunction)->Arg(0)->Arg(1);
+
 }  // namespace
 }  // namespace tensorflow
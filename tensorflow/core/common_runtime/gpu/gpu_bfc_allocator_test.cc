@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
+#include <stdlib.h>
+
 #include <algorithm>
 #include <vector>
 
@@ -263,6 +265,27 @@ TEST(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   LOG(INFO) << "Alloc stats: \n" << stats.DebugString();
 }
 
+TEST(GPUBFCAllocatorTest, ReleasesFreeRegionsWithGrowth) {
+  GPUOptions options;
+  options.set_allow_growth(true);
+
+  // Max of 64MiB, but starts out small.
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 26, options, "GPU_0_bfc");
+
+  // Grows a 32MiB region, which is then entirely free.
+  void* first = a.AllocateRaw(1, 1 << 25);
+  ASSERT_NE(nullptr, first);
+  a.DeallocateRaw(first);
+
+  // Neither the free region nor the remaining 32MiB can hold 48MiB: only
+  // succeeds once the free region has been returned.
+  const size_t big_bytes = 3 << 24;
+  void* big = a.AllocateRaw(1, big_bytes);
+  ASSERT_NE(nullptr, big);
+  EXPECT_EQ(big_bytes, a.RequestedSize(big));
+  a.DeallocateRaw(big);
+}
+
 TEST(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   GPUBFCAllocator a(CudaGpuId(0), 1UL << 60, "GPU_0_bfc");
   GPUBFCAllocator b(CudaGpuId(0), 1UL << 60, "GPU_0_bfc");
@@ -272,6 +295,112 @@ TEST(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   b.DeallocateRaw(bmem);
 }
 
+// Enables the small-chunk caches for allocators constructed while in scope.
+class ScopedSmallChunkCaching {
+ public:
+  ScopedSmallChunkCaching() {
+    setenv("TF_BFC_ALLOCATOR_CACHE_SMALL_CHUNKS", "true", 1);
+  }
+  ~ScopedSmallChunkCaching() {
+    unsetenv("TF_BFC_ALLOCATOR_CACHE_SMALL_CHUNKS");
+  }
+};
+
+TEST(GPUBFCAllocatorTest, SmallChunkCacheReusesChunks) {
+  ScopedSmallChunkCaching caching;
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 30, "GPU_0_bfc");
+
+  void* p1 = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(1000, a.RequestedSize(p1));
+  const int64 id1 = a.AllocationId(p1);
+  a.DeallocateRaw(p1);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(1024, stats.bytes_in_caches);
+
+  // A request with the same rounded size is served from the cache.
+  void* p2 = a.AllocateRaw(1, 900);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(900, a.RequestedSize(p2));
+  EXPECT_GT(a.AllocationId(p2), id1);
+  a.GetStats(&stats);
+  EXPECT_EQ(2, stats.num_allocs);
+  EXPECT_EQ(1, stats.num_cache_hits);
+  EXPECT_EQ(1024, stats.bytes_in_use);
+  EXPECT_EQ(0, stats.bytes_in_caches);
+
+  // A different rounded size is not.
+  void* p3 = a.AllocateRaw(1, 2000);
+  EXPECT_NE(p2, p3);
+  a.GetStats(&stats);
+  EXPECT_EQ(1, stats.num_cache_hits);
+
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(GPUBFCAllocatorTest, SmallChunkCacheFlushedBeforeFailing) {
+  ScopedSmallChunkCaching caching;
+  // Configure a 1MiB byte limit
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 20, "GPU_0_bfc");
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 512; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1024));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_GT(stats.bytes_in_caches, 0);
+
+  // Only succeeds once the cached chunks have been coalesced.
+  void* big = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, big);
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_caches);
+  a.DeallocateRaw(big);
+}
+
+TEST(GPUBFCAllocatorTest, SmallChunkCacheThreaded) {
+  ScopedSmallChunkCaching caching;
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 30, "GPU_0_bfc");
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; t++) {
+      pool.Schedule([&a, t]() {
+        random::PhiloxRandom philox(123, t);
+        random::SimplePhilox rand(&philox);
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 10000; i++) {
+          if (ptrs.size() < 100 && rand.OneIn(2)) {
+            const size_t bytes = 1 + rand.Uniform(32 << 10);
+            void* p = a.AllocateRaw(1, bytes);
+            CHECK_EQ(bytes, a.RequestedSize(p));
+            ptrs.push_back(p);
+          } else if (!ptrs.empty()) {
+            a.DeallocateRaw(ptrs.back());
+            ptrs.pop_back();
+          }
+        }
+        for (void* p : ptrs) {
+          a.DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_GT(stats.num_cache_hits, 0);
+}
+
 static void BM_Allocation(int iters) {
   GPUBFCAllocator a(CudaGpuId(0), 1uLL << 33, "GPU_0_bfc");
   // Exercise a few different allocation sizes
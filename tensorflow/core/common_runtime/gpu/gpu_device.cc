@@ -263,12 +263,23 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
       sync_every_op_(sync_every_op),
       max_streams_(max_streams) {
   ProcessState::singleton()->EnableGPUDevice();
+  const int64 session_memory_limit_mb =
+      options.config.gpu_options().experimental().session_memory_limit_mb();
+  if (session_memory_limit_mb > 0) {
+    // The allocator of the GPU is shared by all the sessions.
+    quota_allocator_ =
+        new QuotaAllocator(gpu_allocator_, session_memory_limit_mb << 20);
+    gpu_allocator_ = quota_allocator_;
+  }
 }
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete gpu_device_info_;
   for (auto sb : scratch_) gpu_allocator_->DeallocateRaw(sb);
   for (auto ctx : device_contexts_) ctx->Unref();
+  if (quota_allocator_ != nullptr) {
+    quota_allocator_->Release();
+  }
 }
 
 Status BaseGPUDevice::Init(const SessionOptions& options) {
@@ -385,6 +396,7 @@ Status BaseGPUDevice::FillContextMap(const Graph* graph,
   const int64 before = Env::Default()->NowMicros();
   gpu_stream_util::AssignStreamsOpts opts;
   opts.max_streams = static_cast<int32>(num_streams);
+  opts.stateful_stream = 0;
   std::unordered_map<int, int> node_to_stream_id;
   TF_RETURN_IF_ERROR(
       gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
@@ -396,7 +408,7 @@ Status BaseGPUDevice::FillContextMap(const Graph* graph,
   device_context_map->resize(graph->num_node_ids());
   for (Node* n : graph->nodes()) {
     auto mapped_stream = node_to_stream_id[n->id()];
-    CHECK_LE(mapped_stream, num_streams);
+    CHECK_LT(mapped_stream, num_streams);
     auto ctx = device_contexts_[mapped_stream];
     VLOG(3) << "Assigned stream " << node_to_stream_id[n->id()]
             << " ==> stream[" << ctx->stream_id() << "] for node id " << n->id()
@@ -438,6 +450,49 @@ string BaseGPUDevice::ComputeOpKernelDebugString(const OpKernel& op_kernel,
                          "]");
 }
 
+Status BaseGPUDevice::WaitForInputStreams(OpKernelContext* context,
+                                          se::Stream* stream, int stream_id) {
+  const bool vlog_2 = VLOG_IS_ON(2);
+  // If this op's device context is different from the other contexts,
+  // we must wait on the stream.
+  gtl::InlinedVector<se::Stream*, 4> waited_for;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    const GPUDeviceContext* idc =
+        static_cast<GPUDeviceContext*>(context->input_device_context(i));
+    if (idc == nullptr) {
+      return errors::Internal("Input device context ", i,
+                              " was not set properly.");
+    }
+    if (vlog_2) {
+      const void* base;
+      size_t len;
+      if (context->has_input(i)) {
+        if (IsRefType(context->input_dtype(i))) {
+          Tensor tensor = context->mutable_input(i, false);
+          base = DMAHelper::base(&tensor);
+          len = tensor.TotalBytes();
+        } else {
+          const Tensor& tensor = context->input(i);
+          base = DMAHelper::base(&tensor);
+          len = tensor.TotalBytes();
+        }
+        LOG(INFO) << "Input " << i << " " << base << "  " << len;
+        LOG(INFO) << "  stream[" << stream_id << "].ThenWaitFor(stream["
+                  << idc->stream_id() << "])"
+                  << ((idc->stream() == stream) ? " not needed" : "");
+      }
+    }
+    se::Stream* input_stream = idc->stream();
+    if (input_stream != stream &&
+        std::find(waited_for.begin(), waited_for.end(), input_stream) ==
+            waited_for.end()) {
+      stream->ThenWaitFor(input_stream);
+      waited_for.push_back(input_stream);
+    }
+  }
+  return Status::OK();
+}
+
 void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
                                   OpKernelContext* context) {
   GPUDeviceContext* gpu_device_context = device_contexts_[0];
@@ -449,7 +504,6 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
   const auto stream_id = gpu_device_context->stream_id();
 
   const bool vlog_1 = VLOG_IS_ON(1);
-  const bool vlog_2 = vlog_1 && VLOG_IS_ON(2);
 
   if (vlog_1) {
     VLOG(1) << "GpuDevice::ComputeHelper "
@@ -458,35 +512,7 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
 
   const auto num_streams = streams_.size();
   if (num_streams > 1) {
-    // If this op's device context is different from the other contexts,
-    // we must wait on the stream.
-    for (int i = 0; i < context->num_inputs(); ++i) {
-      const GPUDeviceContext* idc =
-          static_cast<GPUDeviceContext*>(context->input_device_context(i));
-      OP_REQUIRES(context, idc != nullptr,
-                  errors::Internal("Input device context ", i,
-                                   " was not set properly."));
-      if (vlog_2) {
-        const void* base;
-        size_t len;
-        if (context->has_input(i)) {
-          if (IsRefType(context->input_dtype(i))) {
-            Tensor tensor = context->mutable_input(i, false);
-            base = DMAHelper::base(&tensor);
-            len = tensor.TotalBytes();
-          } else {
-            const Tensor& tensor = context->input(i);
-            base = DMAHelper::base(&tensor);
-            len = tensor.TotalBytes();
-          }
-          LOG(INFO) << "Input " << i << " " << base << "  " << len;
-          LOG(INFO) << "  stream[" << stream_id << "].ThenWaitFor(stream["
-                    << idc->stream_id() << "])"
-                    << ((idc->stream() == stream) ? " not needed" : "");
-        }
-      }
-      if (idc->stream() != stream) stream->ThenWaitFor(idc->stream());
-    }
+    OP_REQUIRES_OK(context, WaitForInputStreams(context, stream, stream_id));
   }
   se::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
   op_kernel->Compute(context);
@@ -542,6 +568,11 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
           << op_kernel->type_string() << " on GPU" << tf_gpu_id_ << " stream["
           << stream_id << "]";
 
+  if (streams_.size() > 1) {
+    OP_REQUIRES_OK_ASYNC(
+        context, WaitForInputStreams(context, stream, stream_id), done);
+  }
+
   // When Xprof profiling is off (which is the default), constructing the
   // activity is simple enough that its overhead is negligible.
   tracing::ScopedActivity activity(op_kernel->name(), op_kernel->type_string(),
@@ -1077,12 +1108,20 @@ Status BaseGPUDeviceFactory::CreateGPUDevice(const SessionOptions& options,
   // different (which should be an error).
   //
   // TODO(laigd): report error if memory_limit doesn't match stats.bytes_limit.
+  int64 device_memory_limit = stats.bytes_limit;
+  const int64 session_memory_limit_mb =
+      options.config.gpu_options().experimental().session_memory_limit_mb();
+  if (session_memory_limit_mb > 0) {
+    device_memory_limit =
+        std::min(device_memory_limit, session_memory_limit_mb << 20);
+  }
   BaseGPUDevice* gpu_device = CreateGPUDevice(
-      options, device_name, static_cast<Bytes>(stats.bytes_limit), dev_locality,
+      options, device_name, static_cast<Bytes>(device_memory_limit),
+      dev_locality,
       tf_gpu_id, GetShortDeviceDescription(cuda_gpu_id, desc), gpu_allocator,
       process_state->GetCPUAllocator(numa_node));
   LOG(INFO) << "Created TensorFlow device (" << device_name << " with "
-            << (stats.bytes_limit >> 20) << " MB memory) -> physical GPU ("
+            << (device_memory_limit >> 20) << " MB memory) -> physical GPU ("
             << GetShortDeviceDescription(cuda_gpu_id, desc) << ")";
   TF_RETURN_IF_ERROR(gpu_device->Init(options));
   devices->push_back(gpu_device);
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/quota_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_base.h"
@@ -127,6 +128,9 @@ class BaseGPUDevice : public LocalDevice {
   gtl::InlinedVector<char*, 4> scratch_;
   std::vector<GPUDeviceContext*> device_contexts_;
   GpuDeviceInfo* gpu_device_info_ = nullptr;
+  // Wraps the GPU allocator if the session has a memory quota. Released in
+  // the destructor.
+  QuotaAllocator* quota_allocator_ = nullptr;
   mutex trace_mu_;
   TfGpuId tf_gpu_id_;
   const bool sync_every_op_ = false;
@@ -139,6 +143,11 @@ class BaseGPUDevice : public LocalDevice {
 
   void ComputeHelper(OpKernel* op_kernel, OpKernelContext* context);
 
+  // Makes 'stream' wait for the streams which produced the inputs of the op,
+  // once per stream, when they differ from it.
+  Status WaitForInputStreams(OpKernelContext* context, se::Stream* stream,
+                             int stream_id);
+
   string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                     const int& stream_id);
 
@@ -15,21 +15,37 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* event_mgr_pending_events = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/gpu_event_mgr/pending_events",
+    "The number of events queued by the EventMgr of a GPU that have not been "
+    "retired yet.",
+    "gpu");
+
+}  // namespace
+
 EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
     : exec_(se),
+      pending_events_cell_(event_mgr_pending_events->GetCell(
+          strings::StrCat(se->device_ordinal()))),
       deferred_bytes_threshold_(gpu_options.deferred_deletion_bytes()
                                     ? gpu_options.deferred_deletion_bytes()
                                     : 8 * 1048576),
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
-      accumulated_stream_(nullptr),
-      accumulated_tensors_(new TensorReferenceVector),
+      polling_spin_usecs_(
+          std::max(0, gpu_options.experimental().event_polling_spin_usecs())),
       accumulated_tensor_bytes_(0),
       // threadpool_ has 1 thread for the polling loop, and one to execute
       // event callback functions. Maybe we should have more?
@@ -44,10 +60,13 @@ EventMgr::~EventMgr() {
   for (auto& e : free_events_) {
     delete e;
   }
-  for (auto& t : *(accumulated_tensors_)) {
-    t.Unref();
+  for (auto& accumulated : accumulated_tensors_) {
+    if (accumulated.second == nullptr) continue;
+    for (auto& t : *accumulated.second) {
+      t.Unref();
+    }
+    delete accumulated.second;
   }
-  delete accumulated_tensors_;
   while (!used_events_.empty()) {
     InUse* ue = &used_events_[0];
     delete ue->event;
@@ -68,6 +87,7 @@ EventMgr::~EventMgr() {
     if (ue->func != nullptr) threadpool_.Schedule(ue->func);
     used_events_.pop_front();
   }
+  pending_events_cell_->Set(0);
 }
 
 void EventMgr::StartPollingLoop() {
@@ -95,16 +115,13 @@ void EventMgr::StopPollingLoop() {
 void EventMgr::ThenDeleteTensors(se::Stream* stream,
                                  const TensorReferenceVector& tensors) {
   mutex_lock l(mu_);
-  // TODO(jeff): We currently keep one accumulated_tensors_ object.
-  // If we start to use multiple streams heavily, we might want to keep
-  // separate vectors/byte counters per stream
-  if (!accumulated_tensors_->empty() && stream != accumulated_stream_) {
-    FlushAccumulatedTensors();
+  TensorReferenceVector*& accumulated = accumulated_tensors_[stream];
+  if (accumulated == nullptr) {
+    accumulated = new TensorReferenceVector;
   }
-  accumulated_stream_ = stream;
   for (const auto& t : tensors) {
     // accumulated_tensors_ takes over ownership of the reference to "t"
-    accumulated_tensors_->push_back(t);
+    accumulated->push_back(t);
     accumulated_tensor_bytes_ += t.TotalBytes();
   }
   if (accumulated_tensor_bytes_ >= deferred_bytes_threshold_) {
@@ -113,12 +130,12 @@ void EventMgr::ThenDeleteTensors(se::Stream* stream,
 }
 
 void EventMgr::FlushAccumulatedTensors() {
-  DCHECK(!accumulated_tensors_->empty());
-  DCHECK(accumulated_stream_ != nullptr);
-  QueueTensors(accumulated_stream_, accumulated_tensors_);
-  accumulated_tensors_ = new TensorReferenceVector;
+  for (auto& accumulated : accumulated_tensors_) {
+    if (accumulated.second == nullptr) continue;
+    QueueTensors(accumulated.first, accumulated.second);
+    accumulated.second = nullptr;
+  }
   accumulated_tensor_bytes_ = 0;
-  accumulated_stream_ = nullptr;
 }
 
 // A polling loop to detect completion of GPU events.
@@ -127,8 +144,13 @@ void EventMgr::FlushAccumulatedTensors() {
 // events are outstanding, we sleep until one is enqueued.
 void EventMgr::PollLoop() {
   ToFreeVector to_free;
+  // The last time events were retired or queued to an empty queue, and the
+  // current delay between polls, when polling_spin_usecs_ is positive.
+  uint64 last_activity_micros = 0;
+  int32 delay_usecs = 1;
   while (true) {
     bool events_still_pending;
+    bool woken = false;
     {
       mutex_lock l(mu_);
       if (stop_polling_) {
@@ -136,16 +158,33 @@ void EventMgr::PollLoop() {
       }
       if (used_events_.empty()) {
         events_pending_.wait(l);
+        woken = true;
       }
       PollEvents(true, &to_free);
       events_still_pending = !used_events_.empty();
     }
+    const bool retired_events = !to_free.empty();
     FreeMemory(to_free);
     to_free.clear();
 
-    if (events_still_pending) {
+    if (!events_still_pending) {
+      continue;
+    }
+    if (polling_spin_usecs_ <= 0) {
       Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+      continue;
+    }
+    const uint64 now_micros = Env::Default()->NowMicros();
+    if (woken || retired_events) {
+      last_activity_micros = now_micros;
+      delay_usecs = 1;
+    }
+    if (now_micros - last_activity_micros <
+        static_cast<uint64>(polling_spin_usecs_)) {
+      continue;
     }
+    Env::Default()->SleepForMicroseconds(delay_usecs);
+    delay_usecs = std::min(2 * delay_usecs, polling_active_delay_usecs_);
   }
   polling_stopped_->Notify();
 }
@@ -165,6 +204,7 @@ void EventMgr::QueueInUse(se::Stream* stream, InUse iu) {
   iu.event = e;
   bool was_empty = used_events_.empty();
   used_events_.push_back(iu);
+  pending_events_cell_->Set(used_events_.size());
   // Maybe wake up the polling thread
   if (was_empty) events_pending_.notify_all();
 }
@@ -226,6 +266,7 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
       break;
     }
   }
+  pending_events_cell_->Set(used_events_.size());
 }
 
 }  // namespace tensorflow
@@ -17,13 +17,16 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_EVENT_MGR_H_
 
 #include <deque>
+#include <functional>
 #include <vector>
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -87,11 +90,15 @@ class EventMgr {
  private:
   friend class TEST_EventMgrHelper;
   se::StreamExecutor* const exec_;
+  // Exports the length of used_events_.
+  monitoring::GaugeCell<int64>* const pending_events_cell_;
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
+  const int32 polling_spin_usecs_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
 
+  // Queues the tensors accumulated on every stream for deletion.
   void FlushAccumulatedTensors() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   struct InUse {
@@ -104,6 +111,7 @@ class EventMgr {
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
 
   void FreeMemory(const ToFreeVector& to_free) {
+    std::vector<std::function<void()>> funcs;
     for (const auto& iu : to_free) {
       if (iu.mem != nullptr) {
         for (auto& t : *(iu.mem)) {
@@ -119,8 +127,20 @@ class EventMgr {
         }
         iu.bufrec.alloc->DeallocateRaw(iu.bufrec.buf);
       }
-      // The function must be called in another thread.
-      if (iu.func != nullptr) threadpool_.Schedule(iu.func);
+      if (iu.func != nullptr) funcs.push_back(iu.func);
+    }
+    // The functions must be called in another thread. They are called in
+    // order by a single closure, rather than scheduled one at a time.
+    if (funcs.size() == 1) {
+      threadpool_.Schedule(std::move(funcs[0]));
+    } else if (!funcs.empty()) {
+      auto* batch = new std::vector<std::function<void()>>(std::move(funcs));
+      threadpool_.Schedule([batch]() {
+        for (const auto& func : *batch) {
+          func();
+        }
+        delete batch;
+      });
     }
   }
 
@@ -154,7 +174,8 @@ class EventMgr {
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // An internal polling loop that runs at a low frequency to clear
-  // straggler Events.
+  // straggler Events. If polling_spin_usecs_ is positive, it polls without
+  // sleeping for that long after each sign of activity, then backs off.
   void PollLoop();
 
   // Setup/Teardown functions for the polling loop.
@@ -164,9 +185,12 @@ class EventMgr {
   // A stack of unused events
   std::vector<se::Event*> free_events_ GUARDED_BY(mu_);
 
-  // Buffered list of tensors waiting to have an event queued for deletion
-  se::Stream* accumulated_stream_ GUARDED_BY(mu_);
-  TensorReferenceVector* accumulated_tensors_ GUARDED_BY(mu_);
+  // Buffered lists of tensors waiting to have an event queued for deletion,
+  // one per stream, so that a device running ops on several streams does not
+  // queue an event each time consecutive ops run on different streams. Null
+  // lists are empty.
+  gtl::FlatMap<se::Stream*, TensorReferenceVector*> accumulated_tensors_
+      GUARDED_BY(mu_);
   // Sum of the TotalBytes() of the tensors in "accumulated_tensors_"
   int64 accumulated_tensor_bytes_ GUARDED_BY(mu_);
 
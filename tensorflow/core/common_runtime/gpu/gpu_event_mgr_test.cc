@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <atomic>
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -181,7 +182,7 @@ TEST(EventMgr, ManySmallTensorsFlushedImmediately) {
   }
 }
 
-TEST(EventMgr, StreamSwitchingFlushesImmediately) {
+TEST(EventMgr, StreamSwitchingKeepsAccumulating) {
   auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
   EventMgr em(stream_exec, GPUOptions());
   TEST_EventMgrHelper th(&em);
@@ -190,17 +191,25 @@ TEST(EventMgr, StreamSwitchingFlushesImmediately) {
   std::unique_ptr<se::Stream> stream2(new se::Stream(stream_exec));
   stream1->Init();
   stream2->Init();
-  TensorReferenceVector v1;
-  AddTensorReference(&v1, 1024);
-  em.ThenDeleteTensors(stream1.get(), v1);
-
-  TensorReferenceVector v2;
-  AddTensorReference(&v2, 1024);
-  int64 initial_live_bytes = live_tensor_bytes;
-  em.ThenDeleteTensors(stream2.get(), v2);
-  th.PollEvents(false);  // Ensure things get registered to be freed by Poll
-  // Different stream should cause first tensor to get deleted
-  EXPECT_GT(initial_live_bytes, live_tensor_bytes);
+  for (int i = 0; i < 3; ++i) {
+    TensorReferenceVector v1;
+    AddTensorReference(&v1, 1024);
+    em.ThenDeleteTensors(stream1.get(), v1);
+    TensorReferenceVector v2;
+    AddTensorReference(&v2, 1024);
+    em.ThenDeleteTensors(stream2.get(), v2);
+  }
+  // Switching streams does not queue any event.
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(6 * 1024, live_tensor_bytes);
+
+  // Reaching the threshold queues one event per stream.
+  TensorReferenceVector v;
+  AddTensorReference(&v, 100 * 1048576);
+  em.ThenDeleteTensors(stream1.get(), v);
+  EXPECT_EQ(2, th.queue_size());
+  th.PollEvents(false);
+  EXPECT_EQ(0, live_tensor_bytes);
 }
 
 TEST(EventMgr, ManySmallTensorsSeparateCallsFlushed) {
@@ -243,6 +252,24 @@ TEST(EventMgr, NonEmptyShutdown) {
   }
 }
 
+// With spin polling, the polling loop runs every callback queued behind
+// pending events.
+TEST(EventMgr, SpinPollingRunsAllCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_polling_spin_usecs(100);
+  EventMgr em(stream_exec, gpu_options);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  const int kNumCallbacks = 100;
+  BlockingCounter counter(kNumCallbacks);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&counter]() { counter.DecrementCount(); });
+  }
+  counter.Wait();
+}
+
 }  // namespace
 }  // namespace tensorflow
 
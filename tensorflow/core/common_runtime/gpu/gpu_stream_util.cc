@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -27,6 +28,28 @@ limitations under the License.
 namespace tensorflow {
 namespace gpu_stream_util {
 
+namespace {
+
+// Returns true if the node may read or write state, or must run after a node
+// which does.
+bool AccessesState(const Node* n) {
+  if (n->op_def().is_stateful()) return true;
+  for (const Edge* e : n->in_edges()) {
+    if (e->IsControlEdge()) {
+      if (!e->src()->IsSource()) return true;
+    } else {
+      const DataType dtype = e->src()->output_type(e->src_output());
+      if (IsRefType(dtype) || dtype == DT_RESOURCE) return true;
+    }
+  }
+  for (DataType dtype : n->output_types()) {
+    if (IsRefType(dtype) || dtype == DT_RESOURCE) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
                      std::unordered_map<int, int>* node_to_stream_id) {
   VLOG(1) << "AssignStreams";
@@ -42,7 +65,8 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
   if ((opts.max_streams < 1) || (opts.send_stream >= opts.max_streams) ||
       (opts.recv_stream >= opts.max_streams) ||
       (opts.const_stream >= opts.max_streams) ||
-      (opts.compute_stream >= opts.max_streams)) {
+      (opts.compute_stream >= opts.max_streams) ||
+      (opts.stateful_stream >= opts.max_streams)) {
     status.Update(errors::InvalidArgument("Bad graph argument supplied."));
   }
   TF_RETURN_IF_ERROR(status);
@@ -95,6 +119,8 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
       if (opts.recv_stream >= 0) stream_id = opts.recv_stream;
     } else if (op == "Const") {
       if (opts.const_stream >= 0) stream_id = opts.const_stream;
+    } else if (opts.stateful_stream >= 0 && AccessesState(n)) {
+      stream_id = opts.stateful_stream;
     } else {
       if (opts.compute_stream >= 0) stream_id = opts.compute_stream;
     }
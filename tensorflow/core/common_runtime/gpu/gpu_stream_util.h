@@ -32,6 +32,11 @@ struct AssignStreamsOpts {
   int32 recv_stream = -1;
   int32 const_stream = -1;
   int32 compute_stream = -1;
+  // If not -1, the stream of the ops which access state: the stateful ops,
+  // the ops with ref or resource inputs or outputs, and the ops with control
+  // inputs. Keeping them on one stream preserves the order of their reads
+  // and writes, which the data edges alone do not express.
+  int32 stateful_stream = -1;
 };
 
 // Given the input graph, assigns every node in the graph with a
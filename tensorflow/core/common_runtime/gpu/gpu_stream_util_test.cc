@@ -144,5 +144,36 @@ TEST_F(GpuStreamUtilTest, StreamOverrides) {
   }
 }
 
+TEST_F(GpuStreamUtilTest, StatefulStream) {
+  auto root = Scope::DisabledShapeInferenceScope().ExitOnError();
+  Output var = ops::Variable(root.WithOpName("var"), {}, DT_FLOAT);
+  Output init = ops::Const(root.WithOpName("init"), 1.0f);
+  Output assign = ops::Assign(root.WithOpName("assign"), var, init);
+  Output read = ops::Identity(
+      root.WithOpName("read").WithControlDependencies({assign}), var);
+  Output a = ops::Const(root.WithOpName("a"), {{1.0f}});
+  Output b = ops::MatMul(root.WithOpName("b"), a, a);
+  Output c = ops::MatMul(root.WithOpName("c"), a, a);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&g));
+
+  std::unordered_map<int, int> node_to_stream_id;
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  opts.stateful_stream = 0;
+  TF_ASSERT_OK(gpu_stream_util::AssignStreams(&g, opts, &node_to_stream_id));
+
+  // The nodes accessing the variable share its stream. The independent
+  // branches use different streams.
+  std::unordered_map<string, int> stream_by_name;
+  for (Node* n : g.nodes()) {
+    stream_by_name[n->name()] = node_to_stream_id[n->id()];
+  }
+  EXPECT_EQ(0, stream_by_name["var"]);
+  EXPECT_EQ(0, stream_by_name["assign"]);
+  EXPECT_EQ(0, stream_by_name["read"]);
+  EXPECT_NE(stream_by_name["b"], stream_by_name["c"]);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,10 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu/pool_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -33,9 +41,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -111,6 +121,141 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+namespace {
+
+// Copies between pageable host memory and the GPU are staged through
+// pinned buffers of at most this size.
+const int64 kStagingChunkBytes = 4 << 20;
+
+// Returns true if a copy of 'num_bytes' from or to 'host_ptr' should be
+// staged: pageable memory cannot be DMAed directly, which makes the copy
+// run at a fraction of the bandwidth, and a device-to-host copy block the
+// calling thread until the stream is done.
+bool UseStagedCopy(const void* host_ptr, int64 num_bytes) {
+  static bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_GPU_STAGE_PAGEABLE_COPIES",
+                                   /*default_val=*/true, &enabled));
+    return enabled;
+  }();
+  return enabled && !CUDAHostAllocator::IsPinned(host_ptr, num_bytes);
+}
+
+// Returns the pool of pinned staging buffers for copies on 'stream_exec'.
+// Buffers are pooled by power-of-two size class, so that the chunks of
+// large copies and the buffers of small ones are all reused.
+Allocator* StagingAllocator(se::StreamExecutor* stream_exec) {
+  static mutex mu(LINKER_INITIALIZED);
+  static std::unordered_map<se::StreamExecutor*, Allocator*>* allocators =
+      new std::unordered_map<se::StreamExecutor*, Allocator*>;
+  mutex_lock l(mu);
+  Allocator*& allocator = (*allocators)[stream_exec];
+  if (allocator == nullptr) {
+    allocator = new PoolAllocator(
+        16 /*pool_size_limit*/, true /*auto_resize*/,
+        new CUDAHostAllocator(stream_exec), new Pow2Rounder, "cuda_staging");
+  }
+  return allocator;
+}
+
+// Copies between pageable host memory and the GPU in chunks, through two
+// pinned staging buffers used in turn: while the DMA of one chunk is in
+// flight, the next chunk is copied on the host to or from the other buffer.
+// Deletes itself once it calls 'done'.
+class StagedCopy {
+ public:
+  enum Direction { kHostToDevice, kDeviceToHost };
+
+  StagedCopy(Direction direction, void* host_ptr, void* device_ptr,
+             int64 total_bytes, se::Stream* stream, EventMgr* event_mgr,
+             std::function<void()> done)
+      : direction_(direction),
+        host_ptr_(static_cast<char*>(host_ptr)),
+        device_ptr_(static_cast<char*>(device_ptr)),
+        total_bytes_(total_bytes),
+        chunk_bytes_(std::min(total_bytes, kStagingChunkBytes)),
+        num_chunks_((total_bytes + chunk_bytes_ - 1) / chunk_bytes_),
+        stream_(stream),
+        event_mgr_(event_mgr),
+        staging_(StagingAllocator(stream->parent())),
+        done_(std::move(done)) {}
+
+  // Returns false, without doing anything, if no staging buffer could be
+  // allocated.
+  bool Start() {
+    const int num_buffers = std::min<int64>(2, num_chunks_);
+    for (int i = 0; i < num_buffers; ++i) {
+      void* buffer =
+          staging_->AllocateRaw(Allocator::kAllocatorAlignment, chunk_bytes_);
+      if (buffer == nullptr) break;
+      buffers_.push_back(static_cast<char*>(buffer));
+    }
+    if (buffers_.empty()) return false;
+    num_active_buffers_ = buffers_.size();
+    // Chunk i is staged through buffer i % buffers_.size().
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      CopyChunk(i);
+    }
+    return true;
+  }
+
+ private:
+  ~StagedCopy() {
+    for (char* buffer : buffers_) {
+      staging_->DeallocateRaw(buffer);
+    }
+  }
+
+  void CopyChunk(int64 chunk) {
+    char* buffer = buffers_[chunk % buffers_.size()];
+    const int64 offset = chunk * chunk_bytes_;
+    const int64 bytes = std::min(chunk_bytes_, total_bytes_ - offset);
+    DeviceMemoryBase device_mem(device_ptr_ + offset, bytes);
+    if (direction_ == kHostToDevice) {
+      memcpy(buffer, host_ptr_ + offset, bytes);
+      stream_->ThenMemcpy(&device_mem, buffer, bytes);
+      event_mgr_->ThenExecute(stream_, [this, chunk]() { ChunkDone(chunk); });
+    } else {
+      stream_->ThenMemcpy(buffer, device_mem, bytes);
+      event_mgr_->ThenExecute(stream_, [this, chunk, buffer, offset, bytes]() {
+        memcpy(host_ptr_ + offset, buffer, bytes);
+        ChunkDone(chunk);
+      });
+    }
+  }
+
+  void ChunkDone(int64 chunk) {
+    // The buffer of 'chunk' is free again.
+    const int64 next_chunk = chunk + buffers_.size();
+    if (next_chunk < num_chunks_ && stream_->ok()) {
+      CopyChunk(next_chunk);
+      return;
+    }
+    if (num_active_buffers_.fetch_sub(1) == 1) {
+      std::function<void()> done = std::move(done_);
+      delete this;
+      done();
+    }
+  }
+
+  const Direction direction_;
+  char* const host_ptr_;
+  char* const device_ptr_;
+  const int64 total_bytes_;
+  const int64 chunk_bytes_;
+  const int64 num_chunks_;
+  se::Stream* const stream_;
+  EventMgr* const event_mgr_;
+  Allocator* const staging_;
+  std::function<void()> done_;
+
+  std::vector<char*> buffers_;
+  // The number of buffers that still have chunks to copy.
+  std::atomic<int> num_active_buffers_{0};
+};
+
+}  // namespace
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -279,23 +424,30 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64 total_bytes = gpu_tensor->TotalBytes();
+  // Use of the input may outlive stack scope, so keep a ref.
+  TensorReference input_ref(*gpu_tensor);
+  auto copy_done = [send_device_to_host_stream, done, input_ref]() {
+    if (!send_device_to_host_stream->ok()) {
+      LOG(FATAL) << "GPU->CPU Memcpy failed";
+    }
+    input_ref.Unref();
+    done(Status::OK());
+  };
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     void* dst_ptr = GetBase(cpu_tensor);
+    if (UseStagedCopy(dst_ptr, total_bytes) &&
+        (new StagedCopy(StagedCopy::kDeviceToHost, dst_ptr, src_ptr,
+                        total_bytes, send_device_to_host_stream,
+                        dev_info->event_mgr, copy_done))
+            ->Start()) {
+      return;
+    }
+    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
   }
-  // Use of the input may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*gpu_tensor);
-  dev_info->event_mgr->ThenExecute(
-      send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
-        if (!send_device_to_host_stream->ok()) {
-          LOG(FATAL) << "GPU->CPU Memcpy failed";
-        }
-        input_ref.Unref();
-        done(Status::OK());
-      });
+  dev_info->event_mgr->ThenExecute(send_device_to_host_stream,
+                                   std::move(copy_done));
 }
 
 /*  static */
@@ -324,24 +476,31 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   recv_host_to_device_stream->ThenWaitFor(recv_stream);
 
   const int64 total_bytes = cpu_tensor->TotalBytes();
+  // Use of cpu_tensor may outlive stack scope, so keep a ref.
+  TensorReference input_ref(*cpu_tensor);
+  auto copy_done = [recv_host_to_device_stream, done, input_ref]() {
+    input_ref.Unref();
+    if (!recv_host_to_device_stream->ok()) {
+      LOG(FATAL) << "CPU->GPU Memcpy failed";
+    }
+    done(Status::OK());
+  };
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
+    if (UseStagedCopy(src_ptr, total_bytes) &&
+        (new StagedCopy(StagedCopy::kHostToDevice, src_ptr, dst_ptr,
+                        total_bytes, recv_host_to_device_stream,
+                        dev_info->event_mgr, copy_done))
+            ->Start()) {
+      return;
+    }
     DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
     recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
   }
-  // Use of cpu_tensor may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*cpu_tensor);
-  dev_info->event_mgr->ThenExecute(
-      recv_host_to_device_stream,
-      [recv_host_to_device_stream, done, input_ref]() {
-        input_ref.Unref();
-        if (!recv_host_to_device_stream->ok()) {
-          LOG(FATAL) << "CPU->GPU Memcpy failed";
-        }
-        done(Status::OK());
-      });
+  dev_info->event_mgr->ThenExecute(recv_host_to_device_stream,
+                                   std::move(copy_done));
 }
 
 Status GPUUtil::Sync(Device* gpu_device) {
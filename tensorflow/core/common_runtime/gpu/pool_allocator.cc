@@ -284,4 +284,41 @@ void PoolAllocator::AddFreeVisitor(Visitor visitor) {
   free_visitors_.push_back(visitor);
 }
 
+namespace {
+
+// The regions allocated by all CUDAHostAllocators, by start address.
+mutex pinned_regions_mu(LINKER_INITIALIZED);
+std::map<uintptr_t, size_t>* PinnedRegions()
+    EXCLUSIVE_LOCKS_REQUIRED(pinned_regions_mu) {
+  static std::map<uintptr_t, size_t>* regions =
+      new std::map<uintptr_t, size_t>;
+  return regions;
+}
+
+}  // namespace
+
+// static
+void CUDAHostAllocator::RegisterPinnedRegion(void* ptr, size_t num_bytes) {
+  mutex_lock l(pinned_regions_mu);
+  (*PinnedRegions())[reinterpret_cast<uintptr_t>(ptr)] = num_bytes;
+}
+
+// static
+void CUDAHostAllocator::UnregisterPinnedRegion(void* ptr) {
+  mutex_lock l(pinned_regions_mu);
+  PinnedRegions()->erase(reinterpret_cast<uintptr_t>(ptr));
+}
+
+// static
+bool CUDAHostAllocator::IsPinned(const void* ptr, size_t num_bytes) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr);
+  mutex_lock l(pinned_regions_mu);
+  std::map<uintptr_t, size_t>* regions = PinnedRegions();
+  // The last region that starts at or before 'ptr'.
+  auto it = regions->upper_bound(start);
+  if (it == regions->begin()) return false;
+  --it;
+  return start + num_bytes <= it->first + it->second;
+}
+
 }  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/common_runtime/visitable_allocator.h"
 #include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mem.h"
@@ -168,12 +169,27 @@ class Pow2Rounder : public RoundUpInterface {
 
 class BasicCPUAllocator : public SubAllocator {
  public:
+  // Memory is placed on 'numa_node' if it is not port::kNUMANoAffinity.
+  explicit BasicCPUAllocator(int numa_node = port::kNUMANoAffinity)
+      : numa_node_(numa_node) {}
   ~BasicCPUAllocator() override {}
 
   void* Alloc(size_t alignment, size_t num_bytes) override {
-    return port::AlignedMalloc(num_bytes, alignment);
+    if (numa_node_ == port::kNUMANoAffinity) {
+      return port::AlignedMalloc(num_bytes, alignment);
+    }
+    return port::NUMAMalloc(numa_node_, num_bytes, alignment);
+  }
+  void Free(void* ptr, size_t num_bytes) override {
+    if (numa_node_ == port::kNUMANoAffinity) {
+      port::AlignedFree(ptr);
+    } else {
+      port::NUMAFree(ptr, num_bytes);
+    }
   }
-  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+
+ private:
+  const int numa_node_;
 };
 
 // Allocator for pinned CPU RAM that is made known to CUDA for the
@@ -194,6 +210,8 @@ class CUDAHostAllocator : public SubAllocator {
       if (ptr == nullptr) {
         LOG(WARNING) << "could not allocate pinned host memory of size: "
                      << num_bytes;
+      } else {
+        RegisterPinnedRegion(ptr, num_bytes);
       }
     }
     return ptr;
@@ -201,11 +219,21 @@ class CUDAHostAllocator : public SubAllocator {
 
   void Free(void* ptr, size_t num_bytes) override {
     if (ptr != nullptr) {
+      UnregisterPinnedRegion(ptr);
       stream_exec_->HostMemoryDeallocate(ptr);
     }
   }
 
+  // Returns true if [ptr, ptr + num_bytes) lies within memory allocated by
+  // some CUDAHostAllocator, e.g. because it is the buffer of a tensor
+  // allocated with AllocatorAttributes::gpu_compatible(). Copies from and to
+  // such memory can be DMAed directly.
+  static bool IsPinned(const void* ptr, size_t num_bytes);
+
  private:
+  static void RegisterPinnedRegion(void* ptr, size_t num_bytes);
+  static void UnregisterPinnedRegion(void* ptr);
+
   se::StreamExecutor* stream_exec_;  // not owned, non-null
 
   TF_DISALLOW_COPY_AND_ASSIGN(CUDAHostAllocator);
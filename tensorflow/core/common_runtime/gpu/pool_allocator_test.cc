@@ -209,6 +209,23 @@ TEST(PoolAllocatorTest, Name) {
   EXPECT_EQ("pool", pool.Name());
 }
 
+TEST(PoolAllocatorTest, IsPinned) {
+  se::Platform* platform =
+      se::MultiPlatformManager::PlatformWithName("cuda").ValueOrDie();
+  CUDAHostAllocator allocator(
+      platform->GetExecutor(se::StreamExecutorConfig(/*ordinal=*/0))
+          .ValueOrDie());
+  char* pinned = static_cast<char*>(allocator.Alloc(64, 1024));
+  ASSERT_NE(nullptr, pinned);
+  EXPECT_TRUE(CUDAHostAllocator::IsPinned(pinned, 1024));
+  EXPECT_TRUE(CUDAHostAllocator::IsPinned(pinned + 512, 512));
+  EXPECT_FALSE(CUDAHostAllocator::IsPinned(pinned + 512, 1024));
+  char pageable[16];
+  EXPECT_FALSE(CUDAHostAllocator::IsPinned(pageable, sizeof(pageable)));
+  allocator.Free(pinned, 1024);
+  EXPECT_FALSE(CUDAHostAllocator::IsPinned(pinned, 1024));
+}
+
 }  // namespace
 }  // namespace tensorflow
 
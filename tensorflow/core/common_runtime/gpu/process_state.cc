@@ -177,13 +177,16 @@ Allocator* ProcessState::GetGPUAllocator(const GPUOptions& options,
 }
 
 Allocator* ProcessState::GetCPUAllocator(int numa_node) {
-  // Although we're temporarily ignoring numa_node, check for legality.
   CHECK_GE(numa_node, 0);
-  // TODO(tucker): actually maintain separate CPUAllocators for
-  // different numa_nodes.  For now, just one.
-  numa_node = 0;
+  if (!port::NUMAEnabled() || numa_node >= port::NUMANumNodes()) {
+    numa_node = 0;
+  }
   mutex_lock lock(mu_);
   while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
+    // Allocators are created for all nodes up to 'numa_node', each one
+    // placing its memory on its own node if NUMA is enabled.
+    const int node = port::NUMAEnabled() ? cpu_allocators_.size()
+                                         : port::kNUMANoAffinity;
     bool use_bfc_allocator = false;
     // TODO(reedwm): Switch default to BGFAllocator if it's at least as fast and
     // efficient.
@@ -203,7 +206,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
         LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
-      allocator = new BFCAllocator(new BasicCPUAllocator(), cpu_mem_limit,
+      allocator = new BFCAllocator(new BasicCPUAllocator(node), cpu_mem_limit,
                                    true /*allow_growth*/,
                                    "bfc_cpu_allocator_for_gpu" /*name*/);
       VLOG(2) << "Using BFCAllocator with memory limit of "
@@ -211,7 +214,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     } else {
       allocator = new PoolAllocator(
           100 /*pool_size_limit*/, true /*auto_resize*/,
-          new BasicCPUAllocator(), new NoopRounder, "cpu_pool");
+          new BasicCPUAllocator(node), new NoopRounder, "cpu_pool");
       VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator";
     }
     if (LogMemory::IsEnabled()) {
@@ -221,7 +224,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     }
     cpu_allocators_.push_back(allocator);
   }
-  return cpu_allocators_[0];
+  return cpu_allocators_[numa_node];
 }
 
 Allocator* ProcessState::GetCUDAHostAllocator(int numa_node) {
@@ -72,8 +72,9 @@ class ProcessState {
   // If we know nothing, it's called CPU 0 with no other attributes.
   MemDesc PtrType(const void* ptr);
 
-  // Returns the one CPUAllocator used for the given numa_node.
-  // TEMPORARY: ignores numa_node.
+  // Returns the one CPUAllocator used for the given numa_node, which
+  // places its memory on that node. Requests for any node share the
+  // allocator of node 0 if NUMA is not enabled.
   Allocator* GetCPUAllocator(int numa_node);
 
   // Returns the one GPU allocator used for the indexed GPU.
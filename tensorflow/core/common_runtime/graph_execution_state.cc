@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/placer.h"
+#include "tensorflow/core/common_runtime/setup_stats_collector.h"
 #include "tensorflow/core/framework/graph.pb_text.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -56,6 +58,7 @@ GraphExecutionState::GraphExecutionState(
     : stateful_placements_(options.stateful_placements),
       device_set_(options.device_set),
       session_options_(options.session_options),
+      setup_stats_(options.setup_stats),
       flib_def_(new FunctionLibraryDefinition(OpRegistry::Global(),
                                               graph_def->library())),
       graph_(nullptr) {
@@ -196,6 +199,7 @@ Status GraphExecutionState::Extend(
   combined_options.device_set = device_set_;
   combined_options.session_options = session_options_;
   combined_options.stateful_placements = stateful_placements_;
+  combined_options.setup_stats = setup_stats_;
 
   // NOTE(mrry): `gdef` is no longer valid after the constructor
   // executes.
@@ -293,15 +297,49 @@ Status GraphExecutionState::PruneGraph(
   const DeviceAttributes* device_info =
       &device_set_->client_device()->attributes();
   if (options.use_function_convention) {
+    // Fed and fetched tensors live on the client device, unless the callable
+    // names another device for them.
+    const auto endpoint_device_info =
+        [this, device_info](const protobuf::Map<string, string>& devices,
+                            const string& endpoint,
+                            const DeviceAttributes** out) {
+          auto it = devices.find(endpoint);
+          if (it == devices.end()) {
+            *out = device_info;
+            return Status::OK();
+          }
+          const Device* device = device_set_->FindDeviceByName(it->second);
+          if (device == nullptr) {
+            return errors::InvalidArgument("Tensor ", endpoint,
+                                           " was requested on unknown device ",
+                                           it->second);
+          }
+          *out = &device->attributes();
+          return Status::OK();
+        };
     for (int i = 0; i < options.callable_options.feed_size(); ++i) {
-      feed_rewrites.emplace_back(new subgraph::ArgFeedRewrite(
-          &options.callable_options.feed(i), device_info, i));
+      const string& feed = options.callable_options.feed(i);
+      const DeviceAttributes* feed_device_info;
+      TF_RETURN_IF_ERROR(endpoint_device_info(
+          options.callable_options.feed_devices(), feed, &feed_device_info));
+      feed_rewrites.emplace_back(
+          new subgraph::ArgFeedRewrite(&feed, feed_device_info, i));
     }
     for (int i = 0; i < options.callable_options.fetch_size(); ++i) {
-      fetch_rewrites.emplace_back(new subgraph::RetvalFetchRewrite(
-          &options.callable_options.fetch(i), device_info, i));
+      const string& fetch = options.callable_options.fetch(i);
+      const DeviceAttributes* fetch_device_info;
+      TF_RETURN_IF_ERROR(endpoint_device_info(
+          options.callable_options.fetch_devices(), fetch, &fetch_device_info));
+      fetch_rewrites.emplace_back(
+          new subgraph::RetvalFetchRewrite(&fetch, fetch_device_info, i));
     }
   } else {
+    if (!options.callable_options.feed_devices().empty() ||
+        !options.callable_options.fetch_devices().empty()) {
+      return errors::Unimplemented(
+          "Feed and fetch devices are only supported with the function "
+          "calling convention");
+    }
     for (const string& feed : options.callable_options.feed()) {
       feed_rewrites.emplace_back(
           new subgraph::RecvFeedRewrite(&feed, device_info));
@@ -360,7 +398,11 @@ Status GraphExecutionState::InitBaseGraph(const BuildGraphOptions& options) {
 
   std::unique_ptr<Graph> new_graph(new Graph(OpRegistry::Global()));
   GraphConstructorOptions opts;
-  TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(opts, *graph_def, new_graph.get()));
+  {
+    ScopedSetupTimer timer(setup_stats_, "graph_conversion");
+    TF_RETURN_IF_ERROR(
+        ConvertGraphDefToGraph(opts, *graph_def, new_graph.get()));
+  }
   for (const Node* n : new_graph->nodes()) {
     VLOG(2) << "Mapping " << n->name() << " to " << n->cost_id();
     node_name_to_cost_id_map_[n->name()] = n->cost_id();
@@ -368,6 +410,7 @@ Status GraphExecutionState::InitBaseGraph(const BuildGraphOptions& options) {
   if (session_options_ &&
       session_options_->config.graph_options().place_pruned_graph()) {
     // Rewrite the graph before placement.
+    ScopedSetupTimer timer(setup_stats_, "subgraph_rewrite");
     rewrite_metadata_.reset(new subgraph::RewriteGraphMetadata);
     TF_RETURN_IF_ERROR(
         PruneGraph(options, new_graph.get(), rewrite_metadata_.get()));
@@ -381,13 +424,17 @@ Status GraphExecutionState::InitBaseGraph(const BuildGraphOptions& options) {
   optimization_options.graph = &new_graph;
   optimization_options.flib_def = flib_def_.get();
   optimization_options.device_set = device_set_;
+  optimization_options.setup_stats = setup_stats_;
 
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::PRE_PLACEMENT, optimization_options));
 
-  Placer placer(new_graph.get(), device_set_, session_options_);
-  // TODO(mrry): Consider making the Placer cancelable.
-  TF_RETURN_IF_ERROR(placer.Run());
+  {
+    ScopedSetupTimer timer(setup_stats_, "placement");
+    Placer placer(new_graph.get(), device_set_, session_options_);
+    // TODO(mrry): Consider making the Placer cancelable.
+    TF_RETURN_IF_ERROR(placer.Run());
+  }
 
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::POST_PLACEMENT, optimization_options));
@@ -416,6 +463,24 @@ Status GraphExecutionState::OptimizeGraph(
     item.id = "tf_graph";
     graph_->ToGraphDef(&item.graph);
 
+    // Specialize the fed placeholders to the shapes they will be fed with,
+    // so that grappler can optimize for them.
+    std::unordered_map<string, const TensorShape*> feed_shapes;
+    for (const auto& feed_shape : options.feed_shapes) {
+      TensorId id = ParseTensorName(feed_shape.first);
+      if (id.second == 0) {
+        feed_shapes[id.first.ToString()] = &feed_shape.second;
+      }
+    }
+    if (!feed_shapes.empty()) {
+      for (NodeDef& node : *item.graph.mutable_node()) {
+        auto it = feed_shapes.find(node.name());
+        if (it != feed_shapes.end() && node.op() == "Placeholder") {
+          it->second->AsProto((*node.mutable_attr())["shape"].mutable_shape());
+        }
+      }
+    }
+
     item.fetch.insert(item.fetch.end(),
                       options.callable_options.fetch().begin(),
                       options.callable_options.fetch().end());
@@ -456,6 +521,10 @@ Status GraphExecutionState::OptimizeGraph(
           return errors::InvalidArgument("Missing node shape or type");
         }
         TensorShapeProto shape_proto(node.attr().at("shape").shape());
+        auto feed_shape = feed_shapes.find(node.name());
+        if (feed_shape != feed_shapes.end()) {
+          feed_shape->second->AsProto(&shape_proto);
+        }
         // If the shape of the placeholder value is only partially known, we're
         // free to use any dimension we want to feed the placeholder. We choose
         // 1 to minimize the memory impact. Note that this only matters if an
@@ -492,8 +561,19 @@ Status GraphExecutionState::OptimizeGraph(
     }
     grappler::VirtualCluster cluster(device_map, device_set_);
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
-        item, rewrite_options, cpu_device, &cluster, &new_graph));
+    std::vector<std::pair<string, int64>> optimizer_run_micros;
+    {
+      ScopedSetupTimer timer(options.setup_stats, "grappler");
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          item, rewrite_options, cpu_device, &cluster, &new_graph,
+          &optimizer_run_micros));
+    }
+    if (options.setup_stats != nullptr) {
+      for (const auto& optimizer : optimizer_run_micros) {
+        options.setup_stats->Record(
+            strings::StrCat("grappler/", optimizer.first), optimizer.second);
+      }
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -564,6 +644,7 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   subgraph::RewriteGraphMetadata rewrite_metadata;
   if (session_options_ == nullptr ||
       !session_options_->config.graph_options().place_pruned_graph()) {
+    ScopedSetupTimer timer(options.setup_stats, "subgraph_rewrite");
     TF_RETURN_IF_ERROR(
         PruneGraph(options, optimized_graph.get(), &rewrite_metadata));
   } else {
@@ -585,6 +666,7 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   optimization_options.graph = &optimized_graph;
   optimization_options.flib_def = optimized_flib.get();
   optimization_options.device_set = device_set_;
+  optimization_options.setup_stats = options.setup_stats;
 
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, optimization_options));
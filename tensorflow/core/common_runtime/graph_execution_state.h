@@ -33,6 +33,7 @@ limitations under the License.
 
 namespace tensorflow {
 struct SessionOptions;
+class SetupStatsCollector;
 
 namespace subgraph {
 struct RewriteGraphMetadata;
@@ -44,6 +45,9 @@ struct GraphExecutionStateOptions {
   // A map from node name to device name, representing the unchangeable
   // placement of stateful nodes.
   std::unordered_map<string, string> stateful_placements;
+  // If non-null, the wall time of each phase of building the base graph is
+  // recorded into it.
+  SetupStatsCollector* setup_stats = nullptr;  // Not owned.
 };
 
 // A ClientGraph is simply a sub-graph of the full graph as induced by
@@ -189,6 +193,7 @@ class GraphExecutionState {
   GraphDef original_graph_def_;            // Immutable after ctor.
   const DeviceSet* device_set_;            // Not owned
   const SessionOptions* session_options_;  // Not owned
+  SetupStatsCollector* setup_stats_;       // Not owned, may be null
 
   // Map from name to Node for the full graph in placed_.
   NodeNameToCostIdMap node_name_to_cost_id_map_;
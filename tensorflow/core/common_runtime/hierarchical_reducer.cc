@@ -0,0 +1,123 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+HierarchicalReducer::HierarchicalReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output)
+    : col_exec_(col_exec),
+      dev_mgr_(dev_mgr),
+      ctx_(ctx),
+      op_params_(op_params),
+      col_params_(col_params),
+      exec_key_(exec_key),
+      step_id_(step_id),
+      input_(input),
+      output_(output) {
+  CHECK(col_params_.instance.same_num_devices_per_task);
+  CHECK_GT(col_params_.group.num_tasks, 0);
+}
+
+/*static*/
+void HierarchicalReducer::Rings(const CollectiveParams& cp,
+                                std::vector<int>* task_ring,
+                                std::vector<int>* cross_task_ring) {
+  const int dev_per_task = cp.group.group_size / cp.group.num_tasks;
+  const int task_idx = cp.default_rank / dev_per_task;
+  const int dev_idx = cp.default_rank % dev_per_task;
+  task_ring->clear();
+  for (int di = 0; di < dev_per_task; ++di) {
+    task_ring->push_back(task_idx * dev_per_task + di);
+  }
+  cross_task_ring->clear();
+  for (int ti = 0; ti < cp.group.num_tasks; ++ti) {
+    cross_task_ring->push_back(ti * dev_per_task + dev_idx);
+  }
+}
+
+Status HierarchicalReducer::RunPhase(RingReducer* reducer) {
+  std::unique_ptr<RingReducer> owned(reducer);
+  Status status;
+  Notification note;
+  reducer->Run([&status, &note](const Status& s) {
+    status = s;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return status;
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+void HierarchicalReducer::Run(StatusCallback done) {
+  std::vector<int> task_ring;
+  std::vector<int> cross_task_ring;
+  Rings(col_params_, &task_ring, &cross_task_ring);
+  VLOG(1) << "HierarchicalReducer::Run for device "
+          << col_params_.instance.device_names[col_params_.default_rank]
+          << " default_rank " << col_params_.default_rank << " task ring "
+          << str_util::Join(task_ring, ",") << " cross-task ring "
+          << str_util::Join(cross_task_ring, ",");
+
+  // 1. Reduce-scatter within the task.  Afterwards this device holds the
+  // task-wide value of the chunk after its own rank.
+  Status s = RunPhase(new RingReducer(
+      col_exec_, dev_mgr_, ctx_, op_params_, col_params_,
+      strings::StrCat(exec_key_, ":rs"), step_id_, input_, output_, task_ring,
+      RingReducer::REDUCE_SCATTER, false /*finalize*/));
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // 2. All-reduce that chunk across tasks.  The devices at the same
+  // position in every task hold the same chunk, since the chunks are
+  // computed from the same output shape.
+  const int rank = col_params_.default_rank - task_ring.front();
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      output_, static_cast<int>(task_ring.size()),
+      ctx_->device()->GetAllocator(ctx_->output_alloc_attr(0))));
+  Tensor chunk = ca->ChunkAlias((rank + 1) % task_ring.size());
+  ca->ConsumeFinalValue(output_);
+  if (chunk.NumElements() > 0) {
+    s = RunPhase(new RingReducer(col_exec_, dev_mgr_, ctx_, op_params_,
+                                 col_params_, strings::StrCat(exec_key_, ":ar"),
+                                 step_id_, &chunk, &chunk, cross_task_ring,
+                                 RingReducer::ALL_PASSES, true /*finalize*/));
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+  }
+
+  // 3. All-gather within the task.
+  done(RunPhase(new RingReducer(
+      col_exec_, dev_mgr_, ctx_, op_params_, col_params_,
+      strings::StrCat(exec_key_, ":ag"), step_id_, output_, output_,
+      task_ring, RingReducer::ALL_GATHER, false /*finalize*/)));
+}
+
+}  // namespace tensorflow
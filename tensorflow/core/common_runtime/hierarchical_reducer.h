@@ -0,0 +1,72 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <vector>
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class DeviceMgr;
+
+// Two-level implementation of collective all-reduce for groups whose
+// devices are spread evenly over several tasks.  It runs three phases of
+// the ring algorithm:
+//   1. a reduce-scatter over the ring of the devices of each task, after
+//      which each device holds the task-wide value of one chunk,
+//   2. an all-reduce of that chunk over the ring of the devices that hold
+//      the same chunk in every task, and
+//   3. an all-gather over the ring of the devices of each task.
+// Compared to a single ring over the whole group, which takes
+// 2 * (group_size - 1) steps, this takes 2 * (devices per task - 1) steps
+// over the fast links within a task and 2 * (num_tasks - 1) steps across
+// tasks, while sending the same number of bytes across tasks.
+//
+// Requires that cp.instance.device_names holds the devices of each task
+// contiguously, as CollectiveParamResolverLocal orders them.
+class HierarchicalReducer {
+ public:
+  HierarchicalReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                      OpKernelContext* ctx, OpKernelContext::Params* op_params,
+                      const CollectiveParams& col_params,
+                      const string& exec_key, int64 step_id,
+                      const Tensor* input, Tensor* output);
+
+  void Run(StatusCallback done);
+
+  // Populates "task_ring" with the indices into cp.instance.device_names of
+  // the devices in the task of this device and "cross_task_ring" with those
+  // of the devices at the same position in every task, both in ring order.
+  static void Rings(const CollectiveParams& cp, std::vector<int>* task_ring,
+                    std::vector<int>* cross_task_ring);
+
+ private:
+  // Runs "reducer" to completion and deletes it.
+  Status RunPhase(RingReducer* reducer);
+
+  CollectiveExecutor* col_exec_;        // Not owned
+  const DeviceMgr* dev_mgr_;            // Not owned
+  OpKernelContext* ctx_;                // Not owned
+  OpKernelContext::Params* op_params_;  // Not owned
+  const CollectiveParams& col_params_;
+  const string exec_key_;
+  const int64 step_id_;
+  const Tensor* input_;  // Not owned
+  Tensor* output_;       // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
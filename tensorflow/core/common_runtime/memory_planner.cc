@@ -0,0 +1,272 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64 RoundUp(int64 n, int64 multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+int64 PlanBufferOffsets(const std::vector<PlannedBuffer>& buffers,
+                        int64 alignment, std::vector<int64>* offsets) {
+  std::vector<int> order(buffers.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&buffers](int a, int b) {
+    return buffers[a].size > buffers[b].size;
+  });
+
+  offsets->assign(buffers.size(), 0);
+  std::vector<int> placed;
+  placed.reserve(buffers.size());
+  std::vector<int> overlapping;
+  int64 total = 0;
+  for (int b : order) {
+    const PlannedBuffer& buffer = buffers[b];
+    overlapping.clear();
+    for (int p : placed) {
+      if (buffers[p].first_use <= buffer.last_use &&
+          buffer.first_use <= buffers[p].last_use) {
+        overlapping.push_back(p);
+      }
+    }
+    std::sort(
+        overlapping.begin(), overlapping.end(),
+        [offsets](int x, int y) { return (*offsets)[x] < (*offsets)[y]; });
+    // Find the lowest gap between the buffers that are live at the same time
+    // that is large enough.
+    int64 offset = 0;
+    for (int p : overlapping) {
+      if ((*offsets)[p] - offset >= buffer.size) break;
+      offset = std::max(offset,
+                        RoundUp((*offsets)[p] + buffers[p].size, alignment));
+    }
+    (*offsets)[b] = offset;
+    total = std::max(total, offset + buffer.size);
+    placed.push_back(b);
+  }
+  return RoundUp(total, alignment);
+}
+
+// Serves the allocations of one node, trying its planned buffers first.
+class MemoryPlanSlab::NodeAllocator : public Allocator {
+ public:
+  NodeAllocator(MemoryPlanSlab* slab, std::vector<int> buffers)
+      : slab_(slab), buffers_(std::move(buffers)) {}
+
+  string Name() override { return "memory_plan"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    void* ptr = nullptr;
+    if (alignment <= kAllocatorAlignment) {
+      ptr = slab_->AllocateBuffer(buffers_, num_bytes);
+    }
+    if (ptr == nullptr) {
+      ptr = slab_->base_->AllocateRaw(alignment, num_bytes);
+      if (ptr == nullptr) return nullptr;
+    }
+    slab_->Ref();
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (!slab_->DeallocateBuffer(ptr)) {
+      slab_->base_->DeallocateRaw(ptr);
+    }
+    // May delete the slab, and this allocator with it.
+    slab_->Unref();
+  }
+
+ private:
+  MemoryPlanSlab* const slab_;  // Not owned.
+  const std::vector<int> buffers_;
+};
+
+MemoryPlanSlab::MemoryPlanSlab(Allocator* base,
+                               std::vector<PlannedBuffer> buffers,
+                               std::vector<int64> offsets, int64 slab_bytes)
+    : base_(base),
+      buffers_(std::move(buffers)),
+      offsets_(std::move(offsets)),
+      slab_bytes_(slab_bytes),
+      conflicts_(buffers_.size()),
+      in_use_(buffers_.size(), false) {
+  // Sweep the buffers in order of offset to find the pairs that overlap.
+  std::vector<int> by_offset(buffers_.size());
+  std::iota(by_offset.begin(), by_offset.end(), 0);
+  std::sort(by_offset.begin(), by_offset.end(),
+            [this](int x, int y) { return offsets_[x] < offsets_[y]; });
+  for (size_t i = 0; i < by_offset.size(); ++i) {
+    const int a = by_offset[i];
+    const int64 end = offsets_[a] + buffers_[a].size;
+    for (size_t j = i + 1; j < by_offset.size(); ++j) {
+      const int b = by_offset[j];
+      if (offsets_[b] >= end) break;
+      conflicts_[a].push_back(b);
+      conflicts_[b].push_back(a);
+    }
+  }
+}
+
+MemoryPlanSlab::~MemoryPlanSlab() {
+  if (slab_ != nullptr) {
+    base_->DeallocateRaw(slab_);
+  }
+}
+
+Status MemoryPlanSlab::Create(const Graph& graph, Allocator* base,
+                              const std::function<bool(const Node*)>& plannable,
+                              MemoryPlanSlab** slab) {
+  *slab = nullptr;
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    position[order[i]->id()] = i;
+  }
+
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  refiner.set_require_shape_inference_fns(false);
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    if (n->IsControlFlow()) return Status::OK();
+    Status s = refiner.AddNode(n);
+    if (!s.ok()) {
+      VLOG(1) << "Not planning memory: " << s;
+      return Status::OK();
+    }
+  }
+
+  std::vector<PlannedBuffer> buffers;
+  std::vector<std::vector<int>> node_buffers(graph.num_node_ids());
+  for (const Node* n : order) {
+    // Constants return a tensor that is built with the kernel.
+    if (!n->IsOp() || n->IsConstant() || !plannable(n)) continue;
+    shape_inference::InferenceContext* c = refiner.GetContext(n);
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      const DataType dt = n->output_type(i);
+      if (!DataTypeCanUseMemcpy(dt)) continue;
+      shape_inference::ShapeHandle shape = c->output(i);
+      if (!c->FullyDefined(shape)) continue;
+      int64 num_elements = 1;
+      for (int d = 0; d < c->Rank(shape); ++d) {
+        num_elements *= c->Value(c->Dim(shape, d));
+      }
+      PlannedBuffer buffer;
+      buffer.size = num_elements * DataTypeSize(dt);
+      if (buffer.size == 0) continue;
+      buffer.first_use = position[n->id()];
+      buffer.last_use = buffer.first_use;
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() || e->src_output() != i) continue;
+        buffer.last_use = std::max(buffer.last_use, position[e->dst()->id()]);
+      }
+      node_buffers[n->id()].push_back(buffers.size());
+      buffers.push_back(buffer);
+    }
+  }
+  if (buffers.empty()) return Status::OK();
+
+  std::vector<int64> offsets;
+  const int64 slab_bytes =
+      PlanBufferOffsets(buffers, Allocator::kAllocatorAlignment, &offsets);
+  std::unique_ptr<MemoryPlanSlab, std::function<void(MemoryPlanSlab*)>> ret(
+      new MemoryPlanSlab(base, std::move(buffers), std::move(offsets),
+                         slab_bytes),
+      [](MemoryPlanSlab* s) { s->Unref(); });
+  ret->slab_ = static_cast<char*>(
+      base->AllocateRaw(Allocator::kAllocatorAlignment, slab_bytes));
+  if (ret->slab_ == nullptr) {
+    LOG(WARNING) << "Not planning memory: could not allocate a slab of "
+                 << slab_bytes << " bytes";
+    return Status::OK();
+  }
+  ret->allocators_.resize(graph.num_node_ids());
+  for (int id = 0; id < graph.num_node_ids(); ++id) {
+    if (!node_buffers[id].empty()) {
+      ret->allocators_[id].reset(
+          new NodeAllocator(ret.get(), std::move(node_buffers[id])));
+    }
+  }
+  *slab = ret.release();
+  return Status::OK();
+}
+
+Allocator* MemoryPlanSlab::allocator(int node_id) const {
+  return static_cast<size_t>(node_id) < allocators_.size()
+             ? allocators_[node_id].get()
+             : nullptr;
+}
+
+void* MemoryPlanSlab::AllocateBuffer(const std::vector<int>& candidates,
+                                     size_t num_bytes) {
+  mutex_lock l(mu_);
+  for (int b : candidates) {
+    if (in_use_[b] || buffers_[b].size != num_bytes) continue;
+    bool free = true;
+    for (int c : conflicts_[b]) {
+      if (in_use_[c]) {
+        free = false;
+        break;
+      }
+    }
+    if (!free) continue;
+    in_use_[b] = true;
+    void* ptr = slab_ + offsets_[b];
+    buffer_at_[ptr] = b;
+    ++num_slab_allocations_;
+    return ptr;
+  }
+  ++num_fallback_allocations_;
+  return nullptr;
+}
+
+bool MemoryPlanSlab::DeallocateBuffer(void* ptr) {
+  mutex_lock l(mu_);
+  auto it = buffer_at_.find(ptr);
+  if (it == buffer_at_.end()) return false;
+  in_use_[it->second] = false;
+  buffer_at_.erase(it);
+  return true;
+}
+
+void MemoryPlanSlab::GetStats(MemoryPlanStats* stats) {
+  stats->set_slab_bytes(slab_bytes_);
+  int64 planned_bytes = 0;
+  for (const PlannedBuffer& b : buffers_) {
+    planned_bytes += b.size;
+  }
+  stats->set_planned_bytes(planned_bytes);
+  mutex_lock l(mu_);
+  stats->set_num_slab_allocations(num_slab_allocations_);
+  stats->set_num_fallback_allocations(num_fallback_allocations_);
+}
+
+}  // namespace tensorflow
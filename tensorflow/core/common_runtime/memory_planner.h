@@ -0,0 +1,117 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A buffer that is live between two positions of a schedule, inclusive.
+struct PlannedBuffer {
+  int64 size = 0;
+  int first_use = 0;
+  int last_use = 0;
+};
+
+// Assigns each of 'buffers' an offset, aligned to 'alignment', such that
+// buffers whose lifetimes overlap do not overlap in memory. Buffers are
+// placed greedily in order of decreasing size at the lowest offset that
+// fits. Returns the size of the memory needed for all buffers.
+int64 PlanBufferOffsets(const std::vector<PlannedBuffer>& buffers,
+                        int64 alignment, std::vector<int64>* offsets);
+
+// MemoryPlanSlab holds one preallocated slab of memory with a buffer plan,
+// and an allocator per node of a graph that places the tensors the node
+// allocates in the buffers planned for its outputs.
+//
+// The plan is only followed when it is safe to: an allocation of node 'n'
+// is placed in a buffer planned for 'n' if the buffer has the requested
+// size and no buffer that overlaps it in the slab is in use, e.g. because
+// a consumer forwarded its input or the graph runs concurrently with
+// itself. Otherwise it is served by the base allocator. Every live
+// allocation holds a reference on the slab, so tensors that outlive their
+// executor stay valid.
+class MemoryPlanSlab : public core::RefCounted {
+ public:
+  ~MemoryPlanSlab() override;
+
+  // Plans the outputs of the nodes of 'graph' for which 'plannable' returns
+  // true and whose shapes and types are known statically. Buffers are live
+  // from the position of their producer to the position of their last
+  // consumer in a topological order. Sets '*slab' to nullptr if there is
+  // nothing to plan, or if 'graph' contains control flow. Does not take
+  // ownership of 'base', which must outlive the slab.
+  static Status Create(const Graph& graph, Allocator* base,
+                       const std::function<bool(const Node*)>& plannable,
+                       MemoryPlanSlab** slab);
+
+  // Returns the allocator for the node with id 'node_id', or nullptr if the
+  // node has no planned buffer. The allocator is valid as long as the slab.
+  Allocator* allocator(int node_id) const;
+
+  // Fills in the size of the slab and the number of allocations served with
+  // and without it so far.
+  void GetStats(MemoryPlanStats* stats);
+
+ private:
+  class NodeAllocator;
+
+  MemoryPlanSlab(Allocator* base, std::vector<PlannedBuffer> buffers,
+                 std::vector<int64> offsets, int64 slab_bytes);
+
+  // Returns the start of a buffer among 'candidates' that can hold
+  // 'num_bytes' now, or nullptr.
+  void* AllocateBuffer(const std::vector<int>& candidates, size_t num_bytes);
+  // Returns false if 'ptr' is not the start of a buffer in use.
+  bool DeallocateBuffer(void* ptr);
+
+  Allocator* const base_;
+  const std::vector<PlannedBuffer> buffers_;
+  const std::vector<int64> offsets_;
+  const int64 slab_bytes_;
+  char* slab_ = nullptr;
+
+  // For each buffer, the other buffers that overlap it in the slab.
+  std::vector<std::vector<int>> conflicts_;
+  // Indexed by node id.
+  std::vector<std::unique_ptr<NodeAllocator>> allocators_;
+
+  mutex mu_;
+  std::vector<bool> in_use_ GUARDED_BY(mu_);
+  gtl::FlatMap<const void*, int> buffer_at_ GUARDED_BY(mu_);
+  int64 num_slab_allocations_ GUARDED_BY(mu_) = 0;
+  int64 num_fallback_allocations_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryPlanSlab);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
@@ -0,0 +1,111 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+PlannedBuffer Buffer(int64 size, int first_use, int last_use) {
+  PlannedBuffer b;
+  b.size = size;
+  b.first_use = first_use;
+  b.last_use = last_use;
+  return b;
+}
+
+TEST(PlanBufferOffsetsTest, Empty) {
+  std::vector<int64> offsets;
+  EXPECT_EQ(0, PlanBufferOffsets({}, 64, &offsets));
+  EXPECT_TRUE(offsets.empty());
+}
+
+TEST(PlanBufferOffsetsTest, DisjointLifetimesShareMemory) {
+  std::vector<int64> offsets;
+  EXPECT_EQ(128, PlanBufferOffsets({Buffer(100, 0, 1), Buffer(100, 2, 3),
+                                    Buffer(50, 4, 5)},
+                                   64, &offsets));
+  EXPECT_EQ(std::vector<int64>({0, 0, 0}), offsets);
+}
+
+TEST(PlanBufferOffsetsTest, OverlappingLifetimes) {
+  std::vector<int64> offsets;
+  // A chain a -> b -> c, where each buffer is live until its consumer ran.
+  EXPECT_EQ(384, PlanBufferOffsets({Buffer(100, 0, 1), Buffer(200, 1, 2),
+                                    Buffer(100, 2, 3)},
+                                   64, &offsets));
+  // The largest buffer is placed first.
+  EXPECT_EQ(std::vector<int64>({256, 0, 256}), offsets);
+}
+
+TEST(PlanBufferOffsetsTest, FillsGaps) {
+  std::vector<int64> offsets;
+  PlanBufferOffsets({Buffer(64, 0, 10), Buffer(64, 0, 1), Buffer(64, 0, 10),
+                     Buffer(64, 5, 6)},
+                    64, &offsets);
+  EXPECT_EQ(std::vector<int64>({0, 64, 128, 64}), offsets);
+}
+
+TEST(MemoryPlanSlabTest, PlacesOutputsInSlab) {
+  // c = -b, b = -a, where only b and c have planned buffers.
+  Graph g(OpRegistry::Global());
+  Tensor t(DT_FLOAT, TensorShape({16}));
+  t.flat<float>().setZero();
+  Node* a = test::graph::Constant(&g, t);
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  Node* c = test::graph::Unary(&g, "Neg", b);
+
+  MemoryPlanSlab* slab = nullptr;
+  TF_ASSERT_OK(MemoryPlanSlab::Create(
+      g, cpu_allocator(), [](const Node*) { return true; }, &slab));
+  ASSERT_NE(nullptr, slab);
+  EXPECT_EQ(nullptr, slab->allocator(a->id()));
+  Allocator* b_allocator = slab->allocator(b->id());
+  Allocator* c_allocator = slab->allocator(c->id());
+  ASSERT_NE(nullptr, b_allocator);
+  ASSERT_NE(nullptr, c_allocator);
+
+  void* b_buf = b_allocator->AllocateRaw(64, 64);
+  void* c_buf = c_allocator->AllocateRaw(64, 64);
+  EXPECT_NE(b_buf, c_buf);
+  // A request of another size, or a second request for the same buffer,
+  // falls back to the base allocator.
+  void* other = b_allocator->AllocateRaw(64, 32);
+  void* again = b_allocator->AllocateRaw(64, 64);
+
+  MemoryPlanStats stats;
+  slab->GetStats(&stats);
+  EXPECT_EQ(128, stats.slab_bytes());
+  EXPECT_EQ(128, stats.planned_bytes());
+  EXPECT_EQ(2, stats.num_slab_allocations());
+  EXPECT_EQ(2, stats.num_fallback_allocations());
+
+  // Live allocations keep the slab alive.
+  slab->Unref();
+  b_allocator->DeallocateRaw(other);
+  b_allocator->DeallocateRaw(again);
+  b_allocator->DeallocateRaw(b_buf);
+  c_allocator->DeallocateRaw(c_buf);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 
+#include "tensorflow/core/common_runtime/setup_stats_collector.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
 namespace tensorflow {
 
 // static
@@ -37,7 +41,13 @@ Status OptimizationPassRegistry::RunGrouping(
       VLOG(1) << "Running optimization phase " << phase.first;
       for (auto& pass : phase.second) {
         VLOG(1) << "Running optimization pass: " << pass->name();
+        const uint64 start_us = Env::Default()->NowMicros();
         Status s = pass->Run(options);
+        if (options.setup_stats != nullptr) {
+          options.setup_stats->Record(
+              strings::StrCat("pass/", pass->name()),
+              Env::Default()->NowMicros() - start_us);
+        }
         if (!s.ok()) return s;
       }
     }
@@ -29,6 +29,7 @@ limitations under the License.
 
 namespace tensorflow {
 struct SessionOptions;
+class SetupStatsCollector;
 
 // All the parameters used by an optimization pass are packaged in
 // this struct. They should be enough for the optimization pass to use
@@ -57,6 +58,10 @@ struct GraphOptimizationPassOptions {
   // Null for pre-partitioning passes.
   std::unordered_map<string, std::unique_ptr<Graph>>* partition_graphs =
       nullptr;
+
+  // If non-null, the wall time of each pass is recorded into it as
+  // "pass/<name>".
+  SetupStatsCollector* setup_stats = nullptr;  // Not owned.
 };
 
 // Optimization passes are implemented by inheriting from
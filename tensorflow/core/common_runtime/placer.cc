@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/placer.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -646,6 +649,25 @@ bool IsGeneratorNode(const Node* node) {
          !IsRefType(node->output_type(0));
 }
 
+// Returns true if "node" creates a variable.
+bool IsVariableNode(const Node* node) {
+  return node->IsVariable() || node->type_string() == "VarHandleOp";
+}
+
+// Returns the number of bytes of the variable that "node" creates, as far
+// as its "shape" and "dtype" attrs tell. A variable whose shape is not fully
+// defined counts as one element.
+int64 VariableBytes(const Node* node) {
+  DataType dtype;
+  PartialTensorShape shape;
+  if (!GetNodeAttr(node->attrs(), "dtype", &dtype).ok() ||
+      !GetNodeAttr(node->attrs(), "shape", &shape).ok()) {
+    return 0;
+  }
+  const int64 num_elements = shape.IsFullyDefined() ? shape.num_elements() : 1;
+  return num_elements * DataTypeSize(dtype);
+}
+
 }  // namespace
 
 Placer::Placer(Graph* graph, const DeviceSet* devices,
@@ -747,7 +769,59 @@ Status Placer::Run() {
     }
   }
 
-  // 3. For each node, assign a device based on the constraints in the
+  // 3. If requested, choose the devices of the colocation groups of the
+  // variables so that the bytes of the variables are balanced among the
+  // devices that the groups allow, e.g. the parameter server tasks of
+  // variables placed on "/job:ps". The other nodes of a group follow its
+  // variables, because the chosen device is moved to the front of its
+  // possible devices.
+  if (options_ != nullptr &&
+      options_->config.experimental().balance_variable_placement()) {
+    std::unordered_map<string, int64> device_bytes;
+    std::unordered_map<int, Device*> group_devices;
+    for (Node* node : graph_->op_nodes()) {
+      if (!IsVariableNode(node)) continue;
+      if (node->has_assigned_device_name()) {
+        device_bytes[node->assigned_device_name()] += VariableBytes(node);
+        continue;
+      }
+      std::vector<Device*>* devices;
+      Status status = colocation_graph.GetDevicesForNode(node, &devices);
+      if (!status.ok()) {
+        return AttachDef(
+            errors::InvalidArgument("Cannot assign a device for operation '",
+                                    node->name(),
+                                    "': ", status.error_message()),
+            *node);
+      }
+      Device*& group_device =
+          group_devices[colocation_graph.FindRoot(node->id())];
+      if (group_device == nullptr) {
+        // Only balance among the devices of the preferred type in the job
+        // and replica of the preferred device, so that e.g. a variable that
+        // may be placed anywhere does not move to a worker task.
+        const DeviceNameUtils::ParsedName& preferred =
+            (*devices)[0]->parsed_name();
+        auto least_loaded = devices->begin();
+        for (auto it = devices->begin(); it != devices->end(); ++it) {
+          const DeviceNameUtils::ParsedName& name = (*it)->parsed_name();
+          if (name.type != preferred.type || name.job != preferred.job ||
+              name.replica != preferred.replica) {
+            continue;
+          }
+          if (device_bytes[(*it)->name()] <
+              device_bytes[(*least_loaded)->name()]) {
+            least_loaded = it;
+          }
+        }
+        std::rotate(devices->begin(), least_loaded, least_loaded + 1);
+        group_device = (*devices)[0];
+      }
+      device_bytes[group_device->name()] += VariableBytes(node);
+    }
+  }
+
+  // 4. For each node, assign a device based on the constraints in the
   // disjoint node set.
   std::vector<Node*> second_pass;
   for (Node* node : graph_->op_nodes()) {
@@ -814,7 +888,7 @@ Status Placer::Run() {
     AssignAndLog(assigned_device, node);
   }
 
-  // 4. Perform a second pass assignment for those nodes explicitly
+  // 5. Perform a second pass assignment for those nodes explicitly
   // skipped during the first pass.
   for (Node* node : second_pass) {
     std::vector<Device*>* devices;
@@ -1280,5 +1280,52 @@ TEST_F(PlacerTest, TestGeneratorNodeDoesntFollowNonColocatedConsumers) {
   EXPECT_DEVICE_TYPE(g, "in", "FakeGPU");
 }
 
+REGISTER_KERNEL_BUILDER(Name("VariableV2").Device("FakeCPU"), DummyOp);
+
+// Test that, if requested, variables that may be placed on any task of a job
+// are spread among the tasks by their sizes.
+TEST_F(PlacerTest, TestBalanceVariablePlacement) {
+  std::vector<std::unique_ptr<Device>> ps_devices;
+  DeviceSet devices;
+  for (int i = 0; i < 3; ++i) {
+    ps_devices.emplace_back(FakeDevice::MakeCPU(
+        strings::StrCat("/job:ps/replica:0/task:", i, "/device:fakecpu:0")));
+    devices.AddDevice(ps_devices.back().get());
+  }
+
+  for (bool balance : {false, true}) {
+    Graph g(OpRegistry::Global());
+    {  // Scope for temporary variables used to construct g.
+      GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+      ops::SourceOp("VariableV2", b.opts()
+                                      .WithName("v0")
+                                      .WithDevice("/job:ps")
+                                      .WithAttr("shape", TensorShape({1000}))
+                                      .WithAttr("dtype", DT_FLOAT));
+      for (int i = 1; i < 4; ++i) {
+        ops::SourceOp("VariableV2", b.opts()
+                                        .WithName(strings::StrCat("v", i))
+                                        .WithDevice("/job:ps")
+                                        .WithAttr("shape", TensorShape({100}))
+                                        .WithAttr("dtype", DT_FLOAT));
+      }
+      TF_EXPECT_OK(BuildGraph(b, &g));
+    }
+
+    SessionOptions options;
+    options.config.mutable_experimental()->set_balance_variable_placement(
+        balance);
+    TF_EXPECT_OK(Place(&g, &devices, &options));
+    const int expected_tasks[] = {0, 1, 2, 1};
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(strings::StrCat("/job:ps/replica:0/task:",
+                                balance ? expected_tasks[i] : 0,
+                                "/device:fakecpu:0"),
+                GetNodeByName(g, strings::StrCat("v", i))
+                    ->assigned_device_name());
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -22,10 +22,15 @@ limitations under the License.
 #endif  // INTEL_MKL
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -83,6 +88,39 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
   return new thread::ThreadPool(options.env, "Compute", num_threads);
 }
 
+bool UseNUMAAffinity(const SessionOptions& options) {
+  return options.config.experimental().use_numa_affinity() &&
+         port::NUMAEnabled();
+}
+
+thread::ThreadPool* NUMAComputePool(const SessionOptions& options,
+                                    int numa_node) {
+  CHECK(UseNUMAAffinity(options));
+  CHECK_GE(numa_node, 0);
+  CHECK_LT(numa_node, port::NUMANumNodes());
+  static mutex mu(LINKER_INITIALIZED);
+  static std::vector<thread::ThreadPool*>* pools =
+      new std::vector<thread::ThreadPool*>(port::NUMANumNodes(), nullptr);
+  mutex_lock l(mu);
+  thread::ThreadPool*& pool = (*pools)[numa_node];
+  if (pool == nullptr) {
+    int32 num_threads = options.config.inter_op_parallelism_threads();
+    if (num_threads == 0) {
+      // Default to using the cores of one node.
+      num_threads =
+          std::max(1, port::NumSchedulableCPUs() / port::NUMANumNodes());
+    }
+    VLOG(1) << "NUMA node " << numa_node
+            << " inter op parallelism threads: " << num_threads;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
+    pool = new thread::ThreadPool(options.env, thread_options,
+                                  strings::StrCat("Compute_numa_", numa_node),
+                                  num_threads);
+  }
+  return pool;
+}
+
 void SchedClosure(std::function<void()> closure) {
   if (!tracing::EventCollector::IsEnabled()) {
     return Env::Default()->SchedClosure(std::move(closure));
@@ -37,6 +37,17 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options);
 
+// Returns true if 'options' ask for devices to be assigned to NUMA nodes and
+// the host has more than one NUMA node.
+bool UseNUMAAffinity(const SessionOptions& options);
+
+// Returns a process-wide ThreadPool for scheduling the compute operations of
+// the devices on NUMA node 'numa_node', whose threads are restricted to the
+// CPUs of that node. Caller does not take ownership over threadpool.
+// Requires UseNUMAAffinity(options).
+thread::ThreadPool* NUMAComputePool(const SessionOptions& options,
+                                    int numa_node);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
 
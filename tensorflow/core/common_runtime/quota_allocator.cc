@@ -0,0 +1,106 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/quota_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+QuotaAllocator::QuotaAllocator(Allocator* allocator, int64 quota_bytes)
+    : allocator_(allocator) {
+  stats_.bytes_limit = quota_bytes;
+}
+
+void QuotaAllocator::Release() {
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    CHECK(!released_);
+    released_ = true;
+    should_delete = ShouldDelete();
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void* QuotaAllocator::AllocateRaw(size_t alignment, size_t num_bytes,
+                                  const AllocationAttributes& allocation_attr) {
+  const int64 bytes = static_cast<int64>(num_bytes);
+  {
+    // The bytes are reserved before allocating, so that concurrent
+    // allocations cannot exceed the quota together.
+    mutex_lock lock(mu_);
+    if (stats_.bytes_in_use + bytes > stats_.bytes_limit) {
+      if (!allocation_attr.no_retry_on_failure) {
+        LOG(WARNING) << "Allocator (" << Name() << ") ran out of its quota of "
+                     << strings::HumanReadableNumBytes(stats_.bytes_limit)
+                     << " trying to allocate "
+                     << strings::HumanReadableNumBytes(num_bytes) << ", with "
+                     << strings::HumanReadableNumBytes(stats_.bytes_in_use)
+                     << " in use.";
+      }
+      return nullptr;
+    }
+    stats_.bytes_in_use += bytes;
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  mutex_lock lock(mu_);
+  if (ptr == nullptr) {
+    stats_.bytes_in_use -= bytes;
+    return nullptr;
+  }
+  sizes_[ptr] = num_bytes;
+  ++stats_.num_allocs;
+  stats_.max_bytes_in_use =
+      std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
+  stats_.max_alloc_size = std::max(stats_.max_alloc_size, bytes);
+  return ptr;
+}
+
+void QuotaAllocator::DeallocateRaw(void* ptr) {
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    auto it = sizes_.find(ptr);
+    CHECK(it != sizes_.end()) << "Deallocating unknown pointer " << ptr;
+    stats_.bytes_in_use -= static_cast<int64>(it->second);
+    sizes_.erase(it);
+    should_delete = ShouldDelete();
+  }
+  // Only now can the pointer be handed out again by 'allocator_'.
+  allocator_->DeallocateRaw(ptr);
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void QuotaAllocator::GetStats(AllocatorStats* stats) {
+  mutex_lock lock(mu_);
+  *stats = stats_;
+}
+
+void QuotaAllocator::ClearStats() {
+  mutex_lock lock(mu_);
+  stats_.num_allocs = 0;
+  stats_.max_bytes_in_use = stats_.bytes_in_use;
+  stats_.max_alloc_size = 0;
+}
+
+}  // end namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_QUOTA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_QUOTA_ALLOCATOR_H_
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// QuotaAllocator is a wrapper for an Allocator shared by several clients,
+// e.g. the allocator of a GPU shared by the sessions of a process. It fails
+// the allocations that would bring the bytes allocated through the wrapper
+// over 'quota_bytes', so that one client cannot exhaust the memory of the
+// others. GetStats() reports the allocations made through the wrapper, with
+// the quota as the bytes limit.
+//
+// Tensors may outlive the client that allocated them, so the owner calls
+// Release() instead of deleting the wrapper: it deletes itself once all of
+// its allocations have been deallocated.
+class QuotaAllocator : public Allocator {
+ public:
+  QuotaAllocator(Allocator* allocator, int64 quota_bytes);
+
+  // After Release() is called, the only further calls allowed are calls to
+  // DeallocateRaw with pointers that were allocated by this wrapper.
+  void Release();
+
+  string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() override {
+    return allocator_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) override {
+    return allocator_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) override {
+    return allocator_->AllocatedSize(ptr);
+  }
+  int64 AllocationId(const void* ptr) override {
+    return allocator_->AllocationId(ptr);
+  }
+  void GetStats(AllocatorStats* stats) override;
+  void ClearStats() override;
+
+ protected:
+  ~QuotaAllocator() override {}
+
+ private:
+  // Returns true if the wrapper should delete itself.
+  bool ShouldDelete() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return released_ && sizes_.empty();
+  }
+
+  Allocator* allocator_;  // not owned.
+  mutex mu_;
+  AllocatorStats stats_ GUARDED_BY(mu_);
+  // The bytes requested for each live allocation.
+  gtl::FlatMap<const void*, size_t> sizes_ GUARDED_BY(mu_);
+  bool released_ GUARDED_BY(mu_) = false;
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_QUOTA_ALLOCATOR_H_
@@ -0,0 +1,59 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/quota_allocator.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(QuotaAllocatorTest, EnforcesQuota) {
+  QuotaAllocator* a = new QuotaAllocator(cpu_allocator(), 1024);
+  void* p1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 768);
+  ASSERT_NE(nullptr, p1);
+  EXPECT_EQ(nullptr, a->AllocateRaw(Allocator::kAllocatorAlignment, 512));
+  void* p2 = a->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  ASSERT_NE(nullptr, p2);
+
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(2, stats.num_allocs);
+  EXPECT_EQ(1024, stats.bytes_in_use);
+  EXPECT_EQ(1024, stats.max_bytes_in_use);
+  EXPECT_EQ(768, stats.max_alloc_size);
+  EXPECT_EQ(1024, stats.bytes_limit);
+
+  a->DeallocateRaw(p1);
+  a->GetStats(&stats);
+  EXPECT_EQ(256, stats.bytes_in_use);
+  void* p3 = a->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+  EXPECT_NE(nullptr, p3);
+  a->DeallocateRaw(p3);
+  a->DeallocateRaw(p2);
+  a->Release();
+}
+
+TEST(QuotaAllocatorTest, OutlivesRelease) {
+  QuotaAllocator* a = new QuotaAllocator(cpu_allocator(), 1024);
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  ASSERT_NE(nullptr, p);
+  a->Release();
+  // Deletes the wrapper.
+  a->DeallocateRaw(p);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -41,6 +41,15 @@ string RingReduceBufKey(const string& exec_key, int pass, int section,
   }
 }
 
+// Returns the rank of "device_idx" in "ring".
+int RankInRing(const std::vector<int>& ring, int device_idx) {
+  for (int rank = 0; rank < ring.size(); ++rank) {
+    if (ring[rank] == device_idx) return rank;
+  }
+  LOG(FATAL) << "Device " << device_idx << " is not in the ring";
+  return -1;
+}
+
 }  // namespace
 
 void RingReducer::PCQueue::Enqueue(RingField* rf) {
@@ -79,11 +88,15 @@ RingReducer::RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
       exec_key_(exec_key),
       input_(input),
       output_(output),
-      rank_(col_params.subdiv_rank[0]),
+      subdiv_permutations_(
+          col_params.instance.impl_details.subdiv_permutations),
+      subdiv_rank_(col_params.subdiv_rank),
+      passes_(ALL_PASSES),
+      finalize_(true),
+      rank_(subdiv_rank_[0]),
       step_id_(step_id),
       group_size_(col_params.group.group_size),
-      num_subdivs_(static_cast<int>(
-          col_params.instance.impl_details.subdiv_permutations.size())),
+      num_subdivs_(static_cast<int>(subdiv_permutations_.size())),
       done_(nullptr),
       device_(nullptr),
       device_name_(
@@ -92,6 +105,37 @@ RingReducer::RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
   CHECK_GT(num_subdivs_, 0);
 }
 
+RingReducer::RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                         OpKernelContext* ctx,
+                         OpKernelContext::Params* op_params,
+                         const CollectiveParams& col_params,
+                         const string& exec_key, int64 step_id,
+                         const Tensor* input, Tensor* output,
+                         const std::vector<int>& ring, Passes passes,
+                         bool finalize)
+    : col_exec_(col_exec),
+      dev_mgr_(dev_mgr),
+      ctx_(ctx),
+      op_params_(op_params),
+      col_params_(col_params),
+      exec_key_(exec_key),
+      input_(input),
+      output_(output),
+      subdiv_permutations_({ring}),
+      subdiv_rank_({RankInRing(ring, col_params.default_rank)}),
+      passes_(passes),
+      finalize_(finalize),
+      rank_(subdiv_rank_[0]),
+      step_id_(step_id),
+      group_size_(static_cast<int>(ring.size())),
+      num_subdivs_(1),
+      done_(nullptr),
+      device_(nullptr),
+      device_name_(
+          col_params_.instance.device_names[col_params_.default_rank]) {
+  CHECK_GT(group_size_, 0);
+}
+
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
 string RingReducer::TensorDebugString(Tensor tensor) {
@@ -123,11 +167,9 @@ void RingReducer::Run(StatusCallback done) {
       strings::StrAppend(&buf, "dev ", r, " : ",
                          col_params_.instance.device_names[r], "\n");
     }
-    for (int sd = 0;
-         sd < col_params_.instance.impl_details.subdiv_permutations.size();
-         ++sd) {
+    for (int sd = 0; sd < subdiv_permutations_.size(); ++sd) {
       strings::StrAppend(&buf, "\nsubdiv ", sd, " perm: ");
-      for (auto x : col_params_.instance.impl_details.subdiv_permutations[sd]) {
+      for (auto x : subdiv_permutations_[sd]) {
         strings::StrAppend(&buf, x, ", ");
       }
     }
@@ -183,12 +225,12 @@ void RingReducer::ContinueAfterInputCopy() {
   ca_.reset(MakeCollectiveAdapter(output_, group_size_ * num_subdivs_,
                                   device_->GetAllocator(attr)));
 
-  if (col_params_.final_op) {
-    // Create an on-device scalar value from group_size_ that may be needed
-    // later.
+  if (finalize_ && col_params_.final_op) {
+    // Create an on-device scalar value from the size of the whole group,
+    // which may be larger than group_size_, that may be needed later.
     // TODO(tucker): Cache and reuse across invocations? Or maybe the scalar
     // can be provided to the kernel in host memory?
-    Tensor group_size_val = ca_->Scalar(group_size_);
+    Tensor group_size_val = ca_->Scalar(col_params_.group.group_size);
     if (col_params_.group.device_type != "CPU") {
       group_size_tensor_ =
           ca_->Scalar(device_->GetAllocator(ctx_->input_alloc_attr(0)));
@@ -205,6 +247,8 @@ void RingReducer::ContinueAfterInputCopy() {
       group_size_tensor_ = group_size_val;
       group_size_tensor_ready_.Notify();
     }
+  } else {
+    group_size_tensor_ready_.Notify();
   }
   Finish(RunAsyncParts());
 }
@@ -291,16 +335,14 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   rf->chunk_idx = chunk_idx;
   rf->subdiv_idx = subdiv_idx;
   rf->sc_idx = field_idx;
-  rf->rank = col_params_.subdiv_rank[subdiv_idx];
+  rf->rank = subdiv_rank_[subdiv_idx];
   rf->second_pass = false;
   rf->action = RF_INIT;
   // Recv from the device with preceding rank within the subdivision.
   int recv_from_rank = (rf->rank + (group_size_ - 1)) % group_size_;
   int send_to_rank = (rf->rank + 1) % group_size_;
-  rf->recv_dev_idx = col_params_.instance.impl_details
-                         .subdiv_permutations[subdiv_idx][recv_from_rank];
-  int send_dev_idx = col_params_.instance.impl_details
-                         .subdiv_permutations[subdiv_idx][send_to_rank];
+  rf->recv_dev_idx = subdiv_permutations_[subdiv_idx][recv_from_rank];
+  int send_dev_idx = subdiv_permutations_[subdiv_idx][send_to_rank];
   rf->recv_is_remote = !col_params_.task.is_local[rf->recv_dev_idx];
   rf->send_is_remote = !col_params_.task.is_local[send_dev_idx];
   if (ca_->ChunkBytes(rf->sc_idx) > 0) {
@@ -362,8 +404,7 @@ void RingReducer::DispatchSend(RingField* rf, const StatusCallback& done) {
           << send_buf_key << " chunk " << ca_->TBounds(rf->chunk) << " sc_idx "
           << rf->sc_idx;
   int send_to_rank = (rf->rank + 1) % group_size_;
-  int send_to_dev_idx = col_params_.instance.impl_details
-                            .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  int send_to_dev_idx = subdiv_permutations_[rf->subdiv_idx][send_to_rank];
   col_exec_->PostToPeer(col_params_.instance.device_names[send_to_dev_idx],
                         col_params_.instance.task_names[send_to_dev_idx],
                         send_buf_key, device_, ctx_->op_device_context(),
@@ -422,6 +463,9 @@ bool RingReducer::RunAsyncParts() {
     for (int subdiv_idx = 0; subdiv_idx < num_subdivs_; ++subdiv_idx) {
       int rf_index = (chunk_idx * num_subdivs_) + subdiv_idx;
       InitRingField(&rfv_[rf_index], chunk_idx, subdiv_idx, rf_index);
+      if (passes_ == ALL_GATHER) {
+        AdvanceToSecondPass(&rfv_[rf_index]);
+      }
       ready_queue.Enqueue(&rfv_[rf_index]);
     }
   }
@@ -474,7 +518,8 @@ bool RingReducer::RunAsyncParts() {
           }
           break;
         case RF_REDUCE:
-          if (!rf->second_pass && col_params_.final_op.get() && rf->is_final) {
+          if (!rf->second_pass && finalize_ && col_params_.final_op.get() &&
+              rf->is_final) {
             rf->action = RF_FINALIZE;
             group_size_tensor_ready_.WaitForNotification();
             Status s = ComputeBinOp(device_, col_params_.final_op.get(),
@@ -515,7 +560,7 @@ bool RingReducer::RunAsyncParts() {
           break;
       }
       if (rf->action == RF_DONE) {
-        if (rf->second_pass) {
+        if (rf->second_pass || passes_ == REDUCE_SCATTER) {
           ++field_done_count;
           break;  // from do while(!dispatched)
         } else {
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_RING_REDUCER_H_
 
 #include <deque>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
 #include "tensorflow/core/framework/collective.h"
@@ -27,11 +28,33 @@ class DeviceMgr;
 // Ring-algorithm implementation of collective all-reduce.
 class RingReducer {
  public:
+  // The passes of the ring algorithm that Run() executes.
+  enum Passes {
+    // Reduce-scatter followed by all-gather, i.e. all-reduce.
+    ALL_PASSES = 0,
+    // Afterwards the device of rank r holds the reduced value of chunk
+    // (r + 1) % ring size.
+    REDUCE_SCATTER,
+    // Expects the device of rank r to hold the reduced value of chunk
+    // (r + 1) % ring size.
+    ALL_GATHER,
+  };
+
   RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
               OpKernelContext* ctx, OpKernelContext::Params* op_params,
               const CollectiveParams& col_params, const string& exec_key,
               int64 step_id, const Tensor* input, Tensor* output);
 
+  // Runs only "passes" over the single ring "ring" of indices into
+  // col_params.instance.device_names, which must contain this device, and
+  // applies col_params.final_op only if "finalize" is true.  The phases of
+  // a HierarchicalReducer are run this way.
+  RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+              OpKernelContext* ctx, OpKernelContext::Params* op_params,
+              const CollectiveParams& col_params, const string& exec_key,
+              int64 step_id, const Tensor* input, Tensor* output,
+              const std::vector<int>& ring, Passes passes, bool finalize);
+
   virtual ~RingReducer();
 
   void Run(StatusCallback done);
@@ -124,6 +147,11 @@ class RingReducer {
   const string exec_key_;
   const Tensor* input_;  // Not owned
   Tensor* output_;       // Not owned
+  // The device ring of each subdivision and the rank of this device in it.
+  const std::vector<std::vector<int>> subdiv_permutations_;
+  const std::vector<int> subdiv_rank_;
+  const Passes passes_;
+  const bool finalize_;
   const int rank_;
   const int64 step_id_;
   const int group_size_;
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
@@ -195,11 +196,14 @@ class RingReducerTest : public ::testing::Test {
     col_params_.group.group_key = kGroupKey;
     col_params_.group.device_type = device_type;
     col_params_.group.group_size = num_workers * num_devices;
+    col_params_.group.num_tasks = num_workers;
     static const int kInstanceKey = 17;
     col_params_.instance.instance_key = kInstanceKey;
     col_params_.instance.impl_details.subdiv_offsets.clear();
     col_params_.instance.type = REDUCTION_COLLECTIVE;
     col_params_.instance.data_type = dtype;
+    col_params_.instance.same_num_devices_per_task = true;
+    col_params_.instance.impl_details.hierarchical = hierarchical_;
     col_params_.instance.impl_details.subdiv_permutations.resize(num_subdivs);
     col_params_.subdiv_rank.resize(num_subdivs);
     int subdiv_stride = num_devices / num_subdivs;
@@ -386,6 +390,7 @@ class RingReducerTest : public ::testing::Test {
       col_params_.group.group_key = parent_->col_params_.group.group_key;
       col_params_.group.device_type = parent_->col_params_.group.device_type;
       col_params_.group.group_size = parent_->col_params_.group.group_size;
+      col_params_.group.num_tasks = parent_->col_params_.group.num_tasks;
       col_params_.instance = parent->col_params_.instance;
       col_params_.task.is_local = parent_->col_params_.task.is_local;
       col_params_.subdiv_rank = parent_->col_params_.subdiv_rank;
@@ -480,20 +485,33 @@ class RingReducerTest : public ::testing::Test {
                                                        &output_tensor_ptr));
       CHECK_EQ(output_tensor_ptr, ctx.mutable_output(0));
 
-      // Prepare a RingReducer instance.
+      // Prepare a RingReducer or HierarchicalReducer instance.
       string exec_key =
           strings::StrCat(col_params_.instance.instance_key, ":0:0");
-      RingReducer rr(parent_->col_exec_, parent_->dev_mgr_.get(), &ctx,
-                     &op_params, col_params_, exec_key, kStepId, &tensor_,
-                     &tensor_);
+      std::unique_ptr<RingReducer> rr;
+      std::unique_ptr<HierarchicalReducer> hr;
+      if (col_params_.instance.impl_details.hierarchical) {
+        hr.reset(new HierarchicalReducer(
+            parent_->col_exec_, parent_->dev_mgr_.get(), &ctx, &op_params,
+            col_params_, exec_key, kStepId, &tensor_, &tensor_));
+      } else {
+        rr.reset(new RingReducer(parent_->col_exec_, parent_->dev_mgr_.get(),
+                                 &ctx, &op_params, col_params_, exec_key,
+                                 kStepId, &tensor_, &tensor_));
+      }
 
       // Start execution in a threadpool then wait for completion.
       Notification notification;
-      SchedClosure([this, &notification, &rr]() {
-        rr.Run([this, &notification](Status s) {
+      SchedClosure([this, &notification, &rr, &hr]() {
+        auto done = [this, &notification](Status s) {
           status_ = s;
           notification.Notify();
-        });
+        };
+        if (hr) {
+          hr->Run(done);
+        } else {
+          rr->Run(done);
+        }
       });
       notification.WaitForNotification();
       CHECK(tensor_.CopyFrom(*ctx.mutable_output(0), tensor_.shape()));
@@ -516,6 +534,7 @@ class RingReducerTest : public ::testing::Test {
   };
 
   bool stop_ = false;
+  bool hierarchical_ = false;
   DeviceType device_type_;
   TestCollectiveExecutorMgr col_exec_mgr_;
   CollectiveExecutor* col_exec_;
@@ -575,6 +594,18 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 // Failure tests
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+#define DEF_HIERARCHICAL_TEST(B, T, W, D, L)                                 \
+  TEST_F(RingReducerTest, Hierarchical_DaTy##B##_Wkr##W##_Dev##D##_Len##L) { \
+    hierarchical_ = true;                                                    \
+    RunTest<T>(DT_##B, DEVICE_CPU, W, D, 1, L, 0);                           \
+  }
+
+DEF_HIERARCHICAL_TEST(FLOAT, float, 2, 2, 1001)
+DEF_HIERARCHICAL_TEST(FLOAT, float, 4, 3, 4095)
+// Most chunks of the tensor are empty.
+DEF_HIERARCHICAL_TEST(FLOAT, float, 2, 8, 5)
+DEF_HIERARCHICAL_TEST(INT64, int64, 3, 4, 1001)
 #endif
 
 #ifdef GOOGLE_CUDA
@@ -0,0 +1,259 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sampling_tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A single-producer, single-consumer ring of events. The producer is the
+// thread that owns the ring; the consumer is SamplingTracer::Drain.
+struct EventRing {
+  EventRing(int64 size, int32 thread_id)
+      : events(size), thread_id(thread_id) {}
+
+  std::vector<SampledEvent> events;
+  const int32 thread_id;
+  // Events [tail, head) are ready to be drained. `head` is only written by
+  // the producer and `tail` only by the consumer.
+  std::atomic<uint64> head{0};
+  std::atomic<uint64> tail{0};
+};
+
+std::atomic<int64> next_tracer_id{0};
+std::atomic<int32> next_thread_id{0};
+
+// The ring of the current thread, for the tracer with id `tracer_id`.
+struct ThreadRing {
+  int64 tracer_id = -1;
+  std::shared_ptr<EventRing> ring;
+};
+
+ThreadRing* CurrentThreadRing() {
+  static thread_local ThreadRing thread_ring;
+  return &thread_ring;
+}
+
+// Counts the activities started by the current thread.
+uint64* CurrentThreadActivityCount() {
+  static thread_local uint64 count = 0;
+  return &count;
+}
+
+}  // namespace
+
+struct SamplingTracer::State {
+  explicit State(int64 ring_size) : ring_size(ring_size) {}
+
+  // Returns the ring of the current thread, registering it on first use.
+  EventRing* CurrentRing() {
+    ThreadRing* thread_ring = CurrentThreadRing();
+    if (thread_ring->tracer_id != id) {
+      auto ring = std::make_shared<EventRing>(ring_size, next_thread_id++);
+      mutex_lock l(mu);
+      rings.push_back(ring);
+      thread_ring->ring = std::move(ring);
+      thread_ring->tracer_id = id;
+    }
+    return thread_ring->ring.get();
+  }
+
+  void Record(const SampledEvent& event) {
+    EventRing* ring = CurrentRing();
+    const uint64 head = ring->head.load(std::memory_order_relaxed);
+    const uint64 tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail >= ring->events.size()) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    SampledEvent* slot = &ring->events[head % ring->events.size()];
+    *slot = event;
+    slot->thread_id = ring->thread_id;
+    ring->head.store(head + 1, std::memory_order_release);
+  }
+
+  const int64 id = next_tracer_id++;
+  const int64 ring_size;
+  std::atomic<int64> dropped{0};
+
+  mutex mu;
+  std::vector<std::shared_ptr<EventRing>> rings GUARDED_BY(mu);
+};
+
+class SamplingTracer::ActivityHandle : public tracing::TraceCollector::Handle {
+ public:
+  ActivityHandle(std::shared_ptr<State> state, Env* env,
+                 StringPiece name_part1, StringPiece name_part2)
+      : state_(std::move(state)), env_(env) {
+    char* name = event_.name;
+    const size_t kMaxLength = SampledEvent::kMaxNameSize - 1;
+    size_t length = std::min(name_part1.size(), kMaxLength);
+    memcpy(name, name_part1.data(), length);
+    if (!name_part2.empty() && length < kMaxLength) {
+      name[length++] = ':';
+      const size_t part2_length =
+          std::min(name_part2.size(), kMaxLength - length);
+      memcpy(name + length, name_part2.data(), part2_length);
+      length += part2_length;
+    }
+    name[length] = '\0';
+    event_.start_micros = env_->NowMicros();
+  }
+
+  // The activity may end on a different thread than it started on (e.g. in
+  // the callback of an asynchronous op); it is recorded in the ring of the
+  // thread that ends it.
+  ~ActivityHandle() override {
+    event_.end_micros = env_->NowMicros();
+    state_->Record(event_);
+  }
+
+ private:
+  const std::shared_ptr<State> state_;
+  Env* const env_;
+  SampledEvent event_;
+};
+
+SamplingTracer::SamplingTracer(const Options& options, Env* env)
+    : options_(options),
+      env_(env),
+      state_(std::make_shared<State>(options.ring_size)) {}
+
+SamplingTracer::~SamplingTracer() { Stop().IgnoreError(); }
+
+Status SamplingTracer::Start() {
+  if (!options_.sink) {
+    return errors::InvalidArgument("SamplingTracer requires a sink");
+  }
+  if (options_.sampling_period < 1 || options_.ring_size < 1) {
+    return errors::InvalidArgument(
+        "SamplingTracer sampling_period and ring_size must be positive, got ",
+        options_.sampling_period, " and ", options_.ring_size);
+  }
+  mutex_lock l(mu_);
+  if (started_) {
+    return errors::FailedPrecondition("SamplingTracer is already started");
+  }
+  if (tracing::GetTraceCollector() != nullptr) {
+    return errors::Unavailable("Another tracer is already collecting traces");
+  }
+  tracing::SetTraceCollector(this);
+  started_ = true;
+  drain_thread_.reset(env_->StartThread(ThreadOptions(), "sampling_tracer",
+                                        [this]() { DrainLoop(); }));
+  return Status::OK();
+}
+
+Status SamplingTracer::Stop() {
+  std::unique_ptr<Thread> drain_thread;
+  {
+    mutex_lock l(mu_);
+    if (!started_) {
+      return Status::OK();
+    }
+    started_ = false;
+    if (tracing::GetTraceCollector() == this) {
+      tracing::SetTraceCollector(nullptr);
+    }
+    drain_thread = std::move(drain_thread_);
+  }
+  cv_.notify_all();
+  // Joins the drain thread.
+  drain_thread.reset();
+  Drain();
+  return Status::OK();
+}
+
+void SamplingTracer::DrainLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (started_) {
+        WaitForMilliseconds(
+            &l, &cv_,
+            std::max<int64>(1, options_.drain_interval_micros / 1000));
+      }
+      if (!started_) {
+        return;
+      }
+    }
+    Drain();
+  }
+}
+
+void SamplingTracer::Drain() {
+  mutex_lock drain_lock(drain_mu_);
+  std::vector<std::shared_ptr<EventRing>> rings;
+  {
+    mutex_lock l(state_->mu);
+    rings = state_->rings;
+  }
+  std::vector<SampledEvent> events;
+  for (const auto& ring : rings) {
+    const uint64 head = ring->head.load(std::memory_order_acquire);
+    const uint64 tail = ring->tail.load(std::memory_order_relaxed);
+    for (uint64 i = tail; i < head; ++i) {
+      events.push_back(ring->events[i % ring->events.size()]);
+    }
+    ring->tail.store(head, std::memory_order_release);
+  }
+  rings.clear();
+  {
+    // Forgets the empty rings of the threads that have exited.
+    mutex_lock l(state_->mu);
+    state_->rings.erase(
+        std::remove_if(state_->rings.begin(), state_->rings.end(),
+                       [](const std::shared_ptr<EventRing>& ring) {
+                         return ring.use_count() == 1 &&
+                                ring->head.load(std::memory_order_acquire) ==
+                                    ring->tail.load(std::memory_order_relaxed);
+                       }),
+        state_->rings.end());
+  }
+  if (!events.empty()) {
+    options_.sink(std::move(events));
+  }
+}
+
+int64 SamplingTracer::dropped_events() const {
+  return state_->dropped.load(std::memory_order_relaxed);
+}
+
+std::unique_ptr<tracing::TraceCollector::Handle>
+SamplingTracer::CreateAnnotationHandle(StringPiece name_part1,
+                                       StringPiece name_part2) const {
+  return nullptr;
+}
+
+std::unique_ptr<tracing::TraceCollector::Handle>
+SamplingTracer::CreateActivityHandle(StringPiece name_part1,
+                                     StringPiece name_part2,
+                                     bool is_expensive) const {
+  uint64* count = CurrentThreadActivityCount();
+  if (++*count % options_.sampling_period != 0) {
+    return nullptr;
+  }
+  return std::unique_ptr<Handle>(
+      new ActivityHandle(state_, env_, name_part1, name_part2));
+}
+
+}  // namespace tensorflow
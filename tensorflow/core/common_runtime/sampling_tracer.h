@@ -0,0 +1,120 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLING_TRACER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLING_TRACER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An activity recorded by a SamplingTracer.
+struct SampledEvent {
+  static constexpr size_t kMaxNameSize = 64;
+
+  // "<name_part1>:<name_part2>" of the activity, truncated and
+  // NUL-terminated.
+  char name[kMaxNameSize];
+  uint64 start_micros;
+  uint64 end_micros;
+  // Identifies the thread that ended the activity.
+  int32 thread_id;
+};
+
+// A tracer that is cheap enough to leave on in production.
+//
+// While started, the tracer is the tracing::TraceCollector of the process, so
+// it sees the tracing::ScopedActivity regions of the executor (each kernel
+// Compute), tf.data iterators, Recv ops and RPCs. It records one in
+// `sampling_period` of them, per thread, as fixed-size events in a per-thread
+// ring buffer: a sampled activity costs two clock reads and a copy of its
+// name, and no locks. Activities that are not sampled cost a thread-local
+// counter increment. A background thread drains the rings every
+// `drain_interval_micros` and hands the events to `sink`. Events that arrive
+// while their ring is full are dropped and counted.
+//
+// Only one tracer (including DeviceTracer) can collect activities at a time.
+class SamplingTracer : public tracing::TraceCollector {
+ public:
+  struct Options {
+    // Records one in `sampling_period` activities of each thread.
+    int64 sampling_period = 1000;
+    // The number of events that each thread buffers between drains.
+    int64 ring_size = 4096;
+    int64 drain_interval_micros = 1000 * 1000;
+    // Receives the drained events, on the drain thread. Required.
+    std::function<void(std::vector<SampledEvent>)> sink;
+  };
+
+  explicit SamplingTracer(const Options& options, Env* env = Env::Default());
+
+  // Stops the tracer.
+  ~SamplingTracer() override;
+
+  // Registers the tracer as the TraceCollector and starts the drain thread.
+  // Returns UNAVAILABLE if another TraceCollector is registered.
+  Status Start() LOCKS_EXCLUDED(mu_);
+
+  // Unregisters the tracer, and drains the rings one last time.
+  Status Stop() LOCKS_EXCLUDED(mu_);
+
+  // Moves the buffered events to the sink now.
+  void Drain() LOCKS_EXCLUDED(drain_mu_);
+
+  // The number of events dropped because their ring was full.
+  int64 dropped_events() const;
+
+  // tracing::TraceCollector interface. Annotations are not recorded.
+  std::unique_ptr<Handle> CreateAnnotationHandle(
+      StringPiece name_part1, StringPiece name_part2) const override;
+  std::unique_ptr<Handle> CreateActivityHandle(
+      StringPiece name_part1, StringPiece name_part2,
+      bool is_expensive) const override;
+
+ private:
+  class ActivityHandle;
+  // The per-thread rings, shared with the activity handles in flight.
+  struct State;
+
+  // Drains the rings every `drain_interval_micros` until the tracer stops.
+  void DrainLoop() LOCKS_EXCLUDED(mu_);
+
+  const Options options_;
+  Env* const env_;
+  const std::shared_ptr<State> state_;
+
+  mutex mu_;
+  bool started_ GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> drain_thread_ GUARDED_BY(mu_);
+  condition_variable cv_;
+  // Serializes drains, which are the only readers of the rings.
+  mutex drain_mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SamplingTracer);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLING_TRACER_H_
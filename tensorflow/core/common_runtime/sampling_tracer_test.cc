@@ -0,0 +1,143 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sampling_tracer.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class SamplingTracerTest : public ::testing::Test {
+ protected:
+  SamplingTracer::Options MakeOptions(int64 sampling_period, int64 ring_size) {
+    SamplingTracer::Options options;
+    options.sampling_period = sampling_period;
+    options.ring_size = ring_size;
+    // Only drain explicitly.
+    options.drain_interval_micros = 3600LL * 1000 * 1000;
+    options.sink = [this](std::vector<SampledEvent> events) {
+      mutex_lock l(mu_);
+      for (const SampledEvent& event : events) {
+        events_.push_back(event);
+      }
+    };
+    return options;
+  }
+
+  std::vector<SampledEvent> events() {
+    mutex_lock l(mu_);
+    return events_;
+  }
+
+  mutex mu_;
+  std::vector<SampledEvent> events_ GUARDED_BY(mu_);
+};
+
+TEST_F(SamplingTracerTest, SamplesActivities) {
+  SamplingTracer tracer(MakeOptions(/*sampling_period=*/3, /*ring_size=*/16));
+  TF_ASSERT_OK(tracer.Start());
+  for (int i = 0; i < 9; ++i) {
+    tracing::ScopedActivity activity("MatMul", "op");
+  }
+  tracer.Drain();
+  std::vector<SampledEvent> sampled = events();
+  ASSERT_EQ(3, sampled.size());
+  for (const SampledEvent& event : sampled) {
+    EXPECT_EQ("MatMul:op", string(event.name));
+    EXPECT_LE(event.start_micros, event.end_micros);
+  }
+  TF_ASSERT_OK(tracer.Stop());
+  EXPECT_EQ(nullptr, tracing::GetTraceCollector());
+}
+
+TEST_F(SamplingTracerTest, TruncatesNames) {
+  SamplingTracer tracer(MakeOptions(/*sampling_period=*/1, /*ring_size=*/16));
+  TF_ASSERT_OK(tracer.Start());
+  const string long_name(2 * SampledEvent::kMaxNameSize, 'x');
+  { tracing::ScopedActivity activity(long_name); }
+  TF_ASSERT_OK(tracer.Stop());
+  std::vector<SampledEvent> sampled = events();
+  ASSERT_EQ(1, sampled.size());
+  EXPECT_EQ(long_name.substr(0, SampledEvent::kMaxNameSize - 1),
+            string(sampled[0].name));
+}
+
+TEST_F(SamplingTracerTest, DropsEventsWhenRingIsFull) {
+  SamplingTracer tracer(MakeOptions(/*sampling_period=*/1, /*ring_size=*/4));
+  TF_ASSERT_OK(tracer.Start());
+  for (int i = 0; i < 6; ++i) {
+    tracing::ScopedActivity activity("op");
+  }
+  EXPECT_EQ(2, tracer.dropped_events());
+  tracer.Drain();
+  EXPECT_EQ(4, events().size());
+  // Draining makes room for new events.
+  { tracing::ScopedActivity activity("op"); }
+  TF_ASSERT_OK(tracer.Stop());
+  EXPECT_EQ(5, events().size());
+  EXPECT_EQ(2, tracer.dropped_events());
+}
+
+TEST_F(SamplingTracerTest, RecordsEventsOfAllThreads) {
+  SamplingTracer tracer(MakeOptions(/*sampling_period=*/1, /*ring_size=*/16));
+  TF_ASSERT_OK(tracer.Start());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back(
+          Env::Default()->StartThread(ThreadOptions(), "worker", [] {
+            for (int j = 0; j < 5; ++j) {
+              tracing::ScopedActivity activity("op");
+            }
+          }));
+    }
+  }
+  TF_ASSERT_OK(tracer.Stop());
+  std::vector<SampledEvent> sampled = events();
+  EXPECT_EQ(20, sampled.size());
+  std::set<int32> thread_ids;
+  for (const SampledEvent& event : sampled) {
+    thread_ids.insert(event.thread_id);
+  }
+  EXPECT_EQ(4, thread_ids.size());
+}
+
+TEST_F(SamplingTracerTest, OnlyOneCollector) {
+  SamplingTracer tracer1(MakeOptions(/*sampling_period=*/1, /*ring_size=*/16));
+  SamplingTracer tracer2(MakeOptions(/*sampling_period=*/1, /*ring_size=*/16));
+  TF_ASSERT_OK(tracer1.Start());
+  EXPECT_TRUE(errors::IsUnavailable(tracer2.Start()));
+  TF_ASSERT_OK(tracer1.Stop());
+  TF_ASSERT_OK(tracer2.Start());
+  TF_ASSERT_OK(tracer2.Stop());
+}
+
+TEST_F(SamplingTracerTest, InvalidOptions) {
+  SamplingTracer::Options options = MakeOptions(0, 16);
+  EXPECT_TRUE(errors::IsInvalidArgument(SamplingTracer(options).Start()));
+  options = MakeOptions(1, 16);
+  options.sink = nullptr;
+  EXPECT_TRUE(errors::IsInvalidArgument(SamplingTracer(options).Start()));
+}
+
+}  // namespace
+}  // namespace tensorflow
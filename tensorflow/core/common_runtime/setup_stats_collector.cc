@@ -0,0 +1,86 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/setup_stats_collector.h"
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* session_setup_micros = monitoring::Counter<1>::New(
+    "/tensorflow/core/session_setup_micros",
+    "The wall time spent in each phase of preparing graphs for execution.",
+    "phase");
+
+}  // namespace
+
+void SetupStatsCollector::Record(const string& phase, int64 micros) {
+  session_setup_micros->GetCell(phase)->IncrementBy(micros);
+  mutex_lock l(mu_);
+  AddLocked(phase, micros);
+}
+
+void SetupStatsCollector::Merge(const SetupStats& stats) {
+  mutex_lock l(mu_);
+  for (const SetupStats::Phase& phase : stats.phases()) {
+    AddLocked(phase.name(), phase.wall_time_micros());
+  }
+}
+
+void SetupStatsCollector::Swap(SetupStats* stats) {
+  mutex_lock l(mu_);
+  stats->Clear();
+  stats->Swap(&stats_);
+  phase_index_.clear();
+}
+
+string SetupStatsCollector::ReportString() const {
+  mutex_lock l(mu_);
+  string report;
+  for (const SetupStats::Phase& phase : stats_.phases()) {
+    strings::Appendf(&report, "%12lld us  %s\n",
+                     static_cast<long long>(phase.wall_time_micros()),
+                     phase.name().c_str());
+  }
+  return report;
+}
+
+void SetupStatsCollector::AddLocked(const string& phase, int64 micros) {
+  auto it = phase_index_.find(phase);
+  if (it == phase_index_.end()) {
+    it = phase_index_.emplace(phase, stats_.phases_size()).first;
+    stats_.add_phases()->set_name(phase);
+  }
+  SetupStats::Phase* recorded = stats_.mutable_phases(it->second);
+  recorded->set_wall_time_micros(recorded->wall_time_micros() + micros);
+}
+
+ScopedSetupTimer::ScopedSetupTimer(SetupStatsCollector* collector,
+                                   const char* phase)
+    : collector_(collector),
+      phase_(phase),
+      start_micros_(collector ? Env::Default()->NowMicros() : 0) {}
+
+ScopedSetupTimer::~ScopedSetupTimer() {
+  if (collector_) {
+    collector_->Record(phase_, Env::Default()->NowMicros() - start_micros_);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SETUP_STATS_COLLECTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SETUP_STATS_COLLECTOR_H_
+
+#include <unordered_map>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// Accumulates the wall times of the phases that prepare a graph for
+// execution into a SetupStats. The times are also added to the
+// "/tensorflow/core/session_setup_micros" counter, labelled by phase, so
+// that they can be monitored across the sessions of a process.
+//
+// Thread-safe.
+class SetupStatsCollector {
+ public:
+  SetupStatsCollector() {}
+
+  // Adds "micros" to the wall time of "phase".
+  void Record(const string& phase, int64 micros);
+
+  // Adds the phases of "stats" to the phases recorded so far, without adding
+  // them to the counter again.
+  void Merge(const SetupStats& stats);
+
+  // Moves the phases recorded so far into "stats", and resets this.
+  void Swap(SetupStats* stats);
+
+  // Returns the phases recorded so far, one per line.
+  string ReportString() const;
+
+ private:
+  void AddLocked(const string& phase, int64 micros)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  SetupStats stats_ GUARDED_BY(mu_);
+  // The index of each phase in stats_.
+  std::unordered_map<string, int> phase_index_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SetupStatsCollector);
+};
+
+// Records the wall time from its construction to its destruction as "phase"
+// of "collector", unless "collector" is null.
+class ScopedSetupTimer {
+ public:
+  ScopedSetupTimer(SetupStatsCollector* collector, const char* phase);
+  ~ScopedSetupTimer();
+
+ private:
+  SetupStatsCollector* const collector_;
+  const char* const phase_;
+  const uint64 start_micros_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedSetupTimer);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SETUP_STATS_COLLECTOR_H_
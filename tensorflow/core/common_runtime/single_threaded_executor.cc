@@ -0,0 +1,362 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/single_threaded_executor.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/gtl/manual_constructor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<DeviceContext*, 4> DeviceContextVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+class SingleThreadedExecutorImpl : public Executor {
+ public:
+  explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
+      : params_(params) {}
+
+  ~SingleThreadedExecutorImpl() override {
+    for (const KernelState& kernel_state : kernels_) {
+      params_.delete_kernel(kernel_state.kernel);
+    }
+  }
+
+  Status Initialize(const Graph& graph) {
+    // Topologically sort `graph` once to get the sequence of kernels that is
+    // replayed by every step.
+    std::vector<Node*> ordered_nodes;
+    ordered_nodes.reserve(graph.num_nodes());
+    std::vector<Node*> all_nodes;
+    GetReversePostOrder(graph, &all_nodes);
+    for (Node* n : all_nodes) {
+      if (n->IsOp()) ordered_nodes.push_back(n);
+    }
+
+    // Create the kernel and input-related structures for each node.
+    gtl::FlatMap<const Node*, size_t> node_to_index;
+    kernels_.reserve(ordered_nodes.size());
+    size_t next_input_index = 0;
+    for (size_t i = 0; i < ordered_nodes.size(); ++i) {
+      const Node* n = ordered_nodes[i];
+      node_to_index[n] = i;
+      TF_RETURN_IF_ERROR(CheckSupported(n));
+
+      kernels_.emplace_back();
+      KernelState& kernel_state = kernels_.back();
+      Status s = params_.create_kernel(n->def(), &kernel_state.kernel);
+      if (!s.ok()) {
+        kernels_.pop_back();
+        return AttachDef(s, *n);
+      }
+      if (kernel_state.kernel->AsAsync() != nullptr) {
+        return errors::Unimplemented(
+            "Single-threaded executor does not support asynchronous "
+            "kernels: ",
+            SummarizeNode(*n));
+      }
+      kernel_state.input_start_index = next_input_index;
+      kernel_state.num_inputs = n->num_inputs();
+      kernel_state.num_outputs = n->num_outputs();
+      next_input_index += kernel_state.num_inputs;
+    }
+    total_num_inputs_ = next_input_index;
+
+    // Build the mapping from each node output to the input slots of its
+    // consumers, and the memory space of every output.
+    input_alloc_attrs_.resize(total_num_inputs_);
+    for (size_t i = 0; i < ordered_nodes.size(); ++i) {
+      const Node* n = ordered_nodes[i];
+      KernelState& kernel_state = kernels_[i];
+      kernel_state.output_locations.resize(kernel_state.num_outputs);
+      kernel_state.output_alloc_attrs.resize(kernel_state.num_outputs);
+      const MemoryTypeVector& output_memory_types =
+          kernel_state.kernel->output_memory_types();
+      for (size_t out = 0; out < kernel_state.num_outputs; ++out) {
+        DCHECK_LT(out, output_memory_types.size());
+        if (output_memory_types[out] == HOST_MEMORY) {
+          kernel_state.output_alloc_attrs[out].set_on_host(true);
+        }
+      }
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() || !e->dst()->IsOp()) continue;
+        const size_t location =
+            kernels_[node_to_index[e->dst()]].input_start_index +
+            e->dst_input();
+        kernel_state.output_locations[e->src_output()].push_back(location);
+        input_alloc_attrs_[location] =
+            kernel_state.output_alloc_attrs[e->src_output()];
+      }
+    }
+    return Status::OK();
+  }
+
+  void RunAsync(const Args& args, DoneCallback done) override {
+    // The inputs to each kernel are stored contiguously in `inputs`: the
+    // inputs of `kernels_[i]` are the `kernels_[i].num_inputs` elements
+    // starting at `kernels_[i].input_start_index`.
+    //
+    // We use `ManualConstructor<Tensor>` to avoid default-constructing a
+    // `Tensor` for each slot at the beginning of every step:
+    // * Elements are initialized when the outputs of a kernel are propagated
+    //   to the inputs of the kernels that depend on them.
+    // * The inputs of kernel `i` are destroyed right after kernel `i` runs,
+    //   which releases each intermediate tensor as soon as its last consumer
+    //   is done with it, and lets a kernel forward a buffer that has no other
+    //   consumer.
+    // * On error, `output_locations` tells which slots have already been
+    //   initialized, and those are destroyed by hand.
+    std::vector<ManualConstructor<Tensor>> inputs(total_num_inputs_);
+
+    TensorValueVec node_inputs;
+    DeviceContextVec input_device_contexts;
+    AllocatorAttributeVec input_alloc_attrs;
+
+    // Prepare the parameters that are the same for all kernels.
+    OpKernelContext::Params params;
+    params.step_id = args.step_id;
+    Device* device = params_.device;
+    params.device = device;
+    params.log_memory = false;
+    params.record_tensor_accesses = false;
+    params.rendezvous = args.rendezvous;
+    params.session_state = args.session_state;
+    params.tensor_store = args.tensor_store;
+    params.cancellation_manager = args.cancellation_manager;
+    params.call_frame = args.call_frame;
+    params.function_library = params_.function_library;
+    params.resource_manager = device->resource_manager();
+    params.step_container = args.step_container;
+    params.slice_reader_cache = nullptr;
+    params.inputs = &node_inputs;
+    params.input_device_contexts = &input_device_contexts;
+    params.input_alloc_attrs = &input_alloc_attrs;
+
+    Args::Runner runner_copy = args.runner;
+    params.runner = &runner_copy;
+    params.stats_collector = args.stats_collector;
+
+    // The graph has no control flow, so everything runs in the root frame.
+    params.frame_iter = FrameAndIter(0, 0);
+    params.is_input_dead = false;
+    params.op_device_context = nullptr;
+    params.forward_from_array = nullptr;
+
+    // Execute the kernels one at a time in topological order.
+    for (size_t i = 0; i < kernels_.size(); ++i) {
+      const KernelState& kernel_state = kernels_[i];
+
+      // Prepare the per-kernel parameters.
+      const size_t input_start_index = kernel_state.input_start_index;
+      const size_t num_inputs = kernel_state.num_inputs;
+      const size_t num_outputs = kernel_state.num_outputs;
+
+      node_inputs.clear();
+      node_inputs.resize(num_inputs);
+      input_alloc_attrs.clear();
+      input_alloc_attrs.resize(num_inputs);
+      for (size_t j = 0; j < num_inputs; ++j) {
+        node_inputs[j].tensor = inputs[input_start_index + j].get();
+        input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
+      }
+      input_device_contexts.clear();
+      input_device_contexts.resize(num_inputs);
+      params.op_kernel = kernel_state.kernel;
+      params.output_attr_array = kernel_state.output_alloc_attrs.data();
+      OpKernelContext ctx(&params, num_outputs);
+
+      // Only the timing of each kernel is recorded, as the kernels are not
+      // scheduled.
+      NodeExecStats* stats = nullptr;
+      if (args.stats_collector != nullptr) {
+        stats = new NodeExecStats;
+        stats->set_node_name(kernel_state.kernel->name());
+        const int64 start_micros = Env::Default()->NowMicros();
+        stats->set_scheduled_micros(start_micros);
+        stats->set_all_start_micros(start_micros);
+      }
+
+      device->Compute(kernel_state.kernel, &ctx);
+
+      if (stats != nullptr) {
+        const int64 elapsed_micros =
+            Env::Default()->NowMicros() - stats->all_start_micros();
+        stats->set_op_end_rel_micros(elapsed_micros);
+        stats->set_all_end_rel_micros(elapsed_micros);
+        args.stats_collector->Save(device->name(), stats);
+      }
+
+      Status s = ctx.status();
+      for (size_t j = 0; s.ok() && j < num_outputs; ++j) {
+        if (ctx.mutable_output(j) == nullptr &&
+            !kernel_state.output_locations[j].empty()) {
+          s = errors::Internal("Missing output ", j, " of ",
+                               SummarizeNodeDef(kernel_state.kernel->def()));
+        }
+      }
+      if (!s.ok()) {
+        // On failure, we must free all intermediate tensors. We scan through
+        // the previously executed kernels and destroy any tensor that was
+        // destined to be the input of a kernel that has not yet run
+        // (including kernel `i` itself).
+        for (size_t j = 0; j < i; ++j) {
+          const KernelState& executed_kernel_state = kernels_[j];
+          for (size_t k = 0; k < executed_kernel_state.num_outputs; ++k) {
+            for (size_t location : executed_kernel_state.output_locations[k]) {
+              if (location >= input_start_index) {
+                inputs[location].Destroy();
+              }
+            }
+          }
+        }
+        done(s);
+        return;
+      }
+
+      // Free the inputs to the current kernel.
+      for (size_t j = 0; j < num_inputs; ++j) {
+        inputs[input_start_index + j].Destroy();
+      }
+
+      // Forward the outputs of the kernel to the inputs of subsequent kernels.
+      for (size_t j = 0; j < num_outputs; ++j) {
+        TensorValue val = ctx.release_output(j);
+        if (val.tensor == nullptr) continue;
+        for (size_t location : kernel_state.output_locations[j]) {
+          inputs[location].Init(*val.tensor);
+        }
+        delete val.tensor;
+      }
+    }
+    done(Status::OK());
+  }
+
+ private:
+  // Returns an error if `n` cannot be executed by this executor.
+  static Status CheckSupported(const Node* n) {
+    for (DataType dt : n->output_types()) {
+      if (IsRefType(dt)) {
+        return errors::Unimplemented(
+            "Single-threaded executor does not support reference-typed "
+            "edges: ",
+            SummarizeNode(*n));
+      }
+    }
+    if (n->IsControlFlow()) {
+      return errors::Unimplemented(
+          "Single-threaded executor does not support control flow: ",
+          SummarizeNode(*n));
+    }
+    if (n->IsSend() || n->IsRecv()) {
+      return errors::Unimplemented(
+          "Single-threaded executor does not support partitioned graphs: ",
+          SummarizeNode(*n));
+    }
+    if (n->IsCollective()) {
+      return errors::Unimplemented(
+          "Single-threaded executor does not support collective ops: ",
+          SummarizeNode(*n));
+    }
+    return Status::OK();
+  }
+
+  const LocalExecutorParams params_;
+
+  // All following members are read-only after Initialize().
+
+  // The sum of the number of inputs of every kernel. This determines the
+  // length of the flat `inputs` vector in `RunAsync()`.
+  size_t total_num_inputs_ = 0;
+
+  // Cached graph structure state for each kernel.
+  struct KernelState {
+    // The kernel object. Created by `params_.create_kernel()` and released
+    // with `params_.delete_kernel()`.
+    OpKernel* kernel = nullptr;
+
+    // The range of elements of `inputs` that holds the inputs of `kernel`.
+    size_t input_start_index = 0;
+    size_t num_inputs = 0;
+
+    size_t num_outputs = 0;
+
+    // For the `j`th output of `kernel`, `output_locations[j]` contains the
+    // locations in the flat `inputs` vector to which that output must be
+    // copied. Length = `num_outputs`.
+    std::vector<std::vector<size_t>> output_locations;
+
+    // Memory space information of each output of `kernel`.
+    // Length = `num_outputs`.
+    std::vector<AllocatorAttributes> output_alloc_attrs;
+  };
+  std::vector<KernelState> kernels_;
+
+  // Memory space information of each input, in the same order as the flat
+  // `inputs` vector. Length = `total_num_inputs_`.
+  std::vector<AllocatorAttributes> input_alloc_attrs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SingleThreadedExecutorImpl);
+};
+
+class SingleThreadedExecutorRegistrar {
+ public:
+  SingleThreadedExecutorRegistrar() {
+    ExecutorFactory::Register("SINGLE_THREADED_EXECUTOR", new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params,
+                       std::unique_ptr<const Graph> graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(
+          NewSingleThreadedExecutor(params, std::move(graph), &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static SingleThreadedExecutorRegistrar registrar;
+
+}  // namespace
+
+Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
+                                 std::unique_ptr<const Graph> graph,
+                                 Executor** executor) {
+  std::unique_ptr<SingleThreadedExecutorImpl> impl(
+      new SingleThreadedExecutorImpl(params));
+  TF_RETURN_IF_ERROR(impl->Initialize(*graph));
+  *executor = impl.release();
+  return Status::OK();
+}
+
+}  // namespace tensorflow
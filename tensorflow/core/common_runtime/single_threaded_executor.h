@@ -0,0 +1,53 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SINGLE_THREADED_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SINGLE_THREADED_EXECUTOR_H_
+
+#include "tensorflow/core/common_runtime/executor.h"
+
+namespace tensorflow {
+
+// Creates a new `Executor` for executing `graph` synchronously on the caller
+// thread.
+//
+// At construction time the graph is sorted topologically once, and the input
+// slot that every node output must be forwarded to is computed up front, so
+// that running a step is a single pass over a flat list of kernels, without
+// pending counts, frames or atomic operations. Every tensor is released as
+// soon as its last consumer has run.
+//
+// The executor is meant for graphs that perform little work per step (tens of
+// microseconds), where issuing work to multiple threads and the bookkeeping of
+// the default executor dominate the cost of running the kernels themselves.
+// It has the following limitations:
+//
+// 1. Reference-typed tensors are not supported.
+// 2. Graphs with control flow (containing "Switch", "Merge", "Enter", "Exit"
+//    or "NextIteration" nodes) are not supported.
+// 3. Partitioned graphs (containing "_Send" or "_Recv" nodes) are not
+//    supported, since kernels run one at a time and cannot block on another
+//    graph.
+// 4. Asynchronous kernels and collective ops are not supported.
+//
+// The executor is registered with the `ExecutorFactory` as
+// "SINGLE_THREADED_EXECUTOR".
+Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
+                                 std::unique_ptr<const Graph> graph,
+                                 Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SINGLE_THREADED_EXECUTOR_H_
@@ -0,0 +1,244 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/single_threaded_executor.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+class SingleThreadedExecutorTest : public ::testing::Test {
+ protected:
+  SingleThreadedExecutorTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")) {}
+
+  ~SingleThreadedExecutorTest() override { delete device_; }
+
+  // Resets exec_ with a new executor based on `graph`.
+  Status Create(std::unique_ptr<const Graph> graph) {
+    const int version = graph->versions().producer();
+    LocalExecutorParams params;
+    params.device = device_;
+    params.create_kernel = [this, version](const NodeDef& ndef,
+                                           OpKernel** kernel) {
+      return CreateNonCachedKernel(device_, nullptr, ndef, version, kernel);
+    };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    exec_.reset();
+    return NewExecutor("SINGLE_THREADED_EXECUTOR", params, std::move(graph),
+                       &exec_);
+  }
+
+  // Runs exec_ with `args` as arguments, and returns its results in *rets.
+  Status Run(gtl::ArraySlice<Tensor> args, int num_rets,
+             std::vector<Tensor>* rets) {
+    DataTypeVector arg_types;
+    for (const Tensor& t : args) arg_types.push_back(t.dtype());
+    FunctionCallFrame call_frame(arg_types,
+                                 DataTypeVector(num_rets, DT_FLOAT));
+    TF_RETURN_IF_ERROR(call_frame.SetArgs(args));
+    Executor::Args exec_args;
+    exec_args.call_frame = &call_frame;
+    exec_args.runner = [](std::function<void()> fn) { fn(); };
+    TF_RETURN_IF_ERROR(exec_->Run(exec_args));
+    return call_frame.ConsumeRetvals(rets);
+  }
+
+  Device* device_ = nullptr;
+  std::unique_ptr<Executor> exec_;
+};
+
+Node* Arg(Graph* g, int index) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_Arg")
+                  .Attr("T", DT_FLOAT)
+                  .Attr("index", index)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+Node* Retval(Graph* g, Node* input, int index) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_Retval")
+                  .Input(input)
+                  .Attr("index", index)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+Tensor V(const float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+TEST_F(SingleThreadedExecutorTest, SimpleAdd) {
+  // c = a + b
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = Arg(g.get(), 0);
+  auto in1 = Arg(g.get(), 1);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  Retval(g.get(), tmp, 0);
+  TF_ASSERT_OK(Create(std::move(g)));
+  std::vector<Tensor> rets;
+  TF_ASSERT_OK(Run({V(1.0), V(1.0)}, 1, &rets));
+  ASSERT_EQ(1, rets.size());
+  test::ExpectTensorEqual<float>(V(2.0), rets[0]);
+}
+
+TEST_F(SingleThreadedExecutorTest, SelfAdd) {
+  // v0 <- a
+  // v1 = v0 + v0
+  // ...
+  // v10 = v9 + v9
+  // out <- v10
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto v = Arg(g.get(), 0);
+  const int N = 10;
+  for (int i = 1; i <= N; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  Retval(g.get(), v, 0);
+  TF_ASSERT_OK(Create(std::move(g)));
+  // Runs the same executor several times to check that no state leaks from
+  // one step to the next.
+  for (int iters = 0; iters < 3; ++iters) {
+    std::vector<Tensor> rets;
+    TF_ASSERT_OK(Run({V(1.0)}, 1, &rets));
+    test::ExpectTensorEqual<float>(V(1024.0), rets[0]);
+  }
+}
+
+TEST_F(SingleThreadedExecutorTest, RandomTree) {
+  // Adds 1024 copies of the argument in a random parenthesization.
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = Arg(g.get(), 0);
+  std::vector<Node*> nodes;
+  for (int i = 0; i < 1024; ++i) {
+    nodes.push_back(test::graph::Identity(g.get(), in, 0));
+  }
+  random::PhiloxRandom philox(testing::RandomSeed(), 17);
+  random::SimplePhilox rnd(&philox);
+  while (nodes.size() > 1) {
+    int x = rnd.Uniform(nodes.size());
+    auto in0 = nodes[x];
+    nodes[x] = nodes.back();
+    nodes.resize(nodes.size() - 1);
+    x = rnd.Uniform(nodes.size());
+    auto in1 = nodes[x];
+    nodes[x] = test::graph::Add(g.get(), in0, in1);
+  }
+  Retval(g.get(), nodes.back(), 0);
+  TF_ASSERT_OK(Create(std::move(g)));
+  std::vector<Tensor> rets;
+  TF_ASSERT_OK(Run({V(1.0)}, 1, &rets));
+  test::ExpectTensorEqual<float>(V(1024.0), rets[0]);
+}
+
+TEST_F(SingleThreadedExecutorTest, ControlDependenciesAreRespected) {
+  // "add" must run after "noop", which only has a control edge to it.
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = Arg(g.get(), 0);
+  auto two = test::graph::Constant(g.get(), V(2.0));
+  auto mul = test::graph::Binary(g.get(), "Mul", in, two);
+  auto noop = test::graph::NoOp(g.get(), {mul});
+  auto add = test::graph::Add(g.get(), mul, in);
+  g->AddControlEdge(noop, add);
+  Retval(g.get(), add, 0);
+  TF_ASSERT_OK(Create(std::move(g)));
+  std::vector<Tensor> rets;
+  TF_ASSERT_OK(Run({V(3.0)}, 1, &rets));
+  test::ExpectTensorEqual<float>(V(9.0), rets[0]);
+}
+
+TEST_F(SingleThreadedExecutorTest, KernelErrorIsPropagated) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = Arg(g.get(), 0);
+  // The output of "in" is still live (consumed by "add") when "err" fails.
+  auto err = test::graph::Error(g.get(), in, "fail");
+  auto add = test::graph::Add(g.get(), in, err);
+  Retval(g.get(), add, 0);
+  TF_ASSERT_OK(Create(std::move(g)));
+  std::vector<Tensor> rets;
+  Status s = Run({V(1.0)}, 1, &rets);
+  EXPECT_TRUE(errors::IsInternal(s)) << s;
+}
+
+TEST_F(SingleThreadedExecutorTest, ControlFlowIsUnimplemented) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = Arg(g.get(), 0);
+  auto in1 = test::graph::Constant(g.get(), test::AsScalar<bool>(true));
+  auto sw = test::graph::Switch(g.get(), in0, in1);
+  Retval(g.get(), sw, 0);
+  EXPECT_TRUE(errors::IsUnimplemented(Create(std::move(g))));
+}
+
+TEST_F(SingleThreadedExecutorTest, PartitionedGraphIsUnimplemented) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = test::graph::Recv(g.get(), "a", "float",
+                              "/job:localhost/replica:0/task:0/cpu:0", 1,
+                              "/job:localhost/replica:0/task:0/cpu:0");
+  Retval(g.get(), in, 0);
+  EXPECT_TRUE(errors::IsUnimplemented(Create(std::move(g))));
+}
+
+// A chain of 'depth' Identity nodes, to measure the per-node overhead of the
+// executor.
+static void BM_chain(int iters, int depth, const char* executor_type) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* v = test::graph::Constant(g, V(1.0));
+  for (int i = 0; i < depth; ++i) {
+    v = test::graph::Identity(g, v, 0);
+  }
+#ifdef PLATFORM_GOOGLE
+  SetBenchmarkItemsProcessed(static_cast<int64>(depth) * iters);
+#endif  // PLATFORM_GOOGLE
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr, executor_type)
+      .Run(iters);
+}
+
+static void BM_SingleThreadedExecutorChain(int iters, int depth) {
+  BM_chain(iters, depth, "SINGLE_THREADED_EXECUTOR");
+}
+static void BM_DefaultExecutorChain(int iters, int depth) {
+  BM_chain(iters, depth, "");
+}
+BENCHMARK(BM_SingleThreadedExecutorChain)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_DefaultExecutorChain)->Arg(16)->Arg(256)->Arg(4096);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,185 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Arenas kept by a StepArenaPool beyond this many are destroyed, which bounds
+// the memory held on behalf of concurrent steps that have finished.
+const size_t kMaxFreeArenas = 8;
+
+size_t RoundUp(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t block_size)
+    : base_(base), block_size_(RoundUp(block_size, kAllocatorAlignment)) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  mutex_lock l(mu_);
+  CHECK(large_allocations_.empty());
+  FreeBlocks();
+}
+
+bool StepArenaAllocator::AddBlock(size_t min_bytes) {
+  const size_t size = std::max(block_size_, min_bytes);
+  char* data =
+      static_cast<char*>(base_->AllocateRaw(kAllocatorAlignment, size));
+  if (data == nullptr) return false;
+  blocks_.push_back({data, size});
+  offset_ = 0;
+  stats_.bytes_limit =
+      std::max<int64>(stats_.bytes_limit, bytes_reserved_locked());
+  return true;
+}
+
+void StepArenaAllocator::FreeBlocks() {
+  for (const Block& b : blocks_) {
+    base_->DeallocateRaw(b.data);
+  }
+  blocks_.clear();
+  offset_ = 0;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, kAllocatorAlignment);
+  if (num_bytes > block_size_) {
+    void* ptr = base_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) return nullptr;
+    Ref();
+    mutex_lock l(mu_);
+    large_allocations_.insert(ptr);
+    ++stats_.num_allocs;
+    stats_.max_alloc_size =
+        std::max<int64>(stats_.max_alloc_size, num_bytes);
+    return ptr;
+  }
+
+  mutex_lock l(mu_);
+  size_t start = blocks_.empty() ? 0 : RoundUp(offset_, alignment);
+  if (blocks_.empty() || start + num_bytes > blocks_.back().size) {
+    if (!AddBlock(num_bytes)) return nullptr;
+    start = 0;
+  }
+  offset_ = start + num_bytes;
+  bytes_used_ += num_bytes;
+  ++stats_.num_allocs;
+  stats_.bytes_in_use = bytes_used_;
+  stats_.max_bytes_in_use =
+      std::max<int64>(stats_.max_bytes_in_use, stats_.bytes_in_use);
+  stats_.max_alloc_size = std::max<int64>(stats_.max_alloc_size, num_bytes);
+  Ref();
+  return blocks_.back().data + start;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  bool is_large;
+  {
+    mutex_lock l(mu_);
+    is_large = large_allocations_.erase(ptr) > 0;
+  }
+  // Memory from the blocks is only reclaimed by Reset().
+  if (is_large) {
+    base_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+void StepArenaAllocator::GetStats(AllocatorStats* stats) {
+  mutex_lock l(mu_);
+  *stats = stats_;
+}
+
+void StepArenaAllocator::ClearStats() {
+  mutex_lock l(mu_);
+  stats_.num_allocs = 0;
+  stats_.max_bytes_in_use = stats_.bytes_in_use;
+  stats_.max_alloc_size = 0;
+}
+
+void StepArenaAllocator::Reset() {
+  CHECK(RefCountIsOne());
+  mutex_lock l(mu_);
+  if (blocks_.size() > 1) {
+    // Everything the step bump-allocated, plus slack for alignment and for
+    // the unused tails of the blocks, fits in one block this large.
+    const size_t needed = bytes_reserved_locked();
+    FreeBlocks();
+    AddBlock(needed);
+  }
+  offset_ = 0;
+  bytes_used_ = 0;
+  stats_.bytes_in_use = 0;
+}
+
+size_t StepArenaAllocator::bytes_reserved() {
+  mutex_lock l(mu_);
+  return bytes_reserved_locked();
+}
+
+size_t StepArenaAllocator::bytes_reserved_locked() {
+  size_t total = 0;
+  for (const Block& b : blocks_) {
+    total += b.size;
+  }
+  return total;
+}
+
+StepArenaPool::StepArenaPool(Allocator* base, size_t block_size)
+    : base_(base), block_size_(block_size) {}
+
+StepArenaPool::~StepArenaPool() {
+  mutex_lock l(mu_);
+  for (StepArenaAllocator* arena : free_arenas_) {
+    arena->Unref();
+  }
+}
+
+StepArenaAllocator* StepArenaPool::Acquire() {
+  {
+    mutex_lock l(mu_);
+    if (!free_arenas_.empty()) {
+      StepArenaAllocator* arena = free_arenas_.back();
+      free_arenas_.pop_back();
+      return arena;
+    }
+  }
+  return new StepArenaAllocator(base_, block_size_);
+}
+
+void StepArenaPool::Release(StepArenaAllocator* arena) {
+  // No new allocations are made from 'arena' once its step is done, so the
+  // reference count can only decrease from here on.
+  if (arena->RefCountIsOne()) {
+    arena->Reset();
+    mutex_lock l(mu_);
+    if (free_arenas_.size() < kMaxFreeArenas) {
+      free_arenas_.push_back(arena);
+      return;
+    }
+  }
+  arena->Unref();
+}
+
+}  // namespace tensorflow
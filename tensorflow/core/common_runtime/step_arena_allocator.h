@@ -0,0 +1,126 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// StepArenaAllocator bump-allocates the buffers of one step from large
+// blocks obtained from a base allocator. Deallocating a buffer does not
+// return its memory; all of it is reclaimed at once when the arena is
+// Reset() after the step.
+//
+// Every live allocation holds a reference on the arena, so a buffer that
+// outlives the step (e.g. a fetched tensor that aliases an intermediate)
+// keeps the arena alive; it is destroyed, and its blocks returned to the
+// base allocator, when the last such buffer is freed. Requests larger than
+// the block size are passed through to the base allocator.
+//
+// Thread-safe.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  // Does not take ownership of 'base', which must outlive the arena.
+  StepArenaAllocator(Allocator* base, size_t block_size);
+  ~StepArenaAllocator() override;
+
+  string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  void GetStats(AllocatorStats* stats) override;
+  void ClearStats() override;
+
+  // Makes all memory of the arena available again. Requires that no
+  // allocation is live, i.e. RefCountIsOne(). If the previous step needed
+  // more than one block, they are replaced by a single block large enough
+  // for all of them, so that a steady-state step bump-allocates from one
+  // contiguous block.
+  void Reset();
+
+  // The number of bytes currently reserved from the base allocator for
+  // blocks.
+  size_t bytes_reserved();
+
+ private:
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  // Appends a new block of at least 'min_bytes' to blocks_.
+  bool AddBlock(size_t min_bytes) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FreeBlocks() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  size_t bytes_reserved_locked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;
+  const size_t block_size_;
+
+  mutex mu_;
+  std::vector<Block> blocks_ GUARDED_BY(mu_);
+  // The offset of the first free byte in blocks_.back().
+  size_t offset_ GUARDED_BY(mu_) = 0;
+  // Bytes handed out from blocks_ since the last Reset().
+  size_t bytes_used_ GUARDED_BY(mu_) = 0;
+  // Allocations passed through to base_.
+  std::unordered_set<void*> large_allocations_ GUARDED_BY(mu_);
+  AllocatorStats stats_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+// A set of StepArenaAllocators that are reused across steps.
+//
+// Thread-safe.
+class StepArenaPool {
+ public:
+  // Does not take ownership of 'base', which must outlive the pool and all
+  // arenas obtained from it.
+  StepArenaPool(Allocator* base, size_t block_size);
+  ~StepArenaPool();
+
+  // Returns an arena for a new step. The caller owns one reference on the
+  // returned arena, which it must pass back to Release() when the step is
+  // done.
+  StepArenaAllocator* Acquire();
+
+  // Ends the step that used 'arena'. If no allocation from 'arena' is live
+  // anymore, the arena is reset and kept for a later step. Otherwise it is
+  // left to be destroyed when its last allocation is freed.
+  void Release(StepArenaAllocator* arena);
+
+ private:
+  Allocator* const base_;
+  const size_t block_size_;
+
+  mutex mu_;
+  std::vector<StepArenaAllocator*> free_arenas_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaPool);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
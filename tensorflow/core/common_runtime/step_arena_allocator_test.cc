@@ -0,0 +1,128 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(StepArenaAllocatorTest, BumpAllocates) {
+  StepArenaAllocator* arena = new StepArenaAllocator(cpu_allocator(), 1024);
+  char* p1 = static_cast<char*>(arena->AllocateRaw(64, 100));
+  char* p2 = static_cast<char*>(arena->AllocateRaw(64, 100));
+  ASSERT_NE(nullptr, p1);
+  EXPECT_EQ(p1 + 128, p2);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p2) % 64);
+  EXPECT_EQ(1024, arena->bytes_reserved());
+
+  // Does not fit in the rest of the block.
+  char* p3 = static_cast<char*>(arena->AllocateRaw(64, 900));
+  ASSERT_NE(nullptr, p3);
+  EXPECT_EQ(2048, arena->bytes_reserved());
+
+  AllocatorStats stats;
+  arena->GetStats(&stats);
+  EXPECT_EQ(3, stats.num_allocs);
+  EXPECT_EQ(1100, stats.bytes_in_use);
+
+  EXPECT_FALSE(arena->RefCountIsOne());
+  arena->DeallocateRaw(p1);
+  arena->DeallocateRaw(p2);
+  arena->DeallocateRaw(p3);
+  ASSERT_TRUE(arena->RefCountIsOne());
+
+  // The two blocks are merged, so that the same allocations fit in one.
+  arena->Reset();
+  EXPECT_EQ(2048, arena->bytes_reserved());
+  p1 = static_cast<char*>(arena->AllocateRaw(64, 100));
+  p3 = static_cast<char*>(arena->AllocateRaw(64, 900));
+  EXPECT_EQ(p1 + 128, p3);
+  arena->DeallocateRaw(p1);
+  arena->DeallocateRaw(p3);
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsBypassArena) {
+  StepArenaAllocator* arena = new StepArenaAllocator(cpu_allocator(), 1024);
+  void* p = arena->AllocateRaw(64, 4096);
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(0, arena->bytes_reserved());
+  arena->DeallocateRaw(p);
+  arena->Unref();
+}
+
+TEST(StepArenaAllocatorTest, TensorsKeepArenaAlive) {
+  StepArenaPool pool(cpu_allocator(), 1 << 20);
+  StepArenaAllocator* arena = pool.Acquire();
+  Tensor t(arena, DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&t, {1, 2, 3, 4});
+  {
+    Tensor dead(arena, DT_FLOAT, TensorShape({16}));
+  }
+  // 't' escapes the step, so the arena cannot be reused...
+  pool.Release(arena);
+  StepArenaAllocator* arena2 = pool.Acquire();
+  EXPECT_NE(arena, arena2);
+  Tensor t2(arena2, DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&t2, {5, 6, 7, 8});
+  // ...and its buffer stays valid.
+  test::ExpectTensorEqual<float>(
+      t, test::AsTensor<float>({1, 2, 3, 4}, TensorShape({4})));
+  t2 = Tensor();
+  pool.Release(arena2);
+
+  // 'arena2' had no live allocation when released, so it is reused.
+  EXPECT_EQ(arena2, pool.Acquire());
+  pool.Release(arena2);
+}
+
+TEST(StepArenaAllocatorTest, StringTensors) {
+  StepArenaPool pool(cpu_allocator(), 1 << 20);
+  for (int step = 0; step < 3; ++step) {
+    StepArenaAllocator* arena = pool.Acquire();
+    {
+      Tensor t(arena, DT_STRING, TensorShape({3}));
+      t.vec<string>()(0) = "a string that does not fit in the small buffer";
+      EXPECT_EQ(2, t.vec<string>()(0).find("string"));
+    }
+    pool.Release(arena);
+  }
+}
+
+static void BM_StepArenaAllocation(int iters, int num_allocs) {
+  StepArenaPool pool(cpu_allocator(), 1 << 20);
+  std::vector<void*> ptrs(num_allocs);
+  while (iters-- > 0) {
+    StepArenaAllocator* arena = pool.Acquire();
+    for (int i = 0; i < num_allocs; ++i) {
+      ptrs[i] = arena->AllocateRaw(64, 256 + 64 * (i % 8));
+    }
+    for (int i = 0; i < num_allocs; ++i) {
+      arena->DeallocateRaw(ptrs[i]);
+    }
+    pool.Release(arena);
+  }
+}
+BENCHMARK(BM_StepArenaAllocation)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,89 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_scheduler.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+StepAdmissionQueue::StepAdmissionQueue(int max_running_steps)
+    : max_running_steps_(max_running_steps) {
+  CHECK_GT(max_running_steps, 0);
+}
+
+void StepAdmissionQueue::Admit(int priority) {
+  mutex_lock l(mu_);
+  const Ticket ticket(-priority, next_arrival_++);
+  waiting_.insert(ticket);
+  while (num_running_ >= max_running_steps_ || *waiting_.begin() != ticket) {
+    cond_.wait(l);
+  }
+  waiting_.erase(waiting_.begin());
+  ++num_running_;
+  // The next waiting step may be admitted too if there is room left.
+  if (!waiting_.empty() && num_running_ < max_running_steps_) {
+    cond_.notify_all();
+  }
+}
+
+void StepAdmissionQueue::Release() {
+  mutex_lock l(mu_);
+  CHECK_GT(num_running_, 0);
+  --num_running_;
+  if (!waiting_.empty()) cond_.notify_all();
+}
+
+int StepAdmissionQueue::num_waiting() {
+  mutex_lock l(mu_);
+  return waiting_.size();
+}
+
+BoundedStepRunner::BoundedStepRunner(Scheduler schedule, int max_parallelism)
+    : schedule_(std::move(schedule)), max_parallelism_(max_parallelism) {
+  CHECK_GT(max_parallelism, 0);
+}
+
+void BoundedStepRunner::Run(Closure c) {
+  {
+    mutex_lock l(mu_);
+    if (num_scheduled_ >= max_parallelism_) {
+      queued_.push_back(std::move(c));
+      return;
+    }
+    ++num_scheduled_;
+  }
+  schedule_(std::bind(&BoundedStepRunner::RunAndDrain, shared_from_this(),
+                      std::move(c)));
+}
+
+void BoundedStepRunner::RunAndDrain(const Closure& first) {
+  first();
+  Closure c;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (queued_.empty()) {
+        --num_scheduled_;
+        return;
+      }
+      c = std::move(queued_.front());
+      queued_.pop_front();
+    }
+    c();
+  }
+}
+
+}  // namespace tensorflow
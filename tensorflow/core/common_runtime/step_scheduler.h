@@ -0,0 +1,103 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_SCHEDULER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <utility>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Bounds the number of steps that run at the same time. The steps that
+// exceed the bound wait to be admitted, the ones with the highest priority
+// first, and in arrival order among equal priorities.
+//
+// Thread-safe.
+class StepAdmissionQueue {
+ public:
+  // 'max_running_steps' must be positive.
+  explicit StepAdmissionQueue(int max_running_steps);
+
+  // Blocks until fewer than 'max_running_steps' steps are running and no
+  // waiting step takes precedence over this one, then counts it as running.
+  // Every Admit() must be matched by a Release() when the step is done.
+  void Admit(int priority);
+  void Release();
+
+  // The number of steps waiting in Admit().
+  int num_waiting();
+
+ private:
+  // Ordered so that the first element is the next step to admit.
+  typedef std::pair<int, int64> Ticket;  // (-priority, arrival)
+
+  const int max_running_steps_;
+
+  mutex mu_;
+  condition_variable cond_;
+  int num_running_ GUARDED_BY(mu_) = 0;
+  int64 next_arrival_ GUARDED_BY(mu_) = 0;
+  std::set<Ticket> waiting_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepAdmissionQueue);
+};
+
+// Runs the closures of one step through a scheduling function, e.g. one that
+// schedules them on an inter-op thread pool, with at most
+// 'max_parallelism' of them scheduled or running at a time. The others are
+// queued and run in order as earlier ones finish, on the threads that ran
+// those, so a step cannot take more than its share of a shared pool.
+//
+// Closures must not block waiting for other closures of the same step, or
+// the step may deadlock once its parallelism is exhausted.
+//
+// Thread-safe. Scheduled closures keep the runner alive.
+class BoundedStepRunner
+    : public std::enable_shared_from_this<BoundedStepRunner> {
+ public:
+  typedef std::function<void()> Closure;
+  typedef std::function<void(Closure)> Scheduler;
+
+  // 'max_parallelism' must be positive.
+  BoundedStepRunner(Scheduler schedule, int max_parallelism);
+
+  void Run(Closure c);
+
+ private:
+  // Runs 'first', then the queued closures until none is left.
+  void RunAndDrain(const Closure& first);
+
+  const Scheduler schedule_;
+  const int max_parallelism_;
+
+  mutex mu_;
+  int num_scheduled_ GUARDED_BY(mu_) = 0;
+  std::deque<Closure> queued_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BoundedStepRunner);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_SCHEDULER_H_
@@ -0,0 +1,138 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_scheduler.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(BoundedStepRunnerTest, QueuesBeyondParallelism) {
+  std::vector<BoundedStepRunner::Closure> scheduled;
+  std::shared_ptr<BoundedStepRunner> runner =
+      std::make_shared<BoundedStepRunner>(
+          [&scheduled](BoundedStepRunner::Closure c) {
+            scheduled.push_back(std::move(c));
+          },
+          2);
+
+  std::vector<int> ran;
+  for (int i = 0; i < 5; ++i) {
+    runner->Run([&ran, i]() { ran.push_back(i); });
+  }
+  ASSERT_EQ(2, scheduled.size());
+
+  // The first scheduled closure runs the queued ones after itself.
+  scheduled[0]();
+  EXPECT_EQ(std::vector<int>({0, 2, 3, 4}), ran);
+  scheduled[1]();
+  EXPECT_EQ(std::vector<int>({0, 2, 3, 4, 1}), ran);
+
+  // The runner has room again.
+  runner->Run([&ran]() { ran.push_back(5); });
+  ASSERT_EQ(3, scheduled.size());
+  scheduled[2]();
+  EXPECT_EQ(5, ran.back());
+}
+
+TEST(BoundedStepRunnerTest, BoundsConcurrency) {
+  thread::ThreadPool pool(Env::Default(), "test", 8);
+  std::shared_ptr<BoundedStepRunner> runner =
+      std::make_shared<BoundedStepRunner>(
+          [&pool](BoundedStepRunner::Closure c) { pool.Schedule(c); }, 3);
+
+  const int kNumClosures = 100;
+  std::atomic<int> num_running(0);
+  std::atomic<int> max_running(0);
+  BlockingCounter done(kNumClosures);
+  for (int i = 0; i < kNumClosures; ++i) {
+    runner->Run([&]() {
+      const int running = num_running.fetch_add(1) + 1;
+      int max = max_running.load();
+      while (running > max &&
+             !max_running.compare_exchange_weak(max, running)) {
+      }
+      Env::Default()->SleepForMicroseconds(100);
+      num_running.fetch_sub(1);
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  EXPECT_LE(max_running.load(), 3);
+}
+
+TEST(StepAdmissionQueueTest, AdmitsByPriority) {
+  StepAdmissionQueue queue(1);
+  queue.Admit(0);
+
+  mutex mu;
+  std::vector<int> admitted;
+  thread::ThreadPool pool(Env::Default(), "test", 3);
+  BlockingCounter done(3);
+  const std::vector<int> priorities = {1, 5, 1};
+  for (int i = 0; i < priorities.size(); ++i) {
+    const int priority = priorities[i];
+    pool.Schedule([&, priority]() {
+      queue.Admit(priority);
+      {
+        mutex_lock l(mu);
+        admitted.push_back(priority);
+      }
+      queue.Release();
+      done.DecrementCount();
+    });
+    // Make the arrival order deterministic.
+    while (queue.num_waiting() < i + 1) {
+      Env::Default()->SleepForMicroseconds(100);
+    }
+  }
+
+  queue.Release();
+  done.Wait();
+  EXPECT_EQ(std::vector<int>({5, 1, 1}), admitted);
+}
+
+TEST(StepAdmissionQueueTest, AdmitsUpToMaxRunningSteps) {
+  StepAdmissionQueue queue(2);
+  queue.Admit(0);
+  queue.Admit(0);
+  EXPECT_EQ(0, queue.num_waiting());
+
+  Notification admitted;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "admit", [&]() {
+        queue.Admit(0);
+        admitted.Notify();
+      }));
+  while (queue.num_waiting() < 1) {
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  EXPECT_FALSE(admitted.HasBeenNotified());
+  queue.Release();
+  admitted.WaitForNotification();
+  queue.Release();
+  queue.Release();
+}
+
+}  // namespace
+}  // namespace tensorflow
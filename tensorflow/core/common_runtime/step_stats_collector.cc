@@ -63,6 +63,7 @@ void NodeExecStatsWrapper::Finalize() {
       auto* r = memory->add_allocation_records();
       r->set_alloc_bytes(record.alloc_bytes);
       r->set_alloc_micros(record.alloc_micros);
+      r->set_allocation_id(record.allocation_id);
     }
   }
   allocations_.clear();
@@ -280,6 +281,16 @@ void StepStatsCollector::Save(const string& device,
   }
 }
 
+void StepStatsCollector::SaveMemoryPlanStats(const string& device,
+                                             const MemoryPlanStats& stats) {
+  mutex_lock l(mu_);
+  if (finalized_) {
+    LOG(WARNING) << "stats saved after finalize will not be collected.";
+  }
+  if (!step_stats_) return;
+  memory_plan_stats_[device].push_back(stats);
+}
+
 string StepStatsCollector::ReportAllocsOnResourceExhausted(const string& err) {
   mutex_lock l(mu_);
   if (err.find("OOM") == err.npos) {
@@ -393,5 +404,16 @@ void StepStatsCollector::FinalizeInternal() {
       stats->stats()->Swap(dss->add_node_stats());
     }
   }
+  for (const auto& plan_stats : memory_plan_stats_) {
+    if (dev_stats_pb.find(plan_stats.first) == dev_stats_pb.end()) {
+      DeviceStepStats* ndev_stat = step_stats_->add_dev_stats();
+      ndev_stat->set_device(plan_stats.first);
+      dev_stats_pb[plan_stats.first] = ndev_stat;
+    }
+    DeviceStepStats* dss = dev_stats_pb.at(plan_stats.first);
+    for (const MemoryPlanStats& stats : plan_stats.second) {
+      *dss->add_memory_plans() = stats;
+    }
+  }
 }
 }  // namespace tensorflow
@@ -82,6 +82,10 @@ class StepStatsCollector {
   void Save(const string& device, NodeExecStats* nt);
   void Save(const string& device, NodeExecStatsWrapper* stats);
 
+  // Saves the state of a memory plan of an executor on 'device'.
+  void SaveMemoryPlanStats(const string& device,
+                           const MemoryPlanStats& stats);
+
   // Generates a string reporting the currently used memory based
   // on ResourceExhausted OOM `err` message.
   // `err` message needs to contain device name and allocator name, E.g.:
@@ -106,6 +110,8 @@ class StepStatsCollector {
   mutex mu_;
   bool finalized_ GUARDED_BY(mu_);
   std::unordered_map<string, NodeExecStatsVec> dev_stats_ GUARDED_BY(mu_);
+  std::unordered_map<string, std::vector<MemoryPlanStats>> memory_plan_stats_
+      GUARDED_BY(mu_);
   StepStats* step_stats_ GUARDED_BY(mu_);
   uint64 collectedNodes GUARDED_BY(mu_) = 0;
 };
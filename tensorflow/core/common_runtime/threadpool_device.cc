@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -35,7 +37,6 @@ limitations under the License.
 #include <omp.h>
 #endif
 #include "tensorflow/core/common_runtime/mkl_cpu_allocator.h"
-#include "tensorflow/core/platform/cpu_info.h"
 #endif
 
 namespace tensorflow {
@@ -48,6 +49,12 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  if (UseNUMAAffinity(options) && locality.numa_node() >= 0 &&
+      locality.numa_node() < port::NUMANumNodes()) {
+    // Run the kernels of this device on the CPUs of its NUMA node.
+    set_tensorflow_device_thread_pool(
+        NUMAComputePool(options, locality.numa_node()));
+  }
 #ifdef INTEL_MKL
 #ifdef _OPENMP
   const char* user_omp_threads = getenv("OMP_NUM_THREADS");
@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <vector>
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -35,10 +37,18 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
     if (iter != options.config.device_count().end()) {
       n = iter->second;
     }
+    const bool use_numa = UseNUMAAffinity(options);
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
-      devices->push_back(new ThreadPoolDevice(
-          options, name, Bytes(256 << 20), DeviceLocality(), cpu_allocator()));
+      DeviceLocality locality;
+      Allocator* allocator = cpu_allocator();
+      if (use_numa) {
+        const int numa_node = i % port::NUMANumNodes();
+        locality.set_numa_node(numa_node);
+        allocator = cpu_allocator(numa_node);
+      }
+      devices->push_back(new ThreadPoolDevice(options, name, Bytes(256 << 20),
+                                              locality, allocator));
     }
 
     return Status::OK();
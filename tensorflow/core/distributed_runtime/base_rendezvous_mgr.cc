@@ -101,6 +101,15 @@ Status BaseRendezvousMgr::RecvLocal(int64 step_id,
   return ret;
 }
 
+Status BaseRendezvousMgr::RecvPushed(int64 step_id,
+                                     const Rendezvous::ParsedKey& parsed,
+                                     const Tensor& val, bool is_dead) {
+  BaseRemoteRendezvous* rendez = FindOrCreate(step_id);
+  Status s = rendez->RecvPushed(parsed, val, is_dead);
+  rendez->Unref();
+  return s;
+}
+
 void BaseRendezvousMgr::Cleanup(int64 step_id) {
   Rendezvous* rendez = nullptr;
   {
@@ -174,6 +183,22 @@ Status BaseRemoteRendezvous::Initialize(WorkerSession* session) {
   return Status::OK();
 }
 
+void BaseRemoteRendezvous::SetPushTensors(bool push_tensors) {
+  mutex_lock l(mu_);
+  push_tensors_ = push_tensors;
+}
+
+void BaseRemoteRendezvous::SetCoalesceRecvs(bool coalesce_recvs) {
+  mutex_lock l(mu_);
+  coalesce_recvs_ = coalesce_recvs;
+}
+
+void BaseRemoteRendezvous::SetRecvTensorEncoding(
+    const TensorTransportEncoding& encoding) {
+  mutex_lock l(mu_);
+  recv_tensor_encoding_ = encoding;
+}
+
 WorkerSession* BaseRemoteRendezvous::session() {
   mutex_lock l(mu_);
   return session_;
@@ -184,10 +209,21 @@ bool BaseRemoteRendezvous::is_initialized() {
   return is_initialized_locked();
 }
 
+bool BaseRemoteRendezvous::coalesce_recvs() {
+  mutex_lock l(mu_);
+  return coalesce_recvs_;
+}
+
+TensorTransportEncoding BaseRemoteRendezvous::recv_tensor_encoding() {
+  mutex_lock l(mu_);
+  return recv_tensor_encoding_;
+}
+
 Status BaseRemoteRendezvous::Send(const Rendezvous::ParsedKey& parsed,
                                   const Rendezvous::Args& args,
                                   const Tensor& val, const bool is_dead) {
   VLOG(1) << "BaseRemoteRendezvous Send " << this << " " << parsed.FullKey();
+  bool push_tensors;
   {
     mutex_lock l(mu_);
     if (!status_.ok()) return status_;
@@ -197,6 +233,10 @@ Status BaseRemoteRendezvous::Send(const Rendezvous::ParsedKey& parsed,
           "Invalid rendezvous key (src): ", parsed.FullKey(), " @ ",
           session_->worker_name);
     }
+    push_tensors = push_tensors_;
+  }
+  if (push_tensors && !IsSameWorker(parsed.src, parsed.dst)) {
+    return PushToRemote(parsed, args, val, is_dead);
   }
   // Buffers "val" and "device_context" in local_.
   return local_->Send(parsed, args, val, is_dead);
@@ -284,6 +324,14 @@ void BaseRemoteRendezvous::SameWorkerRecvDone(
                      std::move(done));
 }
 
+Status BaseRemoteRendezvous::PushToRemote(const Rendezvous::ParsedKey& parsed,
+                                          const Rendezvous::Args& args,
+                                          const Tensor& val, bool is_dead) {
+  return errors::Unimplemented(
+      "This rendezvous does not support pushing tensors to remote workers: ",
+      parsed.FullKey());
+}
+
 bool BaseRemoteRendezvous::IsSameWorker(DeviceNameUtils::ParsedName src,
                                         DeviceNameUtils::ParsedName dst) {
   return DeviceNameUtils::IsSameAddressSpace(src, dst);
@@ -324,10 +372,82 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
         });
     return;
   } else {
-    RecvFromRemoteAsync(parsed, recv_args, std::move(done));
+    bool push_tensors;
+    {
+      mutex_lock l(mu_);
+      push_tensors = push_tensors_;
+    }
+    if (push_tensors) {
+      RecvPushedAsync(parsed, recv_args, std::move(done));
+    } else {
+      RecvFromRemoteAsync(parsed, recv_args, std::move(done));
+    }
   }
 }
 
+Status BaseRemoteRendezvous::RecvPushed(const ParsedKey& parsed,
+                                        const Tensor& val, bool is_dead) {
+  // The tensor may be pushed before the RunGraph (or PartialRunStep) RPC of
+  // this step arrives from the master, in which case it is buffered in
+  // local_ until a consumer is initialized.
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) return status_;
+  }
+  Rendezvous::Args send_args;
+  send_args.alloc_attrs.set_on_host(true);
+  return local_->Send(parsed, send_args, val, is_dead);
+}
+
+void BaseRemoteRendezvous::RecvPushedAsync(const ParsedKey& parsed,
+                                           const Rendezvous::Args& recv_args,
+                                           DoneCallback done) {
+  local_->RecvAsync(
+      parsed, recv_args,
+      [this, parsed, done](const Status& status,
+                           const Rendezvous::Args& send_args,
+                           const Rendezvous::Args& recv_args, const Tensor& in,
+                           bool is_dead) {
+        // Pushed tensors are buffered in host memory, so only a tensor that
+        // is received into the memory of an accelerator needs a copy.
+        const bool dst_host =
+            (recv_args.alloc_attrs.on_host() || parsed.dst.type == "CPU");
+        if (!status.ok() || is_dead || dst_host) {
+          done(status, send_args, recv_args, in, is_dead);
+          return;
+        }
+        if (!DMAHelper::CanUseDMA(&in)) {
+          done(errors::InvalidArgument("Non-DMA-safe ",
+                                       DataTypeString(in.dtype()),
+                                       " tensor may not be copied to a GPU."),
+               send_args, recv_args, Tensor(), false);
+          return;
+        }
+        Device* dst_device;
+        Status s =
+            session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+        if (s.ok() && recv_args.device_context == nullptr) {
+          s = errors::Internal("No device context to receive ",
+                               parsed.FullKey(), " on ", parsed.dst_device);
+        }
+        if (!s.ok()) {
+          done(s, send_args, recv_args, Tensor(), false);
+          return;
+        }
+        Tensor* copy = new Tensor(dst_device->GetAllocator(recv_args.alloc_attrs),
+                                  in.dtype(), in.shape());
+        // Keeps the host buffer alive until the copy is done.
+        Tensor* host = new Tensor(in);
+        recv_args.device_context->CopyCPUTensorToDevice(
+            host, dst_device, copy,
+            [done, send_args, recv_args, host, copy](const Status& s) {
+              done(s, send_args, recv_args, *copy, false);
+              delete host;
+              delete copy;
+            });
+      });
+}
+
 void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
                                           DoneCallback done) {
   {
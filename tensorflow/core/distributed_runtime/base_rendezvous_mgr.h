@@ -82,6 +82,13 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                    Tensor* val, bool* is_dead) override;
 
+  // Buffers "val", which a remote worker pushed for "parsed", in the local
+  // rendezvous instance for the "step_id".
+  //
+  // This method is used by the rpc handler of PushTensor.
+  Status RecvPushed(int64 step_id, const Rendezvous::ParsedKey& parsed,
+                    const Tensor& val, bool is_dead) override;
+
   // Removes rendezvous for "step_id".
   //
   // TODO(zhifengc): Have a background thread in worker that
@@ -123,15 +130,23 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Upgrades the BaseRemoteRendezvous to full initialization.
   Status Initialize(WorkerSession* session) override;
 
+  void SetPushTensors(bool push_tensors) override;
+
+  void SetCoalesceRecvs(bool coalesce_recvs) override;
+
+  void SetRecvTensorEncoding(const TensorTransportEncoding& encoding) override;
+
   // Forwards to local_, where the Tensor "val" will be buffered and
-  // any waiting callback stored.
+  // any waiting callback stored. If tensors are pushed and the consumer is
+  // in a remote process, pushes "val" to it with PushToRemote() instead.
   Status Send(const ParsedKey& key, const Rendezvous::Args& args,
               const Tensor& val, const bool is_dead) override;
 
   // This method is called only by the RecvOp.  It tests to see
   // whether the value will be produced by a local or remote device
   // and handles accordingly.  In the local case it forwards to
-  // local_, in the remote case it initiates an RPC request.
+  // local_, in the remote case it initiates an RPC request, or waits for
+  // the tensor to be pushed into local_ if tensors are pushed.
   void RecvAsync(const ParsedKey& key, const Rendezvous::Args& args,
                  DoneCallback done) override;
 
@@ -149,11 +164,26 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // REQUIRES: "parsed" is one that will be Saved into the local rendezvous.
   void RecvLocalAsync(const ParsedKey& parsed, DoneCallback done);
 
+  // This method is called only by the local Worker, forwarded through the
+  // same method on RendezvousMgr, when it has received a PushTensor request.
+  // Buffers "val", which resides in host memory, in local_ until the local
+  // consumer receives it.
+  Status RecvPushed(const ParsedKey& parsed, const Tensor& val, bool is_dead);
+
  protected:
   virtual void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                                    const Rendezvous::Args& args,
                                    DoneCallback done) = 0;
 
+  // Starts pushing "val" to the remote worker of "parsed.dst", which receives
+  // it with RecvPushed(). Errors that occur after this method returns abort
+  // the rendezvous.
+  //
+  // The default implementation does not support pushing tensors.
+  virtual Status PushToRemote(const Rendezvous::ParsedKey& parsed,
+                              const Rendezvous::Args& args, const Tensor& val,
+                              bool is_dead);
+
   // Returns true if "src" and "dst" are located in the same worker,
   // and hence may use a local rendezvous.
   virtual bool IsSameWorker(DeviceNameUtils::ParsedName src,
@@ -169,6 +199,14 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
 
   bool is_initialized();
 
+  // Whether RecvFromRemoteAsync() may coalesce concurrent receives from the
+  // same remote worker.
+  bool coalesce_recvs();
+
+  // The encodings that RecvFromRemoteAsync() may accept for received
+  // tensors.
+  TensorTransportEncoding recv_tensor_encoding();
+
   ~BaseRemoteRendezvous() override;
 
   const WorkerEnv* const env_;  // Not owned.
@@ -182,6 +220,9 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Status given by StartAbort() if any.
   Status status_ GUARDED_BY(mu_);
   WorkerSession* session_ GUARDED_BY(mu_);  // Not owned.
+  bool push_tensors_ GUARDED_BY(mu_) = false;
+  bool coalesce_recvs_ GUARDED_BY(mu_) = false;
+  TensorTransportEncoding recv_tensor_encoding_ GUARDED_BY(mu_);
 
   // Data structures to handle calls when partially initialized.
   struct DeferredCall {
@@ -213,6 +254,11 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
                           const Rendezvous::Args& out_args, const Tensor& in,
                           Tensor* out, StatusCallback done);
 
+  // Receives a tensor pushed by a remote worker from local_, and copies it to
+  // the memory that "recv_args" asks for.
+  void RecvPushedAsync(const ParsedKey& parsed, const Rendezvous::Args& args,
+                       DoneCallback done);
+
   // Must be called only if fully initialized.
   void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/cancellable_call.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_manager.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
@@ -36,7 +37,7 @@ class RecvBufCall : public CancellableCall {
               DeviceContext* to_device_ctx,
               const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
               const DeviceLocality& client_locality,
-              const DeviceLocality& server_locality,
+              const DeviceLocality& server_locality, bool dma_ok,
               CancellationManager* cancel_mgr, WorkerCacheInterface* wc)
       : CancellableCall(cancel_mgr, peer_task, wc) {
     req_.set_step_id(step_id);
@@ -47,6 +48,7 @@ class RecvBufCall : public CancellableCall {
     req_.set_buf_ptr(reinterpret_cast<int64>(DMAHelper::base(to_tensor)));
     req_.set_src_device(peer_device);
     req_.set_dst_device(to_device->name());
+    req_.set_dma_ok(dma_ok);
   }
 
   ~RecvBufCall() override {}
@@ -84,6 +86,21 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
   // Logic to be executed on the RecvBufAsync callback.
   auto recv_buf_callback = [this, state, peer_task, to_device, to_alloc_attr,
                             to_device_ctx, to_tensor, done](const Status& s) {
+    if (s.ok() && remote_memory_manager_ != nullptr &&
+        !state->call->resp_.transport_options().Is<RecvBufRespExtra>()) {
+      // The peer made the value available through the out-of-band
+      // transport, which moves the bytes directly into to_tensor.
+      const bool on_host =
+          (to_device->tensorflow_gpu_device_info() == nullptr) ||
+          to_alloc_attr.on_host();
+      remote_memory_manager_->TensorFromTransportOptions(
+          to_tensor, state->call->resp_.transport_options(), to_device,
+          to_device_ctx, on_host, [state, done](const Status& s) {
+            delete state;
+            done(s);
+          });
+      return;
+    }
     if (s.ok()) {
       // In this generic implementation the bytes come back in the
       // RPC response protobuf rather than via RDMA so we need to copy
@@ -154,7 +171,7 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
       state->call.reset(new RecvBufCall(
           step_id_, peer_device, peer_task, key, to_device, to_device_ctx,
           to_alloc_attr, to_tensor, client_locality, state->server_locality,
-          &cancel_mgr_, worker_cache_));
+          remote_memory_manager_ != nullptr, &cancel_mgr_, worker_cache_));
       state->call->Start(recv_buf_callback);
     }
   };
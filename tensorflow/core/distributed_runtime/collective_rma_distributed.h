@@ -18,17 +18,22 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
+class RemoteMemoryManager;
 class WorkerCacheInterface;
 
 // Extend CollectiveRemoteAccessLocal with access to remote peers.
+//
+// If "remote_memory_manager" is not null, peers may transfer the values
+// out-of-band through it instead of in the RecvBuf response.
 class CollectiveRemoteAccessDistributed : public CollectiveRemoteAccessLocal {
  public:
-  CollectiveRemoteAccessDistributed(const DeviceMgr* dev_mgr,
-                                    DeviceResolverInterface* dev_resolver,
-                                    WorkerCacheInterface* worker_cache,
-                                    int64 step_id)
+  CollectiveRemoteAccessDistributed(
+      const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver,
+      WorkerCacheInterface* worker_cache, int64 step_id,
+      RemoteMemoryManager* remote_memory_manager = nullptr)
       : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, step_id),
-        worker_cache_(worker_cache) {}
+        worker_cache_(worker_cache),
+        remote_memory_manager_(remote_memory_manager) {}
 
   ~CollectiveRemoteAccessDistributed() override {}
 
@@ -42,7 +47,8 @@ class CollectiveRemoteAccessDistributed : public CollectiveRemoteAccessLocal {
   void StartAbort(const Status& s) override;
 
  protected:
-  WorkerCacheInterface* worker_cache_;  // Not owned
+  WorkerCacheInterface* worker_cache_;          // Not owned
+  RemoteMemoryManager* remote_memory_manager_;  // Not owned
   CancellationManager cancel_mgr_;
 };
 
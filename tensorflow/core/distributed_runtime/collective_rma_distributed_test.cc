@@ -20,8 +20,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_manager.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -57,6 +59,47 @@ static Device* NewDevice(const string& type, const string& name) {
 
 static int64 kStepId = 123;
 
+// Transports tensors "out-of-band" by packing them into a TensorProto, and
+// counts the tensors it has received that way.
+class FakeRemoteMemoryManager : public RemoteMemoryManager {
+ public:
+  Status Init() override { return Status::OK(); }
+  void Run() override {}
+  void Stop() override {}
+
+  void TransportOptionsFromTensor(
+      ::google::protobuf::Any* mutable_transport_options, const Tensor& tensor,
+      Device* device, DeviceContext* device_context, bool on_host,
+      StatusCallback done) override {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    mutable_transport_options->PackFrom(proto);
+    done(Status::OK());
+  }
+
+  void TensorFromTransportOptions(
+      Tensor* tensor, const ::google::protobuf::Any& transport_options,
+      Device* device, DeviceContext* device_context, bool on_host,
+      StatusCallback done) override {
+    TensorProto proto;
+    Tensor value;
+    if (!transport_options.UnpackTo(&proto) || !value.FromProto(proto) ||
+        value.TotalBytes() != tensor->TotalBytes()) {
+      done(errors::Internal("Unexpected transport options"));
+      return;
+    }
+    memcpy(DMAHelper::base(tensor), DMAHelper::base(&value),
+           tensor->TotalBytes());
+    ++num_received_;
+    done(Status::OK());
+  }
+
+  int num_received() const { return num_received_; }
+
+ private:
+  int num_received_ = 0;
+};
+
 class FakeWorker : public TestWorkerInterface {
  public:
   FakeWorker(const string& name, DeviceMgr* dev_mgr,
@@ -66,6 +109,10 @@ class FakeWorker : public TestWorkerInterface {
         device_resolver_(dres),
         buf_rendezvous_(kStepId) {}
 
+  void set_remote_memory_manager(RemoteMemoryManager* remote_memory_manager) {
+    remote_memory_manager_ = remote_memory_manager;
+  }
+
   // Direct access to a BufRendezvous that holds whatever the remote
   // worker is supposed to have.
   BufRendezvous* buf_rendezvous() { return &buf_rendezvous_; }
@@ -100,6 +147,16 @@ class FakeWorker : public TestWorkerInterface {
                                               BufRendezvous::Hook* h) {
           if (s.ok()) {
             opts->ClearCancelCallback();
+            if (request->dma_ok() && remote_memory_manager_ != nullptr) {
+              remote_memory_manager_->TransportOptionsFromTensor(
+                  response->mutable_transport_options(), *h->prod_value,
+                  nullptr /*device*/, nullptr /*device_context*/,
+                  true /*on_host*/, [h, done](const Status& s) {
+                    done(s);
+                    BufRendezvous::DoneWithHook(h);
+                  });
+              return;
+            }
             // Since this is not really RDMA into pre-allocated memory send the
             // bytes in the response.
             RecvBufRespExtra extra;
@@ -119,6 +176,7 @@ class FakeWorker : public TestWorkerInterface {
   DeviceMgr* device_mgr_;
   DeviceResolverDistributed* device_resolver_;
   BufRendezvous buf_rendezvous_;
+  RemoteMemoryManager* remote_memory_manager_ = nullptr;
 };
 
 class FakeCache : public TestWorkerCache {
@@ -328,6 +386,47 @@ TEST_F(CollRMADistTest, ConsFirstOK) {
   ValidateResultTensor();
 }
 
+TEST_F(CollRMADistTest, RemoteMemoryManagerOK) {
+  FakeRemoteMemoryManager remote_memory_manager;
+  rma_.reset(new CollectiveRemoteAccessDistributed(
+      device_mgrs_[0], dev_resolvers_["/job:worker/replica:0/task:0"], &wc_,
+      kStepId, &remote_memory_manager));
+  Notification consumer_note;
+  Notification producer_note;
+  Status consumer_status;
+  Status producer_status;
+  FakeWorker* wi = workers_[1];
+  wi->set_remote_memory_manager(&remote_memory_manager);
+  const string kBufKey = "fake_buf_key";
+  wi->buf_rendezvous()->ProvideBuf(
+      kBufKey, nullptr /*device*/, nullptr /*dev_ctx*/, &expected_value_,
+      AllocatorAttributes(),
+      [this, &producer_note, &producer_status](const Status& s) {
+        producer_status.Update(s);
+        producer_note.Notify();
+      });
+  Device* dst_device = nullptr;
+  string dev_name = "CPU:0";
+  TF_EXPECT_OK(device_mgrs_[0]->LookupDevice(dev_name, &dst_device));
+  DeviceContext* to_device_ctx = nullptr;
+  rma_->RecvFromPeer(
+      "/job:worker/replica:0/task:1/device:" + dev_name,  // peer_dev
+      "/job:worker/replica:0/task:1",                     // peer_task
+      false,                                              // peer_is_local
+      kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
+      device_locality_,
+      [this, &consumer_status, &consumer_note](const Status& s) {
+        consumer_status = s;
+        consumer_note.Notify();
+      });
+  consumer_note.WaitForNotification();
+  TF_EXPECT_OK(consumer_status);
+  producer_note.WaitForNotification();
+  TF_EXPECT_OK(producer_status);
+  EXPECT_EQ(1, remote_memory_manager.num_received());
+  ValidateResultTensor();
+}
+
 TEST_F(CollRMADistTest, ConsFirstAbort) {
   Notification consumer_note;
   Status consumer_status;
@@ -17,41 +17,29 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_EXECUTE_NODE_H_
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
-#include "tensorflow/core/distributed_runtime/eager/eager_client.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_op_batcher.h"
 #include "tensorflow/core/protobuf/eager_service.pb.h"
 
 namespace tensorflow {
 namespace eager {
 
-// EnqueueNode is an implementation of EagerNode which enqueues an operation
-// via RPC in a remote EagerService.
+// RemoteExecuteNode is an implementation of EagerNode which streams an
+// operation, or a handle to decref, to a remote EagerService. It does not
+// wait for the remote context to run it: errors surface in the later nodes
+// streamed to the same context, and in EagerContext::AsyncWait().
 class RemoteExecuteNode : public tensorflow::EagerNode {
  public:
   RemoteExecuteNode(tensorflow::uint64 id,
-                    const tensorflow::eager::EnqueueRequest& request,
-                    tensorflow::eager::EagerClient* eager_client)
-      : tensorflow::EagerNode(id),
-        request_(std::move(request)),
-        eager_client_(eager_client) {}
-
-  tensorflow::Status Run() override {
-    tensorflow::eager::EnqueueResponse response;
-    tensorflow::Status status;
-    Notification n;
-    eager_client_->EnqueueAsync(&request_, &response,
-                                [&n, &status](const tensorflow::Status& s) {
-                                  status.Update(s);
-                                  n.Notify();
-                                });
-    n.WaitForNotification();
-
-    return status;
-  }
+                    const tensorflow::eager::QueueItem& item,
+                    tensorflow::eager::RemoteOpBatcher* batcher)
+      : tensorflow::EagerNode(id), item_(item), batcher_(batcher) {}
+
+  tensorflow::Status Run() override { return batcher_->Add(item_); }
 
  private:
-  EnqueueRequest request_;
-  tensorflow::eager::EagerClient*
-      eager_client_;  // Not owned, and must outlive the RemoteExecuteNode.
+  QueueItem item_;
+  tensorflow::eager::RemoteOpBatcher*
+      batcher_;  // Not owned, and must outlive the RemoteExecuteNode.
 };
 
 }  // namespace eager
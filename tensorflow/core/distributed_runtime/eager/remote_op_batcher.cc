@@ -0,0 +1,127 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/remote_op_batcher.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+
+constexpr int RemoteOpBatcher::kDefaultMaxBatchSize;
+
+RemoteOpBatcher::RemoteOpBatcher(EagerClient* eager_client, uint64 context_id,
+                                 int max_batch_size)
+    : eager_client_(eager_client),
+      context_id_(context_id),
+      max_batch_size_(max_batch_size) {
+  CHECK_GT(max_batch_size, 0);
+}
+
+RemoteOpBatcher::~RemoteOpBatcher() {
+  WaitForAllPendingItems().IgnoreError();
+}
+
+Status RemoteOpBatcher::Add(const QueueItem& item, StatusCallback done) {
+  EnqueueRequest* request = nullptr;
+  std::vector<StatusCallback> callbacks;
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) return status_;
+    pending_items_.push_back(item);
+    pending_callbacks_.push_back(std::move(done));
+    if (batch_in_flight_) return Status::OK();
+    batch_in_flight_ = true;
+    request = new EnqueueRequest;
+    TakeBatch(request, &callbacks);
+  }
+  SendBatch(request, std::move(callbacks));
+  return Status::OK();
+}
+
+Status RemoteOpBatcher::WaitForAllPendingItems() {
+  mutex_lock l(mu_);
+  while (batch_in_flight_) {
+    cond_.wait(l);
+  }
+  Status status = status_;
+  status_ = Status::OK();
+  return status;
+}
+
+void RemoteOpBatcher::TakeBatch(EnqueueRequest* request,
+                                std::vector<StatusCallback>* callbacks) {
+  const int batch_size =
+      std::min(max_batch_size_, static_cast<int>(pending_items_.size()));
+  request->set_context_id(context_id_);
+  for (int i = 0; i < batch_size; ++i) {
+    request->add_queue()->Swap(&pending_items_[i]);
+  }
+  pending_items_.erase(pending_items_.begin(),
+                       pending_items_.begin() + batch_size);
+  callbacks->assign(
+      std::make_move_iterator(pending_callbacks_.begin()),
+      std::make_move_iterator(pending_callbacks_.begin() + batch_size));
+  pending_callbacks_.erase(pending_callbacks_.begin(),
+                           pending_callbacks_.begin() + batch_size);
+}
+
+void RemoteOpBatcher::SendBatch(EnqueueRequest* request,
+                                std::vector<StatusCallback> callbacks) {
+  EnqueueResponse* response = new EnqueueResponse;
+  eager_client_->EnqueueAsync(
+      request, response,
+      std::bind(
+          [this, request, response](std::vector<StatusCallback>& callbacks,
+                                    const Status& s) {
+            delete request;
+            delete response;
+            for (const StatusCallback& done : callbacks) {
+              if (done) done(s);
+            }
+
+            EnqueueRequest* next_request = nullptr;
+            std::vector<StatusCallback> next_callbacks;
+            std::vector<StatusCallback> failed_callbacks;
+            {
+              mutex_lock l(mu_);
+              status_.Update(s);
+              if (!s.ok()) {
+                // The pending items may depend on the ops that failed.
+                pending_items_.clear();
+                failed_callbacks.swap(pending_callbacks_);
+              }
+              if (pending_items_.empty()) {
+                batch_in_flight_ = false;
+                cond_.notify_all();
+              } else {
+                next_request = new EnqueueRequest;
+                TakeBatch(next_request, &next_callbacks);
+              }
+            }
+            for (const StatusCallback& done : failed_callbacks) {
+              if (done) done(s);
+            }
+            if (next_request != nullptr) {
+              SendBatch(next_request, std::move(next_callbacks));
+            }
+          },
+          std::move(callbacks), std::placeholders::_1));
+}
+
+}  // namespace eager
+}  // namespace tensorflow
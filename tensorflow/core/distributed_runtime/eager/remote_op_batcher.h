@@ -0,0 +1,93 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_OP_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_OP_BATCHER_H_
+
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/eager/eager_client.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Streams the queue items (operations and handles to decref) sent to one
+// remote context in batches, in the order they are added. A batch is sent as
+// soon as no other batch is in flight, and the items added while one is in
+// flight form the next batch, so that the client keeps producing ops at the
+// cost of one round-trip per batch instead of one per op.
+//
+// A single batch is in flight at a time since the remote service runs the
+// Enqueue requests in the order it receives them.
+//
+// Thread-safe.
+class RemoteOpBatcher {
+ public:
+  // 'eager_client' is not owned, and must outlive the RemoteOpBatcher.
+  RemoteOpBatcher(EagerClient* eager_client, uint64 context_id,
+                  int max_batch_size = kDefaultMaxBatchSize);
+
+  // Waits for the batches in flight.
+  ~RemoteOpBatcher();
+
+  // Adds 'item' to the stream. 'done', if not null, is called with the
+  // status of the batch which contains it once the remote context ran it.
+  //
+  // Returns the error of a batch that failed since the last
+  // WaitForAllPendingItems(), if any, in which case 'item' is not added, as
+  // it may depend on the ops that failed.
+  Status Add(const QueueItem& item, StatusCallback done = nullptr);
+
+  // Blocks until the remote context ran all the added items, and returns the
+  // first error since the last call, which is then cleared.
+  Status WaitForAllPendingItems();
+
+  static constexpr int kDefaultMaxBatchSize = 256;
+
+ private:
+  // Moves up to 'max_batch_size_' pending items to '*request' and their
+  // callbacks to '*callbacks'.
+  void TakeBatch(EnqueueRequest* request,
+                 std::vector<StatusCallback>* callbacks)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Sends 'request', then the batches pending when it is done. Takes
+  // ownership of 'request'.
+  void SendBatch(EnqueueRequest* request,
+                 std::vector<StatusCallback> callbacks);
+
+  EagerClient* const eager_client_;
+  const uint64 context_id_;
+  const int max_batch_size_;
+
+  mutex mu_;
+  condition_variable cond_;
+  std::vector<QueueItem> pending_items_ GUARDED_BY(mu_);
+  std::vector<StatusCallback> pending_callbacks_ GUARDED_BY(mu_);
+  bool batch_in_flight_ GUARDED_BY(mu_) = false;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RemoteOpBatcher);
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_OP_BATCHER_H_
@@ -0,0 +1,152 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/remote_op_batcher.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// Records the Enqueue requests, which complete when the test says so.
+class FakeEagerClient : public EagerClient {
+ public:
+#define CLIENT_METHOD(method)                        \
+  void method##Async(const method##Request* request, \
+                     method##Response* response,     \
+                     StatusCallback done) override { \
+    done(errors::Unimplemented(#method));            \
+  }
+
+  CLIENT_METHOD(CreateContext);
+  CLIENT_METHOD(WaitQueueDone);
+  CLIENT_METHOD(KeepAlive);
+  CLIENT_METHOD(CloseContext);
+  CLIENT_METHOD(RegisterFunction);
+
+#undef CLIENT_METHOD
+
+  void EnqueueAsync(const EnqueueRequest* request, EnqueueResponse* response,
+                    StatusCallback done) override {
+    requests_.push_back(*request);
+    callbacks_.push_back(std::move(done));
+  }
+
+  const std::vector<EnqueueRequest>& requests() const { return requests_; }
+
+  // Completes the oldest request in flight with 'status'.
+  void Complete(const Status& status) {
+    StatusCallback done = std::move(callbacks_[num_completed_++]);
+    done(status);
+  }
+
+  int num_in_flight() const { return callbacks_.size() - num_completed_; }
+
+ private:
+  std::vector<EnqueueRequest> requests_;
+  std::vector<StatusCallback> callbacks_;
+  int num_completed_ = 0;
+};
+
+QueueItem Decref(int64 op_id) {
+  QueueItem item;
+  item.mutable_handle_to_decref()->set_op_id(op_id);
+  return item;
+}
+
+std::vector<int64> OpIds(const EnqueueRequest& request) {
+  std::vector<int64> op_ids;
+  for (const QueueItem& item : request.queue()) {
+    op_ids.push_back(item.handle_to_decref().op_id());
+  }
+  return op_ids;
+}
+
+TEST(RemoteOpBatcherTest, BatchesItemsAddedWhileInFlight) {
+  FakeEagerClient client;
+  RemoteOpBatcher batcher(&client, 7, /*max_batch_size=*/2);
+
+  TF_ASSERT_OK(batcher.Add(Decref(0)));
+  for (int i = 1; i < 4; ++i) {
+    TF_ASSERT_OK(batcher.Add(Decref(i)));
+  }
+  // The first item is sent on its own, and the others wait for it.
+  ASSERT_EQ(1, client.requests().size());
+  EXPECT_EQ(7, client.requests()[0].context_id());
+  EXPECT_EQ(std::vector<int64>({0}), OpIds(client.requests()[0]));
+
+  client.Complete(Status::OK());
+  ASSERT_EQ(2, client.requests().size());
+  EXPECT_EQ(std::vector<int64>({1, 2}), OpIds(client.requests()[1]));
+  EXPECT_EQ(1, client.num_in_flight());
+
+  client.Complete(Status::OK());
+  ASSERT_EQ(3, client.requests().size());
+  EXPECT_EQ(std::vector<int64>({3}), OpIds(client.requests()[2]));
+
+  client.Complete(Status::OK());
+  EXPECT_EQ(0, client.num_in_flight());
+  TF_EXPECT_OK(batcher.WaitForAllPendingItems());
+}
+
+TEST(RemoteOpBatcherTest, CallsBackWithBatchStatus) {
+  FakeEagerClient client;
+  RemoteOpBatcher batcher(&client, 7);
+
+  std::vector<Status> statuses;
+  auto done = [&statuses](const Status& s) { statuses.push_back(s); };
+  TF_ASSERT_OK(batcher.Add(Decref(0), done));
+  TF_ASSERT_OK(batcher.Add(Decref(1), done));
+  TF_ASSERT_OK(batcher.Add(Decref(2), done));
+
+  client.Complete(Status::OK());
+  ASSERT_EQ(1, statuses.size());
+  TF_EXPECT_OK(statuses[0]);
+
+  client.Complete(errors::Internal("failed"));
+  ASSERT_EQ(3, statuses.size());
+  EXPECT_EQ(error::INTERNAL, statuses[1].code());
+  EXPECT_EQ(error::INTERNAL, statuses[2].code());
+}
+
+TEST(RemoteOpBatcherTest, ReportsErrorsUntilWaited) {
+  FakeEagerClient client;
+  RemoteOpBatcher batcher(&client, 7);
+
+  TF_ASSERT_OK(batcher.Add(Decref(0)));
+  // Dropped along with the batch in flight failing.
+  TF_ASSERT_OK(batcher.Add(Decref(1)));
+  client.Complete(errors::Internal("failed"));
+  EXPECT_EQ(1, client.requests().size());
+
+  EXPECT_EQ(error::INTERNAL, batcher.Add(Decref(2)).code());
+  EXPECT_EQ(error::INTERNAL, batcher.WaitForAllPendingItems().code());
+
+  // The batcher streams again once the error was reported.
+  TF_ASSERT_OK(batcher.Add(Decref(3)));
+  ASSERT_EQ(2, client.requests().size());
+  EXPECT_EQ(std::vector<int64>({3}), OpIds(client.requests()[1]));
+  client.Complete(Status::OK());
+  TF_EXPECT_OK(batcher.WaitForAllPendingItems());
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -419,6 +419,9 @@ void GraphMgr::ExecuteAsync(const string& handle, const int64 step_id,
   }
 
   RemoteRendezvous* rendezvous = worker_env_->rendezvous_mgr->Find(step_id);
+  rendezvous->SetPushTensors(opts.push_tensors());
+  rendezvous->SetCoalesceRecvs(opts.coalesce_recvs());
+  rendezvous->SetRecvTensorEncoding(opts.recv_tensor_encoding());
   Status s = rendezvous->Initialize(session);
   CollectiveExecutor::Handle* ce_handle =
       item->collective_graph_key != BuildGraphOptions::kNoCollectiveGraphKey
@@ -42,20 +42,109 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 
+// The partition graphs registered with the workers of a MasterSession.
+//
+// Partitions that the graphs of different Run() signatures place on the
+// same worker are often identical, e.g. the partitions of parameter servers.
+// ReffedClientGraphs share one registration of such partitions, so that a
+// new signature only registers the partitions that differ from the ones
+// registered already. A registration is keyed by its worker and by a
+// fingerprint of its RegisterGraphRequest.
+//
+// This class is thread-safe.
+class MasterSession::RegisteredGraphs {
+ public:
+  struct Registration {
+    // Notified once the worker responded. "status" and "graph_handle" are
+    // immutable afterwards.
+    Notification done;
+    Status status;
+    string graph_handle;
+
+    // The number of partitions using this registration.
+    int refs = 0;
+  };
+
+  // Returns the registration of the graph of "req" with worker "name", with
+  // a reference for the caller. If the graph is not registered or being
+  // registered yet, sets "*is_new" to true, in which case the caller must
+  // register it and call Finish().
+  std::shared_ptr<Registration> Acquire(const string& name,
+                                        const RegisterGraphRequest& req,
+                                        bool* is_new) {
+    string serialized;
+    SerializeToStringDeterministic(req, &serialized);
+    const Fprint128 fp = Fingerprint128(serialized);
+    const string key = strings::StrCat(name, ":", strings::FpToString(fp.high64),
+                                       strings::FpToString(fp.low64));
+    mutex_lock l(mu_);
+    std::shared_ptr<Registration>& registration = registrations_[key];
+    *is_new = registration == nullptr;
+    if (*is_new) {
+      registration = std::make_shared<Registration>();
+    }
+    ++registration->refs;
+    keys_[registration.get()] = key;
+    return registration;
+  }
+
+  // Records the result of registering "registration". A failed registration
+  // is forgotten, so that the next Acquire() of the same graph retries it.
+  void Finish(Registration* registration, const Status& s,
+              const string& graph_handle) {
+    registration->status = s;
+    registration->graph_handle = graph_handle;
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      Forget(registration);
+    }
+    registration->done.Notify();
+  }
+
+  // Drops the caller's reference to "registration". Returns true if that was
+  // the last reference to a successful registration, in which case the
+  // caller must deregister its graph.
+  bool Release(Registration* registration) {
+    mutex_lock l(mu_);
+    if (--registration->refs > 0) return false;
+    Forget(registration);
+    return registration->done.HasBeenNotified() &&
+           registration->status.ok() && !registration->graph_handle.empty();
+  }
+
+ private:
+  void Forget(Registration* registration) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = keys_.find(registration);
+    if (it == keys_.end()) return;
+    registrations_.erase(it->second);
+    keys_.erase(it);
+  }
+
+  mutex mu_;
+  std::unordered_map<string, std::shared_ptr<Registration>> registrations_
+      GUARDED_BY(mu_);
+  // The keys of the entries of registrations_.
+  std::unordered_map<Registration*, string> keys_ GUARDED_BY(mu_);
+};
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -68,7 +157,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
                     const SessionOptions& session_opts,
                     const StatsPublisherFactory& stats_publisher_factory,
                     bool is_partial, WorkerCacheInterface* worker_cache,
-                    bool should_deregister)
+                    bool should_deregister,
+                    std::shared_ptr<RegisteredGraphs> registered_graphs)
       : session_handle_(handle),
         bg_opts_(bopts),
         client_graph_(std::move(cg)),
@@ -76,7 +166,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
         is_partial_(is_partial),
         callable_opts_(bopts.callable_options),
         worker_cache_(worker_cache),
-        should_deregister_(should_deregister) {
+        should_deregister_(should_deregister),
+        registered_graphs_(std::move(registered_graphs)) {
     VLOG(1) << "Created ReffedClientGraph for node with "
             << client_graph()->graph.num_node_ids();
 
@@ -89,10 +180,17 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   }
 
   ~ReffedClientGraph() override {
+    if (session_opts_.config.experimental().num_backup_workers() > 0 ||
+        VLOG_IS_ON(1)) {
+      LogPartitionStats();
+    }
     if (should_deregister_) {
       DeregisterPartitions();
     } else {
       for (Part& part : partitions_) {
+        if (part.registration != nullptr) {
+          registered_graphs_->Release(part.registration.get());
+        }
         worker_cache_->ReleaseWorker(part.name, part.worker);
       }
     }
@@ -114,6 +212,11 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     return execution_count_.fetch_add(1);
   }
 
+  // The value of MasterSession::num_run_graph_lookups_ when this graph was
+  // last looked up. Guarded by MasterSession::mu_.
+  uint64 last_lookup() const { return last_lookup_; }
+  void set_last_lookup(uint64 lookup) { last_lookup_ = lookup; }
+
   // Turn RPC logging on or off, both at the WorkerCache used by this
   // master process, and at each remote worker in use for the current
   // partitions.
@@ -207,6 +310,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // Post-processing of any runtime statistics gathered during execution.
   void ProcessStats(int64 step_id, PerStepState* pss, ProfileHandler* ph,
                     const RunOptions& options, RunMetadata* resp);
+  // Moves the step stats of each worker to the master's clock.
+  void AlignClocks(PerStepState* pss);
   void ProcessDeviceStats(ProfileHandler* ph, const DeviceStepStats& ds,
                           bool is_rpc);
   // Checks that the requested fetches can be computed from the provided feeds.
@@ -237,7 +342,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   WorkerCacheInterface* const worker_cache_;  // Not owned.
   std::unordered_map<StringPiece, Node*, StringPieceHasher> name_to_node_;
   const bool should_deregister_;
+  const std::shared_ptr<RegisteredGraphs> registered_graphs_;
   std::atomic<int64> execution_count_ = {0};
+  uint64 last_lookup_ = 0;
 
   // Graph partitioned into per-location subgraphs.
   struct Part {
@@ -257,9 +364,27 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // this partition on the worker.
     string graph_handle;
 
+    // The registration of graph_handle, which may be shared with the
+    // partitions of other ReffedClientGraphs.
+    std::shared_ptr<RegisteredGraphs::Registration> registration;
+
+    // The names of the other workers from which this partition receives
+    // tensors.
+    std::unordered_set<string> recv_from;
+
     Part() : feed_key(3), key_fetch(3) {}
   };
 
+  // What the steps of this graph took on each partition, for diagnosing
+  // slow workers.
+  struct PartitionStats {
+    // The microseconds from the start of the step to the completion of
+    // the RunGraph call of the partition.
+    histogram::Histogram run_graph_usecs;
+    // The number of steps that went on without the partition.
+    int64 num_abandoned = 0;
+  };
+
   // partitions_ is immutable after RegisterPartitions() call
   // finishes.  RunPartitions() can access partitions_ safely without
   // acquiring locks.
@@ -276,6 +401,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // init_result_ remembers the initialization error if any.
   Status init_result_ GUARDED_BY(mu_);
 
+  // Indexed like partitions_.
+  std::vector<PartitionStats> partition_stats_ GUARDED_BY(mu_);
+
   std::unique_ptr<StatsPublisherInterface> stats_publisher_;
 
   // Send/Recv nodes that are the result of client-added
@@ -307,6 +435,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // destructor and does not wait for the rpc completion.
   void DeregisterPartitions();
 
+  // Logs partition_stats_.
+  void LogPartitionStats();
+
   TF_DISALLOW_COPY_AND_ASSIGN(ReffedClientGraph);
 };
 
@@ -388,6 +519,16 @@ void MasterSession::ReffedClientGraph::TrackFeedsAndFetches(
         } else {
           part->key_fetch.insert({key, name});
         }
+      } else if (is_recv) {
+        string send_device;
+        TF_CHECK_OK(GetNodeAttr(ndef, "send_device", &send_device));
+        string send_worker;
+        string unused;
+        if (DeviceNameUtils::SplitDeviceName(send_device, &send_worker,
+                                             &unused) &&
+            send_worker != part->name) {
+          part->recv_from.insert(send_worker);
+        }
       }
     }
   }
@@ -439,9 +580,10 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
   };
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
+  gtl::InlinedVector<bool, 4> is_new(num);
   BlockingCounter done(num);
   for (int i = 0; i < num; ++i) {
-    const Part& part = partitions_[i];
+    Part& part = partitions_[i];
     Call* c = &calls[i];
     c->req.set_session_handle(session_handle_);
     c->req.set_create_worker_session_called(!should_deregister_);
@@ -450,6 +592,13 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(bg_opts_.collective_graph_key);
+    part.registration =
+        registered_graphs_->Acquire(part.name, c->req, &is_new[i]);
+    if (!is_new[i]) {
+      VLOG(2) << "Reuse registered graph for " << part.name;
+      done.DecrementCount();
+      continue;
+    }
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
     auto cb = [c, &done](const Status& s) {
       c->status = s;
@@ -458,10 +607,19 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     part.worker->RegisterGraphAsync(&c->req, &c->resp, cb);
   }
   done.Wait();
+  // Finish the registrations of this graph before waiting for the ones of
+  // other graphs, which may in turn wait for the ones of this graph.
   for (int i = 0; i < num; ++i) {
-    Call* c = &calls[i];
-    s.Update(c->status);
-    partitions_[i].graph_handle = c->resp.graph_handle();
+    if (is_new[i]) {
+      registered_graphs_->Finish(partitions_[i].registration.get(),
+                                 calls[i].status, calls[i].resp.graph_handle());
+    }
+  }
+  for (int i = 0; i < num; ++i) {
+    Part& part = partitions_[i];
+    part.registration->done.WaitForNotification();
+    s.Update(part.registration->status);
+    part.graph_handle = part.registration->graph_handle;
   }
   return s;
 }
@@ -469,7 +627,10 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
 // Helper class to manage "num" parallel RunGraph calls.
 class RunManyGraphs {
  public:
-  explicit RunManyGraphs(int num) : calls_(num), pending_(num) {}
+  explicit RunManyGraphs(int num)
+      : calls_(num),
+        pending_(num),
+        start_micros_(Env::Default()->NowMicros()) {}
 
   ~RunManyGraphs() {}
 
@@ -478,21 +639,46 @@ class RunManyGraphs {
     CallOptions opts;
     std::unique_ptr<MutableRunGraphRequestWrapper> req;
     std::unique_ptr<MutableRunGraphResponseWrapper> resp;
+    // True if the step may go on without this call, which then must not
+    // return any fetched tensors.
+    bool may_abandon = false;
+    // The indices of the calls from whose partitions the partition of this
+    // call receives tensors.
+    std::vector<int> sources;
+    // Set when the call completes or is abandoned.
+    bool done = false;
+    bool abandoned = false;
+    int64 elapsed_micros = 0;
   };
   Call* get(int index) { return &calls_[index]; }
 
+  // When the calls were issued.
+  int64 start_micros() const { return start_micros_; }
+
+  // Lets the step go on without up to "num" of the calls that may be
+  // abandoned, once every other call has completed.
+  void set_num_backups(int num) { num_backups_ = num; }
+
   // When the index-th call is done, updates the overall status.
   void WhenDone(int index, const Status& s) {
     TRACEPRINTF("Partition %d %s", index, s.ToString().c_str());
-    auto resp = get(index)->resp.get();
-    if (resp->status_code() != error::Code::OK) {
-      // resp->status_code will only be non-OK if s.ok().
-      mutex_lock l(mu_);
-      UpdateStatusLocked(
-          Status(resp->status_code(), resp->status_error_message()));
-    } else if (!s.ok()) {
+    {
       mutex_lock l(mu_);
-      UpdateStatusLocked(s);
+      Call* call = get(index);
+      call->done = true;
+      call->elapsed_micros = Env::Default()->NowMicros() - start_micros_;
+      // The status of an abandoned call is that of its cancellation.
+      if (!call->abandoned) {
+        auto resp = call->resp.get();
+        if (resp->status_code() != error::Code::OK) {
+          // resp->status_code will only be non-OK if s.ok().
+          UpdateStatusLocked(
+              Status(resp->status_code(), resp->status_error_message()));
+        } else if (!s.ok()) {
+          UpdateStatusLocked(s);
+        }
+        MaybeAbandonLocked();
+      }
     }
     pending_.DecrementCount();
   }
@@ -516,6 +702,9 @@ class RunManyGraphs {
   mutable mutex mu_;
   Status status_ GUARDED_BY(mu_);
 
+  const int64 start_micros_;
+  int num_backups_ = 0;
+
   void UpdateStatusLocked(const Status& s) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (status_.ok()) {
       status_ = s;
@@ -525,10 +714,58 @@ class RunManyGraphs {
     }
   }
 
+  // Cancels the pending calls if there are at most num_backups_ of them,
+  // each may be abandoned, and none of them waits for tensors from
+  // another.  Since every other call has completed, no partition then
+  // waits for the partitions of the cancelled calls.
+  void MaybeAbandonLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (num_backups_ <= 0 || !status_.ok()) return;
+    std::vector<int> pending;
+    for (size_t i = 0; i < calls_.size(); ++i) {
+      if (calls_[i].done) continue;
+      if (!calls_[i].may_abandon || calls_[i].abandoned) return;
+      pending.push_back(i);
+    }
+    if (pending.empty() || static_cast<int>(pending.size()) > num_backups_) {
+      return;
+    }
+    for (int i : pending) {
+      for (int source : calls_[i].sources) {
+        if (!calls_[source].done) return;
+      }
+    }
+    for (int i : pending) {
+      VLOG(1) << "Abandoning partition " << i << " after "
+              << Env::Default()->NowMicros() - start_micros_ << " us";
+      calls_[i].abandoned = true;
+      calls_[i].opts.StartCancel();
+    }
+  }
+
   TF_DISALLOW_COPY_AND_ASSIGN(RunManyGraphs);
 };
 
 namespace {
+// Estimates how far the clock of a worker is ahead of the master's, from when
+// the master sent a RunGraph request and received its response, and when the
+// worker received and answered it. As in NTP, the estimate is exact if the
+// request and the response spend as long on the network. Returns 0 if the
+// worker did not report its clock.
+int64 EstimateClockOffset(int64 send_micros, int64 recv_micros,
+                          const MutableRunGraphResponseWrapper& resp) {
+  if (resp.start_micros() == 0 || resp.end_micros() == 0) return 0;
+  return ((resp.start_micros() - send_micros) +
+          (resp.end_micros() - recv_micros)) /
+         2;
+}
+
+// Moves the events of `dev_stats` back by `offset_micros`.
+void ShiftDeviceStepStats(int64 offset_micros, DeviceStepStats* dev_stats) {
+  for (NodeExecStats& ns : *dev_stats->mutable_node_stats()) {
+    ns.set_all_start_micros(ns.all_start_micros() - offset_micros);
+  }
+}
+
 Status AddSendFromClientRequest(const RunStepRequestWrapper& client_req,
                                 MutableRunGraphRequestWrapper* worker_req,
                                 size_t index, const string& send_key) {
@@ -579,19 +816,59 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   if (pss->collect_timeline) {
     exec_opts.set_record_timeline(true);
   }
+  if (pss->collect_hardware_trace) {
+    exec_opts.set_record_hardware_trace(true);
+  }
   if (pss->collect_rpcs) {
     SetRPCLogging(true);
   }
   if (pss->collect_partition_graphs) {
     exec_opts.set_record_partition_graphs(true);
   }
+  if (session_opts_.config.experimental().use_push_tensor_transfer()) {
+    exec_opts.set_push_tensors(true);
+  }
+  if (session_opts_.config.experimental().coalesce_recv_tensor_rpcs()) {
+    exec_opts.set_coalesce_recvs(true);
+  }
+  if (session_opts_.config.rpc_options().compress_tensor_transport()) {
+    exec_opts.mutable_recv_tensor_encoding()->set_compressed(true);
+  }
+  if (session_opts_.config.rpc_options()
+          .cast_float_tensor_transport_to_bfloat16()) {
+    exec_opts.mutable_recv_tensor_encoding()->set_float_as_bfloat16(true);
+  }
   if (pss->collect_costs || pss->collect_timeline) {
     pss->step_stats.resize(partitions_.size());
   }
+  if (pss->collect_timeline) {
+    pss->clock_offset_micros.assign(partitions_.size(), 0);
+  }
 
   const int num = partitions_.size();
   RunManyGraphs calls(num);
 
+  // Partial runs fetch from arbitrary partitions, so they wait for all.
+  const int num_backups =
+      is_partial_ ? 0
+                  : session_opts_.config.experimental().num_backup_workers();
+  if (num_backups > 0) {
+    std::unordered_map<string, int> part_index;
+    for (int i = 0; i < num; ++i) {
+      part_index[partitions_[i].name] = i;
+    }
+    for (int i = 0; i < num; ++i) {
+      const Part& part = partitions_[i];
+      RunManyGraphs::Call* c = calls.get(i);
+      c->may_abandon = part.key_fetch.empty();
+      for (const string& source : part.recv_from) {
+        auto it = part_index.find(source);
+        if (it != part_index.end()) c->sources.push_back(it->second);
+      }
+    }
+    calls.set_num_backups(num_backups);
+  }
+
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
     RunManyGraphs::Call* c = calls.get(i);
@@ -680,6 +957,21 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   }
   TF_RETURN_IF_ERROR(calls.status());
 
+  {
+    mutex_lock l(mu_);
+    if (partition_stats_.empty()) {
+      partition_stats_ = std::vector<PartitionStats>(num);
+    }
+    for (int i = 0; i < num; ++i) {
+      const RunManyGraphs::Call* c = calls.get(i);
+      if (c->abandoned) {
+        ++partition_stats_[i].num_abandoned;
+      } else {
+        partition_stats_[i].run_graph_usecs.Add(c->elapsed_micros);
+      }
+    }
+  }
+
   // Collects fetches and metadata.
   Status status;
   for (int i = 0; i < num; ++i) {
@@ -701,6 +993,12 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     }
     if (pss->collect_timeline) {
       pss->step_stats[i].Swap(run_graph_resp->mutable_step_stats());
+      const RunManyGraphs::Call* c = calls.get(i);
+      if (!c->abandoned) {
+        pss->clock_offset_micros[i] = EstimateClockOffset(
+            calls.start_micros(), calls.start_micros() + c->elapsed_micros,
+            *run_graph_resp);
+      }
     }
     if (pss->collect_costs) {
       CostGraphDef* cost_graph = run_graph_resp->mutable_cost_graph();
@@ -721,6 +1019,16 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   return status;
 }
 
+void MasterSession::ReffedClientGraph::LogPartitionStats() {
+  mutex_lock l(mu_);
+  for (size_t i = 0; i < partition_stats_.size(); ++i) {
+    const PartitionStats& stats = partition_stats_[i];
+    LOG(INFO) << "RunGraph latency of " << partitions_[i].name
+              << " in session " << session_handle_ << " (abandoned in " << stats.num_abandoned << " steps):\n"
+              << stats.run_graph_usecs.ToString();
+  }
+}
+
 Status MasterSession::ReffedClientGraph::RunPartitions(
     const MasterEnv* env, int64 step_id, int64 execution_count,
     PerStepState* pss, CallOptions* call_opts, const RunStepRequestWrapper& req,
@@ -865,6 +1173,7 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
   if (pss->collect_timeline) {
     SetRPCLogging(false);
     RetrieveLogs(step_id, &pss->rpc_stats);
+    AlignClocks(pss);
   }
   for (size_t i = 0; i < partitions_.size(); ++i) {
     const StepStats& ss = pss->step_stats[i];
@@ -903,6 +1212,23 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
   }
 }
 
+void MasterSession::ReffedClientGraph::AlignClocks(PerStepState* pss) {
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    const int64 offset = pss->clock_offset_micros[i];
+    if (offset == 0) continue;
+    for (DeviceStepStats& ds : *pss->step_stats[i].mutable_dev_stats()) {
+      ShiftDeviceStepStats(offset, &ds);
+    }
+    // The RPCs are logged by the worker that received the tensor.
+    const string prefix = strings::StrCat(partitions_[i].name, "/");
+    for (DeviceStepStats& ds : *pss->rpc_stats.mutable_dev_stats()) {
+      if (str_util::StartsWith(ds.device(), prefix)) {
+        ShiftDeviceStepStats(offset, &ds);
+      }
+    }
+  }
+}
+
 void MasterSession::ReffedClientGraph::ProcessDeviceStats(
     ProfileHandler* ph, const DeviceStepStats& ds, bool is_rpc) {
   const string& dev_name = ds.device();
@@ -1015,8 +1341,12 @@ void MasterSession::ReffedClientGraph::DeregisterPartitions() {
     DeregisterGraphResponse resp;
   };
   for (Part& part : partitions_) {
-    // The graph handle may be empty if we failed during partition registration.
-    if (!part.graph_handle.empty()) {
+    // Other graphs may still use the registration of this partition. It may
+    // also be missing if we failed during partition registration.
+    if (part.registration == nullptr ||
+        !registered_graphs_->Release(part.registration.get())) {
+      worker_cache_->ReleaseWorker(part.name, part.worker);
+    } else {
       Call* c = new Call;
       c->req.set_session_handle(session_handle_);
       c->req.set_create_worker_session_called(!should_deregister_);
@@ -1155,7 +1485,8 @@ MasterSession::MasterSession(
       stats_publisher_factory_(std::move(stats_publisher_factory)),
       graph_version_(0),
       run_graphs_(5),
-      partial_run_graphs_(5) {
+      partial_run_graphs_(5),
+      registered_graphs_(std::make_shared<RegisteredGraphs>()) {
   UpdateLastAccessTime();
   CHECK(devices_) << "device_set was null!";
 
@@ -1402,6 +1733,7 @@ WorkerCacheInterface* MasterSession::get_worker_cache() const {
 Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
                                 ReffedClientGraph** out_rcg, int64* out_count) {
   const uint64 hash = HashBuildGraphOptions(opts);
+  std::vector<ReffedClientGraph*> to_unref;
   {
     mutex_lock l(mu_);
     // TODO(suharshs): We cache partial run graphs and run graphs separately
@@ -1417,18 +1749,27 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
               << "\n";
       std::unique_ptr<ClientGraph> client_graph;
       TF_RETURN_IF_ERROR(execution_state_->BuildGraph(opts, &client_graph));
+      const int32 max_cached_run_graphs =
+          session_opts_.config.experimental().max_cached_run_graphs();
+      if (max_cached_run_graphs > 0) {
+        EvictRunsTable(&to_unref, m, max_cached_run_graphs);
+      }
       WorkerCacheInterface* worker_cache = get_worker_cache();
       auto entry = new ReffedClientGraph(
           handle_, opts, std::move(client_graph), session_opts_,
           stats_publisher_factory_, is_partial, worker_cache,
-          !should_delete_worker_sessions_);
+          !should_delete_worker_sessions_, registered_graphs_);
       iter = m->insert({hash, entry}).first;
       VLOG(1) << "Preparing to execute new graph";
     }
     *out_rcg = iter->second;
     (*out_rcg)->Ref();
+    (*out_rcg)->set_last_lookup(++num_run_graph_lookups_);
     *out_count = (*out_rcg)->get_and_increment_execution_count();
   }
+  // Evicted graphs deregister their partitions when they are deleted, which
+  // does not need to hold mu_.
+  for (ReffedClientGraph* rcg : to_unref) rcg->Unref();
   return Status::OK();
 }
 
@@ -1446,6 +1787,19 @@ void MasterSession::ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
   rcg_map->clear();
 }
 
+void MasterSession::EvictRunsTable(std::vector<ReffedClientGraph*>* to_unref,
+                                   RCGMap* rcg_map, size_t max_size) {
+  while (rcg_map->size() >= max_size) {
+    auto lru = rcg_map->begin();
+    for (auto it = rcg_map->begin(); it != rcg_map->end(); ++it) {
+      if (it->second->last_lookup() < lru->second->last_lookup()) lru = it;
+    }
+    VLOG(1) << "Discarding least recently used reffed graph " << lru->first;
+    to_unref->push_back(lru->second);
+    rcg_map->erase(lru);
+  }
+}
+
 uint64 MasterSession::NewStepId(int64 graph_key) {
   if (graph_key == BuildGraphOptions::kNoCollectiveGraphKey) {
     // StepId must leave the most-significant 7 bits empty for future use.
@@ -1621,6 +1975,8 @@ Status MasterSession::DoPartialRun(CallOptions* opts,
     pss.collect_timeline =
         req.options().trace_level() == RunOptions::FULL_TRACE;
     pss.collect_rpcs = req.options().trace_level() == RunOptions::FULL_TRACE;
+    pss.collect_hardware_trace =
+        req.options().trace_level() == RunOptions::FULL_TRACE;
     pss.report_tensor_allocations_upon_oom =
         req.options().report_tensor_allocations_upon_oom();
 
@@ -1758,6 +2114,8 @@ void MasterSession::FillPerStepState(MasterSession::ReffedClientGraph* rcg,
   out_pss->collect_timeline =
       run_options.trace_level() == RunOptions::FULL_TRACE;
   out_pss->collect_rpcs = run_options.trace_level() == RunOptions::FULL_TRACE;
+  out_pss->collect_hardware_trace =
+      run_options.trace_level() == RunOptions::FULL_TRACE;
   out_pss->report_tensor_allocations_upon_oom =
       run_options.report_tensor_allocations_upon_oom();
   // Build the cost model every 'build_cost_model_every' steps after skipping an
@@ -1883,7 +2241,8 @@ Status MasterSession::MakeCallable(const MakeCallableRequest& req,
     callable = new ReffedClientGraph(handle_, opts, std::move(client_graph),
                                      session_opts_, stats_publisher_factory_,
                                      false /* is_partial */, get_worker_cache(),
-                                     !should_delete_worker_sessions_);
+                                     !should_delete_worker_sessions_,
+                                     registered_graphs_);
   }
 
   Status s = BuildAndRegisterPartitions(callable);
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -156,18 +157,29 @@ class MasterSession : public core::RefCounted {
   typedef std::unordered_map<uint64, ReffedClientGraph*> RCGMap;
   RCGMap run_graphs_ GUARDED_BY(mu_);
   RCGMap partial_run_graphs_ GUARDED_BY(mu_);
+  // The number of lookups in run_graphs_ and partial_run_graphs_, which
+  // orders their entries by last use.
+  uint64 num_run_graph_lookups_ GUARDED_BY(mu_) = 0;
   int64 next_callable_handle_ GUARDED_BY(mu_) = 0;
   RCGMap callables_ GUARDED_BY(mu_);
 
+  // The partition graphs registered with the workers, which the
+  // ReffedClientGraphs with identical partitions share.
+  class RegisteredGraphs;
+  const std::shared_ptr<RegisteredGraphs> registered_graphs_;
+
   struct PerStepState {
     bool collect_costs = false;
     bool collect_timeline = false;
     bool collect_rpcs = false;
     bool collect_partition_graphs = false;
+    bool collect_hardware_trace = false;
     bool report_tensor_allocations_upon_oom = false;
     Microseconds start_micros = Microseconds(0);
     Microseconds end_micros = Microseconds(0);
     std::vector<StepStats> step_stats;  // per partition
+    // Per partition, how far the worker's clock is ahead of the master's.
+    std::vector<int64> clock_offset_micros;
     StepStats rpc_stats;                // for RPC layer
     CostGraphDef cost_graph;
   };
@@ -227,6 +239,11 @@ class MasterSession : public core::RefCounted {
                    ReffedClientGraph** out_rcg, int64* out_count);
   void ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
                       RCGMap* rcg_map) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes the least recently used entries from "rcg_map" until it has
+  // fewer than "max_size" entries, and adds them to "to_unref".
+  void EvictRunsTable(std::vector<ReffedClientGraph*>* to_unref,
+                      RCGMap* rcg_map, size_t max_size)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
   void FillPerStepState(MasterSession::ReffedClientGraph* rcg,
                         const RunOptions& run_options, uint64 step_id,
                         int64 count, PerStepState* out_pss,
@@ -61,10 +61,12 @@ class MasterTest : public ::testing::Test {
   // rpc calls.
 
   Status CreateSession(const GraphDef& def, string* handle,
-                       int64* initial_version) {
+                       int64* initial_version,
+                       const ConfigProto& config = ConfigProto()) {
     ::grpc::ClientContext ctx;
     CreateSessionRequest req;
     *(req.mutable_graph_def()) = def;
+    *(req.mutable_config()) = config;
     // Invokes placement frequently.
     req.mutable_config()->set_placement_period(1);
     CreateSessionResponse resp;
@@ -359,6 +361,36 @@ TEST_F(MasterTest, ConcurrentExtendAndRun) {
   TF_ASSERT_OK(CloseSession(handle));
 }
 
+TEST_F(MasterTest, EvictsLeastRecentlyRunGraphs) {
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({}));
+  test::FillValues<float>(&a_tensor, {1});
+  Node* a_node = test::graph::Constant(&graph, a_tensor);
+  Tensor b_tensor(DT_FLOAT, TensorShape({}));
+  test::FillValues<float>(&b_tensor, {2});
+  Node* b_node = test::graph::Constant(&graph, b_tensor);
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+
+  ConfigProto config;
+  config.mutable_experimental()->set_max_cached_run_graphs(1);
+  string handle;
+  int64 initial_version;
+  TF_ASSERT_OK(CreateSession(def, &handle, &initial_version, config));
+
+  // Every signature evicts the graph of the previous one, which must be
+  // rebuilt and registered again when it is run again.
+  for (int i = 0; i < 3; ++i) {
+    Tensor a(DT_FLOAT, TensorShape({}));
+    TF_ASSERT_OK(RunStep(handle, {}, {{a_node->name() + ":0", &a}}));
+    test::ExpectTensorEqual<float>(a_tensor, a);
+    Tensor b(DT_FLOAT, TensorShape({}));
+    TF_ASSERT_OK(RunStep(handle, {}, {{b_node->name() + ":0", &b}}));
+    test::ExpectTensorEqual<float>(b_tensor, b);
+  }
+  TF_EXPECT_OK(CloseSession(handle));
+}
+
 TEST_F(MasterTest, EigenProblem) {
   // A = [3 2; -1 0]; x = rand(2, 1);
   // for i=1:100; x = A * x; end
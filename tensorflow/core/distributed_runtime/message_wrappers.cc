@@ -641,6 +641,18 @@ void InMemoryRunGraphResponse::AddPartitionGraph(
   partition_graphs_.push_back(partition_graph);
 }
 
+int64 InMemoryRunGraphResponse::start_micros() const { return start_micros_; }
+
+void InMemoryRunGraphResponse::set_start_micros(int64 micros) {
+  start_micros_ = micros;
+}
+
+int64 InMemoryRunGraphResponse::end_micros() const { return end_micros_; }
+
+void InMemoryRunGraphResponse::set_end_micros(int64 micros) {
+  end_micros_ = micros;
+}
+
 size_t OwnedProtoRunGraphResponse::num_recvs() const {
   return response_.recv_size();
 }
@@ -708,6 +720,22 @@ void OwnedProtoRunGraphResponse::AddPartitionGraph(
   *graph_def = partition_graph;
 }
 
+int64 OwnedProtoRunGraphResponse::start_micros() const {
+  return response_.start_micros();
+}
+
+void OwnedProtoRunGraphResponse::set_start_micros(int64 micros) {
+  response_.set_start_micros(micros);
+}
+
+int64 OwnedProtoRunGraphResponse::end_micros() const {
+  return response_.end_micros();
+}
+
+void OwnedProtoRunGraphResponse::set_end_micros(int64 micros) {
+  response_.set_end_micros(micros);
+}
+
 NonOwnedProtoRunGraphResponse::NonOwnedProtoRunGraphResponse(
     RunGraphResponse* response)
     : response_(response) {}
@@ -781,6 +809,22 @@ void NonOwnedProtoRunGraphResponse::AddPartitionGraph(
   *graph_def = partition_graph;
 }
 
+int64 NonOwnedProtoRunGraphResponse::start_micros() const {
+  return response_->start_micros();
+}
+
+void NonOwnedProtoRunGraphResponse::set_start_micros(int64 micros) {
+  response_->set_start_micros(micros);
+}
+
+int64 NonOwnedProtoRunGraphResponse::end_micros() const {
+  return response_->end_micros();
+}
+
+void NonOwnedProtoRunGraphResponse::set_end_micros(int64 micros) {
+  response_->set_end_micros(micros);
+}
+
 MutableRunStepResponseWrapper::~MutableRunStepResponseWrapper() {}
 
 size_t InMemoryRunStepResponse::num_tensors() const { return tensors_.size(); }
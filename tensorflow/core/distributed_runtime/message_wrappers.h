@@ -476,6 +476,13 @@ class MutableRunGraphResponseWrapper {
   virtual GraphDef* mutable_partition_graph(size_t i) = 0;
   virtual void AddPartitionGraph(const GraphDef& partition_graph) = 0;
 
+  // The worker's clock when it received the request and sent the response,
+  // for aligning the step stats of different workers.
+  virtual int64 start_micros() const = 0;
+  virtual void set_start_micros(int64 micros) = 0;
+  virtual int64 end_micros() const = 0;
+  virtual void set_end_micros(int64 micros) = 0;
+
   // Returned status if requested.
   virtual errors::Code status_code() const = 0;
   virtual const string& status_error_message() const = 0;
@@ -510,6 +517,10 @@ class InMemoryRunGraphResponse : public MutableRunGraphResponseWrapper {
   size_t num_partition_graphs() const override;
   GraphDef* mutable_partition_graph(size_t i) override;
   void AddPartitionGraph(const GraphDef& partition_graph) override;
+  int64 start_micros() const override;
+  void set_start_micros(int64 micros) override;
+  int64 end_micros() const override;
+  void set_end_micros(int64 micros) override;
   errors::Code status_code() const override;
   const string& status_error_message() const override;
   void set_status(const Status& status) override;
@@ -524,6 +535,8 @@ class InMemoryRunGraphResponse : public MutableRunGraphResponseWrapper {
   StepStats step_stats_;
   CostGraphDef cost_graph_;
   std::vector<GraphDef> partition_graphs_;
+  int64 start_micros_ = 0;
+  int64 end_micros_ = 0;
   // Store the code and message separately so that they can be updated
   // independently by setters.
   Status status_;
@@ -543,6 +556,10 @@ class OwnedProtoRunGraphResponse : public MutableRunGraphResponseWrapper {
   size_t num_partition_graphs() const override;
   GraphDef* mutable_partition_graph(size_t i) override;
   void AddPartitionGraph(const GraphDef& partition_graph) override;
+  int64 start_micros() const override;
+  void set_start_micros(int64 micros) override;
+  int64 end_micros() const override;
+  void set_end_micros(int64 micros) override;
   errors::Code status_code() const override;
   const string& status_error_message() const override;
   void set_status(const Status& status) override;
@@ -570,6 +587,10 @@ class NonOwnedProtoRunGraphResponse : public MutableRunGraphResponseWrapper {
   size_t num_partition_graphs() const override;
   GraphDef* mutable_partition_graph(size_t i) override;
   void AddPartitionGraph(const GraphDef& partition_graph) override;
+  int64 start_micros() const override;
+  void set_start_micros(int64 micros) override;
+  int64 end_micros() const override;
+  void set_end_micros(int64 micros) override;
   errors::Code status_code() const override;
   const string& status_error_message() const override;
   void set_status(const Status& status) override;
@@ -0,0 +1,194 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/metrics_http_server.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace tensorflow {
+
+namespace {
+
+// How often the serving thread checks whether the server is stopping.
+const int kPollTimeoutMillis = 100;
+// Requests are read until the end of the request line, up to this size.
+const size_t kMaxRequestLineBytes = 8192;
+const int kReadTimeoutSeconds = 5;
+
+string HttpResponse(const string& status, const string& content_type,
+                    const string& body) {
+  return strings::StrCat("HTTP/1.0 ", status, "\r\nContent-Type: ",
+                         content_type, "\r\nContent-Length: ", body.size(),
+                         "\r\nConnection: close\r\n\r\n", body);
+}
+
+}  // namespace
+
+string MetricsHttpServer::HandleRequest(const string& request_line) {
+  const std::vector<string> parts =
+      str_util::Split(request_line, ' ', str_util::SkipEmpty());
+  if (parts.size() < 2) {
+    return HttpResponse("400 Bad Request", "text/plain", "Bad request.\n");
+  }
+  if (parts[0] != "GET") {
+    return HttpResponse("405 Method Not Allowed", "text/plain",
+                        "Only GET is supported.\n");
+  }
+  const string path = parts[1].substr(0, parts[1].find('?'));
+  if (path != "/metrics") {
+    return HttpResponse("404 Not Found", "text/plain",
+                        "The metrics are exported at /metrics.\n");
+  }
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  const std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  return HttpResponse("200 OK", monitoring::kPrometheusTextContentType,
+                      monitoring::ExportPrometheusText(*metrics));
+}
+
+#if defined(PLATFORM_WINDOWS)
+
+Status MetricsHttpServer::Create(Env* env, int port,
+                                 std::unique_ptr<MetricsHttpServer>* server) {
+  return errors::Unimplemented(
+      "The metrics HTTP server is not supported on Windows.");
+}
+
+MetricsHttpServer::MetricsHttpServer(Env* env, int socket, int port)
+    : socket_(socket), port_(port) {}
+
+MetricsHttpServer::~MetricsHttpServer() {}
+
+#else
+
+Status MetricsHttpServer::Create(Env* env, int port,
+                                 std::unique_ptr<MetricsHttpServer>* server) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return errors::Internal("Failed to create a socket: ", strerror(errno));
+  }
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  socklen_t addr_len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), addr_len) != 0 ||
+      listen(fd, SOMAXCONN) != 0 ||
+      getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len) !=
+          0) {
+    const Status s = errors::Unavailable("Failed to listen on port ", port,
+                                         ": ", strerror(errno));
+    close(fd);
+    return s;
+  }
+  server->reset(new MetricsHttpServer(env, fd, ntohs(addr.sin_port)));
+  return Status::OK();
+}
+
+MetricsHttpServer::MetricsHttpServer(Env* env, int socket, int port)
+    : socket_(socket), port_(port) {
+  thread_.reset(env->StartThread(ThreadOptions(), "TF_metrics_http_server",
+                                 [this]() { Serve(); }));
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+  stopping_ = true;
+  // Joins the serving thread.
+  thread_.reset();
+  close(socket_);
+}
+
+void MetricsHttpServer::Serve() {
+  while (!stopping_) {
+    struct pollfd poll_fd;
+    poll_fd.fd = socket_;
+    poll_fd.events = POLLIN;
+    if (poll(&poll_fd, 1, kPollTimeoutMillis) <= 0) {
+      continue;
+    }
+    const int connection = accept(socket_, nullptr, nullptr);
+    if (connection < 0) {
+      continue;
+    }
+    ServeConnection(connection);
+    close(connection);
+  }
+}
+
+void MetricsHttpServer::ServeConnection(int connection) {
+  struct timeval timeout;
+  timeout.tv_sec = kReadTimeoutSeconds;
+  timeout.tv_usec = 0;
+  setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+  const int one = 1;
+  setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+  string request;
+  char buffer[1024];
+  while (request.find("\r\n") == string::npos &&
+         request.size() < kMaxRequestLineBytes) {
+    const ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      return;
+    }
+    request.append(buffer, n);
+  }
+  const string response =
+      HandleRequest(request.substr(0, request.find("\r\n")));
+  size_t sent = 0;
+  while (sent < response.size()) {
+    const ssize_t n = send(connection, response.data() + sent,
+                           response.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      VLOG(1) << "Failed to send the metrics: " << strerror(errno);
+      return;
+    }
+    sent += n;
+  }
+  // Lets the client read the response before the connection is closed.
+  shutdown(connection, SHUT_WR);
+  while (recv(connection, buffer, sizeof(buffer), 0) > 0) {
+  }
+}
+
+#endif  // PLATFORM_WINDOWS
+
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_METRICS_HTTP_SERVER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_METRICS_HTTP_SERVER_H_
+
+#include <atomic>
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+// A minimal HTTP server that exports the metrics of the process, i.e. those
+// of `monitoring::CollectionRegistry::Default()`, in the Prometheus text
+// format at "/metrics", for monitoring systems to scrape.
+//
+// The requests are served one at a time by a single thread, which is enough
+// for periodic scrapes.
+class MetricsHttpServer {
+ public:
+  // Starts a server listening on `port` of all interfaces, or on an unused
+  // port if `port` is 0.
+  static Status Create(Env* env, int port,
+                       std::unique_ptr<MetricsHttpServer>* server);
+
+  // Stops the server.
+  ~MetricsHttpServer();
+
+  // The port the server listens on.
+  int port() const { return port_; }
+
+  // Returns the HTTP response to a request that starts with `request_line`,
+  // e.g. "GET /metrics HTTP/1.1".
+  static string HandleRequest(const string& request_line);
+
+ private:
+  MetricsHttpServer(Env* env, int socket, int port);
+
+  void Serve();
+  void ServeConnection(int connection);
+
+  const int socket_;
+  const int port_;
+  std::atomic<bool> stopping_{false};
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MetricsHttpServer);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_METRICS_HTTP_SERVER_H_
@@ -0,0 +1,95 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/metrics_http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+auto* test_counter = monitoring::Counter<0>::New(
+    "/tensorflow/test/metrics_http_server/counter", "A test counter.");
+
+// Sends `request` to the server on localhost:`port` and returns the response.
+string Fetch(int port, const string& request) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  CHECK_GE(fd, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  CHECK_EQ(0, connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                      sizeof(addr)));
+  CHECK_EQ(request.size(), send(fd, request.data(), request.size(), 0));
+  string response;
+  char buffer[1024];
+  ssize_t n;
+  while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, n);
+  }
+  close(fd);
+  return response;
+}
+
+TEST(MetricsHttpServerTest, HandleRequest) {
+  test_counter->GetCell()->IncrementBy(3);
+  const string response =
+      MetricsHttpServer::HandleRequest("GET /metrics HTTP/1.1");
+  EXPECT_TRUE(str_util::StartsWith(response, "HTTP/1.0 200 OK\r\n"));
+  EXPECT_TRUE(str_util::StrContains(
+      response, "Content-Type: text/plain; version=0.0.4\r\n"));
+  EXPECT_TRUE(str_util::StrContains(
+      response, "\ntensorflow_test_metrics_http_server_counter 3\n"));
+
+  EXPECT_TRUE(str_util::StartsWith(
+      MetricsHttpServer::HandleRequest("GET /metrics?x=1 HTTP/1.1"),
+      "HTTP/1.0 200 OK\r\n"));
+  EXPECT_TRUE(
+      str_util::StartsWith(MetricsHttpServer::HandleRequest("GET / HTTP/1.1"),
+                           "HTTP/1.0 404 Not Found\r\n"));
+  EXPECT_TRUE(str_util::StartsWith(
+      MetricsHttpServer::HandleRequest("POST /metrics HTTP/1.1"),
+      "HTTP/1.0 405 Method Not Allowed\r\n"));
+  EXPECT_TRUE(str_util::StartsWith(MetricsHttpServer::HandleRequest(""),
+                                   "HTTP/1.0 400 Bad Request\r\n"));
+}
+
+TEST(MetricsHttpServerTest, ServesMetrics) {
+  std::unique_ptr<MetricsHttpServer> server;
+  TF_ASSERT_OK(MetricsHttpServer::Create(Env::Default(), 0, &server));
+  EXPECT_GT(server->port(), 0);
+  test_counter->GetCell()->IncrementBy(1);
+  for (int i = 0; i < 2; ++i) {
+    const string response = Fetch(
+        server->port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_TRUE(str_util::StartsWith(response, "HTTP/1.0 200 OK\r\n"));
+    EXPECT_TRUE(str_util::StrContains(
+        response, "# TYPE tensorflow_test_metrics_http_server_counter "
+                  "counter\n"));
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 
@@ -40,6 +41,24 @@ class RemoteRendezvous : public Rendezvous {
  public:
   // Fully construct the RemoteRendezvous.
   virtual Status Initialize(WorkerSession* session) = 0;
+
+  // If "push_tensors" is true, tensors sent to remote workers in this step
+  // are pushed to them as soon as they are produced, and tensors received
+  // from remote workers are expected to be pushed by them. Must be called
+  // before any tensor of the step is sent or received, with the same value
+  // on every worker of the step.
+  virtual void SetPushTensors(bool push_tensors) = 0;
+
+  // If "coalesce_recvs" is true, receives from the same remote worker that
+  // are pending at the same time in this step may be coalesced into one
+  // request. Must be called before any tensor of the step is received.
+  virtual void SetCoalesceRecvs(bool coalesce_recvs) = 0;
+
+  // Sets the encodings that remote workers may apply to the tensors they
+  // send to this worker in this step. Must be called before any tensor of
+  // the step is received.
+  virtual void SetRecvTensorEncoding(
+      const TensorTransportEncoding& encoding) = 0;
 };
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
@@ -85,6 +104,13 @@ class RendezvousMgrInterface {
   virtual Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                            Tensor* val, bool* is_dead) = 0;
 
+  // Finds the local rendezvous instance for the "step_id", and buffers "val"
+  // that a remote worker pushed for "parsed" until it is received.
+  //
+  // This method is used by the rpc handler of PushTensor.
+  virtual Status RecvPushed(int64 step_id, const Rendezvous::ParsedKey& parsed,
+                            const Tensor& val, bool is_dead) = 0;
+
   // Removes rendezvous for "step_id".
   //
   // TODO(zhifengc): Have a background thread in worker that
@@ -54,7 +54,9 @@ class GrpcRemoteWorker : public WorkerInterface {
         cleanupgraph_(Method(GrpcWorkerMethod::kCleanupGraph)),
         cleanupall_(Method(GrpcWorkerMethod::kCleanupAll)),
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
+        recvtensors_(Method(GrpcWorkerMethod::kRecvTensors)),
         recvbuf_(Method(GrpcWorkerMethod::kRecvBuf)),
+        pushtensor_(Method(GrpcWorkerMethod::kPushTensor)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
         completegroup_(Method(GrpcWorkerMethod::kCompleteGroup)),
@@ -203,6 +205,19 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
   }
 
+  void RecvTensorsAsync(CallOptions* call_opts,
+                        const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    IssueRequest(request, response, recvtensors_, std::move(done), call_opts);
+  }
+
+  void PushTensorAsync(CallOptions* call_opts, const PushTensorRequest* request,
+                       PushTensorResponse* response,
+                       StatusCallback done) override {
+    IssueRequest(request, response, pushtensor_, std::move(done), call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -245,7 +260,9 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string cleanupgraph_;
   const ::grpc::string cleanupall_;
   const ::grpc::string recvtensor_;
+  const ::grpc::string recvtensors_;
   const ::grpc::string recvbuf_;
+  const ::grpc::string pushtensor_;
   const ::grpc::string logging_;
   const ::grpc::string tracing_;
   const ::grpc::string completegroup_;
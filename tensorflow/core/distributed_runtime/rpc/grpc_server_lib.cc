@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/master.h"
 #include "tensorflow/core/distributed_runtime/master_env.h"
 #include "tensorflow/core/distributed_runtime/master_session.h"
+#include "tensorflow/core/distributed_runtime/metrics_http_server.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_master_service.h"
@@ -225,7 +226,8 @@ Status GrpcServer::Init(
                                                default_worker_name));
     worker_env_.collective_executor_mgr = new RpcCollectiveExecutorMgr(
         config, worker_env_.device_mgr, std::move(dev_resolver),
-        std::move(param_resolver), worker_cache, default_worker_name);
+        std::move(param_resolver), worker_cache, default_worker_name,
+        worker_env_.remote_memory_manager);
   }
 
   // Set up worker environment.
@@ -359,6 +361,12 @@ Status GrpcServer::Start() {
   mutex_lock l(mu_);
   switch (state_) {
     case NEW: {
+      if (server_def_.metrics_port() > 0) {
+        TF_RETURN_IF_ERROR(MetricsHttpServer::Create(
+            env_, server_def_.metrics_port(), &metrics_server_));
+        LOG(INFO) << "Exporting metrics at http://localhost:"
+                  << metrics_server_->port() << "/metrics";
+      }
       master_thread_.reset(
           env_->StartThread(ThreadOptions(), "TF_master_service",
                             [this] { master_service_->HandleRPCsLoop(); }));
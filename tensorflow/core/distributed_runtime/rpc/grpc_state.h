@@ -45,7 +45,10 @@ class RPCState : public GrpcClientCQTag {
            const ::grpc::string& method, const Request& request,
            Response* response, StatusCallback done, CallOptions* call_opts,
            bool fail_fast, int64 timeout_in_ms)
-      : call_opts_(call_opts), done_(std::move(done)) {
+      : call_opts_(call_opts),
+        inflight_calls_(GrpcClientInflightCalls(method)),
+        done_(std::move(done)) {
+    inflight_calls_->IncrementBy(1);
     context_.set_fail_fast(fail_fast);
     if (timeout_in_ms > 0) {
       context_.set_deadline(gpr_time_from_millis(timeout_in_ms, GPR_TIMESPAN));
@@ -83,12 +86,14 @@ class RPCState : public GrpcClientCQTag {
     if (!s.ok()) {
       VLOG(2) << "Call returned with non-ok status: " << s;
     }
+    inflight_calls_->IncrementBy(-1);
     done_(s);
     delete this;
   }
 
  private:
   CallOptions* call_opts_;
+  monitoring::GaugeCell<int64>* const inflight_calls_;
   ::grpc::ClientContext context_;
   std::unique_ptr<::grpc::GenericClientAsyncResponseReader> call_;
   Response* response_;
@@ -17,6 +17,7 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -234,5 +235,45 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              const TensorTransportEncoding& accepted,
+                              ::grpc::ByteBuffer* result) {
+  if (!ShouldEncodeTensorForTransport(val, accepted)) {
+    EncodeTensorToByteBuffer(is_dead, val, result);
+    return;
+  }
+  RecvTensorResponse response;
+  if (is_dead) {
+    response.set_is_dead(is_dead);
+  }
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  EncodeTensorForTransport(val, accepted, response.mutable_tensor(),
+                           response.mutable_encoding());
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+}
+
+void EncodeRecvTensorResponsesToByteBuffer(
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result) {
+  // Every response is encoded as one RecvTensorsResponse::tensor field: a
+  // header slice with its tag and varint32 length, followed by the slices
+  // of the response itself.
+  static const int kVarintMax32 = 5;  // Max length of varint32 encoding
+  std::vector<::grpc::Slice> slices;
+  for (const ::grpc::ByteBuffer& response : responses) {
+    char header[2 * kVarintMax32];
+    io::ProtoEncodeHelper e(header, sizeof(header));
+    e.WriteVarlengthBeginning(RecvTensorsResponse::kTensorFieldNumber,
+                              response.Length());
+    slices.emplace_back(e.data(), e.size());
+    std::vector<::grpc::Slice> response_slices;
+    response.Dump(&response_slices);
+    slices.insert(slices.end(), response_slices.begin(),
+                  response_slices.end());
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
@@ -23,6 +25,7 @@ class ByteBuffer;
 namespace tensorflow {
 class Tensor;
 class RecvTensorResponse;
+class TensorTransportEncoding;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -51,6 +54,29 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Like EncodeTensorToByteBuffer() above, but encodes the content of "val"
+// with the encodings that "accepted" allows and that are worthwhile for it,
+// and records them in "RecvTensorResponse::encoding". The encoded content
+// is copied rather than shared with "val".
+//
+// Discards original contents of *result.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              const TensorTransportEncoding& accepted,
+                              ::grpc::ByteBuffer* result);
+
+// Encode "responses", each of which holds an encoded RecvTensorResponse
+// (e.g. from EncodeTensorToByteBuffer()), back-to-back into a byte buffer
+// in a format that is parseable as a RecvTensorsResponse protocol buffer
+// holding them in order.
+//
+// The slices of "responses", and with them any tensor buffers they share,
+// are shared by "*result" rather than copied.
+//
+// Discards original contents of *result.
+void EncodeRecvTensorResponsesToByteBuffer(
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -100,4 +100,34 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, RecvTensorResponses) {
+  Tensor a(DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&a, {1.0, 2.0});
+  Tensor b(DT_STRING, TensorShape({1}));
+  test::FillValues<string>(&b, {"peach"});
+  std::vector<::grpc::ByteBuffer> bufs(2);
+  grpc::EncodeTensorToByteBuffer(false, a, &bufs[0]);
+  grpc::EncodeTensorToByteBuffer(true, b, &bufs[1]);
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRecvTensorResponsesToByteBuffer(bufs, &buf);
+
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  RecvTensorsResponse response;
+  ASSERT_TRUE(response.ParseFromString(tmp));
+  ASSERT_EQ(2, response.tensor_size());
+  EXPECT_FALSE(response.tensor(0).is_dead());
+  EXPECT_TRUE(response.tensor(1).is_dead());
+  Tensor result_a, result_b;
+  EXPECT_TRUE(result_a.FromProto(response.tensor(0).tensor()));
+  EXPECT_TRUE(result_b.FromProto(response.tensor(1).tensor()));
+  test::ExpectTensorEqual<float>(a, result_a);
+  test::ExpectTensorEqual<string>(b, result_b);
+}
+
 }  // namespace tensorflow
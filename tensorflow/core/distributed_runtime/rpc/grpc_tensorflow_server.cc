@@ -99,10 +99,14 @@ int main(int argc, char* argv[]) {
   tensorflow::string cluster_spec;
   tensorflow::string job_name;
   int task_index = 0;
+  int metrics_port = 0;
   std::vector<tensorflow::Flag> flag_list = {
       tensorflow::Flag("cluster_spec", &cluster_spec, "cluster spec"),
       tensorflow::Flag("job_name", &job_name, "job name"),
       tensorflow::Flag("task_id", &task_index, "task id"),
+      tensorflow::Flag("metrics_port", &metrics_port,
+                       "if positive, the port to export the metrics of the "
+                       "server on, at http://<host>:<port>/metrics"),
   };
   tensorflow::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
   const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
@@ -120,6 +124,7 @@ int main(int argc, char* argv[]) {
     Usage(argv[0]);
     return -1;
   }
+  server_def.set_metrics_port(metrics_port);
   std::unique_ptr<tensorflow::ServerInterface> server;
   TF_QCHECK_OK(tensorflow::NewServer(server_def, &server));
   TF_QCHECK_OK(server->Start());
@@ -18,6 +18,18 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+auto* grpc_client_inflight_calls = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/grpc/client_inflight_calls",
+    "The number of gRPC client calls that are in flight.", "method");
+
+}  // namespace
+
+monitoring::GaugeCell<int64>* GrpcClientInflightCalls(const string& method) {
+  return grpc_client_inflight_calls->GetCell(method);
+}
+
 ::grpc::Status GrpcMaybeUnparseProto(const protobuf::Message& src,
                                      grpc::ByteBuffer* dst) {
   bool own_buffer;
@@ -28,12 +28,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
+#include "tensorflow/core/distributed_runtime/remote_memory_manager.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_call.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -162,9 +164,15 @@ class GrpcWorkerService : public AsyncServiceInterface {
       for (int i = 0; i < 1000; ++i) {
         EnqueueRecvTensorRequestRaw();
       }
+      for (int i = 0; i < 100; ++i) {
+        EnqueueRecvTensorsRequestRaw();
+      }
       for (int i = 0; i < 500; ++i) {
         ENQUEUE_REQUEST(RecvBuf, true);
       }
+      for (int i = 0; i < 1000; ++i) {
+        ENQUEUE_REQUEST(PushTensor, true);
+      }
       for (int i = 0; i < 100; ++i) {
         ENQUEUE_REQUEST(RunGraph, true);
       }
@@ -303,6 +311,37 @@ class GrpcWorkerService : public AsyncServiceInterface {
       EnqueueRecvTensorRequestRaw();
     }
 
+    void PushTensorHandler(
+        WorkerCall<PushTensorRequest, PushTensorResponse>* call) {
+      Schedule([this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->PushTensorAsync(call_opts, &call->request, &call->response,
+                                 [call, call_opts](const Status& s) {
+                                   call->ClearCancelCallback();
+                                   delete call_opts;
+                                   call->SendResponse(ToGrpcStatus(s));
+                                 });
+      });
+      ENQUEUE_REQUEST(PushTensor, true);
+    }
+
+    void RecvTensorsHandlerRaw(
+        WorkerCall<RecvTensorsRequest, ::grpc::ByteBuffer>* call) {
+      Schedule([this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->GrpcRecvTensorsAsync(call_opts, &call->request,
+                                      &call->response,
+                                      [call, call_opts](const Status& s) {
+                                        call->ClearCancelCallback();
+                                        delete call_opts;
+                                        call->SendResponse(ToGrpcStatus(s));
+                                      });
+      });
+      EnqueueRecvTensorsRequestRaw();
+    }
+
     void CleanupGraphHandler(
         WorkerCall<CleanupGraphRequest, CleanupGraphResponse>* call) {
       Schedule([this, call]() {
@@ -397,6 +436,19 @@ class GrpcWorkerService : public AsyncServiceInterface {
       }
     }
 
+    void EnqueueRecvTensorsRequestRaw() {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+             RecvTensorsRequest, ::grpc::ByteBuffer>::
+            EnqueueRequestForMethod(
+                worker_service_, cq_.get(),
+                static_cast<int>(GrpcWorkerMethod::kRecvTensors),
+                &GrpcWorkerServiceThread::RecvTensorsHandlerRaw,
+                true /* supports cancel*/);
+      }
+    }
+
     GrpcWorker* const worker_ = nullptr;  // Not owned.
     std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
     std::unique_ptr<Thread> thread_;
@@ -421,6 +473,75 @@ class GrpcWorkerService : public AsyncServiceInterface {
 GrpcWorker::GrpcWorker(WorkerEnv* worker_env)
     : Worker(worker_env), recv_tensor_recent_request_ids_(100000) {}
 
+namespace {
+
+// Encodes "val", which "src_dev" produced as described by "send_args", into
+// "response" as a RecvTensorResponse.
+// Encodes "val", which is in host memory, into "*response" and runs "done".
+// Tensors that are encoded as "accepted" allows are encoded on "pool",
+// because compressing them takes a while.
+void EncodeHostTensor(const Tensor& val, bool is_dead,
+                      const TensorTransportEncoding& accepted,
+                      thread::ThreadPool* pool, ::grpc::ByteBuffer* response,
+                      StatusCallback done) {
+  if (!ShouldEncodeTensorForTransport(val, accepted)) {
+    grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+    done(Status::OK());
+    return;
+  }
+  pool->Schedule([val, is_dead, accepted, response, done]() {
+    grpc::EncodeTensorToByteBuffer(is_dead, val, accepted, response);
+    done(Status::OK());
+  });
+}
+
+void EncodeRecvTensor(const string& key, Device* src_dev,
+                      const Rendezvous::Args& send_args, const Tensor& val,
+                      bool is_dead, const TensorTransportEncoding& accepted,
+                      thread::ThreadPool* pool, ::grpc::ByteBuffer* response,
+                      StatusCallback done) {
+  // DMA can only be used for Tensors that do not fall into
+  // the following three odd edge cases: 1) a zero-size
+  // buffer, 2) a dead tensor which has an uninit value, and
+  // 3) the tensor has the on_host allocation attribute,
+  // i.e. it's in CPU RAM *independent of its assigned
+  // device type*.
+  const bool on_host = send_args.alloc_attrs.on_host();
+  {
+    // Non-DMA cases.
+    if (src_dev->tensorflow_gpu_device_info() && (!on_host)) {
+      DeviceContext* send_dev_context = send_args.device_context;
+      AllocatorAttributes alloc_attrs;
+      alloc_attrs.set_gpu_compatible(true);
+      alloc_attrs.set_on_host(true);
+      Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+      Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+      CHECK(send_dev_context)
+          << "send dev name: " << src_dev->name()
+          << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
+      // "val" is on an accelerator device. Uses the device_context to
+      // fill the copy on host.
+      StatusCallback copy_ready = [response, done, copy, is_dead, accepted,
+                                   pool](const Status& s) {
+        if (s.ok()) {
+          // The value is now ready to be returned on the wire.
+          EncodeHostTensor(*copy, is_dead, accepted, pool, response, done);
+        } else {
+          done(s);
+        }
+        delete copy;
+      };
+
+      send_dev_context->CopyDeviceTensorToCPU(&val, key, src_dev, copy,
+                                              copy_ready);
+    } else {
+      EncodeHostTensor(val, is_dead, accepted, pool, response, done);
+    }
+  }
+}
+
+}  // namespace
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -456,48 +577,15 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, response, done, src_dev, request](
+      [this, opts, response, done, src_dev, request](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
         opts->ClearCancelCallback();
         if (status.ok()) {
-          // DMA can only be used for Tensors that do not fall into
-          // the following three odd edge cases: 1) a zero-size
-          // buffer, 2) a dead tensor which has an uninit value, and
-          // 3) the tensor has the on_host allocation attribute,
-          // i.e. it's in CPU RAM *independent of its assigned
-          // device type*.
-          const bool on_host = send_args.alloc_attrs.on_host();
-          {
-            // Non-DMA cases.
-            if (src_dev->tensorflow_gpu_device_info() && (!on_host)) {
-              DeviceContext* send_dev_context = send_args.device_context;
-              AllocatorAttributes alloc_attrs;
-              alloc_attrs.set_gpu_compatible(true);
-              alloc_attrs.set_on_host(true);
-              Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
-              Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
-              CHECK(send_dev_context)
-                  << "send dev name: " << src_dev->name()
-                  << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
-              // "val" is on an accelerator device. Uses the device_context to
-              // fill the copy on host.
-              StatusCallback copy_ready = [response, done, copy,
-                                           is_dead](const Status& s) {
-                // The value is now ready to be returned on the wire.
-                grpc::EncodeTensorToByteBuffer(is_dead, *copy, response);
-                done(s);
-                delete copy;
-              };
-
-              send_dev_context->CopyDeviceTensorToCPU(
-                  &val, request->rendezvous_key(), src_dev, copy, copy_ready);
-            } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
-              done(Status::OK());
-            }
-          }
+          EncodeRecvTensor(request->rendezvous_key(), src_dev, send_args, val,
+                           is_dead, request->accepted_encoding(),
+                           env_->compute_pool, response, done);
         } else {
           //  !s.ok()
           done(status);
@@ -505,9 +593,93 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::GrpcRecvTensorsAsync(CallOptions* opts,
+                                      const RecvTensorsRequest* request,
+                                      ::grpc::ByteBuffer* response,
+                                      StatusCallback done) {
+  Status s = recv_tensor_recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensors (GrpcWorker)", *request);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  const int64 step_id = request->step_id();
+  const int num_keys = request->rendezvous_key_size();
+  TRACEPRINTF("RecvTensors: %lld %d keys", step_id, num_keys);
+  std::vector<Rendezvous::ParsedKey> parsed(num_keys);
+  std::vector<Device*> src_devs(num_keys, nullptr);
+  for (int i = 0; i < num_keys && s.ok(); ++i) {
+    s = Rendezvous::ParseKey(request->rendezvous_key(i), &parsed[i]);
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_devs[i]);
+    }
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // The encoded tensors, which are sent back-to-back once all of them are
+  // available.
+  struct State {
+    explicit State(int num_keys) : responses(num_keys), pending(num_keys) {}
+
+    std::vector<::grpc::ByteBuffer> responses;
+    mutex mu;
+    int pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+  };
+  State* state = new State(num_keys);
+  auto encoded = [opts, response, done, state](const Status& s) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) return;
+      status = state->status;
+    }
+    opts->ClearCancelCallback();
+    if (status.ok()) {
+      grpc::EncodeRecvTensorResponsesToByteBuffer(state->responses, response);
+    }
+    delete state;
+    done(status);
+  };
+  if (num_keys == 0) {
+    state->pending = 1;
+    encoded(Status::OK());
+    return;
+  }
+
+  // Like GrpcRecvTensorAsync, an RPC cancellation aborts the rendezvous
+  // while any of the tensors is still being waited for.
+  opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  for (int i = 0; i < num_keys; ++i) {
+    Device* src_dev = src_devs[i];
+    ::grpc::ByteBuffer* tensor_response = &state->responses[i];
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, parsed[i],
+        [this, encoded, src_dev, tensor_response, request, i](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& val,
+            const bool is_dead) {
+          if (status.ok()) {
+            EncodeRecvTensor(request->rendezvous_key(i), src_dev, send_args,
+                             val, is_dead, request->accepted_encoding(),
+                             env_->compute_pool, tensor_response, encoded);
+          } else {
+            encoded(status);
+          }
+        });
+  }
+}
+
 void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                               RecvBufResponse* response, StatusCallback done) {
-  // This is a generic, low performance implementation appropriate for grpc.
+  // This is a generic, low performance implementation appropriate for grpc,
+  // unless the client accepts the out-of-band transport of
+  // env_->remote_memory_manager.
   CollectiveExecutor::Handle ce_handle(
       env_->collective_executor_mgr->FindOrCreate(request->step_id()), true);
   CollectiveRemoteAccess* rma = ce_handle.get()->remote_access();
@@ -530,6 +702,21 @@ void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
           const bool on_host =
               hook->prod_dev->attributes().device_type() == "CPU" ||
               hook->prod_attr.on_host();
+          if (request->dma_ok() && env_->remote_memory_manager != nullptr &&
+              num_bytes > 0) {
+            // The memory manager holds on to the buffer until the client
+            // has read it, so the hook can be released once the transport
+            // options are set.
+            env_->remote_memory_manager->TransportOptionsFromTensor(
+                response->mutable_transport_options(), *hook->prod_value,
+                hook->prod_dev, hook->prod_ctx, on_host,
+                [this, response, done, hook](const Status& s) {
+                  response->set_send_start_micros(env_->env->NowMicros());
+                  done(s);
+                  BufRendezvous::DoneWithHook(hook);
+                });
+            return;
+          }
           if ((!on_host) && (num_bytes > 0)) {
             Device* cpu_dev = nullptr;
             s = env_->device_mgr->LookupDevice("CPU:0", &cpu_dev);
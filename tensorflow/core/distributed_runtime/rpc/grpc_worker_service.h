@@ -40,6 +40,13 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Specialized version of RecvTensors for gRPC, which encodes the tensors
+  // like GrpcRecvTensorAsync() does.
+  virtual void GrpcRecvTensorsAsync(CallOptions* opts,
+                                    const RecvTensorsRequest* request,
+                                    ::grpc::ByteBuffer* response,
+                                    StatusCallback done);
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done);
 
@@ -81,7 +81,9 @@ enum class GrpcWorkerMethod {
   kCleanupGraph,
   kCleanupAll,
   kRecvTensor,
+  kRecvTensors,
   kRecvBuf,
+  kPushTensor,
   kLogging,
   kTracing,
   kCompleteGroup,
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -47,9 +48,46 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            const Rendezvous::Args& args,
                            DoneCallback done) override;
 
+  Status PushToRemote(const Rendezvous::ParsedKey& parsed,
+                      const Rendezvous::Args& args, const Tensor& val,
+                      bool is_dead) override;
+
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // A receive that waits to be coalesced with other receives from the same
+  // remote worker.
+  struct PendingRecv {
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    DoneCallback done;
+  };
+
+  // The maximum number of receives that are coalesced into one RPC.
+  static constexpr size_t kMaxRecvsPerRpc = 128;
+
+  // Receives "parsed" with its own RecvTensor RPC.
+  void RecvOneFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                              const Rendezvous::Args& args, DoneCallback done);
+
+  // Adds the receive of "parsed" to the pending receives from its source
+  // worker, which are sent in one RPC once the thread pool runs the flush
+  // that the first of them scheduled, or once there are kMaxRecvsPerRpc.
+  void CoalesceRecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                                   const Rendezvous::Args& args,
+                                   DoneCallback done);
+
+  // Sends the pending receives from "src_worker", if any.
+  void FlushRecvs(const string& src_worker);
+
+  // Receives "recvs" from "src_worker" with one RPC.
+  void StartRecvs(const string& src_worker, std::vector<PendingRecv> recvs);
+
+  mutex pending_mu_;
+  std::unordered_map<string, std::vector<PendingRecv>> pending_recvs_
+      GUARDED_BY(pending_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -59,6 +97,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
 
   void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
+            const TensorTransportEncoding& accepted_encoding,
             AllocatorAttributes alloc_attrs, Device* dst_device,
             const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
     wi_ = wi;
@@ -69,6 +108,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    *req_.mutable_accepted_encoding() = accepted_encoding;
   }
 
   void Reset(WorkerCacheInterface* wc) {
@@ -159,6 +199,148 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorCall);
 };
 
+// Used only to push tensors to remote processes.
+class RpcPushTensorCall : public BaseRecvTensorCall {
+ public:
+  RpcPushTensorCall(WorkerInterface* wi, const string& dst_worker,
+                    int64 step_id, StringPiece key)
+      : wi_(wi), dst_worker_(dst_worker) {
+    req_.set_step_id(step_id);
+    req_.set_rendezvous_key(key.data(), key.size());
+    req_.set_request_id(GetUniqueRequestId());
+  }
+
+  // "val" must be in host memory.
+  void SetTensor(const Tensor& val, bool is_dead, int64 send_start_micros) {
+    if (is_dead) {
+      req_.set_is_dead(true);
+    } else {
+      val.AsProtoTensorContent(req_.mutable_tensor());
+    }
+    req_.set_send_start_micros(send_start_micros);
+  }
+
+  void Start(std::function<void()> push_done) override {
+    using namespace std::placeholders;
+    StatusCallback cb = std::bind(
+        [this](std::function<void()> push_done,
+               // Begin unbound arguments.
+               const Status& s) {
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          }
+          push_done();
+        },
+        std::move(push_done), _1);
+    wi_->PushTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  WorkerInterface* wi() const { return wi_; }
+  const string& dst_worker() const { return dst_worker_; }
+
+ private:
+  WorkerInterface* const wi_;
+  const string dst_worker_;
+  CallOptions opts_;
+  PushTensorRequest req_;
+  PushTensorResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcPushTensorCall);
+};
+
+// Used only to retrieve many tensors from one remote process.
+class RpcRecvTensorsCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorsCall(WorkerInterface* wi, const string& src_worker,
+                     int64 step_id,
+                     const std::vector<Rendezvous::ParsedKey>& keys,
+                     const TensorTransportEncoding& accepted_encoding)
+      : wi_(wi), src_worker_(src_worker) {
+    req_.set_step_id(step_id);
+    for (const Rendezvous::ParsedKey& parsed : keys) {
+      const StringPiece key = parsed.FullKey();
+      req_.add_rendezvous_key(key.data(), key.size());
+    }
+    req_.set_request_id(GetUniqueRequestId());
+    *req_.mutable_accepted_encoding() = accepted_encoding;
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    using namespace std::placeholders;
+    StatusCallback cb = std::bind(
+        [this](std::function<void()> recv_done,
+               // Begin unbound arguments.
+               const Status& s) {
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          } else if (resp_.tensor_size() != req_.rendezvous_key_size()) {
+            mutex_lock l(mu_);
+            status_.Update(errors::Internal(
+                "RecvTensors returned ", resp_.tensor_size(), " tensors for ",
+                req_.rendezvous_key_size(), " keys"));
+          }
+          recv_done();
+        },
+        std::move(recv_done), _1);
+    wi_->RecvTensorsAsync(&opts_, &req_, &resp_, std::move(cb));
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  // Decodes the "i"-th received tensor into "*response", to be allocated on
+  // "dst_device" with "alloc_attrs". REQUIRES: status().ok().
+  Status GetTensor(int i, Device* dst_device,
+                   const AllocatorAttributes& alloc_attrs,
+                   TensorResponse* response) {
+    response->InitAlloc(dst_device, alloc_attrs);
+    return response->InitFrom(resp_.mutable_tensor(i));
+  }
+
+  WorkerInterface* wi() const { return wi_; }
+  const string& src_worker() const { return src_worker_; }
+
+ private:
+  WorkerInterface* const wi_;
+  const string src_worker_;
+  CallOptions opts_;
+  RecvTensorsRequest req_;
+  RecvTensorsResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorsCall);
+};
+
 class RpcRecvTensorFreeList {
  public:
   RpcRecvTensorFreeList() {}
@@ -208,6 +390,16 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  if (coalesce_recvs()) {
+    CoalesceRecvFromRemoteAsync(parsed, recv_args, std::move(done));
+  } else {
+    RecvOneFromRemoteAsync(parsed, recv_args, std::move(done));
+  }
+}
+
+void RpcRemoteRendezvous::RecvOneFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -238,8 +430,8 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+  call->Init(rwi, step_id_, parsed.FullKey(), recv_tensor_encoding(),
+             recv_args.alloc_attrs, dst_device, recv_args, std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call);
@@ -260,6 +452,206 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::CoalesceRecvFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  // key.src_device identifies a remote device.
+  string src_worker;
+  string src_rel_device;
+  Status s;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    s = errors::Internal(parsed.src_device,
+                         " is invalid remote source device.");
+  }
+  Device* dst_device;
+  if (s.ok()) {
+    s = session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  bool schedule_flush;
+  std::vector<PendingRecv> full_recvs;
+  {
+    mutex_lock l(pending_mu_);
+    std::vector<PendingRecv>& pending = pending_recvs_[src_worker];
+    schedule_flush = pending.empty();
+    pending.push_back({parsed, dst_device, recv_args, std::move(done)});
+    if (pending.size() >= kMaxRecvsPerRpc) {
+      full_recvs.swap(pending);
+    }
+  }
+  if (!full_recvs.empty()) {
+    StartRecvs(src_worker, std::move(full_recvs));
+  }
+  if (schedule_flush) {
+    // The receives that become pending before the thread pool runs this
+    // closure are coalesced with this one.
+    Ref();
+    SchedClosure([this, src_worker]() {
+      FlushRecvs(src_worker);
+      Unref();
+    });
+  }
+}
+
+void RpcRemoteRendezvous::FlushRecvs(const string& src_worker) {
+  std::vector<PendingRecv> recvs;
+  {
+    mutex_lock l(pending_mu_);
+    auto it = pending_recvs_.find(src_worker);
+    if (it == pending_recvs_.end()) return;
+    recvs.swap(it->second);
+    pending_recvs_.erase(it);
+  }
+  if (!recvs.empty()) {
+    StartRecvs(src_worker, std::move(recvs));
+  }
+}
+
+void RpcRemoteRendezvous::StartRecvs(const string& src_worker,
+                                     std::vector<PendingRecv> recvs) {
+  if (recvs.size() == 1) {
+    // A receive by itself uses the RecvTensor RPC, which avoids a copy of
+    // the tensor content.
+    PendingRecv& recv = recvs[0];
+    RecvOneFromRemoteAsync(recv.parsed, recv.recv_args, std::move(recv.done));
+    return;
+  }
+
+  WorkerSession* sess = session();
+  WorkerInterface* rwi = sess->worker_cache->CreateWorker(src_worker);
+  if (rwi == nullptr) {
+    const Status s = errors::Internal("No worker known as ", src_worker);
+    for (PendingRecv& recv : recvs) {
+      recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+    }
+    return;
+  }
+
+  std::vector<Rendezvous::ParsedKey> keys;
+  keys.reserve(recvs.size());
+  for (const PendingRecv& recv : recvs) {
+    keys.push_back(recv.parsed);
+  }
+  RpcRecvTensorsCall* call =
+      new RpcRecvTensorsCall(rwi, src_worker, step_id_, keys,
+                             recv_tensor_encoding());
+
+  // Record "call" in active_ so that it can be aborted cleanly.
+  RegisterCall(call);
+
+  // Start "call".
+  Ref();
+  // "recvs" is moved into the callback, which runs exactly once.
+  auto shared_recvs =
+      std::make_shared<std::vector<PendingRecv>>(std::move(recvs));
+  call->Start([this, call, shared_recvs]() {
+    // Removes "call" from active_. Prevent StartAbort().
+    DeregisterCall(call);
+    // If StartAbort was called prior to DeregisterCall, then the
+    // current status should be bad.
+    const Status s = call->status();
+    for (size_t i = 0; i < shared_recvs->size(); ++i) {
+      PendingRecv& recv = (*shared_recvs)[i];
+      if (!s.ok()) {
+        recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+        continue;
+      }
+      TensorResponse response;
+      const Status tensor_status = call->GetTensor(
+          i, recv.dst_device, recv.recv_args.alloc_attrs, &response);
+      recv.done(tensor_status, Args(), recv.recv_args, response.tensor(),
+                response.metadata().is_dead());
+    }
+    session()->worker_cache->ReleaseWorker(call->src_worker(), call->wi());
+    delete call;
+    Unref();
+  });
+}
+
+Status RpcRemoteRendezvous::PushToRemote(const Rendezvous::ParsedKey& parsed,
+                                         const Rendezvous::Args& args,
+                                         const Tensor& val, bool is_dead) {
+  // key.dst_device identifies a remote device.
+  string dst_worker;
+  string dst_rel_device;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.dst_device, &dst_worker,
+                                        &dst_rel_device)) {
+    return errors::Internal(parsed.dst_device,
+                            " is invalid remote destination device.");
+  }
+  WorkerSession* sess = session();
+  Device* src_device;
+  TF_RETURN_IF_ERROR(
+      sess->device_mgr()->LookupDevice(parsed.src_device, &src_device));
+  WorkerInterface* rwi = sess->worker_cache->CreateWorker(dst_worker);
+  if (rwi == nullptr) {
+    return errors::Internal("No worker known as ", dst_worker);
+  }
+
+  RpcPushTensorCall* call =
+      new RpcPushTensorCall(rwi, dst_worker, step_id_, parsed.FullKey());
+  // Runs when "call" is done or could not be started. An error aborts this
+  // rendezvous, because the consumer waits for the tensor in vain.
+  auto finish = [this, call](const Status& s) {
+    if (!s.ok()) {
+      StartAbort(s);
+    }
+    session()->worker_cache->ReleaseWorker(call->dst_worker(), call->wi());
+    delete call;
+    Unref();
+  };
+  auto start = [this, call, finish]() {
+    // Record "call" in active_ so that it can be aborted cleanly.
+    RegisterCall(call);
+    call->Start([this, call, finish]() {
+      DeregisterCall(call);
+      finish(call->status());
+    });
+  };
+
+  Ref();
+  const bool on_host = args.alloc_attrs.on_host();
+  if (!is_dead && src_device->tensorflow_gpu_device_info() && !on_host) {
+    // "val" is on an accelerator device. Uses the device_context to copy it
+    // to host memory before it is pushed.
+    if (args.device_context == nullptr) {
+      finish(errors::Internal("No device context to push ", parsed.FullKey(),
+                              " from ", parsed.src_device));
+      return Status::OK();
+    }
+    AllocatorAttributes alloc_attrs;
+    alloc_attrs.set_gpu_compatible(true);
+    alloc_attrs.set_on_host(true);
+    Tensor* copy = new Tensor(src_device->GetAllocator(alloc_attrs),
+                              val.dtype(), val.shape());
+    // Keeps the device buffer alive until the copy is done.
+    Tensor* device_val = new Tensor(val);
+    args.device_context->CopyDeviceTensorToCPU(
+        device_val, parsed.edge_name, src_device, copy,
+        [this, call, copy, device_val, start, finish](const Status& s) {
+          if (s.ok()) {
+            call->SetTensor(*copy, false, env_->env->NowMicros());
+          }
+          delete copy;
+          delete device_val;
+          if (s.ok()) {
+            start();
+          } else {
+            finish(s);
+          }
+        });
+  } else {
+    call->SetTensor(val, is_dead, env_->env->NowMicros());
+    start();
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
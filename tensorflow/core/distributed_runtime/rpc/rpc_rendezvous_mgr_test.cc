@@ -154,6 +154,28 @@ TEST_F(RpcRendezvousMgrTest, CleanupAll) {
   }
 }
 
+TEST_F(RpcRendezvousMgrTest, RecvPushed) {
+  const int64 step_id = 123;
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:mnist/replica:1/task:1/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  // The tensor may be pushed before the step starts on this worker.
+  TF_ASSERT_OK(rmgr_.RecvPushed(step_id, key, V("peach"), false));
+  {
+    RemoteRendezvous* rendez = rmgr_.Find(step_id);
+    core::ScopedUnref unref(rendez);
+    rendez->SetPushTensors(true);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Tensor val(DT_STRING);
+    bool val_dead = false;
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez->Recv(key, args, &val, &val_dead));
+    EXPECT_EQ(V(val), "peach");
+    EXPECT_FALSE(val_dead);
+  }
+  rmgr_.Cleanup(step_id);
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
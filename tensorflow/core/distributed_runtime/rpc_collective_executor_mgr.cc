@@ -29,10 +29,12 @@ RpcCollectiveExecutorMgr::RpcCollectiveExecutorMgr(
     const ConfigProto& config, const DeviceMgr* dev_mgr,
     std::unique_ptr<DeviceResolverDistributed> dev_resolver,
     std::unique_ptr<CollectiveParamResolverDistributed> param_resolver,
-    WorkerCacheInterface* worker_cache, const string& task_name)
+    WorkerCacheInterface* worker_cache, const string& task_name,
+    RemoteMemoryManager* remote_memory_manager)
     : CollectiveExecutorMgr(config, dev_mgr, std::move(dev_resolver),
                             std::move(param_resolver)),
       worker_cache_(worker_cache),
+      remote_memory_manager_(remote_memory_manager),
       task_name_(task_name) {
   group_leader_ = (task_name == config.experimental().collective_group_leader())
                       ? ""
@@ -48,7 +50,8 @@ RpcCollectiveExecutorMgr::~RpcCollectiveExecutorMgr() {
 CollectiveExecutor* RpcCollectiveExecutorMgr::Create(int64 step_id) {
   CollectiveRemoteAccessDistributed* rma =
       new CollectiveRemoteAccessDistributed(dev_mgr_, dev_resolver_.get(),
-                                            worker_cache_, step_id);
+                                            worker_cache_, step_id,
+                                            remote_memory_manager_);
   return new BaseCollectiveExecutor(this, rma, step_id, dev_mgr_);
 }
 
@@ -23,6 +23,7 @@ class CollectiveParamResolverDistributed;
 class ConfigProto;
 class DeviceMgr;
 class DeviceResolverDistributed;
+class RemoteMemoryManager;
 class WorkerCacheInterface;
 class StepSequenceRequest;
 class StepSequenceResponse;
@@ -31,14 +32,17 @@ class StepSequenceResponse;
 // that uses WorkerInterface::RecvBufAsync to route data transfers over RPCs.
 //
 // In some execution environments it may be possible to implement a
-// higher-performance solution and use it in place of this class.
+// higher-performance solution and use it in place of this class. If
+// "remote_memory_manager" is not null, the data of those RPCs is moved
+// out-of-band through it.
 class RpcCollectiveExecutorMgr : public CollectiveExecutorMgr {
  public:
   RpcCollectiveExecutorMgr(
       const ConfigProto& config, const DeviceMgr* dev_mgr,
       std::unique_ptr<DeviceResolverDistributed> dev_resolver,
       std::unique_ptr<CollectiveParamResolverDistributed> param_resolver,
-      WorkerCacheInterface* worker_cache, const string& task_name);
+      WorkerCacheInterface* worker_cache, const string& task_name,
+      RemoteMemoryManager* remote_memory_manager = nullptr);
 
   virtual ~RpcCollectiveExecutorMgr();
 
@@ -52,7 +56,8 @@ class RpcCollectiveExecutorMgr : public CollectiveExecutorMgr {
  protected:
   CollectiveExecutor* Create(int64 step_id) override;
 
-  WorkerCacheInterface* const worker_cache_;  // Not owned.
+  WorkerCacheInterface* const worker_cache_;          // Not owned.
+  RemoteMemoryManager* const remote_memory_manager_;  // Not owned.
   const string task_name_;
   string group_leader_;
   friend class RpcCollectiveExecutorMgrTest;
@@ -18,11 +18,96 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Tensors smaller than this are not worth encoding.
+const size_t kMinEncodedTensorBytes = 1024;
+
+}  // namespace
+
+bool ShouldEncodeTensorForTransport(const Tensor& val,
+                                    const TensorTransportEncoding& accepted) {
+  if (!accepted.compressed() && !accepted.float_as_bfloat16()) return false;
+  if (!DataTypeCanUseMemcpy(val.dtype())) return false;
+  if (val.TotalBytes() < kMinEncodedTensorBytes) return false;
+  return accepted.compressed() || val.dtype() == DT_FLOAT;
+}
+
+void EncodeTensorForTransport(const Tensor& val,
+                              const TensorTransportEncoding& accepted,
+                              TensorProto* proto,
+                              TensorTransportEncoding* applied) {
+  applied->Clear();
+  if (!ShouldEncodeTensorForTransport(val, accepted)) {
+    val.AsProtoTensorContent(proto);
+    return;
+  }
+  if (accepted.float_as_bfloat16() && val.dtype() == DT_FLOAT) {
+    Tensor cast(DT_BFLOAT16, val.shape());
+    FloatToBFloat16(val.flat<float>().data(), cast.flat<bfloat16>().data(),
+                    val.NumElements());
+    cast.AsProtoTensorContent(proto);
+    applied->set_float_as_bfloat16(true);
+  } else {
+    val.AsProtoTensorContent(proto);
+  }
+  if (accepted.compressed()) {
+    const string& content = proto->tensor_content();
+    string compressed;
+    // Only keep compressed content that saves at least an eighth of the
+    // bytes, which is worth the time to uncompress it.
+    if (port::Snappy_Compress(content.data(), content.size(), &compressed) &&
+        compressed.size() <= content.size() - content.size() / 8) {
+      proto->set_tensor_content(std::move(compressed));
+      applied->set_compressed(true);
+    }
+  }
+}
+
+Status DecodeTensorFromTransport(const TensorTransportEncoding& applied,
+                                 TensorProto* proto) {
+  if (applied.compressed()) {
+    const string& compressed = proto->tensor_content();
+    size_t length;
+    if (!port::Snappy_GetUncompressedLength(compressed.data(),
+                                            compressed.size(), &length)) {
+      return errors::InvalidArgument("Cannot uncompress tensor content");
+    }
+    string content;
+    content.resize(length);
+    if (!port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                                 &content[0])) {
+      return errors::InvalidArgument("Cannot uncompress tensor content");
+    }
+    proto->set_tensor_content(std::move(content));
+  }
+  if (applied.float_as_bfloat16()) {
+    if (proto->dtype() != DT_BFLOAT16) {
+      return errors::InvalidArgument(
+          "Expected a bfloat16 tensor to cast to float, got ",
+          DataTypeString(proto->dtype()));
+    }
+    Tensor cast(DT_BFLOAT16);
+    if (!cast.FromProto(*proto)) {
+      return errors::InvalidArgument("Cannot parse tensor from response");
+    }
+    Tensor val(DT_FLOAT, cast.shape());
+    BFloat16ToFloat(cast.flat<bfloat16>().data(), val.flat<float>().data(),
+                    cast.NumElements());
+    val.AsProtoTensorContent(proto);
+  }
+  return Status::OK();
+}
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
@@ -51,14 +136,16 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
-  Status s;
   meta_.Swap(response);
-  if (on_host_) {
-    if (!tensor_.FromProto(allocator_, meta_.tensor())) {
-      s = errors::InvalidArgument("Cannot parse tensor from response");
+  Status s = DecodeTensorFromTransport(meta_.encoding(), meta_.mutable_tensor());
+  if (s.ok()) {
+    if (on_host_) {
+      if (!tensor_.FromProto(allocator_, meta_.tensor())) {
+        s = errors::InvalidArgument("Cannot parse tensor from response");
+      }
+    } else {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     }
-  } else {
-    s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
   }
   {
     TensorProto empty;
@@ -80,6 +167,10 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response) {
 
 Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
+    Status s;
+    if (ParseFastToDevice(source, &s)) return s;
+    ClearTensor();
+
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
 
@@ -87,8 +178,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    s = DecodeTensorFromTransport(meta_.encoding(), meta_.mutable_tensor());
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -260,6 +353,16 @@ bool TensorResponse::ParseFast(Source* source) {
           return false;
         break;
       }
+      case RecvTensorResponse::kEncodingFieldNumber: {
+        // Encoded tensors are decoded on the slow path.
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_encoding()))
+          return false;
+        if (meta_.encoding().compressed() ||
+            meta_.encoding().float_as_bfloat16())
+          return false;
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -270,10 +373,44 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+bool TensorResponse::ParseFastToDevice(Source* source, Status* status) {
+  const DeviceBase::GpuDeviceInfo* device_info =
+      device_->tensorflow_gpu_device_info();
+  if (device_info == nullptr || device_info->default_context == nullptr) {
+    return false;
+  }
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  host_attrs.set_gpu_compatible(true);
+  Allocator* device_allocator = allocator_;
+  allocator_ = device_->GetAllocator(host_attrs);
+  ClearTensor();
+  const bool parsed = ParseFast(source);
+  allocator_ = device_allocator;
+  if (!parsed) return false;
+
+  const Tensor host_tensor = std::move(tensor_);
+  tensor_ = Tensor(allocator_, host_tensor.dtype(), host_tensor.shape());
+  Notification n;
+  // "device_" is a Device, see InitAlloc().
+  device_info->default_context->CopyCPUTensorToDevice(
+      &host_tensor, static_cast<Device*>(device_), &tensor_,
+      [&n, status](const Status& s) {
+        *status = s;
+        n.Notify();
+      });
+  n.WaitForNotification();
+  return true;
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  if (!DecodeTensorFromTransport(meta_.encoding(), meta_.mutable_tensor())
+           .ok()) {
+    return false;
+  }
 
   Tensor parsed(meta_.tensor().dtype());
   if (!parsed.FromProto(allocator_, meta_.tensor())) {
@@ -29,6 +29,24 @@ class Allocator;
 class DeviceBase;
 class TensorProto;
 
+// Returns true if EncodeTensorForTransport() would apply any encoding that
+// "accepted" allows to "val".
+bool ShouldEncodeTensorForTransport(const Tensor& val,
+                                    const TensorTransportEncoding& accepted);
+
+// Stores "val" in "*proto", with the encodings that "accepted" allows and
+// that are worthwhile for "val", and sets "*applied" to the encodings that
+// were applied. Only tensors whose content can be copied with memcpy are
+// encoded.
+void EncodeTensorForTransport(const Tensor& val,
+                              const TensorTransportEncoding& accepted,
+                              TensorProto* proto,
+                              TensorTransportEncoding* applied);
+
+// Undoes the encodings "applied" to "*proto" by EncodeTensorForTransport().
+Status DecodeTensorFromTransport(const TensorTransportEncoding& applied,
+                                 TensorProto* proto);
+
 // TensorResponse can be used as the destination of an RPC that returns
 // a RecvTensorResponse.  It efficiently decodes the incoming data
 // into Tensor contents as well as associated metadata.
@@ -43,7 +61,8 @@ class TensorResponse {
   // related members.
   void ClearTensor();
 
-  // Initialize memory allocation related members.
+  // Initialize memory allocation related members. Unless the tensor is
+  // allocated in host memory, "d" must be a Device.
   void InitAlloc(DeviceBase* d, const AllocatorAttributes& aa);
 
   // Source provides a way for a particular RPC implementation to provide
@@ -70,7 +89,7 @@ class TensorResponse {
   // source->contents() into *this.
   Status ParseFrom(Source* source);
 
-  // Initialize tensor from *response.
+  // Initialize tensor from *response, undoing its encoding if any.
   // Leaves *response with unspecified contents.
   Status InitFrom(RecvTensorResponse* response);
 
@@ -93,6 +112,13 @@ class TensorResponse {
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
+  // For a device that copies from host memory with its default device
+  // context, parses the tensor into host memory that the device can DMA from
+  // with the fast path, and copies it to the device. This avoids the copy of
+  // the tensor content into the intermediate TensorProto of the slow path.
+  // Returns false, with "*status" unset, if the fast path does not apply.
+  bool ParseFastToDevice(Source* source, Status* status);
+
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +157,65 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// Encodes "src" for transport as "accepted" allows, and checks that
+// TensorResponse decodes it back to "src".
+void ValidateEncodedTensor(const Tensor& src,
+                           const TensorTransportEncoding& accepted,
+                           TensorTransportEncoding* applied) {
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  EncodeTensorForTransport(src, accepted, proto.mutable_tensor(), applied);
+  *proto.mutable_encoding() = *applied;
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(123456, response.metadata().send_start_micros());
+  EXPECT_EQ(src.DebugString(), response.tensor().DebugString());
+
+  // The same through InitFrom, as for protos received by other means.
+  TensorResponse from_proto;
+  from_proto.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_EXPECT_OK(from_proto.InitFrom(&proto));
+  test::ExpectTensorEqual<float>(src, from_proto.tensor());
+}
+
+TEST_F(TensorResponseTest, TransportEncoding) {
+  // Small integers are exactly representable as bfloat16, and their bytes
+  // compress well.
+  Tensor src(DT_FLOAT, TensorShape({4096}));
+  auto flat = src.flat<float>();
+  for (int i = 0; i < flat.size(); ++i) {
+    flat(i) = i % 10;
+  }
+
+  TensorTransportEncoding accepted;
+  TensorTransportEncoding applied;
+  ValidateEncodedTensor(src, accepted, &applied);
+  EXPECT_FALSE(applied.compressed());
+  EXPECT_FALSE(applied.float_as_bfloat16());
+
+  accepted.set_float_as_bfloat16(true);
+  ValidateEncodedTensor(src, accepted, &applied);
+  EXPECT_TRUE(applied.float_as_bfloat16());
+
+  // Compression depends on snappy being available in this build.
+  accepted.set_compressed(true);
+  ValidateEncodedTensor(src, accepted, &applied);
+  EXPECT_TRUE(applied.float_as_bfloat16());
+
+  // Tensors that are too small are never encoded.
+  Tensor small(DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&small, {1, 2, 3, 4});
+  ValidateEncodedTensor(small, accepted, &applied);
+  EXPECT_FALSE(applied.compressed());
+  EXPECT_FALSE(applied.float_as_bfloat16());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
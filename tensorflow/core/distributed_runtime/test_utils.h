@@ -83,6 +83,18 @@ class TestWorkerInterface : public WorkerInterface {
     done(errors::Unimplemented("RunGraphAsync"));
   }
 
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    done(errors::Unimplemented("RecvTensorsAsync"));
+  }
+
+  void PushTensorAsync(CallOptions* opts, const PushTensorRequest* request,
+                       PushTensorResponse* response,
+                       StatusCallback done) override {
+    done(errors::Unimplemented("PushTensorAsync"));
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     done(errors::Unimplemented("RunGraphAsync"));
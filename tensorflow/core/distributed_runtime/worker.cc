@@ -23,11 +23,13 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/platform/device_tracer.h"
 #include "tensorflow/core/platform/tracing.h"
 
 namespace tensorflow {
 
-Worker::Worker(WorkerEnv* env) : env_(env) {}
+Worker::Worker(WorkerEnv* env)
+    : env_(env), push_tensor_recent_request_ids_(100000) {}
 
 void Worker::GetStatusAsync(const GetStatusRequest* request,
                             GetStatusResponse* response, StatusCallback done) {
@@ -154,6 +156,10 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
                         StatusCallback done) {
   const int64 step_id = request->step_id();
   TRACEPRINTF("RunGraph: %lld", step_id);
+  const bool record_timeline = request->exec_opts().record_timeline();
+  if (record_timeline) {
+    response->set_start_micros(env_->env->NowMicros());
+  }
   std::shared_ptr<WorkerSession> session;
   Status s;
   if (request->create_worker_session_called()) {
@@ -179,7 +185,21 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
       request->exec_opts().record_timeline() ||
       request->exec_opts().record_costs()) {
     collector = new StepStatsCollector(response->mutable_step_stats());
-    // TODO(mrry,pbar): GPU tracing for distributed steps.
+  }
+  DeviceTracer* tracer = nullptr;
+  if (collector && request->exec_opts().record_hardware_trace()) {
+    // The tracer may be null on platforms without accelerators.
+    tracer = CreateDeviceTracer().release();
+    if (tracer) {
+      Status tracer_status = tracer->Start();
+      if (!tracer_status.ok()) {
+        // The process can only trace one step at a time.
+        LOG(WARNING) << "Not tracing the devices in step " << step_id << ": "
+                     << tracer_status;
+        delete tracer;
+        tracer = nullptr;
+      }
+    }
   }
   CancellationManager* cm = new CancellationManager;
   opts->SetCancelCallback([this, cm, step_id]() {
@@ -193,6 +213,8 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
   if (already_cancelled) {
     opts->ClearCancelCallback();
     delete cm;
+    if (tracer) tracer->Stop().IgnoreError();
+    delete tracer;
     delete collector;
     delete out;
     done(errors::Aborted("Call was aborted"));
@@ -201,8 +223,8 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
   session->graph_mgr->ExecuteAsync(
       request->graph_handle(), step_id, session.get(), request->exec_opts(),
       collector, response, cm, in,
-      [this, step_id, response, session, cm, out, token, collector, opts,
-       done](Status s) {
+      [this, step_id, response, session, cm, out, token, collector, tracer,
+       record_timeline, opts, done](Status s) {
         if (s.ok()) {
           s = session->graph_mgr->RecvOutputs(step_id, out);
         }
@@ -217,9 +239,23 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
             response->AddRecv(key, val);
           }
         }
+        if (tracer) {
+          Status tracer_status = tracer->Stop();
+          if (tracer_status.ok()) {
+            tracer_status = tracer->Collect(collector);
+          }
+          if (!tracer_status.ok()) {
+            LOG(WARNING) << "Failed to trace the devices in step " << step_id
+                         << ": " << tracer_status;
+          }
+          delete tracer;
+        }
         if (collector) collector->Finalize();
         delete collector;
         delete out;
+        if (record_timeline) {
+          response->set_end_micros(env_->env->NowMicros());
+        }
         done(s);
       });
 }
@@ -412,6 +448,49 @@ Status Worker::PrepareRecvTensor(const Rendezvous::ParsedKey& parsed,
   return Status::OK();
 }
 
+void Worker::PushTensorAsync(CallOptions* opts,
+                             const PushTensorRequest* request,
+                             PushTensorResponse* response,
+                             StatusCallback done) {
+  Status s = push_tensor_recent_request_ids_.TrackUnique(
+      request->request_id(), "PushTensor (Worker)", *request);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  const int64 step_id = request->step_id();
+  const string& key = request->rendezvous_key();
+  TRACEPRINTF("PushTensor: %lld %s", step_id, key.c_str());
+  Rendezvous::ParsedKey parsed;
+  s = Rendezvous::ParseKey(key, &parsed);
+  Device* dst_dev = nullptr;
+  if (s.ok()) {
+    s = env_->device_mgr->LookupDevice(
+        DeviceNameUtils::LocalName(parsed.dst_device), &dst_dev);
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // The tensor is buffered in host memory that the destination device can
+  // copy from, until the Recv op that consumes it runs.
+  Tensor val;
+  if (!request->is_dead()) {
+    AllocatorAttributes alloc_attrs;
+    alloc_attrs.set_on_host(true);
+    alloc_attrs.set_gpu_compatible(true);
+    if (!val.FromProto(dst_dev->GetAllocator(alloc_attrs),
+                       request->tensor())) {
+      done(errors::InvalidArgument("Cannot parse tensor pushed for ", key));
+      return;
+    }
+  }
+  done(env_->rendezvous_mgr->RecvPushed(step_id, parsed, val,
+                                        request->is_dead()));
+}
+
 void Worker::RecvTensorAsync(CallOptions* opts,
                              const RecvTensorRequest* request,
                              TensorResponse* response, StatusCallback done) {
@@ -422,4 +501,14 @@ void Worker::RecvTensorAsync(CallOptions* opts,
   done(errors::Unimplemented("Worker::RecvTensorAsync()"));
 }
 
+void Worker::RecvTensorsAsync(CallOptions* opts,
+                              const RecvTensorsRequest* request,
+                              RecvTensorsResponse* response,
+                              StatusCallback done) {
+  // Like RecvTensorAsync, the base Worker class does not implement
+  // RecvTensorsAsync. Use a transport-specific implementation (such as
+  // `GrpcWorker::GrpcRecvTensorsAsync()`) instead.
+  done(errors::Unimplemented("Worker::RecvTensorsAsync()"));
+}
+
 }  // namespace tensorflow
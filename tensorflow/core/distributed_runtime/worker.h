@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/partial_run_mgr.h"
+#include "tensorflow/core/distributed_runtime/recent_request_ids.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 
@@ -84,6 +85,14 @@ class Worker : public WorkerInterface {
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override;
 
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override;
+
+  void PushTensorAsync(CallOptions* opts, const PushTensorRequest* request,
+                       PushTensorResponse* response,
+                       StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -120,6 +129,8 @@ class Worker : public WorkerInterface {
 
   CancellationManager cancellation_manager_;
 
+  RecentRequestIds push_tensor_recent_request_ids_;
+
   Status PrepareRunGraph(RunGraphRequestWrapper* req,
                          GraphMgr::NamedTensors* in,
                          GraphMgr::NamedTensors* out);
@@ -29,6 +29,7 @@ class CollectiveExecutorMgrInterface;
 class Device;
 class DeviceMgr;
 class Env;
+class RemoteMemoryManager;
 class RendezvousMgrInterface;
 class SessionMgr;
 
@@ -62,6 +63,10 @@ struct WorkerEnv {
   // supporting collective operations.
   CollectiveExecutorMgrInterface* collective_executor_mgr = nullptr;
 
+  // If not null, an out-of-band transport (e.g. RDMA) that the rendezvous
+  // and the collectives may use to transfer tensors between workers.
+  RemoteMemoryManager* remote_memory_manager = nullptr;
+
   // A pool of threads for scheduling compute work.
   thread::ThreadPool* compute_pool = nullptr;
 };
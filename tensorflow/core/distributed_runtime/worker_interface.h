@@ -106,6 +106,16 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  virtual void RecvTensorsAsync(CallOptions* opts,
+                                const RecvTensorsRequest* request,
+                                RecvTensorsResponse* response,
+                                StatusCallback done) = 0;
+
+  virtual void PushTensorAsync(CallOptions* opts,
+                               const PushTensorRequest* request,
+                               PushTensorResponse* response,
+                               StatusCallback done) = 0;
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -18,10 +18,13 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -31,6 +34,8 @@ void AllocatorStats::Clear() {
   this->max_bytes_in_use = 0;
   this->max_alloc_size = 0;
   this->bytes_limit = 0;
+  this->num_cache_hits = 0;
+  this->bytes_in_caches = 0;
 }
 
 string AllocatorStats::DebugString() const {
@@ -39,9 +44,12 @@ string AllocatorStats::DebugString() const {
       "InUse:        %20lld\n"
       "MaxInUse:     %20lld\n"
       "NumAllocs:    %20lld\n"
-      "MaxAllocSize: %20lld\n",
+      "MaxAllocSize: %20lld\n"
+      "CacheHits:    %20lld\n"
+      "InCaches:     %20lld\n",
       this->bytes_limit, this->bytes_in_use, this->max_bytes_in_use,
-      this->num_allocs, this->max_alloc_size);
+      this->num_allocs, this->max_alloc_size, this->num_cache_hits,
+      this->bytes_in_caches);
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -84,22 +92,59 @@ static int64_t TotalAllocationWarningBytes() {
   return value;
 }
 
+// Large buffers such as embeddings are mostly read at random offsets, which
+// misses the TLB on every access when they are backed by 4KB pages.  Setting
+// TF_CPU_ALLOCATOR_USE_HUGE_PAGES backs the allocations of the default cpu
+// allocator that span huge pages with transparent huge pages, and setting
+// TF_CPU_ALLOCATOR_INTERLEAVE_NUMA also spreads them across NUMA nodes, so that
+// read-mostly tensors shared by all sockets don't saturate a single one.
+static bool CPUAllocatorInterleaveNUMA() {
+  static const bool value = [] {
+    bool interleave;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_INTERLEAVE_NUMA", false,
+                                   &interleave));
+    return interleave;
+  }();
+  return value;
+}
+
+static bool CPUAllocatorUseHugePages() {
+  static const bool value = [] {
+    bool use_huge_pages;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_HUGE_PAGES", false,
+                                   &use_huge_pages));
+    return use_huge_pages || CPUAllocatorInterleaveNUMA();
+  }();
+  return value;
+}
+
 void EnableCPUAllocatorStats(bool enable) {
   cpu_allocator_collect_stats = enable;
 }
+bool CPUAllocatorStatsEnabled() { return cpu_allocator_collect_stats; }
 void EnableCPUAllocatorFullStats(bool enable) {
   cpu_allocator_collect_full_stats = enable;
 }
 
 class CPUAllocator : public Allocator {
  public:
-  CPUAllocator()
-      : single_allocation_warning_count_(0),
+  CPUAllocator() : CPUAllocator(port::kNUMANoAffinity) {}
+
+  explicit CPUAllocator(int numa_node)
+      : numa_node_(numa_node),
+        use_huge_pages_(numa_node == port::kNUMANoAffinity &&
+                        CPUAllocatorUseHugePages()),
+        interleave_numa_(CPUAllocatorInterleaveNUMA()),
+        single_allocation_warning_count_(0),
         total_allocation_warning_count_(0) {}
 
   ~CPUAllocator() override {}
 
-  string Name() override { return "cpu"; }
+  string Name() override {
+    return numa_node_ == port::kNUMANoAffinity
+               ? "cpu"
+               : strings::StrCat("cpu_numa_", numa_node_);
+  }
 
   void* AllocateRaw(size_t alignment, size_t num_bytes) override {
     if (num_bytes > LargeAllocationWarningBytes() &&
@@ -110,7 +155,14 @@ class CPUAllocator : public Allocator {
                    << "% of system memory.";
     }
 
-    void* p = port::AlignedMalloc(num_bytes, alignment);
+    void* p;
+    if (numa_node_ != port::kNUMANoAffinity) {
+      p = port::NUMAMalloc(numa_node_, num_bytes, alignment);
+    } else if (use_huge_pages_) {
+      p = port::HugePageMalloc(num_bytes, alignment, interleave_numa_);
+    } else {
+      p = port::AlignedMalloc(num_bytes, alignment);
+    }
     if (cpu_allocator_collect_stats) {
       const std::size_t alloc_size = port::MallocExtension_GetAllocatedSize(p);
       mutex_lock l(mu_);
@@ -139,7 +191,11 @@ class CPUAllocator : public Allocator {
       mutex_lock l(mu_);
       stats_.bytes_in_use -= alloc_size;
     }
-    port::AlignedFree(ptr);
+    if (numa_node_ == port::kNUMANoAffinity) {
+      port::AlignedFree(ptr);
+    } else {
+      port::NUMAFree(ptr, 0);
+    }
   }
 
   void GetStats(AllocatorStats* stats) override {
@@ -159,6 +215,10 @@ class CPUAllocator : public Allocator {
   }
 
  private:
+  const int numa_node_;
+  const bool use_huge_pages_;
+  const bool interleave_numa_;
+
   mutex mu_;
   AllocatorStats stats_ GUARDED_BY(mu_);
 
@@ -178,6 +238,26 @@ Allocator* cpu_allocator() {
   return cpu_alloc;
 }
 
+Allocator* cpu_allocator(int numa_node) {
+  if (!port::NUMAEnabled() || numa_node == port::kNUMANoAffinity) {
+    return cpu_allocator();
+  }
+  CHECK_GE(numa_node, 0);
+  CHECK_LT(numa_node, port::NUMANumNodes());
+  static mutex mu(LINKER_INITIALIZED);
+  static std::vector<Allocator*>* numa_allocators =
+      new std::vector<Allocator*>(port::NUMANumNodes(), nullptr);
+  mutex_lock l(mu);
+  Allocator*& alloc = (*numa_allocators)[numa_node];
+  if (alloc == nullptr) {
+    alloc = new CPUAllocator(numa_node);
+    if (cpu_allocator_collect_full_stats) {
+      alloc = new TrackingAllocator(alloc, true);
+    }
+  }
+  return alloc;
+}
+
 REGISTER_MEM_ALLOCATOR("DefaultCPUAllocator", 100, CPUAllocator);
 
 }  // namespace tensorflow
@@ -57,6 +57,13 @@ struct AllocatorStats {
   // unknown.
   int64 bytes_limit;
 
+  // For allocators that keep caches of recently freed memory: the number
+  // of allocations (out of num_allocs) served from such a cache, and the
+  // number of bytes currently held by the caches (not included in
+  // bytes_in_use).
+  int64 num_cache_hits;
+  int64 bytes_in_caches;
+
   AllocatorStats() { Clear(); }
 
   void Clear();
@@ -380,10 +387,19 @@ struct AllocatorAttributes {
 // default malloc. The returned allocator is a process singleton.
 Allocator* cpu_allocator();
 
+// Returns a process singleton Allocator which uses the system default malloc
+// and asks for its memory to be placed on NUMA node 'numa_node'. Returns
+// cpu_allocator() if NUMA is not enabled or 'numa_node' is
+// port::kNUMANoAffinity.
+Allocator* cpu_allocator(int numa_node);
+
 // If 'enable' is true, the process-wide cpu allocator collects
 // AllocatorStats. By default, it's disabled.
 void EnableCPUAllocatorStats(bool enable);
 
+// Returns true if the process-wide cpu allocator collects AllocatorStats.
+bool CPUAllocatorStatsEnabled();
+
 // If 'enable' is true, the process-wide cpu allocator collects full
 // statistics. By default, it's disabled.
 void EnableCPUAllocatorFullStats(bool enable);
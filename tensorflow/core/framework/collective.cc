@@ -50,6 +50,8 @@ CollInstanceParams& CollInstanceParams::operator=(
     impl_details.subdiv_source_rank.assign(
         other.impl_details.subdiv_source_rank.begin(),
         other.impl_details.subdiv_source_rank.end());
+    impl_details.hierarchical = other.impl_details.hierarchical;
+    impl_details.nccl = other.impl_details.nccl;
   }
   return *this;
 }
@@ -84,6 +86,12 @@ string CollInstanceParams::ToString() const {
     }
     strings::StrAppend(&v, "}");
   }
+  if (impl_details.hierarchical) {
+    strings::StrAppend(&v, " hierarchical");
+  }
+  if (impl_details.nccl) {
+    strings::StrAppend(&v, " nccl");
+  }
   strings::StrAppend(&v, "}");  // all subdivs
   return v;
 }
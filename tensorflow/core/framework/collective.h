@@ -68,6 +68,12 @@ struct CollImplDetails {
   std::vector<int> subdiv_offsets;
   // broadcast only: rank of source in each subdiv
   std::vector<int> subdiv_source_rank;
+  // reduction only: if true, reduce within each task and across tasks
+  // separately, rather than over one ring of the whole group.
+  bool hierarchical = false;
+  // reduction only: if true, delegate the whole all-reduce to NCCL, see
+  // RegisterNcclReduceFunction.
+  bool nccl = false;
 };
 
 // Data common to all members of a collective instance.
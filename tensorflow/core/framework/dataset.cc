@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/util/batch_util.h"
 
 namespace tensorflow {
 
@@ -196,6 +197,87 @@ bool GraphDefBuilderWrapper::HasAttr(const string& op_type_name,
   return HasAttr(op_def, attr_name);
 }
 
+Status IteratorBase::GetNextIntoBatch(IteratorContext* ctx, int64 index,
+                                      std::vector<Tensor>* batch,
+                                      bool* end_of_sequence) {
+  std::vector<Tensor> element;
+  TF_RETURN_IF_ERROR(GetNext(ctx, &element, end_of_sequence));
+  if (*end_of_sequence) return Status::OK();
+  return CopyElementToBatch(std::move(element), index, batch);
+}
+
+// static
+Status IteratorBase::CopyElementToBatch(std::vector<Tensor> element,
+                                        int64 index,
+                                        std::vector<Tensor>* batch) {
+  if (element.size() != batch->size()) {
+    return errors::InvalidArgument("Cannot batch an element with ",
+                                   element.size(), " components into ",
+                                   batch->size(), " components.");
+  }
+  for (size_t i = 0; i < element.size(); ++i) {
+    Tensor* batch_component = &(*batch)[i];
+    TF_RETURN_IF_ERROR(CheckBatchComponent(
+        *batch_component, i, index, element[i].dtype(), element[i].shape()));
+    TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(std::move(element[i]),
+                                                      batch_component, index));
+  }
+  return Status::OK();
+}
+
+// static
+int64 IteratorBase::ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& component : element) {
+    bytes += component.TotalBytes();
+  }
+  return bytes;
+}
+
+// static
+int64 IteratorBase::BatchSliceBytes(const std::vector<Tensor>& batch,
+                                    int64 index) {
+  int64 bytes = 0;
+  for (const Tensor& batch_component : batch) {
+    if (batch_component.dims() == 0 || batch_component.dim_size(0) == 0) {
+      continue;
+    }
+    const int64 slice_size =
+        batch_component.NumElements() / batch_component.dim_size(0);
+    if (batch_component.dtype() == DT_STRING) {
+      auto flat = batch_component.flat_outer_dims<string>();
+      for (int64 i = 0; i < slice_size; ++i) {
+        bytes += flat(index, i).size();
+      }
+    } else {
+      bytes += slice_size * DataTypeSize(batch_component.dtype());
+    }
+  }
+  return bytes;
+}
+
+// static
+Status IteratorBase::CheckBatchComponent(const Tensor& batch_component,
+                                         size_t component, int64 index,
+                                         DataType dtype,
+                                         const TensorShape& shape) {
+  if (dtype != batch_component.dtype()) {
+    return errors::InvalidArgument(
+        "Cannot batch a tensor of type ", DataTypeString(dtype),
+        " into a tensor of type ", DataTypeString(batch_component.dtype()),
+        " in component ", component, ".");
+  }
+  TensorShape slice_shape = batch_component.shape();
+  slice_shape.RemoveDim(0);
+  if (shape != slice_shape) {
+    return errors::InvalidArgument(
+        "Cannot batch tensors with different shapes in component ", component,
+        ". First element had shape ", slice_shape.DebugString(),
+        " and element ", index, " had shape ", shape.DebugString(), ".");
+  }
+  return Status::OK();
+}
+
 Status GraphDatasetBase::Serialize(OpKernelContext* ctx,
                                    string* serialized_graph_def,
                                    string* output_node) const {
@@ -22,6 +22,8 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_stateful_op_whitelist.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/iterator_stats.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -275,6 +277,14 @@ class IteratorContext {
 
     // The Allocator to be used to allocate the output of an iterator.
     std::function<Allocator*(AllocatorAttributes)> allocator_getter = nullptr;
+
+    // The model of the input pipeline that the iterator belongs to, if any,
+    // which tunes the parallelism of its iterators.
+    std::shared_ptr<model::Model> model = nullptr;
+
+    // The statistics of the iterators of the input pipeline that the
+    // iterator belongs to, if any.
+    std::shared_ptr<PipelineStats> pipeline_stats = nullptr;
   };
 
   explicit IteratorContext(Params params) : params_(std::move(params)) {}
@@ -313,6 +323,41 @@ class IteratorContext {
     return params_.stats_aggregator_getter;
   }
 
+  std::shared_ptr<model::Model> model() { return params_.model; }
+
+  void set_model(std::shared_ptr<model::Model> model) {
+    params_.model = std::move(model);
+  }
+
+  // Returns the node through which an iterator that produces up to
+  // `parallelism` elements in parallel, or `model::kAutoTune`, reports its
+  // statistics to the model of its pipeline and reads its parallelism. See
+  // `model::Model::AddNode()`.
+  std::shared_ptr<model::Node> MakeModelNode(int64 parallelism,
+                                             int64 max_parallelism = 0) {
+    if (params_.model) {
+      return params_.model->AddNode(parallelism, max_parallelism);
+    }
+    return model::Model::NewStandaloneNode(parallelism, max_parallelism);
+  }
+
+  std::shared_ptr<PipelineStats> pipeline_stats() {
+    return params_.pipeline_stats;
+  }
+
+  void set_pipeline_stats(std::shared_ptr<PipelineStats> pipeline_stats) {
+    params_.pipeline_stats = std::move(pipeline_stats);
+  }
+
+  // Returns the statistics of a new iterator with the given prefix, which are
+  // part of the statistics of its pipeline if there are any.
+  std::shared_ptr<IteratorStats> MakeIteratorStats(const string& prefix) {
+    if (params_.pipeline_stats) {
+      return params_.pipeline_stats->AddIterator(prefix);
+    }
+    return PipelineStats::NewStandaloneIterator(prefix);
+  }
+
  private:
   Params params_;
 };
@@ -341,6 +386,21 @@ class IteratorBase {
   virtual Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                          bool* end_of_sequence) = 0;
 
+  // Like `GetNext()`, but stores the components of the next output in the
+  // `index`-th slices (in the 0th dimension) of the respective tensors in
+  // `*batch`. The slices must have the shapes of the components.
+  //
+  // The default implementation copies the output of `GetNext()` into
+  // `*batch`. Iterators that copy their outputs from existing buffers, and
+  // iterators that forward the outputs of their input, override it to write
+  // directly into `*batch`, which saves a batching dataset one copy of each
+  // output.
+  //
+  // This method is thread-safe.
+  virtual Status GetNextIntoBatch(IteratorContext* ctx, int64 index,
+                                  std::vector<Tensor>* batch,
+                                  bool* end_of_sequence);
+
   // Returns a vector of DataType values, representing the respective
   // element types of each tuple component in the outputs of this
   // iterator.
@@ -382,6 +442,27 @@ class IteratorBase {
     return parent->RestoreInternal(ctx, reader);
   }
 
+  // Copies `element` into the `index`-th slices of `*batch`, for
+  // implementations of `GetNextIntoBatch()`.
+  static Status CopyElementToBatch(std::vector<Tensor> element, int64 index,
+                                   std::vector<Tensor>* batch);
+
+  // Returns the number of bytes of `element`, and of the `index`-th element
+  // of `batch`, respectively, for recording `IteratorStats`.
+  static int64 ElementBytes(const std::vector<Tensor>& element);
+  static int64 BatchSliceBytes(const std::vector<Tensor>& batch, int64 index);
+
+  // The statistics of this iterator, or null if it was not created by
+  // `DatasetBase::MakeIterator()`.
+  IteratorStats* stats() const { return stats_.get(); }
+
+  // Returns an error unless the slices of `batch_component` can hold the
+  // `component`-th component of the `index`-th element of a batch, which has
+  // the given type and shape.
+  static Status CheckBatchComponent(const Tensor& batch_component,
+                                    size_t component, int64 index,
+                                    DataType dtype, const TensorShape& shape);
+
   // Saves the state of this iterator recursively.
   virtual Status SaveInternal(IteratorStateWriter* writer) {
     return errors::Unimplemented("SaveInternal");
@@ -392,6 +473,11 @@ class IteratorBase {
                                  IteratorStateReader* reader) {
     return errors::Unimplemented("RestoreInternal");
   }
+
+ private:
+  friend class DatasetBase;
+
+  std::shared_ptr<IteratorStats> stats_;
 };
 
 // Represents a (potentially infinite) range of outputs, where each
@@ -411,6 +497,7 @@ class DatasetBase : public core::RefCounted {
   Status MakeIterator(IteratorContext* ctx, const string& prefix,
                       std::unique_ptr<IteratorBase>* iterator) const {
     *iterator = MakeIteratorInternal(prefix);
+    (*iterator)->stats_ = ctx->MakeIteratorStats(prefix);
     return (*iterator)->Initialize(ctx);
   }
 
@@ -532,7 +619,11 @@ class DatasetIterator : public IteratorBase {
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) final {
     tracing::ScopedActivity activity(params_.prefix);
+    IteratorStats::ScopedCall call(stats());
     Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+    if (s.ok() && !*end_of_sequence) {
+      call.RecordElement(ElementBytes(*out_tensors));
+    }
     if (TF_PREDICT_FALSE(errors::IsOutOfRange(s) && !*end_of_sequence)) {
       s = errors::Internal(
           "Iterator \"", params_.prefix,
@@ -544,6 +635,18 @@ class DatasetIterator : public IteratorBase {
     return s;
   }
 
+  Status GetNextIntoBatch(IteratorContext* ctx, int64 index,
+                          std::vector<Tensor>* batch,
+                          bool* end_of_sequence) final {
+    tracing::ScopedActivity activity(params_.prefix);
+    IteratorStats::ScopedCall call(stats());
+    Status s = GetNextIntoBatchInternal(ctx, index, batch, end_of_sequence);
+    if (s.ok() && !*end_of_sequence) {
+      call.RecordElement(BatchSliceBytes(*batch, index));
+    }
+    return s;
+  }
+
   Status Save(OpKernelContext* ctx, IteratorStateWriter* writer) final {
     TF_RETURN_IF_ERROR(dataset()->Save(ctx, writer));
     return IteratorBase::Save(ctx, writer);
@@ -555,6 +658,17 @@ class DatasetIterator : public IteratorBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) = 0;
 
+  // Internal implementation of GetNextIntoBatch that is wrapped in tracing
+  // logic.
+  virtual Status GetNextIntoBatchInternal(IteratorContext* ctx, int64 index,
+                                          std::vector<Tensor>* batch,
+                                          bool* end_of_sequence) {
+    std::vector<Tensor> element;
+    TF_RETURN_IF_ERROR(GetNextInternal(ctx, &element, end_of_sequence));
+    if (*end_of_sequence) return Status::OK();
+    return CopyElementToBatch(std::move(element), index, batch);
+  }
+
   string full_name(const string& name) const {
     return strings::StrCat(prefix(), ":", name);
   }
@@ -0,0 +1,142 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/dataset_scheduler.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+DatasetScheduler::DatasetScheduler(Env* env, const string& name,
+                                   int num_threads) {
+  CHECK_GE(num_threads, 1);
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(env->StartThread(
+        ThreadOptions(), strings::StrCat(name, "_", i), [this]() {
+          WorkerLoop();
+        }));
+  }
+}
+
+DatasetScheduler::~DatasetScheduler() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+  }
+  // Joins the threads, which exit once there is no more pending work.
+  threads_.clear();
+}
+
+// static
+DatasetScheduler* DatasetScheduler::Global() {
+  static DatasetScheduler* scheduler = [] {
+    int64 num_threads;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_DATA_SCHEDULER_NUM_THREADS",
+                                    port::NumSchedulableCPUs(), &num_threads));
+    return new DatasetScheduler(Env::Default(), "tf_data_scheduler",
+                                std::max<int64>(1, num_threads));
+  }();
+  return scheduler;
+}
+
+// static
+bool DatasetScheduler::SharedByDefault() {
+  static bool shared = [] {
+    bool shared;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_DATA_USE_SHARED_SCHEDULER",
+                                   /*default_val=*/false, &shared));
+    return shared;
+  }();
+  return shared;
+}
+
+std::shared_ptr<DatasetScheduler::Client> DatasetScheduler::NewClient(
+    const string& name, int priority) {
+  return std::shared_ptr<Client>(new Client(this, name, priority));
+}
+
+void DatasetScheduler::Schedule(std::shared_ptr<Client> client,
+                                std::function<void()> fn) {
+  mutex_lock l(mu_);
+  if (client->queue_.empty()) {
+    client->virtual_time_nanos_ =
+        std::max(client->virtual_time_nanos_, virtual_time_nanos_);
+    active_.push_back(std::move(client));
+    active_.back()->queue_.push_back(std::move(fn));
+  } else {
+    client->queue_.push_back(std::move(fn));
+  }
+  cond_var_.notify_one();
+}
+
+void DatasetScheduler::WorkerLoop() {
+  mutex_lock l(mu_);
+  while (true) {
+    while (!cancelled_ && active_.empty()) {
+      cond_var_.wait(l);
+    }
+    if (active_.empty()) return;
+
+    // The client with the highest priority that used the least time.
+    auto next = std::min_element(
+        active_.begin(), active_.end(),
+        [](const std::shared_ptr<Client>& a, const std::shared_ptr<Client>& b) {
+          if (a->priority_ != b->priority_) return a->priority_ > b->priority_;
+          return a->virtual_time_nanos_ < b->virtual_time_nanos_;
+        });
+    std::shared_ptr<Client> client = *next;
+    std::function<void()> fn = std::move(client->queue_.front());
+    client->queue_.pop_front();
+    if (client->queue_.empty()) {
+      active_.erase(next);
+    }
+    virtual_time_nanos_ = client->virtual_time_nanos_;
+
+    mu_.unlock();
+    const uint64 start_micros = Env::Default()->NowMicros();
+    fn();
+    const int64 elapsed_nanos =
+        (Env::Default()->NowMicros() - start_micros) * 1000;
+    mu_.lock();
+    client->virtual_time_nanos_ += elapsed_nanos;
+    client->run_time_nanos_ += elapsed_nanos;
+  }
+}
+
+void DatasetScheduler::Client::Schedule(std::function<void()> fn) {
+  scheduler_->Schedule(shared_from_this(), std::move(fn));
+}
+
+std::function<void(std::function<void()>)>
+DatasetScheduler::Client::runner() {
+  std::shared_ptr<Client> client = shared_from_this();
+  return [client](std::function<void()> fn) {
+    client->Schedule(std::move(fn));
+  };
+}
+
+int64 DatasetScheduler::Client::run_time_nanos() {
+  mutex_lock l(scheduler_->mu_);
+  return run_time_nanos_;
+}
+
+}  // namespace tensorflow
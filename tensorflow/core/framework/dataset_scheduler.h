@@ -0,0 +1,125 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_FRAMEWORK_DATASET_SCHEDULER_H_
+#define TENSORFLOW_CORE_FRAMEWORK_DATASET_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// DatasetScheduler multiplexes the work of many input pipelines onto one
+// bounded pool of threads, so that the pipelines of a process, e.g. for
+// training and evaluation, do not oversubscribe its cores.
+//
+// Each pipeline schedules its closures through a `Client`, typically by
+// installing `Client::runner()` as the runner of its `IteratorContext`.
+// Pending work of clients with a higher priority always runs first. Clients
+// of the same priority get equal shares of the time of the threads: the
+// scheduler runs the next closure of the client that has used the least
+// time so far, where a client that was idle is not credited for the time
+// it did not use.
+//
+// Closures run on a bounded number of threads, so a closure must not block
+// on other work that is scheduled after it on the same scheduler.
+class DatasetScheduler {
+ public:
+  class Client;
+
+  DatasetScheduler(Env* env, const string& name, int num_threads);
+
+  // Waits until all scheduled closures ran.
+  ~DatasetScheduler();
+
+  // Returns the process-wide scheduler. Its number of threads is the number
+  // of schedulable CPUs, or the value of the TF_DATA_SCHEDULER_NUM_THREADS
+  // environment variable.
+  static DatasetScheduler* Global();
+
+  // Returns true if all input pipelines that are iterated through an
+  // iterator resource should schedule their work on `Global()`, as set by
+  // the TF_DATA_USE_SHARED_SCHEDULER environment variable.
+  static bool SharedByDefault();
+
+  // Returns a new client with the given priority.
+  std::shared_ptr<Client> NewClient(const string& name, int priority);
+
+  int num_threads() const { return threads_.size(); }
+
+ private:
+  void Schedule(std::shared_ptr<Client> client, std::function<void()> fn);
+  void WorkerLoop();
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // The clients with pending closures.
+  std::vector<std::shared_ptr<Client>> active_ GUARDED_BY(mu_);
+  // The time used by the client that ran last, which clients that become
+  // active start from.
+  int64 virtual_time_nanos_ GUARDED_BY(mu_) = 0;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  std::vector<std::unique_ptr<Thread>> threads_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DatasetScheduler);
+};
+
+// The handle through which one input pipeline schedules its work.
+//
+// This class is thread-safe.
+class DatasetScheduler::Client
+    : public std::enable_shared_from_this<DatasetScheduler::Client> {
+ public:
+  const string& name() const { return name_; }
+  int priority() const { return priority_; }
+
+  // Schedules `fn` to run on a thread of the scheduler.
+  void Schedule(std::function<void()> fn);
+
+  // Returns a runner that schedules closures through this client, and keeps
+  // it alive.
+  std::function<void(std::function<void()>)> runner();
+
+  // The total time that closures of this client ran for.
+  int64 run_time_nanos();
+
+ private:
+  friend class DatasetScheduler;
+
+  Client(DatasetScheduler* scheduler, const string& name, int priority)
+      : scheduler_(scheduler), name_(name), priority_(priority) {}
+
+  DatasetScheduler* const scheduler_;  // Not owned.
+  const string name_;
+  const int priority_;
+
+  // Guarded by `scheduler_->mu_`.
+  std::deque<std::function<void()>> queue_;
+  int64 virtual_time_nanos_ = 0;
+  int64 run_time_nanos_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Client);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_DATASET_SCHEDULER_H_
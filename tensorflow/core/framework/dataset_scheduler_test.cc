@@ -0,0 +1,119 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/dataset_scheduler.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(DatasetSchedulerTest, RunsAllClosures) {
+  DatasetScheduler scheduler(Env::Default(), "test", 4);
+  EXPECT_EQ(4, scheduler.num_threads());
+  std::shared_ptr<DatasetScheduler::Client> a = scheduler.NewClient("a", 0);
+  std::shared_ptr<DatasetScheduler::Client> b = scheduler.NewClient("b", 1);
+  auto runner = b->runner();
+  BlockingCounter counter(200);
+  for (int i = 0; i < 100; ++i) {
+    a->Schedule([&counter]() { counter.DecrementCount(); });
+    runner([&counter]() { counter.DecrementCount(); });
+  }
+  counter.Wait();
+}
+
+// Runs `closures` on a scheduler with a single thread, which is busy until
+// all of them are scheduled, and returns the indices of their clients in
+// the order in which they ran.
+std::vector<int> RunOrder(DatasetScheduler* scheduler,
+                          const std::vector<std::pair<int, int>>& closures,
+                          const std::vector<int>& priorities) {
+  std::vector<std::shared_ptr<DatasetScheduler::Client>> clients;
+  for (int priority : priorities) {
+    clients.push_back(scheduler->NewClient("client", priority));
+  }
+  std::shared_ptr<DatasetScheduler::Client> blocker =
+      scheduler->NewClient("blocker", 0);
+  Notification start;
+  blocker->Schedule([&start]() { start.WaitForNotification(); });
+
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter counter(closures.size());
+  // Each closure is a pair of a client index and the time it runs for.
+  for (const auto& closure : closures) {
+    const int client = closure.first;
+    const int run_micros = closure.second;
+    clients[client]->Schedule([client, run_micros, &mu, &order, &counter]() {
+      Env::Default()->SleepForMicroseconds(run_micros);
+      {
+        mutex_lock l(mu);
+        order.push_back(client);
+      }
+      counter.DecrementCount();
+    });
+  }
+  start.Notify();
+  counter.Wait();
+  return order;
+}
+
+TEST(DatasetSchedulerTest, HigherPriorityRunsFirst) {
+  DatasetScheduler scheduler(Env::Default(), "test", 1);
+  // Client 0 is for evaluation, and client 1 for training.
+  EXPECT_EQ(std::vector<int>({1, 1, 0, 0}),
+            RunOrder(&scheduler, {{0, 0}, {0, 0}, {1, 0}, {1, 0}}, {0, 1}));
+}
+
+TEST(DatasetSchedulerTest, FairShare) {
+  DatasetScheduler scheduler(Env::Default(), "test", 1);
+  // Client 0 schedules all of its work first, but client 1 gets its turn
+  // as soon as client 0 used some time.
+  std::vector<int> order =
+      RunOrder(&scheduler, {{0, 1000}, {0, 1000}, {0, 1000}, {1, 1000}},
+               {0, 0});
+  ASSERT_EQ(4, order.size());
+  EXPECT_EQ(0, order[0]);
+  EXPECT_EQ(1, order[1]);
+  // A closure of client 0 that runs for longer costs it more turns.
+  EXPECT_EQ(std::vector<int>({0, 1, 1, 1}),
+            RunOrder(&scheduler, {{0, 10000}, {1, 1000}, {1, 1000}, {1, 1000}},
+                     {0, 0}));
+}
+
+TEST(DatasetSchedulerTest, RunTime) {
+  DatasetScheduler scheduler(Env::Default(), "test", 2);
+  std::shared_ptr<DatasetScheduler::Client> client =
+      scheduler.NewClient("client", 0);
+  Notification done;
+  client->Schedule([&done]() {
+    Env::Default()->SleepForMicroseconds(2000);
+    done.Notify();
+  });
+  done.WaitForNotification();
+  // The time is charged after the closure returns.
+  while (client->run_time_nanos() == 0) {
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  EXPECT_GE(client->run_time_nanos(), 2000 * 1000);
+}
+
+}  // namespace
+}  // namespace tensorflow
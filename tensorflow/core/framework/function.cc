@@ -878,6 +878,16 @@ Status FunctionCallFrame::ConsumeRetvals(std::vector<Tensor>* rets) {
   return Status::OK();
 }
 
+void FunctionCallFrame::Clear() {
+  for (Tensor& arg : args_) {
+    arg = Tensor();
+  }
+  for (Retval& ret : rets_) {
+    ret.has_val = false;
+    ret.val = Tensor();
+  }
+}
+
 Status FunctionCallFrame::GetArg(int index, Tensor* val) const {
   if (index < 0 || static_cast<size_t>(index) >= args_.size()) {
     return errors::InvalidArgument("GetArg ", index, " is not within [0, ",
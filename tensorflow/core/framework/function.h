@@ -263,6 +263,10 @@ class FunctionCallFrame : public CallFrameInterface {
   Status GetRetvals(std::vector<Tensor>* rets) const;
   Status ConsumeRetvals(std::vector<Tensor>* rets);
 
+  // Releases the args and retvals, so that the frame can be reused for
+  // another call.
+  void Clear();
+
   size_t num_args() const override { return arg_types_.size(); }
   size_t num_retvals() const override { return ret_types_.size(); }
 
@@ -454,7 +458,10 @@ class FunctionLibraryRuntime {
     // This interface is EXPERIMENTAL and subject to change.
     //
     // Instatiates the function using an executor of the given type. If empty,
-    // the default TensorFlow executor will be used.
+    // small functions on CPU are run on the calling thread by the
+    // "SINGLE_THREADED_EXECUTOR" when it supports them, and other functions
+    // by the default TensorFlow executor. "DEFAULT" always selects the
+    // latter.
     string executor_type;
   };
   typedef uint64 Handle;
@@ -0,0 +1,82 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/iterator_stats.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/env_time.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The innermost call of `GetNext()` that is measured on this thread.
+thread_local IteratorStats::ScopedCall* current_call = nullptr;
+
+}  // namespace
+
+IteratorStats::ScopedCall::ScopedCall(IteratorStats* stats)
+    : stats_(stats),
+      parent_(current_call),
+      start_micros_(EnvTime::Default()->NowMicros()) {
+  current_call = this;
+}
+
+IteratorStats::ScopedCall::~ScopedCall() {
+  const uint64 elapsed_micros =
+      EnvTime::Default()->NowMicros() - start_micros_;
+  current_call = parent_;
+  if (parent_ != nullptr) {
+    parent_->input_micros_ += elapsed_micros;
+  }
+  if (stats_ == nullptr) return;
+  const uint64 input_micros = std::min(input_micros_, elapsed_micros);
+  stats_->num_calls_.fetch_add(1, std::memory_order_relaxed);
+  if (produced_element_) {
+    stats_->num_elements_.fetch_add(1, std::memory_order_relaxed);
+    stats_->bytes_produced_.fetch_add(bytes_, std::memory_order_relaxed);
+  }
+  stats_->processing_time_.fetch_add((elapsed_micros - input_micros) * 1000,
+                                     std::memory_order_relaxed);
+  stats_->input_time_.fetch_add(input_micros * 1000,
+                                std::memory_order_relaxed);
+}
+
+std::shared_ptr<IteratorStats> PipelineStats::AddIterator(
+    const string& prefix) {
+  mutex_lock l(mu_);
+  std::shared_ptr<IteratorStats>& stats = iterators_[prefix];
+  if (!stats) {
+    stats.reset(new IteratorStats(prefix));
+  }
+  return stats;
+}
+
+// static
+std::shared_ptr<IteratorStats> PipelineStats::NewStandaloneIterator(
+    const string& prefix) {
+  return std::shared_ptr<IteratorStats>(new IteratorStats(prefix));
+}
+
+void PipelineStats::ForEachIterator(
+    const std::function<void(const IteratorStats&)>& f) {
+  mutex_lock l(mu_);
+  for (const auto& prefix_and_stats : iterators_) {
+    f(*prefix_and_stats.second);
+  }
+}
+
+}  // namespace tensorflow
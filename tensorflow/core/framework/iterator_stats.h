@@ -0,0 +1,178 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_FRAMEWORK_ITERATOR_STATS_H_
+#define TENSORFLOW_CORE_FRAMEWORK_ITERATOR_STATS_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The statistics that the iterators of an input pipeline with the same prefix
+// record about their calls of `GetNext()`. They are shared by e.g. the input
+// iterators that a repeat creates for each epoch, or that an interleave
+// creates for each input element.
+//
+// The time of a call is split into the time spent in nested calls of
+// `GetNext()` on the same thread, i.e. waiting for the inputs of the iterator,
+// and the rest, which is the processing time of the iterator itself. The time
+// an asynchronous iterator waits for its background threads counts as
+// processing time.
+//
+// This class is thread-safe.
+class IteratorStats {
+ public:
+  // Measures one call of `GetNext()` of an iterator. Calls of `GetNext()`
+  // that are measured on the same thread while it is alive are attributed to
+  // the inputs of the iterator.
+  class ScopedCall {
+   public:
+    // `stats` may be null, in which case the call is only attributed to the
+    // enclosing call.
+    explicit ScopedCall(IteratorStats* stats);
+    ~ScopedCall();
+
+    // Records that the call produced an element of `bytes` bytes.
+    void RecordElement(int64 bytes) {
+      produced_element_ = true;
+      bytes_ = bytes;
+    }
+
+   private:
+    IteratorStats* const stats_;
+    ScopedCall* const parent_;
+    const uint64 start_micros_;
+    uint64 input_micros_ = 0;
+    bool produced_element_ = false;
+    int64 bytes_ = 0;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(ScopedCall);
+  };
+
+  // The prefix of the iterator, e.g. "Iterator::Prefetch::Map".
+  const string& prefix() const { return prefix_; }
+
+  int64 num_calls() const {
+    return num_calls_.load(std::memory_order_relaxed);
+  }
+  int64 num_elements() const {
+    return num_elements_.load(std::memory_order_relaxed);
+  }
+  int64 bytes_produced() const {
+    return bytes_produced_.load(std::memory_order_relaxed);
+  }
+  // The time spent in `GetNext()`, excluding `input_time()`.
+  int64 processing_time() const {
+    return processing_time_.load(std::memory_order_relaxed);
+  }
+  // The time spent waiting for the inputs of the iterator in `GetNext()`.
+  int64 input_time() const {
+    return input_time_.load(std::memory_order_relaxed);
+  }
+
+  // Records the occupancy of the buffer of an asynchronous iterator when
+  // `GetNext()` is called: `size` elements out of `capacity`. The buffer is
+  // e.g. the elements of a prefetch or a shuffle, or the completed results of
+  // the parallel calls of a map.
+  void RecordBuffer(int64 size, int64 capacity) {
+    num_buffer_samples_.fetch_add(1, std::memory_order_relaxed);
+    buffer_size_sum_.fetch_add(size, std::memory_order_relaxed);
+    buffer_capacity_.store(capacity, std::memory_order_relaxed);
+  }
+
+  // Records that `GetNext()` of an asynchronous iterator waited `micros` for
+  // its background threads to produce an element.
+  void RecordWait(int64 micros) {
+    num_waits_.fetch_add(1, std::memory_order_relaxed);
+    wait_time_.fetch_add(micros * 1000, std::memory_order_relaxed);
+  }
+
+  int64 num_buffer_samples() const {
+    return num_buffer_samples_.load(std::memory_order_relaxed);
+  }
+  // The sum of the sizes passed to `RecordBuffer()`.
+  int64 buffer_size_sum() const {
+    return buffer_size_sum_.load(std::memory_order_relaxed);
+  }
+  // The last capacity passed to `RecordBuffer()`, 0 if it was never called.
+  int64 buffer_capacity() const {
+    return buffer_capacity_.load(std::memory_order_relaxed);
+  }
+  int64 num_waits() const {
+    return num_waits_.load(std::memory_order_relaxed);
+  }
+  // The time waited for background threads, which is part of
+  // `processing_time()`.
+  int64 wait_time() const {
+    return wait_time_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class PipelineStats;
+
+  explicit IteratorStats(const string& prefix) : prefix_(prefix) {}
+
+  const string prefix_;
+  std::atomic<int64> num_calls_{0};
+  std::atomic<int64> num_elements_{0};
+  std::atomic<int64> bytes_produced_{0};
+  std::atomic<int64> processing_time_{0};  // in nanoseconds
+  std::atomic<int64> input_time_{0};       // in nanoseconds
+  std::atomic<int64> num_buffer_samples_{0};
+  std::atomic<int64> buffer_size_sum_{0};
+  std::atomic<int64> buffer_capacity_{0};
+  std::atomic<int64> num_waits_{0};
+  std::atomic<int64> wait_time_{0};  // in nanoseconds
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IteratorStats);
+};
+
+// The statistics of all iterators of an input pipeline, which the owner of
+// the pipeline exports, e.g. into the `StepStats` of a traced step.
+//
+// This class is thread-safe.
+class PipelineStats {
+ public:
+  PipelineStats() {}
+
+  // Returns the statistics of the iterators of the pipeline with the given
+  // prefix, for a new such iterator.
+  std::shared_ptr<IteratorStats> AddIterator(const string& prefix);
+
+  // Like `AddIterator()`, for an iterator that is not part of any pipeline.
+  static std::shared_ptr<IteratorStats> NewStandaloneIterator(
+      const string& prefix);
+
+  // Calls `f` with the statistics of every prefix of the pipeline, in the
+  // order of the prefixes.
+  void ForEachIterator(const std::function<void(const IteratorStats&)>& f);
+
+ private:
+  mutex mu_;
+  std::map<string, std::shared_ptr<IteratorStats>> iterators_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PipelineStats);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_ITERATOR_STATS_H_
@@ -0,0 +1,103 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/iterator_stats.h"
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(IteratorStatsTest, RecordsElements) {
+  std::shared_ptr<IteratorStats> stats =
+      PipelineStats::NewStandaloneIterator("Iterator::Range");
+  {
+    IteratorStats::ScopedCall call(stats.get());
+    call.RecordElement(8);
+  }
+  {
+    IteratorStats::ScopedCall call(stats.get());
+    call.RecordElement(16);
+  }
+  {
+    // The end of the sequence.
+    IteratorStats::ScopedCall call(stats.get());
+  }
+  EXPECT_EQ("Iterator::Range", stats->prefix());
+  EXPECT_EQ(3, stats->num_calls());
+  EXPECT_EQ(2, stats->num_elements());
+  EXPECT_EQ(24, stats->bytes_produced());
+}
+
+TEST(IteratorStatsTest, AttributesNestedCallsToInput) {
+  std::shared_ptr<IteratorStats> map =
+      PipelineStats::NewStandaloneIterator("Iterator::Map");
+  std::shared_ptr<IteratorStats> range =
+      PipelineStats::NewStandaloneIterator("Iterator::Map::Range");
+  {
+    IteratorStats::ScopedCall map_call(map.get());
+    {
+      IteratorStats::ScopedCall range_call(range.get());
+      Env::Default()->SleepForMicroseconds(20 * 1000);
+      range_call.RecordElement(8);
+    }
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+    map_call.RecordElement(8);
+  }
+  EXPECT_EQ(0, range->input_time());
+  EXPECT_GE(range->processing_time(), 20 * 1000 * 1000);
+  EXPECT_GE(map->input_time(), range->processing_time());
+  EXPECT_GE(map->processing_time(), 10 * 1000 * 1000);
+  EXPECT_LT(map->processing_time(), map->input_time());
+}
+
+TEST(IteratorStatsTest, RecordsBufferAndWaits) {
+  std::shared_ptr<IteratorStats> stats =
+      PipelineStats::NewStandaloneIterator("Iterator::Prefetch");
+  EXPECT_EQ(0, stats->buffer_capacity());
+  stats->RecordBuffer(0, 4);
+  stats->RecordWait(10);
+  stats->RecordBuffer(3, 4);
+  stats->RecordWait(5);
+  EXPECT_EQ(2, stats->num_buffer_samples());
+  EXPECT_EQ(3, stats->buffer_size_sum());
+  EXPECT_EQ(4, stats->buffer_capacity());
+  EXPECT_EQ(2, stats->num_waits());
+  EXPECT_EQ(15 * 1000, stats->wait_time());
+}
+
+TEST(IteratorStatsTest, SharesStatsOfSamePrefix) {
+  PipelineStats pipeline;
+  std::shared_ptr<IteratorStats> first = pipeline.AddIterator("Iterator::A");
+  std::shared_ptr<IteratorStats> second = pipeline.AddIterator("Iterator::A");
+  std::shared_ptr<IteratorStats> other = pipeline.AddIterator("Iterator::B");
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+  {
+    IteratorStats::ScopedCall call(second.get());
+    call.RecordElement(4);
+  }
+  std::vector<string> prefixes;
+  pipeline.ForEachIterator([&prefixes](const IteratorStats& stats) {
+    prefixes.push_back(stats.prefix());
+  });
+  EXPECT_EQ(std::vector<string>({"Iterator::A", "Iterator::B"}), prefixes);
+  EXPECT_EQ(1, first->num_elements());
+  EXPECT_EQ(0, other->num_elements());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,150 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace model {
+
+Node::Node(std::shared_ptr<Model> model, int64 parallelism, bool tunable,
+           int64 max_parallelism)
+    : model_(std::move(model)),
+      tunable_(tunable),
+      max_parallelism_(max_parallelism),
+      parallelism_(parallelism) {}
+
+Node::~Node() {
+  if (model_) {
+    model_->RemoveNode(this);
+  }
+}
+
+void Node::RecordElement(int64 processing_time_nanos) {
+  num_elements_.fetch_add(1, std::memory_order_relaxed);
+  processing_time_.fetch_add(processing_time_nanos, std::memory_order_relaxed);
+  if (model_) {
+    model_->MaybeOptimize();
+  }
+}
+
+void Node::RecordWait(int64 wait_time_nanos) {
+  wait_time_.fetch_add(wait_time_nanos, std::memory_order_relaxed);
+}
+
+constexpr int64 Model::kDefaultOptimizationPeriodMicros;
+
+Model::Model(int64 cpu_budget, int64 optimization_period_micros)
+    : cpu_budget_(std::max<int64>(1, cpu_budget)),
+      optimization_period_micros_(optimization_period_micros),
+      next_optimization_micros_(EnvTime::Default()->NowMicros() +
+                                optimization_period_micros) {}
+
+std::shared_ptr<Node> Model::AddNode(int64 parallelism,
+                                     int64 max_parallelism) {
+  const bool tunable = parallelism == kAutoTune;
+  if (max_parallelism <= 0) max_parallelism = cpu_budget_;
+  // Tunable nodes start sequential, and get their share of the budget once
+  // the model has measured them.
+  std::shared_ptr<Node> node(new Node(shared_from_this(),
+                                      tunable ? 1 : parallelism, tunable,
+                                      tunable ? max_parallelism : parallelism));
+  mutex_lock l(mu_);
+  nodes_.push_back(node.get());
+  return node;
+}
+
+// static
+std::shared_ptr<Node> Model::NewStandaloneNode(int64 parallelism,
+                                               int64 max_parallelism) {
+  if (parallelism == kAutoTune) {
+    parallelism = max_parallelism > 0 ? max_parallelism
+                                      : port::NumSchedulableCPUs();
+  }
+  return std::shared_ptr<Node>(
+      new Node(nullptr, parallelism, /*tunable=*/false, parallelism));
+}
+
+void Model::RemoveNode(Node* node) {
+  mutex_lock l(mu_);
+  nodes_.erase(std::remove(nodes_.begin(), nodes_.end(), node), nodes_.end());
+}
+
+void Model::MaybeOptimize() {
+  const uint64 now = EnvTime::Default()->NowMicros();
+  uint64 next = next_optimization_micros_.load(std::memory_order_relaxed);
+  // Only one of the threads that see the deadline pass optimizes.
+  if (now < next ||
+      !next_optimization_micros_.compare_exchange_strong(
+          next, now + optimization_period_micros_)) {
+    return;
+  }
+  mutex_lock l(mu_);
+  OptimizeLocked();
+}
+
+void Model::Optimize() {
+  mutex_lock l(mu_);
+  OptimizeLocked();
+}
+
+void Model::OptimizeLocked() {
+  int64 fixed_parallelism = 0;
+  int64 num_tunable = 0;
+  int64 total_work = 0;
+  int64 total_wait = 0;
+  std::vector<int64> work(nodes_.size(), 0);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    Node* node = nodes_[i];
+    const int64 processing_time = node->processing_time();
+    const int64 wait_time = node->wait_time();
+    total_wait += wait_time - node->last_wait_time_;
+    if (node->tunable()) {
+      work[i] = processing_time - node->last_processing_time_;
+      total_work += work[i];
+      ++num_tunable;
+    } else {
+      fixed_parallelism += node->parallelism();
+    }
+    node->last_processing_time_ = processing_time;
+    node->last_wait_time_ = wait_time;
+  }
+  // Nothing to tune, or the pipeline keeps up with its consumers.
+  if (num_tunable == 0 || total_work == 0 || total_wait == 0) return;
+
+  const int64 budget = std::max(num_tunable, cpu_budget_ - fixed_parallelism);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    Node* node = nodes_[i];
+    if (!node->tunable()) continue;
+    const int64 share = std::llround(static_cast<double>(budget) * work[i] /
+                                     static_cast<double>(total_work));
+    const int64 parallelism =
+        std::min(node->max_parallelism(), std::max<int64>(1, share));
+    if (parallelism != node->parallelism()) {
+      VLOG(2) << "Changing the parallelism of an iterator from "
+              << node->parallelism() << " to " << parallelism;
+      node->parallelism_.store(parallelism, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace model
+}  // namespace tensorflow
@@ -0,0 +1,160 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
+#define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace model {
+
+// The value of a parallelism argument of a dataset, e.g. `num_parallel_calls`,
+// that asks the model of the input pipeline to pick it.
+constexpr int64 kAutoTune = -1;
+
+class Model;
+
+// The statistics of one iterator of an input pipeline, and its parallelism.
+//
+// An iterator records the time it spends producing each element, and the
+// time its consumer waits for an element. If the iterator was created with a
+// parallelism of `kAutoTune`, the model of its pipeline changes the value of
+// `parallelism()` over time, and the iterator must re-read it every time it
+// starts new work.
+//
+// This class is thread-safe.
+class Node {
+ public:
+  ~Node();
+
+  // The number of elements the iterator may produce in parallel.
+  int64 parallelism() const {
+    return parallelism_.load(std::memory_order_relaxed);
+  }
+  bool tunable() const { return tunable_; }
+  int64 max_parallelism() const { return max_parallelism_; }
+
+  // Records that producing one element took `processing_time_nanos`.
+  void RecordElement(int64 processing_time_nanos);
+
+  // Records that the consumer of the iterator waited `wait_time_nanos` for an
+  // element.
+  void RecordWait(int64 wait_time_nanos);
+
+  int64 num_elements() const {
+    return num_elements_.load(std::memory_order_relaxed);
+  }
+  int64 processing_time() const {
+    return processing_time_.load(std::memory_order_relaxed);
+  }
+  int64 wait_time() const {
+    return wait_time_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class Model;
+
+  Node(std::shared_ptr<Model> model, int64 parallelism, bool tunable,
+       int64 max_parallelism);
+
+  // Null for nodes that are not part of a model.
+  const std::shared_ptr<Model> model_;
+  const bool tunable_;
+  const int64 max_parallelism_;
+  std::atomic<int64> parallelism_;
+  std::atomic<int64> num_elements_{0};
+  std::atomic<int64> processing_time_{0};
+  std::atomic<int64> wait_time_{0};
+
+  // Snapshots taken by the model at its last optimization.
+  int64 last_processing_time_ = 0;  // guarded by model_->mu_
+  int64 last_wait_time_ = 0;        // guarded by model_->mu_
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Node);
+};
+
+// A model of an input pipeline, which divides a fixed CPU budget among the
+// iterators of the pipeline that can produce elements in parallel.
+//
+// Every `optimization_period_micros`, the model computes the time each
+// iterator spent producing elements since the last optimization. As all
+// iterators work towards the same output elements, that time is
+// proportional to the work each iterator does per output element, and the
+// throughput of the pipeline is highest when the parallelism of every
+// iterator is proportional to it. The model thus gives the budget that fixed
+// iterators leave to the tunable ones in proportion to their processing
+// time. It only does so after some consumer in the pipeline waited for an
+// element, i.e. while the pipeline limits the throughput of its consumer.
+//
+// This class is thread-safe.
+class Model : public std::enable_shared_from_this<Model> {
+ public:
+  static constexpr int64 kDefaultOptimizationPeriodMicros = 100 * 1000;
+
+  // `cpu_budget` is the number of CPU cores that the parallel iterators of
+  // the pipeline may occupy in total.
+  explicit Model(
+      int64 cpu_budget,
+      int64 optimization_period_micros = kDefaultOptimizationPeriodMicros);
+
+  // Returns a node for an iterator that produces up to `parallelism`
+  // elements in parallel. If `parallelism` is `kAutoTune`, the model tunes
+  // it between 1 and `max_parallelism`, the budget if that is not positive.
+  // The iterator owns the node.
+  std::shared_ptr<Node> AddNode(int64 parallelism, int64 max_parallelism = 0);
+
+  // Like `AddNode()`, for an iterator that is not part of the pipeline of
+  // any model, e.g. because it was created outside of an `IteratorResource`.
+  // Tunable nodes get a fixed parallelism of `max_parallelism`, the number
+  // of schedulable CPUs if that is not positive.
+  static std::shared_ptr<Node> NewStandaloneNode(int64 parallelism,
+                                                 int64 max_parallelism = 0);
+
+  int64 cpu_budget() const { return cpu_budget_; }
+
+  // Reallocates the budget if at least `optimization_period_micros` passed
+  // since the last time.
+  void MaybeOptimize();
+
+  // Reallocates the budget.
+  void Optimize();
+
+ private:
+  friend class Node;
+
+  void RemoveNode(Node* node);
+  void OptimizeLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 cpu_budget_;
+  const int64 optimization_period_micros_;
+  std::atomic<uint64> next_optimization_micros_;
+
+  mutex mu_;
+  std::vector<Node*> nodes_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Model);
+};
+
+}  // namespace model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
@@ -0,0 +1,113 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/model.h"
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace model {
+namespace {
+
+// A model that only optimizes when asked to.
+std::shared_ptr<Model> NewModel(int64 cpu_budget) {
+  return std::make_shared<Model>(cpu_budget,
+                                 /*optimization_period_micros=*/1LL << 40);
+}
+
+TEST(ModelTest, FixedNodes) {
+  std::shared_ptr<Model> model = NewModel(8);
+  std::shared_ptr<Node> node = model->AddNode(3);
+  EXPECT_FALSE(node->tunable());
+  EXPECT_EQ(3, node->parallelism());
+  node->RecordElement(100);
+  node->RecordWait(10);
+  model->Optimize();
+  EXPECT_EQ(3, node->parallelism());
+  EXPECT_EQ(1, node->num_elements());
+  EXPECT_EQ(100, node->processing_time());
+  EXPECT_EQ(10, node->wait_time());
+}
+
+TEST(ModelTest, DividesBudgetByProcessingTime) {
+  std::shared_ptr<Model> model = NewModel(10);
+  std::shared_ptr<Node> fixed = model->AddNode(2);
+  std::shared_ptr<Node> cheap = model->AddNode(kAutoTune);
+  std::shared_ptr<Node> expensive = model->AddNode(kAutoTune);
+  EXPECT_EQ(1, cheap->parallelism());
+  EXPECT_EQ(1, expensive->parallelism());
+
+  cheap->RecordElement(1000);
+  expensive->RecordElement(3000);
+  expensive->RecordWait(1);
+  model->Optimize();
+  // The fixed node occupies 2 of the 10 cores.
+  EXPECT_EQ(2, cheap->parallelism());
+  EXPECT_EQ(6, expensive->parallelism());
+  EXPECT_EQ(2, fixed->parallelism());
+}
+
+TEST(ModelTest, KeepsParallelismWithoutWaits) {
+  std::shared_ptr<Model> model = NewModel(8);
+  std::shared_ptr<Node> node = model->AddNode(kAutoTune);
+  node->RecordElement(1000);
+  model->Optimize();
+  EXPECT_EQ(1, node->parallelism());
+  // Only the time since the last optimization counts.
+  node->RecordWait(1);
+  model->Optimize();
+  EXPECT_EQ(1, node->parallelism());
+  node->RecordElement(1000);
+  node->RecordWait(1);
+  model->Optimize();
+  EXPECT_EQ(8, node->parallelism());
+}
+
+TEST(ModelTest, MaxParallelism) {
+  std::shared_ptr<Model> model = NewModel(16);
+  std::shared_ptr<Node> node = model->AddNode(kAutoTune, 4);
+  node->RecordElement(1000);
+  node->RecordWait(1);
+  model->Optimize();
+  EXPECT_EQ(4, node->parallelism());
+}
+
+TEST(ModelTest, RemovedNodesFreeTheirBudget) {
+  std::shared_ptr<Model> model = NewModel(8);
+  std::shared_ptr<Node> node = model->AddNode(kAutoTune);
+  {
+    std::shared_ptr<Node> fixed = model->AddNode(4);
+    node->RecordElement(1000);
+    node->RecordWait(1);
+    model->Optimize();
+    EXPECT_EQ(4, node->parallelism());
+  }
+  node->RecordElement(1000);
+  node->RecordWait(1);
+  model->Optimize();
+  EXPECT_EQ(8, node->parallelism());
+}
+
+TEST(ModelTest, StandaloneNodes) {
+  EXPECT_EQ(port::NumSchedulableCPUs(),
+            Model::NewStandaloneNode(kAutoTune)->parallelism());
+  EXPECT_EQ(4, Model::NewStandaloneNode(kAutoTune, 4)->parallelism());
+  EXPECT_EQ(2, Model::NewStandaloneNode(2)->parallelism());
+}
+
+}  // namespace
+}  // namespace model
+}  // namespace tensorflow
@@ -281,11 +281,15 @@ OpKernelContext::~OpKernelContext() {
   if (params_->record_tensor_accesses) referenced_tensors_.Destroy();
 }
 
-Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
+Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr,
+                                          bool step_local) {
   Allocator* allocator = nullptr;
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (params_->step_allocator != nullptr && step_local &&
+             attr.value == 0) {
+    allocator = params_->step_allocator;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -670,8 +674,9 @@ Status OpKernelContext::allocate_output(StringPiece name,
 
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
-    AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+    AllocatorAttributes attr, const AllocationAttributes& allocation_attr,
+    bool step_local) {
+  Allocator* a = get_allocator(attr, step_local);
   AllocationAttributes logged_attr(allocation_attr);
   logged_attr.allocation_will_be_logged = true;
   Tensor new_tensor(a, type, shape, logged_attr);
@@ -730,7 +735,8 @@ Status OpKernelContext::allocate_persistent(DataType type,
                                             Tensor** out_tensor,
                                             AllocatorAttributes attr) {
   Tensor persistent;
-  Status s = allocate_tensor(type, shape, &persistent, attr);
+  Status s = allocate_tensor(type, shape, &persistent, attr,
+                             AllocationAttributes(), /*step_local=*/false);
   if (s.ok()) {
     *out_persistent = PersistentTensor(persistent);
     if (out_tensor) {
@@ -738,7 +744,7 @@ Status OpKernelContext::allocate_persistent(DataType type,
     }
     if (track_allocations()) {
       Tensor* t = out_persistent->AccessTensor(this);
-      Allocator* a = get_allocator(attr);
+      Allocator* a = get_allocator(attr, /*step_local=*/false);
       if (a->TracksAllocationSizes()) {
         int64 alloc_size = a->AllocatedSize(t->tensor_data().data());
         int64 alloc_id = a->AllocationId(t->tensor_data().data());
@@ -516,6 +516,11 @@ class OpKernelContext {
       }
     }
 
+    // If non-null, tensors allocated with default allocator attributes that
+    // do not need to outlive the step (i.e. all but persistent tensors) are
+    // allocated from here instead of from the device. Not owned.
+    Allocator* step_allocator = nullptr;
+
     bool track_allocations = false;
     bool log_memory = false;
     bool record_tensor_accesses = false;
@@ -1104,7 +1109,9 @@ class OpKernelContext {
   bool input_is_ref(int index) const;
 
  private:
-  Allocator* get_allocator(AllocatorAttributes attr);
+  // If 'step_local' is false, the returned allocator is never
+  // params_->step_allocator.
+  Allocator* get_allocator(AllocatorAttributes attr, bool step_local = true);
 
   // Internal method to add a tensor's buffer to the list of buffers
   // referenced during the execution of the Op, so that GPUs may
@@ -1123,7 +1130,8 @@ class OpKernelContext {
 
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
-                         const AllocationAttributes& allocation_attr);
+                         const AllocationAttributes& allocation_attr,
+                         bool step_local = true);
 
   // This is called by PersistentTensor::AccessTensor whenever the
   // wrapped tensor is retrieved, to ensure the runtime knows that the
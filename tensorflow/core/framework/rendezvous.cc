@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -45,6 +46,7 @@ Rendezvous::ParsedKey& Rendezvous::ParsedKey::operator=(const ParsedKey& b) {
   dst = b.dst;
   edge_name = StringPiece(buf_.data() + (b.edge_name.data() - b_base),
                           b.edge_name.size());
+  hash_ = b.hash_;
   return *this;
 }
 
@@ -107,6 +109,7 @@ Status Rendezvous::ParseKey(StringPiece key, ParsedKey* out) {
     out->src_device = StringPiece(parts[0].data(), parts[0].size());
     out->dst_device = StringPiece(parts[2].data(), parts[2].size());
     out->edge_name = StringPiece(parts[3].data(), parts[3].size());
+    out->hash_ = Hash64(out->buf_.data(), out->buf_.size());
     return Status::OK();
   }
   return errors::InvalidArgument("Invalid  rendezvous key: ", key);
@@ -146,24 +149,43 @@ Status Rendezvous::Recv(const ParsedKey& key, const Args& args, Tensor* val,
   return Recv(key, args, val, is_dead, no_timeout);
 }
 
+namespace {
+
+auto* rendezvous_pending_items = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/rendezvous/pending_items",
+    "The number of tensors sent to local rendezvous that wait for their recv "
+    "(kind=send), and of recvs that wait for their tensor (kind=recv).",
+    "kind");
+
+monitoring::GaugeCell<int64>* PendingItems(bool is_send) {
+  static monitoring::GaugeCell<int64>* sends =
+      rendezvous_pending_items->GetCell("send");
+  static monitoring::GaugeCell<int64>* recvs =
+      rendezvous_pending_items->GetCell("recv");
+  return is_send ? sends : recvs;
+}
+
+}  // namespace
+
 class LocalRendezvousImpl : public Rendezvous {
  public:
   explicit LocalRendezvousImpl() {}
 
   Status Send(const ParsedKey& key, const Args& send_args, const Tensor& val,
               const bool is_dead) override {
-    uint64 key_hash = KeyHash(key.FullKey());
+    const uint64 key_hash = key.hash_;
     VLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = &shards_[key_hash % kNumShards];
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       return s;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || queue->front()->IsSendValue()) {
       // There is no waiter for this message. Append the message
       // into the queue. The waiter will pick it up when arrives.
@@ -176,14 +198,19 @@ class LocalRendezvousImpl : public Rendezvous {
         item->send_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
+      PendingItems(true)->IncrementBy(1);
       return Status::OK();
     }
 
     // There is an earliest waiter to consume this message.
     Item* item = queue->front();
     queue->pop_front();
-    mu_.unlock();
+    if (queue->empty()) {
+      shard->table.erase(key_hash);
+    }
+    shard->mu.unlock();
+    PendingItems(false)->IncrementBy(-1);
 
     // Notify the waiter by invoking its done closure, outside the
     // lock.
@@ -195,19 +222,20 @@ class LocalRendezvousImpl : public Rendezvous {
 
   void RecvAsync(const ParsedKey& key, const Args& recv_args,
                  DoneCallback done) override {
-    uint64 key_hash = KeyHash(key.FullKey());
+    const uint64 key_hash = key.hash_;
     VLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = &shards_[key_hash % kNumShards];
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       done(s, Args(), recv_args, Tensor(), false);
       return;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || !queue->front()->IsSendValue()) {
       // There is no message to pick up.
       // Only recv-related fields need to be filled.
@@ -218,7 +246,8 @@ class LocalRendezvousImpl : public Rendezvous {
         item->recv_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
+      PendingItems(false)->IncrementBy(1);
       return;
     }
 
@@ -226,7 +255,11 @@ class LocalRendezvousImpl : public Rendezvous {
     // this key.  Consumes the message and invokes the done closure.
     Item* item = queue->front();
     queue->pop_front();
-    mu_.unlock();
+    if (queue->empty()) {
+      shard->table.erase(key_hash);
+    }
+    shard->mu.unlock();
+    PendingItems(true)->IncrementBy(-1);
 
     // Invokes the done() by invoking its done closure, outside scope
     // of the table lock.
@@ -237,18 +270,23 @@ class LocalRendezvousImpl : public Rendezvous {
 
   void StartAbort(const Status& status) override {
     CHECK(!status.ok());
-    Table table;
-    {
-      mutex_lock l(mu_);
-      status_.Update(status);
-      table_.swap(table);
+    // Abort all shards before invoking any waiter, so that a waiter cannot
+    // observe a partially aborted rendezvous.
+    std::vector<Table> tables(kNumShards);
+    for (int i = 0; i < kNumShards; ++i) {
+      mutex_lock l(shards_[i].mu);
+      shards_[i].status.Update(status);
+      shards_[i].table.swap(tables[i]);
     }
-    for (auto& p : table) {
-      for (Item* item : p.second) {
-        if (!item->IsSendValue()) {
-          item->waiter(status, Args(), Args(), Tensor(), false);
+    for (Table& table : tables) {
+      for (auto& p : table) {
+        for (Item* item : p.second) {
+          PendingItems(item->IsSendValue())->IncrementBy(-1);
+          if (!item->IsSendValue()) {
+            item->waiter(status, Args(), Args(), Tensor(), false);
+          }
+          delete item;
         }
-        delete item;
       }
     }
   }
@@ -276,11 +314,6 @@ class LocalRendezvousImpl : public Rendezvous {
     bool IsSendValue() const { return this->waiter == nullptr; }
   };
 
-  // We key the hash table by KeyHash of the Rendezvous::CreateKey string
-  static uint64 KeyHash(const StringPiece& k) {
-    return Hash64(k.data(), k.size());
-  }
-
   // By invariant, the item queue under each key is of the form
   //   [item.IsSendValue()]* meaning each item is a sent message.
   // or
@@ -288,15 +321,28 @@ class LocalRendezvousImpl : public Rendezvous {
   //
   // TODO(zhifengc): consider a better queue impl than std::deque.
   typedef std::deque<Item*> ItemQueue;
+  // Keyed by the hash of the Rendezvous::CreateKey string.
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ GUARDED_BY(mu_);
-  Status status_ GUARDED_BY(mu_);
+  // The table is sharded by key hash, so that Send/Recv pairs of different
+  // keys rarely contend on the same lock.
+  static constexpr int kNumShards = 16;
+  struct Shard {
+    mutex mu;
+    Table table GUARDED_BY(mu);
+    // Non-OK once the rendezvous has been aborted. Every shard holds a copy,
+    // so that Send/Recv only need to lock their own shard.
+    Status status GUARDED_BY(mu);
+  };
+  Shard shards_[kNumShards];
 
   ~LocalRendezvousImpl() override {
-    if (!table_.empty()) {
+    bool empty = true;
+    for (Shard& shard : shards_) {
+      mutex_lock l(shard.mu);
+      empty = empty && shard.table.empty();
+    }
+    if (!empty) {
       StartAbort(errors::Cancelled("LocalRendezvousImpl deleted"));
     }
   }
@@ -75,9 +75,12 @@ class Rendezvous : public core::RefCounted {
 
    private:
     friend class Rendezvous;
+    friend class LocalRendezvousImpl;
     friend class SendOp;
     friend class RecvOp;
     string buf_;
+    // Hash64 of buf_, computed by ParseKey.
+    uint64 hash_ = 0;
   };
   static Status ParseKey(StringPiece key, ParsedKey* out);
 
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -358,5 +361,46 @@ void BM_PingPong(int iters) {
 }
 BENCHMARK(BM_PingPong);
 
+// Each of 'num_pairs' producers sends 'iters' tensors to its own consumer,
+// all of them concurrently through one rendezvous.
+void BM_SendRecvConcurrent(int iters, int num_pairs) {
+  testing::StopTiming();
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_pairs; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", 2 * num_pairs);
+  Rendezvous* rendez = NewLocalRendezvous();
+  BlockingCounter done(2 * num_pairs);
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_pairs);
+  testing::StartTiming();
+  for (int i = 0; i < num_pairs; ++i) {
+    const Rendezvous::ParsedKey& key = keys[i];
+    pool->Schedule([rendez, &key, &done, iters]() {
+      Tensor val = V("val");
+      Rendezvous::Args args;
+      for (int j = 0; j < iters; ++j) {
+        TF_CHECK_OK(rendez->Send(key, args, val, false));
+      }
+      done.DecrementCount();
+    });
+    pool->Schedule([rendez, &key, &done, iters]() {
+      Tensor val;
+      bool is_dead = false;
+      Rendezvous::Args args;
+      for (int j = 0; j < iters; ++j) {
+        TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  testing::StopTiming();
+  rendez->Unref();
+  delete pool;
+}
+BENCHMARK(BM_SendRecvConcurrent)->Arg(1)->Arg(4)->Arg(16)->Arg(32);
+
 }  // namespace
 }  // namespace tensorflow
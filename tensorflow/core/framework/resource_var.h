@@ -32,6 +32,10 @@ class Var : public ResourceBase {
   // TODO(ebrevdo): Use LockSet instead of exposing mu.
   mutex* mu() { return &mu_; }
   Tensor* tensor() { return &tensor_; }
+  // The buffer tensor() had before its last copy-on-write update, kept so
+  // that the next such update can copy into it instead of allocating anew
+  // once the reads holding it are done. See PrepareToUpdateVariable().
+  Tensor* spare_tensor() { return &spare_tensor_; }
 
   string DebugString() override {
     return strings::StrCat(DataTypeString(tensor_.dtype()), "/",
@@ -49,6 +53,7 @@ class Var : public ResourceBase {
  private:
   mutex mu_;
   Tensor tensor_;
+  Tensor spare_tensor_;
 
   ~Var() override {}
 };
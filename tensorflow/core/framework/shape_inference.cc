@@ -1287,20 +1287,27 @@ bool InferenceContext::RelaxInputHandleShapesAndMergeTypes(
 // -----------------------------------------------------------------------------
 // ShapeManager
 // -----------------------------------------------------------------------------
-InferenceContext::ShapeManager::ShapeManager() {}
+// Small enough not to waste much memory on the many contexts that a
+// ShapeRefiner keeps alive, one per node.
+static const size_t kShapeManagerArenaBlockSize = 512;
+
+InferenceContext::ShapeManager::ShapeManager()
+    : arena_(kShapeManagerArenaBlockSize) {}
 InferenceContext::ShapeManager::~ShapeManager() {
-  for (auto* s : all_shapes_) delete s;
-  for (auto* d : all_dims_) delete d;
+  // Dimensions are trivially destructible, and the arena frees the memory.
+  for (auto* s : all_shapes_) s->~Shape();
 }
 
 ShapeHandle InferenceContext::ShapeManager::MakeShape(
     const std::vector<DimensionHandle>& dims) {
-  all_shapes_.push_back(new Shape(dims));
+  all_shapes_.push_back(new (arena_.AllocAligned(sizeof(Shape), alignof(Shape)))
+                            Shape(dims));
   return all_shapes_.back();
 }
 
 ShapeHandle InferenceContext::ShapeManager::UnknownShape() {
-  all_shapes_.push_back(new Shape());
+  all_shapes_.push_back(new (arena_.AllocAligned(sizeof(Shape), alignof(Shape)))
+                            Shape());
   return all_shapes_.back();
 }
 
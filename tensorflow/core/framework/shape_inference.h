@@ -15,10 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_SHAPE_INFERENCE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_SHAPE_INFERENCE_H_
 
+#include <new>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/arena.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -663,14 +665,16 @@ class InferenceContext {
       if (d.dim.IsSet()) {
         return d.dim;
       } else {
-        all_dims_.push_back(new Dimension(d.val));
-        return all_dims_.back();
+        return new (arena_.AllocAligned(sizeof(Dimension),
+                                        alignof(Dimension))) Dimension(d.val);
       }
     }
 
    private:
-    std::vector<Shape*> all_shapes_;    // values are owned.
-    std::vector<Dimension*> all_dims_;  // values are owned.
+    // Shapes and dimensions are allocated from arena_ rather than one by one,
+    // as a context creates many of them and frees them all together.
+    core::Arena arena_;
+    std::vector<Shape*> all_shapes_;  // values are destroyed, not freed.
   };
 
   friend class ::tensorflow::grappler::GraphProperties;
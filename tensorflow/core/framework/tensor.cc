@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -114,6 +115,72 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Largest tensor data, in bytes, that InlineBuffer stores.
+constexpr size_t kMaxInlineBufferBytes = 64;
+
+// Typed ref-counted buffer for tiny tensors of simple types, such as scalars
+// and shapes: T[n] is stored in the buffer object itself, which saves the
+// separate allocator call and its bookkeeping of Buffer<T>. It stands for an
+// allocation by cpu_allocator(), and is only used when nothing accounts for
+// the allocations of cpu_allocator().
+template <typename T>
+class InlineBuffer : public TensorBuffer {
+ public:
+  explicit InlineBuffer(int64 n) : elem_(n) {
+    DCHECK_LE(size(), kMaxInlineBufferBytes);
+  }
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return sizeof(T) * elem_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name(cpu_allocator()->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The data must be as aligned as the one returned by allocators.
+  static void* operator new(size_t size) {
+    return port::AlignedMalloc(size, Allocator::kAllocatorAlignment);
+  }
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+
+ private:
+  alignas(Allocator::kAllocatorAlignment) char data_[kMaxInlineBufferBytes];
+  const int64 elem_;
+
+  ~InlineBuffer() override {}
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
+// Returns true if "bytes" of tensor data to be allocated by "a" can be stored
+// in an InlineBuffer instead: they are small enough, and nothing would notice
+// the missing allocator call.
+bool CanInlineBuffer(Allocator* a, size_t bytes) {
+  return bytes <= kMaxInlineBufferBytes && a == cpu_allocator() &&
+         !a->TracksAllocationSizes() && !CPUAllocatorStatsEnabled() &&
+         !LogMemory::IsEnabled();
+}
+
+// Returns a new T[n] buffer allocated by "a", or an equivalent InlineBuffer.
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64 n) {
+  if (is_simple_type<T>::value && CanInlineBuffer(a, sizeof(T) * n)) {
+    return new InlineBuffer<T>(n);
+  }
+  return new Buffer<T>(a, n);
+}
+
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64 n,
+                        const AllocationAttributes& allocation_attr) {
+  if (is_simple_type<T>::value && CanInlineBuffer(a, sizeof(T) * n)) {
+    return new InlineBuffer<T>(n);
+  }
+  return new Buffer<T>(a, n, allocation_attr);
+}
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -722,7 +789,7 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements()));
   }
   if (buf_ != nullptr && buf_->data() != nullptr && LogMemory::IsEnabled()) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -736,7 +803,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    CASES(type,
+          buf_ = NewBuffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (!allocation_attr.allocation_will_be_logged && buf_ != nullptr &&
       buf_->data() != nullptr && LogMemory::IsEnabled()) {
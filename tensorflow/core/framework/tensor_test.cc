@@ -829,6 +829,31 @@ TEST(Tensor_Scalar, Basics) {
   }
 }
 
+TEST(Tensor_Small, Basics) {
+  // Tiny tensors store their data inline, which must behave like any other
+  // buffer.
+  Tensor t(DT_INT64, TensorShape({8}));
+  EXPECT_TRUE(t.IsAligned());
+  EXPECT_EQ(8 * sizeof(int64), t.tensor_data().size());
+  for (int i = 0; i < 8; ++i) {
+    t.vec<int64>()(i) = i;
+  }
+  Tensor slice = t.Slice(2, 5);
+  EXPECT_TRUE(slice.SharesBufferWith(t));
+  test::ExpectTensorEqual<int64>(slice,
+                                 test::AsTensor<int64>({2, 3, 4}, {3}));
+  Tensor copy = t;
+  EXPECT_TRUE(copy.SharesBufferWith(t));
+  t = Tensor();
+  EXPECT_EQ(7, copy.vec<int64>()(7));
+  EXPECT_EQ(4, slice.vec<int64>()(2));
+
+  Tensor scalar(DT_DOUBLE, TensorShape({}));
+  EXPECT_TRUE(scalar.IsAligned());
+  scalar.scalar<double>()() = 1.5;
+  EXPECT_EQ(1.5, scalar.scalar<double>()());
+}
+
 TEST(Tensor_Float, Reshape_And_Slice_Assignment) {
   // A test to experiment with a way to assign to a subset of a tensor
   Tensor t(DT_FLOAT, TensorShape({10, 4, 3, 2}));
@@ -44,12 +44,14 @@ namespace tensorflow {
 // reference count, and deletes itself once the last call has been
 // received and the high watermark has been retrieved.
 struct AllocRecord {
-  AllocRecord(int64 a_btyes, int64 a_micros)
-      : alloc_bytes(a_btyes), alloc_micros(a_micros) {}
+  AllocRecord(int64 a_btyes, int64 a_micros, int64 a_id = 0)
+      : alloc_bytes(a_btyes), alloc_micros(a_micros), allocation_id(a_id) {}
   AllocRecord() : AllocRecord(0, 0) {}
 
   int64 alloc_bytes;
   int64 alloc_micros;
+  // Pairs an allocation with its deallocation, 0 if unknown.
+  int64 allocation_id;
 };
 
 class TrackingAllocator : public Allocator {
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -2346,6 +2347,38 @@ TEST_F(MklLayoutPassTest, NodeRewrite_Conv2D_Basic) {
             "DMT/_1->C:3");
 }
 
+// Conv2D with a constant filter is marked so that it keeps its reordered
+// filter across steps.
+TEST_F(MklLayoutPassTest, NodeRewrite_Conv2D_ConstFilter) {
+  InitGraph(
+      "node { name: 'A' op: 'Input'}"
+      "node { name: 'B' op: 'Const' "
+      " attr { key: 'dtype' value { type: DT_FLOAT } }"
+      " attr { key: 'value' value { "
+      "    tensor { dtype: DT_FLOAT tensor_shape { dim { size: 1 } "
+      "    dim { size: 1 } dim { size: 1 } dim { size: 1 } } "
+      "    float_val: 1 } } } }"
+      "node { name: 'C' op: 'Conv2D'"
+      " attr { key: 'T'                value { type: DT_FLOAT } }"
+      " attr { key: 'data_format'      value { s: 'NCHW' } }"
+      " attr { key: 'use_cudnn_on_gpu' value { b: false } }"
+      " attr { key: 'strides'          value { list: {i: 1, i:1, i:1, i:1} } }"
+      " attr { key: 'padding'          value { s: 'SAME' } }"
+      " attr { key: 'dilations'        value { list: {i: 1, i:1, i:1, i:1} } }"
+      " input: ['A', 'B']}"
+      "node { name: 'D' op: 'Zeta' attr { key: 'T' value { type: DT_FLOAT } }"
+      " input: ['A', 'C'] }");
+  DoMklLayoutOptimizationPass();
+  for (const Node* n : graph_.nodes()) {
+    if (n->name() == "C") {
+      EXPECT_EQ(n->type_string(), "_MklConv2D");
+      bool is_filter_const;
+      TF_ASSERT_OK(GetNodeAttr(n->def(), "is_filter_const", &is_filter_const));
+      EXPECT_TRUE(is_filter_const);
+    }
+  }
+}
+
 // 2 Conv2D Ops in sequence. Both should get transformed and 1st Conv2D will
 // have 2 outputs, both of which will be inputs to next Conv2D.
 TEST_F(MklLayoutPassTest, NodeRewrite_Conv2D_Positive1) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <queue>
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -59,6 +60,9 @@ namespace tensorflow {
 //  do the conversion for A1 and A2 only. We do not need to do any conversion
 //  for A3.
 //
+//  Conversely, an output of A that is input to several such nodes B1, B2, ...
+//  is converted only once: a single C feeds all of them.
+//
 // This pass relies on ops registering themselves about their Mkl compliance.
 // An Mkl-compliant op can accept inputs in the Mkl format, and produce outputs
 // in the Mkl format. Non-compliant ops accept inputs and outputs in the
@@ -106,15 +110,18 @@ class MklToTfConversionPass : public GraphOptimizationPass {
     return mkl_op_registry::IsMklElementWiseOp(op_name, T);
   }
 
-  // Insert layout conversion node on the edge pointed by 'e' from graph 'g'.
+  // Insert a layout conversion node on the edges pointed by 'edges' from
+  // graph 'g'. All the edges carry the same output of the same source node,
+  // which is converted once for all their destinations.
   //
-  // Edge will be deleted once a call to this function is successful.
-  // Any attempt to use the edge after this call
+  // Edges will be deleted once a call to this function is successful.
+  // Any attempt to use the edges after this call
   // will lead to undefined behaviors.
   //
   // @return Success:OK() if insertion is successful, otherwise returns
   //         appropriate error status code.
-  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*);
+  Status InsertConversionNodeOnEdges(std::unique_ptr<Graph>* g,
+                                     const std::vector<Edge*>& edges);
 
   // For element-wise ops, we need to sanitize the inputs. For this, we add a
   // new node at the input of the replacement element-wise node that checks
@@ -136,38 +143,52 @@ const OptimizationPassRegistry::Grouping kMklTfConvPassGroup =
     OptimizationPassRegistry::POST_PARTITIONING;
 REGISTER_OPTIMIZATION(kMklTfConvPassGroup, 2, MklToTfConversionPass);
 
-Status MklToTfConversionPass::InsertConversionNodeOnEdge(
-    std::unique_ptr<Graph>* g, Edge* e) {
-  CHECK_NOTNULL(e);
-
-  Node* src = e->src();
-  Node* dst = e->dst();
+Status MklToTfConversionPass::InsertConversionNodeOnEdges(
+    std::unique_ptr<Graph>* g, const std::vector<Edge*>& edges) {
+  CHECK(!edges.empty());
 
+  Node* src = edges[0]->src();
+  const int src_output = edges[0]->src_output();
   CHECK_NOTNULL(src);
-  CHECK_NOTNULL(dst);
 
   Node* conversion_node = nullptr;
   DataType src_datatype = DT_INVALID;
-  DataType dst_datatype = DT_INVALID;
   string data_format;
 
   TF_CHECK_OK(GetNodeAttr(src->def(), "T", &src_datatype));
-  bool dst_dtype_found =
-      GetNodeAttr(dst->def(), "T", &dst_datatype) == Status::OK();
-  // We compare source and destination datatypes only when both are found.
-  if (dst_dtype_found && (src_datatype != dst_datatype)) {
-    string err_msg = "T attribute of " + src->name() + " and " + dst->name() +
-                     " do not match. Will not insert" +
-                     " MklToTf node in such case.";
+
+  // Only convert for the destinations that agree with the source datatype.
+  std::vector<Edge*> converted_edges;
+  for (Edge* e : edges) {
+    CHECK_EQ(e->src(), src);
+    CHECK_EQ(e->src_output(), src_output);
+    Node* dst = e->dst();
+    CHECK_NOTNULL(dst);
+    DataType dst_datatype = DT_INVALID;
+    bool dst_dtype_found =
+        GetNodeAttr(dst->def(), "T", &dst_datatype) == Status::OK();
+    // We compare source and destination datatypes only when both are found.
+    if (dst_dtype_found && (src_datatype != dst_datatype)) {
+      VLOG(1) << "MklToTfConversionPass: T attribute of " << src->name()
+              << " and " << dst->name() << " do not match. Will not insert"
+              << " MklToTf node in such case.";
+      continue;
+    }
+    converted_edges.push_back(e);
+  }
+  if (converted_edges.empty()) {
+    string err_msg = "T attribute of " + src->name() +
+                     " does not match any of its non-Mkl consumers." +
+                     " Will not insert MklToTf node in such case.";
     return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
   }
 
   // Build the conversion node and specify src as input.
   TF_CHECK_OK(
       NodeBuilder((*g)->NewName("Mkl2Tf"), "_MklToTf")
-          .Input(src, e->src_output())
+          .Input(src, src_output)
           .Input(src, DataIndexToMetaDataIndex(
-                          e->src_output(),
+                          src_output,
                           src->num_outputs()))  // Get an Mkl tensor slot
                                                 // from the Tf tensor slot.
           .Device(src->def().device())  // We want to get conversion node
@@ -187,17 +208,20 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
   // Set the Mkl op label for this op.
   conversion_node->AddAttr("_kernel", mkl_op_registry::kMklOpLabel);
 
-  // Now that we have added edge from src->conversion_node, let's add edge from
-  // output of conversion_node to the dest node. Since conversion_node
+  // Now that we have added edge from src->conversion_node, let's add edges
+  // from output of conversion_node to the dest nodes. Since conversion_node
   // has only 1 output, the src_output of conversion_node is 0.
-  CHECK_NOTNULL((*g)->AddEdge(conversion_node, 0, dst, e->dst_input()));
+  for (Edge* e : converted_edges) {
+    Node* dst = e->dst();
+    CHECK_NOTNULL((*g)->AddEdge(conversion_node, 0, dst, e->dst_input()));
 
-  VLOG(1) << "MklToTfConversionPass: Inserting Conversion node on: "
-          << src->type_string() << " and " << dst->type_string()
-          << " successful.";
+    VLOG(1) << "MklToTfConversionPass: Inserting Conversion node on: "
+            << src->type_string() << " and " << dst->type_string()
+            << " successful.";
 
-  // Remove src->dst edge now.
-  (*g)->RemoveEdge(e);
+    // Remove src->dst edge now.
+    (*g)->RemoveEdge(e);
+  }
   return Status::OK();
 }
 
@@ -298,8 +322,11 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
   // followed by a non-Mkl op node, we will just iterate over edge
   // set of the graph.
   // edge set whose source and destination are candidates for
-  // inserting conversion node
-  std::vector<Edge*> candidate_edges;
+  // inserting conversion node, grouped by the source output they carry so
+  // that each output is converted once. The groups are kept in the order
+  // their first edge is found, to keep the pass deterministic.
+  std::vector<std::vector<Edge*>> candidate_edges;
+  std::map<std::pair<const Node*, int>, size_t> candidate_edges_index;
 
   for (const Edge* e : (*g)->edges()) {
     Node* src = e->src();
@@ -336,19 +363,24 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
     if (src_is_mkl_op && !dst_is_mkl_op) {
       VLOG(1) << "MklToTfConversionPass: Scheduled nodes " << src->name()
               << " and " << dst->name() << " for inserting conversion nodes";
-      candidate_edges.push_back(const_cast<Edge*>(e));
+      const auto key = std::make_pair(src, e->src_output());
+      auto it = candidate_edges_index.find(key);
+      if (it == candidate_edges_index.end()) {
+        it = candidate_edges_index.emplace(key, candidate_edges.size()).first;
+        candidate_edges.emplace_back();
+      }
+      candidate_edges[it->second].push_back(const_cast<Edge*>(e));
     }
   }
 
   // Process all candidate edges and insert conversion nodes on them.
-  for (Edge* e : candidate_edges) {
+  for (const std::vector<Edge*>& edges : candidate_edges) {
     // Even if we insert conversion node on a single edge, we
     // need to return true.
-    string src_name = e->src()->name();
-    string dst_name = e->dst()->name();
-    if (InsertConversionNodeOnEdge(g, e) == Status::OK()) {
+    string src_name = edges[0]->src()->name();
+    if (InsertConversionNodeOnEdges(g, edges) == Status::OK()) {
       VLOG(1) << "MklToTfConversionPass: Inserted conversion "
-              << "node on edge between " << src_name << " and " << dst_name;
+              << "node on " << edges.size() << " edges from " << src_name;
       result = true;
     }
   }
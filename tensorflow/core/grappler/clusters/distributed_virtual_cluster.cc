@@ -0,0 +1,273 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/clusters/distributed_virtual_cluster.h"
+
+#include <algorithm>
+#include <set>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_scheduler.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// The name of the task of a device, or "" if it names none.
+string TaskName(const string& device) {
+  DeviceNameUtils::ParsedName parsed_name;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed_name) ||
+      !parsed_name.has_job) {
+    return "";
+  }
+  return strings::StrCat("/job:", parsed_name.job, "/replica:",
+                         parsed_name.has_replica ? parsed_name.replica : 0,
+                         "/task:", parsed_name.has_task ? parsed_name.task : 0);
+}
+
+// The size of a tensor, counting the unknown dimensions as 1.
+int64 TensorBytes(const OpInfo::TensorProperties& tensor, bool* inaccurate) {
+  int64 bytes = DataTypeSize(BaseType(tensor.dtype()));
+  if (tensor.shape().unknown_rank()) *inaccurate = true;
+  for (const auto& dim : tensor.shape().dim()) {
+    if (dim.size() < 0) *inaccurate = true;
+    bytes *= std::max<int64>(1, dim.size());
+  }
+  return bytes;
+}
+
+string GetAttrString(const OpInfo& op_info, const string& name) {
+  auto it = op_info.attr().find(name);
+  return it == op_info.attr().end() ? "" : it->second.s();
+}
+
+// The tensor a _Send op transfers between two devices.
+struct Transfer {
+  string src_task;
+  string dst_task;
+  int64 bytes = 0;
+  bool inaccurate = false;
+};
+
+// Returns true, and fills "transfer", if the node is a _Send. Those the
+// VirtualScheduler inserts between devices carry their devices in the
+// src_device_ and dst_device_ attributes, those of partitioned graphs in
+// send_device and recv_device.
+bool GetTransfer(const OpInfo& op_info, Transfer* transfer) {
+  if (op_info.op() != "_Send" || op_info.inputs_size() < 1) return false;
+  string src_device = GetAttrString(op_info, "src_device_");
+  string dst_device = GetAttrString(op_info, "dst_device_");
+  if (src_device.empty()) src_device = GetAttrString(op_info, "send_device");
+  if (dst_device.empty()) dst_device = GetAttrString(op_info, "recv_device");
+  transfer->src_task = TaskName(src_device);
+  transfer->dst_task = TaskName(dst_device);
+  transfer->bytes = TensorBytes(op_info.inputs(0), &transfer->inaccurate);
+  return true;
+}
+
+// The number of devices of an all-reduce, or 0 if the node is not one.
+int AllReduceGroupSize(const OpInfo& op_info) {
+  string attr;
+  if (op_info.op() == "CollectiveReduce") {
+    attr = "group_size";
+  } else if (op_info.op() == "NcclAllReduce") {
+    attr = "num_devices";
+  } else {
+    return 0;
+  }
+  auto it = op_info.attr().find(attr);
+  if (it == op_info.attr().end() || op_info.inputs_size() < 1) return 0;
+  return it->second.i();
+}
+
+// The ring all-reduce of n devices takes 2 * (n - 1) steps, in each of which
+// every device sends and receives 1 / n of the tensor.
+double AllReduceBytesPerDevice(int64 bytes, int group_size) {
+  return 2.0 * (group_size - 1) / group_size * bytes;
+}
+
+Costs LinkCosts(double bytes, int num_messages, double gb_per_sec,
+                double latency_us, bool inaccurate) {
+  Costs costs = Costs::ZeroCosts();
+  // 1 GB/s moves a byte per nanosecond.
+  costs.memory_time =
+      Costs::NanoSeconds(num_messages * latency_us * 1e3 + bytes / gb_per_sec);
+  costs.execution_time = costs.memory_time;
+  costs.inaccurate = inaccurate;
+  return costs;
+}
+
+}  // namespace
+
+// Costs the transfers and all-reduces with the properties of the network, and
+// the other ops like the OpLevelCostEstimator.
+class NetworkCostEstimator : public OpLevelCostEstimator {
+ public:
+  NetworkCostEstimator(const NetworkProperties& network,
+                       bool collectives_use_network)
+      : network_(network), collectives_use_network_(collectives_use_network) {}
+
+  Costs PredictCosts(const OpContext& op_context) const override {
+    const OpInfo& op_info = op_context.op_info;
+    Transfer transfer;
+    if (GetTransfer(op_info, &transfer)) {
+      if (transfer.src_task != transfer.dst_task) {
+        return LinkCosts(transfer.bytes, 1, network_.link_gb_per_sec,
+                         network_.link_latency_us, transfer.inaccurate);
+      }
+      return LinkCosts(transfer.bytes, 1, network_.local_gb_per_sec,
+                       network_.local_latency_us, transfer.inaccurate);
+    }
+    const int group_size = AllReduceGroupSize(op_info);
+    if (group_size > 1) {
+      bool inaccurate = false;
+      const double bytes = AllReduceBytesPerDevice(
+          TensorBytes(op_info.inputs(0), &inaccurate), group_size);
+      const int num_messages = 2 * (group_size - 1);
+      if (op_info.op() == "CollectiveReduce" && collectives_use_network_) {
+        return LinkCosts(bytes, num_messages, network_.link_gb_per_sec,
+                         network_.link_latency_us, inaccurate);
+      }
+      return LinkCosts(bytes, num_messages, network_.local_gb_per_sec,
+                       network_.local_latency_us, inaccurate);
+    }
+    return OpLevelCostEstimator::PredictCosts(op_context);
+  }
+
+  // Adds the bytes the node sends and receives over the network to "links".
+  void AddNetworkUsage(const OpInfo& op_info, const string& device,
+                       std::map<string, LinkUsage>* links) const {
+    Transfer transfer;
+    if (GetTransfer(op_info, &transfer)) {
+      if (transfer.src_task != transfer.dst_task) {
+        (*links)[transfer.src_task].bytes_sent += transfer.bytes;
+        (*links)[transfer.dst_task].bytes_received += transfer.bytes;
+      }
+      return;
+    }
+    const int group_size = AllReduceGroupSize(op_info);
+    if (group_size > 1 && op_info.op() == "CollectiveReduce" &&
+        collectives_use_network_) {
+      bool inaccurate = false;
+      const int64 bytes = AllReduceBytesPerDevice(
+          TensorBytes(op_info.inputs(0), &inaccurate), group_size);
+      LinkUsage& link = (*links)[TaskName(device)];
+      link.bytes_sent += bytes;
+      link.bytes_received += bytes;
+    }
+  }
+
+ private:
+  const NetworkProperties network_;
+  // The members of a CollectiveReduce are assumed to be in different tasks,
+  // unless the cluster only has one.
+  const bool collectives_use_network_;
+};
+
+void AddSimulatedTasks(
+    const string& job, int num_tasks,
+    const std::unordered_map<string, DeviceProperties>& task_devices,
+    std::unordered_map<string, DeviceProperties>* devices) {
+  for (int task = 0; task < num_tasks; ++task) {
+    for (const auto& device : task_devices) {
+      (*devices)[strings::StrCat("/job:", job, "/replica:0/task:", task,
+                                 device.first)] = device.second;
+    }
+  }
+}
+
+DistributedVirtualCluster::DistributedVirtualCluster(
+    const std::unordered_map<string, DeviceProperties>& devices,
+    const NetworkProperties& network)
+    : Cluster(0), network_(network) {
+  devices_ = devices;
+  std::set<string> tasks;
+  for (const auto& device : devices_) {
+    tasks.insert(TaskName(device.first));
+  }
+  node_estimator_.reset(new NetworkCostEstimator(network_, tasks.size() > 1));
+}
+
+DistributedVirtualCluster::~DistributedVirtualCluster() {}
+
+Status DistributedVirtualCluster::Provision() { return Status::OK(); }
+
+Status DistributedVirtualCluster::Initialize(const GrapplerItem& item) {
+  return Status::OK();
+}
+
+Status DistributedVirtualCluster::Run(
+    const GraphDef& graph, const std::vector<std::pair<string, Tensor>>& feed,
+    const std::vector<string>& fetch, RunMetadata* metadata) {
+  GrapplerItem item;
+  item.graph = graph;
+  item.feed = feed;
+  item.fetch = fetch;
+  SimulatedStep step;
+  return Simulate(item, &step, metadata);
+}
+
+Status DistributedVirtualCluster::Simulate(const GrapplerItem& item,
+                                           SimulatedStep* step,
+                                           RunMetadata* metadata) {
+  // Static shape inference keeps the scheduler from running the graph on
+  // the cluster.
+  FirstReadyManager node_manager;
+  VirtualScheduler scheduler(&item, true, this, &node_manager);
+  TF_RETURN_IF_ERROR(scheduler.Init());
+
+  if (metadata) {
+    metadata->clear_step_stats();
+    metadata->clear_cost_graph();
+    metadata->clear_partition_graphs();
+  }
+
+  step->links.clear();
+  Costs node_costs;
+  do {
+    OpContext op_context = scheduler.GetCurrNode();
+    node_costs = node_estimator_->PredictCosts(op_context);
+    node_estimator_->AddNetworkUsage(op_context.op_info,
+                                     op_context.device_name, &step->links);
+  } while (scheduler.MarkCurrNodeExecuted(node_costs));
+
+  step->critical_path_time = scheduler.Summary(metadata).execution_time;
+  step->step_time = step->critical_path_time;
+  for (const auto& link : step->links) {
+    const int64 bytes =
+        std::max(link.second.bytes_sent, link.second.bytes_received);
+    step->step_time = std::max(
+        step->step_time,
+        Costs::Duration(Costs::NanoSeconds(bytes / network_.link_gb_per_sec)));
+  }
+  if (step->step_time.count() > 0) {
+    for (auto& link : step->links) {
+      const int64 bytes =
+          std::max(link.second.bytes_sent, link.second.bytes_received);
+      link.second.utilization =
+          bytes / network_.link_gb_per_sec / step->step_time.count();
+    }
+  }
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_CLUSTERS_DISTRIBUTED_VIRTUAL_CLUSTER_H_
+#define TENSORFLOW_CORE_GRAPPLER_CLUSTERS_DISTRIBUTED_VIRTUAL_CLUSTER_H_
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class NetworkCostEstimator;
+
+// The network of a simulated cluster: every task, e.g. a worker or a
+// parameter server, has one link to the others.
+struct NetworkProperties {
+  // The bandwidth of the link of every task, in each direction, in GB/s.
+  double link_gb_per_sec = 1.25;
+  // The latency of a transfer between tasks, in microseconds.
+  double link_latency_us = 50;
+  // The bandwidth and latency of the transfers between the devices of a
+  // task, e.g. over PCIe.
+  double local_gb_per_sec = 12;
+  double local_latency_us = 10;
+};
+
+// The network usage of a task in a simulated step.
+struct LinkUsage {
+  int64 bytes_sent = 0;
+  int64 bytes_received = 0;
+  // The fraction of the step the link of the task is busy in its busiest
+  // direction.
+  double utilization = 0;
+};
+
+// The prediction of a step on a DistributedVirtualCluster.
+struct SimulatedStep {
+  // The predicted time of the step: the longer of the critical path of the
+  // simulated schedule, and of the time the busiest link takes to carry its
+  // bytes.
+  Costs::Duration step_time;
+  Costs::Duration critical_path_time;
+  // The network usage of every task, keyed by the task name, e.g.
+  // "/job:ps/replica:0/task:0".
+  std::map<string, LinkUsage> links;
+};
+
+// Adds to "devices" `num_tasks` tasks of the job `job`, with the devices
+// `task_devices` keyed by their local names, e.g. "/device:GPU:0".
+void AddSimulatedTasks(
+    const string& job, int num_tasks,
+    const std::unordered_map<string, DeviceProperties>& task_devices,
+    std::unordered_map<string, DeviceProperties>* devices);
+
+// A virtual cluster of several tasks connected by a network, to predict how a
+// distributed training configuration performs before provisioning it. The
+// graph, placed on the devices of the cluster or already partitioned, is
+// scheduled like on a VirtualCluster, with the _Send ops between devices
+// costing the latency and bandwidth of the link they use, and the
+// CollectiveReduce and NcclAllReduce ops costing a ring all-reduce. The
+// scheduler does not make the transfers of a task contend for its link, so
+// the step is also bounded by the bytes its busiest link carries.
+//
+// Different strategies, e.g. parameter servers or all-reduce, or different
+// numbers of parameter servers, are compared by simulating the graph each of
+// them builds.
+class DistributedVirtualCluster : public Cluster {
+ public:
+  DistributedVirtualCluster(
+      const std::unordered_map<string, DeviceProperties>& devices,
+      const NetworkProperties& network);
+
+  ~DistributedVirtualCluster() override;
+
+  string type() const override { return "distributed_virtual"; }
+
+  Status Provision() override;
+  Status Initialize(const GrapplerItem& item) override;
+  Status Run(const GraphDef& graph,
+             const std::vector<std::pair<string, Tensor>>& feed,
+             const std::vector<string>& fetch, RunMetadata* metadata) override;
+
+  // Simulates a step of "item", and predicts its time and network usage.
+  Status Simulate(const GrapplerItem& item, SimulatedStep* step,
+                  RunMetadata* metadata = nullptr);
+
+ private:
+  const NetworkProperties network_;
+  std::unique_ptr<NetworkCostEstimator> node_estimator_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_CLUSTERS_DISTRIBUTED_VIRTUAL_CLUSTER_H_
@@ -0,0 +1,162 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/clusters/distributed_virtual_cluster.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kPs0[] = "/job:ps/replica:0/task:0";
+const char kWorker0[] = "/job:worker/replica:0/task:0";
+const char kWorker1[] = "/job:worker/replica:0/task:1";
+// The size of a shard of the variable.
+const int64 kShardBytes = 512 * 1024 * 4;
+
+// Invent a CPU so that predictions remain the same from machine to machine.
+DeviceProperties CpuDevice() {
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  cpu_device.set_l1_cache_size(32 * 1024);
+  cpu_device.set_l2_cache_size(256 * 1024);
+  cpu_device.set_l3_cache_size(4 * 1024 * 1024);
+  return cpu_device;
+}
+
+std::unordered_map<string, DeviceProperties> ClusterDevices(int num_ps,
+                                                            int num_workers) {
+  std::unordered_map<string, DeviceProperties> devices;
+  AddSimulatedTasks("ps", num_ps, {{"/device:CPU:0", CpuDevice()}}, &devices);
+  AddSimulatedTasks("worker", num_workers, {{"/device:CPU:0", CpuDevice()}},
+                    &devices);
+  return devices;
+}
+
+// Every worker reads the two shards of a variable, placed round-robin on the
+// parameter servers.
+GrapplerItem ParameterServerItem(int num_ps, int num_workers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  std::vector<Output> shards;
+  for (int i = 0; i < 2; ++i) {
+    tensorflow::Scope ps = s.WithDevice(
+        strings::StrCat("/job:ps/replica:0/task:", i % num_ps,
+                        "/device:CPU:0"));
+    shards.push_back(ops::Variable(ps.WithOpName(strings::StrCat("shard", i)),
+                                   {512, 1024}, DT_FLOAT));
+  }
+  GrapplerItem item;
+  for (int w = 0; w < num_workers; ++w) {
+    tensorflow::Scope worker = s.WithDevice(
+        strings::StrCat("/job:worker/replica:0/task:", w, "/device:CPU:0"));
+    const string name = strings::StrCat("sum", w);
+    ops::AddN(worker.WithOpName(name), shards);
+    item.fetch.push_back(name);
+  }
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  return item;
+}
+
+TEST(DistributedVirtualClusterTest, ClusterType) {
+  DistributedVirtualCluster cluster(ClusterDevices(1, 1), NetworkProperties());
+  EXPECT_EQ("distributed_virtual", cluster.type());
+}
+
+TEST(DistributedVirtualClusterTest, ParameterServerLinks) {
+  DistributedVirtualCluster cluster(ClusterDevices(1, 2), NetworkProperties());
+  TF_ASSERT_OK(cluster.Provision());
+  const GrapplerItem item = ParameterServerItem(1, 2);
+  SimulatedStep step;
+  RunMetadata metadata;
+  TF_ASSERT_OK(cluster.Simulate(item, &step, &metadata));
+
+  ASSERT_EQ(3, step.links.size());
+  EXPECT_EQ(4 * kShardBytes, step.links[kPs0].bytes_sent);
+  EXPECT_EQ(0, step.links[kPs0].bytes_received);
+  EXPECT_EQ(2 * kShardBytes, step.links[kWorker0].bytes_received);
+  EXPECT_EQ(2 * kShardBytes, step.links[kWorker1].bytes_received);
+  // The link of the parameter server bounds the step.
+  EXPECT_LE(step.critical_path_time, step.step_time);
+  EXPECT_NEAR(4 * kShardBytes / NetworkProperties().link_gb_per_sec,
+              step.step_time.count(), 1);
+  EXPECT_NEAR(1.0, step.links[kPs0].utilization, 1e-6);
+  EXPECT_NEAR(0.5, step.links[kWorker0].utilization, 1e-6);
+  EXPECT_LT(0, metadata.step_stats().dev_stats_size());
+}
+
+TEST(DistributedVirtualClusterTest, MoreParameterServersShortenTheStep) {
+  SimulatedStep one_ps;
+  DistributedVirtualCluster one_ps_cluster(ClusterDevices(1, 2),
+                                           NetworkProperties());
+  TF_ASSERT_OK(one_ps_cluster.Simulate(ParameterServerItem(1, 2), &one_ps));
+  SimulatedStep two_ps;
+  DistributedVirtualCluster two_ps_cluster(ClusterDevices(2, 2),
+                                           NetworkProperties());
+  TF_ASSERT_OK(two_ps_cluster.Simulate(ParameterServerItem(2, 2), &two_ps));
+
+  EXPECT_EQ(2 * kShardBytes, two_ps.links[kPs0].bytes_sent);
+  EXPECT_LT(two_ps.step_time, one_ps.step_time);
+}
+
+TEST(DistributedVirtualClusterTest, AllReduce) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (int w = 0; w < 2; ++w) {
+    tensorflow::Scope worker = s.WithDevice(
+        strings::StrCat("/job:worker/replica:0/task:", w, "/device:CPU:0"));
+    ops::Variable(worker.WithOpName(strings::StrCat("grad", w)), {1024, 1024},
+                  DT_FLOAT);
+  }
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  for (int w = 0; w < 2; ++w) {
+    const string name = strings::StrCat("reduce", w);
+    TF_CHECK_OK(NodeDefBuilder(name, "CollectiveReduce")
+                    .Input(strings::StrCat("grad", w), 0, DT_FLOAT)
+                    .Attr("group_size", 2)
+                    .Attr("group_key", 1)
+                    .Attr("instance_key", 1)
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Div")
+                    .Attr("subdiv_offsets", std::vector<int>({0}))
+                    .Device(strings::StrCat("/job:worker/replica:0/task:", w,
+                                            "/device:CPU:0"))
+                    .Finalize(item.graph.add_node()));
+    item.fetch.push_back(name);
+  }
+
+  DistributedVirtualCluster cluster(ClusterDevices(0, 2), NetworkProperties());
+  SimulatedStep step;
+  TF_ASSERT_OK(cluster.Simulate(item, &step));
+
+  // Each of the two workers sends and receives half of its tensor twice.
+  ASSERT_EQ(2, step.links.size());
+  EXPECT_EQ(2 * kShardBytes, step.links[kWorker0].bytes_sent);
+  EXPECT_EQ(2 * kShardBytes, step.links[kWorker1].bytes_received);
+  EXPECT_LT(0, step.step_time.count());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,257 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/calibrated_op_level_cost_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+const char kOpCostCorrectionsEnvVar[] = "TF_GRAPPLER_OP_COST_CORRECTIONS";
+
+namespace {
+
+string GetDeviceType(const DeviceProperties& device) {
+  return strings::StrCat(device.type(), ":", device.model());
+}
+
+// The floor of log2 of the total size of the inputs, counting the unknown
+// dimensions as 1.
+int GetInputSizeBucket(const OpInfo& op_info) {
+  uint64 size = 0;
+  for (const auto& input : op_info.inputs()) {
+    if (input.shape().unknown_rank()) continue;
+    uint64 num_elements = 1;
+    for (const auto& dim : input.shape().dim()) {
+      num_elements *= std::max<int64>(dim.size(), 1);
+    }
+    size += num_elements * DataTypeSize(BaseType(input.dtype()));
+  }
+  return size == 0 ? 0 : Log2Floor64(size);
+}
+
+Costs::Duration Scale(Costs::Duration duration, double scale) {
+  return Costs::Duration(duration.count() * scale);
+}
+
+}  // namespace
+
+string CalibratedOpLevelCostEstimator::Key(const string& device_type,
+                                           const string& op,
+                                           int input_size_bucket) {
+  return strings::StrCat(device_type, "|", op, "|", input_size_bucket);
+}
+
+Status CalibratedOpLevelCostEstimator::AddStepStats(
+    const GrapplerItem& item, const StepStats& step_stats) {
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : item.graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+
+  // The kernels of the GPU ops run asynchronously: their execution time is
+  // recorded on the "/stream:all" pseudo device, as one entry per kernel
+  // named "<node>:<op>". The other devices record one entry per execution.
+  std::unordered_map<string, std::vector<int64>> node_micros;
+  std::unordered_map<string, int64> stream_micros;
+  std::unordered_map<string, string> node_device;
+  for (const auto& dev_stats : step_stats.dev_stats()) {
+    string device = dev_stats.device();
+    bool is_stream = false;
+    const size_t pos = device.find("/stream:");
+    if (pos != string::npos) {
+      if (!str_util::EndsWith(device, "/stream:all")) continue;
+      device = device.substr(0, pos);
+      is_stream = true;
+    } else if (device.find("/memcpy") != string::npos) {
+      continue;
+    }
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      const string name =
+          node_stats.node_name().substr(0, node_stats.node_name().find(':'));
+      if (name_to_node.find(name) == name_to_node.end()) continue;
+      int64 micros =
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      if (micros <= 0) {
+        micros = node_stats.all_end_rel_micros();
+      }
+      if (micros <= 0) continue;
+      node_device[name] = device;
+      if (is_stream) {
+        stream_micros[name] += micros;
+      } else {
+        node_micros[name].push_back(micros);
+      }
+    }
+  }
+  for (const auto& stream : stream_micros) {
+    node_micros[stream.first] = {stream.second};
+  }
+
+  for (const auto& node : node_micros) {
+    const string& name = node.first;
+    const NodeDef& node_def = *name_to_node[name];
+    OpContext op_context;
+    op_context.name = name;
+    op_context.device_name = node_device[name];
+    op_context.op_info = BuildOpInfoWithoutDevice(
+        node_def, name_to_node, properties.GetInputProperties(name));
+    for (const auto& output : properties.GetOutputProperties(name)) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    *op_context.op_info.mutable_device() =
+        GetDeviceInfo(op_context.device_name);
+    if (item.graph.has_library()) {
+      op_context.function_library = &item.graph.library();
+    }
+    for (int64 micros : node.second) {
+      AddSample(op_context, Costs::MicroSeconds(micros));
+    }
+  }
+  return Status::OK();
+}
+
+void CalibratedOpLevelCostEstimator::AddSample(const OpContext& op_context,
+                                               Costs::Duration measured) {
+  const Costs::Duration predicted =
+      OpLevelCostEstimator::PredictCosts(op_context).execution_time;
+  if (predicted.count() <= 0 || measured.count() <= 0) {
+    return;
+  }
+  const double log_ratio =
+      std::log(static_cast<double>(measured.count()) / predicted.count());
+  const string device_type = GetDeviceType(op_context.op_info.device());
+  const string& op = op_context.op_info.op();
+  // Also fits a correction for the inputs of any size, for the sizes that
+  // were never measured.
+  for (int bucket : {GetInputSizeBucket(op_context.op_info), -1}) {
+    Samples& samples = samples_[Key(device_type, op, bucket)];
+    samples.correction.set_device_type(device_type);
+    samples.correction.set_op(op);
+    samples.correction.set_input_size_bucket(bucket);
+    samples.log_ratios.push_back(log_ratio);
+  }
+}
+
+void CalibratedOpLevelCostEstimator::Fit(int min_samples) {
+  for (const auto& samples : samples_) {
+    const std::vector<double>& log_ratios = samples.second.log_ratios;
+    if (static_cast<int>(log_ratios.size()) < std::max(min_samples, 1)) {
+      continue;
+    }
+    // The ratios are skewed, so they are averaged in log space. The Huber
+    // mean ignores the outliers, e.g. the first run of a kernel.
+    OpCostCorrection correction = samples.second.correction;
+    correction.set_time_scale(std::exp(RobustStats(log_ratios).mean()));
+    correction.set_num_samples(log_ratios.size());
+    corrections_[samples.first] = correction;
+  }
+}
+
+OpCostCorrectionList CalibratedOpLevelCostEstimator::GetCorrections() const {
+  OpCostCorrectionList list;
+  for (const auto& correction : corrections_) {
+    *list.add_correction() = correction.second;
+  }
+  return list;
+}
+
+void CalibratedOpLevelCostEstimator::SetCorrections(
+    const OpCostCorrectionList& corrections) {
+  corrections_.clear();
+  for (const auto& correction : corrections.correction()) {
+    if (correction.time_scale() <= 0) continue;
+    corrections_[Key(correction.device_type(), correction.op(),
+                     correction.input_size_bucket())] = correction;
+  }
+}
+
+Status CalibratedOpLevelCostEstimator::Save(const string& path) const {
+  return WriteBinaryProto(Env::Default(), path, GetCorrections());
+}
+
+Status CalibratedOpLevelCostEstimator::Load(const string& path) {
+  OpCostCorrectionList corrections;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), path, &corrections));
+  SetCorrections(corrections);
+  return Status::OK();
+}
+
+Costs CalibratedOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  if (corrections_.empty()) {
+    return costs;
+  }
+  const string device_type = GetDeviceType(op_context.op_info.device());
+  const string& op = op_context.op_info.op();
+  auto it = corrections_.find(
+      Key(device_type, op, GetInputSizeBucket(op_context.op_info)));
+  if (it == corrections_.end()) {
+    it = corrections_.find(Key(device_type, op, -1));
+  }
+  if (it == corrections_.end()) {
+    return costs;
+  }
+  const double scale = it->second.time_scale();
+  costs.execution_time = Scale(costs.execution_time, scale);
+  costs.compute_time = Scale(costs.compute_time, scale);
+  costs.memory_time = Scale(costs.memory_time, scale);
+  costs.inaccurate = false;
+  return costs;
+}
+
+OpLevelCostEstimator* NewOpLevelCostEstimator() {
+  string path;
+  Status status =
+      ReadStringFromEnvVar(kOpCostCorrectionsEnvVar, /*default_val=*/"", &path);
+  if (status.ok() && !path.empty()) {
+    std::unique_ptr<CalibratedOpLevelCostEstimator> estimator(
+        new CalibratedOpLevelCostEstimator());
+    status = estimator->Load(path);
+    if (status.ok()) {
+      return estimator.release();
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring the op cost corrections: " << status;
+  }
+  return new OpLevelCostEstimator();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+class StepStats;
+}  // namespace tensorflow
+
+namespace tensorflow {
+namespace grappler {
+
+struct GrapplerItem;
+
+// The environment variable naming a file of OpCostCorrectionList that the
+// default cost estimators apply, see NewOpLevelCostEstimator().
+extern const char kOpCostCorrectionsEnvVar[];
+
+// Corrects the analytical estimates of OpLevelCostEstimator with the execution
+// times measured in real runs. The ratio of the measured to the analytical
+// time is fitted per device type, op type and order of magnitude of the input
+// size, and the predicted times are scaled by it. The ops for which there is
+// no correction keep their analytical estimate.
+class CalibratedOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  CalibratedOpLevelCostEstimator() {}
+  ~CalibratedOpLevelCostEstimator() override {}
+
+  // Records the execution times in "step_stats", collected from a run of the
+  // graph of "item". Call Fit() to update the corrections.
+  Status AddStepStats(const GrapplerItem& item, const StepStats& step_stats);
+
+  // Records that the op described by "op_context" ran in "measured".
+  void AddSample(const OpContext& op_context, Costs::Duration measured);
+
+  // Fits the corrections to the samples recorded so far. Corrections need at
+  // least "min_samples" samples.
+  void Fit(int min_samples = 3);
+
+  OpCostCorrectionList GetCorrections() const;
+  void SetCorrections(const OpCostCorrectionList& corrections);
+
+  // Saves or loads the corrections as a binary OpCostCorrectionList.
+  Status Save(const string& path) const;
+  Status Load(const string& path);
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  static string Key(const string& device_type, const string& op,
+                    int input_size_bucket);
+
+  struct Samples {
+    OpCostCorrection correction;
+    // The logs of the ratios of measured to analytical times.
+    std::vector<double> log_ratios;
+  };
+
+  std::map<string, Samples> samples_;
+  std::map<string, OpCostCorrection> corrections_;
+};
+
+// Returns the OpLevelCostEstimator to use by default: a
+// CalibratedOpLevelCostEstimator with the corrections of the file named by
+// the kOpCostCorrectionsEnvVar environment variable if it is set, a plain
+// OpLevelCostEstimator otherwise.
+OpLevelCostEstimator* NewOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_OP_LEVEL_COST_ESTIMATOR_H_
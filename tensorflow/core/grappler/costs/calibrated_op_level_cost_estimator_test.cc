@@ -0,0 +1,139 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/calibrated_op_level_cost_estimator.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpContext DescribeMatMul(int m, int n, int k) {
+  OpContext op_context;
+  auto* device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(10);
+  device->set_bandwidth(10000000);
+  device->set_frequency(1000);
+  op_context.op_info.set_op("MatMul");
+  for (const auto& dims : {std::make_pair(m, k), std::make_pair(k, n)}) {
+    auto* input = op_context.op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(dims.first);
+    input->mutable_shape()->add_dim()->set_size(dims.second);
+  }
+  return op_context;
+}
+
+TEST(CalibratedOpLevelCostEstimatorTest, ScalePredictions) {
+  CalibratedOpLevelCostEstimator estimator;
+  const OpContext op_context = DescribeMatMul(100, 100, 100);
+  const Costs analytical = OpLevelCostEstimator().PredictCosts(op_context);
+  ASSERT_GT(analytical.execution_time.count(), 0);
+
+  // Not corrected before Fit().
+  for (int i = 0; i < 5; ++i) {
+    estimator.AddSample(op_context,
+                        Costs::Duration(analytical.execution_time.count() * 3));
+  }
+  // An outlier, e.g. the first run.
+  estimator.AddSample(op_context,
+                      Costs::Duration(analytical.execution_time.count() * 100));
+  EXPECT_EQ(analytical.execution_time,
+            estimator.PredictCosts(op_context).execution_time);
+
+  estimator.Fit();
+  const Costs corrected = estimator.PredictCosts(op_context);
+  EXPECT_NEAR(3.0,
+              static_cast<double>(corrected.execution_time.count()) /
+                  analytical.execution_time.count(),
+              0.1);
+  EXPECT_FALSE(corrected.inaccurate);
+
+  // The inputs of another size use the correction for all sizes.
+  const OpContext larger = DescribeMatMul(1000, 1000, 1000);
+  const Costs larger_analytical = OpLevelCostEstimator().PredictCosts(larger);
+  EXPECT_LT(larger_analytical.execution_time,
+            estimator.PredictCosts(larger).execution_time);
+
+  // The other ops are not corrected.
+  OpContext other = op_context;
+  other.op_info.set_op("BatchMatMul");
+  EXPECT_EQ(OpLevelCostEstimator().PredictCosts(other).execution_time,
+            estimator.PredictCosts(other).execution_time);
+}
+
+TEST(CalibratedOpLevelCostEstimatorTest, SaveAndLoad) {
+  CalibratedOpLevelCostEstimator estimator;
+  const OpContext op_context = DescribeMatMul(100, 100, 100);
+  const Costs analytical = OpLevelCostEstimator().PredictCosts(op_context);
+  for (int i = 0; i < 3; ++i) {
+    estimator.AddSample(op_context,
+                        Costs::Duration(analytical.execution_time.count() / 2));
+  }
+  estimator.Fit();
+  EXPECT_EQ(2, estimator.GetCorrections().correction_size());
+
+  const string path = io::JoinPath(testing::TmpDir(), "op_cost_corrections");
+  TF_EXPECT_OK(estimator.Save(path));
+  CalibratedOpLevelCostEstimator loaded;
+  TF_EXPECT_OK(loaded.Load(path));
+  EXPECT_EQ(estimator.PredictCosts(op_context).execution_time,
+            loaded.PredictCosts(op_context).execution_time);
+}
+
+TEST(CalibratedOpLevelCostEstimatorTest, AddStepStats) {
+  const char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {64, 64});
+  Output b = ops::MatMul(s.WithOpName("b"), a, a);
+  GrapplerItem item;
+  item.fetch = {"b"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  StepStats step_stats;
+  auto* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device(kDevice);
+  for (int i = 0; i < 3; ++i) {
+    auto* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name("b");
+    node_stats->set_op_start_rel_micros(1);
+    node_stats->set_op_end_rel_micros(101);
+  }
+  // Unknown nodes are ignored.
+  dev_stats->add_node_stats()->set_node_name("unknown");
+
+  CalibratedOpLevelCostEstimator estimator;
+  TF_EXPECT_OK(estimator.AddStepStats(item, step_stats));
+  estimator.Fit();
+  const OpCostCorrectionList corrections = estimator.GetCorrections();
+  ASSERT_EQ(2, corrections.correction_size());
+  for (const auto& correction : corrections.correction()) {
+    EXPECT_EQ("MatMul", correction.op());
+    EXPECT_EQ(3, correction.num_samples());
+    EXPECT_GT(correction.time_scale(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,379 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/step_critical_path.h"
+
+#include <algorithm>
+#include <map>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// The rendezvous key of a _Send or _Recv, which matches each _Recv to its
+// _Send.
+string RendezvousKey(const NodeDef& node) {
+  string key;
+  for (const char* attr : {"send_device", "send_device_incarnation",
+                           "recv_device", "tensor_name"}) {
+    auto it = node.attr().find(attr);
+    if (it != node.attr().end()) {
+      strings::StrAppend(&key, it->second.s(), it->second.i(), ";");
+    }
+  }
+  return key;
+}
+
+struct MeasuredTimes {
+  int64 start_micros = kint64max;
+  int64 end_micros = kint64min;
+};
+
+Costs::Duration FromMicros(int64 micros) {
+  return Costs::Duration(std::chrono::microseconds(micros));
+}
+
+int64 Micros(Costs::Duration duration) {
+  return duration.asMicroSeconds().count();
+}
+
+}  // namespace
+
+Status StepCriticalPath::Init(const std::vector<GraphDef>& partition_graphs,
+                              const StepStats& step_stats) {
+  if (partition_graphs.empty()) {
+    return errors::InvalidArgument(
+        "The critical path needs the partition graphs of the step.");
+  }
+  graphs_ = partition_graphs;
+  for (const GraphDef& graph : graphs_) {
+    for (const NodeDef& node : graph.node()) {
+      if (!name_to_node_.emplace(node.name(), &node).second) {
+        return errors::InvalidArgument("Node ", node.name(),
+                                       " is in several partition graphs.");
+      }
+    }
+  }
+
+  // The edges of the partition graphs, and the transfer edges.
+  std::unordered_map<string, const NodeDef*> sends;
+  for (const auto& named_node : name_to_node_) {
+    if (IsSend(*named_node.second)) {
+      sends[RendezvousKey(*named_node.second)] = named_node.second;
+    }
+  }
+  for (const GraphDef& graph : graphs_) {
+    for (const NodeDef& node : graph.node()) {
+      NodeState& state = node_states_[&node];
+      state.device_name = node.device();
+      for (const string& input : node.input()) {
+        int port;
+        auto it = name_to_node_.find(ParseNodeName(input, &port));
+        if (it == name_to_node_.end() || IsNextIteration(*it->second)) {
+          continue;
+        }
+        state.inputs.emplace_back(it->second, port);
+        node_states_[it->second].outputs[port].push_back(&node);
+      }
+      if (IsRecv(node)) {
+        auto send = sends.find(RendezvousKey(node));
+        if (send != sends.end()) {
+          state.inputs.emplace_back(send->second, -1);
+          node_states_[send->second].outputs[-1].push_back(&node);
+        }
+      }
+    }
+  }
+
+  // Sorts the nodes topologically.
+  std::unordered_map<const NodeDef*, int> num_pending_inputs;
+  for (const GraphDef& graph : graphs_) {
+    for (const NodeDef& node : graph.node()) {
+      num_pending_inputs[&node] = node_states_[&node].inputs.size();
+      if (node_states_[&node].inputs.empty()) {
+        topo_order_.push_back(&node);
+      }
+    }
+  }
+  for (size_t i = 0; i < topo_order_.size(); ++i) {
+    for (const auto& output : node_states_[topo_order_[i]].outputs) {
+      for (const NodeDef* consumer : output.second) {
+        if (--num_pending_inputs[consumer] == 0) {
+          topo_order_.push_back(consumer);
+        }
+      }
+    }
+  }
+  if (topo_order_.size() != node_states_.size()) {
+    return errors::InvalidArgument(
+        "The partition graphs have a cycle that is not a loop.");
+  }
+
+  // The kernels of the GPU ops run asynchronously and end on the
+  // "/stream:all" pseudo device. Nodes that run several times are merged.
+  std::unordered_map<const NodeDef*, MeasuredTimes> measured;
+  int64 step_start_micros = kint64max;
+  int64 step_end_micros = kint64min;
+  for (const auto& dev_stats : step_stats.dev_stats()) {
+    const string& device = dev_stats.device();
+    if (device.find("/memcpy") != string::npos ||
+        (device.find("/stream:") != string::npos &&
+         !str_util::EndsWith(device, "/stream:all"))) {
+      continue;
+    }
+    const bool is_stream = device.find("/stream:") != string::npos;
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      auto it = name_to_node_.find(
+          node_stats.node_name().substr(0, node_stats.node_name().find(':')));
+      if (it == name_to_node_.end()) continue;
+      MeasuredTimes& times = measured[it->second];
+      const int64 start = node_stats.all_start_micros();
+      const int64 end =
+          start + std::max(node_stats.all_end_rel_micros(),
+                           node_stats.op_end_rel_micros());
+      if (!is_stream || times.start_micros == kint64max) {
+        times.start_micros = std::min(times.start_micros, start);
+      }
+      times.end_micros = std::max(times.end_micros, end);
+      step_start_micros = std::min(step_start_micros, start);
+      step_end_micros = std::max(step_end_micros, end);
+    }
+  }
+  if (measured.empty()) {
+    return errors::InvalidArgument(
+        "The step stats have no node of the partition graphs.");
+  }
+  measured_step_time_ = FromMicros(step_end_micros - step_start_micros);
+
+  step_time_ = Costs::Duration::zero();
+  for (const NodeDef* node : topo_order_) {
+    NodeState& state = node_states_[node];
+    state.time_ready = Costs::Duration::zero();
+    for (const auto& input : state.inputs) {
+      state.time_ready =
+          std::max(state.time_ready, node_states_[input.first].time_finished);
+    }
+    auto it = measured.find(node);
+    if (it == measured.end()) {
+      state.time_scheduled = state.time_ready;
+      state.time_finished = state.time_ready;
+      continue;
+    }
+    state.time_scheduled =
+        std::max(state.time_ready,
+                 FromMicros(it->second.start_micros - step_start_micros));
+    state.time_finished =
+        std::max(state.time_scheduled,
+                 FromMicros(it->second.end_micros - step_start_micros));
+    step_time_ = std::max(step_time_, state.time_finished);
+  }
+
+  // The latest time each node may finish without delaying its consumers.
+  std::unordered_map<const NodeDef*, Costs::Duration> latest_finish;
+  for (auto it = topo_order_.rbegin(); it != topo_order_.rend(); ++it) {
+    Costs::Duration latest = step_time_;
+    for (const auto& output : node_states_[*it].outputs) {
+      for (const NodeDef* consumer : output.second) {
+        latest = std::min<Costs::Duration>(
+            latest, latest_finish[consumer] - RunTime(consumer) -
+                        WaitTime(consumer));
+      }
+    }
+    latest_finish[*it] = latest;
+    slack_[*it] = latest - node_states_[*it].time_finished;
+  }
+
+  // Walks back from the last node to finish through the inputs that were
+  // ready last.
+  const NodeDef* node = nullptr;
+  for (const NodeDef* candidate : topo_order_) {
+    if (!node || node_states_[candidate].time_finished >
+                     node_states_[node].time_finished) {
+      node = candidate;
+    }
+  }
+  while (node) {
+    critical_path_.push_back(node);
+    const NodeDef* last_input = nullptr;
+    for (const auto& input : node_states_[node].inputs) {
+      if (!last_input || node_states_[input.first].time_finished >
+                             node_states_[last_input].time_finished) {
+        last_input = input.first;
+      }
+    }
+    node = last_input;
+  }
+  std::reverse(critical_path_.begin(), critical_path_.end());
+  return Status::OK();
+}
+
+const NodeDef* StepCriticalPath::GetNode(const string& name) const {
+  auto it = name_to_node_.find(name);
+  return it == name_to_node_.end() ? nullptr : it->second;
+}
+
+Costs::Duration StepCriticalPath::WaitTime(const NodeDef* node) const {
+  const NodeState& state = node_states_.at(node);
+  return state.time_scheduled - state.time_ready;
+}
+
+Costs::Duration StepCriticalPath::RunTime(const NodeDef* node) const {
+  const NodeState& state = node_states_.at(node);
+  return state.time_finished - state.time_scheduled;
+}
+
+Costs::Duration StepCriticalPath::EstimateStepTime(
+    const std::unordered_map<const NodeDef*, double>& scales) const {
+  std::unordered_map<const NodeDef*, Costs::Duration> finish;
+  Costs::Duration step_time = Costs::Duration::zero();
+  for (const NodeDef* node : topo_order_) {
+    Costs::Duration ready = Costs::Duration::zero();
+    for (const auto& input : node_states_.at(node).inputs) {
+      ready = std::max(ready, finish[input.first]);
+    }
+    Costs::Duration run_time = RunTime(node);
+    auto scale = scales.find(node);
+    if (scale != scales.end()) {
+      run_time = Costs::Duration(run_time.count() * scale->second);
+    }
+    finish[node] = ready + WaitTime(node) + run_time;
+    step_time = std::max(step_time, finish[node]);
+  }
+  return step_time;
+}
+
+string StepCriticalPath::Report(int top_k) const {
+  string report = strings::Printf(
+      "Step time: %lld us (measured %lld us)\n",
+      static_cast<long long>(Micros(step_time_)),
+      static_cast<long long>(Micros(measured_step_time_)));
+
+  Costs::Duration run_time = Costs::Duration::zero();
+  Costs::Duration wait_time = Costs::Duration::zero();
+  string path;
+  for (const NodeDef* node : critical_path_) {
+    const NodeState& state = node_states_.at(node);
+    run_time += RunTime(node);
+    wait_time += WaitTime(node);
+    strings::Appendf(&path, "  %10lld %9lld %9lld  %s (%s) on %s\n",
+                     static_cast<long long>(Micros(state.time_scheduled)),
+                     static_cast<long long>(Micros(WaitTime(node))),
+                     static_cast<long long>(Micros(RunTime(node))),
+                     node->name().c_str(), node->op().c_str(),
+                     node->device().c_str());
+  }
+  strings::Appendf(&report,
+                   "Critical path: %zu ops, running %lld us and waiting "
+                   "%lld us\n  %10s %9s %9s  %s\n",
+                   critical_path_.size(),
+                   static_cast<long long>(Micros(run_time)),
+                   static_cast<long long>(Micros(wait_time)), "start(us)",
+                   "wait(us)", "run(us)", "node (op) on device");
+  strings::StrAppend(&report, path);
+
+  // What-if estimates for the ops on the critical path, and for all the ops
+  // of the types found on it.
+  struct WhatIf {
+    string name;
+    Costs::Duration run_time;
+    Costs::Duration twice_as_fast;
+    Costs::Duration free;
+  };
+  std::vector<WhatIf> node_what_ifs;
+  std::map<string, std::unordered_map<const NodeDef*, double>> op_types;
+  for (const NodeDef* node : critical_path_) {
+    if (RunTime(node) <= Costs::Duration::zero()) continue;
+    op_types[node->op()];
+    node_what_ifs.push_back(
+        {strings::StrCat(node->name(), " (", node->op(), ")"), RunTime(node),
+         EstimateStepTime({{node, 0.5}}), EstimateStepTime({{node, 0.0}})});
+  }
+  std::unordered_map<string, Costs::Duration> op_type_run_time;
+  for (const NodeDef* node : topo_order_) {
+    auto it = op_types.find(node->op());
+    if (it != op_types.end()) {
+      it->second[node] = 0.0;
+      op_type_run_time[node->op()] += RunTime(node);
+    }
+  }
+  std::vector<WhatIf> op_type_what_ifs;
+  for (auto& op_type : op_types) {
+    const Costs::Duration free = EstimateStepTime(op_type.second);
+    for (auto& scale : op_type.second) {
+      scale.second = 0.5;
+    }
+    op_type_what_ifs.push_back({op_type.first, op_type_run_time[op_type.first],
+                                EstimateStepTime(op_type.second), free});
+  }
+  auto append_what_ifs = [this, top_k, &report](const string& title,
+                                                std::vector<WhatIf>* what_ifs) {
+    std::stable_sort(what_ifs->begin(), what_ifs->end(),
+                     [](const WhatIf& a, const WhatIf& b) {
+                       return a.free < b.free;
+                     });
+    strings::Appendf(&report, "%s\n  %9s %11s %11s  %s\n", title.c_str(),
+                     "run(us)", "2x_saves", "free_saves", "name");
+    for (int i = 0; i < what_ifs->size() && i < top_k; ++i) {
+      const WhatIf& what_if = (*what_ifs)[i];
+      strings::Appendf(
+          &report, "  %9lld %11lld %11lld  %s\n",
+          static_cast<long long>(Micros(what_if.run_time)),
+          static_cast<long long>(Micros(step_time_ - what_if.twice_as_fast)),
+          static_cast<long long>(Micros(step_time_ - what_if.free)),
+          what_if.name.c_str());
+    }
+  };
+  append_what_ifs("Step time saved (us) by speeding up ops:", &node_what_ifs);
+  append_what_ifs("Step time saved (us) by speeding up all ops of a type:",
+                  &op_type_what_ifs);
+
+  // The longest ops whose speedup would not shorten the step.
+  std::vector<const NodeDef*> off_path;
+  for (const NodeDef* node : topo_order_) {
+    if (slack_.at(node) > Costs::Duration::zero() &&
+        RunTime(node) > Costs::Duration::zero()) {
+      off_path.push_back(node);
+    }
+  }
+  std::stable_sort(off_path.begin(), off_path.end(),
+                   [this](const NodeDef* a, const NodeDef* b) {
+                     return RunTime(a) > RunTime(b);
+                   });
+  strings::Appendf(&report,
+                   "Longest ops off the critical path:\n  %9s %9s  %s\n",
+                   "run(us)", "slack(us)", "node (op)");
+  for (int i = 0; i < off_path.size() && i < top_k; ++i) {
+    const NodeDef* node = off_path[i];
+    strings::Appendf(&report, "  %9lld %9lld  %s (%s)\n",
+                     static_cast<long long>(Micros(RunTime(node))),
+                     static_cast<long long>(Micros(slack_.at(node))),
+                     node->name().c_str(), node->op().c_str());
+  }
+  return report;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_STEP_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_STEP_CRITICAL_PATH_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_scheduler.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+class StepStats;
+}  // namespace tensorflow
+
+namespace tensorflow {
+namespace grappler {
+
+// Reconstructs the dependency graph of an executed step from its partition
+// graphs and the StepStats traced for it, and finds its critical path.
+//
+// The nodes are the executed nodes of the partition graphs. Their edges are
+// the data and control edges of the partition graphs, and a transfer edge
+// from every _Send to the _Recv of the same rendezvous key, so that the
+// critical path goes across devices and tasks.
+//
+// Each node is modeled with the times measured for it: it becomes ready when
+// its last input finishes, starts after a delay (the time it waited for a
+// thread or for its asynchronous launch), and then runs for its duration.
+// For asynchronous ops such as _Recv, the duration starts when the inputs are
+// ready, e.g. when the tensor was sent. Replaying the graph with these delays
+// and durations gives back the measured step time, and replaying it with
+// some durations scaled estimates the step time if those ops were faster.
+//
+// Nodes executed several times in the step, e.g. in loops, are modeled as a
+// single execution spanning all of them, and the NextIteration back edges
+// are ignored.
+class StepCriticalPath {
+ public:
+  StepCriticalPath() {}
+
+  // Builds the graph of the step. Nodes without step stats are assumed to
+  // take no time.
+  Status Init(const std::vector<GraphDef>& partition_graphs,
+              const StepStats& step_stats);
+
+  // The step time of the model, from the first start to the last end.
+  Costs::Duration step_time() const { return step_time_; }
+
+  // The nodes on the critical path, in execution order.
+  const std::vector<const NodeDef*>& critical_path() const {
+    return critical_path_;
+  }
+
+  // The measured times of "node", relative to the start of the step:
+  // time_ready is when its inputs were ready, time_scheduled when it started
+  // running and time_finished when it finished.
+  const NodeState& GetNodeState(const NodeDef* node) const {
+    return node_states_.at(node);
+  }
+
+  // How much later "node" could have finished without delaying the step.
+  // The nodes on the critical path have no slack.
+  Costs::Duration GetSlack(const NodeDef* node) const {
+    return slack_.at(node);
+  }
+
+  // The node named "name", or nullptr if there is none.
+  const NodeDef* GetNode(const string& name) const;
+
+  // Estimates the step time if the duration of each node in "scales" was
+  // multiplied by its scale, e.g. 0.5 for an op twice as fast and 0 for an op
+  // taking no time.
+  Costs::Duration EstimateStepTime(
+      const std::unordered_map<const NodeDef*, double>& scales) const;
+
+  // Returns a human-readable report of the critical path, of the "top_k" ops
+  // and op types whose speedup would shorten the step the most, and of the
+  // "top_k" longest ops off the critical path with their slack.
+  string Report(int top_k) const;
+
+ private:
+  // The time "node" waited between becoming ready and starting to run.
+  Costs::Duration WaitTime(const NodeDef* node) const;
+  Costs::Duration RunTime(const NodeDef* node) const;
+
+  std::vector<GraphDef> graphs_;
+  std::unordered_map<string, const NodeDef*> name_to_node_;
+  // The nodes in topological order, ignoring NextIteration back edges.
+  std::vector<const NodeDef*> topo_order_;
+  std::unordered_map<const NodeDef*, NodeState> node_states_;
+  std::unordered_map<const NodeDef*, Costs::Duration> slack_;
+  std::vector<const NodeDef*> critical_path_;
+  Costs::Duration step_time_;
+  Costs::Duration measured_step_time_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepCriticalPath);
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_STEP_CRITICAL_PATH_H_
@@ -0,0 +1,158 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/step_critical_path.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+const char kGpu[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+
+NodeDef* AddNode(const string& name, const string& op, const string& device,
+                 const std::vector<string>& inputs, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  node->set_device(device);
+  for (const string& input : inputs) {
+    node->add_input(input);
+  }
+  if (op == "_Send" || op == "_Recv") {
+    auto& attr = *node->mutable_attr();
+    attr["send_device"].set_s(kCpu);
+    attr["send_device_incarnation"].set_i(1);
+    attr["recv_device"].set_s(kGpu);
+    attr["tensor_name"].set_s("edge_1_b");
+  }
+  return node;
+}
+
+void AddStats(const string& name, int64 start, int64 end,
+              DeviceStepStats* dev_stats) {
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_start_micros(1000 + start);
+  node_stats->set_op_end_rel_micros(end - start);
+  node_stats->set_all_end_rel_micros(end - start);
+}
+
+class StepCriticalPathTest : public ::testing::Test {
+ protected:
+  // A MatMul on the CPU whose output is sent to a Relu on the GPU, and a
+  // shorter independent Relu on the CPU.
+  void SetUp() override {
+    std::vector<GraphDef> graphs(2);
+    AddNode("a", "Const", kCpu, {}, &graphs[0]);
+    AddNode("b", "MatMul", kCpu, {"a", "a"}, &graphs[0]);
+    AddNode("send", "_Send", kCpu, {"b"}, &graphs[0]);
+    AddNode("c", "Const", kCpu, {}, &graphs[0]);
+    AddNode("d", "Relu", kCpu, {"c"}, &graphs[0]);
+    AddNode("recv", "_Recv", kGpu, {}, &graphs[1]);
+    AddNode("e", "Relu", kGpu, {"recv"}, &graphs[1]);
+
+    StepStats step_stats;
+    DeviceStepStats* cpu = step_stats.add_dev_stats();
+    cpu->set_device(kCpu);
+    AddStats("a", 0, 10, cpu);
+    AddStats("b", 10, 110, cpu);
+    AddStats("send", 110, 111, cpu);
+    AddStats("c", 0, 5, cpu);
+    AddStats("d", 5, 25, cpu);
+    DeviceStepStats* gpu = step_stats.add_dev_stats();
+    gpu->set_device(kGpu);
+    // The _Recv starts waiting at the beginning of the step.
+    AddStats("recv", 0, 130, gpu);
+    AddStats("e", 135, 160, gpu);
+    DeviceStepStats* stream = step_stats.add_dev_stats();
+    stream->set_device(strings::StrCat(kGpu, "/stream:all"));
+    AddStats("e:Relu", 140, 185, stream);
+
+    TF_ASSERT_OK(critical_path_.Init(graphs, step_stats));
+  }
+
+  int64 Micros(Costs::Duration duration) {
+    return duration.asMicroSeconds().count();
+  }
+
+  StepCriticalPath critical_path_;
+};
+
+TEST_F(StepCriticalPathTest, CriticalPath) {
+  EXPECT_EQ(185, Micros(critical_path_.step_time()));
+  std::vector<string> names;
+  for (const NodeDef* node : critical_path_.critical_path()) {
+    names.push_back(node->name());
+  }
+  EXPECT_EQ(std::vector<string>({"a", "b", "send", "recv", "e"}), names);
+
+  // The _Recv runs from when the tensor is sent until it is received.
+  const NodeState& recv = critical_path_.GetNodeState(
+      critical_path_.GetNode("recv"));
+  EXPECT_EQ(111, Micros(recv.time_ready));
+  EXPECT_EQ(111, Micros(recv.time_scheduled));
+  EXPECT_EQ(130, Micros(recv.time_finished));
+  // The GPU kernel ends on the stream.
+  const NodeState& e = critical_path_.GetNodeState(critical_path_.GetNode("e"));
+  EXPECT_EQ(130, Micros(e.time_ready));
+  EXPECT_EQ(135, Micros(e.time_scheduled));
+  EXPECT_EQ(185, Micros(e.time_finished));
+}
+
+TEST_F(StepCriticalPathTest, Slack) {
+  for (const NodeDef* node : critical_path_.critical_path()) {
+    EXPECT_EQ(0, Micros(critical_path_.GetSlack(node))) << node->name();
+  }
+  EXPECT_EQ(160, Micros(critical_path_.GetSlack(critical_path_.GetNode("d"))));
+  EXPECT_EQ(160, Micros(critical_path_.GetSlack(critical_path_.GetNode("c"))));
+}
+
+TEST_F(StepCriticalPathTest, EstimateStepTime) {
+  EXPECT_EQ(185, Micros(critical_path_.EstimateStepTime({})));
+  const NodeDef* b = critical_path_.GetNode("b");
+  EXPECT_EQ(135, Micros(critical_path_.EstimateStepTime({{b, 0.5}})));
+  EXPECT_EQ(85, Micros(critical_path_.EstimateStepTime({{b, 0.0}})));
+  // Speeding up an op off the critical path does not shorten the step.
+  const NodeDef* d = critical_path_.GetNode("d");
+  EXPECT_EQ(185, Micros(critical_path_.EstimateStepTime({{d, 0.0}})));
+}
+
+TEST_F(StepCriticalPathTest, Report) {
+  const string report = critical_path_.Report(3);
+  EXPECT_TRUE(str_util::StrContains(report, "Step time: 185 us")) << report;
+  EXPECT_TRUE(str_util::StrContains(report, "Critical path: 5 ops")) << report;
+  EXPECT_TRUE(str_util::StrContains(
+      report, "100          50         100  b (MatMul)\n"))
+      << report;
+  EXPECT_TRUE(str_util::StrContains(report, "20       160  d (Relu)\n"))
+      << report;
+}
+
+TEST(StepCriticalPathErrorsTest, NoPartitionGraphs) {
+  StepCriticalPath critical_path;
+  EXPECT_FALSE(critical_path.Init({}, StepStats()).ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,127 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+NodeDef* MutableGraphView::AddNode(NodeDef&& node) {
+  NodeDef* node_in_graph = GetGraph()->add_node();
+  *node_in_graph = std::move(node);
+
+  AddUniqueNodeOrDie(node_in_graph);
+  AddFanouts(node_in_graph);
+  return node_in_graph;
+}
+
+void MutableGraphView::UpdateFanouts(const string& from_node,
+                                     const string& to_node) {
+  NodeDef* from = GetNode(from_node);
+  NodeDef* to = GetNode(to_node);
+  CHECK(from != nullptr) << "Unknown node " << from_node;
+  CHECK(to != nullptr) << "Unknown node " << to_node;
+
+  auto& num_regular_outputs = *MutableNumRegularOutputs();
+  auto it = num_regular_outputs.find(from);
+  const int last_port_id = it != num_regular_outputs.end() ? it->second : -1;
+  const string from_control = AsControlDependency(from_node);
+  const string to_control = AsControlDependency(to_node);
+
+  auto& fanouts = *MutableFanouts();
+  for (int port_id = -1; port_id <= last_port_id; ++port_id) {
+    auto fanout = fanouts.find(OutputPort(from, port_id));
+    if (fanout == fanouts.end()) continue;
+    // Take the fanouts out first: the new entry may rehash the map.
+    std::unordered_set<InputPort, HashPort> inputs = std::move(fanout->second);
+    fanouts.erase(fanout);
+
+    for (const InputPort& input : inputs) {
+      if (port_id < 0) {
+        for (int i = 0; i < input.node->input_size(); ++i) {
+          if (input.node->input(i) == from_control) {
+            input.node->set_input(i, to_control);
+          }
+        }
+      } else if (port_id == 0) {
+        input.node->set_input(input.port_id, to_node);
+      } else {
+        input.node->set_input(input.port_id,
+                              strings::StrCat(to_node, ":", port_id));
+      }
+    }
+    auto& to_fanouts = fanouts[OutputPort(to, port_id)];
+    to_fanouts.insert(inputs.begin(), inputs.end());
+    if (port_id >= 0) {
+      num_regular_outputs[to] = std::max(num_regular_outputs[to], port_id);
+    }
+  }
+  num_regular_outputs.erase(from);
+}
+
+void MutableGraphView::RemoveFanins(const NodeDef* node) {
+  auto& fanouts = *MutableFanouts();
+  for (int i = 0; i < node->input_size(); ++i) {
+    OutputPort fanin;
+    string fanin_name = ParseNodeName(node->input(i), &fanin.port_id);
+    fanin.node = GetNode(fanin_name);
+    auto it = fanouts.find(fanin);
+    if (it == fanouts.end()) continue;
+    it->second.erase(InputPort(node, fanin.port_id < 0 ? -1 : i));
+    if (it->second.empty()) fanouts.erase(it);
+  }
+}
+
+void MutableGraphView::DeleteNodes(const std::set<string>& nodes_to_delete) {
+  auto& fanouts = *MutableFanouts();
+  auto& num_regular_outputs = *MutableNumRegularOutputs();
+  for (const string& node_name : nodes_to_delete) {
+    NodeDef* node = GetNode(node_name);
+    if (node == nullptr) continue;
+    RemoveFanins(node);
+    auto it = num_regular_outputs.find(node);
+    const int last_port_id = it != num_regular_outputs.end() ? it->second : -1;
+    for (int port_id = -1; port_id <= last_port_id; ++port_id) {
+      fanouts.erase(OutputPort(node, port_id));
+    }
+    if (it != num_regular_outputs.end()) {
+      num_regular_outputs.erase(it);
+    }
+    MutableNodes()->erase(node_name);
+  }
+
+  // Move the deleted nodes to the end of the graph before removing them. This
+  // only swaps the pointers held by the repeated field, so the pointers to
+  // the remaining nodes stay valid.
+  GraphDef* graph = GetGraph();
+  int last = graph->node_size() - 1;
+  for (int i = graph->node_size() - 1; i >= 0; --i) {
+    if (nodes_to_delete.count(graph->node(i).name()) > 0) {
+      graph->mutable_node()->SwapElements(i, last);
+      --last;
+    }
+  }
+  graph->mutable_node()->DeleteSubrange(last + 1,
+                                        graph->node_size() - last - 1);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
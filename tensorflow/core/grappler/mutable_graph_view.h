@@ -0,0 +1,55 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_MUTABLE_GRAPH_VIEW_H_
+#define TENSORFLOW_CORE_GRAPPLER_MUTABLE_GRAPH_VIEW_H_
+
+#include <set>
+
+#include "tensorflow/core/grappler/graph_view.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A utility class to simplify the traversal of a GraphDef that, unlike
+// GraphView, supports updating the graph. The fanin and fanout indices are
+// maintained incrementally, so an optimizer can keep using the same view
+// after each rewrite instead of rebuilding a NodeMap or GraphView over the
+// whole graph.
+class MutableGraphView : public GraphView {
+ public:
+  explicit MutableGraphView(GraphDef* graph) : GraphView(graph) {}
+
+  // Adds a new node to the graph and returns a pointer to it. The nodes
+  // feeding it must already be in the view for their fanouts to be updated.
+  NodeDef* AddNode(NodeDef&& node);
+
+  // Updates all the fanouts (i.e. the input ports reading the outputs) of
+  // 'from_node' to read the same outputs of 'to_node' instead.
+  void UpdateFanouts(const string& from_node, const string& to_node);
+
+  // Deletes the nodes from the graph. The nodes must not have any fanout
+  // left, other than to nodes that are deleted as well.
+  void DeleteNodes(const std::set<string>& nodes_to_delete);
+
+ private:
+  void RemoveFanins(const NodeDef* node);
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_MUTABLE_GRAPH_VIEW_H_
@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class MutableGraphViewTest : public ::testing::Test {
+ protected:
+  // Builds a -> b -> c, with a control dependency from b to d.
+  GrapplerItem CreateItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output a = ops::Const(s.WithOpName("a"), 1.0f, {});
+    Output b = ops::Square(s.WithOpName("b"), a);
+    Output c = ops::Sqrt(s.WithOpName("c"), b);
+    Output d = ops::Neg(s.WithOpName("d").WithControlDependencies(b), a);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+};
+
+TEST_F(MutableGraphViewTest, AddNode) {
+  GrapplerItem item = CreateItem();
+  MutableGraphView graph(&item.graph);
+
+  NodeDef new_node;
+  new_node.set_name("e");
+  new_node.set_op("Exp");
+  new_node.add_input("b");
+  NodeDef* e = graph.AddNode(std::move(new_node));
+
+  EXPECT_EQ(5, item.graph.node_size());
+  EXPECT_EQ(e, graph.GetNode("e"));
+  const auto& fanout = graph.GetFanout(graph.GetOutputPort("b", 0));
+  EXPECT_EQ(2, fanout.size());
+  EXPECT_EQ(1, fanout.count(graph.GetInputPort("e", 0)));
+}
+
+TEST_F(MutableGraphViewTest, UpdateFanouts) {
+  GrapplerItem item = CreateItem();
+  MutableGraphView graph(&item.graph);
+
+  NodeDef new_node;
+  new_node.set_name("e");
+  new_node.set_op("Exp");
+  new_node.add_input("a");
+  graph.AddNode(std::move(new_node));
+  graph.UpdateFanouts("b", "e");
+
+  EXPECT_EQ("e", graph.GetNode("c")->input(0));
+  EXPECT_EQ("^e", graph.GetNode("d")->input(1));
+  EXPECT_TRUE(graph.GetFanouts(*graph.GetNode("b"), true).empty());
+  const auto fanouts = graph.GetFanouts(*graph.GetNode("e"), true);
+  EXPECT_EQ(2, fanouts.size());
+  EXPECT_EQ(1, fanouts.count(graph.GetInputPort("c", 0)));
+  EXPECT_EQ(1, fanouts.count(graph.GetInputPort("d", -1)));
+}
+
+TEST_F(MutableGraphViewTest, DeleteNodes) {
+  GrapplerItem item = CreateItem();
+  MutableGraphView graph(&item.graph);
+  const NodeDef* a = graph.GetNode("a");
+  const NodeDef* d = graph.GetNode("d");
+
+  graph.UpdateFanouts("b", "a");
+  graph.DeleteNodes({"b", "c"});
+
+  EXPECT_EQ(2, item.graph.node_size());
+  EXPECT_EQ(nullptr, graph.GetNode("b"));
+  EXPECT_EQ(nullptr, graph.GetNode("c"));
+  // The pointers to the remaining nodes are still valid.
+  EXPECT_EQ(a, graph.GetNode("a"));
+  EXPECT_EQ(d, graph.GetNode("d"));
+  EXPECT_EQ("^a", d->input(1));
+  const auto fanouts = graph.GetFanouts(*a, true);
+  EXPECT_EQ(2, fanouts.size());
+  EXPECT_EQ(1, fanouts.count(graph.GetInputPort("d", 0)));
+  EXPECT_EQ(1, fanouts.count(graph.GetInputPort("d", -1)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,411 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+const char kSuffix[] = "AutoMixedPrecision";
+
+// Ops that are numerically safe and considerably faster in float16, e.g. on
+// Tensor Cores. They are always converted.
+const std::unordered_set<string>& WhiteList() {
+  static const std::unordered_set<string>* list =
+      new std::unordered_set<string>{
+          "BatchMatMul",
+          "Conv2D",
+          "Conv2DBackpropFilter",
+          "Conv2DBackpropInput",
+          "MatMul",
+      };
+  return *list;
+}
+
+// Ops that are numerically safe in float16 but not much faster in it. They
+// are only converted when they are between converted ops.
+const std::unordered_set<string>& GrayList() {
+  static const std::unordered_set<string>* list =
+      new std::unordered_set<string>{
+          "Add", "AddN", "BiasAdd", "BiasAddGrad", "Mul", "Sub",
+      };
+  return *list;
+}
+
+// Ops that need the range or the precision of float32. The gray and clear ops
+// that consume their results keep float32 as well.
+const std::unordered_set<string>& BlackList() {
+  static const std::unordered_set<string>* list =
+      new std::unordered_set<string>{
+          "Exp",
+          "Expm1",
+          "L2Loss",
+          "Log",
+          "Log1p",
+          "LogSoftmax",
+          "Mean",
+          "Pow",
+          "Softmax",
+          "SoftmaxCrossEntropyWithLogits",
+          "SparseSoftmaxCrossEntropyWithLogits",
+          "Sum",
+      };
+  return *list;
+}
+
+// Ops that only move or select the values of their inputs. They are converted
+// when they are next to converted ops.
+const std::unordered_set<string>& ClearList() {
+  static const std::unordered_set<string>* list =
+      new std::unordered_set<string>{
+          "ConcatV2", "ExpandDims", "Identity",  "MaxPool",   "MaxPoolGrad",
+          "Pack",     "Pad",        "Relu",      "Relu6",     "Relu6Grad",
+          "ReluGrad", "Reshape",    "Slice",     "Squeeze",   "StridedSlice",
+          "Tile",     "Transpose",
+      };
+  return *list;
+}
+
+enum class OpList { kNone, kWhite, kGray, kClear, kBlack };
+
+OpList GetOpList(const string& op) {
+  if (WhiteList().count(op) > 0) return OpList::kWhite;
+  if (GrayList().count(op) > 0) return OpList::kGray;
+  if (ClearList().count(op) > 0) return OpList::kClear;
+  if (BlackList().count(op) > 0) return OpList::kBlack;
+  return OpList::kNone;
+}
+
+int GetNumGPUs(const Cluster& cluster) {
+  int num_gpus = 0;
+  for (const auto& device : cluster.GetDevices()) {
+    if (device.second.type() == "GPU") {
+      num_gpus++;
+    }
+  }
+  return num_gpus;
+}
+
+// A tensor flowing from output "src_port" of node "src" to input "dst_port"
+// of node "dst". Nodes are identified by their index in the graph.
+struct Edge {
+  int src;
+  int src_port;
+  int dst;
+  int dst_port;
+};
+
+class AutoMixedPrecisionImpl {
+ public:
+  AutoMixedPrecisionImpl(Cluster* cluster,
+                         const std::unordered_set<string>& nodes_to_preserve,
+                         GraphDef* graph)
+      : virtual_placer_(cluster),
+        nodes_to_preserve_(nodes_to_preserve),
+        graph_(graph) {}
+
+  Status Optimize();
+
+ private:
+  bool IsOnGPU(const NodeDef& node) const;
+
+  // Returns true if "node" runs on a GPU with a float32 type attribute "T"
+  // that may be changed to float16. In that case "half_inputs" and
+  // "half_outputs" are set to whether each input and output of the node then
+  // becomes float16.
+  bool CanConvert(const NodeDef& node, std::vector<bool>* half_inputs,
+                  std::vector<bool>* half_outputs) const;
+
+  // Returns true if "edge" connects two nodes that may be converted, with a
+  // tensor that changes type with either of them.
+  bool IsConvertibleEdge(const Edge& edge) const {
+    return list_[edge.src] != OpList::kNone &&
+           list_[edge.dst] != OpList::kNone &&
+           half_outputs_[edge.src][edge.src_port] &&
+           half_inputs_[edge.dst][edge.dst_port];
+  }
+
+  // Sets "reached" for the nodes that are reachable from "roots" through
+  // convertible edges, going forward or backward, and passing only through
+  // nodes for which "follow" returns true.
+  void Propagate(const std::vector<int>& roots, bool forward,
+                 const std::function<bool(int)>& follow,
+                 std::vector<bool>* reached) const;
+
+  // Converts the nodes for which "convert" is set, and inserts Cast nodes
+  // where their float16 tensors meet float32 tensors.
+  void Rewrite(const std::vector<bool>& convert);
+
+  VirtualPlacer virtual_placer_;
+  const std::unordered_set<string>& nodes_to_preserve_;
+  GraphDef* graph_;
+
+  std::unordered_map<string, int> node_index_;
+  std::vector<OpList> list_;
+  std::vector<std::vector<bool>> half_inputs_;
+  std::vector<std::vector<bool>> half_outputs_;
+  std::vector<Edge> edges_;
+  std::vector<std::vector<int>> fanin_;
+  std::vector<std::vector<int>> fanout_;
+};
+
+bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
+  string device_name;
+  if (node.device().empty()) {
+    device_name = virtual_placer_.get_canonical_device_name(node);
+  } else {
+    device_name = node.device();
+  }
+  string device;
+  string not_used;
+  return DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
+         str_util::StrContains(str_util::Lowercase(device),
+                               str_util::Lowercase(DEVICE_GPU));
+}
+
+bool AutoMixedPrecisionImpl::CanConvert(const NodeDef& node,
+                                        std::vector<bool>* half_inputs,
+                                        std::vector<bool>* half_outputs) const {
+  if (nodes_to_preserve_.count(node.name()) > 0 || !IsOnGPU(node)) {
+    return false;
+  }
+  auto it = node.attr().find("T");
+  if (it == node.attr().end() || it->second.type() != DT_FLOAT) {
+    return false;
+  }
+  const OpDef* op_def;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  NodeDef half_node = node;
+  (*half_node.mutable_attr())["T"].set_type(DT_HALF);
+  DataTypeVector inputs, outputs, half_node_inputs, half_node_outputs;
+  if (!InOutTypesForNode(node, *op_def, &inputs, &outputs).ok() ||
+      !InOutTypesForNode(half_node, *op_def, &half_node_inputs,
+                         &half_node_outputs)
+           .ok()) {
+    return false;
+  }
+  // Only converts the nodes that have a float16 GPU kernel.
+  if (!FindKernelDef(DeviceType(DEVICE_GPU), half_node, nullptr, nullptr)
+           .ok()) {
+    return false;
+  }
+  half_inputs->clear();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    half_inputs->push_back(half_node_inputs[i] != inputs[i]);
+  }
+  half_outputs->clear();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    half_outputs->push_back(half_node_outputs[i] != outputs[i]);
+  }
+  return true;
+}
+
+void AutoMixedPrecisionImpl::Propagate(const std::vector<int>& roots,
+                                       bool forward,
+                                       const std::function<bool(int)>& follow,
+                                       std::vector<bool>* reached) const {
+  std::deque<int> queue(roots.begin(), roots.end());
+  while (!queue.empty()) {
+    const int node = queue.front();
+    queue.pop_front();
+    for (int e : forward ? fanout_[node] : fanin_[node]) {
+      const Edge& edge = edges_[e];
+      if (!IsConvertibleEdge(edge)) continue;
+      const int next = forward ? edge.dst : edge.src;
+      if ((*reached)[next] || !follow(next)) continue;
+      (*reached)[next] = true;
+      queue.push_back(next);
+    }
+  }
+}
+
+void AutoMixedPrecisionImpl::Rewrite(const std::vector<bool>& convert) {
+  for (int i = 0; i < graph_->node_size(); ++i) {
+    if (convert[i]) {
+      (*graph_->mutable_node(i)->mutable_attr())["T"].set_type(DT_HALF);
+    }
+  }
+  // Inserts at most one Cast per tensor, destination device and type.
+  std::unordered_map<string, string> casts;
+  for (const Edge& edge : edges_) {
+    const bool src_half =
+        convert[edge.src] && half_outputs_[edge.src][edge.src_port];
+    const bool dst_half =
+        convert[edge.dst] && half_inputs_[edge.dst][edge.dst_port];
+    if (src_half == dst_half) continue;
+    const string input = graph_->node(edge.dst).input(edge.dst_port);
+    const string& device = graph_->node(edge.dst).device();
+    string& cast_name =
+        casts[strings::StrCat(input, "|", device, "|", dst_half)];
+    if (cast_name.empty()) {
+      const string prefix =
+          strings::StrCat(graph_->node(edge.src).name(), "-", edge.src_port,
+                          "-CastTo", dst_half ? "Fp16" : "Fp32", "-", kSuffix);
+      cast_name = prefix;
+      for (int n = 1; node_index_.count(cast_name) > 0; ++n) {
+        cast_name = strings::StrCat(prefix, "-", n);
+      }
+      node_index_[cast_name] = graph_->node_size();
+      NodeDef* cast = graph_->add_node();
+      cast->set_name(cast_name);
+      cast->set_op("Cast");
+      cast->set_device(device);
+      cast->add_input(input);
+      (*cast->mutable_attr())["SrcT"].set_type(dst_half ? DT_FLOAT : DT_HALF);
+      (*cast->mutable_attr())["DstT"].set_type(dst_half ? DT_HALF : DT_FLOAT);
+    }
+    *graph_->mutable_node(edge.dst)->mutable_input(edge.dst_port) = cast_name;
+  }
+}
+
+Status AutoMixedPrecisionImpl::Optimize() {
+  const int num_nodes = graph_->node_size();
+  list_.resize(num_nodes, OpList::kNone);
+  half_inputs_.resize(num_nodes);
+  half_outputs_.resize(num_nodes);
+  fanin_.resize(num_nodes);
+  fanout_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph_->node(i);
+    node_index_[node.name()] = i;
+    const OpList list = GetOpList(node.op());
+    if (list != OpList::kNone &&
+        CanConvert(node, &half_inputs_[i], &half_outputs_[i])) {
+      list_[i] = list;
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph_->node(i);
+    for (int j = 0; j < node.input_size(); ++j) {
+      if (IsControlInput(node.input(j))) break;
+      int port;
+      auto it = node_index_.find(ParseNodeName(node.input(j), &port));
+      if (it == node_index_.end()) continue;
+      fanin_[i].push_back(edges_.size());
+      fanout_[it->second].push_back(edges_.size());
+      edges_.push_back({it->second, port, i, j});
+    }
+  }
+
+  std::vector<int> white;
+  std::vector<int> black;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (list_[i] == OpList::kWhite) white.push_back(i);
+    if (list_[i] == OpList::kBlack) black.push_back(i);
+  }
+  if (white.empty()) {
+    return Status::OK();
+  }
+
+  // The gray and clear ops that consume the results of black ops must keep
+  // float32.
+  std::vector<bool> after_black(num_nodes, false);
+  Propagate(black, true,
+            [this](int node) {
+              return list_[node] == OpList::kGray ||
+                     list_[node] == OpList::kClear;
+            },
+            &after_black);
+
+  // Converts the white ops, and the gray and clear ops between them.
+  auto gray_or_clear = [this, &after_black](int node) {
+    return !after_black[node] &&
+           (list_[node] == OpList::kGray || list_[node] == OpList::kClear);
+  };
+  std::vector<bool> after_white(num_nodes, false);
+  std::vector<bool> before_white(num_nodes, false);
+  Propagate(white, true, gray_or_clear, &after_white);
+  Propagate(white, false, gray_or_clear, &before_white);
+  std::vector<bool> convert(num_nodes, false);
+  std::vector<int> converted;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (list_[i] == OpList::kWhite || (after_white[i] && before_white[i])) {
+      convert[i] = true;
+      converted.push_back(i);
+    }
+  }
+
+  // Converts the clear ops next to converted ops, so that the Casts are
+  // inserted where the type of the values actually needs to change.
+  auto clear = [this, &after_black](int node) {
+    return !after_black[node] && list_[node] == OpList::kClear;
+  };
+  std::vector<bool> after_converted(num_nodes, false);
+  std::vector<bool> before_converted(num_nodes, false);
+  Propagate(converted, true, clear, &after_converted);
+  Propagate(converted, false, clear, &before_converted);
+  int num_converted = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (after_converted[i] || before_converted[i]) convert[i] = true;
+    if (convert[i]) ++num_converted;
+  }
+
+  VLOG(1) << "Converting " << num_converted << " of " << num_nodes
+          << " nodes to float16";
+  Rewrite(convert);
+  return Status::OK();
+}
+
+}  // namespace
+
+Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* output) {
+  *output = item.graph;
+  if (cluster == nullptr || GetNumGPUs(*cluster) < 1) {
+    // Mixed precision only pays off on GPUs.
+    return Status::OK();
+  }
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  AutoMixedPrecisionImpl impl(cluster, nodes_to_preserve, output);
+  Status status = impl.Optimize();
+  if (!status.ok()) {
+    *output = item.graph;
+  }
+  return status;
+}
+
+void AutoMixedPrecision::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimize_output,
+                                  double result) {
+  // Nothing to do for AutoMixedPrecision.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
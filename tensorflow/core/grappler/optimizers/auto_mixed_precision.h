@@ -0,0 +1,50 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Converts the float32 computations of a graph that run on GPUs to float16
+// where that is both numerically safe and profitable, e.g. matrix
+// multiplications and convolutions that can then use Tensor Cores. Cast nodes
+// are inserted where float16 and float32 tensors meet. Variables and the ops
+// that update them are left in float32, so the model keeps float32 master
+// weights. The loss still needs to be scaled, e.g. with
+// tf.contrib.mixed_precision.LossScaleOptimizer, to keep small gradients from
+// underflowing in float16.
+class AutoMixedPrecision : public GraphOptimizer {
+ public:
+  AutoMixedPrecision() {}
+
+  ~AutoMixedPrecision() override {}
+
+  string name() const override { return "auto_mixed_precision"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
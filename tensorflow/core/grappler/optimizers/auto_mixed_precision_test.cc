@@ -0,0 +1,126 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/devices.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class AutoMixedPrecisionTest : public GrapplerTest {
+ protected:
+  std::unique_ptr<Cluster> CreateCluster(const string& device_type) {
+    DeviceProperties device_properties;
+    device_properties.set_type(device_type);
+    std::unique_ptr<Cluster> cluster(new VirtualCluster(
+        {{strings::StrCat("/", device_type, ":0"), device_properties}}));
+    TF_CHECK_OK(cluster->Provision());
+    return cluster;
+  }
+
+  // Builds exp -> relu -> add -> matmul -> relu -> add -> matmul -> relu ->
+  // log, where the second add also feeds the second matmul.
+  GrapplerItem CreateItem() {
+    tensorflow::Scope s =
+        tensorflow::Scope::NewRootScope().WithDevice("/device:GPU:0");
+    Output input = ops::Const(s.WithOpName("input"), 1.f / 64, {8, 8});
+    Output blk1 = ops::Exp(s.WithOpName("blk1"), input);
+    Output clr1 = ops::Relu(s.WithOpName("clr1"), blk1);
+    Output gry1 = ops::Add(s.WithOpName("gry1"), clr1, clr1);
+    Output wht1 = ops::MatMul(s.WithOpName("wht1"), gry1, gry1);
+    Output clr2 = ops::Relu(s.WithOpName("clr2"), wht1);
+    Output gry2 = ops::Add(s.WithOpName("gry2"), clr2, clr2);
+    Output wht2 = ops::MatMul(s.WithOpName("wht2"), gry2, clr2);
+    Output clr3 = ops::Relu(s.WithOpName("clr3"), wht2);
+    Output blk2 = ops::Log(s.WithOpName("blk2"), clr3);
+    Output fetch = ops::Identity(s.WithOpName("fetch"), blk2);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+};
+
+TEST_F(AutoMixedPrecisionTest, NoGPU) {
+  std::unique_ptr<Cluster> cluster = CreateCluster("CPU");
+  GrapplerItem item = CreateItem();
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  CompareGraphs(item.graph, output);
+  TF_CHECK_OK(cluster->Shutdown());
+}
+
+#if GOOGLE_CUDA
+TEST_F(AutoMixedPrecisionTest, Simple) {
+  std::unique_ptr<Cluster> cluster = CreateCluster("GPU");
+  GrapplerItem item = CreateItem();
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  // One Cast into wht1 and one Cast into blk2.
+  EXPECT_EQ(item.graph.node_size() + 2, output.node_size());
+  NodeMap node_map(&output);
+  for (const string& name : {"input", "blk1", "clr1", "gry1", "blk2"}) {
+    const NodeDef* node = node_map.GetNode(name);
+    if (node->attr().count("T") > 0) {
+      EXPECT_EQ(DT_FLOAT, node->attr().at("T").type()) << name;
+    }
+  }
+  for (const string& name : {"wht1", "clr2", "gry2", "wht2", "clr3"}) {
+    EXPECT_EQ(DT_HALF, node_map.GetNode(name)->attr().at("T").type()) << name;
+  }
+  // The fetched node keeps its type.
+  EXPECT_EQ(DT_FLOAT, node_map.GetNode("fetch")->attr().at("T").type());
+
+  const NodeDef* cast = node_map.GetNode(node_map.GetNode("wht1")->input(0));
+  EXPECT_EQ("Cast", cast->op());
+  EXPECT_EQ("gry1", cast->input(0));
+  EXPECT_EQ(DT_HALF, cast->attr().at("DstT").type());
+  EXPECT_EQ(cast->name(), node_map.GetNode("wht1")->input(1));
+  cast = node_map.GetNode(node_map.GetNode("blk2")->input(0));
+  EXPECT_EQ("Cast", cast->op());
+  EXPECT_EQ("clr3", cast->input(0));
+  EXPECT_EQ(DT_FLOAT, cast->attr().at("DstT").type());
+
+  if (GetNumAvailableGPUs() > 0) {
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    auto tensors = EvaluateNodes(output, item.fetch);
+    EXPECT_EQ(1, tensors_expected.size());
+    EXPECT_EQ(1, tensors.size());
+    test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-2);
+  }
+  TF_CHECK_OK(cluster->Shutdown());
+}
+#endif  // GOOGLE_CUDA
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/folded_tensor_cache.h"
 #include "tensorflow/core/grappler/optimizers/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -1024,6 +1025,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     }
   });
 
+  std::vector<const TensorProto*> raw_inputs;
   for (const auto& input : node.input()) {
     int port = 0;
     ParseNodeNameAsStringPiece(input, &port);
@@ -1037,13 +1039,39 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                     strings::StrCat("Can't fold ", node.name(), ", its ", input,
                                     " isn't constant"));
     }
-    const TensorProto& raw_val = input_node->attr().at("value").tensor();
-    Tensor* value = new Tensor(raw_val.dtype(), raw_val.tensor_shape());
-    CHECK(value->FromProto(raw_val));
-    inputs.emplace_back(value);
+    raw_inputs.push_back(&input_node->attr().at("value").tensor());
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  // The same node is folded again by every iteration of the meta optimizer,
+  // so reuse the outputs computed before if there are any.
+  FoldedTensorCache* cache = FoldedTensorCache::Global();
+  const Fprint128 key = FoldedTensorCache::Key(node, raw_inputs);
+  std::vector<Tensor> cached_outputs;
+  if (cache->Lookup(key, &cached_outputs)) {
+    for (const Tensor& output : cached_outputs) {
+      output_tensors.emplace_back(new Tensor(output));
+    }
+  } else {
+    for (const TensorProto* raw_val : raw_inputs) {
+      Tensor* value = new Tensor(raw_val->dtype(), raw_val->tensor_shape());
+      CHECK(value->FromProto(*raw_val));
+      inputs.emplace_back(value);
+    }
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+    // Dead outputs depend on more than the input values, e.g. on which
+    // branch of a switch is taken, so don't cache them.
+    bool all_outputs_live = true;
+    for (const auto& output : output_tensors) {
+      if (output.tensor == nullptr) {
+        all_outputs_live = false;
+        break;
+      }
+      cached_outputs.push_back(*output.tensor);
+    }
+    if (all_outputs_live) {
+      cache->Insert(key, cached_outputs);
+    }
+  }
   if (output_tensors.empty()) {
     return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
   }
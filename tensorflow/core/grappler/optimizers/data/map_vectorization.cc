@@ -0,0 +1,280 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/graph_view.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Ops with a single output, each element of which only depends on the
+// corresponding element of the input.
+const std::unordered_set<string>& UnaryOps() {
+  static const std::unordered_set<string>* ops =
+      new std::unordered_set<string>(
+          {"Abs", "Cast", "Ceil", "Cos", "Exp", "Expm1", "Floor", "Identity",
+           "Log", "Log1p", "LogicalNot", "Neg", "Reciprocal", "Relu", "Relu6",
+           "Rint", "Round", "Rsqrt", "Sigmoid", "Sign", "Sin", "Sqrt",
+           "Square", "Tanh"});
+  return *ops;
+}
+
+// Ops with a single output, each element of which only depends on the
+// corresponding elements of the two inputs after broadcasting.
+const std::unordered_set<string>& BinaryOps() {
+  static const std::unordered_set<string>* ops =
+      new std::unordered_set<string>(
+          {"Add", "Div", "Equal", "FloorDiv", "FloorMod", "Greater",
+           "GreaterEqual", "Less", "LessEqual", "LogicalAnd", "LogicalOr",
+           "Maximum", "Minimum", "Mul", "NotEqual", "Pow", "RealDiv",
+           "SquaredDifference", "Sub", "TruncateDiv"});
+  return *ops;
+}
+
+// What the vectorization knows about a tensor in the function: either it is
+// computed from the arguments, and has the given static shape per element,
+// or it is a scalar constant.
+struct Value {
+  bool batched;
+  PartialTensorShape element_shape;
+};
+
+// Checks whether all outputs of `function` are element-wise functions of its
+// first `arg_shapes.size()` arguments, which have the given shapes.
+class ElementWiseChecker {
+ public:
+  ElementWiseChecker(const FunctionDef& function,
+                     const std::vector<PartialTensorShape>& arg_shapes)
+      : function_(function) {
+    const auto& args = function.signature().input_arg();
+    for (int i = 0; i < args.size(); ++i) {
+      if (i < arg_shapes.size()) {
+        values_[args.Get(i).name()] = {true, arg_shapes[i]};
+      } else {
+        // Captured inputs are neither batched nor known to be scalars.
+        unsupported_.insert(args.Get(i).name());
+      }
+    }
+    for (const NodeDef& node : function.node_def()) {
+      nodes_[node.name()] = &node;
+    }
+  }
+
+  bool Check() {
+    for (const auto& ret : function_.ret()) {
+      Value value;
+      if (!Resolve(ret.second, &value) || !value.batched) return false;
+    }
+    return true;
+  }
+
+ private:
+  // Resolves an input of a node, i.e. the name of an argument or
+  // "<node>:<output>:<index>".
+  bool Resolve(const string& input, Value* value) {
+    const string name = input.substr(0, input.find(':'));
+    if (unsupported_.count(name)) return false;
+    auto it = values_.find(name);
+    if (it != values_.end()) {
+      *value = it->second;
+      return true;
+    }
+    // All supported ops have a single output.
+    if (name != input && !str_util::EndsWith(input, ":0")) return false;
+    auto node_it = nodes_.find(name);
+    if (node_it == nodes_.end()) return false;
+    // Marks the node as unsupported while it is visited, which also rejects
+    // cycles.
+    unsupported_.insert(name);
+    if (!Visit(*node_it->second, value)) return false;
+    unsupported_.erase(name);
+    values_[name] = *value;
+    return true;
+  }
+
+  bool Visit(const NodeDef& node, Value* value) {
+    std::vector<Value> inputs;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) continue;
+      Value input_value;
+      if (!Resolve(input, &input_value)) return false;
+      inputs.push_back(input_value);
+    }
+    if (node.op() == "Const") {
+      auto it = node.attr().find("value");
+      if (it == node.attr().end() ||
+          it->second.tensor().tensor_shape().dim_size() != 0) {
+        return false;
+      }
+      *value = {false, PartialTensorShape({})};
+      return true;
+    }
+    if (UnaryOps().count(node.op()) && inputs.size() == 1) {
+      *value = inputs[0];
+      return true;
+    }
+    if (BinaryOps().count(node.op()) && inputs.size() == 2) {
+      const Value& x = inputs[0];
+      const Value& y = inputs[1];
+      if (x.batched && y.batched) {
+        // Batching two inputs of different or unknown shapes could change
+        // how they broadcast against each other.
+        if (!x.element_shape.IsFullyDefined() ||
+            !x.element_shape.IsIdenticalTo(y.element_shape)) {
+          return false;
+        }
+      }
+      *value = x.batched ? x : y;
+      return true;
+    }
+    return false;
+  }
+
+  const FunctionDef& function_;
+  std::unordered_map<string, const NodeDef*> nodes_;
+  std::unordered_map<string, Value> values_;
+  std::unordered_set<string> unsupported_;
+};
+
+const FunctionDef* FindFunction(const FunctionDefLibrary& library,
+                                const string& name) {
+  for (const FunctionDef& function : library.function()) {
+    if (function.signature().name() == name) return &function;
+  }
+  return nullptr;
+}
+
+bool GetShapes(const NodeDef& node, std::vector<PartialTensorShape>* shapes) {
+  auto it = node.attr().find("output_shapes");
+  if (it == node.attr().end()) return false;
+  for (const TensorShapeProto& shape : it->second.list().shape()) {
+    shapes->emplace_back(shape);
+  }
+  return true;
+}
+
+}  // namespace
+
+Status MapVectorization::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* output) {
+  *output = item.graph;
+  GraphView graph(output);
+  std::set<string> nodes_to_delete;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != "BatchDataset" && node.op() != "BatchDatasetV2") {
+      continue;
+    }
+
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef batch_node(node);
+    GraphView::InputPort input_port = graph.GetInputPort(batch_node.name(), 0);
+    NodeDef* node2 = graph.GetRegularFanin(input_port).node;
+    if (node2->op() != "MapDataset" && node2->op() != "ParallelMapDataset") {
+      continue;
+    }
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef map_node(*node2);
+    if (graph.GetFanout(graph.GetOutputPort(map_node.name(), 0)).size() != 1) {
+      continue;
+    }
+
+    NodeDef* input_node =
+        graph.GetRegularFanin(graph.GetInputPort(map_node.name(), 0)).node;
+    std::vector<PartialTensorShape> element_shapes;
+    std::vector<PartialTensorShape> batch_shapes;
+    if (!GetShapes(*input_node, &element_shapes) ||
+        !GetShapes(batch_node, &batch_shapes) || batch_shapes.empty() ||
+        batch_shapes[0].dims() < 1 ||
+        !input_node->attr().count("output_types")) {
+      continue;
+    }
+    const FunctionDef* function = FindFunction(
+        item.graph.library(), map_node.attr().at("f").func().name());
+    if (function == nullptr ||
+        !ElementWiseChecker(*function, element_shapes).Check()) {
+      continue;
+    }
+
+    // Batch the input of the map, with the same static batch size as the
+    // output of the original batch.
+    NodeDef* new_batch_node = output->add_node();
+    new_batch_node->set_op(batch_node.op());
+    graph_utils::SetUniqueName(batch_node.op(), output, new_batch_node);
+    new_batch_node->add_input(map_node.input(0));
+    for (int i = 1; i < batch_node.input_size(); ++i) {
+      new_batch_node->add_input(batch_node.input(i));
+    }
+    (*new_batch_node->mutable_attr())["output_types"] =
+        input_node->attr().at("output_types");
+    AttrValue* shapes_attr =
+        &(*new_batch_node->mutable_attr())["output_shapes"];
+    for (const PartialTensorShape& shape : element_shapes) {
+      PartialTensorShape({batch_shapes[0].dim_size(0)})
+          .Concatenate(shape)
+          .AsProto(shapes_attr->mutable_list()->add_shape());
+    }
+
+    // Map the function over the batches, with the same other arguments.
+    NodeDef* new_map_node = output->add_node();
+    *new_map_node = map_node;
+    graph_utils::SetUniqueName(map_node.op(), output, new_map_node);
+    new_map_node->set_input(0, new_batch_node->name());
+    for (auto key : {"output_shapes", "output_types"}) {
+      (*new_map_node->mutable_attr())[key] = batch_node.attr().at(key);
+    }
+
+    // Mark the `Map` and `Batch` nodes for removal.
+    nodes_to_delete.insert(map_node.name());
+    nodes_to_delete.insert(batch_node.name());
+
+    // Update the input of the outputs of the `Batch` node to use the new
+    // `Map` node.
+    GraphView::OutputPort output_port =
+        graph.GetOutputPort(batch_node.name(), 0);
+    auto fanout = graph.GetFanout(output_port);
+    for (auto it = fanout.begin(); it != fanout.end(); ++it) {
+      it->node->set_input(it->port_id, new_map_node->name());
+    }
+  }
+  TF_RETURN_IF_ERROR(graph_utils::DeleteNodes(nodes_to_delete, output));
+  return Status::OK();
+}
+
+void MapVectorization::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                const GraphDef& optimize_output,
+                                double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,174 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Adds `range(10).map(function).batch(5)` to `item`, where the elements of
+// the range have the given shape.
+void AddMapAndBatch(const FunctionDef &function,
+                    const PartialTensorShape &element_shape,
+                    GrapplerItem *item, NodeDef **map_node,
+                    NodeDef **batch_node) {
+  GraphDef *graph = &item->graph;
+  *graph->mutable_library()->add_function() = function;
+
+  NodeDef *start_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(0, graph, &start_node));
+  NodeDef *stop_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(10, graph, &stop_node));
+  NodeDef *step_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(1, graph, &step_node));
+
+  AttrValue types_attr;
+  SetAttrValue(gtl::ArraySlice<DataType>({DT_INT64}), &types_attr);
+  AttrValue element_shapes_attr;
+  SetAttrValue(gtl::ArraySlice<PartialTensorShape>({element_shape}),
+               &element_shapes_attr);
+  NodeDef *range_node;
+  TF_ASSERT_OK(graph_utils::AddNode(
+      "", "RangeDataset",
+      {start_node->name(), stop_node->name(), step_node->name()},
+      {{"output_shapes", element_shapes_attr}, {"output_types", types_attr}},
+      graph, &range_node));
+
+  AttrValue f_attr;
+  f_attr.mutable_func()->set_name(function.signature().name());
+  AttrValue args_attr;
+  SetAttrValue(gtl::ArraySlice<DataType>({}), &args_attr);
+  TF_ASSERT_OK(graph_utils::AddNode("", "MapDataset", {range_node->name()},
+                                    {{"f", f_attr},
+                                     {"Targuments", args_attr},
+                                     {"output_shapes", element_shapes_attr},
+                                     {"output_types", types_attr}},
+                                    graph, map_node));
+
+  NodeDef *batch_size_node;
+  TF_ASSERT_OK(
+      graph_utils::AddScalarConstNode<int64>(5, graph, &batch_size_node));
+  AttrValue batch_shapes_attr;
+  SetAttrValue(gtl::ArraySlice<PartialTensorShape>(
+                   {PartialTensorShape({-1}).Concatenate(element_shape)}),
+               &batch_shapes_attr);
+  TF_ASSERT_OK(graph_utils::AddNode(
+      "", "BatchDataset", {(*map_node)->name(), batch_size_node->name()},
+      {{"output_shapes", batch_shapes_attr}, {"output_types", types_attr}},
+      graph, batch_node));
+}
+
+TEST(MapVectorizationTest, VectorizeElementWiseFunction) {
+  // f(x) = x * 2 + 1
+  FunctionDef function = FunctionDefHelper::Create(
+      "f", {"x: int64"}, {"y: int64"}, {},
+      {FunctionDefHelper::Const<int64>("two", 2),
+       FunctionDefHelper::Const<int64>("one", 1),
+       {{"mul"}, "Mul", {"x", "two:output:0"}, {{"T", DT_INT64}}},
+       {{"add"}, "Add", {"mul:z:0", "one:output:0"}, {{"T", DT_INT64}}}},
+      {{"y", "add:z:0"}});
+  GrapplerItem item;
+  NodeDef *map_node;
+  NodeDef *batch_node;
+  AddMapAndBatch(function, PartialTensorShape({}), &item, &map_node,
+                 &batch_node);
+  const string range_name = map_node->input(0);
+  const string map_name = map_node->name();
+  const string batch_name = batch_node->name();
+  const AttrValue batch_shapes = batch_node->attr().at("output_shapes");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName(map_name, output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName(batch_name, output));
+  const NodeDef &new_batch_node =
+      output.node(graph_utils::FindNodeWithOp("BatchDataset", output));
+  const NodeDef &new_map_node =
+      output.node(graph_utils::FindNodeWithOp("MapDataset", output));
+  EXPECT_EQ(new_batch_node.input(0), range_name);
+  EXPECT_EQ(new_map_node.input(0), new_batch_node.name());
+  EXPECT_EQ(new_map_node.attr().at("f").func().name(), "f");
+  EXPECT_TRUE(AreAttrValuesEqual(new_batch_node.attr().at("output_shapes"),
+                                 batch_shapes));
+  EXPECT_TRUE(AreAttrValuesEqual(new_map_node.attr().at("output_shapes"),
+                                 batch_shapes));
+}
+
+TEST(MapVectorizationTest, DoNotVectorizeNonElementWiseFunction) {
+  // f(x) = reshape(x, [1]), whose output has a different shape per batch.
+  FunctionDef function = FunctionDefHelper::Create(
+      "f", {"x: int64"}, {"y: int64"}, {},
+      {FunctionDefHelper::Const<int32>("shape", 1),
+       {{"reshape"},
+        "Reshape",
+        {"x", "shape:output:0"},
+        {{"T", DT_INT64}, {"Tshape", DT_INT32}}}},
+      {{"y", "reshape:output:0"}});
+  GrapplerItem item;
+  NodeDef *map_node;
+  NodeDef *batch_node;
+  AddMapAndBatch(function, PartialTensorShape({}), &item, &map_node,
+                 &batch_node);
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+}
+
+TEST(MapVectorizationTest, DoNotVectorizeBroadcastOfUnknownShapes) {
+  // f(x) = x * x is only vectorized if `x` has a fully defined shape.
+  FunctionDef function = FunctionDefHelper::Create(
+      "f", {"x: int64"}, {"y: int64"}, {},
+      {{{"mul"}, "Mul", {"x", "x"}, {{"T", DT_INT64}}}},
+      {{"y", "mul:z:0"}});
+  {
+    GrapplerItem item;
+    NodeDef *map_node;
+    NodeDef *batch_node;
+    AddMapAndBatch(function, PartialTensorShape({-1}), &item, &map_node,
+                   &batch_node);
+    MapVectorization optimizer;
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+  }
+  {
+    GrapplerItem item;
+    NodeDef *map_node;
+    NodeDef *batch_node;
+    AddMapAndBatch(function, PartialTensorShape({3}), &item, &map_node,
+                   &batch_node);
+    MapVectorization optimizer;
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_FALSE(graph_utils::ContainsNodeWithName(map_node->name(), output));
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,405 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_optimizer.h"
+
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+const char kSuffix[] = "EmbeddingLookupOptimizer";
+
+bool IsGatherOp(const NodeDef& node) {
+  return node.op() == "Gather" || node.op() == "GatherV2" ||
+         node.op() == "ResourceGather";
+}
+
+// The type of the rows gathered by "node".
+DataType GetParamsType(const NodeDef& node) {
+  const bool is_resource = node.op() == "ResourceGather";
+  return GetDataTypeFromAttr(node, is_resource ? "dtype" : "Tparams");
+}
+
+bool IsZeroConstant(const NodeDef& node) {
+  if (!IsConstant(node)) return false;
+  auto it = node.attr().find("value");
+  if (it == node.attr().end()) return false;
+  Tensor value;
+  if (!value.FromProto(it->second.tensor()) || value.NumElements() != 1) {
+    return false;
+  }
+  if (value.dtype() == DT_INT32) return value.flat<int32>()(0) == 0;
+  if (value.dtype() == DT_INT64) return value.flat<int64>()(0) == 0;
+  return false;
+}
+
+// Returns true if the two devices are known to be different.
+bool AreDifferentDevices(const string& a, const string& b) {
+  DeviceNameUtils::ParsedName parsed_a;
+  DeviceNameUtils::ParsedName parsed_b;
+  return DeviceNameUtils::ParseFullName(a, &parsed_a) &&
+         DeviceNameUtils::ParseFullName(b, &parsed_b) &&
+         !(parsed_a == parsed_b);
+}
+
+class EmbeddingLookupOptimizerImpl {
+ public:
+  EmbeddingLookupOptimizerImpl(
+      const std::unordered_set<string>& nodes_to_preserve, GraphDef* graph)
+      : nodes_to_preserve_(nodes_to_preserve), graph_(graph) {}
+
+  Status Optimize();
+
+ private:
+  // Returns true if "node" gathers rows along the first dimension on another
+  // device than the one that computes its ids.
+  bool IsRemoteLookup(const NodeDef& node) const;
+
+  // Returns the nodes that are reachable from "roots", following the data and
+  // control edges. The roots themselves are only reached through a path.
+  std::vector<bool> ReachableFrom(const std::vector<int>& roots) const;
+
+  NodeDef* AddNode(const string& prefix, const string& op,
+                   const string& device);
+
+  // Adds a Const of type int32 with the given values. It has a control input
+  // from "anchor" to run in the same frame.
+  NodeDef* AddIntConst(const string& prefix, const std::vector<int>& values,
+                       const TensorShape& shape, const NodeDef& anchor);
+
+  // Replaces the lookups of the same table in "group" by a single remote
+  // Gather of their unique ids.
+  void Rewrite(const std::vector<int>& group);
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  GraphDef* graph_;
+
+  std::unordered_map<string, int> node_index_;
+  std::vector<std::vector<int>> fanouts_;
+};
+
+bool EmbeddingLookupOptimizerImpl::IsRemoteLookup(const NodeDef& node) const {
+  if (!IsGatherOp(node) || nodes_to_preserve_.count(node.name()) > 0 ||
+      NumNonControlInputs(node) < 2) {
+    return false;
+  }
+  const DataType index_type = GetDataTypeFromAttr(node, "Tindices");
+  if ((index_type != DT_INT32 && index_type != DT_INT64) ||
+      GetParamsType(node) == DT_INVALID) {
+    return false;
+  }
+  if (node.op() == "GatherV2") {
+    auto axis = node_index_.find(NodeName(node.input(2)));
+    if (axis == node_index_.end() ||
+        !IsZeroConstant(graph_->node(axis->second))) {
+      return false;
+    }
+  }
+  auto ids = node_index_.find(NodeName(node.input(1)));
+  if (ids == node_index_.end()) return false;
+  return AreDifferentDevices(node.device(),
+                             graph_->node(ids->second).device());
+}
+
+std::vector<bool> EmbeddingLookupOptimizerImpl::ReachableFrom(
+    const std::vector<int>& roots) const {
+  std::vector<bool> reached(graph_->node_size(), false);
+  std::deque<int> queue(roots.begin(), roots.end());
+  while (!queue.empty()) {
+    const int node = queue.front();
+    queue.pop_front();
+    for (int fanout : fanouts_[node]) {
+      if (reached[fanout]) continue;
+      reached[fanout] = true;
+      queue.push_back(fanout);
+    }
+  }
+  return reached;
+}
+
+NodeDef* EmbeddingLookupOptimizerImpl::AddNode(const string& prefix,
+                                               const string& op,
+                                               const string& device) {
+  string name = prefix;
+  for (int n = 1; node_index_.count(name) > 0; ++n) {
+    name = strings::StrCat(prefix, "-", n);
+  }
+  node_index_[name] = graph_->node_size();
+  NodeDef* node = graph_->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  node->set_device(device);
+  return node;
+}
+
+NodeDef* EmbeddingLookupOptimizerImpl::AddIntConst(
+    const string& prefix, const std::vector<int>& values,
+    const TensorShape& shape, const NodeDef& anchor) {
+  NodeDef* node = AddNode(prefix, "Const", anchor.device());
+  node->add_input(AsControlDependency(anchor));
+  Tensor value(DT_INT32, shape);
+  for (size_t i = 0; i < values.size(); ++i) {
+    value.flat<int32>()(i) = values[i];
+  }
+  auto& attr = *node->mutable_attr();
+  attr["dtype"].set_type(DT_INT32);
+  value.AsProtoTensorContent(attr["value"].mutable_tensor());
+  return node;
+}
+
+void EmbeddingLookupOptimizerImpl::Rewrite(const std::vector<int>& group) {
+  // A copy, as the lookups are rewritten in place below.
+  const NodeDef lookup = graph_->node(group[0]);
+  const NodeDef& ids_node =
+      graph_->node(node_index_.at(NodeName(lookup.input(1))));
+  const string& ids_device = ids_node.device();
+  const DataType index_type = GetDataTypeFromAttr(lookup, "Tindices");
+  const DataType params_type = GetParamsType(lookup);
+  const string prefix = strings::StrCat(lookup.name(), "/", kSuffix, "/");
+  const int num_lookups = group.size();
+
+  std::vector<string> ids;
+  for (int i : group) {
+    ids.push_back(graph_->node(i).input(1));
+  }
+
+  // Unique only takes vectors, so the ids are flattened first.
+  const string flat_shape =
+      AddIntConst(prefix + "FlatShape", {-1}, TensorShape({1}), ids_node)
+          ->name();
+  std::vector<string> flat_ids;
+  for (int k = 0; k < num_lookups; ++k) {
+    NodeDef* flat = AddNode(prefix + "FlatIds", "Reshape", ids_device);
+    flat->add_input(ids[k]);
+    flat->add_input(flat_shape);
+    (*flat->mutable_attr())["T"].set_type(index_type);
+    (*flat->mutable_attr())["Tshape"].set_type(DT_INT32);
+    flat_ids.push_back(flat->name());
+  }
+  string all_ids = flat_ids[0];
+  if (num_lookups > 1) {
+    NodeDef* concat = AddNode(prefix + "AllIds", "ConcatV2", ids_device);
+    for (const string& flat : flat_ids) {
+      concat->add_input(flat);
+    }
+    concat->add_input(
+        AddIntConst(prefix + "Axis", {0}, TensorShape({}), ids_node)->name());
+    (*concat->mutable_attr())["N"].set_i(num_lookups);
+    (*concat->mutable_attr())["T"].set_type(index_type);
+    (*concat->mutable_attr())["Tidx"].set_type(DT_INT32);
+    all_ids = concat->name();
+  }
+  NodeDef* unique = AddNode(prefix + "UniqueIds", "Unique", ids_device);
+  unique->add_input(all_ids);
+  (*unique->mutable_attr())["T"].set_type(index_type);
+  (*unique->mutable_attr())["out_idx"].set_type(DT_INT32);
+
+  // The only remote fetch: one row per unique id.
+  NodeDef* rows = AddNode(prefix + "UniqueRows", lookup.op(), lookup.device());
+  *rows->mutable_attr() = lookup.attr();
+  for (int j = 0; j < NumNonControlInputs(lookup); ++j) {
+    rows->add_input(j == 1 ? unique->name() : lookup.input(j));
+  }
+
+  // The position of each id among the unique ids, split per lookup.
+  std::vector<string> positions;
+  if (num_lookups == 1) {
+    positions.push_back(strings::StrCat(unique->name(), ":1"));
+  } else {
+    std::vector<string> sizes;
+    for (const string& flat : flat_ids) {
+      NodeDef* size = AddNode(prefix + "NumIds", "Size", ids_device);
+      size->add_input(flat);
+      (*size->mutable_attr())["T"].set_type(index_type);
+      (*size->mutable_attr())["out_type"].set_type(DT_INT32);
+      sizes.push_back(size->name());
+    }
+    NodeDef* pack = AddNode(prefix + "AllNumIds", "Pack", ids_device);
+    for (const string& size : sizes) {
+      pack->add_input(size);
+    }
+    (*pack->mutable_attr())["N"].set_i(num_lookups);
+    (*pack->mutable_attr())["T"].set_type(DT_INT32);
+    (*pack->mutable_attr())["axis"].set_i(0);
+    NodeDef* split = AddNode(prefix + "Positions", "SplitV", ids_device);
+    split->add_input(strings::StrCat(unique->name(), ":1"));
+    split->add_input(pack->name());
+    split->add_input(
+        AddIntConst(prefix + "SplitAxis", {0}, TensorShape({}), ids_node)
+            ->name());
+    (*split->mutable_attr())["num_split"].set_i(num_lookups);
+    (*split->mutable_attr())["T"].set_type(DT_INT32);
+    (*split->mutable_attr())["Tlen"].set_type(DT_INT32);
+    for (int k = 0; k < num_lookups; ++k) {
+      positions.push_back(k == 0 ? split->name()
+                                 : strings::StrCat(split->name(), ":", k));
+    }
+  }
+
+  // Each lookup becomes a local Gather of the unique rows, with the shape of
+  // its ids. It keeps its name and control inputs, so its consumers are
+  // unchanged.
+  for (int k = 0; k < num_lookups; ++k) {
+    NodeDef* shape = AddNode(prefix + "IdsShape", "Shape", ids_device);
+    shape->add_input(ids[k]);
+    (*shape->mutable_attr())["T"].set_type(index_type);
+    (*shape->mutable_attr())["out_type"].set_type(DT_INT32);
+    NodeDef* reshaped = AddNode(prefix + "IdsPositions", "Reshape", ids_device);
+    reshaped->add_input(positions[k]);
+    reshaped->add_input(shape->name());
+    (*reshaped->mutable_attr())["T"].set_type(DT_INT32);
+    (*reshaped->mutable_attr())["Tshape"].set_type(DT_INT32);
+
+    NodeDef* node = graph_->mutable_node(group[k]);
+    std::vector<string> control_inputs;
+    for (int j = NumNonControlInputs(*node); j < node->input_size(); ++j) {
+      control_inputs.push_back(node->input(j));
+    }
+    node->set_op("Gather");
+    node->set_device(ids_device);
+    node->clear_input();
+    node->add_input(rows->name());
+    node->add_input(reshaped->name());
+    for (const string& control_input : control_inputs) {
+      node->add_input(control_input);
+    }
+    node->clear_attr();
+    (*node->mutable_attr())["Tparams"].set_type(params_type);
+    (*node->mutable_attr())["Tindices"].set_type(DT_INT32);
+    (*node->mutable_attr())["validate_indices"].set_b(true);
+  }
+}
+
+Status EmbeddingLookupOptimizerImpl::Optimize() {
+  const int num_nodes = graph_->node_size();
+  fanouts_.resize(num_nodes);
+  // The lookups in different loop frames or branches of a conditional can't
+  // be merged.
+  bool has_control_flow = false;
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph_->node(i);
+    node_index_[node.name()] = i;
+    if (IsEnter(node) || IsSwitch(node)) {
+      has_control_flow = true;
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : graph_->node(i).input()) {
+      auto it = node_index_.find(NodeName(input));
+      if (it != node_index_.end()) {
+        fanouts_[it->second].push_back(i);
+      }
+    }
+  }
+
+  // Groups the lookups of the same table, by the same op, whose ids come from
+  // the same device.
+  std::map<string, std::vector<int>> tables;
+  int num_lookups = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph_->node(i);
+    if (!IsRemoteLookup(node)) continue;
+    const NodeDef& ids = graph_->node(node_index_[NodeName(node.input(1))]);
+    string key = strings::StrCat(node.op(), "|", node.input(0), "|",
+                                 node.device(), "|", ids.device(), "|",
+                                 GetDataTypeFromAttr(node, "Tindices"));
+    if (node.op() == "GatherV2") {
+      strings::StrAppend(&key, "|", node.input(2));
+    }
+    tables[key].push_back(i);
+    ++num_lookups;
+  }
+  if (num_lookups == 0) {
+    return Status::OK();
+  }
+
+  std::vector<std::vector<int>> groups;
+  for (const auto& table : tables) {
+    const std::vector<int>& lookups = table.second;
+    if (lookups.size() == 1 || has_control_flow) {
+      for (int lookup : lookups) {
+        groups.push_back({lookup});
+      }
+      continue;
+    }
+    // A lookup can only be merged with the others if its ids don't depend on
+    // any of them, and if it has no control inputs that could.
+    const std::vector<bool> reached = ReachableFrom(lookups);
+    std::vector<int> merged;
+    for (int lookup : lookups) {
+      const NodeDef& node = graph_->node(lookup);
+      if (HasControlInputs(node) ||
+          reached[node_index_[NodeName(node.input(1))]]) {
+        groups.push_back({lookup});
+      } else {
+        merged.push_back(lookup);
+      }
+    }
+    if (!merged.empty()) {
+      groups.push_back(merged);
+    }
+  }
+
+  VLOG(1) << "Deduplicating the ids of " << num_lookups
+          << " embedding lookups in " << groups.size() << " remote gathers";
+  for (const std::vector<int>& group : groups) {
+    Rewrite(group);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status EmbeddingLookupOptimizer::Optimize(Cluster* cluster,
+                                          const GrapplerItem& item,
+                                          GraphDef* output) {
+  *output = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  EmbeddingLookupOptimizerImpl impl(nodes_to_preserve, output);
+  Status status = impl.Optimize();
+  if (!status.ok()) {
+    *output = item.graph;
+  }
+  return status;
+}
+
+void EmbeddingLookupOptimizer::Feedback(Cluster* cluster,
+                                        const GrapplerItem& item,
+                                        const GraphDef& optimize_output,
+                                        double result) {
+  // Nothing to do for EmbeddingLookupOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Deduplicates the ids of the embedding lookups that fetch rows from another
+// device, e.g. from a parameter server. The ids are made unique with a Unique
+// op on their own device, only the unique rows are gathered remotely, and the
+// result is expanded back to one row per id next to the ids. The lookups of
+// the same table from the same device are merged into a single remote Gather
+// of the union of their ids.
+class EmbeddingLookupOptimizer : public GraphOptimizer {
+ public:
+  EmbeddingLookupOptimizer() {}
+
+  ~EmbeddingLookupOptimizer() override {}
+
+  string name() const override { return "embedding_lookup_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_OPTIMIZER_H_
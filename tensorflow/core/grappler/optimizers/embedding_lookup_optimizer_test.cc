@@ -0,0 +1,143 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_optimizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kPs[] = "/job:ps/replica:0/task:0/device:CPU:0";
+const char kWorker[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+class EmbeddingLookupOptimizerTest : public GrapplerTest {};
+
+// The local session only has one device.
+GraphDef ClearDevices(const GraphDef& graph) {
+  GraphDef result = graph;
+  for (NodeDef& node : *result.mutable_node()) {
+    node.clear_device();
+  }
+  return result;
+}
+
+TEST_F(EmbeddingLookupOptimizerTest, DeduplicateAndMergeRemoteLookups) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope ps = s.WithDevice(kPs);
+  tensorflow::Scope worker = s.WithDevice(kWorker);
+  Output params = ops::Const(ps.WithOpName("params"),
+                             {{0.0f, 1.0f}, {2.0f, 3.0f}, {4.0f, 5.0f}});
+  Output ids1 = ops::Placeholder(worker.WithOpName("ids1"), DT_INT32);
+  Output ids2 = ops::Placeholder(worker.WithOpName("ids2"), DT_INT32);
+  Output lookup1 = ops::Gather(ps.WithOpName("lookup1"), params, ids1);
+  Output lookup2 = ops::Gather(ps.WithOpName("lookup2"), params, ids2);
+  Output local_ids = ops::Const(ps.WithOpName("local_ids"), {1, 1});
+  Output local = ops::Gather(ps.WithOpName("local"), params, local_ids);
+  Output out1 = ops::Identity(worker.WithOpName("out1"), lookup1);
+  Output out2 = ops::Identity(worker.WithOpName("out2"), lookup2);
+  Output out3 = ops::Identity(worker.WithOpName("out3"), local);
+  GrapplerItem item;
+  item.fetch = {"out1", "out2", "out3"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  EmbeddingLookupOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(1, CountOpNodes(output, "Unique"));
+  NodeMap node_map(&output);
+  const NodeDef* unique = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Unique") unique = &node;
+  }
+  ASSERT_NE(nullptr, unique);
+  EXPECT_EQ(kWorker, unique->device());
+  // A single remote Gather fetches the unique rows.
+  int num_remote_gathers = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Gather" && node.device() == kPs &&
+        node.input(1) == unique->name()) {
+      ++num_remote_gathers;
+    }
+  }
+  EXPECT_EQ(1, num_remote_gathers);
+  for (const string& name : {"lookup1", "lookup2"}) {
+    const NodeDef* lookup = node_map.GetNode(name);
+    ASSERT_NE(nullptr, lookup);
+    EXPECT_EQ("Gather", lookup->op());
+    EXPECT_EQ(kWorker, lookup->device());
+  }
+  const NodeDef* unchanged = node_map.GetNode("local");
+  ASSERT_NE(nullptr, unchanged);
+  EXPECT_EQ(kPs, unchanged->device());
+  EXPECT_EQ("local_ids", unchanged->input(1));
+
+  Tensor ids1_t(DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int>(&ids1_t, {0, 2, 2, 0});
+  Tensor ids2_t(DT_INT32, TensorShape({3}));
+  test::FillValues<int>(&ids2_t, {1, 1, 2});
+  std::vector<std::pair<string, Tensor>> feed = {{"ids1", ids1_t},
+                                                 {"ids2", ids2_t}};
+  auto expected = EvaluateNodes(ClearDevices(item.graph), item.fetch, feed);
+  auto tensors = EvaluateNodes(ClearDevices(output), item.fetch, feed);
+  ASSERT_EQ(expected.size(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<float>(expected[i], tensors[i]);
+  }
+}
+
+TEST_F(EmbeddingLookupOptimizerTest, DontMergeDependentLookups) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope ps = s.WithDevice(kPs);
+  tensorflow::Scope worker = s.WithDevice(kWorker);
+  Output params = ops::Const(ps.WithOpName("params"), {0.0f, 1.0f, 2.0f});
+  Output ids1 = ops::Placeholder(worker.WithOpName("ids1"), DT_INT32);
+  Output lookup1 = ops::Gather(ps.WithOpName("lookup1"), params, ids1);
+  // The ids of the second lookup are computed from the first one.
+  Output ids2 = ops::Cast(worker.WithOpName("ids2"), lookup1, DT_INT32);
+  Output lookup2 = ops::Gather(ps.WithOpName("lookup2"), params, ids2);
+  Output out = ops::Identity(worker.WithOpName("out"), lookup2);
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  EmbeddingLookupOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(2, CountOpNodes(output, "Unique"));
+  EXPECT_EQ(0, CountOpNodes(output, "ConcatV2"));
+
+  Tensor ids1_t(DT_INT32, TensorShape({4}));
+  test::FillValues<int>(&ids1_t, {2, 0, 2, 1});
+  std::vector<std::pair<string, Tensor>> feed = {{"ids1", ids1_t}};
+  auto expected = EvaluateNodes(ClearDevices(item.graph), item.fetch, feed);
+  auto tensors = EvaluateNodes(ClearDevices(output), item.fetch, feed);
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(expected[0], tensors[0]);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
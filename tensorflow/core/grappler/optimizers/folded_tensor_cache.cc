@@ -0,0 +1,107 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/folded_tensor_cache.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Folded tensors are also kept in the graphs as constants, so keep the cache
+// small compared to the graphs.
+constexpr int64 kGlobalCacheCapacityBytes = 64LL << 20;
+
+void AppendFingerprint(const Fprint128& fp, string* key) {
+  key->append(reinterpret_cast<const char*>(&fp.low64), sizeof(fp.low64));
+  key->append(reinterpret_cast<const char*>(&fp.high64), sizeof(fp.high64));
+}
+
+}  // namespace
+
+FoldedTensorCache* FoldedTensorCache::Global() {
+  static FoldedTensorCache* cache =
+      new FoldedTensorCache(kGlobalCacheCapacityBytes);
+  return cache;
+}
+
+Fprint128 FoldedTensorCache::Key(
+    const NodeDef& node, const std::vector<const TensorProto*>& inputs) {
+  // The name, inputs and device of the node don't change its outputs.
+  NodeDef op_and_attrs;
+  op_and_attrs.set_op(node.op());
+  *op_and_attrs.mutable_attr() = node.attr();
+  string serialized;
+  SerializeToStringDeterministic(op_and_attrs, &serialized);
+
+  string key;
+  AppendFingerprint(Fingerprint128(serialized), &key);
+  for (const TensorProto* input : inputs) {
+    SerializeToStringDeterministic(*input, &serialized);
+    AppendFingerprint(Fingerprint128(serialized), &key);
+  }
+  return Fingerprint128(key);
+}
+
+bool FoldedTensorCache::Lookup(const Fprint128& key,
+                               std::vector<Tensor>* outputs) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+  *outputs = it->second.outputs;
+  return true;
+}
+
+void FoldedTensorCache::Insert(const Fprint128& key,
+                               const std::vector<Tensor>& outputs) {
+  int64 bytes = 0;
+  for (const Tensor& output : outputs) {
+    bytes += output.TotalBytes();
+  }
+  if (bytes > capacity_bytes_) {
+    return;
+  }
+
+  mutex_lock l(mu_);
+  if (entries_.count(key) > 0) {
+    return;
+  }
+  while (size_bytes_ + bytes > capacity_bytes_) {
+    auto it = entries_.find(lru_.back());
+    size_bytes_ -= it->second.bytes;
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.outputs = outputs;
+  entry.bytes = bytes;
+  entry.lru_pos = lru_.begin();
+  size_bytes_ += bytes;
+}
+
+int64 FoldedTensorCache::size_bytes() const {
+  mutex_lock l(mu_);
+  return size_bytes_;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_FOLDED_TENSOR_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_FOLDED_TENSOR_CACHE_H_
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A cache of the outputs of the nodes evaluated by constant folding, keyed by
+// the op and attributes of the node and the values of its inputs. The same
+// constant subgraphs are folded again by every iteration of the meta
+// optimizer, and by every session created for the same graph, so the global
+// cache is shared by all of them. The cache is bounded by the total size of
+// the tensors it holds, and evicts the least recently used entries first.
+class FoldedTensorCache {
+ public:
+  explicit FoldedTensorCache(int64 capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // The cache used by ConstantFolding.
+  static FoldedTensorCache* Global();
+
+  // Returns the key of the evaluation of 'node' with the given inputs.
+  static Fprint128 Key(const NodeDef& node,
+                       const std::vector<const TensorProto*>& inputs);
+
+  // Fills 'outputs' and returns true if the outputs for 'key' are cached.
+  bool Lookup(const Fprint128& key, std::vector<Tensor>* outputs);
+
+  // Caches the outputs for 'key', unless they are larger than the whole
+  // cache.
+  void Insert(const Fprint128& key, const std::vector<Tensor>& outputs);
+
+  int64 size_bytes() const;
+
+ private:
+  struct Entry {
+    std::vector<Tensor> outputs;
+    int64 bytes;
+    // The position of the key in lru_.
+    std::list<Fprint128>::iterator lru_pos;
+  };
+
+  const int64 capacity_bytes_;
+  mutable mutex mu_;
+  int64 size_bytes_ GUARDED_BY(mu_) = 0;
+  // The keys of the entries, the most recently used first.
+  std::list<Fprint128> lru_ GUARDED_BY(mu_);
+  std::unordered_map<Fprint128, Entry, Fprint128Hasher> entries_
+      GUARDED_BY(mu_);
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_FOLDED_TENSOR_CACHE_H_
@@ -0,0 +1,91 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/folded_tensor_cache.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+Tensor MakeTensor(float value, int64 num_elements) {
+  Tensor t(DT_FLOAT, TensorShape({num_elements}));
+  t.flat<float>().setConstant(value);
+  return t;
+}
+
+TEST(FoldedTensorCacheTest, Key) {
+  NodeDef node;
+  node.set_name("a");
+  node.set_op("Add");
+  node.add_input("x");
+  (*node.mutable_attr())["T"].set_type(DT_FLOAT);
+  TensorProto x;
+  MakeTensor(1.0f, 4).AsProtoTensorContent(&x);
+  TensorProto y;
+  MakeTensor(2.0f, 4).AsProtoTensorContent(&y);
+
+  const Fprint128 key = FoldedTensorCache::Key(node, {&x, &y});
+  // The name and inputs of the node don't matter.
+  NodeDef renamed = node;
+  renamed.set_name("b");
+  renamed.set_input(0, "z");
+  EXPECT_EQ(key, FoldedTensorCache::Key(renamed, {&x, &y}));
+
+  // The op, attributes and input values do.
+  EXPECT_FALSE(key == FoldedTensorCache::Key(node, {&y, &x}));
+  NodeDef other_op = node;
+  other_op.set_op("Sub");
+  EXPECT_FALSE(key == FoldedTensorCache::Key(other_op, {&x, &y}));
+  NodeDef other_attr = node;
+  (*other_attr.mutable_attr())["T"].set_type(DT_DOUBLE);
+  EXPECT_FALSE(key == FoldedTensorCache::Key(other_attr, {&x, &y}));
+}
+
+TEST(FoldedTensorCacheTest, LookupAndEvict) {
+  // Room for two tensors of 4 floats.
+  FoldedTensorCache cache(32);
+  const Fprint128 k1 = {1, 1};
+  const Fprint128 k2 = {2, 2};
+  const Fprint128 k3 = {3, 3};
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache.Lookup(k1, &outputs));
+
+  cache.Insert(k1, {MakeTensor(1.0f, 4)});
+  cache.Insert(k2, {MakeTensor(2.0f, 4)});
+  EXPECT_EQ(32, cache.size_bytes());
+  ASSERT_TRUE(cache.Lookup(k1, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(MakeTensor(1.0f, 4), outputs[0]);
+
+  // k2 is now the least recently used entry.
+  cache.Insert(k3, {MakeTensor(3.0f, 4)});
+  EXPECT_EQ(32, cache.size_bytes());
+  EXPECT_TRUE(cache.Lookup(k1, &outputs));
+  EXPECT_FALSE(cache.Lookup(k2, &outputs));
+  EXPECT_TRUE(cache.Lookup(k3, &outputs));
+
+  // Too large to be cached at all.
+  cache.Insert(k2, {MakeTensor(2.0f, 16)});
+  EXPECT_FALSE(cache.Lookup(k2, &outputs));
+  EXPECT_EQ(32, cache.size_bytes());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
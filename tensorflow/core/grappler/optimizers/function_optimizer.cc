@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 
+#include <algorithm>
 #include <unordered_map>
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -152,12 +153,15 @@ class FakeCPUDevice : public Device {
 
 class FunctionOptimizerContext {
  public:
-  explicit FunctionOptimizerContext(RewriterConfig::Toggle opt_level,
-                                    const GrapplerItem& item)
+  FunctionOptimizerContext(RewriterConfig::Toggle opt_level,
+                           int max_always_inlined_size,
+                           int64 inlining_growth_budget,
+                           const GrapplerItem& item)
       : graph_version_(item.graph.versions().producer()),
         function_library_(OpRegistry::Global(), item.graph.library()) {
     InitializeTrulyConstNodes(item);
-    InitializeInlinedFunctions(opt_level, item);
+    InitializeInlinedFunctions(opt_level, max_always_inlined_size,
+                               inlining_growth_budget, item);
   }
 
   const FunctionLibraryDefinition& function_library() const {
@@ -214,10 +218,30 @@ class FunctionOptimizerContext {
     }
   }
 
+  // Picks the functions to inline. In aggressive mode all of them are
+  // inlined, even the ones marked noinline. Otherwise small functions and the
+  // ones called once are inlined, and the others only while the graph growth
+  // they cause fits in `inlining_growth_budget` nodes: inlining large
+  // functions called from many places would blow up the graph.
   void InitializeInlinedFunctions(RewriterConfig::Toggle opt_level,
+                                  int max_always_inlined_size,
+                                  int64 inlining_growth_budget,
                                   const GrapplerItem& item) {
     bool aggressive = opt_level == RewriterConfig::AGGRESSIVE;
 
+    // Count the call sites of each function, in the graph and in the bodies
+    // of the other functions.
+    std::unordered_map<string, int> num_calls;
+    for (const NodeDef& node : item.graph.node()) ++num_calls[node.op()];
+    for (const FunctionDef& func : item.graph.library().function()) {
+      for (const NodeDef& node : func.node_def()) ++num_calls[node.op()];
+    }
+
+    // Inlining candidates that don't fit in the always inlined set, with the
+    // number of nodes inlining them everywhere would add to the graph.
+    std::vector<std::pair<int64, const FunctionDef*>> costly_functions;
+    std::unordered_map<string, int64> inlined_sizes;
+
     for (const FunctionDef& func : item.graph.library().function()) {
       // Can't create IdentityN nodes with no input or output: skip these
       // functions for now.
@@ -228,10 +252,56 @@ class FunctionOptimizerContext {
       bool marked_noinline = MarkedNoInline(func);
       bool marked_specialized = MarkedSpecialized(func);
 
-      if (!marked_specialized && (!marked_noinline || aggressive)) {
-        inlined_functions_[func.signature().name()] = &func;
+      if (marked_specialized || (marked_noinline && !aggressive)) continue;
+
+      const string& name = func.signature().name();
+      const int64 size = InlinedSize(func, &inlined_sizes);
+      const int calls = gtl::FindWithDefault(num_calls, name, 0);
+      if (aggressive || size <= max_always_inlined_size || calls <= 1) {
+        inlined_functions_[name] = &func;
+      } else {
+        costly_functions.emplace_back(size * (calls - 1), &func);
+      }
+    }
+
+    // Spend the growth budget on the functions that are cheapest to inline.
+    std::sort(costly_functions.begin(), costly_functions.end(),
+              [](const std::pair<int64, const FunctionDef*>& a,
+                 const std::pair<int64, const FunctionDef*>& b) {
+                if (a.first != b.first) return a.first < b.first;
+                return a.second->signature().name() <
+                       b.second->signature().name();
+              });
+    for (const auto& costly : costly_functions) {
+      const string& name = costly.second->signature().name();
+      if (costly.first > inlining_growth_budget) {
+        VLOG(2) << "Do not inline function " << name << ": it would add "
+                << costly.first << " nodes to the graph, with a budget of "
+                << inlining_growth_budget;
+        continue;
       }
+      inlining_growth_budget -= costly.first;
+      inlined_functions_[name] = costly.second;
+    }
+  }
+
+  // Returns the number of nodes in the body of `func`, with the calls to the
+  // other library functions replaced by their own inlined size.
+  int64 InlinedSize(const FunctionDef& func,
+                    std::unordered_map<string, int64>* inlined_sizes) const {
+    const string& name = func.signature().name();
+    auto it = inlined_sizes->find(name);
+    if (it != inlined_sizes->end()) return it->second;
+
+    // Recursive calls are counted as a single node.
+    (*inlined_sizes)[name] = 1;
+    int64 size = 0;
+    for (const NodeDef& node : func.node_def()) {
+      const FunctionDef* callee = function_library_.Find(node.op());
+      size += callee != nullptr ? InlinedSize(*callee, inlined_sizes) : 1;
     }
+    (*inlined_sizes)[name] = size;
+    return size;
   }
 
   void InitializeFunctionLibraryRuntime() {
@@ -769,7 +839,13 @@ Status FunctionOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     return Status::OK();
   }
 
-  FunctionOptimizerContext ctx(opt_level_, item);
+  const int64 inlining_growth_budget = std::max<int64>(
+      options_.min_inlining_growth_budget,
+      static_cast<int64>(options_.inlining_growth_ratio *
+                         item.graph.node_size()));
+  FunctionOptimizerContext ctx(opt_level_,
+                               options_.max_always_inlined_function_size,
+                               inlining_growth_budget, item);
 
   bool inline_gradients = options_.enable_symbolic_gradient_inlining;
   bool inline_func = options_.enable_function_inlining;
@@ -46,6 +46,16 @@ class FunctionOptimizer : public GraphOptimizer {
     bool enable_function_specialization = true;
     bool enable_symbolic_gradient_inlining = true;
     bool enable_trim_function_library = true;
+    // Functions whose body, with the functions it calls expanded, has at most
+    // this many nodes are always inlined.
+    int max_always_inlined_function_size = 16;
+    // Larger functions called from several places are inlined, smallest
+    // growth first, as long as the nodes they add to the graph fit in a
+    // budget of `inlining_growth_ratio` times the graph size, and at least
+    // `min_inlining_growth_budget` nodes. Functions called once are always
+    // inlined, since that does not grow the graph.
+    int min_inlining_growth_budget = 1024;
+    float inlining_growth_ratio = 1.0f;
   };
 
   RewriterConfig::Toggle opt_level_;
@@ -34,6 +34,16 @@ class FunctionOptimizerTest : public GrapplerTest {
   void DisableFunctionSpecialization(FunctionOptimizer* optimizer) {
     optimizer->options_.enable_function_specialization = false;
   }
+
+  void SetInliningBudget(FunctionOptimizer* optimizer,
+                         int max_always_inlined_function_size,
+                         int min_inlining_growth_budget) {
+    optimizer->options_.max_always_inlined_function_size =
+        max_always_inlined_function_size;
+    optimizer->options_.min_inlining_growth_budget =
+        min_inlining_growth_budget;
+    optimizer->options_.inlining_growth_ratio = 0.0f;
+  }
 };
 
 TEST_F(FunctionOptimizerTest, InlineFunction_SimpleFunction) {
@@ -542,6 +552,87 @@ TEST_F(FunctionOptimizerTest, InlineFunction_FunctionWithNestedFunctionCall) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(FunctionOptimizerTest, InlineFunction_RespectsGrowthBudget) {
+  using test::function::NDef;
+
+  // Build a graph calling XTimesTwo, whose body has 3 nodes, three times:
+  // inlining it everywhere adds 3 * (3 - 1) = 6 nodes to the graph.
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("y1", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y2", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y3", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice)},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+
+  const auto count_calls = [](const GraphDef& graph) {
+    int calls = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == "XTimesTwo") ++calls;
+    }
+    return calls;
+  };
+
+  for (int budget : {5, 6}) {
+    FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+    DisableFunctionSpecialization(&optimizer);
+    SetInliningBudget(&optimizer, /*max_always_inlined_function_size=*/2,
+                      budget);
+
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_EQ(budget < 6 ? 3 : 0, count_calls(output)) << "budget=" << budget;
+  }
+
+  // Small functions are inlined regardless of the budget.
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+  DisableFunctionSpecialization(&optimizer);
+  SetInliningBudget(&optimizer, /*max_always_inlined_function_size=*/3,
+                    /*min_inlining_growth_budget=*/0);
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(0, count_calls(output));
+}
+
+TEST_F(FunctionOptimizerTest, InlineFunction_SingleCallSiteIgnoresBudget) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+  DisableFunctionSpecialization(&optimizer);
+  SetInliningBudget(&optimizer, /*max_always_inlined_function_size=*/0,
+                    /*min_inlining_growth_budget=*/0);
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("y", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("z", "Identity", {"y"}, {{"T", DT_FLOAT}}, kDevice)},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("XTimesTwo", node.op()) << node.name();
+  }
+  EXPECT_EQ(0, output.library().function_size());
+
+  Tensor pi = test::AsScalar<float>(3.14f);
+  item.fetch = {"z"};
+  item.feed.emplace_back("x", pi);
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized(item, std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(FunctionOptimizerTest, InlineSymbolicGradient_TestFunc) {
   FunctionOptimizer optimizer(RewriterConfig::ON);
 
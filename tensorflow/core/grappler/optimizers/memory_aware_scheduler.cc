@@ -0,0 +1,248 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/memory_aware_scheduler.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Also read by the executor, see common_runtime/executor.cc.
+const char kSchedulingPriorityAttr[] = "_scheduling_priority";
+
+namespace {
+
+int64 EstimateSize(const OpInfo::TensorProperties& t) {
+  const TensorShapeProto& shape = t.shape();
+  if (shape.unknown_rank()) {
+    return 0;
+  }
+  // Assume that the unknown dimensions are at least one.
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    num_elements *= std::max<int64>(dim.size(), 1);
+  }
+  return num_elements * DataTypeSize(BaseType(t.dtype()));
+}
+
+// A tensor read by a node, and the number of inputs of the node it feeds.
+struct TensorUse {
+  int producer;
+  int port;
+  int count;
+};
+
+class ListScheduler {
+ public:
+  ListScheduler(const GraphDef& graph, const GraphProperties& properties)
+      : graph_(graph), properties_(properties) {}
+
+  // Returns false if the graph has a cycle other than through loops.
+  bool Schedule(std::vector<int>* order);
+
+ private:
+  void Init();
+  // The estimated change of memory usage caused by running the node.
+  int64 Score(int node) const;
+  void MarkReady(int node);
+  void Rescore(int node);
+
+  const GraphDef& graph_;
+  const GraphProperties& properties_;
+
+  // The size of each output of each node.
+  std::vector<std::vector<int64>> output_sizes_;
+  // The tensors read by each node.
+  std::vector<std::vector<TensorUse>> uses_;
+  // The number of reads of each output of each node that are not scheduled
+  // yet.
+  std::vector<std::vector<int>> remaining_reads_;
+  // The distinct readers of each output of each node.
+  std::vector<std::vector<std::vector<int>>> readers_;
+  // The nodes that each node feeds, through a data or control input.
+  std::vector<std::vector<int>> fanouts_;
+  std::vector<int> num_pending_inputs_;
+
+  // The ready nodes, ordered by score and then by their position in the
+  // graph.
+  std::set<std::pair<int64, int>> ready_;
+  std::vector<int64> score_;
+  std::vector<bool> is_ready_;
+};
+
+void ListScheduler::Init() {
+  const int num_nodes = graph_.node_size();
+  std::unordered_map<string, int> index;
+  for (int i = 0; i < num_nodes; ++i) {
+    index[graph_.node(i).name()] = i;
+  }
+
+  output_sizes_.resize(num_nodes);
+  remaining_reads_.resize(num_nodes);
+  readers_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto& outputs =
+        properties_.GetOutputProperties(graph_.node(i).name());
+    for (const auto& output : outputs) {
+      output_sizes_[i].push_back(EstimateSize(output));
+    }
+    remaining_reads_[i].resize(outputs.size(), 0);
+    readers_[i].resize(outputs.size());
+  }
+
+  uses_.resize(num_nodes);
+  fanouts_.resize(num_nodes);
+  num_pending_inputs_.resize(num_nodes, 0);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph_.node(i);
+    for (const string& input : node.input()) {
+      int port;
+      const string input_name = ParseNodeName(input, &port);
+      auto it = index.find(input_name);
+      if (it == index.end()) continue;
+      const int producer = it->second;
+      // Ignore the back edges of loops.
+      if (IsMerge(node) && IsNextIteration(graph_.node(producer))) continue;
+      fanouts_[producer].push_back(i);
+      ++num_pending_inputs_[i];
+      if (port < 0 ||
+          port >= static_cast<int>(remaining_reads_[producer].size())) {
+        continue;
+      }
+      ++remaining_reads_[producer][port];
+      bool found = false;
+      for (TensorUse& use : uses_[i]) {
+        if (use.producer == producer && use.port == port) {
+          ++use.count;
+          found = true;
+        }
+      }
+      if (!found) {
+        uses_[i].push_back({producer, port, 1});
+        readers_[producer][port].push_back(i);
+      }
+    }
+  }
+  score_.resize(num_nodes, 0);
+  is_ready_.resize(num_nodes, false);
+}
+
+int64 ListScheduler::Score(int node) const {
+  int64 score = 0;
+  for (int64 size : output_sizes_[node]) {
+    score += size;
+  }
+  for (const TensorUse& use : uses_[node]) {
+    if (remaining_reads_[use.producer][use.port] == use.count) {
+      score -= output_sizes_[use.producer][use.port];
+    }
+  }
+  return score;
+}
+
+void ListScheduler::MarkReady(int node) {
+  is_ready_[node] = true;
+  score_[node] = Score(node);
+  ready_.emplace(score_[node], node);
+}
+
+void ListScheduler::Rescore(int node) {
+  ready_.erase(std::make_pair(score_[node], node));
+  score_[node] = Score(node);
+  ready_.emplace(score_[node], node);
+}
+
+bool ListScheduler::Schedule(std::vector<int>* order) {
+  Init();
+  const int num_nodes = graph_.node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    if (num_pending_inputs_[i] == 0) {
+      MarkReady(i);
+    }
+  }
+  order->clear();
+  order->reserve(num_nodes);
+  while (!ready_.empty()) {
+    const int node = ready_.begin()->second;
+    ready_.erase(ready_.begin());
+    is_ready_[node] = false;
+    order->push_back(node);
+
+    // Running the node may make the remaining reader of one of its inputs its
+    // last reader, which then frees it.
+    for (const TensorUse& use : uses_[node]) {
+      int& remaining = remaining_reads_[use.producer][use.port];
+      remaining -= use.count;
+      if (remaining == 0) continue;
+      for (int reader : readers_[use.producer][use.port]) {
+        if (is_ready_[reader]) {
+          Rescore(reader);
+        }
+      }
+    }
+    for (int fanout : fanouts_[node]) {
+      if (--num_pending_inputs_[fanout] == 0) {
+        MarkReady(fanout);
+      }
+    }
+  }
+  return order->size() == static_cast<size_t>(num_nodes);
+}
+
+}  // namespace
+
+Status MemoryAwareScheduler::Optimize(Cluster* cluster,
+                                      const GrapplerItem& item,
+                                      GraphDef* output) {
+  *output = item.graph;
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+
+  std::vector<int> order;
+  ListScheduler scheduler(item.graph, properties);
+  if (!scheduler.Schedule(&order)) {
+    return errors::InvalidArgument(
+        "The graph has a cycle, it can't be scheduled");
+  }
+  for (int i = 0; i < static_cast<int>(order.size()); ++i) {
+    (*output->mutable_node(order[i])->mutable_attr())[kSchedulingPriorityAttr]
+        .set_i(i);
+  }
+  return Status::OK();
+}
+
+void MemoryAwareScheduler::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                    const GraphDef& optimize_output,
+                                    double result) {
+  // Nothing to do for MemoryAwareScheduler.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
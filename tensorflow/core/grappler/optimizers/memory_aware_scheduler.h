@@ -0,0 +1,53 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_AWARE_SCHEDULER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_AWARE_SCHEDULER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// The attribute in which the scheduling priority of a node is recorded. The
+// executor runs the nodes that become ready together in increasing order of
+// priority.
+extern const char kSchedulingPriorityAttr[];
+
+// Computes a topological order of the graph that keeps the peak memory usage
+// low, and records it as the scheduling priority of each node. This is a
+// greedy list scheduler: among the nodes that are ready, it picks the one that
+// increases the memory usage the least, i.e. whose outputs are the smallest
+// compared to the inputs that it is the last consumer of. Large tensors are
+// then consumed soon after they are produced instead of piling up.
+class MemoryAwareScheduler : public GraphOptimizer {
+ public:
+  MemoryAwareScheduler() {}
+
+  ~MemoryAwareScheduler() override {}
+
+  string name() const override { return "memory_aware_scheduler"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_AWARE_SCHEDULER_H_
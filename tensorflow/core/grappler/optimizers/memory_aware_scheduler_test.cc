@@ -0,0 +1,102 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/memory_aware_scheduler.h"
+
+#include <unordered_map>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+std::unordered_map<string, int64> GetPriorities(const GraphDef& graph) {
+  std::unordered_map<string, int64> priorities;
+  for (const NodeDef& node : graph.node()) {
+    auto it = node.attr().find(kSchedulingPriorityAttr);
+    if (it != node.attr().end()) {
+      priorities[node.name()] = it->second.i();
+    }
+  }
+  return priorities;
+}
+
+TEST(MemoryAwareSchedulerTest, ScheduleIsTopological) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Placeholder(s.WithOpName("a"), DT_FLOAT,
+                              ops::Placeholder::Shape({10, 10}));
+  Output b = ops::Square(s.WithOpName("b"), a);
+  Output c = ops::Sqrt(s.WithOpName("c"), a);
+  Output d = ops::Add(s.WithOpName("d"), b, c);
+  Output e =
+      ops::Identity(s.WithOpName("e").WithControlDependencies({b.op()}), d);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  MemoryAwareScheduler optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  std::unordered_map<string, int64> priorities = GetPriorities(output);
+  EXPECT_EQ(output.node_size(), static_cast<int>(priorities.size()));
+  for (const NodeDef& node : output.node()) {
+    for (const string& input : node.input()) {
+      EXPECT_LT(priorities[NodeName(input)], priorities[node.name()])
+          << input << " -> " << node.name();
+    }
+  }
+}
+
+TEST(MemoryAwareSchedulerTest, ConsumeLargeTensorsFirst) {
+  // Two independent branches that each produce a large activation and reduce
+  // it to a scalar. The first activation must be reduced before the second
+  // branch starts, so that only one of them is live at any time.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output axes = ops::Const(s.WithOpName("axes"), {0, 1}, {2});
+  Output x1 = ops::Placeholder(s.WithOpName("x1"), DT_FLOAT,
+                               ops::Placeholder::Shape({1000, 1000}));
+  Output x2 = ops::Placeholder(s.WithOpName("x2"), DT_FLOAT,
+                               ops::Placeholder::Shape({1000, 1000}));
+  Output big1 = ops::Square(s.WithOpName("big1"), x1);
+  Output big2 = ops::Square(s.WithOpName("big2"), x2);
+  Output sum1 = ops::Sum(s.WithOpName("sum1"), big1, axes);
+  Output sum2 = ops::Sum(s.WithOpName("sum2"), big2, axes);
+  Output total = ops::Add(s.WithOpName("total"), sum1, sum2);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  MemoryAwareScheduler optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  std::unordered_map<string, int64> priorities = GetPriorities(output);
+  EXPECT_LT(priorities["x1"], priorities["big1"]);
+  EXPECT_LT(priorities["big1"], priorities["sum1"]);
+  EXPECT_LT(priorities["sum1"], priorities["x2"]);
+  EXPECT_LT(priorities["x2"], priorities["big2"]);
+  EXPECT_LT(priorities["big2"], priorities["sum2"]);
+  EXPECT_LT(priorities["sum2"], priorities["total"]);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -936,13 +936,31 @@ struct MemInfo {
   GraphView::OutputPort port;
   int64 memory_used;
   std::vector<GraphView::InputPort> uses_left;
+  // Estimated time the step is delayed by the copies because they can't be
+  // overlapped with the computation.
+  Costs::Duration stall_time;
   double fitness;
 
-  bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
+  bool operator<(const MemInfo& other) const {
+    if (stall_time != other.stall_time) {
+      return stall_time < other.stall_time;
+    }
+    return fitness < other.fitness;
+  }
 };
 
+// The bandwidth of device to host and host to device copies. This is what a
+// PCIe 3.0 x16 link achieves in practice, in bytes per nanosecond.
+constexpr int64 kSwapBytesPerNanoSecond = 12;
+
+// Estimates the time it takes to copy the tensor in or out of the device.
+static Costs::Duration EstimateSwapTime(int64 memory_used) {
+  return Costs::NanoSeconds(memory_used / kSwapBytesPerNanoSecond);
+}
+
 static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item, std::unordered_set<string>* skip_list,
+    Cluster* cluster, GrapplerItem* item, int64 peak_memory_target,
+    std::unordered_set<string>* skip_list,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
   GraphMemory memory(*item);
   const std::unordered_map<string, DeviceProperties>& devices =
@@ -960,16 +978,21 @@ static bool IdentifySwappingCandidates(
     if (prop.type() != "GPU") {
       continue;
     }
-    if (prop.memory_size() <= 0) {
+    int64 memory_limit = prop.memory_size();
+    if (peak_memory_target > 0 &&
+        (memory_limit <= 0 || peak_memory_target < memory_limit)) {
+      memory_limit = peak_memory_target;
+    }
+    if (memory_limit <= 0) {
       VLOG(1) << "Peak memory usage unknown for device " << name;
       continue;
     }
     const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
 
-    if (mem_usage.used_memory <= prop.memory_size()) {
+    if (mem_usage.used_memory <= memory_limit) {
       continue;
     }
-    int64 required_savings = mem_usage.used_memory - prop.memory_size();
+    int64 required_savings = mem_usage.used_memory - memory_limit;
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
     {
@@ -1012,8 +1035,12 @@ static bool IdentifySwappingCandidates(
         // Don't bother with small tensors.
         continue;
       }
+      // The tensor must stay idle long enough to be copied out and back in.
+      const Costs::Duration swap_time =
+          EstimateSwapTime(live_tensor.memory_used);
       if (live_tensor.deallocation_time - live_tensor.allocation_time <=
-          Costs::Duration(1e6)) {
+          std::max<Costs::Duration>(Costs::Duration(1e6),
+                                    swap_time + swap_time)) {
         // Not enough time to swap.
         VLOG(1) << "Not enough time to swap: skipping " << live_tensor.node;
         continue;
@@ -1076,11 +1103,24 @@ static bool IdentifySwappingCandidates(
         mem_info.fitness +=
             MathUtil::IPow((allocation_time - peak_time).count(), 2);
         mem_info.fitness = -mem_info.fitness;
+        // The copy out has to complete before the peak to reduce it, and the
+        // copy in has to complete before the first use after the peak. Any
+        // part of them that doesn't fit in these windows delays the step.
+        mem_info.stall_time = 0;
+        const Costs::Duration swap_out_window = peak_time - allocation_time;
+        if (swap_out_window < swap_time) {
+          mem_info.stall_time += swap_time - swap_out_window;
+        }
+        const Costs::Duration swap_in_window = earliest_use - peak_time;
+        if (swap_in_window < swap_time) {
+          mem_info.stall_time += swap_time - swap_in_window;
+        }
         mem_state.push_back(mem_info);
       }
     }
 
-    // Sort by fitness
+    // Prefer the tensors whose copies can be hidden behind the computation,
+    // then sort by fitness.
     std::sort(mem_state.begin(), mem_state.end());
 
     for (const MemInfo& mem_info : mem_state) {
@@ -1104,14 +1144,15 @@ static bool IdentifySwappingCandidates(
 }
 
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, GrapplerItem* item,
-                  std::unordered_set<string>* skip_list) {
+                  int64 peak_memory_target, Cluster* cluster,
+                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
-    IdentifySwappingCandidates(cluster, item, skip_list, &nodes_to_swap);
+    IdentifySwappingCandidates(cluster, item, peak_memory_target, skip_list,
+                               &nodes_to_swap);
   }
   // Look for manual annotatations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1323,8 +1364,9 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
          optimization_level_ == RewriterConfig::HEURISTICS ||
          optimization_level_ == RewriterConfig::MANUAL) &&
         cluster != nullptr) {
-      updated_graph |= SwappingPass(optimization_level_, cluster,
-                                    &optimized_item, &skip_list);
+      updated_graph |=
+          SwappingPass(optimization_level_, peak_memory_target_, cluster,
+                       &optimized_item, &skip_list);
     }
   }
 
@@ -196,7 +196,8 @@ TEST_F(RecomputeSubgraphTest, MultiNode) {
 
 class MemoryOptimizerTest : public GrapplerTest {
  public:
-  static std::unique_ptr<VirtualCluster> CreateVirtualCluster() {
+  static std::unique_ptr<VirtualCluster> CreateVirtualCluster(
+      int64 gpu_memory_size = 1024 * 1024) {
     DeviceProperties cpu_device;
     cpu_device.set_type("CPU");
     cpu_device.set_frequency(1000);
@@ -208,7 +209,7 @@ class MemoryOptimizerTest : public GrapplerTest {
     gpu_device.set_frequency(1000);
     gpu_device.set_num_cores(24);
     gpu_device.set_bandwidth(128);
-    gpu_device.set_memory_size(1024 * 1024);
+    gpu_device.set_memory_size(gpu_memory_size);
     gpu_device.mutable_environment()->insert({"architecture", "6"});
     std::unordered_map<string, DeviceProperties> devices;
     devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
@@ -338,6 +339,41 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, PeakMemoryTarget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+  Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+  Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+  Output h = ops::Exp(s.WithOpName("h").WithDevice("/gpu:0"), c);
+  Output i = ops::Log(s.WithOpName("i").WithDevice("/gpu:0"), d);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "f", "g", "h", "i"};
+
+  // The graph fits in the memory of the GPU, so nothing is swapped.
+  std::unique_ptr<VirtualCluster> cluster(
+      CreateVirtualCluster(1024 * 1024 * 1024));
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_EQ(0, CountOpNodes(output, "_CopyFromGpuToHost"));
+
+  // But it doesn't fit in the target.
+  MemoryOptimizer target_optimizer(RewriterConfig::SWAPPING_HEURISTICS,
+                                   "gradients/", 1024 * 1024);
+  TF_EXPECT_OK(target_optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_LT(0, CountOpNodes(output, "_CopyFromGpuToHost"));
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
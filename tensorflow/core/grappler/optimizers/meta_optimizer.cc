@@ -18,23 +18,33 @@ limitations under the License.
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/layout_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/memory_aware_scheduler.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/transfer_optimizer.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -67,7 +77,9 @@ int NumIterations(const RewriterConfig& cfg) {
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
-         name == "loop_optimizer";
+         name == "loop_optimizer" || name == "auto_mixed_precision" ||
+         name == "embedding_lookup_optimizer" ||
+         name == "transfer_optimizer";
 }
 
 }  // namespace
@@ -81,6 +93,7 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("function", new FunctionOptimizer(cfg_.function_optimization()));
   MK_OPT("constfold", new ConstantFolding(cpu_device_));
   MK_OPT("shape", new ShapeOptimizer());
+  MK_OPT("auto_mixed_precision", new AutoMixedPrecision());
   MK_OPT("remap", new Remapper(cfg_.remapping()));
   MK_OPT("layout", new LayoutOptimizer());
   MK_OPT("memory", new MemoryOptimizer(RewriterConfig::MANUAL));
@@ -91,6 +104,9 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("debug_stripper", new DebugStripper());
   MK_OPT("scoped_allocator",
          new ScopedAllocatorOptimizer(cfg_.scoped_allocator_opts()));
+  MK_OPT("memory_aware_scheduler", new MemoryAwareScheduler());
+  MK_OPT("embedding_lookup", new EmbeddingLookupOptimizer());
+  MK_OPT("transfer", new TransferOptimizer());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -116,6 +132,9 @@ Status MetaOptimizer::InitializeOptimizers(
   if (cfg_.shape_optimization() != RewriterConfig::OFF) {
     optimizers->emplace_back(new ShapeOptimizer());
   }
+  if (cfg_.auto_mixed_precision() == RewriterConfig::ON) {
+    optimizers->emplace_back(new AutoMixedPrecision());
+  }
   if (cfg_.remapping() != RewriterConfig::OFF) {
     optimizers->emplace_back(new Remapper(cfg_.remapping()));
   }
@@ -137,21 +156,33 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->emplace_back(
           // Use the default target node name prefix "gradients/"
-          new MemoryOptimizer(cfg_.memory_optimization()));
+          new MemoryOptimizer(cfg_.memory_optimization(), "gradients/",
+                              cfg_.memory_optimizer_peak_memory_target()));
     } else {
       optimizers->emplace_back(
           new MemoryOptimizer(cfg_.memory_optimization(),
-                              cfg_.memory_optimizer_target_node_name_scope()));
+                              cfg_.memory_optimizer_target_node_name_scope(),
+                              cfg_.memory_optimizer_peak_memory_target()));
     }
   }
   if (cfg_.auto_parallel().enable()) {
     optimizers->emplace_back(
         new AutoParallel(cfg_.auto_parallel().num_replicas()));
   }
+  if (cfg_.embedding_lookup_optimization() == RewriterConfig::ON) {
+    optimizers->emplace_back(new EmbeddingLookupOptimizer());
+  }
+  if (cfg_.transfer_optimization() == RewriterConfig::ON) {
+    optimizers->emplace_back(new TransferOptimizer());
+  }
   if (cfg_.scoped_allocator_optimization()) {
     optimizers->emplace_back(
         new ScopedAllocatorOptimizer(cfg_.scoped_allocator_opts()));
   }
+  // Runs last, so that it orders the nodes added by the other optimizers too.
+  if (cfg_.memory_aware_scheduling() == RewriterConfig::ON) {
+    optimizers->emplace_back(new MemoryAwareScheduler());
+  }
   return Status::OK();
 }
 
@@ -299,7 +330,8 @@ Status MetaOptimizer::RunOptimizer(
   }
   VLOG(4) << optimizer->name() << ": " << result;
 
-  OptimizerResult optimizer_result{optimizer->name(), result};
+  OptimizerResult optimizer_result{optimizer->name(), result,
+                                   static_cast<int64>(end_us - start_us)};
   optimization_result->results.push_back(optimizer_result);
   return status;
 }
@@ -388,6 +420,22 @@ void MetaOptimizer::PrintResult() {
   }
 }
 
+std::vector<std::pair<string, int64>> MetaOptimizer::GetOptimizerRunMicros()
+    const {
+  std::vector<std::pair<string, int64>> run_micros;
+  std::unordered_map<string, int> index;
+  for (const GraphOptimizationResult& graph_result : optimization_results_) {
+    for (const OptimizerResult& result : graph_result.results) {
+      auto it = index.emplace(result.optimizer_name, run_micros.size()).first;
+      if (it->second == static_cast<int>(run_micros.size())) {
+        run_micros.emplace_back(result.optimizer_name, 0);
+      }
+      run_micros[it->second].second += result.run_micros;
+    }
+  }
+  return run_micros;
+}
+
 void MetaOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
                              const GraphDef& pruned_graph, double result) {
   // Nothing to do for MetaOptimizer.
@@ -407,14 +455,107 @@ bool MetaOptimizerEnabled(const RewriterConfig& cfg) {
          cfg.memory_optimization() != RewriterConfig::NO_MEM_OPT ||
          cfg.debug_stripper() == RewriterConfig::ON ||
          cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
+         cfg.auto_mixed_precision() == RewriterConfig::ON ||
+         cfg.memory_aware_scheduling() == RewriterConfig::ON ||
+         cfg.embedding_lookup_optimization() == RewriterConfig::ON ||
+         cfg.transfer_optimization() == RewriterConfig::ON ||
          !cfg.optimizers().empty() || !cfg.custom_optimizers().empty();
 }
 
-Status RunMetaOptimizer(const GrapplerItem& item, const RewriterConfig& cfg,
-                        DeviceBase* cpu_device, Cluster* cluster,
-                        GraphDef* optimized_graph) {
-  MetaOptimizer optimizer(cpu_device, cfg);
-  return optimizer.Optimize(cluster, item, optimized_graph);
+namespace {
+
+mutex tuner_mu(LINKER_INITIALIZED);
+
+RewriterConfigTuner* GetRewriterConfigTuner() {
+  static RewriterConfigTuner* tuner = new RewriterConfigTuner;
+  return tuner;
+}
+
+// Returns the file in which the config tuned for 'item' from 'cfg' is cached.
+string TunedConfigPath(const GrapplerItem& item, const RewriterConfig& cfg) {
+  string key;
+  SerializeToStringDeterministic(item.graph, &key);
+  for (const string& fetch : item.fetch) {
+    strings::StrAppend(&key, ";", fetch);
+  }
+  string cfg_key;
+  SerializeToStringDeterministic(cfg, &cfg_key);
+  strings::StrAppend(&key, ";", cfg_key);
+  return io::JoinPath(
+      cfg.meta_optimizer_tuning_cache_dir(),
+      strings::StrCat("rewriter_config_", Fingerprint64(key), ".pbtxt"));
+}
+
+// Reads the config tuned for 'item' from the cache, or tunes it and caches it
+// if it isn't there yet.
+Status GetTunedConfig(const GrapplerItem& item, const RewriterConfig& cfg,
+                      DeviceBase* cpu_device, RewriterConfig* tuned_cfg) {
+  Env* env = Env::Default();
+  const string path = TunedConfigPath(item, cfg);
+  if (env->FileExists(path).ok()) {
+    string contents;
+    TF_RETURN_IF_ERROR(ReadFileToString(env, path, &contents));
+    if (!protobuf::TextFormat::ParseFromString(contents, tuned_cfg)) {
+      return errors::DataLoss("Can't parse the tuned config in ", path);
+    }
+    tuned_cfg->clear_meta_optimizer_tuning_cache_dir();
+    VLOG(1) << "Using the tuned config in " << path;
+    return Status::OK();
+  }
+
+  RewriterConfigTuner tuner;
+  {
+    mutex_lock l(tuner_mu);
+    tuner = *GetRewriterConfigTuner();
+  }
+  if (!tuner) {
+    return errors::NotFound("No tuned config in ", path,
+                            " and no tuner to create it");
+  }
+  RewriterConfig base_cfg = cfg;
+  base_cfg.clear_meta_optimizer_tuning_cache_dir();
+  TF_RETURN_IF_ERROR(tuner(item, base_cfg, cpu_device, tuned_cfg));
+  tuned_cfg->clear_meta_optimizer_tuning_cache_dir();
+
+  // Write to a temporary file first, so that concurrent sessions never read
+  // a partial config.
+  string contents;
+  protobuf::TextFormat::PrintToString(*tuned_cfg, &contents);
+  TF_RETURN_IF_ERROR(
+      env->RecursivelyCreateDir(cfg.meta_optimizer_tuning_cache_dir()));
+  const string tmp_path =
+      strings::StrCat(path, ".tmp", env->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, contents));
+  return env->RenameFile(tmp_path, path);
+}
+
+}  // namespace
+
+void SetRewriterConfigTuner(RewriterConfigTuner tuner) {
+  mutex_lock l(tuner_mu);
+  *GetRewriterConfigTuner() = std::move(tuner);
+}
+
+Status RunMetaOptimizer(
+    const GrapplerItem& item, const RewriterConfig& cfg,
+    DeviceBase* cpu_device, Cluster* cluster, GraphDef* optimized_graph,
+    std::vector<std::pair<string, int64>>* optimizer_run_micros) {
+  RewriterConfig tuned_cfg;
+  const RewriterConfig* run_cfg = &cfg;
+  if (!cfg.meta_optimizer_tuning_cache_dir().empty()) {
+    Status s = GetTunedConfig(item, cfg, cpu_device, &tuned_cfg);
+    if (s.ok()) {
+      run_cfg = &tuned_cfg;
+    } else {
+      LOG(WARNING) << "Not using a tuned rewriter config: " << s;
+    }
+  }
+  MetaOptimizer optimizer(cpu_device, *run_cfg);
+  Status status = optimizer.Optimize(cluster, item, optimized_graph);
+  if (optimizer_run_micros != nullptr) {
+    *optimizer_run_micros = optimizer.GetOptimizerRunMicros();
+  }
+  return status;
 }
 
 }  // namespace grappler
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
@@ -39,6 +43,11 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintResult();
 
+  // Returns the wall time each optimizer spent in the last call to Optimize,
+  // summed over its iterations and over the optimized functions, in the order
+  // the optimizers first ran.
+  std::vector<std::pair<string, int64>> GetOptimizerRunMicros() const;
+
   void Feedback(Cluster* cluster, const GrapplerItem& item,
                 const GraphDef& optimized_graph, double result) override;
 
@@ -64,6 +73,7 @@ class MetaOptimizer : public GraphOptimizer {
   struct OptimizerResult {
     string optimizer_name;
     string result;
+    int64 run_micros;
   };
 
   struct GraphOptimizationResult {
@@ -87,9 +97,25 @@ bool MetaOptimizerEnabled(const RewriterConfig& cfg);
 // during constant folding; if NULL, a new device is created for doing constant
 // folding. For performance, it is recommended to pass in an existing cpu_device
 // when possible.
-Status RunMetaOptimizer(const GrapplerItem& item, const RewriterConfig& cfg,
-                        DeviceBase* cpu_device, Cluster* cluster,
-                        GraphDef* optimized_graph);
+//
+// If <optimizer_run_micros> is non-null, it is filled with the wall time spent
+// in each optimizer.
+Status RunMetaOptimizer(
+    const GrapplerItem& item, const RewriterConfig& cfg,
+    DeviceBase* cpu_device, Cluster* cluster, GraphDef* optimized_graph,
+    std::vector<std::pair<string, int64>>* optimizer_run_micros = nullptr);
+
+// Fills <tuned_cfg> with the config that works best for <item>, starting from
+// <cfg>.
+typedef std::function<Status(const GrapplerItem& item,
+                             const RewriterConfig& cfg, DeviceBase* cpu_device,
+                             RewriterConfig* tuned_cfg)>
+    RewriterConfigTuner;
+
+// Sets the tuner RunMetaOptimizer calls when
+// RewriterConfig::meta_optimizer_tuning_cache_dir is set and no tuned config
+// is cached for the graph yet.
+void SetRewriterConfigTuner(RewriterConfigTuner tuner);
 
 }  // namespace grappler
 }  // namespace tensorflow
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -96,6 +97,39 @@ TEST_F(MetaOptimizerTest, RunOptimizersTwice) {
   TF_EXPECT_OK(status);
 }
 
+TEST_F(MetaOptimizerTest, CachesTunedConfig) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+
+  int num_tunings = 0;
+  SetRewriterConfigTuner([&num_tunings](const GrapplerItem& /*item*/,
+                                        const RewriterConfig& cfg,
+                                        DeviceBase* /*cpu_device*/,
+                                        RewriterConfig* tuned_cfg) {
+    EXPECT_TRUE(cfg.meta_optimizer_tuning_cache_dir().empty());
+    ++num_tunings;
+    *tuned_cfg = cfg;
+    tuned_cfg->add_optimizers("TestOptimizer");
+    return Status::OK();
+  });
+
+  RewriterConfig rewriter_config;
+  rewriter_config.set_meta_optimizer_tuning_cache_dir(
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_tuning_cache"));
+
+  for (int i = 0; i < 2; ++i) {
+    TestOptimizer::SetOptimized(false);
+    GraphDef output;
+    TF_EXPECT_OK(
+        RunMetaOptimizer(item, rewriter_config, nullptr, nullptr, &output));
+    // The second run reuses the cached config instead of tuning again.
+    EXPECT_TRUE(TestOptimizer::IsOptimized());
+    EXPECT_EQ(1, num_tunings);
+  }
+  SetRewriterConfigTuner(nullptr);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   using test::function::NDef;
 
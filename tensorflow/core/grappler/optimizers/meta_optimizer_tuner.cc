@@ -0,0 +1,132 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_tuner.h"
+
+#include "tensorflow/core/grappler/clusters/single_machine.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
+#include "tensorflow/core/grappler/devices.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr int kMeasurementSteps = 10;
+constexpr double kMinSpeedup = 1.05;
+constexpr int kTimeoutSeconds = 300;
+
+// Optimizes 'item' with 'cfg' and measures the optimized graph.
+Status MeasureConfig(const GrapplerItem& item, const RewriterConfig& cfg,
+                     DeviceBase* cpu_device, Cluster* cluster,
+                     int measurement_steps, Costs::Duration* run_time) {
+  MetaOptimizer optimizer(cpu_device, cfg);
+  GraphDef optimized_graph;
+  TF_RETURN_IF_ERROR(optimizer.Optimize(cluster, item, &optimized_graph));
+
+  GrapplerItem optimized_item(item, std::move(optimized_graph));
+  MeasuringCostEstimator estimator(cluster, measurement_steps,
+                                   /*measurement_threads=*/0);
+  TF_RETURN_IF_ERROR(estimator.Initialize(optimized_item));
+  Costs costs;
+  TF_RETURN_IF_ERROR(
+      estimator.PredictCosts(optimized_item.graph, nullptr, &costs));
+  *run_time = costs.execution_time;
+  return Status::OK();
+}
+
+}  // namespace
+
+std::vector<RewriterConfig> GetCandidateConfigs(const RewriterConfig& cfg) {
+  std::vector<RewriterConfig> candidates = {cfg};
+  if (cfg.layout_optimizer() != RewriterConfig::OFF) {
+    candidates.push_back(cfg);
+    candidates.back().set_layout_optimizer(RewriterConfig::OFF);
+  }
+  if (cfg.arithmetic_optimization() != RewriterConfig::OFF) {
+    candidates.push_back(cfg);
+    candidates.back().set_arithmetic_optimization(RewriterConfig::OFF);
+  }
+  if (cfg.loop_optimization() != RewriterConfig::OFF) {
+    candidates.push_back(cfg);
+    candidates.back().set_loop_optimization(RewriterConfig::OFF);
+  }
+  return candidates;
+}
+
+Status TuneRewriterConfig(const GrapplerItem& item, const RewriterConfig& cfg,
+                          DeviceBase* cpu_device, Cluster* cluster,
+                          int measurement_steps, double min_speedup,
+                          RewriterConfig* tuned_cfg) {
+  const std::vector<RewriterConfig> candidates = GetCandidateConfigs(cfg);
+  Costs::Duration base_time;
+  TF_RETURN_IF_ERROR(MeasureConfig(item, cfg, cpu_device, cluster,
+                                   measurement_steps, &base_time));
+  VLOG(1) << "Tuning " << item.id << ": base config runs in "
+          << base_time.count() << "ns";
+
+  *tuned_cfg = cfg;
+  Costs::Duration best_time = base_time;
+  for (size_t i = 1; i < candidates.size(); ++i) {
+    Costs::Duration run_time;
+    Status s = MeasureConfig(item, candidates[i], cpu_device, cluster,
+                             measurement_steps, &run_time);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to measure candidate config " << i << ": " << s;
+      continue;
+    }
+    VLOG(1) << "Tuning " << item.id << ": candidate config " << i
+            << " runs in " << run_time.count() << "ns";
+    if (run_time.count() * min_speedup <= base_time.count() &&
+        run_time < best_time) {
+      best_time = run_time;
+      *tuned_cfg = candidates[i];
+    }
+  }
+  return Status::OK();
+}
+
+Status TuneRewriterConfigOnSingleMachine(const GrapplerItem& item,
+                                         const RewriterConfig& cfg,
+                                         DeviceBase* cpu_device,
+                                         RewriterConfig* tuned_cfg) {
+  SingleMachine cluster(kTimeoutSeconds, port::NumSchedulableCPUs(),
+                        GetNumAvailableGPUs());
+  TF_RETURN_IF_ERROR(cluster.Provision());
+  Status s = TuneRewriterConfig(item, cfg, cpu_device, &cluster,
+                                kMeasurementSteps, kMinSpeedup, tuned_cfg);
+  TF_RETURN_IF_ERROR(cluster.Shutdown());
+  return s;
+}
+
+namespace {
+
+class RewriterConfigTunerRegistration {
+ public:
+  RewriterConfigTunerRegistration() {
+    SetRewriterConfigTuner(TuneRewriterConfigOnSingleMachine);
+  }
+};
+
+static RewriterConfigTunerRegistration registration;
+
+}  // namespace
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_TUNER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_TUNER_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Returns the configs to evaluate when tuning <cfg>: <cfg> itself first, then
+// <cfg> with one of the passes that occasionally slow models down (layout,
+// arithmetic and loop optimizations) turned off.
+std::vector<RewriterConfig> GetCandidateConfigs(const RewriterConfig& cfg);
+
+// Optimizes <item> with each of the candidate configs, measures the resulting
+// graphs on <cluster>, and fills <tuned_cfg> with the config of the fastest
+// one. Candidates must be at least <min_speedup> times faster than <cfg> to be
+// preferred to it, so that measurement noise doesn't churn the choice.
+Status TuneRewriterConfig(const GrapplerItem& item, const RewriterConfig& cfg,
+                          DeviceBase* cpu_device, Cluster* cluster,
+                          int measurement_steps, double min_speedup,
+                          RewriterConfig* tuned_cfg);
+
+// Same as above, on a SingleMachine cluster of all the local CPUs and GPUs.
+// Linking in this library registers this function as the tuner of
+// RunMetaOptimizer, see RewriterConfig::meta_optimizer_tuning_cache_dir.
+Status TuneRewriterConfigOnSingleMachine(const GrapplerItem& item,
+                                         const RewriterConfig& cfg,
+                                         DeviceBase* cpu_device,
+                                         RewriterConfig* tuned_cfg);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_TUNER_H_
@@ -0,0 +1,49 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_tuner.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+TEST(MetaOptimizerTunerTest, CandidateConfigs) {
+  RewriterConfig cfg;
+  cfg.set_constant_folding(RewriterConfig::OFF);
+  std::vector<RewriterConfig> candidates = GetCandidateConfigs(cfg);
+  ASSERT_EQ(4, candidates.size());
+  EXPECT_EQ(cfg.DebugString(), candidates[0].DebugString());
+  EXPECT_EQ(RewriterConfig::OFF, candidates[1].layout_optimizer());
+  EXPECT_EQ(RewriterConfig::OFF, candidates[2].arithmetic_optimization());
+  EXPECT_EQ(RewriterConfig::OFF, candidates[3].loop_optimization());
+  for (const RewriterConfig& candidate : candidates) {
+    EXPECT_EQ(RewriterConfig::OFF, candidate.constant_folding());
+  }
+}
+
+TEST(MetaOptimizerTunerTest, NoCandidatesForDisabledPasses) {
+  RewriterConfig cfg;
+  cfg.set_layout_optimizer(RewriterConfig::OFF);
+  cfg.set_arithmetic_optimization(RewriterConfig::OFF);
+  std::vector<RewriterConfig> candidates = GetCandidateConfigs(cfg);
+  ASSERT_EQ(2, candidates.size());
+  EXPECT_EQ(RewriterConfig::OFF, candidates[1].loop_optimization());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,14 +15,25 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -165,15 +176,857 @@ void AddBatchNormNodes(GraphDef* optimized_graph, const NodeDef& fused_node) {
   *r->add_input() = c->name();
 }
 
-Status Remapper::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
+namespace {
+
+// The cwise ops that _FusedElementwise implements.
+bool IsFusibleUnaryOp(const string& op) {
+  static const std::unordered_set<string>* ops =
+      new std::unordered_set<string>({"Abs", "Exp", "Log", "Neg", "Relu",
+                                      "Relu6", "Rsqrt", "Sigmoid", "Sqrt",
+                                      "Square", "Tanh"});
+  return ops->count(op) > 0;
+}
+
+bool IsFusibleBinaryOp(const string& op) {
+  static const std::unordered_set<string>* ops =
+      new std::unordered_set<string>({"Add", "Maximum", "Minimum", "Mul",
+                                      "RealDiv", "SquaredDifference", "Sub"});
+  return ops->count(op) > 0;
+}
+
+// Returns true if 'node' is of type float or double and will run on CPU. The
+// fused kernels have no GPU implementation, so only such nodes are rewritten.
+bool IsFloatOnCpu(const NodeDef& node, bool cluster_has_gpu) {
+  if (node.attr().count("T") == 0) return false;
+  const DataType dtype = node.attr().at("T").type();
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  DeviceNameUtils::ParsedName device;
+  if (node.device().empty()) {
+    return !cluster_has_gpu;
+  }
+  return DeviceNameUtils::ParseFullName(node.device(), &device) &&
+         device.has_type && device.type == DEVICE_CPU;
+}
+
+// Returns true if 'node' can be evaluated by _FusedElementwise: it is a
+// supported cwise op that runs on CPU, and all of its inputs have the same
+// shape as its output, i.e. it does not broadcast.
+bool IsFusibleCwiseNode(const NodeDef& node, const GraphProperties& properties,
+                        bool cluster_has_gpu) {
+  int num_inputs;
+  if (IsFusibleUnaryOp(node.op())) {
+    num_inputs = 1;
+  } else if (IsFusibleBinaryOp(node.op())) {
+    num_inputs = 2;
+  } else {
+    return false;
+  }
+  if (!IsFloatOnCpu(node, cluster_has_gpu)) return false;
+
+  const auto& inputs = properties.GetInputProperties(node.name());
+  const auto& outputs = properties.GetOutputProperties(node.name());
+  if (inputs.size() != static_cast<size_t>(num_inputs) || outputs.size() != 1 ||
+      !ShapeIsSymbolicallyDefined(outputs[0])) {
+    return false;
+  }
+  for (const auto& input : inputs) {
+    if (!ShapesSymbolicallyEqual(input, outputs[0])) return false;
+  }
+  return true;
+}
+
+// Finds the maximal chains of fusible cwise nodes in which every node but
+// the last one only feeds the next one, and replaces each chain of two or
+// more nodes by a single _FusedElementwise node with the name of the last
+// one. Fills 'fused_nodes' with the new nodes by name, and 'fused_away' with
+// the names of the nodes they replace.
+void FuseElementwiseChains(const GrapplerItem& item,
+                           const GraphProperties& properties,
+                           const GraphView& graph, bool cluster_has_gpu,
+                           std::unordered_map<string, NodeDef>* fused_nodes,
+                           std::unordered_set<string>* fused_away) {
+  const std::unordered_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  std::unordered_set<string> fusible;
+  for (const NodeDef& node : item.graph.node()) {
+    if (fused_away->count(node.name()) == 0 &&
+        fused_nodes->count(node.name()) == 0 &&
+        IsFusibleCwiseNode(node, properties, cluster_has_gpu)) {
+      fusible.insert(node.name());
+    }
+  }
+
+  // For every fusible node, the index of the input that it absorbs as the
+  // previous node of its chain.
+  std::unordered_map<string, int> chain_input;
+  for (const NodeDef& node : item.graph.node()) {
+    if (fusible.count(node.name()) == 0) continue;
+    const int num_inputs = IsFusibleBinaryOp(node.op()) ? 2 : 1;
+    for (int i = 0; i < num_inputs; ++i) {
+      int position;
+      const string input_name = ParseNodeName(node.input(i), &position);
+      if (position != 0 || fusible.count(input_name) == 0 ||
+          nodes_to_preserve.count(input_name) > 0) {
+        continue;
+      }
+      const NodeDef* input = graph.GetNode(input_name);
+      // The input is fused away, so it must have no other consumer.
+      if (input->device() != node.device() ||
+          input->attr().at("T").type() != node.attr().at("T").type() ||
+          graph.GetFanoutEdges(*input, true).size() != 1) {
+        continue;
+      }
+      chain_input[node.name()] = i;
+      fused_away->insert(input_name);
+      break;
+    }
+  }
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (fused_away->count(node.name()) > 0 ||
+        chain_input.count(node.name()) == 0) {
+      continue;
+    }
+    // 'node' is the last node of a chain of at least two nodes.
+    std::vector<const NodeDef*> chain = {&node};
+    for (auto it = chain_input.find(node.name()); it != chain_input.end();
+         it = chain_input.find(chain.back()->name())) {
+      chain.push_back(graph.GetNode(NodeName(chain.back()->input(it->second))));
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    NodeDef fused;
+    fused.set_name(node.name());
+    fused.set_op("_FusedElementwise");
+    fused.set_device(node.device());
+    (*fused.mutable_attr())["T"] = node.attr().at("T");
+    AttrValue ops;
+    AttrValue chain_is_lhs;
+    std::vector<string> control_inputs;
+    for (const NodeDef* n : chain) {
+      ops.mutable_list()->add_s(n->op());
+      auto it = chain_input.find(n->name());
+      if (it == chain_input.end()) {
+        // The first node of the chain: its first input is the start of the
+        // chain.
+        *fused.add_input() = n->input(0);
+        if (IsFusibleBinaryOp(n->op())) {
+          *fused.add_input() = n->input(1);
+        }
+        chain_is_lhs.mutable_list()->add_b(true);
+      } else {
+        // The other input of a binary op is a side input.
+        if (IsFusibleBinaryOp(n->op())) {
+          *fused.add_input() = n->input(1 - it->second);
+        }
+        chain_is_lhs.mutable_list()->add_b(it->second == 0);
+      }
+      for (const string& input : n->input()) {
+        if (IsControlInput(input)) control_inputs.push_back(input);
+      }
+    }
+    (*fused.mutable_attr())["num_inputs"].set_i(fused.input_size());
+    (*fused.mutable_attr())["ops"] = ops;
+    (*fused.mutable_attr())["chain_is_lhs"] = chain_is_lhs;
+    std::sort(control_inputs.begin(), control_inputs.end());
+    control_inputs.erase(
+        std::unique(control_inputs.begin(), control_inputs.end()),
+        control_inputs.end());
+    for (const string& input : control_inputs) {
+      *fused.add_input() = input;
+    }
+    VLOG(1) << "Fusing a chain of " << chain.size()
+            << " cwise nodes into " << fused.DebugString();
+    (*fused_nodes)[node.name()] = std::move(fused);
+  }
+}
+
+// Returns the only node that consumes the outputs of 'node' if it has a single
+// fanout, that fanout reads output 0 of 'node' as its first input, and
+// 'node' can be fused away. Returns nullptr otherwise.
+const NodeDef* GetFusibleConsumer(
+    const NodeDef& node, const GraphView& graph,
+    const std::unordered_set<string>& nodes_to_preserve,
+    const std::unordered_set<string>& fused_away,
+    const std::unordered_map<string, NodeDef>& fused_nodes) {
+  if (nodes_to_preserve.count(node.name()) > 0) return nullptr;
+  const auto fanouts = graph.GetFanoutEdges(node, true);
+  if (fanouts.size() != 1) return nullptr;
+  const GraphView::Edge& edge = *fanouts.begin();
+  if (edge.src.port_id != 0 || edge.tgt.port_id != 0) return nullptr;
+  const NodeDef* consumer = edge.tgt.node;
+  if (fused_away.count(consumer->name()) > 0 ||
+      fused_nodes.count(consumer->name()) > 0 ||
+      consumer->device() != node.device() ||
+      consumer->attr().count("T") == 0 ||
+      consumer->attr().at("T").type() != node.attr().at("T").type()) {
+    return nullptr;
+  }
+  return consumer;
+}
+
+bool HasDataFormat(const NodeDef& node, const string& data_format) {
+  return node.attr().count("data_format") == 0 ||
+         node.attr().at("data_format").s() == data_format;
+}
+
+// Finds the inference chains Conv2D -> [BiasAdd] -> [FusedBatchNorm] ->
+// [Relu | Relu6] with at least one op after the convolution, and replaces
+// each of them by a single _FusedConv2D node with the name of the last node
+// of the chain. The batch norm is only fused when it is not training and its
+// scale, offset, mean and variance are constant, so that _FusedConv2D can
+// fold it into a per-channel scale and offset.
+void FuseConv2DChains(const GrapplerItem& item,
+                      const GraphProperties& properties,
+                      const GraphView& graph, bool cluster_has_gpu,
+                      std::unordered_map<string, NodeDef>* fused_nodes,
+                      std::unordered_set<string>* fused_away) {
+  const std::unordered_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != "Conv2D" || !IsFloatOnCpu(node, cluster_has_gpu) ||
+        !HasDataFormat(node, "NHWC") || fused_away->count(node.name()) > 0) {
+      continue;
+    }
+    std::vector<const NodeDef*> chain = {&node};
+    AttrValue fused_ops;
+    std::vector<string> args;
+    float epsilon = 0.0001f;
+    const NodeDef* next = GetFusibleConsumer(node, graph, nodes_to_preserve,
+                                             *fused_away, *fused_nodes);
+    if (next != nullptr && next->op() == "BiasAdd" &&
+        HasDataFormat(*next, "NHWC")) {
+      fused_ops.mutable_list()->add_s(next->op());
+      args.push_back(next->input(1));
+      chain.push_back(next);
+      next = GetFusibleConsumer(*next, graph, nodes_to_preserve, *fused_away,
+                                *fused_nodes);
+    }
+    if (next != nullptr && next->op() == "FusedBatchNorm" &&
+        HasDataFormat(*next, "NHWC") &&
+        (next->attr().count("is_training") == 0 ||
+         !next->attr().at("is_training").b())) {
+      const auto& props = properties.GetInputProperties(next->name());
+      bool const_inputs = props.size() == 5;
+      for (int i = 1; const_inputs && i < 5; ++i) {
+        const_inputs = props[i].has_value();
+      }
+      // Only the first output, y, can be computed by the fused node.
+      bool only_y = true;
+      for (const GraphView::Edge& edge : graph.GetFanoutEdges(*next, false)) {
+        if (edge.src.port_id != 0) only_y = false;
+      }
+      if (const_inputs && only_y) {
+        fused_ops.mutable_list()->add_s(next->op());
+        for (int i = 1; i < 5; ++i) {
+          args.push_back(next->input(i));
+        }
+        if (next->attr().count("epsilon") > 0) {
+          epsilon = next->attr().at("epsilon").f();
+        }
+        chain.push_back(next);
+        next = GetFusibleConsumer(*next, graph, nodes_to_preserve, *fused_away,
+                                  *fused_nodes);
+      }
+    }
+    if (next != nullptr && (next->op() == "Relu" || next->op() == "Relu6")) {
+      fused_ops.mutable_list()->add_s(next->op());
+      chain.push_back(next);
+    }
+    if (chain.size() < 2) continue;
+
+    const NodeDef& last = *chain.back();
+    NodeDef fused;
+    fused.set_name(last.name());
+    fused.set_op("_FusedConv2D");
+    fused.set_device(node.device());
+    *fused.add_input() = node.input(0);
+    *fused.add_input() = node.input(1);
+    for (const string& arg : args) {
+      *fused.add_input() = arg;
+    }
+    (*fused.mutable_attr())["T"] = node.attr().at("T");
+    (*fused.mutable_attr())["num_args"].set_i(args.size());
+    for (const char* attr : {"strides", "padding", "dilations"}) {
+      if (node.attr().count(attr) > 0) {
+        (*fused.mutable_attr())[attr] = node.attr().at(attr);
+      }
+    }
+    (*fused.mutable_attr())["data_format"].set_s("NHWC");
+    (*fused.mutable_attr())["fused_ops"] = fused_ops;
+    (*fused.mutable_attr())["epsilon"].set_f(epsilon);
+    std::vector<string> control_inputs;
+    for (const NodeDef* n : chain) {
+      for (const string& input : n->input()) {
+        if (IsControlInput(input)) control_inputs.push_back(input);
+      }
+      if (n != &last) fused_away->insert(n->name());
+    }
+    std::sort(control_inputs.begin(), control_inputs.end());
+    control_inputs.erase(
+        std::unique(control_inputs.begin(), control_inputs.end()),
+        control_inputs.end());
+    for (const string& input : control_inputs) {
+      *fused.add_input() = input;
+    }
+    VLOG(1) << "Fusing a chain of " << chain.size()
+            << " nodes into " << fused.DebugString();
+    (*fused_nodes)[last.name()] = std::move(fused);
+  }
+}
+
+
+// Returns the only node that consumes the outputs of 'node' if it has a single
+// fanout reading output 0 of 'node', and 'node' can be fused away. Sets
+// 'input_index' to the input of the consumer that reads 'node'. Returns
+// nullptr otherwise.
+const NodeDef* GetFusibleConsumerOfAnyInput(
+    const NodeDef& node, const GraphView& graph,
+    const std::unordered_set<string>& nodes_to_preserve, int* input_index) {
+  if (nodes_to_preserve.count(node.name()) > 0) return nullptr;
+  const auto fanouts = graph.GetFanoutEdges(node, true);
+  if (fanouts.size() != 1) return nullptr;
+  const GraphView::Edge& edge = *fanouts.begin();
+  if (edge.src.port_id != 0 || edge.tgt.port_id < 0) return nullptr;
+  const NodeDef* consumer = edge.tgt.node;
+  if (consumer->device() != node.device() ||
+      consumer->attr().count("T") == 0 ||
+      consumer->attr().at("T").type() != node.attr().at("T").type()) {
+    return nullptr;
+  }
+  *input_index = edge.tgt.port_id;
+  return consumer;
+}
+
+bool GetBoolAttr(const NodeDef& node, const string& name) {
+  return node.attr().count(name) > 0 && node.attr().at(name).b();
+}
+
+// Returns true if 'properties' is known to hold a single float or double,
+// and sets 'value' to it.
+bool GetScalarValue(const OpInfo::TensorProperties& properties,
+                    double* value) {
+  Tensor tensor;
+  if (!properties.has_value() || !tensor.FromProto(properties.value()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_FLOAT) {
+    *value = tensor.flat<float>()(0);
+    return true;
+  }
+  if (tensor.dtype() == DT_DOUBLE) {
+    *value = tensor.flat<double>()(0);
+    return true;
+  }
+  return false;
+}
+
+// Finds the attention chains BatchMatMul(q, k, adj_y=true) ->
+// [Mul | RealDiv by a scalar constant] -> [Add(mask)] -> Softmax ->
+// BatchMatMul(.., v), and replaces each of them by a single _FusedAttention
+// node with the name of the last node of the chain, which never materializes
+// the scores. The mask may broadcast to the scores, but the scores may not be
+// broadcast by the mask or the scale.
+void FuseAttentionChains(const GrapplerItem& item,
+                         const GraphProperties& properties,
+                         const GraphView& graph, bool cluster_has_gpu,
+                         std::unordered_map<string, NodeDef>* fused_nodes,
+                         std::unordered_set<string>* fused_away) {
+  const std::unordered_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != "BatchMatMul" || !IsFloatOnCpu(node, cluster_has_gpu) ||
+        GetBoolAttr(node, "adj_x") || !GetBoolAttr(node, "adj_y")) {
+      continue;
+    }
+    const auto& scores = properties.GetOutputProperties(node.name());
+    if (scores.size() != 1 || !ShapeIsSymbolicallyDefined(scores[0])) {
+      continue;
+    }
+    auto keeps_scores_shape = [&properties, &scores](const NodeDef& n) {
+      const auto& outputs = properties.GetOutputProperties(n.name());
+      return outputs.size() == 1 &&
+             ShapesSymbolicallyEqual(outputs[0], scores[0]);
+    };
+
+    std::vector<const NodeDef*> chain = {&node};
+    int input_index;
+    const NodeDef* next = GetFusibleConsumerOfAnyInput(
+        node, graph, nodes_to_preserve, &input_index);
+    double scale = 1.0;
+    if (next != nullptr &&
+        (next->op() == "Mul" ||
+         (next->op() == "RealDiv" && input_index == 0)) &&
+        keeps_scores_shape(*next)) {
+      const auto& inputs = properties.GetInputProperties(next->name());
+      double factor;
+      if (inputs.size() == 2 &&
+          GetScalarValue(inputs[1 - input_index], &factor) && factor != 0) {
+        scale = next->op() == "Mul" ? factor : 1.0 / factor;
+        chain.push_back(next);
+        next = GetFusibleConsumerOfAnyInput(*next, graph, nodes_to_preserve,
+                                            &input_index);
+      }
+    }
+    string mask;
+    if (next != nullptr && next->op() == "Add" && keeps_scores_shape(*next)) {
+      mask = next->input(1 - input_index);
+      chain.push_back(next);
+      next = GetFusibleConsumerOfAnyInput(*next, graph, nodes_to_preserve,
+                                          &input_index);
+    }
+    if (next == nullptr || next->op() != "Softmax") continue;
+    chain.push_back(next);
+    next = GetFusibleConsumerOfAnyInput(*next, graph, nodes_to_preserve,
+                                        &input_index);
+    if (next == nullptr || next->op() != "BatchMatMul" || input_index != 0 ||
+        GetBoolAttr(*next, "adj_x") || GetBoolAttr(*next, "adj_y")) {
+      continue;
+    }
+    chain.push_back(next);
+    bool already_fused = false;
+    for (const NodeDef* n : chain) {
+      if (fused_away->count(n->name()) > 0 ||
+          fused_nodes->count(n->name()) > 0) {
+        already_fused = true;
+      }
+    }
+    if (already_fused) continue;
+
+    const NodeDef& last = *chain.back();
+    NodeDef fused;
+    fused.set_name(last.name());
+    fused.set_op("_FusedAttention");
+    fused.set_device(node.device());
+    *fused.add_input() = node.input(0);
+    *fused.add_input() = node.input(1);
+    *fused.add_input() = last.input(1);
+    if (!mask.empty()) {
+      *fused.add_input() = mask;
+    }
+    (*fused.mutable_attr())["T"] = node.attr().at("T");
+    (*fused.mutable_attr())["num_masks"].set_i(mask.empty() ? 0 : 1);
+    (*fused.mutable_attr())["scale"].set_f(scale);
+    std::vector<string> control_inputs;
+    for (const NodeDef* n : chain) {
+      for (const string& input : n->input()) {
+        if (IsControlInput(input)) control_inputs.push_back(input);
+      }
+      if (n != &last) fused_away->insert(n->name());
+    }
+    std::sort(control_inputs.begin(), control_inputs.end());
+    control_inputs.erase(
+        std::unique(control_inputs.begin(), control_inputs.end()),
+        control_inputs.end());
+    for (const string& input : control_inputs) {
+      *fused.add_input() = input;
+    }
+    VLOG(1) << "Fusing a chain of " << chain.size()
+            << " nodes into " << fused.DebugString();
+    (*fused_nodes)[last.name()] = std::move(fused);
+  }
+}
+
+// Returns the node producing the data input 'index' of 'node', if 'node' reads
+// its output 0. Returns nullptr otherwise.
+const NodeDef* GetInputNode(const NodeDef& node, int index,
+                            const GraphView& graph) {
+  if (index >= node.input_size() || IsControlInput(node.input(index))) {
+    return nullptr;
+  }
+  int position;
+  const string name = ParseNodeName(node.input(index), &position);
+  if (position != 0) return nullptr;
+  return graph.GetNode(name);
+}
+
+// Returns true if one of the two inputs of 'node' is a scalar constant equal
+// to 'value' up to float rounding, and sets 'other' to the index of the other
+// input.
+bool HasScalarOperand(const NodeDef& node, const GraphProperties& properties,
+                      double value, int* other) {
+  const auto& inputs = properties.GetInputProperties(node.name());
+  if (inputs.size() != 2) return false;
+  for (int i = 0; i < 2; ++i) {
+    double v;
+    if (GetScalarValue(inputs[i], &v) &&
+        std::abs(v - value) <= 1e-6 * std::abs(value)) {
+      *other = 1 - i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if 'node' is 'op', placed and typed like 'like', and can be
+// fused away as a node with 'num_fanouts' consumers in the matched pattern.
+bool IsFusibleIntermediate(const NodeDef* node, const string& op,
+                           const NodeDef& like, const GraphView& graph,
+                           const std::unordered_set<string>& nodes_to_preserve,
+                           int num_fanouts) {
+  return node != nullptr && node->op() == op &&
+         node->device() == like.device() && node->attr().count("T") > 0 &&
+         node->attr().at("T").type() == like.attr().at("T").type() &&
+         nodes_to_preserve.count(node->name()) == 0 &&
+         graph.GetFanoutEdges(*node, true).size() ==
+             static_cast<size_t>(num_fanouts);
+}
+
+// Returns true if 'mean' is a Mean of 'x' over its last dimension that keeps
+// the reduced dimension.
+bool IsMeanOverLastDim(const NodeDef& mean, const string& x,
+                       const GraphProperties& properties) {
+  if (mean.input_size() < 2 || mean.input(0) != x ||
+      !GetBoolAttr(mean, "keep_dims")) {
+    return false;
+  }
+  const auto& inputs = properties.GetInputProperties(mean.name());
+  if (inputs.size() != 2 || !inputs[1].has_value() ||
+      inputs[0].shape().unknown_rank()) {
+    return false;
+  }
+  Tensor axes;
+  if (!axes.FromProto(inputs[1].value()) || axes.NumElements() != 1) {
+    return false;
+  }
+  int64 axis;
+  if (axes.dtype() == DT_INT32) {
+    axis = axes.flat<int32>()(0);
+  } else if (axes.dtype() == DT_INT64) {
+    axis = axes.flat<int64>()(0);
+  } else {
+    return false;
+  }
+  const int rank = inputs[0].shape().dim_size();
+  return axis == -1 || axis == rank - 1;
+}
+
+// Returns true if 'properties' is a vector of the size of the last dimension
+// of 'x', which is known.
+bool IsVectorOfLastDim(const OpInfo::TensorProperties& properties,
+                       const OpInfo::TensorProperties& x) {
+  if (properties.shape().unknown_rank() || x.shape().unknown_rank() ||
+      properties.shape().dim_size() != 1 || x.shape().dim_size() == 0) {
+    return false;
+  }
+  const int64 depth = x.shape().dim(x.shape().dim_size() - 1).size();
+  return depth >= 0 && properties.shape().dim(0).size() == depth;
+}
+
+// Finds the layer normalizations computed by tf.nn.moments and
+// tf.nn.batch_normalization over the last dimension, as done by
+// tf.contrib.layers.layer_norm:
+//   mean = Mean(x), variance = Mean(SquaredDifference(x, [StopGradient](mean)))
+//   inv = Rsqrt(variance + epsilon) * scale
+//   y = x * inv + (offset - mean * inv)
+// and replaces each of them by a single _FusedLayerNorm node with the name of
+// the last Add. Operands of commutative ops may come in either order.
+void FuseLayerNorms(const GrapplerItem& item,
+                    const GraphProperties& properties,
+                    const GraphView& graph, bool cluster_has_gpu,
+                    std::unordered_map<string, NodeDef>* fused_nodes,
+                    std::unordered_set<string>* fused_away) {
+  const std::unordered_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != "Add" || !IsFloatOnCpu(node, cluster_has_gpu)) continue;
+    auto is_intermediate = [&](const NodeDef* n, const string& op,
+                               int num_fanouts) {
+      return IsFusibleIntermediate(n, op, node, graph, nodes_to_preserve,
+                                   num_fanouts);
+    };
+    for (int i = 0; i < 2; ++i) {
+      // y = x * inv + (offset - mean * inv)
+      const NodeDef* mul_x = GetInputNode(node, i, graph);
+      const NodeDef* sub = GetInputNode(node, 1 - i, graph);
+      if (!is_intermediate(mul_x, "Mul", 1) ||
+          !is_intermediate(sub, "Sub", 1)) {
+        continue;
+      }
+      const NodeDef* mul_mean = GetInputNode(*sub, 1, graph);
+      if (!is_intermediate(mul_mean, "Mul", 1)) continue;
+      for (int j = 0; j < 4; ++j) {
+        const string& inv_name = mul_x->input(j / 2);
+        if (mul_mean->input(j % 2) != inv_name) continue;
+        const string& x = mul_x->input(1 - j / 2);
+        const NodeDef* mean = GetInputNode(*mul_mean, 1 - j % 2, graph);
+        const NodeDef* inv = GetInputNode(*mul_x, j / 2, graph);
+        if (!is_intermediate(mean, "Mean", 2) ||
+            !is_intermediate(inv, "Mul", 2) ||
+            !IsMeanOverLastDim(*mean, x, properties)) {
+          continue;
+        }
+
+        // inv = Rsqrt(variance + epsilon) * scale
+        const NodeDef* rsqrt = nullptr;
+        string scale;
+        for (int k = 0; k < 2 && rsqrt == nullptr; ++k) {
+          const NodeDef* n = GetInputNode(*inv, k, graph);
+          if (is_intermediate(n, "Rsqrt", 1)) {
+            rsqrt = n;
+            scale = inv->input(1 - k);
+          }
+        }
+        if (rsqrt == nullptr) continue;
+        const NodeDef* add_epsilon = GetInputNode(*rsqrt, 0, graph);
+        if (!is_intermediate(add_epsilon, "Add", 1)) continue;
+        const auto& add_inputs =
+            properties.GetInputProperties(add_epsilon->name());
+        double epsilon;
+        const NodeDef* variance = nullptr;
+        for (int k = 0; k < 2 && variance == nullptr; ++k) {
+          if (add_inputs.size() == 2 &&
+              GetScalarValue(add_inputs[k], &epsilon)) {
+            variance = GetInputNode(*add_epsilon, 1 - k, graph);
+          }
+        }
+        if (!is_intermediate(variance, "Mean", 1)) continue;
+
+        // variance = Mean(SquaredDifference(x, [StopGradient](mean)))
+        const NodeDef* squared_difference = GetInputNode(*variance, 0, graph);
+        if (!is_intermediate(squared_difference, "SquaredDifference", 1) ||
+            !IsMeanOverLastDim(*variance, variance->input(0), properties)) {
+          continue;
+        }
+        const NodeDef* stop_gradient = nullptr;
+        bool reads_x_and_mean = false;
+        for (int k = 0; k < 2 && !reads_x_and_mean; ++k) {
+          if (squared_difference->input(k) != x) continue;
+          const NodeDef* n = GetInputNode(*squared_difference, 1 - k, graph);
+          if (n == mean) {
+            reads_x_and_mean = true;
+          } else if (is_intermediate(n, "StopGradient", 1) &&
+                     GetInputNode(*n, 0, graph) == mean) {
+            stop_gradient = n;
+            reads_x_and_mean = true;
+          }
+        }
+        if (!reads_x_and_mean) continue;
+
+        const auto& inputs = properties.GetInputProperties(mul_x->name());
+        const auto& inv_inputs = properties.GetInputProperties(inv->name());
+        const auto& sub_inputs = properties.GetInputProperties(sub->name());
+        const auto& outputs = properties.GetOutputProperties(node.name());
+        if (inputs.size() != 2 || inv_inputs.size() != 2 ||
+            sub_inputs.size() != 2 || outputs.size() != 1) {
+          continue;
+        }
+        const OpInfo::TensorProperties& x_properties = inputs[1 - j / 2];
+        if (!ShapeIsSymbolicallyDefined(x_properties) ||
+            !ShapesSymbolicallyEqual(outputs[0], x_properties) ||
+            !IsVectorOfLastDim(inv_inputs[inv->input(0) == scale ? 0 : 1],
+                               x_properties) ||
+            !IsVectorOfLastDim(sub_inputs[0], x_properties)) {
+          continue;
+        }
+
+        std::vector<const NodeDef*> chain = {
+            mean,     squared_difference, variance, add_epsilon, rsqrt,
+            inv,      mul_x,              mul_mean, sub,         &node};
+        if (stop_gradient != nullptr) chain.push_back(stop_gradient);
+        bool already_fused = false;
+        for (const NodeDef* n : chain) {
+          if (fused_away->count(n->name()) > 0 ||
+              fused_nodes->count(n->name()) > 0) {
+            already_fused = true;
+          }
+        }
+        if (already_fused) continue;
+
+        NodeDef fused;
+        fused.set_name(node.name());
+        fused.set_op("_FusedLayerNorm");
+        fused.set_device(node.device());
+        *fused.add_input() = x;
+        *fused.add_input() = scale;
+        *fused.add_input() = sub->input(0);
+        (*fused.mutable_attr())["T"] = node.attr().at("T");
+        (*fused.mutable_attr())["epsilon"].set_f(epsilon);
+        std::vector<string> control_inputs;
+        for (const NodeDef* n : chain) {
+          for (const string& input : n->input()) {
+            if (IsControlInput(input)) control_inputs.push_back(input);
+          }
+          if (n != &node) fused_away->insert(n->name());
+        }
+        std::sort(control_inputs.begin(), control_inputs.end());
+        control_inputs.erase(
+            std::unique(control_inputs.begin(), control_inputs.end()),
+            control_inputs.end());
+        for (const string& input : control_inputs) {
+          *fused.add_input() = input;
+        }
+        VLOG(1) << "Fusing a layer norm of " << chain.size()
+                << " nodes into " << fused.DebugString();
+        (*fused_nodes)[node.name()] = std::move(fused);
+        break;
+      }
+      if (fused_nodes->count(node.name()) > 0) break;
+    }
+  }
+}
+
+// Finds the GELU activations spelled out with the tanh approximation, as
+// done by BERT:
+//   y = x * (0.5 * (1 + Tanh(sqrt(2 / pi) * (x + 0.044715 * Pow(x, 3)))))
+// optionally preceded by the BiasAdd computing x, and replaces each of them
+// by a single _FusedBiasGelu node with the name of the last Mul. Operands of
+// commutative ops may come in either order.
+void FuseBiasGelus(const GrapplerItem& item,
+                   const GraphProperties& properties, const GraphView& graph,
+                   bool cluster_has_gpu,
+                   std::unordered_map<string, NodeDef>* fused_nodes,
+                   std::unordered_set<string>* fused_away) {
+  const std::unordered_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != "Mul" || !IsFloatOnCpu(node, cluster_has_gpu)) continue;
+    auto is_intermediate = [&](const NodeDef* n, const string& op) {
+      return IsFusibleIntermediate(n, op, node, graph, nodes_to_preserve, 1);
+    };
+    for (int i = 0; i < 2; ++i) {
+      const string& x = node.input(i);
+      int other;
+      const NodeDef* cdf = GetInputNode(node, 1 - i, graph);
+      if (!is_intermediate(cdf, "Mul") ||
+          !HasScalarOperand(*cdf, properties, 0.5, &other)) {
+        continue;
+      }
+      const NodeDef* add_one = GetInputNode(*cdf, other, graph);
+      if (!is_intermediate(add_one, "Add") ||
+          !HasScalarOperand(*add_one, properties, 1.0, &other)) {
+        continue;
+      }
+      const NodeDef* tanh = GetInputNode(*add_one, other, graph);
+      if (!is_intermediate(tanh, "Tanh")) continue;
+      const NodeDef* scaled = GetInputNode(*tanh, 0, graph);
+      if (!is_intermediate(scaled, "Mul") ||
+          !HasScalarOperand(*scaled, properties, 0.7978845608028654,
+                            &other)) {
+        continue;
+      }
+      const NodeDef* add_cube = GetInputNode(*scaled, other, graph);
+      if (!is_intermediate(add_cube, "Add")) continue;
+      const NodeDef* scaled_cube = nullptr;
+      for (int k = 0; k < 2 && scaled_cube == nullptr; ++k) {
+        if (add_cube->input(k) == x) {
+          scaled_cube = GetInputNode(*add_cube, 1 - k, graph);
+        }
+      }
+      if (!is_intermediate(scaled_cube, "Mul") ||
+          !HasScalarOperand(*scaled_cube, properties, 0.044715, &other)) {
+        continue;
+      }
+      const NodeDef* cube = GetInputNode(*scaled_cube, other, graph);
+      if (!is_intermediate(cube, "Pow") || cube->input(0) != x ||
+          !HasScalarOperand(*cube, properties, 3.0, &other) || other != 0) {
+        continue;
+      }
+      const auto& inputs = properties.GetInputProperties(node.name());
+      const auto& outputs = properties.GetOutputProperties(node.name());
+      if (inputs.size() != 2 || outputs.size() != 1 ||
+          !ShapeIsSymbolicallyDefined(inputs[i]) ||
+          !ShapesSymbolicallyEqual(outputs[0], inputs[i])) {
+        continue;
+      }
+
+      std::vector<const NodeDef*> chain = {cube, scaled_cube, add_cube, scaled,
+                                           tanh, add_one,     cdf,      &node};
+      // x is read by the Pow, the Add and the last Mul.
+      const NodeDef* bias_add = GetInputNode(node, i, graph);
+      if (IsFusibleIntermediate(bias_add, "BiasAdd", node, graph,
+                                nodes_to_preserve, 3) &&
+          HasDataFormat(*bias_add, "NHWC")) {
+        chain.insert(chain.begin(), bias_add);
+      } else {
+        bias_add = nullptr;
+      }
+      bool already_fused = false;
+      for (const NodeDef* n : chain) {
+        if (fused_away->count(n->name()) > 0 ||
+            fused_nodes->count(n->name()) > 0) {
+          already_fused = true;
+        }
+      }
+      if (already_fused) continue;
+
+      NodeDef fused;
+      fused.set_name(node.name());
+      fused.set_op("_FusedBiasGelu");
+      fused.set_device(node.device());
+      if (bias_add != nullptr) {
+        *fused.add_input() = bias_add->input(0);
+        *fused.add_input() = bias_add->input(1);
+      } else {
+        *fused.add_input() = x;
+      }
+      (*fused.mutable_attr())["T"] = node.attr().at("T");
+      (*fused.mutable_attr())["num_biases"].set_i(bias_add != nullptr ? 1 : 0);
+      std::vector<string> control_inputs;
+      for (const NodeDef* n : chain) {
+        for (const string& input : n->input()) {
+          if (IsControlInput(input)) control_inputs.push_back(input);
+        }
+        if (n != &node) fused_away->insert(n->name());
+      }
+      std::sort(control_inputs.begin(), control_inputs.end());
+      control_inputs.erase(
+          std::unique(control_inputs.begin(), control_inputs.end()),
+          control_inputs.end());
+      for (const string& input : control_inputs) {
+        *fused.add_input() = input;
+      }
+      VLOG(1) << "Fusing a GELU of " << chain.size() << " nodes into "
+              << fused.DebugString();
+      (*fused_nodes)[node.name()] = std::move(fused);
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
                           GraphDef* optimized_graph) {
   GraphProperties properties(item);
   TF_RETURN_IF_ERROR(properties.InferStatically(false));
   GraphView graph(const_cast<GraphDef*>(&item.graph));
 
+  // Without a cluster, only nodes that are explicitly placed on CPU are
+  // known to run there.
+  bool cluster_has_gpu = true;
+  if (cluster != nullptr) {
+    cluster_has_gpu = false;
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() != "CPU") cluster_has_gpu = true;
+    }
+  }
+  std::unordered_map<string, NodeDef> fused_nodes;
+  std::unordered_set<string> fused_away;
+  // The larger patterns go first, as some of their nodes would otherwise be
+  // taken by a chain of cwise ops.
+  FuseAttentionChains(item, properties, graph, cluster_has_gpu, &fused_nodes,
+                      &fused_away);
+  FuseLayerNorms(item, properties, graph, cluster_has_gpu, &fused_nodes,
+                 &fused_away);
+  FuseBiasGelus(item, properties, graph, cluster_has_gpu, &fused_nodes,
+                &fused_away);
+  FuseElementwiseChains(item, properties, graph, cluster_has_gpu, &fused_nodes,
+                        &fused_away);
+  FuseConv2DChains(item, properties, graph, cluster_has_gpu, &fused_nodes,
+                   &fused_away);
+
   // During inference, most of the inputs to FusedBatchNorm are constant, and we
   // can therefore replace the op with a much cheaper set of primitives.
   for (const NodeDef& node : item.graph.node()) {
+    if (fused_away.count(node.name()) > 0) continue;
+    auto fused = fused_nodes.find(node.name());
+    if (fused != fused_nodes.end()) {
+      *optimized_graph->add_node() = std::move(fused->second);
+      continue;
+    }
     if (node.op() == "FusedBatchNorm" || node.op() == "FusedBatchNormV2") {
       bool optimizable = (node.attr().count("T") == 0 ||
                           node.attr().at("T").type() == DT_FLOAT);
@@ -91,5 +91,389 @@ TEST_F(RemapperTest, FusedBatchNormNCHW) {
   }
 }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, -2.0f, 3.0f, -4.0f}, {2, 2});
+  Output a = ops::Const(s.WithOpName("a"), {0.5f, 0.5f, 2.0f, 2.0f}, {2, 2});
+  Output b = ops::Const(s.WithOpName("b"), {3.0f, 1.0f, 2.0f, 4.0f}, {2, 2});
+  Output scalar = ops::Const(s.WithOpName("scalar"), 2.0f, {});
+  Output mul = ops::Mul(s.WithOpName("mul"), x, a);
+  Output add = ops::Add(s.WithOpName("add"), b, mul);
+  Output relu = ops::Relu(s.WithOpName("relu"), add);
+  Output sigmoid = ops::Sigmoid(s.WithOpName("sigmoid"), relu);
+  // Broadcasts, so it is not fused.
+  Output scaled = ops::Mul(s.WithOpName("scaled"), sigmoid, scalar);
+  Output neg = ops::Neg(s.WithOpName("neg"), scaled);
+  Output exp = ops::Exp(s.WithOpName("exp"), neg);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"exp"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("mul", node.name());
+    EXPECT_NE("add", node.name());
+    EXPECT_NE("relu", node.name());
+    EXPECT_NE("neg", node.name());
+    if (node.name() == "sigmoid") {
+      ++found;
+      EXPECT_EQ("_FusedElementwise", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("x", node.input(0));
+      EXPECT_EQ("a", node.input(1));
+      EXPECT_EQ("b", node.input(2));
+      const auto& ops = node.attr().at("ops").list();
+      ASSERT_EQ(4, ops.s_size());
+      EXPECT_EQ("Mul", ops.s(0));
+      EXPECT_EQ("Add", ops.s(1));
+      EXPECT_EQ("Relu", ops.s(2));
+      EXPECT_EQ("Sigmoid", ops.s(3));
+      const auto& chain_is_lhs = node.attr().at("chain_is_lhs").list();
+      ASSERT_EQ(4, chain_is_lhs.b_size());
+      EXPECT_TRUE(chain_is_lhs.b(0));
+      EXPECT_FALSE(chain_is_lhs.b(1));
+    } else if (node.name() == "scaled") {
+      ++found;
+      EXPECT_EQ("Mul", node.op());
+    } else if (node.name() == "exp") {
+      ++found;
+      EXPECT_EQ("_FusedElementwise", node.op());
+      ASSERT_EQ(1, node.input_size());
+      EXPECT_EQ("scaled", node.input(0));
+    }
+  }
+  EXPECT_EQ(3, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseConv2DWithBiasAddBatchNormAndRelu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({2, 5, 5, 3}));
+  Output filter = ops::Const(s.WithOpName("filter"),
+                             GenerateRandomTensor<DT_FLOAT>({3, 3, 3, 4}));
+  Output bias = ops::Const(s.WithOpName("bias"), {0.1f, -0.2f, 0.3f, -0.4f},
+                           {4});
+  Output scale = ops::Const(s.WithOpName("scale"), {0.5f, 1.5f, 2.0f, 1.0f},
+                            {4});
+  Output offset = ops::Const(s.WithOpName("offset"),
+                             {0.25f, -0.5f, 0.0f, 1.0f}, {4});
+  Output mean = ops::Const(s.WithOpName("mean"), {0.1f, 0.2f, -0.3f, 0.4f},
+                           {4});
+  Output variance = ops::Const(s.WithOpName("variance"),
+                               {0.5f, 1.0f, 2.0f, 0.25f}, {4});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 2, 2, 1},
+                            "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  ops::FusedBatchNorm bn(s.WithOpName("batch_norm"), bias_add, scale, offset,
+                         mean, variance,
+                         ops::FusedBatchNorm::IsTraining(false));
+  Output relu = ops::Relu(s.WithOpName("relu"), bn.y);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("conv", node.name());
+    EXPECT_NE("bias_add", node.name());
+    EXPECT_NE("batch_norm", node.name());
+    if (node.name() == "relu") {
+      ++found;
+      EXPECT_EQ("_FusedConv2D", node.op());
+      ASSERT_EQ(7, node.input_size());
+      EXPECT_EQ("input", node.input(0));
+      EXPECT_EQ("filter", node.input(1));
+      EXPECT_EQ("bias", node.input(2));
+      EXPECT_EQ("scale", node.input(3));
+      EXPECT_EQ("variance", node.input(6));
+      EXPECT_EQ(5, node.attr().at("num_args").i());
+      const auto& fused_ops = node.attr().at("fused_ops").list();
+      ASSERT_EQ(3, fused_ops.s_size());
+      EXPECT_EQ("BiasAdd", fused_ops.s(0));
+      EXPECT_EQ("FusedBatchNorm", fused_ops.s(1));
+      EXPECT_EQ("Relu", fused_ops.s(2));
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(1, tensors.size());
+  // The bias and batch norm are folded differently, so allow for rounding.
+  test::ExpectClose(tensors_expected[0], tensors[0], 1e-3, 1e-4);
+}
+
+TEST_F(RemapperTest, FuseConv2DWithBiasAddOnly) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({1, 4, 4, 2}));
+  Output filter = ops::Const(s.WithOpName("filter"),
+                             GenerateRandomTensor<DT_FLOAT>({2, 2, 2, 3}));
+  Output bias = ops::Const(s.WithOpName("bias"), {0.1f, -0.2f, 0.3f}, {3});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "VALID");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  // The convolution is also fetched, so it can't be fused away.
+  Output conv2 = ops::Conv2D(s.WithOpName("conv2"), input, filter,
+                             {1, 1, 1, 1}, "VALID");
+  Output bias_add2 = ops::BiasAdd(s.WithOpName("bias_add2"), conv2, bias);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"bias_add", "conv2", "bias_add2"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("conv", node.name());
+    if (node.name() == "bias_add") {
+      ++found;
+      EXPECT_EQ("_FusedConv2D", node.op());
+      EXPECT_EQ(1, node.attr().at("num_args").i());
+    } else if (node.name() == "bias_add2") {
+      ++found;
+      EXPECT_EQ("BiasAdd", node.op());
+    }
+  }
+  EXPECT_EQ(2, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(3, tensors.size());
+  // The bias and batch norm are folded differently, so allow for rounding.
+  test::ExpectClose(tensors_expected[0], tensors[0], 1e-3, 1e-4);
+}
+
+TEST_F(RemapperTest, FuseAttention) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output query = ops::Const(s.WithOpName("query"),
+                            GenerateRandomTensor<DT_FLOAT>({2, 3, 5, 4}));
+  Output key = ops::Const(s.WithOpName("key"),
+                          GenerateRandomTensor<DT_FLOAT>({2, 3, 7, 4}));
+  Output value = ops::Const(s.WithOpName("value"),
+                            GenerateRandomTensor<DT_FLOAT>({2, 3, 7, 6}));
+  Output mask = ops::Const(s.WithOpName("mask"),
+                           GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 7}));
+  Output scale = ops::Const(s.WithOpName("scale"), 2.0f);
+  Output scores = ops::BatchMatMul(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMul::AdjY(true));
+  Output scaled = ops::RealDiv(s.WithOpName("scaled"), scores, scale);
+  Output masked = ops::Add(s.WithOpName("masked"), mask, scaled);
+  Output weights = ops::Softmax(s.WithOpName("weights"), masked);
+  Output attention = ops::BatchMatMul(s.WithOpName("attention"), weights,
+                                      value);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"attention"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("scores", node.name());
+    EXPECT_NE("scaled", node.name());
+    EXPECT_NE("masked", node.name());
+    EXPECT_NE("weights", node.name());
+    if (node.name() == "attention") {
+      ++found;
+      EXPECT_EQ("_FusedAttention", node.op());
+      ASSERT_EQ(4, node.input_size());
+      EXPECT_EQ("query", node.input(0));
+      EXPECT_EQ("key", node.input(1));
+      EXPECT_EQ("value", node.input(2));
+      EXPECT_EQ("mask", node.input(3));
+      EXPECT_EQ(1, node.attr().at("num_masks").i());
+      EXPECT_EQ(0.5f, node.attr().at("scale").f());
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-5);
+}
+
+TEST_F(RemapperTest, DoNotFuseAttentionWithFetchedWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output query = ops::Const(s.WithOpName("query"),
+                            GenerateRandomTensor<DT_FLOAT>({3, 5, 4}));
+  Output key = ops::Const(s.WithOpName("key"),
+                          GenerateRandomTensor<DT_FLOAT>({3, 7, 4}));
+  Output value = ops::Const(s.WithOpName("value"),
+                            GenerateRandomTensor<DT_FLOAT>({3, 7, 4}));
+  Output scores = ops::BatchMatMul(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMul::AdjY(true));
+  Output weights = ops::Softmax(s.WithOpName("weights"), scores);
+  Output attention = ops::BatchMatMul(s.WithOpName("attention"), weights,
+                                      value);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"weights", "attention"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("_FusedAttention", node.op());
+  }
+}
+
+TEST_F(RemapperTest, FuseLayerNorm) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output x = ops::Const(s.WithOpName("x"),
+                        GenerateRandomTensor<DT_FLOAT>({2, 3, 8}));
+  Output gamma = ops::Const(s.WithOpName("gamma"),
+                            GenerateRandomTensor<DT_FLOAT>({8}));
+  Output beta = ops::Const(s.WithOpName("beta"),
+                           GenerateRandomTensor<DT_FLOAT>({8}));
+  Output axes = ops::Const(s.WithOpName("axes"), {2}, {1});
+  Output epsilon = ops::Const(s.WithOpName("epsilon"), 1e-6f);
+  // As built by tf.nn.moments and tf.nn.batch_normalization.
+  Output mean = ops::Mean(s.WithOpName("mean"), x, axes,
+                          ops::Mean::KeepDims(true));
+  Output stop_gradient = ops::StopGradient(s.WithOpName("stop_gradient"), mean);
+  Output squared_difference = ops::SquaredDifference(
+      s.WithOpName("squared_difference"), x, stop_gradient);
+  Output variance = ops::Mean(s.WithOpName("variance"), squared_difference,
+                              axes, ops::Mean::KeepDims(true));
+  Output add_epsilon = ops::Add(s.WithOpName("add_epsilon"), variance, epsilon);
+  Output rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), add_epsilon);
+  Output inv = ops::Mul(s.WithOpName("inv"), rsqrt, gamma);
+  Output mul_x = ops::Mul(s.WithOpName("mul_x"), x, inv);
+  Output mul_mean = ops::Mul(s.WithOpName("mul_mean"), mean, inv);
+  Output sub = ops::Sub(s.WithOpName("sub"), beta, mul_mean);
+  Output y = ops::Add(s.WithOpName("y"), mul_x, sub);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"y"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("mean", node.name());
+    EXPECT_NE("variance", node.name());
+    EXPECT_NE("mul_x", node.name());
+    if (node.name() == "y") {
+      ++found;
+      EXPECT_EQ("_FusedLayerNorm", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("x", node.input(0));
+      EXPECT_EQ("gamma", node.input(1));
+      EXPECT_EQ("beta", node.input(2));
+      EXPECT_EQ(1e-6f, node.attr().at("epsilon").f());
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-4);
+}
+
+TEST_F(RemapperTest, FuseBiasGelu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateRandomTensor<DT_FLOAT>({4, 8}));
+  Output bias = ops::Const(s.WithOpName("bias"),
+                           GenerateRandomTensor<DT_FLOAT>({8}));
+  Output x = ops::BiasAdd(s.WithOpName("x"), input, bias);
+  // As written in BERT.
+  Output cube = ops::Pow(s.WithOpName("cube"), x, 3.0f);
+  Output scaled_cube =
+      ops::Mul(s.WithOpName("scaled_cube"), 0.044715f, cube);
+  Output add_cube = ops::Add(s.WithOpName("add_cube"), x, scaled_cube);
+  Output scaled = ops::Mul(s.WithOpName("scaled"), 0.7978846f, add_cube);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), scaled);
+  Output add_one = ops::Add(s.WithOpName("add_one"), 1.0f, tanh);
+  Output cdf = ops::Mul(s.WithOpName("cdf"), 0.5f, add_one);
+  Output gelu = ops::Mul(s.WithOpName("gelu"), x, cdf);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gelu"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("x", node.name());
+    EXPECT_NE("tanh", node.name());
+    if (node.name() == "gelu") {
+      ++found;
+      EXPECT_EQ("_FusedBiasGelu", node.op());
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("input", node.input(0));
+      EXPECT_EQ("bias", node.input(1));
+      EXPECT_EQ(1, node.attr().at("num_biases").i());
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-5);
+}
+
+TEST_F(RemapperTest, DoNotFuseChainsOnGpu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, -2.0f}, {2});
+  Output neg = ops::Neg(s.WithOpName("neg").WithDevice("/device:GPU:0"), x);
+  Output exp = ops::Exp(s.WithOpName("exp").WithDevice("/device:GPU:0"), neg);
+  // Not placed, and there may be a GPU.
+  Output relu = ops::Relu(s.WithOpName("relu"), exp);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), relu);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"tanh"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("_FusedElementwise", node.op());
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -650,7 +650,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 };
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
-    const ScopedAllocatorOptions& opts) {
+    const ScopedAllocatorOptions& opts)
+    : max_fused_bytes_(opts.max_fused_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -811,6 +812,35 @@ void PartitionByLoopStructure(const FrameMap& frame_map,
   }
 }
 
+// Splits "nodes", keeping their order, into consecutive runs whose outputs
+// add up to at most "max_bytes" bytes, unless "max_bytes" is not positive or
+// a single output is larger.  Outputs of unknown size count as empty; the
+// Rewriter rejects their nodes later.
+void PartitionBySize(const GraphProperties& graph_properties, int64 max_bytes,
+                     const std::vector<NodeDef*>& nodes,
+                     std::vector<std::vector<NodeDef*>>* size_groups) {
+  int64 group_bytes = 0;
+  for (NodeDef* n : nodes) {
+    int64 bytes = 0;
+    if (graph_properties.HasOutputProperties(n->name())) {
+      const std::vector<OpInfo::TensorProperties>& prop_list =
+          graph_properties.GetOutputProperties(n->name());
+      if (prop_list.size() == 1 &&
+          TensorShape::IsValid(prop_list[0].shape())) {
+        bytes = TensorShape(prop_list[0].shape()).num_elements() *
+                DataTypeSize(prop_list[0].dtype());
+      }
+    }
+    if (size_groups->empty() ||
+        (max_bytes > 0 && group_bytes + bytes > max_bytes)) {
+      size_groups->emplace_back();
+      group_bytes = 0;
+    }
+    size_groups->back().push_back(n);
+    group_bytes += bytes;
+  }
+}
+
 }  // namespace
 
 Status ScopedAllocatorOptimizer::ProcessGraphDef(
@@ -841,7 +871,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(
-            root.get(), [this, rewriter, graph, &frame_map, &op_name](Tree* t) {
+            root.get(), [this, rewriter, graph, &graph_properties, &frame_map,
+                         &op_name](Tree* t) {
               VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                       << t->depth_ << " of size " << t->nodes_.size();
               if (t->nodes_.size() > 1) {
@@ -849,12 +880,19 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
                 PartitionByLoopStructure(frame_map, t->nodes_, &loop_groups);
                 for (auto& lg : loop_groups) {
                   if (lg.size() > 1) {
-                    bool applied = false;
                     Status s = OrderNodeSet(&lg);
                     TF_RETURN_IF_ERROR(s);
-                    VLOG(1) << "Applying Rewriter for " << op_name;
-                    s = rewriter->Rewrite(this, graph, op_name, lg, &applied);
-                    LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                    std::vector<std::vector<NodeDef*>> size_groups;
+                    PartitionBySize(graph_properties, max_fused_bytes_, lg,
+                                    &size_groups);
+                    for (auto& sg : size_groups) {
+                      if (sg.size() < 2) continue;
+                      bool applied = false;
+                      VLOG(1) << "Applying Rewriter for " << op_name;
+                      s = rewriter->Rewrite(this, graph, op_name, sg,
+                                            &applied);
+                      LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                    }
                   }
                 }
               }
@@ -99,6 +99,7 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
   std::unordered_map<string, Rewriter*> rewriters_;
   std::vector<Rewriter*> to_delete_;
   int next_sa_id_ = 1;
+  int64 max_fused_bytes_ = 0;
   std::unique_ptr<NodeMap> node_map_;
 };
 
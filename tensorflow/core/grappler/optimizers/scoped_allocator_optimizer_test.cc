@@ -162,6 +162,34 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, MaxFusedBytes) {
+  // Tests that no ScopedAllocator combines inputs larger than
+  // max_fused_bytes in total.
+  for (int64 max_fused_bytes : {16, 32}) {
+    GrapplerItem item;
+    BuildAbsGraph(&item.graph);
+    SetShapes(&item.graph);
+
+    ScopedAllocatorOptions opts;
+    opts.add_enable_op("Abs");
+    opts.set_max_fused_bytes(max_fused_bytes);
+    ScopedAllocatorOptimizer sao(opts);
+
+    GraphDef optimized_graph;
+    TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+    // Each Abs output holds 16 bytes.
+    NodeMap node_map(&optimized_graph);
+    if (max_fused_bytes < 32) {
+      EXPECT_EQ(nullptr, node_map.GetNode("scoped_allocator_1"));
+      EXPECT_NE(nullptr, node_map.GetNode("a1"));
+      EXPECT_NE(nullptr, node_map.GetNode("a2"));
+    } else {
+      EXPECT_NE(nullptr, node_map.GetNode("scoped_allocator_1"));
+    }
+  }
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Constructs the same graph as UnaryRewriteOnly, but actually executes it.
   GrapplerItem item;
@@ -0,0 +1,327 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/transfer_optimizer.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// The number of elements assumed for the dimensions that can't be inferred,
+// so that tensors of unknown shape are not taken for small ones.
+constexpr int64 kUnknownDimSize = 256;
+// Bounds the estimates, so that they don't overflow.
+constexpr int64 kMaxNumElements = 1LL << 40;
+// Moving a node can make its neighbors worth moving too, so the graph is
+// traversed until nothing moves, at most this many times.
+constexpr int kMaxPasses = 8;
+
+// The ops that are cheap next to a transfer of their inputs or outputs, and
+// that don't care where they run.
+bool IsMovable(const NodeDef& node) {
+  static const std::unordered_set<string>* kMovableOps =
+      new std::unordered_set<string>({"Cast", "ExpandDims", "Rank", "Reshape",
+                                      "Shape", "ShapeN", "Size", "Squeeze"});
+  return kMovableOps->count(node.op()) > 0;
+}
+
+// The estimated size in bytes of a tensor, or -1 if its type has no fixed
+// size.
+int64 EstimateBytes(const OpInfo::TensorProperties& properties) {
+  const int64 type_size = DataTypeSize(properties.dtype());
+  if (type_size == 0) return -1;
+  const TensorShapeProto& shape = properties.shape();
+  if (shape.unknown_rank()) return type_size * kUnknownDimSize;
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    num_elements *= dim.size() >= 0 ? dim.size() : kUnknownDimSize;
+    num_elements = std::min(num_elements, kMaxNumElements);
+  }
+  return type_size * num_elements;
+}
+
+class TransferOptimizerImpl {
+ public:
+  TransferOptimizerImpl(const std::unordered_set<string>& nodes_to_preserve,
+                        const GraphProperties& properties, GraphDef* graph)
+      : nodes_to_preserve_(nodes_to_preserve),
+        properties_(properties),
+        graph_(graph) {}
+
+  Status Optimize();
+
+ private:
+  // The estimated size of an output of a node, or -1 if unknown.
+  int64 OutputBytes(int node, int port) const;
+
+  // Returns the bytes transferred to and from "node" if it runs on "device",
+  // or -1 if the size of any of them is unknown. An input that is already
+  // sent to "device" for another consumer costs nothing more, unless that
+  // consumer is movable too: the nodes that only need e.g. the shape of a
+  // remote tensor would otherwise keep each other from moving.
+  int64 TransferBytes(int node, const string& device) const;
+
+  bool HasKernel(const NodeDef& node, const string& device) const;
+
+  // Moves "node" to the device of one of its inputs or consumers that lowers
+  // its transfers the most, if any. Returns true if it moved.
+  bool MaybeMove(int node);
+
+  // Makes the consumers of identical movable nodes on the same device read
+  // the first of them, and turns the others into Identity ops of it.
+  int MergeDuplicates();
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  const GraphProperties& properties_;
+  GraphDef* graph_;
+
+  std::unordered_map<string, int> node_index_;
+  // The data inputs of every node, as (node, port) pairs.
+  std::vector<std::vector<std::pair<int, int>>> inputs_;
+  // The data consumers of every output of every node.
+  std::vector<std::vector<std::vector<int>>> fanouts_;
+};
+
+int64 TransferOptimizerImpl::OutputBytes(int node, int port) const {
+  const string& name = graph_->node(node).name();
+  if (!properties_.HasOutputProperties(name)) return -1;
+  const auto& outputs = properties_.GetOutputProperties(name);
+  if (port >= outputs.size()) return -1;
+  return EstimateBytes(outputs[port]);
+}
+
+int64 TransferOptimizerImpl::TransferBytes(int node,
+                                           const string& device) const {
+  int64 bytes = 0;
+  for (const auto& input : inputs_[node]) {
+    if (graph_->node(input.first).device() == device) continue;
+    bool already_sent = false;
+    for (int consumer : fanouts_[input.first][input.second]) {
+      const NodeDef& other = graph_->node(consumer);
+      if (consumer != node && other.device() == device && !IsMovable(other)) {
+        already_sent = true;
+        break;
+      }
+    }
+    if (already_sent) continue;
+    const int64 input_bytes = OutputBytes(input.first, input.second);
+    if (input_bytes < 0) return -1;
+    bytes += input_bytes;
+  }
+  for (int port = 0; port < fanouts_[node].size(); ++port) {
+    // The partitioner sends an output once to every other device.
+    std::set<string> devices;
+    for (int consumer : fanouts_[node][port]) {
+      if (graph_->node(consumer).device() != device) {
+        devices.insert(graph_->node(consumer).device());
+      }
+    }
+    if (devices.empty()) continue;
+    const int64 output_bytes = OutputBytes(node, port);
+    if (output_bytes < 0) return -1;
+    bytes += devices.size() * output_bytes;
+  }
+  return bytes;
+}
+
+bool TransferOptimizerImpl::HasKernel(const NodeDef& node,
+                                      const string& device) const {
+  DeviceNameUtils::ParsedName parsed_name;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed_name) ||
+      !parsed_name.has_type) {
+    return false;
+  }
+  NodeDef moved = node;
+  moved.set_device(device);
+  return FindKernelDef(DeviceType(parsed_name.type), moved, nullptr, nullptr)
+      .ok();
+}
+
+bool TransferOptimizerImpl::MaybeMove(int node_index) {
+  const NodeDef& node = graph_->node(node_index);
+  // Nodes colocated with others must stay with them.
+  if (!IsMovable(node) || node.device().empty() ||
+      nodes_to_preserve_.count(node.name()) > 0 ||
+      node.attr().count("_class") > 0) {
+    return false;
+  }
+  std::set<string> devices;
+  for (const auto& input : inputs_[node_index]) {
+    devices.insert(graph_->node(input.first).device());
+  }
+  for (const auto& consumers : fanouts_[node_index]) {
+    for (int consumer : consumers) {
+      devices.insert(graph_->node(consumer).device());
+    }
+  }
+  devices.erase(node.device());
+  devices.erase("");
+  if (devices.empty()) return false;
+
+  int64 best_bytes = TransferBytes(node_index, node.device());
+  if (best_bytes <= 0) return false;
+  string best_device;
+  for (const string& device : devices) {
+    const int64 bytes = TransferBytes(node_index, device);
+    if (bytes >= 0 && bytes < best_bytes && HasKernel(node, device)) {
+      best_bytes = bytes;
+      best_device = device;
+    }
+  }
+  if (best_device.empty()) return false;
+  VLOG(2) << "Moving " << node.name() << " from " << node.device() << " to "
+          << best_device;
+  graph_->mutable_node(node_index)->set_device(best_device);
+  return true;
+}
+
+int TransferOptimizerImpl::MergeDuplicates() {
+  std::unordered_map<string, int> first_nodes;
+  std::unordered_map<string, string> merged;
+  for (int i = 0; i < graph_->node_size(); ++i) {
+    const NodeDef& node = graph_->node(i);
+    // ShapeN has several outputs, that its Identity couldn't forward.
+    if (!IsMovable(node) || node.op() == "ShapeN" ||
+        nodes_to_preserve_.count(node.name()) > 0 || HasControlInputs(node) ||
+        !properties_.HasOutputProperties(node.name())) {
+      continue;
+    }
+    string key = strings::StrCat(node.op(), "|", node.device());
+    for (const string& input : node.input()) {
+      strings::StrAppend(&key, "|", input);
+    }
+    const std::map<string, AttrValue> attrs(node.attr().begin(),
+                                            node.attr().end());
+    for (const auto& attr : attrs) {
+      strings::StrAppend(&key, "|", attr.first, "=",
+                         attr.second.SerializeAsString());
+    }
+    auto it = first_nodes.emplace(key, i);
+    if (it.second) continue;
+
+    const string& first = graph_->node(it.first->second).name();
+    const DataType type =
+        properties_.GetOutputProperties(node.name())[0].dtype();
+    merged[node.name()] = first;
+    NodeDef* duplicate = graph_->mutable_node(i);
+    duplicate->set_op("Identity");
+    duplicate->clear_input();
+    duplicate->add_input(first);
+    duplicate->clear_attr();
+    (*duplicate->mutable_attr())["T"].set_type(type);
+  }
+  if (merged.empty()) return 0;
+
+  for (NodeDef& node : *graph_->mutable_node()) {
+    if (merged.count(node.name()) > 0) continue;
+    for (int j = 0; j < node.input_size(); ++j) {
+      auto it = merged.find(NodeName(node.input(j)));
+      if (it == merged.end()) continue;
+      node.set_input(j, IsControlInput(node.input(j))
+                            ? AsControlDependency(it->second)
+                            : it->second);
+    }
+  }
+  return merged.size();
+}
+
+Status TransferOptimizerImpl::Optimize() {
+  const int num_nodes = graph_->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    node_index_[graph_->node(i).name()] = i;
+  }
+  inputs_.resize(num_nodes);
+  fanouts_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : graph_->node(i).input()) {
+      if (IsControlInput(input)) continue;
+      int port;
+      auto it = node_index_.find(ParseNodeName(input, &port));
+      if (it == node_index_.end()) continue;
+      inputs_[i].emplace_back(it->second, port);
+      auto& fanouts = fanouts_[it->second];
+      if (fanouts.size() <= port) fanouts.resize(port + 1);
+      fanouts[port].push_back(i);
+    }
+  }
+
+  int num_moved = 0;
+  for (int pass = 0; pass < kMaxPasses; ++pass) {
+    bool moved = false;
+    for (int i = 0; i < num_nodes; ++i) {
+      if (MaybeMove(i)) {
+        moved = true;
+        ++num_moved;
+      }
+    }
+    if (!moved) break;
+  }
+  const int num_merged = MergeDuplicates();
+  VLOG(1) << "Moved " << num_moved << " nodes and merged " << num_merged
+          << " to reduce the transfers between devices";
+  return Status::OK();
+}
+
+}  // namespace
+
+Status TransferOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* output) {
+  *output = item.graph;
+  std::unordered_set<string> devices;
+  for (const NodeDef& node : item.graph.node()) {
+    devices.insert(node.device());
+  }
+  if (devices.size() < 2) {
+    return Status::OK();
+  }
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  TransferOptimizerImpl impl(nodes_to_preserve, properties, output);
+  Status status = impl.Optimize();
+  if (!status.ok()) {
+    *output = item.graph;
+  }
+  return status;
+}
+
+void TransferOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                 const GraphDef& optimize_output,
+                                 double result) {
+  // Nothing to do for TransferOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_TRANSFER_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_TRANSFER_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Refines the placement of the cheap ops next to device boundaries, e.g.
+// Shape, Cast and Reshape, to reduce the bytes the partitioned graph
+// transfers between devices. Each of them is moved to the device of one of
+// its inputs or consumers when that lowers the size, inferred statically, of
+// the tensors sent to or from it. Identical ops that end up on the same
+// device are then merged, so that their inputs and outputs are transferred
+// once.
+class TransferOptimizer : public GraphOptimizer {
+ public:
+  TransferOptimizer() {}
+
+  ~TransferOptimizer() override {}
+
+  string name() const override { return "transfer_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimize_output, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_TRANSFER_OPTIMIZER_H_
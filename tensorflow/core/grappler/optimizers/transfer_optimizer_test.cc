@@ -0,0 +1,136 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/transfer_optimizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kPs[] = "/job:ps/replica:0/task:0/device:CPU:0";
+const char kWorker[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+class TransferOptimizerTest : public GrapplerTest {};
+
+// The local session only has one device.
+GraphDef ClearDevices(const GraphDef& graph) {
+  GraphDef result = graph;
+  for (NodeDef& node : *result.mutable_node()) {
+    node.clear_device();
+  }
+  return result;
+}
+
+TEST_F(TransferOptimizerTest, MoveShapesToTheirInputs) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope ps = s.WithDevice(kPs);
+  tensorflow::Scope worker = s.WithDevice(kWorker);
+  Output x = ops::Placeholder(ps.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({100, 100}));
+  // Both only need the shape of x, and are duplicates of each other.
+  Output shape1 = ops::Shape(worker.WithOpName("shape1"), x);
+  Output shape2 = ops::Shape(worker.WithOpName("shape2"), x);
+  Output out1 = ops::Identity(worker.WithOpName("out1"), shape1);
+  Output out2 = ops::Identity(worker.WithOpName("out2"), shape2);
+  GrapplerItem item;
+  item.fetch = {"out1", "out2"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TransferOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* shape1_node = node_map.GetNode("shape1");
+  ASSERT_NE(nullptr, shape1_node);
+  EXPECT_EQ("Shape", shape1_node->op());
+  EXPECT_EQ(kPs, shape1_node->device());
+  const NodeDef* shape2_node = node_map.GetNode("shape2");
+  ASSERT_NE(nullptr, shape2_node);
+  EXPECT_EQ("Identity", shape2_node->op());
+  EXPECT_EQ(kPs, shape2_node->device());
+  // Both consumers read the same transferred tensor.
+  EXPECT_EQ("shape1", node_map.GetNode("out1")->input(0));
+  EXPECT_EQ("shape1", node_map.GetNode("out2")->input(0));
+
+  Tensor x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({100, 100}));
+  std::vector<std::pair<string, Tensor>> feed = {{"x", x_t}};
+  auto expected = EvaluateNodes(ClearDevices(item.graph), item.fetch, feed);
+  auto tensors = EvaluateNodes(ClearDevices(output), item.fetch, feed);
+  ASSERT_EQ(expected.size(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<int>(expected[i], tensors[i]);
+  }
+}
+
+TEST_F(TransferOptimizerTest, MoveWideningCastToItsConsumers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope ps = s.WithDevice(kPs);
+  tensorflow::Scope worker = s.WithDevice(kWorker);
+  Output x = ops::Placeholder(ps.WithOpName("x"), DT_UINT8,
+                              ops::Placeholder::Shape({64, 64}));
+  Output cast = ops::Cast(ps.WithOpName("cast"), x, DT_FLOAT);
+  Output out = ops::Identity(worker.WithOpName("out"), cast);
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TransferOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* cast_node = node_map.GetNode("cast");
+  ASSERT_NE(nullptr, cast_node);
+  EXPECT_EQ(kWorker, cast_node->device());
+}
+
+TEST_F(TransferOptimizerTest, KeepShapeOfTensorAlreadyTransferred) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope ps = s.WithDevice(kPs);
+  tensorflow::Scope worker = s.WithDevice(kWorker);
+  Output x = ops::Placeholder(ps.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({100, 100}));
+  // x is sent to the worker anyway, so its shape is best computed there.
+  Output y = ops::Square(worker.WithOpName("y"), x);
+  Output shape = ops::Shape(worker.WithOpName("shape"), x);
+  Output out = ops::Reshape(worker.WithOpName("out"), y, shape);
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TransferOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* shape_node = node_map.GetNode("shape");
+  ASSERT_NE(nullptr, shape_node);
+  EXPECT_EQ(kWorker, shape_node->device());
+  EXPECT_EQ(kWorker, node_map.GetNode("out")->device());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
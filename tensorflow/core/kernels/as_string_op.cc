@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 
 namespace tensorflow {
@@ -64,6 +65,8 @@ class AsStringOp : public OpKernel {
     OP_REQUIRES(ctx, !(scientific && shortest),
                 errors::InvalidArgument(
                     "Cannot select both scientific and shortest notation"));
+    // Integers without width are formatted without going through printf.
+    plain_integers_ = width < 0;
     format_ = "%";
     if (width > -1) {
       strings::Appendf(&format_, "%s%d", fill_string.c_str(), width);
@@ -116,6 +119,25 @@ class AsStringOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<string>();
 
+    if (plain_integers_) {
+      switch (dtype) {
+        case DT_INT8:
+          EncodePlainIntegers<int8>(*input_tensor, &output_flat);
+          return;
+        case DT_INT16:
+          EncodePlainIntegers<int16>(*input_tensor, &output_flat);
+          return;
+        case DT_INT32:
+          EncodePlainIntegers<int32>(*input_tensor, &output_flat);
+          return;
+        case DT_INT64:
+          EncodePlainIntegers<int64>(*input_tensor, &output_flat);
+          return;
+        default:
+          break;
+      }
+    }
+
 #define ENCODE_TYPE(type, T, enc_str)                                     \
   case (type): {                                                          \
     const auto& input_flat = input_tensor->flat<T>();                     \
@@ -155,7 +177,21 @@ class AsStringOp : public OpKernel {
   }
 
  private:
+  // Same as printf's "%d" (or "%lld") on each element of "input".
+  template <typename T>
+  static void EncodePlainIntegers(const Tensor& input,
+                                  TTypes<string>::Flat* output) {
+    const auto& input_flat = input.flat<T>();
+    char buffer[strings::kFastToBufferSize];
+    for (int64 i = 0; i < input_flat.size(); ++i) {
+      const size_t length =
+          strings::FastInt64ToBufferLeft(input_flat(i), buffer);
+      (*output)(i).assign(buffer, length);
+    }
+  }
+
   string format_;
+  bool plain_integers_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("AsString").Device(DEVICE_CPU), AsStringOp);
@@ -18,7 +18,6 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
-#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
@@ -26,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/macros.h"
 
@@ -204,12 +204,20 @@ Status Split(OpKernelContext* context, const Tensor& input,
   return SplitCPU<T>(context, input, sizes, outputs);
 }
 
+auto* batching_queue_delay = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/batch_kernels/queue_delay_usecs",
+     "The time batching tasks wait in their queue before being processed, in "
+     "microseconds."},
+    // 1us to ~18min.
+    monitoring::Buckets::Exponential(1, 2, 30));
+
 // A class encapsulating the state and logic for batching tensors.
 class BatchResource : public ResourceBase {
  public:
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros, int32 max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
+                       int32 target_latency_micros,
                        FunctionLibraryRuntime::Handle fhandle,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
@@ -224,6 +232,18 @@ class BatchResource : public ResourceBase {
         max_enqueued_batches;
     new_resource->batcher_queue_options_.batch_timeout_micros =
         batch_timeout_micros;
+    new_resource->batcher_queue_options_.target_latency_micros =
+        target_latency_micros;
+    new_resource->batcher_queue_options_.allowed_batch_sizes =
+        allowed_batch_sizes;
+    // Tasks whose step was cancelled, e.g. because the client's deadline
+    // passed, fail instead of taking up room in a batch.
+    new_resource->batcher_queue_options_.expired_task_callback =
+        [](std::unique_ptr<BatchTask> task) {
+          task->context->SetStatus(errors::Cancelled(
+              "The step was cancelled while its inputs were being batched"));
+          task->done_callback();
+        };
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
 
@@ -268,6 +288,7 @@ class BatchResource : public ResourceBase {
     }
     batch_components->context = context;
     batch_components->done_callback = std::move(done_callback);
+    batch_components->start_time_micros = Env::Default()->NowMicros();
 
     BatcherQueue* batcher_queue;
     TF_RETURN_IF_ERROR(
@@ -288,7 +309,17 @@ class BatchResource : public ResourceBase {
     OpKernelContext* context;
     AsyncOpKernel::DoneCallback done_callback;
 
+    // The time at which the task was enqueued.
+    uint64 start_time_micros;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
+
+    bool IsExpired(uint64 now_micros) const override {
+      CancellationManager* cancellation_manager =
+          context->cancellation_manager();
+      return cancellation_manager != nullptr &&
+             cancellation_manager->IsCancelled();
+    }
   };
 
   using Batcher = serving::SharedBatchScheduler<BatchTask>;
@@ -342,6 +373,13 @@ class BatchResource : public ResourceBase {
 
     // Process each input one at a time (the typical case has just one).
     for (int i = 0; i < num_inputs; ++i) {
+      // A batch of a single task needs no concatenation, so its input is
+      // passed as is.
+      if (batch.num_tasks() == 1 && padding_amount == 0) {
+        concatenated_tensors->push_back(batch.task(0).inputs.at(i));
+        continue;
+      }
+
       // Concatenate the tasks ith input tensors into a big output tensor.
       std::vector<Tensor> to_concatenate;
       to_concatenate.reserve(batch.num_tasks());
@@ -362,10 +400,10 @@ class BatchResource : public ResourceBase {
           Status slice_status;
           std::vector<Tensor> slices;
           switch (type) {
-#define CASE(type)                                                     \
-  case DataTypeToEnum<type>::value:                                    \
-    slice_status =                                                     \
-        SplitCPU<type>(context, padding_source, slice_sizes, &slices); \
+#define CASE(type)                                                  \
+  case DataTypeToEnum<type>::value:                                 \
+    slice_status =                                                  \
+        Split<type>(context, padding_source, slice_sizes, &slices); \
     break;
             TF_CALL_ALL_TYPES(CASE);
 #undef CASE
@@ -412,19 +450,17 @@ class BatchResource : public ResourceBase {
                               batch->num_tasks());
     }
 
-    std::vector<int64> task_sizes_plus_optional_padding;
-    task_sizes_plus_optional_padding.reserve(batch->num_tasks());
+    // The padding at the end of the batched outputs is left out of the
+    // splits.
+    std::vector<int64> task_sizes;
+    task_sizes.reserve(batch->num_tasks());
     for (int i = 0; i < batch->num_tasks(); ++i) {
-      task_sizes_plus_optional_padding.push_back(batch->task(i).size());
+      task_sizes.push_back(batch->task(i).size());
     }
     const int padding_size =
         RoundToLowestAllowedBatchSize(batch->size()) - batch->size();
-    if (padding_size > 0) {
-      task_sizes_plus_optional_padding.push_back(padding_size);
-    }
-
-    // For each output tensor name, a divided-up tensor with one entry per task.
-    std::map<string, std::vector<Tensor>> split_tensors;
+    OpKernelContext* last_task_context =
+        batch->task(batch->num_tasks() - 1).context;
 
     DCHECK_EQ(batch->task(0).context->num_outputs(), combined_outputs.size());
     if (combined_outputs.size() != batch->task(0).context->num_outputs()) {
@@ -444,27 +480,38 @@ class BatchResource : public ResourceBase {
             "the 0th dimension sizes of the input tensors");
       }
 
+      // The splits alias the batched output where its rows are aligned, and
+      // are copies otherwise.
       std::vector<Tensor> split_tensor;
-      const Status split_status = tensor::Split(
-          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-      DCHECK(split_status.ok()) << split_status.ToString();
+      Status split_status;
+      switch (output_tensor.dtype()) {
+#define CASE(type)                                                   \
+  case DataTypeToEnum<type>::value:                                  \
+    split_status = Split<type>(last_task_context, output_tensor,     \
+                               task_sizes, &split_tensor);           \
+    break;
+        TF_CALL_ALL_TYPES(CASE);
+#undef CASE
+        default:
+          split_status = errors::InvalidArgument("Unsupported data type: ",
+                                                 output_tensor.dtype());
+          break;
+      }
       if (!split_status.ok()) {
         return errors::Internal("Tensor split operation failed: ",
                                 split_status.ToString());
       }
-      DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-      if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
+      DCHECK_EQ(split_tensor.size(), task_sizes.size());
+      if (split_tensor.size() != task_sizes.size()) {
         return errors::Internal(
             "Tensor split operation did not work as expected; got ",
-            split_tensor.size(), " splits; expected ",
-            task_sizes_plus_optional_padding.size());
+            split_tensor.size(), " splits; expected ", task_sizes.size());
       }
 
       for (int j = 0; j < batch->num_tasks(); ++j) {
         BatchTask& task = *(batch->mutable_task(j));
         task.context->set_output(i, split_tensor.at(j));
-      }  // (Ignore a possible final split_tensors entry containing the
-         // padding.)
+      }
     }
 
     return Status::OK();
@@ -660,6 +707,11 @@ class BatchResource : public ResourceBase {
 
     std::unique_ptr<BatcherQueue> new_queue;
     auto process_batch_callback = [this](std::unique_ptr<Batch> batch) {
+      const uint64 now_micros = Env::Default()->NowMicros();
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        batching_queue_delay->GetCell()->Add(
+            now_micros - batch->task(i).start_time_micros);
+      }
       if (fhandle_ == kInvalidHandle) {
         ProcessBatch(std::move(batch));
       } else {
@@ -707,6 +759,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
                    c->GetAttr("max_enqueued_batches", &max_enqueued_batches_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+    OP_REQUIRES_OK(c,
+                   c->GetAttr("target_latency_micros", &target_latency_micros_));
 
     auto lib = c->function_library();
     OP_REQUIRES(c, lib != nullptr, errors::Internal("No function library"));
@@ -726,7 +780,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(
           BatchResource::Create(num_batch_threads_, max_batch_size_,
                                 batch_timeout_micros_, max_enqueued_batches_,
-                                allowed_batch_sizes_, fhandle_, &new_resource));
+                                allowed_batch_sizes_, target_latency_micros_,
+                                fhandle_, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -772,6 +827,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
   std::vector<int32> allowed_batch_sizes_;
+  int32 target_latency_micros_;
   FunctionLibraryRuntime::Handle fhandle_;
 };
 
@@ -806,8 +862,8 @@ class BatchKernel : public AsyncOpKernel {
           std::unique_ptr<BatchResource> new_resource;
           TF_RETURN_IF_ERROR(BatchResource::Create(
               num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-              max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
-              &new_resource));
+              max_enqueued_batches_, allowed_batch_sizes_,
+              /*target_latency_micros=*/0, kInvalidHandle, &new_resource));
           *r = new_resource.release();
           return Status::OK();
         };
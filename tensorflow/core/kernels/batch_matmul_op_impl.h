@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/cast_op.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -241,6 +242,34 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
   }
 };
 
+// Eigen has no vectorized bfloat16 arithmetic, so bfloat16 products are
+// computed in float, and only rounded to bfloat16 at the end.
+template <>
+struct LaunchBatchMatMul<CPUDevice, bfloat16> {
+  static void Launch(OpKernelContext* context, const Tensor& in_x,
+                     const Tensor& in_y, bool adj_x, bool adj_y, Tensor* out) {
+    const CPUDevice& d = context->eigen_device<CPUDevice>();
+    Tensor in_x_float;
+    Tensor in_y_float;
+    Tensor out_float;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, in_x.shape(), &in_x_float));
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, in_y.shape(), &in_y_float));
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, out->shape(), &out_float));
+    in_x_float.flat<float>().device(d) =
+        in_x.flat<bfloat16>().template cast<float>();
+    in_y_float.flat<float>().device(d) =
+        in_y.flat<bfloat16>().template cast<float>();
+    LaunchBatchMatMul<CPUDevice, float>::Launch(context, in_x_float,
+                                                in_y_float, adj_x, adj_y,
+                                                &out_float);
+    out->flat<bfloat16>().device(d) =
+        out_float.flat<float>().template cast<bfloat16>();
+  }
+};
+
 #if GOOGLE_CUDA
 
 namespace {
@@ -26,6 +26,7 @@ TF_CALL_float(REGISTER_BATCH_MATMUL_CPU);
 TF_CALL_double(REGISTER_BATCH_MATMUL_CPU);
 #endif
 TF_CALL_half(REGISTER_BATCH_MATMUL_CPU);
+TF_CALL_bfloat16(REGISTER_BATCH_MATMUL_CPU);
 TF_CALL_int32(REGISTER_BATCH_MATMUL_CPU);
 
 #if GOOGLE_CUDA
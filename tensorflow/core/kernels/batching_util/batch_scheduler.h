@@ -62,6 +62,15 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the priority of the task. Schedulers that support priorities place
+  // tasks of a higher priority in earlier batches.
+  virtual int priority() const { return 0; }
+
+  // Returns true iff the task is no longer worth processing at 'now_micros',
+  // e.g. because its deadline passed or its request was cancelled. Schedulers
+  // that support expiration drop expired tasks instead of batching them.
+  virtual bool IsExpired(uint64 now_micros) const { return false; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
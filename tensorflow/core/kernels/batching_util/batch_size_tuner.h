@@ -0,0 +1,222 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_TUNER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_TUNER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Chooses the maximum batch size and the batch timeout of a batching queue so
+// that tasks meet a target latency, as the load changes.
+//
+// The tuner learns online how long a batch takes to process as a function of
+// its size, with an exponentially-decayed linear fit of the observed
+// processing times, plus a margin for the spread of the observations around
+// the fit, so that the prediction approximates the 99th percentile. It also
+// tracks the rate at which task sizes arrive. It then picks the largest batch
+// size that fills up within the target at the current rate, and is processed
+// within the target, among the allowed batch sizes if any. The timeout is the
+// part of the target left once the batch is processed, which bounds the time
+// spent waiting for a batch to fill.
+//
+// So at low load batches are small and close quickly, and at peak load they
+// are as large as the target allows, which maximizes throughput. The time
+// spent waiting for a batch thread is not accounted for, so the target should
+// leave room for it if the threads are often busy.
+//
+// Not thread-safe.
+class BatchSizeTuner {
+ public:
+  struct Options {
+    // The latency to meet, in microseconds. Must be positive.
+    int64 target_latency_micros = 0;
+
+    // The batch sizes to choose from: the allowed batch sizes if not empty,
+    // else all sizes up to 'max_batch_size'.
+    int max_batch_size = 1000;
+    std::vector<int32> allowed_batch_sizes;
+
+    // The weight of the latest observation in the latency fit and in the
+    // arrival rate.
+    double decay = 0.05;
+
+    // The length of the windows over which the arrival rate is measured.
+    int64 arrival_window_micros = 10 * 1000;
+  };
+
+  explicit BatchSizeTuner(const Options& options);
+
+  // Records the arrival of a task of 'size' at 'now_micros'.
+  void RecordArrival(int64 size, uint64 now_micros);
+
+  // Records that a batch of 'batch_size' took 'processing_micros' to process.
+  void RecordBatch(int64 batch_size, int64 processing_micros);
+
+  // Returns the predicted 99th percentile of the processing time of a batch
+  // of 'batch_size', or -1 if no batch was recorded yet.
+  double PredictProcessingMicros(int64 batch_size) const;
+
+  // Returns in '*max_batch_size' and '*batch_timeout_micros' the batching
+  // parameters to use. Returns false, leaving them unchanged, if no batch was
+  // recorded yet.
+  bool GetBatchingParameters(int* max_batch_size,
+                             int64* batch_timeout_micros) const;
+
+ private:
+  // Returns the fixed and per-task processing times of the fit, and the
+  // margin to add to its predictions for the 99th percentile.
+  void Fit(double* fixed_micros, double* per_task_micros,
+           double* margin_micros) const;
+
+  const Options options_;
+  // The batch sizes to choose from, in increasing order.
+  std::vector<int> candidate_batch_sizes_;
+
+  // Exponentially-decayed sums of the weights, of the batch sizes x, of the
+  // processing times y, of x^2, of xy and of y^2.
+  double sum_w_ = 0;
+  double sum_x_ = 0;
+  double sum_y_ = 0;
+  double sum_xx_ = 0;
+  double sum_xy_ = 0;
+  double sum_yy_ = 0;
+
+  // The task sizes arrived per microsecond, or -1 if not known yet.
+  double arrival_rate_ = -1;
+  bool arrival_window_started_ = false;
+  uint64 arrival_window_start_micros_ = 0;
+  int64 arrival_window_size_ = 0;
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+inline BatchSizeTuner::BatchSizeTuner(const Options& options)
+    : options_(options) {
+  CHECK_GT(options.target_latency_micros, 0);
+  if (options.allowed_batch_sizes.empty()) {
+    for (int size = 1; size <= options.max_batch_size; ++size) {
+      candidate_batch_sizes_.push_back(size);
+    }
+  } else {
+    for (int32 size : options.allowed_batch_sizes) {
+      if (size <= options.max_batch_size) {
+        candidate_batch_sizes_.push_back(size);
+      }
+    }
+  }
+  CHECK(!candidate_batch_sizes_.empty());
+}
+
+inline void BatchSizeTuner::RecordArrival(int64 size, uint64 now_micros) {
+  if (!arrival_window_started_) {
+    arrival_window_started_ = true;
+    arrival_window_start_micros_ = now_micros;
+  }
+  arrival_window_size_ += size;
+  const int64 elapsed_micros = now_micros - arrival_window_start_micros_;
+  if (elapsed_micros < options_.arrival_window_micros) return;
+  const double rate = static_cast<double>(arrival_window_size_) /
+                      static_cast<double>(elapsed_micros);
+  arrival_rate_ = arrival_rate_ < 0 ? rate
+                                    : (1 - options_.decay) * arrival_rate_ +
+                                          options_.decay * rate;
+  arrival_window_start_micros_ = now_micros;
+  arrival_window_size_ = 0;
+}
+
+inline void BatchSizeTuner::RecordBatch(int64 batch_size,
+                                        int64 processing_micros) {
+  const double x = batch_size;
+  const double y = processing_micros;
+  const double keep = 1 - options_.decay;
+  sum_w_ = keep * sum_w_ + 1;
+  sum_x_ = keep * sum_x_ + x;
+  sum_y_ = keep * sum_y_ + y;
+  sum_xx_ = keep * sum_xx_ + x * x;
+  sum_xy_ = keep * sum_xy_ + x * y;
+  sum_yy_ = keep * sum_yy_ + y * y;
+}
+
+inline void BatchSizeTuner::Fit(double* fixed_micros, double* per_task_micros,
+                                double* margin_micros) const {
+  // Fit y = a + b * x, falling back to a processing time proportional to the
+  // batch size while the observed sizes are too alike to tell the fixed cost
+  // from the per-task one.
+  double a = 0;
+  double b = sum_x_ > 0 ? sum_y_ / sum_x_ : 0;
+  const double variance_x = sum_w_ * sum_xx_ - sum_x_ * sum_x_;
+  if (variance_x > 1e-6 * sum_w_ * sum_w_) {
+    b = (sum_w_ * sum_xy_ - sum_x_ * sum_y_) / variance_x;
+    if (b < 0) b = 0;
+    a = (sum_y_ - b * sum_x_) / sum_w_;
+    if (a < 0) {
+      a = 0;
+      b = sum_xy_ / sum_xx_;
+    }
+  }
+  // The sum of the squared residuals of the fit.
+  const double squared_residuals = sum_yy_ - 2 * a * sum_y_ -
+                                   2 * b * sum_xy_ + a * a * sum_w_ +
+                                   2 * a * b * sum_x_ + b * b * sum_xx_;
+  *fixed_micros = a;
+  *per_task_micros = b;
+  // The 99th percentile of normally distributed residuals.
+  *margin_micros =
+      2.33 * std::sqrt(std::max(0.0, squared_residuals / sum_w_));
+}
+
+inline double BatchSizeTuner::PredictProcessingMicros(int64 batch_size) const {
+  if (sum_w_ == 0) return -1;
+  double fixed_micros, per_task_micros, margin_micros;
+  Fit(&fixed_micros, &per_task_micros, &margin_micros);
+  return fixed_micros + per_task_micros * batch_size + margin_micros;
+}
+
+inline bool BatchSizeTuner::GetBatchingParameters(
+    int* max_batch_size, int64* batch_timeout_micros) const {
+  if (sum_w_ == 0) return false;
+  double fixed_micros, per_task_micros, margin_micros;
+  Fit(&fixed_micros, &per_task_micros, &margin_micros);
+  const double target = options_.target_latency_micros;
+  int batch_size = candidate_batch_sizes_.front();
+  for (int size : candidate_batch_sizes_) {
+    const double processing_micros =
+        fixed_micros + per_task_micros * size + margin_micros;
+    if (processing_micros > target) break;
+    // The arrival rate is not known before the first window ends, in which
+    // case only the processing time bounds the batch size.
+    const double fill_micros = arrival_rate_ > 0 ? size / arrival_rate_ : 0;
+    if (processing_micros + fill_micros <= target) batch_size = size;
+  }
+  *max_batch_size = batch_size;
+  *batch_timeout_micros = std::max<int64>(
+      0, static_cast<int64>(target - fixed_micros -
+                            per_task_micros * batch_size - margin_micros));
+  return true;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_TUNER_H_
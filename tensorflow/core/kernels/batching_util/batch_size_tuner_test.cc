@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_tuner.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(BatchSizeTunerTest, UnknownUntilBatchRecorded) {
+  BatchSizeTuner::Options options;
+  options.target_latency_micros = 1000;
+  BatchSizeTuner tuner(options);
+  EXPECT_EQ(-1, tuner.PredictProcessingMicros(10));
+  int max_batch_size = 7;
+  int64 batch_timeout_micros = 7;
+  EXPECT_FALSE(
+      tuner.GetBatchingParameters(&max_batch_size, &batch_timeout_micros));
+  EXPECT_EQ(7, max_batch_size);
+  EXPECT_EQ(7, batch_timeout_micros);
+}
+
+TEST(BatchSizeTunerTest, LearnsLinearLatency) {
+  BatchSizeTuner::Options options;
+  options.target_latency_micros = 1000;
+  BatchSizeTuner tuner(options);
+
+  // A single batch size gives a latency proportional to the size.
+  tuner.RecordBatch(10, 200);
+  EXPECT_NEAR(400, tuner.PredictProcessingMicros(20), 1e-6);
+
+  // Batches take 100 microseconds plus 10 per task.
+  for (int i = 0; i < 20; ++i) {
+    tuner.RecordBatch(10, 200);
+    tuner.RecordBatch(30, 400);
+  }
+  EXPECT_NEAR(100, tuner.PredictProcessingMicros(0), 1e-3);
+  EXPECT_NEAR(600, tuner.PredictProcessingMicros(50), 1e-3);
+}
+
+TEST(BatchSizeTunerTest, AddsMarginForVariance) {
+  BatchSizeTuner::Options options;
+  options.target_latency_micros = 1000;
+  // Weighs all the batches equally.
+  options.decay = 0;
+  BatchSizeTuner tuner(options);
+  for (int i = 0; i < 50; ++i) {
+    tuner.RecordBatch(10, 90);
+    tuner.RecordBatch(10, 110);
+  }
+  // The mean is 100 and the standard deviation 10.
+  EXPECT_NEAR(123.3, tuner.PredictProcessingMicros(10), 0.1);
+}
+
+TEST(BatchSizeTunerTest, ChoosesLargestBatchSizeMeetingTarget) {
+  BatchSizeTuner::Options options;
+  options.target_latency_micros = 500;
+  options.max_batch_size = 64;
+  options.allowed_batch_sizes = {8, 16, 32, 64};
+  BatchSizeTuner tuner(options);
+  // Batches take 10 microseconds per task.
+  tuner.RecordBatch(16, 160);
+
+  // The arrival rate is not known yet, so only the processing time bounds
+  // the batch size.
+  int max_batch_size;
+  int64 batch_timeout_micros;
+  ASSERT_TRUE(
+      tuner.GetBatchingParameters(&max_batch_size, &batch_timeout_micros));
+  EXPECT_EQ(32, max_batch_size);
+  EXPECT_EQ(180, batch_timeout_micros);
+
+  // At one task every 20 microseconds, a batch of 16 takes 320 microseconds
+  // to fill and 160 to process.
+  for (uint64 now = 0; now <= 20 * 1000; now += 20) {
+    tuner.RecordArrival(1, now);
+  }
+  ASSERT_TRUE(
+      tuner.GetBatchingParameters(&max_batch_size, &batch_timeout_micros));
+  EXPECT_EQ(16, max_batch_size);
+  EXPECT_EQ(340, batch_timeout_micros);
+}
+
+TEST(BatchSizeTunerTest, FallsBackToSmallestBatchSize) {
+  BatchSizeTuner::Options options;
+  options.target_latency_micros = 100;
+  options.max_batch_size = 64;
+  options.allowed_batch_sizes = {8, 16, 32, 64};
+  BatchSizeTuner tuner(options);
+  tuner.RecordBatch(8, 400);
+
+  int max_batch_size;
+  int64 batch_timeout_micros;
+  ASSERT_TRUE(
+      tuner.GetBatchingParameters(&max_batch_size, &batch_timeout_micros));
+  EXPECT_EQ(8, max_batch_size);
+  EXPECT_EQ(0, batch_timeout_micros);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -17,15 +17,18 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_SHARED_BATCH_SCHEDULER_H_
 
 #include <stddef.h>
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_tuner.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -158,6 +161,28 @@ class SharedBatchScheduler
     // See the class documentation above for guidelines on how to tune this
     // parameter.
     size_t max_enqueued_batches = 10;
+
+    // If positive, the queue chooses the size and the timeout of its batches
+    // as the load changes, so that tasks meet this latency in microseconds;
+    // see BatchSizeTuner. 'max_batch_size' still bounds the batch sizes, and
+    // 'batch_timeout_micros' applies until the first batch was processed.
+    int64 target_latency_micros = 0;
+
+    // The batch sizes the process-batch callback pads batches to, if any.
+    // With 'target_latency_micros', the batch sizes are chosen among the ones
+    // up to 'max_batch_size', so that batches need no padding once full.
+    std::vector<int32> allowed_batch_sizes;
+
+    // If true, each batch is formed from the enqueued tasks of the highest
+    // priority (see BatchTask::priority()), in arrival order among tasks of
+    // the same priority, instead of from the oldest tasks.
+    bool enable_priorities = false;
+
+    // If set, the tasks that expired while enqueued (see
+    // BatchTask::IsExpired()) are dropped when a batch is formed, and handed
+    // to this callback on a batch thread instead of being processed. The
+    // callback is responsible for reporting the tasks' failure.
+    std::function<void(std::unique_ptr<TaskType>)> expired_task_callback;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -224,6 +249,10 @@ namespace internal {
 // closed. If the front-most batch is open (i.e. the queue contains only one
 // batch) and has reached the timeout, it is immediately closed and returned;
 // otherwise no batch is returned for the request.
+//
+// If priorities or expiration are enabled, the batch returned is instead formed
+// from all the enqueued tasks at the time a batch is ready, and the remaining
+// ones are batched again.
 template <typename TaskType>
 class Queue {
  public:
@@ -255,12 +284,19 @@ class Queue {
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
-  // returns a batch, the batch is guaranteed to be closed.
-  std::unique_ptr<Batch<TaskType>> ScheduleBatch();
+  // returns a batch, the batch is guaranteed to be closed. Moves the tasks
+  // that expired while enqueued, if any, to '*expired_tasks', which must then
+  // be passed to DropExpiredTasks().
+  std::unique_ptr<Batch<TaskType>> ScheduleBatch(
+      std::vector<std::unique_ptr<TaskType>>* expired_tasks);
 
   // Processes a batch that has been returned earlier by ScheduleBatch().
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
 
+  // Hands expired tasks returned earlier by ScheduleBatch() to the
+  // expired-task callback.
+  void DropExpiredTasks(std::vector<std::unique_ptr<TaskType>> expired_tasks);
+
   // Determines whether the queue is empty, i.e. has no tasks waiting or being
   // processed.
   bool IsEmpty() const;
@@ -285,8 +321,32 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Whether batches are formed by ReformBatches() rather than in arrival
+  // order.
+  bool ReformsBatches() const {
+    return options_.enable_priorities ||
+           options_.expired_task_callback != nullptr;
+  }
+
+  // Takes all the enqueued tasks out of 'batches_', moves the expired ones to
+  // '*expired_tasks', and returns a batch of the highest-priority ones (or
+  // nullptr if none is left). The other tasks are enqueued again in arrival
+  // order.
+  std::unique_ptr<Batch<TaskType>> ReformBatches(
+      std::vector<std::unique_ptr<TaskType>>* expired_tasks)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
+  // Tunes the batching parameters below, iff
+  // 'options_.target_latency_micros' is positive.
+  std::unique_ptr<BatchSizeTuner> batch_size_tuner_ GUARDED_BY(mu_);
+
+  // The batching parameters in effect, which are the ones in 'options_'
+  // unless tuned.
+  size_t max_batch_size_ GUARDED_BY(mu_);
+  int64 batch_timeout_micros_ GUARDED_BY(mu_);
+
   // The environment to use.
   Env* env_;
 
@@ -312,12 +372,19 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ GUARDED_BY(mu_);
 
+  // The time at which each enqueued task was submitted, iff ReformsBatches(),
+  // so that the open batch start time is known once the batches are formed
+  // again.
+  std::unordered_map<const TaskType*, uint64> task_enqueue_time_micros_
+      GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled. Used
   // to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ GUARDED_BY(mu_) = false;
 
-  // The number of batches currently being processed by batch threads.
-  // Incremented in ScheduleBatch() and decremented in ProcessBatch().
+  // The number of batches currently being processed by batch threads, plus
+  // the number of sets of expired tasks being dropped. Incremented in
+  // ScheduleBatch() and decremented in ProcessBatch() and DropExpiredTasks().
   int num_batches_being_processed_ GUARDED_BY(mu_) = 0;
 
   // Used by CloseAndWaitUntilEmpty() to wait until the queue is empty, for the
@@ -408,6 +475,18 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
+  if (options.target_latency_micros > 0 &&
+      !options.allowed_batch_sizes.empty() &&
+      options.allowed_batch_sizes.front() >
+          static_cast<int64>(options.max_batch_size)) {
+    return errors::InvalidArgument(
+        "allowed_batch_sizes must contain a size up to max_batch_size");
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -450,14 +529,18 @@ template <typename TaskType>
 void SharedBatchScheduler<TaskType>::ThreadLogic() {
   // A batch to process next (or nullptr if no work to do).
   std::unique_ptr<Batch<TaskType>> batch_to_process;
-  // The queue with which 'batch_to_process' is associated.
+  // Expired tasks to drop next.
+  std::vector<std::unique_ptr<TaskType>> expired_tasks;
+  // The queue with which 'batch_to_process' and 'expired_tasks' are
+  // associated.
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   {
     mutex_lock l(mu_);
 
     const int num_queues = queues_.size();
     for (int num_queues_tried = 0;
-         batch_to_process == nullptr && num_queues_tried < num_queues;
+         batch_to_process == nullptr && expired_tasks.empty() &&
+         num_queues_tried < num_queues;
          ++num_queues_tried) {
       DCHECK(next_queue_to_schedule_ != queues_.end());
 
@@ -468,14 +551,15 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
       const bool queue_closed = (*next_queue_to_schedule_)->closed();
 
       // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
-      if (batch_to_process != nullptr) {
+      batch_to_process =
+          (*next_queue_to_schedule_)->ScheduleBatch(&expired_tasks);
+      if (batch_to_process != nullptr || !expired_tasks.empty()) {
         queue_for_batch = next_queue_to_schedule_->get();
       }
 
       // Advance 'next_queue_to_schedule_'.
       if (queue_closed && (*next_queue_to_schedule_)->IsEmpty() &&
-          batch_to_process == nullptr) {
+          batch_to_process == nullptr && expired_tasks.empty()) {
         // We've encountered a closed queue with no work to do. Drop it.
         DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
         next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
@@ -488,7 +572,7 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
       }
     }
 
-    if (batch_to_process == nullptr) {
+    if (batch_to_process == nullptr && expired_tasks.empty()) {
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
       const int64 kTimeoutMillis = 1;  // The smallest accepted granule of time.
@@ -497,7 +581,12 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
     }
   }
 
-  queue_for_batch->ProcessBatch(std::move(batch_to_process));
+  if (!expired_tasks.empty()) {
+    queue_for_batch->DropExpiredTasks(std::move(expired_tasks));
+  }
+  if (batch_to_process != nullptr) {
+    queue_for_batch->ProcessBatch(std::move(batch_to_process));
+  }
 }
 
 namespace internal {
@@ -508,9 +597,18 @@ Queue<TaskType>::Queue(
     Env* env, ProcessBatchCallback process_batch_callback,
     SchedulableBatchCallback schedulable_batch_callback)
     : options_(options),
+      max_batch_size_(options.max_batch_size),
+      batch_timeout_micros_(options.batch_timeout_micros),
       env_(env),
       process_batch_callback_(process_batch_callback),
       schedulable_batch_callback_(schedulable_batch_callback) {
+  if (options.target_latency_micros > 0) {
+    BatchSizeTuner::Options tuner_options;
+    tuner_options.target_latency_micros = options.target_latency_micros;
+    tuner_options.max_batch_size = options.max_batch_size;
+    tuner_options.allowed_batch_sizes = options.allowed_batch_sizes;
+    batch_size_tuner_.reset(new BatchSizeTuner(tuner_options));
+  }
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -538,7 +636,13 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
+    if (batch_size_tuner_ != nullptr) {
+      batch_size_tuner_->RecordArrival((*task)->size(), env_->NowMicros());
+    }
+    // A tuned batch size may be smaller than the task, which then makes up a
+    // batch by itself.
+    if (!batches_.back()->empty() &&
+        batches_.back()->size() + (*task)->size() > max_batch_size_) {
       if (batches_.size() >= options_.max_enqueued_batches) {
         return errors::Unavailable(
             "The batch scheduling queue to which this task was submitted is "
@@ -546,8 +650,12 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       }
       StartNewBatch();
     }
+    const uint64 now_micros = env_->NowMicros();
     if (batches_.back()->empty()) {
-      open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_start_time_micros_ = now_micros;
+    }
+    if (ReformsBatches()) {
+      task_enqueue_time_micros_[task->get()] = now_micros;
     }
     batches_.back()->AddTask(std::move(*task));
 
@@ -582,13 +690,13 @@ size_t Queue<TaskType>::SchedulingCapacity() const {
   const int num_new_batches_schedulable =
       options_.max_enqueued_batches - batches_.size();
   const int open_batch_capacity =
-      options_.max_batch_size - batches_.back()->size();
-  return (num_new_batches_schedulable * options_.max_batch_size) +
-         open_batch_capacity;
+      std::max<int>(0, max_batch_size_ - batches_.back()->size());
+  return (num_new_batches_schedulable * max_batch_size_) + open_batch_capacity;
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch(
+    std::vector<std::unique_ptr<TaskType>>* expired_tasks) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -603,10 +711,20 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 
     if (batches_.size() >= 2) {
       // There is at least one closed batch that is ready to be scheduled.
-      ++num_batches_being_processed_;
-      batch_to_schedule = std::move(batches_.front());
-      batches_.pop_front();
-    } else {
+      if (ReformsBatches()) {
+        batch_to_schedule = ReformBatches(expired_tasks);
+      } else {
+        batch_to_schedule = std::move(batches_.front());
+        batches_.pop_front();
+      }
+      if (batch_to_schedule != nullptr) {
+        ++num_batches_being_processed_;
+      }
+      if (!expired_tasks->empty()) {
+        ++num_batches_being_processed_;
+      }
+    }
+    if (batch_to_schedule == nullptr) {
       schedulable_batch_ = false;
     }
   }
@@ -614,10 +732,112 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ReformBatches(
+    std::vector<std::unique_ptr<TaskType>>* expired_tasks) {
+  const uint64 now_micros = env_->NowMicros();
+
+  // Take the enqueued tasks out, in arrival order.
+  std::vector<std::unique_ptr<TaskType>> tasks;
+  batches_.back()->Close();
+  for (auto& batch : batches_) {
+    const size_t first_task = tasks.size();
+    for (std::unique_ptr<TaskType> task = batch->RemoveTask(); task != nullptr;
+         task = batch->RemoveTask()) {
+      tasks.push_back(std::move(task));
+    }
+    std::reverse(tasks.begin() + first_task, tasks.end());
+  }
+  batches_.clear();
+  batches_.emplace_back(new Batch<TaskType>);
+
+  // Drop the expired tasks.
+  if (options_.expired_task_callback != nullptr) {
+    auto expired = std::stable_partition(
+        tasks.begin(), tasks.end(),
+        [now_micros](const std::unique_ptr<TaskType>& task) {
+          return !task->IsExpired(now_micros);
+        });
+    for (auto it = expired; it != tasks.end(); ++it) {
+      task_enqueue_time_micros_.erase(it->get());
+      expired_tasks->push_back(std::move(*it));
+    }
+    tasks.erase(expired, tasks.end());
+  }
+
+  // Fill a batch with the tasks of the highest priority, in arrival order
+  // among the tasks of the same priority.
+  std::vector<int> order(tasks.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  if (options_.enable_priorities) {
+    std::stable_sort(order.begin(), order.end(), [&tasks](int a, int b) {
+      return tasks[a]->priority() > tasks[b]->priority();
+    });
+  }
+  std::unique_ptr<Batch<TaskType>> batch_to_schedule;
+  for (int i : order) {
+    if (batch_to_schedule == nullptr) {
+      batch_to_schedule.reset(new Batch<TaskType>);
+    } else if (batch_to_schedule->size() + tasks[i]->size() >
+               max_batch_size_) {
+      continue;
+    }
+    task_enqueue_time_micros_.erase(tasks[i].get());
+    batch_to_schedule->AddTask(std::move(tasks[i]));
+  }
+  if (batch_to_schedule != nullptr) {
+    batch_to_schedule->Close();
+  }
+
+  // Enqueue the other tasks again. They fit in fewer batches than before.
+  for (std::unique_ptr<TaskType>& task : tasks) {
+    if (task == nullptr) continue;
+    if (!batches_.back()->empty() &&
+        batches_.back()->size() + task->size() > max_batch_size_) {
+      StartNewBatch();
+    }
+    if (batches_.back()->empty()) {
+      open_batch_start_time_micros_ = task_enqueue_time_micros_[task.get()];
+    }
+    batches_.back()->AddTask(std::move(task));
+  }
+
+  return batch_to_schedule;
+}
+
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
+  const uint64 start_time_micros = env_->NowMicros();
+  const size_t batch_size = batch->size();
   process_batch_callback_(std::move(batch));
 
+  {
+    mutex_lock l(mu_);
+    if (batch_size_tuner_ != nullptr) {
+      batch_size_tuner_->RecordBatch(batch_size,
+                                     env_->NowMicros() - start_time_micros);
+      int max_batch_size;
+      if (batch_size_tuner_->GetBatchingParameters(&max_batch_size,
+                                                   &batch_timeout_micros_)) {
+        max_batch_size_ = max_batch_size;
+      }
+    }
+    --num_batches_being_processed_;
+    if (empty_notification_ != nullptr && IsEmptyInternal()) {
+      empty_notification_->Notify();
+    }
+  }
+}
+
+template <typename TaskType>
+void Queue<TaskType>::DropExpiredTasks(
+    std::vector<std::unique_ptr<TaskType>> expired_tasks) {
+  for (std::unique_ptr<TaskType>& task : expired_tasks) {
+    options_.expired_task_callback(std::move(task));
+  }
+
   {
     mutex_lock l(mu_);
     --num_batches_being_processed_;
@@ -667,9 +887,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
+  return closed_ || open_batch->size() >= max_batch_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros_;
 }
 
 template <typename TaskType>
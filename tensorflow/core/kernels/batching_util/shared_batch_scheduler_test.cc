@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 
+#include <atomic>
+
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -254,6 +256,200 @@ TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, TunesBatchingToTargetLatency) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    // Processing a batch takes 10 microseconds per task.
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    Notification batch_processed[3];
+    auto callback = [&env, &mu, &batch_sizes,
+                     &batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      env.AdvanceByMicroseconds(10 * batch->size());
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch->size());
+      batch_processed[batch_sizes.size() - 1].Notify();
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 8;
+    queue_options.batch_timeout_micros = 10 * 1000 * 1000;  // 10 seconds
+    queue_options.max_enqueued_batches = 2;
+    queue_options.target_latency_micros = 50;
+    queue_options.allowed_batch_sizes = {2, 4, 8};
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // The first batch is formed with the static parameters.
+    for (int i = 0; i < 8; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    batch_processed[0].WaitForNotification();
+
+    // Batches of 8 take 80 microseconds, so batches of 4 are the largest
+    // allowed ones which meet the target.
+    for (int i = 0; i < 4; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    batch_processed[1].WaitForNotification();
+
+    // Batches of 4 take 40 microseconds, which leaves 10 for the timeout.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(9);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed[2].HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    batch_processed[2].WaitForNotification();
+
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ((std::vector<size_t>{8, 4, 1}), batch_sizes);
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+// A task with an id, a priority, and an expiration flag the test sets.
+class PrioritizedTask : public BatchTask {
+ public:
+  PrioritizedTask(int id, size_t size, int priority)
+      : id_(id), size_(size), priority_(priority) {}
+
+  size_t size() const override { return size_; }
+  int priority() const override { return priority_; }
+  bool IsExpired(uint64 now_micros) const override { return expired_; }
+
+  int id() const { return id_; }
+  void Expire() { expired_ = true; }
+
+ private:
+  const int id_;
+  const size_t size_;
+  const int priority_;
+  std::atomic<bool> expired_{false};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PrioritizedTask);
+};
+
+// Schedules a PrioritizedTask, and returns it. The task is owned by
+// 'scheduler'.
+PrioritizedTask* SchedulePrioritizedTask(
+    int id, size_t size, int priority,
+    BatchScheduler<PrioritizedTask>* scheduler) {
+  std::unique_ptr<PrioritizedTask> task(
+      new PrioritizedTask(id, size, priority));
+  PrioritizedTask* task_ptr = task.get();
+  TF_CHECK_OK(scheduler->Schedule(&task));
+  return task_ptr;
+}
+
+TEST(SharedBatchSchedulerTest, BatchesHighestPriorityTasksFirst) {
+  mutex mu;
+  std::vector<std::vector<int>> batch_ids;
+  Notification first_batch_started, proceed;
+  auto callback = [&mu, &batch_ids, &first_batch_started,
+                   &proceed](std::unique_ptr<Batch<PrioritizedTask>> batch) {
+    std::vector<int> ids;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      ids.push_back(batch->task(i).id());
+    }
+    if (ids[0] == 0) {
+      first_batch_started.Notify();
+      proceed.WaitForNotification();
+    }
+    mutex_lock l(mu);
+    batch_ids.push_back(ids);
+  };
+
+  {
+    SharedBatchScheduler<PrioritizedTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<PrioritizedTask>> scheduler;
+    TF_ASSERT_OK(
+        SharedBatchScheduler<PrioritizedTask>::Create(options, &scheduler));
+    SharedBatchScheduler<PrioritizedTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 2;
+    queue_options.batch_timeout_micros = 10 * 1000 * 1000;  // 10 seconds
+    queue_options.max_enqueued_batches = 3;
+    queue_options.enable_priorities = true;
+    std::unique_ptr<BatchScheduler<PrioritizedTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Keep the batch thread busy while the other tasks are enqueued.
+    SchedulePrioritizedTask(0, 2, 0, queue.get());
+    first_batch_started.WaitForNotification();
+    const std::vector<int> priorities = {0, 0, 1, 0, 1};
+    for (int i = 0; i < priorities.size(); ++i) {
+      SchedulePrioritizedTask(i + 1, 1, priorities[i], queue.get());
+    }
+    proceed.Notify();
+  }
+
+  EXPECT_EQ((std::vector<std::vector<int>>{{0}, {3, 5}, {1, 2}, {4}}),
+            batch_ids);
+}
+
+TEST(SharedBatchSchedulerTest, DropsExpiredTasks) {
+  mutex mu;
+  std::vector<std::vector<int>> batch_ids;
+  std::vector<int> expired_ids;
+  Notification first_batch_started, proceed;
+  auto callback = [&mu, &batch_ids, &first_batch_started,
+                   &proceed](std::unique_ptr<Batch<PrioritizedTask>> batch) {
+    std::vector<int> ids;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      ids.push_back(batch->task(i).id());
+    }
+    if (ids[0] == 0) {
+      first_batch_started.Notify();
+      proceed.WaitForNotification();
+    }
+    mutex_lock l(mu);
+    batch_ids.push_back(ids);
+  };
+
+  {
+    SharedBatchScheduler<PrioritizedTask>::Options options;
+    options.num_batch_threads = 1;
+    std::shared_ptr<SharedBatchScheduler<PrioritizedTask>> scheduler;
+    TF_ASSERT_OK(
+        SharedBatchScheduler<PrioritizedTask>::Create(options, &scheduler));
+    SharedBatchScheduler<PrioritizedTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 2;
+    queue_options.batch_timeout_micros = 10 * 1000 * 1000;  // 10 seconds
+    queue_options.max_enqueued_batches = 3;
+    queue_options.expired_task_callback =
+        [&mu, &expired_ids](std::unique_ptr<PrioritizedTask> task) {
+          mutex_lock l(mu);
+          expired_ids.push_back(task->id());
+        };
+    std::unique_ptr<BatchScheduler<PrioritizedTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    SchedulePrioritizedTask(0, 2, 0, queue.get());
+    first_batch_started.WaitForNotification();
+    SchedulePrioritizedTask(1, 1, 0, queue.get());
+    SchedulePrioritizedTask(2, 1, 0, queue.get())->Expire();
+    SchedulePrioritizedTask(3, 1, 0, queue.get());
+    proceed.Notify();
+  }
+
+  EXPECT_EQ((std::vector<std::vector<int>>{{0}, {1, 3}}), batch_ids);
+  EXPECT_EQ(std::vector<int>({2}), expired_ids);
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -42,8 +42,10 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -149,12 +151,50 @@ class LaunchDeepConvOp {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int /*out_cols*/, int /*out_depth*/, int /*dilation_rows*/,
                   int /*dilation_cols*/, int /*stride_rows*/,
-                  int /*stride_cols*/, Tensor* /*output*/,
-                  TensorFormat /*data_format*/) {
+                  int /*stride_cols*/, const Padding& /*padding*/,
+                  Tensor* /*output*/, TensorFormat /*data_format*/) {
     return false;
   }
 };
 
+// The CPU convolution implementations the autotuner chooses from.
+enum class CpuConvAlgorithm { kEigen, kDeepConv2D };
+
+// Remembers the faster CPU convolution implementation for each convolution
+// shape that DeepConv2D supports, when autotuning is enabled (see
+// CanAutoTuneDeepConv2D). Shapes are keyed by their Conv2DArgs, as the
+// strides and filter sizes are the same for all of them.
+class CpuConvAutoTuneMap {
+ public:
+  static CpuConvAutoTuneMap* Get() {
+    static CpuConvAutoTuneMap* map = new CpuConvAutoTuneMap;
+    return map;
+  }
+
+  bool Find(const Conv2DArgs& args, CpuConvAlgorithm* algorithm) const {
+    tf_shared_lock l(mu_);
+    auto it = algorithms_.find(Key(args));
+    if (it == algorithms_.end()) return false;
+    *algorithm = it->second;
+    return true;
+  }
+
+  void Insert(const Conv2DArgs& args, CpuConvAlgorithm algorithm) {
+    mutex_lock l(mu_);
+    algorithms_[Key(args)] = algorithm;
+  }
+
+ private:
+  static std::vector<int> Key(const Conv2DArgs& args) {
+    return {args.batch,    args.in_rows,  args.in_cols,  args.in_depth,
+            args.pad_rows, args.pad_cols, args.out_rows, args.out_cols,
+            args.out_depth};
+  }
+
+  mutable mutex mu_;
+  std::map<std::vector<int>, CpuConvAlgorithm> algorithms_ GUARDED_BY(mu_);
+};
+
 // Conditionally launches DeepConv operation based on convolution parameters.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
@@ -165,9 +205,15 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  const Padding& padding, Tensor* output,
+                  TensorFormat data_format) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
-        dilation_cols != 1 ||
+        dilation_cols != 1) {
+      return false;
+    }
+    const bool autotune = CanAutoTuneDeepConv2D(stride_rows, stride_cols,
+                                                filter_rows, filter_cols);
+    if (!autotune &&
         !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
                           in_depth, out_depth, out_rows, out_cols)) {
       return false;
@@ -190,8 +236,39 @@ class LaunchDeepConvOp<CPUDevice, float> {
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
 
+    if (!autotune) {
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      return true;
+    }
+
+    CpuConvAlgorithm algorithm;
+    if (CpuConvAutoTuneMap::Get()->Find(args, &algorithm)) {
+      if (algorithm == CpuConvAlgorithm::kEigen) return false;
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      return true;
+    }
+
+    // Times both implementations on this first run of the shape. Each one
+    // computes the whole output, so whichever runs last leaves it in place.
+    Env* env = Env::Default();
+    uint64 start = env->NowMicros();
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
+    const uint64 deep_conv_micros = env->NowMicros() - start;
+    start = env->NowMicros();
+    LaunchGeneric<CPUDevice, float>()(ctx, input, filter, stride_rows,
+                                      stride_cols, dilation_rows,
+                                      dilation_cols, padding, output,
+                                      data_format);
+    const uint64 eigen_micros = env->NowMicros() - start;
+    algorithm = deep_conv_micros < eigen_micros ? CpuConvAlgorithm::kDeepConv2D
+                                                : CpuConvAlgorithm::kEigen;
+    VLOG(1) << "Conv2D autotune: deep_conv_micros = " << deep_conv_micros
+            << ", eigen_micros = " << eigen_micros << ", use_deep_conv = "
+            << (algorithm == CpuConvAlgorithm::kDeepConv2D);
+    CpuConvAutoTuneMap::Get()->Insert(args, algorithm);
     return true;
   }
 };
@@ -428,7 +505,7 @@ class Conv2DOp : public BinaryOp<T> {
             context, input, filter, batch, input_rows, input_cols, in_depth,
             filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
             out_depth, dilation_rows, dilation_cols, stride_rows, stride_cols,
-            output, data_format_)) {
+            padding_, output, data_format_)) {
       return;
     }
 
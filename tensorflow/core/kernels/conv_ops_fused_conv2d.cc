@@ -0,0 +1,238 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/conv_ops.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/padding.h"
+#include "tensorflow/core/util/tensor_format.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class Activation { kNone, kRelu, kRelu6 };
+
+}  // namespace
+
+// Computes the convolution with the generic CPU implementation of Conv2D, and
+// then applies the fused ops as a per-channel scale and offset followed by the
+// activation, in a single pass over the output.
+template <typename T>
+class FusedConv2DOp : public OpKernel {
+ public:
+  explicit FusedConv2DOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
+    OP_REQUIRES_OK(context, context->GetAttr("dilations", &dilations_));
+    OP_REQUIRES_OK(context, context->GetAttr("padding", &padding_));
+    string data_format;
+    OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
+    OP_REQUIRES(context, data_format == "NHWC",
+                errors::Unimplemented("_FusedConv2D only supports NHWC"));
+    OP_REQUIRES(context, strides_.size() == 4 && dilations_.size() == 4,
+                errors::InvalidArgument("Sliding window strides and "
+                                        "dilations must specify 4 dimensions"));
+    OP_REQUIRES(context,
+                strides_[0] == 1 && strides_[3] == 1 && dilations_[0] == 1 &&
+                    dilations_[3] == 1,
+                errors::InvalidArgument(
+                    "Current implementation does not yet support strides or "
+                    "dilations in the batch and depth dimensions."));
+    OP_REQUIRES(context,
+                strides_[1] > 0 && strides_[2] > 0 && dilations_[1] > 0 &&
+                    dilations_[2] > 0,
+                errors::InvalidArgument(
+                    "Strides and dilated rates should be larger than 0."));
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    size_t i = 0;
+    if (i < fused_ops.size() && fused_ops[i] == "BiasAdd") {
+      has_bias_ = true;
+      ++i;
+    }
+    if (i < fused_ops.size() && fused_ops[i] == "FusedBatchNorm") {
+      has_batch_norm_ = true;
+      ++i;
+    }
+    if (i < fused_ops.size() && fused_ops[i] == "Relu") {
+      activation_ = Activation::kRelu;
+      ++i;
+    } else if (i < fused_ops.size() && fused_ops[i] == "Relu6") {
+      activation_ = Activation::kRelu6;
+      ++i;
+    }
+    OP_REQUIRES(context, i == fused_ops.size(),
+                errors::InvalidArgument("Unsupported fused ops: ",
+                                        str_util::Join(fused_ops, ", ")));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    const int expected_num_args = (has_bias_ ? 1 : 0) + (has_batch_norm_ ? 4 : 0);
+    OP_REQUIRES(context, num_args == expected_num_args,
+                errors::InvalidArgument("Expected ", expected_num_args,
+                                        " args for the fused ops, got ",
+                                        num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // Input tensor is of the following dimensions:
+    // [ batch, in_rows, in_cols, in_depth ]
+    const Tensor& input = context->input(0);
+
+    // Input filter is of the following dimensions:
+    // [ filter_rows, filter_cols, in_depth, out_depth]
+    const Tensor& filter = context->input(1);
+
+    OP_REQUIRES(context, input.dims() == 4,
+                errors::InvalidArgument("input must be 4-dimensional",
+                                        input.shape().DebugString()));
+    OP_REQUIRES(context, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+    for (int i = 0; i < 4; i++) {
+      OP_REQUIRES(
+          context,
+          FastBoundsCheck(input.dim_size(i), std::numeric_limits<int>::max()),
+          errors::InvalidArgument("input too large"));
+      OP_REQUIRES(
+          context,
+          FastBoundsCheck(filter.dim_size(i), std::numeric_limits<int>::max()),
+          errors::InvalidArgument("filter too large"));
+    }
+    OP_REQUIRES(context, input.dim_size(3) == filter.dim_size(2),
+                errors::InvalidArgument(
+                    "input depth must be equal to filter depth: ",
+                    input.dim_size(3), " vs ", filter.dim_size(2)));
+    const int64 out_depth = filter.dim_size(3);
+
+    int64 out_rows = 0, out_cols = 0, pad_rows = 0, pad_cols = 0;
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSizeV2(input.dim_size(1), filter.dim_size(0),
+                                           dilations_[1], strides_[1], padding_,
+                                           &out_rows, &pad_rows));
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSizeV2(input.dim_size(2), filter.dim_size(1),
+                                           dilations_[2], strides_[2], padding_,
+                                           &out_cols, &pad_cols));
+    TensorShape out_shape({input.dim_size(0), out_rows, out_cols, out_depth});
+
+    // Folds the bias and the batch norm into a per-channel scale and offset.
+    for (int i = 2; i < context->num_inputs(); ++i) {
+      const Tensor& arg = context->input(i);
+      OP_REQUIRES(context,
+                  arg.dims() == 1 && arg.dim_size(0) == out_depth,
+                  errors::InvalidArgument("args must be vectors of size ",
+                                          out_depth, ", got ",
+                                          arg.shape().DebugString()));
+    }
+    std::vector<T> scale(out_depth, static_cast<T>(1));
+    std::vector<T> offset(out_depth, static_cast<T>(0));
+    int next_arg = 2;
+    if (has_bias_) {
+      auto bias = context->input(next_arg++).vec<T>();
+      for (int64 c = 0; c < out_depth; ++c) {
+        offset[c] = bias(c);
+      }
+    }
+    if (has_batch_norm_) {
+      auto bn_scale = context->input(next_arg).vec<T>();
+      auto bn_offset = context->input(next_arg + 1).vec<T>();
+      auto mean = context->input(next_arg + 2).vec<T>();
+      auto variance = context->input(next_arg + 3).vec<T>();
+      for (int64 c = 0; c < out_depth; ++c) {
+        const T s = bn_scale(c) / Eigen::numext::sqrt(
+                                      variance(c) + static_cast<T>(epsilon_));
+        scale[c] = s;
+        offset[c] = (offset[c] - mean(c)) * s + bn_offset(c);
+      }
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &output));
+    if (out_shape.num_elements() == 0) {
+      return;
+    }
+    launcher_(context, /*use_cudnn=*/false, /*cudnn_use_autotune=*/false,
+              input, filter, dilations_[1], dilations_[2], strides_[1],
+              strides_[2], padding_, output, FORMAT_NHWC);
+    if (!context->status().ok()) {
+      return;
+    }
+
+    T* out = output->flat<T>().data();
+    const bool has_scale = has_batch_norm_;
+    const Activation activation = activation_;
+    auto apply = [out, out_depth, has_scale, activation, &scale, &offset](
+                     int64 start, int64 limit) {
+      for (int64 row = start; row < limit; ++row) {
+        T* y = out + row * out_depth;
+        for (int64 c = 0; c < out_depth; ++c) {
+          T v = has_scale ? y[c] * scale[c] + offset[c] : y[c] + offset[c];
+          if (activation == Activation::kRelu) {
+            v = std::max(v, static_cast<T>(0));
+          } else if (activation == Activation::kRelu6) {
+            v = std::min(std::max(v, static_cast<T>(0)), static_cast<T>(6));
+          }
+          y[c] = v;
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          out_shape.num_elements() / out_depth, out_depth * 4, apply);
+  }
+
+ private:
+  std::vector<int32> strides_;
+  std::vector<int32> dilations_;
+  Padding padding_;
+  float epsilon_;
+  bool has_bias_ = false;
+  bool has_batch_norm_ = false;
+  Activation activation_ = Activation::kNone;
+  LaunchConv2DOp<CPUDevice, T> launcher_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConv2DOp);
+};
+
+#define REGISTER_KERNEL(T)                                              \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("_FusedConv2D").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedConv2DOp<T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,908 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A consolidated benchmark suite for the most used kernels, meant to be run
+// as a whole and compared against a baseline to catch kernel regressions (see
+// //tensorflow/tools/test:core_ops_benchmark and compare_benchmarks.py).
+//
+// Every benchmark runs at three sizes (0: small, 1: medium, 2: large) and, on
+// CPU, with 1, 4 and 16 intra-op threads. Benchmarks are named
+//   BM_<Family>_<Op>_<device>/<size>/<threads>
+// Items processed are the floating point operations for MatMul and
+// convolutions, and the elements of the largest input otherwise. Bytes
+// processed are the bytes of all the inputs.
+//
+// New benchmarks should keep existing names and sizes unchanged, so that they
+// remain comparable with stored baselines.
+
+#include <random>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// A graph to benchmark, with the work done by one run of it.
+struct BenchmarkGraph {
+  Graph* graph = nullptr;
+  int64 items = 0;
+  int64 bytes = 0;
+  string label;
+};
+
+void RunBenchmark(int iters, const string& device, int num_threads,
+                  const BenchmarkGraph& b) {
+  testing::ItemsProcessed(b.items * iters);
+  testing::BytesProcessed(b.bytes * iters);
+  testing::SetLabel(b.label);
+  SessionOptions options;
+  options.config.set_intra_op_parallelism_threads(num_threads);
+  test::Benchmark(device, b.graph, &options).Run(iters);
+}
+
+Tensor RandomFloats(const TensorShape& shape) {
+  Tensor t(DT_FLOAT, shape);
+  // Keeps values positive, so that Log, Sqrt etc. do not produce NaNs.
+  t.flat<float>() = t.flat<float>().setRandom().abs() + 0.5f;
+  return t;
+}
+
+Tensor RandomIndices(int64 size, int64 limit) {
+  Tensor t(DT_INT32, TensorShape({size}));
+  std::mt19937 rng(301);
+  std::uniform_int_distribution<int32> dist(0, limit - 1);
+  auto flat = t.flat<int32>();
+  for (int64 i = 0; i < size; ++i) {
+    flat(i) = dist(rng);
+  }
+  return t;
+}
+
+Tensor Int32s(gtl::ArraySlice<int32> values) {
+  return test::AsTensor<int32>(values);
+}
+
+Node* Const(Graph* g, const Tensor& t) { return test::graph::Constant(g, t); }
+
+int64 Bytes(gtl::ArraySlice<Tensor> inputs) {
+  int64 bytes = 0;
+  for (const Tensor& t : inputs) {
+    bytes += t.TotalBytes();
+  }
+  return bytes;
+}
+
+// The sizes of the elementwise benchmarks.
+constexpr int64 kElementwiseSizes[] = {1 << 12, 1 << 18, 1 << 24};
+// The [rows, cols] of the 2D benchmarks (reductions, data movement).
+constexpr int64 kMatrixShapes[][2] = {{64, 64}, {512, 512}, {4096, 4096}};
+
+struct ConvShape {
+  int64 batch, height, width, in_depth, filter, out_depth;
+};
+constexpr ConvShape kConvShapes[] = {
+    {8, 32, 32, 32, 3, 32},
+    {32, 56, 56, 64, 3, 64},
+    {32, 14, 14, 256, 3, 256},
+};
+
+// ---------------------------------------------------------------------------
+// Elementwise ops.
+
+BenchmarkGraph Unary(const string& op, int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(TensorShape({kElementwiseSizes[size]}));
+  test::graph::Unary(b.graph, op, Const(b.graph, x));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph Binary(const string& op, int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(TensorShape({kElementwiseSizes[size]}));
+  Tensor y = RandomFloats(TensorShape({kElementwiseSizes[size]}));
+  test::graph::Binary(b.graph, op, Const(b.graph, x), Const(b.graph, y));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x, y});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+// Broadcasts a row vector over the rows of a matrix.
+BenchmarkGraph BroadcastBinary(const string& op, int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 cols = kMatrixShapes[size][1];
+  Tensor x = RandomFloats(TensorShape({kMatrixShapes[size][0], cols}));
+  Tensor y = RandomFloats(TensorShape({cols}));
+  test::graph::Binary(b.graph, op, Const(b.graph, x), Const(b.graph, y));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x, y});
+  b.label = strings::StrCat(x.shape().DebugString(), " ",
+                            y.shape().DebugString());
+  return b;
+}
+
+BenchmarkGraph CastTo(DataType dtype, int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(TensorShape({kElementwiseSizes[size]}));
+  test::graph::Cast(b.graph, Const(b.graph, x), dtype);
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = strings::StrCat(x.shape().DebugString(), " to ",
+                            DataTypeString(dtype));
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Reductions.
+
+BenchmarkGraph Reduce(const string& op, int size, int axis) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(
+      TensorShape({kMatrixShapes[size][0], kMatrixShapes[size][1]}));
+  test::graph::Reduce(b.graph, op, Const(b.graph, x),
+                      Const(b.graph, Int32s({axis})), /*keep_dims=*/false);
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = strings::StrCat(x.shape().DebugString(), " axis ", axis);
+  return b;
+}
+
+BenchmarkGraph ArgReduce(const string& op, int size, int axis) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(
+      TensorShape({kMatrixShapes[size][0], kMatrixShapes[size][1]}));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), op)
+                  .Input(Const(b.graph, x))
+                  .Input(Const(b.graph, test::AsScalar<int32>(axis)))
+                  .Finalize(b.graph, nullptr));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = strings::StrCat(x.shape().DebugString(), " axis ", axis);
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Matrix multiplications.
+
+constexpr int64 kMatMulSizes[] = {64, 512, 2048};
+
+BenchmarkGraph MatMul(int size, bool transpose_a, bool transpose_b) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 n = kMatMulSizes[size];
+  Tensor x = RandomFloats(TensorShape({n, n}));
+  Tensor y = RandomFloats(TensorShape({n, n}));
+  test::graph::Matmul(b.graph, Const(b.graph, x), Const(b.graph, y),
+                      transpose_a, transpose_b);
+  b.items = 2 * n * n * n;
+  b.bytes = Bytes({x, y});
+  b.label = strings::StrCat(n, "x", n, "x", n);
+  return b;
+}
+
+BenchmarkGraph BatchMatMul(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 batch = 8;
+  const int64 n = kMatMulSizes[size] / 2;
+  Tensor x = RandomFloats(TensorShape({batch, n, n}));
+  Tensor y = RandomFloats(TensorShape({batch, n, n}));
+  test::graph::BatchMatmul(b.graph, Const(b.graph, x), Const(b.graph, y),
+                           false, false);
+  b.items = 2 * batch * n * n * n;
+  b.bytes = Bytes({x, y});
+  b.label = strings::StrCat(batch, "x", n, "x", n, "x", n);
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Convolutions and other NN ops, on NHWC images.
+
+TensorShape InputShape(const ConvShape& s) {
+  return TensorShape({s.batch, s.height, s.width, s.in_depth});
+}
+TensorShape OutputShape(const ConvShape& s) {
+  return TensorShape({s.batch, s.height, s.width, s.out_depth});
+}
+TensorShape FilterShape(const ConvShape& s) {
+  return TensorShape({s.filter, s.filter, s.in_depth, s.out_depth});
+}
+int64 ConvFlops(const ConvShape& s) {
+  return 2 * s.batch * s.height * s.width * s.out_depth * s.filter * s.filter *
+         s.in_depth;
+}
+string ConvLabel(const ConvShape& s) {
+  return strings::StrCat(InputShape(s).DebugString(), " filter ",
+                         FilterShape(s).DebugString());
+}
+
+BenchmarkGraph Conv2D(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor input = RandomFloats(InputShape(s));
+  Tensor filter = RandomFloats(FilterShape(s));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "Conv2D")
+                  .Input(Const(b.graph, input))
+                  .Input(Const(b.graph, filter))
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(b.graph, nullptr));
+  b.items = ConvFlops(s);
+  b.bytes = Bytes({input, filter});
+  b.label = ConvLabel(s);
+  return b;
+}
+
+BenchmarkGraph Conv2DBackpropInput(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor input_sizes = Int32s({static_cast<int32>(s.batch),
+                               static_cast<int32>(s.height),
+                               static_cast<int32>(s.width),
+                               static_cast<int32>(s.in_depth)});
+  Tensor filter = RandomFloats(FilterShape(s));
+  Tensor out_backprop = RandomFloats(OutputShape(s));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "Conv2DBackpropInput")
+                  .Input(Const(b.graph, input_sizes))
+                  .Input(Const(b.graph, filter))
+                  .Input(Const(b.graph, out_backprop))
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(b.graph, nullptr));
+  b.items = ConvFlops(s);
+  b.bytes = Bytes({filter, out_backprop});
+  b.label = ConvLabel(s);
+  return b;
+}
+
+BenchmarkGraph Conv2DBackpropFilter(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor input = RandomFloats(InputShape(s));
+  Tensor filter_sizes = Int32s(
+      {static_cast<int32>(s.filter), static_cast<int32>(s.filter),
+       static_cast<int32>(s.in_depth), static_cast<int32>(s.out_depth)});
+  Tensor out_backprop = RandomFloats(OutputShape(s));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "Conv2DBackpropFilter")
+                  .Input(Const(b.graph, input))
+                  .Input(Const(b.graph, filter_sizes))
+                  .Input(Const(b.graph, out_backprop))
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(b.graph, nullptr));
+  b.items = ConvFlops(s);
+  b.bytes = Bytes({input, out_backprop});
+  b.label = ConvLabel(s);
+  return b;
+}
+
+BenchmarkGraph DepthwiseConv2dNative(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor input = RandomFloats(InputShape(s));
+  Tensor filter =
+      RandomFloats(TensorShape({s.filter, s.filter, s.in_depth, 1}));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "DepthwiseConv2dNative")
+                  .Input(Const(b.graph, input))
+                  .Input(Const(b.graph, filter))
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(b.graph, nullptr));
+  b.items = 2 * s.batch * s.height * s.width * s.in_depth * s.filter * s.filter;
+  b.bytes = Bytes({input, filter});
+  b.label = ConvLabel(s);
+  return b;
+}
+
+// 3x3 windows with stride 2.
+BenchmarkGraph Pool(const string& op, int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor input = RandomFloats(InputShape(s));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), op)
+                  .Input(Const(b.graph, input))
+                  .Attr("ksize", {1, 3, 3, 1})
+                  .Attr("strides", {1, 2, 2, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(b.graph, nullptr));
+  b.items = input.NumElements();
+  b.bytes = Bytes({input});
+  b.label = input.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph BiasAdd(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor value = RandomFloats(OutputShape(s));
+  Tensor bias = RandomFloats(TensorShape({s.out_depth}));
+  test::graph::BiasAdd(b.graph, Const(b.graph, value), Const(b.graph, bias));
+  b.items = value.NumElements();
+  b.bytes = Bytes({value, bias});
+  b.label = value.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph BiasAddGrad(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor out_backprop = RandomFloats(OutputShape(s));
+  test::graph::Unary(b.graph, "BiasAddGrad", Const(b.graph, out_backprop));
+  b.items = out_backprop.NumElements();
+  b.bytes = Bytes({out_backprop});
+  b.label = out_backprop.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph FusedBatchNorm(int size) {
+  const ConvShape& s = kConvShapes[size];
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(InputShape(s));
+  Tensor scale = RandomFloats(TensorShape({s.in_depth}));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "FusedBatchNorm")
+                  .Input(Const(b.graph, x))
+                  .Input(Const(b.graph, scale))
+                  .Input(Const(b.graph, scale))
+                  .Input(Const(b.graph, scale))
+                  .Input(Const(b.graph, scale))
+                  .Attr("is_training", false)
+                  .Finalize(b.graph, nullptr));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x, scale, scale, scale, scale});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+// [batch, classes] logits.
+constexpr int64 kSoftmaxShapes[][2] = {{32, 1000}, {256, 10000}, {512, 32000}};
+
+BenchmarkGraph Softmax(const string& op, int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor logits = RandomFloats(
+      TensorShape({kSoftmaxShapes[size][0], kSoftmaxShapes[size][1]}));
+  test::graph::Unary(b.graph, op, Const(b.graph, logits));
+  b.items = logits.NumElements();
+  b.bytes = Bytes({logits});
+  b.label = logits.shape().DebugString();
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Gather and scatter, on [rows, 64] tables.
+
+constexpr int64 kTableRows[] = {1 << 10, 1 << 17, 1 << 20};
+constexpr int64 kNumIndices[] = {1 << 10, 1 << 14, 1 << 17};
+constexpr int64 kTableCols = 64;
+
+BenchmarkGraph Gather(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor params = RandomFloats(TensorShape({kTableRows[size], kTableCols}));
+  Tensor indices = RandomIndices(kNumIndices[size], kTableRows[size]);
+  test::graph::Gather(b.graph, Const(b.graph, params),
+                      Const(b.graph, indices),
+                      Const(b.graph, test::AsScalar<int32>(0)));
+  b.items = indices.NumElements() * kTableCols;
+  b.bytes = Bytes({indices}) + b.items * sizeof(float);
+  b.label = strings::StrCat(indices.NumElements(), " rows of ",
+                            params.shape().DebugString());
+  return b;
+}
+
+BenchmarkGraph GatherNd(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor params = RandomFloats(TensorShape({kTableRows[size], kTableCols}));
+  Tensor indices = RandomIndices(kNumIndices[size], kTableRows[size]);
+  CHECK(indices.CopyFrom(indices, TensorShape({kNumIndices[size], 1})));
+  test::graph::Binary(b.graph, "GatherNd", Const(b.graph, params),
+                      Const(b.graph, indices));
+  b.items = indices.NumElements() * kTableCols;
+  b.bytes = Bytes({indices}) + b.items * sizeof(float);
+  b.label = strings::StrCat(indices.NumElements(), " rows of ",
+                            params.shape().DebugString());
+  return b;
+}
+
+BenchmarkGraph ScatterNd(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor indices = RandomIndices(kNumIndices[size], kTableRows[size]);
+  CHECK(indices.CopyFrom(indices, TensorShape({kNumIndices[size], 1})));
+  Tensor updates = RandomFloats(TensorShape({kNumIndices[size], kTableCols}));
+  Tensor shape = Int32s({static_cast<int32>(kTableRows[size]),
+                         static_cast<int32>(kTableCols)});
+  test::graph::Multi(b.graph, "ScatterNd",
+                     {Const(b.graph, indices), Const(b.graph, updates),
+                      Const(b.graph, shape)});
+  b.items = updates.NumElements();
+  b.bytes = Bytes({indices, updates});
+  b.label = strings::StrCat(updates.shape().DebugString(), " into ",
+                            kTableRows[size], " rows");
+  return b;
+}
+
+BenchmarkGraph UnsortedSegmentSum(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 num_segments = kNumIndices[size] / 8;
+  Tensor data = RandomFloats(TensorShape({kNumIndices[size], kTableCols}));
+  Tensor segment_ids = RandomIndices(kNumIndices[size], num_segments);
+  test::graph::Multi(
+      b.graph, "UnsortedSegmentSum",
+      {Const(b.graph, data), Const(b.graph, segment_ids),
+       Const(b.graph, test::AsScalar<int32>(num_segments))});
+  b.items = data.NumElements();
+  b.bytes = Bytes({data, segment_ids});
+  b.label = strings::StrCat(data.shape().DebugString(), " into ",
+                            num_segments, " segments");
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Data movement, on [rows, cols] matrices.
+
+Tensor Matrix(int size) {
+  return RandomFloats(
+      TensorShape({kMatrixShapes[size][0], kMatrixShapes[size][1]}));
+}
+
+// Concatenates 4 matrices.
+BenchmarkGraph ConcatV2(int size, int axis) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  std::vector<Node*> inputs(4, Const(b.graph, x));
+  test::graph::ConcatV2(b.graph, inputs,
+                        Const(b.graph, test::AsScalar<int32>(axis)));
+  b.items = 4 * x.NumElements();
+  b.bytes = 4 * x.TotalBytes();
+  b.label = strings::StrCat("4 x ", x.shape().DebugString(), " axis ", axis);
+  return b;
+}
+
+// Splits a matrix in 4.
+BenchmarkGraph Split(int size, int axis) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "Split")
+                  .Input(Const(b.graph, test::AsScalar<int32>(axis)))
+                  .Input(Const(b.graph, x))
+                  .Attr("num_split", 4)
+                  .Finalize(b.graph, nullptr));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = strings::StrCat(x.shape().DebugString(), " axis ", axis);
+  return b;
+}
+
+// Splits the columns of a matrix in 3 uneven parts.
+BenchmarkGraph SplitV(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  const int32 cols = kMatrixShapes[size][1];
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "SplitV")
+                  .Input(Const(b.graph, x))
+                  .Input(Const(b.graph, Int32s({cols / 2, cols / 4, -1})))
+                  .Input(Const(b.graph, test::AsScalar<int32>(1)))
+                  .Attr("num_split", 3)
+                  .Finalize(b.graph, nullptr));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph Pack(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  std::vector<NodeBuilder::NodeOut> inputs(4, Const(b.graph, x));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "Pack")
+                  .Input(inputs)
+                  .Finalize(b.graph, nullptr));
+  b.items = 4 * x.NumElements();
+  b.bytes = 4 * x.TotalBytes();
+  b.label = strings::StrCat("4 x ", x.shape().DebugString());
+  return b;
+}
+
+BenchmarkGraph Unpack(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(
+      TensorShape({4, kMatrixShapes[size][0], kMatrixShapes[size][1]}));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "Unpack")
+                  .Input(Const(b.graph, x))
+                  .Attr("num", 4)
+                  .Finalize(b.graph, nullptr));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+// Takes the bottom right quarter of a matrix.
+BenchmarkGraph Slice(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  const int32 rows = kMatrixShapes[size][0];
+  const int32 cols = kMatrixShapes[size][1];
+  test::graph::Multi(b.graph, "Slice",
+                     {Const(b.graph, x),
+                      Const(b.graph, Int32s({rows / 2, cols / 2})),
+                      Const(b.graph, Int32s({rows / 2, cols / 2}))});
+  b.items = x.NumElements() / 4;
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+// Takes every other row and column of a matrix.
+BenchmarkGraph StridedSlice(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  const int32 rows = kMatrixShapes[size][0];
+  const int32 cols = kMatrixShapes[size][1];
+  test::graph::Multi(
+      b.graph, "StridedSlice",
+      {Const(b.graph, x), Const(b.graph, Int32s({0, 0})),
+       Const(b.graph, Int32s({rows, cols})), Const(b.graph, Int32s({2, 2}))});
+  b.items = x.NumElements() / 4;
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph Tile(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  test::graph::Binary(b.graph, "Tile", Const(b.graph, x),
+                      Const(b.graph, Int32s({2, 2})));
+  b.items = 4 * x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = strings::StrCat(x.shape().DebugString(), " 2x2");
+  return b;
+}
+
+BenchmarkGraph Pad(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  Tensor paddings(DT_INT32, TensorShape({2, 2}));
+  paddings.flat<int32>().setConstant(1);
+  test::graph::Binary(b.graph, "Pad", Const(b.graph, x),
+                      Const(b.graph, paddings));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph Transpose2D(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  test::graph::Binary(b.graph, "Transpose", Const(b.graph, x),
+                      Const(b.graph, Int32s({1, 0})));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+// NHWC to NCHW.
+BenchmarkGraph Transpose4D(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = RandomFloats(InputShape(kConvShapes[size]));
+  test::graph::Binary(b.graph, "Transpose", Const(b.graph, x),
+                      Const(b.graph, Int32s({0, 3, 1, 2})));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph ReverseV2(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor x = Matrix(size);
+  test::graph::Binary(b.graph, "ReverseV2", Const(b.graph, x),
+                      Const(b.graph, Int32s({1})));
+  b.items = x.NumElements();
+  b.bytes = Bytes({x});
+  b.label = x.shape().DebugString();
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Parsing, with batches of 1, 32 and 256 records.
+
+constexpr int64 kParseBatchSizes[] = {1, 32, 256};
+constexpr int kNumFeatures = 10;
+constexpr int kFeatureSize = 16;
+
+BenchmarkGraph ParseExample(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 batch_size = kParseBatchSizes[size];
+  Example example;
+  for (int i = 0; i < kNumFeatures; ++i) {
+    Feature& feature = (*example.mutable_features()
+                              ->mutable_feature())[strings::StrCat("f", i)];
+    for (int j = 0; j < kFeatureSize; ++j) {
+      feature.mutable_float_list()->add_value(j);
+    }
+  }
+  Tensor serialized(DT_STRING, TensorShape({batch_size}));
+  serialized.flat<string>().setConstant(example.SerializeAsString());
+  Tensor names(DT_STRING, TensorShape({0}));
+  std::vector<NodeBuilder::NodeOut> dense_keys;
+  std::vector<NodeBuilder::NodeOut> dense_defaults;
+  std::vector<PartialTensorShape> dense_shapes;
+  for (int i = 0; i < kNumFeatures; ++i) {
+    dense_keys.emplace_back(
+        Const(b.graph, test::AsScalar<string>(strings::StrCat("f", i))));
+    dense_defaults.emplace_back(
+        Const(b.graph, Tensor(DT_FLOAT, TensorShape({0}))));
+    dense_shapes.push_back(PartialTensorShape({kFeatureSize}));
+  }
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "ParseExample")
+                  .Input(Const(b.graph, serialized))
+                  .Input(Const(b.graph, names))
+                  .Input(std::vector<NodeBuilder::NodeOut>())
+                  .Input(dense_keys)
+                  .Input(dense_defaults)
+                  .Attr("sparse_types", DataTypeVector())
+                  .Attr("dense_shapes", dense_shapes)
+                  .Finalize(b.graph, nullptr));
+  b.items = batch_size * kNumFeatures * kFeatureSize;
+  b.bytes = Bytes({serialized});
+  b.label = strings::StrCat(batch_size, " examples of ", kNumFeatures, "x",
+                            kFeatureSize, " floats");
+  return b;
+}
+
+BenchmarkGraph DecodeCSV(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 batch_size = kParseBatchSizes[size];
+  std::vector<string> fields;
+  for (int i = 0; i < kNumFeatures; ++i) {
+    fields.push_back(strings::StrCat(i, ".25"));
+  }
+  Tensor records(DT_STRING, TensorShape({batch_size}));
+  records.flat<string>().setConstant(str_util::Join(fields, ","));
+  std::vector<NodeBuilder::NodeOut> record_defaults(
+      kNumFeatures, Const(b.graph, Tensor(DT_FLOAT, TensorShape({0}))));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "DecodeCSV")
+                  .Input(Const(b.graph, records))
+                  .Input(record_defaults)
+                  .Finalize(b.graph, nullptr));
+  b.items = batch_size * kNumFeatures;
+  b.bytes = Bytes({records});
+  b.label = strings::StrCat(batch_size, " records of ", kNumFeatures,
+                            " floats");
+  return b;
+}
+
+BenchmarkGraph StringToNumber(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  Tensor numbers(DT_STRING,
+                 TensorShape({kParseBatchSizes[size] * kNumFeatures}));
+  numbers.flat<string>().setConstant("1234.5678");
+  test::graph::Unary(b.graph, "StringToNumber", Const(b.graph, numbers));
+  b.items = numbers.NumElements();
+  b.bytes = Bytes({numbers});
+  b.label = numbers.shape().DebugString();
+  return b;
+}
+
+BenchmarkGraph DecodeRaw(int size) {
+  BenchmarkGraph b;
+  b.graph = new Graph(OpRegistry::Global());
+  const int64 batch_size = kParseBatchSizes[size];
+  Tensor bytes(DT_STRING, TensorShape({batch_size}));
+  bytes.flat<string>().setConstant(
+      string(kNumFeatures * kFeatureSize * sizeof(float), '\x01'));
+  TF_CHECK_OK(NodeBuilder(b.graph->NewName("n"), "DecodeRaw")
+                  .Input(Const(b.graph, bytes))
+                  .Attr("out_type", DT_FLOAT)
+                  .Finalize(b.graph, nullptr));
+  b.items = batch_size * kNumFeatures * kFeatureSize;
+  b.bytes = Bytes({bytes});
+  b.label = strings::StrCat(batch_size, " records");
+  return b;
+}
+
+// ---------------------------------------------------------------------------
+// Registration. The expression after the name builds the graph of a given
+// `size`.
+
+#define BM_CPU(NAME, ...)                                               \
+  void BM_##NAME##_cpu(int iters, int size, int threads) {              \
+    RunBenchmark(iters, "cpu", threads, __VA_ARGS__);                   \
+  }                                                                     \
+  BENCHMARK(BM_##NAME##_cpu)                                            \
+      ->ArgPair(0, 1)                                                   \
+      ->ArgPair(0, 4)                                                   \
+      ->ArgPair(0, 16)                                                  \
+      ->ArgPair(1, 1)                                                   \
+      ->ArgPair(1, 4)                                                   \
+      ->ArgPair(1, 16)                                                  \
+      ->ArgPair(2, 1)                                                   \
+      ->ArgPair(2, 4)                                                   \
+      ->ArgPair(2, 16);
+
+#if GOOGLE_CUDA
+#define BM_GPU(NAME, ...)                                               \
+  void BM_##NAME##_gpu(int iters, int size, int threads) {              \
+    RunBenchmark(iters, "gpu", threads, __VA_ARGS__);                   \
+  }                                                                     \
+  BENCHMARK(BM_##NAME##_gpu)->ArgPair(0, 1)->ArgPair(1, 1)->ArgPair(2, 1);
+#else
+#define BM_GPU(NAME, ...)
+#endif  // GOOGLE_CUDA
+
+#define BM_CPU_AND_GPU(NAME, ...) \
+  BM_CPU(NAME, __VA_ARGS__)       \
+  BM_GPU(NAME, __VA_ARGS__)
+
+#define BM_UNARY(OP) BM_CPU_AND_GPU(Unary_##OP, Unary(#OP, size))
+BM_UNARY(Abs);
+BM_UNARY(Neg);
+BM_UNARY(Exp);
+BM_UNARY(Expm1);
+BM_UNARY(Log);
+BM_UNARY(Log1p);
+BM_UNARY(Sqrt);
+BM_UNARY(Rsqrt);
+BM_UNARY(Square);
+BM_UNARY(Reciprocal);
+BM_UNARY(Tanh);
+BM_UNARY(Sigmoid);
+BM_UNARY(Relu);
+BM_UNARY(Relu6);
+BM_UNARY(Elu);
+BM_UNARY(Selu);
+BM_UNARY(Softplus);
+BM_UNARY(Floor);
+BM_UNARY(Ceil);
+BM_UNARY(Round);
+BM_UNARY(Sign);
+BM_UNARY(Sin);
+BM_UNARY(Cos);
+BM_UNARY(Tan);
+BM_UNARY(Atan);
+BM_UNARY(Erf);
+BM_UNARY(Lgamma);
+BM_UNARY(IsFinite);
+#undef BM_UNARY
+
+#define BM_BINARY(OP) BM_CPU_AND_GPU(Binary_##OP, Binary(#OP, size))
+BM_BINARY(Add);
+BM_BINARY(Sub);
+BM_BINARY(Mul);
+BM_BINARY(RealDiv);
+BM_BINARY(Maximum);
+BM_BINARY(Minimum);
+BM_BINARY(Pow);
+BM_BINARY(SquaredDifference);
+BM_BINARY(Less);
+BM_BINARY(Equal);
+BM_BINARY(ReluGrad);
+BM_BINARY(SigmoidGrad);
+BM_BINARY(TanhGrad);
+#undef BM_BINARY
+
+BM_CPU_AND_GPU(BroadcastBinary_Add, BroadcastBinary("Add", size));
+BM_CPU_AND_GPU(BroadcastBinary_Mul, BroadcastBinary("Mul", size));
+BM_CPU_AND_GPU(Cast_Half, CastTo(DT_HALF, size));
+BM_CPU_AND_GPU(Cast_Int32, CastTo(DT_INT32, size));
+
+#define BM_REDUCE(OP)                                             \
+  BM_CPU_AND_GPU(ReduceRows_##OP, Reduce(#OP, size, /*axis=*/0)) \
+  BM_CPU_AND_GPU(ReduceCols_##OP, Reduce(#OP, size, /*axis=*/1))
+BM_REDUCE(Sum);
+BM_REDUCE(Mean);
+BM_REDUCE(Max);
+BM_REDUCE(Min);
+BM_REDUCE(Prod);
+#undef BM_REDUCE
+BM_CPU_AND_GPU(ReduceRows_ArgMax, ArgReduce("ArgMax", size, /*axis=*/0));
+BM_CPU_AND_GPU(ReduceCols_ArgMax, ArgReduce("ArgMax", size, /*axis=*/1));
+BM_CPU_AND_GPU(ReduceCols_ArgMin, ArgReduce("ArgMin", size, /*axis=*/1));
+
+BM_CPU_AND_GPU(MatMul_NN, MatMul(size, false, false));
+BM_CPU_AND_GPU(MatMul_TN, MatMul(size, true, false));
+BM_CPU_AND_GPU(MatMul_NT, MatMul(size, false, true));
+BM_CPU_AND_GPU(BatchMatMul, BatchMatMul(size));
+
+BM_CPU_AND_GPU(NN_Conv2D, Conv2D(size));
+BM_CPU_AND_GPU(NN_Conv2DBackpropInput, Conv2DBackpropInput(size));
+BM_CPU_AND_GPU(NN_Conv2DBackpropFilter, Conv2DBackpropFilter(size));
+BM_CPU_AND_GPU(NN_DepthwiseConv2dNative, DepthwiseConv2dNative(size));
+BM_CPU_AND_GPU(NN_MaxPool, Pool("MaxPool", size));
+BM_CPU_AND_GPU(NN_AvgPool, Pool("AvgPool", size));
+BM_CPU_AND_GPU(NN_BiasAdd, BiasAdd(size));
+BM_CPU_AND_GPU(NN_BiasAddGrad, BiasAddGrad(size));
+BM_CPU_AND_GPU(NN_FusedBatchNorm, FusedBatchNorm(size));
+BM_CPU_AND_GPU(NN_Softmax, Softmax("Softmax", size));
+BM_CPU_AND_GPU(NN_LogSoftmax, Softmax("LogSoftmax", size));
+
+BM_CPU_AND_GPU(Gather_GatherV2, Gather(size));
+BM_CPU_AND_GPU(Gather_GatherNd, GatherNd(size));
+BM_CPU_AND_GPU(Scatter_ScatterNd, ScatterNd(size));
+BM_CPU_AND_GPU(Scatter_UnsortedSegmentSum, UnsortedSegmentSum(size));
+
+BM_CPU_AND_GPU(Movement_ConcatRows, ConcatV2(size, /*axis=*/0));
+BM_CPU_AND_GPU(Movement_ConcatCols, ConcatV2(size, /*axis=*/1));
+BM_CPU_AND_GPU(Movement_SplitRows, Split(size, /*axis=*/0));
+BM_CPU_AND_GPU(Movement_SplitCols, Split(size, /*axis=*/1));
+BM_CPU_AND_GPU(Movement_SplitV, SplitV(size));
+BM_CPU_AND_GPU(Movement_Pack, Pack(size));
+BM_CPU_AND_GPU(Movement_Unpack, Unpack(size));
+BM_CPU_AND_GPU(Movement_Slice, Slice(size));
+BM_CPU_AND_GPU(Movement_StridedSlice, StridedSlice(size));
+BM_CPU_AND_GPU(Movement_Tile, Tile(size));
+BM_CPU_AND_GPU(Movement_Pad, Pad(size));
+BM_CPU_AND_GPU(Movement_Transpose2D, Transpose2D(size));
+BM_CPU_AND_GPU(Movement_Transpose4D, Transpose4D(size));
+BM_CPU_AND_GPU(Movement_ReverseV2, ReverseV2(size));
+
+// Parsing ops only have CPU kernels.
+BM_CPU(Parse_ParseExample, ParseExample(size));
+BM_CPU(Parse_DecodeCSV, DecodeCSV(size));
+BM_CPU(Parse_StringToNumber, StringToNumber(size));
+BM_CPU(Parse_DecodeRaw, DecodeRaw(size));
+
+}  // namespace
+}  // namespace tensorflow
@@ -144,7 +144,8 @@ class CudnnRnnParameters {
   CudnnRnnParameters(int num_layers, int input_size, int num_units,
                      int seq_length, int batch_size, int dir_count,
                      bool has_dropout, bool is_training, RnnMode rnn_mode,
-                     TFRNNInputMode rnn_input_mode, DataType dtype)
+                     TFRNNInputMode rnn_input_mode, DataType dtype,
+                     bool var_seq_lengths)
       : num_layers_(num_layers),
         input_size_(input_size),
         num_units_(num_units),
@@ -155,11 +156,13 @@ class CudnnRnnParameters {
         is_training_(is_training),
         rnn_mode_(rnn_mode),
         rnn_input_mode_(rnn_input_mode),
-        dtype_(dtype) {
+        dtype_(dtype),
+        var_seq_lengths_(var_seq_lengths) {
     hash_code_ = HashList(
         {num_layers, input_size, num_units, seq_length, batch_size, dir_count,
          static_cast<int>(has_dropout), static_cast<int>(is_training),
-         static_cast<int>(rnn_mode), static_cast<int>(rnn_input_mode), dtype});
+         static_cast<int>(rnn_mode), static_cast<int>(rnn_input_mode), dtype,
+         static_cast<int>(var_seq_lengths)});
   }
 
   bool operator==(const CudnnRnnParameters& other) const {
@@ -183,18 +186,21 @@ class CudnnRnnParameters {
         std::to_string(is_training_),
         std::to_string(static_cast<int>(rnn_mode_)),
         std::to_string(static_cast<int>(rnn_input_mode_)),
-        std::to_string(static_cast<int>(dtype_))};
+        std::to_string(static_cast<int>(dtype_)),
+        std::to_string(var_seq_lengths_)};
     return str_util::Join(fields, ", ");
   }
 
  private:
-  using ParameterDataType = std::tuple<int, int, int, int, int, int, bool, bool,
-                                       RnnMode, TFRNNInputMode, DataType>;
+  using ParameterDataType =
+      std::tuple<int, int, int, int, int, int, bool, bool, RnnMode,
+                 TFRNNInputMode, DataType, bool>;
 
   ParameterDataType get_data_as_tuple() const {
     return std::make_tuple(num_layers_, input_size_, num_units_, seq_length_,
                            batch_size_, dir_count_, has_dropout_, is_training_,
-                           rnn_mode_, rnn_input_mode_, dtype_);
+                           rnn_mode_, rnn_input_mode_, dtype_,
+                           var_seq_lengths_);
   }
 
   const int num_layers_;
@@ -208,6 +214,7 @@ class CudnnRnnParameters {
   const RnnMode rnn_mode_;
   const TFRNNInputMode rnn_input_mode_;
   const DataType dtype_;
+  const bool var_seq_lengths_;
   uint64 hash_code_;
 };
 
@@ -498,10 +505,15 @@ struct CudnnRnnModelShapes {
   TensorShape input_shape;
   TensorShape output_shape;
   TensorShape hidden_state_shape;
+  // Whether the sequences are padded to seq_length from the lengths in
+  // seq_lengths, which then has one per batch entry.
+  bool var_seq_lengths = false;
+  std::vector<int> seq_lengths;
   // At present only fields related to cached RnnDescriptor are concerned.
   bool IsCompatibleWith(const CudnnRnnModelShapes& rhs) const {
     return num_layers == rhs.num_layers && input_size == rhs.input_size &&
-           num_units == rhs.num_units && dir_count == rhs.dir_count;
+           num_units == rhs.num_units && dir_count == rhs.dir_count &&
+           var_seq_lengths == rhs.var_seq_lengths;
   }
   string DebugString() const {
     return strings::Printf(
@@ -521,7 +533,8 @@ struct CudnnRnnConfigHasher {
 
     uint64 hash =
         HashList({shapes.num_layers, shapes.input_size, shapes.num_units,
-                  shapes.dir_count, shapes.batch_size});
+                  shapes.dir_count, shapes.batch_size,
+                  static_cast<int>(shapes.var_seq_lengths)});
     hash = Hash64Combine(hash, algo_desc.hash());
     return hash;
   }
@@ -545,11 +558,13 @@ struct RnnScratchSpace {
 };
 
 // Extract and checks the forward input tensors, parameters, and shapes from the
-// OpKernelContext.
+// OpKernelContext. With var_seq_lengths, the lengths of the sequences are
+// read from the "sequence_lengths" input.
 Status ExtractForwardInput(OpKernelContext* context,
                            const CudnnModelTypes& model_types,
-                           const Tensor** input, const Tensor** input_h,
-                           const Tensor** input_c, const Tensor** params,
+                           bool var_seq_lengths, const Tensor** input,
+                           const Tensor** input_h, const Tensor** input_c,
+                           const Tensor** params,
                            CudnnRnnModelShapes* model_shapes) {
   TF_RETURN_IF_ERROR(context->input("input", input));
   TF_RETURN_IF_ERROR(context->input("input_h", input_h));
@@ -595,6 +610,30 @@ Status ExtractForwardInput(OpKernelContext* context,
   model_shapes->output_shape =
       TensorShape({model_shapes->seq_length, model_shapes->batch_size,
                    model_shapes->dir_count * model_shapes->num_units});
+
+  model_shapes->var_seq_lengths = var_seq_lengths;
+  if (var_seq_lengths) {
+    const Tensor* sequence_lengths = nullptr;
+    TF_RETURN_IF_ERROR(context->input("sequence_lengths", &sequence_lengths));
+    if (sequence_lengths->shape() !=
+        TensorShape({model_shapes->batch_size})) {
+      return errors::InvalidArgument(
+          "sequence_lengths must be a vector of batch_size: ",
+          sequence_lengths->shape().DebugString(), " ",
+          model_shapes->input_shape.DebugString());
+    }
+    auto lengths = sequence_lengths->vec<int32>();
+    model_shapes->seq_lengths.assign(lengths.data(),
+                                     lengths.data() + lengths.size());
+    for (int length : model_shapes->seq_lengths) {
+      // cuDNN rejects empty sequences.
+      if (length < 1 || length > model_shapes->seq_length) {
+        return errors::InvalidArgument(
+            "sequence_lengths must be in [1, ", model_shapes->seq_length,
+            "], got ", length);
+      }
+    }
+  }
   return Status::OK();
 }
 
@@ -612,9 +651,14 @@ Status CreateForwardAndBackwardIODescriptors(
   const TensorShape& output_shape = model_shapes.output_shape;
 
   DCHECK_EQ(input_shape.dims(), 3);
-  auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
-      input_shape.dim_size(0), input_shape.dim_size(1), input_shape.dim_size(2),
-      data_type);
+  auto input_desc_s =
+      model_shapes.var_seq_lengths
+          ? executor->createRnnSequenceTensorDescriptor(
+                input_shape.dim_size(0), input_shape.dim_size(1),
+                input_shape.dim_size(2), model_shapes.seq_lengths, data_type)
+          : executor->createRnnSequenceTensorDescriptor(
+                input_shape.dim_size(0), input_shape.dim_size(1),
+                input_shape.dim_size(2), data_type);
   TF_RETURN_IF_ERROR(input_desc_s.status());
   *input_desc = input_desc_s.ConsumeValueOrDie();
 
@@ -626,9 +670,14 @@ Status CreateForwardAndBackwardIODescriptors(
   *state_desc = hidden_state_desc_s.ConsumeValueOrDie();
 
   DCHECK_EQ(output_shape.dims(), 3);
-  auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
-      output_shape.dim_size(0), output_shape.dim_size(1),
-      output_shape.dim_size(2), data_type);
+  auto output_desc_s =
+      model_shapes.var_seq_lengths
+          ? executor->createRnnSequenceTensorDescriptor(
+                output_shape.dim_size(0), output_shape.dim_size(1),
+                output_shape.dim_size(2), model_shapes.seq_lengths, data_type)
+          : executor->createRnnSequenceTensorDescriptor(
+                output_shape.dim_size(0), output_shape.dim_size(1),
+                output_shape.dim_size(2), data_type);
   TF_RETURN_IF_ERROR(output_desc_s.status());
   *output_desc = output_desc_s.ConsumeValueOrDie();
   return Status::OK();
@@ -740,6 +789,10 @@ Status DoBackward(
   // Creates a memory callback for the workspace. The memory lives to the end
   // of this kernel calls.
   Stream* stream = context->op_device_context()->stream();
+  if (model_shapes.var_seq_lengths) {
+    // cuDNN leaves the gradients of the padding unspecified.
+    stream->ThenMemZero(&input_backprop_data, input_backprop_data.size());
+  }
   bool launch_success =
       stream
           ->ThenRnnBackward(rnn_desc, *input_desc, input_data, *state_desc,
@@ -813,6 +866,9 @@ class CudnnRNNKernelCommon : public OpKernel {
     // every Compute() call.
     OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_CUDNN_RESET_RND_GEN_STATE",
                                                false, &reset_rnd_gen_state_));
+    // Only the V3 ops take the lengths of padded sequences.
+    int start, stop;
+    var_seq_lengths_ = InputRange("sequence_lengths", &start, &stop).ok();
   }
 
   bool HasInputC() const { return model_types_.HasInputC(); }
@@ -825,6 +881,7 @@ class CudnnRNNKernelCommon : public OpKernel {
   float dropout() const { return dropout_; }
   uint64 seed() { return (static_cast<uint64>(seed_) << 32) | seed2_; }
   bool ResetRndGenState() { return reset_rnd_gen_state_; }
+  bool var_seq_lengths() const { return var_seq_lengths_; }
 
   template <typename T>
   Status ExtractCudnnRNNParamsInfo(OpKernelContext* context,
@@ -859,7 +916,8 @@ class CudnnRNNKernelCommon : public OpKernel {
     auto rnn_desc_s = stream->parent()->createRnnDescriptor(
         num_layers, num_units, input_size, /*batch_size=*/0, input_mode,
         rnn_direction_mode(), rnn_mode(), ToDataType<T>::value, algo_config,
-        dropout(), seed(), /* state_allocator=*/nullptr);
+        dropout(), seed(), /* state_allocator=*/nullptr,
+        /*use_padded_io=*/false);
     if (!rnn_desc_s.ok()) {
       return FromExecutorStatus(rnn_desc_s);
     }
@@ -880,7 +938,7 @@ class CudnnRNNKernelCommon : public OpKernel {
         model_shapes.num_layers, model_shapes.num_units,
         model_shapes.input_size, model_shapes.batch_size, input_mode,
         rnn_direction_mode(), rnn_mode(), data_type, algo_config, dropout(),
-        seed(), dropout_state_allocator);
+        seed(), dropout_state_allocator, model_shapes.var_seq_lengths);
     TF_RETURN_IF_ERROR(rnn_desc_s.status());
 
     *rnn_desc = rnn_desc_s.ConsumeValueOrDie();
@@ -920,6 +978,7 @@ class CudnnRNNKernelCommon : public OpKernel {
   int seed2_;
   float dropout_;
   bool reset_rnd_gen_state_;
+  bool var_seq_lengths_;
 
   CudnnModelTypes model_types_;
 };
@@ -1172,9 +1231,10 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     const Tensor* input_c = nullptr;
     const Tensor* params = nullptr;
     CudnnRnnModelShapes model_shapes;
-    OP_REQUIRES_OK(context,
-                   ExtractForwardInput(context, model_types(), &input, &input_h,
-                                       &input_c, &params, &model_shapes));
+    OP_REQUIRES_OK(
+        context, ExtractForwardInput(context, model_types(), var_seq_lengths(),
+                                     &input, &input_h, &input_c, &params,
+                                     &model_shapes));
     RnnInputMode input_mode;
     OP_REQUIRES_OK(context,
                    ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
@@ -1354,7 +1414,8 @@ class CudnnRNNForwardOpV2<GPUDevice, T>
         model_shapes.num_units, model_shapes.seq_length,
         model_shapes.batch_size, model_shapes.dir_count,
         /*has_dropout=*/std::abs(dropout()) > 1e-8, is_training(),
-        modeltypes.rnn_mode, modeltypes.rnn_input_mode, input->dtype());
+        modeltypes.rnn_mode, modeltypes.rnn_input_mode, input->dtype(),
+        model_shapes.var_seq_lengths);
 
     if (AutoTuneRnnConfigMap::GetInstance()->Find(rnn_params, algo_config)) {
       return Status::OK();
@@ -1467,6 +1528,21 @@ TF_CALL_float(REGISTER_GPU);
 TF_CALL_double(REGISTER_GPU);
 #undef REGISTER_GPU
 
+// CudnnRNNV3 only adds the sequence_lengths input, which CudnnRNNKernelCommon
+// detects.
+#define REGISTER_GPU(T)                                       \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNV3")                  \
+                              .Device(DEVICE_GPU)             \
+                              .HostMemory("sequence_lengths") \
+                              .HostMemory("host_reserved")    \
+                              .TypeConstraint<T>("T"),        \
+                          CudnnRNNForwardOpV2<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+
 // Run the backward operation of the RNN model.
 template <typename T>
 class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
@@ -1480,9 +1556,10 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     const Tensor* input_c = nullptr;
     const Tensor* params = nullptr;
     CudnnRnnModelShapes model_shapes;
-    OP_REQUIRES_OK(context,
-                   ExtractForwardInput(context, model_types(), &input, &input_h,
-                                       &input_c, &params, &model_shapes));
+    OP_REQUIRES_OK(
+        context, ExtractForwardInput(context, model_types(), var_seq_lengths(),
+                                     &input, &input_h, &input_c, &params,
+                                     &model_shapes));
     RnnInputMode input_mode;
     OP_REQUIRES_OK(context,
                    ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
@@ -1672,6 +1749,19 @@ TF_CALL_float(REGISTER_GPU);
 TF_CALL_double(REGISTER_GPU);
 #undef REGISTER_GPU
 
+#define REGISTER_GPU(T)                                       \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNBackpropV3")          \
+                              .Device(DEVICE_GPU)             \
+                              .HostMemory("sequence_lengths") \
+                              .HostMemory("host_reserved")    \
+                              .TypeConstraint<T>("T"),        \
+                          CudnnRNNBackwardOpV2<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+
 // TODO(zhengxq): Add the conversion of Cudnn RNN Params from and to
 // its canonical form.
 
@@ -24,9 +24,12 @@ limitations under the License.
 
 #include <complex>
 
+#include <limits>
+
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/kernels/cwise_ops.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
 
 #include "tensorflow/core/platform/logging.h"
 namespace tensorflow {
@@ -36,11 +39,255 @@ typedef Eigen::GpuDevice GPUDevice;
 typedef std::complex<float> complex64;
 typedef std::complex<double> complex128;
 
+// The kernels below compute elementwise ops directly, without the per-call
+// overhead of Eigen's GPU evaluator, which dominates for the small and medium
+// tensors that make up most cwise launches. Each thread processes
+// CwiseVectorSize<T> consecutive elements, so that the loads and stores of
+// 1-, 2- and 4-byte types are 4-wide (e.g. float4) and those of 8-byte types
+// 2-wide.
+template <typename T>
+struct CwiseVectorSize {
+  static constexpr int value = sizeof(T) <= 4 ? 4 : (sizeof(T) <= 8 ? 2 : 1);
+};
+
+template <typename T, int N>
+struct alignas(sizeof(T) * N) CwiseVector {
+  T val[N];
+};
+
+// Complex types and tensors with more than kint32max elements are left to
+// Eigen.
+template <typename T>
+bool UseCwiseKernel(int64 size) {
+  return !Eigen::NumTraits<T>::IsComplex &&
+         size <= std::numeric_limits<int32>::max();
+}
+
+template <int N>
+bool IsCwiseVectorAligned(const void* ptr, int element_size) {
+  return reinterpret_cast<uintptr_t>(ptr) % (N * element_size) == 0;
+}
+
+template <int N, typename Tout, typename Tin, typename Unary>
+__global__ void CwiseUnaryKernel(int32 size, const Tin* in, Tout* out,
+                                 Unary func) {
+  const int32 num_vectors = size / N;
+  for (int32 i : CudaGridRangeX(num_vectors)) {
+    const CwiseVector<Tin, N> x =
+        reinterpret_cast<const CwiseVector<Tin, N>*>(in)[i];
+    CwiseVector<Tout, N> y;
+#pragma unroll
+    for (int j = 0; j < N; ++j) {
+      y.val[j] = func(x.val[j]);
+    }
+    reinterpret_cast<CwiseVector<Tout, N>*>(out)[i] = y;
+  }
+  for (int32 i : CudaGridRangeX(size - num_vectors * N)) {
+    const int32 k = num_vectors * N + i;
+    out[k] = func(in[k]);
+  }
+}
+
+template <int N, typename Tout, typename Tin, typename Binary>
+__global__ void CwiseBinaryKernel(int32 size, const Tin* in0, const Tin* in1,
+                                  Tout* out, Binary func) {
+  const int32 num_vectors = size / N;
+  for (int32 i : CudaGridRangeX(num_vectors)) {
+    const CwiseVector<Tin, N> x0 =
+        reinterpret_cast<const CwiseVector<Tin, N>*>(in0)[i];
+    const CwiseVector<Tin, N> x1 =
+        reinterpret_cast<const CwiseVector<Tin, N>*>(in1)[i];
+    CwiseVector<Tout, N> y;
+#pragma unroll
+    for (int j = 0; j < N; ++j) {
+      y.val[j] = func(x0.val[j], x1.val[j]);
+    }
+    reinterpret_cast<CwiseVector<Tout, N>*>(out)[i] = y;
+  }
+  for (int32 i : CudaGridRangeX(size - num_vectors * N)) {
+    const int32 k = num_vectors * N + i;
+    out[k] = func(in0[k], in1[k]);
+  }
+}
+
+// The strides of the output and of the two inputs of a broadcasting binary
+// op. The stride of an input is 0 in the dimensions it is broadcast along.
+template <int NDIMS>
+struct CwiseBCastStrides {
+  int32 out[NDIMS];
+  int32 in0[NDIMS];
+  int32 in1[NDIMS];
+};
+
+template <int NDIMS, typename Tout, typename Tin, typename Binary>
+__global__ void CwiseBCastKernel(int32 size, CwiseBCastStrides<NDIMS> strides,
+                                 const Tin* in0, const Tin* in1, Tout* out,
+                                 Binary func) {
+  for (int32 i : CudaGridRangeX(size)) {
+    int32 remaining = i;
+    int32 i0 = 0;
+    int32 i1 = 0;
+#pragma unroll
+    for (int dim = 0; dim < NDIMS - 1; ++dim) {
+      const int32 coord = remaining / strides.out[dim];
+      remaining -= coord * strides.out[dim];
+      i0 += coord * strides.in0[dim];
+      i1 += coord * strides.in1[dim];
+    }
+    i0 += remaining * strides.in0[NDIMS - 1];
+    i1 += remaining * strides.in1[NDIMS - 1];
+    out[i] = func(in0[i0], in1[i1]);
+  }
+}
+
+constexpr int kCwiseThreadsPerBlock = 256;
+
+// Returns how many blocks of 'kernel' can be resident on a multiprocessor.
+// Querying the occupancy is too expensive to do on every launch, so the
+// launchers cache the result in a static, once per kernel instantiation.
+template <typename Kernel>
+int CwiseMaxBlocksPerSM(Kernel kernel) {
+  int blocks_per_sm = 0;
+  cudaError_t err = cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+      &blocks_per_sm, kernel, kCwiseThreadsPerBlock, 0);
+  CHECK_EQ(err, cudaSuccess);
+  return std::max(blocks_per_sm, 1);
+}
+
+// Returns the launch configuration for 'num_threads' threads. Small sizes get
+// just enough blocks, and large sizes get as many blocks as can be resident
+// at once, which loop over the remaining elements.
+inline CudaLaunchConfig GetCwiseLaunchConfig(int32 num_threads,
+                                             const GPUDevice& d,
+                                             int max_blocks_per_sm) {
+  CudaLaunchConfig config;
+  config.virtual_thread_count = num_threads;
+  config.thread_per_block = kCwiseThreadsPerBlock;
+  config.block_count =
+      std::min(DivUp(num_threads, kCwiseThreadsPerBlock),
+               max_blocks_per_sm * d.getNumCudaMultiProcessors());
+  return config;
+}
+
+template <int N, typename Tout, typename Tin, typename Unary>
+void LaunchCwiseUnaryKernel(const GPUDevice& d, int32 size, const Tin* in,
+                            Tout* out, Unary func) {
+  auto kernel = CwiseUnaryKernel<N, Tout, Tin, Unary>;
+  static const int max_blocks_per_sm = CwiseMaxBlocksPerSM(kernel);
+  CudaLaunchConfig config =
+      GetCwiseLaunchConfig(DivUp(size, N), d, max_blocks_per_sm);
+  kernel<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+      size, in, out, func);
+}
+
+template <int N, typename Tout, typename Tin, typename Binary>
+void LaunchCwiseBinaryKernel(const GPUDevice& d, int32 size, const Tin* in0,
+                             const Tin* in1, Tout* out, Binary func) {
+  auto kernel = CwiseBinaryKernel<N, Tout, Tin, Binary>;
+  static const int max_blocks_per_sm = CwiseMaxBlocksPerSM(kernel);
+  CudaLaunchConfig config =
+      GetCwiseLaunchConfig(DivUp(size, N), d, max_blocks_per_sm);
+  kernel<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+      size, in0, in1, out, func);
+}
+
+// Computes out = func(in), vectorized when the buffers are aligned. Returns
+// false if the op must go through Eigen instead.
+template <typename Tout, typename Tin, typename Unary>
+bool LaunchCwiseUnary(const GPUDevice& d, int64 size, const Tin* in, Tout* out,
+                      Unary func) {
+  if (!UseCwiseKernel<Tin>(size) || !UseCwiseKernel<Tout>(size)) {
+    return false;
+  }
+  if (size == 0) {
+    return true;
+  }
+  constexpr int N = CwiseVectorSize<Tin>::value < CwiseVectorSize<Tout>::value
+                        ? CwiseVectorSize<Tin>::value
+                        : CwiseVectorSize<Tout>::value;
+  if (IsCwiseVectorAligned<N>(in, sizeof(Tin)) &&
+      IsCwiseVectorAligned<N>(out, sizeof(Tout))) {
+    LaunchCwiseUnaryKernel<N>(d, size, in, out, func);
+  } else {
+    LaunchCwiseUnaryKernel<1>(d, size, in, out, func);
+  }
+  return true;
+}
+
+// Computes out = func(in0, in1) for inputs of the same shape.
+template <typename Tout, typename Tin, typename Binary>
+bool LaunchCwiseBinary(const GPUDevice& d, int64 size, const Tin* in0,
+                       const Tin* in1, Tout* out, Binary func) {
+  if (!UseCwiseKernel<Tin>(size) || !UseCwiseKernel<Tout>(size)) {
+    return false;
+  }
+  if (size == 0) {
+    return true;
+  }
+  constexpr int N = CwiseVectorSize<Tin>::value < CwiseVectorSize<Tout>::value
+                        ? CwiseVectorSize<Tin>::value
+                        : CwiseVectorSize<Tout>::value;
+  if (IsCwiseVectorAligned<N>(in0, sizeof(Tin)) &&
+      IsCwiseVectorAligned<N>(in1, sizeof(Tin)) &&
+      IsCwiseVectorAligned<N>(out, sizeof(Tout))) {
+    LaunchCwiseBinaryKernel<N>(d, size, in0, in1, out, func);
+  } else {
+    LaunchCwiseBinaryKernel<1>(d, size, in0, in1, out, func);
+  }
+  return true;
+}
+
+// Computes out = func(in0.broadcast(bcast0), in1.broadcast(bcast1)). BCast
+// has already collapsed the contiguous dimensions that are broadcast alike,
+// so the index computation only runs over the remaining ones. Returns false
+// if an input is tiled along a dimension of size > 1, which is left to Eigen.
+template <int NDIMS, typename Tout, typename Tin, typename Binary>
+bool LaunchCwiseBCast(
+    const GPUDevice& d, typename TTypes<Tout, NDIMS>::Tensor out,
+    typename TTypes<Tin, NDIMS>::ConstTensor in0,
+    const Eigen::array<Eigen::DenseIndex, NDIMS>& bcast0,
+    typename TTypes<Tin, NDIMS>::ConstTensor in1,
+    const Eigen::array<Eigen::DenseIndex, NDIMS>& bcast1, Binary func) {
+  const int64 size = out.size();
+  if (!UseCwiseKernel<Tin>(size) || !UseCwiseKernel<Tout>(size)) {
+    return false;
+  }
+  CwiseBCastStrides<NDIMS> strides;
+  int32 out_stride = 1;
+  int32 in0_stride = 1;
+  int32 in1_stride = 1;
+  for (int dim = NDIMS - 1; dim >= 0; --dim) {
+    if ((bcast0[dim] > 1 && in0.dimension(dim) > 1) ||
+        (bcast1[dim] > 1 && in1.dimension(dim) > 1)) {
+      return false;
+    }
+    strides.out[dim] = out_stride;
+    strides.in0[dim] = in0.dimension(dim) == 1 ? 0 : in0_stride;
+    strides.in1[dim] = in1.dimension(dim) == 1 ? 0 : in1_stride;
+    out_stride *= out.dimension(dim);
+    in0_stride *= in0.dimension(dim);
+    in1_stride *= in1.dimension(dim);
+  }
+  if (size == 0) {
+    return true;
+  }
+  auto kernel = CwiseBCastKernel<NDIMS, Tout, Tin, Binary>;
+  static const int max_blocks_per_sm = CwiseMaxBlocksPerSM(kernel);
+  CudaLaunchConfig config = GetCwiseLaunchConfig(size, d, max_blocks_per_sm);
+  kernel<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+      size, strides, in0.data(), in1.data(), out.data(), func);
+  return true;
+}
+
 // Partial specialization of UnaryFunctor<Device=GPUDevice, Functor>.
 template <typename Functor>
 struct UnaryFunctor<GPUDevice, Functor> {
   void operator()(const GPUDevice& d, typename Functor::tout_type out,
                   typename Functor::tin_type in) {
+    if (LaunchCwiseUnary(d, out.size(), in.data(), out.data(),
+                         typename Functor::func())) {
+      return;
+    }
     To32Bit(out).device(d) = To32Bit(in).unaryExpr(typename Functor::func());
   }
 };
@@ -51,6 +298,10 @@ struct BinaryFunctor<GPUDevice, Functor, NDIMS, has_errors> {
   void operator()(const GPUDevice& d, typename Functor::tout_type out,
                   typename Functor::tin_type in0,
                   typename Functor::tin_type in1, bool* error) {
+    if (LaunchCwiseBinary(d, out.size(), in0.data(), in1.data(), out.data(),
+                          typename Functor::func())) {
+      return;
+    }
     To32Bit(out).device(d) =
         To32Bit(in0).binaryExpr(in1, typename Functor::func());
   }
@@ -62,6 +313,10 @@ struct BinaryFunctor<GPUDevice, Functor, NDIMS, has_errors> {
     typedef typename Functor::in_type Tin;
     typedef typename Functor::func Binary;
     typedef typename Eigen::internal::scalar_left<Tout, Tin, Binary> Unary;
+    if (LaunchCwiseUnary(d, out.size(), in.data(), out.data(),
+                         Unary(scalar.data()))) {
+      return;
+    }
     To32Bit(out).device(d) = To32Bit(in).unaryExpr(Unary(scalar.data()));
   }
 
@@ -72,6 +327,10 @@ struct BinaryFunctor<GPUDevice, Functor, NDIMS, has_errors> {
     typedef typename Functor::in_type Tin;
     typedef typename Functor::func Binary;
     typedef typename Eigen::internal::scalar_right<Tout, Tin, Binary> Unary;
+    if (LaunchCwiseUnary(d, out.size(), in.data(), out.data(),
+                         Unary(scalar.data()))) {
+      return;
+    }
     To32Bit(out).device(d) = To32Bit(in).unaryExpr(Unary(scalar.data()));
   }
 
@@ -84,6 +343,10 @@ struct BinaryFunctor<GPUDevice, Functor, NDIMS, has_errors> {
              bool* error) {
     typedef typename Functor::in_type T;
     typename Functor::func func;
+    if (LaunchCwiseBCast<NDIMS, typename Functor::out_type, T>(
+            d, out, in0, bcast0, in1, bcast1, func)) {
+      return;
+    }
     if ((NDIMS == 2) && Functor::use_bcast_optimization &&
         use_bcast_optimization<T>::value) {
       const bool bcast0_all_one = AllOne<NDIMS>(bcast0);
@@ -122,74 +122,57 @@ class BatchDatasetOp : public UnaryDatasetOpKernel {
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
-        // Each row of `batch_elements` is a tuple of tensors from the
-        // input iterator.
-        std::vector<std::vector<Tensor>> batch_elements;
+        // The first element determines the shape of the batch, and the
+        // input iterator writes the remaining elements straight into their
+        // slices of the pre-allocated batch components.
+        std::vector<Tensor> batch;
+        int64 num_batch_elements = 0;
         {
           mutex_lock l(mu_);
           if (!input_impl_) {
             *end_of_sequence = true;
             return Status::OK();
           }
-          batch_elements.reserve(dataset()->batch_size_);
-          *end_of_sequence = false;
-          for (int i = 0; i < dataset()->batch_size_ && !*end_of_sequence;
-               ++i) {
-            std::vector<Tensor> batch_element_tuple;
-            TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &batch_element_tuple,
-                                                    end_of_sequence));
-            if (!*end_of_sequence) {
-              batch_elements.emplace_back(std::move(batch_element_tuple));
-            } else {
+          std::vector<Tensor> first_element;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &first_element, end_of_sequence));
+          if (*end_of_sequence) {
+            input_impl_.reset();
+            return Status::OK();
+          }
+          batch.reserve(first_element.size());
+          for (const Tensor& component : first_element) {
+            TensorShape batch_component_shape({dataset()->batch_size_});
+            batch_component_shape.AppendShape(component.shape());
+            batch.emplace_back(ctx->allocator({}), component.dtype(),
+                               batch_component_shape);
+          }
+          TF_RETURN_IF_ERROR(
+              CopyElementToBatch(std::move(first_element), 0, &batch));
+          num_batch_elements = 1;
+          while (num_batch_elements < dataset()->batch_size_) {
+            TF_RETURN_IF_ERROR(input_impl_->GetNextIntoBatch(
+                ctx, num_batch_elements, &batch, end_of_sequence));
+            if (*end_of_sequence) {
               input_impl_.reset();
+              break;
             }
+            ++num_batch_elements;
           }
         }
 
-        if (batch_elements.empty()) {
-          DCHECK(*end_of_sequence);
-          return Status::OK();
-        }
-
-        if (dataset()->drop_remainder_ &&
-            batch_elements.size() < dataset()->batch_size_) {
-          *end_of_sequence = true;
-          return Status::OK();
-        }
-
-        // Copy the retrieved batch elements into one output tensor
-        // per tuple component.
-        // NOTE(mrry): If the input or output sizes are statically
-        // known, we could potentially read the input values in-place
-        // into their respective slice locations. This would require a
-        // different GetNext() overload that supports zero-copy, and might
-        // make sense in an optimization pass.
-        const size_t num_tuple_components = batch_elements[0].size();
-        const int64 num_batch_elements = batch_elements.size();
-        for (size_t component_index = 0; component_index < num_tuple_components;
-             ++component_index) {
-          const Tensor& first_element = batch_elements[0][component_index];
-          TensorShape batch_component_shape({num_batch_elements});
-          batch_component_shape.AppendShape(first_element.shape());
-          Tensor batch_component(ctx->allocator({}), first_element.dtype(),
-                                 batch_component_shape);
-          // Build the output tuple component by copying one slice
-          // from each input element in the batch.
-          for (size_t i = 0; i < num_batch_elements; ++i) {
-            if (batch_elements[i][component_index].shape() !=
-                first_element.shape()) {
-              return errors::InvalidArgument(
-                  "Cannot batch tensors with different shapes in component ",
-                  component_index, ". First element had shape ",
-                  first_element.shape().DebugString(), " and element ", i,
-                  " had shape ",
-                  batch_elements[i][component_index].shape().DebugString(),
-                  ".");
-            }
-            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
-                std::move(batch_elements[i][component_index]), &batch_component,
-                i));
+        if (num_batch_elements < dataset()->batch_size_) {
+          if (dataset()->drop_remainder_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          // Slicing from the start of the batch keeps the components
+          // aligned.
+          for (Tensor& batch_component : batch) {
+            batch_component = batch_component.Slice(0, num_batch_elements);
           }
+        }
+        for (Tensor& batch_component : batch) {
           out_tensors->emplace_back(std::move(batch_component));
         }
         *end_of_sequence = false;
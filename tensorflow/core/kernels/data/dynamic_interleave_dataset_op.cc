@@ -0,0 +1,411 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/captured_function.h"
+#include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/platform/cpu_info.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class DynamicInterleaveDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit DynamicInterleaveDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &interleave_func_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    OpInputList inputs;
+    OP_REQUIRES_OK(ctx, ctx->input_list("other_arguments", &inputs));
+    std::vector<Tensor> other_arguments;
+    other_arguments.reserve(inputs.size());
+    for (const Tensor& t : inputs) {
+      other_arguments.push_back(t);
+    }
+
+    int64 cycle_length = 0;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument(ctx, "cycle_length", &cycle_length));
+    if (cycle_length == model::kAutoTune) {
+      cycle_length = port::NumSchedulableCPUs();
+    }
+    OP_REQUIRES(ctx, cycle_length > 0,
+                errors::InvalidArgument("`cycle_length` must be > 0"));
+
+    int64 num_parallel_calls = 0;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
+                                            &num_parallel_calls));
+    if (num_parallel_calls == model::kAutoTune) {
+      num_parallel_calls = port::NumSchedulableCPUs();
+    }
+    OP_REQUIRES(ctx, num_parallel_calls > 0,
+                errors::InvalidArgument("`num_parallel_calls` must be > 0"));
+
+    int64 buffer_output_elements = 0;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "buffer_output_elements",
+                                            &buffer_output_elements));
+    OP_REQUIRES(
+        ctx, buffer_output_elements > 0,
+        errors::InvalidArgument("`buffer_output_elements` must be > 0"));
+
+    int64 max_backup_inputs = 0;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "max_backup_inputs",
+                                            &max_backup_inputs));
+    OP_REQUIRES(ctx, max_backup_inputs >= 0,
+                errors::InvalidArgument("`max_backup_inputs` must be >= 0"));
+
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(
+        ctx, CapturedFunction::Create(
+                 interleave_func_, std::move(other_arguments), &captured_func));
+
+    *output = new Dataset(ctx, input, interleave_func_,
+                          std::move(captured_func), cycle_length,
+                          num_parallel_calls, buffer_output_elements,
+                          max_backup_inputs, output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            const NameAttrList& func,
+            std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
+            int64 num_parallel_calls, int64 buffer_output_elements,
+            int64 max_backup_inputs, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          input_(input),
+          interleave_func_(func),
+          captured_func_(std::move(captured_func)),
+          cycle_length_(cycle_length),
+          num_parallel_calls_(num_parallel_calls),
+          buffer_output_elements_(buffer_output_elements),
+          max_backup_inputs_(max_backup_inputs),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::DynamicInterleave")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "DynamicInterleaveDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      TF_RETURN_IF_ERROR(b->AddFunction(ctx, interleave_func_.name()));
+      Node* input_node;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_node));
+      Node* cycle_length_node;
+      TF_RETURN_IF_ERROR(b->AddScalar(cycle_length_, &cycle_length_node));
+      Node* num_parallel_calls_node;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(num_parallel_calls_, &num_parallel_calls_node));
+      Node* buffer_output_elements_node;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(buffer_output_elements_, &buffer_output_elements_node));
+      Node* max_backup_inputs_node;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(max_backup_inputs_, &max_backup_inputs_node));
+      DataTypeVector other_arguments_types;
+      other_arguments_types.reserve(captured_func_->captured_inputs().size());
+      std::vector<Node*> other_arguments;
+      other_arguments.reserve(captured_func_->captured_inputs().size());
+      for (const Tensor& t : captured_func_->captured_inputs()) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        other_arguments.emplace_back(node);
+        other_arguments_types.emplace_back(t.dtype());
+      }
+      AttrValue f;
+      b->BuildAttrValue(interleave_func_, &f);
+      AttrValue other_arguments_types_attr;
+      b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {{0, input_node},
+           {2, cycle_length_node},
+           {3, num_parallel_calls_node},
+           {4, buffer_output_elements_node},
+           {5, max_backup_inputs_node}},
+          {{1, other_arguments}},
+          {{"f", f}, {"Targuments", other_arguments_types_attr}}, output));
+      return Status::OK();
+    }
+
+   private:
+    // Unlike `ParallelInterleaveDataset`, which assigns each input iterator
+    // ("input") to a worker thread and a position in the cycle, this iterator
+    // keeps a pool of open inputs that any of its `num_parallel_calls` worker
+    // threads may read from, and delivers the elements in the order in which
+    // the reads complete. An idle worker thread takes the next open input
+    // that no other thread is reading from, or opens a new input if there
+    // are fewer than `cycle_length` open inputs.
+    //
+    // An input that is slow to produce an element, e.g. because of a
+    // straggling read from a remote file system, only holds up the thread
+    // that reads from it. When the consumer waits for an element, the workers
+    // may also open up to `max_backup_inputs` inputs beyond `cycle_length`,
+    // so that the other threads have inputs to read from while the slow one
+    // catches up.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        worker_cond_var_.notify_all();
+        consumer_cond_var_.notify_all();
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        node_ = ctx->MakeModelNode(dataset()->num_parallel_calls_);
+        return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureWorkerThreadsStarted(ctx);
+        while (!cancelled_ && outputs_.empty() && !InputsExhausted()) {
+          const uint64 start_micros = ctx->env()->NowMicros();
+          ++num_waiting_consumers_;
+          // Allows the workers to open backup inputs.
+          worker_cond_var_.notify_all();
+          consumer_cond_var_.wait(l);
+          --num_waiting_consumers_;
+          node_->RecordWait((ctx->env()->NowMicros() - start_micros) * 1000);
+        }
+        if (cancelled_) {
+          return errors::Cancelled(
+              "DynamicInterleaveDatasetOp::Dataset::Iterator::GetNext");
+        }
+        if (outputs_.empty()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        Status s = outputs_.front().status;
+        outputs_.front().output.swap(*out_tensors);
+        outputs_.pop_front();
+        worker_cond_var_.notify_one();
+        *end_of_sequence = false;
+        return s;
+      }
+
+     private:
+      struct OutputElem {
+        Status status;
+        std::vector<Tensor> output;
+
+        explicit OutputElem(const Status& s) : status(s) {}
+      };
+
+      struct Input {
+        std::unique_ptr<IteratorBase> iterator;
+        // Whether a worker thread is reading from `iterator`.
+        bool busy = false;
+      };
+
+      void EnsureWorkerThreadsStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (worker_threads_.empty()) {
+          worker_threads_.reserve(dataset()->num_parallel_calls_);
+          for (int64 i = 0; i < dataset()->num_parallel_calls_; ++i) {
+            worker_threads_.emplace_back(ctx->env()->StartThread(
+                {}, "dynamic_interleave_worker",
+                std::bind(&Iterator::WorkerThread, this,
+                          new IteratorContext(*ctx), i)));
+          }
+        }
+      }
+
+      // Returns true if no more elements can be added to `outputs_`.
+      bool InputsExhausted() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return !input_impl_ && inputs_.empty() && num_opening_inputs_ == 0;
+      }
+
+      bool CanOpenInput() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!input_impl_) return false;
+        int64 max_inputs = dataset()->cycle_length_;
+        if (num_waiting_consumers_ > 0) {
+          max_inputs += dataset()->max_backup_inputs_;
+        }
+        return inputs_.size() + num_opening_inputs_ < max_inputs;
+      }
+
+      // Returns the next open input that no thread reads from, if any.
+      std::shared_ptr<Input> NextIdleInput() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        for (size_t i = 0; i < inputs_.size(); ++i) {
+          size_t index = (next_input_ + i) % inputs_.size();
+          if (!inputs_[index]->busy) {
+            next_input_ = index + 1;
+            return inputs_[index];
+          }
+        }
+        return nullptr;
+      }
+
+      void WorkerThread(IteratorContext* ctx_ptr, const int64 thread_index) {
+        std::unique_ptr<IteratorContext> ctx(ctx_ptr);
+        mutex_lock l(mu_);
+        while (true) {
+          std::shared_ptr<Input> input;
+          while (!cancelled_) {
+            if (outputs_.size() < dataset()->buffer_output_elements_) {
+              input = NextIdleInput();
+              if (input || CanOpenInput()) break;
+            }
+            worker_cond_var_.wait(l);
+          }
+          if (cancelled_) return;
+
+          if (!input) {
+            // Opens a new input.
+            std::vector<Tensor> args;
+            bool end_of_input = false;
+            Status s = input_impl_->GetNext(ctx.get(), &args, &end_of_input);
+            if (!s.ok()) {
+              outputs_.emplace_back(s);
+              consumer_cond_var_.notify_one();
+              continue;
+            }
+            if (end_of_input) {
+              input_impl_.reset();
+              // The consumer may be waiting for the end of the sequence.
+              consumer_cond_var_.notify_all();
+              continue;
+            }
+            ++num_opening_inputs_;
+            std::unique_ptr<IteratorBase> iterator;
+            mu_.unlock();
+            s = dataset::MakeIteratorFromInputElement(
+                ctx.get(), args, thread_index, dataset()->captured_func_.get(),
+                prefix(), &iterator);
+            mu_.lock();
+            --num_opening_inputs_;
+            if (s.ok()) {
+              inputs_.emplace_back(new Input);
+              inputs_.back()->iterator = std::move(iterator);
+              worker_cond_var_.notify_all();
+            } else {
+              outputs_.emplace_back(s);
+            }
+            consumer_cond_var_.notify_all();
+            continue;
+          }
+
+          // Reads an element from `input`.
+          input->busy = true;
+          OutputElem output(Status::OK());
+          bool end_of_sequence = false;
+          mu_.unlock();
+          const uint64 start_micros = ctx->env()->NowMicros();
+          output.status = input->iterator->GetNext(ctx.get(), &output.output,
+                                                   &end_of_sequence);
+          node_->RecordElement((ctx->env()->NowMicros() - start_micros) *
+                               1000);
+          mu_.lock();
+          input->busy = false;
+          if (end_of_sequence && output.status.ok()) {
+            inputs_.erase(std::find(inputs_.begin(), inputs_.end(), input));
+            worker_cond_var_.notify_all();
+            consumer_cond_var_.notify_all();
+          } else {
+            outputs_.push_back(std::move(output));
+            worker_cond_var_.notify_one();
+            consumer_cond_var_.notify_one();
+          }
+        }
+      }
+
+      mutex mu_;
+      // The consumer waits on this condition variable for an element or the
+      // end of the sequence.
+      condition_variable consumer_cond_var_;
+      // The worker threads wait on this condition variable for an input to
+      // read from, or for space in `outputs_`.
+      condition_variable worker_cond_var_;
+      std::shared_ptr<model::Node> node_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      // The open inputs, in the order in which they were opened.
+      std::vector<std::shared_ptr<Input>> inputs_ GUARDED_BY(mu_);
+      size_t next_input_ GUARDED_BY(mu_) = 0;
+      // The number of inputs that worker threads are currently opening.
+      int64 num_opening_inputs_ GUARDED_BY(mu_) = 0;
+      int64 num_waiting_consumers_ GUARDED_BY(mu_) = 0;
+      // The elements that were read, in the order in which they were read.
+      std::deque<OutputElem> outputs_ GUARDED_BY(mu_);
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      std::vector<std::unique_ptr<Thread>> worker_threads_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const NameAttrList interleave_func_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+    const int64 cycle_length_;
+    const int64 num_parallel_calls_;
+    const int64 buffer_output_elements_;
+    const int64 max_backup_inputs_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  NameAttrList interleave_func_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DynamicInterleaveDataset").Device(DEVICE_CPU),
+                        DynamicInterleaveDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
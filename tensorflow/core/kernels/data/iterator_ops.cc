@@ -15,11 +15,16 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/dataset_scheduler.h"
 #include "tensorflow/core/framework/iterator.pb.h"
+#include "tensorflow/core/framework/iterator_stats.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_op_kernel.h"
 #include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/graph/graph_constructor.h"
@@ -31,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -94,8 +100,15 @@ class IteratorResource : public ResourceBase {
         pflr_(std::move(pflr)),
         lib_(lib),
         iterator_(nullptr),
+        model_(std::make_shared<model::Model>(port::NumSchedulableCPUs())),
+        pipeline_stats_(std::make_shared<PipelineStats>()),
         output_dtypes_(output_dtypes),
-        output_shapes_(output_shapes) {}
+        output_shapes_(output_shapes) {
+    if (DatasetScheduler::SharedByDefault()) {
+      scheduler_runner_ =
+          DatasetScheduler::Global()->NewClient("iterator", 0)->runner();
+    }
+  }
 
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) {
@@ -104,6 +117,11 @@ class IteratorResource : public ResourceBase {
       if (lib_ != nullptr) {
         ctx->set_lib(lib_);
       }
+      ctx->set_model(model_);
+      ctx->set_pipeline_stats(pipeline_stats_);
+      if (scheduler_runner_) {
+        *ctx->runner() = scheduler_runner_;
+      }
       return captured_iterator->GetNext(ctx, out_tensors, end_of_sequence);
     } else {
       return errors::FailedPrecondition(
@@ -159,6 +177,8 @@ class IteratorResource : public ResourceBase {
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(outputs[0], &dataset));
 
     IteratorContext iter_ctx = dataset::MakeIteratorContext(ctx);
+    iter_ctx.set_model(model_);
+    iter_ctx.set_pipeline_stats(pipeline_stats_);
     std::unique_ptr<IteratorBase> iterator;
     TF_RETURN_IF_ERROR(dataset->MakeIterator(&iter_ctx, "Iterator", &iterator));
     TF_RETURN_IF_ERROR(set_iterator(std::move(iterator)));
@@ -173,6 +193,8 @@ class IteratorResource : public ResourceBase {
       params.allocator_getter = [device](AllocatorAttributes attrs) {
         return device->GetAllocator(attrs);
       };
+      params.model = model_;
+      params.pipeline_stats = pipeline_stats_;
       IteratorContext iter_ctx(std::move(params));
 
       TF_RETURN_IF_ERROR(captured_iterator->Restore(&iter_ctx, reader));
@@ -215,6 +237,52 @@ class IteratorResource : public ResourceBase {
     return output_shapes_;
   }
 
+  // The model that tunes the iterators of the pipeline of this iterator.
+  const std::shared_ptr<model::Model>& model() const { return model_; }
+
+  // The statistics of the iterators of the pipeline of this iterator.
+  const std::shared_ptr<PipelineStats>& pipeline_stats() const {
+    return pipeline_stats_;
+  }
+
+  // If the step of `ctx` is traced, adds the statistics of every iterator of
+  // the pipeline to its `StepStats`, as a node named after the prefix of the
+  // iterator on the "<device>/iterator_stats" device. The statistics are
+  // totals since the iterator was initialized.
+  void MaybeSaveStepStats(OpKernelContext* ctx) {
+    StepStatsCollector* collector = ctx->stats_collector();
+    if (collector == nullptr) return;
+    const string device =
+        strings::StrCat(ctx->device()->name(), "/iterator_stats");
+    const int64 now_micros = ctx->env()->NowMicros();
+    pipeline_stats_->ForEachIterator([&](const IteratorStats& stats) {
+      NodeExecStats* node_stats = new NodeExecStats;
+      node_stats->set_node_name(stats.prefix());
+      node_stats->set_all_start_micros(now_micros);
+      node_stats->set_timeline_label(strings::StrCat(
+          stats.prefix(), " = elements: ", stats.num_elements(),
+          ", calls: ", stats.num_calls(), ", bytes: ", stats.bytes_produced(),
+          ", processing: ", stats.processing_time() / 1000,
+          "us, input: ", stats.input_time() / 1000, "us"));
+      DatasetIteratorStats* iterator_stats =
+          node_stats->mutable_dataset_iterator_stats();
+      iterator_stats->set_num_calls(stats.num_calls());
+      iterator_stats->set_num_elements(stats.num_elements());
+      iterator_stats->set_bytes_produced(stats.bytes_produced());
+      iterator_stats->set_processing_micros(stats.processing_time() / 1000);
+      iterator_stats->set_input_micros(stats.input_time() / 1000);
+      if (stats.num_buffer_samples() > 0) {
+        iterator_stats->set_buffer_capacity(stats.buffer_capacity());
+        iterator_stats->set_mean_buffer_size(
+            static_cast<double>(stats.buffer_size_sum()) /
+            stats.num_buffer_samples());
+      }
+      iterator_stats->set_num_waits(stats.num_waits());
+      iterator_stats->set_wait_micros(stats.wait_time() / 1000);
+      collector->Save(device, node_stats);
+    });
+  }
+
  private:
   // The following (device_mgr_, flib_def_, pflr_) are only used when the
   // IteratorResource is shared between sessions and in that case we create
@@ -224,6 +292,11 @@ class IteratorResource : public ResourceBase {
   std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
   FunctionLibraryRuntime* lib_ = nullptr;  // not owned.
   std::shared_ptr<IteratorBase> iterator_;
+  const std::shared_ptr<model::Model> model_;
+  const std::shared_ptr<PipelineStats> pipeline_stats_;
+  // If set, schedules the work of the pipeline on the shared scheduler
+  // instead of the inter-op thread pool of the calling session.
+  std::function<void(std::function<void()>)> scheduler_runner_;
   mutex mu_;
   std::shared_ptr<const FunctionLibraryDefinition> lib_def_ GUARDED_BY(mu_);
   const DataTypeVector output_dtypes_;
@@ -655,6 +728,8 @@ class MakeIteratorOp : public OpKernel {
     core::ScopedUnref unref(iterator_resource);
 
     IteratorContext iter_ctx = dataset::MakeIteratorContext(ctx);
+    iter_ctx.set_model(iterator_resource->model());
+    iter_ctx.set_pipeline_stats(iterator_resource->pipeline_stats());
     std::unique_ptr<IteratorBase> iterator;
     OP_REQUIRES_OK(ctx,
                    dataset->MakeIterator(&iter_ctx, "Iterator", &iterator));
@@ -870,6 +945,8 @@ class OneShotIteratorOp : public AsyncOpKernel {
     DatasetBase* dataset;
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(return_values[0], &dataset));
     IteratorContext iter_ctx = dataset::MakeIteratorContext(ctx);
+    iter_ctx.set_model((*iterator)->model());
+    iter_ctx.set_pipeline_stats((*iterator)->pipeline_stats());
     std::unique_ptr<IteratorBase> iter;
     TF_RETURN_IF_ERROR(dataset->MakeIterator(&iter_ctx, "Iterator", &iter));
     TF_RETURN_IF_ERROR((*iterator)->set_iterator(std::move(iter)));
@@ -947,6 +1024,7 @@ class IteratorGetNextOp : public AsyncOpKernel {
 
           Status s =
               iterator->GetNext(&iter_ctx, &components, &end_of_sequence);
+          iterator->MaybeSaveStepStats(ctx);
           // NOTE(mrry): We must unref the iterator before calling `done()`, to
           // avoid destruction races.
           iterator->Unref();
@@ -993,8 +1071,9 @@ class IteratorGetNextSyncOp : public OpKernel {
     };
     IteratorContext iter_ctx(std::move(params));
 
-    OP_REQUIRES_OK(ctx,
-                   iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
+    Status s = iterator->GetNext(&iter_ctx, &components, &end_of_sequence);
+    iterator->MaybeSaveStepStats(ctx);
+    OP_REQUIRES_OK(ctx, s);
     OP_REQUIRES(ctx, !end_of_sequence, errors::OutOfRange("End of sequence"));
 
     for (int i = 0; i < components.size(); ++i) {
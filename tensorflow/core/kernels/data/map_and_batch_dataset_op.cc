@@ -17,6 +17,7 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
@@ -69,15 +70,21 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         int64 num_parallel_batches;
         OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_batches",
                                                 &num_parallel_batches));
-        num_parallel_calls = num_parallel_batches * batch_size;
-        OP_REQUIRES(ctx, num_parallel_batches > 0,
+        OP_REQUIRES(ctx,
+                    num_parallel_batches > 0 ||
+                        num_parallel_batches == model::kAutoTune,
                     errors::InvalidArgument(
                         "num_parallel_batches must be greater than zero."));
+        num_parallel_calls = num_parallel_batches == model::kAutoTune
+                                 ? model::kAutoTune
+                                 : num_parallel_batches * batch_size;
         break;
       case 2:
         OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                                 &num_parallel_calls));
-        OP_REQUIRES(ctx, num_parallel_calls > 0,
+        OP_REQUIRES(ctx,
+                    num_parallel_calls > 0 ||
+                        num_parallel_calls == model::kAutoTune,
                     errors::InvalidArgument(
                         "num_parallel_calls must be greater than zero."));
         break;
@@ -203,6 +210,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        node_ = ctx->MakeModelNode(dataset()->num_parallel_calls_);
         return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
       }
 
@@ -213,9 +221,23 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         {
           mutex_lock l(mu_);
           EnsureRunnerThreadStarted(ctx);
-          while (batch_results_.empty() ||
-                 batch_results_.front()->num_calls > 0) {
-            cond_var_.wait(l);
+          if (stats()) {
+            // The batches that are complete out of the batches in flight.
+            int64 num_ready = 0;
+            for (const auto& batch_result : batch_results_) {
+              if (batch_result->num_calls == 0) ++num_ready;
+            }
+            stats()->RecordBuffer(num_ready, MaxBatchResults());
+          }
+          if (batch_results_.empty() || batch_results_.front()->num_calls > 0) {
+            const uint64 start_micros = ctx->env()->NowMicros();
+            while (batch_results_.empty() ||
+                   batch_results_.front()->num_calls > 0) {
+              cond_var_.wait(l);
+            }
+            const uint64 wait_micros = ctx->env()->NowMicros() - start_micros;
+            node_->RecordWait(wait_micros * 1000);
+            if (stats()) stats()->RecordWait(wait_micros);
           }
           std::swap(result, batch_results_.front());
           batch_results_.pop_front();
@@ -357,9 +379,13 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                                    std::vector<Tensor> input_element) {
               std::shared_ptr<std::vector<Tensor>> return_values(
                   new std::vector<Tensor>());
+              const uint64 start_micros = ctx->env()->NowMicros();
               dataset()->captured_func_->RunAsync(
                   ctx.get(), std::move(input_element), return_values.get(),
-                  [this, ctx, result, return_values, offset](Status status) {
+                  [this, ctx, result, return_values, offset,
+                   start_micros](Status status) {
+                    node_->RecordElement(
+                        (ctx->env()->NowMicros() - start_micros) * 1000);
                     Callback(ctx, result, return_values, offset, status);
                   });
             },
@@ -421,7 +447,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       }
 
       int MaxBatchResults() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-        return (dataset()->num_parallel_calls_ + dataset()->batch_size_ - 1) /
+        return (node_->parallelism() + dataset()->batch_size_ - 1) /
                dataset()->batch_size_;
       }
 
@@ -472,7 +498,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         mutex_lock l(mu_);
         while (true) {
           while (!cancelled_ &&
-                 (num_calls_ >= dataset()->num_parallel_calls_ ||
+                 (num_calls_ >= node_->parallelism() ||
                   batch_results_.size() > MaxBatchResults() ||
                   (batch_results_.size() == MaxBatchResults() &&
                    call_counter_ % dataset()->batch_size_ == 0))) {
@@ -483,7 +509,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
             return;
           }
 
-          while (num_calls_ < dataset()->num_parallel_calls_ &&
+          while (num_calls_ < node_->parallelism() &&
                  (batch_results_.size() < MaxBatchResults() ||
                   (batch_results_.size() == MaxBatchResults() &&
                    call_counter_ % dataset()->batch_size_ != 0))) {
@@ -627,6 +653,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       // user specified level of parallelism and there are slots available in
       // the `batch_results_` buffer.
       condition_variable cond_var_;
+      // Reports to the model of the pipeline, and holds the level of
+      // parallelism it picked if `num_parallel_calls` is `kAutoTune`.
+      std::shared_ptr<model::Node> node_;
       // Counts the number of outstanding calls for this batch.
       int64 num_calls_ GUARDED_BY(mu_) = 0;
       // Counts the total number of calls.
@@ -15,6 +15,7 @@ limitations under the License.
 #include <deque>
 
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 
@@ -54,6 +56,12 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
     int64 cycle_length = 0;
     OP_REQUIRES_OK(ctx,
                    ParseScalarArgument(ctx, "cycle_length", &cycle_length));
+    // The cycle length determines the order of the output, so it is not
+    // changed while iterating. Instead, the model of the pipeline accounts
+    // for the worker threads of the iterator as a fixed share of its budget.
+    if (cycle_length == model::kAutoTune) {
+      cycle_length = port::NumSchedulableCPUs();
+    }
     OP_REQUIRES(ctx, cycle_length > 0,
                 errors::InvalidArgument("`cycle_length` must be > 0"));
 
@@ -249,6 +257,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        node_ = ctx->MakeModelNode(dataset()->num_threads());
         return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
       }
 
@@ -341,11 +350,13 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
 
           if (must_wait_for_input) {
             // Wait for elements to become available.
+            const uint64 start_micros = ctx->env()->NowMicros();
             if (dataset()->sloppy_) {
               sloppy_cond_var_.wait(l);
             } else {
               workers_[interleave_indices_[next_index_]].cond_var.wait(l);
             }
+            node_->RecordWait((ctx->env()->NowMicros() - start_micros) * 1000);
           }
         }
         return errors::Cancelled(
@@ -1008,6 +1019,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       // `ckpt_mu_` in either shared or exclusive modes.
       mutex ckpt_mu_;
 
+      // Reports the waits of the consumer to the model of the pipeline.
+      std::shared_ptr<model::Node> node_;
+
       // The iterator producing elements which are converted to datasets by
       // the dataset()->captured_func_ then interleaved together.
       // input_impl_ is reset when we have exhausted its input.
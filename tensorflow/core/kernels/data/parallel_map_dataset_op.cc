@@ -15,12 +15,14 @@ limitations under the License.
 #include <deque>
 
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 
@@ -53,7 +55,9 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     int32 num_parallel_calls;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                             &num_parallel_calls));
-    OP_REQUIRES(ctx, num_parallel_calls > 0,
+    OP_REQUIRES(ctx,
+                num_parallel_calls > 0 ||
+                    num_parallel_calls == model::kAutoTune,
                 errors::InvalidArgument(
                     "num_parallel_calls must be greater than zero."));
 
@@ -152,7 +156,10 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
      public:
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
-            invocation_results_(params.dataset->num_parallel_calls_) {}
+            invocation_results_(
+                params.dataset->num_parallel_calls_ == model::kAutoTune
+                    ? port::NumSchedulableCPUs()
+                    : params.dataset->num_parallel_calls_) {}
 
       ~Iterator() override {
         // TODO(mrry): Replace this cancellation logic with a
@@ -162,7 +169,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         // potentially-blocking iterators, when we add these.
         {
           mutex_lock l(mu_);
-          for (size_t i = 0; i < dataset()->num_parallel_calls_; ++i) {
+          for (size_t i = 0; i < invocation_results_.size(); ++i) {
             if (invocation_results_[i].notification) {
               invocation_results_[i].notification->WaitForNotification();
             }
@@ -171,6 +178,10 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        // `invocation_results_` holds the results of up to the maximum
+        // parallelism of the node.
+        node_ = ctx->MakeModelNode(dataset()->num_parallel_calls_,
+                                   invocation_results_.size());
         return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
       }
 
@@ -179,10 +190,11 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
 
-        // Ensure that there are `dataset()->num_parallel_calls_`
-        // invocations of `func_` outstanding at once.
-        while (input_impl_ && (num_inputs_consumed_ - num_outputs_consumed_ <
-                               dataset()->num_parallel_calls_)) {
+        // Ensure that there are `node_->parallelism()` invocations of
+        // `func_` outstanding at once.
+        const int64 parallelism = node_->parallelism();
+        while (input_impl_ &&
+               (num_inputs_consumed_ - num_outputs_consumed_ < parallelism)) {
           InvokeFunctionLocked(ctx);
         }
 
@@ -191,14 +203,34 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           return Status::OK();
         }
 
+        if (stats()) {
+          // The results that are ready out of the outstanding invocations.
+          int64 num_ready = 0;
+          for (int64 i = num_outputs_consumed_; i < num_inputs_consumed_; ++i) {
+            const InvocationResult& outstanding =
+                invocation_results_[i % invocation_results_.size()];
+            if (!outstanding.notification ||
+                outstanding.notification->HasBeenNotified()) {
+              ++num_ready;
+            }
+          }
+          stats()->RecordBuffer(num_ready, parallelism);
+        }
+
         // Read the next result out of `invocation_results_`, which
         // acts as a circular buffer.
         const size_t result_index =
-            num_outputs_consumed_ % dataset()->num_parallel_calls_;
+            num_outputs_consumed_ % invocation_results_.size();
         InvocationResult* result = &invocation_results_[result_index];
         *end_of_sequence = false;
         if (result->notification) {
-          result->notification->WaitForNotification();
+          if (!result->notification->HasBeenNotified()) {
+            const uint64 start_micros = ctx->env()->NowMicros();
+            result->notification->WaitForNotification();
+            const uint64 wait_micros = ctx->env()->NowMicros() - start_micros;
+            node_->RecordWait(wait_micros * 1000);
+            if (stats()) stats()->RecordWait(wait_micros);
+          }
           if (result->status.ok()) {
             std::swap(*out_tensors, result->return_values);
           }
@@ -228,7 +260,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         TF_RETURN_IF_ERROR(writer->WriteScalar(
             full_name("num_outputs_consumed"), num_outputs_consumed_));
 
-        for (size_t i = 0; i < dataset()->num_parallel_calls_; i++) {
+        for (size_t i = 0; i < invocation_results_.size(); i++) {
           if (invocation_results_[i].notification) {
             invocation_results_[i].notification->WaitForNotification();
             TF_RETURN_IF_ERROR(
@@ -265,7 +297,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                                               &num_inputs_consumed_));
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("num_outputs_consumed"),
                                               &num_outputs_consumed_));
-        for (size_t i = 0; i < dataset()->num_parallel_calls_; i++) {
+        for (size_t i = 0; i < invocation_results_.size(); i++) {
           InvocationResult* result = &invocation_results_[i];
           *result = InvocationResult();
           if (!reader->Contains(full_name(
@@ -312,12 +344,12 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         DCHECK(input_impl_);
         DCHECK(num_inputs_consumed_ - num_outputs_consumed_ <
-               dataset()->num_parallel_calls_);
+               invocation_results_.size());
 
         // The result of invoking the function will be written into the next
         // slot in `invocation_results_`, which acts as a circular buffer.
         const size_t result_index =
-            num_inputs_consumed_ % dataset()->num_parallel_calls_;
+            num_inputs_consumed_ % invocation_results_.size();
         InvocationResult* result = &invocation_results_[result_index];
         *result = InvocationResult();
 
@@ -338,9 +370,13 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           // `result->return_values`, and notify `result->notification`
           // to unblock a consumer.
           result->notification.reset(new Notification);
+          model::Node* node = node_.get();
+          Env* env = ctx->env();
+          const uint64 start_micros = env->NowMicros();
           dataset()->captured_func_->RunAsync(
               ctx, std::move(input_element), &result->return_values,
-              [result, result_index](Status ret_status) {
+              [result, node, env, start_micros](Status ret_status) {
+                node->RecordElement((env->NowMicros() - start_micros) * 1000);
                 result->status.Update(ret_status);
                 result->notification->Notify();
               });
@@ -387,6 +423,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       }
 
       mutex mu_;
+      std::shared_ptr<model::Node> node_;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
       std::vector<InvocationResult> invocation_results_ GUARDED_BY(mu_);
       int64 num_inputs_consumed_ GUARDED_BY(mu_) = 0;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <deque>
 
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
@@ -106,6 +107,8 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        // The prefetch thread occupies one core.
+        node_ = ctx->MakeModelNode(1);
         return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
       }
 
@@ -115,12 +118,23 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
         {
           mutex_lock l(mu_);
           TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
+          if (stats()) {
+            stats()->RecordBuffer(buffer_.size(), auto_tuner_.buffer_limit());
+          }
           // Wait until the next element in the buffer has been
           // produced, or we are shutting down.
+          const uint64 start_micros = ctx->env()->NowMicros();
+          bool waited = false;
           while (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_ &&
                  auto_tuner_.buffer_limit() != 0) {
             auto_tuner_.RecordEmpty();
             cond_var_.wait(l);
+            waited = true;
+          }
+          if (waited) {
+            const uint64 wait_micros = ctx->env()->NowMicros() - start_micros;
+            node_->RecordWait(wait_micros * 1000);
+            if (stats()) stats()->RecordWait(wait_micros);
           }
 
           if (cancelled_) {
@@ -343,6 +357,8 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
       mutex parent_mu_ ACQUIRED_BEFORE(mu_);
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(parent_mu_);
       condition_variable cond_var_;
+      // Reports the waits of the consumer to the model of the pipeline.
+      std::shared_ptr<model::Node> node_;
       PrefetchAutotuner auto_tuner_ GUARDED_BY(mu_);
       std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
       std::unique_ptr<Thread> prefetch_thread_ GUARDED_BY(mu_);
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/lib/io/column_file.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -687,6 +688,287 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 REGISTER_KERNEL_BUILDER(Name("TFRecordDataset").Device(DEVICE_CPU),
                         TFRecordDatasetOp);
 
+// Serves the single allocation of a tensor that aliases a chunk of a mapped
+// column file, and keeps the file mapped until the tensor is freed.
+class ColumnChunkAllocator : public Allocator {
+ public:
+  ColumnChunkAllocator(std::shared_ptr<const io::ColumnFileReader> reader,
+                       StringPiece chunk)
+      : reader_(std::move(reader)), chunk_(chunk) {}
+
+  string Name() override { return "ColumnChunkAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    CHECK_EQ(num_bytes, chunk_.size());
+    CHECK_EQ(reinterpret_cast<uintptr_t>(chunk_.data()) % alignment, 0);
+    return const_cast<char*>(chunk_.data());
+  }
+
+  // The allocator is owned by the tensor buffer from the allocation on.
+  void DeallocateRaw(void* ptr) override { delete this; }
+
+ private:
+  const std::shared_ptr<const io::ColumnFileReader> reader_;
+  const StringPiece chunk_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnChunkAllocator);
+};
+
+class ColumnFileDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ColumnFileDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    for (const DataType& dt : output_types_) {
+      OP_REQUIRES(ctx, dt == DT_INT64 || dt == DT_FLOAT || dt == DT_STRING,
+                  errors::InvalidArgument(
+                      "Each element of `output_types_` must be one of: "
+                      "DT_INT64, DT_FLOAT, DT_STRING"));
+    }
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    const Tensor* columns_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("columns", &columns_tensor));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(columns_tensor->shape()),
+                errors::InvalidArgument("`columns` must be a vector."));
+    OP_REQUIRES(ctx, columns_tensor->NumElements() == output_types_.size(),
+                errors::InvalidArgument(
+                    "`columns` must have one name per output, got ",
+                    columns_tensor->NumElements(), " names for ",
+                    output_types_.size(), " outputs."));
+    std::vector<string> columns;
+    columns.reserve(columns_tensor->NumElements());
+    for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+      columns.push_back(columns_tensor->flat<string>()(i));
+    }
+
+    *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                          output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            std::vector<string> columns, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          filenames_(std::move(filenames)),
+          columns_(std::move(columns)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::ColumnFile")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ColumnFileDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* columns = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {filenames, columns}, output));
+      return Status::OK();
+    }
+
+   private:
+    // Each element is a row group of the files: one vector per requested
+    // column, read without decoding the other columns. The int64 and float
+    // columns of mapped files alias the mapping.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          if (reader_) {
+            if (next_row_group_ < reader_->row_groups().size()) {
+              TF_RETURN_IF_ERROR(ReadRowGroupLocked(ctx, out_tensors));
+              ++next_row_group_;
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+            reader_.reset();
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          TF_RETURN_IF_ERROR(SetupReaderLocked(ctx->env()));
+        } while (true);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+        if (reader_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name("next_row_group"), static_cast<int64>(next_row_group_)));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        reader_.reset();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = size_t(current_file_index);
+        if (reader->Contains(full_name("next_row_group"))) {
+          int64 next_row_group;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("next_row_group"),
+                                                &next_row_group));
+          TF_RETURN_IF_ERROR(SetupReaderLocked(ctx->env()));
+          next_row_group_ = size_t(next_row_group);
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Opens the file at `current_file_index_` and finds the requested
+      // columns in it.
+      Status SetupReaderLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (current_file_index_ >= dataset()->filenames_.size()) {
+          return errors::InvalidArgument(
+              "current_file_index_:", current_file_index_,
+              " >= filenames_.size():", dataset()->filenames_.size());
+        }
+        const string& filename = dataset()->filenames_[current_file_index_];
+        std::unique_ptr<io::ColumnFileReader> reader;
+        TF_RETURN_IF_ERROR(io::ColumnFileReader::Open(env, filename, &reader));
+        column_indices_.clear();
+        for (size_t i = 0; i < dataset()->columns_.size(); ++i) {
+          const string& name = dataset()->columns_[i];
+          const int index = reader->ColumnIndex(name);
+          if (index < 0) {
+            return errors::InvalidArgument("Column file ", filename,
+                                           " has no column ", name);
+          }
+          io::ColumnType type;
+          switch (dataset()->output_types_[i]) {
+            case DT_INT64:
+              type = io::ColumnType::kInt64;
+              break;
+            case DT_FLOAT:
+              type = io::ColumnType::kFloat;
+              break;
+            default:
+              type = io::ColumnType::kString;
+              break;
+          }
+          if (reader->schema()[index].type != type) {
+            return errors::InvalidArgument(
+                "Column ", name, " of ", filename, " does not hold ",
+                DataTypeString(dataset()->output_types_[i]), " values");
+          }
+          column_indices_.push_back(index);
+        }
+        reader_ = std::move(reader);
+        next_row_group_ = 0;
+        return Status::OK();
+      }
+
+      Status ReadRowGroupLocked(IteratorContext* ctx,
+                                std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_rows = reader_->row_groups()[next_row_group_].num_rows;
+        string scratch;
+        for (size_t i = 0; i < column_indices_.size(); ++i) {
+          const DataType dtype = dataset()->output_types_[i];
+          if (dtype == DT_STRING) {
+            std::vector<StringPiece> values;
+            TF_RETURN_IF_ERROR(reader_->ReadStringColumn(
+                next_row_group_, column_indices_[i], &scratch, &values));
+            Tensor tensor(ctx->allocator({}), DT_STRING, {num_rows});
+            auto flat = tensor.flat<string>();
+            for (int64 j = 0; j < num_rows; ++j) {
+              flat(j).assign(values[j].data(), values[j].size());
+            }
+            out_tensors->push_back(std::move(tensor));
+            continue;
+          }
+          StringPiece values;
+          TF_RETURN_IF_ERROR(reader_->ReadFixedColumn(
+              next_row_group_, column_indices_[i], &scratch, &values));
+          if (reader_->mapped() && num_rows > 0 &&
+              reinterpret_cast<uintptr_t>(values.data()) %
+                      Allocator::kAllocatorAlignment ==
+                  0) {
+            out_tensors->emplace_back(new ColumnChunkAllocator(reader_, values),
+                                      dtype, TensorShape({num_rows}));
+          } else {
+            Tensor tensor(ctx->allocator({}), dtype, {num_rows});
+            memcpy(const_cast<char*>(tensor.tensor_data().data()),
+                   values.data(), values.size());
+            out_tensors->push_back(std::move(tensor));
+          }
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      // Shared with the tensors that alias the mapped file.
+      std::shared_ptr<const io::ColumnFileReader> reader_ GUARDED_BY(mu_);
+      // The index in the file of each requested column.
+      std::vector<int> column_indices_ GUARDED_BY(mu_);
+      size_t next_row_group_ GUARDED_BY(mu_) = 0;
+    };
+
+    const std::vector<string> filenames_;
+    const std::vector<string> columns_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ColumnFileDataset").Device(DEVICE_CPU),
+                        ColumnFileDatasetOp);
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -82,6 +82,10 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
+        if (this->stats()) {
+          this->stats()->RecordBuffer(num_elements_,
+                                      this->dataset()->buffer_size_);
+        }
         int64 start_micros = ctx->env()->NowMicros();
         int64 num_log_entries = 0;
         bool first_call = false;
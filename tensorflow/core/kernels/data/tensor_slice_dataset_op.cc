@@ -132,6 +132,34 @@ class TensorSliceDatasetOp : public DatasetOpKernel {
         return Status::OK();
       }
 
+      Status GetNextIntoBatchInternal(IteratorContext* ctx, int64 index,
+                                      std::vector<Tensor>* batch,
+                                      bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (i_ >= n_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        if (batch->size() != dataset()->tensors_.size()) {
+          return errors::InvalidArgument(
+              "Cannot batch an element with ", dataset()->tensors_.size(),
+              " components into ", batch->size(), " components.");
+        }
+        // Copies the slices straight from the components, instead of
+        // materializing them as elements first.
+        for (int i = 0; i < dataset()->tensors_.size(); ++i) {
+          const Tensor& t = dataset()->tensors_[i];
+          TF_RETURN_IF_ERROR(CheckBatchComponent(
+              (*batch)[i], i, index, t.dtype(),
+              TensorShape(dataset()->shapes_[i].dim_sizes())));
+          TF_RETURN_IF_ERROR(
+              batch_util::CopySliceToSlice(t, i_, &(*batch)[i], index));
+        }
+        ++i_;
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
      protected:
       Status SaveInternal(IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
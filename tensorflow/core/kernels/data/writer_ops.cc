@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/column_file.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/file_system.h"
 
@@ -102,5 +103,116 @@ class ToTFRecordOp : public AsyncOpKernel {
 REGISTER_KERNEL_BUILDER(Name("DatasetToTFRecord").Device(DEVICE_CPU),
                         ToTFRecordOp);
 
+class ToColumnFileOp : public AsyncOpKernel {
+ public:
+  explicit ToColumnFileOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        thread_pool_(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(),
+            strings::StrCat("to_column_file_op_", SanitizeThreadSuffix(name())),
+            1 /* num_threads */, false /* low_latency_hint */)) {}
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an
+    // inter-op thread pool thread, so we issue the call from the
+    // owned thread pool.
+    thread_pool_->Schedule([this, ctx, done]() {
+      OP_REQUIRES_OK_ASYNC(ctx, Write(ctx), done);
+      done();
+    });
+  }
+
+ private:
+  Status Write(OpKernelContext* ctx) {
+    const Tensor* filename_t;
+    TF_RETURN_IF_ERROR(ctx->input("filename", &filename_t));
+    if (!TensorShapeUtils::IsScalar(filename_t->shape())) {
+      return errors::InvalidArgument("filename must be a scalar");
+    }
+    const Tensor* columns_t;
+    TF_RETURN_IF_ERROR(ctx->input("columns", &columns_t));
+    if (!TensorShapeUtils::IsVector(columns_t->shape())) {
+      return errors::InvalidArgument("columns must be a vector");
+    }
+
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+    const DataTypeVector& dtypes = dataset->output_dtypes();
+    if (columns_t->NumElements() != dtypes.size()) {
+      return errors::InvalidArgument(
+          "columns must name each of the ", dtypes.size(),
+          " components of the dataset, got ", columns_t->NumElements());
+    }
+    std::vector<io::ColumnSchema> schema(dtypes.size());
+    for (size_t i = 0; i < dtypes.size(); ++i) {
+      schema[i].name = columns_t->vec<string>()(i);
+      switch (dtypes[i]) {
+        case DT_INT64:
+          schema[i].type = io::ColumnType::kInt64;
+          break;
+        case DT_FLOAT:
+          schema[i].type = io::ColumnType::kFloat;
+          break;
+        case DT_STRING:
+          schema[i].type = io::ColumnType::kString;
+          break;
+        default:
+          return errors::InvalidArgument(
+              "Column files hold int64, float and string columns, got ",
+              DataTypeString(dtypes[i]), " for ", schema[i].name);
+      }
+    }
+
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(
+        ctx->env()->NewWritableFile(filename_t->scalar<string>()(), &file));
+    io::ColumnFileWriter writer(file.get(), std::move(schema));
+
+    IteratorContext iter_ctx = dataset::MakeIteratorContext(ctx);
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(
+        dataset->MakeIterator(&iter_ctx, "ToColumnFileOpIterator", &iterator));
+
+    // Each element of the dataset is a row group, with one vector per column.
+    std::vector<Tensor> components;
+    components.reserve(dtypes.size());
+    std::vector<io::ColumnValues> columns(dtypes.size());
+    bool end_of_sequence;
+    do {
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
+      if (!end_of_sequence) {
+        const int64 num_rows = components[0].NumElements();
+        for (size_t i = 0; i < components.size(); ++i) {
+          const Tensor& component = components[i];
+          if (!TensorShapeUtils::IsVector(component.shape()) ||
+              component.NumElements() != num_rows) {
+            return errors::InvalidArgument(
+                "Each element must hold vectors of the same length, got "
+                "shapes ",
+                components[0].shape().DebugString(), " and ",
+                component.shape().DebugString());
+          }
+          if (component.dtype() == DT_STRING) {
+            columns[i].strings = gtl::ArraySlice<string>(
+                component.flat<string>().data(), num_rows);
+          } else {
+            columns[i].fixed = component.tensor_data();
+          }
+        }
+        TF_RETURN_IF_ERROR(writer.AppendRowGroup(num_rows, columns));
+      }
+      components.clear();
+    } while (!end_of_sequence);
+    TF_RETURN_IF_ERROR(writer.Close());
+    return file->Close();
+  }
+
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DatasetToColumnFile").Device(DEVICE_CPU),
+                        ToColumnFileOp);
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,344 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Compute the interpolation indices only once.
+struct CachedInterpolation {
+  int64 lower;  // Lower source index used in the interpolation
+  int64 upper;  // Upper source index used in the interpolation
+  float lerp;   // 1-D linear interpolation weight of 'upper'
+};
+
+// Computes the source positions of 'out_size' output pixels, the i-th of
+// which is at 'offset' + i * 'scale' in a source of 'in_size' pixels.
+void ComputeInterpolationWeights(int64 out_size, int64 in_size, double offset,
+                                 double scale,
+                                 CachedInterpolation* interpolation) {
+  for (int64 i = 0; i < out_size; ++i) {
+    const double in = std::max(offset + i * scale, 0.0);
+    interpolation[i].lower = std::min(static_cast<int64>(in), in_size - 1);
+    interpolation[i].upper = std::min(interpolation[i].lower + 1, in_size - 1);
+    interpolation[i].lerp = static_cast<float>(in - interpolation[i].lower);
+  }
+}
+
+// The part of a JPEG image to decode to produce a crop window at a given
+// size.
+struct DecodeWindow {
+  // The libjpeg DCT scaling denominator: 1, 2, 4 or 8.
+  int ratio;
+  // The window [y, x, height, width] in the image scaled down by 'ratio'.
+  int y;
+  int x;
+  int height;
+  int width;
+};
+
+// Returns the window to decode to resize the crop window [crop_y, crop_x,
+// crop_height, crop_width] of an image to 'out_height' x 'out_width'. The
+// image is decoded at the smallest DCT scaling that keeps the crop window at
+// least as large as the output, so that resizing still only downsamples and
+// the inverse DCT skips most of the work for large images.
+DecodeWindow ComputeDecodeWindow(int image_height, int image_width, int crop_y,
+                                 int crop_x, int crop_height, int crop_width,
+                                 int out_height, int out_width) {
+  DecodeWindow window;
+  window.ratio = 1;
+  for (int ratio : {8, 4, 2}) {
+    if (crop_height >= static_cast<int64>(ratio) * out_height &&
+        crop_width >= static_cast<int64>(ratio) * out_width) {
+      window.ratio = ratio;
+      break;
+    }
+  }
+  // libjpeg rounds the scaled image size up.
+  const int r = window.ratio;
+  const int scaled_height = (image_height + r - 1) / r;
+  const int scaled_width = (image_width + r - 1) / r;
+  window.y = crop_y / r;
+  window.x = crop_x / r;
+  window.height =
+      std::min((crop_y + crop_height + r - 1) / r, scaled_height) - window.y;
+  window.width =
+      std::min((crop_x + crop_width + r - 1) / r, scaled_width) - window.x;
+  return window;
+}
+
+// Bilinearly resizes the crop window [crop_y, crop_x, crop_height,
+// crop_width] of the original image to 'out_height' x 'out_width', given the
+// 'window' of the image decoded in 'decoded'. Matches ResizeBilinear with
+// align_corners=false when the window was decoded at full resolution.
+//
+// Each output row is computed in two passes: the two source rows are
+// interpolated into a float row first, which is a contiguous loop that the
+// compiler vectorizes, and the columns are interpolated from that row next.
+void ResizeWindow(const uint8* decoded, const DecodeWindow& window,
+                  int channels, int crop_y, int crop_x, int crop_height,
+                  int crop_width, int out_height, int out_width,
+                  float* output) {
+  const int r = window.ratio;
+  // A source pixel i of the scaled image covers the original pixels
+  // [i * r, (i + 1) * r), so that the center of original pixel p is at
+  // (p + 0.5) / r - 0.5 in the scaled image.
+  const float height_scale = crop_height / static_cast<float>(out_height);
+  const float width_scale = crop_width / static_cast<float>(out_width);
+  std::vector<CachedInterpolation> ys(out_height);
+  std::vector<CachedInterpolation> xs(out_width);
+  ComputeInterpolationWeights(
+      out_height, window.height,
+      (crop_y - window.y * r + 0.5) / r - 0.5,
+      static_cast<double>(height_scale) / r, ys.data());
+  ComputeInterpolationWeights(out_width, window.width,
+                              (crop_x - window.x * r + 0.5) / r - 0.5,
+                              static_cast<double>(width_scale) / r, xs.data());
+  for (auto& x : xs) {
+    x.lower *= channels;
+    x.upper *= channels;
+  }
+
+  const int64 in_row_size = static_cast<int64>(window.width) * channels;
+  const int64 out_row_size = static_cast<int64>(out_width) * channels;
+  std::vector<float> row(in_row_size);
+  for (int y = 0; y < out_height; ++y) {
+    const uint8* top = decoded + ys[y].lower * in_row_size;
+    const uint8* bottom = decoded + ys[y].upper * in_row_size;
+    const float y_lerp = ys[y].lerp;
+    for (int64 i = 0; i < in_row_size; ++i) {
+      const float top_value = top[i];
+      row[i] = top_value + (bottom[i] - top_value) * y_lerp;
+    }
+    float* output_row = output + y * out_row_size;
+    for (int x = 0; x < out_width; ++x) {
+      const float* left = row.data() + xs[x].lower;
+      const float* right = row.data() + xs[x].upper;
+      const float x_lerp = xs[x].lerp;
+      for (int c = 0; c < channels; ++c) {
+        output_row[c] = left[c] + (right[c] - left[c]) * x_lerp;
+      }
+      output_row += channels;
+    }
+  }
+}
+
+// Decodes and resizes JPEG images, one per element of 'contents', to a fixed
+// size. A vector of contents is decoded into a batch of images in parallel.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument(
+                    "channels must be 0, 1, or 3 for JPEG, got ", channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("fancy_upscaling", &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+
+    // The TensorFlow-chosen default for jpeg decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    const Tensor& crop_window = context->input(1);
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, contents.dims() <= 1,
+                errors::InvalidArgument(
+                    "contents must be a scalar or a vector, got shape ",
+                    contents.shape().DebugString()));
+    const bool batched = contents.dims() == 1;
+    const int64 batch_size = batched ? contents.dim_size(0) : 1;
+    OP_REQUIRES(
+        context,
+        crop_window.dims() == contents.dims() + 1 &&
+            crop_window.dim_size(crop_window.dims() - 1) == 4 &&
+            (!batched || crop_window.dim_size(0) == batch_size),
+        errors::InvalidArgument("crop_window must have shape ",
+                                batched ? strings::StrCat("[", batch_size,
+                                                          ", 4]")
+                                        : "[4]",
+                                ", got ", crop_window.shape().DebugString()));
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument("size must have two elements, got ",
+                                        size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    auto contents_flat = contents.flat<string>();
+    auto crop_windows = crop_window.flat_inner_dims<int32>();
+    if (!batched) {
+      // The number of channels may only be known once the image is decoded.
+      std::unique_ptr<uint8[]> decoded;
+      DecodeWindow window;
+      int channels;
+      OP_REQUIRES_OK(context, Decode(contents_flat(0), &crop_windows(0, 0),
+                                     out_height, out_width, &decoded, &window,
+                                     &channels));
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(
+          context, context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+      ResizeWindow(decoded.get(), window, channels, crop_windows(0, 0),
+                   crop_windows(0, 1), crop_windows(0, 2), crop_windows(0, 3),
+                   out_height, out_width, output->flat<float>().data());
+      return;
+    }
+
+    OP_REQUIRES(context, channels_ != 0,
+                errors::InvalidArgument(
+                    "channels must be 1 or 3 to decode a batch of images"));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    channels_}),
+                       &output));
+    const int64 image_size =
+        static_cast<int64>(out_height) * out_width * channels_;
+    float* output_data = output->flat<float>().data();
+    std::vector<Status> statuses(batch_size);
+    auto work = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        std::unique_ptr<uint8[]> decoded;
+        DecodeWindow window;
+        int channels;
+        statuses[i] = Decode(contents_flat(i), &crop_windows(i, 0), out_height,
+                             out_width, &decoded, &window, &channels);
+        if (statuses[i].ok()) {
+          DCHECK_EQ(channels_, channels);
+          ResizeWindow(decoded.get(), window, channels, crop_windows(i, 0),
+                       crop_windows(i, 1), crop_windows(i, 2),
+                       crop_windows(i, 3), out_height, out_width,
+                       output_data + i * image_size);
+        }
+      }
+    };
+    // Decoding dominates the cost, and is much more expensive than resizing.
+    const int64 kCostPerImage = 1000 * image_size;
+    context->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        batch_size, kCostPerImage, work);
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  // Decodes the part of 'input' needed to resize the crop window
+  // [y, x, height, width] in 'crop_window' to 'out_height' x 'out_width'
+  // into 'decoded', and stores which part it is in 'window'.
+  Status Decode(StringPiece input, const int32* crop_window, int out_height,
+                int out_width, std::unique_ptr<uint8[]>* decoded,
+                DecodeWindow* window, int* channels) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int image_height;
+    int image_width;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                            &image_height, nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, data size ",
+                                     input.size());
+    }
+    const int crop_y = crop_window[0];
+    const int crop_x = crop_window[1];
+    const int crop_height = crop_window[2];
+    const int crop_width = crop_window[3];
+    if (crop_y < 0 || crop_x < 0 || crop_height <= 0 || crop_width <= 0 ||
+        crop_height > image_height - crop_y ||
+        crop_width > image_width - crop_x) {
+      return errors::InvalidArgument(
+          "Invalid JPEG data or crop window, crop window [", crop_y, ", ",
+          crop_x, ", ", crop_height, ", ", crop_width, "] for a ",
+          image_height, "x", image_width, " image");
+    }
+    *window = ComputeDecodeWindow(image_height, image_width, crop_y, crop_x,
+                                  crop_height, crop_width, out_height,
+                                  out_width);
+
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = window->ratio;
+    flags.crop = true;
+    flags.crop_y = window->y;
+    flags.crop_x = window->x;
+    flags.crop_height = window->height;
+    flags.crop_width = window->width;
+    uint8* data = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [decoded, channels](int width, int height,
+                            int components) -> uint8* {
+          *channels = components;
+          decoded->reset(new uint8[static_cast<int64>(width) * height *
+                                   components]);
+          return decoded->get();
+        });
+    if (data == nullptr) {
+      return errors::InvalidArgument(
+          "Invalid JPEG data or crop window, data size ", input.size());
+    }
+    return Status::OK();
+  }
+
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -101,6 +101,13 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols);
 
+// Returns true if DeepConv2D supports the convolution and CPU convolution
+// autotuning is enabled by the TF_CPU_CONV_AUTOTUNE environment variable. The
+// caller then times DeepConv2D against its default implementation, instead of
+// relying on the cost model of CanUseDeepConv2D.
+bool CanAutoTuneDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
+                           int filter_cols);
+
 namespace functor {
 
 // Calls DeepConv2D implementation (see deep_conv2d.cc for details).
@@ -26,15 +26,23 @@ limitations under the License.
 //    - move the results to partition_count. This handles missing values
 //      (corresponding to empty parts).
 // 4. Because partition_count is on the GPU, we bring it asynchronously to
-//    the CPU. Then we can allocate the output tensors.
-// 5. Finally, we use indices_out and the gather functor to collect the output.
-//    This works, because for each interval of i-values, indices_out points
-//    to the slices which should form output[i].
+//    the CPU.
+// 5. Without waiting for partition_count, we use indices_out and the gather
+//    functor to collect the slices of data sorted by partition into a single
+//    buffer. For each interval of i-values, indices_out points to the slices
+//    which should form output[i].
+// 6. Once partition_count reaches the CPU, output[i] is set to the interval
+//    of the sorted buffer that holds the i-values. Only the intervals that
+//    don't start at an aligned address are copied to tensors of their own.
+//    This way the gather runs while the CPU waits for partition_count, and
+//    the GPU has work queued while the output shapes are being determined.
 
 #if GOOGLE_CUDA
 
 #define EIGEN_USE_GPU
 
+#include <atomic>
+
 #include "external/cub_archive/cub/device/device_radix_sort.cuh"
 #include "external/cub_archive/cub/device/device_reduce.cuh"
 #include "external/cub_archive/cub/iterator/constant_input_iterator.cuh"
@@ -177,7 +185,8 @@ class BoundedOutputIterator
 }  // namespace
 
 // The current implementation has memory cost on GPU
-// I + P + max(3N + R + P, O + N), where:
+// I + P + max(3N + R + P, O + N), plus the copies of the unaligned outputs,
+// where:
 // I - the size of the input
 // N - the size of the partitions tensor
 // R - the temporary storage used by cub::RadixSort, about 2N
@@ -276,47 +285,58 @@ class DynamicPartitionOpGPU : public AsyncOpKernel {
     auto* stream = c->op_device_context()->stream();
     OP_REQUIRES_ASYNC(c, stream, errors::Internal("No GPU stream available."),
                       done);
-    Tensor cpu_tensor;
+    // The slices of data, sorted by partition. The outputs are intervals of
+    // this tensor.
+    TensorShape sorted_shape;
+    sorted_shape.AddDim(partitions.NumElements());
+    for (int i = partitions.dims(); i < data.dims(); i++) {
+      sorted_shape.AddDim(data.dim_size(i));
+    }
+    PendingOutputs* pending = new PendingOutputs;
     AllocatorAttributes alloc_attr;
     alloc_attr.set_on_host(true);
     alloc_attr.set_gpu_compatible(true);
-    OP_REQUIRES_OK_ASYNC(
-        c,
-        c->allocate_temp(partition_count.dtype(), partition_count.shape(),
-                         &cpu_tensor, alloc_attr),
-        done);
-    se::DeviceMemoryBase wrapped(partition_count.flat<int32>().data(),
-                                 num_partitions_ * sizeof(int32));
-    const bool status =
-        stream
-            ->ThenMemcpy(cpu_tensor.flat<int32>().data(), wrapped,
-                         num_partitions_ * sizeof(int32))
-            .ok();
-    OP_REQUIRES_ASYNC(
-        c, status,
-        errors::Internal("Failed to launch copy from device to host."), done);
-
-    // Keep a reference to partition_count so that the buffer
-    // is not deallocated at the end of the function, before
-    // memcpy is completed.
-    TensorReference partition_ref(partition_count);
-    auto wrapped_callback = [this, c, &data, &partitions, indices_out,
-                             partition_ref, cpu_tensor, done]() {
-      OpOutputList outputs;
-      this->AllocateOutputs(c, &data, &partitions, &cpu_tensor, &outputs, done);
-      if (!c->status().ok()) {
-        partition_ref.Unref();
-        return;
+    Status s = c->allocate_temp(partition_count.dtype(),
+                                partition_count.shape(),
+                                &pending->cpu_partition_count, alloc_attr);
+    if (s.ok()) {
+      s = c->allocate_temp(DataTypeToEnum<T>::value, sorted_shape,
+                           &pending->sorted_data);
+    }
+    if (!s.ok()) {
+      delete pending;
+      c->SetStatus(s);
+      done();
+      return;
+    }
+
+    // The copy waits for the kernels enqueued so far on the compute stream,
+    // but not for the gather below. Whichever of the copy and this function
+    // finishes last sets the outputs: the CPU waits for partition_count while
+    // the GPU gathers, and the outputs are only produced once the gather has
+    // been enqueued.
+    auto finish = [this, c, stream, pending, done]() {
+      if (pending->num_pending.fetch_sub(1) != 1) return;
+      if (c->status().ok()) {
+        c->SetStatus(this->SetOutputs(c, stream, pending->sorted_data,
+                                      pending->cpu_partition_count));
       }
-      int32 N = partitions.NumElements();
-      int64 slice_size = data.NumElements() / N;
-      this->GatherSlices(c, &data, &indices_out, N, slice_size, outputs);
-      partition_ref.Unref();
+      delete pending;
       done();
     };
-
-    c->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
-        stream, wrapped_callback);
+    c->op_device_context()->CopyDeviceTensorToCPU(
+        &partition_count, "DynamicPartition", c->device(),
+        &pending->cpu_partition_count,
+        [c, finish](const Status& copy_status) {
+          c->SetStatus(copy_status);
+          finish();
+        });
+
+    const int32 N = partitions.NumElements();
+    const int64 slice_size = data.NumElements() / N;
+    this->GatherSorted(c, &data, &indices_out, N, slice_size,
+                       &pending->sorted_data);
+    finish();
   }
 
  protected:
@@ -434,24 +454,64 @@ class DynamicPartitionOpGPU : public AsyncOpKernel {
   }  // At this point indices_in, partitions_out, aggregates_out
      // and cub_temp_storage will be marked for deallocation.
 
-  void GatherSlices(OpKernelContext* c, const Tensor* data,
+  void GatherSorted(OpKernelContext* c, const Tensor* data,
                     const Tensor* indices, int32 N, int64 slice_size,
-                    OpOutputList& outs) {
+                    Tensor* sorted_data) {
     const GPUDevice& device = c->eigen_device<GPUDevice>();
-    const int32* ind_base = indices->flat<int32>().data();
-    const T* data_base = data->flat<T>().data();
+    const int64 out_size = sorted_data->NumElements();
+    if (out_size > 0) {
+      CallGatherKernel<T>(device, data->flat<T>().data(),
+                          indices->flat<int32>().data(),
+                          sorted_data->flat<T>().data(), N, N, slice_size,
+                          out_size);
+    }
+  }
 
+  // Sets outputs[p] to the interval of sorted_data that holds partition p.
+  // Intervals that are not aligned as tensors are copied to new
+  // tensors.
+  Status SetOutputs(OpKernelContext* c, se::Stream* stream,
+                    const Tensor& sorted_data, const Tensor& partition_count) {
+    auto e_part_count = partition_count.flat<int32>();
+    OpOutputList outputs;
+    TF_RETURN_IF_ERROR(c->output_list("outputs", &outputs));
+    int64 start = 0;
     for (int p = 0; p < num_partitions_; p++) {
-      int32 indices_size = outs[p]->dim_size(0);
-      int64 out_size = outs[p]->NumElements();
-      T* out_base = outs[p]->flat<T>().data();
-      if (out_size > 0)
-        CallGatherKernel<T>(device, data_base, ind_base, out_base, N,
-                            indices_size, slice_size, out_size);
-      ind_base += indices_size;
+      const int64 limit = start + e_part_count(p);
+      if (limit > sorted_data.dim_size(0)) {
+        return errors::Internal(
+            "Partition counts exceed the number of elements.");
+      }
+      Tensor slice = sorted_data.Slice(start, limit);
+      if (slice.IsAligned()) {
+        outputs.set(p, slice);
+      } else {
+        Tensor* out;
+        TF_RETURN_IF_ERROR(outputs.allocate(p, slice.shape(), &out));
+        const uint64 bytes = slice.TotalBytes();
+        if (bytes > 0) {
+          se::DeviceMemoryBase src(
+              const_cast<char*>(slice.tensor_data().data()), bytes);
+          se::DeviceMemoryBase dst(
+              const_cast<char*>(out->tensor_data().data()), bytes);
+          if (!stream->ThenMemcpy(&dst, src, bytes).ok()) {
+            return errors::Internal("Failed to launch copy of partition ", p);
+          }
+        }
+      }
+      start = limit;
     }
+    return Status::OK();
   }
 
+  // The state shared by ComputeAsync and the callback of the copy of the
+  // partition counts to the CPU.
+  struct PendingOutputs {
+    Tensor cpu_partition_count;
+    Tensor sorted_data;
+    std::atomic<int> num_pending{2};
+  };
+
   int32 num_partitions_;
 };
 
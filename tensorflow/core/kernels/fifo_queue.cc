@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/fifo_queue.h"
 #include "tensorflow/core/kernels/queue_base.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -33,6 +34,27 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+auto* fifo_queue_ops = monitoring::Counter<2>::New(
+    "/tensorflow/core/fifo_queue_ops",
+    "The number of single element FIFOQueue operations, by whether they had "
+    "to wait for the queue or for other operations.",
+    "op", "waited");
+
+// The cells of fifo_queue_ops.  A high ratio of waiting operations means that
+// the queue is contended, or that its producers and consumers are unbalanced.
+monitoring::CounterCell* enqueues_without_wait =
+    fifo_queue_ops->GetCell("enqueue", "false");
+monitoring::CounterCell* enqueues_with_wait =
+    fifo_queue_ops->GetCell("enqueue", "true");
+monitoring::CounterCell* dequeues_without_wait =
+    fifo_queue_ops->GetCell("dequeue", "false");
+monitoring::CounterCell* dequeues_with_wait =
+    fifo_queue_ops->GetCell("dequeue", "true");
+
+}  // namespace
+
 FIFOQueue::FIFOQueue(int capacity, const DataTypeVector& component_dtypes,
                      const std::vector<TensorShape>& component_shapes,
                      const string& name)
@@ -49,6 +71,30 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
 
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  // Fast path: if no attempt is waiting ahead of this one and there is room,
+  // the enqueue completes right away, without registering for cancellation
+  // and queuing an attempt.
+  bool enqueued = false;
+  bool wake_dequeues = false;
+  {
+    mutex_lock l(mu_);
+    if (!closed_ && enqueue_attempts_.empty() &&
+        queues_[0].size() < static_cast<size_t>(capacity_)) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(PersistentTensor(tuple[i]));
+      }
+      enqueued = true;
+      wake_dequeues = !dequeue_attempts_.empty();
+    }
+  }
+  if (enqueued) {
+    enqueues_without_wait->IncrementBy(1);
+    if (wake_dequeues) FlushUnlocked();
+    callback();
+    return;
+  }
+  enqueues_with_wait->IncrementBy(1);
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -91,6 +137,15 @@ Status FIFOQueue::GetElementComponentFromBatch(const FIFOQueue::Tuple& tuple,
                                                PersistentTensor* out_tensor) {
   TensorShape element_shape(tuple[component].shape());
   element_shape.RemoveDim(0);
+  // Aligned slices are aliased rather than copied, as in UnpackOp.  The batch
+  // then stays alive until all of its elements have been dequeued.
+  Tensor element;
+  if (element.CopyFrom(tuple[component].Slice(index, index + 1),
+                       element_shape) &&
+      element.IsAligned()) {
+    *out_tensor = PersistentTensor(element);
+    return Status::OK();
+  }
   Tensor* element_access = nullptr;
   TF_RETURN_IF_ERROR(ctx->allocate_persistent(
       tuple[component].dtype(), element_shape, out_tensor, &element_access));
@@ -153,6 +208,26 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  // Fast path, as in TryEnqueue.
+  bool dequeued = false;
+  bool wake_enqueues = false;
+  Tuple tuple;
+  {
+    mutex_lock l(mu_);
+    if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+      DequeueLocked(ctx, &tuple);
+      dequeued = true;
+      wake_enqueues = !enqueue_attempts_.empty();
+    }
+  }
+  if (dequeued) {
+    dequeues_without_wait->IncrementBy(1);
+    if (wake_enqueues) FlushUnlocked();
+    callback(tuple);
+    return;
+  }
+  dequeues_with_wait->IncrementBy(1);
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -307,7 +382,7 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
             }
 
             RunResult result = kNoProgress;
-            for (; queue_size > 0; --queue_size) {
+            while (queue_size > 0) {
               if (attempt->tuple.empty()) {
                 // Only allocate tuple when we have something to dequeue
                 // so we don't use excessive memory when there are many
@@ -324,19 +399,28 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                 }
               }
               result = kProgress;
-              Tuple tuple;
-              DequeueLocked(attempt->context, &tuple);
+              // Copies all the elements that are available at once, straight
+              // from queues_, rather than going through a Tuple per element.
+              const int64 num_elements =
+                  std::min<int64>(queue_size, attempt->elements_requested);
               const int64 index =
                   attempt->tuple[0].dim_size(0) - attempt->elements_requested;
               for (int i = 0; i < num_components(); ++i) {
-                attempt->context->SetStatus(batch_util::CopyElementToSlice(
-                    std::move(tuple[i]), &attempt->tuple[i], index));
-                if (!attempt->context->status().ok()) return kComplete;
+                for (int64 j = 0; j < num_elements; ++j) {
+                  attempt->context->SetStatus(batch_util::CopyElementToSlice(
+                      *queues_[i][j].AccessTensor(attempt->context),
+                      &attempt->tuple[i], index + j));
+                  if (!attempt->context->status().ok()) return kComplete;
+                }
               }
-              tuple.clear();
-              --attempt->elements_requested;
+              for (int i = 0; i < num_components(); ++i) {
+                queues_[i].erase(queues_[i].begin(),
+                                 queues_[i].begin() + num_elements);
+              }
+              queue_size -= num_elements;
+              attempt->elements_requested -= num_elements;
               if (attempt->elements_requested == 0) {
-                tuple = attempt->tuple;
+                Tuple tuple = attempt->tuple;
                 attempt->done_callback = [callback, tuple]() {
                   callback(tuple);
                 };
@@ -0,0 +1,245 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The number of queries and keys whose scores are computed at once. A block
+// of scores, and the queries, keys and values it is computed from, stay in
+// cache for depths of a few hundred.
+constexpr int64 kQueryBlock = 32;
+constexpr int64 kKeyBlock = 128;
+
+}  // namespace
+
+// Computes the attention of blocks of queries over blocks of keys, with the
+// online softmax: every block of scores is exponentiated relative to the
+// running maximum of its rows, and the sums and outputs accumulated so far
+// are rescaled whenever that maximum grows. Only one block of scores per
+// thread is ever held in memory.
+template <typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  explicit FusedAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_masks", &num_masks_));
+    OP_REQUIRES(context, num_masks_ <= 1,
+                errors::InvalidArgument("_FusedAttention takes at most one "
+                                        "mask, got ",
+                                        num_masks_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const int dims = query.dims();
+    OP_REQUIRES(context,
+                dims >= 2 && key.dims() == dims && value.dims() == dims,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank of at "
+                    "least 2: ",
+                    query.shape().DebugString(), " ",
+                    key.shape().DebugString(), " ",
+                    value.shape().DebugString()));
+    int64 batch = 1;
+    for (int i = 0; i < dims - 2; ++i) {
+      OP_REQUIRES(context,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions: ",
+                      query.shape().DebugString(), " ",
+                      key.shape().DebugString(), " ",
+                      value.shape().DebugString()));
+      batch *= query.dim_size(i);
+    }
+    const int64 num_queries = query.dim_size(dims - 2);
+    const int64 depth = query.dim_size(dims - 1);
+    const int64 num_keys = key.dim_size(dims - 2);
+    const int64 value_depth = value.dim_size(dims - 1);
+    OP_REQUIRES(context,
+                key.dim_size(dims - 1) == depth &&
+                    value.dim_size(dims - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key must have the depth of query, and value as many "
+                    "rows as key: ",
+                    query.shape().DebugString(), " ",
+                    key.shape().DebugString(), " ",
+                    value.shape().DebugString()));
+
+    // The offset of the mask of each batch, and its strides along the
+    // queries and keys, which are 0 for broadcast dimensions.
+    const T* mask = nullptr;
+    std::vector<int64> mask_offsets(batch, 0);
+    int64 mask_query_stride = 0;
+    int64 mask_key_stride = 0;
+    if (num_masks_ > 0) {
+      const Tensor& mask_tensor = context->input(3);
+      OP_REQUIRES(context, mask_tensor.dims() <= dims,
+                  errors::InvalidArgument(
+                      "mask has a higher rank than the scores: ",
+                      mask_tensor.shape().DebugString()));
+      const int padding = dims - mask_tensor.dims();
+      std::vector<int64> strides(dims, 0);
+      int64 stride = 1;
+      for (int i = dims - 1; i >= 0; --i) {
+        const int64 size = i < padding ? 1 : mask_tensor.dim_size(i - padding);
+        const int64 scores_size = i == dims - 1
+                                      ? num_keys
+                                      : i == dims - 2 ? num_queries
+                                                      : query.dim_size(i);
+        OP_REQUIRES(context, size == 1 || size == scores_size,
+                    errors::InvalidArgument(
+                        "mask of shape ", mask_tensor.shape().DebugString(),
+                        " does not broadcast to the scores"));
+        if (size != 1) strides[i] = stride;
+        stride *= size;
+      }
+      mask_query_stride = strides[dims - 2];
+      mask_key_stride = strides[dims - 1];
+      for (int64 b = 0; b < batch; ++b) {
+        int64 rest = b;
+        for (int i = dims - 3; i >= 0; --i) {
+          mask_offsets[b] += (rest % query.dim_size(i)) * strides[i];
+          rest /= query.dim_size(i);
+        }
+      }
+      mask = mask_tensor.flat<T>().data();
+    }
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(dims - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (num_keys == 0) {
+      // Nothing to attend to: the weighted sums are empty.
+      output->flat<T>().setZero();
+      return;
+    }
+
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        Matrix;
+    typedef Eigen::Map<const Matrix> ConstMatrixMap;
+    typedef Eigen::Map<Matrix> MatrixMap;
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const T scale = static_cast<T>(scale_);
+    const int64 num_query_blocks =
+        (num_queries + kQueryBlock - 1) / kQueryBlock;
+
+    auto attend = [&](int64 start, int64 limit) {
+      Matrix scores(kQueryBlock, kKeyBlock);
+      Matrix sums(kQueryBlock, value_depth);
+      std::vector<T> row_max(kQueryBlock);
+      std::vector<T> row_sum(kQueryBlock);
+      for (int64 w = start; w < limit; ++w) {
+        const int64 b = w / num_query_blocks;
+        const int64 q0 = (w % num_query_blocks) * kQueryBlock;
+        const int64 nq = std::min(kQueryBlock, num_queries - q0);
+        ConstMatrixMap q(query_data + (b * num_queries + q0) * depth, nq,
+                         depth);
+        std::fill(row_max.begin(), row_max.end(),
+                  -std::numeric_limits<T>::infinity());
+        std::fill(row_sum.begin(), row_sum.end(), static_cast<T>(0));
+        sums.topRows(nq).setZero();
+        for (int64 k0 = 0; k0 < num_keys; k0 += kKeyBlock) {
+          const int64 nk = std::min(kKeyBlock, num_keys - k0);
+          ConstMatrixMap k(key_data + (b * num_keys + k0) * depth, nk, depth);
+          ConstMatrixMap v(value_data + (b * num_keys + k0) * value_depth, nk,
+                           value_depth);
+          auto s = scores.topLeftCorner(nq, nk);
+          s.noalias() = q * k.transpose();
+          s *= scale;
+          if (mask != nullptr) {
+            for (int64 i = 0; i < nq; ++i) {
+              const T* m = mask + mask_offsets[b] +
+                           (q0 + i) * mask_query_stride + k0 * mask_key_stride;
+              for (int64 j = 0; j < nk; ++j) {
+                s(i, j) += m[j * mask_key_stride];
+              }
+            }
+          }
+          for (int64 i = 0; i < nq; ++i) {
+            const T new_max = std::max(row_max[i], s.row(i).maxCoeff());
+            if (new_max == -std::numeric_limits<T>::infinity()) {
+              // Every key so far is masked out.
+              s.row(i).setZero();
+              continue;
+            }
+            const T correction = std::exp(row_max[i] - new_max);
+            s.row(i) = (s.row(i).array() - new_max).exp().matrix();
+            row_sum[i] = row_sum[i] * correction + s.row(i).sum();
+            sums.row(i) *= correction;
+            row_max[i] = new_max;
+          }
+          sums.topRows(nq).noalias() += s * v;
+        }
+        MatrixMap out(output_data + (b * num_queries + q0) * value_depth, nq,
+                      value_depth);
+        for (int64 i = 0; i < nq; ++i) {
+          // As with Softmax, rows whose keys are all masked out are NaN.
+          out.row(i) = sums.row(i) / row_sum[i];
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch * num_query_blocks,
+          kQueryBlock * num_keys * (depth + value_depth) * 2, attend);
+  }
+
+ private:
+  float scale_;
+  int num_masks_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedAttentionOp);
+};
+
+#define REGISTER_KERNEL(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedAttention").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedAttentionOp<T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,139 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedAttentionOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_masks, float scale) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedAttention")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(num_masks, DT_FLOAT))
+                           .Attr("scale", scale)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedAttentionOpTest, SingleQuery) {
+  TF_ASSERT_OK(MakeOp(0, 0.5f));
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 0, 0, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {10, 20});
+  TF_ASSERT_OK(RunOpKernel());
+  // The scores are 1 and 2.
+  const float weight = 1 / (1 + std::exp(1.0f));
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 1}));
+  test::FillValues<float>(&expected, {10 * weight + 20 * (1 - weight)});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedAttentionOpTest, BroadcastMaskOverSeveralBlocks) {
+  // The queries and keys span several blocks, the last ones partial, and the
+  // mask is broadcast over the heads and queries.
+  const int kBatch = 2, kHeads = 3, kQueries = 40, kKeys = 300, kDepth = 4;
+  const float kScale = 0.25f;
+  TF_ASSERT_OK(MakeOp(1, kScale));
+  auto query = [](int i) -> float { return std::sin(i * 0.37f); };
+  auto key = [](int i) -> float { return std::cos(i * 0.11f); };
+  auto value = [](int i) -> float { return (i % 17) * 0.1f; };
+  // Masks out the first 200 keys of the first batch entirely, and a few keys
+  // of the second one with a large negative value.
+  auto mask = [](int i) -> float {
+    const int b = i / kKeys, k = i % kKeys;
+    if (b == 0) return k < 200 ? -INFINITY : 0;
+    return k % 7 == 0 ? -1e9f : 0;
+  };
+  AddInput<float>(TensorShape({kBatch, kHeads, kQueries, kDepth}), query);
+  AddInput<float>(TensorShape({kBatch, kHeads, kKeys, kDepth}), key);
+  AddInput<float>(TensorShape({kBatch, kHeads, kKeys, kDepth}), value);
+  AddInput<float>(TensorShape({kBatch, 1, 1, kKeys}), mask);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected_values;
+  for (int b = 0; b < kBatch; ++b) {
+    for (int h = 0; h < kHeads; ++h) {
+      const int bh = b * kHeads + h;
+      for (int q = 0; q < kQueries; ++q) {
+        std::vector<double> weights(kKeys);
+        double max_score = -INFINITY;
+        for (int k = 0; k < kKeys; ++k) {
+          double score = 0;
+          for (int d = 0; d < kDepth; ++d) {
+            score += query((bh * kQueries + q) * kDepth + d) *
+                     key((bh * kKeys + k) * kDepth + d);
+          }
+          weights[k] = score * kScale + mask(b * kKeys + k);
+          max_score = std::max(max_score, weights[k]);
+        }
+        double sum = 0;
+        for (double& weight : weights) {
+          weight = std::exp(weight - max_score);
+          sum += weight;
+        }
+        for (int d = 0; d < kDepth; ++d) {
+          double output = 0;
+          for (int k = 0; k < kKeys; ++k) {
+            output += weights[k] / sum * value((bh * kKeys + k) * kDepth + d);
+          }
+          expected_values.push_back(output);
+        }
+      }
+    }
+  }
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({kBatch, kHeads, kQueries, kDepth}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedAttentionOpTest, NoKeys) {
+  TF_ASSERT_OK(MakeOp(0, 1.0f));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({0, 1}), {});
+  AddInputFromArray<float>(TensorShape({0, 3}), {});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {0, 0, 0, 0, 0, 0});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedAttentionOpTest, MaskNotBroadcastingToScores) {
+  TF_ASSERT_OK(MakeOp(1, 1.0f));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3, 1}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({3, 1}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Adds the bias and applies GELU to every row of the input in a single pass.
+template <typename T>
+class FusedBiasGeluOp : public OpKernel {
+ public:
+  explicit FusedBiasGeluOp(OpKernelConstruction* context) : OpKernel(context) {
+    int num_biases;
+    OP_REQUIRES_OK(context, context->GetAttr("num_biases", &num_biases));
+    OP_REQUIRES(context, num_biases <= 1,
+                errors::InvalidArgument("_FusedBiasGelu takes at most one "
+                                        "bias, got ",
+                                        num_biases));
+    has_bias_ = num_biases == 1;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    OP_REQUIRES(context, input.dims() >= 1,
+                errors::InvalidArgument(
+                    "input must have a rank of at least 1: ",
+                    input.shape().DebugString()));
+    const int64 depth = input.dim_size(input.dims() - 1);
+    const T* bias_data = nullptr;
+    if (has_bias_) {
+      const Tensor& bias = context->input(1);
+      OP_REQUIRES(context, bias.dims() == 1 && bias.dim_size(0) == depth,
+                  errors::InvalidArgument(
+                      "bias must be a vector of the size of the last "
+                      "dimension of input: ",
+                      input.shape().DebugString(), " ",
+                      bias.shape().DebugString()));
+      bias_data = bias.flat<T>().data();
+    }
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+    if (input.NumElements() == 0) return;
+
+    typedef Eigen::Array<T, 1, Eigen::Dynamic> Row;
+    typedef Eigen::Map<const Row> ConstRowMap;
+    typedef Eigen::Map<Row> RowMap;
+    const T* input_data = input.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const T kSqrt2OverPi = static_cast<T>(0.7978845608028654);
+    const T kCubeCoefficient = static_cast<T>(0.044715);
+    auto gelu = [&](int64 start, int64 limit) {
+      Row x(depth);
+      for (int64 r = start; r < limit; ++r) {
+        x = ConstRowMap(input_data + r * depth, depth);
+        if (bias_data != nullptr) {
+          x += ConstRowMap(bias_data, depth);
+        }
+        RowMap(output_data + r * depth, depth) =
+            static_cast<T>(0.5) * x *
+            (static_cast<T>(1) +
+             (kSqrt2OverPi * (x + kCubeCoefficient * x.cube())).tanh());
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          input.NumElements() / depth, depth * 20, gelu);
+  }
+
+ private:
+  bool has_bias_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedBiasGeluOp);
+};
+
+#define REGISTER_KERNEL(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedBiasGelu").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedBiasGeluOp<T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+float Gelu(float x) {
+  return 0.5f * x *
+         (1 + std::tanh(std::sqrt(2 / M_PI) * (x + 0.044715f * x * x * x)));
+}
+
+class FusedBiasGeluOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_biases) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedBiasGelu")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(num_biases, DT_FLOAT))
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedBiasGeluOpTest, WithoutBias) {
+  TF_ASSERT_OK(MakeOp(0));
+  AddInputFromArray<float>(TensorShape({4}), {-3, -0.5, 0, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected,
+                          {Gelu(-3), Gelu(-0.5f), Gelu(0), Gelu(2)});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedBiasGeluOpTest, WithBias) {
+  TF_ASSERT_OK(MakeOp(1));
+  AddInputFromArray<float>(TensorShape({2, 3}), {-2, -1, 0, 1, 2, 3});
+  AddInputFromArray<float>(TensorShape({3}), {0.5, -0.5, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {Gelu(-1.5f), Gelu(-1.5f), Gelu(1),
+                                      Gelu(1.5f), Gelu(1.5f), Gelu(4)});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+}  // namespace
+}  // namespace tensorflow
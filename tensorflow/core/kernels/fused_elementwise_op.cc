@@ -0,0 +1,289 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class FusedOp {
+  // Unary ops.
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  // Binary ops.
+  kAdd,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kRealDiv,
+  kSquaredDifference,
+  kSub,
+};
+
+struct FusedStep {
+  FusedOp op;
+  bool binary;
+  bool chain_is_lhs;
+};
+
+Status ParseFusedStep(const string& name, bool chain_is_lhs, FusedStep* step) {
+  static const gtl::FlatMap<string, FusedOp>* unary_ops =
+      new gtl::FlatMap<string, FusedOp>({
+          {"Abs", FusedOp::kAbs},
+          {"Exp", FusedOp::kExp},
+          {"Log", FusedOp::kLog},
+          {"Neg", FusedOp::kNeg},
+          {"Relu", FusedOp::kRelu},
+          {"Relu6", FusedOp::kRelu6},
+          {"Rsqrt", FusedOp::kRsqrt},
+          {"Sigmoid", FusedOp::kSigmoid},
+          {"Sqrt", FusedOp::kSqrt},
+          {"Square", FusedOp::kSquare},
+          {"Tanh", FusedOp::kTanh},
+      });
+  static const gtl::FlatMap<string, FusedOp>* binary_ops =
+      new gtl::FlatMap<string, FusedOp>({
+          {"Add", FusedOp::kAdd},
+          {"Maximum", FusedOp::kMaximum},
+          {"Minimum", FusedOp::kMinimum},
+          {"Mul", FusedOp::kMul},
+          {"RealDiv", FusedOp::kRealDiv},
+          {"SquaredDifference", FusedOp::kSquaredDifference},
+          {"Sub", FusedOp::kSub},
+      });
+  auto it = unary_ops->find(name);
+  if (it != unary_ops->end()) {
+    *step = {it->second, false, true};
+    return Status::OK();
+  }
+  it = binary_ops->find(name);
+  if (it != binary_ops->end()) {
+    *step = {it->second, true, chain_is_lhs};
+    return Status::OK();
+  }
+  return errors::InvalidArgument("Unsupported op in _FusedElementwise: ",
+                                 name);
+}
+
+}  // namespace
+
+// Evaluates the chain of ops block by block, so that every element of the
+// inputs is read from memory once and every element of the output written
+// once, while the intermediate results of a block stay in cache.
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> ops;
+    std::vector<bool> chain_is_lhs;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &ops));
+    OP_REQUIRES_OK(context, context->GetAttr("chain_is_lhs", &chain_is_lhs));
+    OP_REQUIRES(context, ops.size() == chain_is_lhs.size(),
+                errors::InvalidArgument(
+                    "ops and chain_is_lhs must have the same length, got ",
+                    ops.size(), " and ", chain_is_lhs.size()));
+    int num_binary = 0;
+    steps_.resize(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+      OP_REQUIRES_OK(context,
+                     ParseFusedStep(ops[i], chain_is_lhs[i], &steps_[i]));
+      if (steps_[i].binary) ++num_binary;
+    }
+    OP_REQUIRES(context, num_binary + 1 == context->num_inputs(),
+                errors::InvalidArgument("Expected ", num_binary + 1,
+                                        " inputs for ", num_binary,
+                                        " binary ops, got ",
+                                        context->num_inputs()));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    std::vector<const T*> side_inputs;
+    for (int i = 1; i < context->num_inputs(); ++i) {
+      const Tensor& side_input = context->input(i);
+      OP_REQUIRES(context, side_input.shape() == input.shape(),
+                  errors::InvalidArgument(
+                      "All inputs must have the same shape, but input ", i,
+                      " has shape ", side_input.shape().DebugString(),
+                      " and input 0 has shape ", input.shape().DebugString()));
+      side_inputs.push_back(side_input.flat<T>().data());
+    }
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+    const int64 size = input.NumElements();
+    if (size == 0) return;
+
+    const T* x = input.flat<T>().data();
+    T* y = output->flat<T>().data();
+    auto work = [this, x, y, size, &side_inputs](int64 start, int64 limit) {
+      for (int64 b = start; b < limit; ++b) {
+        const int64 offset = b * kBlockSize;
+        EvaluateBlock(x, side_inputs, offset,
+                      std::min<int64>(kBlockSize, size - offset), y);
+      }
+    };
+    const int64 num_blocks = (size + kBlockSize - 1) / kBlockSize;
+    // Roughly the cost of the most expensive ops, like Tanh.
+    const int64 cost_per_block = kBlockSize * steps_.size() * 10;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          cost_per_block, work);
+  }
+
+ private:
+  // The number of elements evaluated at once: small enough for all
+  // operands of an op to stay in L1.
+  static constexpr int64 kBlockSize = 1024;
+
+  using Block = typename TTypes<T>::UnalignedFlat;
+  using ConstBlock = typename TTypes<T>::UnalignedConstFlat;
+
+  void EvaluateBlock(const T* x, const std::vector<const T*>& side_inputs,
+                     int64 offset, int64 n, T* y) const {
+    T buf[kBlockSize];
+    Block acc(buf, n);
+    acc = ConstBlock(x + offset, n);
+    int next_input = 0;
+    for (const FusedStep& step : steps_) {
+      if (!step.binary) {
+        ApplyUnary(step, &acc);
+      } else {
+        ApplyBinary(step, ConstBlock(side_inputs[next_input++] + offset, n),
+                    &acc);
+      }
+    }
+    Block(y + offset, n) = acc;
+  }
+
+  static void ApplyUnary(const FusedStep& step, Block* acc) {
+    Block& a = *acc;
+    switch (step.op) {
+      case FusedOp::kAbs:
+        a = a.abs();
+        break;
+      case FusedOp::kExp:
+        a = a.exp();
+        break;
+      case FusedOp::kLog:
+        a = a.log();
+        break;
+      case FusedOp::kNeg:
+        a = -a;
+        break;
+      case FusedOp::kRelu:
+        a = a.cwiseMax(static_cast<T>(0));
+        break;
+      case FusedOp::kRelu6:
+        a = a.cwiseMax(static_cast<T>(0)).cwiseMin(static_cast<T>(6));
+        break;
+      case FusedOp::kRsqrt:
+        a = a.rsqrt();
+        break;
+      case FusedOp::kSigmoid:
+        a = a.sigmoid();
+        break;
+      case FusedOp::kSqrt:
+        a = a.sqrt();
+        break;
+      case FusedOp::kSquare:
+        a = a.square();
+        break;
+      case FusedOp::kTanh:
+        a = a.tanh();
+        break;
+      default:
+        LOG(FATAL) << "Not a unary op";
+    }
+  }
+
+  static void ApplyBinary(const FusedStep& step, ConstBlock x, Block* acc) {
+    Block& a = *acc;
+    switch (step.op) {
+      case FusedOp::kAdd:
+        a = a + x;
+        break;
+      case FusedOp::kMaximum:
+        a = a.cwiseMax(x);
+        break;
+      case FusedOp::kMinimum:
+        a = a.cwiseMin(x);
+        break;
+      case FusedOp::kMul:
+        a = a * x;
+        break;
+      case FusedOp::kRealDiv:
+        if (step.chain_is_lhs) {
+          a = a / x;
+        } else {
+          a = x / a;
+        }
+        break;
+      case FusedOp::kSquaredDifference:
+        a = (a - x).square();
+        break;
+      case FusedOp::kSub:
+        if (step.chain_is_lhs) {
+          a = a - x;
+        } else {
+          a = x - a;
+        }
+        break;
+      default:
+        LOG(FATAL) << "Not a binary op";
+    }
+  }
+
+  std::vector<FusedStep> steps_;
+};
+
+template <typename T>
+constexpr int64 FusedElementwiseOp<T>::kBlockSize;
+
+#define REGISTER_KERNEL(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
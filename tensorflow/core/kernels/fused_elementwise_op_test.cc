@@ -0,0 +1,102 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_inputs, const std::vector<string>& ops,
+                const std::vector<bool>& chain_is_lhs) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_inputs, DT_FLOAT))
+                           .Attr("ops", ops)
+                           .Attr("chain_is_lhs", chain_is_lhs)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, UnaryChain) {
+  TF_ASSERT_OK(MakeOp(1, {"Neg", "Relu", "Square"}, {true, true, true}));
+  AddInputFromArray<float>(TensorShape({4}), {-2, -1, 1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {4, 1, 0, 0});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, MulAddReluSigmoid) {
+  // 4 / (3 - sigmoid(relu(x * 2 + 1))), where the chain is the right operand
+  // of the last two ops.
+  TF_ASSERT_OK(MakeOp(5, {"Mul", "Add", "Relu", "Sigmoid", "Sub", "RealDiv"},
+                      {true, true, true, true, false, false}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, -2, 3, -4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 2, 2, 2});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 1, 1, 1});
+  AddInputFromArray<float>(TensorShape({2, 2}), {3, 3, 3, 3});
+  AddInputFromArray<float>(TensorShape({2, 2}), {4, 4, 4, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  std::vector<float> expected_values;
+  for (float x : {1.0f, -2.0f, 3.0f, -4.0f}) {
+    const float sigmoid = 1.0f / (1.0f + std::exp(-std::max(x * 2 + 1, 0.0f)));
+    expected_values.push_back(4 / (3 - sigmoid));
+  }
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, LargeInput) {
+  // Spans several blocks, the last one partial.
+  const int kSize = 5000;
+  TF_ASSERT_OK(MakeOp(2, {"SquaredDifference", "Sqrt"}, {true, true}));
+  AddInput<float>(TensorShape({kSize}), [](int i) -> float { return i; });
+  AddInput<float>(TensorShape({kSize}), [](int i) -> float { return -i; });
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kSize}));
+  test::FillFn<float>(&expected, [](int i) -> float { return 2 * i; });
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-3);
+}
+
+TEST_F(FusedElementwiseOpTest, ShapeMismatch) {
+  TF_ASSERT_OK(MakeOp(2, {"Add"}, {true}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedElementwiseOpTest, InvalidOps) {
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp(1, {"MatMul"}, {true})));
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp(1, {"Add"}, {true})));
+  EXPECT_TRUE(errors::IsInvalidArgument(MakeOp(2, {"Add"}, {true, true})));
+}
+
+}  // namespace
+}  // namespace tensorflow
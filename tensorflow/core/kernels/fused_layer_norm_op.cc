@@ -0,0 +1,106 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Normalizes every row of x in two passes over it, which stays in cache in
+// between: one for the mean and one for the variance and the output. The
+// output is computed as x * inv + (offset - mean * inv), with
+// inv = rsqrt(variance + epsilon) * scale, like tf.nn.batch_normalization.
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+    OP_REQUIRES(context, x.dims() >= 1,
+                errors::InvalidArgument("x must have a rank of at least 1: ",
+                                        x.shape().DebugString()));
+    const int64 depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                scale.dims() == 1 && scale.dim_size(0) == depth &&
+                    offset.dims() == 1 && offset.dim_size(0) == depth,
+                errors::InvalidArgument(
+                    "scale and offset must be vectors of the size of the "
+                    "last dimension of x: ",
+                    x.shape().DebugString(), " ",
+                    scale.shape().DebugString(), " ",
+                    offset.shape().DebugString()));
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    typedef Eigen::Array<T, 1, Eigen::Dynamic> Row;
+    typedef Eigen::Map<const Row> ConstRowMap;
+    typedef Eigen::Map<Row> RowMap;
+    const T* x_data = x.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    ConstRowMap scale_row(scale.flat<T>().data(), depth);
+    ConstRowMap offset_row(offset.flat<T>().data(), depth);
+    const T epsilon = static_cast<T>(epsilon_);
+    auto normalize = [&](int64 start, int64 limit) {
+      for (int64 r = start; r < limit; ++r) {
+        ConstRowMap row(x_data + r * depth, depth);
+        const T mean = row.mean();
+        const T variance = (row - mean).square().mean();
+        const T inv = static_cast<T>(1) / std::sqrt(variance + epsilon);
+        // y may alias x, so the row is not read after this.
+        RowMap(y_data + r * depth, depth) =
+            row * (scale_row * inv) + (offset_row - mean * scale_row * inv);
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          x.NumElements() / depth, depth * 8, normalize);
+  }
+
+ private:
+  float epsilon_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedLayerNormOp);
+};
+
+#define REGISTER_KERNEL(T)                                                  \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
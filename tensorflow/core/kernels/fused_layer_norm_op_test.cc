@@ -0,0 +1,70 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(float epsilon) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedLayerNorm")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Attr("epsilon", epsilon)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, NormalizesRows) {
+  TF_ASSERT_OK(MakeOp(0.01f));
+  AddInputFromArray<float>(TensorShape({2, 4}), {1, 2, 3, 4, -1, -1, 3, 3});
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 1, 2});
+  AddInputFromArray<float>(TensorShape({4}), {0, 0, 1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  // The rows have a mean of 2.5 and 1, and a variance of 1.25 and 4.
+  const float inv0 = 1 / std::sqrt(1.25f + 0.01f);
+  const float inv1 = 1 / std::sqrt(4.0f + 0.01f);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(
+      &expected, {-1.5f * inv0, -0.5f * 2 * inv0, 0.5f * inv0 + 1,
+                  1.5f * 2 * inv0 + 1, -2 * inv1, -2 * 2 * inv1, 2 * inv1 + 1,
+                  2 * 2 * inv1 + 1});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedLayerNormOpTest, ScaleOfWrongSize) {
+  TF_ASSERT_OK(MakeOp(0.01f));
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,25 +16,62 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
-#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
-// is specified. Each individual value must be a scalar. If vector values are
-// required, use MutableHashTableOfTensors.
+namespace {
+
+// Hashes the keys of MutableHashTableOfScalars. FlatMap takes the probe marker
+// from the low bits of the hash and the bucket from the bits above, so
+// integer keys are mixed (with the MurmurHash3 finalizer) rather than hashed
+// to themselves.
+template <typename T>
+struct ScalarKeyHash {
+  size_t operator()(T key) const {
+    uint64 x = static_cast<uint64>(key);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+  }
+};
+
+template <>
+struct ScalarKeyHash<string> {
+  size_t operator()(const string& key) const {
+    return static_cast<size_t>(Hash64(key));
+  }
+};
+
+}  // namespace
+
+// Lookup table that wraps open-addressing FlatMaps, where the key and value
+// data type is specified. Each individual value must be a scalar. If vector
+// values are required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The keys are spread over shards by hash, each with its own reader/writer
+// lock, so that lookups never wait for each other and only wait for inserts
+// into (or the growth of) the shards they read.
 //
 // Sample use case:
 //
@@ -50,8 +87,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    mutex_lock l(mu_);
-    return table_.size();
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.table.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -60,10 +101,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    std::vector<int64> order;
+    ShardStarts starts;
+    GroupByShard(key_values, &order, &starts);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (starts[s] == starts[s + 1]) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64 j = starts[s]; j < starts[s + 1]; ++j) {
+        const int64 i = order[j];
+        value_values(i) = gtl::FindWithDefault(
+            shard.table, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+      }
     }
 
     return Status::OK();
@@ -73,13 +122,34 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    std::vector<int64> order;
+    ShardStarts starts;
+    GroupByShard(key_values, &order, &starts);
+    auto insert_into_shard = [&](int s) {
+      auto& table = shards_[s].table;
+      for (int64 j = starts[s]; j < starts[s + 1]; ++j) {
+        const int64 i = order[j];
+        table[SubtleMustCopyIfIntegral(key_values(i))] =
+            SubtleMustCopyIfIntegral(value_values(i));
+      }
+    };
     if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      // Importing replaces the whole table at once, so all the shards are
+      // locked for it.
+      std::vector<mutex_lock> all_locks;
+      for (Shard& shard : shards_) {
+        all_locks.emplace_back(shard.mu);
+        shard.table.clear();
+      }
+      for (int s = 0; s < kNumShards; ++s) {
+        insert_into_shard(s);
+      }
+    } else {
+      for (int s = 0; s < kNumShards; ++s) {
+        if (starts[s] == starts[s + 1]) continue;
+        mutex_lock l(shards_[s].mu);
+        insert_into_shard(s);
+      }
     }
     return Status::OK();
   }
@@ -95,8 +165,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    int64 size = table_.size();
+    std::vector<tf_shared_lock> all_locks;
+    int64 size = 0;
+    for (const Shard& shard : shards_) {
+      all_locks.emplace_back(shard.mu);
+      size += shard.table.size();
+    }
 
     Tensor* keys;
     Tensor* values;
@@ -108,9 +182,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Shard& shard : shards_) {
+      for (auto it = shard.table.begin(); it != shard.table.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
     return Status::OK();
   }
@@ -125,26 +201,65 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    mutex_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      ret += shard.table.bucket_count() * (sizeof(K) + sizeof(V) + 1);
     }
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
  private:
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  static constexpr int kShardBits = 4;
+  static constexpr int kNumShards = 1 << kShardBits;
+  typedef std::array<int64, kNumShards + 1> ShardStarts;
+
+  struct Shard {
+    mutable mutex mu;
+    gtl::FlatMap<K, V, ScalarKeyHash<K>> table GUARDED_BY(mu);
+  };
+
+  // Returns the shard of a key, from the top bits of its hash, which FlatMap
+  // doesn't use to pick buckets in a shard of moderate size.
+  static int ShardOf(const K& key) {
+    return static_cast<uint64>(ScalarKeyHash<K>()(key)) >>
+           (8 * sizeof(size_t) - kShardBits);
+  }
+
+  // Fills 'order' with the indices of 'keys' grouped by shard: the keys of
+  // shard s are those at indices order[(*starts)[s]] to
+  // order[(*starts)[s + 1] - 1], in their original order.
+  static void GroupByShard(typename TTypes<K>::ConstFlat keys,
+                           std::vector<int64>* order, ShardStarts* starts) {
+    const int64 num_keys = keys.size();
+    std::vector<uint8> shard_of_key(num_keys);
+    starts->fill(0);
+    for (int64 i = 0; i < num_keys; ++i) {
+      shard_of_key[i] = ShardOf(SubtleMustCopyIfIntegral(keys(i)));
+      ++(*starts)[shard_of_key[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      (*starts)[s + 1] += (*starts)[s];
+    }
+    ShardStarts next = *starts;
+    order->resize(num_keys);
+    for (int64 i = 0; i < num_keys; ++i) {
+      (*order)[next[shard_of_key[i]]++] = i;
+    }
+  }
+
+  Shard shards_[kNumShards];
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
-// MutableHashTableOfScalars except that each value must be a vector.
+// Lookup table that maps keys to vectors. Behaves identical to
+// MutableHashTableOfScalars except that each value must be a vector, and that
+// the number of keys can be bounded.
+//
+// The vectors are the rows of one contiguous buffer, so that tables of e.g.
+// embeddings don't cost an allocation per key. If max_size is positive,
+// inserts that would grow the table beyond max_size keys first evict the
+// keys found least often. Find counts how often each key is found, and the
+// counts are halved at every eviction, so that keys that are no longer looked
+// up eventually make way for new ones.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
  public:
@@ -155,11 +270,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
         ctx, TensorShapeUtils::IsVector(value_shape_),
         errors::InvalidArgument("Default value must be a vector, got shape ",
                                 value_shape_.DebugString()));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "max_size", &max_size_));
+    OP_REQUIRES(ctx, max_size_ >= 0,
+                errors::InvalidArgument("max_size must be non-negative, got ",
+                                        max_size_));
   }
 
   size_t size() const override {
     mutex_lock l(mu_);
-    return table_.size();
+    return row_keys_.size();
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -171,11 +290,13 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
     mutex_lock l(mu_);
     for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
+      const int64* row =
+          gtl::FindOrNull(rows_, SubtleMustCopyIfIntegral(key_values(i)));
+      if (row != nullptr) {
+        ++counts_[*row];
+        const int64 offset = *row * value_dim;
         for (int64 j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
+          value_values(i, j) = values_[offset + j];
         }
       } else {
         for (int64 j = 0; j < value_dim; j++) {
@@ -194,16 +315,31 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
     mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
+      rows_.clear();
+      row_keys_.clear();
+      values_.clear();
+      counts_.clear();
+    }
+    if (max_size_ > 0) {
+      TF_RETURN_IF_ERROR(MakeRoomFor(key_values));
     }
     for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray value_vec;
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      int64 row;
+      auto it = rows_.find(key);
+      if (it == rows_.end()) {
+        row = row_keys_.size();
+        rows_[key] = row;
+        row_keys_.push_back(key);
+        counts_.push_back(0);
+        values_.resize((row + 1) * value_dim);
+      } else {
+        row = it->second;
+      }
+      const int64 offset = row * value_dim;
       for (int64 j = 0; j < value_dim; j++) {
-        V value = value_values(i, j);
-        value_vec.push_back(value);
+        values_[offset + j] = value_values(i, j);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
     }
     return Status::OK();
   }
@@ -220,7 +356,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   Status ExportValues(OpKernelContext* ctx) override {
     mutex_lock l(mu_);
-    int64 size = table_.size();
+    int64 size = row_keys_.size();
     int64 value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
@@ -232,13 +368,10 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
+    for (int64 i = 0; i < size; ++i) {
+      keys_data(i) = row_keys_[i];
       for (int64 j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+        values_data(i, j) = values_[i * value_dim + j];
       }
     }
     return Status::OK();
@@ -253,25 +386,83 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
     mutex_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    return sizeof(MutableHashTableOfTensors) +
+           rows_.bucket_count() * (sizeof(K) + sizeof(int64) + 1) +
+           row_keys_.capacity() * sizeof(K) + values_.capacity() * sizeof(V) +
+           counts_.capacity() * sizeof(int64);
+  }
+
+ private:
+  // Evicts the keys found least often, other than 'keys', until 'keys' fit
+  // in max_size_.
+  Status MakeRoomFor(typename TTypes<K>::ConstFlat keys)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    gtl::FlatSet<K, ScalarKeyHash<K>> batch;
+    int64 num_new_keys = 0;
+    for (int64 i = 0; i < keys.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(keys(i));
+      if (batch.insert(key).second && rows_.find(key) == rows_.end()) {
+        ++num_new_keys;
+      }
+    }
+    if (static_cast<int64>(batch.size()) > max_size_) {
+      return errors::InvalidArgument("Cannot insert ", batch.size(),
+                                     " distinct keys into a table of max_size ",
+                                     max_size_);
+    }
+    const int64 num_evicted =
+        static_cast<int64>(row_keys_.size()) + num_new_keys - max_size_;
+    if (num_evicted <= 0) {
+      return Status::OK();
+    }
+
+    std::vector<int64> evicted;
+    for (int64 row = 0; row < static_cast<int64>(row_keys_.size()); ++row) {
+      if (batch.find(row_keys_[row]) == batch.end()) {
+        evicted.push_back(row);
       }
     }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    std::nth_element(
+        evicted.begin(), evicted.begin() + num_evicted, evicted.end(),
+        [this](int64 a, int64 b) { return counts_[a] < counts_[b]; });
+    evicted.resize(num_evicted);
+
+    // Each row is removed by moving the last row into its place. Going from
+    // the last evicted row down, the last row is never one still to evict.
+    const int64 value_dim = value_shape_.dim_size(0);
+    std::sort(evicted.begin(), evicted.end(), std::greater<int64>());
+    for (const int64 row : evicted) {
+      const int64 last = row_keys_.size() - 1;
+      rows_.erase(row_keys_[row]);
+      if (row != last) {
+        row_keys_[row] = row_keys_[last];
+        rows_[row_keys_[row]] = row;
+        counts_[row] = counts_[last];
+        for (int64 j = 0; j < value_dim; j++) {
+          values_[row * value_dim + j] = values_[last * value_dim + j];
+        }
+      }
+      row_keys_.pop_back();
+      counts_.pop_back();
+      values_.resize(last * value_dim);
+    }
+    for (int64& count : counts_) {
+      count /= 2;
+    }
+    return Status::OK();
   }
 
- private:
   TensorShape value_shape_;
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
+  int64 max_size_;
   mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ GUARDED_BY(mu_);
+  // The row of each key in the vectors below.
+  gtl::FlatMap<K, int64, ScalarKeyHash<K>> rows_ GUARDED_BY(mu_);
+  std::vector<K> row_keys_ GUARDED_BY(mu_);
+  // The value of each row, as value_shape_.dim_size(0) consecutive elements.
+  std::vector<V> values_ GUARDED_BY(mu_);
+  // How often Find found each row, halved at every eviction.
+  std::vector<int64> counts_ GUARDED_BY(mu_);
 };
 
 namespace {
@@ -872,6 +1063,7 @@ REGISTER_KERNEL(string, float);
 REGISTER_KERNEL(string, int64);
 REGISTER_KERNEL(int64, string);
 REGISTER_KERNEL(string, bool);
+REGISTER_KERNEL(int64, float);
 
 #undef REGISTER_KERNEL
 
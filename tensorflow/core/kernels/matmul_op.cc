@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/cast_op.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
@@ -146,6 +147,31 @@ struct LaunchMatMulCPU : LaunchMatMulBase<CPUDevice, T> {};
 template <typename T, bool USE_CUBLAS>
 struct LaunchMatMul<CPUDevice, T, USE_CUBLAS> : public LaunchMatMulCPU<T> {};
 
+// Eigen has no vectorized bfloat16 arithmetic, so bfloat16 products are
+// computed in float, and only rounded to bfloat16 at the end.
+template <>
+struct LaunchMatMul<CPUDevice, bfloat16, false>
+    : public LaunchMatMulCPU<bfloat16> {
+  static void launch(
+      OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      std::vector<AlgorithmType>* algorithms, bool use_aututone, Tensor* out) {
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    Tensor a_float;
+    Tensor b_float;
+    Tensor out_float;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_temp(DT_FLOAT, out->shape(), &out_float));
+    a_float.flat<float>().device(d) = a.flat<bfloat16>().cast<float>();
+    b_float.flat<float>().device(d) = b.flat<bfloat16>().cast<float>();
+    LaunchMatMulCPU<float>::launch(ctx, a_float, b_float, dim_pair,
+                                   algorithms, use_aututone, &out_float);
+    out->flat<bfloat16>().device(d) = out_float.flat<float>().cast<bfloat16>();
+  }
+};
+
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T>
 struct LaunchMatMulSYCL : LaunchMatMulBase<SYCLDevice, T> {};
@@ -559,6 +585,7 @@ struct MatMulFunctor<SYCLDevice, T> {
 TF_CALL_float(REGISTER_CPU_EIGEN);
 TF_CALL_double(REGISTER_CPU_EIGEN);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU_EIGEN);
@@ -567,6 +594,7 @@ TF_CALL_complex128(REGISTER_CPU_EIGEN);
 TF_CALL_float(REGISTER_CPU);
 TF_CALL_double(REGISTER_CPU);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU);
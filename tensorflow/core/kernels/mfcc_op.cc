@@ -15,6 +15,8 @@ limitations under the License.
 
 // See docs in ../ops/audio_ops.cc
 
+#include <memory>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/mfcc.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -55,15 +58,9 @@ class MfccOp : public OpKernel {
     const int spectrogram_samples = spectrogram.dim_size(1);
     const int audio_channels = spectrogram.dim_size(0);
 
-    Mfcc mfcc;
-    mfcc.set_upper_frequency_limit(upper_frequency_limit_);
-    mfcc.set_lower_frequency_limit(lower_frequency_limit_);
-    mfcc.set_filterbank_channel_count(filterbank_channel_count_);
-    mfcc.set_dct_coefficient_count(dct_coefficient_count_);
-    OP_REQUIRES(context, mfcc.Initialize(spectrogram_channels, sample_rate),
-                errors::InvalidArgument(
-                    "Mfcc initialization failed for channel count ",
-                    spectrogram_channels, " and sample rate ", sample_rate));
+    std::shared_ptr<const Mfcc> mfcc;
+    OP_REQUIRES_OK(context,
+                   GetMfcc(spectrogram_channels, sample_rate, &mfcc));
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(context,
@@ -87,7 +84,7 @@ class MfccOp : public OpKernel {
         std::vector<double> mfcc_input(sample_data,
                                        sample_data + spectrogram_channels);
         std::vector<double> mfcc_output;
-        mfcc.Compute(mfcc_input, &mfcc_output);
+        mfcc->Compute(mfcc_input, &mfcc_output);
         DCHECK_EQ(dct_coefficient_count_, mfcc_output.size());
         float* output_data =
             output_flat +
@@ -101,10 +98,41 @@ class MfccOp : public OpKernel {
   }
 
  private:
+  // Returns an Mfcc for the spectrogram size and sample rate, which reuses the
+  // filterbank of the previous call when they are the same, as they are for
+  // successive chunks of a stream.
+  Status GetMfcc(int spectrogram_channels, int32 sample_rate,
+                 std::shared_ptr<const Mfcc>* mfcc) {
+    mutex_lock l(mu_);
+    if (mfcc_ == nullptr || mfcc_spectrogram_channels_ != spectrogram_channels ||
+        mfcc_sample_rate_ != sample_rate) {
+      std::shared_ptr<Mfcc> new_mfcc(new Mfcc);
+      new_mfcc->set_upper_frequency_limit(upper_frequency_limit_);
+      new_mfcc->set_lower_frequency_limit(lower_frequency_limit_);
+      new_mfcc->set_filterbank_channel_count(filterbank_channel_count_);
+      new_mfcc->set_dct_coefficient_count(dct_coefficient_count_);
+      if (!new_mfcc->Initialize(spectrogram_channels, sample_rate)) {
+        return errors::InvalidArgument(
+            "Mfcc initialization failed for channel count ",
+            spectrogram_channels, " and sample rate ", sample_rate);
+      }
+      mfcc_ = std::move(new_mfcc);
+      mfcc_spectrogram_channels_ = spectrogram_channels;
+      mfcc_sample_rate_ = sample_rate;
+    }
+    *mfcc = mfcc_;
+    return Status::OK();
+  }
+
   float upper_frequency_limit_;
   float lower_frequency_limit_;
   int32 filterbank_channel_count_;
   int32 dct_coefficient_count_;
+
+  mutex mu_;
+  std::shared_ptr<const Mfcc> mfcc_ GUARDED_BY(mu_);
+  int mfcc_spectrogram_channels_ GUARDED_BY(mu_);
+  int32 mfcc_sample_rate_ GUARDED_BY(mu_);
 };
 REGISTER_KERNEL_BUILDER(Name("Mfcc").Device(DEVICE_CPU), MfccOp);
 
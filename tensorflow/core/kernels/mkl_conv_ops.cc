@@ -37,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 
@@ -786,6 +788,8 @@ class MklConv2DOp : public OpKernel {
     OP_REQUIRES(
         context, dilation_h > 0 && dilation_w > 0,
         errors::InvalidArgument("Dilated rates should be larger than 0."));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("is_filter_const", &is_filter_const_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -883,10 +887,6 @@ class MklConv2DOp : public OpKernel {
       conv_fwd_pd = conv2d_fwd->GetPrimitiveDesc();
       AllocateOutputTensor(context, *conv_fwd_pd,
                        dst_dims_mkl_order, tf_fmt, &dst_tensor);
-      Tensor* filter_out_tensor = nullptr;
-      AllocateFilterOutputTensor(context, *conv_fwd_pd,
-                                 TFShapeToMklDnnDims(filter_tf_shape),
-                                 &filter_out_tensor);
 
       T* dst_data = static_cast<T*>(dst_tensor->flat<T>().data());
 
@@ -903,19 +903,37 @@ class MklConv2DOp : public OpKernel {
                     src_tensor.flat<T>().data()));
       }
       T *filter_data = nullptr;
-      if (filter_md.data.format != conv2d_fwd->GetFilterMemoryFormat()) {
-        filter.SetUsrMem(filter_md, &filter_tensor);
-        filter.CheckReorderToOpMem(
-            conv_fwd_pd.get()->weights_primitive_desc(),
-            filter.GetTensorBuffer(filter_out_tensor), &net);
-        filter_data = static_cast<T*>(filter.GetOpMem().get_data_handle());
+      bool filter_reordered = false;
+      Tensor* filter_out_tensor = nullptr;
+      if (is_filter_const_ &&
+          GetCachedFilter(context, *conv_fwd_pd, filter_dims,
+                          TFShapeToMklDnnDims(filter_tf_shape),
+                          &filter_data)) {
+        // The constant filter was reordered by an earlier step.
       } else {
-        filter_data = static_cast<T*>(const_cast<T*>(
-                       filter_tensor.flat<T>().data()));
+        AllocateFilterOutputTensor(context, *conv_fwd_pd,
+                                   TFShapeToMklDnnDims(filter_tf_shape),
+                                   &filter_out_tensor);
+        if (filter_md.data.format != conv2d_fwd->GetFilterMemoryFormat()) {
+          filter.SetUsrMem(filter_md, &filter_tensor);
+          filter.CheckReorderToOpMem(
+              conv_fwd_pd.get()->weights_primitive_desc(),
+              filter.GetTensorBuffer(filter_out_tensor), &net);
+          filter_data = static_cast<T*>(filter.GetOpMem().get_data_handle());
+          filter_reordered = true;
+        } else {
+          filter_data = static_cast<T*>(const_cast<T*>(
+                         filter_tensor.flat<T>().data()));
+        }
       }
 
       stream(stream::kind::eager).submit(net).wait();
 
+      if (is_filter_const_ && filter_reordered) {
+        CacheFilter(*filter_out_tensor, filter_dims,
+                    conv2d_fwd->GetFilterMemoryFormat());
+      }
+
 
       // execute convolution
       if (biasEnabled) {
@@ -947,6 +965,51 @@ class MklConv2DOp : public OpKernel {
   const int kDilationH = 0, kDilationW = 1;
   engine cpu_engine = engine(engine::cpu, 0);
 
+  // Set by the layout pass when the filter is a constant, as in inference
+  // graphs: its reordered copy is then kept across steps, in cached_filter_.
+  bool is_filter_const_;
+  mutex mu_;
+  Tensor cached_filter_ GUARDED_BY(mu_);
+  memory::dims cached_filter_dims_ GUARDED_BY(mu_);
+  memory::format cached_filter_format_ GUARDED_BY(mu_);
+
+  // Keeps the reordered constant filter in 'filter_out_tensor' for the
+  // following steps. The output tensor is only shared, never written again.
+  void CacheFilter(const Tensor& filter_out_tensor,
+                   const memory::dims& filter_dims,
+                   memory::format filter_format) {
+    mutex_lock lock(mu_);
+    cached_filter_ = filter_out_tensor;
+    cached_filter_dims_ = filter_dims;
+    cached_filter_format_ = filter_format;
+  }
+
+  // If the constant filter of shape 'filter_dims' was already reordered to
+  // the layout 'conv_prim_desc' expects, outputs it as the converted filter,
+  // sets '*filter_data' to it and returns true.
+  bool GetCachedFilter(OpKernelContext* context,
+                       const convolution_forward::primitive_desc&
+                           conv_prim_desc,
+                       const memory::dims& filter_dims,
+                       const memory::dims& filter_dims_tf_order,
+                       T** filter_data) {
+    mutex_lock lock(mu_);
+    auto filter_pd = conv_prim_desc.weights_primitive_desc();
+    if (!cached_filter_.IsInitialized() || cached_filter_dims_ != filter_dims ||
+        cached_filter_format_ != static_cast<memory::format>(
+                                     filter_pd.desc().data.format)) {
+      return false;
+    }
+    MklDnnShape filter_mkl_shape;
+    GetFilterMklShape(filter_pd, filter_dims_tf_order, &filter_mkl_shape);
+    context->set_output(
+        GetTensorDataIndex(kOutputIndex_Filter, context->num_outputs()),
+        cached_filter_);
+    AllocateOutputSetMklShape(context, kOutputIndex_Filter, filter_mkl_shape);
+    *filter_data = const_cast<T*>(cached_filter_.flat<T>().data());
+    return true;
+  }
+
   // Allocate output tensor.
   void AllocateOutputTensor(
       OpKernelContext* context,
@@ -972,6 +1035,22 @@ class MklConv2DOp : public OpKernel {
                               output_tf_shape, output_mkl_shape);
   }
 
+  // Describes the filter reordered to the layout 'filter_pd'.
+  void GetFilterMklShape(memory::primitive_desc filter_pd,
+                         const memory::dims& filter_dims_tf_order,
+                         MklDnnShape* filter_mkl_shape) {
+    filter_mkl_shape->SetMklTensor(true);
+    filter_mkl_shape->SetMklLayout(&filter_pd);
+    filter_mkl_shape->SetElemType(MklDnnType<T>());
+
+    // The format of the filter is actually OIhw8i8o, but TF doesn't support
+    // this format. Just use format::blocked for now because the layout
+    // is stored in the MKL data.
+    filter_mkl_shape->SetTfLayout(filter_dims_tf_order.size(),
+                                  filter_dims_tf_order,
+                                  memory::format::blocked);
+  }
+
   // Allocate output tensor.
   void AllocateFilterOutputTensor(
       OpKernelContext* context,
@@ -982,15 +1061,7 @@ class MklConv2DOp : public OpKernel {
 
     // Allocate shape of Mkl tensor.
     MklDnnShape filter_mkl_shape;
-    filter_mkl_shape.SetMklTensor(true);
-    filter_mkl_shape.SetMklLayout(&filter_pd);
-    filter_mkl_shape.SetElemType(MklDnnType<T>());
-
-    // The format of the filter is actually OIhw8i8o, but TF doesn't support
-    // this format. Just use format::blocked for now because the layout
-    // is stored in the MKL data.
-    filter_mkl_shape.SetTfLayout(filter_dims_tf_order.size(),
-                                 filter_dims_tf_order, memory::format::blocked);
+    GetFilterMklShape(filter_pd, filter_dims_tf_order, &filter_mkl_shape);
 
     // Allocate the data space for the filter to propagate as TF tensor.
     TensorShape filter_tf_shape;
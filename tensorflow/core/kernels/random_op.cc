@@ -68,6 +68,9 @@ struct FillPhiloxRandom {
   }
 };
 
+// Number of Philox groups the CPU fill tasks generate at once.
+static const int kPhiloxBlocksPerBatch = 8;
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -82,12 +85,14 @@ struct FillPhiloxRandomTask<Distribution, false> {
     const int kGroupSize = Distribution::kResultElementCount;
 
     gen.Skip(start_group);
+    // Same samples as "gen", computed several groups at a time.
+    random::BatchedPhiloxRandom<kPhiloxBlocksPerBatch> batched_gen(gen);
     int64 offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64 limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64 index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(&batched_gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -95,7 +100,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64 remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(&batched_gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
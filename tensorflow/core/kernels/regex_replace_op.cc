@@ -52,12 +52,14 @@ class RegexReplaceOp : public OpKernel {
                                         rewrite_tensor->shape().DebugString()));
     const string rewrite = rewrite_tensor->flat<string>()(0);
 
+    // Rewrites the input in place when nothing else uses it.
     Tensor* output_tensor = nullptr;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
-                                             &output_tensor));
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, input_tensor->shape(), &output_tensor));
     auto output_flat = output_tensor->flat<string>();
+    const bool forwarded = output_flat.data() == input_flat.data();
     for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = input_flat(i);
+      if (!forwarded) output_flat(i) = input_flat(i);
       if (replace_global_) {
         RE2::GlobalReplace(&output_flat(i), match, rewrite);
       } else {
@@ -18,16 +18,29 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/remote_fused_graph_execute_info.pb.h"
 #include "tensorflow/core/kernels/i_remote_fused_graph_executor.h"
+#include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/remote_fused_graph_execute_utils.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
-class RemoteFusedGraphExecuteOp : public OpKernel {
+// The remote processor runs one graph at a time and the executors aren't
+// thread-safe, so executions are queued on a thread of this op: the calling
+// thread is released while the remote processor works, and can prepare the
+// inputs of the next execution meanwhile.
+class RemoteFusedGraphExecuteOp : public AsyncOpKernel {
  public:
   explicit RemoteFusedGraphExecuteOp(OpKernelConstruction* const ctx)
-      : OpKernel(ctx), execute_info_() {
+      : AsyncOpKernel(ctx),
+        execute_info_(),
+        thread_pool_(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(),
+            strings::StrCat("remote_fused_graph_execute_",
+                            SanitizeThreadSuffix(name())),
+            1 /* num_threads */, false /* low_latency_hint */)) {
     string serialized_proto;
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(RemoteFusedGraphExecuteUtils::
@@ -62,6 +75,8 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
   }
 
   ~RemoteFusedGraphExecuteOp() final {
+    // Wait for the queued executions.
+    thread_pool_.reset();
     if (remote_fused_graph_executor_) {
       // 6. Teardown graph in remote processor
       remote_fused_graph_executor_->TeardownGraph();
@@ -71,7 +86,17 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
     }
   }
 
-  void Compute(OpKernelContext* const ctx) final {
+  void ComputeAsync(OpKernelContext* const ctx, DoneCallback done) final {
+    thread_pool_->Schedule([this, ctx, done]() {
+      Execute(ctx);
+      done();
+    });
+  }
+
+  bool IsExpensive() final { return true; }
+
+ private:
+  void Execute(OpKernelContext* const ctx) {
     CHECK(ctx != nullptr);
     const int input_count = ctx->num_inputs();
     const int graph_input_count = execute_info_.graph_input_node_name_size();
@@ -120,10 +145,8 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
     }
   }
 
-  bool IsExpensive() final { return true; }
-
- private:
   RemoteFusedGraphExecuteInfo execute_info_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
   std::unique_ptr<IRemoteFusedGraphExecutor> remote_fused_graph_executor_;
   DataTypeVector input_types_;
   DataTypeVector output_types_;
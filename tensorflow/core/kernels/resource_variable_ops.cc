@@ -402,8 +402,8 @@ class AssignUpdateVariableOp : public OpKernel {
     // ADD if value's refcount was 1.
     mutex_lock ml(*variable->mu());
     Tensor* var_tensor = variable->tensor();
-    OP_REQUIRES_OK(context,
-                   PrepareToUpdateVariable<Device, T>(context, var_tensor));
+    OP_REQUIRES_OK(context, PrepareToUpdateVariable<Device, T>(
+                                context, var_tensor, variable->spare_tensor()));
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
@@ -601,7 +601,8 @@ class ResourceScatterUpdateOp : public OpKernel {
     core::ScopedUnref unref_v(v);
     mutex_lock ml(*v->mu());
     Tensor* params = v->tensor();
-    OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, params));
+    OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, params,
+                                                         v->spare_tensor()));
     const Tensor& indices = c->input(1);
     const Tensor& updates = c->input(2);
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -226,6 +228,35 @@ void RestoreTensor(OpKernelContext* context,
 #undef READER_COPY
 }
 
+namespace {
+
+// Each thread of a restore split across the CPU worker threads reads about
+// this many bytes or more.
+constexpr int64 kMinBytesPerRestoreShard = 16 << 20;
+
+// Reads the (full or sliced) tensors sorted_name_idx[begin, end) from
+// "reader" into the already-allocated outputs "restored_tensors".
+Status RestoreTensorRange(BundleReader* reader,
+                          const std::vector<size_t>& sorted_name_idx,
+                          int64 begin, int64 end,
+                          const TTypes<string>::ConstFlat& tensor_names_flat,
+                          const std::vector<TensorSlice>& parsed_slices,
+                          const std::vector<Tensor*>& restored_tensors) {
+  for (int64 j = begin; j < end; ++j) {
+    const size_t i = sorted_name_idx[j];
+    const string& tensor_name = tensor_names_flat(i);
+    if (parsed_slices[i].IsFull()) {
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, restored_tensors[i]));
+    } else {
+      TF_RETURN_IF_ERROR(reader->LookupSlice(tensor_name, parsed_slices[i],
+                                             restored_tensors[i]));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
@@ -234,9 +265,10 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
 
   const auto& tensor_names_flat = tensor_names.flat<string>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
+  const int64 num_tensors = tensor_names_flat.size();
 
   // Sort lookup keys to improve locality when reading multiple tensors.
-  std::vector<size_t> sorted_name_idx(tensor_names_flat.size());
+  std::vector<size_t> sorted_name_idx(num_tensors);
   std::iota(sorted_name_idx.begin(), sorted_name_idx.end(), 0);
   std::sort(sorted_name_idx.begin(), sorted_name_idx.end(),
             [&tensor_names_flat](size_t a, size_t b) {
@@ -246,32 +278,39 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   BundleReader reader(Env::Default(), prefix_string);
   TF_RETURN_IF_ERROR(reader.status());
 
-  // TODO(zongheng): potential optimization: one Seek() in first lookup.
-  // TODO(zongheng): consider measuring speed and issuing concurrent lookups
-  // within a fixed memory budget.
-  TensorShape restored_full_shape;
-  Tensor* restored_tensor = nullptr;
+  // Validates the requests and allocates all the outputs up front, so that
+  // the reads below only fill in existing buffers.
+  std::vector<TensorSlice> parsed_slices(num_tensors);
+  std::vector<Tensor*> restored_tensors(num_tensors, nullptr);
+  int64 total_bytes = 0;
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
 
-    TF_RETURN_IF_ERROR(
-        reader.LookupTensorShape(tensor_name, &restored_full_shape));
+    DataType restored_dtype;
+    TensorShape restored_full_shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(tensor_name, &restored_dtype,
+                                                  &restored_full_shape));
+    if (dtypes[i] != restored_dtype) {
+      return errors::InvalidArgument(
+          "tensor_name = ", tensor_name, "; expected dtype ",
+          DataTypeString(dtypes[i]), " does not equal restored dtype ",
+          DataTypeString(restored_dtype));
+    }
 
     if (shape_and_slice.empty()) {
       // Lookup the full tensor.
-      TF_RETURN_IF_ERROR(
-          context->allocate_output(i, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+      parsed_slices[i] = TensorSlice(restored_full_shape.dims());
+      TF_RETURN_IF_ERROR(context->allocate_output(i, restored_full_shape,
+                                                  &restored_tensors[i]));
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
-      TensorSlice parsed_slice;
       TensorShape parsed_slice_shape;
 
-      TF_RETURN_IF_ERROR(
-          checkpoint::ParseShapeAndSlice(shape_and_slice, &parsed_full_shape,
-                                         &parsed_slice, &parsed_slice_shape));
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(
+          shape_and_slice, &parsed_full_shape, &parsed_slices[i],
+          &parsed_slice_shape));
       if (!restored_full_shape.IsSameSize(parsed_full_shape)) {
         return errors::InvalidArgument(
             "tensor_name = ", tensor_name, "; shape in shape_and_slice spec ",
@@ -279,18 +318,61 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
             " does not match the shape stored in checkpoint: ",
             restored_full_shape.DebugString());
       }
-
-      TF_RETURN_IF_ERROR(
-          context->allocate_output(i, parsed_slice_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(
-          reader.LookupSlice(tensor_name, parsed_slice, restored_tensor));
+      TF_RETURN_IF_ERROR(context->allocate_output(i, parsed_slice_shape,
+                                                  &restored_tensors[i]));
     }
-    if (dtypes[i] != restored_tensor->dtype()) {
-      return errors::InvalidArgument(
-          "tensor_name = ", tensor_name, "; expected dtype ",
-          DataTypeString(dtypes[i]), " does not equal restored dtype ",
-          DataTypeString(restored_tensor->dtype()));
+    total_bytes += restored_tensors[i]->TotalBytes();
+  }
+
+  // Splits the sorted tensors into contiguous groups of roughly equal size,
+  // each read by its own BundleReader (a reader is not thread-safe). Every
+  // group keeps the sorted order, so its reads stay sequential in the data
+  // files, while the groups overlap their I/O and checksumming.
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64 num_shards = std::min<int64>(
+      {static_cast<int64>(worker_threads.num_threads), num_tensors,
+       total_bytes / kMinBytesPerRestoreShard});
+  if (num_shards <= 1) {
+    return RestoreTensorRange(&reader, sorted_name_idx, 0, num_tensors,
+                              tensor_names_flat, parsed_slices,
+                              restored_tensors);
+  }
+
+  std::vector<int64> shard_starts = {0};
+  int64 bytes_so_far = 0;
+  for (int64 j = 0; j < num_tensors; ++j) {
+    if (bytes_so_far * num_shards >=
+            total_bytes * static_cast<int64>(shard_starts.size()) &&
+        shard_starts.back() < j) {
+      shard_starts.push_back(j);
     }
+    bytes_so_far += restored_tensors[sorted_name_idx[j]]->TotalBytes();
+  }
+  shard_starts.push_back(num_tensors);
+
+  const int64 num_groups = shard_starts.size() - 1;
+  std::vector<Status> statuses(num_groups);
+  BlockingCounter counter(num_groups - 1);
+  for (int64 g = 1; g < num_groups; ++g) {
+    worker_threads.workers->Schedule([&, g]() {
+      BundleReader group_reader(Env::Default(), prefix_string);
+      statuses[g] = group_reader.status();
+      if (statuses[g].ok()) {
+        statuses[g] = RestoreTensorRange(
+            &group_reader, sorted_name_idx, shard_starts[g],
+            shard_starts[g + 1], tensor_names_flat, parsed_slices,
+            restored_tensors);
+      }
+      counter.DecrementCount();
+    });
+  }
+  statuses[0] =
+      RestoreTensorRange(&reader, sorted_name_idx, 0, shard_starts[1],
+                         tensor_names_flat, parsed_slices, restored_tensors);
+  counter.Wait();
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
   }
   return Status::OK();
 }
@@ -172,7 +172,8 @@ class ScatterNdUpdateOp : public OpKernel {
       Var* v;
       OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
       Tensor* t = v->tensor();
-      OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, t));
+      OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, t,
+                                                           v->spare_tensor()));
       params = *t;
       params_shape = params.shape();
     } else if (IsRefType(c->input_dtype(0))) {
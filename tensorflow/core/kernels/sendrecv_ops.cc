@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/tracing.h"
 
 namespace tensorflow {
 
@@ -178,6 +179,21 @@ void RecvOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   args.device_context = ctx->op_device_context();
   args.alloc_attrs = ctx->output_alloc_attr(0);
 
+  // Devices only trace synchronous kernels, so cover the wait for the tensor
+  // here.
+  if (tracing::GetTraceCollector() != nullptr) {
+    auto* activity = new tracing::ScopedActivity("Recv", parsed_key_.buf_,
+                                                 /*is_expensive=*/false);
+    if (activity->IsEnabled()) {
+      done = [activity, done]() {
+        delete activity;
+        done();
+      };
+    } else {
+      delete activity;
+    }
+  }
+
   FrameAndIter frame_iter = GetFrameAndIter(ctx, hostmem_sendrecv_);
   if (frame_iter == FrameAndIter(0, 0)) {
     VLOG(2) << "Recv " << parsed_key_.buf_;
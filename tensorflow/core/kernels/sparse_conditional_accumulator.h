@@ -16,7 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SPARSE_CONDITIONAL_ACCUMULATOR_H_
 #define TENSORFLOW_KERNELS_SPARSE_CONDITIONAL_ACCUMULATOR_H_
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 #include "tensorflow/core/kernels/typed_conditional_accumulator_base.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -42,6 +48,11 @@ namespace tensorflow {
  * SparseConditionalAccumulator is the datatype-dependent templated sub-class of
  * ConditionalAccumulatorBase. It implements the virtual arithmetic methods that
  * are used by for aggregating, averaging, allocating, returning indexed slices.
+ *
+ * The accumulated rows are kept in the order in which their indices first
+ * appeared, with a hash map from index to row, so that applying a gradient
+ * only touches the rows of that gradient, and the rows are only sorted by
+ * index when the average is taken.
  */
 template <typename Device, typename T>
 class SparseConditionalAccumulator
@@ -70,17 +81,14 @@ class SparseConditionalAccumulator
  protected:
   std::vector<int64>* accum_idx_vec_ = nullptr;
   std::vector<int>* count_element_ = nullptr;
+  // Maps each index in accum_idx_vec_ to its position.
+  gtl::FlatMap<int64, int64> accum_idx_to_row_;
 
+  // The first accum_idx_vec_->size() rows hold the accumulated values; the
+  // others are spare capacity for the rows of later gradients.
   Tensor* accum_val_ = nullptr;
   PersistentTensor* accum_val_persistent_ = nullptr;
 
-  typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                           Eigen::Unaligned>
-      SliceT;
-  typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
-                           Eigen::Unaligned>
-      SliceConstT;
-
   Status ValidateShape(
       std::tuple<const Tensor*, const Tensor*, const Tensor*>* tensor,
       bool has_known_shape) EXCLUSIVE_LOCKS_REQUIRED(this->mu_) {
@@ -158,197 +166,144 @@ class SparseConditionalAccumulator
   void AllocateAndAssignToAccumGradFunction(
       OpKernelContext* ctx,
       std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad) override {
-    const Tensor* grad_idx = std::get<0>(*grad);
-    const Tensor* grad_val = std::get<1>(*grad);
-
-    const int64 nnz = grad_idx->dim_size(0);
-
-    // Assign indices
-    if (accum_idx_vec_ != nullptr) delete accum_idx_vec_;
-    accum_idx_vec_ = new std::vector<int64>();
-    accum_idx_vec_->reserve(nnz);
-    for (int i = 0; i < nnz; i++) {
-      accum_idx_vec_->push_back(grad_idx->vec<int64>()(i));
-    }
-
-    // Assign values to accum_val_tensor
-    // TODO(b/32704451): Don't just ignore the ::tensorflow::Status object!
-    ctx->allocate_persistent(dtype_, grad_val->shape(), accum_val_persistent_,
-                             &accum_val_)
-        .IgnoreError();
-    accum_val_->flat<T>().device(ctx->template eigen_device<Device>()) =
-        grad_val->flat<T>();
-
-    // Assign count_element_
-    if (count_element_ != nullptr) {
-      delete count_element_;
+    if (accum_idx_vec_ == nullptr) accum_idx_vec_ = new std::vector<int64>();
+    if (count_element_ == nullptr) count_element_ = new std::vector<int>();
+    accum_idx_vec_->clear();
+    count_element_->clear();
+    accum_idx_to_row_.clear();
+    // The values buffer of the previous step is reused if its rows fit.
+    if (accum_val_ != nullptr &&
+        !SameRowShape(*accum_val_, *std::get<1>(*grad))) {
+      accum_val_ = nullptr;
     }
-    count_element_ = new std::vector<int>(nnz, 1);
-
-    // Do not need shape; Assume that the op has checked that the shapes match,
-    // so grad's shape == shape_
+    AddToAccumGradFunction(ctx, grad);
   }
 
   void AddToAccumGradFunction(
       OpKernelContext* ctx,
       std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad) override {
-    // Modeled after third_party/tensorflow/core/kernels/sparse_add_op
-
     const Tensor* grad_idx = std::get<0>(*grad);
     const Tensor* grad_val = std::get<1>(*grad);
-
-    const int64 accum_nnz = accum_idx_vec_->size();
+    const auto grad_idx_vec = grad_idx->vec<int64>();
     const int64 grad_nnz = grad_idx->dim_size(0);
-
-    // Source enumerates the origin of a non-zero element: whether it is from
-    // the new gradient, the accumulated gradient, or the sum of both.
-    enum Source { from_accum, from_grad, from_accum_and_grad };
-
-    // (1) do a pass over inputs, and append values and indices to vectors
-    std::vector<std::tuple<Source, int64, int64>> entries_to_copy;
-    entries_to_copy.reserve(accum_nnz + grad_nnz);
-
-    // Pass over all non-zero elements of both the gradient and the accumulated
-    // value, to identify where each non-zero element of the sum comes from.
-    // The input and output indexed slices are assumed to be ordered along
-    // increasing dimension number.
-    int64 i = 0, j = 0;
-    int64 sum_nnz = 0;
-    while (i < accum_nnz && j < grad_nnz) {
-      sum_nnz++;
-      switch (cmp(accum_idx_vec_, grad_idx, i, j)) {
-        case -1:
-          entries_to_copy.emplace_back(from_accum, i, -1);
-          ++i;
-          break;
-        case 0:
-          entries_to_copy.emplace_back(from_accum_and_grad, i, j);
-          ++i;
-          ++j;
-          break;
-        case 1:
-          entries_to_copy.emplace_back(from_grad, -1, j);
-          ++j;
-          break;
+    const int64 old_nnz = accum_idx_vec_->size();
+
+    // (1) Find the row of each gradient row, appending the new indices.  A
+    // gradient counts once towards each row, even if its index repeats, and
+    // its rows are copied rather than added into new rows of the accumulator.
+    std::vector<int64> rows(grad_nnz);
+    std::vector<bool> copy_row(grad_nnz, false);
+    std::vector<bool> counted(old_nnz, false);
+    bool has_duplicates = false;
+    for (int64 j = 0; j < grad_nnz; ++j) {
+      const int64 index = grad_idx_vec(j);
+      auto it = accum_idx_to_row_.insert(
+          {index, static_cast<int64>(accum_idx_vec_->size())});
+      const int64 row = it.first->second;
+      rows[j] = row;
+      if (it.second) {
+        accum_idx_vec_->push_back(index);
+        count_element_->push_back(1);
+        copy_row[j] = true;
+      } else if (row < old_nnz && !counted[row]) {
+        counted[row] = true;
+        ++(*count_element_)[row];
+      } else {
+        has_duplicates = true;
       }
     }
 
-    // Handle leftovers
-    while (i < accum_nnz) {
-      sum_nnz++;
-      entries_to_copy.emplace_back(from_accum, i, -1);
-      ++i;
-    }
-    while (j < grad_nnz) {
-      sum_nnz++;
-      entries_to_copy.emplace_back(from_grad, -1, j);
-      ++j;
+    // (2) Make room for the new rows.
+    const int64 sum_nnz = accum_idx_vec_->size();
+    if (accum_val_ == nullptr || accum_val_->dim_size(0) < sum_nnz) {
+      TensorShape sum_shape = grad_val->shape();
+      // Grows geometrically, so that the rows are copied O(1) times each.
+      const int64 capacity =
+          accum_val_ == nullptr ? 0 : 2 * accum_val_->dim_size(0);
+      sum_shape.set_dim(0, std::max(sum_nnz, capacity));
+      Tensor* sum_tensor = nullptr;
+      PersistentTensor* sum_persistent = new PersistentTensor();
+      Status s = ctx->allocate_persistent(dtype_, sum_shape, sum_persistent,
+                                          &sum_tensor);
+      if (!s.ok()) {
+        delete sum_persistent;
+        // Forget this gradient.
+        for (int64 i = old_nnz; i < sum_nnz; ++i) {
+          accum_idx_to_row_.erase((*accum_idx_vec_)[i]);
+        }
+        accum_idx_vec_->resize(old_nnz);
+        count_element_->resize(old_nnz);
+        for (int64 row = 0; row < old_nnz; ++row) {
+          if (counted[row]) --(*count_element_)[row];
+        }
+        ctx->CtxFailureWithWarning(s);
+        return;
+      }
+      if (accum_val_ != nullptr && old_nnz > 0) {
+        const T* accum_data = &accum_val_->flat_outer_dims<T>()(0, 0);
+        std::copy(accum_data, accum_data + old_nnz * (accum_val_->NumElements() /
+                                                      accum_val_->dim_size(0)),
+                  &sum_tensor->flat_outer_dims<T>()(0, 0));
+      }
+      accum_val_ = sum_tensor;
+      delete accum_val_persistent_;
+      accum_val_persistent_ = sum_persistent;
     }
 
-    // (2) Copy or sum the non-zero elements into sum_indices and sum_tensor
-    std::vector<int64>* sum_indices_vec = new std::vector<int64>();
-    sum_indices_vec->reserve(sum_nnz);
-
-    std::vector<int>* sum_counts = new std::vector<int>();
-    sum_counts->reserve(sum_nnz);
-
-    Tensor* sum_tensor = nullptr;
-    PersistentTensor* tensor_sum_persistent = new PersistentTensor();
-
-    TensorShape sum_shape = grad_val->shape();
-    sum_shape.set_dim(0, sum_nnz);
-
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_persistent(dtype_, sum_shape, tensor_sum_persistent,
-                                      &sum_tensor));
-    auto sum_flat = sum_tensor->flat_outer_dims<T>();
+    // (3) Copy or add the gradient rows.  Each row is touched once unless the
+    // gradient repeats an index, so the rows can be split among threads.
     auto accum_flat = accum_val_->flat_outer_dims<T>();
-    auto grad_flat = grad_val->flat_outer_dims<T>();
-
+    const auto grad_flat = grad_val->flat_outer_dims<T>();
     const int64 num_col = grad_flat.dimension(1);
-
-    Eigen::DSizes<Eigen::DenseIndex, 1> slice_shape(num_col);
-
-    for (i = 0; i < sum_nnz; ++i) {
-      const Source src = std::get<0>(entries_to_copy[i]);
-      const int64 idx_a = std::get<1>(entries_to_copy[i]);
-      const int64 idx_b = std::get<2>(entries_to_copy[i]);
-      T* sum_slice_ptr = &sum_flat(i, 0);
-      SliceT sum_slice(sum_slice_ptr, slice_shape);
-      if (src == from_accum) {
-        // Element comes from accumulator; directly copy data structures over
-        sum_indices_vec->push_back(accum_idx_vec_->at(idx_a));
-        T* accum_slice_ptr = &accum_flat(idx_a, 0);
-        SliceT accum_slice(accum_slice_ptr, slice_shape);
-        sum_slice = accum_slice;
-        sum_counts->push_back(count_element_->at(idx_a));
-      } else if (src == from_accum_and_grad) {
-        // Element is a sum of accumulated value and new gradient;
-        // compute sum here
-        sum_indices_vec->push_back(accum_idx_vec_->at(idx_a));
-        const T* grad_slice_ptr = &grad_flat(idx_b, 0);
-        SliceConstT grad_slice(grad_slice_ptr, slice_shape);
-        T* accum_slice_ptr = &accum_flat(idx_a, 0);
-        SliceT accum_slice(accum_slice_ptr, slice_shape);
-        sum_slice = grad_slice + accum_slice;
-        sum_counts->push_back(count_element_->at(idx_a) + 1);
-      } else if (src == from_grad) {
-        // Element comes from new gradient; make a copy of indices and values
-        sum_indices_vec->push_back(grad_idx->vec<int64>()(idx_b));
-        const T* grad_slice_ptr = &grad_flat(idx_b, 0);
-        SliceConstT grad_slice(grad_slice_ptr, slice_shape);
-        sum_slice = grad_slice;
-        sum_counts->push_back(1);
+    auto add_rows = [&](int64 begin, int64 end) {
+      for (int64 j = begin; j < end; ++j) {
+        T* accum_row = &accum_flat(rows[j], 0);
+        const T* grad_row = &grad_flat(j, 0);
+        if (copy_row[j]) {
+          std::copy(grad_row, grad_row + num_col, accum_row);
+        } else {
+          for (int64 k = 0; k < num_col; ++k) accum_row[k] += grad_row[k];
+        }
       }
+    };
+    if (has_duplicates) {
+      add_rows(0, grad_nnz);
+    } else {
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, grad_nnz,
+            num_col * sizeof(T), add_rows);
     }
-
-    // (3) Keep output, i.e., switch pointers to point to new data structures
-    // representing the sum
-    // Indices
-    if (accum_idx_vec_ != nullptr) delete accum_idx_vec_;
-    accum_idx_vec_ = sum_indices_vec;
-    // Values
-    accum_val_ = sum_tensor;
-    delete accum_val_persistent_;
-    accum_val_persistent_ = tensor_sum_persistent;
-    // Counts
-    if (count_element_ != nullptr) delete count_element_;
-    count_element_ = sum_counts;
-
-    // No need to copy shape, since shape remains the same after sum.
   }
 
   void DivideAccumGradByCounter(OpKernelContext* ctx) override
       EXCLUSIVE_LOCKS_REQUIRED(this->mu_) {
+    // Average element-wise: each row by the number of gradients that had it.
     const int64 nnz = count_element_->size();
     auto accum_flat = accum_val_->flat_outer_dims<T>();
-    std::vector<T> count_typet;
-    std::transform(count_element_->begin(), count_element_->end(),
-                   std::back_inserter(count_typet),
-                   TypeConverter<T, int>::ConvertUToT);
-
-    // Option 1: divide all by counter
-    /*
-    std::transform(
-        &accum_flat(0,0), &accum_flat(nnz,0), &accum_flat(0,0),
-        std::bind2nd(std::divides<T>(),
-                     TypeConverter<T, int>::ConvertUToT(this->counter_)));
-    */
-
-    // Option 2: average element-wise
-    Eigen::DSizes<Eigen::DenseIndex, 1> slice_shape(accum_flat.dimension(1));
-    for (int64 i = 0; i < nnz; i++) {
-      T* accum_slice_ptr = &accum_flat(i, 0);
-      SliceT accum_slice(accum_slice_ptr, slice_shape);
-      accum_slice.device(ctx->template eigen_device<Device>()) =
-          accum_slice / count_typet[i];
-    }
+    const int64 num_col = accum_flat.dimension(1);
+    auto divide_rows = [this, &accum_flat, num_col](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const T count =
+            TypeConverter<T, int>::ConvertUToT((*count_element_)[i]);
+        T* accum_row = &accum_flat(i, 0);
+        for (int64 k = 0; k < num_col; ++k) accum_row[k] /= count;
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, nnz,
+          num_col * sizeof(T), divide_rows);
   }
 
   bool SetOutput(OpKernelContext* ctx) override {
+    // The average is returned in increasing order of indices.
+    std::vector<int64> order(accum_idx_vec_->size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int64 a, int64 b) {
+      return (*accum_idx_vec_)[a] < (*accum_idx_vec_)[b];
+    });
     bool is_successful = true;
-    if (is_successful) is_successful = ReturnIdxTensor(ctx);
-    if (is_successful) is_successful = ReturnValTensor(ctx);
+    if (is_successful) is_successful = ReturnIdxTensor(ctx, order);
+    if (is_successful) is_successful = ReturnValTensor(ctx, order);
     if (is_successful) is_successful = ReturnShapeTensor(ctx);
     return is_successful;
   }
@@ -407,33 +362,49 @@ class SparseConditionalAccumulator
   }
 
  private:
-  inline int cmp(std::vector<int64>* a_idx, const Tensor* b_idx,
-                 const int64 a_row, const int64 b_row) {
-    const int64 a = a_idx->at(a_row);
-    const int64 b = b_idx->vec<int64>()(b_row);
-    if (a < b) {
-      return -1;
-    } else if (a > b) {
-      return 1;
+  // Returns true if the rows of "a" and "b" have the same shape.
+  static bool SameRowShape(const Tensor& a, const Tensor& b) {
+    if (a.dims() != b.dims()) return false;
+    for (int i = 1; i < a.dims(); ++i) {
+      if (a.dim_size(i) != b.dim_size(i)) return false;
     }
-    return 0;
+    return true;
   }
 
-  inline bool ReturnIdxTensor(OpKernelContext* ctx) {
+  inline bool ReturnIdxTensor(OpKernelContext* ctx,
+                              const std::vector<int64>& order) {
     Tensor* idx_tensor;
-    const int64 nnz = accum_idx_vec_->size();
+    const int64 nnz = order.size();
     OP_REQUIRES_OK_BOOLEAN(ctx, ctx->allocate_output(0, {nnz}, &idx_tensor));
     // If allocate_output fails, OP_REQUIRES_OK_BOOLEAN will short-circuit
     // the remaining code and just return false
     auto idx_tensor_vec = idx_tensor->vec<int64>();
-    for (int i = 0; i < nnz; ++i) {
-      idx_tensor_vec(i) = accum_idx_vec_->at(i);
+    for (int64 i = 0; i < nnz; ++i) {
+      idx_tensor_vec(i) = (*accum_idx_vec_)[order[i]];
     }
     return true;
   }
 
-  inline bool ReturnValTensor(OpKernelContext* ctx) {
-    ctx->set_output(1, *accum_val_);
+  inline bool ReturnValTensor(OpKernelContext* ctx,
+                              const std::vector<int64>& order) {
+    const int64 nnz = order.size();
+    TensorShape val_shape = accum_val_->shape();
+    val_shape.set_dim(0, nnz);
+    Tensor* val_tensor;
+    OP_REQUIRES_OK_BOOLEAN(ctx,
+                           ctx->allocate_output(1, val_shape, &val_tensor));
+    const auto accum_flat = accum_val_->flat_outer_dims<T>();
+    auto val_flat = val_tensor->flat_outer_dims<T>();
+    const int64 num_col = accum_flat.dimension(1);
+    auto copy_rows = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const T* accum_row = &accum_flat(order[i], 0);
+        std::copy(accum_row, accum_row + num_col, &val_flat(i, 0));
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, nnz,
+          num_col * sizeof(T), copy_rows);
     return true;
   }
 
@@ -340,10 +340,11 @@ class SparseCrossOp : public OpKernel {
     };
 
     auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
-    // TODO(zakaria): optimize kCostPerUnit
+    // Initial guess only: the number of crosses per row varies with the
+    // inputs, so the sharding follows the measured cost instead.
     const int kCostPerUnit = 5000 * indices_list_in.size();
-    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
-          kCostPerUnit, do_work);
+    AdaptiveShard(worker_threads->num_threads, worker_threads->workers,
+                  batch_size, kCostPerUnit, &cost_model_, do_work);
   }
 
  private:
@@ -551,6 +552,7 @@ class SparseCrossOp : public OpKernel {
   }
   int64 num_buckets_;
   uint64 hash_key_;
+  ShardCostModel cost_model_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("SparseCross")
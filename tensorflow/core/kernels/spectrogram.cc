@@ -75,6 +75,7 @@ bool Spectrogram::Initialize(const std::vector<double>& window,
   // but keep it as a reminder.
   fft_integer_working_area_[0] = 0;
   input_queue_.clear();
+  input_queue_.reserve(window_length_ + step_length_);
   samples_to_next_step_ = window_length_;
   initialized_ = true;
   return true;
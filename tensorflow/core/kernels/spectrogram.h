@@ -32,7 +32,6 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_SPECTROGRAM_H_
 
 #include <complex>
-#include <deque>
 #include <vector>
 
 #include "third_party/fft2d/fft.h"
@@ -98,7 +97,9 @@ class Spectrogram {
 
   std::vector<double> window_;
   std::vector<double> fft_input_output_;
-  std::deque<double> input_queue_;
+  // The buffered samples, which are contiguous so that windowing them is a
+  // vectorizable loop.
+  std::vector<double> input_queue_;
 
   // Working data areas for the FFT routines.
   std::vector<int> fft_integer_working_area_;
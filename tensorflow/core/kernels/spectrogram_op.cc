@@ -15,16 +15,91 @@ limitations under the License.
 
 // See docs in ../ops/audio_ops.cc
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/spectrogram.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Feeds the channels of the [samples, channels] 'input' to 'spectrograms',
+// one per channel, and outputs the frames they produce as a
+// [channels, frames, frequencies] tensor.
+void ComputeSpectrograms(OpKernelContext* context, const Tensor& input,
+                         bool magnitude_squared,
+                         const std::vector<std::unique_ptr<Spectrogram>>&
+                             spectrograms) {
+  const auto input_as_matrix = input.matrix<float>();
+  const int64 sample_count = input.dim_size(0);
+  const int64 channel_count = input.dim_size(1);
+  DCHECK_EQ(channel_count, spectrograms.size());
+
+  std::vector<float> input_for_channel(sample_count);
+  std::vector<std::vector<std::vector<float>>> spectrogram_outputs(
+      channel_count);
+  for (int64 channel = 0; channel < channel_count; ++channel) {
+    for (int i = 0; i < sample_count; ++i) {
+      input_for_channel[i] = input_as_matrix(i, channel);
+    }
+    OP_REQUIRES(context,
+                spectrograms[channel]->ComputeSquaredMagnitudeSpectrogram(
+                    input_for_channel, &spectrogram_outputs[channel]),
+                errors::InvalidArgument("Spectrogram compute failed"));
+  }
+
+  const int64 output_height =
+      channel_count == 0 ? 0 : spectrogram_outputs[0].size();
+  const int64 output_width =
+      channel_count == 0 ? 0 : spectrograms[0]->output_frequency_channels();
+  Tensor* output_tensor = nullptr;
+  OP_REQUIRES_OK(
+      context,
+      context->allocate_output(
+          0, TensorShape({channel_count, output_height, output_width}),
+          &output_tensor));
+  auto output_flat = output_tensor->flat<float>().data();
+  for (int64 channel = 0; channel < channel_count; ++channel) {
+    const std::vector<std::vector<float>>& spectrogram_output =
+        spectrogram_outputs[channel];
+    OP_REQUIRES(context, (spectrogram_output.size() == output_height),
+                errors::InvalidArgument(
+                    "Spectrogram size calculation failed: Expected height ",
+                    output_height, " but got ", spectrogram_output.size()));
+    float* output_slice =
+        output_flat + (channel * output_height * output_width);
+    for (int row_index = 0; row_index < output_height; ++row_index) {
+      const std::vector<float>& spectrogram_row =
+          spectrogram_output[row_index];
+      DCHECK_EQ(spectrogram_row.size(), output_width);
+      float* output_row = output_slice + (row_index * output_width);
+      if (magnitude_squared) {
+        for (int i = 0; i < output_width; ++i) {
+          output_row[i] = spectrogram_row[i];
+        }
+      } else {
+        for (int i = 0; i < output_width; ++i) {
+          output_row[i] = sqrtf(spectrogram_row[i]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
 // Create a spectrogram frequency visualization from audio data.
 class AudioSpectrogramOp : public OpKernel {
  public:
@@ -41,81 +116,167 @@ class AudioSpectrogramOp : public OpKernel {
     OP_REQUIRES(context, input.dims() == 2,
                 errors::InvalidArgument("input must be 2-dimensional",
                                         input.shape().DebugString()));
-    Spectrogram spectrogram;
-    OP_REQUIRES(context, spectrogram.Initialize(window_size_, stride_),
-                errors::InvalidArgument(
-                    "Spectrogram initialization failed for window size ",
-                    window_size_, " and stride ", stride_));
+    // Each channel is a separate waveform, which starts with an empty
+    // buffer.
+    std::vector<std::unique_ptr<Spectrogram>> spectrograms;
+    for (int64 channel = 0; channel < input.dim_size(1); ++channel) {
+      spectrograms.emplace_back(new Spectrogram);
+      OP_REQUIRES(context,
+                  spectrograms.back()->Initialize(window_size_, stride_),
+                  errors::InvalidArgument(
+                      "Spectrogram initialization failed for window size ",
+                      window_size_, " and stride ", stride_));
+    }
+    ComputeSpectrograms(context, input, magnitude_squared_, spectrograms);
+  }
 
-    const auto input_as_matrix = input.matrix<float>();
+ private:
+  int32 window_size_;
+  int32 stride_;
+  bool magnitude_squared_;
+};
+REGISTER_KERNEL_BUILDER(Name("AudioSpectrogram").Device(DEVICE_CPU),
+                        AudioSpectrogramOp);
 
-    const int64 sample_count = input.dim_size(0);
-    const int64 channel_count = input.dim_size(1);
+// The state of a streaming spectrogram: the samples of each channel that
+// are buffered for the next frames. The Spectrogram objects also keep their
+// FFT tables between the chunks.
+class SpectrogramStream : public ResourceBase {
+ public:
+  SpectrogramStream(int32 window_size, int32 stride)
+      : window_size_(window_size), stride_(stride) {}
 
-    const int64 output_width = spectrogram.output_frequency_channels();
-    const int64 length_minus_window = (sample_count - window_size_);
-    int64 output_height;
-    if (length_minus_window < 0) {
-      output_height = 0;
-    } else {
-      output_height = 1 + (length_minus_window / stride_);
-    }
-    const int64 output_slices = channel_count;
-
-    Tensor* output_tensor = nullptr;
-    OP_REQUIRES_OK(
-        context,
-        context->allocate_output(
-            0, TensorShape({output_slices, output_height, output_width}),
-            &output_tensor));
-    auto output_flat = output_tensor->flat<float>().data();
-
-    std::vector<float> input_for_channel(sample_count);
-    for (int64 channel = 0; channel < channel_count; ++channel) {
-      float* output_slice =
-          output_flat + (channel * output_height * output_width);
-      for (int i = 0; i < sample_count; ++i) {
-        input_for_channel[i] = input_as_matrix(i, channel);
-      }
-      std::vector<std::vector<float>> spectrogram_output;
-      OP_REQUIRES(context,
-                  spectrogram.ComputeSquaredMagnitudeSpectrogram(
-                      input_for_channel, &spectrogram_output),
-                  errors::InvalidArgument("Spectrogram compute failed"));
-      OP_REQUIRES(context, (spectrogram_output.size() == output_height),
-                  errors::InvalidArgument(
-                      "Spectrogram size calculation failed: Expected height ",
-                      output_height, " but got ", spectrogram_output.size()));
-      OP_REQUIRES(context,
-                  spectrogram_output.empty() ||
-                      (spectrogram_output[0].size() == output_width),
-                  errors::InvalidArgument(
-                      "Spectrogram size calculation failed: Expected width ",
-                      output_width, " but got ", spectrogram_output[0].size()));
-      for (int row_index = 0; row_index < output_height; ++row_index) {
-        const std::vector<float>& spectrogram_row =
-            spectrogram_output[row_index];
-        DCHECK_EQ(spectrogram_row.size(), output_width);
-        float* output_row = output_slice + (row_index * output_width);
-        if (magnitude_squared_) {
-          for (int i = 0; i < output_width; ++i) {
-            output_row[i] = spectrogram_row[i];
-          }
-        } else {
-          for (int i = 0; i < output_width; ++i) {
-            output_row[i] = sqrtf(spectrogram_row[i]);
-          }
+  string DebugString() override {
+    return strings::StrCat("SpectrogramStream[window_size=", window_size_,
+                           ", stride=", stride_, "]");
+  }
+
+  int32 window_size() const { return window_size_; }
+  int32 stride() const { return stride_; }
+
+  mutex* mu() { return &mu_; }
+
+  // Returns the spectrograms of the 'channel_count' channels of the stream,
+  // which is started by the first chunk.
+  Status GetSpectrograms(int64 channel_count,
+                         const std::vector<std::unique_ptr<Spectrogram>>**
+                             spectrograms) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (spectrograms_.empty()) {
+      for (int64 channel = 0; channel < channel_count; ++channel) {
+        spectrograms_.emplace_back(new Spectrogram);
+        if (!spectrograms_.back()->Initialize(window_size_, stride_)) {
+          spectrograms_.clear();
+          return errors::InvalidArgument(
+              "Spectrogram initialization failed for window size ",
+              window_size_, " and stride ", stride_);
         }
       }
+    } else if (spectrograms_.size() != channel_count) {
+      return errors::InvalidArgument("The stream has ", spectrograms_.size(),
+                                     " channels, but got a chunk with ",
+                                     channel_count, " channels.");
     }
+    *spectrograms = &spectrograms_;
+    return Status::OK();
+  }
+
+  // Drops the buffered samples, so that the next chunk starts a new stream.
+  void Reset() EXCLUSIVE_LOCKS_REQUIRED(mu_) { spectrograms_.clear(); }
+
+ private:
+  const int32 window_size_;
+  const int32 stride_;
+  mutex mu_;
+  std::vector<std::unique_ptr<Spectrogram>> spectrograms_ GUARDED_BY(mu_);
+};
+
+class AudioSpectrogramStreamOp : public ResourceOpKernel<SpectrogramStream> {
+ public:
+  explicit AudioSpectrogramStreamOp(OpKernelConstruction* context)
+      : ResourceOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("window_size", &window_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("stride", &stride_));
+    OP_REQUIRES(context, window_size_ > 1 && stride_ > 0,
+                errors::InvalidArgument(
+                    "Invalid window size ", window_size_, " and stride ",
+                    stride_, " for a spectrogram stream."));
   }
 
  private:
+  Status CreateResource(SpectrogramStream** resource) override
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *resource = new SpectrogramStream(window_size_, stride_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(SpectrogramStream* resource) override {
+    if (resource->window_size() != window_size_ ||
+        resource->stride() != stride_) {
+      return errors::InvalidArgument(
+          "Shared spectrogram stream has window size ",
+          resource->window_size(), " and stride ", resource->stride(),
+          " but requested ", window_size_, " and ", stride_);
+    }
+    return Status::OK();
+  }
+
   int32 window_size_;
   int32 stride_;
+};
+REGISTER_KERNEL_BUILDER(Name("AudioSpectrogramStream").Device(DEVICE_CPU),
+                        AudioSpectrogramStreamOp);
+
+// Computes the frames of a spectrogram stream that a chunk completes, with
+// the samples buffered from the previous chunks, so that the overlapping
+// windows are not recomputed.
+class AudioSpectrogramStreamComputeOp : public OpKernel {
+ public:
+  explicit AudioSpectrogramStreamComputeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("magnitude_squared", &magnitude_squared_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    SpectrogramStream* stream;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0),
+                                  &stream));
+    core::ScopedUnref unref(stream);
+    const Tensor& input = context->input(1);
+    OP_REQUIRES(context, input.dims() == 2,
+                errors::InvalidArgument("input must be 2-dimensional",
+                                        input.shape().DebugString()));
+    mutex_lock l(*stream->mu());
+    const std::vector<std::unique_ptr<Spectrogram>>* spectrograms;
+    OP_REQUIRES_OK(context,
+                   stream->GetSpectrograms(input.dim_size(1), &spectrograms));
+    ComputeSpectrograms(context, input, magnitude_squared_, *spectrograms);
+  }
+
+ private:
   bool magnitude_squared_;
 };
-REGISTER_KERNEL_BUILDER(Name("AudioSpectrogram").Device(DEVICE_CPU),
-                        AudioSpectrogramOp);
+REGISTER_KERNEL_BUILDER(
+    Name("AudioSpectrogramStreamCompute").Device(DEVICE_CPU),
+    AudioSpectrogramStreamComputeOp);
+
+class AudioSpectrogramStreamResetOp : public OpKernel {
+ public:
+  explicit AudioSpectrogramStreamResetOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    SpectrogramStream* stream;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0),
+                                  &stream));
+    core::ScopedUnref unref(stream);
+    mutex_lock l(*stream->mu());
+    stream->Reset();
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("AudioSpectrogramStreamReset").Device(DEVICE_CPU),
+                        AudioSpectrogramStreamResetOp);
 
 }  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/audio_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/cc/ops/math_ops.h"
@@ -101,6 +102,78 @@ TEST(SpectrogramOpTest, SquaredTest) {
       test::AsTensor<float>({0, 1, 4, 1, 0}, TensorShape({1, 1, 5})), 1e-3);
 }
 
+TEST(SpectrogramOpTest, StreamMatchesWholeWaveform) {
+  Scope root = Scope::NewRootScope();
+
+  // Two channels of 20 samples, which have 4 windows of 8 with a stride of 4.
+  Tensor audio_tensor(DT_FLOAT, TensorShape({20, 2}));
+  Tensor chunk_tensors[2] = {Tensor(DT_FLOAT, TensorShape({10, 2})),
+                             Tensor(DT_FLOAT, TensorShape({10, 2}))};
+  for (int i = 0; i < 20; ++i) {
+    const float left = sinf(i * 0.7f);
+    const float right = cosf(i * 0.3f) * 0.5f;
+    audio_tensor.matrix<float>()(i, 0) = left;
+    audio_tensor.matrix<float>()(i, 1) = right;
+    chunk_tensors[i / 10].matrix<float>()(i % 10, 0) = left;
+    chunk_tensors[i / 10].matrix<float>()(i % 10, 1) = right;
+  }
+  Output audio_const_op = Const(root.WithOpName("audio_const_op"),
+                                Input::Initializer(audio_tensor));
+  AudioSpectrogram spectrogram_op =
+      AudioSpectrogram(root.WithOpName("spectrogram_op"), audio_const_op, 8, 4);
+
+  auto chunk = Placeholder(root.WithOpName("chunk"), DT_FLOAT);
+  AudioSpectrogramStream stream_op =
+      AudioSpectrogramStream(root.WithOpName("stream_op"), 8, 4);
+  AudioSpectrogramStreamCompute compute_op = AudioSpectrogramStreamCompute(
+      root.WithOpName("compute_op"), stream_op.handle, chunk);
+  AudioSpectrogramStreamReset reset_op =
+      AudioSpectrogramStreamReset(root.WithOpName("reset_op"), stream_op.handle);
+
+  TF_ASSERT_OK(root.status());
+
+  ClientSession session(root);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session.Run({spectrogram_op.spectrogram}, &outputs));
+  const Tensor expected = outputs[0];
+  ASSERT_EQ(4, expected.dim_size(1));
+  const auto expected_frames = expected.tensor<float, 3>();
+
+  for (int pass = 0; pass < 2; ++pass) {
+    // The first chunk completes one window, and the second chunk completes
+    // the other three with the samples buffered from the first.
+    int frame = 0;
+    for (const Tensor& chunk_tensor : chunk_tensors) {
+      TF_ASSERT_OK(session.Run({{chunk, chunk_tensor}},
+                               {compute_op.spectrogram}, &outputs));
+      const auto frames = outputs[0].tensor<float, 3>();
+      ASSERT_EQ(2, outputs[0].dim_size(0));
+      ASSERT_EQ(expected.dim_size(2), outputs[0].dim_size(2));
+      for (int i = 0; i < outputs[0].dim_size(1); ++i, ++frame) {
+        for (int channel = 0; channel < 2; ++channel) {
+          for (int j = 0; j < expected.dim_size(2); ++j) {
+            EXPECT_NEAR(expected_frames(channel, frame, j),
+                        frames(channel, i, j), 1e-4);
+          }
+        }
+      }
+    }
+    EXPECT_EQ(4, frame);
+    // After a reset, the waveform is streamed again from the start.
+    TF_ASSERT_OK(session.Run(ClientSession::FeedType(), {},
+                             {reset_op.operation}, &outputs));
+  }
+
+  // The stream keeps the channel count of its first chunk.
+  Tensor mono_tensor(DT_FLOAT, TensorShape({10, 1}));
+  mono_tensor.flat<float>().setZero();
+  TF_ASSERT_OK(session.Run({{chunk, chunk_tensors[0]}},
+                           {compute_op.spectrogram}, &outputs));
+  EXPECT_FALSE(session.Run({{chunk, mono_tensor}}, {compute_op.spectrogram},
+                           &outputs)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace ops
 }  // namespace tensorflow
@@ -29,22 +29,35 @@ namespace tensorflow {
 
 namespace {
 
-std::vector<string> Split(const string& str, const string& delimiter,
-                          const bool skipEmpty) {
-  if (!delimiter.empty()) {
-    if (skipEmpty) {
-      return str_util::Split(str, delimiter, str_util::SkipEmpty());
+// Appends the tokens of 'str' to 'tokens', split at any of the bytes for
+// which 'is_delimiter' is true, or its single characters if there are no
+// delimiters. The tokens point into 'str'. Returns the number of tokens.
+int64 Split(StringPiece str, const bool* is_delimiter, bool has_delimiter,
+            bool skip_empty, std::vector<StringPiece>* tokens) {
+  const size_t num_tokens = tokens->size();
+  if (!has_delimiter) {
+    for (size_t i = 0; i < str.size(); ++i) {
+      tokens->emplace_back(str.data() + i, 1);
     }
-    return str_util::Split(str, delimiter);
+    return str.size();
   }
-  std::vector<string> char_vector(str.size());
-  for (size_t i = 0; i < str.size(); ++i) {
-    char_vector[i] = str[i];
+  if (str.empty()) return 0;
+  size_t token_start = 0;
+  for (size_t i = 0; i <= str.size(); ++i) {
+    if (i == str.size() || is_delimiter[static_cast<uint8>(str[i])]) {
+      if (!skip_empty || i > token_start) {
+        tokens->emplace_back(str.data() + token_start, i - token_start);
+      }
+      token_start = i + 1;
+    }
   }
-  return char_vector;
+  return tokens->size() - num_tokens;
 }
 
-std::vector<string> SplitV2(const string& str, StringPiece sep, int maxsplit) {
+// Appends the tokens of 'str' to 'tokens', which point into 'str'. Returns
+// the number of tokens.
+int64 SplitV2(StringPiece str, StringPiece sep, int maxsplit,
+              std::vector<StringPiece>* tokens) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -59,12 +72,12 @@ std::vector<string> SplitV2(const string& str, StringPiece sep, int maxsplit) {
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<string> result;
+  const size_t num_tokens = tokens->size();
 
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(std::string(text));
-    return result;
+    tokens->push_back(text);
+    return 1;
   }
 
   if (sep.empty()) {
@@ -73,32 +86,31 @@ std::vector<string> SplitV2(const string& str, StringPiece sep, int maxsplit) {
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.emplace_back(std::string(token));
+      tokens->push_back(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.emplace_back(std::string(text));
-        return result;
+        tokens->push_back(text);
+        break;
       }
     }
-    return result;
+    return tokens->size() - num_tokens;
   }
   auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   int split = 0;
   while (p != text.end()) {
     StringPiece token = text.substr(0, p - text.begin());
-    result.emplace_back(std::string(token));
+    tokens->push_back(token);
     text.remove_prefix(token.size());
     text.remove_prefix(sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.emplace_back(std::string(text));
-      return result;
+      break;
     }
     p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   }
-  result.emplace_back(std::string(text));
-  return result;
+  tokens->push_back(text);
+  return tokens->size() - num_tokens;
 }
 
 }  // namespace
@@ -134,7 +146,12 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<string>();
     const string& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<string> tokens;
+    bool is_delimiter[256] = {};
+    for (const char c : delimiter) {
+      is_delimiter[static_cast<uint8>(c)] = true;
+    }
+    // The tokens point into the input, and are only copied to the output.
+    std::vector<StringPiece> tokens;
     // Guess that we'll be unpacking a handful of tokens per example.
     static constexpr int kReserveSize = 4;
     tokens.reserve(batch_size * kReserveSize);
@@ -143,12 +160,11 @@ class StringSplitOp : public OpKernel {
     int64 max_num_entries = 0;
     std::vector<int64> num_indices(batch_size);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<string> parts = Split(input_vec(i), delimiter, skip_empty_);
-      int64 n_entries = parts.size();
+      const int64 n_entries = Split(input_vec(i), is_delimiter,
+                                    !delimiter.empty(), skip_empty_, &tokens);
       num_indices[i] = n_entries;
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -170,7 +186,7 @@ class StringSplitOp : public OpKernel {
       for (size_t j = 0; j < num_indices[i]; ++j) {
         sp_indices(c, 0) = i;
         sp_indices(c, 1) = j;
-        sp_tokens(c) = tokens[c];
+        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
         ++c;
       }
     }
@@ -204,7 +220,8 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<string>();
     StringPiece sep(sep_vec(0));
-    std::vector<string> tokens;
+    // The tokens point into the input, and are only copied to the output.
+    std::vector<StringPiece> tokens;
     // Guess that we'll be unpacking a handful of tokens per example.
     static constexpr int kReserveSize = 4;
     tokens.reserve(batch_size * kReserveSize);
@@ -213,12 +230,10 @@ class StringSplitV2Op : public OpKernel {
     int64 max_num_entries = 0;
     std::vector<int64> num_indices(batch_size);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<string> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64 n_entries = parts.size();
+      const int64 n_entries = SplitV2(input_vec(i), sep, maxsplit_, &tokens);
       num_indices[i] = n_entries;
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -240,7 +255,7 @@ class StringSplitV2Op : public OpKernel {
       for (size_t j = 0; j < num_indices[i]; ++j) {
         sp_indices(c, 0) = i;
         sp_indices(c, 1) = j;
-        sp_tokens(c) = tokens[c];
+        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
         ++c;
       }
     }
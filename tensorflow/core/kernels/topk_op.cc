@@ -36,6 +36,44 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Larger k are selected with std::nth_element instead of a TopN heap, whose
+// O(num_cols * log(k)) pushes dominate once the heap is this large.
+constexpr int kMaxHeapK = 256;
+
+// A row with at least this many columns per thread is split across threads
+// when there are fewer rows than threads.
+constexpr int64 kMinColsPerRowShard = 1 << 15;
+
+// Moves the indices of the k largest values of 'input_data' among
+// [begin, end) to [begin, begin + k), in decreasing order of value if
+// 'sorted' or increasing order of index otherwise. Equal values are ordered
+// by index, as with the TopN heap.
+template <typename T>
+void SelectTopK(const T* input_data, int k, bool sorted, int32* begin,
+                int32* end) {
+  const auto stable_comp = [input_data](const int32 a, const int32 b) {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  };
+  if (k < end - begin) {
+    std::nth_element(begin, begin + k - 1, end, stable_comp);
+  }
+  if (sorted) {
+    std::sort(begin, begin + k, stable_comp);
+  } else {
+    std::sort(begin, begin + k);
+  }
+}
+
+}  // namespace
+
 template <typename Device, typename T>
 class TopK : public OpKernel {
  public:
@@ -134,7 +172,57 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // With few, long rows, each row is split into shards whose top k are
+    // selected in parallel, and the top k of the row are then selected among
+    // those candidates.
+    const int64 max_row_shards =
+        std::min<int64>(worker_threads.num_threads,
+                        num_cols / std::max<int64>(kMinColsPerRowShard, 2 * k));
+    if (num_rows < worker_threads.num_threads && max_row_shards > 1) {
+      const int64 shard_cols = Eigen::divup(num_cols, max_row_shards);
+      const int64 num_row_shards = Eigen::divup(num_cols, shard_cols);
+      std::vector<int32> candidates(num_cols);
+      for (int64 b = 0; b < num_rows; ++b) {
+        const T* input_data = &input(b, 0);
+        std::iota(candidates.begin(), candidates.end(), 0);
+        auto SelectShards = [&](int64 start_shard, int64 limit_shard) {
+          for (int64 i = start_shard; i < limit_shard; ++i) {
+            const int64 start = i * shard_cols;
+            const int64 limit = std::min(start + shard_cols, num_cols);
+            SelectTopK(input_data, std::min<int64>(k, limit - start),
+                       /*sorted=*/false, candidates.data() + start,
+                       candidates.data() + limit);
+          }
+        };
+        Shard(worker_threads.num_threads, worker_threads.workers,
+              num_row_shards,
+              static_cast<int64>(shard_cols * 4 *
+                                 Eigen::TensorOpCost::AddCost<T>()),
+              SelectShards);
+        // Shards have at least 2 * k columns, except maybe the last one, so
+        // their candidates move to the front without overwriting any that
+        // are yet to be moved.
+        int64 num_candidates = 0;
+        for (int64 i = 0; i < num_row_shards; ++i) {
+          const int64 start = i * shard_cols;
+          const int64 count = std::min<int64>(k, num_cols - start);
+          std::copy_n(candidates.begin() + start, count,
+                      candidates.begin() + num_candidates);
+          num_candidates += count;
+        }
+        SelectTopK(input_data, k, sorted, candidates.data(),
+                   candidates.data() + num_candidates);
+        std::copy_n(candidates.begin(), k, &indices(b, 0));
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const int32 loc) { return input(b, loc); });
+      }
+      return Status::OK();
+    }
+
     auto SortIndices = [&, context](int start_batch, int limit_batch) {
+      std::vector<int32> candidates;
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32 a, const int32 b) {
@@ -149,11 +237,6 @@ struct TopKFunctor<CPUDevice, T> {
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -176,6 +259,12 @@ struct TopKFunctor<CPUDevice, T> {
             }
             run_begin = run_end;
           }
+        } else if (k > kMaxHeapK) {
+          candidates.resize(num_cols);
+          std::iota(candidates.begin(), candidates.end(), 0);
+          SelectTopK(input_data, k, sorted, candidates.data(),
+                     candidates.data() + num_cols);
+          std::copy(candidates.begin(), candidates.begin() + k, &indices(b, 0));
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
@@ -219,7 +308,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
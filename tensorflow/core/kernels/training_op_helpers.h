@@ -33,36 +33,54 @@ void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
 
 // This is for use with ResourceVariables to ensure *tensor has a
 // reference count of 1 before you update it.
-// REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held.
+// If the buffer is shared with pending reads, it is copied into *spare when
+// that buffer is no longer used by anything else and has the same type and
+// shape, and into a new buffer otherwise; the shared buffer then becomes the
+// new *spare. This way a variable updated under concurrent reads alternates
+// between two buffers instead of allocating one per update. spare may be
+// nullptr.
+// REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held,
+// and spare should be variable->spare_tensor().
 template <typename Device, typename T>
-Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor) {
+Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
+                               Tensor* spare) {
   if (!tensor->RefCountIsOne()) {
     // Tensor's buffer is in use by some read, so we need to copy before
     // updating.
-    PersistentTensor unused;
-    Tensor* tmp;
-    if (std::is_same<T, Variant>::value) {
+    Tensor tmp;
+    if (spare != nullptr && spare->RefCountIsOne() &&
+        spare->dtype() == tensor->dtype() &&
+        spare->shape() == tensor->shape()) {
+      tmp = *spare;
+    } else {
+      PersistentTensor unused;
+      Tensor* allocated;
       AllocatorAttributes attr;
-      attr.set_on_host(true);
+      if (std::is_same<T, Variant>::value) {
+        attr.set_on_host(true);
+      } else {
+        attr.set_gpu_compatible(true);
+        attr.set_nic_compatible(true);
+      }
       TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-          tensor->dtype(), tensor->shape(), &unused, &tmp, attr));
-
+          tensor->dtype(), tensor->shape(), &unused, &allocated, attr));
+      tmp = *allocated;
+    }
+    if (std::is_same<T, Variant>::value) {
       const auto elements_in = tensor->flat<Variant>();
-      auto elements_out = tmp->flat<Variant>();
+      auto elements_out = tmp.flat<Variant>();
       for (int64 i = 0; i < elements_in.size(); ++i) {
         elements_out(i) = elements_in(i);
       }
     } else {
-      AllocatorAttributes attr;
-      attr.set_gpu_compatible(true);
-      attr.set_nic_compatible(true);
-      TF_RETURN_IF_ERROR(ctx->allocate_persistent(
-          tensor->dtype(), tensor->shape(), &unused, &tmp, attr));
       functor::DenseUpdate<Device, T, ASSIGN> copy_functor;
-      copy_functor(ctx->eigen_device<Device>(), tmp->flat<T>(),
+      copy_functor(ctx->eigen_device<Device>(), tmp.flat<T>(),
                    const_cast<const Tensor*>(tensor)->flat<T>());
     }
-    *tensor = *tmp;
+    if (spare != nullptr) {
+      *spare = *tensor;
+    }
+    *tensor = tmp;
   }
   return Status::OK();
 }
@@ -82,13 +100,15 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
     core::ScopedUnref unref_var(var);
     if (lock_held) {
       TF_RETURN_IF_ERROR(
-          PrepareToUpdateVariable<Device, T>(ctx, var->tensor()));
+          PrepareToUpdateVariable<Device, T>(ctx, var->tensor(),
+                                             var->spare_tensor()));
       *out = *var->tensor();
     } else {
       mutex_lock ml(*var->mu());
       if (!sparse) {
         TF_RETURN_IF_ERROR(
-            PrepareToUpdateVariable<Device, T>(ctx, var->tensor()));
+            PrepareToUpdateVariable<Device, T>(ctx, var->tensor(),
+                                               var->spare_tensor()));
       }
       *out = *var->tensor();
     }
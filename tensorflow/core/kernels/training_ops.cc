@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 
 #include <algorithm>
+#include <numeric>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/training_ops.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -2783,6 +2785,130 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Applies Adam to N variables at once, in one loop over all of their elements
+// that is sharded across threads, rather than in N separate kernels.
+template <typename T>
+class ResourceGroupApplyAdamOp : public OpKernel {
+ public:
+  explicit ResourceGroupApplyAdamOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    // The inputs are the N vars, then the N m's and the N v's, then the
+    // scalars, then the N grads.
+    std::vector<int> var_inputs(3 * n);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks =
+        MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                             var_inputs);
+
+    std::vector<Tensor> vars(3 * n);
+    for (int i = 0; i < 3 * n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                              ctx, i, use_exclusive_lock_, false, &vars[i]));
+      OP_REQUIRES(ctx, vars[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+
+    const Tensor& beta1_power = ctx->input(3 * n);
+    const Tensor& beta2_power = ctx->input(3 * n + 1);
+    const Tensor& lr = ctx->input(3 * n + 2);
+    const Tensor& beta1 = ctx->input(3 * n + 3);
+    const Tensor& beta2 = ctx->input(3 * n + 4);
+    const Tensor& epsilon = ctx->input(3 * n + 5);
+    for (int i = 3 * n; i < 3 * n + 6; ++i) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(ctx->input(i).shape()),
+                  errors::InvalidArgument(
+                      "beta1_power, beta2_power, lr, beta1, beta2 and epsilon "
+                      "must be scalars, got ",
+                      ctx->input(i).shape().DebugString()));
+    }
+
+    // The variables are updated in blocks of kBlockSize elements, which start
+    // at aligned offsets. block_offsets[i] is the number of blocks of the
+    // variables before the i-th one.
+    const int64 kBlockSize = 1024;
+    std::vector<int64> block_offsets(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      const Tensor& var = vars[i];
+      const Tensor& grad = ctx->input(3 * n + 6 + i);
+      OP_REQUIRES(ctx, var.shape().IsSameSize(vars[n + i].shape()),
+                  errors::InvalidArgument(
+                      "var and m do not have the same shape",
+                      var.shape().DebugString(), " ",
+                      vars[n + i].shape().DebugString()));
+      OP_REQUIRES(ctx, var.shape().IsSameSize(vars[2 * n + i].shape()),
+                  errors::InvalidArgument(
+                      "var and v do not have the same shape",
+                      var.shape().DebugString(), " ",
+                      vars[2 * n + i].shape().DebugString()));
+      OP_REQUIRES(ctx, var.shape().IsSameSize(grad.shape()),
+                  errors::InvalidArgument(
+                      "var and grad do not have the same shape",
+                      var.shape().DebugString(), " ",
+                      grad.shape().DebugString()));
+      block_offsets[i + 1] =
+          block_offsets[i] + Eigen::divup(var.NumElements(), kBlockSize);
+    }
+
+    auto apply_blocks = [&](int64 start_block, int64 limit_block) {
+      int i = std::upper_bound(block_offsets.begin(), block_offsets.end(),
+                               start_block) -
+              block_offsets.begin() - 1;
+      for (int64 block = start_block; block < limit_block; ++block) {
+        while (block >= block_offsets[i + 1]) ++i;
+        const int64 begin = (block - block_offsets[i]) * kBlockSize;
+        const int64 size =
+            std::min(kBlockSize, vars[i].NumElements() - begin);
+        typename TTypes<T>::Flat var(vars[i].flat<T>().data() + begin, size);
+        typename TTypes<T>::Flat m(vars[n + i].flat<T>().data() + begin,
+                                   size);
+        typename TTypes<T>::Flat v(vars[2 * n + i].flat<T>().data() + begin,
+                                   size);
+        typename TTypes<T>::ConstFlat grad(
+            ctx->input(3 * n + 6 + i).flat<T>().data() + begin, size);
+        functor::ApplyAdamNonCuda<Eigen::DefaultDevice, T>()(
+            Eigen::DefaultDevice(), var, m, v, beta1_power.scalar<T>(),
+            beta2_power.scalar<T>(), lr.scalar<T>(), beta1.scalar<T>(),
+            beta2.scalar<T>(), epsilon.scalar<T>(), grad, use_nesterov_);
+      }
+    };
+    // Roughly the cycles of the Adam update of one element, with its
+    // square root and division.
+    const int64 kCostPerElement = 30;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, block_offsets[n],
+          kBlockSize * kCostPerElement, apply_blocks);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+  int num_vars_;
+};
+
+#define REGISTER_CPU_KERNELS(T)                                   \
+  REGISTER_KERNEL_BUILDER(Name("ResourceGroupApplyAdam")          \
+                              .Device(DEVICE_CPU)                 \
+                              .HostMemory("var")                  \
+                              .HostMemory("m")                    \
+                              .HostMemory("v")                    \
+                              .TypeConstraint<T>("T"),            \
+                          ResourceGroupApplyAdamOp<T>);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdaMaxOp : public OpKernel {
  public:
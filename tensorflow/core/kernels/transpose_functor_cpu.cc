@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -65,12 +66,95 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes 'batch' matrices of 'rows' x 'cols' elements from 'p' into 'q'.
+// The matrices are copied in square tiles, small enough that the rows of a
+// tile read from 'p' and written to 'q' all stay in the L1 cache, and the
+// tiles are spread across threads.
+template <typename T, bool conjugate>
+void TransposeTiled(const CPUDevice& device, const T* p, T* q, int64 batch,
+                    int64 rows, int64 cols) {
+  const int64 tile_size = std::max<int64>(8, 128 / sizeof(T));
+  const int64 row_tiles = Eigen::divup(rows, tile_size);
+  const int64 col_tiles = Eigen::divup(cols, tile_size);
+  auto transpose_fn = [=](int64 begin, int64 end) {
+    for (int64 tile = begin; tile < end; ++tile) {
+      const int64 b = tile / (row_tiles * col_tiles);
+      const int64 row_tile = tile / col_tiles % row_tiles;
+      const int64 col_tile = tile % col_tiles;
+      const T* src = p + b * rows * cols;
+      T* dst = q + b * rows * cols;
+      const int64 row_begin = row_tile * tile_size;
+      const int64 row_end = std::min(row_begin + tile_size, rows);
+      const int64 col_begin = col_tile * tile_size;
+      const int64 col_end = std::min(col_begin + tile_size, cols);
+      for (int64 c = col_begin; c < col_end; ++c) {
+        for (int64 r = row_begin; r < row_end; ++r) {
+          if (conjugate) {
+            dst[c * rows + r] = Eigen::numext::conj(src[r * cols + c]);
+          } else {
+            dst[c * rows + r] = src[r * cols + c];
+          }
+        }
+      }
+    }
+  };
+  const int64 tile_elements =
+      std::min(tile_size, rows) * std::min(tile_size, cols);
+  Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/tile_elements * sizeof(T),
+      /*bytes_stored=*/tile_elements * sizeof(T),
+      /*compute_cycles=*/tile_elements * ((conjugate ? 1 : 0) +
+                                          2 * Eigen::TensorOpCost::AddCost<
+                                                  int64>()));
+  device.parallelFor(batch * row_tiles * col_tiles, cost,
+                     std::move(transpose_fn));
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    // Collapses the dimensions that stay adjacent in the output, which often
+    // leaves a (batched) matrix transpose or a lower rank for Eigen.
+    internal::TransposePermsVec new_perm;
+    internal::TransposeDimsVec new_dims(in.dims());
+    internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm,
+                                        &new_dims);
+    const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+    T* q = reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data()));
+    if (new_perm.size() == 1) {
+      TransposeTiled<T, conjugate>(d, p, q, 1, 1, new_dims[0]);
+      return;
+    }
+    if (new_perm.size() == 2) {
+      TransposeTiled<T, conjugate>(d, p, q, 1, new_dims[0], new_dims[1]);
+      return;
+    }
+    if (new_perm.size() == 3 && new_perm[0] == 0) {
+      TransposeTiled<T, conjugate>(d, p, q, new_dims[0], new_dims[1],
+                                   new_dims[2]);
+      return;
+    }
+    if (new_perm.size() < static_cast<size_t>(in.dims())) {
+      internal::TransposeDimsVec new_out_dims(new_perm.size());
+      for (int i = 0; i < new_perm.size(); ++i) {
+        new_out_dims[i] = new_dims[new_perm[i]];
+      }
+      Tensor reduced_in;
+      Tensor reduced_out;
+      CHECK(reduced_in.CopyFrom(in, TensorShape(new_dims)));
+      CHECK(reduced_out.CopyFrom(*out, TensorShape(new_out_dims)));
+      RunWithEigen(d, reduced_in, new_perm, &reduced_out);
+      return;
+    }
+    RunWithEigen(d, in, perm, out);
+  }
+
+ private:
+  static void RunWithEigen(const CPUDevice& d, const Tensor& in,
+                           const gtl::ArraySlice<int32> perm, Tensor* out) {
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -23,12 +24,151 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// gtl::FlatMap takes the probe marker from the low bits of the hash and the
+// bucket from the bits above, and std::hash is the identity for integers, so
+// hashes are mixed with the MurmurHash3 finalizer first.
+inline uint64 MixHash(uint64 h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <typename T>
+struct UniqueHash {
+  size_t operator()(const T& value) const {
+    return static_cast<size_t>(MixHash(hash<T>{}(value)));
+  }
+};
+
+// Inputs with at least this many elements are deduplicated in parallel.
+constexpr int64 kParallelUniqueMinElements = 128 * 1024;
+
+// Finds the unique elements of 'input' in parallel, each with the index of
+// its first occurrence, and sets 'idx' to the index of each element in the
+// output. The elements are partitioned by hash, so that all the copies of an
+// element are in the same partition, and each partition is deduplicated
+// separately. The output order, by first occurrence, is then recovered with a
+// prefix sum over the first occurrences.
+template <typename T, typename TIndex>
+void ParallelUnique(OpKernelContext* context,
+                    typename TTypes<T>::ConstFlat input,
+                    typename TTypes<TIndex>::Vec idx,
+                    std::vector<int64>* first_occurrences) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64 n = input.size();
+  const int num_parts = std::min(worker_threads.num_threads * 4, 256);
+  const int64 chunk_size = (n + num_parts - 1) / num_parts;
+  // The partitions and the chunks of the input are both processed as one
+  // unit of work per thread, with this many elements in each.
+  const int64 cost_per_part = chunk_size * 100;
+  auto for_each_part = [&](std::function<void(int)> fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_parts,
+          cost_per_part, [&fn](int64 start, int64 limit) {
+            for (int64 p = start; p < limit; ++p) fn(p);
+          });
+  };
+
+  // Count the elements of each partition in each chunk of the input, and
+  // lay the partitions out one after another, each in input order.
+  std::vector<uint8> part_of(n);
+  std::vector<int64> offsets(num_parts * num_parts, 0);
+  for_each_part([&](int c) {
+    int64* counts = &offsets[c * num_parts];
+    for (int64 i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size);
+         ++i) {
+      part_of[i] = (MixHash(hash<T>{}(input(i))) >> 32) % num_parts;
+      ++counts[part_of[i]];
+    }
+  });
+  std::vector<int64> part_starts(num_parts + 1);
+  int64 offset = 0;
+  for (int p = 0; p < num_parts; ++p) {
+    part_starts[p] = offset;
+    for (int c = 0; c < num_parts; ++c) {
+      const int64 count = offsets[c * num_parts + p];
+      offsets[c * num_parts + p] = offset;
+      offset += count;
+    }
+  }
+  part_starts[num_parts] = n;
+  std::vector<int64> order(n);
+  for_each_part([&](int c) {
+    int64* next = &offsets[c * num_parts];
+    for (int64 i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size);
+         ++i) {
+      order[next[part_of[i]]++] = i;
+    }
+  });
+
+  // Deduplicate each partition, setting idx to the index of each element
+  // among the unique elements of its partition for now.
+  std::vector<std::vector<int64>> part_firsts(num_parts);
+  std::vector<uint8> is_first(n, 0);
+  for_each_part([&](int p) {
+    gtl::FlatMap<T, TIndex, UniqueHash<T>> uniq(
+        2 * (part_starts[p + 1] - part_starts[p]));
+    std::vector<int64>* firsts = &part_firsts[p];
+    for (int64 j = part_starts[p]; j < part_starts[p + 1]; ++j) {
+      const int64 i = order[j];
+      auto it = uniq.insert(std::make_pair(input(i), firsts->size()));
+      idx(i) = it.first->second;
+      if (it.second) {
+        firsts->push_back(i);
+        is_first[i] = 1;
+      }
+    }
+  });
+
+  // The output index of a unique element is the number of first occurrences
+  // before its own, which is computed per chunk of the input.
+  std::vector<int64> chunk_firsts(num_parts + 1, 0);
+  for_each_part([&](int c) {
+    for (int64 i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size);
+         ++i) {
+      chunk_firsts[c + 1] += is_first[i];
+    }
+  });
+  for (int c = 0; c < num_parts; ++c) {
+    chunk_firsts[c + 1] += chunk_firsts[c];
+  }
+  const int64 num_unique = chunk_firsts[num_parts];
+  std::vector<int64> output_index(n);
+  first_occurrences->resize(num_unique);
+  for_each_part([&](int c) {
+    int64 next = chunk_firsts[c];
+    for (int64 i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size);
+         ++i) {
+      if (is_first[i]) {
+        output_index[i] = next;
+        (*first_occurrences)[next++] = i;
+      }
+    }
+  });
+  for_each_part([&](int p) {
+    const std::vector<int64>& firsts = part_firsts[p];
+    for (int64 j = part_starts[p]; j < part_starts[p + 1]; ++j) {
+      const int64 i = order[j];
+      idx(i) = output_index[firsts[idx(i)]];
+    }
+  });
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -106,26 +246,42 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
-      std::unordered_map<T, TIndex> uniq;
-      uniq.reserve(2 * N);
-      for (int64 i = 0, j = 0; i < N; ++i) {
-        auto it = uniq.insert(std::make_pair(Tin(i), j));
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
+      if (N >= kParallelUniqueMinElements &&
+          context->device()->tensorflow_cpu_worker_threads()->num_threads >
+              1) {
+        std::vector<int64> first_occurrences;
+        ParallelUnique<T, TIndex>(context, Tin, idx_vec, &first_occurrences);
+        uniq_size = static_cast<int64>(first_occurrences.size());
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->flat<T>();
+        for (int64 i = 0; i < uniq_size; ++i) {
+          Tout(i) = Tin(first_occurrences[i]);
+        }
+      } else {
+        gtl::FlatMap<T, TIndex, UniqueHash<T>> uniq(2 * N);
+        for (int64 i = 0, j = 0; i < N; ++i) {
+          auto it = uniq.insert(std::make_pair(Tin(i), j));
+          idx_vec(i) = it.first->second;
+          if (it.second) {
+            ++j;
+          }
         }
-      }
 
-      uniq_size = static_cast<int64>(uniq.size());
-      TensorShape output_shape(input.shape());
-      output_shape.set_dim(axis, uniq_size);
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output(0, output_shape, &output));
-      auto Tout = output->flat<T>();
+        uniq_size = static_cast<int64>(uniq.size());
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->flat<T>();
 
-      for (auto it : uniq) {
-        Tout(it.second) = it.first;
+        for (auto it : uniq) {
+          Tout(it.second) = it.first;
+        }
       }
     } else {
       // General implementation when unique is run over multiple elements.
@@ -138,7 +294,7 @@ class UniqueOp : public OpKernel {
             h = Hash64Combine(h, hash<T>{}(Tin(i, key, j)));
           }
         }
-        return h;
+        return static_cast<size_t>(MixHash(h));
       };
 
       auto equal_to_fn = [&Tin](const int64& lhs, const int64& rhs) {
@@ -152,10 +308,8 @@ class UniqueOp : public OpKernel {
         return true;
       };
 
-      std::unordered_map<int64, int64, decltype(hash_fn), decltype(equal_to_fn)>
-          uniq(0, hash_fn, equal_to_fn);
-
-      uniq.reserve(2 * Tin.dimension(1));
+      gtl::FlatMap<int64, int64, decltype(hash_fn), decltype(equal_to_fn)>
+          uniq(2 * Tin.dimension(1), hash_fn, equal_to_fn);
 
       for (int64 i = 0, j = 0; i < Tin.dimension(1); ++i) {
         auto it = uniq.insert(std::make_pair(i, j));
@@ -17,7 +17,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -28,27 +30,52 @@ limitations under the License.
 namespace tensorflow {
 namespace thread {
 
+namespace {
+
+// Created on first use, as thread pools may be created during static
+// initialization.
+monitoring::Gauge<int64, 1>* ThreadPoolPendingClosures() {
+  static auto* gauge = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/core/thread_pool/pending_closures",
+      "The number of closures scheduled on the thread pools with a name that "
+      "have not started running yet.",
+      "name");
+  return gauge;
+}
+
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
-  struct TaskImpl {
+  // Held by value in the run queues, so that scheduling a closure small
+  // enough for std::function's inline storage doesn't allocate.
+  struct Task {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
   };
-  struct Task {
-    std::unique_ptr<TaskImpl> f;
-  };
 
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  monitoring::GaugeCell<int64>* const pending_closures_;
+  // Number of threads created so far, to pin them to consecutive CPUs.
+  int num_created_threads_ = 0;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
                    const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        pending_closures_(ThreadPoolPendingClosures()->GetCell(name)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
-    return env_->StartThread(thread_options_, name_, [=]() {
+    ThreadOptions thread_options = thread_options_;
+    if (thread_options.cpu != port::kNoCPUAffinity) {
+      thread_options.cpu += num_created_threads_;
+    }
+    ++num_created_threads_;
+    return env_->StartThread(thread_options, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
       // Set the processor rounding mode to ROUND TO NEAREST.
@@ -63,20 +90,20 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    pending_closures_->IncrementBy(1);
     return Task{
-        std::unique_ptr<TaskImpl>(new TaskImpl{
-            std::move(f),
-            Context(ContextKind::kThread),
-            id,
-        }),
+        std::move(f),
+        Context(ContextKind::kThread),
+        id,
     };
   }
 
   void ExecuteTask(const Task& t) {
-    WithContext wc(t.f->context);
+    pending_closures_->IncrementBy(-1);
+    WithContext wc(t.context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
-                                 t.f->trace_id);
-    t.f->f();
+                                 t.trace_id);
+    t.f();
   }
 };
 
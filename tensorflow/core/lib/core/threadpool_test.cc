@@ -61,6 +61,20 @@ TEST(ThreadPool, DoWork) {
   }
 }
 
+TEST(ThreadPool, PinnedToCPUs) {
+  ThreadOptions thread_options;
+  thread_options.cpu = 0;
+  const int kWorkItems = 15;
+  std::atomic<int> num_done(0);
+  {
+    ThreadPool pool(Env::Default(), thread_options, "test", 4);
+    for (int i = 0; i < kWorkItems; i++) {
+      pool.Schedule([&num_done]() { ++num_done; });
+    }
+  }
+  EXPECT_EQ(num_done, kWorkItems);
+}
+
 TEST(ThreadPool, ParallelFor) {
   Context outer_context(ContextKind::kThread);
   // Make ParallelFor use as many threads as possible.
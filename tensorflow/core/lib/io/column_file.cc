@@ -0,0 +1,433 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/column_file.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+constexpr char kMagic[] = "TFCOLUMN";
+constexpr size_t kMagicSize = 8;
+// footer_crc, footer_size and the trailing magic.
+constexpr size_t kTrailerSize = sizeof(uint32) + sizeof(uint64) + kMagicSize;
+
+void PutLengthPrefixed(string* dst, StringPiece value) {
+  core::PutVarint64(dst, value.size());
+  dst->append(value.data(), value.size());
+}
+
+bool GetLengthPrefixed(StringPiece* input, string* value) {
+  uint64 size;
+  if (!core::GetVarint64(input, &size) || size > input->size()) {
+    return false;
+  }
+  value->assign(input->data(), size);
+  input->remove_prefix(size);
+  return true;
+}
+
+Status ValidateColumn(const ColumnSchema& column, int64 num_rows,
+                      const ColumnValues& values) {
+  switch (column.type) {
+    case ColumnType::kInt64:
+    case ColumnType::kFloat: {
+      const size_t width =
+          column.type == ColumnType::kInt64 ? sizeof(int64) : sizeof(float);
+      if (values.fixed.size() != num_rows * width) {
+        return errors::InvalidArgument("Column ", column.name, " has ",
+                                       values.fixed.size(), " bytes for ",
+                                       num_rows, " rows");
+      }
+      return Status::OK();
+    }
+    case ColumnType::kString:
+      if (values.strings.size() != static_cast<size_t>(num_rows)) {
+        return errors::InvalidArgument("Column ", column.name, " has ",
+                                       values.strings.size(), " values for ",
+                                       num_rows, " rows");
+      }
+      return Status::OK();
+  }
+  return errors::InvalidArgument("Column ", column.name, " has invalid type ",
+                                 static_cast<int>(column.type));
+}
+
+// Sets the min and max of an int64 or float chunk.
+template <typename T>
+void FixedStats(StringPiece values, string* min, string* max) {
+  const size_t n = values.size() / sizeof(T);
+  bool found = false;
+  T lo = T(), hi = T();
+  for (size_t i = 0; i < n; ++i) {
+    T value;
+    memcpy(&value, values.data() + i * sizeof(T), sizeof(T));
+    if (std::isnan(static_cast<double>(value))) {
+      continue;
+    }
+    if (!found || value < lo) lo = value;
+    if (!found || value > hi) hi = value;
+    found = true;
+  }
+  if (found) {
+    min->assign(reinterpret_cast<const char*>(&lo), sizeof(T));
+    max->assign(reinterpret_cast<const char*>(&hi), sizeof(T));
+  }
+}
+
+}  // namespace
+
+ColumnFileWriter::ColumnFileWriter(WritableFile* file,
+                                   std::vector<ColumnSchema> schema)
+    : file_(file), schema_(std::move(schema)) {}
+
+ColumnFileWriter::~ColumnFileWriter() {
+  if (started_ && !closed_) {
+    LOG(WARNING) << "ColumnFileWriter::Close() not called. The file has no "
+                    "footer and can not be read.";
+  }
+}
+
+Status ColumnFileWriter::AppendRowGroup(
+    int64 num_rows, const std::vector<ColumnValues>& columns) {
+  if (closed_) {
+    return errors::FailedPrecondition("ColumnFileWriter is closed");
+  }
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Column files can only be written on little-endian hosts");
+  }
+  if (num_rows < 0) {
+    return errors::InvalidArgument("Row groups can't have ", num_rows,
+                                   " rows");
+  }
+  if (columns.size() != schema_.size()) {
+    return errors::InvalidArgument("Expected ", schema_.size(),
+                                   " columns, got ", columns.size());
+  }
+  for (size_t i = 0; i < schema_.size(); ++i) {
+    TF_RETURN_IF_ERROR(ValidateColumn(schema_[i], num_rows, columns[i]));
+  }
+  if (!started_) {
+    TF_RETURN_IF_ERROR(WriteHeader());
+  }
+
+  RowGroup row_group;
+  row_group.num_rows = num_rows;
+  row_group.chunks.resize(schema_.size());
+  string buffer;
+  for (size_t i = 0; i < schema_.size(); ++i) {
+    ColumnChunk* chunk = &row_group.chunks[i];
+    switch (schema_[i].type) {
+      case ColumnType::kInt64:
+        FixedStats<int64>(columns[i].fixed, &chunk->min, &chunk->max);
+        TF_RETURN_IF_ERROR(AppendChunk(columns[i].fixed, chunk));
+        break;
+      case ColumnType::kFloat:
+        FixedStats<float>(columns[i].fixed, &chunk->min, &chunk->max);
+        TF_RETURN_IF_ERROR(AppendChunk(columns[i].fixed, chunk));
+        break;
+      case ColumnType::kString: {
+        const gtl::ArraySlice<string>& values = columns[i].strings;
+        buffer.clear();
+        uint64 data_size = 0;
+        core::PutFixed64(&buffer, data_size);
+        for (const string& value : values) {
+          data_size += value.size();
+          core::PutFixed64(&buffer, data_size);
+        }
+        for (size_t j = 0; j < values.size(); ++j) {
+          buffer.append(values[j]);
+          if (j == 0 || values[j] < chunk->min) chunk->min = values[j];
+          if (j == 0 || values[j] > chunk->max) chunk->max = values[j];
+        }
+        TF_RETURN_IF_ERROR(AppendChunk(buffer, chunk));
+        break;
+      }
+    }
+  }
+  row_groups_.push_back(std::move(row_group));
+  return Status::OK();
+}
+
+Status ColumnFileWriter::WriteHeader() {
+  string header(kMagic, kMagicSize);
+  header.resize(kColumnChunkAlignment, '\0');
+  TF_RETURN_IF_ERROR(file_->Append(header));
+  offset_ = header.size();
+  started_ = true;
+  return Status::OK();
+}
+
+Status ColumnFileWriter::AppendChunk(StringPiece data, ColumnChunk* chunk) {
+  chunk->offset = offset_;
+  chunk->size = data.size();
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  const size_t padding =
+      (kColumnChunkAlignment - data.size() % kColumnChunkAlignment) %
+      kColumnChunkAlignment;
+  if (padding > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(string(padding, '\0')));
+  }
+  offset_ += data.size() + padding;
+  return Status::OK();
+}
+
+Status ColumnFileWriter::Close() {
+  if (closed_) {
+    return errors::FailedPrecondition("ColumnFileWriter is closed");
+  }
+  if (!started_) {
+    TF_RETURN_IF_ERROR(WriteHeader());
+  }
+  string footer;
+  core::PutVarint64(&footer, schema_.size());
+  for (const ColumnSchema& column : schema_) {
+    PutLengthPrefixed(&footer, column.name);
+    footer.push_back(static_cast<char>(column.type));
+  }
+  core::PutVarint64(&footer, row_groups_.size());
+  for (const RowGroup& row_group : row_groups_) {
+    core::PutVarint64(&footer, row_group.num_rows);
+    for (const ColumnChunk& chunk : row_group.chunks) {
+      core::PutVarint64(&footer, chunk.offset);
+      core::PutVarint64(&footer, chunk.size);
+      PutLengthPrefixed(&footer, chunk.min);
+      PutLengthPrefixed(&footer, chunk.max);
+    }
+  }
+  string trailer;
+  core::PutFixed32(&trailer,
+                   crc32c::Mask(crc32c::Value(footer.data(), footer.size())));
+  core::PutFixed64(&trailer, footer.size());
+  trailer.append(kMagic, kMagicSize);
+  TF_RETURN_IF_ERROR(file_->Append(footer));
+  TF_RETURN_IF_ERROR(file_->Append(trailer));
+  closed_ = true;
+  return Status::OK();
+}
+
+ColumnFileReader::ColumnFileReader(const string& filename)
+    : filename_(filename) {}
+
+ColumnFileReader::~ColumnFileReader() {}
+
+Status ColumnFileReader::Open(Env* env, const string& filename,
+                              std::unique_ptr<ColumnFileReader>* reader) {
+  std::unique_ptr<ColumnFileReader> result(new ColumnFileReader(filename));
+  TF_RETURN_IF_ERROR(result->Initialize(env));
+  *reader = std::move(result);
+  return Status::OK();
+}
+
+Status ColumnFileReader::Initialize(Env* env) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Column files can only be read on little-endian hosts");
+  }
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename_, &file_size));
+  if (file_size < kMagicSize + kTrailerSize) {
+    return errors::DataLoss("Column file ", filename_, " is too short");
+  }
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename_, &region_);
+  if (errors::IsUnimplemented(s)) {
+    s = env->NewRandomAccessFile(filename_, &file_);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  string scratch;
+  StringPiece data;
+  TF_RETURN_IF_ERROR(Read(0, kMagicSize, &scratch, &data));
+  if (data != StringPiece(kMagic, kMagicSize)) {
+    return errors::DataLoss(filename_, " is not a column file");
+  }
+  TF_RETURN_IF_ERROR(
+      Read(file_size - kTrailerSize, kTrailerSize, &scratch, &data));
+  const uint32 footer_crc = crc32c::Unmask(core::DecodeFixed32(data.data()));
+  const uint64 footer_size = core::DecodeFixed64(data.data() + sizeof(uint32));
+  if (data.substr(sizeof(uint32) + sizeof(uint64)) !=
+          StringPiece(kMagic, kMagicSize) ||
+      footer_size > file_size - kMagicSize - kTrailerSize) {
+    return errors::DataLoss("Column file ", filename_,
+                            " has a corrupted trailer");
+  }
+  const uint64 data_end = file_size - kTrailerSize - footer_size;
+  TF_RETURN_IF_ERROR(Read(data_end, footer_size, &scratch, &data));
+  if (crc32c::Value(data.data(), data.size()) != footer_crc) {
+    return errors::DataLoss("Column file ", filename_,
+                            " has a corrupted footer: CRC mismatch");
+  }
+  if (!ParseFooter(data, data_end).ok()) {
+    return errors::DataLoss("Column file ", filename_,
+                            " has a corrupted footer");
+  }
+  return Status::OK();
+}
+
+Status ColumnFileReader::ParseFooter(StringPiece footer, uint64 data_end) {
+  const Status corrupted = errors::DataLoss("Corrupted footer");
+  uint64 num_columns;
+  if (!core::GetVarint64(&footer, &num_columns) ||
+      num_columns > footer.size()) {
+    return corrupted;
+  }
+  schema_.resize(num_columns);
+  for (ColumnSchema& column : schema_) {
+    if (!GetLengthPrefixed(&footer, &column.name) || footer.empty()) {
+      return corrupted;
+    }
+    const uint8 type = footer[0];
+    footer.remove_prefix(1);
+    if (type < static_cast<uint8>(ColumnType::kInt64) ||
+        type > static_cast<uint8>(ColumnType::kString)) {
+      return corrupted;
+    }
+    column.type = static_cast<ColumnType>(type);
+  }
+  uint64 num_row_groups;
+  if (!core::GetVarint64(&footer, &num_row_groups) ||
+      num_row_groups > footer.size()) {
+    return corrupted;
+  }
+  row_groups_.resize(num_row_groups);
+  for (RowGroup& row_group : row_groups_) {
+    uint64 num_rows;
+    // A row takes at least one byte in each column, except for columnless
+    // files.
+    if (!core::GetVarint64(&footer, &num_rows) ||
+        (num_columns > 0 && num_rows > data_end)) {
+      return corrupted;
+    }
+    row_group.num_rows = num_rows;
+    row_group.chunks.resize(num_columns);
+    for (size_t i = 0; i < num_columns; ++i) {
+      ColumnChunk& chunk = row_group.chunks[i];
+      if (!core::GetVarint64(&footer, &chunk.offset) ||
+          !core::GetVarint64(&footer, &chunk.size) ||
+          !GetLengthPrefixed(&footer, &chunk.min) ||
+          !GetLengthPrefixed(&footer, &chunk.max)) {
+        return corrupted;
+      }
+      if (chunk.offset < kColumnChunkAlignment ||
+          chunk.offset % kColumnChunkAlignment != 0 ||
+          chunk.offset > data_end || chunk.size > data_end - chunk.offset) {
+        return corrupted;
+      }
+      switch (schema_[i].type) {
+        case ColumnType::kInt64:
+          if (chunk.size != num_rows * sizeof(int64)) return corrupted;
+          break;
+        case ColumnType::kFloat:
+          if (chunk.size != num_rows * sizeof(float)) return corrupted;
+          break;
+        case ColumnType::kString:
+          if (chunk.size < (num_rows + 1) * sizeof(uint64)) return corrupted;
+          break;
+      }
+    }
+  }
+  if (!footer.empty()) {
+    return corrupted;
+  }
+  return Status::OK();
+}
+
+int ColumnFileReader::ColumnIndex(StringPiece name) const {
+  for (size_t i = 0; i < schema_.size(); ++i) {
+    if (schema_[i].name == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Status ColumnFileReader::Read(uint64 offset, size_t n, string* scratch,
+                              StringPiece* result) const {
+  if (region_) {
+    *result =
+        StringPiece(static_cast<const char*>(region_->data()) + offset, n);
+    return Status::OK();
+  }
+  scratch->resize(n);
+  TF_RETURN_IF_ERROR(file_->Read(offset, n, result, &(*scratch)[0]));
+  if (result->size() != n) {
+    return errors::DataLoss("Column file ", filename_, " was truncated");
+  }
+  return Status::OK();
+}
+
+Status ColumnFileReader::ReadChunk(int64 row_group, int column, bool strings,
+                                   string* scratch, StringPiece* chunk) const {
+  if (row_group < 0 || row_group >= static_cast<int64>(row_groups_.size())) {
+    return errors::InvalidArgument("Column file ", filename_, " has ",
+                                   row_groups_.size(),
+                                   " row groups, requested ", row_group);
+  }
+  if (column < 0 || column >= static_cast<int>(schema_.size())) {
+    return errors::InvalidArgument("Column file ", filename_, " has ",
+                                   schema_.size(), " columns, requested ",
+                                   column);
+  }
+  if ((schema_[column].type == ColumnType::kString) != strings) {
+    return errors::InvalidArgument(
+        "Column ", schema_[column].name, " of ", filename_,
+        strings ? " does not hold" : " holds", " strings");
+  }
+  const ColumnChunk& meta = row_groups_[row_group].chunks[column];
+  return Read(meta.offset, meta.size, scratch, chunk);
+}
+
+Status ColumnFileReader::ReadFixedColumn(int64 row_group, int column,
+                                         string* scratch,
+                                         StringPiece* values) const {
+  return ReadChunk(row_group, column, false /* strings */, scratch, values);
+}
+
+Status ColumnFileReader::ReadStringColumn(
+    int64 row_group, int column, string* scratch,
+    std::vector<StringPiece>* values) const {
+  StringPiece chunk;
+  TF_RETURN_IF_ERROR(
+      ReadChunk(row_group, column, true /* strings */, scratch, &chunk));
+  const int64 num_rows = row_groups_[row_group].num_rows;
+  const char* offsets = chunk.data();
+  StringPiece data = chunk.substr((num_rows + 1) * sizeof(uint64));
+  values->clear();
+  values->reserve(num_rows);
+  uint64 start = core::DecodeFixed64(offsets);
+  for (int64 i = 0; i < num_rows; ++i) {
+    const uint64 end = core::DecodeFixed64(offsets + (i + 1) * sizeof(uint64));
+    if (start > end || end > data.size()) {
+      return errors::DataLoss("Column ", schema_[column].name, " of ",
+                              filename_, " has corrupted offsets");
+    }
+    values->emplace_back(data.data() + start, end - start);
+    start = end;
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,201 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_COLUMN_FILE_H_
+#define TENSORFLOW_CORE_LIB_IO_COLUMN_FILE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Column files store a table of named, typed columns, split into row groups
+// of consecutive rows. Each row group stores each column as one contiguous
+// chunk, so a reader can read a subset of the columns without touching the
+// bytes of the others:
+//
+//   file      = magic padding chunk* footer footer_crc:fixed32
+//               footer_size:fixed64 magic
+//   footer    = num_columns:varint (name_size:varint name type:byte)*
+//               num_row_groups:varint (num_rows:varint chunk_meta*)*
+//   chunk_meta = offset:varint size:varint min_size:varint min
+//                max_size:varint max
+//
+// Chunks start at multiples of kColumnChunkAlignment bytes, after the padded
+// magic. The chunk of an int64 or float column holds its values in
+// little-endian order, so the chunks of a mapped file can back tensors without
+// a copy or any decoding. The chunk of a string column holds num_rows + 1
+// fixed64 offsets, relative to the end of the offsets, followed by the
+// concatenated values.
+//
+// The min and max of each chunk are encoded like its values (without offsets
+// for strings), and are empty if the chunk has no values to compare (no rows,
+// or only NaNs). Column files can only be written and read on little-endian
+// hosts.
+
+// The alignment of chunks in the file, which is also the alignment of chunks
+// in a mapped file.
+constexpr size_t kColumnChunkAlignment = 64;
+
+enum class ColumnType : uint8 { kInt64 = 1, kFloat = 2, kString = 3 };
+
+struct ColumnSchema {
+  string name;
+  ColumnType type;
+};
+
+// The location and statistics of the chunk of a column in a row group.
+struct ColumnChunk {
+  uint64 offset = 0;
+  uint64 size = 0;
+  string min;
+  string max;
+};
+
+struct RowGroup {
+  int64 num_rows = 0;
+  std::vector<ColumnChunk> chunks;  // One per column.
+};
+
+// The values of a column in a row group, as passed to
+// ColumnFileWriter::AppendRowGroup().
+struct ColumnValues {
+  // For int64 and float columns: the values, in host order.
+  StringPiece fixed;
+  // For string columns: the values.
+  gtl::ArraySlice<string> strings;
+};
+
+// Writes a column file.
+//
+// A given instance of a ColumnFileWriter is NOT safe for concurrent use
+// by multiple threads.
+class ColumnFileWriter {
+ public:
+  // Does not take ownership of `file`, which must be empty.
+  ColumnFileWriter(WritableFile* file, std::vector<ColumnSchema> schema);
+
+  ~ColumnFileWriter();
+
+  // Appends a row group of `num_rows` rows. `columns[i]` holds the values of
+  // the i-th column of the schema.
+  Status AppendRowGroup(int64 num_rows,
+                        const std::vector<ColumnValues>& columns);
+
+  // Writes the footer. Does not close the file.
+  //
+  // After calling this, any further calls to `AppendRowGroup()` or `Close()`
+  // will fail.
+  Status Close();
+
+ private:
+  // Writes the magic, padded to the first chunk.
+  Status WriteHeader();
+
+  // Appends `data` to the file, padded to a multiple of kColumnChunkAlignment
+  // bytes.
+  Status AppendChunk(StringPiece data, ColumnChunk* chunk);
+
+  WritableFile* file_;  // Not owned
+  const std::vector<ColumnSchema> schema_;
+  std::vector<RowGroup> row_groups_;
+  uint64 offset_ = 0;
+  bool started_ = false;
+  bool closed_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnFileWriter);
+};
+
+// Reads a column file.
+//
+// The file is memory-mapped when its file system supports it, and chunks are
+// returned in place, so only the pages of the columns that are read are
+// loaded. Otherwise, the chunks are read from the file when they are
+// requested.
+//
+// A given instance of a ColumnFileReader is safe for concurrent use by
+// multiple threads.
+class ColumnFileReader {
+ public:
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnFileReader>* reader);
+
+  ~ColumnFileReader();
+
+  const std::vector<ColumnSchema>& schema() const { return schema_; }
+
+  // Returns the index of the column named `name` in the schema, or -1.
+  int ColumnIndex(StringPiece name) const;
+
+  const std::vector<RowGroup>& row_groups() const { return row_groups_; }
+
+  // Returns true if the file is memory-mapped. The chunks of a mapped file
+  // never use the scratch, and live as long as the reader.
+  bool mapped() const { return region_ != nullptr; }
+
+  // Sets `*values` to the values of int64 or float column `column` in row
+  // group `row_group`. `*values` points into the mapped file or into
+  // `*scratch`, and is valid as long as both are.
+  Status ReadFixedColumn(int64 row_group, int column, string* scratch,
+                         StringPiece* values) const;
+
+  // Sets `*values` to the values of string column `column` in row group
+  // `row_group`. The values point into the mapped file or into `*scratch`,
+  // and are valid as long as both are.
+  Status ReadStringColumn(int64 row_group, int column, string* scratch,
+                          std::vector<StringPiece>* values) const;
+
+ private:
+  explicit ColumnFileReader(const string& filename);
+
+  // Reads the file and parses its footer.
+  Status Initialize(Env* env);
+
+  Status ParseFooter(StringPiece footer, uint64 data_end);
+
+  // Sets `*result` to `n` bytes at `offset`, read into `*scratch` if the file
+  // is not mapped.
+  Status Read(uint64 offset, size_t n, string* scratch,
+              StringPiece* result) const;
+
+  // Reads the chunk of `column` in `row_group`, checking whether the column
+  // holds strings.
+  Status ReadChunk(int64 row_group, int column, bool strings, string* scratch,
+                   StringPiece* chunk) const;
+
+  const string filename_;
+  // Exactly one of `region_` and `file_` is set.
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  std::unique_ptr<RandomAccessFile> file_;
+  std::vector<ColumnSchema> schema_;
+  std::vector<RowGroup> row_groups_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnFileReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_COLUMN_FILE_H_
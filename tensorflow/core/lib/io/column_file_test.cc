@@ -0,0 +1,172 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/column_file.h"
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+template <typename T>
+StringPiece Bytes(const std::vector<T>& values) {
+  return StringPiece(reinterpret_cast<const char*>(values.data()),
+                     values.size() * sizeof(T));
+}
+
+template <typename T>
+T Decode(StringPiece bytes) {
+  EXPECT_EQ(sizeof(T), bytes.size());
+  T value;
+  memcpy(&value, bytes.data(), sizeof(T));
+  return value;
+}
+
+// Writes a file with columns "id" (int64), "name" (string) and "score"
+// (float) in two row groups of 3 and 2 rows.
+string WriteTestFile(const string& name) {
+  const string fname = JoinPath(testing::TmpDir(), name);
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+  ColumnFileWriter writer(file.get(), {{"id", ColumnType::kInt64},
+                                       {"name", ColumnType::kString},
+                                       {"score", ColumnType::kFloat}});
+  const std::vector<int64> ids1 = {3, 1, 2};
+  const std::vector<string> names1 = {"c", "a", "bb"};
+  const std::vector<float> scores1 = {0.5f, kNaN, -1.5f};
+  TF_CHECK_OK(writer.AppendRowGroup(
+      3, {{Bytes(ids1), {}}, {StringPiece(), names1}, {Bytes(scores1), {}}}));
+  const std::vector<int64> ids2 = {4, 5};
+  const std::vector<string> names2 = {"", "e"};
+  const std::vector<float> scores2 = {kNaN, kNaN};
+  TF_CHECK_OK(writer.AppendRowGroup(
+      2, {{Bytes(ids2), {}}, {StringPiece(), names2}, {Bytes(scores2), {}}}));
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return fname;
+}
+
+TEST(ColumnFileTest, ReadColumns) {
+  const string fname = WriteTestFile("column_file_read");
+  std::unique_ptr<ColumnFileReader> reader;
+  TF_ASSERT_OK(ColumnFileReader::Open(Env::Default(), fname, &reader));
+
+  ASSERT_EQ(3, reader->schema().size());
+  EXPECT_EQ("name", reader->schema()[1].name);
+  EXPECT_EQ(ColumnType::kString, reader->schema()[1].type);
+  EXPECT_EQ(2, reader->ColumnIndex("score"));
+  EXPECT_EQ(-1, reader->ColumnIndex("missing"));
+  ASSERT_EQ(2, reader->row_groups().size());
+  EXPECT_EQ(3, reader->row_groups()[0].num_rows);
+  EXPECT_EQ(2, reader->row_groups()[1].num_rows);
+
+  string scratch;
+  StringPiece ids;
+  TF_ASSERT_OK(reader->ReadFixedColumn(0, 0, &scratch, &ids));
+  ASSERT_EQ(3 * sizeof(int64), ids.size());
+  // The chunks of a mapped file are aligned for use in place.
+  if (reader->mapped()) {
+    EXPECT_EQ(0,
+              reinterpret_cast<uintptr_t>(ids.data()) % kColumnChunkAlignment);
+  }
+  EXPECT_EQ(1, Decode<int64>(ids.substr(sizeof(int64), sizeof(int64))));
+
+  std::vector<StringPiece> names;
+  TF_ASSERT_OK(reader->ReadStringColumn(1, 1, &scratch, &names));
+  ASSERT_EQ(2, names.size());
+  EXPECT_EQ("", names[0]);
+  EXPECT_EQ("e", names[1]);
+
+  StringPiece scores;
+  TF_ASSERT_OK(reader->ReadFixedColumn(0, 2, &scratch, &scores));
+  EXPECT_EQ(-1.5f, Decode<float>(scores.substr(2 * sizeof(float))));
+
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reader->ReadFixedColumn(0, 1, &scratch, &scores)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reader->ReadStringColumn(0, 0, &scratch, &names)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reader->ReadFixedColumn(2, 0, &scratch, &scores)));
+}
+
+TEST(ColumnFileTest, Stats) {
+  const string fname = WriteTestFile("column_file_stats");
+  std::unique_ptr<ColumnFileReader> reader;
+  TF_ASSERT_OK(ColumnFileReader::Open(Env::Default(), fname, &reader));
+
+  const RowGroup& row_group = reader->row_groups()[0];
+  EXPECT_EQ(1, Decode<int64>(row_group.chunks[0].min));
+  EXPECT_EQ(3, Decode<int64>(row_group.chunks[0].max));
+  EXPECT_EQ("a", row_group.chunks[1].min);
+  EXPECT_EQ("c", row_group.chunks[1].max);
+  // NaNs are skipped.
+  EXPECT_EQ(-1.5f, Decode<float>(row_group.chunks[2].min));
+  EXPECT_EQ(0.5f, Decode<float>(row_group.chunks[2].max));
+  EXPECT_TRUE(reader->row_groups()[1].chunks[2].min.empty());
+  EXPECT_TRUE(reader->row_groups()[1].chunks[2].max.empty());
+}
+
+TEST(ColumnFileTest, InvalidRowGroups) {
+  const string fname = JoinPath(testing::TmpDir(), "column_file_invalid");
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+  ColumnFileWriter writer(file.get(), {{"id", ColumnType::kInt64}});
+  const std::vector<int64> ids = {1, 2};
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(writer.AppendRowGroup(3, {{Bytes(ids), {}}})));
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.AppendRowGroup(2, {})));
+  TF_EXPECT_OK(writer.AppendRowGroup(2, {{Bytes(ids), {}}}));
+  TF_EXPECT_OK(writer.Close());
+  EXPECT_TRUE(errors::IsFailedPrecondition(writer.Close()));
+}
+
+TEST(ColumnFileTest, CorruptedFile) {
+  const string fname = WriteTestFile("column_file_corrupted");
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &contents));
+  std::unique_ptr<ColumnFileReader> reader;
+
+  // Flip a byte of the footer.
+  string corrupted = contents;
+  corrupted[corrupted.size() - 30] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, corrupted));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ColumnFileReader::Open(Env::Default(), fname, &reader)));
+
+  // Truncate the trailer.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname,
+                                 contents.substr(0, contents.size() - 1)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ColumnFileReader::Open(Env::Default(), fname, &reader)));
+
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, "not a column file"));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ColumnFileReader::Open(Env::Default(), fname, &reader)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,306 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/gzip_blocks.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/notification.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Member header fields (RFC 1952).
+constexpr uint8 kGzipId1 = 0x1f;
+constexpr uint8 kGzipId2 = 0x8b;
+constexpr uint8 kGzipDeflate = 8;
+constexpr uint8 kGzipFlagExtra = 4;
+constexpr uint8 kGzipOsUnknown = 255;
+// The extra field holds a single "TF" subfield with the member size.
+constexpr uint16 kExtraSize = 8;
+constexpr uint16 kSubfieldSize = 4;
+// The trailer holds the CRC32 and the size of the data.
+constexpr size_t kTrailerSize = 8;
+
+// Inflates the raw deflate data and trailer of a member.
+Status InflateMember(StringPiece member, string* data) {
+  if (member.size() < kTrailerSize) {
+    return errors::DataLoss("Truncated gzip member");
+  }
+  const char* trailer = member.data() + member.size() - kTrailerSize;
+  const uint32 expected_crc = core::DecodeFixed32(trailer);
+  data->resize(core::DecodeFixed32(trailer + 4));
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+    return errors::Internal("inflateInit2() failed");
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(member.data()));
+  stream.avail_in = member.size() - kTrailerSize;
+  stream.next_out = reinterpret_cast<Bytef*>(&(*data)[0]);
+  stream.avail_out = data->size();
+  const int error = inflate(&stream, Z_FINISH);
+  const bool complete = stream.avail_out == 0 && stream.avail_in == 0;
+  inflateEnd(&stream);
+  if (error != Z_STREAM_END || !complete) {
+    return errors::DataLoss("Corrupted gzip member: inflate() returned ",
+                            error);
+  }
+  const uint32 crc = crc32(crc32(0L, Z_NULL, 0),
+                           reinterpret_cast<const Bytef*>(data->data()),
+                           data->size());
+  if (crc != expected_crc) {
+    return errors::DataLoss("Corrupted gzip member: CRC mismatch");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+bool ParseGzipBlockHeader(StringPiece header, uint32* member_size) {
+  if (header.size() < kGzipBlockHeaderSize) {
+    return false;
+  }
+  const uint8* bytes = reinterpret_cast<const uint8*>(header.data());
+  if (bytes[0] != kGzipId1 || bytes[1] != kGzipId2 ||
+      bytes[2] != kGzipDeflate || bytes[3] != kGzipFlagExtra ||
+      core::DecodeFixed16(header.data() + 10) != kExtraSize ||
+      bytes[12] != 'T' || bytes[13] != 'F' ||
+      core::DecodeFixed16(header.data() + 14) != kSubfieldSize) {
+    return false;
+  }
+  *member_size = core::DecodeFixed32(header.data() + 16);
+  return *member_size >= kGzipBlockHeaderSize + kTrailerSize;
+}
+
+bool IsGzipBlockFile(RandomAccessFile* file) {
+  char scratch[kGzipBlockHeaderSize];
+  StringPiece header;
+  uint32 member_size;
+  return file->Read(0, kGzipBlockHeaderSize, &header, scratch).ok() &&
+         ParseGzipBlockHeader(header, &member_size);
+}
+
+GzipBlockOutputBuffer::GzipBlockOutputBuffer(
+    WritableFile* file, int64 block_size,
+    const ZlibCompressionOptions& zlib_options)
+    : file_(file), block_size_(block_size), zlib_options_(zlib_options) {}
+
+GzipBlockOutputBuffer::~GzipBlockOutputBuffer() {
+  if (!closed_ && !buffer_.empty()) {
+    LOG(WARNING) << "GzipBlockOutputBuffer::Close() not called. Possible data "
+                    "loss";
+  }
+}
+
+Status GzipBlockOutputBuffer::Append(const StringPiece& data) {
+  if (closed_) {
+    return errors::FailedPrecondition("GzipBlockOutputBuffer is closed");
+  }
+  StringPiece remaining = data;
+  while (!remaining.empty()) {
+    const size_t n = std::min(remaining.size(), block_size_ - buffer_.size());
+    buffer_.append(remaining.data(), n);
+    remaining.remove_prefix(n);
+    if (buffer_.size() == block_size_) {
+      TF_RETURN_IF_ERROR(WriteMember());
+    }
+  }
+  return Status::OK();
+}
+
+Status GzipBlockOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("GzipBlockOutputBuffer is closed");
+  }
+  TF_RETURN_IF_ERROR(WriteMember());
+  return file_->Flush();
+}
+
+Status GzipBlockOutputBuffer::Close() {
+  if (closed_) {
+    return errors::FailedPrecondition("GzipBlockOutputBuffer is closed");
+  }
+  TF_RETURN_IF_ERROR(WriteMember());
+  closed_ = true;
+  return Status::OK();
+}
+
+Status GzipBlockOutputBuffer::Sync() {
+  if (closed_) {
+    return errors::FailedPrecondition("GzipBlockOutputBuffer is closed");
+  }
+  TF_RETURN_IF_ERROR(WriteMember());
+  return file_->Sync();
+}
+
+Status GzipBlockOutputBuffer::WriteMember() {
+  if (buffer_.empty()) {
+    return Status::OK();
+  }
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, zlib_options_.compression_level,
+                   zlib_options_.compression_method, -MAX_WBITS,
+                   zlib_options_.mem_level,
+                   zlib_options_.compression_strategy) != Z_OK) {
+    return errors::Internal("deflateInit2() failed");
+  }
+  string member(kGzipBlockHeaderSize +
+                    deflateBound(&stream, buffer_.size()) + kTrailerSize,
+                '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(&buffer_[0]);
+  stream.avail_in = buffer_.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&member[kGzipBlockHeaderSize]);
+  stream.avail_out = member.size() - kGzipBlockHeaderSize - kTrailerSize;
+  const int error = deflate(&stream, Z_FINISH);
+  const size_t compressed_size = stream.total_out;
+  deflateEnd(&stream);
+  if (error != Z_STREAM_END) {
+    return errors::DataLoss("deflate() failed with error ", error);
+  }
+  member.resize(kGzipBlockHeaderSize + compressed_size + kTrailerSize);
+
+  char* header = &member[0];
+  header[0] = kGzipId1;
+  header[1] = kGzipId2;
+  header[2] = kGzipDeflate;
+  header[3] = kGzipFlagExtra;
+  // MTIME (4 bytes) and XFL are left at zero.
+  header[9] = kGzipOsUnknown;
+  core::EncodeFixed16(header + 10, kExtraSize);
+  header[12] = 'T';
+  header[13] = 'F';
+  core::EncodeFixed16(header + 14, kSubfieldSize);
+  core::EncodeFixed32(header + 16, member.size());
+  char* trailer = &member[member.size() - kTrailerSize];
+  core::EncodeFixed32(
+      trailer, crc32(crc32(0L, Z_NULL, 0),
+                     reinterpret_cast<const Bytef*>(buffer_.data()),
+                     buffer_.size()));
+  core::EncodeFixed32(trailer + 4, buffer_.size());
+  buffer_.clear();
+  return file_->Append(member);
+}
+
+struct GzipBlockInputStream::Member {
+  Notification inflated;
+  string data;
+  Status status;
+};
+
+GzipBlockInputStream::GzipBlockInputStream(InputStreamInterface* input_stream,
+                                           int parallelism,
+                                           bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      parallelism_(std::max(parallelism, 1)),
+      thread_pool_(new thread::ThreadPool(Env::Default(), "gzip_block_inflate",
+                                          parallelism_)) {}
+
+GzipBlockInputStream::~GzipBlockInputStream() {
+  ClearQueue();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status GzipBlockInputStream::FillQueue() {
+  string header;
+  while (queue_.size() < static_cast<size_t>(parallelism_) && !input_eof_) {
+    Status s = input_stream_->ReadNBytes(kGzipBlockHeaderSize, &header);
+    if (errors::IsOutOfRange(s) && header.empty()) {
+      input_eof_ = true;
+      break;
+    }
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      return s;
+    }
+    uint32 member_size;
+    if (!ParseGzipBlockHeader(header, &member_size)) {
+      return errors::DataLoss("Invalid blocked gzip member header");
+    }
+    std::shared_ptr<Member> member(new Member);
+    auto compressed = std::make_shared<string>();
+    s = input_stream_->ReadNBytes(member_size - kGzipBlockHeaderSize,
+                                  compressed.get());
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("Truncated blocked gzip member");
+    }
+    TF_RETURN_IF_ERROR(s);
+    thread_pool_->Schedule([member, compressed]() {
+      member->status = InflateMember(*compressed, &member->data);
+      member->inflated.Notify();
+    });
+    queue_.push_back(std::move(member));
+  }
+  return Status::OK();
+}
+
+void GzipBlockInputStream::ClearQueue() {
+  for (const auto& member : queue_) {
+    member->inflated.WaitForNotification();
+  }
+  queue_.clear();
+  member_pos_ = 0;
+}
+
+Status GzipBlockInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
+  result->clear();
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    TF_RETURN_IF_ERROR(FillQueue());
+    if (queue_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    Member* member = queue_.front().get();
+    member->inflated.WaitForNotification();
+    TF_RETURN_IF_ERROR(member->status);
+    const size_t n =
+        std::min(member->data.size() - member_pos_,
+                 static_cast<size_t>(bytes_to_read) - result->size());
+    result->append(member->data, member_pos_, n);
+    member_pos_ += n;
+    bytes_read_ += n;
+    if (member_pos_ == member->data.size()) {
+      queue_.pop_front();
+      member_pos_ = 0;
+    }
+  }
+  return Status::OK();
+}
+
+int64 GzipBlockInputStream::Tell() const { return bytes_read_; }
+
+Status GzipBlockInputStream::Reset() {
+  ClearQueue();
+  input_eof_ = false;
+  bytes_read_ = 0;
+  return input_stream_->Reset();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,148 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_GZIP_BLOCKS_H_
+#define TENSORFLOW_CORE_LIB_IO_GZIP_BLOCKS_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/zlib_compression_options.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Blocked gzip files are a sequence of complete gzip members (RFC 1952), each
+// compressing up to a block of the data independently. Concatenated members
+// decompress to the concatenation of their data, so any gzip reader can read
+// these files. The header of each member has an extra field (subfield id
+// "TF", 4 bytes little-endian) holding the size of the whole member, so that
+// GzipBlockInputStream can find the members without inflating them, and
+// inflate several of them at once.
+
+// The size of the header of a member of a blocked gzip file.
+constexpr size_t kGzipBlockHeaderSize = 20;
+
+// Returns true if `header` is the header of a member of a blocked gzip file,
+// and sets `*member_size` to the size of the member.
+bool ParseGzipBlockHeader(StringPiece header, uint32* member_size);
+
+// Returns true if `file` starts with a member of a blocked gzip file.
+bool IsGzipBlockFile(RandomAccessFile* file);
+
+// Writes a blocked gzip file. Every `block_size` bytes appended are deflated
+// into a member, with the level, memory level and strategy of
+// `zlib_options`.
+//
+// A given instance of an GzipBlockOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class GzipBlockOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`.
+  GzipBlockOutputBuffer(WritableFile* file, int64 block_size,
+                        const ZlibCompressionOptions& zlib_options);
+
+  ~GzipBlockOutputBuffer() override;
+
+  Status Append(const StringPiece& data) override;
+
+  // Writes the buffered data as a (short) member and flushes the file.
+  Status Flush() override;
+
+  // Writes the buffered data as a member. Does not close the file.
+  //
+  // After calling this, any further calls to `Append()`, `Flush()` or
+  // `Close()` will fail.
+  Status Close() override;
+
+  // Writes the buffered data as a member and syncs the file.
+  Status Sync() override;
+
+ private:
+  // Deflates `buffer_` into a member and appends it to `file_`.
+  Status WriteMember();
+
+  WritableFile* file_;  // Not owned
+  const size_t block_size_;
+  const ZlibCompressionOptions zlib_options_;
+  string buffer_;
+  bool closed_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GzipBlockOutputBuffer);
+};
+
+// Reads a blocked gzip file, inflating up to `parallelism` members ahead of
+// the reads on as many threads.
+//
+// A given instance of an GzipBlockInputStream is NOT safe for concurrent use
+// by multiple threads.
+class GzipBlockInputStream : public InputStreamInterface {
+ public:
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  GzipBlockInputStream(InputStreamInterface* input_stream, int parallelism,
+                       bool owns_input_stream);
+
+  ~GzipBlockInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the stream is not a valid blocked gzip file.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // A member being inflated.
+  struct Member;
+
+  // Reads members from the input and schedules their inflation, until
+  // `parallelism_` members are queued or the input ends.
+  Status FillQueue();
+
+  // Waits for the queued members and drops them.
+  void ClearQueue();
+
+  const bool owns_input_stream_;
+  InputStreamInterface* input_stream_;
+  const int parallelism_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // The queued members, in file order.
+  std::deque<std::shared_ptr<Member>> queue_;
+  // The position of the next unread byte in the data of the front member.
+  size_t member_pos_ = 0;
+  bool input_eof_ = false;
+  int64 bytes_read_ = 0;  // Bytes read from the uncompressed stream.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GzipBlockInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_GZIP_BLOCKS_H_
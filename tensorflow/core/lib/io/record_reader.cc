@@ -16,12 +16,17 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 
 #include <limits.h>
+#include <string.h>
+#include <algorithm>
 
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
+#if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/gzip_blocks.h"
+#endif  // IS_SLIM_BUILD
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/env.h"
 
@@ -68,9 +73,15 @@ RecordReader::RecordReader(RandomAccessFile* file,
 #if defined(IS_SLIM_BUILD)
     LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
 #else   // IS_SLIM_BUILD
-    input_stream_.reset(new ZlibInputStream(
-        input_stream_.release(), options.zlib_options.input_buffer_size,
-        options.zlib_options.output_buffer_size, options.zlib_options, true));
+    if (options.decompression_parallelism > 1 && IsGzipBlockFile(file)) {
+      input_stream_.reset(new GzipBlockInputStream(
+          input_stream_.release(), options.decompression_parallelism, true));
+    } else {
+      input_stream_.reset(new ZlibInputStream(
+          input_stream_.release(), options.zlib_options.input_buffer_size,
+          options.zlib_options.output_buffer_size, options.zlib_options,
+          true));
+    }
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -152,5 +163,142 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status ReadRecordIndex(RandomAccessFile* index_file,
+                       std::vector<uint64>* offsets) {
+  static const size_t kReadSize = 1 << 20;
+
+  offsets->clear();
+  string buffer(kReadSize, '\0');
+  uint64 file_offset = 0;
+  while (true) {
+    StringPiece result;
+    Status s = index_file->Read(file_offset, kReadSize, &result, &buffer[0]);
+    if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+    if (result.size() % sizeof(uint64) != 0) {
+      return errors::DataLoss("truncated record index at ",
+                              file_offset + result.size());
+    }
+    for (size_t i = 0; i < result.size(); i += sizeof(uint64)) {
+      offsets->push_back(core::DecodeFixed64(result.data() + i));
+    }
+    file_offset += result.size();
+    if (result.size() < kReadSize) break;
+  }
+  return Status::OK();
+}
+
+BatchedRecordReader::BatchedRecordReader(Env* env, RandomAccessFile* file,
+                                         size_t chunk_size)
+    : env_(env),
+      file_(file),
+      // A full chunk always holds at least a record header.
+      chunk_size_(std::max(chunk_size, sizeof(uint64) + sizeof(uint32))) {}
+
+BatchedRecordReader::~BatchedRecordReader() { WaitForPrefetch().IgnoreError(); }
+
+Status BatchedRecordReader::ReadChunk(uint64 offset, size_t n,
+                                      string* buffer) {
+  buffer->resize(n);
+  StringPiece result;
+  Status s = file_->Read(offset, n, &result, &(*buffer)[0]);
+  if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+  if (result.data() != buffer->data()) {
+    memmove(&(*buffer)[0], result.data(), result.size());
+  }
+  buffer->resize(result.size());
+  return Status::OK();
+}
+
+void BatchedRecordReader::StartPrefetch() {
+  {
+    mutex_lock l(mu_);
+    prefetch_in_flight_ = true;
+  }
+  next_offset_ = offset_;
+  env_->SchedClosure([this]() {
+    Status s = ReadChunk(next_offset_, chunk_size_, &next_);
+    mutex_lock l(mu_);
+    prefetch_status_ = s;
+    prefetch_in_flight_ = false;
+    prefetch_done_cv_.notify_all();
+  });
+}
+
+Status BatchedRecordReader::WaitForPrefetch() {
+  mutex_lock l(mu_);
+  while (prefetch_in_flight_) {
+    prefetch_done_cv_.wait(l);
+  }
+  return prefetch_status_;
+}
+
+Status BatchedRecordReader::ReadBatch(std::vector<StringPiece>* records) {
+  static const size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
+  static const size_t kFooterSize = sizeof(uint32);
+
+  records->clear();
+  if (eof_) return errors::OutOfRange("eof");
+
+  // Takes the chunk prefetched at offset_, or reads it if there is none (on
+  // the first call, or after a record that did not fit in a chunk).
+  TF_RETURN_IF_ERROR(WaitForPrefetch());
+  if (next_offset_ == offset_ && !next_.empty()) {
+    current_.swap(next_);
+    next_.clear();
+  } else {
+    TF_RETURN_IF_ERROR(ReadChunk(offset_, chunk_size_, &current_));
+  }
+  buffer_offset_ = offset_;
+
+  size_t pos = 0;
+  while (true) {
+    const size_t remaining = current_.size() - pos;
+    if (remaining < kHeaderSize) break;
+    const char* header = current_.data() + pos;
+    const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+      return errors::DataLoss("corrupted record at ", buffer_offset_ + pos);
+    }
+    const uint64 length = core::DecodeFixed64(header);
+    if (remaining < kHeaderSize + kFooterSize ||
+        length > remaining - kHeaderSize - kFooterSize) {
+      if (records->empty()) {
+        // The record does not fit in a chunk: reads it whole.
+        if (length >= SIZE_MAX - kHeaderSize - kFooterSize) {
+          return errors::DataLoss("record size too large");
+        }
+        TF_RETURN_IF_ERROR(ReadChunk(buffer_offset_ + pos,
+                                     kHeaderSize + length + kFooterSize,
+                                     &current_));
+        buffer_offset_ += pos;
+        pos = 0;
+        if (current_.size() < kHeaderSize + length + kFooterSize) {
+          return errors::DataLoss("truncated record at ", buffer_offset_);
+        }
+        continue;
+      }
+      break;
+    }
+    const char* data = header + kHeaderSize;
+    const uint32 masked_data_crc = core::DecodeFixed32(data + length);
+    if (crc32c::Unmask(masked_data_crc) != crc32c::Value(data, length)) {
+      return errors::DataLoss("corrupted record at ", buffer_offset_ + pos);
+    }
+    records->emplace_back(data, length);
+    pos += kHeaderSize + length + kFooterSize;
+  }
+  offset_ = buffer_offset_ + pos;
+
+  if (records->empty()) {
+    eof_ = true;
+    if (pos < current_.size()) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    return errors::OutOfRange("eof");
+  }
+  StartPrefetch();
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
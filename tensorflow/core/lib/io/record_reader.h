@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
@@ -24,10 +26,13 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
+class Env;
 class RandomAccessFile;
 
 namespace io {
@@ -48,6 +53,11 @@ class RecordReaderOptions {
 #if !defined(IS_SLIM_BUILD)
   // Options specific to zlib compression.
   ZlibCompressionOptions zlib_options;
+
+  // If greater than one and a compressed file is a blocked gzip file (see
+  // RecordWriterOptions::compression_block_size), up to this many blocks are
+  // inflated in parallel, ahead of the reads.
+  int decompression_parallelism = 0;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -119,6 +129,76 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Reads into "*offsets" the index of a TFRecord file written by a RecordWriter
+// with an "index_dest": the offset of each record of the file, in order.
+// Record i of an uncompressed file can then be read directly with
+// RecordReader::ReadRecord() at (*offsets)[i], and the records of the file
+// split into balanced shards.
+Status ReadRecordIndex(RandomAccessFile* index_file,
+                       std::vector<uint64>* offsets);
+
+// Reads the records of an uncompressed TFRecord file sequentially, many at a
+// time, for readers that are limited by I/O rather than by parsing.
+//
+// Each ReadBatch() returns the complete records of the next chunk of the file
+// as pieces of an internal buffer, without copying them. While the caller
+// consumes a batch, the next chunk is read with one large read on a
+// background thread.
+//
+// Note: this class is not thread safe; external synchronization required.
+class BatchedRecordReader {
+ public:
+  // Create a reader that will return the records of "*file", reading about
+  // "chunk_size" bytes at a time.  "*env" and "*file" must remain live while
+  // this reader is in use.
+  BatchedRecordReader(Env* env, RandomAccessFile* file,
+                      size_t chunk_size = 4 << 20);
+
+  // Waits for the read in flight, if any.
+  ~BatchedRecordReader();
+
+  // Replaces "*records" with the next records of the file.  The pieces stay
+  // valid until the next call.  Returns OK on success (with at least one
+  // record), OUT_OF_RANGE at the end of the file, or something else for an
+  // error.
+  Status ReadBatch(std::vector<StringPiece>* records);
+
+  // Returns the offset in the file of the first record that has not been
+  // returned yet.
+  uint64 TellOffset() const { return offset_; }
+
+ private:
+  // Reads "n" bytes at "offset" into "*buffer", fewer at the end of the file.
+  Status ReadChunk(uint64 offset, size_t n, string* buffer);
+
+  // Starts reading the chunk at offset_ into next_ in the background.
+  void StartPrefetch();
+
+  // Waits for the prefetch started last, and returns its status.
+  Status WaitForPrefetch();
+
+  Env* const env_;
+  RandomAccessFile* const file_;
+  const size_t chunk_size_;
+
+  // The bytes of the current batch, starting at file offset buffer_offset_.
+  string current_;
+  uint64 buffer_offset_ = 0;
+  // Offset of the first record not returned yet.
+  uint64 offset_ = 0;
+  bool eof_ = false;
+
+  // The chunk being prefetched, at file offset next_offset_.
+  string next_;
+  uint64 next_offset_ = 0;
+  mutex mu_;
+  condition_variable prefetch_done_cv_;
+  bool prefetch_in_flight_ GUARDED_BY(mu_) = false;
+  Status prefetch_status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BatchedRecordReader);
+};
+
 }  // namespace io
 }  // namespace tensorflow
 
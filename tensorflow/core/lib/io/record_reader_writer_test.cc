@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/gzip_blocks.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -105,4 +106,152 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestGzipBlocks) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_gzip_blocks_test";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(string(i, 'a' + i % 26));
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions("GZIP");
+    options.compression_block_size = 100;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  // Blocks are inflated in parallel with decompression_parallelism, and the
+  // file is still a valid gzip file without it.
+  for (int parallelism : {4, 0}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    EXPECT_TRUE(io::IsGzipBlockFile(read_file.get()));
+    io::RecordReaderOptions options =
+        io::RecordReaderOptions::CreateRecordReaderOptions("GZIP");
+    options.decompression_parallelism = parallelism;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    string record;
+    for (const string& expected : records) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+    // Reading an earlier record restarts from the beginning.
+    offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[0], record);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".index";
+
+  std::vector<string> expected;
+  for (int i = 0; i < 50; ++i) {
+    expected.push_back(strings::StrCat("record", string(i, 'x')));
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+    io::RecordWriter writer(file.get(), index_file.get());
+    for (const string& record : expected) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  std::unique_ptr<RandomAccessFile> index_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &index_file));
+  std::vector<uint64> offsets;
+  TF_CHECK_OK(io::ReadRecordIndex(index_file.get(), &offsets));
+  ASSERT_EQ(expected.size(), offsets.size());
+
+  // Reads the records backwards, seeking to each.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  for (int i = expected.size() - 1; i >= 0; --i) {
+    uint64 offset = offsets[i];
+    string record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(expected[i], record);
+    if (i + 1 < expected.size()) {
+      EXPECT_EQ(offsets[i + 1], offset);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestBatchedReader) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_batched_test";
+
+  std::vector<string> expected;
+  for (int i = 0; i < 100; ++i) {
+    expected.push_back(string(i * 7 % 50, 'a' + i % 26));
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : expected) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (size_t chunk_size : {1, 20, 100, 1 << 20}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::BatchedRecordReader reader(env, read_file.get(), chunk_size);
+    std::vector<string> records;
+    std::vector<StringPiece> batch;
+    Status s;
+    while ((s = reader.ReadBatch(&batch)).ok()) {
+      EXPECT_FALSE(batch.empty());
+      for (StringPiece record : batch) {
+        records.push_back(std::string(record));
+      }
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+    EXPECT_EQ(expected, records);
+    uint64 file_size;
+    TF_CHECK_OK(env->GetFileSize(fname, &file_size));
+    EXPECT_EQ(file_size, reader.TellOffset());
+  }
+}
+
+TEST(RecordReaderWriterTest, TestBatchedReaderTruncated) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_truncated_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_CHECK_OK(writer.Flush());
+    // Half a record.
+    TF_CHECK_OK(file->Append("0123456"));
+  }
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::BatchedRecordReader reader(env, read_file.get());
+  std::vector<StringPiece> batch;
+  TF_CHECK_OK(reader.ReadBatch(&batch));
+  ASSERT_EQ(1, batch.size());
+  EXPECT_EQ("abc", batch[0]);
+  EXPECT_TRUE(errors::IsDataLoss(reader.ReadBatch(&batch)));
+}
+
 }  // namespace tensorflow
@@ -18,6 +18,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
+#if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/gzip_blocks.h"
+#endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -62,6 +65,11 @@ RecordWriter::RecordWriter(WritableFile* dest,
 #if defined(IS_SLIM_BUILD)
     LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
 #else   // IS_SLIM_BUILD
+    if (options.compression_block_size > 0) {
+      dest_ = new GzipBlockOutputBuffer(dest, options.compression_block_size,
+                                        options.zlib_options);
+      return;
+    }
     ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
         dest, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options);
@@ -79,6 +87,12 @@ RecordWriter::RecordWriter(WritableFile* dest,
   }
 }
 
+RecordWriter::RecordWriter(WritableFile* dest, WritableFile* index_dest,
+                           const RecordWriterOptions& options)
+    : RecordWriter(dest, options) {
+  index_dest_ = index_dest;
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     Status s = Close();
@@ -105,6 +119,14 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[sizeof(uint32)];
   core::EncodeFixed32(footer, MaskedCrc(data.data(), data.size()));
 
+  if (index_dest_ != nullptr) {
+    char offset[sizeof(uint64)];
+    core::EncodeFixed64(offset, offset_);
+    TF_RETURN_IF_ERROR(
+        index_dest_->Append(StringPiece(offset, sizeof(offset))));
+  }
+  offset_ += sizeof(header) + data.size() + sizeof(footer);
+
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -42,6 +42,12 @@ class RecordWriterOptions {
 // Options specific to zlib compression.
 #if !defined(IS_SLIM_BUILD)
   ZlibCompressionOptions zlib_options;
+
+  // If non-zero, a compressed file is instead written as a blocked gzip file
+  // (see gzip_blocks.h) with blocks of this many bytes, which
+  // RecordReaderOptions::decompression_parallelism can inflate in parallel.
+  // The file can still be read as a GZIP file.
+  int64 compression_block_size = 0;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -53,6 +59,16 @@ class RecordWriter {
   RecordWriter(WritableFile* dest,
                const RecordWriterOptions& options = RecordWriterOptions());
 
+  // Like above, and also appends the offset of each record to "*index_dest",
+  // as a fixed64, so that a reader can seek to any record, or split the file
+  // into shards of records, without scanning it (see ReadRecordIndex() in
+  // record_reader.h).  The offsets are in the uncompressed stream, so they
+  // only allow direct seeks in uncompressed files.
+  // "*index_dest" must be initially empty.
+  // "*index_dest" must remain live while this Writer is in use.
+  RecordWriter(WritableFile* dest, WritableFile* index_dest,
+               const RecordWriterOptions& options = RecordWriterOptions());
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -75,6 +91,9 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  WritableFile* index_dest_ = nullptr;  // Not owned.
+  // Offset of the next record in the uncompressed stream.
+  uint64 offset_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordWriter);
 };
@@ -197,6 +197,12 @@ Status ZlibInputStream::Inflate() {
     }
     return errors::DataLoss(error_string);
   }
+  if (error == Z_STREAM_END && zlib_options_.window_bits > MAX_WBITS) {
+    // A gzip stream may hold several members, which decompress to the
+    // concatenation of their data (e.g. blocked gzip files, see
+    // gzip_blocks.h). Get ready for the next one.
+    inflateReset(z_stream_.get());
+  }
   return Status::OK();
 }
 
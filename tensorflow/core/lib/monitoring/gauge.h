@@ -77,6 +77,10 @@ class GaugeCell<int64> {
   // Atomically sets the value.
   void Set(int64 value);
 
+  // Atomically increments the value by `delta`, which may be negative, e.g.
+  // to track the length of a queue.
+  void IncrementBy(int64 delta);
+
   // Retrieves the current value.
   int64 value() const;
 
@@ -194,6 +198,10 @@ T GaugeCell<T>::value() const {
 
 inline void GaugeCell<int64>::Set(int64 value) { value_ = value; }
 
+inline void GaugeCell<int64>::IncrementBy(int64 delta) {
+  value_.fetch_add(delta, std::memory_order_relaxed);
+}
+
 inline int64 GaugeCell<int64>::value() const { return value_; }
 
 inline void GaugeCell<bool>::Set(bool value) { value_ = value; }
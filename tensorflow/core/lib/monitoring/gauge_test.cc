@@ -65,6 +65,15 @@ TEST(UnlabeledGaugeTest, GetCell) {
   EXPECT_EQ(10, same_cell->value());
 }
 
+TEST(UnlabeledGaugeTest, IncrementBy) {
+  auto* cell = gauge_without_labels->GetCell();
+  cell->Set(5);
+  cell->IncrementBy(3);
+  EXPECT_EQ(8, cell->value());
+  cell->IncrementBy(-10);
+  EXPECT_EQ(-2, cell->value());
+}
+
 auto* string_gauge = Gauge<string, 0>::New("/tensorflow/test/string_gauge",
                                            "Gauge of string value.");
 
@@ -33,6 +33,7 @@ class GaugeCell {
   ~GaugeCell() {}
 
   void Set(const T& value) {}
+  void IncrementBy(const T& delta) {}
   T value() const { return T(); }
 
  private:
@@ -0,0 +1,163 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+
+#include <float.h>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+const char kPrometheusTextContentType[] = "text/plain; version=0.0.4";
+
+namespace {
+
+// Escapes a label value, or a help text if `escape_quotes` is false.
+string Escape(const string& s, bool escape_quotes) {
+  string escaped;
+  for (char c : s) {
+    if (c == '\\') {
+      escaped.append("\\\\");
+    } else if (c == '\n') {
+      escaped.append("\\n");
+    } else if (c == '"' && escape_quotes) {
+      escaped.append("\\\"");
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+string FormatDouble(double value) {
+  if (value >= DBL_MAX) return "+Inf";
+  if (value <= -DBL_MAX) return "-Inf";
+  return strings::StrCat(value);
+}
+
+// Returns the labels of `point`, followed by `extra_label` if not empty, in
+// the Prometheus format, e.g. {allocator="GPU_0_bfc",le="10"}.
+string FormatLabels(const Point& point, const string& extra_label) {
+  std::vector<string> labels;
+  for (const Point::Label& label : point.labels) {
+    labels.push_back(strings::StrCat(PrometheusMetricName(label.name), "=\"",
+                                     Escape(label.value, true), "\""));
+  }
+  if (!extra_label.empty()) {
+    labels.push_back(extra_label);
+  }
+  if (labels.empty()) {
+    return "";
+  }
+  string formatted = "{";
+  for (size_t i = 0; i < labels.size(); ++i) {
+    strings::StrAppend(&formatted, i > 0 ? "," : "", labels[i]);
+  }
+  formatted.push_back('}');
+  return formatted;
+}
+
+const char* PrometheusType(const MetricDescriptor& descriptor) {
+  if (descriptor.value_type == ValueType::kHistogram) {
+    return "histogram";
+  }
+  if (descriptor.metric_kind == MetricKind::kCumulative) {
+    return "counter";
+  }
+  return "gauge";
+}
+
+void AppendPoint(const string& name, const Point& point, string* output) {
+  switch (point.value_type) {
+    case ValueType::kInt64:
+      strings::StrAppend(output, name, FormatLabels(point, ""), " ",
+                         point.int64_value, "\n");
+      break;
+    case ValueType::kBool:
+      strings::StrAppend(output, name, FormatLabels(point, ""), " ",
+                         point.bool_value ? 1 : 0, "\n");
+      break;
+    case ValueType::kString:
+      strings::StrAppend(
+          output, name,
+          FormatLabels(point, strings::StrCat("value=\"",
+                                              Escape(point.string_value, true),
+                                              "\"")),
+          " 1\n");
+      break;
+    case ValueType::kHistogram: {
+      const HistogramProto& histogram = point.histogram_value;
+      double count = 0;
+      for (int i = 0; i < histogram.bucket_size(); ++i) {
+        count += histogram.bucket(i);
+        if (i + 1 == histogram.bucket_size() &&
+            histogram.bucket_limit(i) >= DBL_MAX) {
+          // Always emitted below.
+          break;
+        }
+        const string le = strings::StrCat(
+            "le=\"", FormatDouble(histogram.bucket_limit(i)), "\"");
+        strings::StrAppend(output, name, "_bucket", FormatLabels(point, le),
+                           " ", FormatDouble(count), "\n");
+      }
+      strings::StrAppend(output, name, "_bucket",
+                         FormatLabels(point, "le=\"+Inf\""), " ",
+                         FormatDouble(histogram.num()), "\n");
+      strings::StrAppend(output, name, "_sum", FormatLabels(point, ""), " ",
+                         FormatDouble(histogram.sum()), "\n");
+      strings::StrAppend(output, name, "_count", FormatLabels(point, ""), " ",
+                         FormatDouble(histogram.num()), "\n");
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+string PrometheusMetricName(const string& metric_name) {
+  string name;
+  for (char c : metric_name) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9' && !name.empty()) || c == '_') {
+      name.push_back(c);
+    } else if (!name.empty()) {
+      name.push_back('_');
+    }
+  }
+  return name;
+}
+
+string ExportPrometheusText(const CollectedMetrics& metrics) {
+  string output;
+  for (const auto& point_set : metrics.point_set_map) {
+    const string name = PrometheusMetricName(point_set.first);
+    auto descriptor = metrics.metric_descriptor_map.find(point_set.first);
+    if (descriptor != metrics.metric_descriptor_map.end()) {
+      strings::StrAppend(&output, "# HELP ", name, " ",
+                         Escape(descriptor->second->description, false), "\n",
+                         "# TYPE ", name, " ",
+                         PrometheusType(*descriptor->second), "\n");
+    }
+    for (const auto& point : point_set.second->points) {
+      AppendPoint(name, *point, &output);
+    }
+  }
+  return output;
+}
+
+}  // namespace monitoring
+}  // namespace tensorflow
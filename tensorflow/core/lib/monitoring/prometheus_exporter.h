@@ -0,0 +1,45 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
+#define TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
+
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+// The content type of the output of ExportPrometheusText().
+extern const char kPrometheusTextContentType[];
+
+// Formats the collected metrics in the Prometheus text exposition format.
+//
+// Metric names are converted to Prometheus names by replacing the path
+// separators, e.g. "/tensorflow/core/direct_session_runs" is exported as
+// "tensorflow_core_direct_session_runs". Cumulative int64 metrics are exported
+// as counters, int64 and bool gauges as gauges, and histograms as histograms
+// with cumulative buckets. String gauges are exported as gauges of value 1,
+// with the string in a "value" label.
+string ExportPrometheusText(const CollectedMetrics& metrics);
+
+// Returns the Prometheus name of a metric, e.g.
+// "tensorflow_core_direct_session_runs".
+string PrometheusMetricName(const string& metric_name);
+
+}  // namespace monitoring
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
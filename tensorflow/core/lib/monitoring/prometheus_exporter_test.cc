@@ -0,0 +1,90 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace monitoring {
+namespace {
+
+auto* counter = Counter<1>::New("/tensorflow/test/prometheus/counter",
+                                "A counter.", "my-label");
+auto* int_gauge = Gauge<int64, 0>::New("/tensorflow/test/prometheus/gauge",
+                                       "A gauge\nwith two lines.");
+auto* string_gauge = Gauge<string, 0>::New(
+    "/tensorflow/test/prometheus/string_gauge", "A string gauge.");
+auto* sampler = Sampler<0>::New(
+    {"/tensorflow/test/prometheus/sampler", "A sampler."},
+    Buckets::Explicit({10.0, 20.0}));
+
+string Export() {
+  return ExportPrometheusText(*CollectionRegistry::Default()->CollectMetrics(
+      CollectionRegistry::CollectMetricsOptions()));
+}
+
+TEST(PrometheusExporterTest, MetricName) {
+  EXPECT_EQ("tensorflow_core_direct_session_runs",
+            PrometheusMetricName("/tensorflow/core/direct_session_runs"));
+  EXPECT_EQ("a_b_c", PrometheusMetricName("/a-b/c"));
+  EXPECT_EQ("gpu_0", PrometheusMetricName("/0/gpu/0"));
+}
+
+TEST(PrometheusExporterTest, Counter) {
+  counter->GetCell("a\"b")->IncrementBy(3);
+  const string output = Export();
+  EXPECT_TRUE(str_util::StrContains(
+      output, "# HELP tensorflow_test_prometheus_counter A counter.\n"
+              "# TYPE tensorflow_test_prometheus_counter counter\n"
+              "tensorflow_test_prometheus_counter{my_label=\"a\\\"b\"} 3\n"));
+}
+
+TEST(PrometheusExporterTest, Gauges) {
+  int_gauge->GetCell()->Set(-7);
+  string_gauge->GetCell()->Set("v1");
+  const string output = Export();
+  EXPECT_TRUE(str_util::StrContains(
+      output, "# HELP tensorflow_test_prometheus_gauge A gauge\\nwith two "
+              "lines.\n"
+              "# TYPE tensorflow_test_prometheus_gauge gauge\n"
+              "tensorflow_test_prometheus_gauge -7\n"));
+  EXPECT_TRUE(str_util::StrContains(
+      output, "tensorflow_test_prometheus_string_gauge{value=\"v1\"} 1\n"));
+}
+
+TEST(PrometheusExporterTest, Histogram) {
+  sampler->GetCell()->Add(5.0);
+  sampler->GetCell()->Add(15.0);
+  sampler->GetCell()->Add(16.0);
+  sampler->GetCell()->Add(100.0);
+  const string output = Export();
+  EXPECT_TRUE(str_util::StrContains(
+      output, "# TYPE tensorflow_test_prometheus_sampler histogram\n"
+              "tensorflow_test_prometheus_sampler_bucket{le=\"10\"} 1\n"
+              "tensorflow_test_prometheus_sampler_bucket{le=\"20\"} 3\n"
+              "tensorflow_test_prometheus_sampler_bucket{le=\"+Inf\"} 4\n"
+              "tensorflow_test_prometheus_sampler_sum 136\n"
+              "tensorflow_test_prometheus_sampler_count 4\n"));
+}
+
+}  // namespace
+}  // namespace monitoring
+}  // namespace tensorflow
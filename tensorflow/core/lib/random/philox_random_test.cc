@@ -68,6 +68,22 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating several groups at once, including across
+// the carry of the lowest counter word, gives the same samples as one group
+// at a time.
+TEST(PhiloxRandomTest, BatchedMatchTest) {
+  PhiloxRandom gen(GetTestSeed());
+  gen.Skip(0xfffffffa);
+  BatchedPhiloxRandom<8> batched_gen(gen);
+  for (int i = 0; i < 20; ++i) {
+    const PhiloxRandom::ResultType expected = gen();
+    const PhiloxRandom::ResultType actual = batched_gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(expected[j], actual[j]);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -64,6 +64,8 @@ PHILOX_DEVICE_INLINE Int SignedAdd(Int a,
 //              actual returned sample type.
 //   RealType: the data type of the real numbers that will be returned by the
 //             distribution. This could be either float or double for now.
+// Samples can also be drawn from any other generator with the same ResultType,
+// such as a BatchedPhiloxRandom wrapping a Generator.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
 template <class Generator, typename RealType>
@@ -82,8 +84,8 @@ class UniformDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -106,8 +108,8 @@ class UniformDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -130,8 +132,8 @@ class UniformDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -154,8 +156,8 @@ class UniformDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -182,8 +184,8 @@ class UniformDistribution<Generator, int32> {
   UniformDistribution(int32 lo, int32 hi)
       : lo_(lo), range_(static_cast<uint32>(hi) - static_cast<uint32>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -217,8 +219,8 @@ class UniformDistribution<Generator, int64> {
   UniformDistribution(int64 lo, int64 hi)
       : lo_(lo), range_(static_cast<uint64>(hi) - static_cast<uint64>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -307,6 +309,8 @@ class SingleSampleAdapter {
 //              returned sample type.
 //   RealType: the data type of the real numbers that will be returned by the
 //             distribution. This could be either float or double for now.
+// As with UniformDistribution, samples can be drawn from any generator with
+// the same ResultType as Generator.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
 template <class Generator, typename RealType>
@@ -335,8 +339,8 @@ class NormalDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -362,8 +366,8 @@ class NormalDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     static_assert(kResultElementCount % 2 == 0,
@@ -392,8 +396,8 @@ class NormalDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -416,8 +420,8 @@ class NormalDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class G>
+  PHILOX_DEVICE_INLINE ResultType operator()(G* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -100,6 +100,17 @@ Status SpectrogramShapeFn(InferenceContext* c) {
   return Status::OK();
 }
 
+Status SpectrogramStreamComputeShapeFn(InferenceContext* c) {
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+  ShapeHandle input;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &input));
+  // The number of frames depends on the samples buffered by the stream.
+  c->set_output(0, c->MakeShape({c->Dim(input, 1), c->UnknownDim(),
+                                 c->UnknownDim()}));
+  return Status::OK();
+}
+
 Status MfccShapeFn(InferenceContext* c) {
   ShapeHandle spectrogram;
   TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &spectrogram));
@@ -144,6 +155,29 @@ REGISTER_OP("AudioSpectrogram")
     .Output("spectrogram: float")
     .SetShapeFn(SpectrogramShapeFn);
 
+REGISTER_OP("AudioSpectrogramStream")
+    .Attr("window_size: int")
+    .Attr("stride: int")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Output("handle: resource")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("AudioSpectrogramStreamCompute")
+    .Input("handle: resource")
+    .Input("input: float")
+    .Attr("magnitude_squared: bool = false")
+    .Output("spectrogram: float")
+    .SetShapeFn(SpectrogramStreamComputeShapeFn);
+
+REGISTER_OP("AudioSpectrogramStreamReset")
+    .Input("handle: resource")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      return c->WithRank(c->input(0), 0, &unused);
+    });
+
 REGISTER_OP("Mfcc")
     .Input("spectrogram: float")
     .Input("sample_rate: int32")
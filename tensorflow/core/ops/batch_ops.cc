@@ -29,6 +29,7 @@ REGISTER_OP("BatchFunction")
     .Attr("batch_timeout_micros: int")
     .Attr("max_enqueued_batches: int = 10")
     .Attr("allowed_batch_sizes: list(int) = []")
+    .Attr("target_latency_micros: int = 0")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
     .Attr("batching_queue: string = ''")
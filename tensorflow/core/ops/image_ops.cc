@@ -311,6 +311,60 @@ REGISTER_OP("DecodeAndCropJpeg")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndCropAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &contents));
+      DimensionHandle channels_dim = c->UnknownDim();
+      int32 channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 0) {
+        if (channels < 0) {
+          return errors::InvalidArgument("channels must be non-negative, got ",
+                                         channels);
+        }
+        channels_dim = c->MakeDim(channels);
+      }
+
+      ShapeHandle size;
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &size));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(size, 0), 2, &unused_dim));
+      ShapeHandle height_width;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(2, &height_width));
+
+      if (!c->RankKnown(contents)) {
+        c->set_output(0, c->UnknownShape());
+        return Status::OK();
+      }
+      // A vector of contents is decoded into a batch of images, with one
+      // crop window per image.
+      ShapeHandle crop_window;
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(1), c->Rank(contents) + 1, &crop_window));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(crop_window, -1), 4, &unused_dim));
+      ShapeHandle batch;
+      TF_RETURN_IF_ERROR(c->Subshape(crop_window, 0, -1, &batch));
+      TF_RETURN_IF_ERROR(c->Merge(contents, batch, &batch));
+
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(batch, height_width, &output));
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(output, c->Vector(channels_dim), &output));
+      c->set_output(0, output);
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -142,6 +142,45 @@ TEST(ImageOpsTest, DecodeAndCropJpeg_InvalidCropWindow) {
   INFER_OK(op, "[];[?]", "[?,?,?]");
 }
 
+TEST(ImageOpsTest, DecodeAndCropAndResizeJpeg_ShapeFn) {
+  const char* op_name = "DecodeAndCropAndResizeJpeg";
+  ShapeInferenceTestOp op(op_name);
+  op.input_tensors.resize(3);
+
+  // Check the number of inputs.
+  INFER_ERROR("Wrong number of inputs passed: 2 while 3 expected", op,
+              "[];[4]");
+
+  TF_ASSERT_OK(NodeDefBuilder("test", op_name)
+                   .Input({"img", 0, DT_STRING})
+                   .Input({"crop_window", 1, DT_INT32})
+                   .Input({"size", 2, DT_INT32})
+                   .Finalize(&op.node_def));
+  // Rank checks.
+  INFER_ERROR("Shape must be at most rank 1 but is rank 2", op, "[1,2];?;?");
+  INFER_ERROR("Shape must be rank 1 but is rank 2", op, "[];[1,4];?");
+  INFER_ERROR("Dimension must be 4 but is 3", op, "[];[3];?");
+  INFER_ERROR("Dimension must be 2 but is 3", op, "[];[4];[3]");
+  INFER_ERROR("Dimensions must be equal, but are 5 and 6", op,
+              "[5];[6,4];[2]");
+
+  // The size is not known, neither is the channel.
+  INFER_OK(op, "?;?;[2]", "?");
+  INFER_OK(op, "[];[4];[2]", "[?,?,?]");
+  INFER_OK(op, "[?];[5,4];[2]", "[d1_0,?,?,?]");
+
+  Tensor size_tensor = test::AsTensor<int32>({20, 30});
+  op.input_tensors[2] = &size_tensor;
+  TF_ASSERT_OK(NodeDefBuilder("test", op_name)
+                   .Input({"img", 0, DT_STRING})
+                   .Input({"crop_window", 1, DT_INT32})
+                   .Input({"size", 2, DT_INT32})
+                   .Attr("channels", 3)
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "[];[4];[2]", "[20,30,3]");
+  INFER_OK(op, "[5];[?,4];[2]", "[d0_0,20,30,3]");
+}
+
 TEST(ImageOpsTest, EncodeImage_ShapeFn) {
   for (const char* op_name : {"EncodeJpeg", "EncodePng"}) {
     ShapeInferenceTestOp op(op_name);
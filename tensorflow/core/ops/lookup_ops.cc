@@ -262,6 +262,7 @@ REGISTER_OP("MutableHashTableOfTensors")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
     .Attr("value_shape: shape = {}")
+    .Attr("max_size: int = 0")
     .SetIsStateful()
     .SetShapeFn(TwoElementOutput);
 
@@ -273,6 +274,7 @@ REGISTER_OP("MutableHashTableOfTensorsV2")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
     .Attr("value_shape: shape = {}")
+    .Attr("max_size: int = 0")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
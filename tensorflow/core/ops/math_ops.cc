@@ -1576,6 +1576,35 @@ REGISTER_OP("ClipByValue")
     .Attr("T: numbertype")
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("_FusedElementwise")
+    .Input("inputs: num_inputs * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_inputs: int >= 1")
+    .Attr("ops: list(string) >= 1")
+    .Attr("chain_is_lhs: list(bool) >= 1")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle cur = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(c->Merge(c->input(i), cur, &cur),
+                                        "From merging shape ", i,
+                                        " with other shapes.");
+      }
+      c->set_output(0, cur);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Evaluates a chain of cwise ops in a single pass over memory.
+
+Starting from y = inputs[0], applies ops[i] in order. A unary op computes
+y = op(y). A binary op consumes the next of inputs[1:] as x, and computes
+y = op(y, x) if chain_is_lhs[i], y = op(x, y) otherwise. All inputs must
+have the same shape. Created by the grappler remapper.
+
+ops: The names of the cwise ops, e.g. "Mul" or "Relu".
+chain_is_lhs: Ignored for unary ops.
+)doc");
+
 #ifdef INTEL_MKL
 REGISTER_OP("_MklAddN")
     .Input("inputs: N * T")
@@ -454,6 +454,93 @@ REGISTER_OP("FusedPadConv2D")
       return CommonFusedConvCalculations(c, false /* has_resize */);
     });
 
+REGISTER_OP("_FusedConv2D")
+    .Input("input: T")
+    .Input("filter: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("strides: list(int)")
+    .Attr(GetPaddingAttrString())
+    .Attr(GetConvnetDataFormatAttrString())
+    .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .Attr("fused_ops: list(string) = []")
+    .Attr("epsilon: float = 0.0001")
+    .SetShapeFn(shape_inference::Conv2DShape)
+    .Doc(R"doc(
+Computes a Conv2D followed by the ops in fused_ops in a single pass over the
+output.
+
+fused_ops is an optional "BiasAdd", then an optional "FusedBatchNorm", then an
+optional "Relu" or "Relu6". args holds the bias for "BiasAdd", and the scale,
+offset, mean and variance for "FusedBatchNorm", which is evaluated for
+inference. Created by the grappler remapper.
+
+epsilon: The epsilon of "FusedBatchNorm".
+)doc");
+
+REGISTER_OP("_FusedAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("mask: num_masks * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("num_masks: int >= 0")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 2, &query));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 2, &value));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(query, -1, c->Dim(value, -1), &output));
+      c->set_output(0, output);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes softmax(query * key^T * scale + mask) * value over the last two
+dimensions without materializing the scores.
+
+query, key and value have the same leading dimensions, and the shapes
+[..., num_queries, depth], [..., num_keys, depth] and
+[..., num_keys, value_depth]. The optional mask broadcasts to the scores of
+shape [..., num_queries, num_keys]. Created by the grappler remapper.
+
+scale: The factor the scores are multiplied by before adding the mask.
+)doc");
+
+REGISTER_OP("_FusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Normalizes x over its last dimension to a mean of 0 and a variance of 1, and
+then multiplies it by scale and adds offset, both of which have the size of
+that dimension. Created by the grappler remapper.
+
+epsilon: Added to the variance before taking its square root.
+)doc");
+
+REGISTER_OP("_FusedBiasGelu")
+    .Input("input: T")
+    .Input("bias: num_biases * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("num_biases: int >= 0")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Adds the optional bias along the last dimension of input, and applies the
+tanh approximation of GELU:
+0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))).
+Created by the grappler remapper.
+)doc");
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("DepthwiseConv2dNative")
@@ -1518,6 +1605,7 @@ REGISTER_OP("_MklConv2D")
     .Attr(GetPaddingAttrString())
     .Attr(GetConvnetDataFormatAttrString())
     .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .Attr("is_filter_const: bool = false")
     .SetShapeFn(shape_inference::Conv2DShape)
     .Doc(R"doc(
 MKL version of Conv2D operator. Uses MKL DNN APIs to perform 2D convolution.
@@ -1564,6 +1652,7 @@ REGISTER_OP("_MklConv2DWithBias")
     .Attr(GetPaddingAttrString())
     .Attr(GetConvnetDataFormatAttrString())
     .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .Attr("is_filter_const: bool = false")
     .SetShapeFn(shape_inference::Conv2DShape)
     .Doc(R"doc(
 MKL version of Conv2D and BiasAdd operator. Uses MKL DNN APIs to perform
@@ -741,6 +741,39 @@ REGISTER_OP("ResourceApplyAdam")
       return ApplyAdamShapeFn(c, false /* sparse */);
     });
 
+REGISTER_OP("ResourceGroupApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {half, float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      ShapeHandle unused;
+      // The var, m, v and grad of each variable have the same shape.
+      for (int i = 0; i < n; ++i) {
+        ShapeHandle s = ShapeOrHandleShape(c, i);
+        TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, n + i), &s));
+        TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, 2 * n + i), &s));
+        TF_RETURN_IF_ERROR(c->Merge(s, c->input(3 * n + 6 + i), &s));
+      }
+      // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+      for (int i = 3 * n; i < 3 * n + 6; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      return Status::OK();
+    });
+
 static Status ApplyAdaMaxShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
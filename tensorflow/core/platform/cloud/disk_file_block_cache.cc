@@ -0,0 +1,309 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+#ifndef _WIN32
+#include <utime.h>
+#endif
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// The suffix of block files, which Trim and Flush only delete.
+constexpr char kBlockSuffix[] = ".block";
+
+// The directory is rescanned once a process has written this fraction of
+// max_bytes since the last scan, which bounds how far the blocks written by
+// other processes can take the directory over max_bytes.
+constexpr size_t kScanFraction = 16;
+
+// Marks the block at `path` as recently used.
+void TouchBlockFile(const string& path) {
+#ifndef _WIN32
+  utime(path.c_str(), nullptr);
+#endif
+}
+
+}  // namespace
+
+DiskFileBlockCache::DiskFileBlockCache(const string& directory,
+                                       size_t block_size, size_t max_bytes,
+                                       BlockFetcher block_fetcher, Env* env)
+    : directory_(directory),
+      block_size_(block_size),
+      max_bytes_(max_bytes),
+      block_fetcher_(std::move(block_fetcher)),
+      env_(env) {
+  if (IsCacheEnabled()) {
+    Status status = env_->RecursivelyCreateDir(directory_);
+    if (!status.ok() && status.code() != error::ALREADY_EXISTS) {
+      LOG(WARNING) << "Failed to create the block cache directory "
+                   << directory_ << ": " << status;
+    }
+    Trim();
+  }
+  VLOG(1) << "Disk file block cache in " << directory_ << " is "
+          << (IsCacheEnabled() ? "enabled" : "disabled");
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return Status::OK();
+  }
+  if (!IsCacheEnabled()) {
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  std::vector<char> data;
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    TF_RETURN_IF_ERROR(ReadBlock(filename, pos, &data));
+    if (offset >= pos + data.size()) {
+      // The requested offset is at or beyond the end of the file.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                data.size());
+    }
+    const size_t begin = offset > pos ? offset - pos : 0;
+    const size_t end = std::min(data.size(), offset + n - pos);
+    if (begin < end) {
+      memcpy(&buffer[total_bytes_transferred], &data[begin], end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return Status::OK();
+}
+
+string DiskFileBlockCache::BlockPath(const string& filename, size_t offset) {
+  int64 signature;
+  {
+    mutex_lock l(mu_);
+    auto it = file_signature_map_.find(filename);
+    if (it == file_signature_map_.end()) {
+      return "";
+    }
+    signature = it->second;
+  }
+  const uint64 key = Hash64Combine(Hash64(filename), signature);
+  return io::JoinPath(
+      directory_, strings::Printf("%016llx_%llu%s",
+                                  static_cast<unsigned long long>(key),
+                                  static_cast<unsigned long long>(offset),
+                                  kBlockSuffix));
+}
+
+Status DiskFileBlockCache::ReadBlock(const string& filename, size_t offset,
+                                     std::vector<char>* data) {
+  const string path = BlockPath(filename, offset);
+  if (!path.empty()) {
+    const Status status = ReadBlockFile(path, data);
+    if (status.ok()) {
+      TouchBlockFile(path);
+      mutex_lock l(mu_);
+      ++stats_.hits;
+      return Status::OK();
+    }
+    if (status.code() != error::NOT_FOUND) {
+      LOG(WARNING) << "Failed to read the cached block " << path << ": "
+                   << status;
+    }
+  }
+
+  data->resize(block_size_);
+  size_t bytes_transferred = 0;
+  TF_RETURN_IF_ERROR(block_fetcher_(filename, offset, block_size_,
+                                    data->data(), &bytes_transferred));
+  data->resize(bytes_transferred);
+  bool trim = false;
+  {
+    mutex_lock l(mu_);
+    ++stats_.misses;
+  }
+  if (!path.empty() && !data->empty()) {
+    const Status status = WriteBlockFile(path, *data);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to cache the block " << path << ": " << status;
+    } else {
+      mutex_lock l(mu_);
+      written_since_scan_ += data->size();
+      trim = scanned_size_ + written_since_scan_ > max_bytes_ ||
+             written_since_scan_ >= max_bytes_ / kScanFraction;
+    }
+  }
+  if (trim) {
+    Trim();
+  }
+  return Status::OK();
+}
+
+Status DiskFileBlockCache::ReadBlockFile(const string& path,
+                                         std::vector<char>* data) {
+  uint64 size;
+  TF_RETURN_IF_ERROR(env_->GetFileSize(path, &size));
+  if (size > block_size_) {
+    return errors::DataLoss("Cached block ", path, " has ", size,
+                            " bytes, more than the block size ", block_size_);
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(path, &file));
+  data->resize(size);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(0, size, &result, data->data()));
+  if (result.size() != size) {
+    return errors::DataLoss("Cached block ", path, " was truncated");
+  }
+  if (result.data() != data->data()) {
+    memmove(data->data(), result.data(), size);
+  }
+  return Status::OK();
+}
+
+Status DiskFileBlockCache::WriteBlockFile(const string& path,
+                                          const std::vector<char>& data) {
+  // Other processes may read the block as soon as it has its name, so it is
+  // written under a unique temporary name first.
+  const string tmp_path = strings::StrCat(path, ".", random::New64(), ".tmp");
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(tmp_path, &file));
+  Status status = file->Append(StringPiece(data.data(), data.size()));
+  status.Update(file->Close());
+  if (status.ok()) {
+    status = env_->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    env_->DeleteFile(tmp_path).IgnoreError();
+  }
+  return status;
+}
+
+void DiskFileBlockCache::Trim() {
+  mutex_lock trim_lock(trim_mu_);
+  std::vector<string> children;
+  if (!env_->GetChildren(directory_, &children).ok()) {
+    return;
+  }
+  // (modification time, size, path) of every block in the directory.
+  std::vector<std::tuple<int64, int64, string>> blocks;
+  size_t total_size = 0;
+  for (const string& child : children) {
+    if (!str_util::EndsWith(child, kBlockSuffix)) {
+      continue;
+    }
+    const string path = io::JoinPath(directory_, child);
+    FileStatistics stat;
+    if (!env_->Stat(path, &stat).ok()) {
+      // Deleted by another process since the listing.
+      continue;
+    }
+    blocks.emplace_back(stat.mtime_nsec, stat.length, path);
+    total_size += stat.length;
+  }
+  int64 evicted_bytes = 0;
+  if (total_size > max_bytes_) {
+    std::sort(blocks.begin(), blocks.end());
+    for (const auto& block : blocks) {
+      if (total_size <= max_bytes_) {
+        break;
+      }
+      // Another process may delete the same block; it is gone either way.
+      env_->DeleteFile(std::get<2>(block)).IgnoreError();
+      total_size -= std::get<1>(block);
+      evicted_bytes += std::get<1>(block);
+    }
+  }
+  mutex_lock l(mu_);
+  scanned_size_ = total_size;
+  written_since_scan_ = 0;
+  stats_.evicted_bytes += evicted_bytes;
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
+                                                        int64 file_signature) {
+  mutex_lock l(mu_);
+  auto it = file_signature_map_.find(filename);
+  if (it != file_signature_map_.end()) {
+    if (it->second == file_signature) {
+      return true;
+    }
+    // The blocks of the old signature are no longer reachable.
+    it->second = file_signature;
+    return false;
+  }
+  file_signature_map_[filename] = file_signature;
+  return true;
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  mutex_lock l(mu_);
+  file_signature_map_.erase(filename);
+}
+
+void DiskFileBlockCache::Flush() {
+  {
+    mutex_lock l(mu_);
+    file_signature_map_.clear();
+  }
+  mutex_lock trim_lock(trim_mu_);
+  std::vector<string> children;
+  if (env_->GetChildren(directory_, &children).ok()) {
+    for (const string& child : children) {
+      if (str_util::EndsWith(child, kBlockSuffix)) {
+        env_->DeleteFile(io::JoinPath(directory_, child)).IgnoreError();
+      }
+    }
+  }
+  mutex_lock l(mu_);
+  scanned_size_ = 0;
+  written_since_scan_ = 0;
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  mutex_lock l(mu_);
+  return scanned_size_ + written_since_scan_;
+}
+
+DiskFileBlockCache::Stats DiskFileBlockCache::stats() const {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,135 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief A block cache of file contents stored in a local directory.
+///
+/// Each block is a file in `directory`, named after the filename, the file
+/// signature and the offset of the block, so several processes on a host can
+/// share the directory and read each other's blocks. Blocks are written to a
+/// temporary file and renamed into place, so readers never see a partial
+/// block. When the directory grows past `max_bytes`, the least recently used
+/// blocks (by modification time, which hits refresh) are deleted.
+///
+/// Blocks of a file are only cached once its signature is known, through
+/// ValidateAndUpdateFileSignature; other reads go to the fetcher. A changed
+/// signature makes the old blocks unreachable, and they age out.
+///
+/// This class is meant to be the fetcher of a RamFileBlockCache, which
+/// deduplicates concurrent fetches of a block within a process. Concurrent
+/// fetches of a block from different processes may both go to the fetcher.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  /// Counters of the reads of a cache.
+  struct Stats {
+    /// Blocks read from the directory.
+    int64 hits = 0;
+    /// Blocks read from the fetcher.
+    int64 misses = 0;
+    /// Bytes of blocks deleted to stay under max_bytes.
+    int64 evicted_bytes = 0;
+  };
+
+  DiskFileBlockCache(const string& directory, size_t block_size,
+                     size_t max_bytes, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  /// Read `n` bytes from `filename` starting at `offset` into `out`, with the
+  /// same results as RamFileBlockCache::Read.
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64 file_signature) override
+      LOCKS_EXCLUDED(mu_);
+
+  /// Stops caching blocks of `filename` until its signature is validated
+  /// again. The blocks already cached are left to age out.
+  void RemoveFile(const string& filename) override LOCKS_EXCLUDED(mu_);
+
+  /// Remove all blocks in the directory, including those of other processes.
+  void Flush() override LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return 0; }
+
+  /// The size (in bytes) of the directory at the last scan, plus the blocks
+  /// this process wrote since.
+  size_t CacheSize() const override LOCKS_EXCLUDED(mu_);
+
+  bool IsCacheEnabled() const override {
+    return block_size_ > 0 && max_bytes_ > 0;
+  }
+
+  Stats stats() const LOCKS_EXCLUDED(mu_);
+
+ private:
+  /// Returns the path of the block at `offset` of `filename`, or an empty
+  /// string if the file signature is unknown.
+  string BlockPath(const string& filename, size_t offset) LOCKS_EXCLUDED(mu_);
+
+  /// Reads the block at `offset` of `filename` into `data`, from the directory
+  /// if it is there and from the fetcher otherwise.
+  Status ReadBlock(const string& filename, size_t offset,
+                   std::vector<char>* data) LOCKS_EXCLUDED(mu_);
+
+  /// Reads the block file at `path` into `data`. Returns NOT_FOUND if it is
+  /// not cached.
+  Status ReadBlockFile(const string& path, std::vector<char>* data);
+
+  /// Writes `data` to the block file at `path`.
+  Status WriteBlockFile(const string& path, const std::vector<char>& data);
+
+  /// Rescans the directory, and deletes the least recently used blocks while
+  /// it holds more than max_bytes_.
+  void Trim() LOCKS_EXCLUDED(mu_);
+
+  const string directory_;
+  const size_t block_size_;
+  const size_t max_bytes_;
+  const BlockFetcher block_fetcher_;
+  Env* const env_;  // not owned
+
+  mutable mutex mu_;
+  /// A filename->file_signature map.
+  std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+  /// The size of the directory at the last scan.
+  size_t scanned_size_ GUARDED_BY(mu_) = 0;
+  /// The bytes of the blocks written by this process since the last scan.
+  size_t written_since_scan_ GUARDED_BY(mu_) = 0;
+  Stats stats_ GUARDED_BY(mu_);
+  /// Serializes scans of the directory.
+  mutex trim_mu_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
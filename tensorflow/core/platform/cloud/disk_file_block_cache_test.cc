@@ -0,0 +1,148 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
+#include <cstring>
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+string CacheDir(const string& name) {
+  const string dir = io::JoinPath(testing::TmpDir(), name);
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return dir;
+}
+
+// Serves a 20 byte file whose byte i is 'a' + i.
+Status FetchAlphabet(const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  for (size_t i = offset; i < offset + n && i < 20; ++i) {
+    buffer[(*bytes_transferred)++] = 'a' + i;
+  }
+  return Status::OK();
+}
+
+TEST(DiskFileBlockCacheTest, IsCacheEnabled) {
+  const string dir = CacheDir("enabled");
+  DiskFileBlockCache cache1(dir, 0, 0, FetchAlphabet);
+  DiskFileBlockCache cache2(dir, 16, 0, FetchAlphabet);
+  DiskFileBlockCache cache3(dir, 16, 32, FetchAlphabet);
+  EXPECT_FALSE(cache1.IsCacheEnabled());
+  EXPECT_FALSE(cache2.IsCacheEnabled());
+  EXPECT_TRUE(cache3.IsCacheEnabled());
+}
+
+TEST(DiskFileBlockCacheTest, SharedAcrossInstances) {
+  const string dir = CacheDir("shared");
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    ++calls;
+    return FetchAlphabet(filename, offset, n, buffer, bytes_transferred);
+  };
+  // Two caches on the same directory stand for two processes on a host.
+  DiskFileBlockCache cache1(dir, 8, 1 << 20, fetcher);
+  DiskFileBlockCache cache2(dir, 8, 1 << 20, fetcher);
+  std::vector<char> out;
+
+  // Blocks are only cached once the file signature is known.
+  TF_EXPECT_OK(ReadCache(&cache1, "a", 0, 4, &out));
+  TF_EXPECT_OK(ReadCache(&cache1, "a", 0, 4, &out));
+  EXPECT_EQ(2, calls);
+
+  EXPECT_TRUE(cache1.ValidateAndUpdateFileSignature("a", 1));
+  EXPECT_TRUE(cache2.ValidateAndUpdateFileSignature("a", 1));
+  calls = 0;
+  TF_EXPECT_OK(ReadCache(&cache1, "a", 6, 14, &out));
+  EXPECT_EQ(string("ghijklmnopqrst"), string(out.begin(), out.end()));
+  EXPECT_EQ(3, calls);
+  EXPECT_EQ(20, cache1.CacheSize());
+  // The other cache reads the blocks, including the partial last one, from
+  // the directory.
+  TF_EXPECT_OK(ReadCache(&cache2, "a", 0, 30, &out));
+  EXPECT_EQ(string("abcdefghijklmnopqrst"), string(out.begin(), out.end()));
+  EXPECT_EQ(3, calls);
+  EXPECT_EQ(3, cache2.stats().hits);
+  EXPECT_EQ(0, cache2.stats().misses);
+  EXPECT_EQ(errors::Code::OUT_OF_RANGE,
+            ReadCache(&cache2, "a", 22, 4, &out).code());
+
+  // A new signature misses the old blocks.
+  EXPECT_FALSE(cache2.ValidateAndUpdateFileSignature("a", 2));
+  TF_EXPECT_OK(ReadCache(&cache2, "a", 0, 4, &out));
+  EXPECT_EQ(4, calls);
+  // Removed files are not cached until validated again.
+  cache1.RemoveFile("a");
+  TF_EXPECT_OK(ReadCache(&cache1, "a", 0, 4, &out));
+  EXPECT_EQ(5, calls);
+}
+
+TEST(DiskFileBlockCacheTest, EvictsLeastRecentlyUsed) {
+  const string dir = CacheDir("evict");
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    ++calls;
+    return FetchAlphabet(filename, offset, n, buffer, bytes_transferred);
+  };
+  // Room for two blocks. The sleeps step past the one second resolution of
+  // file modification times.
+  DiskFileBlockCache cache(dir, 8, 16, fetcher);
+  std::vector<char> out;
+  for (const string& filename : {"a", "b", "c"}) {
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature(filename, 1));
+  }
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 8, &out));
+  Env::Default()->SleepForMicroseconds(1100000);
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 8, &out));
+  Env::Default()->SleepForMicroseconds(1100000);
+  // Reading "a" again makes "b" the least recently used block.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 8, &out));
+  Env::Default()->SleepForMicroseconds(1100000);
+  TF_EXPECT_OK(ReadCache(&cache, "c", 0, 8, &out));
+  EXPECT_EQ(3, calls);
+  EXPECT_EQ(16, cache.CacheSize());
+  EXPECT_EQ(8, cache.stats().evicted_bytes);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 8, &out));
+  EXPECT_EQ(3, calls);
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, 8, &out));
+  EXPECT_EQ(4, calls);
+
+  cache.Flush();
+  EXPECT_EQ(0, cache.CacheSize());
+}
+
+}  // namespace
+}  // namespace tensorflow
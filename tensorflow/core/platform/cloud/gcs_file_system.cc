@@ -26,6 +26,7 @@ limitations under the License.
 #include <io.h>  // for _mktemp
 #endif
 #include "include/json/json.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
@@ -81,6 +82,35 @@ constexpr size_t kDefaultMaxCacheSize = 2 * kDefaultBlockSize;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that disables reading ahead the next block of files
+// read sequentially, when the cache can hold at least two blocks.
+constexpr char kSequentialReadaheadDisabled[] =
+    "GCS_READ_CACHE_READAHEAD_DISABLED";
+// The environment variable that overrides the maximum number of concurrent
+// ranged requests a large read is split into.
+constexpr char kReadParallelism[] = "GCS_READ_PARALLELISM";
+constexpr int64 kDefaultReadParallelism = 4;
+// Reads are only split into requests of at least this many bytes.
+constexpr size_t kMinParallelReadSize = 16 * 1024 * 1024;
+// The environment variable that enables parallel composite uploads: written
+// files are uploaded in parts of this many bytes while they are written, and
+// composed into the object on flush/close. The default of 0 uploads the whole
+// file on flush/close. (format: <uint64>)
+constexpr char kUploadPartSize[] = "GCS_UPLOAD_PART_SIZE";
+// The environment variable that overrides the maximum number of parts of a
+// file that are uploaded concurrently.
+constexpr char kUploadParallelism[] = "GCS_UPLOAD_PARALLELISM";
+constexpr int64 kDefaultUploadParallelism = 4;
+// The maximum number of objects a GCS compose request can concatenate.
+constexpr size_t kMaxComposeComponents = 32;
+// The environment variable that enables a second-tier block cache in a local
+// directory, e.g. on an SSD, which the processes on a host can share. Blocks
+// missing from the in-memory cache are looked up there before GCS.
+constexpr char kDiskCacheDir[] = "GCS_DISK_CACHE_DIR";
+// The environment variable that overrides the maximum size (MB) of the disk
+// cache directory.
+constexpr char kDiskCacheMaxSize[] = "GCS_DISK_CACHE_MAX_SIZE_MB";
+constexpr size_t kDefaultDiskCacheMaxSize = 64 * kDefaultBlockSize;
 // The environment variable that overrides the maximum age of entries in the
 // Stat cache. A value of 0 (the default) means nothing is cached.
 constexpr char kStatCacheMaxAge[] = "GCS_STAT_CACHE_MAX_AGE";
@@ -312,20 +342,32 @@ class GcsRandomAccessFile : public RandomAccessFile {
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
 /// tmp file and copies it to GCS on flush/close.
+///
+/// With a non-zero upload_part_size, the file is instead uploaded while it is
+/// written: every upload_part_size bytes appended are uploaded in the
+/// background as a temporary part object, with up to upload_parallelism
+/// uploads in flight. Flush/close composes the parts into the object, and
+/// close deletes them.
 class GcsWritableFile : public WritableFile {
  public:
   GcsWritableFile(const string& bucket, const string& object,
                   GcsFileSystem* filesystem,
                   GcsFileSystem::TimeoutConfig* timeouts,
                   std::function<void()> file_cache_erase,
-                  int64 initial_retry_delay_usec)
+                  int64 initial_retry_delay_usec, size_t upload_part_size = 0,
+                  int64 upload_parallelism = 1)
       : bucket_(bucket),
         object_(object),
         filesystem_(filesystem),
         timeouts_(timeouts),
         file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
-        initial_retry_delay_usec_(initial_retry_delay_usec) {
+        initial_retry_delay_usec_(initial_retry_delay_usec),
+        upload_part_size_(upload_part_size),
+        upload_parallelism_(std::max<int64>(upload_parallelism, 1)) {
+    if (upload_part_size_ > 0) {
+      return;
+    }
     // TODO: to make it safer, outfile_ should be constructed from an FD
     if (GetTmpFilename(&tmp_content_filename_).ok()) {
       outfile_.open(tmp_content_filename_,
@@ -355,11 +397,22 @@ class GcsWritableFile : public WritableFile {
                   std::ofstream::binary | std::ofstream::app);
   }
 
-  ~GcsWritableFile() override { Close().IgnoreError(); }
+  ~GcsWritableFile() override {
+    Close().IgnoreError();
+    // Part uploads still reference this file if the close failed.
+    WaitForPartUploads().IgnoreError();
+  }
 
   Status Append(const StringPiece& data) override {
     TF_RETURN_IF_ERROR(CheckWritable());
     sync_needed_ = true;
+    if (upload_part_size_ > 0) {
+      part_buffer_.append(data.data(), data.size());
+      if (part_buffer_.size() >= upload_part_size_) {
+        return StartPartUpload();
+      }
+      return Status::OK();
+    }
     outfile_ << data;
     if (!outfile_.good()) {
       return errors::Internal(
@@ -369,6 +422,14 @@ class GcsWritableFile : public WritableFile {
   }
 
   Status Close() override {
+    if (upload_part_size_ > 0) {
+      if (!closed_) {
+        TF_RETURN_IF_ERROR(Sync());
+        closed_ = true;
+        DeleteParts();
+      }
+      return Status::OK();
+    }
     if (outfile_.is_open()) {
       TF_RETURN_IF_ERROR(Sync());
       outfile_.close();
@@ -384,7 +445,7 @@ class GcsWritableFile : public WritableFile {
     if (!sync_needed_) {
       return Status::OK();
     }
-    Status status = SyncImpl();
+    Status status = upload_part_size_ > 0 ? SyncComposite() : SyncImpl();
     if (status.ok()) {
       sync_needed_ = false;
     }
@@ -437,7 +498,138 @@ class GcsWritableFile : public WritableFile {
     return upload_status;
   }
 
+  /// \brief Uploads the buffered data as the next part in the background.
+  ///
+  /// Blocks while upload_parallelism_ parts are being uploaded, and returns
+  /// the error of a failed part upload.
+  Status StartPartUpload() {
+    {
+      mutex_lock l(upload_mu_);
+      while (uploads_in_flight_ >= upload_parallelism_) {
+        upload_cv_.wait(l);
+      }
+      TF_RETURN_IF_ERROR(upload_status_);
+      ++uploads_in_flight_;
+    }
+    std::shared_ptr<string> data(new string);
+    data->swap(part_buffer_);
+    const string part = strings::StrCat(object_, ".part-", parts_.size());
+    parts_.push_back(part);
+    Env::Default()->SchedClosure([this, part, data]() {
+      const Status status = RetryingUtils::CallWithRetries(
+          [this, &part, &data]() { return UploadObject(part, *data); },
+          initial_retry_delay_usec_);
+      mutex_lock l(upload_mu_);
+      upload_status_.Update(status);
+      --uploads_in_flight_;
+      upload_cv_.notify_all();
+    });
+    return Status::OK();
+  }
+
+  /// Waits for the part uploads in flight and returns the first error.
+  Status WaitForPartUploads() {
+    mutex_lock l(upload_mu_);
+    while (uploads_in_flight_ > 0) {
+      upload_cv_.wait(l);
+    }
+    return upload_status_;
+  }
+
+  /// \brief Makes the object hold the data appended so far.
+  ///
+  /// Uploads the buffered data as the last part and composes the parts not
+  /// yet in the object into it, at most kMaxComposeComponents at a time.
+  Status SyncComposite() {
+    if (!part_buffer_.empty() || parts_.empty()) {
+      TF_RETURN_IF_ERROR(StartPartUpload());
+    }
+    TF_RETURN_IF_ERROR(WaitForPartUploads());
+    while (composed_parts_ < parts_.size()) {
+      std::vector<string> sources;
+      if (composed_parts_ > 0) {
+        sources.push_back(object_);
+      }
+      const size_t end =
+          std::min(parts_.size(), composed_parts_ + kMaxComposeComponents -
+                                      sources.size());
+      sources.insert(sources.end(), parts_.begin() + composed_parts_,
+                     parts_.begin() + end);
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this, &sources]() { return ComposeObject(sources); },
+          initial_retry_delay_usec_));
+      composed_parts_ = end;
+    }
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    return Status::OK();
+  }
+
+  /// Uploads 'data' as the object 'name' with a single request.
+  Status UploadObject(const string& name, const string& data) {
+    std::vector<char> output_buffer;
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                    "/o?uploadType=media&name=",
+                                    request->EscapeString(name)));
+    request->SetPostFromBuffer(data.data(), data.size());
+    request->SetResultBuffer(&output_buffer);
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle, timeouts_->write);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading gs://",
+                                    bucket_, "/", name);
+    return Status::OK();
+  }
+
+  /// Replaces the object with the concatenation of the 'sources' objects.
+  Status ComposeObject(const std::vector<string>& sources) {
+    Json::Value body;
+    Json::Value& source_objects = body["sourceObjects"];
+    for (const string& source : sources) {
+      Json::Value source_object;
+      source_object["name"] = source;
+      source_objects.append(source_object);
+    }
+    const string body_str = Json::FastWriter().write(body);
+
+    std::vector<char> output_buffer;
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                    request->EscapeString(object_),
+                                    "/compose"));
+    request->AddHeader("Content-Type", "application/json");
+    request->SetPostFromBuffer(body_str.data(), body_str.size());
+    request->SetResultBuffer(&output_buffer);
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                         timeouts_->metadata);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                    GetGcsPath());
+    return Status::OK();
+  }
+
+  /// Deletes the part objects. Failures only leave garbage behind.
+  void DeleteParts() {
+    for (const string& part : parts_) {
+      const string part_path = strings::StrCat("gs://", bucket_, "/", part);
+      const Status status = RetryingUtils::DeleteWithRetries(
+          [this, &part_path]() { return filesystem_->DeleteFile(part_path); },
+          initial_retry_delay_usec_);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to delete the upload part " << part_path
+                     << ": " << status;
+      }
+    }
+    parts_.clear();
+  }
+
   Status CheckWritable() const {
+    if (upload_part_size_ > 0) {
+      if (closed_) {
+        return errors::FailedPrecondition("The file is closed.");
+      }
+      return Status::OK();
+    }
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
           "The internal temporary file is not writable.");
@@ -572,6 +764,21 @@ class GcsWritableFile : public WritableFile {
   std::function<void()> file_cache_erase_;
   bool sync_needed_;  // whether there is buffered data that needs to be synced
   int64 initial_retry_delay_usec_;
+
+  // State of parallel composite uploads, used when upload_part_size_ > 0.
+  const size_t upload_part_size_;
+  const int64 upload_parallelism_;
+  bool closed_ = false;
+  // The data appended since the last part.
+  string part_buffer_;
+  // The names of the part objects, in order.
+  std::vector<string> parts_;
+  // The number of leading parts already composed into the object.
+  size_t composed_parts_ = 0;
+  mutex upload_mu_;
+  condition_variable upload_cv_;
+  int64 uploads_in_flight_ GUARDED_BY(upload_mu_) = 0;
+  Status upload_status_ GUARDED_BY(upload_mu_);
 };
 
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
@@ -631,7 +838,36 @@ GcsFileSystem::GcsFileSystem()
     // Setting either to 0 disables the cache; set both for good measure.
     block_size = max_bytes = 0;
   }
+  sequential_readahead_ = !std::getenv(kSequentialReadaheadDisabled);
+  read_parallelism_ = kDefaultReadParallelism;
+  int64 parallelism;
+  if (GetEnvVar(kReadParallelism, strings::safe_strto64, &parallelism)) {
+    read_parallelism_ = std::max<int64>(parallelism, 1);
+  }
+  StringPiece disk_cache_dir;
+  if (GetEnvVar(kDiskCacheDir, StringPieceIdentity, &disk_cache_dir) &&
+      !disk_cache_dir.empty()) {
+    size_t disk_max_bytes = kDefaultDiskCacheMaxSize;
+    if (GetEnvVar(kDiskCacheMaxSize, strings::safe_strtou64, &value)) {
+      disk_max_bytes = value * 1024 * 1024;
+    }
+    disk_block_cache_.reset(new DiskFileBlockCache(
+        string(disk_cache_dir), block_size > 0 ? block_size : kDefaultBlockSize,
+        disk_max_bytes,
+        [this](const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return LoadBufferFromGCS(filename, offset, n, buffer,
+                                   bytes_transferred);
+        }));
+  }
   file_block_cache_ = MakeFileBlockCache(block_size, max_bytes, max_staleness);
+  if (GetEnvVar(kUploadPartSize, strings::safe_strtou64, &value)) {
+    upload_part_size_ = value;
+  }
+  upload_parallelism_ = kDefaultUploadParallelism;
+  if (GetEnvVar(kUploadParallelism, strings::safe_strto64, &parallelism)) {
+    upload_parallelism_ = std::max<int64>(parallelism, 1);
+  }
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
   size_t stat_cache_max_entries = kStatCacheDefaultMaxEntries;
@@ -769,7 +1005,7 @@ Status GcsFileSystem::NewRandomAccessFile(
                                                    StringPiece* result,
                                                    char* scratch) {
     tf_shared_lock l(block_cache_lock_);
-    if (file_block_cache_->IsCacheEnabled()) {
+    if (file_block_cache_->IsCacheEnabled() || disk_block_cache_) {
       GcsFileStat stat;
       TF_RETURN_IF_ERROR(stat_cache_->LookupOrCompute(
           fname, &stat,
@@ -782,6 +1018,10 @@ Status GcsFileSystem::NewRandomAccessFile(
             << "File signature has been changed. Refreshing the cache. Path: "
             << fname;
       }
+      if (disk_block_cache_) {
+        disk_block_cache_->ValidateAndUpdateFileSignature(
+            fname, stat.generation_number);
+      }
     }
     *result = StringPiece();
     size_t bytes_transferred;
@@ -798,6 +1038,11 @@ Status GcsFileSystem::NewRandomAccessFile(
   return Status::OK();
 }
 
+void GcsFileSystem::SetUploadOptions(size_t part_size, int64 parallelism) {
+  upload_part_size_ = part_size;
+  upload_parallelism_ = std::max<int64>(parallelism, 1);
+}
+
 void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
                                         size_t max_bytes,
                                         uint64 max_staleness_secs) {
@@ -816,9 +1061,14 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
+        if (disk_block_cache_) {
+          return disk_block_cache_->Read(filename, offset, n, buffer,
+                                         bytes_transferred);
+        }
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), sequential_readahead_));
   return file_block_cache;
 }
 
@@ -831,24 +1081,54 @@ Status GcsFileSystem::LoadBufferFromGCS(const string& filename, size_t offset,
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(filename, false, &bucket, &object));
 
-  std::unique_ptr<HttpRequest> request;
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&request),
-                                  "when reading gs://", bucket, "/", object);
-
-  request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
-                                  request->EscapeString(object)));
-  request->SetRange(offset, offset + n - 1);
-  request->SetResultBufferDirect(buffer, n);
-  request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
-
   if (stats_ != nullptr) {
     stats_->RecordBlockLoadRequest(filename, offset);
   }
 
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when reading gs://",
-                                  bucket, "/", object);
-
-  size_t bytes_read = request->GetResultBufferDirectBytesTransferred();
+  size_t bytes_read = 0;
+  const size_t num_parts = std::max<size_t>(
+      1, std::min<size_t>(read_parallelism_, n / kMinParallelReadSize));
+  if (num_parts == 1) {
+    TF_RETURN_IF_ERROR(
+        LoadRangeFromGCS(bucket, object, offset, n, buffer, &bytes_read));
+  } else {
+    // Issues one ranged request per part, all but the first in the
+    // background.
+    const size_t part_size = (n + num_parts - 1) / num_parts;
+    std::vector<Status> statuses(num_parts);
+    std::vector<size_t> part_bytes(num_parts, 0);
+    auto load_part = [&, this](size_t i) {
+      const size_t part_offset = i * part_size;
+      const size_t part_n = std::min(part_size, n - part_offset);
+      statuses[i] = LoadRangeFromGCS(bucket, object, offset + part_offset,
+                                     part_n, buffer + part_offset,
+                                     &part_bytes[i]);
+    };
+    BlockingCounter counter(num_parts - 1);
+    for (size_t i = 1; i < num_parts; ++i) {
+      Env::Default()->SchedClosure([&load_part, &counter, i]() {
+        load_part(i);
+        counter.DecrementCount();
+      });
+    }
+    load_part(0);
+    counter.Wait();
+    for (size_t i = 0; i < num_parts; ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+    }
+    // The data read is the prefix up to the first short part, after which the
+    // parts must be empty.
+    bool short_part = false;
+    for (size_t i = 0; i < num_parts; ++i) {
+      if (short_part && part_bytes[i] > 0) {
+        return errors::Internal(strings::Printf(
+            "File contents are inconsistent for file: %s @ %lu.",
+            filename.c_str(), offset));
+      }
+      bytes_read += part_bytes[i];
+      short_part = part_bytes[i] < std::min(part_size, n - i * part_size);
+    }
+  }
   *bytes_transferred = bytes_read;
   VLOG(1) << "Successful read of gs://" << bucket << "/" << object << " @ "
           << offset << " of size: " << bytes_read;
@@ -857,8 +1137,6 @@ Status GcsFileSystem::LoadBufferFromGCS(const string& filename, size_t offset,
     stats_->RecordBlockRetrieved(filename, offset, bytes_read);
   }
 
-  throttle_.RecordResponse(bytes_read);
-
   if (bytes_read < n) {
     // Check stat cache to see if we encountered an interrupted read.
     GcsFileStat stat;
@@ -876,9 +1154,36 @@ Status GcsFileSystem::LoadBufferFromGCS(const string& filename, size_t offset,
   return Status::OK();
 }
 
+Status GcsFileSystem::LoadRangeFromGCS(const string& bucket,
+                                       const string& object, size_t offset,
+                                       size_t n, char* buffer,
+                                       size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&request),
+                                  "when reading gs://", bucket, "/", object);
+
+  request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
+                                  request->EscapeString(object)));
+  request->SetRange(offset, offset + n - 1);
+  request->SetResultBufferDirect(buffer, n);
+  request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
+
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when reading gs://",
+                                  bucket, "/", object);
+
+  *bytes_transferred = request->GetResultBufferDirectBytesTransferred();
+  throttle_.RecordResponse(*bytes_transferred);
+  return Status::OK();
+}
+
 void GcsFileSystem::ClearFileCaches(const string& fname) {
   tf_shared_lock l(block_cache_lock_);
   file_block_cache_->RemoveFile(fname);
+  if (disk_block_cache_) {
+    disk_block_cache_->RemoveFile(fname);
+  }
   stat_cache_->Delete(fname);
   // TODO(rxsang): Remove the patterns that matche the file in
   // MatchingPathsCache as well.
@@ -890,7 +1195,8 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
   result->reset(new GcsWritableFile(bucket, object, this, &timeouts_,
                                     [this, fname]() { ClearFileCaches(fname); },
-                                    initial_retry_delay_usec_));
+                                    initial_retry_delay_usec_,
+                                    upload_part_size_, upload_parallelism_));
   return Status::OK();
 }
 
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/cloud/auth_provider.h"
+#include "tensorflow/core/platform/cloud/disk_file_block_cache.h"
 #include "tensorflow/core/platform/cloud/expiring_lru_cache.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/gcs_dns_cache.h"
@@ -207,6 +208,13 @@ class GcsFileSystem : public FileSystem {
   /// The new auth provider will be used for all subsequent requests.
   void SetAuthProvider(std::unique_ptr<AuthProvider> auth_provider);
 
+  /// \brief Configures parallel composite uploads of new writable files.
+  ///
+  /// Files are uploaded in parts of 'part_size' bytes while they are written,
+  /// with up to 'parallelism' parts in flight, and the parts are composed into
+  /// the object on flush/close. A 'part_size' of 0 disables them.
+  void SetUploadOptions(size_t part_size, int64 parallelism);
+
   /// \brief Resets the block cache and re-instantiates it with the new values.
   ///
   /// This method can be used to clear the existing block cache and/or to
@@ -267,15 +275,37 @@ class GcsFileSystem : public FileSystem {
                                                      uint64 max_staleness);
 
   /// Loads file contents from GCS for a given filename, offset, and length.
+  /// Large reads are split into up to read_parallelism_ concurrent ranged
+  /// requests.
   Status LoadBufferFromGCS(const string& filename, size_t offset, size_t n,
                            char* buffer, size_t* bytes_transferred);
 
+  /// Loads file contents from GCS with a single ranged request.
+  Status LoadRangeFromGCS(const string& bucket, const string& object,
+                          size_t offset, size_t n, char* buffer,
+                          size_t* bytes_transferred);
+
   // Clear all the caches related to the file with name `filename`.
   void ClearFileCaches(const string& fname);
 
+  /// Whether the block cache reads ahead the next block of files read
+  /// sequentially.
+  bool sequential_readahead_ = false;
+  /// The maximum number of concurrent requests of a large read.
+  int64 read_parallelism_ = 1;
+  /// The part size of parallel composite uploads, or 0 to upload written
+  /// files on flush/close.
+  size_t upload_part_size_ = 0;
+  /// The maximum number of parts of a written file uploaded concurrently.
+  int64 upload_parallelism_ = 1;
+
   mutex mu_;
   std::unique_ptr<AuthProvider> auth_provider_ GUARDED_BY(mu_);
   std::unique_ptr<HttpRequest::Factory> http_request_factory_;
+  // The optional second-tier block cache on local disk, which fetches the
+  // blocks missing from file_block_cache_. Declared first, as it outlives
+  // file_block_cache_.
+  std::unique_ptr<DiskFileBlockCache> disk_block_cache_;
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
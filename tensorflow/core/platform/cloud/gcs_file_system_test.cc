@@ -510,6 +510,79 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelCompositeUpload) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2Fwriteable.part-0\n"
+           "Auth Token: fake_token\n"
+           "Post body: content1,\n"
+           "Timeouts: 5 1 30\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2Fwriteable.part-1\n"
+           "Auth Token: fake_token\n"
+           "Post body: content2\n"
+           "Timeouts: 5 1 30\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2Fwriteable.part-2\n"
+           "Auth Token: fake_token\n"
+           "Post body: end\n"
+           "Timeouts: 5 1 30\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "path%2Fwriteable/compose\n"
+           "Auth Token: fake_token\n"
+           "Header Content-Type: application/json\n"
+           "Post body: {\"sourceObjects\":["
+           "{\"name\":\"path/writeable.part-0\"},"
+           "{\"name\":\"path/writeable.part-1\"},"
+           "{\"name\":\"path/writeable.part-2\"}]}\n\n"
+           "Timeouts: 5 1 10\n",
+           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b"
+                           "/bucket/o/path%2Fwriteable.part-0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b"
+                           "/bucket/o/path%2Fwriteable.part-1\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b"
+                           "/bucket/o/path%2Fwriteable.part-2\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      0 /* block size */, 0 /* max bytes */, 0 /* max staleness */,
+      0 /* stat cache max age */, 0 /* stat cache max entries */,
+      0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, 0 /* initial retry delay */,
+      kTestTimeoutConfig, nullptr /* gcs additional header */);
+  // One part in flight at a time keeps the requests in order.
+  fs.SetUploadOptions(8 /* part size */, 1 /* parallelism */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable", &wfile));
+  // Every 8 bytes appended are uploaded as a part, and the rest on close.
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  TF_EXPECT_OK(wfile->Append("end"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -173,6 +173,7 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     finish += block_size_;
   }
   size_t total_bytes_transferred = 0;
+  bool eof = false;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
@@ -210,13 +211,49 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
+      eof = true;
       break;
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  if (sequential_readahead_) {
+    MaybeReadAhead(filename, offset, offset + total_bytes_transferred,
+                   std::make_pair(filename, finish), eof);
+  }
   return Status::OK();
 }
 
+void RamFileBlockCache::MaybeReadAhead(const string& filename, size_t offset,
+                                       size_t end, const Key& key, bool eof) {
+  {
+    mutex_lock lock(mu_);
+    auto it = last_read_end_.find(filename);
+    const bool sequential = it != last_read_end_.end() && it->second == offset;
+    // Nothing is read ahead past a partial block, which would make the cache
+    // look inconsistent (see UpdateLRU).
+    if (eof) {
+      last_read_end_.erase(filename);
+      return;
+    }
+    last_read_end_[filename] = end;
+    if (!sequential || block_map_.find(key) != block_map_.end()) return;
+  }
+  {
+    mutex_lock l(readahead_mu_);
+    ++num_readaheads_;
+  }
+  env_->SchedClosure([this, key]() {
+    std::shared_ptr<Block> block = Lookup(key);
+    if (MaybeFetch(key, block).ok()) {
+      UpdateLRU(key, block).IgnoreError();
+    }
+    mutex_lock l(readahead_mu_);
+    if (--num_readaheads_ == 0) {
+      readahead_done_.notify_all();
+    }
+  });
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64 file_signature) {
   mutex_lock lock(mu_);
@@ -261,6 +298,7 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  last_read_end_.clear();
   cache_size_ = 0;
 }
 
@@ -277,6 +315,7 @@ void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
     RemoveBlock(it);
     it = next;
   }
+  last_read_end_.erase(filename);
 }
 
 void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
@@ -49,13 +49,19 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// If `sequential_readahead` is true and the cache can hold at least two
+  /// blocks, a read that continues where the previous read of the same file
+  /// ended also fetches the following block in the background.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    bool sequential_readahead = false)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        sequential_readahead_(sequential_readahead &&
+                              max_bytes >= 2 * block_size) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
@@ -65,6 +71,12 @@ class RamFileBlockCache : public FileBlockCache {
   }
 
   ~RamFileBlockCache() override {
+    {
+      mutex_lock l(readahead_mu_);
+      while (num_readaheads_ > 0) {
+        readahead_done_.wait(l);
+      }
+    }
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -130,6 +142,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// Whether sequential reads fetch the next block in the background.
+  const bool sequential_readahead_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -206,6 +220,11 @@ class RamFileBlockCache : public FileBlockCache {
   Status UpdateLRU(const Key& key, const std::shared_ptr<Block>& block)
       LOCKS_EXCLUDED(mu_);
 
+  /// Fetches the block `key` in the background, if a sequential read of
+  /// `filename` ended at `end` and the block is not cached yet.
+  void MaybeReadAhead(const string& filename, size_t offset, size_t end,
+                      const Key& key, bool eof) LOCKS_EXCLUDED(mu_);
+
   /// Remove all blocks of a file, with mu_ already held.
   void RemoveFile_Locked(const string& filename) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -241,6 +260,16 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+
+  // The offset at which the last read of each file ended, for detecting
+  // sequential reads.
+  std::map<string, size_t> last_read_end_ GUARDED_BY(mu_);
+
+  /// Guards the count of background readaheads, which the destructor waits
+  /// for.
+  mutex readahead_mu_;
+  condition_variable readahead_done_;
+  int64 num_readaheads_ GUARDED_BY(readahead_mu_) = 0;
 };
 
 }  // namespace tensorflow
@@ -83,6 +83,41 @@ TEST(RamFileBlockCacheTest, ValidateAndUpdateFileSignature) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, SequentialReadahead) {
+  // A 40-byte file, read in blocks of 16.
+  mutex mu;
+  std::vector<size_t> fetched;
+  Notification fetched_last_block;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    const size_t bytes = offset < 40 ? std::min<size_t>(n, 40 - offset) : 0;
+    memset(buffer, 'x', bytes);
+    *bytes_transferred = bytes;
+    mutex_lock l(mu);
+    fetched.push_back(offset);
+    if (offset == 32) fetched_last_block.Notify();
+    return Status::OK();
+  };
+  RamFileBlockCache cache(16, 64, 0, fetcher, Env::Default(),
+                          /*sequential_readahead=*/true);
+  std::vector<char> out;
+  // The first read of a file is not sequential.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  {
+    mutex_lock l(mu);
+    EXPECT_EQ(std::vector<size_t>({0}), fetched);
+  }
+  // The second one is, and reads ahead the third block.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 16, 16, &out));
+  fetched_last_block.WaitForNotification();
+  TF_EXPECT_OK(ReadCache(&cache, "a", 32, 16, &out));
+  EXPECT_EQ(8, out.size());
+  // Nothing is read ahead past the end of the file.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  mutex_lock l(mu);
+  EXPECT_EQ(std::vector<size_t>({0, 16, 32}), fetched);
+}
+
 TEST(RamFileBlockCacheTest, PassThrough) {
   const string want_filename = "foo/bar";
   const size_t want_offset = 42;
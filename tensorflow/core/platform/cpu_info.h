@@ -39,6 +39,34 @@ int NumSchedulableCPUs();
 // on the CPU
 int NumHyperthreadsPerCore();
 
+// Denotes "no NUMA node preference" wherever a NUMA node is passed.
+constexpr int kNUMANoAffinity = -1;
+
+// Returns true iff NUMA support is available on this platform and the host
+// has more than one NUMA node.
+bool NUMAEnabled();
+
+// Returns the number of NUMA nodes of the host, or 1 if NUMA is not
+// supported on this platform.
+int NUMANumNodes();
+
+// Restricts the calling thread to run on the CPUs of NUMA node `node`, or
+// removes that restriction again if `node` is kNUMANoAffinity.  Does nothing
+// if !NUMAEnabled() or `node` is out of range.
+void NUMASetThreadNodeAffinity(int node);
+
+// Returns the NUMA node the calling thread was restricted to by
+// NUMASetThreadNodeAffinity(), or kNUMANoAffinity.
+int NUMAGetThreadNodeAffinity();
+
+// Denotes "not pinned to a CPU" wherever a CPU index is passed.
+constexpr int kNoCPUAffinity = -1;
+
+// Pins the calling thread to one CPU: the (`cpu` modulo their number)-th of
+// the CPUs the process may run on. Does nothing if `cpu` is kNoCPUAffinity
+// or thread affinity is not supported on this platform.
+void SetThreadCPUAffinity(int cpu);
+
 // Mostly ISA related features that we care about
 enum CPUFeature {
   // Do not change numeric assignments.
@@ -489,9 +489,23 @@ Status WriteBinaryProto(Env* env, const string& fname,
 
 Status ReadBinaryProto(Env* env, const string& fname,
                        ::tensorflow::protobuf::MessageLite* proto) {
+  // Parse straight from the file's pages when it can be memory-mapped, which
+  // avoids copying all of it through a read buffer first. Large frozen graphs
+  // are mostly tensor contents, for which that copy is a large part of the
+  // load time.
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
   std::unique_ptr<RandomAccessFile> file;
-  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file));
-  std::unique_ptr<FileStream> stream(new FileStream(file.get()));
+  std::unique_ptr<::tensorflow::protobuf::io::ZeroCopyInputStream> stream;
+  FileStream* file_stream = nullptr;
+  if (env->NewReadOnlyMemoryRegionFromFile(fname, &region).ok() &&
+      region->length() <= static_cast<uint64>(kint32max)) {
+    stream.reset(new ::tensorflow::protobuf::io::ArrayInputStream(
+        region->data(), static_cast<int>(region->length())));
+  } else {
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file));
+    file_stream = new FileStream(file.get());
+    stream.reset(file_stream);
+  }
 
   // TODO(jiayq): the following coded stream is for debugging purposes to allow
   // one to parse arbitrarily large messages for MessageLite. One most likely
@@ -503,7 +517,9 @@ Status ReadBinaryProto(Env* env, const string& fname,
   coded_stream.SetTotalBytesLimit(1024LL << 20, 512LL << 20);
 
   if (!proto->ParseFromCodedStream(&coded_stream)) {
-    TF_RETURN_IF_ERROR(stream->status());
+    if (file_stream != nullptr) {
+      TF_RETURN_IF_ERROR(file_stream->status());
+    }
     return errors::DataLoss("Can't parse ", fname, " as binary proto");
   }
   return Status::OK();
@@ -386,6 +386,12 @@ struct ThreadOptions {
   size_t stack_size = 0;  // 0: use system default value
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
+  /// NUMA node whose CPUs the thread is restricted to, if supported.
+  int numa_node = -1;  // -1: no affinity (port::kNUMANoAffinity)
+  /// CPU the thread is pinned to, as an index into the CPUs the process may
+  /// run on, if supported. Thread pools pin their workers to consecutive CPUs
+  /// starting from this one.
+  int cpu = -1;  // -1: not pinned (port::kNoCPUAffinity)
 };
 
 /// A utility routine: copy contents of `src` in file system `src_fs`
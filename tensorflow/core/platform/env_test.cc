@@ -119,6 +119,15 @@ TEST_F(DefaultEnvTest, ReadWriteBinaryProto) {
   EXPECT_EQ(result.DebugString(), proto.DebugString());
 }
 
+TEST_F(DefaultEnvTest, ReadCorruptBinaryProto) {
+  const string filename = strings::StrCat(BaseDir(), "corrupt_binary_proto");
+  TF_EXPECT_OK(WriteStringToFile(env_, filename, "\xff\xff\xff"));
+
+  GraphDef result;
+  EXPECT_EQ(error::DATA_LOSS,
+            ReadBinaryProto(env_, filename, &result).code());
+}
+
 TEST_F(DefaultEnvTest, ReadWriteTextProto) {
   const GraphDef proto = CreateTestProto();
   const string filename = strings::StrCat(BaseDir(), "text_proto");
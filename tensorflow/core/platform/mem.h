@@ -29,6 +29,21 @@ namespace port {
 void* AlignedMalloc(size_t size, int minimum_alignment);
 void AlignedFree(void* aligned_memory);
 
+// Like AlignedMalloc, but asks for the pages of the returned memory to be
+// placed on NUMA node `node` when they are first touched.  The placement is
+// best effort: it falls back to any node if `node` is out of memory, and to
+// AlignedMalloc if !NUMAEnabled() or `node` is kNUMANoAffinity.  Memory
+// returned by NUMAMalloc must be released with NUMAFree.
+void* NUMAMalloc(int node, size_t size, int minimum_alignment);
+void NUMAFree(void* ptr, size_t size);
+
+// Like AlignedMalloc, but asks for allocations of at least one huge page to be
+// backed by transparent huge pages, and if `interleave` is true, for their
+// pages to be spread round-robin across all NUMA nodes.  Both are best effort
+// and fall back to AlignedMalloc where unsupported.  Memory returned by
+// HugePageMalloc must be released with AlignedFree.
+void* HugePageMalloc(size_t size, int minimum_alignment, bool interleave);
+
 void* Malloc(size_t size);
 void* Realloc(void* ptr, size_t size);
 void Free(void* ptr);
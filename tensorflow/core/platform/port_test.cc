@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string.h>
+
 #include <condition_variable>
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
@@ -33,6 +35,45 @@ TEST(Port, AlignedMalloc) {
   }
 }
 
+TEST(Port, NUMAMalloc) {
+  for (int node = kNUMANoAffinity; node < NUMANumNodes(); ++node) {
+    for (size_t size : {1, 1 << 20}) {
+      void* p = NUMAMalloc(node, size, 64);
+      ASSERT_TRUE(p != nullptr) << "NUMAMalloc(" << node << ", " << size << ")";
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0);
+      memset(p, 0, size);
+      NUMAFree(p, size);
+    }
+  }
+}
+
+TEST(Port, HugePageMalloc) {
+  for (bool interleave : {false, true}) {
+    for (size_t size : {1, 1 << 20, 5 << 20}) {
+      void* p = HugePageMalloc(size, 64, interleave);
+      ASSERT_TRUE(p != nullptr) << "HugePageMalloc(" << size << ")";
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0);
+      memset(p, 0, size);
+      AlignedFree(p);
+    }
+  }
+}
+
+TEST(Port, NUMAThreadAffinity) {
+  EXPECT_GE(NUMANumNodes(), 1);
+  EXPECT_EQ(NUMAEnabled(), NUMANumNodes() > 1);
+  for (int node = 0; node < NUMANumNodes(); ++node) {
+    ThreadOptions thread_options;
+    thread_options.numa_node = node;
+    int affinity = -2;
+    {
+      thread::ThreadPool pool(Env::Default(), thread_options, "numa", 1);
+      pool.Schedule([&affinity]() { affinity = NUMAGetThreadNodeAffinity(); });
+    }
+    EXPECT_EQ(NUMAEnabled() ? node : kNUMANoAffinity, affinity);
+  }
+}
+
 TEST(ConditionVariable, WaitForMilliseconds_Timeout) {
   mutex m;
   mutex_lock l(m);
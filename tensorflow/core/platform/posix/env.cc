@@ -29,6 +29,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/lib/core/error_codes.pb.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/load_library.h"
 #include "tensorflow/core/platform/logging.h"
@@ -40,10 +41,18 @@ namespace {
 
 class StdThread : public Thread {
  public:
-  // name and thread_options are both ignored.
+  // name and thread_options, except for numa_node and cpu, are ignored.
   StdThread(const ThreadOptions& thread_options, const string& name,
             std::function<void()> fn)
-      : thread_(fn) {}
+      : thread_(thread_options.numa_node == port::kNUMANoAffinity &&
+                        thread_options.cpu == port::kNoCPUAffinity
+                    ? fn
+                    : [fn, thread_options]() {
+                        port::NUMASetThreadNodeAffinity(
+                            thread_options.numa_node);
+                        port::SetThreadCPUAffinity(thread_options.cpu);
+                        fn();
+                      }) {}
   ~StdThread() override { thread_.join(); }
 
  private:
@@ -29,12 +29,17 @@ limitations under the License.
 
 #if defined(__linux__) && !defined(__ANDROID__)
 #include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
 #endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+
+#include <algorithm>
+#include <vector>
 #ifdef TF_USE_SNAPPY
 #include "snappy.h"
 #endif
@@ -79,6 +84,204 @@ int NumHyperthreadsPerCore() {
   return (ht_per_core > 0) ? ht_per_core : 1;
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// From <numaif.h>, which is not available everywhere.
+constexpr int kMPolPreferred = 1;
+constexpr int kMPolInterleave = 3;
+
+// The size of the transparent huge pages of x86-64 and arm64 kernels.
+constexpr size_t kHugePageSize = 2 << 20;
+
+// Parses a sysfs CPU list such as "0-7,16-23" into 'cpus'.
+bool ParseCPUList(const char* list, cpu_set_t* cpus) {
+  CPU_ZERO(cpus);
+  const char* p = list;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    const long first = strtol(p, &end, 10);
+    if (end == p) return false;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = strtol(p + 1, &end, 10);
+      if (end == p + 1) return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+      CPU_SET(cpu, cpus);
+    }
+    if (*p == ',') ++p;
+  }
+  return true;
+}
+
+// The CPUs of each NUMA node of the host, read once from sysfs.
+const std::vector<cpu_set_t>& NUMANodeCPUs() {
+  static const std::vector<cpu_set_t>* node_cpus = [] {
+    auto* nodes = new std::vector<cpu_set_t>;
+    for (int node = 0;; ++node) {
+      char path[64];
+      snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+               node);
+      FILE* f = fopen(path, "r");
+      if (f == nullptr) break;
+      char list[4096];
+      cpu_set_t cpus;
+      const bool ok = fgets(list, sizeof(list), f) != nullptr &&
+                      ParseCPUList(list, &cpus);
+      fclose(f);
+      if (!ok) break;
+      nodes->push_back(cpus);
+    }
+    return nodes;
+  }();
+  return *node_cpus;
+}
+
+// The CPUs the process may run on, before any thread was restricted to a
+// NUMA node.
+const cpu_set_t& ProcessCPUs() {
+  static const cpu_set_t* process_cpus = [] {
+    auto* cpus = new cpu_set_t;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), cpus) != 0) {
+      CPU_ZERO(cpus);
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) CPU_SET(cpu, cpus);
+    }
+    return cpus;
+  }();
+  return *process_cpus;
+}
+
+thread_local int thread_numa_node = kNUMANoAffinity;
+
+}  // namespace
+#endif
+
+bool NUMAEnabled() { return NUMANumNodes() > 1; }
+
+int NUMANumNodes() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  return std::max<int>(1, NUMANodeCPUs().size());
+#else
+  return 1;
+#endif
+}
+
+void NUMASetThreadNodeAffinity(int node) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  if (!NUMAEnabled() || node < kNUMANoAffinity || node >= NUMANumNodes()) {
+    return;
+  }
+  cpu_set_t cpus = ProcessCPUs();
+  if (node != kNUMANoAffinity) {
+    CPU_AND(&cpus, &cpus, &NUMANodeCPUs()[node]);
+    if (CPU_COUNT(&cpus) == 0) {
+      LOG(WARNING) << "None of the CPUs of NUMA node " << node
+                   << " are schedulable";
+      return;
+    }
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &cpus) != 0) {
+    perror("sched_setaffinity");
+    return;
+  }
+  thread_numa_node = node;
+#endif
+}
+
+int NUMAGetThreadNodeAffinity() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  return thread_numa_node;
+#else
+  return kNUMANoAffinity;
+#endif
+}
+
+void SetThreadCPUAffinity(int cpu) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  if (cpu < 0) {
+    return;
+  }
+  const cpu_set_t& process_cpus = ProcessCPUs();
+  const int num_cpus = CPU_COUNT(&process_cpus);
+  if (num_cpus == 0) {
+    return;
+  }
+  int index = cpu % num_cpus;
+  for (int i = 0; i < CPU_SETSIZE; ++i) {
+    if (!CPU_ISSET(i, &process_cpus)) continue;
+    if (index-- == 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(i, &cpus);
+      if (sched_setaffinity(0, sizeof(cpu_set_t), &cpus) != 0) {
+        perror("sched_setaffinity");
+      }
+      return;
+    }
+  }
+#endif
+}
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+  if (NUMAEnabled() && node >= 0 && node < NUMANumNodes() &&
+      node < static_cast<int>(8 * sizeof(unsigned long))) {
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    // Only whole pages can be bound, so small requests are left to the
+    // first-touch placement of the allocating thread.
+    if (size >= page_size) {
+      void* ptr = AlignedMalloc(
+          size, std::max<size_t>(minimum_alignment, page_size));
+      if (ptr != nullptr) {
+        const unsigned long node_mask = 1UL << node;
+        // Best effort: pages that were already touched stay where they are.
+        syscall(SYS_mbind, ptr, size / page_size * page_size, kMPolPreferred,
+                &node_mask, 8 * sizeof(node_mask), 0);
+      }
+      return ptr;
+    }
+  }
+#endif
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void NUMAFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
+void* HugePageMalloc(size_t size, int minimum_alignment, bool interleave) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  // Only whole, aligned huge pages can be promoted, so smaller requests would
+  // just waste the alignment padding.
+  if (size >= kHugePageSize) {
+    void* ptr = AlignedMalloc(
+        size, std::max<size_t>(minimum_alignment, kHugePageSize));
+    if (ptr != nullptr) {
+      const size_t huge_size = size / kHugePageSize * kHugePageSize;
+#ifdef MADV_HUGEPAGE
+      madvise(ptr, huge_size, MADV_HUGEPAGE);
+#endif
+#ifdef SYS_mbind
+      if (interleave && NUMAEnabled()) {
+        const int num_nodes = std::min<int>(
+            NUMANumNodes(), static_cast<int>(8 * sizeof(unsigned long)));
+        const unsigned long node_mask =
+            num_nodes == static_cast<int>(8 * sizeof(unsigned long))
+                ? ~0UL
+                : (1UL << num_nodes) - 1;
+        // Best effort, as in NUMAMalloc.
+        syscall(SYS_mbind, ptr, huge_size, kMPolInterleave, &node_mask,
+                8 * sizeof(node_mask), 0);
+      }
+#endif
+    }
+    return ptr;
+  }
+#endif
+  return AlignedMalloc(size, minimum_alignment);
+}
+
 void* AlignedMalloc(size_t size, int minimum_alignment) {
 #if defined(__ANDROID__)
   return memalign(minimum_alignment, size);
@@ -0,0 +1,115 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/profile_utils/perf_event_counters.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace profile_utils {
+
+namespace {
+
+constexpr int kNumCounters = 3;
+constexpr uint64 kCounterConfigs[kNumCounters] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES};
+
+// The counters of one thread, read together as a perf_event group.
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    for (int i = 0; i < kNumCounters; ++i) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = kCounterConfigs[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      const int group_fd = i == 0 ? -1 : fds_[0];
+      fds_[i] = syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                        group_fd, /*flags=*/0);
+      if (fds_[i] < 0) {
+        static std::atomic<bool> logged(false);
+        if (!logged.exchange(true)) {
+          LOG(WARNING) << "Hardware performance counters are not available: "
+                       << strerror(errno);
+        }
+        Close();
+        return;
+      }
+    }
+  }
+
+  ~ThreadCounters() { Close(); }
+
+  bool Read(PerfEventCounters::Values* values) {
+    if (fds_[0] < 0) return false;
+    // With PERF_FORMAT_GROUP, the number of counters and then their values.
+    uint64 buffer[1 + kNumCounters];
+    if (read(fds_[0], buffer, sizeof(buffer)) != sizeof(buffer) ||
+        buffer[0] != kNumCounters) {
+      return false;
+    }
+    values->cycles = buffer[1];
+    values->instructions = buffer[2];
+    values->llc_misses = buffer[3];
+    return true;
+  }
+
+ private:
+  void Close() {
+    for (int i = kNumCounters - 1; i >= 0; --i) {
+      if (fds_[i] >= 0) close(fds_[i]);
+      fds_[i] = -1;
+    }
+  }
+
+  int fds_[kNumCounters] = {-1, -1, -1};
+};
+
+}  // namespace
+
+/* static */ bool PerfEventCounters::Read(Values* values) {
+  static thread_local ThreadCounters counters;
+  return counters.Read(values);
+}
+
+}  // namespace profile_utils
+}  // namespace tensorflow
+
+#else  // defined(__linux__) && !defined(__ANDROID__)
+
+namespace tensorflow {
+namespace profile_utils {
+
+/* static */ bool PerfEventCounters::Read(Values* values) { return false; }
+
+}  // namespace profile_utils
+}  // namespace tensorflow
+
+#endif  // defined(__linux__) && !defined(__ANDROID__)
@@ -0,0 +1,52 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_PLATFORM_PROFILE_UTILS_PERF_EVENT_COUNTERS_H_
+#define TENSORFLOW_PLATFORM_PROFILE_UTILS_PERF_EVENT_COUNTERS_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profile_utils {
+
+// Reads the hardware performance counters of the calling thread, with
+// perf_event_open on Linux. The counters of a thread are opened on its first
+// read and stay open until the thread exits; they only count user-space
+// events.
+class PerfEventCounters {
+ public:
+  // The size of the cache lines that LLC misses fetch from memory.
+  static constexpr int64 kCacheLineBytes = 64;
+
+  struct Values {
+    int64 cycles = 0;
+    int64 instructions = 0;
+    // Last-level cache misses.
+    int64 llc_misses = 0;
+  };
+
+  // Reads the counters of the calling thread into `values`. Returns false if
+  // they are not available: on platforms other than Linux, in most virtual
+  // machines, and if perf_event_paranoid forbids it.
+  static bool Read(Values* values);
+
+ private:
+  PerfEventCounters() = delete;
+};
+
+}  // namespace profile_utils
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_PLATFORM_PROFILE_UTILS_PERF_EVENT_COUNTERS_H_
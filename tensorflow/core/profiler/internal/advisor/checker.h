@@ -28,6 +28,7 @@ static const char* const kCheckers[] = {
     "AcceleratorUtilizationChecker", "OperationChecker",
     "ExpensiveOperationChecker",
     "JobChecker",  // Internal checker.
+    "HardwareCounterChecker", "MemoryChecker", "InputPipelineChecker",
 };
 
 class Checker {
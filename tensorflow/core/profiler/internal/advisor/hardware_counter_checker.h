@@ -0,0 +1,94 @@
+/* Copyright 2018 The TensorFlow Authors All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// This checker checks whether the most expensive CPU operations are
+// memory-bound or compute-bound, with their hardware counters.
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_HARDWARE_COUNTER_CHECKER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_HARDWARE_COUNTER_CHECKER_H_
+
+#include "tensorflow/core/profiler/internal/advisor/checker.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+class HardwareCounterChecker : public Checker {
+ public:
+  string name() const override { return kCheckers[4]; }
+
+  // Operations with more last-level cache misses per 1000 instructions are
+  // considered memory-bound.
+  static constexpr double kMemoryBoundMPKI = 5.0;
+
+ private:
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!stats) {
+      fprintf(stderr, "Missing profiles (e.g. graph, run_meta). Skip %s\n",
+              name().c_str());
+      return reports_;
+    }
+    if (stats->steps().empty()) {
+      fprintf(stderr, "Missing run_meta for %s\n", name().c_str());
+      return reports_;
+    }
+    CheckOpView(stats);
+    return reports_;
+  }
+
+  void CheckOpView(const TFStats* stats) {
+    Options opts(3, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, -1, "cpu_micros", {".*"},
+                 {".*"}, {}, {".*"}, {}, false, {"cpu_micros", "hw_counters"},
+                 "none", {});
+    const MultiGraphNodeProto root = stats->ShowMultiGraphNode("op", opts);
+    std::vector<string> outputs;
+    for (int i = 0; i < root.children_size() && outputs.size() < 3; ++i) {
+      const MultiGraphNodeProto& node = root.children(i);
+      const HardwareCounters& counters = node.hardware_counters();
+      if (counters.cycles() <= 0 || counters.instructions() <= 0) {
+        continue;
+      }
+      const double ipc =
+          static_cast<double>(counters.instructions()) / counters.cycles();
+      const double mpki =
+          1000.0 * counters.llc_misses() / counters.instructions();
+      // Bytes per microsecond are MB/s.
+      const double gb_per_sec =
+          counters.dram_bytes() / (1000.0 * (node.cpu_exec_micros() + 1e-10));
+      outputs.push_back(strings::Printf(
+          "top %d cpu operation type: %s, cpu: %s, %.2f IPC, %.2f LLC MPKI, "
+          "~%.2fGB/s DRAM: %s",
+          static_cast<int>(outputs.size()) + 1, node.name().c_str(),
+          FormatTime(node.cpu_exec_micros()).c_str(), ipc, mpki, gb_per_sec,
+          mpki >= kMemoryBoundMPKI
+              ? "likely memory-bound, consider improving data locality or "
+                "fusing it with its producers and consumers"
+              : "likely compute-bound"));
+    }
+    if (outputs.empty()) {
+      fprintf(stderr,
+              "Missing hardware counters for %s. Set "
+              "RunOptions.experimental.collect_hardware_counters.\n",
+              name().c_str());
+      return;
+    }
+    reports_.add_reports(str_util::Join(outputs, "\n"));
+  }
+
+  AdviceProto::Checker reports_;
+};
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_HARDWARE_COUNTER_CHECKER_H_
@@ -0,0 +1,246 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// This checker checks whether the steps wait for the input pipeline, and
+// which stage of the pipeline is the bottleneck, with the iterator statistics
+// that tf.data exports into the RunMetadata.
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_INPUT_PIPELINE_CHECKER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_INPUT_PIPELINE_CHECKER_H_
+
+#include <algorithm>
+#include <tuple>
+
+#include "tensorflow/core/profiler/internal/advisor/checker.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+class InputPipelineChecker : public Checker {
+ public:
+  string name() const override { return kCheckers[6]; }
+
+  // Steps spending at least this fraction of their time in IteratorGetNext
+  // are considered input-bound.
+  static constexpr double kInputBoundFraction = 0.1;
+  // A prefetch buffer below this occupancy starves its consumer, and one
+  // above kFullBufferFraction is kept full by its producer.
+  static constexpr double kEmptyBufferFraction = 0.1;
+  static constexpr double kFullBufferFraction = 0.9;
+  static constexpr int kMaxReportedSteps = 5;
+  static constexpr int kMaxReportedStages = 5;
+
+ private:
+  // An iterator of the pipeline, named by its prefix, e.g.
+  // "Iterator::Prefetch::ParallelMap".
+  struct Stage {
+    string prefix;
+    string type;
+    const DatasetIteratorStats* stats;
+    // The processing time, excluding the waits for background threads.
+    int64 self_micros;
+  };
+
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!stats) {
+      fprintf(stderr, "Missing profiles (e.g. graph, run_meta). Skip %s\n",
+              name().c_str());
+      return reports_;
+    }
+    if (stats->steps().empty()) {
+      fprintf(stderr, "Missing run_meta for %s\n", name().c_str());
+      return reports_;
+    }
+    CheckGetNext(stats);
+    CheckPipeline(stats);
+    return reports_;
+  }
+
+  // Reports the steps that spend the most time waiting in IteratorGetNext.
+  void CheckGetNext(const TFStats* stats) {
+    // {get_next_micros, step_micros, step}
+    std::vector<std::tuple<int64, int64, int64>> input_bound_steps;
+    for (int64 step : stats->steps()) {
+      int64 start_micros = kint64max;
+      int64 end_micros = 0;
+      int64 get_next_micros = 0;
+      for (const auto& n : stats->nodes()) {
+        const TFGraphNode* node = n.second.get();
+        if (node->dataset_iterator_stats(step) ||
+            node->all_start_micros(step) <= 0) {
+          continue;
+        }
+        start_micros = std::min(start_micros, node->all_start_micros(step));
+        end_micros = std::max(end_micros, node->latest_end_micros(step));
+        if (node->op() == "IteratorGetNext" ||
+            node->op() == "IteratorGetNextSync") {
+          get_next_micros += node->exec_micros(step);
+        }
+      }
+      const int64 step_micros = end_micros - start_micros;
+      if (step_micros > 0 &&
+          get_next_micros >= kInputBoundFraction * step_micros) {
+        input_bound_steps.emplace_back(get_next_micros, step_micros, step);
+      }
+    }
+    if (input_bound_steps.empty()) {
+      return;
+    }
+    std::sort(input_bound_steps.begin(), input_bound_steps.end(),
+              [](const std::tuple<int64, int64, int64>& a,
+                 const std::tuple<int64, int64, int64>& b) {
+                return std::get<0>(a) * std::get<1>(b) >
+                       std::get<0>(b) * std::get<1>(a);
+              });
+    std::vector<string> outputs;
+    outputs.push_back(strings::Printf(
+        "%zu of %zu steps spend over %.0f%% of their time waiting for the "
+        "input pipeline in IteratorGetNext:",
+        input_bound_steps.size(), stats->steps().size(),
+        100 * kInputBoundFraction));
+    for (int i = 0; i < kMaxReportedSteps && i < input_bound_steps.size();
+         ++i) {
+      const auto& s = input_bound_steps[i];
+      outputs.push_back(strings::Printf(
+          "  step %lld: %.2fms of %.2fms (%.2f%%)", std::get<2>(s),
+          std::get<0>(s) / 1000.0, std::get<1>(s) / 1000.0,
+          100.0 * std::get<0>(s) / std::get<1>(s)));
+    }
+    reports_.add_reports(str_util::Join(outputs, "\n"));
+  }
+
+  // Reports the most expensive stages of the input pipelines, and advice for
+  // the bottleneck stage.
+  void CheckPipeline(const TFStats* stats) {
+    // The statistics are totals since the iterators were created, so the
+    // last step that has them covers all the others.
+    std::vector<Stage> stages;
+    for (auto step = stats->steps().rbegin();
+         step != stats->steps().rend() && stages.empty(); ++step) {
+      for (const auto& n : stats->nodes()) {
+        const DatasetIteratorStats* iterator_stats =
+            n.second->dataset_iterator_stats(*step);
+        if (!iterator_stats || iterator_stats->num_calls() == 0) {
+          continue;
+        }
+        Stage stage;
+        stage.prefix = n.second->name();
+        const std::vector<string> components =
+            str_util::Split(stage.prefix, "::");
+        stage.type = components.back();
+        stage.stats = iterator_stats;
+        stage.self_micros = std::max<int64>(
+            0, iterator_stats->processing_micros() -
+                   iterator_stats->wait_micros());
+        stages.push_back(stage);
+      }
+    }
+    if (stages.empty()) {
+      return;
+    }
+    std::sort(stages.begin(), stages.end(),
+              [](const Stage& a, const Stage& b) {
+                return a.self_micros > b.self_micros;
+              });
+    int64 total_micros = 0;
+    for (const Stage& stage : stages) {
+      total_micros += stage.self_micros;
+    }
+    std::vector<string> outputs;
+    outputs.push_back("Most expensive input pipeline stages:");
+    for (int i = 0; i < kMaxReportedStages && i < stages.size(); ++i) {
+      const Stage& stage = stages[i];
+      const int64 num_elements =
+          std::max<int64>(1, stage.stats->num_elements());
+      outputs.push_back(strings::Printf(
+          "  %s: %.2fus per element, %.2f%% of pipeline time",
+          stage.prefix.c_str(),
+          static_cast<double>(stage.self_micros) / num_elements,
+          total_micros > 0 ? 100.0 * stage.self_micros / total_micros : 0.0));
+    }
+    reports_.add_reports(str_util::Join(outputs, "\n"));
+
+    const Stage& bottleneck = stages.front();
+    if (bottleneck.self_micros > 0) {
+      reports_.add_reports(strings::Printf(
+          "%s is the input pipeline bottleneck. %s", bottleneck.prefix.c_str(),
+          StageAdvice(bottleneck).c_str()));
+    }
+    for (const Stage& stage : stages) {
+      if (stage.type != "Prefetch" || stage.stats->buffer_capacity() <= 0) {
+        continue;
+      }
+      const double occupancy =
+          stage.stats->mean_buffer_size() / stage.stats->buffer_capacity();
+      if (occupancy < kEmptyBufferFraction && stage.stats->num_waits() > 0) {
+        reports_.add_reports(strings::Printf(
+            "%s buffer is %.2f%% full on average and waited %lld times: "
+            "its input is too slow to keep it filled.",
+            stage.prefix.c_str(), 100 * occupancy,
+            static_cast<int64>(stage.stats->num_waits())));
+      } else if (occupancy >= kFullBufferFraction) {
+        reports_.add_reports(strings::Printf(
+            "%s buffer is %.2f%% full on average: the input pipeline is not "
+            "the bottleneck.",
+            stage.prefix.c_str(), 100 * occupancy));
+      }
+    }
+    for (const Stage& stage : stages) {
+      // The root iterators, e.g. "Iterator::Batch".
+      const std::vector<string> components =
+          str_util::Split(stage.prefix, "::");
+      if (components.size() == 2 && stage.type != "Prefetch") {
+        reports_.add_reports(strings::Printf(
+            "%s is not prefetched: add .prefetch(1) at the end of the input "
+            "pipeline to overlap it with the steps.",
+            stage.prefix.c_str()));
+      }
+    }
+  }
+
+  string StageAdvice(const Stage& stage) {
+    const DatasetIteratorStats& s = *stage.stats;
+    if (stage.type == "Map") {
+      return "Set num_parallel_calls of the map to process elements in "
+             "parallel.";
+    }
+    if (stage.type == "ParallelMap" || stage.type == "MapAndBatch") {
+      if (s.buffer_capacity() > 0 && s.num_waits() > 0 &&
+          s.mean_buffer_size() / s.buffer_capacity() < kEmptyBufferFraction) {
+        return strings::Printf(
+            "Its %lld parallel calls are rarely ready: increase "
+            "num_parallel_calls.",
+            static_cast<int64>(s.buffer_capacity()));
+      }
+      return "Reduce the cost of the map function, or cache its results.";
+    }
+    if (stage.type == "Interleave" || stage.type == "FlatMap" ||
+        stage.type == "TFRecord" || stage.type == "TextLine" ||
+        stage.type == "FixedLengthRecord") {
+      return "Read the input files in parallel with parallel_interleave.";
+    }
+    if (stage.type == "Shuffle") {
+      return "Reduce the shuffle buffer_size, or shuffle the file names "
+             "instead.";
+    }
+    return "Cache its output, or parallelize it.";
+  }
+
+  AdviceProto::Checker reports_;
+};
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_INPUT_PIPELINE_CHECKER_H_
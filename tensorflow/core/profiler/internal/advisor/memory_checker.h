@@ -0,0 +1,184 @@
+/* Copyright 2018 The TensorFlow Authors All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// This checker reports the live tensors at the memory peak of each allocator
+// of each device, and the ops and code that allocated them.
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_MEMORY_CHECKER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_MEMORY_CHECKER_H_
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/profiler/internal/advisor/checker.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+class MemoryChecker : public Checker {
+ public:
+  string name() const override { return kCheckers[5]; }
+
+  static constexpr int kMaxReportedOpTypes = 5;
+  static constexpr int kMaxReportedTensors = 10;
+
+ private:
+  // A tensor allocated by a graph node.
+  struct Tensor {
+    TFGraphNode* node;
+    const TensorLifetime* lifetime;
+  };
+
+  // The live tensors of a <device, allocator> pair at its memory peak.
+  struct Peak {
+    int64 step = -1;
+    int64 micros = 0;
+    int64 bytes = 0;
+    std::vector<Tensor> live_tensors;
+  };
+
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!stats) {
+      fprintf(stderr, "Missing profiles (e.g. graph, run_meta). Skip %s\n",
+              name().c_str());
+      return reports_;
+    }
+    if (stats->steps().empty()) {
+      fprintf(stderr, "Missing run_meta for %s\n", name().c_str());
+      return reports_;
+    }
+    // <device, allocator> -> the highest peak over all steps.
+    std::map<std::pair<string, string>, Peak> peaks;
+    for (int64 step : stats->steps()) {
+      std::map<std::pair<string, string>, std::vector<Tensor>> tensors;
+      for (const auto& n : stats->nodes()) {
+        TFGraphNode* node = n.second.get();
+        for (const TensorLifetime& lifetime : node->tensor_lifetimes(step)) {
+          tensors[std::make_pair(node->canonical_device(),
+                                 lifetime.allocator())]
+              .push_back({node, &lifetime});
+        }
+      }
+      for (auto& t : tensors) {
+        Peak peak = FindPeak(step, std::move(t.second));
+        if (peak.bytes > peaks[t.first].bytes) {
+          peaks[t.first] = std::move(peak);
+        }
+      }
+    }
+    for (const auto& p : peaks) {
+      reports_.add_reports(
+          FormatPeak(p.first.first, p.first.second, p.second));
+    }
+    return reports_;
+  }
+
+  // Replays the allocations and deallocations of `tensors` in time order.
+  Peak FindPeak(int64 step, std::vector<Tensor> tensors) {
+    // {micros, bytes}, with deallocations before allocations at the same
+    // time.
+    std::vector<std::pair<int64, int64>> events;
+    for (const Tensor& t : tensors) {
+      events.emplace_back(t.lifetime->alloc_micros(), t.lifetime->bytes());
+      if (t.lifetime->dealloc_micros() > 0) {
+        events.emplace_back(t.lifetime->dealloc_micros(),
+                            -t.lifetime->bytes());
+      }
+    }
+    std::sort(events.begin(), events.end());
+    Peak peak;
+    peak.step = step;
+    int64 live_bytes = 0;
+    for (const auto& e : events) {
+      live_bytes += e.second;
+      if (live_bytes > peak.bytes) {
+        peak.bytes = live_bytes;
+        peak.micros = e.first;
+      }
+    }
+    for (const Tensor& t : tensors) {
+      if (t.lifetime->alloc_micros() <= peak.micros &&
+          (t.lifetime->dealloc_micros() == 0 ||
+           t.lifetime->dealloc_micros() > peak.micros)) {
+        peak.live_tensors.push_back(t);
+      }
+    }
+    std::sort(peak.live_tensors.begin(), peak.live_tensors.end(),
+              [](const Tensor& a, const Tensor& b) {
+                return a.lifetime->bytes() > b.lifetime->bytes();
+              });
+    return peak;
+  }
+
+  string FormatPeak(const string& device, const string& allocator,
+                    const Peak& peak) {
+    std::vector<string> outputs;
+    outputs.push_back(strings::Printf(
+        "device: %s, allocator: %s, peak: %s in %zu tensors at %lldus "
+        "(step %lld)",
+        device.c_str(), allocator.c_str(), FormatMemory(peak.bytes).c_str(),
+        peak.live_tensors.size(), peak.micros, peak.step));
+
+    std::map<string, int64> op_type_bytes;
+    for (const Tensor& t : peak.live_tensors) {
+      op_type_bytes[t.node->op()] += t.lifetime->bytes();
+    }
+    std::vector<std::pair<int64, string>> op_types;
+    for (const auto& o : op_type_bytes) {
+      op_types.emplace_back(o.second, o.first);
+    }
+    std::sort(op_types.rbegin(), op_types.rend());
+    for (int i = 0; i < kMaxReportedOpTypes && i < op_types.size(); ++i) {
+      outputs.push_back(strings::Printf(
+          "  top %d operation type: %s, %s (%.2f%%)", i + 1,
+          op_types[i].second.c_str(), FormatMemory(op_types[i].first).c_str(),
+          100.0 * op_types[i].first / peak.bytes));
+    }
+
+    for (int i = 0; i < kMaxReportedTensors && i < peak.live_tensors.size();
+         ++i) {
+      const Tensor& t = peak.live_tensors[i];
+      string tensor =
+          t.lifetime->slot() >= 0
+              ? strings::StrCat(t.node->name(), ":", t.lifetime->slot())
+              : strings::StrCat("temporary of ", t.node->name());
+      string lifetime =
+          t.lifetime->dealloc_micros() > 0
+              ? strings::StrCat(
+                    "live ", FormatTime(t.lifetime->dealloc_micros() -
+                                        t.lifetime->alloc_micros()))
+              : "not deallocated in step";
+      string output = strings::Printf(
+          "  %s %s (%s), allocated at %lldus, %s",
+          FormatMemory(t.lifetime->bytes()).c_str(), tensor.c_str(),
+          t.node->op().c_str(),
+          static_cast<int64>(t.lifetime->alloc_micros()), lifetime.c_str());
+      const CallStack* call_stack = t.node->call_stack();
+      if (call_stack && !call_stack->traces().empty()) {
+        const CallStack::Trace& trace = call_stack->traces().back();
+        strings::StrAppend(&output, ", ", io::Basename(trace.file()), ":",
+                           trace.lineno());
+      }
+      outputs.push_back(output);
+    }
+    return str_util::Join(outputs, "\n");
+  }
+
+  AdviceProto::Checker reports_;
+};
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_MEMORY_CHECKER_H_
@@ -19,7 +19,10 @@ limitations under the License.
 #include "tensorflow/core/profiler/internal/advisor/accelerator_utilization_checker.h"
 #include "tensorflow/core/profiler/internal/advisor/checker.h"
 #include "tensorflow/core/profiler/internal/advisor/expensive_operation_checker.h"
+#include "tensorflow/core/profiler/internal/advisor/hardware_counter_checker.h"
+#include "tensorflow/core/profiler/internal/advisor/input_pipeline_checker.h"
 #include "tensorflow/core/profiler/internal/advisor/internal_checker_runner.h"
+#include "tensorflow/core/profiler/internal/advisor/memory_checker.h"
 #include "tensorflow/core/profiler/internal/advisor/operation_checker.h"
 #include "tensorflow/core/profiler/tfprof_options.pb.h"
 
@@ -61,6 +64,22 @@ class Advisor {
           expensive_op_checker.Run(options.checkers().at(kCheckers[2]),
                                    stats_));
     }
+    if (options.checkers().find(kCheckers[4]) != options.checkers().end()) {
+      HardwareCounterChecker hw_counter_checker;
+      (*ret.mutable_checkers())[kCheckers[4]].MergeFrom(
+          hw_counter_checker.Run(options.checkers().at(kCheckers[4]), stats_));
+    }
+    if (options.checkers().find(kCheckers[5]) != options.checkers().end()) {
+      MemoryChecker memory_checker;
+      (*ret.mutable_checkers())[kCheckers[5]].MergeFrom(
+          memory_checker.Run(options.checkers().at(kCheckers[5]), stats_));
+    }
+    if (options.checkers().find(kCheckers[6]) != options.checkers().end()) {
+      InputPipelineChecker input_pipeline_checker;
+      (*ret.mutable_checkers())[kCheckers[6]].MergeFrom(
+          input_pipeline_checker.Run(options.checkers().at(kCheckers[6]),
+                                     stats_));
+    }
     for (const auto& checker : ret.checkers()) {
       fprintf(stdout, "\n%s:\n", checker.first.c_str());
       for (const string& r : checker.second.reports()) {
@@ -65,6 +65,66 @@ class TFProfAdvisorTest : public ::testing::Test {
     return node;
   }
 
+  // Creates a node that ran on a 2GHz CPU for `exec_micros`, with the given
+  // hardware counters.
+  std::unique_ptr<TFGraphNode> CreateCPUNode(const string& name,
+                                             const string& type, int64 step,
+                                             int64 exec_micros,
+                                             int64 instructions,
+                                             int64 llc_misses) {
+    node_defs_.push_back(std::unique_ptr<NodeDef>(new NodeDef()));
+    NodeDef* def = node_defs_.back().get();
+    def->set_name(name);
+    def->set_op(type);
+    std::unique_ptr<TFGraphNode> node(new TFGraphNode(def, -1, nullptr));
+
+    NodeExecStats node_stat;
+    node_stat.set_all_start_micros(1);
+    node_stat.set_op_end_rel_micros(exec_micros);
+    HardwareCounters* counters = node_stat.mutable_hardware_counters();
+    counters->set_cycles(2000 * exec_micros);
+    counters->set_instructions(instructions);
+    counters->set_llc_misses(llc_misses);
+    counters->set_dram_bytes(64 * llc_misses);
+    node->AddStepStat(step, "/job:localhost/replica:0/task:0/device:CPU:0",
+                      node_stat);
+    return node;
+  }
+
+  // Creates the node of an input pipeline iterator, with its statistics.
+  std::unique_ptr<TFGraphNode> CreateIteratorNode(
+      const string& prefix, int64 step,
+      const DatasetIteratorStats& iterator_stats) {
+    node_defs_.push_back(std::unique_ptr<NodeDef>(new NodeDef()));
+    NodeDef* def = node_defs_.back().get();
+    def->set_name(prefix);
+    def->set_op(prefix);
+    std::unique_ptr<TFGraphNode> node(new TFGraphNode(def, -1, nullptr));
+
+    NodeExecStats node_stat;
+    node_stat.set_all_start_micros(100);
+    *node_stat.mutable_dataset_iterator_stats() = iterator_stats;
+    node->AddStepStat(
+        step, "/job:localhost/replica:0/task:0/device:CPU:0/iterator_stats",
+        node_stat);
+    return node;
+  }
+
+  // Adds an allocation record, and its deallocation if `dealloc_micros` > 0.
+  void AddAllocation(AllocatorMemoryUsed* memory, int64 id, int64 bytes,
+                     int64 alloc_micros, int64 dealloc_micros) {
+    AllocationRecord* record = memory->add_allocation_records();
+    record->set_allocation_id(id);
+    record->set_alloc_bytes(bytes);
+    record->set_alloc_micros(alloc_micros);
+    if (dealloc_micros > 0) {
+      record = memory->add_allocation_records();
+      record->set_allocation_id(id);
+      record->set_alloc_bytes(-bytes);
+      record->set_alloc_micros(dealloc_micros);
+    }
+  }
+
   std::unique_ptr<TFStats> stats_;
   std::unique_ptr<Advisor> advisor_;
   std::vector<std::unique_ptr<NodeDef>> node_defs_;
@@ -105,5 +165,172 @@ TEST_F(TFProfAdvisorTest, ExpensiveOperationChecker) {
                             "top 1 operation type: Conv2D"));
 }
 
+TEST_F(TFProfAdvisorTest, HardwareCounterChecker) {
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[4]];
+  // Without hardware counters, there is nothing to report.
+  AdviceProto advice = advisor_->Advise(options);
+  EXPECT_EQ(advice.checkers().at(kCheckers[4]).reports_size(), 0);
+
+  TFStats stats(std::unique_ptr<GraphDef>(new GraphDef()), nullptr, nullptr,
+                nullptr);
+  stats.AddNodeForTest(0, CreateCPUNode("n3", "MatMul", 0, 100,
+                                        /*instructions=*/300000,
+                                        /*llc_misses=*/100));
+  stats.AddNodeForTest(0, CreateCPUNode("n4", "Gather", 0, 50,
+                                        /*instructions=*/100000,
+                                        /*llc_misses=*/2000));
+  stats.BuildAllViews();
+  advice = Advisor(&stats).Advise(options);
+  ASSERT_EQ(advice.checkers().at(kCheckers[4]).reports_size(), 1);
+  const string& report = advice.checkers().at(kCheckers[4]).reports(0);
+  EXPECT_TRUE(str_util::StrContains(
+      report, "top 1 cpu operation type: MatMul, cpu: 100us, 1.50 IPC, "
+              "0.33 LLC MPKI"));
+  EXPECT_TRUE(str_util::StrContains(report, "likely compute-bound"));
+  EXPECT_TRUE(str_util::StrContains(
+      report, "top 2 cpu operation type: Gather, cpu: 50us, 1.00 IPC, "
+              "20.00 LLC MPKI, ~2.56GB/s DRAM: likely memory-bound"));
+}
+
+TEST_F(TFProfAdvisorTest, MemoryChecker) {
+  const string device = "/job:localhost/replica:0/task:0/device:GPU:0";
+  TFStats stats(std::unique_ptr<GraphDef>(new GraphDef()), nullptr, nullptr,
+                nullptr);
+  // n5 outputs a tensor that lives until the end of n6, which allocates a
+  // temporary buffer and an output that is not deallocated in the step.
+  NodeDef* def = new NodeDef();
+  node_defs_.emplace_back(def);
+  def->set_name("n5");
+  def->set_op("MatMul");
+  std::unique_ptr<TFGraphNode> node(new TFGraphNode(def, -1, nullptr));
+  NodeExecStats node_stat;
+  node_stat.set_all_start_micros(10);
+  node_stat.set_op_end_rel_micros(10);
+  AllocatorMemoryUsed* memory = node_stat.add_memory();
+  memory->set_allocator_name("GPU_0_bfc");
+  AddAllocation(memory, 1, 4000, 12, 40);
+  NodeOutput* output = node_stat.add_output();
+  output->set_slot(0);
+  AllocationDescription* alloc_desc =
+      output->mutable_tensor_description()->mutable_allocation_description();
+  alloc_desc->set_allocator_name("GPU_0_bfc");
+  alloc_desc->set_allocation_id(1);
+  alloc_desc->set_requested_bytes(4000);
+  node->AddStepStat(0, device, node_stat);
+  stats.AddNodeForTest(0, std::move(node));
+
+  def = new NodeDef();
+  node_defs_.emplace_back(def);
+  def->set_name("n6");
+  def->set_op("Conv2D");
+  node.reset(new TFGraphNode(def, -1, nullptr));
+  node_stat.Clear();
+  node_stat.set_all_start_micros(30);
+  node_stat.set_op_end_rel_micros(10);
+  memory = node_stat.add_memory();
+  memory->set_allocator_name("GPU_0_bfc");
+  AddAllocation(memory, 2, 3000, 31, 35);
+  AddAllocation(memory, 3, 2000, 32, 0);
+  node->AddStepStat(0, device, node_stat);
+  stats.AddNodeForTest(0, std::move(node));
+  stats.BuildAllViews();
+
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[5]];
+  AdviceProto advice = Advisor(&stats).Advise(options);
+  ASSERT_EQ(advice.checkers().at(kCheckers[5]).reports_size(), 1);
+  const string& report = advice.checkers().at(kCheckers[5]).reports(0);
+  EXPECT_TRUE(str_util::StrContains(
+      report, strings::StrCat("device: ", str_util::Lowercase(device),
+                              ", allocator: GPU_0_bfc, peak: 9.00KB in 3 "
+                              "tensors at 32us (step 0)")));
+  EXPECT_TRUE(str_util::StrContains(
+      report, "top 1 operation type: Conv2D, 5.00KB (55.56%)"));
+  EXPECT_TRUE(str_util::StrContains(
+      report, "4.00KB n5:0 (MatMul), allocated at 12us, live 28us"));
+  EXPECT_TRUE(str_util::StrContains(
+      report, "3.00KB temporary of n6 (Conv2D), allocated at 31us, live 4us"));
+  EXPECT_TRUE(str_util::StrContains(
+      report, "2.00KB temporary of n6 (Conv2D), allocated at 32us, "
+              "not deallocated in step"));
+}
+
+TEST_F(TFProfAdvisorTest, InputPipelineChecker) {
+  const string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+  TFStats stats(std::unique_ptr<GraphDef>(new GraphDef()), nullptr, nullptr,
+                nullptr);
+  // The step waits 60us of 100us for the next element.
+  NodeDef* def = new NodeDef();
+  node_defs_.emplace_back(def);
+  def->set_name("get_next");
+  def->set_op("IteratorGetNext");
+  std::unique_ptr<TFGraphNode> node(new TFGraphNode(def, -1, nullptr));
+  NodeExecStats node_stat;
+  node_stat.set_all_start_micros(10);
+  node_stat.set_op_end_rel_micros(60);
+  node->AddStepStat(0, device, node_stat);
+  stats.AddNodeForTest(0, std::move(node));
+
+  def = new NodeDef();
+  node_defs_.emplace_back(def);
+  def->set_name("train");
+  def->set_op("MatMul");
+  node.reset(new TFGraphNode(def, -1, nullptr));
+  node_stat.set_all_start_micros(70);
+  node_stat.set_op_end_rel_micros(40);
+  node->AddStepStat(0, device, node_stat);
+  stats.AddNodeForTest(0, std::move(node));
+
+  // The prefetch buffer is mostly empty, because of the sequential map.
+  DatasetIteratorStats iterator_stats;
+  iterator_stats.set_num_calls(10);
+  iterator_stats.set_num_elements(10);
+  iterator_stats.set_processing_micros(700);
+  iterator_stats.set_buffer_capacity(2);
+  iterator_stats.set_mean_buffer_size(0.1);
+  iterator_stats.set_num_waits(5);
+  iterator_stats.set_wait_micros(650);
+  stats.AddNodeForTest(
+      0, CreateIteratorNode("Iterator::Prefetch", 0, iterator_stats));
+  iterator_stats.Clear();
+  iterator_stats.set_num_calls(10);
+  iterator_stats.set_num_elements(10);
+  iterator_stats.set_processing_micros(1000);
+  stats.AddNodeForTest(
+      0, CreateIteratorNode("Iterator::Prefetch::Map", 0, iterator_stats));
+  iterator_stats.set_processing_micros(200);
+  stats.AddNodeForTest(0, CreateIteratorNode(
+                             "Iterator::Prefetch::Map::TFRecord", 0,
+                             iterator_stats));
+  stats.BuildAllViews();
+
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[6]];
+  AdviceProto advice = Advisor(&stats).Advise(options);
+  const AdviceProto::Checker& checker = advice.checkers().at(kCheckers[6]);
+  ASSERT_EQ(checker.reports_size(), 4);
+  EXPECT_TRUE(str_util::StrContains(
+      checker.reports(0), "1 of 1 steps spend over 10% of their time"));
+  EXPECT_TRUE(str_util::StrContains(checker.reports(0),
+                                    "step 0: 0.06ms of 0.10ms (60.00%)"));
+  EXPECT_TRUE(str_util::StrContains(
+      checker.reports(1),
+      "Iterator::Prefetch::Map: 100.00us per element, 80.00% of pipeline "
+      "time"));
+  EXPECT_TRUE(str_util::StrContains(
+      checker.reports(1),
+      "Iterator::Prefetch::Map::TFRecord: 20.00us per element, 16.00% of "
+      "pipeline time"));
+  EXPECT_TRUE(str_util::StrContains(
+      checker.reports(2),
+      "Iterator::Prefetch::Map is the input pipeline bottleneck. Set "
+      "num_parallel_calls"));
+  EXPECT_TRUE(str_util::StrContains(
+      checker.reports(3),
+      "Iterator::Prefetch buffer is 5.00% full on average and waited 5 "
+      "times"));
+}
+
 }  // namespace tfprof
 }  // namespace tensorflow
@@ -74,8 +74,20 @@ void ExecStep::AddTimeStats(const string& dev, const NodeExecStats& step_stat) {
       // In while-loop, a graph node is executed multiple times under
       // the same name.
       exec_.set_run_count(exec_.run_count() + 1);
+      if (step_stat.has_hardware_counters()) {
+        AddHardwareCounters(step_stat.hardware_counters(),
+                            exec_.mutable_hardware_counters());
+      }
     }
   }
+  // Iterator statistics are totals since the iterator was created, so only
+  // the latest ones are kept.
+  if (step_stat.has_dataset_iterator_stats() &&
+      step_stat.dataset_iterator_stats().num_calls() >=
+          exec_.dataset_iterator_stats().num_calls()) {
+    *exec_.mutable_dataset_iterator_stats() =
+        step_stat.dataset_iterator_stats();
+  }
 }
 
 void ExecStep::AddMemoryStats(const string& dev,
@@ -110,6 +122,43 @@ void ExecStep::AddMemoryStats(const string& dev,
             accelerator_allocator_cnt);
   }
 
+  // Pairs the allocations with their deallocations and with the outputs they
+  // are returned in, by allocation id.
+  std::map<std::pair<string, int64>, int32> output_slots;
+  for (const auto& output : step_stat.output()) {
+    const AllocationDescription& alloc_desc =
+        output.tensor_description().allocation_description();
+    if (alloc_desc.allocation_id() != 0) {
+      output_slots[std::make_pair(alloc_desc.allocator_name(),
+                                  alloc_desc.allocation_id())] = output.slot();
+    }
+  }
+  for (const auto& mem : step_stat.memory()) {
+    std::map<int64, size_t> live_tensors;
+    for (const auto& alloc : mem.allocation_records()) {
+      if (alloc.alloc_bytes() > 0) {
+        TensorLifetime lifetime;
+        lifetime.set_allocator(mem.allocator_name());
+        lifetime.set_bytes(alloc.alloc_bytes());
+        lifetime.set_alloc_micros(alloc.alloc_micros());
+        auto slot = output_slots.find(
+            std::make_pair(mem.allocator_name(), alloc.allocation_id()));
+        lifetime.set_slot(slot != output_slots.end() ? slot->second : -1);
+        if (alloc.allocation_id() != 0) {
+          live_tensors[alloc.allocation_id()] = tensor_lifetimes_.size();
+        }
+        tensor_lifetimes_.push_back(lifetime);
+      } else {
+        auto live = live_tensors.find(alloc.allocation_id());
+        if (live != live_tensors.end()) {
+          tensor_lifetimes_[live->second].set_dealloc_micros(
+              alloc.alloc_micros());
+          live_tensors.erase(live);
+        }
+      }
+    }
+  }
+
   int64 total_output_bytes = 0;
   for (const auto& output : step_stat.output()) {
     if (output.has_tensor_description() &&
@@ -287,6 +336,13 @@ TensorShapeProto VecToShapeProto(const std::vector<int64>& shape_vec) {
   return shape_pb;
 }
 
+void AddHardwareCounters(const HardwareCounters& from, HardwareCounters* to) {
+  to->set_cycles(to->cycles() + from.cycles());
+  to->set_instructions(to->instructions() + from.instructions());
+  to->set_llc_misses(to->llc_misses() + from.llc_misses());
+  to->set_dram_bytes(to->dram_bytes() + from.dram_bytes());
+}
+
 bool IsPlacedOnAccelerator(const string& device) {
   return device.find("gpu") != device.npos ||
          device.find("sycl") != device.npos;
@@ -40,6 +40,9 @@ std::vector<int64> ShapeProtoToVec(const TensorShapeProto& shape_pb);
 
 TensorShapeProto VecToShapeProto(const std::vector<int64>& shape_vec);
 
+// Adds the counters of `from` to `to`.
+void AddHardwareCounters(const HardwareCounters& from, HardwareCounters* to);
+
 class TFGraphNode;
 
 class CallStack {
@@ -111,6 +114,15 @@ class ExecStep {
   }
   int64 all_start_micros() const { return exec_.all_start_micros(); }
   int64 latest_end_micros() const { return exec_.latest_end_micros(); }
+  const HardwareCounters& hardware_counters() const {
+    return exec_.hardware_counters();
+  }
+  bool has_dataset_iterator_stats() const {
+    return exec_.has_dataset_iterator_stats();
+  }
+  const DatasetIteratorStats& dataset_iterator_stats() const {
+    return exec_.dataset_iterator_stats();
+  }
   int64 lastest_schedule_end_micros() const {
     int64 ret = 0;
     for (const auto& exec : cpu_execs_) {
@@ -188,6 +200,10 @@ class ExecStep {
     return allocations_;
   }
 
+  const std::vector<TensorLifetime>& tensor_lifetimes() const {
+    return tensor_lifetimes_;
+  }
+
   const ExecProfile& ToProto() {
     exec_.mutable_accelerator_execs()->clear();
     for (const auto& e : accelerator_execs_) {
@@ -223,6 +239,11 @@ class ExecStep {
     for (const auto& m : memory_execs_) {
       exec_.add_memory_execs()->MergeFrom(m);
     }
+
+    exec_.mutable_tensor_lifetimes()->Clear();
+    for (const auto& t : tensor_lifetimes_) {
+      exec_.add_tensor_lifetimes()->MergeFrom(t);
+    }
     return exec_;
   }
 
@@ -239,6 +260,7 @@ class ExecStep {
 
     allocations_.clear();
     memory_execs_.clear();
+    tensor_lifetimes_.clear();
 
     for (const auto& exec_time : exec_.accelerator_execs()) {
       auto& exec = accelerator_execs_[exec_time.first];
@@ -262,6 +284,9 @@ class ExecStep {
     for (const auto& m : exec_.memory_execs()) {
       memory_execs_.push_back(m);
     }
+    for (const auto& t : exec_.tensor_lifetimes()) {
+      tensor_lifetimes_.push_back(t);
+    }
   }
 
  private:
@@ -285,6 +310,9 @@ class ExecStep {
 
   // The history of accelerator allocations and deallocations of this step.
   std::vector<AllocationRecord> allocations_;
+  // The buffers allocated on all allocators in this step, with the output
+  // slots they are returned in.
+  std::vector<TensorLifetime> tensor_lifetimes_;
 };
 
 #define GRAPH_NODE_BYTES(type)             \
@@ -546,6 +574,32 @@ class TFGraphNode {
     return total_micros / execs_.size();
   }
 
+  // The hardware counters of a step, or their average over all steps, when
+  // step < 0.
+  HardwareCounters hardware_counters(int64 step) const {
+    HardwareCounters counters;
+    if (execs_.empty()) {
+      return counters;
+    }
+    if (step >= 0) {
+      auto exec = execs_.find(step);
+      if (exec != execs_.end()) {
+        counters = exec->second.hardware_counters();
+      }
+      return counters;
+    }
+
+    for (const auto& exec : execs_) {
+      AddHardwareCounters(exec.second.hardware_counters(), &counters);
+    }
+    const int64 num_steps = execs_.size();
+    counters.set_cycles(counters.cycles() / num_steps);
+    counters.set_instructions(counters.instructions() / num_steps);
+    counters.set_llc_misses(counters.llc_misses() / num_steps);
+    counters.set_dram_bytes(counters.dram_bytes() / num_steps);
+    return counters;
+  }
+
   // This is cpu computation time of a step, or average of
   // multiple step, when step < 0.
   int64 cpu_exec_micros(int64 step) const {
@@ -654,6 +708,24 @@ class TFGraphNode {
     return exec->second.allocations();
   }
 
+  const std::vector<TensorLifetime>& tensor_lifetimes(int64 step) const {
+    auto exec = execs_.find(step);
+    if (exec == execs_.end()) {
+      return empty_tensor_lifetimes_;
+    }
+    return exec->second.tensor_lifetimes();
+  }
+
+  // The statistics of the input pipeline iterator this node stands for in a
+  // step, or null.
+  const DatasetIteratorStats* dataset_iterator_stats(int64 step) const {
+    auto exec = execs_.find(step);
+    if (exec == execs_.end() || !exec->second.has_dataset_iterator_stats()) {
+      return nullptr;
+    }
+    return &exec->second.dataset_iterator_stats();
+  }
+
   int64 parameters() const {
     if (!shape().empty()) {
       int64 params = 1;
@@ -754,6 +826,7 @@ class TFGraphNode {
   std::map<int64, int64> empty_bytes_in_use_;
   std::map<string, std::vector<std::pair<int64, int64>>> empty_execs_;
   std::vector<AllocationRecord> empty_allocations_;
+  std::vector<TensorLifetime> empty_tensor_lifetimes_;
 };
 
 class TFMultiGraphNode {
@@ -785,6 +858,7 @@ class TFMultiGraphNode {
 
     float_ops_ = 0;
     parameters_ = 0;
+    hardware_counters_.Clear();
     op_types_.clear();
     shapes_.clear();
     devices_.clear();
@@ -804,6 +878,7 @@ class TFMultiGraphNode {
       exec_micros_ += node->exec_micros(step);
       accelerator_exec_micros_ += node->accelerator_exec_micros(step);
       cpu_exec_micros_ += node->cpu_exec_micros(step);
+      AddHardwareCounters(node->hardware_counters(step), &hardware_counters_);
 
       requested_bytes_ += node->requested_bytes(step);
       peak_bytes_ += node->peak_bytes(step);
@@ -840,6 +915,9 @@ class TFMultiGraphNode {
   int64 exec_micros() const { return exec_micros_; }
   int64 accelerator_exec_micros() const { return accelerator_exec_micros_; }
   int64 cpu_exec_micros() const { return cpu_exec_micros_; }
+  const HardwareCounters& hardware_counters() const {
+    return hardware_counters_;
+  }
 
   int64 requested_bytes() const { return requested_bytes_; }
   int64 peak_bytes() const { return peak_bytes_; }
@@ -898,6 +976,7 @@ class TFMultiGraphNode {
   int64 output_bytes_;
   int64 float_ops_;
   int64 parameters_;
+  HardwareCounters hardware_counters_;
   std::set<string> devices_;
   std::vector<std::vector<int64>> shapes_;
   std::map<string, const TFGraphNode*> snapshot_nodes_;
@@ -154,6 +154,11 @@ bool ShowMultiNode::ReInit(int64 step,
   mutable_proto()->set_exec_micros(node->exec_micros());
   mutable_proto()->set_accelerator_exec_micros(node->accelerator_exec_micros());
   mutable_proto()->set_cpu_exec_micros(node->cpu_exec_micros());
+  if (node->hardware_counters().cycles() > 0) {
+    *mutable_proto()->mutable_hardware_counters() = node->hardware_counters();
+  } else {
+    mutable_proto()->clear_hardware_counters();
+  }
 
   mutable_proto()->set_requested_bytes(node->requested_bytes());
   mutable_proto()->set_peak_bytes(node->peak_bytes());
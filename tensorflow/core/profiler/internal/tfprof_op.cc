@@ -79,6 +79,29 @@ string FormatAcceleratorExecTime(const ShowMultiNode* node,
                   accu_pct, pct)
                   .c_str());
 }
+
+// Formats the instructions per cycle, the LLC misses per kilo instructions
+// and the DRAM bandwidth estimated from the LLC misses.
+string FormatHardwareCounters(const ShowMultiNode* node) {
+  const HardwareCounters& counters = node->proto().hardware_counters();
+  if (counters.cycles() <= 0 || counters.instructions() <= 0) {
+    return strings::Printf("%30s", "--");
+  }
+  const double ipc =
+      static_cast<double>(counters.instructions()) / counters.cycles();
+  const double mpki = 1000.0 * counters.llc_misses() / counters.instructions();
+  const int64 cpu_micros = node->proto().cpu_exec_micros();
+  string bandwidth = "--";
+  if (cpu_micros > 0) {
+    // Bytes per microsecond are MB/s.
+    bandwidth = strings::Printf(
+        "%.2fGB/s", counters.dram_bytes() / (1000.0 * cpu_micros));
+  }
+  return strings::Printf(
+      "%30s", strings::Printf("%.2f IPC, %.2f MPKI, %s", ipc, mpki,
+                              bandwidth.c_str())
+                  .c_str());
+}
 }  // namespace
 
 void TFOp::AddNode(TFGraphNode* node) {
@@ -261,6 +284,9 @@ string TFOp::FormatNode(OpNode* node, OpNode* root, const Options& opts) const {
       opts.select.find(kShown[1]) == opts.select.end()) {
     attrs.push_back(FormatCPUExecTime(node, root));
   }
+  if (opts.select.find(kShown[14]) != opts.select.end()) {
+    attrs.push_back(FormatHardwareCounters(node));
+  }
   if (opts.select.find(kShown[2]) != opts.select.end()) {
     double accu_pct = 0.0;
     double pct = 0.0;
@@ -337,6 +337,10 @@ static const char* const kResidualBytes =
 static const char* const kOutputBytes =
     "output bytes: The memory that is output from the operation (not "
     "necessarilty allocated by the operation)";
+static const char* const kHardwareCounters =
+    "hw counters: Instructions per cycle, last-level cache misses per 1000 "
+    "instructions and the DRAM bandwidth estimated from the cache misses of "
+    "the CPU executions (op view only).";
 static const char* const kOccurrence =
     "occurrence: The number of times it occurs";
 static const char* const kInputShapes =
@@ -418,6 +422,8 @@ string QueryDoc(const string& cmd, const Options& opts) {
       helps.push_back(kResidualBytes);
     } else if (s == kShown[13]) {
       helps.push_back(kOutputBytes);
+    } else if (s == kShown[14]) {
+      helps.push_back(kHardwareCounters);
     } else {
       helps.push_back("Unknown select: " + s);
     }
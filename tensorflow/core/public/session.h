@@ -214,6 +214,10 @@ class Session {
   /// The order of tensors in `feed_tensors` must and `fetch_tensors` will
   /// match the order of names in `CallableOptions::feed()` and
   /// `CallableOptions::fetch()` when this subgraph was created.
+  ///
+  /// Fed and fetched tensors are in host memory, except the ones named in
+  /// `CallableOptions::feed_devices()` and `CallableOptions::fetch_devices()`,
+  /// which are passed in and returned in the memory of the given device.
   /// NOTE: This API is still experimental and may change.
   virtual Status RunCallable(CallableHandle handle,
                              const std::vector<Tensor>& feed_tensors,
@@ -187,6 +187,38 @@ Status MaybeMoveSliceToElement(Tensor* parent, Tensor* element, int64 index) {
   }
 }
 
+Status CopySliceToSlice(const Tensor& src, int64 src_index, Tensor* dst,
+                        int64 dst_index) {
+  DCHECK_NE(src.dim_size(0), 0);
+  DCHECK_NE(dst->dim_size(0), 0);
+  if (src.dtype() != dst->dtype() ||
+      src.NumElements() / src.dim_size(0) !=
+          dst->NumElements() / dst->dim_size(0)) {
+    return errors::Internal(
+        "CopySliceToSlice Cannot perform copy: slices do not match. Tensors "
+        "are: [src]: ",
+        src.DebugString(), ", [dst]: ", dst->DebugString());
+  }
+
+#define HANDLE_TYPE(T)                                     \
+  case DataTypeToEnum<T>::value: {                         \
+    dst->flat_outer_dims<T>().chip(dst_index, 0) =         \
+        src.flat_outer_dims<T>().chip(src_index, 0);       \
+    return Status::OK();                                   \
+  }
+
+  switch (src.dtype()) {
+    TF_CALL_ALL_TYPES(HANDLE_TYPE);
+    TF_CALL_QUANTIZED_TYPES(HANDLE_TYPE);
+    TF_CALL_uint32(HANDLE_TYPE);
+    TF_CALL_uint64(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      return errors::Unimplemented("CopySliceToSlice Unhandled data type: ",
+                                   src.dtype());
+  }
+}
+
 // The following five functions are copied from padding_fifo_queue.cc.
 // TODO(mrry): Reconcile these functions with the similar methods in the
 // queue implementation.
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <list>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -1827,33 +1829,57 @@ class MklPrimitive {
 
 const mkldnn::memory::dims NONE_DIMS = {};
 
+// Pool of the primitives created by MKL ops, keyed by their parameters and
+// shapes. Each thread has its own pool, so that a primitive is never executed
+// by two threads at once, holding at most kCapacity primitives: once full, the
+// least recently used primitive is deleted to make room for a new one.
 template <typename T>
 class MklPrimitiveFactory {
  public:
   MklPrimitiveFactory() {}
   ~MklPrimitiveFactory() {}
 
+  // Returns the primitive for 'key', or nullptr. The primitive remains owned by
+  // the pool, and is valid until the next call to SetOp() on this thread.
   MklPrimitive* GetOp(const std::string& key) {
-    auto stream_iter = MklPrimitiveFactory<T>::GetHashMap().find(key);
-    if (stream_iter == MklPrimitiveFactory<T>::GetHashMap().end()) {
+    LruCache& cache = GetCache();
+    auto it = cache.map.find(key);
+    if (it == cache.map.end()) {
       return nullptr;
-    } else {
-      return stream_iter->second;
     }
+    // Move the entry to the front of the usage list.
+    cache.lru.splice(cache.lru.begin(), cache.lru, it->second);
+    return it->second->second.get();
   }
 
+  // Takes ownership of 'op' and adds it to the pool under 'key'.
   void SetOp(const std::string& key, MklPrimitive* op) {
-    auto stream_iter = MklPrimitiveFactory<T>::GetHashMap().find(key);
-
-    CHECK(stream_iter == MklPrimitiveFactory<T>::GetHashMap().end());
-
-    MklPrimitiveFactory<T>::GetHashMap()[key] = op;
+    LruCache& cache = GetCache();
+    CHECK(cache.map.find(key) == cache.map.end());
+    if (cache.map.size() >= kCapacity) {
+      cache.map.erase(cache.lru.back().first);
+      cache.lru.pop_back();
+    }
+    cache.lru.emplace_front(key, std::unique_ptr<MklPrimitive>(op));
+    cache.map[key] = cache.lru.begin();
   }
 
  private:
-  static inline std::unordered_map<std::string, MklPrimitive*> &GetHashMap() {
-    static thread_local std::unordered_map<std::string, MklPrimitive*> map_;
-    return map_;
+  static const size_t kCapacity = 1024;
+
+  struct LruCache {
+    // Entries from most to least recently used.
+    std::list<std::pair<std::string, std::unique_ptr<MklPrimitive>>> lru;
+    std::unordered_map<
+        std::string,
+        typename std::list<std::pair<std::string,
+                                     std::unique_ptr<MklPrimitive>>>::iterator>
+        map;
+  };
+
+  static inline LruCache& GetCache() {
+    static thread_local LruCache cache_;
+    return cache_;
   }
 };
 
@@ -133,7 +133,8 @@ void StatSummarizer::ProcessStepStats(const StepStats& step_stats) {
 
   int64 first_node_start_us =
       step_stats.dev_stats(0).node_stats(0).all_start_micros();
-  std::map<std::string, Detail> details;
+  // Accumulate the stats of this step with the ones of the previous steps.
+  std::map<std::string, Detail> details = stats_calculator_->GetDetails();
 
   int node_num = 0;
   for (const auto& ds : step_stats.dev_stats()) {
@@ -214,12 +215,12 @@ void StatSummarizer::ProcessStepStats(const StepStats& step_stats) {
       mem_total += curr_node_mem;
 
       ++detail->times_called;
-      stats_calculator_->UpdateDetails(details);
 
       Validate(outputs, ns);
     }
   }
 
+  stats_calculator_->UpdateDetails(details);
   stats_calculator_->UpdateRunTotalUs(curr_total_us);
   stats_calculator_->UpdateMemoryUsed(mem_total);
 }
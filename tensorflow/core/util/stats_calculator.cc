@@ -274,7 +274,9 @@ std::string StatsCalculator::GetOutputString() const {
 
 void StatsCalculator::UpdateDetails(
     const std::map<std::string, Detail>& details) {
-  details_.insert(details.begin(), details.end());
+  for (const auto& detail : details) {
+    details_[detail.first] = detail.second;
+  }
 }
 
 }  // namespace tensorflow
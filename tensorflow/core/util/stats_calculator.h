@@ -163,6 +163,8 @@ class StatsCalculator {
   };
 
   const std::map<std::string, Detail>& GetDetails() const { return details_; }
+  // Replaces the details of the nodes in 'details'. To accumulate the stats
+  // of several runs, start from a copy of GetDetails().
   void UpdateDetails(const std::map<std::string, Detail>& details);
 
  private:
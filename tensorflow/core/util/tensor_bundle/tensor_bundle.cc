@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -59,6 +60,20 @@ static const int kBufferSize = 1024 * 1024;
 // bundle.
 const char* const kHeaderEntryKey = "";
 
+// A read-only memory mapping of a data file, shared by the BundleReader that
+// mapped it and by the tensors that point into it.
+class MappedDataFile : public core::RefCounted {
+ public:
+  explicit MappedDataFile(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const char* data() const { return static_cast<const char*>(region_->data()); }
+  uint64 length() const { return region_->length(); }
+
+ private:
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+};
+
 namespace {
 
 // Reads "num_elements" string elements from file[offset, offset+size) into the
@@ -365,6 +380,36 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// Serves the one allocation of a tensor whose bytes live in a mapped data
+// file, at "data".  Holds a reference on the mapping until the tensor
+// deallocates its buffer, then deletes itself.
+class MappedTensorAllocator : public Allocator {
+ public:
+  MappedTensorAllocator(MappedDataFile* mapped_file, const void* data)
+      : mapped_file_(mapped_file), data_(data) {
+    mapped_file_->Ref();
+  }
+
+  string Name() override { return "MappedTensorAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return const_cast<void*>(data_);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    DCHECK_EQ(ptr, data_);
+    delete this;
+  }
+
+ private:
+  ~MappedTensorAllocator() override { mapped_file_->Unref(); }
+
+  MappedDataFile* const mapped_file_;
+  const void* const data_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorAllocator);
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -751,6 +796,9 @@ BundleReader::~BundleReader() {
     }
   }
   gtl::STLDeleteValues(&data_);
+  for (auto pair : mapped_data_) {
+    if (pair.second != nullptr) pair.second->Unref();
+  }
   gtl::STLDeleteValues(&tensor_slices_);
 }
 
@@ -872,6 +920,68 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::GetMappedDataFile(int32 shard_id,
+                                       MappedDataFile** mapped_file) {
+  auto it = mapped_data_.find(shard_id);
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, shard_id, num_shards_), &region);
+    MappedDataFile* mapped = nullptr;
+    if (s.ok()) {
+      mapped = new MappedDataFile(std::move(region));
+    } else if (!errors::IsUnimplemented(s)) {
+      return s;
+    }
+    it = mapped_data_.insert({shard_id, mapped}).first;
+  }
+  *mapped_file = it->second;
+  return Status::OK();
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape stored_shape(entry.shape());
+
+  MappedDataFile* mapped_file = nullptr;
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      entry.size() > 0 &&
+      entry.offset() % Allocator::kAllocatorAlignment == 0) {
+    TF_RETURN_IF_ERROR(GetMappedDataFile(entry.shard_id(), &mapped_file));
+  }
+  if (mapped_file == nullptr) {
+    *val = Tensor(entry.dtype(), stored_shape);
+    return Lookup(key, val);
+  }
+
+  const int64 expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            expected_size);
+  }
+  if (entry.offset() + entry.size() > mapped_file->length()) {
+    return errors::DataLoss("Bundle entry of key ", key,
+                            " lies past the end of its data file");
+  }
+  const char* data = mapped_file->data() + entry.offset();
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+  // The tensor's buffer releases the allocator, and with it its reference on
+  // the mapping, when it is destroyed.
+  *val = Tensor(new MappedTensorAllocator(mapped_file, data), entry.dtype(),
+                stored_shape);
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -84,6 +84,7 @@ limitations under the License.
 namespace tensorflow {
 
 class FileOutputBuffer;
+class MappedDataFile;
 
 // Versioning of the tensor bundle format.
 // Follows the same rules as 3p/tf/core/public/version.h.
@@ -218,6 +219,22 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but on success "val" is replaced by a read-only tensor
+  // backed by a memory mapping of the data file rather than by a copy of the
+  // stored bytes, so that no extra memory is allocated for it.  The returned
+  // tensor stays valid after this reader is destroyed, and must not be
+  // written to.
+  //
+  // Only whole tensors of dtypes that can be memcpy'd, and whose data starts
+  // at a multiple of Allocator::kAllocatorAlignment, are mapped; the bundle
+  // should have been written with BundleWriter::Options::data_alignment set to
+  // that value.  Other tensors, and file systems that do not support memory
+  // mapping, fall back to Lookup() into a newly allocated "val".
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -274,6 +291,11 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Maps (once) the data file of "shard_id" into "*mapped_file".  Returns
+  // OK with a nullptr if the file system does not support memory mapping.
+  Status GetMappedDataFile(int32 shard_id,
+                           MappedDataFile** mapped_file) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -292,6 +314,10 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Memory mappings of the data files used by LookupMapped(), keyed by shard
+  // id.  Holds a reference on each; the tensors returned hold their own.
+  std::unordered_map<int32, MappedDataFile*> mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -772,6 +772,38 @@ TEST(TensorBundleTest, VersionTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  for (int alignment : {1, static_cast<int>(Allocator::kAllocatorAlignment)}) {
+    const string prefix = Prefix(strings::StrCat("mapped_", alignment));
+    {
+      BundleWriter::Options opts;
+      opts.data_alignment = alignment;
+      BundleWriter writer(Env::Default(), prefix, opts);
+      TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+      TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<string>("string")));
+      TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<int64>(2)));
+      TF_EXPECT_OK(writer.Add("foo_003", Constant<double>(3, {100, 100})));
+      TF_ASSERT_OK(writer.Finish());
+    }
+    Tensor val0, val1, val2, val3;
+    {
+      BundleReader reader(Env::Default(), prefix);
+      TF_ASSERT_OK(reader.status());
+      TF_ASSERT_OK(reader.LookupMapped("foo_000", &val0));
+      TF_ASSERT_OK(reader.LookupMapped("foo_001", &val1));
+      TF_ASSERT_OK(reader.LookupMapped("foo_002", &val2));
+      TF_ASSERT_OK(reader.LookupMapped("foo_003", &val3));
+      EXPECT_EQ(error::NOT_FOUND,
+                reader.LookupMapped("foo_004", &val0).code());
+    }
+    // The tensors outlive the reader.
+    test::ExpectTensorEqual<float>(val0, Constant_2x3<float>(0));
+    test::ExpectTensorEqual<string>(val1, Constant_2x3<string>("string"));
+    test::ExpectTensorEqual<int64>(val2, Constant_2x3<int64>(2));
+    test::ExpectTensorEqual<double>(val3, Constant<double>(3, {100, 100}));
+  }
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
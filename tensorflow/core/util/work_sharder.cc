@@ -16,10 +16,22 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 
+namespace {
+
+const int64 kMinCostPerShard = 10000;
+
+// Number of blocks AdaptiveShard splits the work of each thread into, for
+// the others to take over when it falls behind.
+const int64 kBlocksPerShard = 4;
+
+}  // namespace
+
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work) {
   CHECK_GE(total, 0);
@@ -42,7 +54,6 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
   // If total * cost_per_unit is small, it is not worth shard too
   // much. Let us assume each cost unit is 1ns, kMinCostPerShard=10000
   // is 10us.
-  static const int64 kMinCostPerShard = 10000;
   const int num_shards =
       std::max<int>(1, std::min(static_cast<int64>(max_parallelism),
                                 total * cost_per_unit / kMinCostPerShard));
@@ -74,4 +85,83 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
   counter.Wait();
 }
 
+ShardCostModel::ShardCostModel() {
+  for (auto& cost : cost_per_unit_) {
+    cost.store(0, std::memory_order_relaxed);
+  }
+}
+
+int ShardCostModel::SizeClass(int64 total) {
+  return total <= 1 ? 0 : Log2Floor64(static_cast<uint64>(total));
+}
+
+int64 ShardCostModel::CostPerUnit(int64 total,
+                                  int64 default_cost_per_unit) const {
+  const int64 cost =
+      cost_per_unit_[SizeClass(total)].load(std::memory_order_relaxed);
+  return cost > 0 ? cost : default_cost_per_unit;
+}
+
+void ShardCostModel::Record(int64 total, int64 nanos) {
+  if (total <= 0) {
+    return;
+  }
+  const int64 measured = std::max(int64{1}, nanos / total);
+  std::atomic<int64>& cost = cost_per_unit_[SizeClass(total)];
+  const int64 previous = cost.load(std::memory_order_relaxed);
+  // Concurrent updates may lose one another, which only delays convergence.
+  cost.store(previous > 0 ? (3 * previous + measured) / 4 : measured,
+             std::memory_order_relaxed);
+}
+
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, int64 cost_per_unit,
+                   ShardCostModel* cost_model,
+                   std::function<void(int64, int64)> work) {
+  CHECK_GE(total, 0);
+  if (total == 0) {
+    return;
+  }
+  Env* env = Env::Default();
+  cost_per_unit =
+      std::max(int64{1}, cost_model->CostPerUnit(total, cost_per_unit));
+  const int num_shards =
+      std::max<int>(1, std::min(static_cast<int64>(max_parallelism),
+                                total * cost_per_unit / kMinCostPerShard));
+  if (num_shards == 1) {
+    const uint64 start_micros = env->NowMicros();
+    work(0, total);
+    cost_model->Record(total, (env->NowMicros() - start_micros) * 1000);
+    return;
+  }
+
+  const int64 num_blocks = std::min(total, num_shards * kBlocksPerShard);
+  const int64 block_size = (total + num_blocks - 1) / num_blocks;
+  std::atomic<int64> next_block(0);
+  std::atomic<int64> busy_micros(0);
+  auto run_blocks = [&work, &next_block, &busy_micros, env, block_size,
+                     total]() {
+    const uint64 start_micros = env->NowMicros();
+    for (;;) {
+      const int64 start = next_block.fetch_add(1) * block_size;
+      if (start >= total) {
+        break;
+      }
+      work(start, std::min(start + block_size, total));
+    }
+    busy_micros += env->NowMicros() - start_micros;
+  };
+
+  BlockingCounter counter(num_shards - 1);
+  for (int i = 1; i < num_shards; ++i) {
+    workers->Schedule([&run_blocks, &counter]() {
+      run_blocks();
+      counter.DecrementCount();
+    });
+  }
+  run_blocks();
+  counter.Wait();
+  cost_model->Record(total, busy_micros.load() * 1000);
+}
+
 }  // end namespace tensorflow
@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_UTIL_WORK_SHARDER_H_
 
+#include <atomic>
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -48,6 +50,52 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work);
 
+// Keeps the cost per unit measured by AdaptiveShard, separately for each
+// class of "total" (powers of two), so that later calls can be sharded
+// according to what the work actually cost rather than a guess. A kernel
+// typically owns one per sharded loop. Thread-safe.
+class ShardCostModel {
+ public:
+  ShardCostModel();
+
+  // Returns the measured cost per unit of work for sharding "total" units, or
+  // "default_cost_per_unit" if no similar call has been measured yet.
+  int64 CostPerUnit(int64 total, int64 default_cost_per_unit) const;
+
+  // Records that "total" units of work took "nanos" nanoseconds of compute,
+  // summed across all the threads that worked on them.
+  void Record(int64 total, int64 nanos);
+
+ private:
+  static int SizeClass(int64 total);
+
+  // Moving average of the measured cost per unit, in nanoseconds, or 0 when
+  // nothing was measured yet.
+  std::atomic<int64> cost_per_unit_[64];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardCostModel);
+};
+
+// Like Shard(), but sharding with the cost per unit measured by "cost_model"
+// on previous calls of similar size, "cost_per_unit" being only used until
+// then. The cost of this call is measured and recorded into "cost_model".
+//
+// [0, total) is split into several blocks per participating thread, which
+// the calling thread and the workers claim one at a time until none are
+// left. Threads that get cheap blocks, or that start late because "workers"
+// is busy, thus take over the remaining blocks of the others, which balances
+// work units of uneven cost (e.g. ragged sparse rows).
+//
+// REQUIRES: max_parallelism >= 0
+// REQUIRES: workers != nullptr
+// REQUIRES: total >= 0
+// REQUIRES: cost_per_unit >= 0
+// REQUIRES: cost_model != nullptr
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, int64 cost_per_unit,
+                   ShardCostModel* cost_model,
+                   std::function<void(int64, int64)> work);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_UTIL_WORK_SHARDER_H_
@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <atomic>
+#include <set>
 #include <vector>
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -76,6 +78,66 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(AdaptiveShard, Basic) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  ShardCostModel cost_model;
+  for (auto workers : {0, 1, 2, 3, 5, 7, 10, 11, 15, 100, 1000}) {
+    for (auto total : {0, 1, 7, 10, 64, 100, 256, 1000, 9999}) {
+      for (auto cost_per_unit : {0, 1, 11, 102, 1003, 10005, 1000007}) {
+        mutex mu;
+        int64 num_done_work = 0;
+        std::vector<bool> work(total, false);
+        AdaptiveShard(workers, &threads, total, cost_per_unit, &cost_model,
+                      [=, &mu, &num_done_work, &work](int64 start,
+                                                      int64 limit) {
+                        EXPECT_GE(start, 0);
+                        EXPECT_LE(limit, total);
+                        mutex_lock l(mu);
+                        for (; start < limit; ++start) {
+                          EXPECT_FALSE(work[start]);  // No duplicate
+                          ++num_done_work;
+                          work[start] = true;
+                        }
+                      });
+        EXPECT_EQ(num_done_work, total);
+      }
+    }
+  }
+}
+
+TEST(AdaptiveShard, LearnsCostPerUnit) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  ShardCostModel cost_model;
+  EXPECT_EQ(cost_model.CostPerUnit(100, 7), 7);
+  // Each unit takes at least 100us, far more than the guess of 1ns.
+  AdaptiveShard(4, &threads, 100, 1, &cost_model, [](int64 start, int64 limit) {
+    Env::Default()->SleepForMicroseconds((limit - start) * 100);
+  });
+  EXPECT_GE(cost_model.CostPerUnit(100, 7), 100000);
+  // Totals of another size class still use their own guess.
+  EXPECT_EQ(cost_model.CostPerUnit(1000, 7), 7);
+}
+
+TEST(AdaptiveShard, BalancesUnevenUnits) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  ShardCostModel cost_model;
+  mutex mu;
+  std::set<int> threads_used;
+  // Only the first quarter of the units is expensive: the threads done with
+  // their cheap blocks must take over some of them, rather than leave them all
+  // to a single thread as an even split would.
+  AdaptiveShard(4, &threads, 64, 1000000, &cost_model,
+                [&mu, &threads, &threads_used](int64 start, int64 limit) {
+                  if (start >= 16) return;
+                  {
+                    mutex_lock l(mu);
+                    threads_used.insert(threads.CurrentThreadId());
+                  }
+                  Env::Default()->SleepForMicroseconds(10000);
+                });
+  EXPECT_GT(threads_used.size(), 1u);
+}
+
 void BM_Sharding(int iters, int arg) {
   thread::ThreadPool threads(Env::Default(), "test", 16);
   const int64 total = 1LL << 30;
@@ -561,6 +561,81 @@ class Timeline(object):
             logging.vlog(1, 'Can\'t find tensor %s - removed by CSE?',
                          input_name)
 
+  def _parse_transfer(self, device_name, node_stats):
+    """Returns the key and the kind of a transfer node, or (None, None).
+
+    Sends, RecvTensor RPCs and Recvs of the same tensor share a key made of the
+    tensor name and the receiving device.
+
+    Args:
+      device_name: The device on which the node ran.
+      node_stats: The 'NodeExecStats' proto of the node.
+    """
+    label = node_stats.timeline_label
+    if node_stats.node_name == 'RecvTensor':
+      # Labels of the form: [bytes] tensor_name from src_device to dst_device.
+      match = re.match(r'\[.*\] (.*) from (.*) to (.*)$', label)
+      if match:
+        tensor_name, _, dst_device = match.groups()
+        return (tensor_name, dst_device), 'RecvTensor'
+      return None, None
+    # Labels of the form: name = _Send(tensor_name @recv_device, and
+    # name = _Recv(tensor_name @send_device.
+    match = re.match(r'.* = _(?:Host)?(Send|Recv)\((.*) @(.*)$', label)
+    if match is None:
+      return None, None
+    kind, tensor_name, peer_device = match.groups()
+    if kind == 'Send':
+      return (tensor_name, peer_device), kind
+    return (tensor_name, device_name), kind
+
+  def _show_transfers(self):
+    """Adds flows from each Send to its RecvTensor RPC, if any, and its Recv.
+
+    The Send, the RPC and the Recv of a tensor usually run on different
+    workers, so their timestamps are only comparable once the master has
+    aligned the clocks of the workers.
+    """
+    transfers = {}  # key -> kind -> [(start, end, pid, tid)]
+    for dev_stats in self._step_stats.dev_stats:
+      device_name = dev_stats.device
+      if self._is_gputrace_device(device_name):
+        continue
+      device_pid = self._device_pids[device_name]
+      for node_stats in dev_stats.node_stats:
+        key, kind = self._parse_transfer(device_name, node_stats)
+        if key is None:
+          continue
+        start_time = node_stats.all_start_micros
+        end_time = start_time + node_stats.all_end_rel_micros
+        transfers.setdefault(key, {}).setdefault(kind, []).append(
+            (start_time, end_time, device_pid, node_stats.thread_id))
+
+    for key in sorted(transfers):
+      by_kind = transfers[key]
+      sends = sorted(by_kind.get('Send', []))
+      rpcs = sorted(by_kind.get('RecvTensor', []))
+      recvs = sorted(by_kind.get('Recv', []))
+      # A tensor sent in a loop has one transfer per iteration; pair them up
+      # in the order in which they started.
+      for i, send in enumerate(sends):
+        if i >= len(recvs):
+          break
+        tensor_name = key[0]
+        flow_id = self._alloc_flow_id()
+        self._chrome_trace.emit_flow_start(tensor_name, send[0], send[2],
+                                           send[3], flow_id)
+        if i < len(rpcs):
+          rpc = rpcs[i]
+          self._chrome_trace.emit_flow_end(tensor_name, rpc[0], rpc[2], rpc[3],
+                                           flow_id)
+          flow_id = self._alloc_flow_id()
+          self._chrome_trace.emit_flow_start(tensor_name, rpc[1] - 1, rpc[2],
+                                             rpc[3], flow_id)
+        recv = recvs[i]
+        self._chrome_trace.emit_flow_end(tensor_name, recv[1] - 1, recv[2],
+                                         recv[3], flow_id)
+
   def _show_memory_counters(self):
     """Produce a counter series for each memory allocator."""
     # Iterate over all tensor trackers to build a list of allocations and
@@ -611,6 +686,8 @@ class Timeline(object):
     self._assign_lanes()
     self._analyze_tensors(show_memory)
     self._show_compute(show_dataflow)
+    if show_dataflow:
+      self._show_transfers()
     if show_memory:
       self._show_memory_counters()
     return StepStatsAnalysis(
@@ -134,6 +134,41 @@ class TimelineTest(test.TestCase):
     ctf = tl.generate_chrome_trace_format()
     self._validateTrace(ctf)
 
+  def testTimelineLinksTransfersAcrossWorkers(self):
+    """Tests that a Send, its RecvTensor RPC and its Recv are linked."""
+    ps_device = '/job:ps/replica:0/task:0/device:CPU:0'
+    worker_device = '/job:worker/replica:0/task:0/device:CPU:0'
+    step_stats = config_pb2.RunMetadata().step_stats
+    dev_stats = step_stats.dev_stats.add()
+    dev_stats.device = ps_device
+    node_stats = dev_stats.node_stats.add()
+    node_stats.node_name = 'w/_1'
+    node_stats.all_start_micros = 100
+    node_stats.all_end_rel_micros = 2
+    node_stats.timeline_label = 'w/_1 = _Send(edge_3_w @%s' % worker_device
+    dev_stats = step_stats.dev_stats.add()
+    dev_stats.device = worker_device
+    node_stats = dev_stats.node_stats.add()
+    node_stats.node_name = 'RecvTensor'
+    node_stats.all_start_micros = 103
+    node_stats.all_end_rel_micros = 10
+    node_stats.timeline_label = '[4B] edge_3_w from %s to %s' % (ps_device,
+                                                                 worker_device)
+    node_stats = dev_stats.node_stats.add()
+    node_stats.node_name = 'w/_2'
+    node_stats.all_start_micros = 90
+    node_stats.all_end_rel_micros = 25
+    node_stats.timeline_label = 'w/_2 = _Recv(edge_3_w @%s' % ps_device
+    tl = timeline.Timeline(step_stats)
+    ctf = tl.generate_chrome_trace_format()
+    self._validateTrace(ctf)
+    flows = [
+        (event['ph'], event['ts'])
+        for event in json.loads(ctf)['traceEvents']
+        if event.get('cat') == 'DataFlow' and event['name'] == 'edge_3_w'
+    ]
+    self.assertEqual([('s', 100), ('t', 103), ('s', 112), ('t', 114)], flows)
+
   def testAnalysisAndAllocations(self):
     run_options = config_pb2.RunOptions(
         trace_level=config_pb2.RunOptions.FULL_TRACE)
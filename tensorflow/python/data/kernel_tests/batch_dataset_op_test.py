@@ -112,6 +112,29 @@ class BatchDatasetTest(test.TestCase, parameterized.TestCase):
       with self.assertRaises(errors.InvalidArgumentError):
         sess.run(get_next)
 
+  @parameterized.named_parameters(
+      ('with_remainder', False),
+      ('without_remainder', True),
+  )
+  def testBatchTensorSlices(self, drop_remainder):
+    # The slices are copied straight into the batch components.
+    components = (np.arange(10),
+                  np.array([[1, 2, 3]]) * np.arange(10)[:, np.newaxis],
+                  np.array([compat.as_bytes(str(i)) for i in range(10)]))
+    iterator = (
+        dataset_ops.Dataset.from_tensor_slices(components).batch(
+            4, drop_remainder=drop_remainder).make_one_shot_iterator())
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for start, end in [(0, 4), (4, 8)] + ([] if drop_remainder else
+                                            [(8, 10)]):
+        result = sess.run(get_next)
+        for component, result_component in zip(components, result):
+          self.assertAllEqual(component[start:end], result_component)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
   def assertSparseValuesEqual(self, a, b):
     self.assertAllEqual(a.indices, b.indices)
     self.assertAllEqual(a.values, b.values)
@@ -895,7 +895,9 @@ class Dataset(object):
        `self.output_types`) to another nested structure of tensors.
       num_parallel_calls: (Optional.) A `tf.int32` scalar `tf.Tensor`,
         representing the number elements to process in parallel. If not
-        specified, elements will be processed sequentially.
+        specified, elements will be processed sequentially. If the value
+        `tf.contrib.data.AUTOTUNE` is used, the level of parallelism is tuned
+        at runtime, within the CPU budget of the input pipeline.
 
     Returns:
       Dataset: A `Dataset`.
@@ -155,6 +155,41 @@ class ParallelInterleaveDataset(dataset_ops.InterleaveDataset):
     return "tf.contrib.data.parallel_interleave()"
 
 
+class DynamicInterleaveDataset(dataset_ops.FlatMapDataset):
+  """A `Dataset` that interleaves its nested datasets in completion order."""
+
+  def __init__(self, input_dataset, map_func, cycle_length, num_parallel_calls,
+               buffer_output_elements, max_backup_inputs):
+    """See `tf.contrib.data.dynamic_interleave()` for details."""
+    super(DynamicInterleaveDataset, self).__init__(input_dataset, map_func)
+    self._cycle_length = ops.convert_to_tensor(
+        cycle_length, dtype=dtypes.int64, name="cycle_length")
+    self._num_parallel_calls = convert.optional_param_to_tensor(
+        "num_parallel_calls", num_parallel_calls, argument_default=cycle_length)
+    self._buffer_output_elements = convert.optional_param_to_tensor(
+        "buffer_output_elements",
+        buffer_output_elements,
+        argument_default=2 * cycle_length)
+    self._max_backup_inputs = convert.optional_param_to_tensor(
+        "max_backup_inputs", max_backup_inputs, argument_default=cycle_length)
+
+  def _as_variant_tensor(self):
+    # pylint: disable=protected-access
+    return gen_dataset_ops.dynamic_interleave_dataset(
+        self._input_dataset._as_variant_tensor(),
+        self._map_func.captured_inputs,
+        self._cycle_length,
+        self._num_parallel_calls,
+        self._buffer_output_elements,
+        self._max_backup_inputs,
+        f=self._map_func,
+        **dataset_ops.flat_structure(self))
+    # pylint: enable=protected-access
+
+  def _transformation_name(self):
+    return "tf.contrib.data.dynamic_interleave()"
+
+
 @tf_export("data.TFRecordDataset")
 class TFRecordDataset(dataset_ops.Dataset):
   """A `Dataset` comprising records from one or more TFRecord files."""
@@ -34,11 +34,30 @@ limitations under the License.
   $1 = &temp;
 }
 
+%typemap(in) const tensorflow::RunMetadata& (tensorflow::RunMetadata temp) {
+  char* c_string;
+  Py_ssize_t py_size;
+  if (PyBytes_AsStringAndSize($input, &c_string, &py_size) == -1) {
+    // Python has raised an error (likely TypeError or UnicodeEncodeError).
+    SWIG_fail;
+  }
+
+  if (!temp.ParseFromString(string(c_string, py_size))) {
+    PyErr_SetString(
+        PyExc_TypeError,
+        "The RunMetadata could not be parsed as a valid protocol buffer");
+    SWIG_fail;
+  }
+  $1 = &temp;
+}
+
 %{
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/clusters/single_machine.h"
 #include "tensorflow/core/grappler/devices.h"
+#include "tensorflow/core/grappler/costs/step_critical_path.h"
 #include "tensorflow/core/grappler/grappler_item_builder.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/python/grappler/cost_analyzer.h"
 %}
 
@@ -61,7 +80,24 @@ string GenerateCostReport(const tensorflow::MetaGraphDef& metagraph, bool per_no
   return os.str();
 }
 
+string GenerateCriticalPathReport(const tensorflow::RunMetadata& run_metadata,
+                                  int top_k) {
+  std::vector<tensorflow::GraphDef> partition_graphs(
+      run_metadata.partition_graphs().begin(),
+      run_metadata.partition_graphs().end());
+  tensorflow::grappler::StepCriticalPath critical_path;
+  tensorflow::Status status =
+      critical_path.Init(partition_graphs, run_metadata.step_stats());
+  if (!status.ok()) {
+    return "Error: " + status.ToString();
+  }
+  return critical_path.Report(top_k);
+}
+
 %}
 
 string GenerateCostReport(const tensorflow::MetaGraphDef& metagraph, bool per_node_report,
                           bool verbose, GCluster cluster);
+
+string GenerateCriticalPathReport(const tensorflow::RunMetadata& run_metadata,
+                                  int top_k);
@@ -52,6 +52,28 @@ def GenerateCostReport(metagraph,
   return ret_from_swig
 
 
+def GenerateCriticalPathReport(run_metadata, top_k=10):
+  """Analyze the critical path of a traced step.
+
+  Reconstructs the dependencies of the executed ops, including the transfers
+  between devices, from the partition graphs and the step stats of the step.
+  The report lists the ops on the critical path, estimates how much shorter
+  the step would be if each of them, or each op type, was twice as fast or
+  took no time, and lists the longest ops off the critical path with their
+  slack, i.e. how much later they could finish without delaying the step.
+
+  Args:
+    run_metadata: The RunMetadata of a step run with
+      `trace_level=RunOptions.FULL_TRACE` and `output_partition_graphs=True`.
+    top_k: The number of ops and op types to list in each section.
+
+  Returns:
+    A string of critical path report.
+  """
+  return tf_wrap.GenerateCriticalPathReport(run_metadata.SerializeToString(),
+                                            top_k)
+
+
 def GenerateMemoryReport(metagraph, detailed_report=True, cluster=None):
   """Analyze the peak memory usage for the provided metagraph.
 
@@ -20,6 +20,7 @@ from __future__ import print_function
 
 import re
 
+from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import meta_graph
@@ -155,6 +156,30 @@ class CostAnalysisTest(test.TestCase):
     self.assertTrue("  c:0 uses 4 bytes" in report)
     self.assertTrue("  d:0 uses 4 bytes" in report)
 
+  def testCriticalPath(self):
+    """Make sure the critical path of a traced step is reported."""
+    with test_util.device(use_gpu=False):
+      a = random_ops.random_normal([64, 64], name="a")
+      b = math_ops.matmul(a, a, name="b")
+      c = math_ops.matmul(b, b, name="c")
+      d = math_ops.add(a, 1.0, name="d")
+    run_options = config_pb2.RunOptions(
+        trace_level=config_pb2.RunOptions.FULL_TRACE,
+        output_partition_graphs=True)
+    run_metadata = config_pb2.RunMetadata()
+    with self.test_session() as sess:
+      sess.run([c, d], options=run_options, run_metadata=run_metadata)
+
+    report = cost_analyzer.GenerateCriticalPathReport(run_metadata)
+
+    # Print the report to make it easier to debug
+    print("{}".format(report))
+
+    self.assertTrue(b"Step time:" in report)
+    self.assertTrue(b"Critical path:" in report)
+    self.assertTrue(b"c (MatMul)" in report)
+    self.assertTrue(b"Longest ops off the critical path:" in report)
+
 
 if __name__ == "__main__":
   test.main()
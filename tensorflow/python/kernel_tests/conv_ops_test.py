@@ -1795,6 +1795,32 @@ class DeepConv2DTest(test.TestCase):
   def testConv2D3x3FilterStride1x1Same(self):
     self._RunTestCases([1, 1], "SAME")
 
+  def testConv2D3x3FilterStride1x1AutoTune(self):
+    x1 = np.random.rand(2, 35, 35, 288).astype(np.float32)
+    x2 = np.random.rand(3, 3, 288, 384).astype(np.float32)
+
+    with self.test_session(use_gpu=False) as sess:
+      conv = nn_ops.conv2d(
+          constant_op.constant(x1),
+          constant_op.constant(x2),
+          strides=[1, 1, 1, 1],
+          padding="SAME")
+
+      os.environ["TF_USE_DEEP_CONV2D"] = "0"
+      values_expect = sess.run(conv)
+
+      # The first run times DeepConv2D against Eigen, the second one uses
+      # the faster of them.
+      os.environ["TF_CPU_CONV_AUTOTUNE"] = "1"
+      try:
+        values_tuning = sess.run(conv)
+        values_tuned = sess.run(conv)
+      finally:
+        del os.environ["TF_CPU_CONV_AUTOTUNE"]
+
+      self.assertAllClose(values_expect, values_tuning, rtol=1e-5, atol=1e-5)
+      self.assertAllClose(values_expect, values_tuned, rtol=1e-5, atol=1e-5)
+
 
 class Conv2DBenchmark(test.Benchmark):
 
@@ -31,6 +31,7 @@ from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import data_flow_ops
 from tensorflow.python.ops import embedding_ops
 from tensorflow.python.ops import gradient_checker
+from tensorflow.python.ops import gradients_impl
 from tensorflow.python.ops import linalg_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import partitioned_variables
@@ -719,6 +720,31 @@ class EmbeddingLookupSparseTest(test.TestCase):
             x, x_shape, y, y_shape, x_init_value=x_init_value)
       self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
 
+  def testGradientsEmbeddingLookupSparseIsIndexedSlices(self):
+    # Without weights, the rows of a single params tensor are combined without
+    # gathering them first, and their gradient stays sparse.
+    with self.test_session():
+      params = variables.Variable(
+          np.arange(12, dtype=np.float32).reshape([6, 2]))
+      sp_ids = sparse_tensor.SparseTensor(
+          constant_op.constant([[0, 0], [0, 1], [0, 2], [2, 0]], dtypes.int64),
+          constant_op.constant([1, 4, 1, 3], dtypes.int64),
+          constant_op.constant([3, 3], dtypes.int64))
+      third = 1. / 3
+      for combiner, scale in [("sum", [1, 1, 1, 1]),
+                              ("mean", [third, third, third, 1]),
+                              ("sqrtn", np.sqrt([third, third, third, 1]))]:
+        y = embedding_ops.embedding_lookup_sparse(
+            params, sp_ids, None, combiner=combiner)
+        grad, = gradients_impl.gradients(
+            y, params, grad_ys=array_ops.ones_like(y))
+        self.assertIsInstance(grad, ops.IndexedSlices)
+        variables.global_variables_initializer().run()
+        self.assertAllEqual([1, 4, 1, 3], grad.indices.eval())
+        self.assertAllClose(np.tile(np.reshape(scale, [4, 1]), [1, 2]),
+                            grad.values.eval())
+        self.assertAllEqual([6, 2], grad.dense_shape.eval())
+
   def testIncompatibleShapes(self):
     with self.test_session():
       x, _, _ = _EmbeddingParams(1, 10, dtype=dtypes.float32)
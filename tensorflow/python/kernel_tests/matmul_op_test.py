@@ -22,6 +22,7 @@ import operator
 import numpy as np
 
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
@@ -156,6 +157,21 @@ class MatMulStatsTest(test_lib.TestCase):
           self.assertEqual(7200, flops)
 
 
+class MatMulBfloat16Test(test_lib.TestCase):
+
+  def testMatMulAndBatchMatMul(self):
+    # Small integers are exact in bfloat16, and so are their products here.
+    a_np = np.random.randint(-4, 4, size=[3, 5, 7]).astype(np.float32)
+    b_np = np.random.randint(-4, 4, size=[3, 7, 2]).astype(np.float32)
+    with self.test_session(use_gpu=False):
+      a = math_ops.cast(constant_op.constant(a_np), dtypes.bfloat16)
+      b = math_ops.cast(constant_op.constant(b_np), dtypes.bfloat16)
+      product = math_ops.cast(math_ops.matmul(a[0], b[0]), dtypes.float32)
+      self.assertAllEqual(np.matmul(a_np[0], b_np[0]), product.eval())
+      product = math_ops.cast(math_ops.matmul(a, b), dtypes.float32)
+      self.assertAllEqual(np.matmul(a_np, b_np), product.eval())
+
+
 try:
   # @ operator supported since python 3.5.
   infix_matmul = operator.matmul
@@ -17,6 +17,10 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
+
+import numpy as np
+
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.client import session
 from tensorflow.python.framework import dtypes
@@ -56,5 +60,25 @@ class ShapeInferenceTest(test.TestCase):
     self.assertEqual([1, 4], op.get_shape())
 
 
+class RestoreV2Test(test.TestCase):
+
+  def testRestoreManyLargeTensors(self):
+    # Large enough for the restore to be split across the worker threads.
+    prefix = os.path.join(self.get_temp_dir(), "many_large_tensors")
+    names = ["var%d" % i for i in range(8)]
+    values = [np.random.rand(2048, 1024).astype(np.float32) for _ in names]
+    config = config_pb2.ConfigProto(intra_op_parallelism_threads=4)
+    with self.test_session(config=config) as sess:
+      sess.run(gen_io_ops.save_v2(prefix, names, [""] * len(names), values))
+      shape_and_slices = [
+          "2048 1024 2,5:-" if i % 4 == 0 else "" for i in range(8)
+      ]
+      restored = sess.run(
+          io_ops.restore_v2(prefix, names[::-1], shape_and_slices[::-1],
+                            [dtypes.float32] * len(names)))
+    for i, value in enumerate(restored[::-1]):
+      self.assertAllEqual(values[i][2:7] if i % 4 == 0 else values[i], value)
+
+
 if __name__ == "__main__":
   test.main()
@@ -148,6 +148,19 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float32)
     self._testMediumTopK(np.float16)
 
+  def testLongRowsTopK(self):
+    # Few rows with many columns, which are split across threads, and k large
+    # enough to be selected rather than kept in a heap.
+    b = 2
+    n = 200000
+    for k in [300, 2000]:
+      inputs = np.random.permutation(
+          np.linspace(0, 100, b * n, dtype=np.float32)).reshape(b, n)
+      indices = np.argsort(-inputs, axis=1)[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+      self._validateTopK(inputs, k, values, indices, sorted=False)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -417,6 +417,19 @@ class TransposeTest(test.TestCase):
       self._compare_cpu_gpu(
           np.arange(np.prod(shape)).reshape(shape).astype(np.float32))
 
+  def testCollapsedDims(self):
+    # Permutations that collapse to a matrix transpose, a batched matrix
+    # transpose, or a lower rank transpose, including ranks beyond 8.
+    for shape, perm in [([3, 70, 50], [2, 0, 1]),
+                        ([4, 3, 40, 30], [0, 2, 3, 1]),
+                        ([2, 3, 4, 5, 6], [0, 1, 4, 2, 3]),
+                        ([2, 3, 2, 3, 2, 3], [1, 0, 4, 5, 2, 3]),
+                        ([2] * 10, [1, 0, 2, 3, 4, 5, 6, 7, 9, 8])]:
+      x = np.arange(np.prod(shape)).reshape(shape)
+      self._compareCpu(x.astype(np.int32), perm)
+      c = (x + 1j * x).astype(np.complex64)
+      self._compareCpu(c, perm, conjugate=True)
+
   def testTransposeShapes(self):
     self.assertEqual(
         [],
@@ -50,6 +50,18 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]])
 
+  def testInt64Large(self):
+    # Large enough to be deduplicated in parallel.
+    x = np.random.randint(0, high=100000, size=300000).astype(np.int64)
+    with self.test_session() as sess:
+      y, idx = array_ops.unique(x)
+      tf_y, tf_idx = sess.run([y, idx])
+
+    # The unique elements are in order of first occurrence.
+    _, first_occurrences = np.unique(x, return_index=True)
+    self.assertAllEqual(x[np.sort(first_occurrences)], tf_y)
+    self.assertAllEqual(x, tf_y[tf_idx])
+
   def testString(self):
     indx = np.random.randint(65, high=122, size=7000)
     x = [chr(i) for i in indx]
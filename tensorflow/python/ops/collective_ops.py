@@ -18,7 +18,12 @@ from __future__ import division
 from __future__ import print_function
 
 from tensorflow.python.framework import device
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import gen_collective_ops
+from tensorflow.python.ops import math_ops
 
 
 def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
@@ -58,6 +63,99 @@ def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
                                               subdiv_offsets=subdiv_offsets)
 
 
+def all_reduce_indexed_slices(slices, group_size, group_key, instance_key,
+                              member_index, max_density=0.5,
+                              subdiv_offsets=(0)):
+  """Sums IndexedSlices collectively, across devices, without densifying them.
+
+  Each device first sums the values of its duplicate indices.  Then all devices
+  gather the (indices, values) pairs of every device, by all-reducing a
+  [group_size, max_rows, ...] tensor to which each device contributes only its
+  own rows, and sum the values of the same index.  When the slices of all
+  devices together hold more than `max_density` of the rows of the dense
+  tensor, a dense all-reduce moves less data, so that is done instead.
+
+  Args:
+    slices: the `IndexedSlices` to be reduced.  Its dense_shape must be set.
+    group_size: the total number of tensors to be collectively reduced.
+      Each must reside on a different device.
+    group_key: an integer identifying the group of devices.
+    instance_key: an integer identifying the participating group of Ops.  The
+      reduction uses the four instance keys starting at this one.
+    member_index: an integer in [0, group_size) that differs for every device
+      of the group.
+    max_density: the fraction of the rows of the dense tensor above which
+      the reduction is done densely.
+    subdiv_offsets: as for `all_reduce`, used by the dense reduction.
+
+  Returns:
+    An `IndexedSlices` with unique indices holding the sums of the slices of
+    all devices.
+
+  Raises:
+    ValueError: if any of the input parameter constraints are not met.
+  """
+  if not device.canonical_name(slices.values.device):
+    raise ValueError('Device assignment required for collective ops')
+  if group_size <= 1:
+    raise ValueError(
+        'Parameter group_size to all_reduce_indexed_slices must be at least 2.')
+  if slices.dense_shape is None:
+    raise ValueError('IndexedSlices to be reduced must have a dense_shape.')
+  if not 0 <= member_index < group_size:
+    raise ValueError('Parameter member_index must be in [0, group_size).')
+
+  # Int64 indices, since collectives of int32 aren't supported on GPUs.
+  indices, positions = array_ops.unique(
+      math_ops.cast(slices.indices, dtypes.int64))
+  num_rows = array_ops.size(indices)
+  values = math_ops.unsorted_segment_sum(slices.values, positions, num_rows)
+
+  # The number of rows of every device.
+  counts = all_reduce(
+      math_ops.cast(num_rows, dtypes.int64) *
+      array_ops.one_hot(member_index, group_size, dtype=dtypes.int64),
+      group_size, group_key, instance_key, 'Add', 'Id', [0])
+  max_rows = math_ops.cast(math_ops.reduce_max(counts), dtypes.int32)
+  dense_rows = math_ops.cast(slices.dense_shape[0], dtypes.int64)
+
+  def _all_gather(t, key):
+    """Returns the rows of t of every device, concatenated in device order."""
+    slots = array_ops.stack(
+        [array_ops.fill([num_rows], member_index), math_ops.range(num_rows)],
+        axis=1)
+    shape = array_ops.concat(
+        [[group_size, max_rows], array_ops.shape(t)[1:]], axis=0)
+    gathered = all_reduce(
+        array_ops.scatter_nd(slots, t, shape), group_size, group_key,
+        key, 'Add', 'Id', [0])
+    valid = (math_ops.range(max_rows, dtype=dtypes.int64)[None, :] <
+             counts[:, None])
+    return array_ops.boolean_mask(gathered, valid)
+
+  def _sparse():
+    all_indices, all_positions = array_ops.unique(
+        _all_gather(indices, instance_key + 1))
+    all_values = math_ops.unsorted_segment_sum(
+        _all_gather(values, instance_key + 2), all_positions,
+        array_ops.size(all_indices))
+    return all_indices, all_values
+
+  def _dense():
+    dense = math_ops.unsorted_segment_sum(values, indices, dense_rows)
+    return (math_ops.range(dense_rows, dtype=dtypes.int64),
+            all_reduce(dense, group_size, group_key, instance_key + 3, 'Add',
+                       'Id', subdiv_offsets))
+
+  # Every device sees the same counts, so all take the same branch.
+  is_dense = (math_ops.cast(math_ops.reduce_sum(counts), dtypes.float32) >
+              max_density * math_ops.cast(dense_rows, dtypes.float32))
+  reduced_indices, reduced_values = control_flow_ops.cond(
+      is_dense, _dense, _sparse)
+  return ops.IndexedSlices(reduced_values, reduced_indices,
+                           slices.dense_shape)
+
+
 def broadcast_send(t, shape, dtype, group_size, group_key, instance_key):
   """Broadcasts one tensor to a group of others, across devices.
 
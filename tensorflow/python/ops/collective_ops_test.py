@@ -18,6 +18,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import numpy as np
+
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import ops
@@ -75,6 +77,41 @@ class CollectiveOpTest(test.TestCase):
   def testCollectiveBroadcast(self):
     self._testCollectiveBroadcast([0.1, 1.1, 2.1, 3.1, 4.1, 5.1, 6.1, 7.1])
 
+  def _testCollectiveReduceIndexedSlices(self, max_density):
+    group_key = 1
+    instance_key = 1
+    dense_shape = [6, 2]
+    indices = [[1, 4, 1], [4, 0]]
+    values = [[[1., 2.], [3., 4.], [5., 6.]], [[7., 8.], [9., 10.]]]
+    with self.test_session(
+        config=config_pb2.ConfigProto(device_count={'CPU': 2})) as sess:
+      reduced = []
+      for i in range(2):
+        with ops.device('/CPU:%d' % i):
+          slices = ops.IndexedSlices(
+              constant_op.constant(values[i]),
+              constant_op.constant(indices[i]),
+              constant_op.constant(dense_shape))
+          reduced.append(collective_ops.all_reduce_indexed_slices(
+              slices, 2, group_key, instance_key, i, max_density))
+      run_options = config_pb2.RunOptions()
+      run_options.experimental.collective_graph_key = 1
+      results = sess.run(reduced, options=run_options)
+    expected = np.zeros(dense_shape)
+    for i in range(2):
+      np.add.at(expected, indices[i], values[i])
+    for result in results:
+      self.assertEqual(len(np.unique(result.indices)), len(result.indices))
+      dense = np.zeros(dense_shape)
+      dense[result.indices] = result.values
+      self.assertAllClose(dense, expected, rtol=1e-5, atol=1e-5)
+
+  def testCollectiveReduceIndexedSlicesSparse(self):
+    self._testCollectiveReduceIndexedSlices(max_density=1.0)
+
+  def testCollectiveReduceIndexedSlicesDense(self):
+    self._testCollectiveReduceIndexedSlices(max_density=0.1)
+
 
 if __name__ == '__main__':
   test.main()
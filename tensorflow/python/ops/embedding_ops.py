@@ -421,6 +421,10 @@ def embedding_lookup_sparse(params,
       segment_ids = math_ops.cast(segment_ids, dtypes.int32)
 
     ids = sp_ids.values
+    if (ignore_weights and len(params) == 1 and max_norm is None and
+        not context.executing_eagerly()):
+      return _sparse_segment_combine(params[0], ids, segment_ids, combiner,
+                                     name)
     ids, idx = array_ops.unique(ids)
 
     embeddings = embedding_lookup(
@@ -479,3 +483,75 @@ def embedding_lookup_sparse(params,
         assert False, "Unrecognized combiner"
 
     return embeddings
+
+
+def _sparse_segment_combine(params, ids, segment_ids, combiner, name):
+  """Combines the rows `ids` of `params` for each segment of `segment_ids`.
+
+  The SparseSegment* ops read the rows of `params` themselves, so unlike
+  `embedding_lookup` followed by a combiner this doesn't materialize the
+  looked up rows. Their gradient with respect to `params` is overridden to be
+  `IndexedSlices` of the rows read, rather than a dense tensor of the shape of
+  `params`, so that embedding variables still get sparse updates.
+
+  Args:
+    params: A single `Tensor` or `Variable` of embeddings.
+    ids: The ids to look up, as a 1-D `Tensor`.
+    segment_ids: The segment of each of `ids`, as a sorted 1-D int32 `Tensor`.
+    combiner: One of "mean", "sqrtn" and "sum".
+    name: A name for the operation.
+
+  Returns:
+    A dense `Tensor` of the combined embeddings of each segment.
+  """
+  combine_fn, op_type = {
+      "sum": (math_ops.sparse_segment_sum, "SparseSegmentSum"),
+      "mean": (math_ops.sparse_segment_mean, "SparseSegmentMean"),
+      "sqrtn": (math_ops.sparse_segment_sqrt_n, "SparseSegmentSqrtN"),
+  }[combiner]
+  with ops.get_default_graph().gradient_override_map(
+      {op_type: op_type + "AsIndexedSlices"}):
+    return combine_fn(params, ids, segment_ids, name=name)
+
+
+def _sparse_segment_grad_as_indexed_slices(op, grad, scale_fn=None):
+  """Returns the gradient of a SparseSegment* op as `IndexedSlices`.
+
+  Args:
+    op: The SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN op.
+    grad: The gradient with respect to its output.
+    scale_fn: If not None, maps the number of ids in each segment to the factor
+      its gradient is scaled by.
+
+  Returns:
+    The gradients with respect to the inputs of `op`.
+  """
+  params, ids, segment_ids = op.inputs
+  values = array_ops.gather(grad, segment_ids)
+  if scale_fn is not None:
+    counts = math_ops.unsorted_segment_sum(
+        array_ops.ones_like(segment_ids, dtype=grad.dtype), segment_ids,
+        array_ops.shape(grad)[0])
+    scale = array_ops.gather(scale_fn(math_ops.maximum(counts, 1)),
+                             segment_ids)
+    # Reshape the scale to broadcast over the rest of the dimensions.
+    ones = array_ops.ones(
+        array_ops.expand_dims(array_ops.rank(values) - 1, 0), dtypes.int32)
+    values *= array_ops.reshape(
+        scale, array_ops.concat([array_ops.shape(scale), ones], 0))
+  return (ops.IndexedSlices(values, ids, array_ops.shape(params)), None, None)
+
+
+@ops.RegisterGradient("SparseSegmentSumAsIndexedSlices")
+def _SparseSegmentSumAsIndexedSlicesGrad(op, grad):
+  return _sparse_segment_grad_as_indexed_slices(op, grad)
+
+
+@ops.RegisterGradient("SparseSegmentMeanAsIndexedSlices")
+def _SparseSegmentMeanAsIndexedSlicesGrad(op, grad):
+  return _sparse_segment_grad_as_indexed_slices(op, grad, math_ops.reciprocal)
+
+
+@ops.RegisterGradient("SparseSegmentSqrtNAsIndexedSlices")
+def _SparseSegmentSqrtNAsIndexedSlicesGrad(op, grad):
+  return _sparse_segment_grad_as_indexed_slices(op, grad, math_ops.rsqrt)
@@ -3111,6 +3111,89 @@ class JpegTest(test_util.TensorFlowTestCase):
             lambda e: "Invalid JPEG data or crop window" in str(e)):
           sess.run(result)
 
+  def testDecodeAndCropAndResizeJpeg(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+      # The sizes are large enough for the crop windows to be decoded at full
+      # resolution.
+      for crop_window, size in [([0, 0, 256, 128], [200, 100]),
+                                ([6, 5, 15, 10], [20, 12]),
+                                ([10, 20, 100, 50], [60, 40])]:
+        # Explicit three stages: decode + crop + resize.
+        y, x, h, w = crop_window
+        image1 = image_ops.resize_bilinear(
+            array_ops.expand_dims(
+                image_ops.crop_to_bounding_box(
+                    image_ops.decode_jpeg(jpeg0), y, x, h, w), 0), size)[0]
+
+        image2 = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, size)
+        self.assertAllEqual(image1.get_shape().as_list(),
+                            image2.get_shape().as_list())
+        image1, image2 = sess.run([image1, image2])
+        self.assertAllClose(image1, image2, atol=1e-3)
+
+  def testDecodeAndCropAndResizeJpegScaled(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+      # Downscaling by 2 and 4 is done by the DCT, which averages the pixels
+      # instead of interpolating them, so it is compared with area resizing.
+      for crop_window, size in [([0, 0, 256, 128], [128, 64]),
+                                ([16, 8, 200, 100], [50, 25])]:
+        y, x, h, w = crop_window
+        image1 = image_ops.resize_area(
+            array_ops.expand_dims(
+                image_ops.crop_to_bounding_box(
+                    image_ops.decode_jpeg(jpeg0), y, x, h, w), 0), size)[0]
+        image2 = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, size)
+        image1, image2 = sess.run([image1, image2])
+        self.assertLess(self.averageError(image1, image2), 4)
+
+  def testDecodeAndCropAndResizeJpegBatch(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      crop_windows = [[0, 0, 256, 128], [6, 5, 15, 10], [16, 8, 200, 100]]
+      size = [24, 16]
+      images = [
+          image_ops.decode_and_crop_and_resize_jpeg(
+              jpeg0, crop_window, size, channels=3)
+          for crop_window in crop_windows
+      ]
+      batch = image_ops.decode_and_crop_and_resize_jpeg(
+          array_ops.stack([jpeg0] * 3), crop_windows, size, channels=3)
+      self.assertAllEqual([3, 24, 16, 3], batch.get_shape().as_list())
+      images, batch = sess.run([images, batch])
+      self.assertAllEqual(np.stack(images), batch)
+
+      # The number of channels must be known to decode a batch.
+      batch = image_ops.decode_and_crop_and_resize_jpeg(
+          array_ops.stack([jpeg0] * 3), crop_windows, size)
+      with self.assertRaisesOpError("channels must be 1 or 3"):
+        sess.run(batch)
+
+  def testDecodeAndCropAndResizeJpegWithInvalidCropWindow(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+      h, w, _ = 256, 128, 3
+      crop_windows = [[-1, 11, 11, 11], [11, -1, 11, 11], [11, 11, -1, 11],
+                      [11, 11, 11, -1], [11, 11, 0, 11], [11, 11, 11, 0],
+                      [0, 0, h + 1, w], [0, 0, h, w + 1]]
+      for crop_window in crop_windows:
+        result = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, crop_window, [8, 8])
+        with self.assertRaisesWithPredicateMatch(
+            errors.InvalidArgumentError,
+            lambda e: "Invalid JPEG data or crop window" in str(e)):
+          sess.run(result)
+
   def testSynthetic(self):
     with self.test_session(use_gpu=True) as sess:
       # Encode it, then decode it, then encode it
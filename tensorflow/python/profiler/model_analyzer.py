@@ -45,6 +45,9 @@ ALL_ADVICE = {
     'AcceleratorUtilizationChecker': {},
     'JobChecker': {},  # Only available internally.
     'OperationChecker': {},
+    'HardwareCounterChecker': {},
+    'MemoryChecker': {},
+    'InputPipelineChecker': {},
 }
 
 
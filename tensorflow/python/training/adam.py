@@ -19,6 +19,7 @@ from __future__ import division
 from __future__ import print_function
 
 from tensorflow.python.eager import context
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import math_ops
@@ -29,6 +30,10 @@ from tensorflow.python.training import training_ops
 from tensorflow.python.util.tf_export import tf_export
 
 
+# The dtypes of the ResourceGroupApplyAdam kernels.
+_GROUPED_DENSE_UPDATE_DTYPES = (dtypes.float16, dtypes.float32, dtypes.float64)
+
+
 @tf_export("train.AdamOptimizer")
 class AdamOptimizer(optimizer.Optimizer):
   """Optimizer that implements the Adam algorithm.
@@ -38,7 +43,7 @@ class AdamOptimizer(optimizer.Optimizer):
   """
 
   def __init__(self, learning_rate=0.001, beta1=0.9, beta2=0.999, epsilon=1e-8,
-               use_locking=False, name="Adam"):
+               use_locking=False, name="Adam", group_dense_updates=False):
     """Construct a new Adam optimizer.
 
     Initialization:
@@ -85,6 +90,11 @@ class AdamOptimizer(optimizer.Optimizer):
       use_locking: If True use locks for update operations.
       name: Optional name for the operations created when applying gradients.
         Defaults to "Adam".
+      group_dense_updates: If True, the dense updates of resource variables
+        are applied by one op per device and dtype, rather than one op per
+        variable, when building a graph. This cuts the per-op overhead of
+        models with many small variables. The grouped op only has CPU
+        kernels, for half, float and double variables.
 
     @compatibility(eager)
     When eager execution is enabled, `learning_rate`, `beta1`, `beta2`, and
@@ -108,6 +118,10 @@ class AdamOptimizer(optimizer.Optimizer):
     # Created in SparseApply if needed.
     self._updated_lr = None
 
+    # The (grad, var) pairs whose dense updates are deferred to _finish().
+    self._group_dense_updates = group_dense_updates
+    self._grouped_dense_updates = []
+
   def _get_beta_accumulators(self):
     if context.executing_eagerly():
       graph = None
@@ -160,6 +174,10 @@ class AdamOptimizer(optimizer.Optimizer):
         grad, use_locking=self._use_locking).op
 
   def _resource_apply_dense(self, grad, var):
+    if (self._group_dense_updates and not context.executing_eagerly() and
+        grad.dtype.base_dtype in _GROUPED_DENSE_UPDATE_DTYPES):
+      self._grouped_dense_updates.append((grad, var))
+      return control_flow_ops.no_op()
     m = self.get_slot(var, "m")
     v = self.get_slot(var, "v")
     beta1_power, beta2_power = self._get_beta_accumulators()
@@ -217,7 +235,34 @@ class AdamOptimizer(optimizer.Optimizer):
     return self._apply_sparse_shared(
         grad, var, indices, self._resource_scatter_add)
 
+  def _apply_grouped_dense_updates(self):
+    """Applies the deferred dense updates, in one op per device and dtype."""
+    groups = {}
+    for grad, var in self._grouped_dense_updates:
+      groups.setdefault((var.device, grad.dtype.base_dtype), []).append(
+          (grad, var))
+    self._grouped_dense_updates = []
+    beta1_power, beta2_power = self._get_beta_accumulators()
+    update_ops = []
+    for (_, dtype), grads_and_vars in sorted(
+        groups.items(), key=lambda item: (item[0][0], item[0][1].name)):
+      grads, var_list = zip(*grads_and_vars)
+      with ops.colocate_with(var_list[0]):
+        update_ops.append(training_ops.resource_group_apply_adam(
+            [var.handle for var in var_list],
+            [self.get_slot(var, "m").handle for var in var_list],
+            [self.get_slot(var, "v").handle for var in var_list],
+            math_ops.cast(beta1_power, dtype),
+            math_ops.cast(beta2_power, dtype),
+            math_ops.cast(self._lr_t, dtype),
+            math_ops.cast(self._beta1_t, dtype),
+            math_ops.cast(self._beta2_t, dtype),
+            math_ops.cast(self._epsilon_t, dtype),
+            list(grads), use_locking=self._use_locking))
+    return update_ops
+
   def _finish(self, update_ops, name_scope):
+    update_ops = update_ops + self._apply_grouped_dense_updates()
     # Update the power accumulators.
     with ops.control_dependencies(update_ops):
       beta1_power, beta2_power = self._get_beta_accumulators()
@@ -150,7 +150,10 @@ class AdamOptimizerTest(test.TestCase):
           self.assertAllClose(aggregated_update_var.eval(),
                               repeated_index_update_var.eval())
 
-  def doTestBasic(self, use_resource=False, use_callable_params=False):
+  def doTestBasic(self,
+                  use_resource=False,
+                  use_callable_params=False,
+                  group_dense_updates=False):
     for i, dtype in enumerate([dtypes.half, dtypes.float32, dtypes.float64]):
       with self.test_session(graph=ops.Graph()):
         # Initialize variables for numpy implementation.
@@ -181,7 +184,9 @@ class AdamOptimizerTest(test.TestCase):
           beta2 = beta2()
           epsilon = epsilon()
 
-        opt = adam.AdamOptimizer(learning_rate=learning_rate)
+        opt = adam.AdamOptimizer(
+            learning_rate=learning_rate,
+            group_dense_updates=group_dense_updates)
         update = opt.apply_gradients(zip([grads0, grads1], [var0, var1]))
         opt_variables = opt.variables()
         beta1_power, beta2_power = opt._get_beta_accumulators()
@@ -231,6 +236,9 @@ class AdamOptimizerTest(test.TestCase):
   def testResourceBasic(self):
     self.doTestBasic(use_resource=True)
 
+  def testResourceGroupDenseUpdates(self):
+    self.doTestBasic(use_resource=True, group_dense_updates=True)
+
   def testBasicCallableParams(self):
     with context.eager_mode():
       self.doTestBasic(use_resource=True, use_callable_params=True)
@@ -378,6 +378,20 @@ bool CUDAExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
   return true;
 }
 
+bool CUDAExecutor::LaunchBatch(Stream *stream,
+                               port::ArraySlice<KernelLaunch> launches) {
+  // Activates the context once for all the launches, which then find it
+  // already current.
+  ScopedActivateContext activation(context_);
+  for (const KernelLaunch &launch : launches) {
+    if (!Launch(stream, launch.thread_dims, launch.block_dims, *launch.kernel,
+                *launch.args)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // This is a non-essential operation; if there's a failure, proceed without
 // logging an error. It's nearly certain that in case of failures, we'd never
 // get here in the first place; these are very low-impact routines.
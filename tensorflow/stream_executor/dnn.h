@@ -26,6 +26,7 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 #include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/lib/array_slice.h"
@@ -2028,6 +2029,9 @@ class DnnSupport {
   //  state_allocator: an memory allocator that will be used to store the state
   //    for dropout layer. The user has to maintain the memory until the model
   //    is no longer in use.
+  //  use_padded_io: whether the model runs on padded sequences of variable
+  //    lengths, described by createRnnSequenceTensorDescriptor with
+  //    seq_lengths.
   virtual port::StatusOr<std::unique_ptr<dnn::RnnDescriptor>>
   createRnnDescriptor(int num_layers, int hidden_size, int input_size,
                       int batch_size, dnn::RnnInputMode input_mode,
@@ -2035,7 +2039,7 @@ class DnnSupport {
                       dnn::RnnMode rnn_mode, dnn::DataType data_type,
                       const dnn::AlgorithmConfig& algorithm_config,
                       float dropout, uint64 seed,
-                      ScratchAllocator* state_allocator) {
+                      ScratchAllocator* state_allocator, bool use_padded_io) {
     return port::Status(port::error::UNIMPLEMENTED,
                         "createRnnDescriptor is unimplemented");
   }
@@ -2055,6 +2059,26 @@ class DnnSupport {
                         "createRnnSequenceTensorDescriptor is unimplemented");
   }
 
+  // Create a RNN sequence descriptor for a batch of padded sequences of
+  // variable lengths, laid out as [max_seq_length, batch_size, data_size].
+  // Steps past the length of a sequence are neither read nor computed, and
+  // are zero in the output.
+  //
+  // Arguments:
+  //  max_seq_length: the length of the longest sequence.
+  //  batch_size: the size of a minibatch.
+  //  data_size: the size of the state.
+  //  seq_lengths: the length of every sequence of the minibatch.
+  //  data_type: an enum to specify the type for the underlying data.
+  virtual port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(int max_seq_length, int batch_size,
+                                    int data_size,
+                                    const std::vector<int>& seq_lengths,
+                                    dnn::DataType data_type) {
+    return port::Status(port::error::UNIMPLEMENTED,
+                        "createRnnSequenceTensorDescriptor is unimplemented");
+  }
+
   // Create an RNN state descriptor that specifies the input or hidden state.
   // The caller retains the ownership of the returned descriptor.
   virtual port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
@@ -77,6 +77,7 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/kernel_cache_config.h"
+#include "tensorflow/stream_executor/launch_dim.h"
 #include "tensorflow/stream_executor/lib/array_slice.h"
 #include "tensorflow/stream_executor/lib/inlined_vector.h"
 #include "tensorflow/stream_executor/lib/stringpiece.h"
@@ -484,6 +485,15 @@ class KernelArgsArray : public KernelArgsArrayBase {
   size_t number_of_shared_memory_arguments_;
 };
 
+// A kernel launch with already-packed arguments, as passed to
+// Stream::ThenLaunchBatch. Owns neither the kernel nor the arguments.
+struct KernelLaunch {
+  ThreadDim thread_dims;
+  BlockDim block_dims;
+  const KernelBase *kernel;
+  const KernelArgsArrayBase *args;
+};
+
 // Typed variant of KernelBase, like a typed device function pointer. See the
 // file comment for details and example usage.
 //
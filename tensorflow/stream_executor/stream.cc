@@ -1927,6 +1927,23 @@ void Stream::ReturnSubStream(Stream *sub_stream) {
   LOG(FATAL) << "the sub-stream to be returned is not created by this stream";
 }
 
+Stream &Stream::ThenLaunchBatch(port::ArraySlice<KernelLaunch> launches) {
+  const int64 num_launches = launches.size();
+  VLOG_CALL(PARAM(num_launches));
+
+  if (ok()) {
+    if (!parent_->LaunchBatch(this, launches)) {
+      SetError();
+      LOG(WARNING) << "parent failed to launch a batch of " << num_launches
+                   << " kernels";
+    }
+  } else {
+    LOG(INFO) << "stream " << this << " did not enqueue a batch of "
+              << num_launches << " kernels";
+  }
+  return *this;
+}
+
 Stream &Stream::ThenStartTimer(Timer *t) {
   VLOG_CALL(PARAM(t));
 
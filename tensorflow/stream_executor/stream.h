@@ -155,6 +155,12 @@ class Stream {
   Stream &ThenLaunch(ThreadDim thread_dims, BlockDim block_dims,
                      const TypedKernel<Params...> &kernel, Args... args);
 
+  // Launches the kernels in order, with arguments that the caller has already
+  // packed (see StreamExecutor::Launch). Amortizes the per-launch host
+  // overhead of ThenLaunch across many small kernels. The launches and their
+  // arguments need only live until this returns.
+  Stream &ThenLaunchBatch(port::ArraySlice<KernelLaunch> launches);
+
   // Record a "start" event for the interval timer at this point in the
   // stream's
   // execution (relative to the previously and subsequently enqueued items in
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/stream_executor/kernel_cache_config.h"
 #include "tensorflow/stream_executor/kernel_spec.h"
 #include "tensorflow/stream_executor/launch_dim.h"
+#include "tensorflow/stream_executor/lib/array_slice.h"
 #include "tensorflow/stream_executor/lib/status.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 #include "tensorflow/stream_executor/platform.h"
@@ -168,6 +169,19 @@ class StreamExecutorInterface {
                       const KernelArgsArrayBase &args) {
     return false;
   }
+  // Launches the kernels in order on the stream. Stops at, and returns false
+  // on, the first launch that fails. Platforms may override this to amortize
+  // the per-launch host overhead.
+  virtual bool LaunchBatch(Stream *stream,
+                           port::ArraySlice<KernelLaunch> launches) {
+    for (const KernelLaunch &launch : launches) {
+      if (!Launch(stream, launch.thread_dims, launch.block_dims,
+                  *launch.kernel, *launch.args)) {
+        return false;
+      }
+    }
+    return true;
+  }
   // Releases any state associated with the kernel.
   virtual void UnloadKernel(const KernelBase *kernel) {}
   virtual void *Allocate(uint64 size) = 0;
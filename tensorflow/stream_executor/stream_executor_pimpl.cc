@@ -354,7 +354,7 @@ StreamExecutor::createRnnDescriptor(
     dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
     dnn::RnnMode rnn_mode, dnn::DataType data_type,
     const dnn::AlgorithmConfig &algorithm_config, float dropout, uint64 seed,
-    ScratchAllocator *state_allocator) {
+    ScratchAllocator *state_allocator, bool use_padded_io) {
   dnn::DnnSupport *dnn_support = AsDnn();
   if (!dnn_support) {
     return port::Status(port::error::UNKNOWN,
@@ -363,7 +363,7 @@ StreamExecutor::createRnnDescriptor(
   return dnn_support->createRnnDescriptor(
       num_layers, hidden_size, input_size, batch_size, input_mode,
       direction_mode, rnn_mode, data_type, algorithm_config, dropout, seed,
-      state_allocator);
+      state_allocator, use_padded_io);
 }
 
 port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
@@ -379,6 +379,19 @@ StreamExecutor::createRnnSequenceTensorDescriptor(int seq_length,
                                                         data_size, data_type);
 }
 
+port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+StreamExecutor::createRnnSequenceTensorDescriptor(
+    int max_seq_length, int batch_size, int data_size,
+    const std::vector<int> &seq_lengths, dnn::DataType data_type) {
+  dnn::DnnSupport *dnn_support = AsDnn();
+  if (!dnn_support) {
+    return port::Status(port::error::UNKNOWN,
+                        "Fail to find the dnn implementation.");
+  }
+  return dnn_support->createRnnSequenceTensorDescriptor(
+      max_seq_length, batch_size, data_size, seq_lengths, data_type);
+}
+
 port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
 StreamExecutor::createRnnStateTensorDescriptor(int num_layer, int batch_size,
                                                int data_size,
@@ -442,6 +455,18 @@ bool StreamExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
   return implementation_->Launch(stream, thread_dims, block_dims, kernel, args);
 }
 
+bool StreamExecutor::LaunchBatch(Stream *stream,
+                                 port::ArraySlice<KernelLaunch> launches) {
+  if (tracing_enabled_) {
+    for (const KernelLaunch &launch : launches) {
+      SubmitTrace(&TraceListener::LaunchSubmit, stream, launch.thread_dims,
+                  launch.block_dims, *launch.kernel, *launch.args);
+    }
+  }
+
+  return implementation_->LaunchBatch(stream, launches);
+}
+
 port::Status StreamExecutor::BlockHostUntilDone(Stream *stream) {
   port::Status result;
   SCOPED_TRACE(TraceListener::BlockHostUntilDone, &result, stream);
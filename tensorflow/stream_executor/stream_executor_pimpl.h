@@ -390,7 +390,7 @@ class StreamExecutor {
       dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
       dnn::RnnMode rnn_mode, dnn::DataType data_type,
       const dnn::AlgorithmConfig &algorithm_config, float dropout, uint64 seed,
-      ScratchAllocator *state_allocator);
+      ScratchAllocator *state_allocator, bool use_padded_io);
 
   // Create a RNN sequence descriptor that specifies either the input or output
   // sequence. The caller retains the ownership of the returned descriptor.
@@ -398,6 +398,15 @@ class StreamExecutor {
   createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
                                     int data_size, dnn::DataType data_type);
 
+  // Create a RNN sequence descriptor for a batch of padded sequences of
+  // variable lengths. The caller retains the ownership of the returned
+  // descriptor.
+  port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(int max_seq_length, int batch_size,
+                                    int data_size,
+                                    const std::vector<int> &seq_lengths,
+                                    dnn::DataType data_type);
+
   // Create an RNN state descriptor that specifies the input or hidden state.
   // The caller retains the ownership of the returned descriptor.
   port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
@@ -428,6 +437,13 @@ class StreamExecutor {
               const BlockDim &block_dims, const KernelBase &kernel,
               const KernelArgsArrayBase &args);
 
+  // Launches the kernels in order with already-packed args, as by Launch(),
+  // with the per-launch overhead paid once for the whole batch. Returns false
+  // at the first launch that fails.
+  //
+  // This is called by Stream::ThenLaunchBatch().
+  bool LaunchBatch(Stream *stream, port::ArraySlice<KernelLaunch> launches);
+
   // Gets-or-creates (creates with memoization) a FftSupport datatype that can
   // be used to execute FFT routines on the current platform.
   //
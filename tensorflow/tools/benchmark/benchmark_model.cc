@@ -71,48 +71,6 @@ void InitializeTensor(const std::vector<float>& initialization_values,
   }
 }
 
-void CreateTensorsFromInputInfo(
-    const std::vector<InputLayerInfo>& inputs,
-    std::vector<std::pair<string, tensorflow::Tensor> >* input_tensors) {
-  for (const InputLayerInfo& input : inputs) {
-    Tensor input_tensor(input.data_type, input.shape);
-    switch (input.data_type) {
-      case DT_INT32: {
-        InitializeTensor<int32>(input.initialization_values, &input_tensor);
-        break;
-      }
-      case DT_FLOAT: {
-        InitializeTensor<float>(input.initialization_values, &input_tensor);
-        break;
-      }
-      case DT_QUINT8: {
-        InitializeTensor<quint8>(input.initialization_values, &input_tensor);
-        break;
-      }
-      case DT_UINT8: {
-        InitializeTensor<uint8>(input.initialization_values, &input_tensor);
-        break;
-      }
-      case DT_BOOL: {
-        InitializeTensor<bool>(input.initialization_values, &input_tensor);
-        break;
-      }
-      case DT_STRING: {
-        if (!input.initialization_values.empty()) {
-          LOG(FATAL) << "Initialization values are not supported for strings";
-        }
-        auto type_tensor = input_tensor.flat<string>();
-        type_tensor = type_tensor.constant("");
-        break;
-      }
-      default:
-        LOG(FATAL) << "Unsupported input type: "
-                   << DataTypeString(input.data_type);
-    }
-    input_tensors->push_back({input.name, input_tensor});
-  }
-}
-
 Status GetOutputShapes(const std::vector<InputLayerInfo>& inputs,
                        const std::set<string>& wanted_shapes, Session* session,
                        std::unordered_map<string, TensorShape>* node_shapes) {
@@ -245,6 +203,48 @@ void SleepSeconds(double sleep_seconds) {
 
 }  // namespace
 
+void CreateTensorsFromInputInfo(
+    const std::vector<InputLayerInfo>& inputs,
+    std::vector<std::pair<string, tensorflow::Tensor> >* input_tensors) {
+  for (const InputLayerInfo& input : inputs) {
+    Tensor input_tensor(input.data_type, input.shape);
+    switch (input.data_type) {
+      case DT_INT32: {
+        InitializeTensor<int32>(input.initialization_values, &input_tensor);
+        break;
+      }
+      case DT_FLOAT: {
+        InitializeTensor<float>(input.initialization_values, &input_tensor);
+        break;
+      }
+      case DT_QUINT8: {
+        InitializeTensor<quint8>(input.initialization_values, &input_tensor);
+        break;
+      }
+      case DT_UINT8: {
+        InitializeTensor<uint8>(input.initialization_values, &input_tensor);
+        break;
+      }
+      case DT_BOOL: {
+        InitializeTensor<bool>(input.initialization_values, &input_tensor);
+        break;
+      }
+      case DT_STRING: {
+        if (!input.initialization_values.empty()) {
+          LOG(FATAL) << "Initialization values are not supported for strings";
+        }
+        auto type_tensor = input_tensor.flat<string>();
+        type_tensor = type_tensor.constant("");
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unsupported input type: "
+                   << DataTypeString(input.data_type);
+    }
+    input_tensors->push_back({input.name, input_tensor});
+  }
+}
+
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
                          std::unique_ptr<GraphDef>* graph_def) {
@@ -30,6 +30,12 @@ struct InputLayerInfo {
   std::vector<float> initialization_values;
 };
 
+// Creates the tensors described by `inputs`, paired with their names so that
+// they can be fed to Session::Run.
+void CreateTensorsFromInputInfo(
+    const std::vector<InputLayerInfo>& inputs,
+    std::vector<std::pair<string, tensorflow::Tensor> >* input_tensors);
+
 // Loads a model from disk into a new session.
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
@@ -0,0 +1,569 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to benchmark the serving latency of a SavedModel under
+// concurrent load, closed or open loop, optionally with request batching.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/serving_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/batching_util/basic_batch_scheduler.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace serving_benchmark {
+
+namespace {
+
+using benchmark_model::InputLayerInfo;
+using serving::BasicBatchScheduler;
+using serving::Batch;
+using serving::BatchTask;
+
+// Runs requests on a session, tracing one in `trace_every` into `stats`.
+class RequestRunner {
+ public:
+  RequestRunner(const std::vector<string>& outputs,
+                const std::vector<string>& targets, Session* session,
+                StatSummarizer* stats, int trace_every)
+      : outputs_(outputs),
+        targets_(targets),
+        session_(session),
+        trace_every_(trace_every),
+        stats_(stats) {}
+
+  Status Run(const std::vector<std::pair<string, Tensor> >& inputs,
+             std::vector<Tensor>* outputs) {
+    RunOptions run_options;
+    const bool trace = stats_ != nullptr && trace_every_ > 0 &&
+                       num_runs_.fetch_add(1) % trace_every_ == 0;
+    if (trace) {
+      run_options.set_trace_level(RunOptions::FULL_TRACE);
+    }
+    RunMetadata run_metadata;
+    TF_RETURN_IF_ERROR(session_->Run(run_options, inputs, outputs_, targets_,
+                                     outputs, &run_metadata));
+    if (trace) {
+      mutex_lock l(stats_mu_);
+      stats_->ProcessStepStats(run_metadata.step_stats());
+    }
+    return Status::OK();
+  }
+
+ private:
+  const std::vector<string>& outputs_;
+  const std::vector<string>& targets_;
+  Session* const session_;
+  const int trace_every_;
+  std::atomic<int64> num_runs_{0};
+
+  mutex stats_mu_;
+  StatSummarizer* const stats_ PT_GUARDED_BY(stats_mu_);
+};
+
+// A request waiting in the batch scheduler. Its size is its number of
+// examples, the 0th dimension of its inputs.
+struct BatchedRequest : public BatchTask {
+  size_t size() const override { return inputs[0].second.dim_size(0); }
+
+  std::vector<std::pair<string, Tensor> > inputs;
+  std::vector<Tensor>* outputs;
+  Status* status;
+  Notification* done;
+};
+
+// Concatenates the inputs of the requests of `batch`, runs them together and
+// splits the outputs back between the requests.
+Status RunBatch(RequestRunner* runner, Batch<BatchedRequest>* batch) {
+  std::vector<int64> sizes;
+  for (int t = 0; t < batch->num_tasks(); ++t) {
+    sizes.push_back(batch->task(t).size());
+  }
+  std::vector<std::pair<string, Tensor> > inputs;
+  for (int i = 0; i < batch->task(0).inputs.size(); ++i) {
+    std::vector<Tensor> to_concatenate;
+    for (int t = 0; t < batch->num_tasks(); ++t) {
+      to_concatenate.push_back(batch->task(t).inputs[i].second);
+    }
+    Tensor concatenated;
+    TF_RETURN_IF_ERROR(tensor::Concat(to_concatenate, &concatenated));
+    inputs.emplace_back(batch->task(0).inputs[i].first, concatenated);
+  }
+  std::vector<Tensor> outputs;
+  TF_RETURN_IF_ERROR(runner->Run(inputs, &outputs));
+  for (const Tensor& output : outputs) {
+    std::vector<Tensor> split;
+    TF_RETURN_IF_ERROR(tensor::Split(output, sizes, &split));
+    for (int t = 0; t < batch->num_tasks(); ++t) {
+      batch->mutable_task(t)->outputs->push_back(split[t]);
+    }
+  }
+  return Status::OK();
+}
+
+void ProcessBatch(RequestRunner* runner,
+                  std::unique_ptr<Batch<BatchedRequest> > batch) {
+  const Status status = RunBatch(runner, batch.get());
+  for (int t = 0; t < batch->num_tasks(); ++t) {
+    BatchedRequest* request = batch->mutable_task(t);
+    *request->status = status;
+    request->done->Notify();
+  }
+}
+
+Status InputsFromSignature(const SignatureDef& signature,
+                           int request_batch_size,
+                           const std::vector<string>& input_layer_shapes,
+                           std::vector<InputLayerInfo>* inputs) {
+  // Sorted by key, the order of --input_layer_shape.
+  const std::map<string, TensorInfo> signature_inputs(
+      signature.inputs().begin(), signature.inputs().end());
+  if (!input_layer_shapes.empty() &&
+      input_layer_shapes.size() != signature_inputs.size()) {
+    return errors::InvalidArgument(
+        "--input_layer_shape has ", input_layer_shapes.size(),
+        " shapes but the signature has ", signature_inputs.size(), " inputs");
+  }
+  int n = 0;
+  for (const auto& signature_input : signature_inputs) {
+    const TensorInfo& tensor_info = signature_input.second;
+    InputLayerInfo input;
+    input.name = tensor_info.name();
+    input.data_type = tensor_info.dtype();
+    if (!input_layer_shapes.empty()) {
+      std::vector<int32> sizes;
+      if (!str_util::SplitAndParseAsInts(input_layer_shapes[n], ',', &sizes)) {
+        return errors::InvalidArgument("Incorrect size string specified: ",
+                                       input_layer_shapes[n]);
+      }
+      for (int32 size : sizes) {
+        input.shape.AddDim(size);
+      }
+    } else {
+      if (tensor_info.tensor_shape().unknown_rank()) {
+        return errors::InvalidArgument(
+            "Input ", signature_input.first,
+            " has an unknown rank, specify it with --input_layer_shape");
+      }
+      for (int i = 0; i < tensor_info.tensor_shape().dim_size(); ++i) {
+        int64 size = tensor_info.tensor_shape().dim(i).size();
+        if (size < 0 && i == 0) {
+          size = request_batch_size;
+        } else if (size < 0) {
+          return errors::InvalidArgument(
+              "Input ", signature_input.first, " has an unknown dimension ", i,
+              ", specify its shape with --input_layer_shape");
+        }
+        input.shape.AddDim(size);
+      }
+    }
+    inputs->push_back(input);
+    ++n;
+  }
+  return Status::OK();
+}
+
+void RecordBenchmarkEntry(const string& output_prefix,
+                          const string& benchmark_name, int concurrency,
+                          const ServingBenchmarkResult& result) {
+  TestReporter reporter(output_prefix,
+                        strings::StrCat(benchmark_name, "_c", concurrency));
+  TF_QCHECK_OK(reporter.Initialize());
+  TF_QCHECK_OK(reporter.Benchmark(result.num_requests, -1.0,
+                                  result.wall_time_s, result.throughput_qps));
+  TF_QCHECK_OK(reporter.SetProperty("errors", result.num_errors));
+  TF_QCHECK_OK(reporter.SetProperty("mean_us", result.mean_us));
+  TF_QCHECK_OK(reporter.SetProperty("p50_us", result.p50_us));
+  TF_QCHECK_OK(reporter.SetProperty("p90_us", result.p90_us));
+  TF_QCHECK_OK(reporter.SetProperty("p99_us", result.p99_us));
+  TF_QCHECK_OK(reporter.SetProperty("p999_us", result.p999_us));
+  TF_QCHECK_OK(reporter.SetProperty("max_us", result.max_us));
+  TF_QCHECK_OK(reporter.SetProperty("mean_batch_size", result.mean_batch_size));
+  TF_QCHECK_OK(reporter.Close());
+}
+
+string FormatResult(int concurrency, const ServingBenchmarkResult& result) {
+  return strings::Printf(
+      "%11d %9lld %7lld %10.1f %9lld %9lld %9lld %9lld %9lld %9lld %6.1f",
+      concurrency, result.num_requests, result.num_errors,
+      result.throughput_qps, result.mean_us, result.p50_us, result.p90_us,
+      result.p99_us, result.p999_us, result.max_us, result.mean_batch_size);
+}
+
+}  // namespace
+
+int64 Percentile(const std::vector<int64>& sorted_values, double percentile) {
+  const int64 rank = static_cast<int64>(
+      std::ceil(percentile / 100.0 * sorted_values.size()));
+  return sorted_values[std::min<int64>(std::max<int64>(rank, 1),
+                                       sorted_values.size()) -
+                       1];
+}
+
+Status RunServingBenchmark(const ServingBenchmarkOptions& options,
+                           const std::vector<InputLayerInfo>& inputs,
+                           const std::vector<string>& outputs,
+                           const std::vector<string>& targets,
+                           Session* session, StatSummarizer* stats,
+                           ServingBenchmarkResult* result) {
+  if (options.concurrency <= 0) {
+    return errors::InvalidArgument("concurrency must be positive, got ",
+                                   options.concurrency);
+  }
+  if (options.max_num_requests <= 0 && options.max_time_s <= 0.0) {
+    return errors::InvalidArgument(
+        "One of max_num_requests and max_time_s must be positive");
+  }
+  std::vector<std::pair<string, Tensor> > input_tensors;
+  benchmark_model::CreateTensorsFromInputInfo(inputs, &input_tensors);
+
+  RequestRunner runner(outputs, targets, session, stats, options.trace_every);
+  std::atomic<int64> num_batches(0);
+  std::unique_ptr<BasicBatchScheduler<BatchedRequest> > scheduler;
+  if (options.batching) {
+    for (const auto& input : input_tensors) {
+      if (input.second.dims() == 0) {
+        return errors::InvalidArgument("Batching requires inputs with a 0th ",
+                                       "dimension, but ", input.first,
+                                       " is a scalar");
+      }
+    }
+    BasicBatchScheduler<BatchedRequest>::Options scheduler_options;
+    scheduler_options.max_batch_size = options.max_batch_size;
+    scheduler_options.batch_timeout_micros = options.batch_timeout_micros;
+    scheduler_options.num_batch_threads = options.num_batch_threads;
+    // There are at most as many requests in flight as clients.
+    scheduler_options.max_enqueued_batches = options.concurrency;
+    TF_RETURN_IF_ERROR(BasicBatchScheduler<BatchedRequest>::Create(
+        scheduler_options,
+        [&runner, &num_batches](std::unique_ptr<Batch<BatchedRequest> > batch) {
+          num_batches.fetch_add(1);
+          ProcessBatch(&runner, std::move(batch));
+        },
+        &scheduler));
+  }
+
+  auto run_request = [&input_tensors, &runner, &scheduler]() -> Status {
+    std::vector<Tensor> output_tensors;
+    if (!scheduler) {
+      return runner.Run(input_tensors, &output_tensors);
+    }
+    Status status;
+    Notification done;
+    std::unique_ptr<BatchedRequest> request(new BatchedRequest);
+    request->inputs = input_tensors;
+    request->outputs = &output_tensors;
+    request->status = &status;
+    request->done = &done;
+    TF_RETURN_IF_ERROR(scheduler->Schedule(&request));
+    done.WaitForNotification();
+    return status;
+  };
+
+  LOG(INFO) << "Running " << options.concurrency << " clients in a "
+            << (options.target_qps > 0.0
+                    ? strings::StrCat("open loop at ", options.target_qps,
+                                      " QPS")
+                    : "closed loop")
+            << (options.batching ? " with batching" : "") << ", for max "
+            << options.max_num_requests << " requests and max "
+            << options.max_time_s << " seconds";
+
+  Env* env = Env::Default();
+  const int64 max_num_requests =
+      options.max_num_requests > 0 ? options.max_num_requests : kint64max;
+  const int64 start_us = env->NowMicros();
+  const int64 end_us =
+      options.max_time_s > 0.0
+          ? start_us + static_cast<int64>(options.max_time_s * 1000000.0)
+          : kint64max;
+  std::atomic<int64> next_request(0);
+  mutex mu;
+  std::vector<int64> latencies;
+  int64 num_errors = 0;
+  Status first_error;
+  {
+    thread::ThreadPool clients(env, "serving_benchmark_clients",
+                               options.concurrency);
+    for (int c = 0; c < options.concurrency; ++c) {
+      clients.Schedule([&]() {
+        std::vector<int64> client_latencies;
+        int64 client_errors = 0;
+        Status client_error;
+        for (int64 i = next_request.fetch_add(1); i < max_num_requests;
+             i = next_request.fetch_add(1)) {
+          int64 scheduled_us = env->NowMicros();
+          if (options.target_qps > 0.0) {
+            const int64 now_us = scheduled_us;
+            scheduled_us =
+                start_us + static_cast<int64>(i * 1000000.0 /
+                                              options.target_qps);
+            if (scheduled_us > now_us) {
+              env->SleepForMicroseconds(scheduled_us - now_us);
+            }
+          }
+          if (scheduled_us >= end_us) break;
+          const Status s = run_request();
+          const int64 latency_us = env->NowMicros() - scheduled_us;
+          if (s.ok()) {
+            client_latencies.push_back(latency_us);
+          } else {
+            if (client_errors++ == 0) client_error = s;
+          }
+        }
+        mutex_lock l(mu);
+        latencies.insert(latencies.end(), client_latencies.begin(),
+                         client_latencies.end());
+        num_errors += client_errors;
+        first_error.Update(client_error);
+      });
+    }
+  }  // Waits for the clients.
+  const int64 wall_time_us = env->NowMicros() - start_us;
+  scheduler.reset();
+
+  if (num_errors > 0) {
+    LOG(WARNING) << num_errors << " requests failed, the first with "
+                 << first_error;
+  }
+  if (latencies.empty()) {
+    return first_error.ok() ? errors::DeadlineExceeded(
+                                  "No request was issued within max_time_s")
+                            : first_error;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  int64 total_latency_us = 0;
+  for (int64 latency_us : latencies) {
+    total_latency_us += latency_us;
+  }
+  result->num_requests = latencies.size() + num_errors;
+  result->num_errors = num_errors;
+  result->wall_time_s = wall_time_us / 1000000.0;
+  result->throughput_qps = latencies.size() / result->wall_time_s;
+  result->mean_us = total_latency_us / latencies.size();
+  result->p50_us = Percentile(latencies, 50.0);
+  result->p90_us = Percentile(latencies, 90.0);
+  result->p99_us = Percentile(latencies, 99.0);
+  result->p999_us = Percentile(latencies, 99.9);
+  result->max_us = latencies.back();
+  result->mean_batch_size =
+      num_batches > 0 ? static_cast<double>(latencies.size()) / num_batches
+                      : 1.0;
+  return Status::OK();
+}
+
+int Main(int argc, char** argv) {
+  string saved_model_dir = "";
+  string tags_string = kSavedModelTagServe;
+  string signature = kDefaultServingSignatureDefKey;
+  string input_layer_shape_string = "";
+  int request_batch_size = 1;
+  string concurrency_string = "1,2,4,8,16";
+  string target_qps = "-1.0";
+  int max_num_requests = 1000;
+  string max_time = "10.0";
+  int warmup_requests = 10;
+  bool batching = false;
+  int max_batch_size = 32;
+  int batch_timeout_micros = 1000;
+  int num_batch_threads = 1;
+  int num_threads = -1;
+  int trace_every = 100;
+  int time_limit = 10;
+  string benchmark_name = "";
+  string output_prefix = "";
+
+  std::vector<Flag> flag_list = {
+      Flag("saved_model_dir", &saved_model_dir, "SavedModel directory"),
+      Flag("tags", &tags_string, "tags of the MetaGraphDef to load"),
+      Flag("signature", &signature, "key of the SignatureDef to run"),
+      Flag("input_layer_shape", &input_layer_shape_string,
+           "input shapes, in the order of the signature input keys, instead "
+           "of the signature shapes"),
+      Flag("request_batch_size", &request_batch_size,
+           "size of unknown 0th input dimensions"),
+      Flag("concurrency", &concurrency_string,
+           "numbers of concurrent clients to benchmark"),
+      Flag("target_qps", &target_qps,
+           "total rate of requests in an open loop, or closed loop if <= 0"),
+      Flag("max_num_requests", &max_num_requests,
+           "number of requests max per concurrency level"),
+      Flag("max_time", &max_time, "length to run max per concurrency level"),
+      Flag("warmup_requests", &warmup_requests,
+           "how many requests to initialize model"),
+      Flag("batching", &batching, "whether to batch concurrent requests"),
+      Flag("max_batch_size", &max_batch_size, "max examples per batch"),
+      Flag("batch_timeout_micros", &batch_timeout_micros,
+           "max wait for a batch to fill"),
+      Flag("num_batch_threads", &num_batch_threads,
+           "number of batches run concurrently"),
+      Flag("num_threads", &num_threads, "number of intra-op threads"),
+      Flag("trace_every", &trace_every,
+           "trace one run in this many for per-op stats, 0 to disable"),
+      Flag("time_limit", &time_limit, "how many ops to show by time taken"),
+      Flag("benchmark_name", &benchmark_name, "benchmark name"),
+      Flag("output_prefix", &output_prefix, "benchmark output prefix"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || saved_model_dir.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  std::vector<int32> concurrencies;
+  if (!str_util::SplitAndParseAsInts(concurrency_string, ',',
+                                     &concurrencies) ||
+      concurrencies.empty()) {
+    LOG(ERROR) << "Incorrect --concurrency specified: " << concurrency_string;
+    return -1;
+  }
+
+  SessionOptions session_options;
+  if (num_threads > 0) {
+    session_options.config.set_intra_op_parallelism_threads(num_threads);
+  }
+  const std::vector<string> tags = str_util::Split(tags_string, ',');
+  SavedModelBundle bundle;
+  Status s = LoadSavedModel(
+      session_options, RunOptions(), saved_model_dir,
+      std::unordered_set<string>(tags.begin(), tags.end()), &bundle);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not load SavedModel: " << s;
+    return -1;
+  }
+  const auto signature_it = bundle.meta_graph_def.signature_def().find(
+      signature);
+  if (signature_it == bundle.meta_graph_def.signature_def().end()) {
+    LOG(ERROR) << "SignatureDef " << signature << " not found";
+    return -1;
+  }
+  std::vector<InputLayerInfo> inputs;
+  s = InputsFromSignature(signature_it->second, request_batch_size,
+                          str_util::Split(input_layer_shape_string, ':'),
+                          &inputs);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return -1;
+  }
+  const std::map<string, TensorInfo> signature_outputs(
+      signature_it->second.outputs().begin(),
+      signature_it->second.outputs().end());
+  std::vector<string> outputs;
+  for (const auto& output : signature_outputs) {
+    outputs.push_back(output.second.name());
+  }
+
+  ServingBenchmarkOptions options;
+  options.target_qps = std::strtod(target_qps.c_str(), nullptr);
+  options.max_num_requests = max_num_requests;
+  options.max_time_s = std::strtod(max_time.c_str(), nullptr);
+  options.batching = batching;
+  options.max_batch_size = max_batch_size;
+  options.batch_timeout_micros = batch_timeout_micros;
+  options.num_batch_threads = num_batch_threads;
+  options.trace_every = trace_every;
+
+  if (warmup_requests > 0) {
+    ServingBenchmarkOptions warmup_options = options;
+    warmup_options.concurrency = 1;
+    warmup_options.target_qps = 0.0;
+    warmup_options.max_num_requests = warmup_requests;
+    warmup_options.max_time_s = -1.0;
+    warmup_options.trace_every = 0;
+    ServingBenchmarkResult warmup_result;
+    s = RunServingBenchmark(warmup_options, inputs, outputs, {},
+                            bundle.session.get(), nullptr, &warmup_result);
+    if (!s.ok()) {
+      LOG(ERROR) << "Warmup failed with " << s;
+      return -1;
+    }
+  }
+
+  StatSummarizerOptions stats_options;
+  stats_options.show_run_order = false;
+  stats_options.time_limit = time_limit;
+  stats_options.show_memory = false;
+  std::vector<string> lines;
+  for (int concurrency : concurrencies) {
+    options.concurrency = concurrency;
+    std::unique_ptr<StatSummarizer> stats;
+    if (trace_every > 0) {
+      stats.reset(new StatSummarizer(stats_options));
+    }
+    ServingBenchmarkResult result;
+    s = RunServingBenchmark(options, inputs, outputs, {},
+                            bundle.session.get(), stats.get(), &result);
+    if (!s.ok()) {
+      LOG(ERROR) << "Benchmark failed with " << s;
+      return -1;
+    }
+    lines.push_back(FormatResult(concurrency, result));
+    LOG(INFO) << "Latencies in us with " << concurrency
+              << " clients: " << result.num_requests << " requests, "
+              << result.throughput_qps << " QPS, mean " << result.mean_us
+              << ", p50 " << result.p50_us << ", p90 " << result.p90_us
+              << ", p99 " << result.p99_us << ", p99.9 " << result.p999_us
+              << ", max " << result.max_us;
+    if (stats != nullptr && stats->num_runs() > 0) {
+      stats->PrintStepStats();
+    }
+    if (!benchmark_name.empty() && !output_prefix.empty()) {
+      RecordBenchmarkEntry(output_prefix, benchmark_name, concurrency, result);
+    }
+  }
+
+  LOG(INFO) << "Summary, latencies in us:\n"
+            << "concurrency  requests  errors        QPS      mean       p50 "
+               "      p90       p99     p99.9       max  batch\n"
+            << str_util::Join(lines, "\n");
+  return 0;
+}
+
+}  // namespace serving_benchmark
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_SERVING_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_SERVING_BENCHMARK_H_
+
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/stat_summarizer.h"
+#include "tensorflow/tools/benchmark/benchmark_model.h"
+
+namespace tensorflow {
+namespace serving_benchmark {
+
+struct ServingBenchmarkOptions {
+  // The number of client threads issuing requests.
+  int concurrency = 1;
+  // If not positive, the clients run a closed loop: each sends its next
+  // request as soon as the previous one returns. Otherwise they run an open
+  // loop, issuing requests on a fixed schedule at this total rate whatever
+  // the latency. Latencies are then measured from the scheduled time, so that
+  // they include the queueing when the clients fall behind.
+  double target_qps = 0.0;
+  // The benchmark stops after this many requests if positive, or after
+  // max_time_s seconds if positive, whichever comes first.
+  int64 max_num_requests = 1000;
+  double max_time_s = 10.0;
+  // If true, concurrent requests are concatenated along their 0th dimension
+  // and run together, with a BasicBatchScheduler as in a batching model
+  // server.
+  bool batching = false;
+  int max_batch_size = 32;
+  int64 batch_timeout_micros = 1000;
+  int num_batch_threads = 1;
+  // If positive, one session run in trace_every is traced into the
+  // StatSummarizer, for a per-op breakdown.
+  int trace_every = 0;
+};
+
+struct ServingBenchmarkResult {
+  int64 num_requests = 0;
+  int64 num_errors = 0;
+  double wall_time_s = 0.0;
+  // Successful requests per second.
+  double throughput_qps = 0.0;
+  // The latencies of successful requests.
+  int64 mean_us = 0;
+  int64 p50_us = 0;
+  int64 p90_us = 0;
+  int64 p99_us = 0;
+  int64 p999_us = 0;
+  int64 max_us = 0;
+  // With batching, the mean number of requests per session run.
+  double mean_batch_size = 1.0;
+};
+
+// Issues requests with `inputs` to `session` as configured by `options`, and
+// times them. Failed requests are counted in `result`; an error is only
+// returned if no request succeeded. `stats` may be null.
+Status RunServingBenchmark(
+    const ServingBenchmarkOptions& options,
+    const std::vector<benchmark_model::InputLayerInfo>& inputs,
+    const std::vector<string>& outputs, const std::vector<string>& targets,
+    Session* session, StatSummarizer* stats, ServingBenchmarkResult* result);
+
+// Returns the nearest-rank `percentile` (in [0, 100]) of `sorted_values`,
+// which must not be empty.
+int64 Percentile(const std::vector<int64>& sorted_values, double percentile);
+
+// Handles all setup and argument parsing.
+int Main(int argc, char** argv);
+
+}  // namespace serving_benchmark
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_SERVING_BENCHMARK_H_
@@ -0,0 +1,154 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/serving_benchmark.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using serving_benchmark::ServingBenchmarkOptions;
+using serving_benchmark::ServingBenchmarkResult;
+
+// Creates a session running a MatMul of a [batch_size, 10] input, with an
+// unknown batch size.
+void CreateTestSession(int batch_size, benchmark_model::InputLayerInfo* input,
+                       string* output_name,
+                       std::unique_ptr<Session>* session) {
+  auto root = Scope::NewRootScope().ExitOnError();
+  input->shape = TensorShape({batch_size, 10});
+  input->data_type = DT_FLOAT;
+  Tensor constant_tensor(DT_FLOAT, TensorShape({10, 4}));
+  test::FillFn<float>(&constant_tensor, [](int) -> float { return 3.0; });
+  auto placeholder = ops::Placeholder(
+      root, DT_FLOAT, ops::Placeholder::Shape(PartialTensorShape({-1, 10})));
+  input->name = placeholder.node()->name();
+  auto m = ops::MatMul(root, placeholder, constant_tensor);
+  *output_name = m.node()->name();
+  GraphDef graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+  session->reset(NewSession(SessionOptions()));
+  TF_ASSERT_OK((*session)->Create(graph_def));
+}
+
+void ExpectValidLatencies(const ServingBenchmarkResult& result) {
+  EXPECT_GT(result.throughput_qps, 0.0);
+  EXPECT_LE(result.p50_us, result.p90_us);
+  EXPECT_LE(result.p90_us, result.p99_us);
+  EXPECT_LE(result.p99_us, result.p999_us);
+  EXPECT_LE(result.p999_us, result.max_us);
+  EXPECT_LE(result.mean_us, result.max_us);
+}
+
+TEST(ServingBenchmarkTest, Percentile) {
+  std::vector<int64> values;
+  for (int i = 1; i <= 1000; ++i) {
+    values.push_back(i);
+  }
+  EXPECT_EQ(1, serving_benchmark::Percentile(values, 0.0));
+  EXPECT_EQ(500, serving_benchmark::Percentile(values, 50.0));
+  EXPECT_EQ(990, serving_benchmark::Percentile(values, 99.0));
+  EXPECT_EQ(999, serving_benchmark::Percentile(values, 99.9));
+  EXPECT_EQ(1000, serving_benchmark::Percentile(values, 100.0));
+  EXPECT_EQ(7, serving_benchmark::Percentile({7}, 99.9));
+}
+
+TEST(ServingBenchmarkTest, ClosedLoop) {
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  std::unique_ptr<Session> session;
+  CreateTestSession(1, &input, &output_name, &session);
+
+  ServingBenchmarkOptions options;
+  options.concurrency = 4;
+  options.max_num_requests = 100;
+  options.max_time_s = -1.0;
+  ServingBenchmarkResult result;
+  TF_ASSERT_OK(serving_benchmark::RunServingBenchmark(
+      options, {input}, {output_name}, {}, session.get(), nullptr, &result));
+  EXPECT_EQ(100, result.num_requests);
+  EXPECT_EQ(0, result.num_errors);
+  ExpectValidLatencies(result);
+}
+
+TEST(ServingBenchmarkTest, OpenLoop) {
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  std::unique_ptr<Session> session;
+  CreateTestSession(1, &input, &output_name, &session);
+
+  ServingBenchmarkOptions options;
+  options.concurrency = 2;
+  options.target_qps = 1000.0;
+  options.max_num_requests = 50;
+  options.max_time_s = -1.0;
+  ServingBenchmarkResult result;
+  TF_ASSERT_OK(serving_benchmark::RunServingBenchmark(
+      options, {input}, {output_name}, {}, session.get(), nullptr, &result));
+  EXPECT_EQ(50, result.num_requests);
+  EXPECT_EQ(0, result.num_errors);
+  // The requests are spread over at least 49ms.
+  EXPECT_GE(result.wall_time_s, 0.049);
+  ExpectValidLatencies(result);
+}
+
+TEST(ServingBenchmarkTest, Batching) {
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  std::unique_ptr<Session> session;
+  CreateTestSession(2, &input, &output_name, &session);
+
+  ServingBenchmarkOptions options;
+  options.concurrency = 4;
+  options.max_num_requests = 100;
+  options.max_time_s = -1.0;
+  options.batching = true;
+  options.max_batch_size = 8;
+  options.batch_timeout_micros = 1000;
+  ServingBenchmarkResult result;
+  TF_ASSERT_OK(serving_benchmark::RunServingBenchmark(
+      options, {input}, {output_name}, {}, session.get(), nullptr, &result));
+  EXPECT_EQ(100, result.num_requests);
+  EXPECT_EQ(0, result.num_errors);
+  EXPECT_GE(result.mean_batch_size, 1.0);
+  EXPECT_LE(result.mean_batch_size, 4.0);
+  ExpectValidLatencies(result);
+}
+
+TEST(ServingBenchmarkTest, TracesOneRunInTraceEvery) {
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  std::unique_ptr<Session> session;
+  CreateTestSession(1, &input, &output_name, &session);
+
+  ServingBenchmarkOptions options;
+  options.concurrency = 2;
+  options.max_num_requests = 100;
+  options.max_time_s = -1.0;
+  options.trace_every = 10;
+  StatSummarizer stats((StatSummarizerOptions()));
+  ServingBenchmarkResult result;
+  TF_ASSERT_OK(serving_benchmark::RunServingBenchmark(
+      options, {input}, {output_name}, {}, session.get(), &stats, &result));
+  EXPECT_EQ(100, result.num_requests);
+  EXPECT_EQ(10, stats.num_runs());
+}
+
+}  // namespace
+}  // namespace tensorflow
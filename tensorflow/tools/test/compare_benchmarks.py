@@ -0,0 +1,147 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Compares benchmark results against a baseline and reports regressions.
+
+The results are TestResults protos written by run_and_gather_logs, e.g. by
+`bazel run //tensorflow/tools/test:core_ops_benchmark`, either as JSON (when
+--test_log_output_dir is set) or in text format. Benchmarks are matched by
+name and compared on their wall time per iteration:
+
+  python compare_benchmarks.py --baseline=before.json --current=after.json \
+      --threshold=0.1
+
+Exits with a non-zero status if any benchmark regressed by more than the
+threshold.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import sys
+
+from google.protobuf import json_format
+from google.protobuf import text_format
+
+from tensorflow.core.util import test_log_pb2
+from tensorflow.python.platform import app
+from tensorflow.python.platform import gfile
+
+FLAGS = None
+
+
+def load_test_results(path):
+  """Reads a TestResults proto from a JSON or text format file."""
+  content = gfile.GFile(path, "r").read()
+  test_results = test_log_pb2.TestResults()
+  if path.endswith(".json"):
+    json_format.Parse(content, test_results)
+  else:
+    text_format.Merge(content, test_results)
+  return test_results
+
+
+def wall_time_per_iteration(test_results):
+  """Returns {benchmark name: wall time per iteration in seconds}."""
+  times = {}
+  for entry in test_results.entries.entry:
+    if entry.wall_time > 0:
+      times[entry.name] = entry.wall_time / max(entry.iters, 1)
+  return times
+
+
+def compare(baseline, current, threshold):
+  """Compares the benchmarks of two TestResults.
+
+  Args:
+    baseline: The TestResults to compare against.
+    current: The TestResults to check.
+    threshold: The relative slowdown above which a benchmark regressed, e.g.
+      0.1 for 10%.
+
+  Returns:
+    A (regressions, improvements, missing) tuple. The first two are lists of
+    (name, baseline time, current time) sorted from the largest relative
+    change; missing are the names of baseline benchmarks that did not run.
+  """
+  baseline_times = wall_time_per_iteration(baseline)
+  current_times = wall_time_per_iteration(current)
+  regressions = []
+  improvements = []
+  missing = []
+  for name in sorted(baseline_times):
+    if name not in current_times:
+      missing.append(name)
+      continue
+    before = baseline_times[name]
+    after = current_times[name]
+    if after > before * (1 + threshold):
+      regressions.append((name, before, after))
+    elif after < before / (1 + threshold):
+      improvements.append((name, before, after))
+  regressions.sort(key=lambda r: r[1] / r[2])
+  improvements.sort(key=lambda r: r[2] / r[1])
+  return regressions, improvements, missing
+
+
+def _format(name, before, after):
+  return "  %-60s %12.3fus -> %12.3fus (%+.1f%%)" % (
+      name, before * 1e6, after * 1e6, 100.0 * (after - before) / before)
+
+
+def main(unused_args):
+  baseline = load_test_results(FLAGS.baseline)
+  current = load_test_results(FLAGS.current)
+  regressions, improvements, missing = compare(baseline, current,
+                                               FLAGS.threshold)
+  if regressions:
+    print("%d regressions:" % len(regressions))
+    for r in regressions:
+      print(_format(*r))
+  if improvements:
+    print("%d improvements:" % len(improvements))
+    for i in improvements:
+      print(_format(*i))
+  if missing:
+    print("%d benchmarks missing from the current results:" % len(missing))
+    for name in missing:
+      print("  " + name)
+  if not regressions:
+    print("No regressions above %.1f%%." % (100 * FLAGS.threshold))
+    return 0
+  return 1
+
+
+if __name__ == "__main__":
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      "--baseline",
+      type=str,
+      default="",
+      help="TestResults to compare against, in JSON or text format.")
+  parser.add_argument(
+      "--current",
+      type=str,
+      default="",
+      help="TestResults to check, in JSON or text format.")
+  parser.add_argument(
+      "--threshold",
+      type=float,
+      default=0.1,
+      help="Relative slowdown in wall time above which a benchmark is "
+      "reported as a regression.")
+  FLAGS, unparsed = parser.parse_known_args()
+  app.run(main=main, argv=[sys.argv[0]] + unparsed)
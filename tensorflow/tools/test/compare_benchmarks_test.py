@@ -0,0 +1,72 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for compare_benchmarks."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from google.protobuf import json_format
+
+from tensorflow.core.util import test_log_pb2
+from tensorflow.python.platform import gfile
+from tensorflow.python.platform import test
+from tensorflow.tools.test import compare_benchmarks
+
+
+def _test_results(wall_times):
+  test_results = test_log_pb2.TestResults()
+  for name, (iters, wall_time) in wall_times.items():
+    entry = test_results.entries.entry.add()
+    entry.name = name
+    entry.iters = iters
+    entry.wall_time = wall_time
+  return test_results
+
+
+class CompareBenchmarksTest(test.TestCase):
+
+  def testCompare(self):
+    baseline = _test_results({
+        "BM_a/0/1": (100, 1.0),
+        "BM_b/0/1": (100, 1.0),
+        "BM_c/0/1": (100, 1.0),
+        "BM_d/0/1": (100, 1.0),
+    })
+    # Times are compared per iteration: BM_a is unchanged.
+    current = _test_results({
+        "BM_a/0/1": (200, 2.0),
+        "BM_b/0/1": (100, 1.5),
+        "BM_c/0/1": (100, 0.5),
+        "BM_e/0/1": (100, 1.0),
+    })
+    regressions, improvements, missing = compare_benchmarks.compare(
+        baseline, current, threshold=0.1)
+    self.assertEqual([("BM_b/0/1", 0.01, 0.015)], regressions)
+    self.assertEqual([("BM_c/0/1", 0.01, 0.005)], improvements)
+    self.assertEqual(["BM_d/0/1"], missing)
+
+  def testLoadJson(self):
+    test_results = _test_results({"BM_a/0/1": (10, 1.0)})
+    path = os.path.join(self.get_temp_dir(), "results.json")
+    gfile.GFile(path, "w").write(json_format.MessageToJson(test_results))
+    self.assertEqual(test_results,
+                     compare_benchmarks.load_test_results(path))
+
+
+if __name__ == "__main__":
+  test.main()